@@ -0,0 +1,470 @@
+/**
+ * @file EcsBenchmark.cpp
+ * @brief World の基本操作を計測するヘッドレスのマイクロベンチマーク
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ウィンドウや D3D11 を使わずに World だけを動かし、エンティティ数ごと(既定 1k / 10k / 100k / 1M)に
+ * 次の操作の所要時間を計測します。
+ * - create        : CreateEntity() を N 回
+ * - destroy       : DestroyEntity() を N 回(破棄キューへの追加のみ)
+ * - flush_destroy : N 件の破棄キューを FlushDestroyEndOfFrame() で反映
+ * - add           : Add<BenchPosition>() を N 回
+ * - remove        : Remove<BenchPosition>() を N 回
+ * - foreach_1     : ForEach<BenchPosition> で N 件を走査
+ * - foreach_2     : ForEach<BenchPosition, BenchVelocity> で N 件を走査
+ * - tick          : N 個の Behaviour を持つ World の Tick() を1回
+ * - world_scalar  : N 個の Transform の ToMatrix() から転置したワールド行列と WVP 行列を1つずつ書き込む
+ * - world_sse     : 同じ計算を WorldMatrixBatch の SSE の実装で
+ * - world_avx2    : 同じ計算を WorldMatrixBatch の AVX2 の実装で(AVX2 のない CPU では計測しない)
+ *
+ * 計測の前に、Tick 前の World のスナップショットを別の World へ読み戻せるかを確かめ、
+ * 失敗した場合は計測せずに終了コード 1 で終わります。
+ *
+ * 各計測は World を作り直して `--repeat` 回行い、最小値と中央値を出します。
+ * 準備(エンティティの作成など)は計測に含みません。
+ *
+ * 結果は標準出力に表として、`--out` のファイルに CSV(1計測1行)として書き出します。
+ * ファイルが既にある場合は行を追記するため、`--label` で実行ごとに名前を付けておくと、
+ * ストレージやスケジューラの変更前後を同じファイルで比較できます。
+ * 各回の計測値は `--history` のファイル(既定 bench_history.csv、BenchmarkHistory)にもコミットとマシンを付けて追記し、
+ * HEW_BENCH_COMPARE で前のコミットと比較できます(tick は World::Tick/<N> という名前で記録します)。
+ *
+ * @par 使用例
+ * @code
+ * HEW_ECS_BENCH.exe --label baseline
+ * HEW_ECS_BENCH.exe --label chunk32k --counts 10000,100000 --repeat 10
+ * HEW_ECS_BENCH.exe --history none                // 履歴に追記しない
+ * @endcode
+ *
+ * @note Release 構成で実行してください(Debug ではログと検査が計測の大半を占めます)。
+ */
+#include "ecs/World.h"
+#include "app/BenchmarkHistory.h"
+#include "app/FrameArena.h"
+#include "components/Component.h"
+#include "components/Transform.h"
+#include "graphics/WorldMatrixBatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ========================================================
+// 計測用のコンポーネント
+// ========================================================
+
+struct BenchPosition {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+struct BenchVelocity {
+    float x = 1.0f, y = 0.0f, z = 0.0f;
+};
+
+/**
+ * @brief ワールド行列の計測の書き込み先(RenderSystem のインスタンスデータと同じ大きさ)
+ */
+struct BenchInstance {
+    DirectX::XMFLOAT4X4 world;
+    float color[4];
+    float uvTransform[4];
+    uint32_t textureSlice[4];
+};
+
+/**
+ * @brief Tick() の計測に使う最小の Behaviour
+ */
+struct BenchBehaviour : Behaviour {
+    float value = 0.0f;
+
+    void OnUpdate(World&, Entity, float dt) override {
+        value += dt;
+    }
+};
+
+// ========================================================
+// 計測の補助
+// ========================================================
+
+/**
+ * @struct BenchResult
+ * @brief 1計測の結果
+ */
+struct BenchResult {
+    const char* name = "";  ///< 計測名(create, foreach_1 など)
+    size_t entities = 0;    ///< エンティティ数
+    size_t ops = 0;         ///< 1回の計測での操作数
+    double bestMs = 0.0;    ///< 最小値(ミリ秒)
+    double medianMs = 0.0;  ///< 中央値(ミリ秒)
+    std::vector<double> samples; ///< 各回の計測値(ミリ秒、計測順)
+
+    double NsPerOp() const {
+        return ops > 0 ? bestMs * 1.0e6 / static_cast<double>(ops) : 0.0;
+    }
+};
+
+/**
+ * @struct BenchOptions
+ * @brief コマンドライン引数
+ */
+struct BenchOptions {
+    std::vector<size_t> counts{ 1000, 10000, 100000, 1000000 }; ///< エンティティ数
+    int repeat = 5;                                              ///< 計測の繰り返し回数
+    std::string out = "ecs_benchmark.csv";                       ///< CSV の出力先
+    std::string label = "default";                               ///< 実行の名前(CSV の label 列)
+    std::string history = BenchmarkHistory::DEFAULT_PATH;        ///< 計測値を追記する履歴("none" で追記しない)
+};
+
+using BenchClock = std::chrono::steady_clock;
+
+/// 最適化で走査が消えないよう、結果をここへ書き込む
+volatile float g_sink = 0.0f;
+
+double ElapsedMs(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+/**
+ * @brief 計測を repeat 回行い、最小値と中央値をまとめる
+ *
+ * @param[in] run World を受け取り、計測した時間(ミリ秒)を返す関数。World は毎回作り直す
+ */
+template<class F>
+BenchResult Measure(const char* name, size_t entities, size_t ops, int repeat, F&& run) {
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(repeat));
+    for (int r = 0; r < repeat; ++r) {
+        {
+            World world;
+            samples.push_back(run(world));
+        }
+        // 1回の計測を1フレームとみなし、破棄・スポーンの反映が使った分をアプリのフレーム終端と同じく戻す
+        FrameArena::ForThread().Reset();
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.entities = entities;
+    result.ops = ops;
+    result.samples = samples;
+    std::sort(samples.begin(), samples.end());
+    result.bestMs = samples.front();
+    result.medianMs = samples[samples.size() / 2];
+    return result;
+}
+
+/**
+ * @brief n 個のエンティティを作成(計測対象外の準備)
+ */
+std::vector<Entity> Populate(World& world, size_t n) {
+    world.Reserve(n);
+    std::vector<Entity> entities;
+    world.CreateBatch(n, entities);
+    return entities;
+}
+
+// ========================================================
+// 計測
+// ========================================================
+
+/**
+ * @brief ワールド行列の計算(World は使わない)を実装ごとに計測
+ */
+void RunWorldMatrixSuite(size_t n, int repeat, std::vector<BenchResult>& results) {
+    std::vector<Transform> transforms(n);
+    std::vector<DirectX::XMFLOAT3> positions(n), rotations(n), scales(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float f = static_cast<float>(i);
+        transforms[i] = Transform({ f, f * 0.5f, -f }, { f * 3.0f, f * 7.0f, f * 11.0f }, { 1.0f, 1.0f + f * 0.001f, 2.0f });
+        positions[i] = transforms[i].position;
+        rotations[i] = transforms[i].rotation;
+        scales[i] = transforms[i].scale;
+    }
+    std::vector<BenchInstance> instances(n);
+    std::vector<DirectX::XMFLOAT4X4> wvps(n);
+    const DirectX::XMMATRIX viewProj =
+        DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(0.0f, 5.0f, -10.0f, 1.0f), DirectX::XMVectorZero(), DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) *
+        DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+    results.push_back(Measure("world_scalar", n, n, repeat, [&](World&) {
+        auto start = BenchClock::now();
+        for (size_t i = 0; i < n; ++i) {
+            const DirectX::XMMATRIX world = transforms[i].ToMatrix();
+            DirectX::XMStoreFloat4x4(&instances[i].world, DirectX::XMMatrixTranspose(world));
+            DirectX::XMStoreFloat4x4(&wvps[i], DirectX::XMMatrixTranspose(world * viewProj));
+        }
+        double ms = ElapsedMs(start);
+        g_sink = instances[n - 1].world._14 + wvps[n - 1]._44;
+        return ms;
+    }));
+
+    WorldMatrixBatch::Output out;
+    out.world = &instances[0].world;
+    out.worldStride = sizeof(BenchInstance);
+    out.wvp = wvps.data();
+    out.viewProj = &viewProj;
+    const WorldMatrixBatch::Kernel kernels[] = { WorldMatrixBatch::Kernel::Sse, WorldMatrixBatch::Kernel::Avx2 };
+    for (WorldMatrixBatch::Kernel kernel : kernels) {
+        if (WorldMatrixBatch::Resolve(kernel) != kernel) continue;
+        const char* name = kernel == WorldMatrixBatch::Kernel::Avx2 ? "world_avx2" : "world_sse";
+        results.push_back(Measure(name, n, n, repeat, [&](World&) {
+            auto start = BenchClock::now();
+            WorldMatrixBatch::Build(positions.data(), rotations.data(), scales.data(), n, out, kernel);
+            double ms = ElapsedMs(start);
+            g_sink = instances[n - 1].world._14 + wvps[n - 1]._44;
+            return ms;
+        }));
+    }
+}
+
+void RunSuite(size_t n, int repeat, std::vector<BenchResult>& results) {
+    results.push_back(Measure("create", n, n, repeat, [n](World& world) {
+        world.Reserve(n);
+        auto start = BenchClock::now();
+        for (size_t i = 0; i < n; ++i) {
+            world.CreateEntity();
+        }
+        return ElapsedMs(start);
+    }));
+
+    results.push_back(Measure("destroy", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        auto start = BenchClock::now();
+        for (Entity e : entities) {
+            world.DestroyEntity(e);
+        }
+        return ElapsedMs(start);
+    }));
+
+    results.push_back(Measure("flush_destroy", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        for (Entity e : entities) {
+            world.Add<BenchPosition>(e);
+            world.Add<BenchVelocity>(e);
+            world.DestroyEntity(e);
+        }
+        auto start = BenchClock::now();
+        world.FlushDestroyEndOfFrame();
+        return ElapsedMs(start);
+    }));
+
+    results.push_back(Measure("add", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        auto start = BenchClock::now();
+        for (Entity e : entities) {
+            world.Add<BenchPosition>(e);
+        }
+        return ElapsedMs(start);
+    }));
+
+    results.push_back(Measure("remove", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        for (Entity e : entities) {
+            world.Add<BenchPosition>(e);
+        }
+        auto start = BenchClock::now();
+        for (Entity e : entities) {
+            world.Remove<BenchPosition>(e);
+        }
+        return ElapsedMs(start);
+    }));
+
+    results.push_back(Measure("foreach_1", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        for (Entity e : entities) {
+            world.Add<BenchPosition>(e);
+        }
+        float sum = 0.0f;
+        auto start = BenchClock::now();
+        world.ForEach<BenchPosition>([&sum](Entity, BenchPosition& p) {
+            p.x += 1.0f;
+            sum += p.x;
+        });
+        double ms = ElapsedMs(start);
+        g_sink = sum;
+        return ms;
+    }));
+
+    results.push_back(Measure("foreach_2", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        for (Entity e : entities) {
+            world.Add<BenchPosition>(e);
+            world.Add<BenchVelocity>(e);
+        }
+        float sum = 0.0f;
+        auto start = BenchClock::now();
+        world.ForEach<BenchPosition, BenchVelocity>([&sum](Entity, BenchPosition& p, BenchVelocity& v) {
+            p.x += v.x;
+            p.y += v.y;
+            p.z += v.z;
+            sum += p.x;
+        });
+        double ms = ElapsedMs(start);
+        g_sink = sum;
+        return ms;
+    }));
+
+    results.push_back(Measure("tick", n, n, repeat, [n](World& world) {
+        std::vector<Entity> entities = Populate(world, n);
+        for (Entity e : entities) {
+            world.Add<BenchBehaviour>(e);
+        }
+        world.Tick(1.0f / 60.0f); // OnStart を済ませる
+        auto start = BenchClock::now();
+        world.Tick(1.0f / 60.0f);
+        return ElapsedMs(start);
+    }));
+
+    RunWorldMatrixSuite(n, repeat, results);
+}
+
+// ========================================================
+// 計測前の確認
+// ========================================================
+
+/**
+ * @brief Tick 前に書き出したスナップショットが別の World に読み込めるかを確認
+ *
+ * IDキャッシュがブロック単位で確保した分まで世代表が揃っていないと、読み込み側で不正な表として拒否されます。
+ */
+bool CheckSnapshotRoundTrip() {
+    World source;
+    std::vector<Entity> entities = Populate(source, 100);
+    std::vector<uint8_t> bytes;
+    source.Serialize(bytes);
+
+    World restored;
+    if (!restored.Deserialize(bytes) || restored.GetAliveCount() != entities.size()) return false;
+    for (Entity e : entities) {
+        if (!restored.IsAlive(e)) return false;
+    }
+    return true;
+}
+
+// ========================================================
+// 引数と出力
+// ========================================================
+
+bool ParseCounts(const char* text, std::vector<size_t>& counts) {
+    counts.clear();
+    const char* p = text;
+    while (*p) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(p, &end, 10);
+        if (end == p || value == 0) return false;
+        counts.push_back(static_cast<size_t>(value));
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return !counts.empty();
+}
+
+bool ParseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--counts") == 0 && hasValue) {
+            if (!ParseCounts(argv[++i], options.counts)) return false;
+        } else if (std::strcmp(arg, "--repeat") == 0 && hasValue) {
+            options.repeat = std::atoi(argv[++i]);
+            if (options.repeat < 1) return false;
+        } else if (std::strcmp(arg, "--out") == 0 && hasValue) {
+            options.out = argv[++i];
+        } else if (std::strcmp(arg, "--label") == 0 && hasValue) {
+            options.label = argv[++i];
+        } else if (std::strcmp(arg, "--history") == 0 && hasValue) {
+            options.history = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintUsage() {
+    std::printf("usage: HEW_ECS_BENCH [--counts 1000,10000,...] [--repeat N] [--out file.csv] [--label name] [--history file.csv|none]\n");
+}
+
+/**
+ * @brief 結果を CSV に追記(新規ファイルのみ見出し行を書く)
+ */
+bool WriteCsv(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    FILE* probe = nullptr;
+    const bool writeHeader = (fopen_s(&probe, options.out.c_str(), "r") != 0 || probe == nullptr);
+    if (probe) std::fclose(probe);
+
+    FILE* fp = nullptr;
+    if (fopen_s(&fp, options.out.c_str(), "a") != 0 || !fp) return false;
+    if (writeHeader) {
+        std::fprintf(fp, "label,case,entities,ops,repeat,best_ms,median_ms,ns_per_op\n");
+    }
+    for (const BenchResult& r : results) {
+        std::fprintf(fp, "%s,%s,%zu,%zu,%d,%.4f,%.4f,%.2f\n",
+                     options.label.c_str(), r.name, r.entities, r.ops, options.repeat,
+                     r.bestMs, r.medianMs, r.NsPerOp());
+    }
+    std::fclose(fp);
+    return true;
+}
+
+/**
+ * @brief 各回の計測値を BenchmarkHistory に追記(tick は World::Tick として記録)
+ */
+bool WriteHistory(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::vector<BenchmarkRecord> records;
+    records.reserve(results.size());
+    for (const BenchResult& r : results) {
+        const char* name = std::strcmp(r.name, "tick") == 0 ? "World::Tick" : r.name;
+        records.push_back(BenchmarkHistory::MakeRecord("ecs", std::string(name) + "/" + std::to_string(r.entities), r.samples));
+    }
+    return BenchmarkHistory::Append(options.history, records);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+    if (!CheckSnapshotRoundTrip()) {
+        std::fprintf(stderr, "snapshot round trip before Tick failed\n");
+        return 1;
+    }
+
+    std::printf("%-14s %10s %12s %12s %10s\n", "case", "entities", "best_ms", "median_ms", "ns/op");
+    std::vector<BenchResult> results;
+    for (size_t n : options.counts) {
+        const size_t first = results.size();
+        RunSuite(n, options.repeat, results);
+        for (size_t i = first; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            std::printf("%-14s %10zu %12.3f %12.3f %10.1f\n", r.name, r.entities, r.bestMs, r.medianMs, r.NsPerOp());
+        }
+        std::fflush(stdout);
+    }
+
+    if (!WriteCsv(options, results)) {
+        std::fprintf(stderr, "failed to write %s\n", options.out.c_str());
+        return 1;
+    }
+    std::printf("results appended to %s (label=%s)\n", options.out.c_str(), options.label.c_str());
+
+    if (options.history != "none") {
+        if (!WriteHistory(options, results)) {
+            std::fprintf(stderr, "failed to write %s\n", options.history.c_str());
+            return 1;
+        }
+        std::printf("samples appended to %s (commit=%s)\n", options.history.c_str(), BenchmarkHistory::CurrentCommit().c_str());
+    }
+    return 0;
+}
@@ -1,21 +1,26 @@
 ﻿#pragma once
 #include "components/Component.h"
-#include "ecs/Entity.h"
-#include "ecs/World.h"
 #include "graphics/TextureManager.h"
+#include "components/MeshRenderer.h"
+#include <DirectXMath.h>
+#include <cstddef>
 #include <vector>
-#include <cmath>
 
 /**
  * @file Animation.h
  * @brief アニメーションコンポーネントの定義
  * @author 山内陽
  * @date 2025
- * @version 5.0
+ * @version 6.0
  *
  * @details
- * このファイルはスプライトアニメーションとUVスクロールアニメーションを
- * 実現するBehaviourコンポーネントを定義します。
+ * このファイルはスプライトアニメーションとUVスクロールアニメーションの
+ * データコンポーネントを定義します。再生は SpriteAnimationSystem が種類ごとに
+ * クエリの密配列をまとめて進め、同じエンティティの MeshRenderer に直接書き込みます
+ * (エンティティごとの仮想呼び出しはありません)。
+ *
+ * 停止中・再生の終わったアニメーションは、システムがコンポーネントを無効化(World::SetEnabled)して
+ * 次のステップから走査の対象外にします。再開は SpriteAnimationSystem::Play() で行います。
  */
 
 /**
@@ -28,7 +33,7 @@
  *
  * ### アニメーションの仕組み:
  * 1. frames配列に複数のテクスチャを登録
- * 2. frameTime間隔でテクスチャを切り替え
+ * 2. frameTime間隔でテクスチャを切り替え(SpriteAnimationSystem が MeshRenderer::texture に反映)
  * 3. loopフラグで繰り返し再生を制御
  *
  * @par 使用例(基本)
@@ -40,13 +45,10 @@
  * world.Add<SpriteAnimation>(entity, anim);
  * @endcode
  *
- * @par 使用例(毎フレーム現在のテクスチャを取得)
+ * @par 使用例(一時停止と再開)
  * @code
- * auto* anim = world.TryGet<SpriteAnimation>(entity);
- * auto* renderer = world.TryGet<MeshRenderer>(entity);
- * if (anim && renderer) {
- *     renderer->texture = anim->GetCurrentTexture();
- * }
+ * SpriteAnimationSystem::Stop<SpriteAnimation>(world, entity);  // 現在のフレームで止める
+ * SpriteAnimationSystem::Play<SpriteAnimation>(world, entity);  // 続きから再生
  * @endcode
  *
  * @par 使用例(歩行アニメーション)
@@ -63,10 +65,13 @@
  * walkAnim.loop = true;
  * @endcode
  *
+ * @see SpriteSheetAnimation アトラスのUV矩形で切り替える版(インスタンス描画にまとまる)
  * @see UVAnimation UVスクロールアニメーション
  * @author 山内陽
  */
-struct SpriteAnimation : Behaviour {
+struct SpriteAnimation : IComponent {
+    static constexpr size_t NOT_APPLIED = static_cast<size_t>(-1);
+
     std::vector<TextureManager::TextureHandle> frames;  ///< アニメーションフレーム(テクスチャ配列)
     float frameTime = 0.1f;   ///< 1フレームの表示時間(秒)
     bool loop = true;         ///< ループ再生するか
@@ -75,54 +80,14 @@ struct SpriteAnimation : Behaviour {
     float currentTime = 0.0f;   ///< 内部時間(触らなくてOK)
     size_t currentFrame = 0;    ///< 現在のフレーム番号
     bool finished = false;      ///< アニメーション終了フラグ
-
-    /**
-     * @brief 毎フレーム更新処理
-     * @param[in,out] w ワールド参照
-     * @param[in] self このコンポーネントが付いているエンティティ
-     * @param[in] dt デルタタイム
-     *
-     * @details
-     * 時間を加算し、frameTimeを超えたら次のフレームに進みます。
-     * ループが無効で最後のフレームに達したら再生を停止します。
-     */
-    void OnUpdate(World& w, Entity self, float dt) override {
-        if (!playing || frames.empty()) return;
-
-        currentTime += dt;
-
-        // フレーム切り替え
-        if (currentTime >= frameTime) {
-            currentTime -= frameTime;
-            currentFrame++;
-
-            if (currentFrame >= frames.size()) {
-                if (loop) {
-                    currentFrame = 0;
-                } else {
-                    currentFrame = frames.size() - 1;
-                    playing = false;
-                    finished = true;
-                }
-            }
-        }
-    }
+    size_t appliedFrame = NOT_APPLIED; ///< MeshRenderer に反映したフレーム(SpriteAnimationSystem が使用)
 
     /**
      * @brief 現在のテクスチャを取得
      * @return TextureManager::TextureHandle 現在表示すべきテクスチャ
      *
      * @details
-     * MeshRendererに設定するテクスチャを取得します。
-     *
-     * @par 使用例
-     * @code
-     * auto* renderer = world.TryGet<MeshRenderer>(entity);
-     * auto* anim = world.TryGet<SpriteAnimation>(entity);
-     * if (renderer && anim) {
-     *     renderer->texture = anim->GetCurrentTexture();
-     * }
-     * @endcode
+     * SpriteAnimationSystem が MeshRenderer に設定するテクスチャです。
      */
     TextureManager::TextureHandle GetCurrentTexture() const {
         if (frames.empty()) return TextureManager::INVALID_TEXTURE;
@@ -135,6 +100,8 @@ struct SpriteAnimation : Behaviour {
      * @details
      * 停止していたアニメーションを再開します。
      * finishedフラグもリセットされます。
+     *
+     * @note システムが無効化したコンポーネントは再開されません。SpriteAnimationSystem::Play() を使用してください
      */
     void Play() {
         playing = true;
@@ -157,7 +124,76 @@ struct SpriteAnimation : Behaviour {
      *
      * @details
      * 最初のフレームに戻り、時間もリセットします。
-     * 再生状態は変更されません。
+     * 再生状態は変更されません(MeshRenderer への反映は次の更新で行います)。
+     */
+    void Reset() {
+        currentFrame = 0;
+        currentTime = 0.0f;
+        finished = false;
+    }
+};
+
+/**
+ * @struct SpriteSheetAnimation
+ * @brief アトラステクスチャのUV矩形を切り替えるスプライトアニメーション
+ *
+ * @details
+ * SpriteAnimation と同じ再生制御で、フレームをテクスチャではなくアトラス内のUV矩形で表します。
+ * フレームが変わると SpriteAnimationSystem が同じエンティティの MeshRenderer の texture / uvOffset / uvScale を書き換えます。
+ * テクスチャが全フレームで同じなので、表示中のフレームが違うスプライトも1回のインスタンス描画にまとまります。
+ *
+ * @par 使用例
+ * @code
+ * SpriteSheetAnimation walk;
+ * walk.atlas = texManager.CreateAtlasFromFiles({ "walk1.png", "walk2.png", "walk3.png", "walk4.png" }, walk.frames);
+ * walk.frameTime = 0.15f;
+ * world.Add<SpriteSheetAnimation>(entity, walk);  // MeshRenderer も必要
+ * @endcode
+ *
+ * @see SpriteAnimation テクスチャを切り替える版
+ * @see TextureManager::CreateAtlasFromFiles アトラスの作成
+ * @author 山内陽
+ */
+struct SpriteSheetAnimation : IComponent {
+    static constexpr size_t NOT_APPLIED = static_cast<size_t>(-1);
+
+    TextureManager::TextureHandle atlas = TextureManager::INVALID_TEXTURE; ///< アトラステクスチャ
+    std::vector<AtlasRect> frames;  ///< アニメーションフレーム(アトラス内のUV矩形)
+    float frameTime = 0.1f;   ///< 1フレームの表示時間(秒)
+    bool loop = true;         ///< ループ再生するか
+    bool playing = true;      ///< 再生中か
+
+    float currentTime = 0.0f;   ///< 内部時間(触らなくてOK)
+    size_t currentFrame = 0;    ///< 現在のフレーム番号
+    bool finished = false;      ///< アニメーション終了フラグ
+    size_t appliedFrame = NOT_APPLIED; ///< MeshRenderer に反映したフレーム(SpriteAnimationSystem が使用)
+
+    /**
+     * @brief 現在のフレームのUV矩形(フレームがなければ nullptr)
+     */
+    const AtlasRect* GetCurrentRect() const {
+        if (frames.empty()) return nullptr;
+        return &frames[currentFrame];
+    }
+
+    /**
+     * @brief アニメーションを再生(finishedフラグもリセット)
+     * @note システムが無効化したコンポーネントは再開されません。SpriteAnimationSystem::Play() を使用してください
+     */
+    void Play() {
+        playing = true;
+        finished = false;
+    }
+
+    /**
+     * @brief アニメーションを停止(現在のフレームは保持)
+     */
+    void Stop() {
+        playing = false;
+    }
+
+    /**
+     * @brief 最初のフレームに戻す(MeshRenderer への反映は次の更新で行う)
      */
     void Reset() {
         currentFrame = 0;
@@ -177,6 +213,8 @@ struct SpriteAnimation : Behaviour {
  * ### UVスクロールとは:
  * テクスチャの表示位置(UV座標)をずらすことで、
  * テクスチャが移動しているように見せる技術です。
+ * SpriteAnimationSystem が毎ステップ currentOffset を進め、MeshRenderer::uvOffset に書き込みます。
+ * 止める場合は World::SetEnabled<UVAnimation>(entity, false) で無効化します。
  *
  * @par 使用例(横にスクロール)
  * @code
@@ -190,15 +228,6 @@ struct SpriteAnimation : Behaviour {
  * world.Add<UVAnimation>(entity, UVAnimation{0.5f, 0.0f});
  * @endcode
  *
- * @par 使用例(MeshRendererに反映)
- * @code
- * auto* uv = world.TryGet<UVAnimation>(entity);
- * auto* renderer = world.TryGet<MeshRenderer>(entity);
- * if (uv && renderer) {
- *     renderer->uvOffset = uv->currentOffset;
- * }
- * @endcode
- *
  * @par 使用例(流れる水)
  * @code
  * // 水のテクスチャをゆっくり斜めに流す
@@ -209,7 +238,7 @@ struct SpriteAnimation : Behaviour {
  * @see SpriteAnimation スプライトアニメーション
  * @author 山内陽
  */
-struct UVAnimation : Behaviour {
+struct UVAnimation : IComponent {
     DirectX::XMFLOAT2 scrollSpeed{ 0.0f, 0.0f };   ///< UV座標のスクロール速度(単位/秒)
     DirectX::XMFLOAT2 currentOffset{ 0.0f, 0.0f }; ///< 現在のオフセット(自動更新)
 
@@ -243,36 +272,4 @@ struct UVAnimation : Behaviour {
      * @endcode
      */
     UVAnimation(float u, float v) : scrollSpeed{u, v} {}
-
-    /**
-     * @brief 毎フレーム更新処理
-     * @param[in,out] w ワールド参照
-     * @param[in] self このコンポーネントが付いているエンティティ
-     * @param[in] dt デルタタイム
-     *
-     * @details
-     * スクロール量を加算し、0-1の範囲に正規化します。
-     * 正規化することで、数値が無限に大きくなることを防ぎます。
-     *
-     * @par 処理の詳細:
-     * @code
-     * // 例: scrollSpeed = {0.5, 0.0}, dt = 0.016(60FPS)
-     * currentOffset.x += 0.5 * 0.016 = 0.008加算
-     *
-     * // 1.0を超えたら引き算(テクスチャは繰り返すため)
-     * if (currentOffset.x >= 1.0f) currentOffset.x -= 1.0f;
-     * @endcode
-     */
-    void OnUpdate(World& w, Entity self, float dt) override {
-        // スクロール量を加算
-        currentOffset.x += scrollSpeed.x * dt;
-        currentOffset.y += scrollSpeed.y * dt;
-
-        // 0-1範囲に正規化(繰り返し)
-        currentOffset.x = fmodf(currentOffset.x, 1.0f);
-        currentOffset.y = fmodf(currentOffset.y, 1.0f);
-
-        if (currentOffset.x < 0.0f) currentOffset.x += 1.0f;
-        if (currentOffset.y < 0.0f) currentOffset.y += 1.0f;
-    }
 };
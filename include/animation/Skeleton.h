@@ -0,0 +1,423 @@
+/**
+ * @file Skeleton.h
+ * @brief スケルトン・圧縮したアニメーションクリップ・ポーズの評価(スキニング用)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ModelLoader が Assimp のボーンとアニメーションから作るデータと、それを評価する関数をまとめます。
+ * - Skeleton: 関節の親子関係(親が必ず先に並ぶ)・バインドポーズ・逆バインド行列
+ * - AnimationClip: 一定のサンプリング周期で再標本化したキーフレーム。回転は SHORTN4、
+ *   平行移動と拡大縮小はクリップの範囲に対する USHORTN4 に量子化します(1関節1フレーム 40 → 24バイト、
+ *   拡大縮小がない場合は 16バイト)。フレームごとに全関節を並べるため、2フレームの補間は連続した読み込みです。
+ * - Pose: 関節ごとの回転・平行移動・拡大縮小を要素ごとの配列(SoA)に持ち、補間とブレンドは
+ *   DirectXMath のベクトル演算(nlerp)で行います。
+ * - SkinInfluence: 頂点ごとの影響を4つまでに絞った関節番号(uint8)と重み(UNORM8)。
+ *
+ * ComputeSkinningPalette() は逆バインド行列 × モデル空間の関節の行列を転置して書き出し、
+ * 頂点シェーダー(RenderSystem の SKINNED バリアント)が構造化バッファとして読みます。
+ */
+#pragma once
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct SkinInfluence
+ * @brief 頂点1つ分のスキニングの影響(頂点バッファの2本目のストリーム、8バイト)
+ *
+ * @details
+ * 重みは合計がちょうど 255 になるように量子化します(シェーダーでは UNORM として 0～1 で読む)。
+ */
+struct SkinInfluence {
+    static constexpr int MAX_INFLUENCES = 4; ///< 頂点あたりの影響の最大数
+
+    uint8_t joints[MAX_INFLUENCES] = { 0, 0, 0, 0 };    ///< 関節番号(Skeleton の添字)
+    uint8_t weights[MAX_INFLUENCES] = { 255, 0, 0, 0 }; ///< 重み(UNORM8)
+
+    /**
+     * @struct Accumulator
+     * @brief 影響を集めて大きい順に4つまで残す(読み込み時の作業用)
+     */
+    struct Accumulator {
+        uint8_t joints[MAX_INFLUENCES] = { 0, 0, 0, 0 };
+        float weights[MAX_INFLUENCES] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        /**
+         * @brief 影響を追加(4つを超える場合は最も小さいものと入れ替える)
+         */
+        void Add(uint8_t joint, float weight) {
+            if (!(weight > 0.0f)) return;
+            int smallest = 0;
+            for (int i = 1; i < MAX_INFLUENCES; ++i) {
+                if (weights[i] < weights[smallest]) smallest = i;
+            }
+            if (weight <= weights[smallest]) return;
+            joints[smallest] = joint;
+            weights[smallest] = weight;
+        }
+
+        /**
+         * @brief 重みを正規化して量子化(影響がない頂点は関節0に固定)
+         */
+        SkinInfluence Pack() const {
+            SkinInfluence out;
+            const float total = weights[0] + weights[1] + weights[2] + weights[3];
+            if (!(total > 0.0f)) return out;
+
+            int largest = 0;
+            int sum = 0;
+            for (int i = 0; i < MAX_INFLUENCES; ++i) {
+                out.joints[i] = joints[i];
+                out.weights[i] = static_cast<uint8_t>(std::lround(weights[i] / total * 255.0f));
+                sum += out.weights[i];
+                if (weights[i] > weights[largest]) largest = i;
+            }
+            // 丸めの誤差は最大の重みで吸収する(合計を 255 に揃える)
+            out.weights[largest] = static_cast<uint8_t>(out.weights[largest] + (255 - sum));
+            return out;
+        }
+    };
+};
+static_assert(sizeof(SkinInfluence) == 8, "SkinInfluence must match the skinned input layout");
+
+/**
+ * @struct Skeleton
+ * @brief 関節の階層とバインドポーズ
+ *
+ * @details
+ * parents[i] < i (ルートは -1) の順に並べるため、先頭から1回走査すればモデル空間の行列が求まります。
+ * 行列はすべて DirectXMath の行ベクトルの規約(転置前)です。
+ */
+struct Skeleton {
+    static constexpr size_t MAX_JOINTS = 256; ///< SkinInfluence の関節番号(uint8)で表せる数
+
+    std::vector<std::string> names;                   ///< 関節名(Assimp のノード名)
+    std::vector<int16_t> parents;                     ///< 親の関節番号(ルートは -1)
+    std::vector<DirectX::XMFLOAT4X4> inverseBind;     ///< 逆バインド行列(メッシュ空間 → 関節空間、ボーンでない関節は単位行列)
+    std::vector<DirectX::XMFLOAT4> bindRotations;     ///< バインドポーズの回転(クォータニオン、親空間)
+    std::vector<DirectX::XMFLOAT3> bindTranslations;  ///< バインドポーズの平行移動(親空間)
+    std::vector<DirectX::XMFLOAT3> bindScales;        ///< バインドポーズの拡大縮小(親空間)
+    DirectX::XMFLOAT4X4 rootInverse{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }; ///< ルートの変換の逆(バインドポーズのパレットを単位行列にする)
+
+    size_t JointCount() const { return parents.size(); }
+
+    /**
+     * @brief 関節名から番号を引く(ない場合 -1)
+     */
+    int Find(const std::string& name) const {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    /**
+     * @brief 関節を追加(親は先に追加済みであること)
+     * @param[in] localBind 親空間のバインドポーズ(行ベクトルの規約)
+     */
+    int AddJoint(const std::string& name, int parent, const DirectX::XMMATRIX& localBind, const DirectX::XMFLOAT4X4& inverseBindMatrix) {
+        using namespace DirectX;
+        XMVECTOR scale, rotation, translation;
+        if (!XMMatrixDecompose(&scale, &rotation, &translation, localBind)) {
+            scale = XMVectorSplatOne();
+            rotation = XMQuaternionIdentity();
+            translation = localBind.r[3];
+        }
+        names.push_back(name);
+        parents.push_back(static_cast<int16_t>(parent));
+        inverseBind.push_back(inverseBindMatrix);
+        bindRotations.emplace_back();
+        bindTranslations.emplace_back();
+        bindScales.emplace_back();
+        XMStoreFloat4(&bindRotations.back(), rotation);
+        XMStoreFloat3(&bindTranslations.back(), translation);
+        XMStoreFloat3(&bindScales.back(), scale);
+        return static_cast<int>(parents.size() - 1);
+    }
+};
+
+/**
+ * @struct Pose
+ * @brief 関節ごとの親空間の変換(SoA、16バイト境界)
+ */
+struct Pose {
+    std::vector<DirectX::XMFLOAT4A> rotations;    ///< クォータニオン
+    std::vector<DirectX::XMFLOAT4A> translations; ///< xyz(w は未使用)
+    std::vector<DirectX::XMFLOAT4A> scales;       ///< xyz(w は未使用)
+
+    size_t JointCount() const { return rotations.size(); }
+
+    void Resize(size_t joints) {
+        rotations.resize(joints);
+        translations.resize(joints);
+        scales.resize(joints);
+    }
+
+    /**
+     * @brief バインドポーズを設定
+     */
+    void SetBindPose(const Skeleton& skeleton) {
+        const size_t n = skeleton.JointCount();
+        Resize(n);
+        for (size_t j = 0; j < n; ++j) {
+            const DirectX::XMFLOAT4& r = skeleton.bindRotations[j];
+            const DirectX::XMFLOAT3& t = skeleton.bindTranslations[j];
+            const DirectX::XMFLOAT3& s = skeleton.bindScales[j];
+            rotations[j] = DirectX::XMFLOAT4A(r.x, r.y, r.z, r.w);
+            translations[j] = DirectX::XMFLOAT4A(t.x, t.y, t.z, 0.0f);
+            scales[j] = DirectX::XMFLOAT4A(s.x, s.y, s.z, 0.0f);
+        }
+    }
+};
+
+/**
+ * @class AnimationClip
+ * @brief 量子化したキーフレーム(一定周期で再標本化済み)
+ *
+ * @details
+ * キーは frame * JointCount() + joint の順に並びます。平行移動と拡大縮小はクリップ全体の
+ * 最小値と幅に対する 0～1 の USHORTN4 で、拡大縮小がすべて 1 のクリップは scaleKeys_ を持ちません。
+ */
+class AnimationClip {
+public:
+    static constexpr float DEFAULT_SAMPLE_RATE = 30.0f; ///< 読み込み時の既定のサンプリング周波数(Hz)
+
+    /**
+     * @brief 浮動小数点のキーを量子化してクリップを作成
+     * @param[in] rotations / translations / scales frameCount * jointCount 個のキー(フレームごとに全関節)
+     */
+    static AnimationClip Compress(const std::string& name, float sampleRate, uint32_t frameCount, uint32_t jointCount,
+                                  const std::vector<DirectX::XMFLOAT4>& rotations,
+                                  const std::vector<DirectX::XMFLOAT3>& translations,
+                                  const std::vector<DirectX::XMFLOAT3>& scales) {
+        using namespace DirectX;
+        using namespace DirectX::PackedVector;
+        AnimationClip clip;
+        clip.name_ = name;
+        clip.sampleRate_ = sampleRate > 0.0f ? sampleRate : DEFAULT_SAMPLE_RATE;
+        clip.frameCount_ = std::max<uint32_t>(frameCount, 1);
+        clip.jointCount_ = jointCount;
+        clip.duration_ = static_cast<float>(clip.frameCount_ - 1) / clip.sampleRate_;
+
+        const size_t keys = static_cast<size_t>(clip.frameCount_) * jointCount;
+        if (rotations.size() < keys || translations.size() < keys || scales.size() < keys) {
+            clip.frameCount_ = 0;
+            return clip;
+        }
+
+        clip.rotationKeys_.resize(keys);
+        for (size_t k = 0; k < keys; ++k) {
+            XMStoreShortN4(&clip.rotationKeys_[k], XMQuaternionNormalize(XMLoadFloat4(&rotations[k])));
+        }
+
+        clip.translationRange_ = ComputeRange(translations, keys);
+        clip.translationKeys_.resize(keys);
+        for (size_t k = 0; k < keys; ++k) {
+            clip.translationKeys_[k] = Quantize(translations[k], clip.translationRange_);
+        }
+
+        bool hasScale = false;
+        for (size_t k = 0; k < keys && !hasScale; ++k) {
+            hasScale = std::fabs(scales[k].x - 1.0f) > 1e-4f || std::fabs(scales[k].y - 1.0f) > 1e-4f || std::fabs(scales[k].z - 1.0f) > 1e-4f;
+        }
+        if (hasScale) {
+            clip.scaleRange_ = ComputeRange(scales, keys);
+            clip.scaleKeys_.resize(keys);
+            for (size_t k = 0; k < keys; ++k) {
+                clip.scaleKeys_[k] = Quantize(scales[k], clip.scaleRange_);
+            }
+        }
+        return clip;
+    }
+
+    const std::string& Name() const { return name_; }
+    float Duration() const { return duration_; }
+    float SampleRate() const { return sampleRate_; }
+    uint32_t FrameCount() const { return frameCount_; }
+    uint32_t JointCount() const { return jointCount_; }
+    bool IsValid() const { return frameCount_ > 0 && jointCount_ > 0; }
+
+    /**
+     * @brief キーフレームのバイト数(圧縮後)
+     */
+    size_t KeyBytes() const {
+        return rotationKeys_.size() * sizeof(rotationKeys_[0]) + translationKeys_.size() * sizeof(translationKeys_[0]) +
+               scaleKeys_.size() * sizeof(scaleKeys_[0]);
+    }
+
+    /**
+     * @brief 再生位置をクリップの範囲に収める(ループは剰余、それ以外は端で止める)
+     */
+    float WrapTime(float time, bool loop) const {
+        if (duration_ <= 0.0f) return 0.0f;
+        if (!loop) return std::min(std::max(time, 0.0f), duration_);
+        if (time >= 0.0f && time < duration_) return time;
+        return time - duration_ * std::floor(time / duration_);
+    }
+
+    /**
+     * @brief 時刻 time のポーズを out に書き込む(隣り合う2フレームを nlerp で補間)
+     * @param[in] time WrapTime() 済みの再生位置(秒)
+     * @param[in] loop true の場合、最後のフレームと最初のフレームの間も補間する
+     */
+    void Sample(float time, bool loop, Pose& out) const {
+        using namespace DirectX;
+        using namespace DirectX::PackedVector;
+        out.Resize(jointCount_);
+        if (!IsValid()) return;
+
+        const float frame = std::max(0.0f, time * sampleRate_);
+        uint32_t f0 = static_cast<uint32_t>(frame);
+        float t = frame - static_cast<float>(f0);
+        if (f0 >= frameCount_ - 1) {
+            f0 = frameCount_ - 1;
+            t = loop ? t : 0.0f;
+        }
+        const uint32_t f1 = f0 + 1 < frameCount_ ? f0 + 1 : (loop ? 0 : f0);
+
+        const XMVECTOR weight = XMVectorReplicate(t);
+        const XMVECTOR translationMin = XMLoadFloat4(&translationRange_.minimum);
+        const XMVECTOR translationExtent = XMLoadFloat4(&translationRange_.extent);
+        const XMVECTOR scaleMin = XMLoadFloat4(&scaleRange_.minimum);
+        const XMVECTOR scaleExtent = XMLoadFloat4(&scaleRange_.extent);
+        const bool hasScale = !scaleKeys_.empty();
+        const size_t base0 = static_cast<size_t>(f0) * jointCount_;
+        const size_t base1 = static_cast<size_t>(f1) * jointCount_;
+
+        for (uint32_t j = 0; j < jointCount_; ++j) {
+            const XMVECTOR q0 = XMLoadShortN4(&rotationKeys_[base0 + j]);
+            XMVECTOR q1 = XMLoadShortN4(&rotationKeys_[base1 + j]);
+            q1 = XMVectorSelect(q1, XMVectorNegate(q1), XMVectorLess(XMVector4Dot(q0, q1), XMVectorZero()));
+            XMStoreFloat4A(&out.rotations[j], XMQuaternionNormalize(XMVectorLerpV(q0, q1, weight)));
+
+            const XMVECTOR t0 = XMVectorMultiplyAdd(XMLoadUShortN4(&translationKeys_[base0 + j]), translationExtent, translationMin);
+            const XMVECTOR t1 = XMVectorMultiplyAdd(XMLoadUShortN4(&translationKeys_[base1 + j]), translationExtent, translationMin);
+            XMStoreFloat4A(&out.translations[j], XMVectorLerpV(t0, t1, weight));
+
+            if (hasScale) {
+                const XMVECTOR s0 = XMVectorMultiplyAdd(XMLoadUShortN4(&scaleKeys_[base0 + j]), scaleExtent, scaleMin);
+                const XMVECTOR s1 = XMVectorMultiplyAdd(XMLoadUShortN4(&scaleKeys_[base1 + j]), scaleExtent, scaleMin);
+                XMStoreFloat4A(&out.scales[j], XMVectorLerpV(s0, s1, weight));
+            } else {
+                XMStoreFloat4A(&out.scales[j], XMVectorSplatOne());
+            }
+        }
+    }
+
+private:
+    /**
+     * @struct Range
+     * @brief 量子化の範囲(xyz、w は未使用)
+     */
+    struct Range {
+        DirectX::XMFLOAT4 minimum{ 0.0f, 0.0f, 0.0f, 0.0f };
+        DirectX::XMFLOAT4 extent{ 1.0f, 1.0f, 1.0f, 0.0f };
+    };
+
+    static Range ComputeRange(const std::vector<DirectX::XMFLOAT3>& values, size_t count) {
+        using namespace DirectX;
+        XMVECTOR lo = XMVectorReplicate(FLT_MAX);
+        XMVECTOR hi = XMVectorReplicate(-FLT_MAX);
+        for (size_t k = 0; k < count; ++k) {
+            const XMVECTOR v = XMLoadFloat3(&values[k]);
+            lo = XMVectorMin(lo, v);
+            hi = XMVectorMax(hi, v);
+        }
+        // 幅が 0 の成分は 1 にして割り算を避ける(量子化した値は常に 0)
+        XMVECTOR extent = XMVectorSubtract(hi, lo);
+        extent = XMVectorSelect(extent, XMVectorSplatOne(), XMVectorLess(extent, XMVectorReplicate(1e-6f)));
+        Range range;
+        XMStoreFloat4(&range.minimum, XMVectorSetW(lo, 0.0f));
+        XMStoreFloat4(&range.extent, XMVectorSetW(extent, 0.0f));
+        return range;
+    }
+
+    static DirectX::PackedVector::XMUSHORTN4 Quantize(const DirectX::XMFLOAT3& value, const Range& range) {
+        using namespace DirectX;
+        PackedVector::XMUSHORTN4 packed;
+        const XMVECTOR n = XMVectorDivide(XMVectorSubtract(XMLoadFloat3(&value), XMLoadFloat4(&range.minimum)), XMLoadFloat4(&range.extent));
+        PackedVector::XMStoreUShortN4(&packed, XMVectorSetW(n, 0.0f));
+        return packed;
+    }
+
+    std::string name_;
+    float sampleRate_ = DEFAULT_SAMPLE_RATE;
+    float duration_ = 0.0f;
+    uint32_t frameCount_ = 0;
+    uint32_t jointCount_ = 0;
+    Range translationRange_;
+    Range scaleRange_;
+    std::vector<DirectX::PackedVector::XMSHORTN4> rotationKeys_;   ///< 回転(クォータニオン)
+    std::vector<DirectX::PackedVector::XMUSHORTN4> translationKeys_; ///< 平行移動(translationRange_ に対する割合)
+    std::vector<DirectX::PackedVector::XMUSHORTN4> scaleKeys_;     ///< 拡大縮小(空の場合はすべて 1)
+};
+
+/**
+ * @struct SkinnedModelData
+ * @brief 1つのモデルファイルのスケルトンとクリップ(メッシュ間で共有、読み込み後は不変)
+ */
+struct SkinnedModelData {
+    Skeleton skeleton;
+    std::vector<AnimationClip> clips;
+
+    /**
+     * @brief クリップ名から番号を引く(ない場合 -1)
+     */
+    int FindClip(const std::string& name) const {
+        for (size_t i = 0; i < clips.size(); ++i) {
+            if (clips[i].Name() == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+namespace SkeletalAnimation {
+
+/**
+ * @brief pose を target に向けて weight の割合でブレンド(回転は nlerp、結果は pose に上書き)
+ */
+inline void BlendPoses(Pose& pose, const Pose& target, float weight) {
+    using namespace DirectX;
+    const size_t n = std::min(pose.JointCount(), target.JointCount());
+    const XMVECTOR w = XMVectorReplicate(std::min(std::max(weight, 0.0f), 1.0f));
+    for (size_t j = 0; j < n; ++j) {
+        const XMVECTOR q0 = XMLoadFloat4A(&pose.rotations[j]);
+        XMVECTOR q1 = XMLoadFloat4A(&target.rotations[j]);
+        q1 = XMVectorSelect(q1, XMVectorNegate(q1), XMVectorLess(XMVector4Dot(q0, q1), XMVectorZero()));
+        XMStoreFloat4A(&pose.rotations[j], XMQuaternionNormalize(XMVectorLerpV(q0, q1, w)));
+        XMStoreFloat4A(&pose.translations[j], XMVectorLerpV(XMLoadFloat4A(&pose.translations[j]), XMLoadFloat4A(&target.translations[j]), w));
+        XMStoreFloat4A(&pose.scales[j], XMVectorLerpV(XMLoadFloat4A(&pose.scales[j]), XMLoadFloat4A(&target.scales[j]), w));
+    }
+}
+
+/**
+ * @brief スキニング行列のパレットを計算(頂点シェーダー用に転置して書き出す)
+ * @param[in] modelScratch 関節数以上の作業領域(モデル空間の行列)
+ * @param[out] palette 関節数分の 逆バインド行列 × モデル空間の行列 × rootInverse(転置済み)
+ */
+inline void ComputeSkinningPalette(const Skeleton& skeleton, const Pose& pose, DirectX::XMFLOAT4X4A* modelScratch, DirectX::XMFLOAT4X4* palette) {
+    using namespace DirectX;
+    const size_t n = std::min(skeleton.JointCount(), pose.JointCount());
+    const XMMATRIX rootInverse = XMLoadFloat4x4(&skeleton.rootInverse);
+    for (size_t j = 0; j < n; ++j) {
+        const XMVECTOR s = XMLoadFloat4A(&pose.scales[j]);
+        const XMVECTOR r = XMLoadFloat4A(&pose.rotations[j]);
+        const XMVECTOR t = XMLoadFloat4A(&pose.translations[j]);
+        XMMATRIX model = XMMatrixAffineTransformation(s, XMVectorZero(), r, t);
+        const int parent = skeleton.parents[j];
+        if (parent >= 0) model = XMMatrixMultiply(model, XMLoadFloat4x4A(&modelScratch[parent]));
+        XMStoreFloat4x4A(&modelScratch[j], model);
+
+        const XMMATRIX skin = XMMatrixMultiply(XMMatrixMultiply(XMLoadFloat4x4(&skeleton.inverseBind[j]), model), rootInverse);
+        XMStoreFloat4x4(&palette[j], XMMatrixTranspose(skin));
+    }
+}
+
+} // namespace SkeletalAnimation
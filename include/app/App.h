@@ -3,7 +3,7 @@
  * @brief ミニゲームのメインアプリケーションクラス
  * @author 山内 陽
  * @date 2025
- * @version 5.1
+ * @version 5.14
  */
 #pragma once
 // ========================================================
@@ -14,6 +14,7 @@
 #define NOMINMAX
 
 #include <Windows.h>
+#include <mfapi.h>
 #include <DirectXMath.h>
 #include <chrono>
 #include <sstream>
@@ -22,6 +23,10 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <cwchar>
+#include <iterator>
+
+#pragma comment(lib, "mfplat.lib")
 
 // DirectX11 & ECS システム
 #include "graphics/GfxDevice.h"
@@ -29,13 +34,44 @@
 #include "ecs/World.h"
 #include "graphics/Camera.h"
 #include "input/InputSystem.h"
+#include "input/InputSampler.h"
+#include "input/InputActions.h"
+#include "input/InputReplay.h"
+#include "util/Random.h"
 #include "graphics/TextureManager.h"
+#include "graphics/MaterialManager.h"
 #include "graphics/DebugDraw.h"
+#include "graphics/SpriteBatch.h"
+#include "graphics/PerfOverlay.h"
+#include "graphics/DynamicResolution.h"
 #include "app/ResourceManager.h"
 #include "app/ServiceLocator.h"
+#include "app/JobSystem.h"
+#include "app/ThreadPlacement.h"
+#include "app/StartupTasks.h"
+#include "app/StartupReport.h"
+#include "systems/MovementSystem.h"
+#include "systems/GpuMoverSystem.h"
+#include "systems/ScriptSystem.h"
+#include "systems/AnimationSystem.h"
+#include "systems/SpriteAnimationSystem.h"
+#include "systems/TransformSystem.h"
+#include "systems/SpatialHashGrid.h"
+#include "systems/CollisionSystem.h"
+#include "graphics/RenderSnapshot.h"
+#include "app/SimulationThread.h"
+#include "app/AssetBenchmark.h"
+#include "app/HeadlessRun.h"
+#include "app/ScenarioBenchmark.h"
+#include "app/QualityGovernor.h"
 
 #ifdef _DEBUG
 #include "app/DebugLog.h"
+#include "app/Profiler.h"
+#include "app/Telemetry.h"
+#include "app/FrameHistogram.h"
+#include "app/FrameArena.h"
+#include "app/MemoryTracker.h"
 #endif
 
 // コンポーネント
@@ -45,6 +81,8 @@
 // ゲームシステム
 #include "scenes/SceneManager.h"
 #include "scenes/Game.h"
+#include "scenes/RenderBenchmarkScene.h"
+#include "scenes/CrowdBenchmarkScene.h"
 
 /**
  * @struct App
@@ -56,29 +94,79 @@
 struct App {
     // Windows関連
     HWND hwnd_ = nullptr; ///< メインウィンドウのハンドル
+    uint32_t pendingWidth_ = 0;   ///< WM_SIZE で受けたクライアント領域の幅
+    uint32_t pendingHeight_ = 0;  ///< WM_SIZE で受けたクライアント領域の高さ
+    bool resizePending_ = false;  ///< 次のフレームの前に ApplyResize() するか
+    bool firstFrameLogged_ = false; ///< 起動時間の内訳（StartupReport）を書き出したか
 
     // DirectX11システム
     GfxDevice gfx_; ///< グラフィックスデバイス
     RenderSystem renderer_; ///< 描画システム
     TextureManager texManager_; ///< テクスチャ管理
+    MaterialManager materials_; ///< マテリアル管理
     ResourceManager resManager_; ///< リソース管理
+    bool mediaFoundationStarted_ = false; ///< 起動時に MFStartup() したか（Shutdown() で MFShutdown()）
 
     // ECSシステム
+    JobSystem jobs_; ///< ワーカースレッドプール(World::ParallelForEach用)
     World world_; ///< ECSワールド
+    ScriptLibrary scripts_; ///< ゲームプレイのスクリプト(ScriptSystem が実行)
     Camera camera_; ///< カメラ
     InputSystem input_; ///< 入力システム
     GamepadSystem gamepad_; ///< ゲームパッド入力システム
+    InputActions actions_; ///< アクション・軸の割り当てと評価済みの状態
+    InputSampler inputSampler_; ///< 高頻度の入力スレッド(`--input-thread` 時のみ起動)
+    uint32_t inputSampleRateHz_ = 0; ///< 入力スレッドの周波数(0 は使わない)
+    ThreadPlacementConfig threadPlacement_; ///< ワーカー数・コアの予約・アフィニティ(既定は OS の配置)
+    InputReplayConfig replayConfig_; ///< `--record-input` / `--replay-input` の設定
+    InputReplay inputReplay_; ///< 入力の記録・再生
+    uint64_t simulationSeed_ = 0; ///< 固定した乱数のシード(記録・再生、`--bench`)
+    bool simulationSeedPending_ = false; ///< 最初のステップでシミュレーションのスレッドの乱数を simulationSeed_ で初期化するか
 
     // シーン管理
     SceneManager sceneManager_; ///< シーンマネージャー
+    std::unique_ptr<RenderBenchmark> renderBenchmark_; ///< `--render-benchmark` 時の計測(それ以外は nullptr)
+    std::unique_ptr<HeadlessRun> headless_; ///< `--headless` 時の計測(それ以外は nullptr)
+    std::unique_ptr<ScenarioBenchmark> scenarioBenchmark_; ///< `--bench` 時のシナリオと計測(それ以外は nullptr)
+    std::unique_ptr<RenderBenchmark> replayBenchmark_; ///< `--replay-capture` 時の計測(それ以外は nullptr)
+    std::string replayCapturePath_; ///< `--replay-capture` で再生する FrameCapture のファイル
 
 #ifdef _DEBUG
     DebugDraw debugDraw_; ///< デバッグ描画用
 #endif
+    SpriteBatch sprites_; ///< Sprite コンポーネントと PerfOverlay の四角形をまとめて描く2Dバッチ
+    PerfOverlay perfOverlay_; ///< 性能のオーバーレイ（F3 で表示を切り替え、リリースビルドでも使用可）
+    DynamicResolution dynamicResolution_; ///< GPU時間からシーンの描画解像度を決める（F2 で切り替え、既定は無効）
+    QualityGovernor qualityGovernor_; ///< CPU・GPU時間から品質の段階を決める（`--frame-budget` で有効、既定は無効）
+    float frameBudgetMs_ = -1.0f; ///< `--frame-budget` の目標（0 はリフレッシュ間隔、負は無効）
 
     void InitializeGame() {
         DEBUGLOG("InitializeGame() begin");
 
+        if (scenarioBenchmark_) {
+            const ScenarioBenchmarkConfig& config = scenarioBenchmark_->Config();
+            if (!inputReplay_.IsReplaying() && !inputReplay_.IsRecording()) {
+                SeedSimulation(config.seed); // 記録・再生時は記録のシードのまま
+            }
+            if (ScenarioBenchmarkConfig::IsCrowdScenario(config.scenario)) {
+                sceneManager_.RegisterScene("Bench", std::make_unique<CrowdBenchmarkScene>(config));
+            } else if (config.scenario == "render") {
+                sceneManager_.RegisterScene("Bench", std::make_unique<RenderBenchmarkScene>(config.RenderConfig()));
+            } else {
+                sceneManager_.RegisterScene("Bench", std::make_unique<GameScene>());
+            }
+            sceneManager_.Init("Bench", world_);
+            DEBUGLOG("SceneManager initialised with benchmark scenario: " + config.scenario);
+            return;
+        }
+
+        if (renderBenchmark_) {
+            sceneManager_.RegisterScene("RenderBenchmark", std::make_unique<RenderBenchmarkScene>(renderBenchmark_->Config()));
+            sceneManager_.Init("RenderBenchmark", world_);
+            DEBUGLOG("SceneManager initialised with RenderBenchmark scene");
+            return;
+        }
+
         auto gameScene = std::make_unique<GameScene>();
         DEBUGLOG("GameScene instance created");
 
@@ -91,6 +179,91 @@ struct App {
         DEBUGLOG("InitializeGame() complete");
     }
 
+    /**
+     * @brief 品質のつまみを QualityGovernor に登録して有効にする(起動時の初期化の後)
+     *
+     * @details
+     * 見た目が変わりにくいものから順に登録します(この順に下げ、逆順に上げる)。
+     */
+    void InitializeQualityGovernor() {
+        using Cost = QualityGovernor::Cost;
+        qualityGovernor_.Register("particles", 3, Cost::Gpu, [this](uint32_t level) {
+            static const float DENSITY[] = { 1.0f, 0.5f, 0.25f };
+            renderer_.SetParticleDensity(DENSITY[level]);
+        });
+        const float shadowDistance = renderer_.GetShadowDistance();
+        qualityGovernor_.Register("shadows", 3, Cost::Both, [this, shadowDistance](uint32_t level) {
+            // 距離を縮めるとカスケードごとのキャスターが減り、最後の段階では影を描かない
+            renderer_.SetShadowDistance(level == 0 ? shadowDistance : shadowDistance * 0.5f);
+            renderer_.SetShadowsEnabled(level < 2);
+        });
+        qualityGovernor_.Register("lod", 3, Cost::Both, [this](uint32_t level) {
+            static const float SCALE[] = { 1.0f, 0.7f, 0.5f };
+            renderer_.SetLodScale(SCALE[level]);
+        });
+        qualityGovernor_.Register("textures", 3, Cost::Gpu, [this](uint32_t level) {
+            static const float SCALE[] = { 1.0f, 0.5f, 0.25f };
+            renderer_.SetTextureDetailScale(SCALE[level]);
+        });
+
+        qualityGovernor_.SetTargetMs(frameBudgetMs_ > 0.0f ? frameBudgetMs_ : 1000.0f / gfx_.RefreshRate());
+        qualityGovernor_.SetEnabled(true);
+        gfx_.Profiler().SetEnabled(true);
+        char line[128];
+        sprintf_s(line, "品質の予算: 目標 %.2fms, つまみ %zu 個", qualityGovernor_.TargetMs(), qualityGovernor_.Knobs().size());
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, line);
+    }
+
+    /**
+     * @brief `--replay-capture` の記録を読み込んで RenderSystem の再生を始める(シーンは開かない)
+     * @return bool 再生を始められた場合 true
+     */
+    bool InitializeFrameReplay() {
+        FrameCapture capture;
+        std::string error;
+        if (!capture.Load(replayCapturePath_, &error)) {
+            DEBUGLOG_ERROR("フレームの記録を読み込めません: " + replayCapturePath_ + " (" + error + ")");
+            return false;
+        }
+        if (capture.renderWidth != gfx_.RenderWidth() || capture.renderHeight != gfx_.RenderHeight()) {
+            DEBUGLOG_WARNING("記録時と描画解像度が異なります: " + std::to_string(capture.renderWidth) + "x" +
+                             std::to_string(capture.renderHeight) + " (GPU 時間は比較できません)");
+        }
+        return renderer_.BeginReplay(capture);
+    }
+
+    /**
+     * @brief `--record-input` / `--replay-input` の記録・再生を開始し、乱数のシードを設定(シーンの初期化より前)
+     */
+    void StartInputReplay() {
+        if (!replayConfig_.replayPath.empty()) {
+            if (!inputReplay_.StartReplay(replayConfig_.replayPath)) {
+                DEBUGLOG_WARNING("入力を再生できないため通常の入力で実行します");
+                return;
+            }
+            if (inputReplay_.FixedTimestep() != FIXED_TIMESTEP) {
+                DEBUGLOG_WARNING("記録時と固定ステップの長さが異なります (記録: " + std::to_string(inputReplay_.FixedTimestep()) + " 秒)");
+            }
+        } else if (!replayConfig_.recordPath.empty()) {
+            const uint64_t seed = replayConfig_.seed != 0 ? replayConfig_.seed : util::Random::NextSeed();
+            if (!inputReplay_.StartRecording(replayConfig_.recordPath, seed, FIXED_TIMESTEP)) return;
+        } else {
+            return;
+        }
+
+        SeedSimulation(inputReplay_.Seed());
+        gamepad_.SetFixedDeltaTime(FIXED_TIMESTEP);
+    }
+
+    /**
+     * @brief シーンの初期化(メインスレッド)と各ステップ(シミュレーションのスレッド)の乱数を seed から始める
+     */
+    void SeedSimulation(uint64_t seed) {
+        util::Random::Engine().Seed(seed);
+        simulationSeed_ = seed;
+        simulationSeedPending_ = true;
+    }
+
     // ========================================================
     // パフォーマンス計測
     // ========================================================
@@ -99,25 +272,285 @@ struct App {
         float renderTime = 0.0f;  ///< Render時間（秒）
         float presentTime = 0.0f; ///< Present時間（秒）
         float totalTime = 0.0f;   ///< 合計フレーム時間（秒）
+        // GPU時間（GfxDevice::Profiler()、数フレーム前の値。計測無効時は0）
+        float gpuTime = 0.0f;          ///< フレーム全体のGPU時間（秒）
+        float gpuInstancedTime = 0.0f; ///< MeshRendererのインスタンス描画（秒）
+        float gpuQueueTime = 0.0f;     ///< 描画キュー（深度プリパスを含む、秒）
+        float gpuDebugDrawTime = 0.0f; ///< DebugDraw（秒）
+        float gpuParticleTime = 0.0f;  ///< GPUパーティクルの更新と描画（秒）
+        float pacingWaitTime = 0.0f;   ///< 表示待ち（フレーム遅延待機オブジェクト + 固定レートのリミッター、秒）
+        float simulationSteps = 0.0f;  ///< このフレームで進めた固定ステップ数
     };
 
     FrameMetrics currentMetrics_;       ///< 現在のフレームメトリクス
-    FrameMetrics avgMetrics_;           ///< 平均メトリクス
-    int metricsFrameCount_ = 0;         ///< メトリクス計測フレーム数
-    const int metricsUpdateInterval_ = 30; ///< メトリクス更新間隔（フレーム）
+    FrameMetrics avgMetrics_;           ///< 表示の区間のメトリクスの合計（PublishFrameStats() で平均にしてリセット）
+    int metricsFrameCount_ = 0;         ///< 表示の区間のフレーム数
+
+    /**
+     * @struct DisplayedFrameStats
+     * @brief タイトルとオーバーレイに表示する統計（表示の間隔ごとに PublishFrameStats() が更新）
+     *
+     * @details
+     * 毎フレームは合計に足すだけで、平均・FPS・直近1秒の99%タイルは表示の間隔ごとに1回だけ求めます。
+     * 表示側はこの値を読むだけなので、1フレームの揺れではなく区間の平均を読める速さで表示します。
+     */
+    struct DisplayedFrameStats {
+        FrameMetrics average;      ///< 区間の平均（秒、simulationSteps はステップ数）
+        float fps = 0.0f;          ///< 区間の平均フレーム時間から求めた FPS
+        float frameP99Ms = 0.0f;   ///< 直近1秒のフレーム時間の99%タイル（ミリ秒）
+        int frames = 0;            ///< 区間のフレーム数（0 はまだ表示する値がない）
+    };
+    DisplayedFrameStats displayedStats_;
+    double statsDisplayInterval_ = 0.25;   ///< タイトルとオーバーレイの文字を更新する間隔（秒、SetStatsDisplayRate()）
+    double lastStatsDisplayTime_ = 0.0;    ///< 最後に更新した時刻（秒）
+    wchar_t windowTitle_[256] = {};        ///< 最後に設定したタイトル（同じ内容なら SetWindowTextW() を呼ばない）
+
+    /**
+     * @struct FrameTimeHistograms
+     * @brief 詳細統計用のフレーム時間の分布（固定メモリ、直近1秒/10秒/60秒とセッション全体）
+     */
+    struct FrameTimeHistograms {
+        RollingFrameHistogram total;   ///< フレーム合計時間
+        RollingFrameHistogram update;  ///< Update時間
+        RollingFrameHistogram render;  ///< Render時間
+        RollingFrameHistogram present; ///< Present時間
+        RollingFrameHistogram gpu;     ///< GPU時間（計測が有効な間のみ）
+    };
+
+    // 約1MBあるためスタック上の App に直接置かずヒープに確保する
+    std::unique_ptr<FrameTimeHistograms> frameHistograms_ = std::make_unique<FrameTimeHistograms>();
+    std::chrono::steady_clock::time_point metricsStartTime_ = std::chrono::steady_clock::now(); ///< ヒストグラムの時刻の基準
+    double lastPercentileLogTime_ = 0.0;          ///< 直近10秒の百分位を最後にログ出力した時刻（秒）
+    static constexpr double PERCENTILE_LOG_INTERVAL = 10.0; ///< 百分位のログ出力間隔（秒、デバッグビルド）
+
+    /**
+     * @struct TelemetryIds
+     * @brief リリースビルドでも記録するテレメトリ(telemetry.csv)のメトリクス
+     */
+    struct TelemetryIds {
+        Telemetry::MetricId frames = Telemetry::INVALID_METRIC;    ///< counter: 総フレーム数
+        Telemetry::MetricId frameMs = Telemetry::INVALID_METRIC;   ///< histogram: フレーム時間(ミリ秒)
+        Telemetry::MetricId updateMs = Telemetry::INVALID_METRIC;  ///< histogram: Update時間
+        Telemetry::MetricId renderMs = Telemetry::INVALID_METRIC;  ///< histogram: Render時間
+        Telemetry::MetricId presentMs = Telemetry::INVALID_METRIC; ///< histogram: Present時間
+        Telemetry::MetricId entities = Telemetry::INVALID_METRIC;  ///< gauge: 生存エンティティ数
+        Telemetry::MetricId entitiesCreated = Telemetry::INVALID_METRIC;   ///< gauge: 直近の Tick での作成数
+        Telemetry::MetricId entitiesDestroyed = Telemetry::INVALID_METRIC; ///< gauge: 直近の Tick での破棄数
+        Telemetry::MetricId ecsBytes = Telemetry::INVALID_METRIC;  ///< gauge: World のコンポーネントとエンティティの表の確保バイト数(概算)
+        Telemetry::MetricId drawCalls = Telemetry::INVALID_METRIC; ///< gauge: ドローコール数
+        Telemetry::MetricId triangles = Telemetry::INVALID_METRIC; ///< gauge: 描画した三角形数
+        Telemetry::MetricId textureBinds = Telemetry::INVALID_METRIC; ///< gauge: テクスチャのバインド数
+        Telemetry::MetricId constantBufferBytes = Telemetry::INVALID_METRIC; ///< gauge: 定数バッファへの書き込み(バイト)
+        Telemetry::MetricId renderPassMs[RenderSystem::Statistics::PASS_COUNT] = {}; ///< histogram: 描画の段階ごとのCPU時間(ミリ秒)
+        Telemetry::MetricId frameArenaBytes = Telemetry::INVALID_METRIC; ///< gauge: メインスレッドの FrameArena の使用量(バイト)
+        Telemetry::MetricId memoryBytes[MemoryTracker::TAG_COUNT] = {}; ///< gauge: MemoryTag ごとの使用量(CPU + GPU、バイト)
+    };
+    TelemetryIds telemetry_;
 
-    // 詳細統計用（最大1000フレーム分のサンプル）
-    std::vector<float> frameTotalSamples_; ///< フレーム合計時間のサンプル
-    std::vector<float> updateSamples_;     ///< Update時間のサンプル
-    std::vector<float> renderSamples_;     ///< Render時間のサンプル
-    std::vector<float> presentSamples_;    ///< Present時間のサンプル
+    // ========================================================
+    // メモリ使用量
+    // ========================================================
+    static constexpr double MEMORY_REPORT_INTERVAL = 1.0;  ///< サブシステムの使用量を数え直す間隔（秒）
+    double lastMemoryReportTime_ = 0.0;                    ///< 最後に数え直した時刻（秒）
 
-    const int maxSamples_ = 1000;          ///< 最大サンプル数
-    bool metricsCollecting_ = true;        ///< メトリクス収集中フラグ
+    /**
+     * @brief MemoryTag ごとの予算の既定値（バイト、CPU + GPU、0 は監視しない）
+     * @details MemoryTracker::GetInstance().SetBudget() で変更できます。
+     */
+    static constexpr size_t DEFAULT_MEMORY_BUDGETS[MemoryTracker::TAG_COUNT] = {
+        256ull * 1024 * 1024, // ECS
+        128ull * 1024 * 1024, // Render
+        512ull * 1024 * 1024, // Textures
+        512ull * 1024 * 1024, // Models
+        32ull * 1024 * 1024,  // Logging
+    };
+
+    // ========================================================
+    // 固定ステップ
+    // ========================================================
+    static constexpr float FIXED_TIMESTEP = 1.0f / 60.0f; ///< シミュレーションの時間刻み（秒）
+    static constexpr int MAX_SIMULATION_STEPS = 5;        ///< 1フレームで追いつく最大ステップ数（超えた分の時間は捨てる）
+    float simulationAccumulator_ = 0.0f;                 ///< まだシミュレーションに進めていない時間（秒）
+    int lockstepSteps_ = 0;                              ///< 実時間に関係なく毎フレーム進めるステップ数（0 は実時間に合わせる、`--headless` / `--bench`）
+    double droppedSimulationTime_ = 0.0;                 ///< 追いつけずに捨てた時間の累計（秒）
+    bool renderInterpolationEnabled_ = true;             ///< 描画でステップ間を補間するか（デバッグビルドは F5 で切り替え）
+    TransformSystem* transformSystem_ = nullptr;         ///< 補間の更新番号の取得元
+    SpatialHashGrid* spatialGrid_ = nullptr;             ///< SpatialBody の近傍検索・当たり判定（ServiceLocator にも登録）
+    CollisionSystem* collisionSystem_ = nullptr;         ///< Collider の詳細判定と衝突イベント（ServiceLocator にも登録）
+
+    // ========================================================
+    // 並列シミュレーション
+    // ========================================================
+    // ステップ中に検出し、メインスレッドで実行する操作（pendingCommands_ のビット）
+    static constexpr uint32_t COMMAND_QUIT = 1u << 0;                ///< 終了（ESC）
+    static constexpr uint32_t COMMAND_ABORT = 1u << 1;               ///< シーン更新で例外が発生したため終了
+    static constexpr uint32_t COMMAND_SUBMIT_BENCHMARK = 1u << 2;    ///< F9
+    static constexpr uint32_t COMMAND_EXPORT_TRACE = 1u << 3;        ///< F7
+    static constexpr uint32_t COMMAND_CYCLE_PRESENT_MODE = 1u << 4;  ///< F6
+    static constexpr uint32_t COMMAND_TOGGLE_INTERPOLATION = 1u << 5; ///< F5
+    static constexpr uint32_t COMMAND_TOGGLE_DEPTH_PREPASS = 1u << 6; ///< F8
+    static constexpr uint32_t COMMAND_TOGGLE_PIPELINE = 1u << 7;     ///< F4
+    static constexpr uint32_t COMMAND_TOGGLE_OVERLAY = 1u << 8;      ///< F3
+    static constexpr uint32_t COMMAND_PICK = 1u << 9;                ///< 中クリック(pickX_, pickY_)
+    static constexpr uint32_t COMMAND_TOGGLE_DYNAMIC_RESOLUTION = 1u << 10; ///< F2
+    static constexpr uint32_t COMMAND_CAPTURE_FRAME = 1u << 11;      ///< F11
+
+    bool pipelinedSimulation_ = false;           ///< シミュレーションを描画と並行して進めるか（デバッグビルドは F4 で切り替え）
+    SimulationThread simulationThread_;          ///< 並列時にステップを実行するスレッド（初めて有効にしたときに起動）
+    std::unique_ptr<RenderSnapshot> renderSnapshot_; ///< 並列時に描画する World の写し
+    uint32_t pendingCommands_ = 0;               ///< ステップで検出した操作（シミュレーションの完了後にメインスレッドが読む）
+    int pickX_ = 0;                              ///< COMMAND_PICK のマウス座標
+    int pickY_ = 0;
+    float lastSimulationTime_ = 0.0f;            ///< 直前の RunSimulation() の所要時間（秒）
+    WorldStats simulatedWorldStats_;             ///< 同期点での World の件数とメモリの概算（オーバーレイ・テレメトリ用）
+    size_t simulatedDormantCount_ = 0;           ///< 同期点でのプールの休止中エンティティ数（オーバーレイ用）
+    double simulatedPoolHitRate_ = 0.0;          ///< 同期点でのプールの再利用率（オーバーレイ用）
+    bool simulatedStreaming_ = false;            ///< 同期点でシーンのストリーミング中か（オーバーレイ用）
+    float simulatedStreamProgress_ = 0.0f;       ///< 同期点でのストリーミングの進み具合（オーバーレイ用）
+    bool simulatedCellStreaming_ = false;        ///< 同期点でセルのストリーミングが有効か（オーバーレイ用）
+    CellStreamerStats simulatedCellStats_;       ///< 同期点でのセルの状態（オーバーレイ用）
 
     // ========================================================
     // 初期化
     // ========================================================
+    /**
+     * @brief 描画の負荷計測シーンで起動する(Init() の前に呼ぶ)
+     *
+     * @details
+     * GameScene の代わりに RenderBenchmarkScene を開き、GPU 時間の計測を有効にして、
+     * 垂直同期なし(PresentMode::Uncapped)で config.frames フレームを記録したら終了します。
+     */
+    void EnableRenderBenchmark(const RenderBenchmarkConfig& config) {
+        renderBenchmark_ = std::make_unique<RenderBenchmark>(config);
+    }
+
+    /**
+     * @brief 記録したフレームの描画キューを再生して計測する(Init() の前に呼ぶ)
+     *
+     * @details
+     * シーンを開かずに config.capturePath の FrameCapture を RenderSystem::RenderReplay() で毎フレーム送り直し、
+     * GPU 時間の計測を有効にして、垂直同期なしで config.frames フレームを記録したら RenderBenchmark と同じ CSV を書き出して終了します。
+     * 読み込めない記録の場合は Init() が失敗します。
+     */
+    void EnableFrameReplay(const FrameReplayConfig& config) {
+        replayBenchmark_ = std::make_unique<RenderBenchmark>(config.RenderConfig());
+        replayCapturePath_ = config.capturePath;
+    }
+
+    /**
+     * @brief ウィンドウを表示せずにシミュレーションだけを全速で進める(Init() の前に呼ぶ)
+     *
+     * @details
+     * 表示の待ち・描画・Present を飛ばし、実時間に関係なく毎フレーム config.stepsPerFrame ステップを進めます。
+     * デバイスはシーンの読み込みがバッファやテクスチャを作れるよう既定で WARP で作ります。
+     * config.frames フレーム(または config.seconds 秒)進めたら CSV を書き出して終了します(HeadlessRun.h を参照)。
+     */
+    void EnableHeadless(const HeadlessConfig& config) {
+        headless_ = std::make_unique<HeadlessRun>(config);
+        lockstepSteps_ = config.stepsPerFrame;
+        if (config.warp) gfx_.SetUseWarp(true);
+    }
+
+    /**
+     * @brief シナリオを決まったフレーム数だけ実行して結果を CSV に追記する(Init() の前に呼ぶ)
+     *
+     * @details
+     * GameScene の代わりにシナリオのシーンを開き、垂直同期なし・GPU 計測ありで毎フレーム1固定ステップを進めます。
+     * util::Random は config.seed で初期化します(記録・再生時は記録のシード)。
+     * ウォームアップの後に config.frames フレームを記録したら、フレーム時間の分布・World と描画の統計を
+     * config.outputPath に1行追記して終了します(ScenarioBenchmark.h を参照)。
+     */
+    void EnableScenarioBenchmark(const ScenarioBenchmarkConfig& config) {
+        scenarioBenchmark_ = std::make_unique<ScenarioBenchmark>(config);
+        lockstepSteps_ = 1;
+    }
+
+    /**
+     * @brief ハードウェアの代わりに WARP で描画する(Init() の前に呼ぶ、GfxDevice::SetUseWarp を参照)
+     */
+    void EnableWarp() {
+        gfx_.SetUseWarp(true);
+    }
+
+    /**
+     * @brief 入力を専用スレッドで高頻度に受け取る(Init() の前に呼ぶ)
+     * @param[in] rateHz XInput のポーリング周波数(InputSampler を参照)
+     *
+     * @details
+     * 各ステップは自分のシミュレーション時刻までの入力を使い、最後のステップはスワップチェインの待機後までの
+     * 入力を使います。スレッドを起動できない場合はメインスレッドでの受け取りのままです。
+     */
+    void EnableInputSampling(uint32_t rateHz) {
+        inputSampleRateHz_ = rateHz;
+    }
+
+    /**
+     * @brief ワーカー数・コアの予約・アフィニティ・優先度を設定する(Init() の前に呼ぶ、ThreadPlacement.h を参照)
+     */
+    void SetThreadPlacement(const ThreadPlacementConfig& config) {
+        threadPlacement_ = config;
+    }
+
+    /**
+     * @brief タイトルとオーバーレイの文字を更新する頻度(Hz、既定 4Hz、0.5〜60 に丸める)
+     *
+     * @details
+     * 表示する値はこの間隔の平均です。グラフの履歴とテレメトリ・ヒストグラムは頻度に関係なく毎フレーム記録します。
+     */
+    void SetStatsDisplayRate(float hz) {
+        const float clamped = (std::min)((std::max)(hz, 0.5f), 60.0f);
+        statsDisplayInterval_ = 1.0 / clamped;
+    }
+
+    /**
+     * @brief テクスチャが使うVRAMの上限(バイト、0で無制限)
+     *
+     * @details
+     * 超えた場合は長く描画されていないテクスチャのミップを落とすか退避し、次に描画した時に読み込み直します
+     * (TextureManager::SetResidencyBudget を参照)。
+     */
+    void SetTextureVramBudget(size_t bytes) {
+        texManager_.SetResidencyBudget(bytes);
+    }
+
+    /**
+     * @brief フレーム時間の予算に合わせて品質を自動で上げ下げする(Init() の前に呼ぶ)
+     * @param[in] targetMs 目標のフレーム時間(ミリ秒、0 以下はリフレッシュ間隔)
+     *
+     * @details
+     * パーティクルの放出数・影の距離・LOD の切り替え距離・ストリーミングするテクスチャの解像度を
+     * QualityGovernor に登録し、CPU 時間(Present の待ちを除く)と GPU 時間が目標に収まるよう段階を変えます。
+     * GPU 時間の計測も有効にします。
+     */
+    void EnableQualityGovernor(float targetMs) {
+        frameBudgetMs_ = (std::max)(targetMs, 0.0f);
+    }
+
+    /**
+     * @brief 入力を記録・再生する(Init() の前に呼ぶ)
+     * @param[in] config 記録先・再生するファイルとシード(InputReplay.h を参照)
+     *
+     * @details
+     * 記録時は各ステップの入力と乱数のシード・固定ステップの長さをファイルに書き出します。
+     * 再生時はステップごとの入力をファイルから反映し、同じシードで util::Random を初期化して、
+     * 最後のステップまで再生したら終了します(ビルド間の性能比較で同じシミュレーションを実行する)。
+     */
+    void EnableInputReplay(const InputReplayConfig& config) {
+        replayConfig_ = config;
+    }
+
+    /**
+     * @brief モデル・テクスチャの読み込み時間を計測して CSV に書き出す(Init() の後、Run() の代わりに呼ぶ)
+     *
+     * @details
+     * シーンの非同期読み込みと重ならないよう GfxDevice::ResourceMutex() を取ってから計測します。
+     * @return bool CSV を書き出せた場合 true
+     */
+    bool RunAssetBenchmark(const AssetBenchmarkConfig& config) {
+        std::lock_guard<std::mutex> lock(gfx_.ResourceMutex());
+        return AssetBenchmark::Run(config, texManager_);
+    }
+
     /**
      * @brief アプリケーションの初期化
      * @param[in] hInst アプリケーションのインスタンスハンドル
@@ -130,6 +563,11 @@ struct App {
         DEBUGLOG("App::Init() 開始");
         DEBUGLOG("ウィンドウサイズ: " + std::to_string(width) + "x" + std::to_string(height));
 
+#ifdef _DEBUG
+        // クラッシュ時も書き込みスレッドに残ったログを書き出す
+        SetUnhandledExceptionFilter(&App::UnhandledExceptionFilterStatic);
+#endif
+
         // P2: COM初期化モードを明示的に記録
         HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
         if (SUCCEEDED(hrCom)) {
@@ -142,27 +580,62 @@ struct App {
             return false;
         }
 
-        if (!CreateAppWindow(hInst, width, height)) {
-            DEBUGLOG("[ERROR] CreateAppWindow() 失敗");
-            return false;
+        InitializeTelemetry();
+
+        // ジョブシステム（失敗時はParallelForEachが逐次実行にフォールバック）
+        // 起動時の初期化ステップの並列実行にも使うため、ウィンドウより先に起動する
+        // ワーカーと予約したスレッドのコアは ThreadPlacement が決め、各スレッドが起動時に自分へ設定する
+        ThreadPlacement& placement = ThreadPlacement::GetInstance();
+        placement.Configure(threadPlacement_);
+        placement.ApplyCurrent(ThreadRole::Main);
+        if (jobs_.Init(placement.WorkerCount(), [](uint32_t worker) {
+                ThreadPlacement::GetInstance().ApplyCurrent(ThreadRole::Worker, worker);
+            })) {
+            world_.SetJobSystem(&jobs_);
+            renderer_.SetJobSystem(&jobs_);
+            resManager_.SetJobSystem(&jobs_);
+            ModelLoader::SetJobSystem(&jobs_); // 1モデル内のメッシュの並列変換
+            texManager_.SetJobSystem(&jobs_);
+            sceneManager_.SetJobSystem(&jobs_); // ストリーミングするシーンファイルの読み込み
+#ifdef _DEBUG
+            debugDraw_.SetJobSystem(&jobs_); // ワーカーからの線の追加用
+#endif
+        } else {
+            DEBUGLOG_WARNING("JobSystemの初期化に失敗しました。並列処理は無効です");
         }
 
-        if (!InitializeGraphics(width, height)) {
-            DEBUGLOG("[ERROR] InitializeGraphics() 失敗");
+        // 起動時の初期化（依存のないステップはワーカーで並列に実行し、ステップごとの時間をログに出す）
+        using StartupThread = StartupTasks::Thread;
+        StartupTasks startup;
+        const auto window = startup.Add("Window", StartupThread::Main, [&]() { return CreateAppWindow(hInst, width, height); });
+        startup.Add("MediaFoundation", StartupThread::Worker, [this]() { return StartMediaFoundation(); }, {}, false);
+        const auto graphics = startup.Add("Graphics", StartupThread::Main, [&]() { return InitializeGraphics(width, height); }, { window });
+        const auto input = startup.Add("Input", StartupThread::Main, [this]() { return InitializeInput(); }, { window });
+#ifdef _DEBUG
+        startup.Add("DebugDraw", StartupThread::Worker, [this]() { return InitializeDebugDraw(); }, { graphics }, false);
+#endif
+        startup.Add("Sprites", StartupThread::Worker, [this]() {
+            perfOverlay_.Init();
+            return sprites_.Init(gfx_);
+        }, { graphics }, false);
+        startup.Add("Game", StartupThread::Main, [&]() {
+            InitializeWorld();
+            SetupCamera(width, height);
+            if (replayBenchmark_) return InitializeFrameReplay(); // 記録したフレームの再生ではシーンを開かない
+            InitializeGame(); // ゲームシーンの初期化
+            return true;
+        }, { graphics, input });
+
+        if (!startup.Run(&jobs_)) {
+            DEBUGLOG("[ERROR] 起動時の初期化に失敗");
             return false;
         }
+        if (frameBudgetMs_ >= 0.0f) {
+            InitializeQualityGovernor();
+        }
 
-        // サービスロケータに登録（GfxDeviceとTextureManagerはInitializeGraphics内で登録済み）
-        ServiceLocator::Register(&input_);
-        ServiceLocator::Register(&gamepad_);
-        ServiceLocator::Register(&world_);
-        ServiceLocator::Register(&renderer_);
-        ServiceLocator::Register(&resManager_);
-
-        SetupCamera(width, height);
-
-        // ゲームシーンの初期化
-        InitializeGame();
+        // リリースビルドのタイトルは固定（デバッグビルドは表示の間隔ごとにメトリクスを含めて更新）
+        SetWindowTitle(L"はじく！");
 
         DEBUGLOG("App::Init() 正常に完了");
         DEBUGLOG("========================================");
@@ -195,10 +668,26 @@ struct App {
 
             // フレーム開始時刻
             auto frameStartTime = std::chrono::high_resolution_clock::now();
+            PROFILE_SCOPE("Frame");
+
+            // ウィンドウの大きさの変更（メッセージ処理で受けた最後の大きさ）
+            if (resizePending_) {
+                ApplyResize();
+            }
+
+            // スワップチェインに空きができるまで待つ（入力を取得する前、LowLatency で遅延が最小になる）
+            // ヘッドレス時は表示しないので待たない
+            if (!headless_) {
+                PROFILE_SCOPE("WaitForNextFrame");
+                gfx_.WaitForNextFrame();
+            }
 
             // 時間の計算
             float deltaTime = CalculateDeltaTime(previousTime);
 
+            // このフレームの最後のステップが使う入力の時刻(待機の後なので最新の入力まで含む)
+            const int64_t inputTime = InputSystem::Now();
+
             // デルタタイムの異常値チェック
             if (deltaTime > 1.0f) {
                 DEBUGLOG("[WARNING] 異常なdeltaTimeを検出: " + std::to_string(deltaTime) + "s (0.1sにクランプ)");
@@ -208,48 +697,105 @@ struct App {
             // ========== UPDATE PHASE ==========
             auto updateStartTime = std::chrono::high_resolution_clock::now();
 
-            // 入力の更新
-         input_.Update();
+            // 同期点: 並列時は前のフレームで投入したシミュレーションの完了を待つ（以降 world_ に触れてよい）
+            {
+                PROFILE_SCOPE("WaitForSimulation");
+                simulationThread_.Wait();
+            }
+            const float simulationTime = lastSimulationTime_;
+            world_.GetStats(simulatedWorldStats_, false);
+            simulatedDormantCount_ = world_.GetDormantEntityCount();
+            simulatedPoolHitRate_ = world_.GetEntityPoolStats().HitRate();
+            simulatedStreaming_ = sceneManager_.GetStreaming().IsActive();
+            simulatedStreamProgress_ = sceneManager_.GetStreaming().Progress();
+            simulatedCellStreaming_ = sceneManager_.GetCellStreaming().IsOpen();
+            if (simulatedCellStreaming_) {
+                simulatedCellStats_ = sceneManager_.GetCellStreaming().GetStats();
+            }
+            sceneManager_.SetStreamingFocus(camera_.position); // シーンが注視点を返さない場合はカメラの周りを読み込む
+            ApplyAppCommands();
 
-         // ゲームパッドの更新
-         gamepad_.Update();
 #ifdef _DEBUG
             UpdateDebugCamera(deltaTime);
+            debugDraw_.Update(deltaTime); // 寿命付きのデバッグ描画の期限切れを取り除く
 #endif
+            if (renderBenchmark_) {
+                renderBenchmark_->ApplyCamera(camera_);
+            }
+            if (scenarioBenchmark_) {
+                scenarioBenchmark_->ApplyCamera(camera_);
+            }
 
-            // ESCキーで終了
-            if (input_.GetKeyDown(VK_ESCAPE)) {
-                DEBUGLOG_CATEGORY(DebugLog::Category::System, "ESCキーが押されました - アプリケーション終了要求（ユーザー操作）");
-                PostQuitMessage(0);
+            // 変更されたモデル・テクスチャ・シェーダーのホットリロード(有効時のみ)
+            resManager_.Update();
+            renderer_.UpdateShaderHotReload();
+
+            // テクスチャのストリーミング(前フレームに通知された解像度まで転送)
+            texManager_.Update();
+
+            // 並列時は直前のシミュレーション結果を写し取り、次のステップと並行してそれを描画する
+            const bool pipelined = pipelinedSimulation_;
+            World* renderWorld = &world_;
+            if (pipelined) {
+                PrepareRender();
+                renderSnapshot_->Capture(world_);
+                renderWorld = &renderSnapshot_->GetWorld();
             }
 
-            // シーンの更新
-            try {
-                sceneManager_.Update(world_, input_, deltaTime);
-            } catch (const std::exception& e) {
-                DEBUGLOG("[CRITICAL ERROR] シーン更新中に例外が発生: " + std::string(e.what()));
-                PostQuitMessage(-1);
+            // 固定ステップのシミュレーション（描画のフレームレートに関係なく FIXED_TIMESTEP 刻みで進める）
+            // ヘッドレス・計測時は実時間に合わせず、毎フレーム決まった数だけ進める
+            const int steps = lockstepSteps_ > 0 ? lockstepSteps_ : AdvanceSimulationClock(deltaTime);
+            currentMetrics_.simulationSteps = static_cast<float>(steps);
+            if (pipelined) {
+                simulationThread_.Kick([this, steps, inputTime]() { RunSimulation(steps, inputTime); });
+            } else {
+                RunSimulation(steps, inputTime);
+                ApplyAppCommands();
+                PrepareRender();
             }
 
             auto updateEndTime = std::chrono::high_resolution_clock::now();
             std::chrono::duration<float> updateDuration = updateEndTime - updateStartTime;
-            currentMetrics_.updateTime = updateDuration.count();
+            // 並列時はシミュレーションスレッドでの所要時間（1フレーム前に投入した分）
+            currentMetrics_.updateTime = pipelined ? simulationTime : updateDuration.count();
 
             // ========== RENDER PHASE ==========
             auto renderStartTime = std::chrono::high_resolution_clock::now();
 
-            // BeginFrameとレンダリング処理
-            gfx_.BeginFrame();
+            // 並列時は Present までシミュレーション側のモデル読み込み（テクスチャ管理と即時コンテキストを使う）と排他にする
+            std::unique_lock<std::mutex> resourceLock(gfx_.ResourceMutex(), std::defer_lock);
+            if (pipelined) resourceLock.lock();
 
-#ifdef _DEBUG
-            DrawDebugInfo();
-#endif
+            // ヘッドレス時は指定した間隔のフレームだけ描画する
+            const bool drawFrame = !headless_ || headless_->ShouldRender(frameCount);
+            if (drawFrame) {
+                // BeginFrameとレンダリング処理
+                gfx_.BeginFrame();
 
-            renderer_.Render(world_, camera_);
+                if (replayBenchmark_) {
+                    renderer_.RenderReplay();
+                } else {
+                    renderer_.Render(*renderWorld, camera_);
+                }
 
 #ifdef _DEBUG
-            debugDraw_.Render(gfx_, camera_);
+                {
+                    GpuProfileScope gpuScope(gfx_.Profiler(), gfx_.Ctx(), "DebugDraw");
+                    debugDraw_.Render(gfx_, camera_);
+                }
 #endif
+                // 縮小して描いたシーンを拡大（以降のオーバーレイはウィンドウの解像度で描く）
+                gfx_.ResolveScene();
+
+                // HUD のスプライトと性能のオーバーレイ(最前面)をまとめて描く
+                {
+                    GpuProfileScope gpuScope(gfx_.Profiler(), gfx_.Ctx(), "Sprites");
+                    sprites_.Begin(static_cast<float>(gfx_.Width()), static_cast<float>(gfx_.Height()));
+                    sprites_.DrawWorld(*renderWorld);
+                    perfOverlay_.Render(sprites_);
+                    sprites_.End(gfx_, texManager_);
+                }
+            }
 
             auto renderEndTime = std::chrono::high_resolution_clock::now();
             std::chrono::duration<float> renderDuration = renderEndTime - renderStartTime;
@@ -259,7 +805,20 @@ struct App {
             auto presentStartTime = std::chrono::high_resolution_clock::now();
 
             // Present実行（VSync待機含む）
-            gfx_.EndFrame();
+            if (drawFrame) {
+                PROFILE_SCOPE("Present");
+                gfx_.EndFrame();
+            }
+            if (resourceLock.owns_lock()) resourceLock.unlock();
+            if (!firstFrameLogged_ && drawFrame) {
+                // WinMain から最初の Present までの内訳を startup_report.csv に追記
+                firstFrameLogged_ = true;
+                StartupReport& startupReport = StartupReport::GetInstance();
+                if (!startupReport.MarkFirstPresent()) {
+                    DEBUGLOG_WARNING(std::string("起動時間の内訳を書き出せません: ") + StartupReport::Path());
+                }
+                DEBUGLOG_CATEGORY(DebugLog::Category::System, "[Startup] WinMain から最初のフレームまで " + std::to_string(startupReport.TotalMs()) + " ms");
+            }
 
             auto presentEndTime = std::chrono::high_resolution_clock::now();
             std::chrono::duration<float> presentDuration = presentEndTime - presentStartTime;
@@ -269,37 +828,114 @@ struct App {
             std::chrono::duration<float> frameDuration = presentEndTime - frameStartTime;
             currentMetrics_.totalTime = frameDuration.count();
 
+            const GpuProfiler& gpu = gfx_.Profiler();
+            currentMetrics_.gpuTime = gpu.FrameMs() * 0.001f;
+            currentMetrics_.gpuInstancedTime = gpu.ScopeMs(RenderSystem::GPU_SCOPE_INSTANCED) * 0.001f;
+            currentMetrics_.gpuQueueTime = (gpu.ScopeMs(RenderSystem::GPU_SCOPE_DEPTH_PREPASS) + gpu.ScopeMs(RenderSystem::GPU_SCOPE_QUEUE) +
+                                           gpu.ScopeMs(RenderSystem::GPU_SCOPE_TRANSPARENT) + gpu.ScopeMs(RenderSystem::GPU_SCOPE_VIDEO)) *
+                                          0.001f;
+            currentMetrics_.gpuDebugDrawTime = gpu.ScopeMs("DebugDraw") * 0.001f;
+            currentMetrics_.gpuParticleTime = gpu.ScopeMs(RenderSystem::GPU_SCOPE_PARTICLES) * 0.001f;
+            currentMetrics_.pacingWaitTime = gfx_.LastPacingWait();
+
+            // 動的解像度: GPU時間の履歴から次のフレームの描画解像度を決める
+            if (dynamicResolution_.IsEnabled()) {
+                gfx_.SetRenderScale(dynamicResolution_.Update(gpu.FrameMs()));
+            }
+
+            // 品質の予算: Present の待ちを除いた CPU 時間と GPU 時間から各サブシステムの段階を決める
+            if (qualityGovernor_.IsEnabled() && drawFrame) {
+                qualityGovernor_.Update((currentMetrics_.totalTime - currentMetrics_.presentTime) * 1000.0f, gpu.FrameMs());
+            }
+
+            // 負荷計測: 規定フレーム数を記録したら CSV を書き出して終了
+            if (renderBenchmark_ && !renderBenchmark_->IsFinished() &&
+                renderBenchmark_->Record(currentMetrics_.totalTime * 1000.0f, currentMetrics_.renderTime * 1000.0f,
+                                         currentMetrics_.gpuTime * 1000.0f, renderer_.GetStatistics())) {
+                PostQuitMessage(0);
+            }
+
+            // 記録したフレームの再生: 規定フレーム数を記録したら CSV を書き出して終了
+            if (replayBenchmark_ && !replayBenchmark_->IsFinished() &&
+                replayBenchmark_->Record(currentMetrics_.totalTime * 1000.0f, currentMetrics_.renderTime * 1000.0f,
+                                         currentMetrics_.gpuTime * 1000.0f, renderer_.GetStatistics())) {
+                PostQuitMessage(0);
+            }
+
+            // シナリオの計測: 規定フレーム数を記録したら結果を追記して終了
+            if (scenarioBenchmark_ && !scenarioBenchmark_->IsFinished() &&
+                scenarioBenchmark_->Record(currentMetrics_.totalTime, currentMetrics_.updateTime, currentMetrics_.renderTime,
+                                           currentMetrics_.presentTime, currentMetrics_.gpuTime, renderer_.GetStatistics())) {
+                WorldStats worldStats;
+                world_.GetStats(worldStats, false);
+                scenarioBenchmark_->WriteResults(worldStats);
+                PostQuitMessage(0);
+            }
+
+            // ヘッドレス: 規定のフレーム数・秒数を進めたら CSV を書き出して終了(`--bench` と併用した場合は `--bench` の終了に従う)
+            if (headless_ && !headless_->IsFinished() &&
+                headless_->Record(currentMetrics_.updateTime * 1000.0f, steps, simulatedWorldStats_.alive) && !scenarioBenchmark_) {
+                PostQuitMessage(0);
+            }
+
             // メトリクス集計
             avgMetrics_.updateTime += currentMetrics_.updateTime;
             avgMetrics_.renderTime += currentMetrics_.renderTime;
             avgMetrics_.presentTime += currentMetrics_.presentTime;
             avgMetrics_.totalTime += currentMetrics_.totalTime;
+            avgMetrics_.gpuTime += currentMetrics_.gpuTime;
+            avgMetrics_.gpuInstancedTime += currentMetrics_.gpuInstancedTime;
+            avgMetrics_.gpuQueueTime += currentMetrics_.gpuQueueTime;
+            avgMetrics_.gpuDebugDrawTime += currentMetrics_.gpuDebugDrawTime;
+            avgMetrics_.gpuParticleTime += currentMetrics_.gpuParticleTime;
+            avgMetrics_.pacingWaitTime += currentMetrics_.pacingWaitTime;
+            avgMetrics_.simulationSteps += currentMetrics_.simulationSteps;
             metricsFrameCount_++;
 
-            // サンプル収集（最大1000フレーム）
-            if (metricsCollecting_ && frameTotalSamples_.size() < maxSamples_) {
-                frameTotalSamples_.push_back(currentMetrics_.totalTime);
-                updateSamples_.push_back(currentMetrics_.updateTime);
-                renderSamples_.push_back(currentMetrics_.renderTime);
-                presentSamples_.push_back(currentMetrics_.presentTime);
+            RecordTelemetry();
+
+            // 分布の記録（O(1)、固定メモリ）
+            const double metricsNow = MetricsSeconds();
+            if (metricsNow - lastMemoryReportTime_ >= MEMORY_REPORT_INTERVAL) {
+                lastMemoryReportTime_ = metricsNow;
+                UpdateMemoryTracking();
             }
+            frameHistograms_->total.Record(currentMetrics_.totalTime, metricsNow);
+            frameHistograms_->update.Record(currentMetrics_.updateTime, metricsNow);
+            frameHistograms_->render.Record(currentMetrics_.renderTime, metricsNow);
+            frameHistograms_->present.Record(currentMetrics_.presentTime, metricsNow);
+            if (gpu.IsEnabled() && currentMetrics_.gpuTime > 0.0f) {
+                frameHistograms_->gpu.Record(currentMetrics_.gpuTime, metricsNow);
+            }
+
+            // 表示の間隔ごとに区間の平均をまとめ、オーバーレイの文字とタイトルはそのときだけ作り直す
+            // （グラフの履歴は毎フレーム進める。SetWindowTextW は DWM とのやり取りで待つことがあるため毎フレーム呼ばない）
+            const bool statsPublished = metricsNow - lastStatsDisplayTime_ >= statsDisplayInterval_;
+            if (statsPublished) {
+                lastStatsDisplayTime_ = metricsNow;
+                PublishFrameStats(metricsNow);
+            }
+            UpdatePerfOverlay(statsPublished);
 
 #ifdef _DEBUG
-            // ウィンドウタイトルにスコアとFPS表示
-            if (metricsFrameCount_ >= metricsUpdateInterval_) {
+            // オーバーレイの表示中はタイトルの代わりにオーバーレイで見る
+            if (statsPublished && !perfOverlay_.IsVisible()) {
                 UpdateWindowTitleWithMetrics();
+            }
 
-                // リセット
-                avgMetrics_ = FrameMetrics{};
-                metricsFrameCount_ = 0;
+            // 直近10秒の百分位を定期的にログ出力（長時間実行の途中のスパイクを残す）
+            if (metricsNow - lastPercentileLogTime_ >= PERCENTILE_LOG_INTERVAL) {
+                lastPercentileLogTime_ = metricsNow;
+                LogRecentPercentiles(metricsNow);
             }
-#else
-            UpdateWindowTitle();
 #endif
 
+            // このフレームの一時データを一括解放
+            FrameArena::ForThread().Reset();
             frameCount++;
         }
 
+        simulationThread_.Wait();
         DEBUGLOG("App::Run() - メインループ終了 (総フレーム数: " + std::to_string(frameCount) + ")");
     }
 
@@ -309,14 +945,251 @@ struct App {
     ~App() {
         DEBUGLOG("App::~App() - デストラクタ呼び出し");
 
-        // 終了前にフレーム統計を出力
+        // 終了前にフレーム統計とメモリ使用量を出力
         OutputFrameStatistics();
+        UpdateMemoryTracking();
+        MemoryTracker::GetInstance().LogSummary();
 
         Shutdown();
         DEBUGLOG("App 正常に破棄");
     }
 
 private:
+    /**
+     * @brief フレームの経過時間を加え、このフレームで進めるステップ数を求める
+     * @return int ステップ数（0〜MAX_SIMULATION_STEPS）
+     *
+     * @details
+     * 追いつけなかった分の時間は捨てます（処理落ちのたびにステップが増えて更に遅くなるのを防ぐ）。
+     */
+    int AdvanceSimulationClock(float deltaTime) {
+        simulationAccumulator_ += deltaTime;
+        int steps = static_cast<int>(simulationAccumulator_ / FIXED_TIMESTEP);
+        if (steps > MAX_SIMULATION_STEPS) steps = MAX_SIMULATION_STEPS;
+        simulationAccumulator_ -= steps * FIXED_TIMESTEP;
+        if (simulationAccumulator_ >= FIXED_TIMESTEP) {
+            float remainder = std::fmod(simulationAccumulator_, FIXED_TIMESTEP);
+            droppedSimulationTime_ += simulationAccumulator_ - remainder;
+            simulationAccumulator_ = remainder;
+        }
+        if (simulationAccumulator_ < 0.0f) simulationAccumulator_ = 0.0f;
+        return steps;
+    }
+
+    /**
+     * @brief ステップを続けて実行（並列時はシミュレーションスレッドで呼ばれる）
+     *
+     * @details
+     * world_ / input_ / gamepad_ / actions_ / sceneManager_ だけに触れます。描画やデバイスへの操作は
+     * pendingCommands_ に記録し、完了後にメインスレッドの ApplyAppCommands() が実行します。
+     * inputTime は最後のステップの入力の時刻で、それより前のステップは FIXED_TIMESTEP ずつ前の時刻までの入力を使います。
+     */
+    void RunSimulation(int steps, int64_t inputTime) {
+        PROFILE_SCOPE("RunSimulation");
+        auto start = std::chrono::high_resolution_clock::now();
+        const int64_t ticksPerStep = static_cast<int64_t>(static_cast<double>(InputSystem::Frequency()) * FIXED_TIMESTEP);
+        for (int i = 0; i < steps; ++i) {
+            if (!SimulateStep(inputTime - ticksPerStep * (steps - 1 - i))) break;
+        }
+        lastSimulationTime_ = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    /**
+     * @brief シミュレーションを FIXED_TIMESTEP だけ進める
+     * @param[in] inputTime このステップで反映する入力の時刻(InputSystem::Now() の基準)
+     * @return bool 続けてステップを進めてよい場合 true（シーン更新で例外が発生した場合 false）
+     *
+     * @details
+     * 入力はステップごとに取得するため、押した瞬間の判定はちょうど1ステップで検出されます
+     * （ステップのないフレームでは前回の状態のまま、次のステップで検出されます）。
+     */
+    bool SimulateStep(int64_t inputTime) {
+        PROFILE_SCOPE("SimulateStep");
+
+        // 記録・再生時と `--bench` ではシミュレーションを実行するスレッドの乱数も同じシードから始める
+        if (simulationSeedPending_) {
+            util::Random::Engine().Seed(simulationSeed_, 1);
+            simulationSeedPending_ = false;
+        }
+
+        if (inputReplay_.IsReplaying()) {
+            // 記録した入力を反映(最後まで再生したら終了)
+            if (!inputReplay_.ReplayStep(input_, gamepad_)) {
+                DEBUGLOG_CATEGORY(DebugLog::Category::System, "入力の再生が終了 - アプリケーション終了要求");
+                pendingCommands_ |= COMMAND_QUIT;
+                return false;
+            }
+        } else {
+            // 入力の更新
+            input_.Update(inputTime);
+
+            // ゲームパッドの更新
+            gamepad_.Update(inputTime);
+
+            inputReplay_.RecordStep(input_, gamepad_);
+        }
+
+        // アクションの評価(ゲームのコードはこの結果を読む)
+        actions_.Update(input_, &gamepad_);
+
+#ifdef _DEBUG
+        if (input_.GetKeyDown(VK_F9)) pendingCommands_ |= COMMAND_SUBMIT_BENCHMARK;
+        if (input_.GetKeyDown(VK_F7)) pendingCommands_ |= COMMAND_EXPORT_TRACE;
+        if (input_.GetKeyDown(VK_F6)) pendingCommands_ |= COMMAND_CYCLE_PRESENT_MODE;
+        if (input_.GetKeyDown(VK_F5)) pendingCommands_ |= COMMAND_TOGGLE_INTERPOLATION;
+        if (input_.GetKeyDown(VK_F8)) pendingCommands_ |= COMMAND_TOGGLE_DEPTH_PREPASS;
+        if (input_.GetKeyDown(VK_F4)) pendingCommands_ |= COMMAND_TOGGLE_PIPELINE;
+        if (input_.GetKeyDown(VK_F11)) pendingCommands_ |= COMMAND_CAPTURE_FRAME;
+        if (input_.GetMouseButtonDown(InputSystem::Middle)) {
+            pendingCommands_ |= COMMAND_PICK;
+            pickX_ = input_.GetMouseX();
+            pickY_ = input_.GetMouseY();
+        }
+#endif
+
+        if (input_.GetKeyDown(VK_F3)) pendingCommands_ |= COMMAND_TOGGLE_OVERLAY;
+        if (input_.GetKeyDown(VK_F2)) pendingCommands_ |= COMMAND_TOGGLE_DYNAMIC_RESOLUTION;
+
+        // ESCキーで終了
+        if (input_.GetKeyDown(VK_ESCAPE)) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::System, "ESCキーが押されました - アプリケーション終了要求（ユーザー操作）");
+            pendingCommands_ |= COMMAND_QUIT;
+        }
+
+        // シーンの更新
+        try {
+            sceneManager_.Update(world_, input_, FIXED_TIMESTEP);
+        } catch (const std::exception& e) {
+            DEBUGLOG("[CRITICAL ERROR] シーン更新中に例外が発生: " + std::string(e.what()));
+            pendingCommands_ |= COMMAND_ABORT;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief ステップで検出した操作を実行（メインスレッド、シミュレーションが止まっている間）
+     */
+    void ApplyAppCommands() {
+        const uint32_t commands = pendingCommands_;
+        pendingCommands_ = 0;
+        if (commands == 0) return;
+
+        // PostQuitMessage はメッセージループのスレッドから呼ぶ必要がある
+        if (commands & COMMAND_ABORT) {
+            PostQuitMessage(-1);
+        } else if (commands & COMMAND_QUIT) {
+            PostQuitMessage(0);
+        }
+
+        // F3: 性能のオーバーレイの表示を切り替え
+        if (commands & COMMAND_TOGGLE_OVERLAY) {
+            perfOverlay_.SetVisible(!perfOverlay_.IsVisible());
+        }
+
+        // F2: 動的解像度を切り替え（目標はリフレッシュ間隔のGPU時間、GPU時間の計測も有効にする）
+        if (commands & COMMAND_TOGGLE_DYNAMIC_RESOLUTION) {
+            const bool enable = !dynamicResolution_.IsEnabled();
+            dynamicResolution_.SetTargetMs(1000.0f / gfx_.RefreshRate());
+            dynamicResolution_.SetEnabled(enable);
+            if (enable) gfx_.Profiler().SetEnabled(true);
+            gfx_.SetRenderScale(dynamicResolution_.Scale());
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("動的解像度: ") + (enable ? "有効" : "無効"));
+        }
+
+#ifdef _DEBUG
+        // F9: 描画キューの単一スレッド送信と遅延コンテキストでの並列記録を比較計測
+        if (commands & COMMAND_SUBMIT_BENCHMARK) {
+            renderer_.StartSubmitBenchmark(600);
+        }
+
+        // F7: CPUプロファイラの記録を Chrome トレース(about:tracing / Perfetto)に書き出す
+        if (commands & COMMAND_EXPORT_TRACE) {
+            Profiler::GetInstance().ExportChromeTrace("profile_trace.json");
+        }
+
+        // F6: 表示モードを順に切り替え（タイトルのモード名・FPS・W で比較）
+        if (commands & COMMAND_CYCLE_PRESENT_MODE) {
+            int next = (static_cast<int>(gfx_.GetPresentMode()) + 1) % static_cast<int>(GfxDevice::PresentMode::Count);
+            gfx_.SetPresentMode(static_cast<GfxDevice::PresentMode>(next));
+        }
+
+        // F5: 固定ステップ間の描画補間を切り替え（Uncapped で動きの滑らかさを比較）
+        if (commands & COMMAND_TOGGLE_INTERPOLATION) {
+            renderInterpolationEnabled_ = !renderInterpolationEnabled_;
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("描画補間: ") + (renderInterpolationEnabled_ ? "有効" : "無効"));
+        }
+
+        // F8: 深度プリパスと手前から奥へのソートを切り替え(タイトルの OD で比較)
+        if (commands & COMMAND_TOGGLE_DEPTH_PREPASS) {
+            bool enable = !renderer_.IsDepthPrepassEnabled();
+            renderer_.SetDepthPrepassEnabled(enable);
+            renderer_.SetFrontToBackSortingEnabled(enable);
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("深度プリパス: ") + (enable ? "有効" : "無効"));
+        }
+
+        // F11: 次のフレームの描画キューを書き出す(`--replay-capture frame_capture.hfcp` で再生)
+        if (commands & COMMAND_CAPTURE_FRAME) {
+            renderer_.RequestFrameCapture("frame_capture.hfcp");
+        }
+
+        // F4: シミュレーションと描画の並列実行を切り替え（タイトルの U と FPS で比較）
+        if (commands & COMMAND_TOGGLE_PIPELINE) {
+            SetPipelinedSimulation(!pipelinedSimulation_);
+        }
+
+        // 中クリック: 前回描画したエンティティをカリング用BVHで選択し、境界球を2秒間強調表示
+        if (commands & COMMAND_PICK) {
+            Entity picked{ 0, 0 };
+            DirectX::XMFLOAT3 center;
+            float radius;
+            if (renderer_.Pick(camera_, static_cast<float>(pickX_), static_cast<float>(pickY_),
+                               static_cast<float>(gfx_.Width()), static_cast<float>(gfx_.Height()), picked) &&
+                renderer_.FindProxyBounds(picked, center, radius)) {
+                debugDraw_.DrawShape(DebugDraw::SHAPE_SPHERE,
+                                     DirectX::XMMatrixScaling(radius, radius, radius) * DirectX::XMMatrixTranslation(center.x, center.y, center.z),
+                                     DirectX::XMFLOAT3{ 1.0f, 1.0f, 0.0f }, DebugDraw::Lifetime::Seconds(2.0f), DebugDraw::DEPTH_OVERLAY);
+                DEBUGLOG("ピック: Entity " + std::to_string(picked.id) + " (gen " + std::to_string(picked.gen) + ")");
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief シミュレーションと描画の並列実行の切り替え（シミュレーションが止まっている間に呼ぶ）
+     *
+     * @details
+     * 有効な間、フレーム N の描画は RenderSnapshot に写したフレーム N-1 までの結果を使い、
+     * 同時にシミュレーションスレッドが次のステップを進めます。表示は1フレーム遅れます。
+     * スレッドを起動できない場合は無効のままにします。
+     */
+    void SetPipelinedSimulation(bool enabled) {
+        if (enabled && !simulationThread_.Start()) {
+            DEBUGLOG_WARNING("シミュレーションスレッドを起動できないため並列実行は無効です");
+            enabled = false;
+        }
+        if (enabled && !renderSnapshot_) {
+            renderSnapshot_ = std::make_unique<RenderSnapshot>();
+        }
+        pipelinedSimulation_ = enabled;
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, std::string("シミュレーションの並列実行: ") + (enabled ? "有効" : "無効"));
+    }
+
+    /**
+     * @brief 描画前の準備（world_ の状態を読むため、シミュレーションが止まっている間に呼ぶ）
+     */
+    void PrepareRender() {
+#ifdef _DEBUG
+        DrawDebugInfo();
+        if (renderBenchmark_) {
+            renderBenchmark_->DrawLines(debugDraw_);
+        }
+#endif
+        // 最後のステップから次のステップまでの割合で Transform を補間して描画する
+        float alpha = renderInterpolationEnabled_ ? simulationAccumulator_ / FIXED_TIMESTEP : 1.0f;
+        renderer_.SetInterpolation(alpha, transformSystem_ ? transformSystem_->StepCount() : 0);
+    }
+
 #ifdef _DEBUG
     void UpdateDebugCamera(float deltaTime) {
         const float moveSpeed = 10.0f;
@@ -364,6 +1237,10 @@ private:
     void Shutdown() {
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "App::Shutdown() - クリーンアップ開始");
 
+        // シミュレーションスレッドを止め、描画用の写し（モデルのバッファを参照）を解放
+        simulationThread_.Stop();
+        renderSnapshot_.reset();
+
         // Phase 0: すべてのシステムを停止（新規Spawn無効化）
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 0: すべてのシステムを停止（新規Spawn無効化）");
         world_.StopAllSystems();
@@ -371,6 +1248,15 @@ private:
         // Phase 1: シーンマネージャーの終了（シーンのOnExitを呼び出し）
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 1: SceneManagerのシャットダウン");
         sceneManager_.Shutdown(world_);
+        sceneManager_.SetJobSystem(nullptr);
+
+        // ワーカースレッドを停止（以降のParallelForEachは逐次実行）
+        world_.SetJobSystem(nullptr);
+        renderer_.SetJobSystem(nullptr);
+        resManager_.SetJobSystem(nullptr); // 読み込み中のモデルを待つ
+        ModelLoader::SetJobSystem(nullptr);
+        texManager_.SetJobSystem(nullptr); // デコード中のテクスチャを待つ
+        jobs_.Shutdown();
 
         // Phase 2: WorldのDestroyキュー/Spawnキューを明示的にフラッシュ
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 2: Worldキューをフラッシュ (エンティティ数: " + std::to_string(world_.GetAliveCount()) + ")");
@@ -390,10 +1276,13 @@ private:
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 4: DebugDrawを解放");
         debugDraw_.Shutdown();
 #endif
+        perfOverlay_.Shutdown();
+        sprites_.Shutdown();
 
         // Phase 5: レンダリングシステム解放
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 5: RenderSystemを解放");
         renderer_.Shutdown();
+        materials_.Shutdown();
 
         // Phase 6: テクスチャマネージャー解放
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 6: TextureManagerを解放");
@@ -404,6 +1293,8 @@ private:
 
         // Phase 7: 入力システム解放
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 7: InputSystemを解放");
+        inputSampler_.Stop();
+        inputReplay_.Stop();
         input_.Shutdown();
 
         // Phase 7.5: ゲームパッドシステム解放
@@ -414,6 +1305,15 @@ private:
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 8: GfxDeviceを解放");
         gfx_.Shutdown();
 
+        // 起動時に開始した Media Foundation を終了
+        if (mediaFoundationStarted_) {
+            MFShutdown();
+            mediaFoundationStarted_ = false;
+        }
+
+        // テレメトリの最後の区間を書き出す
+        Telemetry::GetInstance().Close();
+
         // Phase 9: COM終了（最後）
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "Phase 9: COMを終了");
         CoUninitialize();
@@ -473,12 +1373,85 @@ private:
         DEBUGLOG("ウィンドウ作成成功 (HWND: 0x" + std::to_string(reinterpret_cast<uintptr_t>(hwnd_)) + ")");
 
         input_.SetWindowHandle(hwnd_);
-        ShowWindow(hwnd_, SW_SHOW);
-        DEBUGLOG("ウィンドウを表示");
+        if (headless_) {
+            DEBUGLOG("ヘッドレス実行のためウィンドウを表示しません");
+        } else {
+            ShowWindow(hwnd_, SW_SHOW);
+            DEBUGLOG("ウィンドウを表示");
+        }
         DEBUGLOG("CreateAppWindow() 正常に完了");
         return true;
     }
 
+    /**
+     * @brief ECSのシステムの登録とサービスロケータへの登録（グラフィックスの初期化後）
+     */
+    void InitializeWorld() {
+        // Velocity の積分（同じステップの行列に反映するため TransformSystem より先に登録）
+        world_.AddSystem<MovementSystem>();
+
+        // GpuMover のスロットの割り当てと書き戻し（積分と描画は RenderSystem がGPUで行う）
+        world_.AddSystem<GpuMoverSystem>(renderer_.GpuMoverQueue());
+
+        // ScriptInstance のスクリプトをスクリプトごとにまとめて実行（Transform を書くので TransformSystem より先）
+        world_.AddSystem<ScriptSystem>(scripts_);
+
+        // スケルタルアニメーションの評価（スキニング行列のパレットを SkinPose に書く）
+        world_.AddSystem<AnimationSystem>();
+
+        // スプライト・UVスクロールアニメーション（結果を MeshRenderer に直接書く）
+        world_.AddSystem<SpriteAnimationSystem>();
+
+        // ワールド行列のキャッシュと親子階層の伝播（描画はLocalToWorldを参照）
+        transformSystem_ = &world_.AddSystem<TransformSystem>();
+
+        // 別の World で組み立てたエンティティを MergeFrom() で移す際の参照の付け替え
+        world_.RegisterEntityRemap<Parent>([](Parent& p, const EntityRemap& remap) { p.entity = remap(p.entity); });
+        world_.RegisterEntityRemap<ModelPart>([](ModelPart& m, const EntityRemap& remap) { m.root = remap(m.root); });
+
+        // SpatialBody を持つエンティティの近傍検索（Transform と SpatialBody を読むだけなので他の読み取りと並列）
+        spatialGrid_ = &world_.AddSystem<SpatialHashGrid>();
+
+        // 組の詳細判定と接触時の破棄（排他のため、グリッドを更新した後の段で実行）
+        collisionSystem_ = &world_.AddSystem<CollisionSystem>(*spatialGrid_);
+
+        // サービスロケータに登録（GfxDeviceとTextureManagerはInitializeGraphics内で登録済み）
+        ServiceLocator::Register(&jobs_);
+        ServiceLocator::Register(&input_);
+        ServiceLocator::Register(&gamepad_);
+        ServiceLocator::Register(&actions_);
+        ServiceLocator::Register(&world_);
+        ServiceLocator::Register(&renderer_);
+        ServiceLocator::Register(&resManager_);
+        ServiceLocator::Register(&scripts_);
+        ServiceLocator::Register(spatialGrid_);
+        ServiceLocator::Register(collisionSystem_);
+#ifdef _DEBUG
+        resManager_.SetHotReloadEnabled(true);
+        renderer_.SetShaderHotReloadEnabled(true);    // ShaderSource/mesh_*.hlsl の編集を反映
+        scripts_.SetHotReloadEnabled(true);           // 読み込んだスクリプトの編集を反映
+        renderer_.SetPipelineStatisticsEnabled(true); // タイトルにオーバードローを表示
+        gfx_.Profiler().SetEnabled(true);             // タイトルにパスごとのGPU時間を表示
+        Profiler::GetInstance().SetEnabled(true);     // F7 で直近のゾーンを書き出す
+        world_.SetBehaviourTimingEnabled(true);       // 集計ログに重いBehaviourの型を出力
+#endif
+        if (renderBenchmark_) {
+            gfx_.Profiler().SetEnabled(true);                        // CSV の gpu_ms
+            gfx_.SetPresentMode(GfxDevice::PresentMode::Uncapped);  // 表示の待ちを計測に含めない
+        }
+        if (scenarioBenchmark_) {
+            gfx_.Profiler().SetEnabled(true);                        // 結果の gpu 列
+            gfx_.SetPresentMode(GfxDevice::PresentMode::Uncapped);
+        }
+        if (replayBenchmark_) {
+            gfx_.Profiler().SetEnabled(true);                        // CSV の gpu_ms
+            gfx_.SetPresentMode(GfxDevice::PresentMode::Uncapped);
+        }
+        if (headless_) {
+            gfx_.SetPresentMode(GfxDevice::PresentMode::Uncapped);  // 描画するフレームも表示を待たない
+        }
+    }
+
     /**
      * @brief グラフィックス関連の初期化
      * @param[in] width 幅
@@ -508,6 +1481,13 @@ private:
         // Register TextureManager before renderer init so RenderSystem can access textures if needed
         ServiceLocator::Register(&texManager_);
 
+        if (!materials_.Init(gfx_)) {
+            DEBUGLOG("[ERROR] MaterialManager::Init() 失敗");
+            MessageBoxA(nullptr, "MaterialManagerの初期化に失敗", "エラー", MB_OK | MB_ICONERROR);
+            return false;
+        }
+        ServiceLocator::Register(&materials_);
+
         if (!renderer_.Init()) {
             DEBUGLOG("[ERROR] RenderSystem::Init() 失敗");
             MessageBoxA(nullptr, "RenderSystemの初期化に失敗", "エラー", MB_OK | MB_ICONERROR);
@@ -515,29 +1495,73 @@ private:
         }
         DEBUGLOG("RenderSystemを正常に初期化");
 
+        DEBUGLOG("InitializeGraphics() 正常に完了");
+        return true;
+    }
+
+    /**
+     * @brief キーボード・ゲームパッド・入力の記録と再生の初期化（ウィンドウの作成後、メインスレッド）
+     * @return bool 常に true（ゲームパッドが使えなくても続行）
+     */
+    bool InitializeInput() {
         input_.Init();
+        actions_.RegisterDefaults();
         DEBUGLOG("InputSystemを初期化");
 
-        // GamepadSystemを初期化
-     DEBUGLOG("GamepadSystemを初期化中");
-        if (!gamepad_.Init()) {
+        // GamepadSystemを初期化（接続中のウィンドウを GetActiveWindow() で取るためメインスレッドで呼ぶ）
+        DEBUGLOG("GamepadSystemを初期化中");
+        StartupReport::Scope gamepadScope("GamepadSystem.Init");
+        const bool gamepadReady = gamepad_.Init();
+        gamepadScope.End();
+        if (!gamepadReady) {
             DEBUGLOG_WARNING("GamepadSystem::Init() 失敗 - ゲームパッドは利用できません");
-       // 致命的ではないため続行
+            // 致命的ではないため続行
         } else {
-  DEBUGLOG("GamepadSystemを正常に初期化");
-     }
+            DEBUGLOG("GamepadSystemを正常に初期化");
+        }
+
+        if (inputSampleRateHz_ > 0 && !inputSampler_.Start(input_, gamepad_, hwnd_, inputSampleRateHz_)) {
+            DEBUGLOG_WARNING("InputSampler を起動できないため入力はメインスレッドで受け取ります");
+        }
+
+        StartInputReplay();
+        return true;
+    }
 
 #ifdef _DEBUG
+    /**
+     * @brief デバッグ描画の初期化（デバイスだけを使うため、グラフィックスの初期化後にワーカーで実行できる）
+     */
+    bool InitializeDebugDraw() {
         DEBUGLOG("DebugDrawを初期化中 (DEBUGビルド)");
-        if (!debugDraw_.Init(gfx_)) {
+        const size_t maxDebugLines = 10000 + (renderBenchmark_ ? renderBenchmark_->Config().lineCount : 0);
+        if (!debugDraw_.Init(gfx_, maxDebugLines)) {
             DEBUGLOG("[WARNING] DebugDraw::Init() 失敗 - デバッグビジュアライゼーションは利用できません");
             MessageBoxA(nullptr, "DebugDrawの初期化に失敗", "警告", MB_OK | MB_ICONWARNING);
-        } else {
-            DEBUGLOG("DebugDrawを正常に初期化");
+            return false;
         }
+        DEBUGLOG("DebugDrawを正常に初期化");
+        return true;
+    }
 #endif
 
-        DEBUGLOG("InitializeGraphics() 正常に完了");
+    /**
+     * @brief Media Foundation を先に起動しておく（VideoPlayer::Init() の MFStartup を参照カウントの加算だけにする）
+     * @return bool 成功した場合は true（失敗しても動画を使わなければ影響なし）
+     *
+     * @details
+     * ワーカーで実行するため、そのスレッドでも COM を初期化してから呼びます。
+     * 対応する MFShutdown() は Shutdown() で呼びます。
+     */
+    bool StartMediaFoundation() {
+        const HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        HRESULT hr = MFStartup(MF_VERSION);
+        if (SUCCEEDED(hrCom)) CoUninitialize();
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("MFStartup() 失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        mediaFoundationStarted_ = true;
         return true;
     }
 
@@ -563,6 +1587,24 @@ private:
         );
     }
 
+    /**
+     * @brief WM_SIZE で受けた大きさをバックバッファとカメラに反映（フレームの外、メインスレッド）
+     *
+     * @details
+     * デバイスやシェーダーは作り直さず、GfxDevice::Resize() でバックバッファと大きさに依存するリソースだけを変更します。
+     * 最小化中（大きさ0）は元の大きさのままにします。
+     */
+    void ApplyResize() {
+        resizePending_ = false;
+        if (pendingWidth_ == 0 || pendingHeight_ == 0) return;
+        {
+            // 並列時はシミュレーション側のモデル読み込み（即時コンテキストを使う）と排他にする
+            std::lock_guard<std::mutex> lock(gfx_.ResourceMutex());
+            if (!gfx_.Resize(pendingWidth_, pendingHeight_)) return;
+        }
+        camera_.SetAspect(static_cast<float>(gfx_.Width()) / static_cast<float>(gfx_.Height()));
+    }
+
     /**
      * @brief ゲーム関連の初期化
      */
@@ -598,35 +1640,72 @@ private:
     }
 
     /**
-     * @brief ウィンドウタイトルを更新する
+     * @brief 区間の合計を平均にして表示用の統計を更新し、合計をリセット（表示の間隔ごとに1回）
      */
-    void UpdateWindowTitle() {
-        if (sceneManager_.GetCurrentScene()) {
-            std::wstringstream ss;
-            ss << L"はじく！" ;
-            SetWindowTextW(hwnd_, ss.str().c_str());
-        }
+    void PublishFrameStats(double now) {
+        if (metricsFrameCount_ == 0) return;
+        const float n = static_cast<float>(metricsFrameCount_);
+        FrameMetrics& a = displayedStats_.average;
+        a.updateTime = avgMetrics_.updateTime / n;
+        a.renderTime = avgMetrics_.renderTime / n;
+        a.presentTime = avgMetrics_.presentTime / n;
+        a.totalTime = avgMetrics_.totalTime / n;
+        a.gpuTime = avgMetrics_.gpuTime / n;
+        a.gpuInstancedTime = avgMetrics_.gpuInstancedTime / n;
+        a.gpuQueueTime = avgMetrics_.gpuQueueTime / n;
+        a.gpuDebugDrawTime = avgMetrics_.gpuDebugDrawTime / n;
+        a.gpuParticleTime = avgMetrics_.gpuParticleTime / n;
+        a.pacingWaitTime = avgMetrics_.pacingWaitTime / n;
+        a.simulationSteps = avgMetrics_.simulationSteps / n;
+        displayedStats_.fps = a.totalTime > 0.0f ? 1.0f / a.totalTime : 0.0f;
+        FrameHistogram lastSecond;
+        frameHistograms_->total.Window(1, now, lastSecond);
+        displayedStats_.frameP99Ms = lastSecond.PercentileSeconds(99.0) * 1000.0f;
+        displayedStats_.frames = metricsFrameCount_;
+
+        avgMetrics_ = FrameMetrics{};
+        metricsFrameCount_ = 0;
     }
 
     /**
-     * @brief ウィンドウタイトルにメトリクスを含めて更新する
+     * @brief ウィンドウタイトルを設定（内容が変わったときだけ SetWindowTextW() を呼ぶ）
      */
-    void UpdateWindowTitleWithMetrics() {
-        if (sceneManager_.GetCurrentScene() && metricsFrameCount_ > 0) {
-            float avgUpdate = avgMetrics_.updateTime / metricsFrameCount_ * 1000.0f; // ms
-            float avgRender = avgMetrics_.renderTime / metricsFrameCount_ * 1000.0f; // ms
-            float avgPresent = avgMetrics_.presentTime / metricsFrameCount_ * 1000.0f; // ms
-            float avgTotal = avgMetrics_.totalTime / metricsFrameCount_; // s
-            float fps = (avgTotal > 0.0f) ? (1.0f / avgTotal) : 0.0f;
+    void SetWindowTitle(const wchar_t* title) {
+        if (!hwnd_ || std::wcscmp(windowTitle_, title) == 0) return;
+        wcsncpy_s(windowTitle_, title, _TRUNCATE);
+        SetWindowTextW(hwnd_, windowTitle_);
+    }
 
-            std::wstringstream ss;
-            ss << L"はじく！"
-               << L" | FPS: " << static_cast<int>(fps)
-               << L" (U:" << std::fixed << std::setprecision(1) << avgUpdate
-               << L"ms R:" << avgRender
-               << L"ms P:" << avgPresent << L"ms)";
-            SetWindowTextW(hwnd_, ss.str().c_str());
+    /**
+     * @brief ウィンドウタイトルにメトリクスを含めて更新する（DisplayedFrameStats の値、表示の間隔ごと）
+     */
+    void UpdateWindowTitleWithMetrics() {
+        const DisplayedFrameStats& d = displayedStats_;
+        if (!sceneManager_.GetCurrentScene() || d.frames == 0) return;
+        const FrameMetrics& a = d.average;
+
+        wchar_t title[256];
+        int len = swprintf_s(title, L"はじく！ | %hs FPS: %d (U:%.1fms R:%.1fms P:%.1fms W:%.1fms) S:%.1f%ls%ls",
+                             GfxDevice::PresentModeName(gfx_.GetPresentMode()), static_cast<int>(d.fps),
+                             a.updateTime * 1000.0f, a.renderTime * 1000.0f, a.presentTime * 1000.0f, a.pacingWaitTime * 1000.0f,
+                             a.simulationSteps, renderInterpolationEnabled_ ? L"" : L" (補間なし)", pipelinedSimulation_ ? L" (並列)" : L"");
+        auto append = [&title, &len](const wchar_t* format, auto... args) {
+            if (len < 0 || len >= static_cast<int>(std::size(title))) return;
+            const int written = swprintf_s(title + len, std::size(title) - len, format, args...);
+            if (written > 0) len += written;
+        };
+        if (gfx_.RenderScale() < 1.0f) {
+            append(L" Res:%d%%", static_cast<int>(gfx_.RenderScale() * 100.0f + 0.5f));
+        }
+        append(L" p99:%.1fms", d.frameP99Ms);
+        if (gfx_.Profiler().IsEnabled()) {
+            append(L" GPU:%.1fms (I:%.1f Q:%.1f P:%.1f D:%.1f)", a.gpuTime * 1000.0f, a.gpuInstancedTime * 1000.0f,
+                   a.gpuQueueTime * 1000.0f, a.gpuParticleTime * 1000.0f, a.gpuDebugDrawTime * 1000.0f);
         }
+        if (renderer_.IsPipelineStatisticsEnabled()) {
+            append(L" OD:%.2f", renderer_.GetStatistics().overdraw);
+        }
+        SetWindowTitle(title);
     }
 
 #ifdef _DEBUG
@@ -650,63 +1729,190 @@ private:
             DirectX::XMFLOAT3 pos = t.position;
             DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 0.0f }; // 黄色
 
-            // キューブのエッジを描画
-            debugDraw_.AddLine(
-                {pos.x - size, pos.y - size, pos.z - size},
-                {pos.x + size, pos.y - size, pos.z - size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x + size, pos.y - size, pos.z - size},
-                {pos.x + size, pos.y + size, pos.z - size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x + size, pos.y + size, pos.z - size},
-                {pos.x - size, pos.y + size, pos.z - size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x - size, pos.y + size, pos.z - size},
-                {pos.x - size, pos.y - size, pos.z - size},
-                color);
-
-            // Back face
-            debugDraw_.AddLine(
-                {pos.x - size, pos.y - size, pos.z + size},
-                {pos.x + size, pos.y - size, pos.z + size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x + size, pos.y - size, pos.z + size},
-                {pos.x + size, pos.y + size, pos.z + size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x + size, pos.y + size, pos.z + size},
-                {pos.x - size, pos.y + size, pos.z + size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x - size, pos.y + size, pos.z + size},
-                {pos.x - size, pos.y - size, pos.z + size},
-                color);
-
-            // Connections between front and back
-            debugDraw_.AddLine(
-                {pos.x - size, pos.y - size, pos.z - size},
-                {pos.x - size, pos.y - size, pos.z + size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x + size, pos.y - size, pos.z - size},
-                {pos.x + size, pos.y - size, pos.z + size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x + size, pos.y + size, pos.z - size},
-                {pos.x + size, pos.y + size, pos.z + size},
-                color);
-            debugDraw_.AddLine(
-                {pos.x - size, pos.y + size, pos.z - size},
-                {pos.x - size, pos.y + size, pos.z + size},
-                color);
+            debugDraw_.DrawBox(pos, DirectX::XMFLOAT3{ size, size, size }, color);
         });
     }
 #endif
 
+    /**
+     * @brief テレメトリの書き出し先を開き、フレームのメトリクスを登録
+     * @details 開けない場合も記録は続けます(書き出しのみ行わない)。
+     */
+    void InitializeTelemetry() {
+        Telemetry& t = Telemetry::GetInstance();
+        if (!t.Open("telemetry.csv")) {
+            DEBUGLOG_WARNING("telemetry.csv を開けません。テレメトリは書き出されません");
+        }
+        telemetry_.frames = t.RegisterCounter("frames");
+        telemetry_.frameMs = t.RegisterHistogram("frame_ms");
+        telemetry_.updateMs = t.RegisterHistogram("update_ms");
+        telemetry_.renderMs = t.RegisterHistogram("render_ms");
+        telemetry_.presentMs = t.RegisterHistogram("present_ms");
+        telemetry_.entities = t.RegisterGauge("entities");
+        telemetry_.entitiesCreated = t.RegisterGauge("entities_created");
+        telemetry_.entitiesDestroyed = t.RegisterGauge("entities_destroyed");
+        telemetry_.ecsBytes = t.RegisterGauge("ecs_estimated_bytes");
+        telemetry_.drawCalls = t.RegisterGauge("draw_calls");
+        telemetry_.triangles = t.RegisterGauge("triangles");
+        telemetry_.textureBinds = t.RegisterGauge("texture_binds");
+        telemetry_.constantBufferBytes = t.RegisterGauge("constant_buffer_bytes");
+        // Telemetry は名前のポインタを保持するため静的な文字列で登録する
+        static const char* const renderPassHistograms[RenderSystem::Statistics::PASS_COUNT] = {
+            "render_lights_ms", "render_extract_ms", "render_culling_ms", "render_models_ms", "render_static_batches_ms",
+            "render_shadows_ms", "render_instanced_ms", "render_queue_ms", "render_particles_ms"
+        };
+        for (uint32_t pass = 0; pass < RenderSystem::Statistics::PASS_COUNT; ++pass) {
+            telemetry_.renderPassMs[pass] = t.RegisterHistogram(renderPassHistograms[pass]);
+        }
+        telemetry_.frameArenaBytes = t.RegisterGauge("frame_arena_bytes");
+        static const char* const memoryGauges[MemoryTracker::TAG_COUNT] = {
+            "mem_ecs_bytes", "mem_render_bytes", "mem_textures_bytes", "mem_models_bytes", "mem_logging_bytes"
+        };
+        MemoryTracker& mem = MemoryTracker::GetInstance();
+        for (size_t i = 0; i < MemoryTracker::TAG_COUNT; ++i) {
+            telemetry_.memoryBytes[i] = t.RegisterGauge(memoryGauges[i]);
+            mem.SetBudget(static_cast<MemoryTag>(i), DEFAULT_MEMORY_BUDGETS[i]);
+        }
+    }
+
+    /**
+     * @brief 暗黙に解放されるリソース(テクスチャ・モデル・描画バッファ)の使用量を数え直し、予算を確認
+     *
+     * @details
+     * ECS と描画の作業用配列は TrackedAllocator が確保のたびに加算するため、ここでは数えません。
+     * 並列シミュレーション中のモデル読み込みと重ならないよう GfxDevice::ResourceMutex() を取ります。
+     */
+    void UpdateMemoryTracking() {
+        MemoryTracker& mem = MemoryTracker::GetInstance();
+        {
+            std::lock_guard<std::mutex> lock(gfx_.ResourceMutex());
+            size_t renderGpuBytes = renderer_.GpuMemoryBytes();
+#ifdef _DEBUG
+            renderGpuBytes += debugDraw_.GpuMemoryBytes();
+#endif
+            renderGpuBytes += sprites_.GpuMemoryBytes();
+            renderGpuBytes += materials_.GpuMemoryBytes();
+            mem.Report(MemoryTag::Render, MemoryKind::Gpu, renderGpuBytes);
+            mem.Report(MemoryTag::Textures, MemoryKind::Gpu, texManager_.GpuMemoryBytes());
+            mem.Report(MemoryTag::Textures, MemoryKind::Cpu, texManager_.CpuMemoryBytes());
+            mem.Report(MemoryTag::Models, MemoryKind::Gpu, resManager_.GpuMemoryBytes() + gfx_.MeshGpuMemoryBytes());
+        }
+        mem.Report(MemoryTag::Logging, MemoryKind::Cpu, DebugLog::GetInstance().GetMemoryBytes());
+
+        Telemetry& t = Telemetry::GetInstance();
+        for (size_t i = 0; i < MemoryTracker::TAG_COUNT; ++i) {
+            t.Set(telemetry_.memoryBytes[i], static_cast<double>(mem.Live(static_cast<MemoryTag>(i))));
+        }
+        mem.CheckBudgets();
+    }
+
+    /**
+     * @brief 現在のフレームの計測値をオーバーレイに渡す（次のフレームの描画で表示）
+     *
+     * @details
+     * グラフの履歴は非表示の間も進め、文字と棒は表示中に refreshText のとき（表示の間隔ごと）だけ作り直します。
+     * フレーム時間は DisplayedFrameStats の区間の平均です。World の数は同期点で控えた値を使うため、並列シミュレーション中でも world_ には触れません。
+     */
+    void UpdatePerfOverlay(bool refreshText) {
+        const float ms[PerfOverlay::SERIES_COUNT] = {
+            currentMetrics_.updateTime * 1000.0f,
+            currentMetrics_.renderTime * 1000.0f,
+            currentMetrics_.presentTime * 1000.0f,
+            currentMetrics_.gpuTime * 1000.0f,
+        };
+        perfOverlay_.PushFrame(ms);
+        if (!perfOverlay_.IsVisible()) return;
+        // 文字は表示の間隔ごとに積み直す（表示し始めたフレームはすぐに作る）
+        if (!refreshText && perfOverlay_.HasText()) return;
+        perfOverlay_.ClearText();
+
+        char line[128];
+        const float frameMs = displayedStats_.average.totalTime * 1000.0f;
+        sprintf_s(line, "FRAME %.2f MS (%d FPS)  P99 %.2f MS %s", frameMs, static_cast<int>(displayedStats_.fps),
+                  displayedStats_.frameP99Ms, pipelinedSimulation_ ? "PIPELINED" : "");
+        perfOverlay_.AddText(line, frameMs > PerfOverlay::TARGET_MS ? PerfOverlay::COLOR_WARN : PerfOverlay::COLOR_TEXT);
+
+        const WorldStats& ws = simulatedWorldStats_;
+        sprintf_s(line, "ENTITIES %zu  BEHAVIOURS %zu", ws.alive, ws.behaviours);
+        perfOverlay_.AddText(line);
+        sprintf_s(line, "CREATED %u  DESTROYED %u  STORES %zu  ECS %zu KB", ws.createdLastFrame, ws.destroyedLastFrame, ws.stores,
+                  ws.EstimatedBytes() / 1024);
+        perfOverlay_.AddText(line, PerfOverlay::COLOR_DIM);
+        sprintf_s(line, "POOLED %zu  REUSE %.0f%%", simulatedDormantCount_, simulatedPoolHitRate_ * 100.0);
+        perfOverlay_.AddText(line, PerfOverlay::COLOR_DIM);
+        if (simulatedStreaming_) {
+            sprintf_s(line, "STREAMING %.0f%%", simulatedStreamProgress_ * 100.0f);
+            perfOverlay_.AddText(line, PerfOverlay::COLOR_WARN);
+        }
+        if (simulatedCellStreaming_) {
+            const CellStreamerStats& cs = simulatedCellStats_;
+            sprintf_s(line, "CELLS %zu/%zu  LOADING %zu  UNLOADING %zu  RESIDENT %zu", cs.loaded, cs.cells, cs.loading, cs.unloading,
+                      cs.residentEntities);
+            perfOverlay_.AddText(line, cs.loading + cs.unloading > 0 ? PerfOverlay::COLOR_WARN : PerfOverlay::COLOR_DIM);
+        }
+
+        const RenderSystem::Statistics& rs = renderer_.GetStatistics();
+        sprintf_s(line, "DRAWS %zu  INSTANCED %zu  INSTANCES %zu", rs.totalDrawCalls, rs.instancedDraws, rs.instancesRendered);
+        perfOverlay_.AddText(line);
+        sprintf_s(line, "PROXIES %zu  CULLED %zu (BVH %zu)  STATE %zu", rs.proxies, rs.culled, rs.treeCulled, rs.stateChanges);
+        perfOverlay_.AddText(line, PerfOverlay::COLOR_DIM);
+        using RenderStats = RenderSystem::Statistics;
+        sprintf_s(line, "TRIS %zuK  TEX %zu  CB %zu KB  (SH %zu MAT %zu TX %zu MESH %zu)", rs.trianglesRendered / 1000, rs.textureBinds,
+                  rs.constantBufferBytes / 1024, rs.stateChangesByKind[RenderStats::STATE_SHADER],
+                  rs.stateChangesByKind[RenderStats::STATE_MATERIAL], rs.stateChangesByKind[RenderStats::STATE_TEXTURE],
+                  rs.stateChangesByKind[RenderStats::STATE_MESH]);
+        perfOverlay_.AddText(line, PerfOverlay::COLOR_DIM);
+        // 段階ごとのCPU時間は履歴の平均(1フレームの値は揺れが大きい)
+        sprintf_s(line, "CPU EXT %.2f  MDL %.2f  SHD %.2f  INST %.2f  QUEUE %.2f ms",
+                  renderer_.AveragePassMs(RenderStats::PASS_EXTRACT), renderer_.AveragePassMs(RenderStats::PASS_MODELS),
+                  renderer_.AveragePassMs(RenderStats::PASS_SHADOWS), renderer_.AveragePassMs(RenderStats::PASS_INSTANCED),
+                  renderer_.AveragePassMs(RenderStats::PASS_QUEUE));
+        perfOverlay_.AddText(line, PerfOverlay::COLOR_DIM);
+        const SpriteBatch::Statistics& ss = sprites_.GetStatistics();
+        sprintf_s(line, "SPRITES %zu  DRAWS %zu  TEX %zu  WRAPS %zu", ss.sprites, ss.draws, ss.textureBinds, ss.ringWraps);
+        perfOverlay_.AddText(line, PerfOverlay::COLOR_DIM);
+
+#ifdef _DEBUG
+        const DebugDraw::Statistics& ds = debugDraw_.GetStatistics();
+        sprintf_s(line, "LINES %zu  SHAPES %zu  KEPT %zu  DROPPED %zu", ds.linesDrawn, ds.shapesDrawn, ds.persistentCount,
+                  ds.linesDropped);
+        perfOverlay_.AddText(line, ds.linesDropped > 0 ? PerfOverlay::COLOR_WARN : PerfOverlay::COLOR_DIM);
+#endif
+
+        // メモリは UpdateMemoryTracking() が MEMORY_REPORT_INTERVAL ごとに数え直した値
+        const MemoryTracker& mem = MemoryTracker::GetInstance();
+        for (size_t i = 0; i < MemoryTracker::TAG_COUNT; ++i) {
+            const MemoryTag tag = static_cast<MemoryTag>(i);
+            perfOverlay_.AddBar(MemoryTracker::TagName(tag), mem.Live(tag), mem.Budget(tag));
+        }
+    }
+
+    /**
+     * @brief 現在のフレームのメトリクスをテレメトリに記録(間隔ごとに書き出す)
+     */
+    void RecordTelemetry() {
+        Telemetry& t = Telemetry::GetInstance();
+        t.Add(telemetry_.frames);
+        t.Record(telemetry_.frameMs, currentMetrics_.totalTime * 1000.0f);
+        t.Record(telemetry_.updateMs, currentMetrics_.updateTime * 1000.0f);
+        t.Record(telemetry_.renderMs, currentMetrics_.renderTime * 1000.0f);
+        t.Record(telemetry_.presentMs, currentMetrics_.presentTime * 1000.0f);
+        t.Set(telemetry_.entities, static_cast<double>(simulatedWorldStats_.alive));
+        t.Set(telemetry_.entitiesCreated, static_cast<double>(simulatedWorldStats_.createdLastFrame));
+        t.Set(telemetry_.entitiesDestroyed, static_cast<double>(simulatedWorldStats_.destroyedLastFrame));
+        t.Set(telemetry_.ecsBytes, static_cast<double>(simulatedWorldStats_.EstimatedBytes()));
+        const RenderSystem::Statistics& rs = renderer_.GetStatistics();
+        t.Set(telemetry_.drawCalls, static_cast<double>(rs.totalDrawCalls));
+        t.Set(telemetry_.triangles, static_cast<double>(rs.trianglesRendered));
+        t.Set(telemetry_.textureBinds, static_cast<double>(rs.textureBinds));
+        t.Set(telemetry_.constantBufferBytes, static_cast<double>(rs.constantBufferBytes));
+        for (uint32_t pass = 0; pass < RenderSystem::Statistics::PASS_COUNT; ++pass) {
+            t.Record(telemetry_.renderPassMs[pass], rs.passMs[pass]);
+        }
+        t.Set(telemetry_.frameArenaBytes, static_cast<double>(FrameArena::ForThread().Used()));
+        t.Update();
+    }
+
     /**
      * @brief フレーム統計を出力する
      * @details
@@ -714,30 +1920,38 @@ private:
      * （平均、最小、最大、99%タイル）をログに出力します。
      */
     void OutputFrameStatistics() {
-        if (frameTotalSamples_.empty()) {
+        const FrameTimeHistograms& h = *frameHistograms_;
+        if (h.total.Total().Count() == 0) {
             DEBUGLOG_WARNING("フレーム統計データが収集されていません");
             return;
         }
 
+        const double now = MetricsSeconds();
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "========================================");
-        DEBUGLOG_CATEGORY(DebugLog::Category::System, "フレーム統計サマリ (サンプル数: " + std::to_string(frameTotalSamples_.size()) + ")");
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "フレーム統計サマリ (サンプル数: " + std::to_string(h.total.Total().Count()) + ")");
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "========================================");
 
         // 各メトリクスの統計を計算
-        OutputMetricStatistics("フレーム合計時間", frameTotalSamples_, "ms");
-        OutputMetricStatistics("Update時間", updateSamples_, "ms");
-        OutputMetricStatistics("Render時間", renderSamples_, "ms");
-        OutputMetricStatistics("Present時間", presentSamples_, "ms");
-
-        // FPS統計
-        std::vector<float> fpsSamples;
-        fpsSamples.reserve(frameTotalSamples_.size());
-        for (float t : frameTotalSamples_) {
-            if (t > 0.0f) {
-                fpsSamples.push_back(1.0f / t);
-            }
+        OutputMetricStatistics("フレーム合計時間", frameHistograms_->total, now);
+        OutputMetricStatistics("Update時間", frameHistograms_->update, now);
+        OutputMetricStatistics("Render時間", frameHistograms_->render, now);
+        OutputMetricStatistics("Present時間", frameHistograms_->present, now);
+        OutputMetricStatistics("GPU時間", frameHistograms_->gpu, now);
+
+        // FPS統計（フレーム時間の分布から換算、1%Low は99%タイルのフレーム時間）
+        const FrameHistogram& total = h.total.Total();
+        auto toFps = [](float seconds) { return seconds > 0.0f ? 1.0f / seconds : 0.0f; };
+        std::ostringstream oss;
+        oss << "FPS: 平均=" << std::fixed << std::setprecision(2) << toFps(total.MeanSeconds())
+            << ", 中央値=" << toFps(total.PercentileSeconds(50.0))
+            << ", 1%Low=" << toFps(total.PercentileSeconds(99.0))
+            << ", 最低=" << toFps(total.MaxSeconds());
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, oss.str());
+
+        if (droppedSimulationTime_ > 0.0) {
+            DEBUGLOG_FMT_WARNING(DebugLog::Category::System, "処理落ちで捨てたシミュレーション時間: {}s (1フレーム最大{}ステップ)",
+                                 droppedSimulationTime_, MAX_SIMULATION_STEPS);
         }
-        OutputMetricStatistics("FPS", fpsSamples, "");
 
         DEBUGLOG_CATEGORY(DebugLog::Category::System, "========================================");
     }
@@ -745,61 +1959,65 @@ private:
     /**
      * @brief メトリクス統計を出力する
      * @param name メトリクス名
-     * @param samples サンプルデータ
-     * @param unit 単位
+     * @param histogram 分布
+     * @param now 現在時刻（MetricsSeconds()）
+     * @details セッション全体の統計と、直近1秒/10秒/60秒の99%タイルを出力します。
      */
-    void OutputMetricStatistics(const std::string& name, std::vector<float> samples, const std::string& unit) {
-        if (samples.empty()) return;
-
-        // 外れ値フィルタリング（上位1%と下位1%を除外）
-        std::sort(samples.begin(), samples.end());
-
-        size_t removeCount = static_cast<size_t>(samples.size() * 0.01);
-        if (removeCount > 0 && samples.size() > removeCount * 2) {
-            samples.erase(samples.begin(), samples.begin() + removeCount); // 下位1%を除外
-            samples.erase(samples.end() - removeCount, samples.end());     // 上位1%を除外
-        }
-
-        if (samples.empty()) {
-            DEBUGLOG_WARNING(name + ": 外れ値除外後にサンプルが空になりました");
-            return;
-        }
+    void OutputMetricStatistics(const std::string& name, RollingFrameHistogram& histogram, double now) {
+        const FrameHistogram& total = histogram.Total();
+        if (total.Count() == 0) return;
 
-        // 統計計算
-        float sum = 0.0f;
-        for (float s : samples) sum += s;
-        float avg = sum / samples.size();
-        float min = samples.front();
-        float max = samples.back();
+        FrameHistogram window1, window10, window60;
+        histogram.Window(1, now, window1);
+        histogram.Window(10, now, window10);
+        histogram.Window(60, now, window60);
 
-        // 99%タイル（上位1%を除外）
-        size_t p99Index = static_cast<size_t>(samples.size() * 0.99);
-        if (p99Index >= samples.size()) p99Index = samples.size() - 1;
-        float p99 = samples[p99Index];
-
-        // 50%タイル（中央値）
-        size_t p50Index = samples.size() / 2;
-        float p50 = samples[p50Index];
-
-        // 1%タイル（下位1%）
-        size_t p01Index = static_cast<size_t>(samples.size() * 0.01);
-        float p01 = samples[p01Index];
+        std::ostringstream oss;
+        oss << name << " (サンプル数: " << total.Count() << "): "
+            << "平均=" << std::fixed << std::setprecision(2) << (total.MeanSeconds() * 1000.0f) << "ms"
+            << ", 最小=" << (total.MinSeconds() * 1000.0f) << "ms"
+            << ", 1%タイル=" << (total.PercentileSeconds(1.0) * 1000.0f) << "ms"
+            << ", 中央値=" << (total.PercentileSeconds(50.0) * 1000.0f) << "ms"
+            << ", 99%タイル=" << (total.PercentileSeconds(99.0) * 1000.0f) << "ms"
+            << ", 最大=" << (total.MaxSeconds() * 1000.0f) << "ms"
+            << " | 直近1s/10s/60sの99%タイル=" << (window1.PercentileSeconds(99.0) * 1000.0f)
+            << "/" << (window10.PercentileSeconds(99.0) * 1000.0f)
+            << "/" << (window60.PercentileSeconds(99.0) * 1000.0f) << "ms";
 
-        // ログ出力（msの場合は1000倍、FPSの場合はそのまま）
-        float multiplier = (unit == "ms") ? 1000.0f : 1.0f;
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, oss.str());
+    }
 
+    /**
+     * @brief 直近10秒のフレーム時間の百分位をログ出力する
+     */
+    void LogRecentPercentiles(double now) {
+        FrameHistogram window;
+        frameHistograms_->total.Window(10, now, window);
+        if (window.Count() == 0) return;
         std::ostringstream oss;
-        oss << name << " (外れ値除外後サンプル数: " << samples.size() << "): "
-            << "平均=" << std::fixed << std::setprecision(2) << (avg * multiplier) << unit
-            << ", 最小=" << (min * multiplier) << unit
-            << ", 1%タイル=" << (p01 * multiplier) << unit
-            << ", 中央値=" << (p50 * multiplier) << unit
-            << ", 99%タイル=" << (p99 * multiplier) << unit
-            << ", 最大=" << (max * multiplier) << unit;
-
+        oss << "フレーム時間(直近10s): 中央値=" << std::fixed << std::setprecision(2) << (window.PercentileSeconds(50.0) * 1000.0f)
+            << "ms, 99%タイル=" << (window.PercentileSeconds(99.0) * 1000.0f)
+            << "ms, 最大=" << (window.MaxSeconds() * 1000.0f) << "ms";
         DEBUGLOG_CATEGORY(DebugLog::Category::System, oss.str());
     }
 
+    /**
+     * @brief ヒストグラムの時刻（App 作成からの秒）
+     */
+    double MetricsSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - metricsStartTime_).count();
+    }
+
+    /**
+     * @brief 未処理の例外フィルター(デバッグビルドのみ登録)
+     * @details DebugLog の書き込みスレッドに残ったログを書き出してから既定の処理に任せます。
+     */
+    static LONG WINAPI UnhandledExceptionFilterStatic(EXCEPTION_POINTERS* info) {
+        DEBUGLOG_ERROR("未処理の例外 (コード: 0x" + std::to_string(info ? info->ExceptionRecord->ExceptionCode : 0) + ")");
+        DebugLog::GetInstance().Flush(1000);
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
     // ========================================================
     // Windowsメッセージ処理
     // ========================================================
@@ -845,9 +2063,33 @@ private:
             PostQuitMessage(0);
             return 0;
 
+        case WM_SIZE:
+            // 反映はメインループのフレームの外で行う（枠のドラッグ中に何度届いても最後の大きさだけ）
+            pendingWidth_ = LOWORD(lp);
+            pendingHeight_ = HIWORD(lp);
+            resizePending_ = true;
+            return 0;
+
         case WM_MOUSEWHEEL:
             input_.OnMouseWheel(GET_WHEEL_DELTA_WPARAM(wp));
             return 0;
+
+        case WM_INPUT:
+            input_.OnRawInput(reinterpret_cast<HRAWINPUT>(lp));
+            return DefWindowProc(hWnd, msg, wp, lp); // RIM_INPUT のバッファを解放させる
+
+        case WM_MOUSEMOVE:
+            input_.OnMouseMove(static_cast<short>(LOWORD(lp)), static_cast<short>(HIWORD(lp)));
+            return 0;
+
+        case WM_KILLFOCUS:
+            input_.OnFocusLost();
+            return DefWindowProc(hWnd, msg, wp, lp);
+
+        case WM_DEVICECHANGE:
+            // ゲームパッドの抜き差し(列挙はバックグラウンドのスレッドで行う)
+            gamepad_.OnDeviceChange();
+            return DefWindowProc(hWnd, msg, wp, lp);
         }
 
         return DefWindowProc(hWnd, msg, wp, lp);
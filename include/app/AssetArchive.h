@@ -0,0 +1,452 @@
+/**
+ * @file AssetArchive.h
+ * @brief 目次と整列したデータを1ファイルにまとめたアセットのアーカイブ(pak)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * モデル・テクスチャはファイルごとに Assimp / WIC / DdsLoader が開くため、ファイル数だけオープンとシークが発生します。
+ * AssetArchive は起動時にアーカイブを1回だけ開いてメモリマップし、以降の読み込みはマップした領域を参照するだけです。
+ *
+ * - ModelLoader: Assimp の IOSystem(ArchiveIOSystem.h)で .fbx / .obj と、同じディレクトリの参照ファイル(.mtl など)を読む
+ * - TextureManager: WIC のメモリ上のストリーム(IWICStream::InitializeFromMemory)で読む。.dds は DdsLoader がマップした領域から読む
+ * - MeshCacheFile: .meshcache をマップした領域から読む(元のモデルが個別のファイルになければ鮮度を確認せずに使う)
+ * - VideoPlayer: Media Foundation はファイル名(URL)から開くため、動画は従来どおり個別のファイルのまま
+ *
+ * アーカイブに含まれるパスはアーカイブを優先し、含まれないパスは従来どおり個別のファイルから読みます。
+ * アーカイブを消せば開発中の個別のファイルに戻ります。パスは大文字小文字と '/' '\\' を区別しません。
+ *
+ * ### ファイルレイアウト:
+ * - Header(目次の位置と件数)
+ * - データ: ファイルごとにパスの順(同じディレクトリのファイルが隣り合い、順に読むとシークが少ない)。先頭は ALIGNMENT 境界
+ * - 目次: Entry をパスのハッシュ順に並べた配列(二分探索)と、パスの文字列
+ *
+ * 圧縮は util::Lz4 のブロック形式で、縮む割合が COMPRESS_MIN_SAVING 未満のファイル(PNG・JPEG など圧縮済みの形式)はそのまま格納します。
+ * そのまま格納したファイルはマップした領域を直接参照し、圧縮したファイルは Read() が呼び出し側のバッファへ展開します。
+ *
+ * @par 作成・使用例
+ * @code
+ * // 作成(`HEW_GAME.exe --build-pak` は Assets を Assets.pak にまとめて終了)
+ * std::string error;
+ * AssetArchive::Build("Assets", "Assets.pak", true, error);
+ *
+ * // 起動時(main.cpp が Assets.pak があれば自動でマウント)
+ * AssetArchive::GetInstance().Mount("Assets.pak");
+ * AssetArchive::Blob blob;
+ * if (AssetArchive::GetInstance().Read("Assets/Textures/test.png", blob)) {
+ *     // blob.data / blob.size
+ * }
+ * @endcode
+ *
+ * @note Mount() / Unmount() は読み込みの前後(起動・終了時)に呼んでください。Read() / Contains() は複数スレッドから同時に呼べます。
+ */
+#pragma once
+#include <Windows.h>
+#include "app/CommandLine.h"
+#include "app/DebugLog.h"
+#include "util/Lz4.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct AssetArchiveConfig
+ * @brief アーカイブのコマンドライン設定
+ *
+ * @details
+ * - `--pak <path>`: マウントするアーカイブ(既定 Assets.pak。なければ個別のファイルから読む)
+ * - `--no-pak`: アーカイブがあってもマウントしない
+ * - `--build-pak`: sourceDirectory を path にまとめて終了(`--pak-store` で圧縮しない)
+ */
+struct AssetArchiveConfig {
+    std::string path = "Assets.pak";      ///< アーカイブのパス
+    std::string sourceDirectory = "Assets"; ///< --build-pak でまとめるディレクトリ
+    bool mount = true;                    ///< 起動時にマウントするか
+    bool build = false;                   ///< 作成して終了するか
+    bool compress = true;                 ///< 作成時に縮むファイルを圧縮するか
+
+    /**
+     * @brief コマンドラインを解析
+     * @return bool アーカイブのオプションが1つでも指定された場合 true(指定がなくても out は既定値で有効)
+     */
+    static bool Parse(const char* cmdLine, AssetArchiveConfig& out) {
+        out = AssetArchiveConfig();
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+
+        bool any = false;
+        for (size_t i = 0; i < args.size(); ++i) {
+            const std::string& key = args[i];
+            if (key == "--pak" && i + 1 < args.size()) out.path = args[++i];
+            else if (key == "--no-pak") out.mount = false;
+            else if (key == "--build-pak") out.build = true;
+            else if (key == "--pak-store") out.compress = false;
+            else continue;
+            any = true;
+        }
+        return any;
+    }
+};
+
+/**
+ * @class AssetArchive
+ * @brief メモリマップしたアセットのアーカイブ(プロセスで1つ)
+ */
+class AssetArchive {
+public:
+    static constexpr uint32_t MAGIC = 0x4B415048;         ///< "HPAK"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t ALIGNMENT = 4096;           ///< データの先頭の境界(ページ)
+    static constexpr uint32_t FLAG_LZ4 = 1;               ///< util::Lz4 のブロック形式で圧縮
+    static constexpr uint64_t COMPRESS_MIN_SAVING = 8;    ///< 元の 1/8 以上縮む場合だけ圧縮して格納
+
+    /**
+     * @struct Blob
+     * @brief 読み込んだファイルの内容
+     *
+     * @details 圧縮していないファイルはマップした領域(Unmount() まで有効)、圧縮したファイルは storage を指します。
+     */
+    struct Blob {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        std::vector<uint8_t> storage;  ///< 展開先(圧縮したファイルのみ)
+    };
+
+    static AssetArchive& GetInstance() {
+        static AssetArchive instance;
+        return instance;
+    }
+
+    ~AssetArchive() { Unmount(); }
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    /**
+     * @brief アーカイブを開いてメモリマップする(既にマウントしていれば先に外す)
+     * @return bool 目次まで正しく読めた場合 true
+     */
+    bool Mount(const std::string& path) {
+        Unmount();
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(Header))) return fail(path, "サイズが不正です");
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_) base_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!base_) return fail(path, "メモリマップ失敗");
+        size_ = static_cast<size_t>(size.QuadPart);
+
+        Header header;
+        std::memcpy(&header, base_, sizeof(Header));
+        if (header.magic != MAGIC || header.version != VERSION) return fail(path, "形式が異なります");
+        const uint64_t entryBytes = static_cast<uint64_t>(header.entryCount) * sizeof(Entry);
+        if (header.tocOffset > size_ || entryBytes + header.pathBytes > size_ - header.tocOffset) return fail(path, "目次が範囲外です");
+        entries_ = reinterpret_cast<const Entry*>(base_ + header.tocOffset);
+        entryCount_ = header.entryCount;
+        paths_ = reinterpret_cast<const char*>(base_ + header.tocOffset + entryBytes);
+        pathBytes_ = header.pathBytes;
+        for (uint32_t i = 0; i < entryCount_; ++i) {
+            const Entry& e = entries_[i];
+            if (e.offset > size_ || e.storedSize > size_ - e.offset || e.pathOffset + static_cast<uint64_t>(e.pathLength) > pathBytes_) {
+                return fail(path, "エントリが範囲外です");
+            }
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[AssetArchive] マウント: " + path + " (" + std::to_string(entryCount_) + " ファイル, " +
+                          std::to_string(size_ / 1024) + " KB)");
+        return true;
+    }
+
+    /**
+     * @brief マップを解除してファイルを閉じる(Read() で得た非圧縮の Blob は無効になる)
+     */
+    void Unmount() {
+        if (base_) UnmapViewOfFile(base_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        base_ = nullptr;
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+        size_ = 0;
+        entries_ = nullptr;
+        entryCount_ = 0;
+        paths_ = nullptr;
+        pathBytes_ = 0;
+    }
+
+    bool IsMounted() const { return base_ != nullptr; }
+    uint32_t FileCount() const { return entryCount_; }
+
+    /**
+     * @brief アーカイブに含まれるか
+     */
+    bool Contains(const std::string& path) const { return find(path) != nullptr; }
+
+    /**
+     * @brief 展開後のサイズ(含まれなければ 0)
+     */
+    size_t FileSize(const std::string& path) const {
+        const Entry* e = find(path);
+        return e ? static_cast<size_t>(e->size) : 0;
+    }
+
+    /**
+     * @brief ファイルの内容を取得
+     * @return bool 含まれていて(圧縮したファイルは展開まで)成功した場合 true
+     */
+    bool Read(const std::string& path, Blob& out) const {
+        out.data = nullptr;
+        out.size = 0;
+        const Entry* e = find(path);
+        if (!e) return false;
+        const uint8_t* stored = base_ + e->offset;
+        if ((e->flags & FLAG_LZ4) == 0) {
+            out.data = stored;
+            out.size = static_cast<size_t>(e->size);
+            return true;
+        }
+        out.storage.resize(static_cast<size_t>(e->size));
+        if (util::Lz4::Decompress(stored, static_cast<size_t>(e->storedSize), out.storage.data(), out.storage.size()) != out.storage.size()) {
+            DEBUGLOG_ERROR("[AssetArchive] 展開に失敗しました: " + path);
+            return false;
+        }
+        out.data = out.storage.data();
+        out.size = out.storage.size();
+        return true;
+    }
+
+    /**
+     * @brief アーカイブ(マウントしている場合)か個別のファイルにあるか
+     */
+    static bool Exists(const std::string& path) {
+        return GetInstance().Contains(path) || GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    /**
+     * @brief ディレクトリ以下のファイルをアーカイブにまとめる
+     * @param[in] directory まとめるディレクトリ(格納するパスは "directory/..." の形。実行時に開くパスと合わせる)
+     * @param[in] outPath 出力先(一時ファイルに書いてから置き換える)
+     * @param[in] compress 縮むファイルを圧縮するか
+     * @param[out] error 失敗時の理由
+     */
+    static bool Build(const std::string& directory, const std::string& outPath, bool compress, std::string& error) {
+        std::vector<std::string> files;
+        return ListFiles(directory, files, error) && Build(std::move(files), outPath, compress, error);
+    }
+
+    /**
+     * @brief ディレクトリ以下のファイルのパスを列挙("directory/..." の形、'/' 区切り)
+     */
+    static bool ListFiles(const std::string& directory, std::vector<std::string>& files, std::string& error) {
+        namespace fs = std::filesystem;
+        files.clear();
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            files.push_back((fs::path(directory) / it->path().lexically_relative(directory)).generic_string());
+        }
+        if (ec) {
+            error = "ディレクトリを列挙できません: " + ec.message();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 指定したファイルをアーカイブにまとめる(格納するパスは files から先頭の "./" を除いたもの)
+     */
+    static bool Build(std::vector<std::string> files, const std::string& outPath, bool compress, std::string& error) {
+        std::sort(files.begin(), files.end());  // 同じディレクトリのファイルが隣り合うように
+
+        const std::string tempPath = outPath + ".tmp";
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, tempPath.c_str(), "wb") != 0 || !fp) {
+            error = "書き込みできません: " + tempPath;
+            return false;
+        }
+
+        Header header;
+        std::vector<Entry> entries;
+        std::string paths;
+        std::vector<uint8_t> source;
+        std::vector<uint8_t> packed;
+        uint64_t offset = ALIGNMENT;
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 && pad(fp, sizeof(header), ALIGNMENT);
+        uint64_t rawBytes = 0;
+        uint64_t storedBytes = 0;
+        for (size_t i = 0; ok && i < files.size(); ++i) {
+            if (!readFile(files[i], source)) {
+                error = "読み込めません: " + files[i];
+                ok = false;
+                break;
+            }
+            // 検索(hashPath / samePath)と同じく先頭の "./" を除いた形で格納する
+            const std::string stored = files[i].substr(skipDot(files[i]));
+            Entry entry{};
+            entry.hash = hashPath(stored);
+            entry.offset = offset;
+            entry.size = source.size();
+            entry.pathOffset = static_cast<uint32_t>(paths.size());
+            entry.pathLength = static_cast<uint32_t>(stored.size());
+            paths += stored;
+
+            const uint8_t* data = source.data();
+            size_t bytes = source.size();
+            packed.clear();
+            if (compress && !source.empty()) {
+                const size_t compressed = util::Lz4::Compress(source.data(), source.size(), packed);
+                if (compressed + source.size() / COMPRESS_MIN_SAVING <= source.size()) {
+                    data = packed.data();
+                    bytes = compressed;
+                    entry.flags = FLAG_LZ4;
+                }
+            }
+            entry.storedSize = bytes;
+            ok = (bytes == 0 || fwrite(data, 1, bytes, fp) == bytes);
+            const uint64_t next = alignUp(offset + bytes, ALIGNMENT);
+            ok = ok && pad(fp, static_cast<size_t>(offset + bytes), ALIGNMENT);
+            offset = next;
+            rawBytes += entry.size;
+            storedBytes += entry.storedSize;
+            entries.push_back(entry);
+        }
+
+        // 目次(ハッシュ順)とパスの文字列
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+        header.entryCount = static_cast<uint32_t>(entries.size());
+        header.tocOffset = offset;
+        header.pathBytes = paths.size();
+        ok = ok && (entries.empty() || fwrite(entries.data(), sizeof(Entry), entries.size(), fp) == entries.size());
+        ok = ok && (paths.empty() || fwrite(paths.data(), 1, paths.size(), fp) == paths.size());
+        ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, fp) == 1;
+        ok = (fclose(fp) == 0) && ok;
+        if (!ok) {
+            if (error.empty()) error = "書き込みに失敗しました: " + tempPath;
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        if (!MoveFileExA(tempPath.c_str(), outPath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            error = "置き換えに失敗しました: " + outPath;
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[AssetArchive] 作成: " + outPath + " (" + std::to_string(entries.size()) + " ファイル, " +
+                          std::to_string(rawBytes / 1024) + " KB -> " + std::to_string(storedBytes / 1024) + " KB)");
+        return true;
+    }
+
+private:
+    struct Header {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t entryCount = 0;
+        uint32_t reserved = 0;
+        uint64_t tocOffset = 0;     ///< 目次の先頭
+        uint64_t pathBytes = 0;     ///< パスの文字列の合計
+    };
+
+    struct Entry {
+        uint64_t hash;              ///< 正規化したパスの FNV-1a
+        uint64_t offset;            ///< データの先頭(ALIGNMENT 境界)
+        uint64_t storedSize;        ///< 格納したバイト数
+        uint64_t size;              ///< 展開後のバイト数
+        uint32_t pathOffset;        ///< パスの文字列の位置
+        uint32_t pathLength;
+        uint32_t flags;             ///< FLAG_LZ4
+        uint32_t reserved;
+    };
+
+    AssetArchive() = default;
+
+    static char normalize(char c) {
+        if (c == '\\') return '/';
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // 大文字小文字と区切り文字を区別しないハッシュ(先頭の "./" は読み飛ばす)
+    static uint64_t hashPath(const std::string& path) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = skipDot(path); i < path.size(); ++i) {
+            h ^= static_cast<uint8_t>(normalize(path[i]));
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    static size_t skipDot(const std::string& path) {
+        return (path.size() >= 2 && path[0] == '.' && (path[1] == '/' || path[1] == '\\')) ? 2 : 0;
+    }
+
+    static bool samePath(const std::string& path, const char* stored, size_t length) {
+        const size_t begin = skipDot(path);
+        if (path.size() - begin != length) return false;
+        for (size_t i = 0; i < length; ++i) {
+            if (normalize(path[begin + i]) != normalize(stored[i])) return false;
+        }
+        return true;
+    }
+
+    const Entry* find(const std::string& path) const {
+        if (!base_ || entryCount_ == 0) return nullptr;
+        if (path.find("..") != std::string::npos) {
+            // "Assets/Models/../Textures/a.png" のような相対参照(マテリアルのテクスチャパス)を畳む
+            return findNormalized(std::filesystem::path(path).lexically_normal().generic_string());
+        }
+        return findNormalized(path);
+    }
+
+    const Entry* findNormalized(const std::string& path) const {
+        const uint64_t h = hashPath(path);
+        const Entry* first = std::lower_bound(entries_, entries_ + entryCount_, h,
+                                              [](const Entry& e, uint64_t value) { return e.hash < value; });
+        for (const Entry* e = first; e != entries_ + entryCount_ && e->hash == h; ++e) {
+            if (samePath(path, paths_ + e->pathOffset, e->pathLength)) return e;
+        }
+        return nullptr;
+    }
+
+    static uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    // written バイト書いた位置から次の alignment 境界までゼロで埋める
+    static bool pad(FILE* fp, size_t written, uint64_t alignment) {
+        static const uint8_t zeros[ALIGNMENT] = {};
+        const size_t bytes = static_cast<size_t>(alignUp(written, alignment) - written);
+        return bytes == 0 || fwrite(zeros, 1, bytes, fp) == bytes;
+    }
+
+    static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "rb") != 0 || !fp) return false;
+        bool ok = _fseeki64(fp, 0, SEEK_END) == 0;
+        const long long size = ok ? _ftelli64(fp) : -1;
+        ok = ok && size >= 0 && _fseeki64(fp, 0, SEEK_SET) == 0;
+        if (ok) {
+            out.resize(static_cast<size_t>(size));
+            ok = size == 0 || fread(out.data(), 1, out.size(), fp) == out.size();
+        }
+        fclose(fp);
+        return ok;
+    }
+
+    bool fail(const std::string& path, const char* reason) {
+        DEBUGLOG_WARNING(std::string("[AssetArchive] アーカイブを使用できません(") + reason + "): " + path);
+        Unmount();
+        return false;
+    }
+
+    HANDLE file_ = INVALID_HANDLE_VALUE;   ///< 唯一のファイルハンドル
+    HANDLE mapping_ = nullptr;
+    const uint8_t* base_ = nullptr;        ///< マップした先頭
+    size_t size_ = 0;
+    const Entry* entries_ = nullptr;       ///< 目次(ハッシュ順、base_ を参照)
+    uint32_t entryCount_ = 0;
+    const char* paths_ = nullptr;          ///< パスの文字列(base_ を参照)
+    uint64_t pathBytes_ = 0;
+};
@@ -0,0 +1,296 @@
+/**
+ * @file AssetBenchmark.h
+ * @brief モデル・テクスチャの読み込み時間を段階ごとに計測して CSV に書き出す
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * `--asset-benchmark` を付けて起動すると、App は初期化の後にメインループの代わりにこの計測を行って終了します。
+ * 指定ディレクトリ以下のモデル(.fbx / .obj / .gltf / .glb)と画像(.png / .jpg / .jpeg / .bmp / .dds)を
+ * 名前順に読み込み、1ファイル1回の読み込みごとに1行を書き出します。
+ *
+ * - モデル: 1回目(cold)は変換済みキャッシュ(.meshcache)を削除してから Assimp で読み込みます
+ *   (読み込みの最後にキャッシュは書き直されます)。2回目以降(warm)はそのキャッシュから読み込みます。
+ *   内訳は ModelLoader::LoadTimings(キャッシュの読み込み・解析・ポストプロセス・頂点の変換・
+ *   キャッシュの書き出し・バッファの作成)です。
+ * - テクスチャ: 毎回 TextureManager::LoadFromFile() で読み込んで Release() します。1回目(cold)は
+ *   初めての読み込み、2回目以降(warm)は OS のファイルキャッシュに載った状態です。
+ *   内訳は TextureManager::LoadTimings(デコード・ミップの生成とアップロード)です。
+ *
+ * io_ms は読み込みの直前にローダーが読むファイル(cold のモデルは元ファイル、warm はキャッシュ)を
+ * メモリへ読み切った時間です。ローダー自身の読み取りはその後 OS のキャッシュから行われるため、
+ * parse_ms / decode_ms はほぼ解析とデコードだけの時間になります。
+ *
+ * total_ms はファイルと cold / warm ごとに `--asset-history` のファイル(BenchmarkHistory)にも追記します
+ * (metric は ModelLoader::LoadGeometry/<file>/warm、TextureManager::LoadFromFile/<file>/cold など)。
+ * 実行を重ねると cold の値も同じコミットの標本として集まり、HEW_BENCH_COMPARE で前のコミットと比較できます。
+ *
+ * @par コマンドライン
+ * @code
+ * HEW_GAME.exe --asset-benchmark [--asset-dir Assets] [--asset-repeat 3] [--asset-out asset_benchmark.csv]
+ *              [--asset-history bench_history.csv|none]
+ * @endcode
+ */
+#pragma once
+#include "app/BenchmarkHistory.h"
+#include "app/CommandLine.h"
+#include "app/DebugLog.h"
+#include "graphics/ModelLoader.h"
+#include "graphics/TextureManager.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/**
+ * @struct AssetBenchmarkConfig
+ * @brief 計測対象と出力先
+ */
+struct AssetBenchmarkConfig {
+    std::string directory = "Assets";               ///< 計測するファイルを探すディレクトリ(サブディレクトリを含む)
+    int repeat = 3;                                 ///< 1ファイルあたりの読み込み回数(1回目が cold)
+    std::string outputPath = "asset_benchmark.csv"; ///< CSV の出力先
+    std::string historyPath = BenchmarkHistory::DEFAULT_PATH; ///< 読み込み時間を追記する履歴("none" で追記しない)
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @return bool `--asset-benchmark` が指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, AssetBenchmarkConfig& out) {
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+        if (!CommandLine::Has(args, "--asset-benchmark")) return false;
+
+        AssetBenchmarkConfig config;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            const std::string& key = args[i];
+            if (key == "--asset-dir") config.directory = args[i + 1];
+            else if (key == "--asset-repeat") config.repeat = (std::max)(1, std::atoi(args[i + 1].c_str()));
+            else if (key == "--asset-out") config.outputPath = args[i + 1];
+            else if (key == "--asset-history") config.historyPath = args[i + 1];
+        }
+        out = config;
+        return true;
+    }
+};
+
+/**
+ * @class AssetBenchmark
+ * @brief 読み込み時間の計測(メインスレッドから、GfxDevice::ResourceMutex() を取って呼ぶ)
+ */
+class AssetBenchmark {
+public:
+    /**
+     * @brief 計測して CSV に書き出す
+     * @return bool CSV を書き出せた場合 true
+     */
+    static bool Run(const AssetBenchmarkConfig& config, TextureManager& textures) {
+        std::vector<std::string> models, images;
+        collectFiles(config.directory, models, images);
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[AssetBenchmark] models=" + std::to_string(models.size()) +
+                          ", textures=" + std::to_string(images.size()) + ", repeat=" + std::to_string(config.repeat));
+
+        std::vector<Row> rows;
+        rows.reserve((models.size() + images.size()) * static_cast<size_t>(config.repeat));
+        for (const std::string& path : models) measureModel(path, config.repeat, rows);
+        for (const std::string& path : images) measureTexture(path, config.repeat, textures, rows);
+
+        if (!writeCsv(config.outputPath, rows)) return false;
+        if (config.historyPath != "none") writeHistory(config.historyPath, rows);
+        logSummary(rows);
+        return true;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Row {
+        std::string file;
+        const char* kind = "";   ///< "model" / "texture"
+        int run = 0;             ///< 0 が cold
+        bool fromCache = false;  ///< モデルを .meshcache から読み込んだか
+        bool compressed = false; ///< テクスチャを DDS から読み込んだか
+        bool ok = false;
+        double totalMs = 0.0;
+        double ioMs = 0.0;
+        double cacheReadMs = 0.0;
+        double parseMs = 0.0;
+        double postProcessMs = 0.0;
+        double convertMs = 0.0;
+        double cacheWriteMs = 0.0;
+        double uploadMs = 0.0;
+        double decodeMs = 0.0;
+        size_t meshes = 0;
+        size_t vertices = 0;
+        size_t indices = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        size_t fileBytes = 0;
+    };
+
+    static double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    static std::string lowerExtension(const std::filesystem::path& path) {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext;
+    }
+
+    static void collectFiles(const std::string& directory, std::vector<std::string>& models, std::vector<std::string>& images) {
+        static const char* const modelExts[] = { ".fbx", ".obj", ".gltf", ".glb" };
+        static const char* const imageExts[] = { ".png", ".jpg", ".jpeg", ".bmp", ".dds" };
+
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            const std::string ext = lowerExtension(it->path());
+            const std::string path = it->path().generic_string(); // ModelLoader は '/' 区切りでディレクトリを求める
+            if (std::find(std::begin(modelExts), std::end(modelExts), ext) != std::end(modelExts)) models.push_back(path);
+            else if (std::find(std::begin(imageExts), std::end(imageExts), ext) != std::end(imageExts)) images.push_back(path);
+        }
+        if (ec) {
+            DEBUGLOG_WARNING("[AssetBenchmark] " + directory + " を列挙できません: " + ec.message());
+        }
+        std::sort(models.begin(), models.end());
+        std::sort(images.begin(), images.end());
+    }
+
+    /**
+     * @brief ファイルをメモリへ読み切る(ローダーの前に OS のキャッシュへ載せ、その時間を io_ms とする)
+     */
+    static double readWholeFile(const std::string& path, size_t& bytes) {
+        bytes = 0;
+        auto start = Clock::now();
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "rb") != 0 || !fp) return 0.0;
+        std::vector<char> buffer(1 << 20);
+        size_t read = 0;
+        while ((read = std::fread(buffer.data(), 1, buffer.size(), fp)) > 0) bytes += read;
+        std::fclose(fp);
+        return elapsedMs(start);
+    }
+
+    static void measureModel(const std::string& path, int repeat, std::vector<Row>& rows) {
+        const std::string cachePath = path + MeshCacheFile::EXTENSION;
+        for (int run = 0; run < repeat; ++run) {
+            if (run == 0) std::remove(cachePath.c_str()); // cold: Assimp を通す(読み込みの最後に書き直される)
+
+            Row row;
+            row.file = path;
+            row.kind = "model";
+            row.run = run;
+            std::error_code ec;
+            row.ioMs = readWholeFile(std::filesystem::exists(cachePath, ec) ? cachePath : path, row.fileBytes);
+
+            ModelLoader::LoadedModel model;
+            ModelLoader::LoadTimings timings;
+            auto start = Clock::now();
+            row.ok = ModelLoader::LoadGeometry(path, model, &timings);
+            row.totalMs = elapsedMs(start);
+
+            row.fromCache = timings.fromCache;
+            row.cacheReadMs = timings.cacheReadMs;
+            row.parseMs = timings.parseMs;
+            row.postProcessMs = timings.postProcessMs;
+            row.convertMs = timings.convertMs;
+            row.cacheWriteMs = timings.cacheWriteMs;
+            row.uploadMs = timings.uploadMs;
+            row.meshes = model.meshes.size();
+            row.vertices = timings.vertexCount;
+            row.indices = timings.indexCount;
+            rows.push_back(row);
+        }
+    }
+
+    static void measureTexture(const std::string& path, int repeat, TextureManager& textures, std::vector<Row>& rows) {
+        for (int run = 0; run < repeat; ++run) {
+            Row row;
+            row.file = path;
+            row.kind = "texture";
+            row.run = run;
+            row.ioMs = readWholeFile(path, row.fileBytes);
+
+            TextureManager::LoadTimings timings;
+            auto start = Clock::now();
+            TextureManager::TextureHandle handle = textures.LoadFromFile(path.c_str(), &timings);
+            row.totalMs = elapsedMs(start);
+            textures.Release(handle);
+
+            row.ok = handle != TextureManager::INVALID_TEXTURE;
+            row.compressed = timings.compressed;
+            row.decodeMs = timings.decodeMs;
+            row.uploadMs = timings.uploadMs;
+            row.width = timings.width;
+            row.height = timings.height;
+            rows.push_back(row);
+        }
+    }
+
+    static bool writeCsv(const std::string& outputPath, const std::vector<Row>& rows) {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, outputPath.c_str(), "w") != 0 || !fp) {
+            DEBUGLOG_ERROR("[AssetBenchmark] " + outputPath + " を開けません");
+            return false;
+        }
+        std::fprintf(fp, "file,kind,run,phase,source,ok,total_ms,io_ms,cache_read_ms,parse_ms,postprocess_ms,convert_ms,"
+                         "cache_write_ms,upload_ms,decode_ms,meshes,vertices,indices,width,height,file_bytes\n");
+        for (const Row& r : rows) {
+            const char* source = r.kind[0] == 'm' ? (r.fromCache ? "meshcache" : "assimp") : (r.compressed ? "dds" : "wic");
+            std::fprintf(fp, "%s,%s,%d,%s,%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%zu,%zu,%zu,%u,%u,%zu\n",
+                         r.file.c_str(), r.kind, r.run, r.run == 0 ? "cold" : "warm", source, r.ok ? 1 : 0,
+                         r.totalMs, r.ioMs, r.cacheReadMs, r.parseMs, r.postProcessMs, r.convertMs,
+                         r.cacheWriteMs, r.uploadMs, r.decodeMs, r.meshes, r.vertices, r.indices,
+                         r.width, r.height, r.fileBytes);
+        }
+        std::fclose(fp);
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[AssetBenchmark] 結果を " + outputPath + " に書き出しました");
+        return true;
+    }
+
+    /**
+     * @brief 読み込めた回の total_ms をファイルと cold / warm ごとに BenchmarkHistory に追記
+     */
+    static bool writeHistory(const std::string& historyPath, const std::vector<Row>& rows) {
+        std::vector<BenchmarkRecord> records;
+        for (size_t begin = 0; begin < rows.size();) {
+            size_t end = begin;
+            std::vector<double> cold, warm;
+            for (; end < rows.size() && rows[end].file == rows[begin].file; ++end) {
+                if (rows[end].ok) (rows[end].run == 0 ? cold : warm).push_back(rows[end].totalMs);
+            }
+            const std::string metric = std::string(rows[begin].kind[0] == 'm' ? "ModelLoader::LoadGeometry/" : "TextureManager::LoadFromFile/") +
+                                       rows[begin].file;
+            records.push_back(BenchmarkHistory::MakeRecord("assets", metric + "/cold", std::move(cold)));
+            records.push_back(BenchmarkHistory::MakeRecord("assets", metric + "/warm", std::move(warm)));
+            begin = end;
+        }
+        if (!BenchmarkHistory::Append(historyPath, records)) {
+            DEBUGLOG_ERROR("[AssetBenchmark] " + historyPath + " を開けません");
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[AssetBenchmark] 読み込み時間を " + historyPath + " に追記しました");
+        return true;
+    }
+
+    /**
+     * @brief 種類と cold / warm ごとの合計時間をログ出力
+     */
+    static void logSummary(const std::vector<Row>& rows) {
+        double totals[2][2] = {}; // [model/texture][cold/warm]
+        for (const Row& r : rows) {
+            totals[r.kind[0] == 'm' ? 0 : 1][r.run == 0 ? 0 : 1] += r.totalMs + r.ioMs;
+        }
+        char line[256];
+        sprintf_s(line, "[AssetBenchmark] モデル cold %.1fms / warm %.1fms, テクスチャ cold %.1fms / warm %.1fms (io を含む合計)",
+                  totals[0][0], totals[0][1], totals[1][0], totals[1][1]);
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, line);
+    }
+};
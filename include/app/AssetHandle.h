@@ -0,0 +1,33 @@
+/**
+ * @file AssetHandle.h
+ * @brief ResourceManager が返すアセットの型付きハンドル
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 種類ごとにタグ型を分けているため、モデルのハンドルをテクスチャとして解放するといった
+ * 取り違えはコンパイルエラーになります。ハンドルは ResourceManager::Release() で返却します。
+ */
+#pragma once
+#include <cstdint>
+
+/**
+ * @struct AssetHandle
+ * @brief アセットのハンドル(id が 0 の場合は無効)
+ * @tparam Tag アセットの種類を表すタグ型
+ */
+template<typename Tag>
+struct AssetHandle {
+    uint32_t id = 0;
+
+    bool IsValid() const { return id != 0; }
+    bool operator==(const AssetHandle& other) const { return id == other.id; }
+    bool operator!=(const AssetHandle& other) const { return id != other.id; }
+};
+
+struct ModelAsset {};    ///< モデル(メッシュとその依存テクスチャ)
+struct TextureAsset {};  ///< テクスチャ
+
+using ModelAssetHandle = AssetHandle<ModelAsset>;
+using TextureAssetHandle = AssetHandle<TextureAsset>;
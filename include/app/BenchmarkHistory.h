@@ -0,0 +1,453 @@
+/**
+ * @file BenchmarkHistory.h
+ * @brief ベンチマークの計測値をコミットとマシンごとに蓄積し、基準と統計的に比較する
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 各ベンチマーク(HEW_ECS_BENCH・`--bench`・`--render-benchmark`・`--asset-benchmark`)は、それぞれの CSV に加えて
+ * 計測値そのもの(繰り返しやフレームごとの値)をこの履歴のファイル(既定 bench_history.csv)に1指標1行で追記します。
+ * 行にはその時点の git のコミットとマシンの識別子が付くため、同じファイルに追記し続けるだけで
+ * 「どのマシンで・どのコミットの・何の値が・いくつあるか」を後から引けます。
+ *
+ * CSV の列は date,commit,machine,machine_info,suite,metric,count,samples です。
+ * - commit: 環境変数 HEW_BENCH_COMMIT、なければ作業ディレクトリから親へ .git を探して HEAD が指すコミット(git は起動しない)
+ * - machine: machine_info(CPU 名・論理コア数・メモリ量・ビルド構成)の FNV-1a の8桁。異なるマシンの値は比較しない
+ * - suite: 計測の条件(シナリオとエンティティ数など)。同じ suite と metric の値だけを比較する
+ * - metric: 計測した処理(World::Tick/100000、RenderSystem::Render/cpu_ms、ModelLoader::LoadGeometry/<file>/warm など)
+ * - samples: 計測値(ミリ秒)を ';' 区切りで計測順に
+ *
+ * 比較(Compare())は外れ値に強い中央値と MAD(中央絶対偏差)で要約し、中央値の変化率の信頼区間を
+ * ブロックブートストラップで求めます(フレームごとの値は前後で相関するため、連続した値をまとめて再標本化する)。
+ * 信頼区間の全体が閾値(既定 +5%)より遅い側にあれば Regression、速い側にあれば Improvement です。
+ * 比較は tools/BenchCompare.cpp(HEW_BENCH_COMPARE)が行い、World::Tick・RenderSystem::Render・ModelLoader の
+ * 指標(IsGated())に Regression があれば終了コード 1 を返します。
+ *
+ * @par 使用例
+ * @code
+ * std::vector<BenchmarkRecord> records;
+ * records.push_back(BenchmarkHistory::MakeRecord("scenario/crowd/10000", "World::Tick/update_ms", updateSamples));
+ * BenchmarkHistory::Append(BenchmarkHistory::DEFAULT_PATH, records);
+ * @endcode
+ *
+ * @note 同じコミット・マシン・suite・metric の行が複数あれば、比較ではそれらの値をまとめて1つの標本として扱います
+ */
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include "util/Random.h"
+#include <intrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct BenchmarkRecord
+ * @brief 履歴の1行(1つの指標の計測値の列)
+ */
+struct BenchmarkRecord {
+    std::string date;               ///< 追記した日時(ISO 8601、ローカル時刻)
+    std::string commit;             ///< git のコミット(40桁、分からなければ "unknown")
+    std::string machine;            ///< machineInfo のハッシュ(8桁)
+    std::string machineInfo;        ///< CPU 名・論理コア数・メモリ量・ビルド構成
+    std::string suite;              ///< 計測の条件
+    std::string metric;             ///< 計測した処理
+    std::vector<double> samples;    ///< 計測値(ミリ秒、計測順)
+};
+
+/**
+ * @struct BenchmarkSummary
+ * @brief 計測値の要約
+ */
+struct BenchmarkSummary {
+    size_t count = 0;
+    double median = 0.0;
+    double mad = 0.0;   ///< 中央絶対偏差に 1.4826 を掛けたもの(正規分布なら標準偏差の推定)
+};
+
+/**
+ * @struct BenchmarkComparison
+ * @brief 基準と候補の比較の結果
+ */
+struct BenchmarkComparison {
+    enum class Verdict {
+        Unchanged,      ///< 信頼区間が閾値をまたぐ(差があるとは言えない)
+        Regression,     ///< 信頼区間の全体が +閾値より遅い
+        Improvement,    ///< 信頼区間の全体が -閾値より速い
+        Insufficient    ///< どちらかの計測値が MIN_SAMPLES 未満
+    };
+
+    BenchmarkSummary baseline;
+    BenchmarkSummary candidate;
+    double change = 0.0;    ///< 中央値の変化率(0.05 で 5% 遅い)
+    double ciLow = 0.0;     ///< 変化率の信頼区間の下限
+    double ciHigh = 0.0;    ///< 変化率の信頼区間の上限
+    Verdict verdict = Verdict::Insufficient;
+
+    static const char* VerdictName(Verdict verdict) {
+        switch (verdict) {
+        case Verdict::Unchanged: return "unchanged";
+        case Verdict::Regression: return "REGRESSION";
+        case Verdict::Improvement: return "improvement";
+        case Verdict::Insufficient: return "insufficient";
+        }
+        return "unknown";
+    }
+};
+
+/**
+ * @class BenchmarkHistory
+ * @brief 履歴のファイルの読み書きと統計
+ */
+class BenchmarkHistory {
+public:
+    static constexpr const char* DEFAULT_PATH = "bench_history.csv";
+    static constexpr size_t MIN_SAMPLES = 3;            ///< 比較に必要な計測値の数(基準・候補それぞれ)
+    static constexpr double DEFAULT_THRESHOLD = 0.05;   ///< これより小さい変化は差として扱わない
+    static constexpr double DEFAULT_CONFIDENCE = 0.95;
+    static constexpr int DEFAULT_RESAMPLES = 2000;
+    static constexpr double MAD_SCALE = 1.4826;
+
+    /**
+     * @brief 現在のコミットとマシンを付けた行を作る(日時は Append() の時点)
+     */
+    static BenchmarkRecord MakeRecord(const std::string& suite, const std::string& metric, std::vector<double> samples) {
+        static const std::string commit = CurrentCommit();
+        static const std::string machineInfo = MachineInfo();
+        BenchmarkRecord record;
+        record.commit = commit;
+        record.machineInfo = machineInfo;
+        record.machine = MachineId(machineInfo);
+        record.suite = sanitize(suite);
+        record.metric = sanitize(metric);
+        record.samples = std::move(samples);
+        return record;
+    }
+
+    /**
+     * @brief 行を追記(ファイルが空ならヘッダーも書く、計測値のない行は書かない)
+     * @return bool 書き込めた場合 true
+     */
+    static bool Append(const std::string& path, const std::vector<BenchmarkRecord>& records) {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "a") != 0 || !fp) return false;
+        std::fseek(fp, 0, SEEK_END);
+        if (std::ftell(fp) == 0) std::fprintf(fp, "date,commit,machine,machine_info,suite,metric,count,samples\n");
+
+        const std::string date = now();
+        for (const BenchmarkRecord& r : records) {
+            if (r.samples.empty()) continue;
+            std::fprintf(fp, "%s,%s,%s,%s,%s,%s,%zu,", r.date.empty() ? date.c_str() : r.date.c_str(), r.commit.c_str(),
+                         r.machine.c_str(), r.machineInfo.c_str(), r.suite.c_str(), r.metric.c_str(), r.samples.size());
+            for (size_t i = 0; i < r.samples.size(); ++i) std::fprintf(fp, i == 0 ? "%.5g" : ";%.5g", r.samples[i]);
+            std::fprintf(fp, "\n");
+        }
+        std::fclose(fp);
+        return true;
+    }
+
+    /**
+     * @brief 履歴を読む(形式の合わない行は飛ばす)
+     * @return bool ファイルを開けた場合 true
+     */
+    static bool Load(const std::string& path, std::vector<BenchmarkRecord>& out) {
+        out.clear();
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "rb") != 0 || !fp) return false;
+        std::string line;
+        char buffer[4096];
+        bool header = true;
+        while (std::fgets(buffer, sizeof(buffer), fp)) {
+            line += buffer;
+            if (line.back() != '\n' && !std::feof(fp)) continue; // 長い行の続き
+            while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+            if (header) header = false;
+            else if (!line.empty()) {
+                BenchmarkRecord record;
+                if (parseLine(line, record)) out.push_back(std::move(record));
+            }
+            line.clear();
+        }
+        std::fclose(fp);
+        return true;
+    }
+
+    // ========================================================
+    // コミットとマシン
+    // ========================================================
+
+    /**
+     * @brief 現在のコミット(HEW_BENCH_COMMIT、なければ .git の HEAD、どちらもなければ "unknown")
+     */
+    static std::string CurrentCommit() {
+        char* env = nullptr;
+        size_t length = 0;
+        if (_dupenv_s(&env, &length, "HEW_BENCH_COMMIT") == 0 && env) {
+            std::string commit = sanitize(env);
+            std::free(env);
+            if (!commit.empty()) return commit;
+        }
+
+        std::error_code ec;
+        for (std::filesystem::path dir = std::filesystem::current_path(ec); !ec && !dir.empty(); dir = dir.parent_path()) {
+            const std::filesystem::path dotGit = dir / ".git";
+            if (std::filesystem::is_directory(dotGit, ec)) return resolveHead(dotGit);
+            if (std::filesystem::is_regular_file(dotGit, ec)) {
+                // ワークツリーとサブモジュールは "gitdir: <path>" を書いたファイル
+                const std::string link = readFirstLine(dotGit);
+                if (link.compare(0, 8, "gitdir: ") == 0) {
+                    std::filesystem::path gitDir = link.substr(8);
+                    if (gitDir.is_relative()) gitDir = dir / gitDir;
+                    return resolveHead(gitDir);
+                }
+            }
+            if (dir == dir.parent_path()) break;
+        }
+        return "unknown";
+    }
+
+    /**
+     * @brief マシンの説明(CPU 名 / 論理コア数 / メモリ量 / ビルド構成)
+     */
+    static std::string MachineInfo() {
+        char brand[49] = {};
+        int regs[4] = {};
+        __cpuid(regs, 0x80000000);
+        if (static_cast<unsigned>(regs[0]) >= 0x80000004u) {
+            for (int i = 0; i < 3; ++i) {
+                __cpuid(regs, 0x80000002 + i);
+                std::memcpy(brand + i * 16, regs, sizeof(regs));
+            }
+        }
+        std::string cpu = brand;
+        cpu.erase(0, cpu.find_first_not_of(' '));
+        if (cpu.empty()) cpu = "unknown-cpu";
+
+        MEMORYSTATUSEX memory{};
+        memory.dwLength = sizeof(memory);
+        const unsigned long long memoryGb = GlobalMemoryStatusEx(&memory) ? (memory.ullTotalPhys + (1ull << 29)) >> 30 : 0;
+#ifdef _DEBUG
+        const char* build = "Debug";
+#else
+        const char* build = "Release";
+#endif
+        char info[160];
+        sprintf_s(info, "%s / %u threads / %lluGB / %s", cpu.c_str(), std::thread::hardware_concurrency(), memoryGb, build);
+        return sanitize(info);
+    }
+
+    /**
+     * @brief マシンの説明から識別子(FNV-1a の8桁)を作る
+     */
+    static std::string MachineId(const std::string& machineInfo) {
+        uint32_t h = 2166136261u;
+        for (unsigned char c : machineInfo) h = (h ^ c) * 16777619u;
+        char id[9];
+        sprintf_s(id, "%08x", h);
+        return id;
+    }
+
+    /**
+     * @brief 回帰で終了コードを変える指標か(World::Tick・RenderSystem::Render・ModelLoader の読み込み)
+     */
+    static bool IsGated(const std::string& metric) {
+        static const char* const prefixes[] = { "World::Tick", "RenderSystem::Render", "ModelLoader::" };
+        for (const char* prefix : prefixes) {
+            if (metric.compare(0, std::strlen(prefix), prefix) == 0) return true;
+        }
+        return false;
+    }
+
+    // ========================================================
+    // 統計
+    // ========================================================
+
+    static double Median(std::vector<double> values) {
+        if (values.empty()) return 0.0;
+        const size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        const double upper = values[mid];
+        if (values.size() % 2 != 0) return upper;
+        const double lower = *std::max_element(values.begin(), values.begin() + mid);
+        return (lower + upper) * 0.5;
+    }
+
+    static BenchmarkSummary Summarize(const std::vector<double>& samples) {
+        BenchmarkSummary summary;
+        summary.count = samples.size();
+        if (samples.empty()) return summary;
+        summary.median = Median(samples);
+        std::vector<double> deviations(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) deviations[i] = std::fabs(samples[i] - summary.median);
+        summary.mad = Median(std::move(deviations)) * MAD_SCALE;
+        return summary;
+    }
+
+    /**
+     * @brief 候補の中央値の基準からの変化率と、その信頼区間を求めて判定する
+     * @param[in] baseline 基準の計測値(計測順)
+     * @param[in] candidate 候補の計測値(計測順)
+     * @param[in] threshold 差として扱う最小の変化率
+     * @param[in] confidence 信頼区間の水準
+     * @param[in] resamples ブートストラップの回数
+     *
+     * @details
+     * 再標本化は長さ n^(1/3) のブロック単位で行います(繰り返しの計測では 1、1200 フレームでは 10)。
+     * 乱数のシードは固定のため、同じ入力からは毎回同じ区間が得られます。
+     */
+    static BenchmarkComparison Compare(const std::vector<double>& baseline, const std::vector<double>& candidate,
+                                       double threshold = DEFAULT_THRESHOLD, double confidence = DEFAULT_CONFIDENCE,
+                                       int resamples = DEFAULT_RESAMPLES) {
+        BenchmarkComparison result;
+        result.baseline = Summarize(baseline);
+        result.candidate = Summarize(candidate);
+        if (baseline.size() < MIN_SAMPLES || candidate.size() < MIN_SAMPLES || result.baseline.median <= 0.0) return result;
+
+        result.change = result.candidate.median / result.baseline.median - 1.0;
+
+        util::Rng rng(0xBE7C4ull);
+        std::vector<double> changes;
+        changes.reserve(static_cast<size_t>((std::max)(resamples, 1)));
+        std::vector<double> a, b;
+        for (int r = 0; r < resamples; ++r) {
+            resample(baseline, rng, a);
+            resample(candidate, rng, b);
+            const double base = Median(a);
+            if (base > 0.0) changes.push_back(Median(b) / base - 1.0);
+        }
+        if (changes.empty()) return result;
+        std::sort(changes.begin(), changes.end());
+        const double tail = (1.0 - confidence) * 0.5;
+        const auto at = [&changes](double q) {
+            const size_t index = static_cast<size_t>(q * static_cast<double>(changes.size() - 1) + 0.5);
+            return changes[(std::min)(index, changes.size() - 1)];
+        };
+        result.ciLow = at(tail);
+        result.ciHigh = at(1.0 - tail);
+
+        using Verdict = BenchmarkComparison::Verdict;
+        if (result.ciLow > threshold) result.verdict = Verdict::Regression;
+        else if (result.ciHigh < -threshold) result.verdict = Verdict::Improvement;
+        else result.verdict = Verdict::Unchanged;
+        return result;
+    }
+
+private:
+    static std::string now() {
+        char date[32] = {};
+        const std::time_t t = std::time(nullptr);
+        std::tm local{};
+        if (localtime_s(&local, &t) == 0) std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &local);
+        return date;
+    }
+
+    /**
+     * @brief CSV の区切り(',' と ';')と改行を空白に置き換える
+     */
+    static std::string sanitize(std::string text) {
+        for (char& c : text) {
+            if (c == ',' || c == ';' || c == '\n' || c == '\r') c = ' ';
+        }
+        while (!text.empty() && text.back() == ' ') text.pop_back();
+        return text;
+    }
+
+    static bool parseLine(const std::string& line, BenchmarkRecord& out) {
+        std::string* fields[] = { &out.date, &out.commit, &out.machine, &out.machineInfo, &out.suite, &out.metric };
+        size_t pos = 0;
+        for (std::string* field : fields) {
+            const size_t comma = line.find(',', pos);
+            if (comma == std::string::npos) return false;
+            *field = line.substr(pos, comma - pos);
+            pos = comma + 1;
+        }
+        const size_t comma = line.find(',', pos); // count 列(samples の数から分かるため読み飛ばす)
+        if (comma == std::string::npos) return false;
+        pos = comma + 1;
+
+        const char* p = line.c_str() + pos;
+        while (*p) {
+            char* end = nullptr;
+            const double value = std::strtod(p, &end);
+            if (end == p) return false;
+            out.samples.push_back(value);
+            p = (*end == ';') ? end + 1 : end;
+            if (*end != ';' && *end != '\0') return false;
+        }
+        return !out.samples.empty();
+    }
+
+    static std::string readFirstLine(const std::filesystem::path& path) {
+        FILE* fp = nullptr;
+        if (_wfopen_s(&fp, path.c_str(), L"rb") != 0 || !fp) return std::string();
+        char buffer[512] = {};
+        const bool ok = std::fgets(buffer, sizeof(buffer), fp) != nullptr;
+        std::fclose(fp);
+        if (!ok) return std::string();
+        std::string line = buffer;
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        return line;
+    }
+
+    /**
+     * @brief HEAD が指すコミット(ブランチならその ref のファイル、なければ packed-refs から)
+     */
+    static std::string resolveHead(const std::filesystem::path& gitDir) {
+        const std::string head = readFirstLine(gitDir / "HEAD");
+        if (head.compare(0, 5, "ref: ") != 0) return head.empty() ? "unknown" : sanitize(head); // detached HEAD
+
+        const std::string ref = head.substr(5);
+        const std::string loose = readFirstLine(gitDir / ref);
+        if (!loose.empty()) return sanitize(loose);
+
+        // ワークツリーではブランチの ref は共通のディレクトリ(commondir)にある
+        std::filesystem::path common = gitDir;
+        const std::string commonDir = readFirstLine(gitDir / "commondir");
+        if (!commonDir.empty()) {
+            common = std::filesystem::path(commonDir).is_relative() ? gitDir / commonDir : std::filesystem::path(commonDir);
+            const std::string shared = readFirstLine(common / ref);
+            if (!shared.empty()) return sanitize(shared);
+        }
+
+        FILE* fp = nullptr;
+        if (_wfopen_s(&fp, (common / "packed-refs").c_str(), L"rb") != 0 || !fp) return "unknown";
+        char buffer[512];
+        std::string found = "unknown";
+        while (std::fgets(buffer, sizeof(buffer), fp)) {
+            std::string line = buffer;
+            while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+            const size_t space = line.find(' ');
+            if (space != std::string::npos && line.compare(space + 1, std::string::npos, ref) == 0) {
+                found = line.substr(0, space);
+                break;
+            }
+        }
+        std::fclose(fp);
+        return found;
+    }
+
+    /**
+     * @brief ブロック単位の復元抽出で、values と同じ数の値を out に作る
+     */
+    static void resample(const std::vector<double>& values, util::Rng& rng, std::vector<double>& out) {
+        const size_t n = values.size();
+        const size_t block = (std::max)(static_cast<size_t>(std::cbrt(static_cast<double>(n))), static_cast<size_t>(1));
+        const int starts = static_cast<int>(n - block);
+        out.clear();
+        while (out.size() < n) {
+            const size_t start = static_cast<size_t>(rng.Int(0, starts));
+            for (size_t i = 0; i < block && out.size() < n; ++i) out.push_back(values[start + i]);
+        }
+    }
+};
@@ -0,0 +1,88 @@
+/**
+ * @file CommandLine.h
+ * @brief WinMain の lpCmdLine を引数に分ける
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 各機能の設定(HeadlessConfig・ScenarioBenchmarkConfig・AssetArchiveConfig など)の Parse() が共通で使います。
+ * 区切りは空白とタブで、引用符の扱いは Windows の CommandLineToArgvW と同じです。
+ * - "..." の中の空白は区切らない(`--asset-dir "My Assets"`)
+ * - \\" は " 1文字、引用符の直前の \\ の並びは半分になる。それ以外の \\ はそのまま(パスの区切り)
+ * - 引用の中の "" は " 1文字
+ */
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * @struct CommandLine
+ * @brief コマンドラインの分割
+ *
+ * @par 使用例
+ * @code
+ * const std::vector<std::string> args = CommandLine::Split(lpCmdLine);
+ * if (CommandLine::Has(args, "--headless")) { ... }
+ * @endcode
+ */
+struct CommandLine {
+    /**
+     * @brief 引数に分ける(引用符は取り除く)
+     * @param[in] cmdLine WinMain の lpCmdLine(nullptr 可)
+     * @return std::vector<std::string> 引数(プログラム名は含まない)
+     */
+    static std::vector<std::string> Split(const char* cmdLine) {
+        std::vector<std::string> args;
+        if (!cmdLine) return args;
+        const char* p = cmdLine;
+        while (*p) {
+            while (*p == ' ' || *p == '\t') ++p;
+            if (!*p) break;
+            std::string arg;
+            bool quoted = false;
+            while (*p && (quoted || (*p != ' ' && *p != '\t'))) {
+                if (*p == '\\') {
+                    size_t slashes = 0;
+                    while (*p == '\\') {
+                        ++slashes;
+                        ++p;
+                    }
+                    if (*p == '"') {
+                        arg.append(slashes / 2, '\\');
+                        if (slashes % 2 != 0) {
+                            arg.push_back('"');
+                            ++p;
+                        }
+                    } else {
+                        arg.append(slashes, '\\');
+                    }
+                    continue;
+                }
+                if (*p == '"') {
+                    if (quoted && p[1] == '"') {
+                        arg.push_back('"');
+                        p += 2;
+                        continue;
+                    }
+                    quoted = !quoted;
+                    ++p;
+                    continue;
+                }
+                arg.push_back(*p++);
+            }
+            args.push_back(std::move(arg));
+        }
+        return args;
+    }
+
+    /**
+     * @brief option と一致する引数があるか
+     */
+    static bool Has(const std::vector<std::string>& args, const char* option) {
+        for (const std::string& arg : args) {
+            if (arg == option) return true;
+        }
+        return false;
+    }
+};
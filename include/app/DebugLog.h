@@ -7,18 +7,37 @@
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cstdio>
+#include <type_traits>
 
 // Debug log macros
+// (カテゴリのレベルで除外される場合、message などの引数は評価しない)
 #ifdef _DEBUG
-#define DEBUGLOG(message) DebugLog::GetInstance().Log(message)
-#define DEBUGLOG_ERROR(message) DebugLog::GetInstance().LogError(message)
-#define DEBUGLOG_WARNING(message) DebugLog::GetInstance().LogWarning(message)
-#define DEBUGLOG_CATEGORY(category, message) DebugLog::GetInstance().LogWithCategory(category, message)
+#define DEBUGLOG_IF_ENABLED(category, level, call) \
+    (DebugLog::GetInstance().IsEnabled(category, level) ? DebugLog::GetInstance().call : (void)0)
+#define DEBUGLOG(message) DEBUGLOG_IF_ENABLED(DebugLog::Category::General, DebugLog::Level::Info, Log(message))
+#define DEBUGLOG_ERROR(message) DEBUGLOG_IF_ENABLED(DebugLog::Category::General, DebugLog::Level::Error, LogError(message))
+#define DEBUGLOG_WARNING(message) DEBUGLOG_IF_ENABLED(DebugLog::Category::General, DebugLog::Level::Warning, LogWarning(message))
+#define DEBUGLOG_CATEGORY(category, message) DEBUGLOG_IF_ENABLED(category, DebugLog::Level::Info, LogWithCategory(category, message))
+// 書式文字列("{}" を引数で置き換え)のログ。引数はレコードにそのまま格納し、書式化は書き込みスレッドで行う
+#define DEBUGLOG_FMT(category, ...) DEBUGLOG_IF_ENABLED(category, DebugLog::Level::Info, LogFormat(category, DebugLog::Level::Info, __VA_ARGS__))
+#define DEBUGLOG_FMT_WARNING(category, ...) DEBUGLOG_IF_ENABLED(category, DebugLog::Level::Warning, LogFormat(category, DebugLog::Level::Warning, __VA_ARGS__))
+#define DEBUGLOG_FMT_ERROR(category, ...) DEBUGLOG_IF_ENABLED(category, DebugLog::Level::Error, LogFormat(category, DebugLog::Level::Error, __VA_ARGS__))
 #else
 #define DEBUGLOG(message) ((void)0)
 #define DEBUGLOG_ERROR(message) ((void)0)
 #define DEBUGLOG_WARNING(message) ((void)0)
 #define DEBUGLOG_CATEGORY(category, message) ((void)0)
+#define DEBUGLOG_FMT(category, ...) ((void)0)
+#define DEBUGLOG_FMT_WARNING(category, ...) ((void)0)
+#define DEBUGLOG_FMT_ERROR(category, ...) ((void)0)
 #endif
 
 /**
@@ -30,6 +49,29 @@
  * @details
  * UTF-8 BOM対応、カテゴリ分類、スレッドID記録、フレーム計測を備えた
  * 強化されたデバッグログシステム
+ *
+ * ### 非同期書き込み:
+ * 呼び出し側は固定長のレコード(時刻・フレーム・スレッド・本文)をロックフリーのリング
+ * (複数生成者・単一消費者)に積むだけで戻ります。書式化とファイルへの書き込みは
+ * バックグラウンドの書き込みスレッドがまとめて行います。
+ * - リングが一杯の場合、INFO は破棄して件数を数え(次の書き込みで件数を出力)、
+ *   WARNING / ERROR は空きができるまで待ちます(SetBlockWhenFull(true) で INFO も待つ)
+ * - 本文が MAX_MESSAGE_BYTES を超える場合は UTF-8 の文字境界で切り詰めます
+ * - 終了時(デストラクタ)と std::terminate 時は残りを書き出してから終了します。
+ *   クラッシュハンドラからは Flush() を呼んでください
+ *
+ * ### 書式付きログ:
+ * DEBUGLOG_FMT(category, "id={} name={}", id, name) は引数を型タグ付きのバイナリとして
+ * レコードに書き込むだけで、std::string を作りません。"{}" の置き換えは書き込みスレッドで行います
+ * ("{{" / "}}" は波括弧そのもの)。書式文字列は文字列リテラルなど、書き込まれるまで有効なものを渡してください。
+ * 整数・浮動小数点・bool・char・列挙型・文字列(const char* / std::string、内容をコピー)を渡せます。
+ *
+ * ### カテゴリごとのレベル:
+ * SetCategoryLevel() で下限を設定したカテゴリは、マクロの引数を評価する前に除外されます。
+ * @code
+ * DebugLog::GetInstance().SetCategoryLevel(DebugLog::Category::ECS, DebugLog::Level::Warning);
+ * DEBUGLOG_FMT(DebugLog::Category::ECS, "エンティティ作成 (新規ID: {})", id); // 出力されない
+ * @endcode
  */
 class DebugLog {
 public:
@@ -48,6 +90,22 @@ public:
         Game       ///< ゲームロジック
     };
 
+    /**
+     * @enum Level
+     * @brief ログの重要度
+     */
+    enum class Level : uint8_t {
+        Info,
+        Warning,
+        Error,
+        Off      ///< SetCategoryLevel() 用: そのカテゴリをすべて除外
+    };
+
+    static constexpr size_t CATEGORY_COUNT = static_cast<size_t>(Category::Game) + 1;
+
+    static constexpr uint32_t QUEUE_CAPACITY = 4096;    ///< リングのレコード数(2の累乗)
+    static constexpr uint32_t MAX_MESSAGE_BYTES = 480;  ///< 1レコードの本文の上限(バイト)
+
     static DebugLog& GetInstance() {
         static DebugLog instance;
         return instance;
@@ -79,32 +137,107 @@ public:
             float avgDt = totalTime_ / frameCount_;
             float avgFps = (avgDt > 0.0f) ? (1.0f / avgDt) : 0.0f;
 
-            std::lock_guard<std::mutex> lock(mutex_);
-            WriteLog("INFO", "フレーム統計", Category::System,
-                     "Frames=" + std::to_string(frameCount_) +
-                     ", AvgFPS=" + std::to_string(avgFps) +
-                     ", AvgDt=" + std::to_string(avgDt * 1000.0f) + "ms");
+            push(Level::Info, Category::System,
+                 "フレーム統計 | Frames=" + std::to_string(frameCount_) +
+                 ", AvgFPS=" + std::to_string(avgFps) +
+                 ", AvgDt=" + std::to_string(avgDt * 1000.0f) + "ms");
         }
     }
 
     void Log(const std::string& message) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        WriteLog("INFO", message, Category::General);
+        push(Level::Info, Category::General, message);
     }
 
     void LogError(const std::string& message) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        WriteLog("ERROR", message, Category::General);
+        push(Level::Error, Category::General, message);
     }
 
     void LogWarning(const std::string& message) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        WriteLog("WARNING", message, Category::General);
+        push(Level::Warning, Category::General, message);
     }
 
     void LogWithCategory(Category cat, const std::string& message) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        WriteLog("INFO", message, cat);
+        push(Level::Info, cat, message);
+    }
+
+    /**
+     * @brief 書式付きログ(DEBUGLOG_FMT から呼ばれる)
+     * @param[in] format "{}" を含む書式文字列(書き込まれるまで有効な文字列、通常は文字列リテラル)
+     * @param[in] args "{}" に順に入る引数
+     *
+     * @details
+     * 引数をレコードにバイナリで格納するだけでヒープ確保はしません。
+     * 格納しきれない引数は "{}" のまま出力され、末尾に " (...)" が付きます。
+     */
+    template <class... Args>
+    void LogFormat(Category cat, Level level, const char* format, const Args&... args) {
+        if (!IsEnabled(cat, level)) return;
+        uint64_t pos = 0;
+        Cell* cell = reserve(level, pos);
+        if (!cell) return;
+
+        Record& r = cell->record;
+        stamp(r, level, cat, format);
+        ArgWriter w{ r.text, r.text + MAX_MESSAGE_BYTES };
+        (encodeArg(w, args), ...);
+        r.length = static_cast<uint16_t>(w.p - r.text);
+        r.truncated = w.truncated;
+        publish(cell, pos, level);
+    }
+
+    /**
+     * @brief カテゴリの出力下限を設定(既定はすべて Info)
+     */
+    void SetCategoryLevel(Category cat, Level minLevel) {
+        minLevel_[static_cast<size_t>(cat)].store(static_cast<uint8_t>(minLevel), std::memory_order_relaxed);
+    }
+
+    Level GetCategoryLevel(Category cat) const {
+        return static_cast<Level>(minLevel_[static_cast<size_t>(cat)].load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief そのカテゴリ・レベルのログが出力されるか(マクロが引数を評価する前に呼ぶ)
+     */
+    bool IsEnabled(Category cat, Level level) const {
+        return static_cast<uint8_t>(level) >= minLevel_[static_cast<size_t>(cat)].load(std::memory_order_relaxed) &&
+               level != Level::Off;
+    }
+
+    /**
+     * @brief 呼び出し時点までに積まれたログがファイルに書かれるまで待つ
+     * @param[in] timeoutMs 待つ上限(ミリ秒)
+     * @return bool 書き終えた場合 true(書き込みスレッドがない場合も true)
+     */
+    bool Flush(uint32_t timeoutMs = 1000) {
+        if (!writerRunning_.load(std::memory_order_acquire)) return true;
+        const uint64_t target = enqueuePos_.load(std::memory_order_acquire);
+        wake();
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        return flushedCv_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] {
+            return written_.load(std::memory_order_acquire) >= target;
+        });
+    }
+
+    /**
+     * @brief リングが一杯のとき INFO も空きを待つか(既定は false: 破棄して件数を数える)
+     */
+    void SetBlockWhenFull(bool block) {
+        blockWhenFull_.store(block, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief リングが一杯で破棄したログの累計
+     */
+    uint64_t GetDroppedCount() const {
+        return droppedTotal_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief リングバッファが確保しているバイト数(MemoryTracker への報告用)
+     */
+    size_t GetMemoryBytes() const {
+        return sizeof(Cell) * QUEUE_CAPACITY;
     }
 
     /**
@@ -128,20 +261,49 @@ public:
         float recentAvgDt = (recentValidCount > 0) ? (recentSum / recentValidCount) : 0.0f;
         float recentAvgFps = (recentAvgDt > 0.0f) ? (1.0f / recentAvgDt) : 0.0f;
 
-        logFile_ << "========================================" << std::endl;
-        logFile_ << "フレーム統計（DebugLog）" << std::endl;
-        logFile_ << "========================================" << std::endl;
-        logFile_ << "総フレーム数: " << frameCount_ << std::endl;
-        logFile_ << "総実行時間: " << std::fixed << std::setprecision(2) << totalTime_ << "秒" << std::endl;
-        logFile_ << "平均FPS: " << std::fixed << std::setprecision(2) << avgFps << std::endl;
-        logFile_ << "平均フレーム時間: " << std::fixed << std::setprecision(2) << (avgDt * 1000.0f) << "ms" << std::endl;
-        logFile_ << "直近100フレームの平均FPS: " << std::fixed << std::setprecision(2) << recentAvgFps << std::endl;
-        logFile_ << "直近100フレームの平均時間: " << std::fixed << std::setprecision(2) << (recentAvgDt * 1000.0f) << "ms" << std::endl;
-        logFile_ << "========================================" << std::endl;
+        std::ostringstream oss;
+        oss << "========================================\n";
+        oss << "フレーム統計（DebugLog）\n";
+        oss << "========================================\n";
+        oss << "総フレーム数: " << frameCount_ << "\n";
+        oss << "総実行時間: " << std::fixed << std::setprecision(2) << totalTime_ << "秒\n";
+        oss << "平均FPS: " << std::fixed << std::setprecision(2) << avgFps << "\n";
+        oss << "平均フレーム時間: " << std::fixed << std::setprecision(2) << (avgDt * 1000.0f) << "ms\n";
+        oss << "直近100フレームの平均FPS: " << std::fixed << std::setprecision(2) << recentAvgFps << "\n";
+        oss << "直近100フレームの平均時間: " << std::fixed << std::setprecision(2) << (recentAvgDt * 1000.0f) << "ms\n";
+        oss << "========================================\n";
+        writeRaw(oss.str());
     }
 
 private:
+    /**
+     * @struct Record
+     * @brief リングの1要素(呼び出し側で確定する情報と本文)
+     */
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        uint64_t frame = 0;
+        std::thread::id threadId;
+        Level level = Level::Info;
+        Category category = Category::General;
+        const char* format = nullptr;  ///< 書式付きログの書式(text は引数のバイナリ)、通常のログは nullptr
+        bool truncated = false;
+        uint16_t length = 0;
+        char text[MAX_MESSAGE_BYTES];
+    };
+
+    struct Cell {
+        std::atomic<uint64_t> sequence{ 0 };  ///< 位置 pos の書き込み可: pos、読み出し可: pos + 1
+        Record record;
+    };
+
     DebugLog() {
+        for (uint32_t i = 0; i < QUEUE_CAPACITY; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        for (std::atomic<uint8_t>& level : minLevel_) {
+            level.store(static_cast<uint8_t>(Level::Info), std::memory_order_relaxed);
+        }
 #ifdef _DEBUG
         // UTF-8 BOMで出力するため、バイナリモードで開く
         logFile_.open("debug_log.txt", std::ios::out | std::ios::trunc | std::ios::binary);
@@ -153,6 +315,10 @@ private:
             logFile_ << "デバッグログ開始" << std::endl;
             logFile_ << "========================================" << std::endl;
             logFile_.flush();
+
+            writerRunning_.store(true, std::memory_order_release);
+            writer_ = std::thread([this] { writerLoop(); });
+            previousTerminate_ = std::set_terminate(&DebugLog::onTerminate);
         }
 #endif
     }
@@ -160,7 +326,8 @@ private:
     ~DebugLog() {
 #ifdef _DEBUG
         if (logFile_.is_open()) {
-            // 終了時統計を出力
+            // 残りのログを書き出してから終了時統計を出力
+            stopWriter();
             OutputShutdownStatistics();
 
             logFile_ << "========================================" << std::endl;
@@ -179,52 +346,397 @@ private:
             case Category::Graphics: return "Graphics";
             case Category::Scene: return "Scene";
             case Category::System: return "System";
+            case Category::Game: return "Game";
             default: return "General";
         }
     }
 
-    void WriteLog(const std::string& level, const std::string& message, Category cat, const std::string& extra = "") {
-        if (logFile_.is_open()) {
-            auto now = std::chrono::system_clock::now();
-            auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    static const char* LevelToString(Level level) {
+        switch (level) {
+            case Level::Warning: return "WARNING";
+            case Level::Error: return "ERROR";
+            default: return "INFO";
+        }
+    }
 
-            std::tm bt{};
-            localtime_s(&bt, &in_time_t);
+    /**
+     * @enum ArgType
+     * @brief 書式付きログの引数の型タグ
+     */
+    enum class ArgType : uint8_t {
+        Int,     ///< int64_t
+        UInt,    ///< uint64_t
+        Double,  ///< double
+        Bool,    ///< uint8_t
+        Char,    ///< char
+        String   ///< uint16_t の長さ + バイト列
+    };
 
-            // フレームプレフィックス
-            uint64_t frame = currentFrame_.load(std::memory_order_relaxed);
+    struct ArgWriter {
+        char* p;
+        char* end;
+        bool truncated = false;
+    };
 
-            // スレッドID取得
-            auto threadId = std::this_thread::get_id();
-            std::ostringstream oss;
-            oss << threadId;
+    template <class T>
+    static void putScalar(ArgWriter& w, ArgType type, T value) {
+        if (w.truncated || static_cast<size_t>(w.end - w.p) < 1 + sizeof(T)) {
+            w.truncated = true;
+            return;
+        }
+        *w.p++ = static_cast<char>(type);
+        std::memcpy(w.p, &value, sizeof(T));
+        w.p += sizeof(T);
+    }
 
-            logFile_ << std::put_time(&bt, "%Y-%m-%d %H:%M:%S")
-                     << " [F#" << frame << "]"
-                     << " [TID:" << oss.str() << "]"
-                     << " [" << CategoryToString(cat) << "]"
-                     << " [" << level << "] " << message;
+    static void putString(ArgWriter& w, const char* text, size_t length) {
+        const size_t header = 1 + sizeof(uint16_t);
+        if (w.truncated || static_cast<size_t>(w.end - w.p) <= header) {
+            w.truncated = true;
+            return;
+        }
+        const size_t room = static_cast<size_t>(w.end - w.p) - header;
+        if (length > room) {
+            length = utf8Prefix(text, room);
+            w.truncated = true;
+        }
+        *w.p++ = static_cast<char>(ArgType::String);
+        const uint16_t len16 = static_cast<uint16_t>(length);
+        std::memcpy(w.p, &len16, sizeof(len16));
+        w.p += sizeof(len16);
+        std::memcpy(w.p, text, length);
+        w.p += length;
+    }
+
+    template <class T>
+    static void encodeArg(ArgWriter& w, const T& value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            putScalar(w, ArgType::Bool, static_cast<uint8_t>(value ? 1 : 0));
+        } else if constexpr (std::is_same_v<U, char>) {
+            putScalar(w, ArgType::Char, value);
+        } else if constexpr (std::is_enum_v<U>) {
+            putScalar(w, ArgType::Int, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            putScalar(w, ArgType::Int, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<U>) {
+            putScalar(w, ArgType::UInt, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<U>) {
+            putScalar(w, ArgType::Double, static_cast<double>(value));
+        } else if constexpr (std::is_same_v<U, std::string>) {
+            putString(w, value.data(), value.size());
+        } else {
+            static_assert(std::is_convertible_v<const T&, const char*>, "DEBUGLOG_FMT: 対応していない引数の型です");
+            const char* text = value;
+            putString(w, text ? text : "(null)", text ? std::strlen(text) : 6);
+        }
+    }
+
+    // 引数を1つ読み出して out に追加(読めなければ false)
+    static bool decodeArg(const char*& p, const char* end, std::string& out) {
+        if (p >= end) return false;
+        const ArgType type = static_cast<ArgType>(*p++);
+        char buf[32];
+        auto read = [&](auto& value) {
+            if (static_cast<size_t>(end - p) < sizeof(value)) return false;
+            std::memcpy(&value, p, sizeof(value));
+            p += sizeof(value);
+            return true;
+        };
+        switch (type) {
+            case ArgType::Int: {
+                int64_t v = 0;
+                if (!read(v)) return false;
+                snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v));
+                out += buf;
+                return true;
+            }
+            case ArgType::UInt: {
+                uint64_t v = 0;
+                if (!read(v)) return false;
+                snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(v));
+                out += buf;
+                return true;
+            }
+            case ArgType::Double: {
+                double v = 0.0;
+                if (!read(v)) return false;
+                snprintf(buf, sizeof(buf), "%g", v);
+                out += buf;
+                return true;
+            }
+            case ArgType::Bool: {
+                uint8_t v = 0;
+                if (!read(v)) return false;
+                out += v ? "true" : "false";
+                return true;
+            }
+            case ArgType::Char: {
+                char v = 0;
+                if (!read(v)) return false;
+                out += v;
+                return true;
+            }
+            case ArgType::String: {
+                uint16_t length = 0;
+                if (!read(length) || static_cast<size_t>(end - p) < length) return false;
+                out.append(p, length);
+                p += length;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 書式の "{}" を引数で置き換えて out に追加
+    static void expand(const Record& r, std::string& out) {
+        const char* p = r.text;
+        const char* end = r.text + r.length;
+        for (const char* f = r.format; *f; ++f) {
+            if ((f[0] == '{' && f[1] == '{') || (f[0] == '}' && f[1] == '}')) {
+                out += *f++;
+            } else if (f[0] == '{' && f[1] == '}') {
+                if (!decodeArg(p, end, out)) out += "{}";
+                ++f;
+            } else {
+                out += *f;
+            }
+        }
+    }
+
+    // UTF-8 の文字境界で maxBytes 以下に収まる長さ
+    static size_t utf8Prefix(const char* text, size_t maxBytes) {
+        size_t length = maxBytes;
+        while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) --length;
+        return length;
+    }
+
+    // リングの1要素を確保する(書き込みスレッドがない場合と、一杯で破棄する場合は nullptr)
+    Cell* reserve(Level level, uint64_t& pos) {
+        if (!writerRunning_.load(std::memory_order_acquire)) return nullptr;
+
+        const bool block = level != Level::Info || blockWhenFull_.load(std::memory_order_relaxed);
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell = &cells_[pos & (QUEUE_CAPACITY - 1)];
+            uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return cell;
+            } else if (diff < 0) {
+                // 一杯: 書き込みスレッドが追いつくのを待つか、破棄する
+                if (!block) {
+                    droppedTotal_.fetch_add(1, std::memory_order_relaxed);
+                    droppedPending_.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                wake();
+                std::this_thread::yield();
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void stamp(Record& r, Level level, Category cat, const char* format) {
+        r.time = std::chrono::system_clock::now();
+        r.frame = currentFrame_.load(std::memory_order_relaxed);
+        r.threadId = std::this_thread::get_id();
+        r.level = level;
+        r.category = cat;
+        r.format = format;
+    }
+
+    // 書き終えたレコードを書き込みスレッドに渡す
+    void publish(Cell* cell, uint64_t pos, Level level) {
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        // 重要なログと、リングが半分埋まった場合はすぐに書き込みスレッドを起こす
+        if (level != Level::Info || pos - written_.load(std::memory_order_relaxed) >= QUEUE_CAPACITY / 2) {
+            wake();
+        }
+    }
 
-            if (!extra.empty()) {
-                logFile_ << " | " << extra;
+    // 文字列のログをリングに積む
+    void push(Level level, Category cat, const std::string& message) {
+        if (!IsEnabled(cat, level)) return;
+        uint64_t pos = 0;
+        Cell* cell = reserve(level, pos);
+        if (!cell) return;
+
+        Record& r = cell->record;
+        stamp(r, level, cat, nullptr);
+        size_t length = message.size();
+        r.truncated = length > MAX_MESSAGE_BYTES;
+        if (r.truncated) {
+            // UTF-8 の継続バイトの途中で切らない
+            length = utf8Prefix(message.data(), MAX_MESSAGE_BYTES);
+        }
+        std::memcpy(r.text, message.data(), length);
+        r.length = static_cast<uint16_t>(length);
+        publish(cell, pos, level);
+    }
+
+    void wake() {
+        wakeRequested_.store(true, std::memory_order_release);
+        wakeCv_.notify_one();
+    }
+
+    // 書き込みスレッド: 積まれたレコードをまとめて書式化し、1回の書き込みで出力する
+    void writerLoop() {
+        std::string batch;
+        batch.reserve(64 * 1024);
+        for (;;) {
+            const bool stopping = !writerRunning_.load(std::memory_order_acquire);
+            bool flushNow = false;
+            batch.clear();
+
+            uint64_t dropped = droppedPending_.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                batch += "[DebugLog] リングが一杯のため " + std::to_string(dropped) + " 件のログを破棄しました\n";
             }
 
-            logFile_ << std::endl;
+            uint64_t pos = dequeuePos_;
+            for (;;) {
+                Cell& cell = cells_[pos & (QUEUE_CAPACITY - 1)];
+                if (cell.sequence.load(std::memory_order_acquire) != pos + 1) break;
+                format(cell.record, batch);
+                if (cell.record.level != Level::Info) flushNow = true;
+                cell.sequence.store(pos + QUEUE_CAPACITY, std::memory_order_release);
+                ++pos;
+            }
+            const bool wroteAny = pos != dequeuePos_;
+            dequeuePos_ = pos;
 
-            // 重要なログは即座にフラッシュ
-            if (level == "ERROR" || level == "WARNING") {
-                logFile_.flush();
+            if (!batch.empty()) {
+                logFile_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                // 重要なログを含むバッチと、待っている Flush() がある場合は即座にフラッシュ
+                if (flushNow || wakeRequested_.load(std::memory_order_acquire)) logFile_.flush();
             }
+            if (wroteAny) {
+                {
+                    std::lock_guard<std::mutex> lock(flushMutex_);
+                    written_.store(pos, std::memory_order_release);
+                }
+                flushedCv_.notify_all();
+            }
+
+            if (stopping) {
+                // 停止時は確保済みのレコードをすべて書き終えるまで続ける
+                if (dequeuePos_ == enqueuePos_.load(std::memory_order_acquire)) break;
+                if (!wroteAny) std::this_thread::yield();
+                continue;
+            }
+            if (!wroteAny) {
+                std::unique_lock<std::mutex> lock(wakeMutex_);
+                wakeCv_.wait_for(lock, std::chrono::milliseconds(WRITER_INTERVAL_MS), [this] {
+                    return wakeRequested_.load(std::memory_order_acquire);
+                });
+                wakeRequested_.store(false, std::memory_order_relaxed);
+            }
+        }
+        logFile_.flush();
+    }
+
+    // 1件を書式化して out に追加(時刻とスレッドIDの文字列は直前のレコードと同じなら使い回す)
+    void format(const Record& r, std::string& out) {
+        auto in_time_t = std::chrono::system_clock::to_time_t(r.time);
+        if (in_time_t != cachedTime_ || cachedTimeText_.empty()) {
+            std::tm bt{};
+            localtime_s(&bt, &in_time_t);
+            std::ostringstream oss;
+            oss << std::put_time(&bt, "%Y-%m-%d %H:%M:%S");
+            cachedTime_ = in_time_t;
+            cachedTimeText_ = oss.str();
+        }
+        if (r.threadId != cachedThreadId_ || cachedThreadText_.empty()) {
+            std::ostringstream oss;
+            oss << r.threadId;
+            cachedThreadId_ = r.threadId;
+            cachedThreadText_ = oss.str();
+        }
+
+        out += cachedTimeText_;
+        out += " [F#";
+        out += std::to_string(r.frame);
+        out += "] [TID:";
+        out += cachedThreadText_;
+        out += "] [";
+        out += CategoryToString(r.category);
+        out += "] [";
+        out += LevelToString(r.level);
+        out += "] ";
+        if (r.format) {
+            expand(r, out);
+        } else {
+            out.append(r.text, r.length);
         }
+        if (r.truncated) out += " (...)";
+        out += '\n';
+    }
+
+    // 複数行の統計を出力(書き込みスレッドの動作中はレコードとして積み、停止後は直接書く)
+    void writeRaw(const std::string& text) {
+        if (!writerRunning_.load(std::memory_order_acquire)) {
+            if (logFile_.is_open()) logFile_ << text;
+            return;
+        }
+        for (size_t begin = 0; begin < text.size();) {
+            size_t end = text.find('\n', begin);
+            if (end == std::string::npos) end = text.size();
+            push(Level::Info, Category::System, text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    }
+
+    void stopWriter() {
+        if (!writer_.joinable()) return;
+        writerRunning_.store(false, std::memory_order_release);
+        wake();
+        writer_.join();
+    }
+
+    static void onTerminate() {
+        DebugLog& log = GetInstance();
+        log.push(Level::Error, Category::System, "std::terminate が呼ばれました");
+        log.Flush();
+        if (log.previousTerminate_) log.previousTerminate_();
+        std::abort();
     }
 
     DebugLog(const DebugLog&) = delete;
     DebugLog& operator=(const DebugLog&) = delete;
 
+    static constexpr uint32_t WRITER_INTERVAL_MS = 20;  ///< 書き込みスレッドの最大待機時間
+
     std::ofstream logFile_;
-    std::mutex mutex_;
     std::atomic<uint64_t> currentFrame_{0};
 
+    // リング(Vyukov の有界MPMCキューを単一消費者で使用)
+    std::unique_ptr<Cell[]> cells_{ new Cell[QUEUE_CAPACITY] };
+    std::atomic<uint64_t> enqueuePos_{ 0 };      ///< 次に確保する位置(生成者が CAS で進める)
+    uint64_t dequeuePos_ = 0;                     ///< 次に読む位置(書き込みスレッドのみ)
+    std::atomic<uint64_t> written_{ 0 };          ///< 書き込み済みの位置(Flush の待機用)
+    std::atomic<uint64_t> droppedTotal_{ 0 };     ///< 破棄したログの累計
+    std::atomic<uint64_t> droppedPending_{ 0 };   ///< 未報告の破棄件数
+    std::atomic<bool> blockWhenFull_{ false };
+    std::atomic<uint8_t> minLevel_[CATEGORY_COUNT];  ///< カテゴリごとの出力下限(Level)
+
+    // 書き込みスレッド
+    std::thread writer_;
+    std::atomic<bool> writerRunning_{ false };
+    std::atomic<bool> wakeRequested_{ false };
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    std::mutex flushMutex_;
+    std::condition_variable flushedCv_;
+    std::terminate_handler previousTerminate_ = nullptr;
+    std::time_t cachedTime_ = 0;          ///< 書き込みスレッドのみ
+    std::string cachedTimeText_;
+    std::thread::id cachedThreadId_;
+    std::string cachedThreadText_;
+
     // フレーム計測
     std::chrono::high_resolution_clock::time_point frameStartTime_;
     uint64_t frameCount_ = 0;
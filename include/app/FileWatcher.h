@@ -0,0 +1,226 @@
+/**
+ * @file FileWatcher.h
+ * @brief ディレクトリ以下のファイルの変更を ReadDirectoryChangesW で受け取る監視
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 監視用のスレッドが各ディレクトリ(サブディレクトリを含む)の変更通知を待ち、書き込み・作成・名前の変更が
+ * あったファイルのパスを記録します。メインスレッドは Poll() で、最後の通知から DEBOUNCE_MS 以上経った
+ * パスだけを受け取ります(エディタやツールは1回の保存で複数回書き込むため、書き終わるまで待つ)。
+ *
+ * 毎回すべてのファイルの更新日時を確認するのと異なり、変更がなければメインスレッドの負荷はありません。
+ * 通知のバッファがあふれた場合は個々のパスが失われるため、Poll() の overflowed で全体の確認を促します。
+ *
+ * @par 使用例
+ * @code
+ * FileWatcher watcher;
+ * watcher.Start({ "Assets" });
+ * // 毎フレーム
+ * std::vector<std::string> changed;
+ * bool overflowed = false;
+ * watcher.Poll(changed, overflowed);  // "Assets/Textures/test.png" など('/' 区切り)
+ * @endcode
+ */
+#pragma once
+#include <Windows.h>
+#include "app/DebugLog.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FileWatcher
+ * @brief ディレクトリの変更の監視(Start() / Stop() と Poll() はメインスレッドから呼ぶ)
+ */
+class FileWatcher {
+public:
+    static constexpr uint32_t DEBOUNCE_MS = 150;          ///< 最後の通知からこの時間が経ったら変更として渡す
+    static constexpr DWORD NOTIFY_BUFFER_BYTES = 64 * 1024; ///< ディレクトリごとの通知バッファ
+
+    FileWatcher() = default;
+    ~FileWatcher() { Stop(); }
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief 監視を開始(既に開始していれば止めてから始め直す)
+     * @param[in] directories 監視するディレクトリ(サブディレクトリも含む。開けないものは飛ばす)
+     * @return bool 1つ以上のディレクトリを監視できた場合 true
+     */
+    bool Start(const std::vector<std::string>& directories) {
+        Stop();
+        for (const std::string& directory : directories) {
+            HANDLE handle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+            if (handle == INVALID_HANDLE_VALUE) {
+                DEBUGLOG_WARNING("FileWatcher - ディレクトリを開けません: " + directory);
+                continue;
+            }
+            Watch watch;
+            watch.directory = normalize(directory);
+            watch.handle = handle;
+            watch.overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+            watch.buffer.resize(NOTIFY_BUFFER_BYTES / sizeof(DWORD)); // FILE_NOTIFY_INFORMATION は DWORD 境界
+            watches_.push_back(std::move(watch));
+        }
+        if (watches_.empty()) return false;
+
+        for (Watch& watch : watches_) {
+            issue(watch);
+        }
+        stopEvent_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        thread_ = std::thread([this]() { run(); });
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "FileWatcher - " + std::to_string(watches_.size()) + " 個のディレクトリを監視");
+        return true;
+    }
+
+    /**
+     * @brief 監視を停止(記録済みの変更は捨てる)
+     */
+    void Stop() {
+        if (thread_.joinable()) {
+            SetEvent(stopEvent_);
+            thread_.join();
+        }
+        for (Watch& watch : watches_) {
+            CancelIoEx(watch.handle, &watch.overlapped);
+            DWORD bytes = 0;
+            GetOverlappedResult(watch.handle, &watch.overlapped, &bytes, TRUE); // 取り消しの完了を待ってからバッファを捨てる
+            CloseHandle(watch.overlapped.hEvent);
+            CloseHandle(watch.handle);
+        }
+        watches_.clear();
+        if (stopEvent_) {
+            CloseHandle(stopEvent_);
+            stopEvent_ = nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        changes_.clear();
+        overflowed_ = false;
+    }
+
+    bool IsRunning() const { return thread_.joinable(); }
+
+    /**
+     * @brief 書き終わった(最後の通知から DEBOUNCE_MS 以上経った)変更を取り出す
+     * @param[out] changed 変更されたファイルのパス(監視ディレクトリ + 相対パス、'/' 区切り。追加する)
+     * @param[out] overflowed 通知があふれて一部のパスが失われた場合 true(呼び出し側で全体を確認する)
+     */
+    void Poll(std::vector<std::string>& changed, bool& overflowed) {
+        overflowed = false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (changes_.empty() && !overflowed_) return;
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto debounce = std::chrono::milliseconds(DEBOUNCE_MS);
+        for (auto it = changes_.begin(); it != changes_.end();) {
+            if (now - it->second >= debounce) {
+                changed.push_back(it->first);
+                it = changes_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (overflowed_ && now - overflowTime_ >= debounce) {
+            overflowed = true;
+            overflowed_ = false;
+        }
+    }
+
+private:
+    /**
+     * @struct Watch
+     * @brief 監視中のディレクトリ1つ分
+     */
+    struct Watch {
+        std::string directory;     ///< 監視ディレクトリ('/' 区切り、末尾の '/' なし)
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped = {};
+        std::vector<DWORD> buffer; ///< 通知の受け取り先
+    };
+
+    static std::string normalize(std::string path) {
+        for (char& c : path) {
+            if (c == '\\') c = '/';
+        }
+        while (path.size() > 1 && path.back() == '/') path.pop_back();
+        return path;
+    }
+
+    // 次の通知の受け取りを始める
+    static bool issue(Watch& watch) {
+        ResetEvent(watch.overlapped.hEvent);
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+        return ReadDirectoryChangesW(watch.handle, watch.buffer.data(), static_cast<DWORD>(watch.buffer.size() * sizeof(DWORD)),
+                                     TRUE, filter, nullptr, &watch.overlapped, nullptr) != FALSE;
+    }
+
+    // 監視用スレッド: いずれかのディレクトリの通知か停止を待つ
+    void run() {
+        std::vector<HANDLE> events;   // 先頭は停止、以降は active と同じ順
+        std::vector<Watch*> active;
+        events.push_back(stopEvent_);
+        for (Watch& watch : watches_) {
+            events.push_back(watch.overlapped.hEvent);
+            active.push_back(&watch);
+        }
+
+        while (!active.empty()) {
+            DWORD result = WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, INFINITE);
+            if (result <= WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + events.size()) return;
+
+            const size_t index = result - WAIT_OBJECT_0 - 1;
+            Watch& watch = *active[index];
+            DWORD bytes = 0;
+            if (GetOverlappedResult(watch.handle, &watch.overlapped, &bytes, FALSE)) {
+                record(watch, bytes);
+            }
+            if (!issue(watch)) {
+                DEBUGLOG_WARNING("FileWatcher - 監視を続けられません: " + watch.directory);
+                events.erase(events.begin() + index + 1);
+                active.erase(active.begin() + index);
+            }
+        }
+    }
+
+    // 受け取った通知からファイルのパスを記録する(bytes が 0 ならバッファがあふれた)
+    void record(const Watch& watch, DWORD bytes) {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes == 0) {
+            overflowed_ = true;
+            overflowTime_ = now;
+            return;
+        }
+
+        const uint8_t* cursor = reinterpret_cast<const uint8_t*>(watch.buffer.data());
+        for (;;) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                const int wideLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+                char name[MAX_PATH * 2];
+                int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, wideLength, name, sizeof(name), nullptr, nullptr);
+                if (length > 0) {
+                    changes_[normalize(watch.directory + "/" + std::string(name, length))] = now;
+                }
+            }
+            if (info->NextEntryOffset == 0) break;
+            cursor += info->NextEntryOffset;
+        }
+    }
+
+    std::vector<Watch> watches_;
+    HANDLE stopEvent_ = nullptr;
+    std::thread thread_;
+
+    std::mutex mutex_;  ///< 以下を監視用スレッドと共有
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> changes_; ///< パス -> 最後の通知
+    bool overflowed_ = false;
+    std::chrono::steady_clock::time_point overflowTime_;
+};
@@ -0,0 +1,149 @@
+/**
+ * @file FrameArena.h
+ * @brief フレーム単位で一括解放する線形アロケータ(std::pmr 対応)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * フレーム中の一時データ(破棄・スポーンキューの写しなど)を、先頭から詰めて確保するだけの
+ * アロケータです。個別の解放は行わず、Reset() でオフセットを先頭に戻して全体を一度に解放します。
+ *
+ * スレッドごとに1つ(ForThread())持ち、リセットはそのスレッドのフレームの区切りで行います。
+ * - メインスレッド: App のフレーム終端(Present の後)
+ * - SimulationThread: 投入された処理の完了後
+ * - JobSystem のワーカー: ジョブ1件の完了後
+ *
+ * 容量を超えた確保は上位のリソース(new/delete)から行い、次の Reset() で解放したうえで
+ * そのフレームの使用量が収まるまでバッファを拡張します。以降の同じ規模のフレームでは
+ * ヒープ確保は発生しません。
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+/**
+ * @class FrameArena
+ * @brief フレーム単位の線形アロケータ
+ *
+ * @par 使用例
+ * @code
+ * FrameArena& arena = FrameArena::ForThread();
+ * std::pmr::vector<uint32_t> ids(&arena); // フレーム終端まで有効
+ * ids.reserve(count);
+ *
+ * // フレーム終端(このスレッドで)
+ * FrameArena::ForThread().Reset();
+ * @endcode
+ *
+ * @note 確保したメモリは同じスレッドの次の Reset() まで有効です。フレームをまたいで保持しないでください。
+ */
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024; ///< 最初の確保で用意するバッファ(バイト)
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+    ~FrameArena() override {
+        releaseOverflow();
+        releaseBuffer();
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief 呼び出しスレッドのアリーナ
+     */
+    static FrameArena& ForThread() {
+        static thread_local FrameArena arena;
+        return arena;
+    }
+
+    /**
+     * @brief 確保したメモリをすべて解放
+     *
+     * @details
+     * 通常はオフセットを戻すだけです。容量を超えたフレームの後だけ、溢れた分を解放して
+     * バッファをそのフレームの使用量まで広げます。
+     */
+    void Reset() {
+        const size_t frameBytes = offset_ + overflowBytes_;
+        if (frameBytes > peak_) peak_ = frameBytes;
+        if (!overflow_.empty()) {
+            releaseOverflow();
+            if (frameBytes > capacity_) {
+                releaseBuffer();
+                capacity_ = frameBytes + frameBytes / 2;
+                ++growCount_;
+            }
+        }
+        offset_ = 0;
+    }
+
+    size_t Used() const { return offset_ + overflowBytes_; }   ///< 前回の Reset() 以降の確保量(バイト、アラインメント込み)
+    size_t Capacity() const { return capacity_; }             ///< バッファの容量(バイト)
+    size_t Peak() const { return peak_; }                     ///< 1フレームの最大使用量(バイト、Reset() 時に更新)
+    uint32_t GrowCount() const { return growCount_; }         ///< バッファを拡張した回数
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (!buffer_) {
+            buffer_ = static_cast<std::byte*>(::operator new(capacity_, std::align_val_t{ alignof(std::max_align_t) }));
+        }
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(buffer_);
+        const uintptr_t aligned = (base + offset_ + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+        const size_t end = static_cast<size_t>(aligned - base) + bytes;
+        if (end <= capacity_) {
+            offset_ = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        // 容量不足(このフレームだけ上位から確保し、Reset() で拡張)
+        void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        overflow_.push_back(Overflow{ p, bytes, alignment });
+        overflowBytes_ += bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+        // 個別には解放しない(Reset() で一括)
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct Overflow {
+        void* ptr;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    void releaseOverflow() {
+        for (const Overflow& o : overflow_) {
+            std::pmr::new_delete_resource()->deallocate(o.ptr, o.bytes, o.alignment);
+        }
+        overflow_.clear();
+        overflowBytes_ = 0;
+    }
+
+    void releaseBuffer() {
+        if (!buffer_) return;
+        ::operator delete(buffer_, std::align_val_t{ alignof(std::max_align_t) });
+        buffer_ = nullptr;
+    }
+
+    std::byte* buffer_ = nullptr;     ///< 線形に確保するバッファ(最初の確保時に作成)
+    size_t capacity_ = 0;             ///< buffer_ の容量
+    size_t offset_ = 0;               ///< 次の確保位置
+    std::vector<Overflow> overflow_;  ///< 容量不足で上位から確保したブロック
+    size_t overflowBytes_ = 0;        ///< overflow_ の合計
+    size_t peak_ = 0;                 ///< 1フレームの最大使用量
+    uint32_t growCount_ = 0;          ///< 拡張回数
+};
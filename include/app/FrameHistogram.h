@@ -0,0 +1,207 @@
+/**
+ * @file FrameHistogram.h
+ * @brief 固定メモリで百分位を求めるフレーム時間のヒストグラム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * HDR ヒストグラムと同じく、値(マイクロ秒)を「2の累乗の区間 × 32分割」のバケットに数えます。
+ * 記録は O(1)、メモリは固定(約2.8KB)で、百分位の誤差は約3%です。
+ * RollingFrameHistogram は1秒ごとのヒストグラムを60秒分持ち、直近1秒・10秒・60秒の百分位と、
+ * セッション全体の百分位を同時に求めます。長時間の実行でも後半のスパイクを取りこぼしません。
+ */
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @class FrameHistogram
+ * @brief マイクロ秒の値の対数線形ヒストグラム
+ */
+class FrameHistogram {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 5;                    ///< 2の累乗の区間を 2^5 = 32 分割
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr uint32_t MAX_EXPONENT = 25;                       ///< 2^26 マイクロ秒(約67秒)未満を区別、以上は最後のバケット
+    static constexpr uint32_t BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    FrameHistogram() { Reset(); }
+
+    void Reset() {
+        std::memset(buckets_, 0, sizeof(buckets_));
+        count_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    /**
+     * @brief 値を追加
+     * @param[in] micros 値(マイクロ秒)
+     */
+    void Record(uint64_t micros) {
+        ++buckets_[bucketOf(micros)];
+        ++count_;
+        sum_ += micros;
+        if (micros < min_) min_ = micros;
+        if (micros > max_) max_ = micros;
+    }
+
+    /**
+     * @brief 秒の値を追加(負の値は 0)
+     */
+    void RecordSeconds(float seconds) {
+        Record(seconds > 0.0f ? static_cast<uint64_t>(seconds * 1000000.0f) : 0);
+    }
+
+    /**
+     * @brief 別のヒストグラムを加算
+     */
+    void Merge(const FrameHistogram& other) {
+        if (other.count_ == 0) return;
+        for (uint32_t i = 0; i < BUCKET_COUNT; ++i) buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        if (other.min_ < min_) min_ = other.min_;
+        if (other.max_ > max_) max_ = other.max_;
+    }
+
+    uint64_t Count() const { return count_; }
+    uint64_t MinMicros() const { return count_ ? min_ : 0; }
+    uint64_t MaxMicros() const { return max_; }
+    double MeanMicros() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    /**
+     * @brief 百分位の値(マイクロ秒、バケットの上端。最大値は超えない)
+     * @param[in] percentile 0〜100
+     */
+    uint64_t ValueAtPercentile(double percentile) const {
+        if (count_ == 0) return 0;
+        if (percentile >= 100.0) return max_;
+        uint64_t target = static_cast<uint64_t>(percentile * 0.01 * count_ + 0.5);
+        if (target < 1) target = 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets_[i];
+            if (seen >= target) {
+                uint64_t upper = bucketUpper(i);
+                if (upper > max_) upper = max_;
+                return upper < min_ ? min_ : upper;
+            }
+        }
+        return max_;
+    }
+
+    // 秒で取得する版(FrameMetrics と同じ単位)
+    float MeanSeconds() const { return static_cast<float>(MeanMicros() * 1e-6); }
+    float MinSeconds() const { return MinMicros() * 1e-6f; }
+    float MaxSeconds() const { return MaxMicros() * 1e-6f; }
+    float PercentileSeconds(double percentile) const { return ValueAtPercentile(percentile) * 1e-6f; }
+
+private:
+    // 32未満はそのまま、以上は最上位ビットの位置と続く5ビットで区間を決める
+    static uint32_t bucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS) return static_cast<uint32_t>(v);
+        uint32_t exponent = 63;
+        while (!(v >> exponent)) --exponent;
+        if (exponent > MAX_EXPONENT) return BUCKET_COUNT - 1;
+        const uint32_t sub = static_cast<uint32_t>(v >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+    }
+
+    // バケットに入る最大の値
+    static uint64_t bucketUpper(uint32_t index) {
+        if (index < SUB_BUCKETS) return index;
+        const uint32_t exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+        const uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        const uint64_t width = 1ull << (exponent - SUB_BUCKET_BITS);
+        return ((SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS)) + width - 1;
+    }
+
+    uint32_t buckets_[BUCKET_COUNT];
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+/**
+ * @class RollingFrameHistogram
+ * @brief 1秒ごとのヒストグラムのリング(直近 WINDOW_SECONDS 秒)とセッション全体
+ *
+ * @par 使用例
+ * @code
+ * RollingFrameHistogram frameTime;
+ * frameTime.Record(dt, elapsedSeconds);
+ *
+ * FrameHistogram last10s;
+ * frameTime.Window(10, last10s);
+ * float p99 = last10s.PercentileSeconds(99.0);
+ * @endcode
+ */
+class RollingFrameHistogram {
+public:
+    static constexpr uint32_t WINDOW_SECONDS = 60; ///< 保持する秒数(Window() の上限)
+
+    /**
+     * @brief 値を追加
+     * @param[in] seconds 値(秒)
+     * @param[in] nowSeconds 現在時刻(秒、単調増加。1秒単位で区間を切り替える)
+     */
+    void Record(float seconds, double nowSeconds) {
+        advance(nowSeconds);
+        slots_[currentSlot_].RecordSeconds(seconds);
+        total_.RecordSeconds(seconds);
+    }
+
+    /**
+     * @brief 直近 windowSeconds 秒(現在の1秒を含む)を out に集計
+     * @param[in] nowSeconds 現在時刻(記録が途切れていた区間を除くため)
+     */
+    void Window(uint32_t windowSeconds, double nowSeconds, FrameHistogram& out) {
+        advance(nowSeconds);
+        out.Reset();
+        if (windowSeconds > WINDOW_SECONDS) windowSeconds = WINDOW_SECONDS;
+        for (uint32_t i = 0; i < windowSeconds; ++i) {
+            out.Merge(slots_[(currentSlot_ + SLOT_COUNT - i) % SLOT_COUNT]);
+        }
+    }
+
+    /**
+     * @brief セッション全体
+     */
+    const FrameHistogram& Total() const { return total_; }
+
+    void Reset() {
+        for (FrameHistogram& slot : slots_) slot.Reset();
+        total_.Reset();
+        currentSecond_ = -1;
+        currentSlot_ = 0;
+    }
+
+private:
+    static constexpr uint32_t SLOT_COUNT = WINDOW_SECONDS;
+
+    // 現在の秒の区間へ進める(飛ばした秒の区間は空にする)
+    void advance(double nowSeconds) {
+        const int64_t second = static_cast<int64_t>(nowSeconds);
+        if (currentSecond_ < 0) {
+            currentSecond_ = second;
+            return;
+        }
+        int64_t steps = second - currentSecond_;
+        if (steps <= 0) return;
+        if (steps > SLOT_COUNT) steps = SLOT_COUNT;
+        for (int64_t i = 0; i < steps; ++i) {
+            currentSlot_ = (currentSlot_ + 1) % SLOT_COUNT;
+            slots_[currentSlot_].Reset();
+        }
+        currentSecond_ = second;
+    }
+
+    FrameHistogram slots_[SLOT_COUNT];
+    FrameHistogram total_;
+    int64_t currentSecond_ = -1;
+    uint32_t currentSlot_ = 0;
+};
@@ -0,0 +1,200 @@
+/**
+ * @file HeadlessRun.h
+ * @brief 画面に表示せずにシミュレーションだけを全速で進める実行(ヘッドレス)の設定と計測
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * `--headless` を付けて起動すると、App はウィンドウを表示せず、D3D11 デバイスをソフトウェアラスタライザ(WARP)で作り、
+ * 表示の待ち・描画・Present を飛ばしてフレームごとに決まった数の固定ステップを続けて実行します。
+ * 実時間に合わせないため、World・シーン・システムは CPU が回る限りの速さで進みます
+ * (GPU のないビルドエージェントでの長時間の耐久試験や、ECS のスループットの計測に使う)。
+ *
+ * 完全に描画しないデバイス(ヌルバックエンド)ではなく WARP を使うのは、ResourceManager・ModelLoader・
+ * TextureManager などがシーンの読み込み中に頂点バッファやテクスチャを作るためです。
+ * `--headless-render N` を指定した場合は N フレームに1回だけ WARP で描画します(描画経路の確認用)。
+ *
+ * 規定のフレーム数(または秒数)を進めたら、フレームごとの更新時間・ステップ数・エンティティ数を CSV に書き出して終了します。
+ * 計測中はファイル書き込みを行いません。`--replay-input` と組み合わせると毎回同じシミュレーションを実行できます。
+ *
+ * @par コマンドライン
+ * @code
+ * HEW_GAME.exe --headless [--headless-frames N] [--headless-seconds S] [--headless-steps N]
+ *              [--headless-render N] [--headless-gpu] [--headless-out headless_benchmark.csv]
+ * @endcode
+ */
+#pragma once
+#include "app/CommandLine.h"
+#include "app/DebugLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * @struct HeadlessConfig
+ * @brief ヘッドレス実行の長さと出力先
+ */
+struct HeadlessConfig {
+    int frames = 3600;                                  ///< 進めるフレーム数(0 なら seconds だけで終了)
+    double seconds = 0.0;                               ///< 実時間の上限(秒、0 なら無制限)
+    int stepsPerFrame = 1;                              ///< 1フレームで進める固定ステップ数
+    int renderInterval = 0;                             ///< 描画するフレームの間隔(0 なら描画しない)
+    bool warp = true;                                   ///< WARP でデバイスを作る(`--headless-gpu` でハードウェア)
+    std::string outputPath = "headless_benchmark.csv";  ///< CSV の出力先
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @param[in] cmdLine WinMain の lpCmdLine
+     * @param[out] out 読み取った設定(`--headless` がない場合は変更しない)
+     * @return bool `--headless` が指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, HeadlessConfig& out) {
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+        if (!CommandLine::Has(args, "--headless")) return false;
+
+        HeadlessConfig config;
+        for (size_t i = 0; i < args.size(); ++i) {
+            const std::string& key = args[i];
+            if (key == "--headless-gpu") {
+                config.warp = false;
+                continue;
+            }
+            if (i + 1 >= args.size()) break;
+            const char* value = args[i + 1].c_str();
+            if (key == "--headless-frames") config.frames = (std::max)(0, std::atoi(value));
+            else if (key == "--headless-seconds") config.seconds = (std::max)(0.0, std::atof(value));
+            else if (key == "--headless-steps") config.stepsPerFrame = (std::max)(1, std::atoi(value));
+            else if (key == "--headless-render") config.renderInterval = (std::max)(0, std::atoi(value));
+            else if (key == "--headless-out") config.outputPath = value;
+        }
+        if (config.frames == 0 && config.seconds <= 0.0) {
+            config.frames = HeadlessConfig{}.frames;  // 終わらない実行にはしない
+        }
+        out = config;
+        return true;
+    }
+};
+
+/**
+ * @class HeadlessRun
+ * @brief ヘッドレス実行のフレームごとの記録と終了の判定
+ *
+ * @par 使用例(App のメインループ)
+ * @code
+ * const int steps = headless.Config().stepsPerFrame;   // 実時間ではなく固定の数だけ進める
+ * // ... RunSimulation(steps) ...
+ * if (headless.ShouldRender(frame)) { ... Render / Present ... }
+ * if (headless.Record(updateMs, steps, entityCount)) {
+ *     PostQuitMessage(0);                              // CSV を書き出し済み
+ * }
+ * @endcode
+ */
+class HeadlessRun {
+public:
+    explicit HeadlessRun(const HeadlessConfig& config) : config_(config) {
+        if (config_.frames > 0) rows_.reserve(static_cast<size_t>(config_.frames));
+    }
+
+    const HeadlessConfig& Config() const { return config_; }
+
+    /**
+     * @brief このフレームを描画するか
+     */
+    bool ShouldRender(int frame) const {
+        return config_.renderInterval > 0 && frame % config_.renderInterval == 0;
+    }
+
+    /**
+     * @brief 1フレーム分の結果を記録
+     * @param[in] updateMs シミュレーションの CPU 時間(ミリ秒)
+     * @param[in] steps このフレームで進めた固定ステップ数
+     * @param[in] entities 生存エンティティ数
+     * @return bool 規定のフレーム数・秒数に達して CSV を書き出した場合 true(呼び出し側で終了する)
+     */
+    bool Record(float updateMs, int steps, size_t entities) {
+        if (finished_) return true;
+        const auto now = std::chrono::steady_clock::now();
+        if (rows_.empty()) start_ = now;
+
+        Row row;
+        row.frame = static_cast<int>(rows_.size());
+        row.updateMs = updateMs;
+        row.steps = steps;
+        row.entities = entities;
+        rows_.push_back(row);
+        totalSteps_ += static_cast<uint64_t>(steps);
+        entitySteps_ += static_cast<double>(entities) * steps;
+
+        elapsed_ = std::chrono::duration<double>(now - start_).count();
+        const bool framesDone = config_.frames > 0 && static_cast<int>(rows_.size()) >= config_.frames;
+        const bool timeDone = config_.seconds > 0.0 && elapsed_ >= config_.seconds;
+        if (!framesDone && !timeDone) return false;
+
+        finished_ = true;
+        WriteCsv();
+        LogSummary();
+        return true;
+    }
+
+    bool IsFinished() const { return finished_; }
+
+private:
+    struct Row {
+        int frame = 0;
+        float updateMs = 0.0f;
+        int steps = 0;
+        size_t entities = 0;
+    };
+
+    void WriteCsv() const {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, config_.outputPath.c_str(), "w") != 0 || !fp) {
+            DEBUGLOG_ERROR("[Headless] " + config_.outputPath + " を開けません");
+            return;
+        }
+        std::fprintf(fp, "frame,update_ms,steps,entities\n");
+        for (const Row& r : rows_) {
+            std::fprintf(fp, "%d,%.4f,%d,%zu\n", r.frame, r.updateMs, r.steps, r.entities);
+        }
+        std::fclose(fp);
+    }
+
+    /**
+     * @brief スループットと更新時間の百分位をログ出力
+     */
+    void LogSummary() const {
+        std::vector<float> update;
+        update.reserve(rows_.size());
+        for (const Row& r : rows_) update.push_back(r.updateMs);
+        auto percentile = [&update](float p) {
+            if (update.empty()) return 0.0f;
+            size_t index = static_cast<size_t>(p * static_cast<float>(update.size() - 1));
+            std::nth_element(update.begin(), update.begin() + index, update.end());
+            return update[index];
+        };
+
+        const double seconds = elapsed_ > 0.0 ? elapsed_ : 1e-9;
+        char line[320];
+        sprintf_s(line, "[Headless] %zu フレーム / %.2f 秒: %.1f フレーム/秒, %.1f ステップ/秒, %.3g エンティティ・ステップ/秒, "
+                        "更新 p50 %.3fms p99 %.3fms",
+                  rows_.size(), elapsed_, static_cast<double>(rows_.size()) / seconds,
+                  static_cast<double>(totalSteps_) / seconds, entitySteps_ / seconds,
+                  percentile(0.5f), percentile(0.99f));
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, line);
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[Headless] 結果を " + config_.outputPath + " に書き出しました");
+    }
+
+    HeadlessConfig config_;
+    std::vector<Row> rows_;                          ///< 記録したフレーム(終了時にまとめて書き出す)
+    std::chrono::steady_clock::time_point start_;    ///< 最初に記録した時刻
+    double elapsed_ = 0.0;                           ///< 最初の記録からの経過時間(秒)
+    uint64_t totalSteps_ = 0;
+    double entitySteps_ = 0.0;                       ///< エンティティ数 × ステップ数の合計
+    bool finished_ = false;
+};
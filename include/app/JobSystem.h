@@ -0,0 +1,342 @@
+#pragma once
+#include "app/DebugLog.h"
+#include "app/FrameArena.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <string>
+#include <algorithm>
+
+/**
+ * @file JobSystem.h
+ * @brief ワークスティーリング方式のジョブシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ハードウェアスレッド数に合わせたワーカースレッドを起動し、ジョブを並列実行します。
+ * 各ワーカーは自分のキューの末尾から取り出し、空になると他のワーカーのキューの
+ * 先頭から盗みます(ワークスティーリング)。
+ */
+
+/**
+ * @class JobSystem
+ * @brief 並列ジョブ実行システム
+ *
+ * @details
+ * ### 主な機能:
+ * - Submit(): ジョブを投入(JobCounterで完了待ち可能)
+ * - Wait(): 完了待ち。待機中も呼び出しスレッドがジョブを実行するため、デッドロックしません
+ * - ParallelFor(): 範囲を grainSize 単位に分割して並列実行
+ *
+ * @par 使用例
+ * @code
+ * JobSystem jobs;
+ * jobs.Init();
+ *
+ * jobs.ParallelFor(positions.size(), 256, [&](size_t begin, size_t end) {
+ *     for (size_t i = begin; i < end; ++i) {
+ *         positions[i].x += velocities[i].x * dt;
+ *     }
+ * });
+ *
+ * jobs.Shutdown();
+ * @endcode
+ *
+ * @note ジョブ内で例外が発生した場合はログに記録し、ワーカーは継続します
+ * @author 山内陽
+ */
+class JobSystem {
+public:
+    /**
+     * @struct JobCounter
+     * @brief 未完了ジョブ数のカウンタ(完了待ち用)
+     */
+    struct JobCounter {
+        std::atomic<uint32_t> pending{ 0 }; ///< 未完了ジョブ数
+
+        bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    JobSystem() = default;
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem() { Shutdown(); }
+
+    /**
+     * @brief ワーカースレッドを起動
+     * @param[in] workerCount ワーカー数(0でハードウェアスレッド数-1)
+     * @param[in] onWorkerStart 各ワーカーの起動直後にそのスレッドで呼ぶ関数(アフィニティ・優先度の設定用、省略可)
+     * @return bool 初期化が成功した場合は true
+     *
+     * @see ThreadPlacement
+     */
+    bool Init(uint32_t workerCount = 0, std::function<void(uint32_t worker)> onWorkerStart = nullptr) {
+        if (running_) {
+            DEBUGLOG_WARNING("JobSystem::Init() - 既に初期化されています");
+            return true;
+        }
+
+        if (workerCount == 0) {
+            uint32_t hw = std::thread::hardware_concurrency();
+            workerCount = hw > 1 ? hw - 1 : 1; // メインスレッド分を残す
+        }
+
+        // ワーカー用キュー + 外部スレッド(メインスレッド等)用キュー
+        queues_.clear();
+        for (uint32_t i = 0; i < workerCount + 1; ++i) {
+            queues_.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+        }
+
+        onWorkerStart_ = std::move(onWorkerStart);
+        running_ = true;
+        queuedJobs_ = 0;
+        try {
+            for (uint32_t i = 0; i < workerCount; ++i) {
+                threads_.emplace_back(&JobSystem::workerLoop, this, i);
+            }
+        } catch (const std::exception& ex) {
+            DEBUGLOG_ERROR(std::string("JobSystem::Init() - ワーカースレッドの起動に失敗: ") + ex.what());
+            Shutdown();
+            return false;
+        }
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "JobSystem::Init() 完了 (ワーカー数: " + std::to_string(workerCount) + ")");
+        return true;
+    }
+
+    /**
+     * @brief ワーカースレッドを停止(冪等)
+     *
+     * @details
+     * キューに残ったジョブは呼び出しスレッドで実行してから停止します。
+     */
+    void Shutdown() {
+        if (!running_ && threads_.empty()) return;
+
+        // 残っているジョブを消化
+        uint32_t external = externalQueueIndex();
+        while (!queues_.empty() && tryRunOne(external)) {}
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            running_ = false;
+        }
+        wakeCv_.notify_all();
+
+        for (auto& t : threads_) {
+            if (t.joinable()) t.join();
+        }
+        threads_.clear();
+        queues_.clear();
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "JobSystem::Shutdown() 完了");
+    }
+
+    /**
+     * @brief ジョブを投入
+     * @param[in] job 実行する関数
+     * @param[in] counter 完了待ち用カウンタ(省略可)
+     *
+     * @details
+     * 未初期化の場合は呼び出しスレッドで即時実行します。
+     */
+    void Submit(std::function<void()> job, JobCounter* counter = nullptr) {
+        if (!running_ || queues_.empty()) {
+            runJob(Job{ std::move(job), nullptr });
+            return;
+        }
+
+        if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t index = currentQueueIndex();
+        queuedJobs_.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->jobs.push_back(Job{ std::move(job), counter });
+        }
+        {
+            // 待機判定と通知の間での取りこぼしを防ぐ
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        wakeCv_.notify_one();
+    }
+
+    /**
+     * @brief カウンタが0になるまで待機
+     * @param[in] counter 待機対象
+     *
+     * @details
+     * 待機中も呼び出しスレッドがキューのジョブを実行します。
+     */
+    void Wait(JobCounter& counter) {
+        uint32_t index = currentQueueIndex();
+        while (!counter.IsDone()) {
+            if (!tryRunOne(index)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief 範囲を分割して並列実行
+     * @param[in] count 要素数
+     * @param[in] grainSize 1ジョブあたりの要素数(0は256扱い)
+     * @param[in] fn void(size_t begin, size_t end) 形式の関数
+     *
+     * @details
+     * 先頭の分割は呼び出しスレッドで実行し、残りをワーカーに投入します。
+     * 全分割の完了を待ってから戻ります。
+     * ワーカー側で発生した例外はログに記録され、呼び出し元には伝播しません。
+     */
+    template<class F>
+    void ParallelFor(size_t count, size_t grainSize, F&& fn) {
+        if (count == 0) return;
+        if (grainSize == 0) grainSize = 256;
+
+        if (!running_ || count <= grainSize) {
+            fn(static_cast<size_t>(0), count);
+            return;
+        }
+
+        JobCounter counter;
+        for (size_t begin = grainSize; begin < count; begin += grainSize) {
+            size_t end = (std::min)(begin + grainSize, count);
+            Submit([&fn, begin, end]() { fn(begin, end); }, &counter);
+        }
+
+        // 投入済みジョブがcounterを参照しているため、例外時も完了を待ってから再送出する
+        try {
+            fn(static_cast<size_t>(0), grainSize);
+        } catch (...) {
+            Wait(counter);
+            throw;
+        }
+        Wait(counter);
+    }
+
+    /**
+     * @brief ワーカースレッド数(呼び出しスレッドを除く)
+     */
+    uint32_t WorkerCount() const { return static_cast<uint32_t>(threads_.size()); }
+
+    bool IsRunning() const { return running_; }
+
+    /**
+     * @brief 現在のスレッドがワーカースレッドかどうか
+     */
+    static bool IsWorkerThread() { return workerIndex() >= 0; }
+
+    /**
+     * @brief 現在のスレッドのワーカー番号
+     * @return int 0..WorkerCount()-1、ワーカー以外のスレッドでは -1
+     */
+    static int CurrentWorkerIndex() { return workerIndex(); }
+
+private:
+    struct Job {
+        std::function<void()> fn; ///< ジョブ本体
+        JobCounter* counter;      ///< 完了通知先(nullptr可)
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;      ///< キュー保護
+        std::deque<Job> jobs;  ///< 所有スレッドは末尾、盗む側は先頭から取り出す
+    };
+
+    static int& workerIndex() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    uint32_t externalQueueIndex() const {
+        return queues_.empty() ? 0 : static_cast<uint32_t>(queues_.size() - 1);
+    }
+
+    uint32_t currentQueueIndex() const {
+        int index = workerIndex();
+        return index >= 0 ? static_cast<uint32_t>(index) : externalQueueIndex();
+    }
+
+    bool popLocal(uint32_t index, Job& out) {
+        WorkQueue& q = *queues_[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.empty()) return false;
+        out = std::move(q.jobs.back());
+        q.jobs.pop_back();
+        return true;
+    }
+
+    bool steal(uint32_t thief, Job& out) {
+        const uint32_t n = static_cast<uint32_t>(queues_.size());
+        for (uint32_t offset = 1; offset < n; ++offset) {
+            WorkQueue& q = *queues_[(thief + offset) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.jobs.empty()) continue;
+            out = std::move(q.jobs.front());
+            q.jobs.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    bool tryRunOne(uint32_t index) {
+        Job job;
+        if (!popLocal(index, job) && !steal(index, job)) {
+            return false;
+        }
+        queuedJobs_.fetch_sub(1, std::memory_order_acq_rel);
+        runJob(std::move(job));
+        return true;
+    }
+
+    void runJob(Job job) {
+        try {
+            if (job.fn) job.fn();
+        } catch (const std::exception& ex) {
+            DEBUGLOG_ERROR(std::string("JobSystem - ジョブ実行中に例外発生: ") + ex.what());
+        } catch (...) {
+            DEBUGLOG_ERROR("JobSystem - ジョブ実行中に不明な例外発生");
+        }
+        if (job.counter) {
+            job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void workerLoop(uint32_t index) {
+        workerIndex() = static_cast<int>(index);
+        if (onWorkerStart_) onWorkerStart_(index);
+        while (true) {
+            if (tryRunOne(index)) {
+                // ジョブ1件がワーカーのフレーム(Wait() 中に横取りしたジョブは呼び出し元の区切りでリセット)
+                FrameArena::ForThread().Reset();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wakeCv_.wait(lock, [this]() {
+                return !running_ || queuedJobs_.load(std::memory_order_acquire) > 0;
+            });
+            if (!running_ && queuedJobs_.load(std::memory_order_acquire) == 0) break;
+        }
+        workerIndex() = -1;
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_; ///< [0..N-1]: ワーカー, [N]: 外部スレッド
+    std::vector<std::thread> threads_;               ///< ワーカースレッド
+    std::function<void(uint32_t)> onWorkerStart_;    ///< ワーカーの起動時に呼ぶ関数
+    std::atomic<bool> running_{ false };             ///< 稼働中フラグ
+    std::atomic<int> queuedJobs_{ 0 };               ///< 全キューの未取得ジョブ数
+    std::mutex sleepMutex_;                          ///< 待機用
+    std::condition_variable wakeCv_;                 ///< ジョブ投入通知
+};
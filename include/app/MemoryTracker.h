@@ -0,0 +1,264 @@
+/**
+ * @file MemoryTracker.h
+ * @brief サブシステムごとのメモリ使用量(CPU・GPU)の集計と予算の監視
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 使用量はタグ(ECS / Render / Textures / Models / Logging)ごとに、CPU とGPU(D3D11 リソース)の
+ * 2系統で数えます。値の入れ方は2通りです。
+ * - 加算: TrackedAllocator / TrackedVector や Add() / Remove() で確保・解放のたびに増減
+ *   (どのスレッドからでも可、アトミック操作のみ)
+ * - 報告: Report() で所有者が数えた現在量を設定(テクスチャやモデルのバッファなど、
+ *   ComPtr の解放で暗黙に消えるものは App が定期的に数え直す)
+ *
+ * 現在量は両者の合計で、最大値(ピーク)も記録します。SetBudget() で予算(CPU + GPU)を設定すると、
+ * CheckBudgets() が超えたときに一度だけ警告を出します(予算内に戻ると再び警告します)。
+ */
+#pragma once
+#include "app/DebugLog.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * @enum MemoryTag
+ * @brief メモリ使用量を集計するサブシステム
+ */
+enum class MemoryTag : uint8_t {
+    ECS = 0,   ///< World のコンポーネントストア
+    Render,    ///< RenderSystem・DebugDraw のバッファと作業用配列
+    Textures,  ///< TextureManager のテクスチャ
+    Models,    ///< ResourceManager のモデルキャッシュ
+    Logging,   ///< DebugLog のリングバッファ
+    Count
+};
+
+/**
+ * @enum MemoryKind
+ * @brief メモリの種類
+ */
+enum class MemoryKind : uint8_t {
+    Cpu = 0,   ///< CPU ヒープ
+    Gpu,       ///< D3D11 リソース
+    Count
+};
+
+/**
+ * @class MemoryTracker
+ * @brief タグごとのメモリ使用量と予算
+ *
+ * @par 使用例
+ * @code
+ * MemoryTracker& mem = MemoryTracker::GetInstance();
+ * mem.SetBudget(MemoryTag::Textures, 512ull * 1024 * 1024);
+ *
+ * // 定期的に(メインスレッド)
+ * mem.Report(MemoryTag::Textures, MemoryKind::Gpu, texManager.GpuMemoryBytes());
+ * mem.CheckBudgets();
+ * @endcode
+ */
+class MemoryTracker {
+public:
+    static constexpr size_t TAG_COUNT = static_cast<size_t>(MemoryTag::Count);
+    static constexpr size_t KIND_COUNT = static_cast<size_t>(MemoryKind::Count);
+
+    static MemoryTracker& GetInstance() {
+        static MemoryTracker instance;
+        return instance;
+    }
+
+    static const char* TagName(MemoryTag tag) {
+        static const char* const names[TAG_COUNT] = { "ECS", "Render", "Textures", "Models", "Logging" };
+        return names[static_cast<size_t>(tag)];
+    }
+
+    /**
+     * @brief 確保した量を加算
+     */
+    void Add(MemoryTag tag, MemoryKind kind, size_t bytes) {
+        Counter& c = counter(tag, kind);
+        c.tracked.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        updatePeak(c);
+    }
+
+    /**
+     * @brief 解放した量を減算
+     */
+    void Remove(MemoryTag tag, MemoryKind kind, size_t bytes) {
+        counter(tag, kind).tracked.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 所有者が数えた現在量を設定(前回の報告を置き換える)
+     */
+    void Report(MemoryTag tag, MemoryKind kind, size_t bytes) {
+        Counter& c = counter(tag, kind);
+        c.reported.store(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        updatePeak(c);
+    }
+
+    /**
+     * @brief 現在量(バイト)
+     */
+    size_t Live(MemoryTag tag, MemoryKind kind) const {
+        const Counter& c = counter(tag, kind);
+        int64_t live = c.tracked.load(std::memory_order_relaxed) + c.reported.load(std::memory_order_relaxed);
+        return live > 0 ? static_cast<size_t>(live) : 0;
+    }
+
+    /**
+     * @brief 最大値(バイト)
+     */
+    size_t Peak(MemoryTag tag, MemoryKind kind) const {
+        int64_t peak = counter(tag, kind).peak.load(std::memory_order_relaxed);
+        return peak > 0 ? static_cast<size_t>(peak) : 0;
+    }
+
+    /**
+     * @brief CPU と GPU の現在量の合計(バイト)
+     */
+    size_t Live(MemoryTag tag) const { return Live(tag, MemoryKind::Cpu) + Live(tag, MemoryKind::Gpu); }
+
+    /**
+     * @brief 予算(CPU + GPU、バイト)を設定(0 で監視しない)
+     */
+    void SetBudget(MemoryTag tag, size_t bytes) {
+        budgets_[static_cast<size_t>(tag)].store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t Budget(MemoryTag tag) const { return budgets_[static_cast<size_t>(tag)].load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 予算を超えたタグを警告(超えた時点で1回)
+     * @return bool 予算を超えているタグがある場合 true
+     */
+    bool CheckBudgets() {
+        bool over = false;
+        for (size_t i = 0; i < TAG_COUNT; ++i) {
+            const MemoryTag tag = static_cast<MemoryTag>(i);
+            const size_t budget = Budget(tag);
+            const bool exceeded = budget > 0 && Live(tag) > budget;
+            if (exceeded && !overBudget_[i]) {
+                DEBUGLOG_WARNING(std::string("[MemoryTracker] ") + TagName(tag) + " が予算を超えました: " +
+                                 FormatBytes(Live(tag)) + " / " + FormatBytes(budget) +
+                                 " (CPU " + FormatBytes(Live(tag, MemoryKind::Cpu)) + ", GPU " + FormatBytes(Live(tag, MemoryKind::Gpu)) + ")");
+            }
+            overBudget_[i] = exceeded;
+            over = over || exceeded;
+        }
+        return over;
+    }
+
+    /**
+     * @brief 全タグの現在量・最大値・予算をログ出力
+     */
+    void LogSummary() const {
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "メモリ使用量 (現在 / 最大):");
+        for (size_t i = 0; i < TAG_COUNT; ++i) {
+            const MemoryTag tag = static_cast<MemoryTag>(i);
+            std::string line = std::string("  ") + TagName(tag) +
+                ": CPU " + FormatBytes(Live(tag, MemoryKind::Cpu)) + " / " + FormatBytes(Peak(tag, MemoryKind::Cpu)) +
+                ", GPU " + FormatBytes(Live(tag, MemoryKind::Gpu)) + " / " + FormatBytes(Peak(tag, MemoryKind::Gpu));
+            if (Budget(tag) > 0) line += ", 予算 " + FormatBytes(Budget(tag));
+            DEBUGLOG_CATEGORY(DebugLog::Category::System, line);
+        }
+    }
+
+    /**
+     * @brief バイト数を B / KB / MB 表記に変換
+     */
+    static std::string FormatBytes(size_t bytes) {
+        char buf[32];
+        if (bytes >= 1024 * 1024) {
+            snprintf(buf, sizeof(buf), "%.1fMB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+        } else if (bytes >= 1024) {
+            snprintf(buf, sizeof(buf), "%.1fKB", static_cast<double>(bytes) / 1024.0);
+        } else {
+            snprintf(buf, sizeof(buf), "%zuB", bytes);
+        }
+        return buf;
+    }
+
+private:
+    struct Counter {
+        std::atomic<int64_t> tracked{ 0 };  ///< Add() / Remove() の累計
+        std::atomic<int64_t> reported{ 0 }; ///< 最後に Report() した値
+        std::atomic<int64_t> peak{ 0 };     ///< tracked + reported の最大値
+    };
+
+    MemoryTracker() {
+        for (size_t i = 0; i < TAG_COUNT; ++i) {
+            budgets_[i].store(0, std::memory_order_relaxed);
+            overBudget_[i] = false;
+        }
+    }
+
+    Counter& counter(MemoryTag tag, MemoryKind kind) {
+        return counters_[static_cast<size_t>(tag)][static_cast<size_t>(kind)];
+    }
+    const Counter& counter(MemoryTag tag, MemoryKind kind) const {
+        return counters_[static_cast<size_t>(tag)][static_cast<size_t>(kind)];
+    }
+
+    static void updatePeak(Counter& c) {
+        int64_t live = c.tracked.load(std::memory_order_relaxed) + c.reported.load(std::memory_order_relaxed);
+        int64_t prev = c.peak.load(std::memory_order_relaxed);
+        while (live > prev && !c.peak.compare_exchange_weak(prev, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    Counter counters_[TAG_COUNT][KIND_COUNT];
+    std::atomic<size_t> budgets_[TAG_COUNT];
+    bool overBudget_[TAG_COUNT];  ///< 前回の CheckBudgets() で超えていたか(メインスレッドのみ)
+};
+
+/**
+ * @class TrackedAllocator
+ * @brief 確保量を MemoryTracker の CPU 使用量に加算する標準アロケータ
+ *
+ * @tparam T 要素の型
+ * @tparam Tag 集計先のタグ
+ */
+template<class T, MemoryTag Tag>
+class TrackedAllocator {
+public:
+    using value_type = T;
+
+    template<class U>
+    struct rebind {
+        using other = TrackedAllocator<U, Tag>;
+    };
+
+    TrackedAllocator() noexcept = default;
+    template<class U>
+    TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        T* p = std::allocator<T>().allocate(n);
+        MemoryTracker::GetInstance().Add(Tag, MemoryKind::Cpu, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        MemoryTracker::GetInstance().Remove(Tag, MemoryKind::Cpu, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<class U>
+    bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+    template<class U>
+    bool operator!=(const TrackedAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+/**
+ * @brief 確保量を集計する std::vector
+ */
+template<class T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
@@ -0,0 +1,286 @@
+/**
+ * @file ParallelAlgorithms.h
+ * @brief JobSystem の上に作った並列の集約・ソート・プレフィックス和・圧縮・散布
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * システムごとにスレッドの分担を書かずに済むよう、よく使う並列処理をまとめます。
+ * どの関数も JobSystem が nullptr・未起動、または要素数が1チャンクに収まる場合は呼び出しスレッドで逐次に実行します。
+ *
+ * - **粒度**: grain(1チャンクの要素数)に 0 を渡すと AutoGrain() で決めます。
+ *   チャンク数がスレッド数 × CHUNKS_PER_THREAD 程度になり、1チャンクは MIN_GRAIN 以上になります。
+ * - **決定性**: Reduce() はチャンクの結果をチャンク順に結合するため、浮動小数点でもスレッド数が同じなら結果が変わりません。
+ *   ExclusiveScan() / Compact() も入力順を保ちます。
+ * - **プロファイラ**: 各関数は呼び出しスレッドに "parallel::名前"、チャンクごとに "parallel::名前.Chunk" の
+ *   ゾーンを記録します(PROFILE_SCOPE が有効なビルドのみ)。
+ * - **一時メモリ**: チャンクの結果とソートの作業領域は呼び出しスレッドの FrameArena から取ります。
+ *
+ * 関数はすべて完了を待ってから戻ります。ワーカーの例外は JobSystem::ParallelFor() と同じくログに記録され、
+ * 呼び出し元には伝わりません。
+ *
+ * @par 使用例
+ * @code
+ * // 境界の合計(集約)
+ * Bounds all = parallel::Reduce(jobs, n, 0, Bounds{}, [&](size_t begin, size_t end) {
+ *     Bounds b;
+ *     for (size_t i = begin; i < end; ++i) b.Grow(points[i]);
+ *     return b;
+ * }, [](Bounds a, const Bounds& b) { a.Grow(b); return a; });
+ *
+ * // 可視のものだけを順番を保って詰める(圧縮)
+ * size_t visible = parallel::Compact(jobs, n, 0,
+ *     [&](size_t i) { return cull.Visible(i); },
+ *     [&](size_t i, size_t dst) { out[dst] = items[i]; });
+ *
+ * // ソートキーの並べ替え
+ * parallel::Sort(jobs, keys.data(), keys.size());
+ * @endcode
+ */
+#pragma once
+#include "app/JobSystem.h"
+#include "app/FrameArena.h"
+#include "app/Profiler.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace parallel {
+
+static constexpr size_t CHUNKS_PER_THREAD = 4;     ///< AutoGrain() がスレッドあたりに作るチャンク数(偏りの吸収)
+static constexpr size_t MIN_GRAIN = 1024;          ///< AutoGrain() の1チャンクの最小要素数
+static constexpr size_t SORT_MIN_GRAIN = 4096;     ///< Sort() の1チャンクの最小要素数(これ未満の全体は std::sort)
+
+/**
+ * @brief 並列に実行できるか(JobSystem が起動していてワーカーがいる)
+ */
+inline bool CanRun(const JobSystem* jobs) {
+    return jobs && jobs->IsRunning() && jobs->WorkerCount() > 0;
+}
+
+/**
+ * @brief 要素数とスレッド数から1チャンクの要素数を決める
+ * @param[in] jobs ジョブシステム(nullptr可)
+ * @param[in] count 要素数
+ * @param[in] minGrain 1チャンクの最小要素数(チャンクの投入より処理が軽くならないように)
+ */
+inline size_t AutoGrain(const JobSystem* jobs, size_t count, size_t minGrain = MIN_GRAIN) {
+    const size_t threads = CanRun(jobs) ? static_cast<size_t>(jobs->WorkerCount()) + 1 : 1;
+    const size_t chunks = threads * CHUNKS_PER_THREAD;
+    return (std::max)((count + chunks - 1) / chunks, (std::max<size_t>)(minGrain, 1));
+}
+
+/**
+ * @brief [0, count) をチャンクに分けて fn(chunk, begin, end) を並列に呼ぶ
+ * @param[in] jobs ジョブシステム(nullptr可)
+ * @param[in] count 要素数
+ * @param[in] grain 1チャンクの要素数(0 は AutoGrain())
+ * @param[in] fn void(size_t chunk, size_t begin, size_t end)
+ * @param[in] zone チャンクごとのプロファイラのゾーン名
+ * @return size_t チャンク数
+ */
+template<class F>
+size_t ForChunks(JobSystem* jobs, size_t count, size_t grain, F&& fn, const char* zone = "parallel::For.Chunk") {
+    if (count == 0) return 0;
+    if (grain == 0) grain = AutoGrain(jobs, count);
+    const size_t chunks = (count + grain - 1) / grain;
+    (void)zone;
+    if (chunks == 1 || !CanRun(jobs)) {
+        for (size_t c = 0; c < chunks; ++c) {
+            PROFILE_SCOPE(zone);
+            fn(c, c * grain, (std::min)(count, (c + 1) * grain));
+        }
+        return chunks;
+    }
+    jobs->ParallelFor(chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            PROFILE_SCOPE(zone);
+            fn(c, c * grain, (std::min)(count, (c + 1) * grain));
+        }
+    });
+    return chunks;
+}
+
+/**
+ * @brief [0, count) を並列に処理(JobSystem::ParallelFor() に粒度の自動決定と逐次の代替を足したもの)
+ * @param[in] fn void(size_t begin, size_t end)
+ */
+template<class F>
+void For(JobSystem* jobs, size_t count, size_t grain, F&& fn) {
+    PROFILE_SCOPE("parallel::For");
+    ForChunks(jobs, count, grain, [&fn](size_t, size_t begin, size_t end) { fn(begin, end); });
+}
+
+/**
+ * @brief 並列の集約(境界・統計など)
+ * @param[in] identity 単位元(空のチャンクの結果・結合の初期値)
+ * @param[in] map T(size_t begin, size_t end): チャンクの結果
+ * @param[in] combine T(T accumulated, const T& chunk): 結合(結合法則を満たすこと。順番はチャンク順)
+ * @return T 全体の結果(count が 0 なら identity)
+ */
+template<class T, class Map, class Combine>
+T Reduce(JobSystem* jobs, size_t count, size_t grain, T identity, Map&& map, Combine&& combine) {
+    PROFILE_SCOPE("parallel::Reduce");
+    if (count == 0) return identity;
+    if (grain == 0) grain = AutoGrain(jobs, count);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || !CanRun(jobs)) return combine(std::move(identity), map(static_cast<size_t>(0), count));
+
+    std::pmr::vector<T> partial(chunks, identity, &FrameArena::ForThread());
+    ForChunks(jobs, count, grain, [&](size_t c, size_t begin, size_t end) {
+        partial[c] = map(begin, end);
+    }, "parallel::Reduce.Chunk");
+
+    T result = std::move(identity);
+    for (const T& p : partial) result = combine(std::move(result), p);
+    return result;
+}
+
+/**
+ * @brief 並列の排他的プレフィックス和 out[i] = init op in[0] op ... op in[i - 1]
+ * @param[in] in 入力(out と同じでもよい)
+ * @param[out] out 出力
+ * @param[in] init 初期値(out[0])
+ * @param[in] op 結合法則を満たす二項演算
+ * @return T 全体の合計(init op in[0] op ... op in[count - 1])
+ *
+ * @details
+ * チャンクごとの合計(1回目)、合計の逐次のプレフィックス和、チャンクごとの書き込み(2回目)の3段です。
+ */
+template<class T, class Op = std::plus<T>>
+T ExclusiveScan(JobSystem* jobs, const T* in, T* out, size_t count, size_t grain = 0, T init = T{}, Op op = Op{}) {
+    PROFILE_SCOPE("parallel::ExclusiveScan");
+    auto scanRange = [&](size_t begin, size_t end, T acc) {
+        for (size_t i = begin; i < end; ++i) {
+            T v = in[i];
+            out[i] = acc;
+            acc = op(acc, v);
+        }
+        return acc;
+    };
+    if (count == 0) return init;
+    if (grain == 0) grain = AutoGrain(jobs, count);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || !CanRun(jobs)) return scanRange(0, count, init);
+
+    std::pmr::vector<T> offsets(chunks + 1, init, &FrameArena::ForThread());
+    ForChunks(jobs, count, grain, [&](size_t c, size_t begin, size_t end) {
+        T sum = in[begin];
+        for (size_t i = begin + 1; i < end; ++i) sum = op(sum, in[i]);
+        offsets[c + 1] = sum;
+    }, "parallel::ExclusiveScan.Chunk");
+    for (size_t c = 0; c < chunks; ++c) offsets[c + 1] = op(offsets[c], offsets[c + 1]);
+    ForChunks(jobs, count, grain, [&](size_t c, size_t begin, size_t end) {
+        scanRange(begin, end, offsets[c]);
+    }, "parallel::ExclusiveScan.Chunk");
+    return offsets[chunks];
+}
+
+/**
+ * @brief 条件を満たす要素を順番を保って詰める(カリングの出力など)
+ * @param[in] keep bool(size_t i): 残すか(2回呼ばれるため、副作用がなく軽いこと)
+ * @param[in] emit void(size_t i, size_t dst): 残す i を出力の dst 番目へ書く(dst は重複しない)
+ * @return size_t 残した数
+ *
+ * @details
+ * チャンクごとの数を数え、そのプレフィックス和を書き込み先の先頭にします。
+ * 入力と出力が同じ配列だとチャンクの書き込みが他のチャンクの未読の要素を上書きするため、別の配列へ書いてください。
+ */
+template<class Keep, class Emit>
+size_t Compact(JobSystem* jobs, size_t count, size_t grain, Keep&& keep, Emit&& emit) {
+    PROFILE_SCOPE("parallel::Compact");
+    if (count == 0) return 0;
+    if (grain == 0) grain = AutoGrain(jobs, count);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || !CanRun(jobs)) {
+        size_t dst = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (keep(i)) emit(i, dst++);
+        }
+        return dst;
+    }
+
+    std::pmr::vector<size_t> offsets(chunks + 1, 0, &FrameArena::ForThread());
+    ForChunks(jobs, count, grain, [&](size_t c, size_t begin, size_t end) {
+        size_t n = 0;
+        for (size_t i = begin; i < end; ++i) n += keep(i) ? 1 : 0;
+        offsets[c + 1] = n;
+    }, "parallel::Compact.Chunk");
+    for (size_t c = 0; c < chunks; ++c) offsets[c + 1] += offsets[c];
+    ForChunks(jobs, count, grain, [&](size_t c, size_t begin, size_t end) {
+        size_t dst = offsets[c];
+        for (size_t i = begin; i < end; ++i) {
+            if (keep(i)) emit(i, dst++);
+        }
+    }, "parallel::Compact.Chunk");
+    return offsets[chunks];
+}
+
+/**
+ * @brief 並列の散布 dst[index[i]] = src[i]
+ * @param[in] index 書き込み先(重複しないこと。重複すると結果が決まらない)
+ */
+template<class T, class Index>
+void Scatter(JobSystem* jobs, const T* src, const Index* index, T* dst, size_t count, size_t grain = 0) {
+    PROFILE_SCOPE("parallel::Scatter");
+    ForChunks(jobs, count, grain, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) dst[static_cast<size_t>(index[i])] = src[i];
+    }, "parallel::Scatter.Chunk");
+}
+
+/**
+ * @brief 並列のソート(チャンクごとの std::sort と、2つずつの並列なマージ)
+ * @param[in,out] data 並べ替える配列
+ * @param[in] comp 比較(std::sort と同じ要件)
+ * @param[in] grain 1チャンクの要素数(0 は AutoGrain(jobs, count, SORT_MIN_GRAIN))
+ *
+ * @details
+ * 安定ではありません(等しい要素の順番は決まらない)。順番を決めたい場合はキーに元の位置を含めてください。
+ * T はデフォルト構築とムーブ代入ができること(作業領域に要素数分を確保します)。
+ */
+template<class T, class Compare = std::less<T>>
+void Sort(JobSystem* jobs, T* data, size_t count, Compare comp = Compare{}, size_t grain = 0) {
+    PROFILE_SCOPE("parallel::Sort");
+    if (grain == 0) grain = AutoGrain(jobs, count, SORT_MIN_GRAIN);
+    const size_t chunks = grain > 0 ? (count + grain - 1) / grain : 0;
+    if (chunks <= 1 || !CanRun(jobs)) {
+        std::sort(data, data + count, comp);
+        return;
+    }
+
+    ForChunks(jobs, count, grain, [&](size_t, size_t begin, size_t end) {
+        std::sort(data + begin, data + end, comp);
+    }, "parallel::Sort.Chunk");
+
+    // 幅 width の整列済みの区間を2つずつマージし、data と作業領域を交互に使う
+    std::pmr::vector<T> buffer(count, &FrameArena::ForThread());
+    T* from = data;
+    T* to = buffer.data();
+    for (size_t width = grain; width < count; width *= 2) {
+        const size_t pairs = (count + 2 * width - 1) / (2 * width);
+        jobs->ParallelFor(pairs, 1, [&](size_t first, size_t last) {
+            for (size_t p = first; p < last; ++p) {
+                PROFILE_SCOPE("parallel::Sort.Merge");
+                const size_t begin = p * 2 * width;
+                const size_t mid = (std::min)(begin + width, count);
+                const size_t end = (std::min)(begin + 2 * width, count);
+                std::merge(std::make_move_iterator(from + begin), std::make_move_iterator(from + mid),
+                           std::make_move_iterator(from + mid), std::make_move_iterator(from + end),
+                           to + begin, comp);
+            }
+        });
+        std::swap(from, to);
+    }
+    if (from != data) {
+        ForChunks(jobs, count, grain, [&](size_t, size_t begin, size_t end) {
+            std::move(from + begin, from + end, data + begin);
+        }, "parallel::Sort.Chunk");
+    }
+}
+
+} // namespace parallel
@@ -0,0 +1,223 @@
+/**
+ * @file Profiler.h
+ * @brief スコープ単位のCPUプロファイラ(Chrome トレース形式で書き出し)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * PROFILE_SCOPE("名前") を置いたスコープの開始・終了時刻を、スレッドごとのリングバッファに記録します。
+ * 記録はそのスレッドだけが書き込むため、ロックもアトミックな読み書き以外の同期も必要ありません。
+ * ExportChromeTrace() は各スレッドの直近のイベントを about:tracing / Perfetto で読める JSON に書き出します。
+ *
+ * PROFILE_SCOPE はデバッグビルド(または ENABLE_PROFILER を定義した場合)だけ有効で、
+ * さらに Profiler::SetEnabled(true) の間だけ時刻を記録します。
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "app/DebugLog.h"
+
+#if defined(_DEBUG) && !defined(ENABLE_PROFILER)
+#define ENABLE_PROFILER
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_PROFILER
+/// スコープの終わりまでを1つのゾーンとして記録(name は記録を書き出すまで有効な文字列)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+/**
+ * @class Profiler
+ * @brief スレッドごとのゾーン記録と Chrome トレースの書き出し
+ *
+ * @par 使用例
+ * @code
+ * Profiler::GetInstance().SetEnabled(true);
+ * {
+ *     PROFILE_SCOPE("Physics");
+ *     // 計測したい処理...
+ * }
+ * Profiler::GetInstance().ExportChromeTrace("profile_trace.json");
+ * @endcode
+ */
+class Profiler {
+public:
+    static constexpr uint32_t EVENTS_PER_THREAD = 1u << 16; ///< スレッドごとのリングバッファの容量(2の累乗)
+
+    /**
+     * @struct Event
+     * @brief 1ゾーンの記録
+     */
+    struct Event {
+        const char* name = nullptr;
+        int64_t beginNs = 0;  ///< 開始時刻(Profiler 作成時からのナノ秒)
+        int64_t endNs = 0;    ///< 終了時刻
+    };
+
+    static Profiler& GetInstance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    /**
+     * @brief 記録の有効・無効(既定は無効)
+     *
+     * @details
+     * 呼び出したスレッドのバッファをこの時点で登録するため、メインスレッドから呼べば
+     * トレース上でメインスレッドが先頭(Thread 0)になります。
+     */
+    void SetEnabled(bool enabled) {
+        if (enabled) threadBuffer();
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 現在時刻(Profiler 作成時からのナノ秒)
+     */
+    int64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin_).count();
+    }
+
+    /**
+     * @brief 呼び出したスレッドのバッファにゾーンを追加(ProfileZone から呼ばれる)
+     */
+    void Record(const char* name, int64_t beginNs, int64_t endNs) {
+        ThreadBuffer& buffer = threadBuffer();
+        uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        Event& e = buffer.events[head & (EVENTS_PER_THREAD - 1)];
+        e.name = name;
+        e.beginNs = beginNs;
+        e.endNs = endNs;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 記録したゾーンを Chrome トレース形式(JSON)で書き出す
+     * @param[in] path 出力先
+     * @return bool 書き出せた場合 true
+     *
+     * @details
+     * 各スレッドの直近 EVENTS_PER_THREAD 件を書き出します。記録中でも呼べますが、
+     * 読み取り中に上書きされたイベントは含めません。
+     */
+    bool ExportChromeTrace(const std::string& path) {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "wb") != 0 || !fp) {
+            DEBUGLOG_ERROR("[Profiler] トレースの出力先を開けません: " + path);
+            return false;
+        }
+
+        fputs("{\"traceEvents\":[\n", fp);
+        size_t written = 0;
+        std::vector<Event> events;
+        std::lock_guard<std::mutex> lock(threadsMutex_);
+        for (const std::unique_ptr<ThreadBuffer>& buffer : threads_) {
+            snapshot(*buffer, events);
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+                written > 0 ? ",\n" : "", buffer->index, buffer->index);
+            ++written;
+            for (const Event& e : events) {
+                std::string name = escape(e.name);
+                fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    name.c_str(), buffer->index, e.beginNs / 1000.0, (e.endNs - e.beginNs) / 1000.0);
+                ++written;
+            }
+        }
+        fputs("\n]}\n", fp);
+        bool ok = fclose(fp) == 0;
+
+        DEBUGLOG("[Profiler] トレースを書き出しました: " + path + " (" + std::to_string(written) + " イベント)");
+        return ok;
+    }
+
+private:
+    struct ThreadBuffer {
+        std::unique_ptr<Event[]> events{ new Event[EVENTS_PER_THREAD] };
+        std::atomic<uint64_t> head{ 0 }; ///< 書き込んだ総数(書き込みは所有スレッドのみ)
+        uint32_t index = 0;              ///< トレース上のスレッド番号(最初に記録した順)
+    };
+
+    Profiler() : origin_(std::chrono::steady_clock::now()) {}
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // 呼び出したスレッドのバッファ(初回だけ登録のためにロックする)
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(threadsMutex_);
+            threads_.push_back(std::make_unique<ThreadBuffer>());
+            buffer = threads_.back().get();
+            buffer->index = static_cast<uint32_t>(threads_.size() - 1);
+        }
+        return *buffer;
+    }
+
+    // リングバッファの有効な範囲をコピー(コピー中に上書きされた可能性のある古い側は捨てる)
+    static void snapshot(const ThreadBuffer& buffer, std::vector<Event>& out) {
+        out.clear();
+        uint64_t head = buffer.head.load(std::memory_order_acquire);
+        uint64_t first = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = first; i < head; ++i) {
+            out.push_back(buffer.events[i & (EVENTS_PER_THREAD - 1)]);
+        }
+        uint64_t after = buffer.head.load(std::memory_order_acquire);
+        uint64_t overwritten = after > EVENTS_PER_THREAD ? after - EVENTS_PER_THREAD : 0;
+        if (overwritten > first) {
+            size_t drop = static_cast<size_t>(std::min<uint64_t>(overwritten - first, out.size()));
+            out.erase(out.begin(), out.begin() + drop);
+        }
+    }
+
+    static std::string escape(const char* s) {
+        std::string out;
+        for (; s && *s; ++s) {
+            if (*s == '"' || *s == '\\') out += '\\';
+            if (static_cast<unsigned char>(*s) < 0x20) continue;
+            out += *s;
+        }
+        return out;
+    }
+
+    std::chrono::steady_clock::time_point origin_;
+    std::atomic<bool> enabled_{ false };
+    std::mutex threadsMutex_;                          ///< threads_ の登録と書き出しを保護
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_; ///< 記録したことのあるスレッドのバッファ
+};
+
+/**
+ * @class ProfileZone
+ * @brief PROFILE_SCOPE が作る RAII オブジェクト(無効な間は時刻を取らない)
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name_(name), beginNs_(Profiler::GetInstance().IsEnabled() ? Profiler::GetInstance().Now() : -1) {}
+
+    ~ProfileZone() {
+        if (beginNs_ < 0) return;
+        Profiler& profiler = Profiler::GetInstance();
+        profiler.Record(name_, beginNs_, profiler.Now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name_;
+    int64_t beginNs_;
+};
@@ -0,0 +1,248 @@
+/**
+ * @file QualityGovernor.h
+ * @brief CPU・GPU時間の履歴からサブシステムごとの品質の段階を上げ下げするフレーム時間の予算の制御
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 各サブシステムは品質の段階(0 が最高品質、数が大きいほど軽い)と、段階を反映する関数を Register() で登録します。
+ * 毎フレーム Update() に CPU 時間と GPU 時間を渡すと、次のように段階を1つずつ動かします。
+ * - 下げる: 目標を超えたフレームが OVER_FRAMES フレーム続いたら、CPU と GPU の遅い方(ボトルネック)に効く
+ *   つまみのうち、登録順で最初のまだ下げられるものを1段下げる(1フレームだけの突発的な負荷では動かない)
+ * - 上げる: 履歴(raiseFrames_ フレーム)の最大値が目標の RAISE_THRESHOLD 倍を下回っている間だけ、
+ *   最後に下げたつまみから(下げたのと逆の順に)1段上げる
+ *
+ * 上げた直後(RECENT_RAISE_FRAMES 以内)にまた下げた場合は往復とみなし、次に上げるまでの履歴の長さを2倍にします
+ * (MAX_RAISE_FRAMES まで。しばらく上げずに済むと元に戻る)。
+ * GpuProfiler の結果は数フレーム遅れて届き、テクスチャや影の変化も数フレームかかるため、
+ * 段階を変えた後の SETTLE_FRAMES フレームは読み捨て、履歴を空にしてから数え直します。
+ *
+ * DynamicResolution(GPU時間だけで解像度を決める)と併用する場合は、解像度で吸収できない負荷だけがここに届きます。
+ *
+ * @par 使用例
+ * @code
+ * QualityGovernor governor;
+ * governor.SetTargetMs(1000.0f / gfx.RefreshRate());
+ * governor.Register("particles", 3, QualityGovernor::Cost::Gpu, [&](uint32_t level) {
+ *     const float density[] = { 1.0f, 0.5f, 0.25f };
+ *     renderer.SetParticleDensity(density[level]);
+ * });
+ * governor.SetEnabled(true);
+ *
+ * // フレームごと(GPU時間の計測後)
+ * governor.Update(cpuMs, gfx.Profiler().FrameMs());
+ * @endcode
+ */
+#pragma once
+#include "app/DebugLog.h"
+#include "graphics/GpuProfiler.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @class QualityGovernor
+ * @brief 目標のフレーム時間を保つよう、登録した品質のつまみの段階を上げ下げする
+ */
+class QualityGovernor {
+public:
+    static constexpr size_t HISTORY_CAPACITY = 480;          ///< 履歴の最大フレーム数(MAX_RAISE_FRAMES 以上)
+    static constexpr uint32_t OVER_FRAMES = 3;                ///< 目標を超えたフレームがこれだけ続いたら下げる
+    static constexpr uint32_t SETTLE_FRAMES = GpuProfiler::LATENCY + 4; ///< 段階の変更が計測に現れるまでのフレーム数
+    static constexpr uint32_t MIN_RAISE_FRAMES = 60;          ///< 上げる判定に使う履歴のフレーム数(既定)
+    static constexpr uint32_t MAX_RAISE_FRAMES = 480;         ///< 往復を繰り返した時の上限
+    static constexpr uint32_t RECENT_RAISE_FRAMES = 120;      ///< 上げてからこのフレーム数以内に下げたら往復とみなす
+    static constexpr float RAISE_THRESHOLD = 0.75f;           ///< 履歴の最大値がこの割合を下回ったら上げる
+    static_assert(MAX_RAISE_FRAMES <= HISTORY_CAPACITY, "the raise history must fit in the ring");
+
+    /**
+     * @enum Cost
+     * @brief つまみが主に減らす負荷(ボトルネックに合うものから下げる)
+     */
+    enum class Cost : uint8_t {
+        Cpu,   ///< CPU 時間(描画の準備・シミュレーション)
+        Gpu,   ///< GPU 時間
+        Both,  ///< どちらにも効く
+    };
+
+    /**
+     * @struct Knob
+     * @brief 登録した品質のつまみ
+     */
+    struct Knob {
+        std::string name;
+        uint32_t levelCount = 1;               ///< 段階の数(0 〜 levelCount-1)
+        uint32_t level = 0;                    ///< 現在の段階(0 が最高品質)
+        Cost cost = Cost::Both;
+        std::function<void(uint32_t)> apply;   ///< 段階を反映する関数
+    };
+
+    void SetEnabled(bool enabled) {
+        enabled_ = enabled;
+        Reset();
+    }
+
+    bool IsEnabled() const { return enabled_; }
+
+    /**
+     * @brief 目標のフレーム時間(ミリ秒、例: 1000 / リフレッシュレート)
+     */
+    void SetTargetMs(float ms) { targetMs_ = (std::max)(ms, 0.1f); }
+    float TargetMs() const { return targetMs_; }
+
+    /**
+     * @brief 品質のつまみを登録(登録順に下げ、下げたのと逆の順に上げる。軽くしても見た目が変わりにくいものから登録する)
+     * @param[in] name ログ用の名前
+     * @param[in] levelCount 段階の数(2 以上。1 以下は登録しない)
+     * @param[in] cost 主に減らす負荷
+     * @param[in] apply void(uint32_t level) 形式の関数(登録時に段階 0 で1回呼ぶ)
+     * @return size_t つまみの番号(登録しなかった場合は SIZE_MAX)
+     */
+    size_t Register(const std::string& name, uint32_t levelCount, Cost cost, std::function<void(uint32_t)> apply) {
+        if (levelCount < 2 || !apply) return SIZE_MAX;
+        Knob knob;
+        knob.name = name;
+        knob.levelCount = levelCount;
+        knob.cost = cost;
+        knob.apply = std::move(apply);
+        knob.apply(0);
+        knobs_.push_back(std::move(knob));
+        return knobs_.size() - 1;
+    }
+
+    const std::vector<Knob>& Knobs() const { return knobs_; }
+
+    /**
+     * @brief すべてのつまみを最高品質に戻し、履歴を空にする
+     */
+    void Reset() {
+        for (Knob& knob : knobs_) {
+            if (knob.level != 0) {
+                knob.level = 0;
+                knob.apply(0);
+            }
+        }
+        lowered_.clear();
+        raiseFrames_ = MIN_RAISE_FRAMES;
+        sinceRaise_ = UINT32_MAX;
+        clearHistory();
+    }
+
+    /**
+     * @brief 1フレーム分の時間を記録し、必要なら1つのつまみの段階を変える
+     * @param[in] cpuMs CPU 時間(ミリ秒、Present の待ちを除く)
+     * @param[in] gpuMs GPU 時間(ミリ秒、0 以下は計測なしとして CPU 時間だけで判断)
+     * @return bool 段階を変えた場合 true
+     */
+    bool Update(float cpuMs, float gpuMs) {
+        if (!enabled_ || knobs_.empty()) return false;
+        if (sinceRaise_ != UINT32_MAX) ++sinceRaise_;
+        if (settle_ > 0) {
+            --settle_;
+            return false;
+        }
+
+        const float frameMs = (std::max)(cpuMs, gpuMs);
+        if (frameMs > targetMs_) {
+            if (++overFrames_ < OVER_FRAMES) return false;
+            return lower(gpuMs > cpuMs ? Cost::Gpu : Cost::Cpu, frameMs);
+        }
+        overFrames_ = 0;
+
+        history_[historyNext_] = frameMs;
+        historyNext_ = (historyNext_ + 1) % raiseFrames_;
+        if (historyCount_ < raiseFrames_) ++historyCount_;
+        if (historyCount_ < raiseFrames_) return false;
+
+        // 履歴全体に余裕がある場合だけ、最後に下げたつまみを1段上げる
+        const float peak = *std::max_element(history_, history_ + raiseFrames_);
+        if (peak >= targetMs_ * RAISE_THRESHOLD) return false;
+        return raise(peak);
+    }
+
+    /**
+     * @brief 下げている段階の合計(0 なら全つまみが最高品質)
+     */
+    uint32_t ReducedLevels() const {
+        uint32_t total = 0;
+        for (const Knob& knob : knobs_) total += knob.level;
+        return total;
+    }
+
+private:
+    bool lower(Cost bottleneck, float frameMs) {
+        Knob* target = nullptr;
+        for (Knob& knob : knobs_) {
+            if (knob.level + 1 >= knob.levelCount) continue;
+            if (knob.cost == bottleneck || knob.cost == Cost::Both) {
+                target = &knob;
+                break;
+            }
+        }
+        if (!target) {
+            // ボトルネックに効くつまみを下げ切った場合は、もう一方に効くものも下げる
+            for (Knob& knob : knobs_) {
+                if (knob.level + 1 < knob.levelCount) {
+                    target = &knob;
+                    break;
+                }
+            }
+        }
+        overFrames_ = 0;
+        if (!target) return false;
+
+        // 上げた直後に下げる往復は、次に上げるまでの履歴を長くする
+        if (sinceRaise_ <= RECENT_RAISE_FRAMES) {
+            raiseFrames_ = (std::min)(raiseFrames_ * 2, MAX_RAISE_FRAMES);
+        }
+        sinceRaise_ = UINT32_MAX;
+        lowered_.push_back(static_cast<size_t>(target - knobs_.data()));
+        change(*target, target->level + 1, frameMs, bottleneck == Cost::Gpu ? "GPU" : "CPU");
+        return true;
+    }
+
+    bool raise(float peakMs) {
+        if (lowered_.empty()) return false;
+        Knob& knob = knobs_[lowered_.back()];
+        lowered_.pop_back();
+        change(knob, knob.level - 1, peakMs, "余裕");
+        // 往復せずに最高品質まで戻れたら、上げる判定の長さも元に戻す
+        if (lowered_.empty()) raiseFrames_ = MIN_RAISE_FRAMES;
+        sinceRaise_ = 0;
+        return true;
+    }
+
+    void change(Knob& knob, uint32_t level, float frameMs, const char* reason) {
+        knob.level = level;
+        knob.apply(level);
+        clearHistory();
+        char line[192];
+        sprintf_s(line, "[QualityGovernor] %s: 段階 %u/%u (%s %.2fms, 目標 %.2fms)", knob.name.c_str(), level, knob.levelCount - 1,
+                  reason, frameMs, targetMs_);
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, line);
+    }
+
+    void clearHistory() {
+        historyCount_ = 0;
+        historyNext_ = 0;
+        overFrames_ = 0;
+        settle_ = SETTLE_FRAMES;
+    }
+
+    std::vector<Knob> knobs_;
+    std::vector<size_t> lowered_;               ///< 下げたつまみの番号(1段ごと、下げた順)
+    float history_[HISTORY_CAPACITY] = {};      ///< 現在の段階で計測したフレーム時間(ミリ秒、raiseFrames_ 個のリング)
+    uint32_t historyCount_ = 0;
+    uint32_t historyNext_ = 0;
+    uint32_t overFrames_ = 0;                   ///< 目標を超えたフレームが続いた数
+    uint32_t settle_ = 0;                       ///< 読み捨てる残りフレーム数
+    uint32_t raiseFrames_ = MIN_RAISE_FRAMES;   ///< 上げる判定に使う履歴のフレーム数
+    uint32_t sinceRaise_ = UINT32_MAX;          ///< 最後に上げてからのフレーム数(UINT32_MAX は上げていない)
+    float targetMs_ = 1000.0f / 60.0f;
+    bool enabled_ = false;
+};
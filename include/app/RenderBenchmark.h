@@ -0,0 +1,421 @@
+/**
+ * @file RenderBenchmark.h
+ * @brief 描画の負荷計測シーンの設定・カメラ経路・フレームごとの統計の記録
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * `--render-benchmark` を付けて起動すると、App は GameScene の代わりに RenderBenchmarkScene を開き、
+ * 決まった数の MeshRenderer・ModelComponent・DebugDraw の線を並べて、決まったカメラ経路を
+ * 指定フレーム数だけ描画してから終了します。経路はフレーム番号だけで決まるため、
+ * 実行のたびに同じ視点の列が描画されます。
+ *
+ * ウォームアップ(モデルの非同期読み込みとシェーダーのコンパイル)の後のフレームについて、
+ * CPU 時間・描画キューの送信時間・GPU 時間(GpuProfiler、数フレーム前の値)・ドローコール数・
+ * 三角形数・種類ごとのステート変更数・段階ごとの CPU 時間などを RenderSystem::Statistics から集め、
+ * 終了時に CSV へ1フレーム1行で書き出します。
+ * 計測中はファイル書き込みを行いません。
+ * 終了時にはフレームごとの RenderSystem::Render の CPU 時間(段階ごとの時間の合計)・抽出・送信・GPU の時間を
+ * `--bench-history` のファイル(BenchmarkHistory)にもコミットとマシンを付けて追記し、HEW_BENCH_COMPARE で比較できます。
+ *
+ * @par コマンドライン
+ * @code
+ * HEW_GAME.exe --render-benchmark [--bench-meshes N] [--bench-models N] [--bench-lines N]
+ *              [--bench-frames N] [--bench-warmup N] [--bench-model path] [--bench-out render_benchmark.csv]
+ *              [--bench-history bench_history.csv|none]
+ * @endcode
+ *
+ * `--replay-capture` は RenderSystem::RequestFrameCapture() で記録した描画キュー(FrameCapture.h)を
+ * シーンを開かずに毎フレーム送り直し、同じ形式の CSV を書き出します(FrameReplayConfig)。
+ * @code
+ * HEW_GAME.exe --replay-capture frame_capture.hfcp [--replay-frames N] [--replay-warmup N] [--replay-out frame_replay.csv]
+ *              [--replay-history bench_history.csv|none]
+ * @endcode
+ *
+ * @note DebugDraw はデバッグビルドにしかないため、線の数はデバッグビルドでのみ反映されます。
+ */
+#pragma once
+#include "app/BenchmarkHistory.h"
+#include "app/CommandLine.h"
+#include "app/DebugLog.h"
+#include "graphics/Camera.h"
+#include "graphics/RenderSystem.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @struct RenderBenchmarkConfig
+ * @brief 計測シーンの規模と出力先
+ */
+struct RenderBenchmarkConfig {
+    size_t meshCount = 10000;                          ///< MeshRenderer のプリミティブ数
+    size_t modelCount = 100;                           ///< ModelComponent(テクスチャ付きモデル)の数
+    size_t lineCount = 5000;                           ///< 毎フレーム追加する DebugDraw の線の数
+    int frames = 600;                                  ///< 記録するフレーム数(カメラ経路の1周)
+    int warmupFrames = 120;                            ///< 記録を始めるまでのフレーム数
+    std::string modelPath = "Assets/Models/test.fbx";  ///< 配置するモデル
+    std::string outputPath = "render_benchmark.csv";   ///< CSV の出力先
+    std::string historyPath = BenchmarkHistory::DEFAULT_PATH; ///< フレームごとの値を追記する履歴("none" で追記しない)
+    std::string historySuite;                          ///< 履歴の suite(空なら render/<meshes>x<models>x<lines>)
+    std::string historyFunction = "RenderSystem::Render"; ///< 履歴の metric の接頭辞
+
+    static constexpr float MESH_SPACING = 2.0f;   ///< プリミティブの間隔
+    static constexpr float MODEL_SPACING = 6.0f;  ///< モデルの間隔
+    static constexpr float MODEL_HEIGHT = 4.0f;   ///< モデルを並べる高さ
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @param[in] cmdLine WinMain の lpCmdLine
+     * @param[out] out 読み取った設定(`--render-benchmark` がない場合は変更しない)
+     * @return bool `--render-benchmark` が指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, RenderBenchmarkConfig& out) {
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+        if (!CommandLine::Has(args, "--render-benchmark")) return false;
+
+        RenderBenchmarkConfig config;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            const std::string& key = args[i];
+            const char* value = args[i + 1].c_str();
+            if (key == "--bench-meshes") config.meshCount = std::strtoul(value, nullptr, 10);
+            else if (key == "--bench-models") config.modelCount = std::strtoul(value, nullptr, 10);
+            else if (key == "--bench-lines") config.lineCount = std::strtoul(value, nullptr, 10);
+            else if (key == "--bench-frames") config.frames = (std::max)(1, std::atoi(value));
+            else if (key == "--bench-warmup") config.warmupFrames = (std::max)(0, std::atoi(value));
+            else if (key == "--bench-model") config.modelPath = value;
+            else if (key == "--bench-out") config.outputPath = value;
+            else if (key == "--bench-history") config.historyPath = value;
+        }
+        out = config;
+        return true;
+    }
+
+    /**
+     * @brief count 個を正方形の格子に並べたときの1辺の個数
+     */
+    static size_t GridSide(size_t count) {
+        return count > 0 ? static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count)))) : 0;
+    }
+
+    /**
+     * @brief 格子の index 番目の位置(原点を中心に XZ 平面へ並べる)
+     */
+    static DirectX::XMFLOAT3 GridPosition(size_t index, size_t count, float spacing, float y) {
+        const size_t side = GridSide(count);
+        const float half = (static_cast<float>(side) - 1.0f) * spacing * 0.5f;
+        return DirectX::XMFLOAT3{
+            static_cast<float>(index % side) * spacing - half,
+            y,
+            static_cast<float>(index / side) * spacing - half
+        };
+    }
+
+    /**
+     * @brief シーン全体の半径(XZ 平面)
+     */
+    float Extent() const {
+        const float meshes = static_cast<float>(GridSide(meshCount)) * MESH_SPACING * 0.5f;
+        const float models = static_cast<float>(GridSide(modelCount)) * MODEL_SPACING * 0.5f;
+        return (std::max)((std::max)(meshes, models), 10.0f);
+    }
+};
+
+/**
+ * @struct FrameReplayConfig
+ * @brief 記録したフレームの再生(`--replay-capture`)の入力と計測の設定
+ */
+struct FrameReplayConfig {
+    std::string capturePath;                        ///< RenderSystem::RequestFrameCapture() で書き出したファイル
+    int frames = 600;                               ///< 記録するフレーム数
+    int warmupFrames = 60;                          ///< 記録を始めるまでのフレーム数(テクスチャの読み込みを待つ)
+    std::string outputPath = "frame_replay.csv";    ///< CSV の出力先
+    std::string historyPath = BenchmarkHistory::DEFAULT_PATH; ///< フレームごとの値を追記する履歴("none" で追記しない)
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @param[in] cmdLine WinMain の lpCmdLine
+     * @param[out] out 読み取った設定(`--replay-capture <path>` がない場合は変更しない)
+     * @return bool `--replay-capture <path>` が指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, FrameReplayConfig& out) {
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+
+        FrameReplayConfig config;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            const std::string& key = args[i];
+            const char* value = args[i + 1].c_str();
+            if (key == "--replay-capture") config.capturePath = value;
+            else if (key == "--replay-frames") config.frames = (std::max)(1, std::atoi(value));
+            else if (key == "--replay-warmup") config.warmupFrames = (std::max)(0, std::atoi(value));
+            else if (key == "--replay-out") config.outputPath = value;
+            else if (key == "--replay-history") config.historyPath = value;
+        }
+        if (config.capturePath.empty()) return false;
+        out = config;
+        return true;
+    }
+
+    /**
+     * @brief 計測(RenderBenchmark)の設定(シーンの規模は 0)
+     */
+    RenderBenchmarkConfig RenderConfig() const {
+        RenderBenchmarkConfig config;
+        config.meshCount = 0;
+        config.modelCount = 0;
+        config.lineCount = 0;
+        config.frames = frames;
+        config.warmupFrames = warmupFrames;
+        config.outputPath = outputPath;
+        config.historyPath = historyPath;
+        config.historySuite = "replay/" + std::filesystem::path(capturePath).filename().string();
+        config.historyFunction = "RenderSystem::RenderReplay";
+        return config;
+    }
+};
+
+/**
+ * @class RenderBenchmark
+ * @brief カメラ経路の適用とフレームごとの統計の記録
+ *
+ * @par 使用例(App のメインループ)
+ * @code
+ * benchmark.ApplyCamera(camera);          // 描画の前
+ * // ... Render / Present ...
+ * if (benchmark.Record(cpuMs, renderMs, gpuMs, renderer.GetStatistics())) {
+ *     PostQuitMessage(0);                 // CSV を書き出し済み
+ * }
+ * @endcode
+ */
+class RenderBenchmark {
+public:
+    explicit RenderBenchmark(const RenderBenchmarkConfig& config) : config_(config) {
+        rows_.reserve(static_cast<size_t>(config_.frames));
+    }
+
+    const RenderBenchmarkConfig& Config() const { return config_; }
+
+    /**
+     * @brief 現在のフレームの視点をカメラに設定
+     *
+     * @details
+     * シーンの周りを1周(config.frames フレーム)しながら、高さと半径を変えて近づいたり離れたりします。
+     * 近い視点では格子の一部だけが視錐台に入り、遠い視点ではほぼ全体が入ります。
+     */
+    void ApplyCamera(Camera& camera) const {
+        OrbitCamera(camera, config_, (std::max)(0, frame_ - config_.warmupFrames));
+    }
+
+    /**
+     * @brief config のシーンを回る経路の recorded フレーム目の視点(ScenarioBenchmark の render シナリオと共用)
+     */
+    static void OrbitCamera(Camera& camera, const RenderBenchmarkConfig& config, int recorded) {
+        const float extent = config.Extent();
+        const float t = static_cast<float>(recorded % config.frames) / static_cast<float>(config.frames);
+        const float angle = t * DirectX::XM_2PI;
+        const float radius = extent * (0.6f + 0.5f * (0.5f + 0.5f * std::cos(angle * 2.0f)));
+        const float height = extent * (0.25f + 0.35f * (0.5f + 0.5f * std::sin(angle * 3.0f)));
+
+        camera.position = DirectX::XMFLOAT3{ radius * std::cos(angle), height, radius * std::sin(angle) };
+        camera.target = DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f };
+        camera.up = DirectX::XMFLOAT3{ 0.0f, 1.0f, 0.0f };
+        const float farZ = extent * 4.0f;
+        if (camera.farZ != farZ) {
+            camera.farZ = farZ;
+            camera.Proj = DirectX::XMMatrixPerspectiveFovLH(camera.fovY, camera.aspect, camera.nearZ, camera.farZ);
+        }
+        camera.Update();
+    }
+
+    /**
+     * @brief 毎フレームの線を追加(DebugDraw::Clear() の後に呼ぶ)
+     *
+     * @details
+     * メッシュの格子の上に、格子点から立ち上がる縦線を並べます。
+     */
+    template<class TDebugDraw>
+    void DrawLines(TDebugDraw& debugDraw) const {
+        const size_t count = config_.lineCount;
+        for (size_t i = 0; i < count; ++i) {
+            DirectX::XMFLOAT3 base = RenderBenchmarkConfig::GridPosition(i, count, RenderBenchmarkConfig::MESH_SPACING, 0.0f);
+            DirectX::XMFLOAT3 top{ base.x, 1.0f + static_cast<float>(i % 7) * 0.5f, base.z };
+            debugDraw.AddLine(base, top, DirectX::XMFLOAT3{ 1.0f, 0.8f, 0.2f });
+        }
+    }
+
+    /**
+     * @brief 1フレーム分の結果を記録
+     * @param[in] cpuFrameMs フレーム全体の CPU 時間(ミリ秒)
+     * @param[in] cpuRenderMs 描画フェーズの CPU 時間(ミリ秒)
+     * @param[in] gpuMs GPU 時間(ミリ秒、計測無効時は 0)
+     * @param[in] stats このフレームの RenderSystem::Statistics
+     * @return bool 全フレームを記録して CSV を書き出した場合 true(呼び出し側で終了する)
+     */
+    bool Record(float cpuFrameMs, float cpuRenderMs, float gpuMs, const RenderSystem::Statistics& stats) {
+        if (finished_) return true;
+        const int frame = frame_++;
+        if (frame < config_.warmupFrames) return false;
+
+        Row row;
+        row.frame = frame - config_.warmupFrames;
+        row.cpuFrameMs = cpuFrameMs;
+        row.cpuRenderMs = cpuRenderMs;
+        row.extractMs = stats.extractMs;
+        row.submitMs = stats.submitMs;
+        row.gpuMs = gpuMs;
+        row.drawCalls = stats.totalDrawCalls;
+        row.instancedDraws = stats.instancedDraws;
+        row.instances = stats.instancesRendered;
+        row.stateChanges = stats.stateChanges;
+        row.stateChangesSkipped = stats.stateChangesSkipped;
+        row.culled = stats.culled;
+        row.proxies = stats.proxies;
+        row.meshes = stats.meshesRendered;
+        row.models = stats.modelsRendered;
+        row.triangles = stats.trianglesRendered;
+        row.textureBinds = stats.textureBinds;
+        row.constantBufferBytes = stats.constantBufferBytes;
+        std::copy(std::begin(stats.stateChangesByKind), std::end(stats.stateChangesByKind), row.stateChangesByKind);
+        std::copy(std::begin(stats.passMs), std::end(stats.passMs), row.passMs);
+        rows_.push_back(row);
+
+        if (static_cast<int>(rows_.size()) < config_.frames) return false;
+        finished_ = true;
+        WriteCsv();
+        WriteHistory();
+        LogSummary();
+        return true;
+    }
+
+    bool IsFinished() const { return finished_; }
+
+private:
+    struct Row {
+        int frame = 0;
+        float cpuFrameMs = 0.0f;
+        float cpuRenderMs = 0.0f;
+        float extractMs = 0.0f;
+        float submitMs = 0.0f;
+        float gpuMs = 0.0f;
+        size_t drawCalls = 0;
+        size_t instancedDraws = 0;
+        size_t instances = 0;
+        size_t stateChanges = 0;
+        size_t stateChangesSkipped = 0;
+        size_t culled = 0;
+        size_t proxies = 0;
+        size_t meshes = 0;
+        size_t models = 0;
+        size_t triangles = 0;
+        size_t textureBinds = 0;
+        size_t constantBufferBytes = 0;
+        size_t stateChangesByKind[RenderSystem::Statistics::STATE_KIND_COUNT] = {};
+        float passMs[RenderSystem::Statistics::PASS_COUNT] = {};
+    };
+
+    void WriteCsv() const {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, config_.outputPath.c_str(), "w") != 0 || !fp) {
+            DEBUGLOG_ERROR("[RenderBenchmark] " + config_.outputPath + " を開けません");
+            return;
+        }
+        using Stats = RenderSystem::Statistics;
+        std::fprintf(fp, "frame,cpu_frame_ms,cpu_render_ms,extract_ms,submit_ms,gpu_ms,draw_calls,instanced_draws,"
+                         "instances,state_changes,state_changes_skipped,culled,proxies,meshes_rendered,models_rendered,"
+                         "triangles,texture_binds,constant_buffer_bytes");
+        for (uint32_t k = 0; k < Stats::STATE_KIND_COUNT; ++k) std::fprintf(fp, ",state_%s", Stats::StateKindName(k));
+        for (uint32_t p = 0; p < Stats::PASS_COUNT; ++p) std::fprintf(fp, ",%s_ms", Stats::PassName(p));
+        std::fprintf(fp, "\n");
+        for (const Row& r : rows_) {
+            std::fprintf(fp, "%d,%.4f,%.4f,%.4f,%.4f,%.4f,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu",
+                         r.frame, r.cpuFrameMs, r.cpuRenderMs, r.extractMs, r.submitMs, r.gpuMs,
+                         r.drawCalls, r.instancedDraws, r.instances, r.stateChanges, r.stateChangesSkipped,
+                         r.culled, r.proxies, r.meshes, r.models, r.triangles, r.textureBinds, r.constantBufferBytes);
+            for (size_t changes : r.stateChangesByKind) std::fprintf(fp, ",%zu", changes);
+            for (float ms : r.passMs) std::fprintf(fp, ",%.4f", ms);
+            std::fprintf(fp, "\n");
+        }
+        std::fclose(fp);
+    }
+
+    /**
+     * @brief フレームごとの時間を BenchmarkHistory に追記
+     */
+    void WriteHistory() const {
+        if (config_.historyPath == "none") return;
+        std::vector<double> frame, render, extract, submit, gpu;
+        for (const Row& r : rows_) {
+            double renderMs = 0.0;
+            for (float ms : r.passMs) renderMs += ms;
+            frame.push_back(r.cpuFrameMs);
+            render.push_back(renderMs);
+            extract.push_back(r.extractMs);
+            submit.push_back(r.submitMs);
+            if (r.gpuMs > 0.0f) gpu.push_back(r.gpuMs);
+        }
+        const std::string suite = !config_.historySuite.empty() ? config_.historySuite :
+            "render/" + std::to_string(config_.meshCount) + "x" + std::to_string(config_.modelCount) + "x" + std::to_string(config_.lineCount);
+        const std::string& function = config_.historyFunction;
+        std::vector<BenchmarkRecord> records;
+        records.push_back(BenchmarkHistory::MakeRecord(suite, "frame/total_ms", std::move(frame)));
+        records.push_back(BenchmarkHistory::MakeRecord(suite, function + "/cpu_ms", std::move(render)));
+        records.push_back(BenchmarkHistory::MakeRecord(suite, function + "/extract_ms", std::move(extract)));
+        records.push_back(BenchmarkHistory::MakeRecord(suite, function + "/submit_ms", std::move(submit)));
+        records.push_back(BenchmarkHistory::MakeRecord(suite, function + "/gpu_ms", std::move(gpu)));
+        if (!BenchmarkHistory::Append(config_.historyPath, records)) {
+            DEBUGLOG_ERROR("[RenderBenchmark] " + config_.historyPath + " を開けません");
+            return;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderBenchmark] フレームごとの値を " + config_.historyPath + " に追記しました");
+    }
+
+    /**
+     * @brief 平均と百分位をログ出力
+     */
+    void LogSummary() const {
+        auto percentile = [](std::vector<float> values, float p) {
+            if (values.empty()) return 0.0f;
+            size_t index = static_cast<size_t>(p * static_cast<float>(values.size() - 1));
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index];
+        };
+
+        std::vector<float> cpu, submit, gpu;
+        cpu.reserve(rows_.size());
+        submit.reserve(rows_.size());
+        gpu.reserve(rows_.size());
+        double drawCalls = 0.0, stateChanges = 0.0;
+        for (const Row& r : rows_) {
+            cpu.push_back(r.cpuFrameMs);
+            submit.push_back(r.submitMs);
+            gpu.push_back(r.gpuMs);
+            drawCalls += static_cast<double>(r.drawCalls);
+            stateChanges += static_cast<double>(r.stateChanges);
+        }
+        const double n = static_cast<double>(rows_.size());
+
+        char line[320];
+        sprintf_s(line, "[RenderBenchmark] meshes=%zu models=%zu lines=%zu, %zu フレーム: CPU p50 %.3fms p99 %.3fms, 送信 p50 %.3fms, GPU p50 %.3fms p99 %.3fms, "
+                        "ドローコール平均 %.1f, ステート変更平均 %.1f",
+                  config_.meshCount, config_.modelCount, config_.lineCount,
+                  rows_.size(), percentile(cpu, 0.5f), percentile(cpu, 0.99f), percentile(submit, 0.5f),
+                  percentile(gpu, 0.5f), percentile(gpu, 0.99f), drawCalls / n, stateChanges / n);
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, line);
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderBenchmark] 結果を " + config_.outputPath + " に書き出しました");
+    }
+
+    RenderBenchmarkConfig config_;
+    std::vector<Row> rows_;  ///< 記録したフレーム(終了時にまとめて書き出す)
+    int frame_ = 0;          ///< Record() を呼んだ回数(ウォームアップを含む)
+    bool finished_ = false;
+};
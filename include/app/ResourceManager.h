@@ -2,26 +2,224 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
 #include "components/ModelComponent.h"
 #include "graphics/ModelLoader.h"
+#include "app/JobSystem.h"
+#include "app/AssetHandle.h"
+#include "app/FileWatcher.h"
+#include "graphics/MeshCache.h"
 
 /**
  * @file ResourceManager.h
  * @brief 3Dモデルなどのリソースを管理（キャッシュ）するクラス
  * @author 山内陽
  * @date 2025
- * @version 6.0
+ * @version 6.3
+ *
+ * @details
+ * GetModel() は呼び出しスレッドで読み込みます。GetModelAsync() はジオメトリの変換と
+ * GPUバッファの作成をジョブシステムのワーカーで行い、テクスチャの読み込みだけを
+ * 完了後の呼び出し(メインスレッド)で行います。
+ *
+ * AcquireModel() / AcquireTexture() は参照カウント付きのハンドルを返します。モデルは読み込み時に
+ * 使ったテクスチャを依存として記録し、最後のハンドルが Release() されるとモデルと依存テクスチャを
+ * まとめて解放します。シーンの切り替えでは PreloadModels() で次のシーンのモデルを先に読み込み、
+ * 前のシーンのハンドルを ReleaseModels() で返却します。
+ *
+ * SetHotReloadEnabled(true) の間、HOT_RELOAD_DIRECTORY を FileWatcher で監視し、Update() が変更の通知のあった
+ * モデルと依存テクスチャを読み込み直します(監視を始められない場合は HOT_RELOAD_POLL_FRAMES ごとに更新日時を確認)。
+ * 同名で拡張子だけ異なるファイル(.dds・.mtl など)の変更も元のアセットの変更として扱います。
+ * - テクスチャ: TextureManager::ReloadAsync() でワーカーがデコードし、完了後にハンドルを保ったまま差し替える
+ * - モデル: ワーカーが読み込み直す(.meshcache も作り直す)間は元のキャッシュを使い続け、完了したフレームで
+ *   キャッシュを入れ替えて GetModelGeneration() を進める。ModelLoadingSystem はそのフレームのうちにエンティティを作り直す
+ * 読み込みに失敗した場合(保存途中のファイルなど)は元の内容のまま、次の変更でまた試します。
  */
 
 class ResourceManager {
 public:
+    /**
+     * @enum LoadState
+     * @brief 非同期読み込みの状態
+     */
+    enum class LoadState {
+        Loading,  ///< 読み込み中
+        Ready,    ///< 読み込み完了(キャッシュ済み)
+        Failed,   ///< 読み込み失敗
+    };
+
     // モデルをファイルパスで取得（キャッシュ対応）
     const std::vector<ModelComponent>& GetModel(const std::string& filePath);
 
-    // キャッシュをクリア
+    /**
+     * @brief モデルを非同期で取得(初回呼び出しで読み込みを開始し、以降は毎フレーム状態を確認)
+     * @param[in] filePath モデルファイルのパス(読み込みのハンドルを兼ねる)
+     * @param[out] out Ready の場合キャッシュ済みのメッシュ、それ以外は nullptr
+     * @return LoadState 現在の状態
+     *
+     * @note メインスレッドから呼び出してください。ジョブシステム未設定の場合はその場で読み込みます
+     */
+    LoadState GetModelAsync(const std::string& filePath, const std::vector<ModelComponent>*& out);
+
+    /**
+     * @brief モデルのハンドルを取得し、未読み込みなら非同期読み込みを開始
+     * @param[in] filePath モデルファイルのパス
+     * @return ModelAssetHandle 同じパスには同じハンドル(参照カウントを1つ増やす)
+     */
+    ModelAssetHandle AcquireModel(const std::string& filePath);
+
+    // ハンドルでモデルを非同期で取得(GetModelAsync(filePath, out) と同じ)
+    LoadState GetModelAsync(ModelAssetHandle handle, const std::vector<ModelComponent>*& out);
+
+    // ハンドルのパス(無効なハンドルは空文字列)
+    const std::string& GetPath(ModelAssetHandle handle) const;
+
+    /**
+     * @brief モデルのハンドルを返却
+     *
+     * @details
+     * 最後のハンドルが返却されるとキャッシュのメッシュと依存テクスチャを解放します。
+     * 解放後もエンティティが持つ ModelComponent のバッファは残りますが、テクスチャは無効になるため
+     * 使用中のエンティティを先に破棄してください。
+     */
+    void Release(ModelAssetHandle& handle);
+
+    /**
+     * @brief テクスチャのハンドルを取得(TextureManager::LoadFromFileAsync で読み込み)
+     */
+    TextureAssetHandle AcquireTexture(const std::string& filePath);
+
+    // ハンドルの TextureManager のテクスチャ(無効なハンドルは INVALID_TEXTURE)
+    TextureManager::TextureHandle GetTexture(TextureAssetHandle handle) const;
+
+    // テクスチャのハンドルを返却
+    void Release(TextureAssetHandle& handle);
+
+    // シーンで使うモデルをまとめて取得して読み込みを開始
+    std::vector<ModelAssetHandle> PreloadModels(const std::vector<std::string>& filePaths);
+
+    // すべて Ready か Failed になったか(ロード画面の終了判定)
+    bool AreModelsLoaded(const std::vector<ModelAssetHandle>& handles);
+
+    // まとめて返却(handles は空になる)
+    void ReleaseModels(std::vector<ModelAssetHandle>& handles);
+
+    // ファイル変更の監視を切り替え(有効にすると HOT_RELOAD_DIRECTORY の監視を始める)
+    void SetHotReloadEnabled(bool enabled);
+    bool IsHotReloadEnabled() const { return hotReload_; }
+
+    // ホットリロードの確認(毎フレーム、メインスレッドから呼び出す。読み込み直しの完了もここで反映する)
+    void Update();
+
+    // モデルが読み込み直された回数(エンティティ側の作り直しの判定に使う)
+    uint32_t GetModelGeneration(const std::string& filePath) const;
+
+    // いずれかのモデルが読み込み直されるたびに増える(毎フレームの全エンティティの確認を省くため)
+    uint32_t GetReloadCount() const { return reloadCount_; }
+
+    // キャッシュ済みモデルの頂点・インデックスバッファ(LOD・スキニングの影響を含む)の合計バイト数(MemoryTracker への報告用)
+    size_t GpuMemoryBytes() const;
+
+    static constexpr uint32_t HOT_RELOAD_POLL_FRAMES = 30; ///< 監視できない場合にファイルを確認する間隔(フレーム)
+    static constexpr const char* HOT_RELOAD_DIRECTORY = "Assets"; ///< 変更を監視するディレクトリ
+
+    // 非同期読み込みに使うジョブシステムを設定(nullptrで同期読み込み、切り替え前に読み込み中のものを待つ)
+    void SetJobSystem(JobSystem* jobs);
+
+    // キャッシュをクリア（読み込み中のものは完了を待ってから破棄）
     void Clear();
 
 private:
+    /**
+     * @struct PendingModel
+     * @brief ワーカーで読み込み中のモデル
+     */
+    struct PendingModel {
+        ModelLoader::LoadedModel model;  ///< 読み込み結果(done が true になってから参照)
+        bool succeeded = false;          ///< 読み込みに成功したか
+        std::atomic<bool> done{ false }; ///< ワーカーの処理が終わったか
+    };
+
+    // 完了した読み込みのテクスチャを解決してキャッシュへ移す
+    LoadState finishPending(const std::string& filePath, PendingModel& pending, const std::vector<ModelComponent>*& out);
+
+    // 読み込み中のジョブをすべて待つ
+    void waitPending();
+
+    // テクスチャを解決したモデルをキャッシュに登録し、依存テクスチャと元ファイルの情報を記録
+    const std::vector<ModelComponent>& storeModel(const std::string& filePath, ModelLoader::LoadedModel& model);
+
+    // キャッシュのモデルと依存テクスチャを解放(読み込み中ならその結果を捨てる)
+    // keepTextures が true の場合、テクスチャは次の読み込みが終わるまで残す(ホットリロード用)
+    void unloadModel(const std::string& filePath, bool keepTextures = false);
+
+    // ホットリロードでモデルの読み込み直しをワーカーで始める(読み込み直し中なら前の結果を捨てる)
+    void startReload(const std::string& filePath);
+
+    // 読み込み直しが完了したモデルをキャッシュと入れ替える
+    void finishReloads();
+
+    // unloadModel(filePath, true) で残したテクスチャを解放
+    void releaseRetired(const std::string& filePath);
+
+    // テクスチャをホットリロードの監視対象に加える / 外す(依存とハンドルで共有するため参照カウント)
+    void watchTexture(TextureManager::TextureHandle handle, const std::string& filePath);
+    void unwatchTexture(TextureManager::TextureHandle handle);
+
+    /**
+     * @struct ModelRecord
+     * @brief AcquireModel() のハンドル1つ分
+     */
+    struct ModelRecord {
+        std::string path;
+        uint32_t refCount = 0; ///< 0 は空き
+    };
+
+    /**
+     * @struct TextureWatch
+     * @brief ホットリロードで監視するテクスチャ
+     */
+    struct TextureWatch {
+        std::string path;
+        MeshCacheStamp stamp;
+        uint32_t refCount = 0;
+    };
+
     // モデルキャッシュ
     std::unordered_map<std::string, std::vector<ModelComponent>> modelCache_;
+    // 読み込み中のモデル
+    std::unordered_map<std::string, std::shared_ptr<PendingModel>> pending_;
+    // ホットリロードで読み込み直し中のモデル(完了までキャッシュは元のまま)
+    std::unordered_map<std::string, std::shared_ptr<PendingModel>> reloading_;
+    // 読み込みに失敗したモデル(再試行しない)
+    std::unordered_set<std::string> failed_;
+    // モデルごとの依存テクスチャ
+    std::unordered_map<std::string, std::vector<TextureManager::TextureHandle>> modelTextures_;
+    // 再読み込み中のモデルが以前使っていたテクスチャ
+    std::unordered_map<std::string, std::vector<TextureManager::TextureHandle>> retiredTextures_;
+    // モデルの元ファイルの情報(ホットリロード用)
+    std::unordered_map<std::string, MeshCacheStamp> modelStamps_;
+    // モデルの再読み込み回数
+    std::unordered_map<std::string, uint32_t> modelGenerations_;
+    uint32_t reloadCount_ = 0;
+
+    // モデルのハンドル(id - 1 が添字)
+    std::vector<ModelRecord> modelRecords_;
+    std::unordered_map<std::string, uint32_t> modelIds_;
+    std::vector<uint32_t> freeModelIds_;
+
+    // AcquireTexture() の参照カウント(TextureManager のハンドル -> 取得回数)
+    std::unordered_map<TextureManager::TextureHandle, uint32_t> textureRefs_;
+    // ホットリロードで監視するテクスチャ
+    std::unordered_map<TextureManager::TextureHandle, TextureWatch> textureWatches_;
+
+    bool hotReload_ = false;
+    uint32_t pollFrame_ = 0;
+    FileWatcher watcher_;  ///< HOT_RELOAD_DIRECTORY の変更の通知(止まっている場合は更新日時の確認)
+
+    // 非同期読み込み用
+    JobSystem* jobs_ = nullptr;
+    JobSystem::JobCounter loads_;
 };
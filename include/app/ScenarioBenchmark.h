@@ -0,0 +1,312 @@
+/**
+ * @file ScenarioBenchmark.h
+ * @brief コマンドラインで指定したシナリオを決まったフレーム数だけ実行し、結果を CSV に1行追記する計測
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * `--bench <scenario>` を付けて起動すると、App はゲームの代わりにシナリオのシーンを開き、垂直同期なしで
+ * 毎フレームちょうど1固定ステップずつ進めます(実時間に合わせないため、遅いマシンでも同じシミュレーションになる)。
+ * util::Random はメインスレッドとシミュレーションのスレッドの両方を `--seed` で初期化します。
+ *
+ * ウォームアップ(モデルの非同期読み込みとシェーダーのコンパイル)の後の `--frames` フレームについて、
+ * フレーム・Update・Render・Present・GPU の時間の分布(App::OutputFrameStatistics と同じ FrameHistogram)と
+ * RenderSystem::Statistics の平均を集め、終了時に World の統計と一緒に CSV へ1回の実行を1行として追記します。
+ * 列は固定なので、夜間の計測で同じファイルに追記し続けて推移を比較できます。
+ * フレームごとのフレーム・Update(World::Tick)・RenderSystem::Render(段階ごとの CPU 時間の合計)・GPU の時間は
+ * `--history` のファイル(BenchmarkHistory)にコミットとマシンを付けて追記し、HEW_BENCH_COMPARE で前のコミットと比較できます。
+ *
+ * シナリオ:
+ * - crowd: `--entities` 個の MeshRenderer が箱の中を動き回る(MovementSystem・Rotator・並列の壁の反射、CrowdBenchmarkScene)
+ * - crowd-gpu: crowd と同じ群衆を GpuMover で動かす(積分・壁の反射・描画をGPUで行う、GpuMoverSystem)
+ * - render: `--entities` 個のプリミティブとモデルの格子を周回するカメラで描画(RenderBenchmarkScene)
+ * - game: 通常の GameScene(`--entities` は使わない)
+ *
+ * @par コマンドライン
+ * @code
+ * HEW_GAME.exe --bench crowd [--frames N] [--warmup N] [--entities M] [--seed S] [--out bench_results.csv]
+ *              [--history bench_history.csv|none] [--headless]
+ * @endcode
+ *
+ * @note `--headless` と組み合わせた場合、終了の判定は `--frames` に従います
+ * @note ParallelForEach のワーカーの util::Random はシードで初期化されないため、ワーカーで乱数を使うシステムの結果は一致しません
+ */
+#pragma once
+#include "app/BenchmarkHistory.h"
+#include "app/CommandLine.h"
+#include "app/DebugLog.h"
+#include "app/FrameHistogram.h"
+#include "app/RenderBenchmark.h"
+#include "ecs/World.h"
+#include "graphics/Camera.h"
+#include "graphics/RenderSystem.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ScenarioBenchmarkConfig
+ * @brief 実行するシナリオと規模・出力先
+ */
+struct ScenarioBenchmarkConfig {
+    std::string scenario = "crowd";                 ///< シナリオ名(IsKnownScenario() を参照)
+    int frames = 1200;                              ///< 記録するフレーム数(= 固定ステップ数)
+    int warmupFrames = 120;                         ///< 記録を始めるまでのフレーム数
+    size_t entities = 10000;                        ///< シナリオのエンティティ数
+    uint64_t seed = 1;                              ///< util::Random のシード
+    std::string outputPath = "bench_results.csv";   ///< 結果を追記する CSV
+    std::string historyPath = BenchmarkHistory::DEFAULT_PATH; ///< フレームごとの値を追記する履歴("none" で追記しない)
+
+    static constexpr float CROWD_DENSITY = 0.25f;   ///< crowd の1エンティティあたりの床面積の逆数(1/m^2)
+    static constexpr float CROWD_SPEED = 6.0f;      ///< crowd の最大速度(m/秒)
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @param[in] cmdLine WinMain の lpCmdLine
+     * @param[out] out 読み取った設定(`--bench` がない場合は変更しない)
+     * @return bool `--bench` が指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, ScenarioBenchmarkConfig& out) {
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+        auto bench = std::find(args.begin(), args.end(), "--bench");
+        if (bench == args.end()) return false;
+
+        ScenarioBenchmarkConfig config;
+        if (bench + 1 != args.end() && (bench + 1)->compare(0, 2, "--") != 0) config.scenario = *(bench + 1);
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            const std::string& key = args[i];
+            const char* value = args[i + 1].c_str();
+            if (key == "--frames") config.frames = (std::max)(1, std::atoi(value));
+            else if (key == "--warmup") config.warmupFrames = (std::max)(0, std::atoi(value));
+            else if (key == "--entities") config.entities = std::strtoul(value, nullptr, 10);
+            else if (key == "--seed") config.seed = std::strtoull(value, nullptr, 10);
+            else if (key == "--out") config.outputPath = value;
+            else if (key == "--history") config.historyPath = value;
+        }
+        out = config;
+        return true;
+    }
+
+    static bool IsKnownScenario(const std::string& name) {
+        return IsCrowdScenario(name) || name == "render" || name == "game";
+    }
+
+    /**
+     * @brief CrowdBenchmarkScene を使うシナリオか(crowd-gpu は GpuMover で動かす)
+     */
+    static bool IsCrowdScenario(const std::string& name) {
+        return name == "crowd" || name == "crowd-gpu";
+    }
+
+    /**
+     * @brief crowd の箱の半径(XZ 平面、エンティティ数から密度が一定になるように決める)
+     */
+    float CrowdExtent() const {
+        const float area = static_cast<float>(entities) / CROWD_DENSITY;
+        return (std::max)(std::sqrt(area) * 0.5f, 10.0f);
+    }
+
+    /**
+     * @brief render シナリオの RenderBenchmarkScene の設定(プリミティブの数を entities にする)
+     */
+    RenderBenchmarkConfig RenderConfig() const {
+        RenderBenchmarkConfig config;
+        config.meshCount = entities;
+        config.lineCount = 0;
+        config.frames = frames;
+        config.warmupFrames = warmupFrames;
+        return config;
+    }
+};
+
+/**
+ * @class ScenarioBenchmark
+ * @brief シナリオのカメラと、フレームごとの分布・描画の統計の集計、結果の追記
+ *
+ * @par 使用例(App のメインループ)
+ * @code
+ * bench.ApplyCamera(camera);                       // 描画の前
+ * // ... 1 固定ステップ / Render / Present ...
+ * if (bench.Record(totalSec, updateSec, renderSec, presentSec, gpuSec, renderer.GetStatistics())) {
+ *     bench.WriteResults(worldStats);               // CSV に1行追記
+ *     PostQuitMessage(0);
+ * }
+ * @endcode
+ */
+class ScenarioBenchmark {
+public:
+    explicit ScenarioBenchmark(const ScenarioBenchmarkConfig& config) : config_(config) {}
+
+    const ScenarioBenchmarkConfig& Config() const { return config_; }
+
+    /**
+     * @brief シナリオの視点をカメラに設定(render は周回、crowd は箱全体を斜め上から見下ろす、game は変更しない)
+     */
+    void ApplyCamera(Camera& camera) const {
+        if (config_.scenario == "render") {
+            RenderBenchmark::OrbitCamera(camera, config_.RenderConfig(), (std::max)(0, frame_ - config_.warmupFrames));
+        } else if (IsCrowdScenario(config_.scenario)) {
+            const float extent = config_.CrowdExtent();
+            camera.position = DirectX::XMFLOAT3{ 0.0f, extent * 1.2f, -extent * 1.4f };
+            camera.target = DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f };
+            camera.up = DirectX::XMFLOAT3{ 0.0f, 1.0f, 0.0f };
+            const float farZ = extent * 4.0f;
+            if (camera.farZ != farZ) {
+                camera.farZ = farZ;
+                camera.Proj = DirectX::XMMatrixPerspectiveFovLH(camera.fovY, camera.aspect, camera.nearZ, camera.farZ);
+            }
+            camera.Update();
+        }
+    }
+
+    /**
+     * @brief 1フレーム分の結果を記録(時間はすべて秒)
+     * @return bool ウォームアップの後に config.frames フレームを記録した場合 true(呼び出し側で WriteResults() して終了する)
+     */
+    bool Record(float totalSec, float updateSec, float renderSec, float presentSec, float gpuSec,
+                const RenderSystem::Statistics& stats) {
+        if (finished_) return true;
+        const int frame = frame_++;
+        if (frame < config_.warmupFrames) return false;
+
+        total_.RecordSeconds(totalSec);
+        update_.RecordSeconds(updateSec);
+        render_.RecordSeconds(renderSec);
+        present_.RecordSeconds(presentSec);
+        if (gpuSec > 0.0f) gpu_.RecordSeconds(gpuSec);
+        if (samples_[0].empty()) {
+            for (std::vector<double>& samples : samples_) samples.reserve(static_cast<size_t>(config_.frames));
+        }
+        double renderCpuMs = 0.0;
+        for (float passMs : stats.passMs) renderCpuMs += passMs;
+        samples_[0].push_back(totalSec * 1000.0);
+        samples_[1].push_back(updateSec * 1000.0);
+        samples_[2].push_back(renderCpuMs);
+        if (gpuSec > 0.0f) samples_[3].push_back(gpuSec * 1000.0);
+
+        drawCalls_ += static_cast<double>(stats.totalDrawCalls);
+        instancedDraws_ += static_cast<double>(stats.instancedDraws);
+        triangles_ += static_cast<double>(stats.trianglesRendered);
+        stateChanges_ += static_cast<double>(stats.stateChanges);
+        textureBinds_ += static_cast<double>(stats.textureBinds);
+        constantBufferBytes_ += static_cast<double>(stats.constantBufferBytes);
+        culled_ += static_cast<double>(stats.culled);
+        for (uint32_t p = 0; p < RenderSystem::Statistics::PASS_COUNT; ++p) passMs_[p] += stats.passMs[p];
+
+        if (static_cast<int>(total_.Count()) < config_.frames) return false;
+        finished_ = true;
+        return true;
+    }
+
+    bool IsFinished() const { return finished_; }
+
+    /**
+     * @brief 集計と World の統計を CSV に1行追記(ファイルが空ならヘッダーも書く)
+     * @return bool 書き込めた場合 true
+     */
+    bool WriteResults(const WorldStats& world) const {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, config_.outputPath.c_str(), "a") != 0 || !fp) {
+            DEBUGLOG_ERROR("[Bench] " + config_.outputPath + " を開けません");
+            return false;
+        }
+        using Stats = RenderSystem::Statistics;
+        std::fseek(fp, 0, SEEK_END);
+        if (std::ftell(fp) == 0) {
+            std::fprintf(fp, "date,build,scenario,entities,seed,frames,"
+                             "frame_mean_ms,frame_p50_ms,frame_p99_ms,frame_max_ms,fps_mean,fps_1pct_low,"
+                             "update_p50_ms,update_p99_ms,render_p50_ms,render_p99_ms,present_p50_ms,present_p99_ms,gpu_p50_ms,gpu_p99_ms,"
+                             "alive,max_alive,total_created,total_destroyed,behaviours,stores,ecs_bytes,"
+                             "draw_calls,instanced_draws,triangles,state_changes,texture_binds,constant_buffer_bytes,culled");
+            for (uint32_t p = 0; p < Stats::PASS_COUNT; ++p) std::fprintf(fp, ",%s_ms", Stats::PassName(p));
+            std::fprintf(fp, "\n");
+        }
+
+        char date[32] = {};
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+        if (localtime_s(&local, &now) == 0) std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &local);
+#ifdef _DEBUG
+        const char* build = "Debug";
+#else
+        const char* build = "Release";
+#endif
+        const double n = static_cast<double>((std::max)<uint64_t>(total_.Count(), 1));
+        auto ms = [](const FrameHistogram& h, double percentile) { return h.PercentileSeconds(percentile) * 1000.0f; };
+        auto fps = [](float seconds) { return seconds > 0.0f ? 1.0f / seconds : 0.0f; };
+
+        std::fprintf(fp, "%s,%s,%s,%zu,%llu,%llu,", date, build, config_.scenario.c_str(), config_.entities,
+                     static_cast<unsigned long long>(config_.seed), static_cast<unsigned long long>(total_.Count()));
+        std::fprintf(fp, "%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,", total_.MeanSeconds() * 1000.0f, ms(total_, 50.0), ms(total_, 99.0),
+                     total_.MaxSeconds() * 1000.0f, fps(total_.MeanSeconds()), fps(total_.PercentileSeconds(99.0)));
+        std::fprintf(fp, "%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,", ms(update_, 50.0), ms(update_, 99.0), ms(render_, 50.0),
+                     ms(render_, 99.0), ms(present_, 50.0), ms(present_, 99.0), ms(gpu_, 50.0), ms(gpu_, 99.0));
+        std::fprintf(fp, "%zu,%zu,%llu,%llu,%zu,%zu,%zu,", world.alive, world.maxAlive,
+                     static_cast<unsigned long long>(world.totalCreated), static_cast<unsigned long long>(world.totalDestroyed),
+                     world.behaviours, world.stores, world.EstimatedBytes());
+        std::fprintf(fp, "%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f", drawCalls_ / n, instancedDraws_ / n, triangles_ / n,
+                     stateChanges_ / n, textureBinds_ / n, constantBufferBytes_ / n, culled_ / n);
+        for (double passMs : passMs_) std::fprintf(fp, ",%.4f", passMs / n);
+        std::fprintf(fp, "\n");
+        std::fclose(fp);
+
+        char line[256];
+        sprintf_s(line, "[Bench] %s entities=%zu seed=%llu, %llu フレーム: 平均 %.3fms p99 %.3fms, Update p50 %.3fms p99 %.3fms",
+                  config_.scenario.c_str(), config_.entities, static_cast<unsigned long long>(config_.seed),
+                  static_cast<unsigned long long>(total_.Count()), total_.MeanSeconds() * 1000.0f, ms(total_, 99.0),
+                  ms(update_, 50.0), ms(update_, 99.0));
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, line);
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[Bench] 結果を " + config_.outputPath + " に追記しました");
+        WriteHistory();
+        return true;
+    }
+
+    /**
+     * @brief フレームごとの値を BenchmarkHistory に追記(suite は scenario/<シナリオ>/<エンティティ数>)
+     */
+    bool WriteHistory() const {
+        if (config_.historyPath == "none") return true;
+        static const char* const METRICS[SAMPLE_KINDS] = {
+            "frame/total_ms", "World::Tick/update_ms", "RenderSystem::Render/cpu_ms", "RenderSystem::Render/gpu_ms"
+        };
+        const std::string suite = "scenario/" + config_.scenario + "/" + std::to_string(config_.entities);
+        std::vector<BenchmarkRecord> records;
+        for (size_t k = 0; k < SAMPLE_KINDS; ++k) records.push_back(BenchmarkHistory::MakeRecord(suite, METRICS[k], samples_[k]));
+        if (!BenchmarkHistory::Append(config_.historyPath, records)) {
+            DEBUGLOG_ERROR("[Bench] " + config_.historyPath + " を開けません");
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[Bench] フレームごとの値を " + config_.historyPath + " に追記しました (commit " +
+                          records.front().commit + ")");
+        return true;
+    }
+
+private:
+    static constexpr size_t SAMPLE_KINDS = 4; ///< 履歴に残す値(フレーム・Update・Render の CPU・GPU)
+
+    ScenarioBenchmarkConfig config_;
+    FrameHistogram total_;     ///< フレーム合計時間(ウォームアップ後)
+    FrameHistogram update_;    ///< Update時間
+    FrameHistogram render_;    ///< Render時間
+    FrameHistogram present_;   ///< Present時間
+    FrameHistogram gpu_;       ///< GPU時間(計測できたフレームのみ)
+    std::vector<double> samples_[SAMPLE_KINDS]; ///< 履歴に残すフレームごとの値(ミリ秒、GPU は計測できたフレームのみ)
+    double drawCalls_ = 0.0;   ///< 描画の統計の合計(書き出し時にフレーム数で割る)
+    double instancedDraws_ = 0.0;
+    double triangles_ = 0.0;
+    double stateChanges_ = 0.0;
+    double textureBinds_ = 0.0;
+    double constantBufferBytes_ = 0.0;
+    double culled_ = 0.0;
+    double passMs_[RenderSystem::Statistics::PASS_COUNT] = {};
+    int frame_ = 0;            ///< Record() を呼んだ回数(ウォームアップを含む)
+    bool finished_ = false;
+};
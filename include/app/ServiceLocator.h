@@ -1,7 +1,9 @@
 #pragma once
 #include <memory>
-#include <unordered_map>
-#include <typeindex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
 #include "app/DebugLog.h"
 
 /**
@@ -15,6 +17,10 @@
  * GfxDeviceやTextureManagerなどのグローバルなサービス（オブジェクト）を登録し、
  * アプリケーションのどこからでも静的にアクセスできるようにします。
  * これにより、オブジェクトを関数の引数で引き回す必要がなくなります。
+ *
+ * サービスは型ごとの静的な変数(Slot<T>::service)に保持するため、Get() はポインタを1回読むだけです
+ * (毎フレーム・エンティティごとに呼んでも検索はありません)。null の登録や別のインスタンスでの上書きは
+ * Register() の時点で検出します。登録はメインスレッドで、取得を始める前(初期化中)に行ってください。
  */
 
 class ServiceLocator {
@@ -26,12 +32,19 @@ public:
      */
     template<typename T>
     static void Register(T* service) {
-        if (service) {
-            DEBUGLOG("Service registered: " + std::string(typeid(T).name()));
-            services_[typeid(T)] = service;
-        } else {
+        if (!service) {
             DEBUGLOG_WARNING("Attempted to register a null service: " + std::string(typeid(T).name()));
+            return;
         }
+        if (Slot<T>::service && Slot<T>::service != service) {
+            DEBUGLOG_WARNING("Service replaced by another instance: " + std::string(typeid(T).name()));
+        }
+        if (!Slot<T>::registered) {
+            Slot<T>::registered = true;
+            resetters_.push_back(&Slot<T>::Reset);
+        }
+        DEBUGLOG("Service registered: " + std::string(typeid(T).name()));
+        Slot<T>::service = service;
     }
 
     /**
@@ -42,13 +55,17 @@ public:
      */
     template<typename T>
     static T& Get() {
-        auto it = services_.find(typeid(T));
-        if (it == services_.end() || it->second == nullptr) {
-            std::string errorMsg = "Service not found or is null: " + std::string(typeid(T).name());
-            DEBUGLOG_ERROR(errorMsg);
-            throw std::runtime_error(errorMsg.c_str());
-        }
-        return *static_cast<T*>(it->second);
+        T* service = Slot<T>::service;
+        if (!service) NotFound(typeid(T).name());
+        return *service;
+    }
+
+    /**
+     * @brief 登録されたサービスを取得します（登録されていない場合は nullptr）。
+     */
+    template<typename T>
+    static T* TryGet() {
+        return Slot<T>::service;
     }
 
     /**
@@ -57,10 +74,26 @@ public:
      */
     static void Shutdown() {
         DEBUGLOG("ServiceLocator shutting down.");
-        services_.clear();
+        for (void (*reset)() : resetters_) reset();
     }
 
 private:
-    // 型情報とサービスへのポインタをマッピング
-    inline static std::unordered_map<std::type_index, void*> services_;
+    /**
+     * @brief 型ごとのサービスへのポインタ
+     */
+    template<typename T>
+    struct Slot {
+        inline static T* service = nullptr;
+        inline static bool registered = false;  ///< resetters_ に追加済みか
+        static void Reset() { service = nullptr; }
+    };
+
+    [[noreturn]] static void NotFound(const char* typeName) {
+        std::string errorMsg = "Service not found or is null: " + std::string(typeName);
+        DEBUGLOG_ERROR(errorMsg);
+        throw std::runtime_error(errorMsg.c_str());
+    }
+
+    // Shutdown() でクリアするスロット(登録された型ごとに1つ)
+    inline static std::vector<void (*)()> resetters_;
 };
@@ -0,0 +1,140 @@
+/**
+ * @file SimulationThread.h
+ * @brief 1件ずつ処理を投入して完了を待つ専用スレッド(並列シミュレーション用)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * App がシミュレーション(入力・シーン更新・World::Tick)を描画と並行して進めるために使います。
+ * JobSystem のワーカーではなく専用のスレッドで実行するため、描画側の JobSystem::Wait() が
+ * シミュレーション全体を横取りして実行することはありません。
+ * シミュレーション中の ParallelForEach は通常どおり JobSystem に分割を投入します。
+ */
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "app/DebugLog.h"
+#include "app/FrameArena.h"
+#include "app/ThreadPlacement.h"
+
+/**
+ * @class SimulationThread
+ * @brief 投入した処理を別スレッドで1件ずつ実行する
+ *
+ * @par 使用例
+ * @code
+ * SimulationThread sim;
+ * sim.Start();
+ *
+ * sim.Kick([&]() { world.Tick(dt); }); // 描画と並行して実行
+ * // ... 描画 ...
+ * sim.Wait();                          // 次に World に触れる前に完了を待つ
+ *
+ * sim.Stop();
+ * @endcode
+ *
+ * @note 前の処理が終わる前に Kick() を呼ぶと、先に完了を待ちます
+ */
+class SimulationThread {
+public:
+    SimulationThread() = default;
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    ~SimulationThread() { Stop(); }
+
+    /**
+     * @brief スレッドを起動
+     * @return bool 起動できた場合 true(失敗時は Kick() が呼び出しスレッドで即時実行する)
+     */
+    bool Start() {
+        if (thread_.joinable()) return true;
+        stopping_ = false;
+        try {
+            thread_ = std::thread([this]() { threadLoop(); });
+        } catch (const std::exception& e) {
+            DEBUGLOG_ERROR(std::string("[SimulationThread] スレッドの起動失敗: ") + e.what());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 実行中の処理を待ってスレッドを終了
+     */
+    void Stop() {
+        if (!thread_.joinable()) return;
+        Wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    bool IsRunning() const { return thread_.joinable(); }
+
+    /**
+     * @brief 処理を投入(スレッドが起動していない場合はこの場で実行)
+     */
+    void Kick(std::function<void()> task) {
+        if (!thread_.joinable()) {
+            task();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !busy_; });
+        task_ = std::move(task);
+        busy_ = true;
+        lock.unlock();
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief 投入した処理の完了を待つ(何も投入していなければすぐ戻る)
+     */
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !busy_; });
+    }
+
+    /**
+     * @brief 処理を実行中か
+     */
+    bool IsBusy() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return busy_;
+    }
+
+private:
+    void threadLoop() {
+        ThreadPlacement::GetInstance().ApplyCurrent(ThreadRole::Simulation);
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this]() { return busy_ || stopping_; });
+            if (!busy_) return; // stopping_ かつ処理なし
+            std::function<void()> task = std::move(task_);
+            lock.unlock();
+            try {
+                task();
+            } catch (const std::exception& e) {
+                DEBUGLOG_ERROR(std::string("[SimulationThread] 処理中に例外が発生: ") + e.what());
+            }
+            FrameArena::ForThread().Reset(); // 投入1件がこのスレッドのフレーム
+            lock.lock();
+            busy_ = false;
+            cv_.notify_all();
+        }
+    }
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_; ///< 投入・完了・終了の通知(待ち手は少ないため1つで兼用)
+    std::function<void()> task_; ///< 次に実行する処理
+    bool busy_ = false;          ///< 投入から完了まで true
+    bool stopping_ = false;      ///< Stop() が呼ばれた
+};
@@ -0,0 +1,224 @@
+/**
+ * @file StartupReport.h
+ * @brief WinMain から最初の Present までの起動時間の内訳(リリースビルドでも有効)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * WinMain の先頭で Begin() を呼び、起動の各段階を Scope で囲んで計測します。
+ * 最初の Present の後に MarkFirstPresent() を呼ぶと、起動1回分の行を startup_report.csv に追記します。
+ * 起動のたびに同じファイルへ追記するため、リリースごとの起動時間の変化をそのまま比較できます。
+ *
+ * CSV の列は launch,build,phase,depth,thread,start_ms,duration_ms です。
+ * - launch: Begin() を呼んだ日時(同じ起動の行で共通)
+ * - depth: Scope の入れ子の深さ(スレッドごと、0 が最上位)
+ * - thread: Begin() を呼んだスレッドなら main、それ以外は worker
+ * - start_ms: Begin() からの時刻
+ * 先頭の Process 行はプロセスの作成から WinMain までの時間(start_ms は負)、最後の FirstPresent 行は全体の時間です。
+ *
+ * 記録は mutex で保護するためどのスレッドからでも使えます。MarkFirstPresent() の後の Scope は何もしません。
+ */
+#pragma once
+#include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class StartupReport
+ * @brief 起動時の段階ごとの時間の記録と CSV への追記
+ *
+ * @par 使用例
+ * @code
+ * // WinMain の先頭
+ * StartupReport::GetInstance().Begin();
+ *
+ * // 計測する段階
+ * {
+ *     StartupReport::Scope scope("RenderSystem.CompileShaders");
+ *     CompileShaders(gfx);
+ * }
+ *
+ * // 最初の Present の後
+ * StartupReport::GetInstance().MarkFirstPresent();
+ * @endcode
+ */
+class StartupReport {
+public:
+    static StartupReport& GetInstance() {
+        static StartupReport instance;
+        return instance;
+    }
+
+    /**
+     * @brief 書き出し先(作業ディレクトリからの相対パス)
+     */
+    static const char* Path() { return "startup_report.csv"; }
+
+    /**
+     * @class Scope
+     * @brief 生存期間を1つの段階として記録する
+     */
+    class Scope {
+    public:
+        /**
+         * @param[in] name 段階の名前(文字列リテラルなど、書き出しまで有効なもの)
+         */
+        explicit Scope(const char* name) : name_(name) {
+            StartupReport& report = GetInstance();
+            active_ = report.IsRecording();
+            if (!active_) return;
+            depth_ = threadDepth()++;
+            startMs_ = report.ElapsedMs();
+        }
+
+        ~Scope() { End(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief スコープの終わりより前に記録を終える(2回目以降は何もしない)
+         */
+        void End() {
+            if (!active_) return;
+            active_ = false;
+            --threadDepth();
+            StartupReport& report = GetInstance();
+            report.add(name_, depth_, startMs_, report.ElapsedMs() - startMs_);
+        }
+
+    private:
+        const char* name_;
+        double startMs_ = 0.0;
+        uint32_t depth_ = 0;
+        bool active_ = false;
+    };
+
+    /**
+     * @brief 計測の起点(WinMain の先頭で1回呼ぶ)
+     *
+     * @details
+     * プロセスの作成時刻(GetProcessTimes)から現在までを Process として記録します。
+     */
+    void Begin() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        origin_ = std::chrono::steady_clock::now();
+        mainThread_ = std::this_thread::get_id();
+        phases_.clear();
+        recording_ = true;
+
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+        if (localtime_s(&local, &now) == 0) {
+            std::strftime(launch_, sizeof(launch_), "%Y-%m-%d %H:%M:%S", &local);
+        }
+
+        FILETIME creation{}, exitTime{}, kernel{}, user{}, current{};
+        if (GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+            GetSystemTimePreciseAsFileTime(&current);
+            const double beforeMs = static_cast<double>(toTicks(current) - toTicks(creation)) / 10000.0; // 100ns 単位
+            if (beforeMs >= 0.0) {
+                phases_.push_back(Phase{ "Process", 0, true, -beforeMs, beforeMs });
+            }
+        }
+    }
+
+    bool IsRecording() const { return recording_; }
+
+    /**
+     * @brief Begin() からの経過時間(ミリ秒)
+     */
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin_).count();
+    }
+
+    /**
+     * @brief 最初の Present の後に呼び、起動1回分を CSV に追記して記録を終える(2回目以降は何もしない)
+     * @return bool 書き出せた場合 true
+     */
+    bool MarkFirstPresent() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!recording_) return false;
+        recording_ = false;
+        totalMs_ = ElapsedMs();
+        return write();
+    }
+
+    /**
+     * @brief WinMain から最初の Present までの時間(ミリ秒、MarkFirstPresent() の前は 0)
+     */
+    double TotalMs() const { return totalMs_; }
+
+private:
+    /**
+     * @struct Phase
+     * @brief 記録した1段階
+     */
+    struct Phase {
+        const char* name;
+        uint32_t depth;
+        bool mainThread;
+        double startMs;
+        double durationMs;
+    };
+
+    StartupReport() = default;
+
+    static uint32_t& threadDepth() {
+        thread_local uint32_t depth = 0;
+        return depth;
+    }
+
+    static uint64_t toTicks(const FILETIME& t) {
+        return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+    }
+
+    void add(const char* name, uint32_t depth, double startMs, double durationMs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!recording_) return;
+        phases_.push_back(Phase{ name, depth, std::this_thread::get_id() == mainThread_, startMs, durationMs });
+    }
+
+    // 起動1回分を追記(新しいファイルならヘッダー行も書く)
+    bool write() const {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, Path(), "ab") != 0 || !fp) return false;
+        fseek(fp, 0, SEEK_END);
+        if (ftell(fp) == 0) {
+            fputs("launch,build,phase,depth,thread,start_ms,duration_ms\n", fp);
+        }
+
+#ifdef _DEBUG
+        const char* build = "Debug";
+#else
+        const char* build = "Release";
+#endif
+        // 記録は終わった順のため、開始の順に並べ替える(入れ子の親が子より先)
+        std::vector<Phase> phases = phases_;
+        std::stable_sort(phases.begin(), phases.end(), [](const Phase& a, const Phase& b) {
+            return a.startMs < b.startMs || (a.startMs == b.startMs && a.depth < b.depth);
+        });
+        phases.push_back(Phase{ "FirstPresent", 0, true, 0.0, totalMs_ });
+        for (const Phase& phase : phases) {
+            fprintf(fp, "%s,%s,%s,%u,%s,%.3f,%.3f\n", launch_, build, phase.name, phase.depth,
+                    phase.mainThread ? "main" : "worker", phase.startMs, phase.durationMs);
+        }
+        return fclose(fp) == 0;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+    std::chrono::steady_clock::time_point origin_ = std::chrono::steady_clock::now();
+    std::thread::id mainThread_;
+    char launch_[32] = "unknown";   ///< Begin() の日時
+    double totalMs_ = 0.0;
+    std::atomic<bool> recording_{ false };
+};
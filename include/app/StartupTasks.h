@@ -0,0 +1,254 @@
+/**
+ * @file StartupTasks.h
+ * @brief 依存関係のある起動時の初期化ステップを並列に実行するタスクグラフ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ステップは名前・実行するスレッド・依存するステップ(先に追加したもの)を指定して追加します。
+ * 依存がすべて終わったステップから開始し、Worker のステップは JobSystem のワーカーに投入、
+ * Main のステップ(ウィンドウ・即時コンテキスト・スレッドに紐づくAPIを使うもの)は Run() を呼んだスレッドで実行します。
+ * メインスレッドは実行できるステップがない間だけ、ワーカーのステップの完了を待ちます。
+ *
+ * ステップごとに開始時刻と所要時間をログに出し、最後に全体の時間と各ステップの合計(逐次に実行した場合の目安)を出します。
+ * 各ステップは StartupReport にもステップ名の段階として記録します。
+ * 必須のステップが失敗すると、まだ開始していないステップは実行せず、実行中のワーカーのステップを待ってから false を返します。
+ * 任意のステップの失敗は警告だけで、依存するステップはそのまま実行します。
+ */
+#pragma once
+#include "app/JobSystem.h"
+#include "app/DebugLog.h"
+#include "app/StartupReport.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class StartupTasks
+ * @brief 起動時の初期化ステップの依存グラフ
+ *
+ * @par 使用例
+ * @code
+ * StartupTasks startup;
+ * const auto window = startup.Add("Window", StartupTasks::Thread::Main, [&]() { return CreateAppWindow(); });
+ * const auto media = startup.Add("MediaFoundation", StartupTasks::Thread::Worker, [&]() { return StartMedia(); }, {}, false);
+ * startup.Add("Graphics", StartupTasks::Thread::Main, [&]() { return InitializeGraphics(); }, { window });
+ * if (!startup.Run(&jobs)) return false;
+ * @endcode
+ */
+class StartupTasks {
+public:
+    using TaskId = uint32_t;
+
+    /**
+     * @enum Thread
+     * @brief ステップを実行するスレッド
+     */
+    enum class Thread {
+        Main,   ///< Run() を呼んだスレッド
+        Worker, ///< JobSystem のワーカー(ジョブシステムがない場合は Main と同じ)
+    };
+
+    /**
+     * @brief ステップを追加
+     * @param[in] name ログに出す名前(文字列リテラルなど、Run() が終わるまで有効なもの)
+     * @param[in] thread 実行するスレッド
+     * @param[in] fn 実行する関数(成功した場合 true)
+     * @param[in] dependencies 先に終わっている必要のあるステップ(このステップより前に追加したもの)
+     * @param[in] required 失敗したら起動を中止するか
+     * @return TaskId 追加したステップ(依存の指定に使う)
+     */
+    TaskId Add(const char* name, Thread thread, std::function<bool()> fn,
+               std::initializer_list<TaskId> dependencies = {}, bool required = true) {
+        const TaskId id = static_cast<TaskId>(tasks_.size());
+        Task task;
+        task.name = name;
+        task.thread = thread;
+        task.fn = std::move(fn);
+        task.required = required;
+        for (TaskId dependency : dependencies) {
+            if (dependency >= id) {
+                DEBUGLOG_WARNING(std::string("[Startup] 後から追加したステップには依存できません: ") + name);
+                continue;
+            }
+            ++task.remaining;
+            tasks_[dependency].dependents.push_back(id);
+        }
+        tasks_.push_back(std::move(task));
+        return id;
+    }
+
+    /**
+     * @brief すべてのステップを実行
+     * @param[in] jobs ワーカーのステップを投入するジョブシステム(nullptr または未初期化なら全て呼び出しスレッドで実行)
+     * @return bool 必須のステップがすべて成功した場合 true
+     */
+    bool Run(JobSystem* jobs) {
+        const bool parallel = jobs && jobs->IsRunning();
+        start_ = std::chrono::steady_clock::now();
+        finished_ = 0;
+        running_ = 0;
+        failed_ = false;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            // 始められるステップを集める(ワーカーのものは投入し、メインのものは1つずつ実行)
+            std::vector<TaskId> submit;
+            TaskId mainTask = INVALID;
+            for (TaskId id = 0; id < tasks_.size(); ++id) {
+                Task& task = tasks_[id];
+                if (task.state != State::Pending || task.remaining > 0) continue;
+                if (failed_) {
+                    // 依存するステップ(後ろにある)も同じ走査でスキップされる
+                    task.state = State::Skipped;
+                    ++finished_;
+                    for (TaskId dependent : task.dependents) {
+                        --tasks_[dependent].remaining;
+                    }
+                    continue;
+                }
+                if (parallel && task.thread == Thread::Worker) {
+                    task.state = State::Running;
+                    ++running_;
+                    submit.push_back(id);
+                } else if (mainTask == INVALID) {
+                    mainTask = id;
+                }
+            }
+            if (finished_ == tasks_.size()) break;
+
+            if (!submit.empty() || mainTask != INVALID) {
+                if (mainTask != INVALID) {
+                    tasks_[mainTask].state = State::Running;
+                    ++running_;
+                }
+                lock.unlock();
+                for (TaskId id : submit) {
+                    jobs->Submit([this, id]() { execute(id); });
+                }
+                if (mainTask != INVALID) execute(mainTask);
+                lock.lock();
+                continue;
+            }
+
+            if (running_ == 0) {
+                // 依存が満たされないステップが残った(追加の誤り)
+                DEBUGLOG_ERROR("[Startup] 開始できないステップが残っています");
+                failed_ = true;
+                break;
+            }
+            doneCv_.wait(lock);
+        }
+        lock.unlock();
+
+        logSummary();
+        return !failed_;
+    }
+
+    /**
+     * @brief ステップの所要時間(ミリ秒、実行していない場合は負)
+     */
+    double TaskMs(TaskId id) const {
+        if (id >= tasks_.size() || tasks_[id].endMs < 0.0) return -1.0;
+        return tasks_[id].endMs - tasks_[id].startMs;
+    }
+
+    /**
+     * @brief 直近の Run() の全体の時間(ミリ秒)
+     */
+    double TotalMs() const { return totalMs_; }
+
+private:
+    static constexpr TaskId INVALID = ~TaskId(0);
+
+    enum class State { Pending, Running, Done, Skipped };
+
+    struct Task {
+        const char* name = "";
+        Thread thread = Thread::Main;
+        std::function<bool()> fn;
+        std::vector<TaskId> dependents;
+        uint32_t remaining = 0;   ///< 終わっていない依存の数
+        bool required = true;
+        bool succeeded = false;
+        State state = State::Pending;
+        double startMs = -1.0;    ///< Run() の開始からの時刻
+        double endMs = -1.0;
+    };
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    // ステップを実行して依存するステップの待ち数を減らす(ロックを持たずに呼ぶ)
+    void execute(TaskId id) {
+        Task& task = tasks_[id];
+        task.startMs = elapsedMs();
+        bool ok = false;
+        StartupReport::Scope scope(task.name);
+        try {
+            ok = task.fn();
+        } catch (const std::exception& ex) {
+            DEBUGLOG_ERROR(std::string("[Startup] ") + task.name + " で例外: " + ex.what());
+        } catch (...) {
+            DEBUGLOG_ERROR(std::string("[Startup] ") + task.name + " で不明な例外");
+        }
+        task.endMs = elapsedMs();
+        task.succeeded = ok;
+        scope.End();
+
+        const bool worker = JobSystem::IsWorkerThread();
+        char line[256];
+        sprintf_s(line, "[Startup] %s: %.1f ms (開始 +%.1f ms, %s)%s", task.name, task.endMs - task.startMs, task.startMs,
+                  worker ? "ワーカー" : "メインスレッド", ok ? "" : " 失敗");
+        if (ok) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::System, line);
+        } else if (task.required) {
+            DEBUGLOG_ERROR(line);
+        } else {
+            DEBUGLOG_WARNING(line);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task.state = State::Done;
+            if (!ok && task.required) failed_ = true;
+            for (TaskId dependent : task.dependents) {
+                --tasks_[dependent].remaining;
+            }
+            --running_;
+            ++finished_;
+        }
+        doneCv_.notify_all();
+    }
+
+    void logSummary() {
+        totalMs_ = elapsedMs();
+        double serialMs = 0.0;
+        for (const Task& task : tasks_) {
+            if (task.endMs >= 0.0) serialMs += task.endMs - task.startMs;
+        }
+        char line[256];
+        sprintf_s(line, "[Startup] 合計 %.1f ms (ステップの合計 %.1f ms, %zu ステップ)%s", totalMs_, serialMs, tasks_.size(),
+                  failed_ ? " 中止" : "");
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, line);
+    }
+
+    std::vector<Task> tasks_;
+    std::mutex mutex_;
+    std::condition_variable doneCv_;
+    std::chrono::steady_clock::time_point start_;
+    size_t finished_ = 0;     ///< 終わった(またはスキップした)ステップの数
+    uint32_t running_ = 0;    ///< 実行中のステップの数
+    bool failed_ = false;     ///< 必須のステップが失敗したか
+    double totalMs_ = 0.0;
+};
@@ -0,0 +1,277 @@
+/**
+ * @file Telemetry.h
+ * @brief リリースビルドでも有効な軽量テレメトリ(カウンタ・ゲージ・ヒストグラム)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * DEBUGLOG はリリースビルドで消えるため、実行中の性能を後から確認する手段として
+ * _DEBUG に関係なく組み込まれる計測チャンネルを用意します。
+ * 値の記録はアトミック操作だけで行い(どのスレッドからでも可、ロックなし)、
+ * Update() が FlushInterval() ごとに CSV の行としてまとめてファイルへ書き出します。
+ *
+ * CSV の列は time_s,kind,name,count,value,mean,p50,p90,p99,max です。
+ * - counter: value は累計
+ * - gauge: value は最後に設定した値
+ * - histogram: 前回の書き出しからの区間の count / mean / 百分位 / max(書き出すたびにリセット)
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+/**
+ * @class Telemetry
+ * @brief 名前付きメトリクスの記録と定期的な CSV 書き出し
+ *
+ * @par 使用例
+ * @code
+ * Telemetry& t = Telemetry::GetInstance();
+ * t.Open("telemetry.csv");
+ * Telemetry::MetricId frameMs = t.RegisterHistogram("frame_ms");
+ *
+ * // 毎フレーム
+ * t.Record(frameMs, dt * 1000.0f);
+ * t.Update();
+ *
+ * // 終了時
+ * t.Close();
+ * @endcode
+ */
+class Telemetry {
+public:
+    using MetricId = uint32_t;
+
+    static constexpr MetricId INVALID_METRIC = 0xFFFFFFFFu; ///< 登録できなかった場合の値(記録は何もしない)
+    static constexpr uint32_t MAX_METRICS = 64;            ///< 登録できるメトリクスの上限
+    static constexpr uint32_t HISTOGRAM_BUCKETS = 64;       ///< ヒストグラムの区間数(2の累乗を4分割、1/16 から 4096 まで)
+
+    /**
+     * @enum Kind
+     * @brief メトリクスの種類
+     */
+    enum class Kind : uint8_t {
+        Counter,   ///< 加算のみの累計
+        Gauge,     ///< 最後に設定した値
+        Histogram  ///< 値の分布(区間ごと)
+    };
+
+    static Telemetry& GetInstance() {
+        static Telemetry instance;
+        return instance;
+    }
+
+    /**
+     * @brief 書き出し先を開く(ヘッダー行を書く)
+     * @return bool 開けた場合 true(失敗時は記録だけ行い、書き出さない)
+     */
+    bool Open(const char* path) {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        closeFile();
+        if (fopen_s(&file_, path, "wb") != 0 || !file_) {
+            file_ = nullptr;
+            return false;
+        }
+        fputs("time_s,kind,name,count,value,mean,p50,p90,p99,max\n", file_);
+        lastFlush_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    /**
+     * @brief 最後の区間を書き出して閉じる
+     */
+    void Close() {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (file_) writeRows();
+        closeFile();
+    }
+
+    bool IsOpen() const { return file_ != nullptr; }
+
+    /**
+     * @brief 書き出す間隔(秒、既定は5秒)
+     */
+    void SetFlushInterval(float seconds) { flushInterval_ = seconds > 0.1f ? seconds : 0.1f; }
+    float FlushInterval() const { return flushInterval_; }
+
+    MetricId RegisterCounter(const char* name) { return registerMetric(name, Kind::Counter); }
+    MetricId RegisterGauge(const char* name) { return registerMetric(name, Kind::Gauge); }
+    MetricId RegisterHistogram(const char* name) { return registerMetric(name, Kind::Histogram); }
+
+    /**
+     * @brief カウンタに加算
+     */
+    void Add(MetricId id, uint64_t amount = 1) {
+        if (id >= MAX_METRICS) return;
+        metrics_[id].count.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief ゲージの値を設定
+     */
+    void Set(MetricId id, double value) {
+        if (id >= MAX_METRICS) return;
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        metrics_[id].value.store(bits, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief ヒストグラムに値を追加(負の値は 0 として扱う)
+     */
+    void Record(MetricId id, float value) {
+        if (id >= MAX_METRICS) return;
+        Metric& m = metrics_[id];
+        if (!(value > 0.0f)) value = 0.0f;
+        m.buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        m.count.fetch_add(1, std::memory_order_relaxed);
+        m.value.fetch_add(static_cast<uint64_t>(value * 1000.0f), std::memory_order_relaxed); // 合計(1/1000単位)
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits)); // 正の float はビット列の大小が値の大小と一致する
+        uint32_t prev = m.maxBits.load(std::memory_order_relaxed);
+        while (bits > prev && !m.maxBits.compare_exchange_weak(prev, bits, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief 間隔が経過していれば書き出す(メインループから毎フレーム呼ぶ)
+     */
+    void Update() {
+        if (!file_) return;
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - lastFlush_).count() < flushInterval_) return;
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (!file_) return;
+        lastFlush_ = now;
+        writeRows();
+    }
+
+private:
+    struct Metric {
+        const char* name = nullptr;
+        Kind kind = Kind::Counter;
+        std::atomic<uint64_t> count{ 0 };   ///< カウンタの累計 / ヒストグラムの区間の件数
+        std::atomic<uint64_t> value{ 0 };   ///< ゲージの double のビット列 / ヒストグラムの区間の合計(1/1000単位)
+        std::atomic<uint32_t> maxBits{ 0 }; ///< ヒストグラムの区間の最大値(float のビット列)
+        std::atomic<uint32_t> buckets[HISTOGRAM_BUCKETS];
+    };
+
+    Telemetry() : origin_(std::chrono::steady_clock::now()), lastFlush_(origin_) {
+        for (Metric& m : metrics_) {
+            for (std::atomic<uint32_t>& b : m.buckets) b.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~Telemetry() { Close(); }
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // 登録(同じ名前と種類なら既存のIDを返す)。name は終了まで有効な文字列(通常は文字列リテラル)
+    MetricId registerMetric(const char* name, Kind kind) {
+        std::lock_guard<std::mutex> lock(registerMutex_);
+        const uint32_t count = metricCount_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (metrics_[i].kind == kind && std::strcmp(metrics_[i].name, name) == 0) return i;
+        }
+        if (count >= MAX_METRICS) return INVALID_METRIC;
+        metrics_[count].name = name;
+        metrics_[count].kind = kind;
+        metricCount_.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    // 区間 i の範囲は [2^(i/4) * 2^(i%4/4)] / 16 付近(約19%刻み)
+    static uint32_t bucketOf(float value) {
+        float scaled = value * 16.0f;
+        if (scaled <= 1.0f) return 0;
+        int index = static_cast<int>(std::log2(scaled) * 4.0f);
+        return index >= static_cast<int>(HISTOGRAM_BUCKETS) ? HISTOGRAM_BUCKETS - 1 : static_cast<uint32_t>(index);
+    }
+
+    // 区間の上端の値
+    static float bucketUpper(uint32_t index) {
+        return std::exp2((index + 1) * 0.25f) / 16.0f;
+    }
+
+    static float percentile(const uint32_t* buckets, uint64_t total, float fraction, float maxValue) {
+        const uint64_t target = static_cast<uint64_t>(std::ceil(total * fraction));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= target && seen > 0) {
+                float upper = bucketUpper(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    // fileMutex_ を保持して呼ぶ
+    void writeRows() {
+        const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - origin_).count();
+        const uint32_t count = metricCount_.load(std::memory_order_acquire);
+        char line[256];
+        for (uint32_t i = 0; i < count; ++i) {
+            Metric& m = metrics_[i];
+            switch (m.kind) {
+                case Kind::Counter:
+                    snprintf(line, sizeof(line), "%.3f,counter,%s,,%llu,,,,,\n", t, m.name,
+                             static_cast<unsigned long long>(m.count.load(std::memory_order_relaxed)));
+                    break;
+                case Kind::Gauge: {
+                    uint64_t bits = m.value.load(std::memory_order_relaxed);
+                    double value = 0.0;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    snprintf(line, sizeof(line), "%.3f,gauge,%s,,%g,,,,,\n", t, m.name, value);
+                    break;
+                }
+                case Kind::Histogram: {
+                    // 区間の値を取り出してリセット(取り出し中の記録は次の区間に入ることがある)
+                    uint32_t buckets[HISTOGRAM_BUCKETS];
+                    uint64_t total = 0;
+                    for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+                        buckets[b] = m.buckets[b].exchange(0, std::memory_order_relaxed);
+                        total += buckets[b];
+                    }
+                    m.count.exchange(0, std::memory_order_relaxed);
+                    const uint64_t sum = m.value.exchange(0, std::memory_order_relaxed);
+                    const uint32_t maxBits = m.maxBits.exchange(0, std::memory_order_relaxed);
+                    float maxValue = 0.0f;
+                    std::memcpy(&maxValue, &maxBits, sizeof(maxValue));
+                    if (total == 0) {
+                        snprintf(line, sizeof(line), "%.3f,histogram,%s,0,,,,,,\n", t, m.name);
+                        break;
+                    }
+                    snprintf(line, sizeof(line), "%.3f,histogram,%s,%llu,,%.3f,%.3f,%.3f,%.3f,%.3f\n", t, m.name,
+                             static_cast<unsigned long long>(total), sum / 1000.0 / total,
+                             percentile(buckets, total, 0.50f, maxValue), percentile(buckets, total, 0.90f, maxValue),
+                             percentile(buckets, total, 0.99f, maxValue), maxValue);
+                    break;
+                }
+            }
+            fputs(line, file_);
+        }
+        fflush(file_);
+    }
+
+    void closeFile() {
+        if (file_) fclose(file_);
+        file_ = nullptr;
+    }
+
+    Metric metrics_[MAX_METRICS];
+    std::atomic<uint32_t> metricCount_{ 0 };
+    std::mutex registerMutex_;
+    std::mutex fileMutex_;
+    FILE* file_ = nullptr;
+    float flushInterval_ = 5.0f;
+    std::chrono::steady_clock::time_point origin_;
+    std::chrono::steady_clock::time_point lastFlush_;
+};
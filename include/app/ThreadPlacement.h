@@ -0,0 +1,379 @@
+/**
+ * @file ThreadPlacement.h
+ * @brief ワーカー数・コアの割り当て(アフィニティ)・優先度の設定と、特定のスレッド用のコアの予約
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 何も設定しなければ OS の配置に任せ、JobSystem はハードウェアスレッド数-1 のワーカーを起動します(従来どおり)。
+ * コアの多い CPU(CCX / CCD ごとに L3 が分かれるもの)では、ホットなスレッドがコアや L3 の間を移動し、
+ * ワーカーとメインスレッドが同じコアを取り合うことがあります。ThreadPlacement は起動時に一度だけ
+ * 物理コアと L3 の構成を読み、役割ごとにコアを決めます。
+ *
+ * - **予約**: メイン(描画)・入力(InputSampler)・シミュレーション(SimulationThread)・動画のデコード用に
+ *   物理コアを1つずつ取り分けます。メイン・入力・シミュレーションは互いにデータを渡すため最初の L3 から、
+ *   動画は Media Foundation の内部スレッドが使うため最後の L3 から取ります。
+ *   予約したコアはワーカーに割り当てないため、ワーカーが増えても予約したスレッドとは競合しません。
+ * - **ワーカー**: 残りの物理コアを L3 の順に並べ、ワーカー i を i 番目のコアに固定します(pinWorkers)。
+ *   番号の近いワーカー(盗み合う相手)が同じ L3 に集まります。コアより多いワーカーは SMT の兄弟へ回します。
+ *   固定しない場合も、アフィニティは予約していないコア全体に制限します。
+ * - **優先度**: ワーカーは workerPriority(THREAD_PRIORITY_* の値)、予約したスレッドは THREAD_PRIORITY_ABOVE_NORMAL。
+ *
+ * 予約したスレッドは自分のスレッドで ApplyCurrent(役割) を呼びます(InputSampler / SimulationThread は起動時に呼ぶ)。
+ * Media Foundation のデコードスレッドは直接固定できないため、動画の予約はワーカーを外すだけです。
+ * アフィニティはスレッドと同じプロセッサグループの中でだけ設定できるため、各スレッドは1つのグループに収まります。
+ *
+ * @par コマンドライン
+ * @code
+ * HEW_GAME.exe [--workers=N] [--pin-threads] [--reserve-cores=main,input,sim,video] [--worker-priority=N]
+ * @endcode
+ */
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include "app/CommandLine.h"
+#include "app/DebugLog.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @enum ThreadRole
+ * @brief コアを割り当てるスレッドの役割
+ */
+enum class ThreadRole : uint8_t {
+    Main,        ///< メインスレッド(描画・Present)
+    Input,       ///< InputSampler
+    Simulation,  ///< SimulationThread
+    Video,       ///< 動画のデコード
+    Worker,      ///< JobSystem のワーカー
+};
+
+/**
+ * @struct ThreadPlacementConfig
+ * @brief スレッドの配置の設定
+ */
+struct ThreadPlacementConfig {
+    uint32_t workerCount = 0;                      ///< ワーカー数(0 は予約していない論理プロセッサ数、最低1)
+    bool pinWorkers = false;                       ///< ワーカーを1つずつ物理コアに固定するか
+    bool reserveMain = false;                      ///< メインスレッド用に物理コアを予約するか
+    bool reserveInput = false;                     ///< 入力スレッド用
+    bool reserveSimulation = false;                ///< シミュレーションスレッド用
+    bool reserveVideo = false;                     ///< 動画のデコード用(ワーカーを外すだけ)
+    int workerPriority = THREAD_PRIORITY_NORMAL;   ///< ワーカーの優先度(THREAD_PRIORITY_LOWEST 〜 HIGHEST)
+
+    /**
+     * @brief 既定(OS の配置のまま)から変わっているか
+     */
+    bool IsCustom() const {
+        return pinWorkers || reserveMain || reserveInput || reserveSimulation || reserveVideo ||
+               workerPriority != THREAD_PRIORITY_NORMAL;
+    }
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @param[in] cmdLine WinMain の lpCmdLine
+     * @param[out] out 読み取った設定(該当するオプションの項目だけ変更する)
+     * @return bool いずれかのオプションが指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, ThreadPlacementConfig& out) {
+        if (!cmdLine) return false;
+        bool found = false;
+        for (const std::string& arg : CommandLine::Split(cmdLine)) {
+            if (arg.compare(0, 10, "--workers=") == 0) {
+                const int count = std::atoi(arg.c_str() + 10);
+                if (count > 0) out.workerCount = static_cast<uint32_t>(count);
+                found = true;
+            } else if (arg == "--pin-threads") {
+                out.pinWorkers = true;
+                found = true;
+            } else if (arg.compare(0, 16, "--reserve-cores=") == 0) {
+                const std::string roles = arg.substr(16);
+                auto has = [&roles](const char* name) {
+                    const size_t n = std::strlen(name);
+                    for (size_t pos = roles.find(name); pos != std::string::npos; pos = roles.find(name, pos + 1)) {
+                        const bool startOk = pos == 0 || roles[pos - 1] == ',';
+                        const bool endOk = pos + n == roles.size() || roles[pos + n] == ',';
+                        if (startOk && endOk) return true;
+                    }
+                    return false;
+                };
+                out.reserveMain = has("main");
+                out.reserveInput = has("input");
+                out.reserveSimulation = has("sim");
+                out.reserveVideo = has("video");
+                found = true;
+            } else if (arg.compare(0, 18, "--worker-priority=") == 0) {
+                out.workerPriority = (std::min)((std::max)(std::atoi(arg.c_str() + 18), static_cast<int>(THREAD_PRIORITY_LOWEST)),
+                                                static_cast<int>(THREAD_PRIORITY_HIGHEST));
+                found = true;
+            }
+        }
+        return found;
+    }
+};
+
+/**
+ * @class ThreadPlacement
+ * @brief 物理コア・L3 の構成を読み、役割ごとにアフィニティと優先度を決める(プロセスで1つ)
+ *
+ * @par 使用例
+ * @code
+ * ThreadPlacement& placement = ThreadPlacement::GetInstance();
+ * placement.Configure(config);                       // JobSystem::Init() の前に1回
+ * placement.ApplyCurrent(ThreadRole::Main);
+ * jobs.Init(placement.WorkerCount(), [](uint32_t worker) {
+ *     ThreadPlacement::GetInstance().ApplyCurrent(ThreadRole::Worker, worker);
+ * });
+ * @endcode
+ */
+class ThreadPlacement {
+public:
+    static ThreadPlacement& GetInstance() {
+        static ThreadPlacement instance;
+        return instance;
+    }
+
+    /**
+     * @brief 構成を読み、役割ごとのコアを決める
+     * @return bool 設定どおりに割り当てられた場合 true(構成が読めない場合は OS の配置のまま false)
+     */
+    bool Configure(const ThreadPlacementConfig& config) {
+        config_ = config;
+        configured_ = false;
+        cores_.clear();
+        for (Assignment& a : reserved_) a = Assignment{};
+        workerCores_.clear();
+
+        if (!config.IsCustom()) {
+            workerCount_ = config.workerCount;  // 0 なら JobSystem の既定
+            return true;
+        }
+        if (!readTopology()) {
+            DEBUGLOG_WARNING("[ThreadPlacement] CPU の構成を取得できないため、スレッドの配置は OS に任せます");
+            workerCount_ = config.workerCount;
+            return false;
+        }
+
+        // 予約: メイン・入力・シミュレーションは先頭の L3 から、動画は末尾の L3 から物理コアを1つずつ
+        std::vector<bool> taken(cores_.size(), false);
+        auto reserveFront = [&](ThreadRole role) {
+            for (size_t c = 0; c < cores_.size(); ++c) {
+                if (taken[c]) continue;
+                taken[c] = true;
+                reserved_[static_cast<size_t>(role)] = Assignment{ true, cores_[c].group, cores_[c].mask };
+                return;
+            }
+        };
+        auto reserveBack = [&](ThreadRole role) {
+            for (size_t c = cores_.size(); c-- > 0;) {
+                if (taken[c]) continue;
+                taken[c] = true;
+                reserved_[static_cast<size_t>(role)] = Assignment{ true, cores_[c].group, cores_[c].mask };
+                return;
+            }
+        };
+        // ワーカーに1つも残らない場合は予約しない
+        const size_t reserveCount = (config.reserveMain ? 1 : 0) + (config.reserveInput ? 1 : 0) +
+                                    (config.reserveSimulation ? 1 : 0) + (config.reserveVideo ? 1 : 0);
+        if (reserveCount < cores_.size()) {
+            if (config.reserveMain) reserveFront(ThreadRole::Main);
+            if (config.reserveInput) reserveFront(ThreadRole::Input);
+            if (config.reserveSimulation) reserveFront(ThreadRole::Simulation);
+            if (config.reserveVideo) reserveBack(ThreadRole::Video);
+        } else if (reserveCount > 0) {
+            DEBUGLOG_WARNING("[ThreadPlacement] 物理コアが足りないため、コアを予約しません (物理コア " + std::to_string(cores_.size()) + ")");
+        }
+
+        // ワーカー: 残りの物理コアを L3 の順に、足りなければ SMT の兄弟へ
+        std::vector<size_t> freeCores;
+        uint32_t freeLogical = 0;
+        for (size_t c = 0; c < cores_.size(); ++c) {
+            if (taken[c]) continue;
+            freeCores.push_back(c);
+            freeLogical += popCount(cores_[c].mask);
+            unreservedMask_[cores_[c].group] |= cores_[c].mask;
+        }
+        workerCount_ = config.workerCount > 0 ? config.workerCount : (std::max)(freeLogical, 1u);
+        for (uint32_t w = 0; w < workerCount_; ++w) {
+            const Core& core = cores_[freeCores[w % freeCores.size()]];
+            // 1周目は物理コア全体、2周目以降は SMT の兄弟を1つずつ
+            const uint32_t lap = w / static_cast<uint32_t>(freeCores.size());
+            const KAFFINITY mask = lap == 0 ? core.mask : nthBit(core.mask, lap % popCount(core.mask));
+            workerCores_.push_back(Assignment{ true, core.group, mask });
+        }
+
+        configured_ = true;
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "[ThreadPlacement] " + Describe());
+        return true;
+    }
+
+    /**
+     * @brief JobSystem::Init() に渡すワーカー数(0 は JobSystem の既定)
+     */
+    uint32_t WorkerCount() const { return workerCount_; }
+
+    /**
+     * @brief 呼び出しスレッドへ役割のアフィニティと優先度を設定
+     * @param[in] role 役割
+     * @param[in] workerIndex ワーカー番号(Worker のみ)
+     *
+     * @details Configure() で割り当てがない役割(予約していないスレッド)には何もしません。
+     */
+    void ApplyCurrent(ThreadRole role, uint32_t workerIndex = 0) const {
+        if (!configured_) return;
+        HANDLE thread = GetCurrentThread();
+        if (role == ThreadRole::Worker) {
+            if (workerIndex >= workerCores_.size()) return;
+            const Assignment& a = workerCores_[workerIndex];
+            const KAFFINITY mask = config_.pinWorkers ? a.mask : unreservedMask_[a.group];
+            if (mask != 0) setAffinity(thread, a.group, mask);
+            if (config_.workerPriority != THREAD_PRIORITY_NORMAL) SetThreadPriority(thread, config_.workerPriority);
+            return;
+        }
+        const Assignment& a = reserved_[static_cast<size_t>(role)];
+        if (!a.valid) return;
+        setAffinity(thread, a.group, a.mask);
+        SetThreadPriority(thread, THREAD_PRIORITY_ABOVE_NORMAL);
+    }
+
+    /**
+     * @brief 割り当ての説明(ログ・オーバーレイ用)
+     */
+    std::string Describe() const {
+        std::string text = "物理コア " + std::to_string(cores_.size()) + " (L3 " + std::to_string(l3Count_) +
+                           "), ワーカー " + std::to_string(workerCount_) + (config_.pinWorkers ? " (固定)" : "");
+        static const char* names[] = { "main", "input", "sim", "video" };
+        for (size_t r = 0; r < 4; ++r) {
+            if (!reserved_[r].valid) continue;
+            text += std::string(", ") + names[r] + "=G" + std::to_string(reserved_[r].group) + ":" + maskText(reserved_[r].mask);
+        }
+        return text;
+    }
+
+private:
+    static constexpr size_t MAX_GROUPS = 64;  ///< プロセッサグループの上限(Windows の仕様では最大 20)
+
+    struct Core {
+        WORD group = 0;       ///< プロセッサグループ
+        KAFFINITY mask = 0;   ///< 物理コアの論理プロセッサ(SMT の兄弟を含む)
+        uint32_t l3 = 0;      ///< L3 の番号(同じ L3 を共有するコアは同じ値)
+    };
+
+    struct Assignment {
+        bool valid = false;
+        WORD group = 0;
+        KAFFINITY mask = 0;
+    };
+
+    ThreadPlacement() = default;
+
+    /**
+     * @brief 物理コアと L3 を読み、コアを (L3, グループ, 論理プロセッサ番号) の順に並べる
+     */
+    bool readTopology() {
+        std::vector<uint8_t> buffer;
+        if (!queryInformation(RelationProcessorCore, buffer)) return false;
+        forEachEntry(buffer, [this](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info) {
+            const GROUP_AFFINITY& g = info.Processor.GroupMask[0];
+            if (g.Group < MAX_GROUPS) cores_.push_back(Core{ g.Group, g.Mask, 0 });
+        });
+        if (cores_.empty()) return false;
+
+        std::vector<GROUP_AFFINITY> caches;
+        if (queryInformation(RelationCache, buffer)) {
+            forEachEntry(buffer, [&caches](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info) {
+                if (info.Cache.Level == 3) caches.push_back(info.Cache.GroupMask);
+            });
+        }
+        l3Count_ = static_cast<uint32_t>((std::max<size_t>)(caches.size(), 1));
+        for (Core& core : cores_) {
+            core.l3 = 0;
+            for (size_t i = 0; i < caches.size(); ++i) {
+                if (caches[i].Group == core.group && (caches[i].Mask & core.mask) != 0) {
+                    core.l3 = static_cast<uint32_t>(i);
+                    break;
+                }
+            }
+        }
+        std::stable_sort(cores_.begin(), cores_.end(), [](const Core& a, const Core& b) {
+            if (a.l3 != b.l3) return a.l3 < b.l3;
+            if (a.group != b.group) return a.group < b.group;
+            return lowestBit(a.mask) < lowestBit(b.mask);
+        });
+        for (KAFFINITY& mask : unreservedMask_) mask = 0;
+        return true;
+    }
+
+    static bool queryInformation(LOGICAL_PROCESSOR_RELATIONSHIP relation, std::vector<uint8_t>& buffer) {
+        DWORD bytes = 0;
+        GetLogicalProcessorInformationEx(relation, nullptr, &bytes);
+        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || bytes == 0) return false;
+        buffer.resize(bytes);
+        return GetLogicalProcessorInformationEx(relation, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &bytes) != FALSE;
+    }
+
+    template<class F>
+    static void forEachEntry(const std::vector<uint8_t>& buffer, F&& fn) {
+        size_t offset = 0;
+        while (offset < buffer.size()) {
+            const auto* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+            if (info->Size == 0) break;
+            fn(*info);
+            offset += info->Size;
+        }
+    }
+
+    static void setAffinity(HANDLE thread, WORD group, KAFFINITY mask) {
+        GROUP_AFFINITY affinity{};
+        affinity.Group = group;
+        affinity.Mask = mask;
+        if (!SetThreadGroupAffinity(thread, &affinity, nullptr)) {
+            DEBUGLOG_WARNING("[ThreadPlacement] アフィニティの設定失敗 (エラー: " + std::to_string(GetLastError()) + ")");
+        }
+    }
+
+    static uint32_t popCount(KAFFINITY mask) {
+        uint32_t n = 0;
+        for (; mask; mask &= mask - 1) ++n;
+        return n;
+    }
+
+    static uint32_t lowestBit(KAFFINITY mask) {
+        uint32_t bit = 0;
+        while (mask && !(mask & 1)) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+    }
+
+    // mask の下から n 番目(0 始まり)に立っているビットだけのマスク
+    static KAFFINITY nthBit(KAFFINITY mask, uint32_t n) {
+        for (; mask; mask &= mask - 1) {
+            if (n-- == 0) return mask & (~mask + 1);
+        }
+        return 0;
+    }
+
+    static std::string maskText(KAFFINITY mask) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(mask));
+        return text;
+    }
+
+    ThreadPlacementConfig config_;
+    bool configured_ = false;
+    uint32_t workerCount_ = 0;
+    uint32_t l3Count_ = 0;
+    std::vector<Core> cores_;                 ///< L3 の順の物理コア
+    Assignment reserved_[4];                  ///< ThreadRole::Main..Video の予約
+    std::vector<Assignment> workerCores_;     ///< ワーカーごとのコア
+    KAFFINITY unreservedMask_[MAX_GROUPS]{};  ///< グループごとの予約していない論理プロセッサ
+};
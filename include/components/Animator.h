@@ -0,0 +1,72 @@
+#pragma once
+#include "animation/Skeleton.h"
+#include <DirectXMath.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @file Animator.h
+ * @brief スケルタルアニメーションの再生状態とスキニング行列のコンポーネント定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * スキニングされたメッシュを持つモデルを読み込むと、ModelLoadingSystem が Model のエンティティに
+ * Animator を、スキニングされたメッシュのエンティティ(ModelPart を含む)に SkinPose を追加します。
+ * AnimationSystem が Animator のクリップを評価して SkinPose のパレットを書き、
+ * RenderSystem がパレットを頂点シェーダーへ渡します。
+ */
+
+/**
+ * @struct Animator
+ * @brief スケルタルアニメーションの再生状態
+ *
+ * @details
+ * clip を再生し、blendClip が有効な場合は blendWeight の割合で重ねます(クロスフェードは
+ * blendWeight を毎ステップ動かして行います)。clip が NO_CLIP の場合はバインドポーズです。
+ *
+ * @par 使用例
+ * @code
+ * auto* animator = world.TryGet<Animator>(entity);
+ * if (animator && animator->data) {
+ *     animator->Play(animator->data->FindClip("Run"));
+ * }
+ * @endcode
+ */
+struct Animator {
+    static constexpr int NO_CLIP = -1;
+
+    std::shared_ptr<const SkinnedModelData> data; ///< スケルトンとクリップ(ModelLoader が読み込んだもの)
+    int clip = 0;                 ///< 再生するクリップ(SkinnedModelData::clips の添字)
+    int blendClip = NO_CLIP;      ///< 重ねるクリップ
+    float time = 0.0f;            ///< clip の再生位置(秒)
+    float blendTime = 0.0f;       ///< blendClip の再生位置(秒)
+    float blendWeight = 0.0f;     ///< blendClip の割合(0～1)
+    float speed = 1.0f;           ///< 再生速度
+    bool loop = true;             ///< ループ再生するか
+    bool playing = true;          ///< 再生位置を進めるか
+
+    /**
+     * @brief クリップを最初から再生(ブレンドは解除)
+     */
+    void Play(int clipIndex, bool looping = true) {
+        clip = clipIndex;
+        time = 0.0f;
+        blendClip = NO_CLIP;
+        blendWeight = 0.0f;
+        loop = looping;
+        playing = true;
+    }
+};
+
+/**
+ * @struct SkinPose
+ * @brief 頂点シェーダーに渡すスキニング行列(関節ごと、転置済み)
+ *
+ * @note AnimationSystem が毎ステップ上書きします。空の場合はバインドポーズのまま描画します
+ */
+struct SkinPose {
+    std::vector<DirectX::XMFLOAT4X4> palette; ///< 関節ごとの 逆バインド行列 × モデル空間の行列(転置済み)
+};
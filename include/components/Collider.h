@@ -0,0 +1,114 @@
+#pragma once
+#include "components/MeshRenderer.h"
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @file Collider.h
+ * @brief 当たり判定の形状(球・箱・カプセル)の定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform・SpatialBody と一緒に持たせると、CollisionSystem が SpatialHashGrid の組に対して
+ * この形状で詳細判定を行い、接触を CollisionEvent として記録します。
+ * 形状はローカル空間で定義し、LocalToWorld(位置・回転・スケール)で変換して判定します。
+ */
+
+/**
+ * @struct Collider
+ * @brief 当たり判定の形状
+ *
+ * @details
+ * SpatialBody::radius は形状全体を囲む必要があります(BoundingRadius() × スケール以上)。
+ * 小さいと、重なっていても組として見つからない場合があります。
+ *
+ * @par 使用例
+ * @code
+ * Collider collider = Collider::FromMesh(MeshType::Cube);
+ * collider.flags |= Collider::DESTROY_ON_CONTACT;
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{0, 5, 0})
+ *     .With<Collider>(collider)
+ *     .With<SpatialBody>(SpatialBody{ collider.BoundingRadius(), SpatialBody::LAYER_ENEMY, SpatialBody::LAYER_PLAYER })
+ *     .Build();
+ * @endcode
+ */
+struct Collider {
+    /**
+     * @enum Shape
+     * @brief 形状の種類(詳細判定の組み合わせの順序を兼ねる)
+     */
+    enum Shape : uint32_t {
+        SHAPE_SPHERE = 0, ///< center を中心とする半径 radius の球
+        SHAPE_CAPSULE,    ///< center を中心にローカルY軸方向へ ±halfHeight の線分を、半径 radius で太らせた形
+        SHAPE_BOX,        ///< center を中心とする半分の大きさ halfExtents の箱
+        SHAPE_COUNT
+    };
+
+    static constexpr uint32_t DESTROY_ON_CONTACT = 1u << 0; ///< 接触したら World::Cause::Collision で破棄する
+
+    Shape shape = SHAPE_SPHERE;                           ///< 形状
+    DirectX::XMFLOAT3 center{ 0.0f, 0.0f, 0.0f };         ///< ローカル空間の中心
+    float radius = 0.5f;                                  ///< 球・カプセルの半径
+    float halfHeight = 0.5f;                              ///< カプセルの線分の長さの半分
+    DirectX::XMFLOAT3 halfExtents{ 0.5f, 0.5f, 0.5f };    ///< 箱の半分の大きさ
+    uint32_t flags = 0;                                   ///< DESTROY_ON_CONTACT など
+
+    static Collider Sphere(float r) {
+        Collider c;
+        c.shape = SHAPE_SPHERE;
+        c.radius = r;
+        return c;
+    }
+
+    static Collider Capsule(float r, float half) {
+        Collider c;
+        c.shape = SHAPE_CAPSULE;
+        c.radius = r;
+        c.halfHeight = half;
+        return c;
+    }
+
+    static Collider Box(const DirectX::XMFLOAT3& half) {
+        Collider c;
+        c.shape = SHAPE_BOX;
+        c.halfExtents = half;
+        return c;
+    }
+
+    /**
+     * @brief MeshType の基本形状(一辺・直径 1)に合わせた形状
+     *
+     * @details
+     * 円柱・円錐はカプセル・球で近似します(側面は一致し、端がわずかに大きくなります)。
+     */
+    static Collider FromMesh(MeshType type) {
+        switch (type) {
+        case MeshType::Cube:     return Box(DirectX::XMFLOAT3{ 0.5f, 0.5f, 0.5f });
+        case MeshType::Sphere:   return Sphere(0.5f);
+        case MeshType::Cylinder: return Capsule(0.5f, 0.25f);
+        case MeshType::Cone:     return Sphere(0.5f);
+        case MeshType::Plane:    return Box(DirectX::XMFLOAT3{ 0.5f, 0.01f, 0.5f });
+        case MeshType::Capsule:  return Capsule(0.5f, 0.5f);
+        }
+        return Sphere(0.5f);
+    }
+
+    /**
+     * @brief ローカル原点から形状全体を囲む球の半径(スケール 1 の場合)
+     */
+    float BoundingRadius() const {
+        const float offset = std::sqrt(center.x * center.x + center.y * center.y + center.z * center.z);
+        switch (shape) {
+        case SHAPE_CAPSULE:
+            return offset + halfHeight + radius;
+        case SHAPE_BOX:
+            return offset + std::sqrt(halfExtents.x * halfExtents.x + halfExtents.y * halfExtents.y + halfExtents.z * halfExtents.z);
+        default:
+            return offset + radius;
+        }
+    }
+};
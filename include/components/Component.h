@@ -1,4 +1,7 @@
 ﻿#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 
 // 前方宣言により依存関係を減らし、コンパイル速度を向上させる。
 // World クラスは、ゲーム内のエンティティやコンポーネントを管理する「ゲームワールド」を表します。
@@ -12,6 +15,12 @@ struct IComponent {
  virtual ~IComponent() = default; ///< 派生クラスの適切なクリーンアップを保証するための仮想デストラクタ。
 };
 
+// データを持たないタグコンポーネントの基底。
+// 仮想関数を持たない空の型は World がタグとして扱い、エンティティごとのスロットを確保せず
+// 所持の有無をビットだけで記録する（IComponent を継承すると vtable のため空の型にならない）。
+// クエリでは With<Tag>() / Without<Tag>() で絞り込む。
+struct ITag {};
+
 // ゲームループ中に実行されるロジックを持つコンポーネントの基底クラス。
 // このクラスを継承することで、特定の振る舞いを持つコンポーネントを作成できます。
 struct Behaviour : IComponent {
@@ -27,6 +36,29 @@ struct Behaviour : IComponent {
  virtual void OnUpdate(World& w, Entity self, float dt) {}
 };
 
+// 同じ型のBehaviourをまとめて更新するためのビュー。
+// Behaviour派生型に次の静的関数を定義すると、OnUpdateの代わりに型ごとに1回だけ呼び出される。
+//   static void UpdateBatch(World& w, BehaviourBatch<T>& batch, float dt);
+// At(i) は更新中に削除されたBehaviourに対して nullptr を返す。
+template<class T>
+struct BehaviourBatch {
+ const Entity* entities; ///< エンティティ配列
+ T* const* items;        ///< Behaviour配列（削除済みは nullptr）
+ size_t count;           ///< 要素数
+
+ size_t Size() const { return count; }
+ const Entity& EntityAt(size_t i) const { return entities[i]; }
+ T* At(size_t i) const { return items[i]; }
+};
+
+// T が UpdateBatch を持つかどうかを判定する。
+template<class T, class = void>
+struct HasUpdateBatch : std::false_type {};
+
+template<class T>
+struct HasUpdateBatch<T, decltype(T::UpdateBatch(std::declval<World&>(), std::declval<BehaviourBatch<T>&>(), 0.0f), void())>
+ : std::true_type {};
+
 // データ専用コンポーネントを定義するためのマクロ。
 // データコンポーネントは状態を保持するが、振る舞いを持たない。
 // @param ComponentName: コンポーネントの名前。
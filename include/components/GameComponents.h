@@ -1,6 +1,7 @@
 #pragma once
 
 #include "components/Component.h"
+#include "ecs/ComponentReflection.h"
 #include <DirectXMath.h>
 
 /**
@@ -66,6 +67,7 @@ struct Health : IComponent {
         return current <= 0.0f;
     }
 };
+REFLECT_COMPONENT(Health, current, max)
 
 /**
  * @struct Velocity
@@ -73,12 +75,27 @@ struct Health : IComponent {
  *
  * @details
  * エンティティの移動速度を保持します。
- * 物理演算や移動処理に使用します。
+ * Transform と一緒に持たせると、MovementSystem が毎ステップ加速度・抵抗を反映して
+ * Transform::position を進めます(Behaviour で位置を書き換える必要はありません)。
+ *
+ * @par 使用例
+ * @code
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{0, 5, 0})
+ *     .With<Velocity>(DirectX::XMFLOAT3{0, -2, 0})
+ *     .Build();
+ * @endcode
  *
  * @author 山内陽
  */
 struct Velocity : IComponent {
-    DirectX::XMFLOAT3 velocity{ 0.0f, 0.0f, 0.0f };  ///< 速度ベクトル
+    DirectX::XMFLOAT3 velocity{ 0.0f, 0.0f, 0.0f };      ///< 速度ベクトル
+    DirectX::XMFLOAT3 acceleration{ 0.0f, 0.0f, 0.0f };  ///< 加速度(重力など、毎秒 velocity に加算)
+    float drag = 0.0f;                                   ///< 空気抵抗(1/秒、0 で減速なし)
+
+    Velocity() = default;
+    Velocity(const DirectX::XMFLOAT3& v) : velocity(v) {}
+    Velocity(const DirectX::XMFLOAT3& v, const DirectX::XMFLOAT3& a, float d = 0.0f) : velocity(v), acceleration(a), drag(d) {}
 
     /**
      * @brief 速度を加算
@@ -92,3 +109,21 @@ struct Velocity : IComponent {
         velocity.z += z;
     }
 };
+REFLECT_COMPONENT(Velocity, velocity, acceleration, drag)
+
+/**
+ * @struct DespawnBelow
+ * @brief 指定の高さより下に出たら破棄するデータコンポーネント
+ *
+ * @details
+ * MovementSystem が移動の後に判定し、World::Cause::LifetimeExpired で破棄を予約します。
+ *
+ * @author 山内陽
+ */
+struct DespawnBelow : IComponent {
+    float y = -10.0f;  ///< この高さより下で破棄
+
+    DespawnBelow() = default;
+    DespawnBelow(float limit) : y(limit) {}
+};
+REFLECT_COMPONENT(DespawnBelow, y)
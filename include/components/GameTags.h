@@ -6,7 +6,8 @@
  * @brief タグコンポーネント
  * @details エンティティの種類を識別するためのマーカーです。
  * データは持たず、エンティティが特定の種類であることを示すために使用します。
+ * ITag を継承した空の型なので、World はビットだけで所持を記録します。
  */
-struct PlayerTag : IComponent {};  ///< プレイヤータグ
-struct EnemyTag : IComponent {};   ///< 敵タグ
-struct BulletTag : IComponent {};  ///< 弾丸タグ
+struct PlayerTag : ITag {};  ///< プレイヤータグ
+struct EnemyTag : ITag {};   ///< 敵タグ
+struct BulletTag : ITag {};  ///< 弾丸タグ
@@ -0,0 +1,63 @@
+#pragma once
+#include "components/Component.h"
+#include "components/MeshRenderer.h"
+#include <DirectXMath.h>
+#include <cstdint>
+
+/**
+ * @file GpuMover.h
+ * @brief 位置・速度・回転をGPUのバッファに置いて移動させるコンポーネントの定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 10万体規模の群衆では、MovementSystem の積分と Transform の行列の計算・インスタンスの書き込みそのものが
+ * CPU時間の大半になります。Transform と GpuMover を持つエンティティは、生成時の Transform を初期値として
+ * GPUの構造化バッファに1回だけ書き込み、以降の積分(MovementSystem と同じ式)・Y軸回転・描画を
+ * RenderSystem がコンピュートシェーダーとインスタンス描画で行います(GpuMoverSystem / GpuMovers)。
+ *
+ * GPUに置いた後の Transform は更新されません(当たり判定・近傍検索・カリングにも使われません)。
+ * ゲーム側で位置を読むエンティティだけに GpuReadback を付けると、数フレーム遅れの位置と向きが
+ * Transform に書き戻されます。
+ *
+ * MeshRenderer と一緒に持たせると二重に描かれるため、見た目は meshType・color で指定します。
+ * 生成後に GpuMover の値を書き換えてもGPU側には反映されません(作り直す場合は Remove して Add し直す)。
+ *
+ * @par 使用例
+ * @code
+ * GpuMover mover;
+ * mover.velocity = DirectX::XMFLOAT3{ 2.0f, 0.0f, 0.0f };
+ * mover.rotationSpeedDegY = 90.0f;
+ * mover.color = DirectX::XMFLOAT3{ 0.9f, 0.3f, 0.2f };
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{ 0, 1, 0 })
+ *     .With<GpuMover>(mover)
+ *     .Build();
+ * @endcode
+ */
+struct GpuMover : IComponent {
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    DirectX::XMFLOAT3 velocity{ 0.0f, 0.0f, 0.0f };      ///< 初速
+    DirectX::XMFLOAT3 acceleration{ 0.0f, 0.0f, 0.0f };  ///< 加速度(Velocity と同じ)
+    float drag = 0.0f;                                   ///< 空気抵抗(1/秒)
+    float rotationSpeedDegY = 0.0f;                      ///< Y軸の回転速度(度/秒、Rotator と同じ)
+    MeshType meshType = MeshType::Cube;                  ///< 描画する形状
+    DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f };         ///< 色
+    float bounceExtent = 0.0f;                           ///< 原点を中心に XZ がこの範囲を出たら速度を反射(0 で反射しない)
+
+    uint32_t slot = NO_SLOT;                             ///< GPUのバッファ上の位置(GpuMoverSystem が設定)
+
+    GpuMover() = default;
+    GpuMover(const DirectX::XMFLOAT3& v, float rotationDegY = 0.0f) : velocity(v), rotationSpeedDegY(rotationDegY) {}
+};
+
+/**
+ * @struct GpuReadback
+ * @brief GpuMover の位置と向きを Transform に書き戻すタグ(ゲーム側で位置を参照するエンティティだけに付ける)
+ *
+ * @details
+ * 書き戻す値は GpuProfiler::LATENCY フレーム程度遅れます。書き戻せる数は GpuMovers::MAX_READBACKS まで。
+ */
+struct GpuReadback : ITag {};
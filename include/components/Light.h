@@ -6,12 +6,39 @@
  * @brief ライト（光源）コンポーネントの定義
  * @author 山内陽
  * @date 2025
- * @version 6.0
+ * @version 6.1
  */
 
-// 現状は指向性ライトのみを想定
+// 指向性ライト(シーンに1つ、最後に見つかったものを使用)
 struct DirectionalLight {
     DirectX::XMFLOAT3 direction{ 0.577f, -0.577f, 0.577f }; // デフォルトのライト方向
     float padding; // 16バイトアライメント用
     DirectX::XMFLOAT4 color{ 1.0f, 1.0f, 1.0f, 1.0f };      // ライトの色
 };
+
+/**
+ * @struct PointLight
+ * @brief 点光源(位置は同じエンティティの Transform)
+ *
+ * @details
+ * range で0になるように滑らかに減衰します。数に上限はなく、RenderSystem がクラスタごとに
+ * 影響するライトだけを列挙するため、ピクセルあたりの負荷は近くのライトの数で決まります。
+ */
+struct PointLight {
+    DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f }; ///< ライトの色
+    float intensity = 1.0f;                      ///< 明るさ(色に掛ける)
+    float range = 5.0f;                          ///< 届く距離(ワールド単位)
+};
+
+/**
+ * @struct SpotLight
+ * @brief スポットライト(位置と向きは同じエンティティの Transform)
+ */
+struct SpotLight {
+    DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f };      ///< ライトの色
+    float intensity = 1.0f;                           ///< 明るさ(色に掛ける)
+    float range = 10.0f;                              ///< 届く距離(ワールド単位)
+    DirectX::XMFLOAT3 direction{ 0.0f, 0.0f, 1.0f };  ///< ローカル空間の照射方向(Transform の回転を掛ける)
+    float innerAngle = 20.0f;                         ///< 減衰が始まる半角(度)
+    float outerAngle = 30.0f;                         ///< 0になる半角(度)
+};
@@ -1,13 +1,14 @@
 ﻿#pragma once
 #include <DirectXMath.h>
 #include "graphics/TextureManager.h"
+#include "graphics/MaterialManager.h"
 
 /**
  * @file MeshRenderer.h
  * @brief メッシュ描画コンポーネントの定義
  * @author 山内陽
  * @date 2025
- * @version 6.0
+ * @version 6.1
  * 
  * @details
  * このファイルは3Dオブジェクトの「見た目」を制御するコンポーネントを定義します。
@@ -280,4 +281,52 @@ struct MeshRenderer {
      * @note デフォルトは{1.0, 1.0}
      */
     DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };
+
+    /**
+     * @var material
+     * @brief 明示的なマテリアル(MaterialManager::Create で作成)
+     *
+     * @details
+     * 設定した場合は color / texture より優先し、マテリアルの色・テクスチャ・スペキュラ強度で描画します。
+     * 設定しない場合は color / texture から RenderSystem が暗黙のマテリアルを引きます。
+     *
+     * @par 使用例
+     * @code
+     * MaterialDesc desc;
+     * desc.texture = texManager.LoadFromFile("metal.png");
+     * desc.specularPower = 96.0f;
+     * renderer.material = ServiceLocator::Get<MaterialManager>().Create(desc);
+     * @endcode
+     *
+     * @note デフォルトはINVALID_MATERIAL(color / texture を使用)
+     * @see MaterialManager マテリアル管理クラス
+     */
+    MaterialManager::MaterialHandle material = MaterialManager::INVALID_MATERIAL;
 };
+
+/**
+ * @struct StaticBatch
+ * @brief 静的バッチ対象のタグ(動かない MeshRenderer を1つのバッファにまとめて描画)
+ *
+ * @details
+ * このタグを持つエンティティは、同じマテリアル(material または色・テクスチャ、UV変換)ごとに頂点を
+ * ワールド座標へ変換済みの大きな頂点・インデックスバッファへまとめられ、数回のドローで描画されます。
+ * メンバーの Transform / MeshRenderer / LocalToWorld が変わったとき、またはメンバーが増減したときだけ再構築します。
+ *
+ * @par 使用例(地面のタイル)
+ * @code
+ * MeshRenderer floor;
+ * floor.meshType = MeshType::Plane;
+ * for (int x = 0; x < 16; ++x) {
+ *     world.Create()
+ *         .With<Transform>(DirectX::XMFLOAT3{ x * 2.0f, 0.0f, 0.0f })
+ *         .With<MeshRenderer>(floor)
+ *         .With<StaticBatch>()
+ *         .Build();
+ * }
+ * @endcode
+ *
+ * @note ForEach の参照経由で Transform を書き換えた場合も LocalToWorld の変更で検出されますが、
+ *       MeshRenderer を参照経由で書き換えた場合は World::MarkChanged<MeshRenderer>() を呼んでください
+ */
+struct StaticBatch {};
@@ -1,14 +1,35 @@
 #pragma once
 #include <string>
+#include <cstdint>
+#include "ecs/Entity.h"
 
 /**
  * @file Model.h
  * @brief モデルファイルパスを保持するコンポーネント
  * @author 山内陽
  * @date 2025
- * @version 6.0
+ * @version 6.2
  */
 
 struct Model {
     std::string filePath;
+    bool showPlaceholder = false; ///< 非同期読み込み中に仮の立方体(MeshRenderer)を表示するか
+    uint32_t generation = 0;      ///< 読み込んだ時点の ResourceManager::GetModelGeneration()(ホットリロードの判定用)
+};
+
+/**
+ * @struct ModelPlaceholder
+ * @brief 読み込み中の仮表示として ModelLoadingSystem が追加した MeshRenderer の目印
+ */
+struct ModelPlaceholder {};
+
+/**
+ * @struct ModelPart
+ * @brief ModelLoadingSystem が作成した2つ目以降のメッシュの子エンティティの目印
+ *
+ * @details
+ * ホットリロードでモデルを作り直す際に、元のモデルの子メッシュだけを破棄するために使います。
+ */
+struct ModelPart {
+    Entity root{}; ///< Model を持つエンティティ
 };
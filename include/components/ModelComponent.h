@@ -1,15 +1,21 @@
 #pragma once
 #include <DirectXMath.h>
 #include "graphics/TextureManager.h"
+#include "graphics/MaterialManager.h"
+#include "graphics/MeshPool.h"
+#include "graphics/VertexFormat.h"
 #include <wrl/client.h>
 #include <d3d11.h>
+#include <memory>
+
+struct SkinnedModelData;
 
 /**
  * @file ModelComponent.h
  * @brief 3Dモデルのメッシュデータを保持するコンポーネントの定義
  * @author 山内陽
  * @date 2025
- * @version 6.0
+ * @version 6.3
  * 
  * @details
  * このファイルは、Assimpによってロードされた3Dモデルの個々のメッシュの
@@ -17,6 +23,18 @@
  * ModelComponentを定義します。
  */
 
+/**
+ * @struct ModelLod
+ * @brief 簡略化したメッシュ(LOD1以降)
+ */
+struct ModelLod {
+    Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+    UINT indexCount = 0; // 0 の場合はこのレベルなし(より詳細なレベルを使用)
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
+    MeshPoolHandle pooled; // 共有メッシュバッファ内の範囲(設定時は vertexBuffer/indexBuffer は空)
+};
+
 struct ModelComponent {
     // 頂点バッファ
     Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
@@ -24,12 +42,31 @@ struct ModelComponent {
     Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
     // インデックス数
     UINT indexCount = 0;
+    // インデックス形式 (頂点数が65535を超えるメッシュは R32_UINT)
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
+    // 共有メッシュバッファ(GfxDevice::Meshes())内の範囲 (設定時は vertexBuffer/indexBuffer は空)
+    MeshPoolHandle pooled;
+    // 頂点形式 (LOD1, LOD2 も同じ形式。ModelLoader::SetVertexFormat で読み込み時に選ぶ)
+    VertexFormat vertexFormat = VertexFormat::Standard;
+    // CompactQuantized の位置の逆量子化 (xyz: 原点, w: 拡大率。VertexCompression::PositionDequantMatrix)
+    DirectX::XMFLOAT4 positionDequant{ 0.0f, 0.0f, 0.0f, 1.0f };
     // テクスチャハンドル (現時点では単一テクスチャを想定)
     TextureManager::TextureHandle texture = TextureManager::INVALID_TEXTURE;
     TextureManager::TextureHandle normalTexture = TextureManager::INVALID_TEXTURE;
     // 基本色 (テクスチャがない場合、または色調補正用)
     DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f };
+    // 明示的なマテリアル (MaterialManager::Create。設定時は texture / normalTexture / color より優先)
+    MaterialManager::MaterialHandle material = MaterialManager::INVALID_MATERIAL;
     // UVオフセットとスケール (将来的に必要に応じて拡張)
     DirectX::XMFLOAT2 uvOffset{ 0.0f, 0.0f };
     DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };
+    // ローカル空間の境界球 (視錐台カリング用、半径0以下はカリングしない)
+    DirectX::XMFLOAT3 boundsCenter{ 0.0f, 0.0f, 0.0f };
+    float boundsRadius = 0.0f;
+    // LOD1, LOD2 (ModelLoader が頂点クラスタリングで生成、生成できなかったレベルは空)
+    ModelLod lods[2];
+    // スキニングの影響 (SkinInfluence の頂点ごとの2本目のストリーム。スキニングされたメッシュのみ、LOD と共有メッシュバッファは使わない)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> skinBuffer;
+    // スケルトンとアニメーションクリップ (同じモデルファイルのメッシュで共有、スキニングされたモデルのみ)
+    std::shared_ptr<const SkinnedModelData> skinData;
 };
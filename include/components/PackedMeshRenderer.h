@@ -0,0 +1,122 @@
+#pragma once
+#include "components/MeshRenderer.h"
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <cstdint>
+
+/**
+ * @file PackedMeshRenderer.h
+ * @brief 大量のエンティティ向けに詰めた16バイトの描画コンポーネントの定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * MeshRenderer は 40 バイト(形状の enum・float3 の色・テクスチャ・float2 の UV 変換2つ・マテリアル)、
+ * ModelComponent はエンティティごとに ComPtr とLODのバッファを持ちます。数万体の描画対象では
+ * ExtractRenderProxies の走査がこれらの読み込みで律速するため、次のように詰めたものを用意しています。
+ * - mesh: 16 ビット。MeshType、または MODEL_BIT と SharedModelTable に登録したモデルの番号
+ * - material: 16 ビットの MaterialManager のハンドル(0 は color を使用)
+ * - color: RGBA8(A は予約、常に 255)
+ * - uv: UV のオフセットとスケールを半精度で4つ
+ *
+ * 同じモデルを使うエンティティはバッファを SharedModelTable の1つの ModelComponent で共有し、
+ * LODの解決もフレームにモデルごとに1回だけ行われます。
+ *
+ * MeshRenderer と違い、テクスチャはマテリアル経由でだけ指定でき(モデルはモデル自身のテクスチャを使用)、
+ * StaticBatch の対象にもなりません。動かない背景や個別にテクスチャを差し替えるものは MeshRenderer を使ってください。
+ * MeshRenderer と一緒に持たせると二重に描かれます。
+ *
+ * @par 使用例
+ * @code
+ * PackedMeshRenderer packed;
+ * packed.SetMeshType(MeshType::Sphere);
+ * packed.SetColor(DirectX::XMFLOAT3{ 0.9f, 0.3f, 0.2f });
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{ 0, 1, 0 })
+ *     .With<PackedMeshRenderer>(packed)
+ *     .Build();
+ *
+ * // 読み込んだモデルを共有する
+ * const uint16_t id = renderer.SharedModels().Register(model);
+ * PackedMeshRenderer crowd;
+ * crowd.SetModel(id);
+ * @endcode
+ */
+struct PackedMeshRenderer {
+    static constexpr uint16_t MODEL_BIT = 0x8000;       ///< mesh がモデルの番号であることを示すビット
+    static constexpr uint16_t HALF_ZERO = 0x0000;       ///< 半精度の 0.0
+    static constexpr uint16_t HALF_ONE = 0x3C00;        ///< 半精度の 1.0
+
+    uint16_t mesh = 0;                                  ///< MeshType、または MODEL_BIT | モデルの番号
+    uint16_t material = 0;                              ///< MaterialManager のハンドル(0 は color を使用)
+    uint32_t color = 0xFFFFB34Du;                       ///< RGBA8(R が下位バイト。既定は MeshRenderer と同じ水色)
+    uint16_t uv[4] = { HALF_ZERO, HALF_ZERO, HALF_ONE, HALF_ONE }; ///< 半精度の uvOffset.xy, uvScale.xy
+
+    PackedMeshRenderer() = default;
+
+    explicit PackedMeshRenderer(const DirectX::XMFLOAT3& rgb, MeshType type = MeshType::Cube) {
+        SetMeshType(type);
+        SetColor(rgb);
+    }
+
+    /**
+     * @brief MeshRenderer の内容を詰める
+     * @return bool 詰められない場合(マテリアルなしのテクスチャ、16 ビットに収まらないマテリアル) false
+     */
+    bool Pack(const MeshRenderer& mr) {
+        if (mr.texture != TextureManager::INVALID_TEXTURE && mr.material == MaterialManager::INVALID_MATERIAL) return false;
+        if (!SetMaterial(mr.material)) return false;
+        SetMeshType(mr.meshType);
+        SetColor(mr.color);
+        SetUv(mr.uvOffset, mr.uvScale);
+        return true;
+    }
+
+    void SetMeshType(MeshType type) { mesh = static_cast<uint16_t>(type); }
+    MeshType GetMeshType() const { return static_cast<MeshType>(mesh); }
+
+    /**
+     * @brief SharedModelTable に登録したモデルを描画する
+     */
+    void SetModel(uint16_t id) { mesh = static_cast<uint16_t>(MODEL_BIT | (id & ~MODEL_BIT)); }
+    bool IsModel() const { return (mesh & MODEL_BIT) != 0; }
+    uint16_t ModelId() const { return static_cast<uint16_t>(mesh & ~MODEL_BIT); }
+
+    /**
+     * @brief マテリアルを設定(16 ビットに収まらないハンドルは設定しない)
+     */
+    bool SetMaterial(MaterialManager::MaterialHandle handle) {
+        if (handle > 0xFFFFu) return false;
+        material = static_cast<uint16_t>(handle);
+        return true;
+    }
+    MaterialManager::MaterialHandle GetMaterial() const { return material; }
+
+    void SetColor(const DirectX::XMFLOAT3& rgb) {
+        const auto toByte = [](float c) { return static_cast<uint32_t>((c < 0.0f ? 0.0f : c > 1.0f ? 1.0f : c) * 255.0f + 0.5f); };
+        color = toByte(rgb.x) | (toByte(rgb.y) << 8) | (toByte(rgb.z) << 16) | (255u << 24);
+    }
+
+    DirectX::XMFLOAT3 GetColor() const {
+        constexpr float scale = 1.0f / 255.0f;
+        return DirectX::XMFLOAT3{ (color & 0xFF) * scale, ((color >> 8) & 0xFF) * scale, ((color >> 16) & 0xFF) * scale };
+    }
+
+    void SetUv(const DirectX::XMFLOAT2& offset, const DirectX::XMFLOAT2& scale) {
+        uv[0] = DirectX::PackedVector::XMConvertFloatToHalf(offset.x);
+        uv[1] = DirectX::PackedVector::XMConvertFloatToHalf(offset.y);
+        uv[2] = DirectX::PackedVector::XMConvertFloatToHalf(scale.x);
+        uv[3] = DirectX::PackedVector::XMConvertFloatToHalf(scale.y);
+    }
+
+    DirectX::XMFLOAT2 UvOffset() const {
+        return DirectX::XMFLOAT2{ DirectX::PackedVector::XMConvertHalfToFloat(uv[0]), DirectX::PackedVector::XMConvertHalfToFloat(uv[1]) };
+    }
+
+    DirectX::XMFLOAT2 UvScale() const {
+        return DirectX::XMFLOAT2{ DirectX::PackedVector::XMConvertHalfToFloat(uv[2]), DirectX::PackedVector::XMConvertHalfToFloat(uv[3]) };
+    }
+};
+
+static_assert(sizeof(PackedMeshRenderer) == 16, "PackedMeshRenderer must stay 16 bytes");
@@ -0,0 +1,62 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+
+/**
+ * @file ParticleEmitter.h
+ * @brief GPUパーティクルの放出元コンポーネントの定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform と ParticleEmitter を持つエンティティから、RenderSystem が毎フレーム粒子を放出します。
+ * 放出・移動・寿命の判定・描画はすべてコンピュートシェーダーと間接描画で行うため(ParticleSystem)、
+ * CPU側の負荷は粒子数ではなく放出元の数に比例します。
+ */
+
+/**
+ * @struct ParticleEmitter
+ * @brief 粒子の放出元(位置と向きは同じエンティティの Transform)
+ *
+ * @details
+ * rate による連続放出に加えて、burstId を変えるたびに burstCount 個を一度に放出します
+ * (ゲーム側は burstId を1増やすだけでよく、放出済みかどうかの管理は RenderSystem が行います)。
+ * 生成時に burstId を 1 以上にしておくと、最初の描画で1回放出します。
+ *
+ * 放出後の粒子は放出元と独立して動くため、エンティティを破棄しても残りの寿命の間は描画されます。
+ *
+ * @par 使用例
+ * @code
+ * // 爆発(連続放出なし、生成時に1回だけ放出)
+ * ParticleEmitter burst;
+ * burst.rate = 0.0f;
+ * burst.burstCount = 2000;
+ * burst.burstId = 1;
+ * burst.spreadAngle = 180.0f;
+ * world.Create()
+ *     .With<Transform>(position)
+ *     .With<ParticleEmitter>(burst)
+ *     .Build();
+ * // 放出した粒子は寿命まで残るため、エンティティは次のフレーム以降いつ破棄してもよい
+ * @endcode
+ */
+struct ParticleEmitter {
+    float rate = 50.0f;                                   ///< 毎秒の放出数(0 で連続放出なし)
+    uint32_t burstCount = 0;                              ///< burstId を変えたときに放出する数
+    uint32_t burstId = 0;                                 ///< 変えるたびに burstCount 個を放出する
+    float lifetimeMin = 1.0f;                             ///< 寿命の最小(秒)
+    float lifetimeMax = 2.0f;                             ///< 寿命の最大(秒)
+    float speedMin = 1.0f;                                ///< 初速の最小
+    float speedMax = 3.0f;                                ///< 初速の最大
+    DirectX::XMFLOAT3 direction{ 0.0f, 1.0f, 0.0f };      ///< ローカル空間の放出方向(Transform の回転を掛ける)
+    float spreadAngle = 25.0f;                            ///< 放出方向からの最大の角度(度、180 で全方向)
+    float spawnRadius = 0.0f;                             ///< 放出位置のばらつき(球の半径)
+    DirectX::XMFLOAT3 acceleration{ 0.0f, -9.8f, 0.0f };  ///< ワールド空間の加速度(重力など)
+    float drag = 0.0f;                                    ///< 速度の減衰(毎秒の割合)
+    DirectX::XMFLOAT4 startColor{ 1.0f, 0.8f, 0.3f, 1.0f }; ///< 放出時の色(加算合成、a は明るさに掛ける)
+    DirectX::XMFLOAT4 endColor{ 1.0f, 0.2f, 0.0f, 0.0f };   ///< 寿命の終わりの色
+    float startSize = 0.15f;                              ///< 放出時の大きさ(ビルボードの半分の幅)
+    float endSize = 0.05f;                                ///< 寿命の終わりの大きさ
+    bool enabled = true;                                  ///< false の間は連続放出を止める(バーストと放出済みの粒子はそのまま)
+};
@@ -15,8 +15,7 @@
 #include "ecs/World.h"
 #include "components/Transform.h"
 #include "components/MeshRenderer.h"
-#include "input/InputSystem.h"
-#include "input/GamepadSystem.h"
+#include "input/InputActions.h"
 #include <DirectXMath.h>
 
 // ========================================================
@@ -41,16 +40,17 @@
  * .Build();
  *
  * auto& movement = world.Add<PlayerMovement>(player);
- * movement.input_ = &GetInput();
+ * movement.actions_ = &ServiceLocator::Get<InputActions>();
  * movement.speed =8.0f;
  * @endcode
  *
- * @note InputSystemへの参照を設定する必要があります
- * @see InputSystem
+ * @note InputActionsへの参照を設定する必要があります("MoveX" / "MoveY" を読みます)
+ * @see InputActions
  */
 struct PlayerMovement : Behaviour {
-    InputSystem *input_ = nullptr;             ///< 入力システムへのポインタ
-    GamepadSystem *gamepad_ = nullptr;         ///< ゲームパッドシステムへのポインタ
+    const InputActions *actions_ = nullptr;    ///< 評価済みのアクションへのポインタ
+    InputActions::ActionId moveX_ = InputActions::INVALID_ACTION; ///< "MoveX"(最初の更新で引く)
+    InputActions::ActionId moveY_ = InputActions::INVALID_ACTION; ///< "MoveY"(最初の更新で引く)
     float speed = 10.0f;                        ///< 移動速度(単位/秒) - 速度を上げて動きを明確に
     DirectX::XMFLOAT2 velocity = {0.0f, 0.0f}; ///< 現在の移動ベロシティ
 
@@ -61,49 +61,20 @@ struct PlayerMovement : Behaviour {
      * @param[in] dt デルタタイム(前フレームからの経過時間)
      *
      * @details
-     * スティック入力を読み取り、プレイヤーの位置とベロシティを更新します。
-     * キーボード入力とすべての接続されているゲームパッド（XInput + DirectInput）の入力を統合します。
+     * "MoveX" / "MoveY" アクションの評価済みの値(キーボードとすべてのゲームパッドの統合値)を読み取り、
+     * プレイヤーの位置とベロシティを更新します。
      * 入力がない場合は最後のベロシティに基づいて移動を続けます。
      */
     void OnUpdate(World &w, Entity self, float dt) override {
         auto *t = w.TryGet<Transform>(self);
-        if (!t || (!input_ && !gamepad_))
+        if (!t || !actions_)
             return;
 
-        DirectX::XMFLOAT2 inputDir = {0.0f, 0.0f};
-
-        // キーボード入力の処理
-        if (input_) {
-            if (input_->GetKey('W') || input_->GetKey(VK_UP)) {
-                inputDir.y += 1.0f;
-            }
-            if (input_->GetKey('S') || input_->GetKey(VK_DOWN)) {
-                inputDir.y -= 1.0f;
-            }
-            if (input_->GetKey('A') || input_->GetKey(VK_LEFT)) {
-                inputDir.x -= 1.0f;
-            }
-            if (input_->GetKey('D') || input_->GetKey(VK_RIGHT)) {
-                inputDir.x += 1.0f;
-            }
-        }
-
-        // すべての接続されているゲームパッドの入力を統合（XInput + DirectInput）
-        if (gamepad_) {
-            float gx = gamepad_->GetLeftStickX();
-            float gy = gamepad_->GetLeftStickY();
-
-#ifdef _DEBUG
-            static int debugCounter = 0;
-            if (debugCounter % 30 == 0 && (gx != 0.0f || gy != 0.0f)) {  // 入力があるときだけログ出力
-                DEBUGLOG("PlayerMovement: Gamepad input - LX=" + std::to_string(gx) + ", LY=" + std::to_string(gy));
-            }
-            debugCounter++;
-#endif
-
-            inputDir.x += gx;
-            inputDir.y += gy;
+        if (moveX_ == InputActions::INVALID_ACTION) {
+            moveX_ = actions_->Find("MoveX");
+            moveY_ = actions_->Find("MoveY");
         }
+        const DirectX::XMFLOAT2 inputDir = {actions_->Value(moveX_), actions_->Value(moveY_)};
 
         // 入力がある場合はベロシティを更新
         if (inputDir.x != 0.0f || inputDir.y != 0.0f) {
@@ -21,6 +21,20 @@ struct Rotator : Behaviour {
         auto* t = w.TryGet<Transform>(self);
         if (!t) return; // Transformがなければ何もしない
 
+        // クォータニオンモード: 1フレーム分の回転を掛け合わせるだけ(dtが変わらなければ三角関数なし)
+        if (t->useQuaternion) {
+            if (dt != cachedDt_ || speedDegY != cachedSpeed_) {
+                cachedDt_ = dt;
+                cachedSpeed_ = speedDegY;
+                DirectX::XMStoreFloat4(&step_, DirectX::XMQuaternionRotationRollPitchYaw(
+                    0.0f, DirectX::XMConvertToRadians(speedDegY * dt), 0.0f));
+            }
+            DirectX::XMVECTOR q = DirectX::XMQuaternionMultiply(
+                DirectX::XMLoadFloat4(&t->orientation), DirectX::XMLoadFloat4(&step_));
+            DirectX::XMStoreFloat4(&t->orientation, DirectX::XMQuaternionNormalize(q));
+            return;
+        }
+
         // 回転値を更新(dt = デルタタイム = 前フレームからの経過時間)
         t->rotation.y += speedDegY * dt;
 
@@ -28,4 +42,9 @@ struct Rotator : Behaviour {
         while (t->rotation.y >= 360.0f) t->rotation.y -= 360.0f;
         while (t->rotation.y < 0.0f) t->rotation.y += 360.0f;
     }
+
+private:
+    float cachedDt_ = -1.0f;                            ///< step_ を計算したときのdt
+    float cachedSpeed_ = 0.0f;                          ///< step_ を計算したときの回転速度
+    DirectX::XMFLOAT4 step_{ 0.0f, 0.0f, 0.0f, 1.0f };  ///< 1フレーム分のY軸回転
 };
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file ScriptInstance.h
+ * @brief ゲームプレイのスクリプト(ScriptLibrary で作成)を実行するコンポーネントの定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform と ScriptInstance を持つエンティティは、ScriptSystem が同じスクリプトのものをまとめて実行します。
+ * スクリプトの param / local の値はエンティティごとに slots に宣言順で入ります(Behaviour のメンバー変数に相当)。
+ *
+ * ScriptLibrary::MakeInstance() で作ると param の既定値が入り、ScriptLibrary::SetParam() で個別に上書きできます。
+ * script だけを設定した場合や、スクリプトを読み込み直して param / local の並びが変わった場合は、
+ * ScriptSystem が既定値を入れ直して start から実行し直します。
+ *
+ * @par 使用例
+ * @code
+ * ScriptLibrary& scripts = ServiceLocator::Get<ScriptLibrary>();
+ * ScriptInstance bouncer = scripts.MakeInstance(scripts.LoadFile("Assets/Scripts/bouncer.script"));
+ * scripts.SetParam(bouncer, "amplitude", 3.0f);
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{ 0, 0, 0 })
+ *     .With<MeshRenderer>(DirectX::XMFLOAT3{ 0, 1, 0 })
+ *     .With<ScriptInstance>(bouncer)
+ *     .Build();
+ * @endcode
+ */
+struct ScriptInstance {
+    static constexpr uint32_t MAX_SLOTS = 16;           ///< param と local の合計の上限
+    static constexpr uint16_t NO_SCRIPT = 0xFFFF;
+
+    uint16_t script = NO_SCRIPT;    ///< ScriptLibrary のスクリプトの番号
+    uint16_t layout = 0;            ///< slots を初期化したときのスクリプトの並びの番号(0 は未初期化)
+    uint32_t started = 0;           ///< start を実行済みか(ScriptSystem が設定)
+    float slots[MAX_SLOTS] = {};    ///< param / local の値(宣言順)
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file SpatialBody.h
+ * @brief 空間ハッシュグリッドに登録する当たりの大きさとレイヤーの定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform と SpatialBody を持つエンティティは SpatialHashGrid に登録され、
+ * 半径・AABB の近傍検索と、重なっている組(ブロードフェーズ)の列挙の対象になります。
+ */
+
+/**
+ * @struct SpatialBody
+ * @brief 近傍検索・当たり判定で使う球の半径とレイヤー
+ *
+ * @details
+ * 球の中心は Transform::position です(親子階層は考慮しません)。
+ * 組の列挙では、互いの layer が相手の mask に含まれる場合だけ組になります。
+ *
+ * @par 使用例
+ * @code
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{0, 5, 0})
+ *     .With<SpatialBody>(SpatialBody{ 0.5f, SpatialBody::LAYER_ENEMY, SpatialBody::LAYER_PLAYER })
+ *     .Build();
+ * @endcode
+ */
+struct SpatialBody {
+    static constexpr uint32_t LAYER_DEFAULT = 1u << 0; ///< 既定
+    static constexpr uint32_t LAYER_PLAYER = 1u << 1;  ///< プレイヤー
+    static constexpr uint32_t LAYER_ENEMY = 1u << 2;   ///< 敵
+
+    float radius = 0.5f;             ///< 球の半径
+    uint32_t layer = LAYER_DEFAULT;  ///< 自分のレイヤー(ビット)
+    uint32_t mask = 0xFFFFFFFFu;     ///< 組になる相手のレイヤー(ビット)
+};
@@ -0,0 +1,47 @@
+/**
+ * @file Sprite.h
+ * @brief 画面座標に描く2Dスプライトのコンポーネント
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * HUD やスクリーン上の2D要素を、MeshRenderer の Plane(3Dのパス)ではなく SpriteBatch でまとめて描きます。
+ * 位置と大きさはウィンドウのピクセル(左上が原点)で、Transform は使いません。
+ * App はシーンの拡大(GfxDevice::ResolveScene)の後、ウィンドウの解像度で全スプライトを描きます。
+ *
+ * SpriteAnimation / SpriteSheetAnimation と一緒に持たせると、SpriteAnimationSystem が
+ * MeshRenderer と同じように texture / uvOffset / uvScale を書き換えます。
+ */
+#pragma once
+#include "graphics/TextureManager.h"
+#include <DirectXMath.h>
+#include <cstdint>
+
+/**
+ * @struct Sprite
+ * @brief 2Dスプライト(1枚の四角形)
+ *
+ * @par 使用例
+ * @code
+ * Sprite icon;
+ * icon.position = DirectX::XMFLOAT2{ 64.0f, 64.0f };
+ * icon.size = DirectX::XMFLOAT2{ 48.0f, 48.0f };
+ * icon.texture = texManager.LoadFromFile("heart.png");
+ * icon.layer = 10;                                  // 大きいほど手前
+ * world.Create().With<Sprite>(icon).Build();
+ * @endcode
+ *
+ * @note 同じ layer の中ではテクスチャごとにまとめて描くため、テクスチャの違うスプライトの前後は決まりません。
+ *       重なる要素は layer で前後を指定してください(同じテクスチャ同士は追加順)。
+ */
+struct Sprite {
+    DirectX::XMFLOAT2 position{ 0.0f, 0.0f };                               ///< 中心の位置(ピクセル、左上が原点)
+    DirectX::XMFLOAT2 size{ 32.0f, 32.0f };                                 ///< 幅・高さ(ピクセル)
+    float rotation = 0.0f;                                                  ///< 中心まわりの回転(度、時計回り)
+    DirectX::XMFLOAT4 color{ 1.0f, 1.0f, 1.0f, 1.0f };                      ///< 乗算する色(a は不透明度)
+    TextureManager::TextureHandle texture = TextureManager::INVALID_TEXTURE; ///< テクスチャ(INVALID_TEXTURE なら単色)
+    DirectX::XMFLOAT2 uvOffset{ 0.0f, 0.0f };                               ///< UVの左上(アトラスの矩形)
+    DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };                                ///< UVの幅・高さ
+    int16_t layer = 0;                                                      ///< 描画の前後(大きいほど手前)
+};
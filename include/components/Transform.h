@@ -1,12 +1,13 @@
 ﻿#pragma once
 #include <DirectXMath.h>
+#include <cmath>
 
 /**
  * @file Transform.h
  * @brief 位置・回転・スケールコンポーネントの定義
  * @author 山内陽
  * @date 2025
- * @version 4.0
+ * @version 4.1
  * 
  * @details
  * このファイルは3D空間におけるエンティティの基本的な変換情報を管理する
@@ -61,6 +62,13 @@
  * });
  * @endcode
  * 
+ * @par 使用例(クォータニオン)
+ * @code
+ * // 回転をクォータニオンで保持すると、行列計算で三角関数を使わない
+ * transform.UseQuaternion();
+ * DirectX::XMFLOAT3 euler = transform.GetRotationDegrees(); // 従来のオイラー角でも読み書き可能
+ * @endcode
+ * 
  * @note すべての3Dオブジェクトに推奨されるコンポーネントです
  * @warning 回転角度は度数法(0-360度)で指定します(ラジアンではありません)
  * 
@@ -183,4 +191,124 @@ struct Transform {
      * @warning 負の値を使用するとメッシュが裏返ります
      */
     DirectX::XMFLOAT3 scale{ 1, 1, 1 };
+
+    /**
+     * @var orientation
+     * @brief クォータニオンによる回転(useQuaternion が true のときのみ有効)
+     *
+     * @details
+     * 有効な場合、行列計算は rotation(オイラー角)の代わりにこの値を直接使うため、
+     * エンティティごとの三角関数計算が不要になります。
+     * SetOrientation() か UseQuaternion() で有効にします。
+     */
+    DirectX::XMFLOAT4 orientation{ 0, 0, 0, 1 };
+
+    /**
+     * @var useQuaternion
+     * @brief 回転を orientation で保持しているか(false なら rotation を使用)
+     */
+    bool useQuaternion = false;
+
+    /**
+     * @brief 現在の rotation を orientation に変換し、以降クォータニオンで回転を保持する
+     */
+    void UseQuaternion() {
+        if (useQuaternion) return;
+        orientation = EulerDegreesToQuaternion(rotation);
+        useQuaternion = true;
+    }
+
+    /**
+     * @brief クォータニオンで回転を設定(クォータニオンモードになる)
+     * @param[in] q 正規化済みのクォータニオン
+     */
+    void SetOrientation(const DirectX::XMFLOAT4& q) {
+        orientation = q;
+        useQuaternion = true;
+    }
+
+    /**
+     * @brief オイラー角(度数法)で回転を設定(どちらのモードでも使用可)
+     */
+    void SetRotationDegrees(const DirectX::XMFLOAT3& degrees) {
+        if (useQuaternion) {
+            orientation = EulerDegreesToQuaternion(degrees);
+        } else {
+            rotation = degrees;
+        }
+    }
+
+    /**
+     * @brief オイラー角(度数法)で回転を取得(どちらのモードでも使用可)
+     */
+    DirectX::XMFLOAT3 GetRotationDegrees() const {
+        return useQuaternion ? QuaternionToEulerDegrees(orientation) : rotation;
+    }
+
+    /**
+     * @brief 回転をクォータニオンで取得
+     */
+    DirectX::XMVECTOR GetOrientationVector() const {
+        if (useQuaternion) {
+            return DirectX::XMLoadFloat4(&orientation);
+        }
+        return DirectX::XMQuaternionRotationRollPitchYaw(
+            DirectX::XMConvertToRadians(rotation.x),
+            DirectX::XMConvertToRadians(rotation.y),
+            DirectX::XMConvertToRadians(rotation.z));
+    }
+
+    /**
+     * @brief ローカル行列(スケール → 回転 → 平行移動)を計算
+     */
+    DirectX::XMMATRIX ToMatrix() const {
+        return DirectX::XMMatrixAffineTransformation(
+            DirectX::XMVectorSet(scale.x, scale.y, scale.z, 0.0f),
+            DirectX::XMVectorZero(),
+            GetOrientationVector(),
+            DirectX::XMVectorSet(position.x, position.y, position.z, 1.0f));
+    }
+
+    /**
+     * @brief オイラー角(度数法、Y→X→Zの適用順)をクォータニオンに変換
+     */
+    static DirectX::XMFLOAT4 EulerDegreesToQuaternion(const DirectX::XMFLOAT3& degrees) {
+        DirectX::XMFLOAT4 q;
+        DirectX::XMStoreFloat4(&q, DirectX::XMQuaternionRotationRollPitchYaw(
+            DirectX::XMConvertToRadians(degrees.x),
+            DirectX::XMConvertToRadians(degrees.y),
+            DirectX::XMConvertToRadians(degrees.z)));
+        return q;
+    }
+
+    /**
+     * @brief クォータニオンをオイラー角(度数法)に変換
+     *
+     * @details
+     * XMMatrixRotationRollPitchYaw と同じ軸順で分解します。
+     * ピッチが±90度付近(ジンバルロック)ではロールを0としてヨーに寄せます。
+     */
+    static DirectX::XMFLOAT3 QuaternionToEulerDegrees(const DirectX::XMFLOAT4& q) {
+        DirectX::XMFLOAT4X4 m;
+        DirectX::XMStoreFloat4x4(&m, DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&q)));
+
+        float sinPitch = -m._32;
+        if (sinPitch > 1.0f) sinPitch = 1.0f;
+        if (sinPitch < -1.0f) sinPitch = -1.0f;
+
+        float pitch = std::asin(sinPitch);
+        float yaw;
+        float roll;
+        if (std::fabs(sinPitch) < 0.9999f) {
+            yaw = std::atan2(m._31, m._33);
+            roll = std::atan2(m._12, m._22);
+        } else {
+            yaw = std::atan2(-m._13, m._11);
+            roll = 0.0f;
+        }
+        return DirectX::XMFLOAT3{
+            DirectX::XMConvertToDegrees(pitch),
+            DirectX::XMConvertToDegrees(yaw),
+            DirectX::XMConvertToDegrees(roll) };
+    }
 };
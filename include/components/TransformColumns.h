@@ -0,0 +1,248 @@
+#pragma once
+#include "components/Transform.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file TransformColumns.h
+ * @brief Transform をSIMD向けの列(x/y/z ごとの float 配列)に並べ替えて処理するための作業領域
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform のコンポーネント本体は XMFLOAT3 を並べた構造体(AoS)のままです
+ * (アドレスが安定し、Transform& を受け取る既存のコードがそのまま動くため)。
+ * 多数のエンティティに同じ計算をするシステムは、必要な列だけを Gather() で 8 要素単位のブロック
+ * (x[8], y[8], z[8] の AoSoA)に集め、ブロック単位のベクトル演算の後に Scatter() で書き戻します。
+ *
+ * 1ブロックは 8 レーン(32 バイト境界)なので、/arch:AVX のビルドでは 256 ビット、
+ * 既定のビルドでは DirectXMath の 128 ビット演算2回でそのまま処理できます。
+ * 要素数が 8 の倍数でない場合、最後のブロックの余りのレーンは 0 で埋めます(結果は書き戻さない)。
+ *
+ * 列の要素には columns.position[i].x のように、Transform と同じ書き方でアクセスできます。
+ */
+
+/**
+ * @struct Float3Block
+ * @brief 8 要素分の x / y / z の列
+ */
+struct alignas(32) Float3Block {
+    static constexpr size_t LANES = 8;  ///< 1ブロックの要素数
+
+    float x[LANES];
+    float y[LANES];
+    float z[LANES];
+};
+
+/**
+ * @struct Float3Ref
+ * @brief 列の1要素への参照(XMFLOAT3 と同じく .x / .y / .z で読み書きする)
+ */
+struct Float3Ref {
+    float& x;
+    float& y;
+    float& z;
+
+    operator DirectX::XMFLOAT3() const { return DirectX::XMFLOAT3{ x, y, z }; }
+
+    Float3Ref& operator=(const DirectX::XMFLOAT3& value) {
+        x = value.x;
+        y = value.y;
+        z = value.z;
+        return *this;
+    }
+};
+
+/**
+ * @class Float3Columns
+ * @brief XMFLOAT3 の配列を x / y / z の列として保持する(8 要素ブロック単位)
+ */
+class Float3Columns {
+public:
+    static constexpr size_t LANES = Float3Block::LANES;
+
+    /**
+     * @brief 要素数を変更(増えたレーンは 0、容量は残して使い回す)
+     */
+    void Resize(size_t count) {
+        size_ = count;
+        blocks_.resize((count + LANES - 1) / LANES, Float3Block{});
+        clearTail();
+    }
+
+    size_t Size() const { return size_; }
+    size_t BlockCount() const { return blocks_.size(); }
+    Float3Block* Blocks() { return blocks_.data(); }
+    const Float3Block* Blocks() const { return blocks_.data(); }
+
+    Float3Ref operator[](size_t i) {
+        Float3Block& block = blocks_[i / LANES];
+        const size_t lane = i % LANES;
+        return Float3Ref{ block.x[lane], block.y[lane], block.z[lane] };
+    }
+
+    DirectX::XMFLOAT3 Get(size_t i) const {
+        const Float3Block& block = blocks_[i / LANES];
+        const size_t lane = i % LANES;
+        return DirectX::XMFLOAT3{ block.x[lane], block.y[lane], block.z[lane] };
+    }
+
+    /**
+     * @brief this += a * scale(全ブロック)
+     */
+    void MultiplyAdd(const Float3Columns& a, float scale) {
+        using namespace DirectX;
+        const XMVECTOR s = XMVectorReplicate(scale);
+        const size_t count = (std::min)(blocks_.size(), a.blocks_.size());
+        for (size_t b = 0; b < count; ++b) {
+            Float3Block& out = blocks_[b];
+            const Float3Block& in = a.blocks_[b];
+            multiplyAdd(out.x, in.x, s);
+            multiplyAdd(out.y, in.y, s);
+            multiplyAdd(out.z, in.z, s);
+        }
+    }
+
+    /**
+     * @brief 要素ごとに this *= factor[i](全ブロック、factor は要素数 BlockCount() * LANES 以上、境界の指定なし)
+     */
+    void MultiplyPerElement(const float* factor) {
+        using namespace DirectX;
+        for (size_t b = 0; b < blocks_.size(); ++b) {
+            Float3Block& out = blocks_[b];
+            const float* f = factor + b * LANES;
+            for (size_t half = 0; half < LANES; half += 4) {
+                const XMVECTOR scale = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(f + half));
+                multiply4(out.x + half, scale);
+                multiply4(out.y + half, scale);
+                multiply4(out.z + half, scale);
+            }
+        }
+    }
+
+private:
+    static void multiplyAdd(float* out, const float* in, DirectX::FXMVECTOR s) {
+        using namespace DirectX;
+        for (size_t half = 0; half < LANES; half += 4) {
+            XMFLOAT4A* o = reinterpret_cast<XMFLOAT4A*>(out + half);
+            const XMVECTOR value = XMVectorMultiplyAdd(XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(in + half)), s, XMLoadFloat4A(o));
+            XMStoreFloat4A(o, value);
+        }
+    }
+
+    static void multiply4(float* out, DirectX::FXMVECTOR scale) {
+        using namespace DirectX;
+        XMFLOAT4A* o = reinterpret_cast<XMFLOAT4A*>(out);
+        XMStoreFloat4A(o, XMVectorMultiply(XMLoadFloat4A(o), scale));
+    }
+
+    void clearTail() {
+        if (blocks_.empty()) return;
+        Float3Block& last = blocks_.back();
+        for (size_t lane = size_ - (blocks_.size() - 1) * LANES; lane < LANES; ++lane) {
+            last.x[lane] = 0.0f;
+            last.y[lane] = 0.0f;
+            last.z[lane] = 0.0f;
+        }
+    }
+
+    std::vector<Float3Block> blocks_;
+    size_t size_ = 0;
+};
+
+/**
+ * @struct TransformRef
+ * @brief TransformColumns の1要素への参照(t.position.x と同じ書き方)
+ */
+struct TransformRef {
+    Float3Ref position;
+    Float3Ref rotation;
+    Float3Ref scale;
+};
+
+/**
+ * @class TransformColumns
+ * @brief Transform の位置・回転(オイラー角)・スケールの列と、書き戻し先
+ *
+ * @par 使用例
+ * @code
+ * columns.Begin();
+ * query.ForEach([&](Entity, Transform& t, Velocity&) { columns.Add(t); });
+ * columns.Gather(TransformColumns::POSITION);
+ * columns.position.MultiplyAdd(velocities, dt);  // 8 要素ずつ
+ * columns[0].position.x += 1.0f;                 // 1要素の読み書き
+ * columns.Scatter(TransformColumns::POSITION);
+ * @endcode
+ *
+ * @note 回転の列はオイラー角(Transform::rotation)です。クォータニオンで保持する Transform の向きは扱いません
+ */
+class TransformColumns {
+public:
+    /**
+     * @brief Gather() / Scatter() する列
+     */
+    enum Field : uint32_t {
+        POSITION = 1u << 0,
+        ROTATION = 1u << 1,
+        SCALE = 1u << 2,
+        ALL = POSITION | ROTATION | SCALE,
+    };
+
+    /**
+     * @brief 書き戻し先の登録を始める(前回の一覧を空にする)
+     */
+    void Begin() { sources_.clear(); }
+
+    /**
+     * @brief 書き戻し先を追加(コンポーネントのアドレスは削除まで変わらない)
+     */
+    void Add(Transform& t) { sources_.push_back(&t); }
+
+    /**
+     * @brief 追加した Transform の fields を列に集める
+     */
+    void Gather(uint32_t fields = ALL) {
+        const size_t count = sources_.size();
+        if (fields & POSITION) position.Resize(count);
+        if (fields & ROTATION) rotation.Resize(count);
+        if (fields & SCALE) scale.Resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const Transform& t = *sources_[i];
+            if (fields & POSITION) position[i] = t.position;
+            if (fields & ROTATION) rotation[i] = t.rotation;
+            if (fields & SCALE) scale[i] = t.scale;
+        }
+    }
+
+    /**
+     * @brief 列の fields を追加した Transform に書き戻す
+     */
+    void Scatter(uint32_t fields = ALL) const {
+        for (size_t i = 0; i < sources_.size(); ++i) {
+            Transform& t = *sources_[i];
+            if (fields & POSITION) t.position = position.Get(i);
+            if (fields & ROTATION) t.rotation = rotation.Get(i);
+            if (fields & SCALE) t.scale = scale.Get(i);
+        }
+    }
+
+    size_t Size() const { return sources_.size(); }
+
+    /**
+     * @brief 1要素の位置・回転・スケール(ALL を Gather() した後に使用)
+     */
+    TransformRef operator[](size_t i) {
+        return TransformRef{ position[i], rotation[i], scale[i] };
+    }
+
+    Float3Columns position;  ///< 位置の列
+    Float3Columns rotation;  ///< 回転(度)の列
+    Float3Columns scale;     ///< スケールの列
+
+private:
+    std::vector<Transform*> sources_;  ///< 書き戻し先(列の要素と同じ順)
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "ecs/Entity.h"
+#include "components/Transform.h"
+#include <DirectXMath.h>
+#include <cstdint>
+
+/**
+ * @file TransformHierarchy.h
+ * @brief ワールド行列キャッシュと親子関係のコンポーネント定義
+ * @author 山内陽
+ * @date 2025
+ * @version 1.1
+ *
+ * @details
+ * TransformSystem が Transform からワールド行列を計算して LocalToWorld に保持します。
+ * Parent を持つエンティティの Transform は親からの相対値として扱われます。
+ * 子の一覧は World の親子関係(World::ForEachChild())から引きます。
+ */
+
+/**
+ * @struct LocalToWorld
+ * @brief キャッシュ済みのワールド行列
+ *
+ * @details
+ * Transform を持つエンティティには TransformSystem が自動で追加します。
+ * 行列を計算したときの Transform を source に保持し、値が変わったときだけ再計算します。
+ * 再計算の直前の行列を previous に残すため、描画は固定ステップの間を補間できます。
+ *
+ * @note 直接書き換えないでください(次の更新で上書きされます)
+ */
+struct LocalToWorld {
+    DirectX::XMFLOAT4X4 matrix{
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        0, 0, 0, 1 };       ///< ワールド行列(行優先、S * R * T * 親)
+    DirectX::XMFLOAT4X4 previous{
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        0, 0, 0, 1 };       ///< 直前の再計算の前のワールド行列(movedStep の更新で matrix になった)
+    Transform source;       ///< 計算に使用したローカルTransform
+    uint32_t movedStep = 0; ///< 最後に行列が変わった TransformSystem の更新番号(TransformSystem::StepCount())
+    bool valid = false;     ///< 一度でも計算済みか
+};
+
+/**
+ * @struct Parent
+ * @brief 親エンティティへのリンク
+ *
+ * @note 追加・解除は TransformSystem::SetParent() / ClearParent() を使用してください(World の親子関係と対で更新するため)
+ *       World と食い違う場合(MergeFrom()・Deserialize() の後など)は、TransformSystem の更新で Parent に合わせて直します
+ */
+struct Parent {
+    Entity entity{};        ///< 親エンティティ
+};
@@ -0,0 +1,48 @@
+/**
+ * @file VideoSurface.h
+ * @brief VideoPlayer のフレームを描く面のコンポーネント
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * RenderSystem は VideoPlayer::GetFrame() のテクスチャを直接サンプリングして描きます。
+ * ハードウェアデコード時は NV12 の輝度・色差から描画中に RGB へ変換するため、RGB のテクスチャへの変換パスも
+ * CPU のコピーもありません。新しいフレームが届かない間は前のフレームをそのまま描きます。
+ *
+ * - fullscreen が false: Transform の位置・向きで、ローカルの XY 平面に size の大きさの四角形を描く(ゲーム内の画面)
+ * - fullscreen が true: 3D の描画の最後に画面全体へ描く(カットシーン)。Transform は不要
+ *
+ * 再生の進行(VideoPlayer::Update())は VideoPlayback などで行ってください。
+ */
+#pragma once
+#include <DirectXMath.h>
+
+class VideoPlayer;
+
+/**
+ * @struct VideoSurface
+ * @brief 動画を描く面
+ *
+ * @par 使用例
+ * @code
+ * VideoSurface screen;
+ * screen.player = &player;
+ * screen.size = DirectX::XMFLOAT2{ 3.2f, 1.8f };
+ * world.Create().With<Transform>(DirectX::XMFLOAT3{ 0, 2, 5 }).With<VideoSurface>(screen).Build();
+ *
+ * VideoSurface cutscene;
+ * cutscene.player = &intro;
+ * cutscene.fullscreen = true;
+ * world.Create().With<VideoSurface>(cutscene).Build();
+ * @endcode
+ *
+ * @note player はエンティティより長く生存させてください(RenderSnapshot もポインタだけを写します)。
+ */
+struct VideoSurface {
+    VideoPlayer* player = nullptr;                       ///< 描くフレームの VideoPlayer(nullptr なら描かない)
+    DirectX::XMFLOAT2 size{ 1.6f, 0.9f };                ///< 四角形の幅・高さ(ローカル空間、fullscreen では無視)
+    DirectX::XMFLOAT4 tint{ 1.0f, 1.0f, 1.0f, 1.0f };    ///< 乗算する色(a は使わない、不透明で描く)
+    bool fullscreen = false;                             ///< 画面全体に描くか
+    bool preserveAspect = true;                          ///< fullscreen のとき動画の縦横比を保つか(余白は黒)
+};
@@ -0,0 +1,227 @@
+#pragma once
+#include "ecs/Entity.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @file CommandBuffer.h
+ * @brief 構造変更(生成/追加/削除/破棄)を記録して後で反映するコマンドバッファ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ワーカースレッドから World の構造を直接変更する代わりに、操作をスレッドごとの
+ * バッファへ記録し、World::Tick() の開始時と終了時にメインスレッドでまとめて反映します。
+ * 記録はロックを取らず、コンポーネント引数は固定サイズブロックの線形アリーナへ構築します。
+ */
+
+class World;
+
+/**
+ * @class CommandBuffer
+ * @brief 1スレッド専用の構造変更コマンド列
+ *
+ * @details
+ * World::GetCommandBuffer() で現在のスレッド用のバッファを取得します。
+ * CreateEntity() が返すハンドルは反映時に実際のエンティティへ置き換わる仮ハンドルで、
+ * 同じバッファの Add/Remove/Destroy にだけ使用できます。
+ *
+ * @par 使用例
+ * @code
+ * world.ParallelForEach<Transform, Weapon>([&world](Entity e, Transform& t, Weapon& w) {
+ *     if (!w.fire) return;
+ *     CommandBuffer& cmd = world.GetCommandBuffer();
+ *     Entity bullet = cmd.CreateEntity(World::Cause::Spawner);
+ *     cmd.Add<Transform>(bullet, t.position);
+ *     cmd.Add<Bullet>(bullet);
+ * });
+ * @endcode
+ *
+ * @note 1つのバッファを複数スレッドから同時に使用しないでください
+ */
+class CommandBuffer {
+public:
+    static constexpr uint32_t DEFERRED_ENTITY_BIT = 0x80000000u; ///< 仮ハンドルを示すIDビット
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;             ///< アリーナ1ブロックのサイズ
+
+    /**
+     * @enum Op
+     * @brief コマンドの種類
+     */
+    enum class Op : uint8_t {
+        Create,   ///< エンティティ生成
+        Add,      ///< コンポーネント追加
+        Remove,   ///< コンポーネント削除
+        Enable,   ///< コンポーネントの有効化・無効化
+        Destroy   ///< エンティティ破棄
+    };
+
+    using ApplyFn = void(*)(World& world, Entity target, EntityCause cause, void* payload);
+    using DestroyFn = void(*)(void* payload);
+
+    /**
+     * @struct Command
+     * @brief 記録された1件の操作
+     */
+    struct Command {
+        Op op;                 ///< 種類
+        EntityCause cause;     ///< 起因タグ
+        Entity target;         ///< 対象(仮ハンドルの場合あり)
+        ApplyFn apply;         ///< Add/Remove/Enable の実行関数
+        DestroyFn destroy;     ///< 引数オブジェクトの破棄関数(nullptr可)
+        void* payload;         ///< アリーナ上の引数オブジェクト
+    };
+
+    CommandBuffer() = default;
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    ~CommandBuffer() { Clear(); }
+
+    /**
+     * @brief エンティティ生成を記録
+     * @return Entity 仮ハンドル(反映時に実エンティティへ置き換え)
+     */
+    Entity CreateEntity(EntityCause cause = EntityCause::Unknown) {
+        Entity placeholder{ DEFERRED_ENTITY_BIT | createdCount_++, 0 };
+        commands_.push_back(Command{ Op::Create, cause, placeholder, nullptr, nullptr, nullptr });
+        return placeholder;
+    }
+
+    /**
+     * @brief World::ReserveEntity() で予約したエンティティの生成を記録
+     * @param[in] reserved 予約したハンドル
+     * @return Entity reserved(実ハンドルなので、他のバッファやコンポーネントからも参照できる)
+     */
+    Entity CreateReserved(Entity reserved, EntityCause cause = EntityCause::Unknown) {
+        commands_.push_back(Command{ Op::Create, cause, reserved, nullptr, nullptr, nullptr });
+        return reserved;
+    }
+
+    /**
+     * @brief コンポーネント追加を記録
+     * @tparam T 追加するコンポーネントの型(ムーブ構築可能であること)
+     * @param[in] e 対象(実ハンドルまたは同じバッファの仮ハンドル)
+     * @param[in] args コンストラクタ引数(この時点で T を構築して保持します)
+     */
+    template<class T, class... Args>
+    void Add(Entity e, Args&&... args) {
+        AddWithCause<T>(e, EntityCause::Unknown, std::forward<Args>(args)...);
+    }
+
+    template<class T, class... Args>
+    void AddWithCause(Entity e, EntityCause cause, Args&&... args) {
+        void* mem = allocate(sizeof(T), alignof(T));
+        T* obj = new (mem) T(std::forward<Args>(args)...);
+        commands_.push_back(Command{ Op::Add, cause, e, &applyAdd<World, T>, &destroyPayload<T>, obj });
+    }
+
+    /**
+     * @brief コンポーネント削除を記録
+     */
+    template<class T>
+    void Remove(Entity e) {
+        commands_.push_back(Command{ Op::Remove, EntityCause::Unknown, e, &applyRemove<World, T>, nullptr, nullptr });
+    }
+
+    /**
+     * @brief コンポーネントの有効・無効の切り替えを記録(反映時に World::SetEnabled へ渡します)
+     */
+    template<class T>
+    void SetEnabled(Entity e, bool enabled) {
+        ApplyFn apply = enabled ? &applySetEnabled<World, T, true> : &applySetEnabled<World, T, false>;
+        commands_.push_back(Command{ Op::Enable, EntityCause::Unknown, e, apply, nullptr, nullptr });
+    }
+
+    /**
+     * @brief エンティティ破棄を記録(反映時に World::DestroyEntityWithCause へ渡します)
+     */
+    void Destroy(Entity e, EntityCause cause = EntityCause::Unknown) {
+        commands_.push_back(Command{ Op::Destroy, cause, e, nullptr, nullptr, nullptr });
+    }
+
+    static bool IsDeferred(Entity e) { return (e.id & DEFERRED_ENTITY_BIT) != 0; }
+
+    bool Empty() const { return commands_.empty(); }
+    size_t CommandCount() const { return commands_.size(); }
+    uint32_t CreatedCount() const { return createdCount_; }
+    const std::vector<Command>& Commands() const { return commands_; }
+
+    /**
+     * @brief 全コマンドを破棄(アリーナのブロックは再利用のため保持)
+     */
+    void Clear() {
+        for (auto& cmd : commands_) {
+            if (cmd.destroy && cmd.payload) cmd.destroy(cmd.payload);
+        }
+        commands_.clear();
+        createdCount_ = 0;
+        currentBlock_ = 0;
+        offset_ = 0;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data; ///< ブロック本体
+        size_t size;                           ///< ブロックのバイト数
+    };
+
+    void* allocate(size_t size, size_t align) {
+        while (currentBlock_ < blocks_.size()) {
+            void* mem = tryAllocate(blocks_[currentBlock_], size, align);
+            if (mem) return mem;
+            ++currentBlock_;
+            offset_ = 0;
+        }
+
+        // 新しいブロックを末尾に追加(既存ブロックは移動しないため、記録済みの引数は無効にならない)
+        size_t blockSize = size + align > BLOCK_SIZE ? size + align : static_cast<size_t>(BLOCK_SIZE);
+        blocks_.push_back(Block{ std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize });
+        currentBlock_ = blocks_.size() - 1;
+        offset_ = 0;
+        return tryAllocate(blocks_.back(), size, align);
+    }
+
+    void* tryAllocate(Block& block, size_t size, size_t align) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get() + offset_);
+        size_t padding = (align - (address & (align - 1))) & (align - 1);
+        if (offset_ + padding + size > block.size) return nullptr;
+
+        void* mem = block.data.get() + offset_ + padding;
+        offset_ += padding + size;
+        return mem;
+    }
+
+    // W は World(関数テンプレートの実体化を World の定義後まで遅らせるため)
+    template<class W, class T>
+    static void applyAdd(W& world, Entity target, EntityCause cause, void* payload) {
+        world.template AddWithCause<T>(target, cause, std::move(*static_cast<T*>(payload)));
+    }
+
+    template<class W, class T>
+    static void applyRemove(W& world, Entity target, EntityCause, void*) {
+        world.template Remove<T>(target);
+    }
+
+    template<class W, class T, bool Enabled>
+    static void applySetEnabled(W& world, Entity target, EntityCause, void*) {
+        world.template SetEnabled<T>(target, Enabled);
+    }
+
+    template<class T>
+    static void destroyPayload(void* payload) {
+        static_cast<T*>(payload)->~T();
+    }
+
+    std::vector<Command> commands_;   ///< 記録順のコマンド
+    std::vector<Block> blocks_;       ///< 引数用アリーナ
+    size_t currentBlock_ = 0;         ///< 割り当て中のブロック
+    size_t offset_ = 0;               ///< ブロック内の使用済みバイト数
+    uint32_t createdCount_ = 0;       ///< 記録した生成数(仮ハンドルの連番)
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <bitset>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @file ComponentId.h
+ * @brief コンポーネント型ごとの連番IDとビットマスク
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * std::type_index のハッシュ検索の代わりに、型ごとに一度だけ採番される連番IDを使用します。
+ * WorldはこのIDでコンポーネントストアの配列を直接引くため、ストア検索は1回の配列参照になります。
+ */
+
+using ComponentTypeId = uint32_t; ///< コンポーネント型ID
+
+/**
+ * @brief ビットマスクで表現できるコンポーネント型の最大数
+ *
+ * @details
+ * これを超えた型もストアとしては使用できますが、エンティティのシグネチャ(ビットマスク)には
+ * 反映されません。
+ */
+constexpr uint32_t MAX_COMPONENT_TYPES = 128;
+
+using ComponentMask = std::bitset<MAX_COMPONENT_TYPES>; ///< コンポーネント型の集合
+
+/**
+ * @class ComponentTypeRegistry
+ * @brief コンポーネント型IDの採番器
+ *
+ * @details
+ * 型ごとの関数内static変数で初回呼び出し時にIDを確定します。
+ * 採番順は実行ごとに変わり得るため、IDを保存データに書き出さないでください。
+ */
+class ComponentTypeRegistry {
+public:
+    template<class T>
+    static ComponentTypeId Id() {
+        static const ComponentTypeId id = next();
+        return id;
+    }
+
+    /**
+     * @brief これまでに採番された型の数
+     */
+    static uint32_t Count() { return counter().load(std::memory_order_relaxed); }
+
+private:
+    static std::atomic<uint32_t>& counter() {
+        static std::atomic<uint32_t> value{ 0 };
+        return value;
+    }
+
+    static ComponentTypeId next() { return counter().fetch_add(1, std::memory_order_relaxed); }
+};
+
+/**
+ * @brief コンポーネント型IDを取得
+ * @tparam T コンポーネントの型(const/参照は除去されます)
+ * @return ComponentTypeId 型ID
+ *
+ * @par 使用例
+ * @code
+ * ComponentTypeId id = ComponentId<Transform>();
+ * @endcode
+ */
+template<class T>
+inline ComponentTypeId ComponentId() {
+    return ComponentTypeRegistry::Id<typename std::remove_cv<typename std::remove_reference<T>::type>::type>();
+}
+
+template<class... Ts>
+struct ComponentMaskBuilder;
+
+template<>
+struct ComponentMaskBuilder<> {
+    static ComponentMask Build() { return ComponentMask(); }
+};
+
+template<class T, class... Rest>
+struct ComponentMaskBuilder<T, Rest...> {
+    static ComponentMask Build() {
+        ComponentMask mask = ComponentMaskBuilder<Rest...>::Build();
+        ComponentTypeId id = ComponentId<T>();
+        if (id < MAX_COMPONENT_TYPES) mask.set(id);
+        return mask;
+    }
+};
+
+/**
+ * @brief 型の並びからコンポーネントマスクを作成
+ *
+ * @par 使用例
+ * @code
+ * ComponentMask mask = MakeComponentMask<Transform, MeshRenderer>();
+ * @endcode
+ */
+template<class... Ts>
+inline ComponentMask MakeComponentMask() {
+    return ComponentMaskBuilder<Ts...>::Build();
+}
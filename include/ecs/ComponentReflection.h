@@ -0,0 +1,205 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file ComponentReflection.h
+ * @brief コンポーネントのフィールドの一覧をコンパイル時に持たせる軽量なリフレクション
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * IComponent・Behaviour の派生型は仮想デストラクタ(vtable)を持つため std::is_trivially_copyable が偽になり、
+ * 中身が float だけでも memcpy で複写できません。REFLECT_COMPONENT() でフィールドを列挙すると、
+ * ComponentLayout<T> がフィールドの数・大きさ・トリビアルにコピーできるかをコンパイル時に求め、
+ * vtable を除いたフィールドだけを詰めて読み書きできるようになります。
+ *
+ * World はこれを使って次のように扱いを分けます。
+ * - トリビアルにコピーできる型: スナップショットでチャンクの連続した範囲を memcpy でまとめて複写する
+ * - REFLECT_COMPONENT() 済みでフィールドがすべてトリビアルにコピーできる型: フィールドごとに詰めて複写する
+ *   (RegisterSnapshotType<T>(name) に保存・読み込み関数を渡す必要がない)
+ * - それ以外: 従来どおり呼び出し側の保存・読み込み関数
+ *
+ * REFLECT_COMPONENT() は型の定義の後、グローバル名前空間に書きます(フィールドは16個まで)。
+ * 基底クラスのフィールドも列挙できます。
+ *
+ * @par 使用例
+ * @code
+ * struct Health : IComponent {
+ *     float current = 100.0f;
+ *     float max = 100.0f;
+ * };
+ * REFLECT_COMPONENT(Health, current, max)
+ *
+ * static_assert(ComponentLayout<Health>::PACKED_SIZE == sizeof(float) * 2, "");
+ * for (const ComponentFieldInfo& field : ComponentLayout<Health>::Fields()) {
+ *     // field.name, field.offset, field.size
+ * }
+ * world.RegisterSnapshotType<Health>("Health");  // フィールドごとに保存される
+ * @endcode
+ */
+
+/**
+ * @struct ComponentFieldInfo
+ * @brief フィールド1つの情報(ComponentLayout<T>::Fields())
+ */
+struct ComponentFieldInfo {
+    const char* name = nullptr;      ///< フィールド名
+    size_t offset = 0;               ///< 型の先頭からのバイト位置
+    size_t size = 0;                 ///< sizeof
+    bool triviallyCopyable = false;  ///< memcpy で複写できるか
+};
+
+/**
+ * @struct ReflectedField
+ * @brief REFLECT_COMPONENT() が作るフィールドの記述(名前とメンバーポインタ)
+ */
+template<class C, class M>
+struct ReflectedField {
+    using Type = M;
+    const char* name;
+    M C::* member;
+};
+
+template<class C, class M>
+constexpr ReflectedField<C, M> MakeReflectedField(const char* name, M C::* member) {
+    return ReflectedField<C, M>{ name, member };
+}
+
+/**
+ * @struct ComponentReflection
+ * @brief REFLECT_COMPONENT() で特殊化されるフィールドの一覧(未指定の型は REFLECTED が false)
+ */
+template<class T>
+struct ComponentReflection {
+    static constexpr bool REFLECTED = false;
+    static constexpr std::tuple<> FIELDS{};
+};
+
+// REFLECT_COMPONENT() の引数を1つずつ MakeReflectedField() に展開する(MSVC の __VA_ARGS__ のため EXPAND を挟む)
+#define REFLECT_DETAIL_EXPAND(x) x
+#define REFLECT_DETAIL_CAT_(a, b) a##b
+#define REFLECT_DETAIL_CAT(a, b) REFLECT_DETAIL_CAT_(a, b)
+#define REFLECT_DETAIL_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define REFLECT_DETAIL_COUNT(...) REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define REFLECT_DETAIL_FIELD(T, f) MakeReflectedField(#f, &T::f)
+#define REFLECT_DETAIL_1(T, f) REFLECT_DETAIL_FIELD(T, f)
+#define REFLECT_DETAIL_2(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_1(T, __VA_ARGS__))
+#define REFLECT_DETAIL_3(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_2(T, __VA_ARGS__))
+#define REFLECT_DETAIL_4(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_3(T, __VA_ARGS__))
+#define REFLECT_DETAIL_5(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_4(T, __VA_ARGS__))
+#define REFLECT_DETAIL_6(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_5(T, __VA_ARGS__))
+#define REFLECT_DETAIL_7(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_6(T, __VA_ARGS__))
+#define REFLECT_DETAIL_8(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_7(T, __VA_ARGS__))
+#define REFLECT_DETAIL_9(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_8(T, __VA_ARGS__))
+#define REFLECT_DETAIL_10(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_9(T, __VA_ARGS__))
+#define REFLECT_DETAIL_11(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_10(T, __VA_ARGS__))
+#define REFLECT_DETAIL_12(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_11(T, __VA_ARGS__))
+#define REFLECT_DETAIL_13(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_12(T, __VA_ARGS__))
+#define REFLECT_DETAIL_14(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_13(T, __VA_ARGS__))
+#define REFLECT_DETAIL_15(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_14(T, __VA_ARGS__))
+#define REFLECT_DETAIL_16(T, f, ...) REFLECT_DETAIL_FIELD(T, f), REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_15(T, __VA_ARGS__))
+#define REFLECT_DETAIL_FIELDS(T, ...) \
+ REFLECT_DETAIL_EXPAND(REFLECT_DETAIL_CAT(REFLECT_DETAIL_, REFLECT_DETAIL_COUNT(__VA_ARGS__))(T, __VA_ARGS__))
+
+// コンポーネント型のフィールドを列挙する(型の定義の後、グローバル名前空間で使用)。
+// @param Type: コンポーネントの型。
+// @param ...: フィールド名(1〜16個)。
+#define REFLECT_COMPONENT(Type, ...) \
+ template<> struct ComponentReflection<Type> { \
+ static constexpr bool REFLECTED = true; \
+ static constexpr auto FIELDS = std::make_tuple(REFLECT_DETAIL_FIELDS(Type, __VA_ARGS__)); \
+ };
+
+namespace reflection_detail {
+template<class Tuple>
+struct FieldList;
+
+template<class... Fields>
+struct FieldList<std::tuple<Fields...>> {
+    static constexpr size_t COUNT = sizeof...(Fields);
+    static constexpr size_t PACKED_SIZE = (size_t(0) + ... + sizeof(typename Fields::Type));
+    static constexpr bool TRIVIALLY_COPYABLE = (true && ... && std::is_trivially_copyable<typename Fields::Type>::value);
+};
+} // namespace reflection_detail
+
+/**
+ * @struct ComponentLayout
+ * @brief コンポーネント型の複写の方法(コンパイル時に決まる)
+ * @tparam T コンポーネントの型
+ */
+template<class T>
+struct ComponentLayout {
+private:
+    using List = reflection_detail::FieldList<std::decay_t<decltype(ComponentReflection<T>::FIELDS)>>;
+
+public:
+    static constexpr bool REFLECTED = ComponentReflection<T>::REFLECTED;             ///< REFLECT_COMPONENT() 済みか
+    static constexpr bool TRIVIALLY_COPYABLE = std::is_trivially_copyable<T>::value; ///< 型ごと memcpy できるか
+    static constexpr size_t FIELD_COUNT = List::COUNT;                               ///< 列挙したフィールド数
+    static constexpr size_t PACKED_SIZE = List::PACKED_SIZE;                         ///< 列挙したフィールドを詰めた大きさ
+
+    /// 型ごとの memcpy はできないが、列挙したフィールドはすべて memcpy できる(フィールドごとに詰めて複写する)
+    static constexpr bool FIELD_COPYABLE = !TRIVIALLY_COPYABLE && REFLECTED && List::TRIVIALLY_COPYABLE;
+
+    /**
+     * @brief 列挙したフィールドを順に走査
+     * @param[in] fn void(const ReflectedField<C, M>& field) 形式の関数(item.*field.member で値を参照)
+     */
+    template<class F>
+    static void ForEachField(F&& fn) {
+        std::apply([&fn](const auto&... field) { (fn(field), ...); }, ComponentReflection<T>::FIELDS);
+    }
+
+    /**
+     * @brief 列挙したフィールドを dst へ詰めて書き込む(PACKED_SIZE バイト)
+     */
+    static void WritePacked(const T& item, uint8_t* dst) {
+        static_assert(List::TRIVIALLY_COPYABLE, "WritePacked requires trivially copyable fields");
+        ForEachField([&](const auto& field) {
+            const auto& value = item.*(field.member);
+            std::memcpy(dst, &value, sizeof(value));
+            dst += sizeof(value);
+        });
+    }
+
+    /**
+     * @brief WritePacked() で詰めたフィールドを item へ書き戻す(列挙していないフィールドはそのまま)
+     */
+    static void ReadPacked(const uint8_t* src, T& item) {
+        static_assert(List::TRIVIALLY_COPYABLE, "ReadPacked requires trivially copyable fields");
+        ForEachField([&](const auto& field) {
+            auto& value = item.*(field.member);
+            std::memcpy(&value, src, sizeof(value));
+            src += sizeof(value);
+        });
+    }
+
+    /**
+     * @brief 列挙したフィールドの名前・位置・大きさ(デバッグ表示やツール用。既定構築した値で位置を求める)
+     */
+    static std::vector<ComponentFieldInfo> Fields() {
+        std::vector<ComponentFieldInfo> out;
+        if constexpr (REFLECTED) {
+            static_assert(std::is_default_constructible<T>::value, "ComponentLayout<T>::Fields() requires a default constructible type");
+            const T probe{};
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(&probe);
+            out.reserve(FIELD_COUNT);
+            ForEachField([&](const auto& field) {
+                using M = typename std::decay_t<decltype(field)>::Type;
+                ComponentFieldInfo info;
+                info.name = field.name;
+                info.offset = static_cast<size_t>(reinterpret_cast<const uint8_t*>(&(probe.*(field.member))) - base);
+                info.size = sizeof(M);
+                info.triviallyCopyable = std::is_trivially_copyable<M>::value;
+                out.push_back(info);
+            });
+        }
+        return out;
+    }
+};
@@ -0,0 +1,519 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include "app/MemoryTracker.h"
+
+/**
+ * @file ComponentStorage.h
+ * @brief スパースセット方式のコンポーネントプール(16KBチャンク格納)
+ * @author 山内陽
+ * @date 2025
+ * @version 2.0
+ *
+ * @details
+ * 同じ型のコンポーネントを固定サイズ(約16KB)のチャンクへ詰めて格納します。
+ * エンティティIDからスロットへの対応はページ化されたスパース配列で管理し、
+ * Has/TryGetをハッシュ計算なしの配列参照だけで解決します。
+ * チャンク・スパースページ・密配列の確保量は MemoryTracker の ECS タグに加算します。
+ * データを持たない型(タグ)は TagStorage で所持の有無をビットだけで管理します。
+ */
+
+/**
+ * @struct ComponentPoolStats
+ * @brief コンポーネントプールの使用状況
+ */
+struct ComponentPoolStats {
+    size_t live = 0;          ///< 格納中のコンポーネント数
+    size_t highWater = 0;     ///< これまでの最大格納数
+    size_t capacity = 0;      ///< 確保済みスロット数（チャンク数 × チャンク容量）
+    size_t chunkCount = 0;    ///< 確保済みチャンク数
+    size_t reservedBytes = 0; ///< チャンク本体の確保バイト数
+
+    /**
+     * @brief 占有率（0.0～1.0、未確保の場合は0）
+     */
+    float Occupancy() const {
+        return capacity > 0 ? static_cast<float>(live) / static_cast<float>(capacity) : 0.0f;
+    }
+
+    ComponentPoolStats& operator+=(const ComponentPoolStats& other) {
+        live += other.live;
+        highWater += other.highWater;
+        capacity += other.capacity;
+        chunkCount += other.chunkCount;
+        reservedBytes += other.reservedBytes;
+        return *this;
+    }
+};
+
+/**
+ * @class ChunkedStorage
+ * @brief 単一コンポーネント型のスパースセットプール
+ *
+ * @tparam T 格納するコンポーネントの型
+ *
+ * @details
+ * ### 構造:
+ * - スパース配列: EntityID -> スロット番号(4096件単位のページで遅延確保)
+ * - 密なエンティティ配列: スロット番号 -> 所有エンティティID(0 は空きスロット)
+ * - 密なコンポーネント配列: スロット番号 -> コンポーネント本体(16KBチャンク単位)
+ *
+ * コンポーネントは一度配置されると削除されるまで移動しません(安定アドレス)。
+ * BehaviourをWorldがポインタで保持しているため、削除時に末尾要素を詰める代わりに
+ * スロットを空き(墓石)として残し、次のEmplaceで再利用します。
+ * 走査は密配列を先頭から順に読むだけで、空きスロットは所有者ID 0 で判別します。
+ *
+ * @note World はID 0 を発行しないため、0 を空きスロットの印として使用しています
+ * @note World内部専用です。ゲームコードからは World::Add/TryGet を使用してください
+ */
+template<class T>
+class ChunkedStorage {
+public:
+    static constexpr size_t CHUNK_BYTES = 16 * 1024;  ///< 1チャンクのおおよそのサイズ
+    static constexpr uint32_t CHUNK_CAPACITY =      ///< 1チャンクに格納できるコンポーネント数
+        sizeof(T) >= CHUNK_BYTES ? 1u : static_cast<uint32_t>(CHUNK_BYTES / sizeof(T));
+    static constexpr uint32_t SPARSE_PAGE_SIZE = 4096;     ///< スパース配列1ページのエントリ数
+    static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFFu;  ///< スロット未割り当て
+
+    ChunkedStorage() = default;
+    ChunkedStorage(const ChunkedStorage&) = delete;
+    ChunkedStorage& operator=(const ChunkedStorage&) = delete;
+
+    ~ChunkedStorage() { Clear(); }
+
+    /**
+     * @brief コンポーネントをスロットに構築
+     * @param[in] id 所有エンティティID(0以外)
+     * @param[in] args コンストラクタ引数
+     * @return T& 構築したコンポーネント
+     */
+    template<class... Args>
+    T& Emplace(uint32_t id, Args&&... args) {
+        uint32_t slot = acquireSlot();
+
+        T* obj = nullptr;
+        try {
+            obj = new (slotPtr(slot)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            freeSlots_.push_back(slot);
+            throw;
+        }
+
+        dense_[slot] = id;
+        sparseEntry(id) = slot;
+        if (++size_ > highWater_) highWater_ = size_;
+        return *obj;
+    }
+
+    /**
+     * @brief 追加で count 個を格納できるようにチャンクを事前確保
+     *
+     * @details
+     * 一括生成の前に呼ぶと、Emplace中のチャンク確保と密配列の再確保がなくなります。
+     */
+    void Reserve(size_t count) {
+        if (count <= freeSlots_.size()) return;
+        size_t needed = dense_.size() + (count - freeSlots_.size());
+        dense_.reserve(needed);
+        addedTicks_.reserve(needed);
+        changedTicks_.reserve(needed);
+        while (chunks_.size() * CHUNK_CAPACITY < needed) {
+            chunks_.push_back(std::unique_ptr<Chunk>(new Chunk()));
+        }
+    }
+
+    /**
+     * @brief コンポーネントを破棄してスロットを解放
+     * @param[in] id 所有エンティティID
+     * @return bool 削除した場合true
+     */
+    bool Erase(uint32_t id) {
+        uint32_t slot = SlotOf(id);
+        if (slot == INVALID_SLOT) return false;
+
+        sparse_[id / SPARSE_PAGE_SIZE]->slots[id % SPARSE_PAGE_SIZE] = INVALID_SLOT;
+        dense_[slot] = 0;
+        slotPtr(slot)->~T();
+
+        freeSlots_.push_back(slot);
+        --size_;
+        return true;
+    }
+
+    /**
+     * @brief エンティティIDからスロット番号を取得
+     * @return uint32_t スロット番号(存在しない場合 INVALID_SLOT)
+     */
+    uint32_t SlotOf(uint32_t id) const {
+        uint32_t page = id / SPARSE_PAGE_SIZE;
+        if (page >= sparse_.size() || !sparse_[page]) return INVALID_SLOT;
+        return sparse_[page]->slots[id % SPARSE_PAGE_SIZE];
+    }
+
+    T* Find(uint32_t id) {
+        uint32_t slot = SlotOf(id);
+        return slot == INVALID_SLOT ? nullptr : slotPtr(slot);
+    }
+
+    const T* Find(uint32_t id) const {
+        uint32_t slot = SlotOf(id);
+        return slot == INVALID_SLOT ? nullptr : slotPtr(slot);
+    }
+
+    bool Contains(uint32_t id) const { return SlotOf(id) != INVALID_SLOT; }
+
+    /**
+     * @brief 追加ティックを記録（変更ティックも同じ値にする）
+     */
+    void StampAdded(uint32_t id, uint32_t tick) {
+        uint32_t slot = SlotOf(id);
+        if (slot == INVALID_SLOT) return;
+        addedTicks_[slot] = tick;
+        changedTicks_[slot] = tick;
+    }
+
+    /**
+     * @brief 変更ティックを記録
+     */
+    void StampChanged(uint32_t id, uint32_t tick) {
+        uint32_t slot = SlotOf(id);
+        if (slot != INVALID_SLOT) changedTicks_[slot] = tick;
+    }
+
+    /**
+     * @brief 追加ティックを取得（存在しない場合0）
+     */
+    uint32_t AddedTick(uint32_t id) const {
+        uint32_t slot = SlotOf(id);
+        return slot == INVALID_SLOT ? 0 : addedTicks_[slot];
+    }
+
+    /**
+     * @brief 変更ティックを取得（存在しない場合0）
+     */
+    uint32_t ChangedTick(uint32_t id) const {
+        uint32_t slot = SlotOf(id);
+        return slot == INVALID_SLOT ? 0 : changedTicks_[slot];
+    }
+
+    size_t Size() const { return size_; }
+
+    size_t ChunkCount() const { return chunks_.size(); }
+
+    /**
+     * @brief 確保済みスロット数（空きスロットと未使用の末尾を含む）
+     */
+    size_t Capacity() const { return chunks_.size() * CHUNK_CAPACITY; }
+
+    /**
+     * @brief これまでの最大格納数（Clearしてもリセットされません）
+     */
+    size_t HighWaterMark() const { return highWater_; }
+
+    /**
+     * @brief 使用状況をまとめて取得
+     */
+    ComponentPoolStats Stats() const {
+        ComponentPoolStats stats;
+        stats.live = size_;
+        stats.highWater = highWater_;
+        stats.capacity = Capacity();
+        stats.chunkCount = chunks_.size();
+        stats.reservedBytes = chunks_.size() * sizeof(Chunk);
+        return stats;
+    }
+
+    /**
+     * @brief 密配列の長さ(空きスロットを含む)
+     */
+    uint32_t DenseSize() const { return static_cast<uint32_t>(dense_.size()); }
+
+    /**
+     * @brief スロットの所有エンティティID(0 は空き)
+     */
+    uint32_t OwnerAt(uint32_t slot) const { return dense_[slot]; }
+
+    T& At(uint32_t slot) { return *slotPtr(slot); }
+    const T& At(uint32_t slot) const { return *slotPtr(slot); }
+
+    /**
+     * @brief 全コンポーネントを密配列の順に走査
+     * @param[in] fn void(uint32_t id, T& component) 形式の関数
+     *
+     * @details
+     * コールバック内でのAdd/Removeに対応するため、密配列の長さは毎回読み直します。
+     * 削除されたスロットは自動的にスキップされます。
+     */
+    template<class F>
+    void ForEach(F&& fn) {
+        for (uint32_t c = 0; c < chunks_.size(); ++c) {
+            T* base = chunks_[c]->Ptr(0);
+            uint32_t first = c * CHUNK_CAPACITY;
+            for (uint32_t i = 0; i < CHUNK_CAPACITY && first + i < dense_.size(); ++i) {
+                uint32_t owner = dense_[first + i];
+                if (owner != 0) {
+                    fn(owner, base[i]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief チャンク内で連続して埋まっているスロットの範囲ごとに走査(まとめて複写する場合用)
+     * @param[in] fn void(const uint32_t* ids, T* items, uint32_t count) 形式の関数
+     *
+     * @details
+     * ids と items はそれぞれ count 個連続しています(空きスロットとチャンクの境界で区切る)。
+     * コールバック内で Add/Remove はできません。
+     */
+    template<class F>
+    void ForEachRun(F&& fn) {
+        const uint32_t size = static_cast<uint32_t>(dense_.size());
+        for (uint32_t c = 0; c < chunks_.size(); ++c) {
+            T* base = chunks_[c]->Ptr(0);
+            const uint32_t first = c * CHUNK_CAPACITY;
+            if (first >= size) break;
+            const uint32_t end = (std::min)(CHUNK_CAPACITY, size - first);
+            uint32_t i = 0;
+            while (i < end) {
+                while (i < end && dense_[first + i] == 0) ++i;
+                const uint32_t runBegin = i;
+                while (i < end && dense_[first + i] != 0) ++i;
+                if (i > runBegin) fn(&dense_[first + runBegin], base + runBegin, i - runBegin);
+            }
+        }
+    }
+
+    /**
+     * @brief 全コンポーネントを破棄(チャンクとスパースページも解放)
+     */
+    void Clear() {
+        for (uint32_t slot = 0; slot < dense_.size(); ++slot) {
+            if (dense_[slot] != 0) {
+                dense_[slot] = 0;
+                slotPtr(slot)->~T();
+            }
+        }
+        chunks_.clear();
+        dense_.clear();
+        addedTicks_.clear();
+        changedTicks_.clear();
+        sparse_.clear();
+        freeSlots_.clear();
+        size_ = 0;
+    }
+
+private:
+    /**
+     * @brief new/delete で MemoryTracker の ECS タグに加算する基底
+     */
+    template<class Derived>
+    struct EcsTracked {
+        static void* operator new(size_t bytes) {
+            void* p = ::operator new(bytes);
+            MemoryTracker::GetInstance().Add(MemoryTag::ECS, MemoryKind::Cpu, bytes);
+            return p;
+        }
+        static void* operator new(size_t bytes, std::align_val_t align) {
+            void* p = ::operator new(bytes, align);
+            MemoryTracker::GetInstance().Add(MemoryTag::ECS, MemoryKind::Cpu, bytes);
+            return p;
+        }
+        static void operator delete(void* p, size_t bytes) noexcept {
+            MemoryTracker::GetInstance().Remove(MemoryTag::ECS, MemoryKind::Cpu, bytes);
+            ::operator delete(p);
+        }
+        static void operator delete(void* p, size_t bytes, std::align_val_t align) noexcept {
+            MemoryTracker::GetInstance().Remove(MemoryTag::ECS, MemoryKind::Cpu, bytes);
+            ::operator delete(p, align);
+        }
+    };
+
+    struct Chunk : EcsTracked<Chunk> {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type data[CHUNK_CAPACITY]; ///< コンポーネント本体
+
+        T* Ptr(uint32_t i) { return reinterpret_cast<T*>(&data[i]); }
+        const T* Ptr(uint32_t i) const { return reinterpret_cast<const T*>(&data[i]); }
+    };
+
+    struct SparsePage : EcsTracked<SparsePage> {
+        uint32_t slots[SPARSE_PAGE_SIZE]; ///< EntityID % SPARSE_PAGE_SIZE -> スロット
+    };
+
+    T* slotPtr(uint32_t slot) { return chunks_[slot / CHUNK_CAPACITY]->Ptr(slot % CHUNK_CAPACITY); }
+    const T* slotPtr(uint32_t slot) const { return chunks_[slot / CHUNK_CAPACITY]->Ptr(slot % CHUNK_CAPACITY); }
+
+    uint32_t& sparseEntry(uint32_t id) {
+        uint32_t page = id / SPARSE_PAGE_SIZE;
+        if (page >= sparse_.size()) {
+            sparse_.resize(page + 1);
+        }
+        if (!sparse_[page]) {
+            sparse_[page].reset(new SparsePage());
+            for (uint32_t i = 0; i < SPARSE_PAGE_SIZE; ++i) {
+                sparse_[page]->slots[i] = INVALID_SLOT;
+            }
+        }
+        return sparse_[page]->slots[id % SPARSE_PAGE_SIZE];
+    }
+
+    uint32_t acquireSlot() {
+        if (!freeSlots_.empty()) {
+            uint32_t slot = freeSlots_.back();
+            freeSlots_.pop_back();
+            return slot;
+        }
+        uint32_t slot = static_cast<uint32_t>(dense_.size());
+        if (slot == chunks_.size() * CHUNK_CAPACITY) {
+            chunks_.push_back(std::unique_ptr<Chunk>(new Chunk()));
+        }
+        dense_.push_back(0);
+        addedTicks_.push_back(0);
+        changedTicks_.push_back(0);
+        return slot;
+    }
+
+    template<class U>
+    using Vector = TrackedVector<U, MemoryTag::ECS>;
+
+    Vector<std::unique_ptr<Chunk>> chunks_;                ///< 密なコンポーネント配列(チャンク自体は移動しない)
+    Vector<uint32_t> dense_;                               ///< 密なエンティティ配列(スロット -> EntityID)
+    Vector<uint32_t> addedTicks_;                          ///< スロット -> 追加されたティック
+    Vector<uint32_t> changedTicks_;                        ///< スロット -> 最後に変更されたティック
+    Vector<std::unique_ptr<SparsePage>> sparse_;           ///< ページ化スパース配列(EntityID -> スロット)
+    Vector<uint32_t> freeSlots_;                           ///< 再利用可能なスロット
+    size_t size_ = 0;                                      ///< 格納中のコンポーネント数
+    size_t highWater_ = 0;                                 ///< 最大格納数
+};
+
+/**
+ * @class TagStorage
+ * @brief データを持たない型(タグ)のプール
+ *
+ * @tparam T 格納するタグの型(空の型)
+ *
+ * @details
+ * 所持の有無を EntityID ごとの1ビットで管理し、インスタンスは型ごとに1つだけ共有します。
+ * エンティティごとのスロット・チャンク・スパースページは確保しません。
+ * 追加・変更ティックは型単位で1つだけ記録するため、Added/Changed フィルタは
+ * 「いずれかのエンティティに追加・変更があったか」の判定になり、その場合は所持する全エンティティが一致します。
+ *
+ * @note World内部専用です。ChunkedStorage と同じインターフェースを持ちます
+ */
+template<class T>
+class TagStorage {
+public:
+    static_assert(std::is_empty<T>::value, "TagStorage requires an empty type");
+
+    TagStorage() = default;
+    TagStorage(const TagStorage&) = delete;
+    TagStorage& operator=(const TagStorage&) = delete;
+
+    template<class... Args>
+    T& Emplace(uint32_t id, Args&&... args) {
+        // 空の型でもコンストラクタ引数の検査のために一度構築する
+        T value(std::forward<Args>(args)...);
+        (void)value;
+
+        uint64_t& word = wordOf(id);
+        const uint64_t bit = uint64_t(1) << (id % 64);
+        if ((word & bit) == 0) {
+            word |= bit;
+            if (++size_ > highWater_) highWater_ = size_;
+        }
+        return instance_;
+    }
+
+    void Reserve(size_t) {}
+
+    bool Erase(uint32_t id) {
+        if (!Contains(id)) return false;
+        bits_[id / 64] &= ~(uint64_t(1) << (id % 64));
+        --size_;
+        return true;
+    }
+
+    T* Find(uint32_t id) { return Contains(id) ? &instance_ : nullptr; }
+    const T* Find(uint32_t id) const { return Contains(id) ? &instance_ : nullptr; }
+
+    bool Contains(uint32_t id) const {
+        size_t word = id / 64;
+        return word < bits_.size() && ((bits_[word] >> (id % 64)) & 1u) != 0;
+    }
+
+    void StampAdded(uint32_t id, uint32_t tick) {
+        if (!Contains(id)) return;
+        addedTick_ = tick;
+        changedTick_ = tick;
+    }
+
+    void StampChanged(uint32_t id, uint32_t tick) {
+        if (Contains(id)) changedTick_ = tick;
+    }
+
+    uint32_t AddedTick(uint32_t id) const { return Contains(id) ? addedTick_ : 0; }
+    uint32_t ChangedTick(uint32_t id) const { return Contains(id) ? changedTick_ : 0; }
+
+    size_t Size() const { return size_; }
+    size_t HighWaterMark() const { return highWater_; }
+
+    /**
+     * @brief 使用状況(チャンクは持たないため、容量はビット列の長さ)
+     */
+    ComponentPoolStats Stats() const {
+        ComponentPoolStats stats;
+        stats.live = size_;
+        stats.highWater = highWater_;
+        stats.capacity = bits_.size() * 64;
+        stats.reservedBytes = bits_.size() * sizeof(uint64_t);
+        return stats;
+    }
+
+    /**
+     * @brief 所持しているエンティティをID順に走査
+     * @param[in] fn void(uint32_t id, T& tag) 形式の関数
+     */
+    template<class F>
+    void ForEach(F&& fn) {
+        for (size_t w = 0; w < bits_.size(); ++w) {
+            // 走査開始時のワードを使い、コールバック内で削除されたものは飛ばす
+            uint64_t word = bits_[w];
+            for (uint32_t bit = 0; word != 0; ++bit, word >>= 1) {
+                if ((word & 1u) == 0) continue;
+                uint32_t id = static_cast<uint32_t>(w * 64 + bit);
+                if (Contains(id)) fn(id, instance_);
+            }
+        }
+    }
+
+    void Clear() {
+        bits_.clear();
+        size_ = 0;
+    }
+
+private:
+    uint64_t& wordOf(uint32_t id) {
+        size_t word = id / 64;
+        if (word >= bits_.size()) bits_.resize(word + 1, 0);
+        return bits_[word];
+    }
+
+    TrackedVector<uint64_t, MemoryTag::ECS> bits_; ///< EntityID -> 所持ビット(64件/ワード)
+    T instance_{};                                 ///< 全エンティティで共有するインスタンス
+    uint32_t addedTick_ = 0;                       ///< 最後に追加されたティック(型単位)
+    uint32_t changedTick_ = 0;                     ///< 最後に変更されたティック(型単位)
+    size_t size_ = 0;                              ///< 所持しているエンティティ数
+    size_t highWater_ = 0;                         ///< 最大所持数
+};
+
+/**
+ * @brief 型に応じたプール(空の型は TagStorage、それ以外は ChunkedStorage)
+ */
+template<class T>
+using ComponentStorageFor = typename std::conditional<std::is_empty<T>::value, TagStorage<T>, ChunkedStorage<T>>::type;
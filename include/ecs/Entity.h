@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 
@@ -12,8 +13,16 @@
  * @details
  * Entity Component System(ECS)アーキテクチャにおける
  * エンティティの基本構造を定義します。
+ *
+ * ハンドルは 64 ビットに詰めた値(下位 ENTITY_INDEX_BITS ビットが id、残りが世代番号)として比較・ハッシュします。
+ * ENTITY_INDEX_BITS はビルド全体で同じ値を定義します(既定 32、id の上限と世代番号の周期が決まる)。
  */
 
+#ifndef ENTITY_INDEX_BITS
+#define ENTITY_INDEX_BITS 32 ///< 詰めた値のうち id に使うビット数(残りが世代番号)
+#endif
+static_assert(ENTITY_INDEX_BITS >= 16 && ENTITY_INDEX_BITS <= 32, "ENTITY_INDEX_BITS は 16 から 32");
+
 /**
  * @struct Entity
  * @brief ゲーム世界のオブジェクトを表す一意な識別子
@@ -23,29 +32,88 @@
  * エンティティ自体には機能がなく、コンポーネントを通じて機能を追加します。
  * 
  * ### 特徴:
- * - **軽量**: id と世代番号 generation を保持
+ * - **軽量**: id と世代番号 generation を 8 バイトに保持し、比較は 64 ビットの値1回
  * - **安全性**: 世代番号により古いハンドルを無効化し use-after-free を防止
  * - **柔軟性**: コンポーネントの組み合わせで機能を定義
  * 
  * @note 同一フレームでのID再利用による不具合を避けるため、世代番号を導入しています
+ * @note id は MAX_INDEX まで、世代番号は 1 から GENERATION_MASK までを周回します(0 は使わない)。
+ *       World はこの範囲に収まるハンドルだけを作るため、範囲外のハンドルはリリースビルドでも無効と判定されます。
  */
-struct Entity {
+struct alignas(8) Entity {
+    static constexpr uint32_t INDEX_BITS = ENTITY_INDEX_BITS;                 ///< id のビット数
+    static constexpr uint32_t GENERATION_BITS = 64 - INDEX_BITS;              ///< 世代番号のビット数(32 を超える分は使わない)
+    static constexpr uint32_t MAX_INDEX = static_cast<uint32_t>((uint64_t(1) << INDEX_BITS) - 1);   ///< id の上限
+    static constexpr uint32_t GENERATION_MASK = GENERATION_BITS >= 32 ? 0xFFFFFFFFu
+        : static_cast<uint32_t>((uint64_t(1) << GENERATION_BITS) - 1);       ///< 世代番号の上限
+
     uint32_t id;   ///< エンティティID
     uint32_t gen;  ///< 世代番号（破棄の度にインクリメント）
 
+    /**
+     * @brief 64 ビットに詰めた値(下位が id、上位が世代番号)
+     */
+    constexpr uint64_t Packed() const { return (static_cast<uint64_t>(gen) << INDEX_BITS) | id; }
+
+    /**
+     * @brief Packed() の値からハンドルを復元
+     */
+    static constexpr Entity FromPacked(uint64_t packed) {
+        return Entity{ static_cast<uint32_t>(packed & MAX_INDEX), static_cast<uint32_t>(packed >> INDEX_BITS) & GENERATION_MASK };
+    }
+
+    /**
+     * @brief 破棄後の世代番号(GENERATION_MASK の次は 1 に戻る)
+     */
+    static constexpr uint32_t NextGeneration(uint32_t generation) {
+        return (generation & GENERATION_MASK) == GENERATION_MASK ? 1u : (generation & GENERATION_MASK) + 1u;
+    }
+
+    /**
+     * @brief NextGeneration() の逆(破棄の通知で破棄前のハンドルを作る)
+     */
+    static constexpr uint32_t PreviousGeneration(uint32_t generation) {
+        return generation <= 1 ? GENERATION_MASK : generation - 1u;
+    }
+
     // 比較演算子（id と generation の両方を比較）
-    bool operator==(const Entity& other) const { return id == other.id && gen == other.gen; }
+    bool operator==(const Entity& other) const { return Packed() == other.Packed(); }
     bool operator!=(const Entity& other) const { return !(*this == other); }
     bool operator<(const Entity& other) const { return id < other.id || (id == other.id && gen < other.gen); }
 };
+static_assert(sizeof(Entity) == sizeof(uint64_t), "Entity は 64 ビット");
+
+/**
+ * @enum EntityCause
+ * @brief エンティティの生成/破棄の起因タグ（ログ解析用）
+ *
+ * @details
+ * World::Cause として参照できます。
+ */
+enum class EntityCause {
+    Unknown = 0,
+    Spawner = 1,
+    WaveTimer = 2,
+    Collision = 3,
+    LifetimeExpired = 4,
+    SceneInit = 5,
+    SceneTeardown = 6,   // シーン終了時
+    SceneUnload = 7,     // シーン切り替え時
+    AppShutdown = 8,     // アプリケーション終了時
+    Merged = 9           // 別の World へ移動（World::MergeFrom()）
+};
 
 // 構造体の外にハッシュの特殊化を追加
 namespace std {
     template <>
     struct hash<Entity> {
         size_t operator()(const Entity& e) const {
-            // 簡易結合ハッシュ(id と gen)
-            return (static_cast<size_t>(e.id) << 32) ^ static_cast<size_t>(e.gen);
+            // 詰めた値を splitmix64 の仕上げで混ぜ、size_t の幅に畳む(32 ビットのビルドでも上位を捨てない)
+            uint64_t h = e.Packed();
+            h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+            h ^= h >> 31;
+            return static_cast<size_t>(h ^ (h >> 32));
         }
     };
 }
@@ -0,0 +1,134 @@
+#pragma once
+#include "ecs/Entity.h"
+#include "ecs/Prefab.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file EntityPool.h
+ * @brief プレハブ単位のエンティティプール
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * プールから生成したエンティティは、破棄されるとコンポーネントを残したまま休止状態になり、
+ * 次の Spawn() でプレハブの初期値に戻して再び有効になります。
+ * 生成・破棄のたびに発生していたID確保、コンポーネントのスロット確保と解放、
+ * Behaviour グループへの登録と解除の並べ替えを、値の書き戻しとクエリへの出入りだけに置き換えます。
+ */
+
+class World;
+
+/**
+ * @brief プールの区別に使う型ごとの一意なキー
+ */
+template<class Key>
+inline const void* PoolTypeKey() {
+    static const char key = 0;
+    return &key;
+}
+
+/**
+ * @class EntityPool
+ * @brief 同じプレハブから生成するエンティティの再利用
+ *
+ * @details
+ * World::Pool<Key>() で取得します(Key は区別のための任意の型)。
+ * 休止中のエンティティは生存数・クエリ・Behaviour の更新・ForEach の対象外で、
+ * 以前のハンドルは無効になります(IsAlive() が false、TryGet() が nullptr)。
+ *
+ * 破棄の時点で、プレハブにないコンポーネント(TransformSystem が追加する LocalToWorld など)は削除します。
+ * 再利用時はプレハブの各コンポーネントを初期値のコピーで作り直すため、Behaviour は再び OnStart() から始まります。
+ *
+ * @par 使用例
+ * @code
+ * struct BulletPool {};
+ *
+ * EntityPool& pool = world.Pool<BulletPool>();
+ * if (pool.GetPrefab().Empty()) {
+ *     pool.GetPrefab().With<Transform>().With<MeshRenderer>().With<Bullet>();
+ *     pool.Prewarm(256);
+ * }
+ *
+ * for (Entity e : pool.Spawn(8, World::Cause::Spawner)) {
+ *     world.Get<Transform>(e).position = muzzle;
+ * }
+ * // 通常どおり DestroyEntityWithCause() で破棄すると、フレーム終了時にプールへ戻る
+ * @endcode
+ *
+ * @note メインスレッドでのみ使用してください(並列区間中の Spawn() は例外になります)
+ */
+class EntityPool {
+public:
+    /**
+     * @struct Statistics
+     * @brief プールの累計
+     */
+    struct Statistics {
+        uint64_t spawned = 0;   ///< Spawn() で有効にした数
+        uint64_t reused = 0;    ///< そのうち休止中のエンティティを再利用した数
+        uint64_t created = 0;   ///< そのうち新しく生成した数(Prewarm() を含まない)
+        uint64_t released = 0;  ///< 破棄されて休止状態に戻った数
+        uint64_t discarded = 0; ///< 容量を超えたため実際に破棄した数
+
+        /**
+         * @brief 再利用率(0.0～1.0)
+         */
+        double HitRate() const { return spawned > 0 ? static_cast<double>(reused) / static_cast<double>(spawned) : 0.0; }
+    };
+
+    explicit EntityPool(World& world) : world_(&world) {}
+
+    EntityPool(const EntityPool&) = delete;
+    EntityPool& operator=(const EntityPool&) = delete;
+
+    /**
+     * @brief 生成に使うプレハブ(最初の Spawn() の前に組み立てる)
+     *
+     * @details
+     * 後から型を増やした場合、休止中のエンティティには次の再利用時に追加されます。
+     */
+    Prefab& GetPrefab() { return prefab_; }
+    const Prefab& GetPrefab() const { return prefab_; }
+
+    /**
+     * @brief エンティティを有効にする(休止中のものを優先し、足りない分は新しく生成)
+     * @param[in] count 数
+     * @param[in] cause 事象の原因(Behaviour の登録にも記録されます)
+     * @return std::vector<Entity> 有効にしたエンティティ(コンポーネントはプレハブの初期値)
+     */
+    std::vector<Entity> Spawn(size_t count = 1, EntityCause cause = EntityCause::Unknown);
+
+    /**
+     * @brief 休止中のエンティティを事前に生成する
+     * @param[in] count 休止中の数がこの数になるまで生成する
+     */
+    void Prewarm(size_t count);
+
+    /**
+     * @brief 休止中のエンティティをすべて実際に破棄する
+     */
+    void Clear();
+
+    /**
+     * @brief 休止中に保持する最大数(0 で無制限)。超えた分は破棄時に実際に破棄する
+     */
+    void SetCapacity(size_t capacity) { capacity_ = capacity; }
+    size_t GetCapacity() const { return capacity_; }
+
+    size_t DormantCount() const { return dormant_.size(); }
+    size_t ActiveCount() const { return active_; }
+    const Statistics& GetStatistics() const { return stats_; }
+
+private:
+    friend class World;
+
+    World* world_;
+    Prefab prefab_;
+    std::vector<uint32_t> dormant_; ///< 休止中のエンティティID(後から入れたものを先に使う)
+    size_t capacity_ = 0;
+    size_t active_ = 0;             ///< 有効なエンティティ数
+    Statistics stats_;
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include "ecs/Entity.h"
+#include "app/JobSystem.h"
+#include "app/DebugLog.h"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file EventChannel.h
+ * @brief 型ごとのイベントチャネル(フレーム単位でまとめて配信)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 送信側はスレッドごとのバッファに追記するだけで、ロックもコールバックの呼び出しもありません。
+ * World::Tick() の開始時にスレッド番号順(メインスレッド、ワーカー0、1...)で1本の配列にまとめ、
+ * 受信側はそのフレームの間、連続した配列として読みます。
+ * 各バッファは容量を残したまま使い回すため、定常状態ではイベントごとのヒープ確保はありません。
+ */
+
+/**
+ * @struct EntityDestroyedEvent
+ * @brief エンティティが破棄されたことを知らせるイベント
+ *
+ * @details
+ * World が FlushDestroyEndOfFrame() で破棄したときに送信します(チャネルが作成されている場合のみ)。
+ * 受信時点で entity は無効なハンドルです。
+ */
+struct EntityDestroyedEvent {
+    Entity entity;      ///< 破棄されたエンティティ
+    EntityCause cause;  ///< 破棄の原因
+};
+
+/**
+ * @class EventChannelBase
+ * @brief World がチャネルを型に依存せず保持するための基底
+ */
+class EventChannelBase {
+public:
+    virtual ~EventChannelBase() = default;
+    virtual const void* TypeKey() const = 0;
+    virtual void SetThreadCount(size_t count) = 0;
+    virtual void Swap() = 0;
+    virtual void Clear() = 0;
+};
+
+/**
+ * @brief イベント型ごとの一意なキー
+ */
+template<class T>
+inline const void* EventTypeKey() {
+    static const char key = 0;
+    return &key;
+}
+
+/**
+ * @class EventChannel
+ * @brief 1つのイベント型の送受信
+ *
+ * @tparam T イベントの型(コピー可能な値型)
+ *
+ * @details
+ * World::Events<T>() で取得します。Send() で送ったイベントは、次の World::Tick() の開始時に
+ * Read() で読めるようになり、そのフレームの間は同じ内容のままです(1フレームの遅延)。
+ * 読まれなかったイベントは次の切り替えで捨てられます。
+ *
+ * @par 使用例
+ * @code
+ * // 送信(メインスレッド・ワーカーのどちらからでも可)
+ * world.Events<EntityDestroyedEvent>().Send(EntityDestroyedEvent{ e, World::Cause::Collision });
+ *
+ * // 受信(前のフレームに送られたもの)
+ * for (const EntityDestroyedEvent& ev : world.Events<EntityDestroyedEvent>().Read()) {
+ *     if (ev.cause == World::Cause::Collision) score++;
+ * }
+ * @endcode
+ *
+ * @note 1つのスレッドのバッファを複数スレッドから同時に使わないため、
+ *       送信できるのはメインスレッドと World::SetJobSystem() で設定したジョブシステムのワーカーだけです
+ */
+template<class T>
+class EventChannel : public EventChannelBase {
+public:
+    explicit EventChannel(size_t threadCount) { SetThreadCount(threadCount); }
+
+    /**
+     * @brief 現在のスレッドのバッファに追記(ロックなし)
+     */
+    void Send(const T& event) { threadBuffer().push_back(event); }
+
+    /**
+     * @brief 現在のスレッドのバッファに直接構築
+     */
+    template<class... Args>
+    void Emplace(Args&&... args) { threadBuffer().emplace_back(std::forward<Args>(args)...); }
+
+    /**
+     * @brief 前のフレームに送られたイベント(スレッド番号順、各スレッド内は送信順)
+     */
+    const std::vector<T>& Read() const { return read_; }
+
+    size_t Size() const { return read_.size(); }
+    bool Empty() const { return read_.empty(); }
+
+    const void* TypeKey() const override { return EventTypeKey<T>(); }
+
+    /**
+     * @brief スレッドごとのバッファ数を設定(メインスレッドのみ、送信中でないこと)
+     */
+    void SetThreadCount(size_t count) override {
+        if (count > writers_.size()) writers_.resize(count);
+    }
+
+    /**
+     * @brief 送信されたイベントを読み取り側に移す(フレーム境界でメインスレッドから呼ぶ)
+     *
+     * @details
+     * 送信したスレッドが1つだけの場合は配列を入れ替えるだけで、コピーしません。
+     */
+    void Swap() override {
+        read_.clear();
+        size_t writers = 0;
+        std::vector<T>* single = nullptr;
+        for (Writer& writer : writers_) {
+            if (writer.events.empty()) continue;
+            writers++;
+            single = &writer.events;
+        }
+        if (writers == 1) {
+            read_.swap(*single);
+            return;
+        }
+        for (Writer& writer : writers_) {
+            if (writer.events.empty()) continue;
+            read_.insert(read_.end(), writer.events.begin(), writer.events.end());
+            writer.events.clear();
+        }
+    }
+
+    /**
+     * @brief 送信済み・読み取り中のイベントをすべて捨てる
+     */
+    void Clear() override {
+        read_.clear();
+        for (Writer& writer : writers_) writer.events.clear();
+    }
+
+private:
+    std::vector<T>& threadBuffer() {
+        int worker = JobSystem::CurrentWorkerIndex();
+        size_t slot = worker >= 0 ? static_cast<size_t>(worker) + 1 : 0;
+        if (slot >= writers_.size()) {
+            DEBUGLOG_ERROR("EventChannel::Send() - ワーカー " + std::to_string(worker) + " 用のバッファがありません (SetJobSystemを確認してください)");
+            throw std::runtime_error("No event buffer for this thread");
+        }
+        return writers_[slot].events;
+    }
+
+    /**
+     * @struct Writer
+     * @brief 1スレッドの送信バッファ(隣のスレッドと同じキャッシュラインを共有しないよう揃える)
+     */
+    struct alignas(64) Writer {
+        std::vector<T> events;
+    };
+
+    std::vector<Writer> writers_;          ///< スレッドごとの送信バッファ（[0]: メインスレッド, [1..]: ワーカー）
+    std::vector<T> read_;                  ///< 前のフレームのイベント
+};
@@ -0,0 +1,217 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file Pipeline.h
+ * @brief 固定のエンティティ単位の処理を1つのシステムにまとめ、同じクエリの段を1回の走査に融合するパイプライン
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 各段(ステージ)は PipelineStage<Read<...>, Write<...>> を継承し、1エンティティ分の Apply() だけを持ちます。
+ * Pipeline<Stages...> はコンパイル時に段の並びを調べ、隣り合う段が同じコンポーネントの並びを宣言していれば
+ * 1つのクエリの1回の走査で順に Apply() を呼びます(コンポーネントの検索は1エンティティにつき1回)。
+ * 並びの異なる段はそれぞれのクエリで走査します。呼び出しはすべて具象型を確定して行うため、
+ * 段ごと・エンティティごとの仮想関数の呼び出しはありません。
+ *
+ * Apply() は自分のエンティティのコンポーネントだけを読み書きする前提です。そのため段を融合しても
+ * 段ごとに全体を走査した場合と結果は同じです(他のエンティティを読む処理は通常の System にしてください)。
+ * パイプライン全体の Read/Write は各段の宣言の和として SystemScheduler に渡ります。
+ */
+
+/**
+ * @struct PipelineStage
+ * @brief パイプラインの1段の基底(アクセスするコンポーネントを宣言の順に Apply() へ渡す)
+ *
+ * @tparam Access Read<T> または Write<T> の並び(1つ以上)
+ *
+ * @details
+ * 派生クラスは次の関数を定義します(Read<T> の引数は const T& で受けられます)。
+ * @code
+ * void Apply(Entity e, T1& c1, T2& c2, ..., float dt);
+ * @endcode
+ */
+template<class... Access>
+struct PipelineStage {
+    static_assert(sizeof...(Access) > 0, "PipelineStage にはアクセスするコンポーネントが1つ以上必要です");
+};
+
+template<class... Access>
+struct PipelineAccessTarget;
+
+template<class T>
+struct PipelineAccessTarget<Read<T>> { using type = T; };
+
+template<class T>
+struct PipelineAccessTarget<Write<T>> { using type = T; };
+
+/**
+ * @brief 段の宣言(アクセスの並びとコンポーネントの並び)を取り出す
+ */
+template<class Stage>
+struct PipelineStageTraits {
+private:
+    template<class... Access>
+    static std::tuple<Access...> accessOf(const PipelineStage<Access...>*);
+    template<class... Access>
+    static std::tuple<typename PipelineAccessTarget<Access>::type...> componentsOf(const PipelineStage<Access...>*);
+
+public:
+    using AccessList = decltype(accessOf(static_cast<const Stage*>(nullptr)));       ///< std::tuple<Read<T>/Write<T>...>
+    using Components = decltype(componentsOf(static_cast<const Stage*>(nullptr)));   ///< std::tuple<T...>(融合の判定に使う)
+};
+
+template<class Components>
+struct PipelineQuery;
+
+template<class... Cs>
+struct PipelineQuery<std::tuple<Cs...>> {
+    using type = QueryView<Cs...>;
+
+    static type& Get(World& world) { return world.Query<Cs...>(); }
+
+    template<class F>
+    static void ParallelForEach(World& world, F&& fn, size_t grainSize) {
+        world.ParallelForEach<Cs...>(std::forward<F>(fn), grainSize);
+    }
+};
+
+template<class AccessList>
+struct PipelineAccessBuilder;
+
+template<class... Access>
+struct PipelineAccessBuilder<std::tuple<Access...>> {
+    static void Build(ComponentMask& read, ComponentMask& write) {
+        SystemAccessBuilder<Access...>::Build(read, write);
+    }
+};
+
+/**
+ * @class Pipeline
+ * @brief PipelineStage の並びをコンパイル時に展開するシステム
+ *
+ * @tparam Stages PipelineStage の派生クラス(既定構築できるもの)。この順に実行する
+ *
+ * @par 使用例
+ * @code
+ * struct Integrate : PipelineStage<Write<Transform>, Write<Velocity>> {
+ *     void Apply(Entity, Transform& t, Velocity& v, float dt) { MovementSystem::Integrate(t, v, dt); }
+ * };
+ * struct Bob : PipelineStage<Write<Transform>, Write<Velocity>> {
+ *     void Apply(Entity, Transform& t, Velocity& v, float dt) { t.position.y += v.velocity.x * 0.1f * dt; }
+ * };
+ * struct Spin : PipelineStage<Write<Transform>, Read<Spinner>> {
+ *     void Apply(Entity, Transform& t, const Spinner& s, float dt) { t.rotation.y += s.speed * dt; }
+ * };
+ *
+ * // Integrate と Bob は Transform, Velocity の1回の走査、Spin は Transform, Spinner の走査
+ * auto& pipeline = world.AddSystem<Pipeline<Integrate, Bob, Spin>>();
+ * pipeline.SetParallelGrain(1024);
+ * pipeline.Stage<Spin>(); // 段の状態(設定・集計)へのアクセス
+ * @endcode
+ */
+template<class... Stages>
+class Pipeline : public ISystem {
+    static_assert(sizeof...(Stages) > 0, "Pipeline には1つ以上の段が必要です");
+
+public:
+    static constexpr size_t STAGE_COUNT = sizeof...(Stages);
+
+    Pipeline() {
+        (PipelineAccessBuilder<typename PipelineStageTraits<Stages>::AccessList>::Build(read_, write_), ...);
+        exclusive_ = false;
+    }
+
+    void OnCreate(World& world) override {
+        // 同じコンポーネントの並びの段は World がキャッシュした同じクエリを共有する
+        queries_ = std::make_tuple(&PipelineQuery<typename PipelineStageTraits<Stages>::Components>::Get(world)...);
+    }
+
+    void OnUpdate(World& world, float dt) override {
+        runFrom<0>(world, dt);
+    }
+
+    const char* GetName() const override { return "Pipeline"; }
+
+    /**
+     * @brief 1ジョブあたりのエンティティ数(0 ならメインスレッドで逐次、既定 0)
+     *
+     * @details
+     * 0 以外の場合、各走査を World::ParallelForEach でワーカーに分割します。
+     * 段の Apply() と段のメンバーの更新はスレッド安全にしてください。
+     */
+    void SetParallelGrain(size_t grainSize) { parallelGrain_ = grainSize; }
+
+    /**
+     * @brief 段の実体(段の設定・集計用)
+     */
+    template<class S>
+    S& Stage() { return std::get<S>(stages_); }
+
+    /**
+     * @brief 1フレームの走査の回数(融合後のグループ数、コンパイル時に決まる)
+     */
+    static constexpr size_t SweepCount() { return countSweeps(0); }
+
+private:
+    using ComponentLists = std::tuple<typename PipelineStageTraits<Stages>::Components...>;
+
+    // 段 I から同じコンポーネントの並びが続く範囲の終わり
+    template<size_t I, size_t J = I + 1>
+    static constexpr size_t groupEnd() {
+        if constexpr (J >= STAGE_COUNT) {
+            return STAGE_COUNT;
+        } else if constexpr (std::is_same_v<std::tuple_element_t<I, ComponentLists>, std::tuple_element_t<J, ComponentLists>>) {
+            return groupEnd<I, J + 1>();
+        } else {
+            return J;
+        }
+    }
+
+    template<size_t... I>
+    static constexpr size_t groupEndAt(size_t index, std::index_sequence<I...>) {
+        size_t end = STAGE_COUNT;
+        ((I == index ? (end = groupEnd<I>(), 0) : 0), ...);
+        return end;
+    }
+
+    static constexpr size_t countSweeps(size_t index) {
+        return index >= STAGE_COUNT ? 0 : 1 + countSweeps(groupEndAt(index, std::index_sequence_for<Stages...>()));
+    }
+
+    // 段 I から始まるグループを1回の走査で実行し、次のグループへ進む
+    template<size_t I>
+    void runFrom(World& world, float dt) {
+        if constexpr (I < STAGE_COUNT) {
+            constexpr size_t End = groupEnd<I>();
+            using Query = PipelineQuery<std::tuple_element_t<I, ComponentLists>>;
+            auto sweep = [this, dt](Entity e, auto&... components) {
+                applyRange<I, End>(e, dt, components...);
+            };
+            if (parallelGrain_ > 0) {
+                Query::ParallelForEach(world, sweep, parallelGrain_);
+            } else {
+                std::get<I>(queries_)->ForEach(sweep);
+            }
+            runFrom<End>(world, dt);
+        }
+    }
+
+    template<size_t I, size_t End, class... Cs>
+    void applyRange(Entity e, float dt, Cs&... components) {
+        if constexpr (I < End) {
+            std::get<I>(stages_).Apply(e, components..., dt);
+            applyRange<I + 1, End>(e, dt, components...);
+        }
+    }
+
+    std::tuple<Stages...> stages_;                                                                  ///< 段の実体
+    std::tuple<typename PipelineQuery<typename PipelineStageTraits<Stages>::Components>::type*...> queries_{}; ///< 段ごとのクエリ
+    size_t parallelGrain_ = 0;                                                                      ///< 0 なら逐次
+};
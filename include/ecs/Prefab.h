@@ -0,0 +1,148 @@
+#pragma once
+#include "ecs/Entity.h"
+#include "ecs/ComponentId.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @file Prefab.h
+ * @brief エンティティの雛形(プレハブ)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * コンポーネントの初期値を一度だけ組み立てておき、World::Instantiate() で
+ * 同じ構成のエンティティをまとめて生成します。一括生成ではID・コンポーネントスロット・
+ * Behaviour登録を型ごとに連続して確保するため、EntityBuilder を繰り返すより高速です。
+ */
+
+class World;
+
+/**
+ * @class Prefab
+ * @brief コンポーネント初期値の集合
+ *
+ * @par 使用例
+ * @code
+ * Prefab bullet;
+ * bullet.With<Transform>()
+ *       .With<MeshRenderer>(DirectX::XMFLOAT3{1, 1, 0})
+ *       .With<Bullet>();
+ *
+ * std::vector<Entity> spawned = world.Instantiate(bullet, 500, World::Cause::Spawner);
+ * for (Entity e : spawned) {
+ *     world.Get<Transform>(e).position = RandomPosition();
+ * }
+ * @endcode
+ *
+ * @note コンポーネントはコピー構築されます。T はコピー構築可能である必要があります
+ */
+class Prefab {
+public:
+    Prefab() = default;
+    Prefab(const Prefab&) = delete;
+    Prefab& operator=(const Prefab&) = delete;
+    Prefab(Prefab&&) = default;
+    Prefab& operator=(Prefab&&) = default;
+
+    /**
+     * @brief コンポーネントの初期値を追加(同じ型が既にあれば置き換え)
+     * @tparam T コンポーネントの型
+     * @param[in] args コンストラクタ引数
+     * @return Prefab& メソッドチェーン用の自身への参照
+     */
+    template<class T, class... Args>
+    Prefab& With(Args&&... args) {
+        static_assert(std::is_copy_constructible<T>::value, "Prefab components must be copy constructible");
+        ComponentTypeId type = ComponentId<T>();
+        std::unique_ptr<IEntry> entry(new Entry<T>(type, std::forward<Args>(args)...));
+        for (auto& e : entries_) {
+            if (e->type == type) {
+                e = std::move(entry);
+                return *this;
+            }
+        }
+        entries_.push_back(std::move(entry));
+        return *this;
+    }
+
+    /**
+     * @brief 初期値を取得(存在しない場合nullptr)
+     */
+    template<class T>
+    T* TryGet() {
+        ComponentTypeId type = ComponentId<T>();
+        for (auto& e : entries_) {
+            if (e->type == type) return &static_cast<Entry<T>*>(e.get())->proto;
+        }
+        return nullptr;
+    }
+
+    template<class T>
+    bool Has() const {
+        ComponentTypeId type = ComponentId<T>();
+        for (auto& e : entries_) {
+            if (e->type == type) return true;
+        }
+        return false;
+    }
+
+    size_t ComponentCount() const { return entries_.size(); }
+    bool Empty() const { return entries_.empty(); }
+
+private:
+    friend class World;
+
+    struct IEntry {
+        explicit IEntry(ComponentTypeId t) : type(t) {}
+        virtual ~IEntry() = default;
+
+        // entities[0..count) に初期値のコピーを追加する
+        virtual void Instantiate(World& world, const Entity* entities, size_t count, EntityCause cause) const = 0;
+
+        // プールから再利用する entity のコンポーネントを初期値のコピーに戻す（無ければ追加）
+        virtual void Reset(World& world, Entity entity, EntityCause cause) const = 0;
+
+        ComponentTypeId type; ///< コンポーネント型ID
+    };
+
+    template<class T>
+    struct Entry : IEntry {
+        template<class... Args>
+        explicit Entry(ComponentTypeId t, Args&&... args) : IEntry(t), proto(std::forward<Args>(args)...) {}
+
+        void Instantiate(World& world, const Entity* entities, size_t count, EntityCause cause) const override {
+            instantiate(world, entities, count, cause, proto);
+        }
+
+        void Reset(World& world, Entity entity, EntityCause cause) const override {
+            reset(world, entity, cause, proto);
+        }
+
+        // W は World(実体化を World の定義後まで遅らせるため)
+        template<class W>
+        static void instantiate(W& world, const Entity* entities, size_t count, EntityCause cause, const T& value) {
+            world.template instantiateComponents<T>(entities, count, cause, value);
+        }
+
+        template<class W>
+        static void reset(W& world, Entity entity, EntityCause cause, const T& value) {
+            world.template resetComponent<T>(entity, cause, value);
+        }
+
+        T proto; ///< 初期値
+    };
+
+    bool hasType(ComponentTypeId type) const {
+        for (auto& e : entries_) {
+            if (e->type == type) return true;
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<IEntry>> entries_; ///< 追加順の初期値
+};
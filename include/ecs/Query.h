@@ -0,0 +1,350 @@
+#pragma once
+#include "ecs/Entity.h"
+#include "ecs/ComponentId.h"
+#include "ecs/ComponentStorage.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include <utility>
+
+/**
+ * @file Query.h
+ * @brief 複数コンポーネントのキャッシュ付きクエリ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.2
+ *
+ * @details
+ * 条件に一致するエンティティ集合を保持し、Add/Remove/破棄のたびに差分更新します。
+ * 毎フレームの走査では集合を読むだけなので、IDのコピーやハッシュ検索は発生しません。
+ */
+
+/**
+ * @struct Without
+ * @brief クエリの除外条件(指定したコンポーネントを持つエンティティを除外)
+ *
+ * @par 使用例
+ * @code
+ * auto& q = world.Query<Transform, Velocity>(Without<PlayerTag>());
+ * @endcode
+ */
+template<class... Ts>
+struct Without {};
+
+/**
+ * @struct With
+ * @brief クエリの追加の必須条件(指定したコンポーネントを持つことだけを要求し、ForEach には渡さない)
+ *
+ * @details
+ * タグ(データを持たない型)で絞り込む場合に使用します。
+ *
+ * @par 使用例
+ * @code
+ * auto& enemies = world.Query<Transform>(With<EnemyTag>(), Without<PlayerTag>());
+ * enemies.ForEach([](Entity e, Transform& t) { ... });
+ * @endcode
+ */
+template<class... Ts>
+struct With {};
+
+/**
+ * @struct Changed
+ * @brief 指定ティックより後に変更された T だけを走査するフィルタ
+ *
+ * @details
+ * 変更ティックは World::Add/Instantiate、非const の Get/TryGet、World::MarkChanged で記録されます。
+ * ForEach が渡す参照経由の書き込みは記録されないため、必要に応じて MarkChanged を呼んでください。
+ *
+ * @par 使用例
+ * @code
+ * uint32_t since = lastTick_;
+ * lastTick_ = world.AdvanceChangeTick();
+ * auto& q = world.Query<Transform, MeshRenderer>();
+ * q.ForEach(Changed<Transform>(since), [](Entity e, Transform& t, MeshRenderer& mr) {
+ *     // since の後に Transform が変更されたエンティティだけ
+ * });
+ * @endcode
+ */
+template<class T>
+struct Changed {
+    explicit Changed(uint32_t since = 0) : sinceTick(since) {}
+    uint32_t sinceTick; ///< このティックより後の変更が対象
+};
+
+/**
+ * @struct Added
+ * @brief 指定ティックより後に追加された T だけを走査するフィルタ
+ */
+template<class T>
+struct Added {
+    explicit Added(uint32_t since = 0) : sinceTick(since) {}
+    uint32_t sinceTick; ///< このティックより後の追加が対象
+};
+
+/**
+ * @class QueryBase
+ * @brief 型に依存しないクエリの一致集合管理
+ *
+ * @details
+ * 一致集合は密なエンティティID配列と、ID -> 位置 の逆引き配列で管理します。
+ * 走査中に集合から外れたエンティティは 0 で埋めておき、走査終了時にまとめて詰めます。
+ * これにより走査中のAdd/Removeでも同じエンティティを二重に訪問しません。
+ */
+class QueryBase {
+public:
+    QueryBase(const ComponentMask& include, const ComponentMask& exclude, const void* typeKey)
+        : include_(include), exclude_(exclude), typeKey_(typeKey) {}
+
+    virtual ~QueryBase() = default;
+
+    QueryBase(const QueryBase&) = delete;
+    QueryBase& operator=(const QueryBase&) = delete;
+
+    /**
+     * @brief シグネチャが条件に一致するか
+     */
+    bool Matches(const ComponentMask& signature) const {
+        return (signature & include_) == include_ && (signature & exclude_).none();
+    }
+
+    /**
+     * @brief 無効化されたコンポーネントを考慮して一致するか
+     *
+     * @details
+     * 無効なコンポーネントは必須条件を満たしませんが、除外条件(Without)には存在するものとして数えます。
+     * (無効化した LocalToWorld を TransformSystem が追加し直す、といった二重追加を防ぐため)
+     */
+    bool Matches(const ComponentMask& signature, const ComponentMask& disabled) const {
+        return ((signature & ~disabled) & include_) == include_ && (signature & exclude_).none();
+    }
+
+    /**
+     * @brief エンティティのシグネチャ変化を反映(World から呼ばれる)
+     * @param[in] disabled シグネチャのうち無効化されている型
+     */
+    void OnSignatureChanged(uint32_t id, const ComponentMask& signature, const ComponentMask& disabled = ComponentMask()) {
+        bool member = Contains(id);
+        bool match = signature.any() && Matches(signature, disabled);
+        if (match && !member) {
+            insert(id);
+        } else if (!match && member) {
+            erase(id);
+        }
+    }
+
+    bool Contains(uint32_t id) const {
+        return id < position_.size() && position_[id] != 0;
+    }
+
+    /**
+     * @brief 一致しているエンティティ数
+     */
+    size_t Size() const { return count_; }
+
+    bool Empty() const { return count_ == 0; }
+
+    const ComponentMask& IncludeMask() const { return include_; }
+    const ComponentMask& ExcludeMask() const { return exclude_; }
+    const void* TypeKey() const { return typeKey_; }
+
+    /**
+     * @brief 内部配列の長さ(走査中に外れた墓石を含む)
+     *
+     * @details
+     * ForEachInRange() の範囲指定に使用します。
+     */
+    size_t DenseCount() const { return entities_.size(); }
+
+    /**
+     * @brief 走査区間を示すRAIIガード(入れ子可)
+     *
+     * @details
+     * 区間中の削除は墓石化され、位置が動きません。範囲を分割して並列走査する場合は
+     * 呼び出し側で全体をこのガードで囲んでください。
+     */
+    struct IterationScope {
+        explicit IterationScope(QueryBase& q) : query(q) { query.iterating_.fetch_add(1, std::memory_order_relaxed); }
+        ~IterationScope() {
+            if (query.iterating_.fetch_sub(1, std::memory_order_acq_rel) == 1 && query.needsCompaction_) {
+                query.compact();
+            }
+        }
+        QueryBase& query;
+    };
+
+protected:
+    std::vector<uint32_t> entities_;   ///< 一致エンティティID(走査中の削除は0で埋める)
+
+private:
+    void insert(uint32_t id) {
+        if (id >= position_.size()) {
+            position_.resize(id + 1, 0);
+        }
+        entities_.push_back(id);
+        position_[id] = static_cast<uint32_t>(entities_.size());
+        ++count_;
+    }
+
+    void erase(uint32_t id) {
+        uint32_t pos = position_[id] - 1;
+        position_[id] = 0;
+        --count_;
+
+        if (iterating_.load(std::memory_order_relaxed) > 0) {
+            // 走査中は位置を動かさず墓石化
+            entities_[pos] = 0;
+            needsCompaction_ = true;
+            return;
+        }
+
+        uint32_t last = entities_.back();
+        entities_.pop_back();
+        if (pos < entities_.size()) {
+            entities_[pos] = last;
+            position_[last] = pos + 1;
+        }
+    }
+
+    void compact() {
+        size_t write = 0;
+        for (size_t read = 0; read < entities_.size(); ++read) {
+            uint32_t id = entities_[read];
+            if (id == 0) continue;
+            entities_[write] = id;
+            position_[id] = static_cast<uint32_t>(write + 1);
+            ++write;
+        }
+        entities_.resize(write);
+        needsCompaction_ = false;
+    }
+
+    ComponentMask include_;            ///< 必須コンポーネント
+    ComponentMask exclude_;            ///< 除外コンポーネント
+    const void* typeKey_;              ///< クエリ型の識別子(同一マスクで型順が異なる場合の区別用)
+    std::vector<uint32_t> position_;   ///< EntityID -> entities_内の位置+1(0は非所属)
+    size_t count_ = 0;                 ///< 一致数(墓石を除く)
+    std::atomic<int> iterating_{ 0 };  ///< 走査の入れ子深さ(読み取りフェーズでは複数スレッドが同じクエリを同時に走査する)
+    bool needsCompaction_ = false;     ///< 走査終了後に詰める必要があるか
+};
+
+/**
+ * @class QueryView
+ * @brief コンポーネント型付きのキャッシュ付きクエリ
+ *
+ * @tparam Ts 必須コンポーネントの型
+ *
+ * @details
+ * World::Query<Ts...>() で取得します。取得したクエリはWorldが所有し、
+ * Worldが破棄されるまで有効なので、参照を保持して毎フレーム使い回せます。
+ *
+ * @par 使用例
+ * @code
+ * auto& movers = world.Query<Transform, Velocity>();
+ * movers.ForEach([dt](Entity e, Transform& t, Velocity& v) {
+ *     t.position.x += v.velocity.x * dt;
+ * });
+ * @endcode
+ */
+template<class... Ts>
+class QueryView : public QueryBase {
+public:
+    QueryView(const ComponentMask& include, const ComponentMask& exclude, const void* typeKey,
+              const std::vector<uint32_t>* generations, ComponentStorageFor<Ts>*... stores)
+        : QueryBase(include, exclude, typeKey), generations_(generations), stores_(stores...) {}
+
+    /**
+     * @brief 一致する全エンティティを走査
+     * @param[in] fn void(Entity, Ts&...) 形式の関数
+     *
+     * @details
+     * 走査開始時点の一致集合を対象とします。走査中に追加された一致は次回から対象になり、
+     * 走査中に一致しなくなったエンティティはスキップされます。
+     */
+    template<class F>
+    void ForEach(F&& fn) {
+        IterationScope scope(*this);
+        forEachImpl(fn, 0, entities_.size(), AcceptAll(), std::index_sequence_for<Ts...>());
+    }
+
+    /**
+     * @brief since より後に C が変更されたエンティティだけを走査
+     * @tparam C Ts のいずれか
+     */
+    template<class C, class F>
+    void ForEach(Changed<C> filter, F&& fn) {
+        IterationScope scope(*this);
+        const ComponentStorageFor<C>* store = std::get<ComponentStorageFor<C>*>(stores_);
+        const uint32_t since = filter.sinceTick;
+        forEachImpl(fn, 0, entities_.size(),
+                    [store, since](uint32_t id) { return store->ChangedTick(id) > since; },
+                    std::index_sequence_for<Ts...>());
+    }
+
+    /**
+     * @brief since より後に C が追加されたエンティティだけを走査
+     * @tparam C Ts のいずれか
+     */
+    template<class C, class F>
+    void ForEach(Added<C> filter, F&& fn) {
+        IterationScope scope(*this);
+        const ComponentStorageFor<C>* store = std::get<ComponentStorageFor<C>*>(stores_);
+        const uint32_t since = filter.sinceTick;
+        forEachImpl(fn, 0, entities_.size(),
+                    [store, since](uint32_t id) { return store->AddedTick(id) > since; },
+                    std::index_sequence_for<Ts...>());
+    }
+
+    /**
+     * @brief 内部配列の [begin, end) だけを走査
+     * @param[in] begin 開始位置
+     * @param[in] end 終了位置(DenseCount() 以下)
+     * @param[in] fn void(Entity, Ts&...) 形式の関数
+     *
+     * @details
+     * IterationScope を張らないため、呼び出し側で走査全体を IterationScope で囲んでください。
+     * 範囲が重ならなければ複数スレッドから同時に呼び出せます(World::ParallelForEach で使用)。
+     */
+    template<class F>
+    void ForEachInRange(size_t begin, size_t end, F&& fn) {
+        if (end > entities_.size()) end = entities_.size();
+        forEachImpl(fn, begin, end, AcceptAll(), std::index_sequence_for<Ts...>());
+    }
+
+private:
+    struct AcceptAll {
+        bool operator()(uint32_t) const { return true; }
+    };
+
+    template<class F, class Pred, size_t... I>
+    void forEachImpl(F& fn, size_t begin, size_t end, Pred pred, std::index_sequence<I...>) {
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t id = entities_[i];
+            if (id == 0 || !pred(id)) continue;
+
+            std::tuple<Ts*...> comps(std::get<I>(stores_)->Find(id)...);
+            if (!allPresent(std::get<I>(comps)...)) continue;
+
+            fn(Entity{ id, (*generations_)[id] }, *std::get<I>(comps)...);
+        }
+    }
+
+    static bool allPresent() { return true; }
+
+    template<class P, class... Rest>
+    static bool allPresent(P* p, Rest*... rest) {
+        return p != nullptr && allPresent(rest...);
+    }
+
+    const std::vector<uint32_t>* generations_;  ///< World の世代テーブル
+    std::tuple<ComponentStorageFor<Ts>*...> stores_; ///< 各コンポーネントのストア
+};
+
+/**
+ * @brief クエリ型ごとの一意なキー
+ */
+template<class Q>
+inline const void* QueryTypeKey() {
+    static const char key = 0;
+    return &key;
+}
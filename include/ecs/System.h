@@ -0,0 +1,244 @@
+#pragma once
+#include "ecs/ComponentId.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <typeinfo>
+
+/**
+ * @file System.h
+ * @brief 読み書きするコンポーネントを宣言するシステムと、その並列スケジューラ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Behaviour がエンティティ単位のロジックであるのに対し、System はWorld全体を1回の更新で
+ * 処理するロジックです。各システムは Read<T> / Write<T> でアクセスするコンポーネントを宣言し、
+ * SystemScheduler は競合しないシステム同士をジョブシステム上で同時に実行します。
+ */
+
+class World;
+class JobSystem;
+
+/**
+ * @struct Read
+ * @brief システムが読み取るコンポーネントの宣言
+ */
+template<class T>
+struct Read {};
+
+/**
+ * @struct Write
+ * @brief システムが書き込むコンポーネントの宣言
+ */
+template<class T>
+struct Write {};
+
+/**
+ * @class ISystem
+ * @brief 型に依存しないシステムの基底クラス
+ *
+ * @details
+ * 通常は System<Read<...>, Write<...>> を継承してください。
+ * アクセス宣言を持たないシステム(Exclusive)は、他のすべてのシステムと直列に実行されます。
+ */
+class ISystem {
+public:
+    virtual ~ISystem() = default;
+
+    /**
+     * @brief スケジューラに登録された直後に1回呼ばれる(メインスレッド)
+     *
+     * @details
+     * World::Query() の取得など、構造変更を伴う準備はここで行ってください。
+     * OnUpdate() は他のシステムと並列に呼ばれるため、その中で新しいクエリを作成できません。
+     */
+    virtual void OnCreate(World& world) {}
+
+    /**
+     * @brief 毎フレーム呼ばれる更新処理
+     * @param[in] world ゲームワールド
+     * @param[in] dt デルタタイム(秒)
+     */
+    virtual void OnUpdate(World& world, float dt) = 0;
+
+    /**
+     * @brief ログ表示用の名前
+     */
+    virtual const char* GetName() const { return typeid(*this).name(); }
+
+    const ComponentMask& ReadMask() const { return read_; }
+    const ComponentMask& WriteMask() const { return write_; }
+
+    /**
+     * @brief 他のシステムと同時実行できないか
+     */
+    bool IsExclusive() const { return exclusive_; }
+
+    /**
+     * @brief 2つのシステムが同時実行できないか判定
+     *
+     * @details
+     * どちらかの書き込み集合が相手の読み書き集合と重なる場合に競合します。
+     * 読み取り同士は競合しません。
+     */
+    bool ConflictsWith(const ISystem& other) const {
+        if (exclusive_ || other.exclusive_) return true;
+        return (write_ & (other.read_ | other.write_)).any() ||
+               (other.write_ & read_).any();
+    }
+
+    bool IsEnabled() const { return enabled_; }
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+
+protected:
+    ComponentMask read_;      ///< 読み取るコンポーネント
+    ComponentMask write_;     ///< 書き込むコンポーネント
+    bool exclusive_ = true;   ///< アクセス宣言なし(全体を排他)
+    bool enabled_ = true;     ///< 無効なシステムは実行されない
+};
+
+template<class... Access>
+struct SystemAccessBuilder;
+
+template<>
+struct SystemAccessBuilder<> {
+    static void Build(ComponentMask&, ComponentMask&) {}
+};
+
+template<class T, class... Rest>
+struct SystemAccessBuilder<Read<T>, Rest...> {
+    static void Build(ComponentMask& read, ComponentMask& write) {
+        read |= MakeComponentMask<T>();
+        SystemAccessBuilder<Rest...>::Build(read, write);
+    }
+};
+
+template<class T, class... Rest>
+struct SystemAccessBuilder<Write<T>, Rest...> {
+    static void Build(ComponentMask& read, ComponentMask& write) {
+        write |= MakeComponentMask<T>();
+        SystemAccessBuilder<Rest...>::Build(read, write);
+    }
+};
+
+/**
+ * @class System
+ * @brief アクセスするコンポーネントを型で宣言するシステム
+ *
+ * @tparam Access Read<T> または Write<T> の並び
+ *
+ * @par 使用例
+ * @code
+ * struct MovementSystem : System<Read<Velocity>, Write<Transform>> {
+ *     QueryView<Transform, Velocity>* movers = nullptr;
+ *
+ *     void OnCreate(World& world) override {
+ *         movers = &world.Query<Transform, Velocity>();
+ *     }
+ *
+ *     void OnUpdate(World& world, float dt) override {
+ *         movers->ForEach([dt](Entity, Transform& t, Velocity& v) {
+ *             t.position.x += v.velocity.x * dt;
+ *         });
+ *     }
+ * };
+ *
+ * world.AddSystem<MovementSystem>();
+ * @endcode
+ *
+ * @note 宣言していないコンポーネントへのアクセスは検出されません。宣言に漏れがないようにしてください
+ */
+template<class... Access>
+class System : public ISystem {
+public:
+    System() {
+        SystemAccessBuilder<Access...>::Build(read_, write_);
+        exclusive_ = sizeof...(Access) == 0;
+    }
+};
+
+/**
+ * @class SystemScheduler
+ * @brief システムの依存関係を解析し、段階(ステージ)ごとに並列実行する
+ *
+ * @details
+ * 登録順を基準に、先に登録された競合システムより後のステージへ配置します。
+ * 同じステージのシステムは互いに競合しないため、ジョブシステム上で同時に実行されます。
+ * ステージ構成はシステムの追加時にのみ再構築します(無効なシステムは実行時にスキップ)。
+ *
+ * @note World が所有します。World::AddSystem() から登録してください
+ */
+class SystemScheduler {
+public:
+    SystemScheduler() = default;
+    SystemScheduler(const SystemScheduler&) = delete;
+    SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+    /**
+     * @brief システムを登録
+     * @return ISystem& 登録したシステム(スケジューラ破棄まで有効)
+     */
+    ISystem& Add(std::unique_ptr<ISystem> system) {
+        systems_.push_back(std::move(system));
+        dirty_ = true;
+        return *systems_.back();
+    }
+
+    /**
+     * @brief 全システムを1フレーム分実行
+     * @param[in] world ゲームワールド
+     * @param[in] jobs ジョブシステム(nullptrなら逐次実行)
+     * @param[in] dt デルタタイム(秒)
+     *
+     * @details 実装は World.h の末尾にあります(World の定義が必要なため)
+     */
+    void Run(World& world, JobSystem* jobs, float dt);
+
+    size_t Count() const { return systems_.size(); }
+
+    /**
+     * @brief ステージ数(依存グラフの深さ)
+     */
+    size_t StageCount() {
+        rebuildIfDirty();
+        return stages_.size();
+    }
+
+    void Clear() {
+        systems_.clear();
+        stages_.clear();
+        dirty_ = false;
+    }
+
+private:
+    void rebuildIfDirty() {
+        if (!dirty_) return;
+        dirty_ = false;
+
+        stages_.clear();
+        std::vector<size_t> stageOf(systems_.size(), 0);
+        for (size_t i = 0; i < systems_.size(); ++i) {
+            // 先行する競合システムのうち最も深いステージの次に配置
+            size_t stage = 0;
+            for (size_t j = 0; j < i; ++j) {
+                if (systems_[i]->ConflictsWith(*systems_[j]) && stageOf[j] + 1 > stage) {
+                    stage = stageOf[j] + 1;
+                }
+            }
+            stageOf[i] = stage;
+
+            if (stage >= stages_.size()) {
+                stages_.resize(stage + 1);
+            }
+            stages_[stage].push_back(systems_[i].get());
+        }
+    }
+
+    static void runOne(ISystem* system, World& world, float dt);
+
+    std::vector<std::unique_ptr<ISystem>> systems_;  ///< 登録順のシステム
+    std::vector<std::vector<ISystem*>> stages_;      ///< ステージごとの同時実行可能なシステム
+    bool dirty_ = false;                             ///< ステージ再構築が必要か
+};
@@ -0,0 +1,284 @@
+#pragma once
+#include "ecs/Entity.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/**
+ * @file TaskScheduler.h
+ * @brief World が Tick() ごとに再開する、待ちを挟んで進む非同期タスク
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * タスクは「1区切り分の処理をして、次に再開する条件(TaskWait)を返す」関数です。
+ * 区切りの間の状態はラムダのキャプチャ(mutable)に持たせます。
+ * 待ちの種類ごとに置き場所を分けるため、待っている間のタスクは呼ばれません。
+ * - NextFrame: 次の Tick() の再開リスト
+ * - Seconds: 再開時刻の最小ヒープ(時刻になったものだけ取り出す)
+ * - Until: 毎フレーム条件だけを確認するリスト(読み込みの完了待ちなど、時刻で決まらないもの)
+ * タイマーが何千あっても、1フレームのコストは再開するタスクの数(と Until の条件の数)だけです。
+ *
+ * プロジェクトは C++17 のため co_await のコルーチンではなく、区切りごとに関数を呼び直す形にしています。
+ * 時刻は Tick() の dt を積算したワールド時間(一時停止・スロー再生に追従)です。
+ * タスクは Tick() のメインスレッドで、Behaviour の OnUpdate の後・システムの前に再開します
+ * (書き込みの段階なのでエンティティの生成・コンポーネントの追加ができます)。
+ */
+
+class World;
+
+/**
+ * @class TaskWait
+ * @brief タスクが次に再開する条件(タスクの戻り値)
+ */
+class TaskWait {
+public:
+    /**
+     * @enum Kind
+     * @brief 待ちの種類
+     */
+    enum class Kind : uint8_t {
+        Done,       ///< 終了
+        NextFrame,  ///< 次の Tick()
+        Seconds,    ///< ワールド時間で指定秒数の後
+        Until,      ///< 条件が true になった Tick()
+    };
+
+    static TaskWait Done() { return TaskWait(Kind::Done); }
+    static TaskWait NextFrame() { return TaskWait(Kind::NextFrame); }
+
+    /**
+     * @brief seconds 秒後に再開(0 以下は NextFrame と同じ)
+     */
+    static TaskWait Seconds(float seconds) {
+        TaskWait wait(seconds > 0.0f ? Kind::Seconds : Kind::NextFrame);
+        wait.seconds_ = seconds;
+        return wait;
+    }
+
+    /**
+     * @brief ready() が true を返した Tick() に再開(条件は毎フレーム1回呼ばれる)
+     */
+    static TaskWait Until(std::function<bool()> ready) {
+        TaskWait wait(ready ? Kind::Until : Kind::NextFrame);
+        wait.ready_ = std::move(ready);
+        return wait;
+    }
+
+    Kind GetKind() const { return kind_; }
+
+private:
+    friend class TaskScheduler;
+
+    explicit TaskWait(Kind kind) : kind_(kind) {}
+
+    Kind kind_;
+    float seconds_ = 0.0f;
+    std::function<bool()> ready_;
+};
+
+/**
+ * @struct TaskHandle
+ * @brief 開始したタスクの識別子(終了したタスクのハンドルは無効になる)
+ */
+struct TaskHandle {
+    uint32_t index = 0;
+    uint32_t gen = 0;   ///< 0 は無効
+
+    bool IsValid() const { return gen != 0; }
+};
+
+/**
+ * @struct TaskSchedulerStats
+ * @brief タスクの件数(TaskScheduler::GetStats())
+ */
+struct TaskSchedulerStats {
+    size_t active = 0;          ///< 実行中(待ちを含む)のタスク数
+    size_t nextFrame = 0;       ///< 次の Tick() に再開するタスク数
+    size_t sleeping = 0;        ///< 時刻待ちのタスク数
+    size_t polling = 0;         ///< 条件待ちのタスク数
+    size_t resumedLastTick = 0; ///< 直近の Run() で再開したタスク数
+};
+
+/**
+ * @class TaskScheduler
+ * @brief 非同期タスクの待ちの管理と再開(World::Tasks() で取得)
+ *
+ * @par 使用例
+ * @code
+ * // 1.5 秒ごとに 10 回スポーンして終了
+ * world.Tasks().Start([wave = 0](World& w) mutable -> TaskWait {
+ *     SpawnWave(w, wave);
+ *     if (++wave >= 10) return TaskWait::Done();
+ *     return TaskWait::Seconds(1.5f);
+ * });
+ *
+ * // モデルの読み込みを待ってから配置(owner が破棄されていたら再開せずに終了)
+ * auto handle = resources.AcquireModel(path);
+ * auto loaded = [&resources, handle]() {
+ *     const std::vector<ModelComponent>* models = nullptr;
+ *     return resources.GetModelAsync(handle, models) != ResourceManager::LoadState::Loading;
+ * };
+ * world.Tasks().Start([&resources, handle](World& w) -> TaskWait {
+ *     const std::vector<ModelComponent>* models = nullptr;
+ *     if (resources.GetModelAsync(handle, models) == ResourceManager::LoadState::Ready) Place(w, *models);
+ *     return TaskWait::Done();
+ * }, TaskWait::Until(loaded), owner);
+ * @endcode
+ */
+class TaskScheduler {
+public:
+    using Step = std::function<TaskWait(World&)>;
+
+    TaskScheduler() = default;
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief タスクを開始(最初の区切りは次の Run() で実行)
+     * @param[in] step 1区切り分の処理
+     * @param[in] owner 指定した場合、再開の時点で破棄されていればタスクを終了する
+     * @return TaskHandle Cancel() / IsRunning() に使うハンドル
+     */
+    TaskHandle Start(Step step, Entity owner = Entity{ 0, 0 }) {
+        return Start(std::move(step), TaskWait::NextFrame(), owner);
+    }
+
+    /**
+     * @brief タスクを開始(最初の区切りは first の待ちが明けた時に実行)
+     */
+    TaskHandle Start(Step step, TaskWait first, Entity owner = Entity{ 0, 0 }) {
+        if (!step) return TaskHandle{};
+        uint32_t index;
+        if (!freeSlots_.empty()) {
+            index = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        Slot& slot = slots_[index];
+        slot.step = std::move(step);
+        slot.owner = owner;
+        slot.active = true;
+        ++activeCount_;
+        const TaskHandle handle{ index, slot.gen };
+        schedule(handle, std::move(first));
+        return handle;
+    }
+
+    /**
+     * @brief タスクを終了(待ちのリストからは次に取り出す時に外れる)
+     * @return bool 実行中のタスクだった場合 true
+     */
+    bool Cancel(TaskHandle handle) {
+        if (!IsRunning(handle)) return false;
+        finish(handle.index);
+        return true;
+    }
+
+    bool IsRunning(TaskHandle handle) const {
+        return handle.IsValid() && handle.index < slots_.size() &&
+            slots_[handle.index].active && slots_[handle.index].gen == handle.gen;
+    }
+
+    /**
+     * @brief すべてのタスクを終了
+     */
+    void Clear() {
+        for (uint32_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].active) finish(i);
+        }
+        nextFrame_.clear();
+        polling_.clear();
+        timers_ = TimerQueue();
+    }
+
+    /**
+     * @brief 待ちが明けたタスクを再開(World::Tick() から呼ばれる。World の定義後に実装)
+     */
+    void Run(World& world, float dt);
+
+    /**
+     * @brief Run() で積算したワールド時間(秒)
+     */
+    double Time() const { return time_; }
+
+    TaskSchedulerStats GetStats() const {
+        TaskSchedulerStats stats;
+        stats.active = activeCount_;
+        stats.nextFrame = nextFrame_.size();
+        stats.sleeping = timers_.size();
+        stats.polling = polling_.size();
+        stats.resumedLastTick = resumedLastTick_;
+        return stats;
+    }
+
+private:
+    struct Slot {
+        Step step;
+        std::function<bool()> ready;  ///< Until の条件
+        Entity owner{ 0, 0 };
+        uint32_t gen = 1;
+        bool active = false;
+    };
+
+    struct Timer {
+        double wakeTime;
+        uint64_t order;       ///< 同じ時刻は待ちに入った順
+        TaskHandle handle;
+
+        bool operator>(const Timer& other) const {
+            return wakeTime != other.wakeTime ? wakeTime > other.wakeTime : order > other.order;
+        }
+    };
+
+    using TimerQueue = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>;
+
+    // 戻り値の待ちに応じて置き場所を決める
+    void schedule(TaskHandle handle, TaskWait&& wait) {
+        switch (wait.kind_) {
+        case TaskWait::Kind::Done:
+            finish(handle.index);
+            break;
+        case TaskWait::Kind::NextFrame:
+            nextFrame_.push_back(handle);
+            break;
+        case TaskWait::Kind::Seconds:
+            timers_.push(Timer{ time_ + wait.seconds_, timerOrder_++, handle });
+            break;
+        case TaskWait::Kind::Until:
+            slots_[handle.index].ready = std::move(wait.ready_);
+            polling_.push_back(handle);
+            break;
+        }
+    }
+
+    void finish(uint32_t index) {
+        Slot& slot = slots_[index];
+        slot.step = nullptr;
+        slot.ready = nullptr;
+        slot.active = false;
+        if (++slot.gen == 0) slot.gen = 1;
+        freeSlots_.push_back(index);
+        --activeCount_;
+    }
+
+    // 1区切りを実行して次の待ちに入れる(World の定義後に実装)
+    void resume(World& world, TaskHandle handle);
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<TaskHandle> nextFrame_;
+    std::vector<TaskHandle> running_;   ///< Run() 中に再開する NextFrame の写し(容量を使い回す)
+    std::vector<TaskHandle> polling_;
+    TimerQueue timers_;
+    double time_ = 0.0;
+    uint64_t timerOrder_ = 0;
+    size_t activeCount_ = 0;
+    size_t resumedLastTick_ = 0;
+};
@@ -0,0 +1,271 @@
+#pragma once
+#include "ecs/Entity.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * @file TimerWheel.h
+ * @brief World が Tick() ごとに進める階層タイマーホイール(遅延コールバックと遅延破棄)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 時刻を TickSeconds() 単位の刻みに丸め、64 スロット × 4 段のホイールに満了の刻みで振り分けます。
+ * 1段目は1刻みごと、2段目以降は 64 倍ずつ粗いスロットで、上の段のスロットは時刻がそこに達した時に
+ * 下の段へ振り分け直されます(カスケード)。タイマーはスロットごとの双方向リストの要素なので、
+ * 登録と取り消しはどちらも O(1) で、毎フレーム触るのは満了するタイマーと、進んだ刻みのスロットだけです。
+ * 4段で 2^24 刻み(既定の 1/60 秒で約 77 時間)まで表せ、それより先のタイマーは最上段で待ってから振り分け直します。
+ *
+ * 満了は指定時刻の後の最初の刻みで、最大1刻み遅れます。
+ * エンティティの遅延破棄(World::DestroyEntityAfter())は満了時に DestroyEntityWithCause() で予約するだけなので、
+ * 実際の破棄はほかの破棄と同じく FlushDestroyEndOfFrame() でまとめて行われます。
+ */
+
+class World;
+
+/**
+ * @struct TimerHandle
+ * @brief 登録したタイマーの識別子(満了・取り消しの後は無効になる)
+ */
+struct TimerHandle {
+    uint32_t index = 0;
+    uint32_t gen = 0;   ///< 0 は無効
+
+    bool IsValid() const { return gen != 0; }
+};
+
+/**
+ * @struct TimerWheelStats
+ * @brief タイマーの件数(TimerWheel::GetStats())
+ */
+struct TimerWheelStats {
+    size_t pending = 0;         ///< 待っているタイマー数
+    size_t capacity = 0;        ///< 確保済みのタイマーの枠
+    size_t firedLastTick = 0;   ///< 直近の Advance() で満了した数
+    size_t cascadedLastTick = 0;///< 直近の Advance() で下の段へ振り分け直した数
+};
+
+/**
+ * @class TimerWheel
+ * @brief 遅延コールバックとエンティティの遅延破棄(World::Timers() で取得)
+ *
+ * @par 使用例
+ * @code
+ * // 3 秒後に破棄(LifeTime と同じ)
+ * world.DestroyEntityAfter(bullet, 3.0f, World::Cause::LifetimeExpired);
+ *
+ * // 1.5 秒後に呼ぶ(取り消しは Cancel())
+ * TimerHandle h = world.Timers().Schedule(1.5f, [](World& w) { SpawnWave(w); });
+ * world.Timers().Cancel(h);
+ * @endcode
+ */
+class TimerWheel {
+public:
+    using Callback = std::function<void(World&)>;
+
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;  ///< 1段のスロット数
+    static constexpr uint32_t LEVELS = 4;               ///< 段数
+
+    explicit TimerWheel(float tickSeconds = 1.0f / 60.0f)
+        : tickSeconds_(tickSeconds > 0.0f ? tickSeconds : 1.0f / 60.0f) {
+        for (auto& level : heads_) {
+            for (uint32_t& head : level) head = NONE;
+        }
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief seconds 秒後に fn を呼ぶ(Tick() の中でメインスレッドから呼ばれる)
+     */
+    TimerHandle Schedule(float seconds, Callback fn) {
+        if (!fn) return TimerHandle{};
+        const uint32_t index = allocate(seconds);
+        nodes_[index].callback = std::move(fn);
+        return TimerHandle{ index, nodes_[index].gen };
+    }
+
+    /**
+     * @brief seconds 秒後に e を cause で破棄(満了時に破棄済みなら何もしない)
+     * @note 通常は World::DestroyEntityAfter() から使う
+     */
+    TimerHandle ScheduleDestroy(Entity e, float seconds, EntityCause cause) {
+        const uint32_t index = allocate(seconds);
+        nodes_[index].target = e;
+        nodes_[index].cause = cause;
+        return TimerHandle{ index, nodes_[index].gen };
+    }
+
+    /**
+     * @brief タイマーを取り消す
+     * @return bool 待っているタイマーだった場合 true
+     */
+    bool Cancel(TimerHandle handle) {
+        if (!IsPending(handle)) return false;
+        unlink(handle.index);
+        release(handle.index);
+        return true;
+    }
+
+    bool IsPending(TimerHandle handle) const {
+        return handle.IsValid() && handle.index < nodes_.size() &&
+            nodes_[handle.index].linked && nodes_[handle.index].gen == handle.gen;
+    }
+
+    /**
+     * @brief 満了までの残り秒数(待っていないタイマーは 0)
+     */
+    float Remaining(TimerHandle handle) const {
+        if (!IsPending(handle)) return 0.0f;
+        const double remaining = static_cast<double>(nodes_[handle.index].expiry) * tickSeconds_ - time_;
+        return remaining > 0.0 ? static_cast<float>(remaining) : 0.0f;
+    }
+
+    /**
+     * @brief すべてのタイマーを取り消す
+     */
+    void Clear() {
+        for (uint32_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i].linked) {
+                unlink(i);
+                release(i);
+            }
+        }
+    }
+
+    /**
+     * @brief 時刻を dt 進め、満了したタイマーを実行(World::Tick() から呼ばれる。World の定義後に実装)
+     */
+    void Advance(World& world, float dt);
+
+    float TickSeconds() const { return tickSeconds_; }
+
+    /**
+     * @brief Advance() で積算した時刻(秒)
+     */
+    double Time() const { return time_; }
+
+    TimerWheelStats GetStats() const {
+        TimerWheelStats stats;
+        stats.pending = pending_;
+        stats.capacity = nodes_.size();
+        stats.firedLastTick = firedLastTick_;
+        stats.cascadedLastTick = cascadedLastTick_;
+        return stats;
+    }
+
+private:
+    static constexpr uint32_t NONE = ~0u;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+    struct Node {
+        Callback callback;              ///< 空なら target の破棄
+        Entity target{ 0, 0 };
+        EntityCause cause = EntityCause::Unknown;
+        uint64_t expiry = 0;            ///< 満了の刻み
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint32_t gen = 1;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool linked = false;
+    };
+
+    uint32_t allocate(float seconds) {
+        uint32_t index;
+        if (!freeNodes_.empty()) {
+            index = freeNodes_.back();
+            freeNodes_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        // 満了は指定時刻以降の最初の刻み(少なくとも次の刻み)
+        const double due = time_ + (seconds > 0.0f ? seconds : 0.0f);
+        uint64_t expiry = static_cast<uint64_t>(std::ceil(due / tickSeconds_));
+        if (expiry <= now_) expiry = now_ + 1;
+        nodes_[index].expiry = expiry;
+        link(index);
+        ++pending_;
+        return index;
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes_[index];
+        node.callback = nullptr;
+        node.target = Entity{ 0, 0 };
+        if (++node.gen == 0) node.gen = 1;
+        freeNodes_.push_back(index);
+        --pending_;
+    }
+
+    // 満了の刻みと現在の刻みの差が収まる最も細かい段のスロットにつなぐ
+    void link(uint32_t index) {
+        Node& node = nodes_[index];
+        uint32_t level = 0;
+        uint64_t slotTick = node.expiry;
+        while (level + 1 < LEVELS && (node.expiry >> (SLOT_BITS * level)) - (now_ >> (SLOT_BITS * level)) >= SLOTS) {
+            ++level;
+        }
+        const uint32_t shift = SLOT_BITS * level;
+        if ((slotTick >> shift) - (now_ >> shift) >= SLOTS) {
+            // 最上段にも収まらない: 最上段の最後に振り分けるスロットで待つ
+            slotTick = ((now_ >> shift) + SLOTS - 1) << shift;
+        }
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>((slotTick >> shift) & SLOT_MASK);
+        uint32_t& head = heads_[node.level][node.slot];
+        node.prev = NONE;
+        node.next = head;
+        if (head != NONE) nodes_[head].prev = index;
+        head = index;
+        node.linked = true;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != NONE) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.level][node.slot] = node.next;
+        }
+        if (node.next != NONE) nodes_[node.next].prev = node.prev;
+        node.prev = NONE;
+        node.next = NONE;
+        node.linked = false;
+    }
+
+    // 上の段のスロットを現在の刻みから見た段へつなぎ直す
+    void cascade(uint32_t level) {
+        const uint32_t slot = static_cast<uint32_t>((now_ >> (SLOT_BITS * level)) & SLOT_MASK);
+        uint32_t index = heads_[level][slot];
+        heads_[level][slot] = NONE;
+        while (index != NONE) {
+            const uint32_t next = nodes_[index].next;
+            nodes_[index].linked = false;
+            link(index);
+            ++cascadedLastTick_;
+            index = next;
+        }
+    }
+
+    // 現在の刻みで満了したタイマーを実行(World の定義後に実装)
+    void expire(World& world);
+
+    float tickSeconds_;
+    double time_ = 0.0;
+    uint64_t now_ = 0;                      ///< 処理済みの刻み
+    uint32_t heads_[LEVELS][SLOTS];         ///< スロットごとのリストの先頭
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;
+    size_t pending_ = 0;
+    size_t firedLastTick_ = 0;
+    size_t cascadedLastTick_ = 0;
+};
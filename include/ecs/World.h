@@ -1,7 +1,22 @@
 #pragma once
 #include "ecs/Entity.h"
+#include "ecs/ComponentStorage.h"
+#include "ecs/ComponentId.h"
+#include "ecs/Query.h"
+#include "ecs/System.h"
+#include "ecs/CommandBuffer.h"
+#include "ecs/EventChannel.h"
+#include "ecs/Prefab.h"
+#include "ecs/EntityPool.h"
+#include "ecs/TaskScheduler.h"
+#include "ecs/TimerWheel.h"
+#include "ecs/WorldSnapshot.h"
+#include "ecs/ComponentReflection.h"
+#include "app/JobSystem.h"
+#include "app/FrameArena.h"
 #include "components/Component.h"
 #include "app/DebugLog.h" // デバッグビルド/リリースビルド両方で必要
+#include "app/Profiler.h"
 #include "components/Model.h"
 #include <unordered_map>
 #include <typeindex>
@@ -11,22 +26,26 @@
 #include <stdexcept>
 #include <cstdio>
 #include <memory>
-#include <unordered_set>
 #include <algorithm> // std::remove_if のために追加
+#include <atomic>
 #include <limits>
+#include <cstdint>
 #include <mutex>
+#include <new>
 #include <string> // std::to_string のために追加
+#include <thread>
 
 #ifdef _DEBUG
 #include <cassert>
 #endif
+#include <chrono>
 
 /**
  * @file World.h
  * @brief ECSワールド管理システムとエンティティビルダーの定義
  * @author 山内陽
  * @date 2025
- * @version 5.0
+ * @version 5.3
  *
  * @details
  * ECSアーキテクチャの中核となるWorldクラスと、
@@ -35,6 +54,158 @@
 
 class World; ///< 前方宣言
 
+/**
+ * @enum WorldPhase
+ * @brief World のアクセスの段階(World::GetPhase())
+ *
+ * @details
+ * - Write: 同期点(Tick() の Behaviour 更新・逐次のシステム・フレーム境界、Tick() の外)。
+ *   構造変更(エンティティの作成・破棄の反映、コンポーネントの追加・削除、クエリの作成)は
+ *   この段階で、同時に1つのスレッドからだけ行えます。
+ * - Read: 並列のシステムのステージ・ParallelForEach()・World::ReadPhaseScope の間。
+ *   IsAlive / Has / Peek / const の TryGet と作成済みのクエリの走査は、複数のスレッドから同時に行えます
+ *   (コンポーネントの値の書き込みは、システムが Write<T> で宣言した型、または自分のエンティティだけ)。
+ *   非 const の TryGet / Get / MarkChanged は変更ティックを書き込み Changed<T> の対象にするため、書き込みと同じ扱いです。
+ *   構造変更は例外またはエラーになるため、CommandBuffer / EnqueueSpawn / DestroyEntity(キュー)で予約します。
+ *
+ * 読み取りはロックを取りません。デバッグビルドでは、構造変更の入口で別スレッドとの同時実行と、
+ * Tick() 中に Tick() を呼んだスレッド以外からの構造変更を検出して DEBUGLOG_ERROR に出力します。
+ */
+enum class WorldPhase : uint8_t {
+    Write,  ///< 構造変更ができる(1スレッド)
+    Read,   ///< 複数スレッドから読み取れる(構造変更は予約のみ)
+};
+
+// 構造変更の入口に置き、デバッグビルドでスレッドの競合を検出する(リリースビルドでは何もしない)
+#ifdef _DEBUG
+#define WORLD_WRITE_ACCESS(operation) WriteAccessCheck worldWriteAccess_(*this, operation)
+#else
+#define WORLD_WRITE_ACCESS(operation) ((void)0)
+#endif
+
+/**
+ * @enum BehaviourExceptionPolicy
+ * @brief Behaviour の OnStart / OnUpdate / UpdateBatch が投げた例外の扱い(World::SetBehaviourExceptionPolicy())
+ *
+ * @details
+ * どの方式でも捕まえるのは std::exception の派生だけです。
+ */
+enum class BehaviourExceptionPolicy : uint8_t {
+    Catch,          ///< 呼び出しごとに try で囲む(デバッグビルドの既定)
+    CatchPerBatch,  ///< 型ごとのグループの走査全体を1つの try で囲み、例外の後は次の要素から再開する(リリースビルドの既定)
+    Propagate,      ///< 捕まえずに Tick() の呼び出し元へ伝える(World の状態は戻さない。デバッガ・クラッシュダンプ用)
+};
+
+/**
+ * @struct BehaviourStats
+ * @brief Behaviour の具象型ごとの更新コスト(World::GetBehaviourStats())
+ *
+ * @details
+ * 時間と呼び出し回数は World::SetBehaviourTimingEnabled(true) の間だけ加算されます。
+ */
+struct BehaviourStats {
+    const char* name = nullptr;  ///< 型名(typeid(T).name())
+    size_t live = 0;             ///< 現在登録されている数
+    uint64_t frames = 0;         ///< 計測したフレーム数(グループが空のフレームは除く)
+    uint64_t invocations = 0;    ///< OnUpdate の呼び出し回数(UpdateBatch の場合は処理した要素数)
+    double totalMs = 0.0;        ///< OnUpdate / UpdateBatch の合計時間(ミリ秒)
+    double lastMs = 0.0;         ///< 直近のフレームの時間
+    double maxMs = 0.0;          ///< 1フレームの最大時間
+    uint64_t exceptions = 0;     ///< 捕まえた例外の数(計測の有効・無効に関係なく加算)
+
+    /**
+     * @brief 1フレームあたりの平均時間(ミリ秒)
+     */
+    double AverageMs() const { return frames > 0 ? totalMs / static_cast<double>(frames) : 0.0; }
+};
+
+/**
+ * @class EntityRemap
+ * @brief World::MergeFrom() での移動元のハンドルから移動先のハンドルへの対応
+ *
+ * @details
+ * World::RegisterEntityRemap() で登録した関数に渡され、コンポーネント内の Entity を付け替えます。
+ * 移動しなかったエンティティ・古い世代のハンドルは無効なハンドル(Entity{})になります。
+ */
+class EntityRemap {
+public:
+    /**
+     * @struct Slot
+     * @brief 移動元のIDごとの対応
+     */
+    struct Slot {
+        uint32_t gen = 0; ///< 移動元の世代（0 は移動していない）
+        Entity to{};      ///< 移動先のエンティティ
+    };
+
+    explicit EntityRemap(const std::vector<Slot>& slots) : slots_(&slots) {}
+
+    Entity operator()(Entity from) const {
+        if (from.id >= slots_->size()) return Entity{};
+        const Slot& slot = (*slots_)[from.id];
+        return slot.gen != 0 && slot.gen == from.gen ? slot.to : Entity{};
+    }
+
+    /**
+     * @brief 移動元のIDから移動先のエンティティを取得（移動していない場合 Entity{}）
+     */
+    Entity Find(uint32_t id) const {
+        return id < slots_->size() && (*slots_)[id].gen != 0 ? (*slots_)[id].to : Entity{};
+    }
+
+private:
+    const std::vector<Slot>* slots_;
+};
+
+/**
+ * @struct ComponentStoreStats
+ * @brief コンポーネントの型ごとのストアの使用状況(World::GetComponentStoreStats())
+ */
+struct ComponentStoreStats {
+    const char* name = nullptr;  ///< 型名(typeid(T).name())
+    ComponentPoolStats pool;     ///< 格納数・容量・確保バイト数
+};
+
+/**
+ * @struct WorldStats
+ * @brief World の件数とメモリの概算(World::GetStats()、リリースビルドでも有効)
+ *
+ * @details
+ * 窓(window*)は直近に完了した集計窓(World のメトリクスの既定 1000 フレーム)の値で、
+ * 最初の窓が終わるまでは windowFrames が 0 です。
+ */
+struct WorldStats {
+    uint64_t frame = 0;               ///< Tick() の回数
+    float lastDt = 0.0f;              ///< 直近の Tick() の dt(秒)
+
+    size_t alive = 0;                 ///< 生存エンティティ数
+    size_t maxAlive = 0;              ///< 生存数の最大
+    uint64_t totalCreated = 0;        ///< 作成の累計
+    uint64_t totalDestroyed = 0;      ///< 破棄の累計
+    uint32_t createdLastFrame = 0;    ///< 直近の Tick() での作成数
+    uint32_t destroyedLastFrame = 0;  ///< 直近の Tick() での破棄数
+
+    uint32_t windowFrames = 0;        ///< 窓のフレーム数
+    uint32_t windowCreated = 0;       ///< 窓の作成数
+    uint32_t windowDestroyed = 0;     ///< 窓の破棄数
+    float windowDtAvg = 0.0f;         ///< 窓の dt の平均・最小・最大(秒)
+    float windowDtMin = 0.0f;
+    float windowDtMax = 0.0f;
+
+    size_t behaviours = 0;            ///< 登録中の Behaviour の数
+    size_t behaviourTypes = 0;        ///< Behaviour の型の数
+    size_t stores = 0;                ///< 作成済みのコンポーネントストアの数
+    ComponentPoolStats components;    ///< 全ストアの合計
+    size_t entityBytes = 0;           ///< エンティティIDごとの表(世代・生存ビット・シグネチャ・親子)の確保バイト数
+
+    std::vector<ComponentStoreStats> storeDetails; ///< ストアごとの使用状況(GetStats() で includeStores の場合のみ)
+
+    /**
+     * @brief コンポーネントとエンティティの表の確保バイト数の概算
+     */
+    size_t EstimatedBytes() const { return components.reservedBytes + entityBytes; }
+};
+
 /**
  * @class EntityBuilder
  * @brief エンティティ作成用のビルダーパターンクラス
@@ -168,6 +339,9 @@ private:
  *     .Build();
  * @endcode
  *
+ * @par スレッド
+ * 読み取りと構造変更の段階は WorldPhase を参照してください。
+ *
  * @see Entity
  * @see IComponent
  * @see Behaviour
@@ -176,18 +350,8 @@ private:
  */
 class World {
 public:
-    // 起因タグ（ログ解析用）
-    enum class Cause {
-        Unknown = 0,
-        Spawner = 1,
-        WaveTimer = 2,
-        Collision = 3,
-        LifetimeExpired = 4,
-        SceneInit = 5,
-        SceneTeardown = 6,   // シーン終了時
-        SceneUnload = 7,     // シーン切り替え時
-        AppShutdown = 8      // アプリケーション終了時
-    };
+    // 起因タグ（ログ解析用）。定義は Entity.h（CommandBuffer からも参照するため）
+    using Cause = EntityCause;
 
     static const char* CauseToString(Cause c) {
         switch (c) {
@@ -199,6 +363,7 @@ public:
         case Cause::SceneTeardown: return "SceneTeardown";
         case Cause::SceneUnload: return "SceneUnload";
         case Cause::AppShutdown: return "AppShutdown";
+        case Cause::Merged: return "Merged";
         default: return "Unknown";
         }
     }
@@ -208,7 +373,7 @@ public:
      * @return size_t 生存中のエンティティ数
      */
     size_t GetAliveCount() const {
-        return alive_.size();
+        return aliveCount_;
     }
 
     /**
@@ -216,7 +381,28 @@ public:
      * @return size_t 総エンティティ数
      */
     size_t GetEntityCount() const {
-        return alive_.size();
+        return aliveCount_;
+    }
+
+    /**
+     * @brief 生存中の全エンティティをID順に走査
+     * @param[in] fn void(Entity) 形式の関数
+     *
+     * @details
+     * 生存ビット列を64件単位で読み、空のワードは丸ごと読み飛ばします。
+     * コールバック内で破棄を予約しても走査には影響しません（破棄はEoFで反映）。
+     */
+    template<class F>
+    void ForEachEntity(F&& fn) const {
+        for (size_t w = 0; w < aliveBits_.size(); ++w) {
+            uint64_t bits = aliveBits_[w];
+            for (uint32_t b = 0; bits != 0; ++b, bits >>= 1) {
+                if (bits & 1u) {
+                    uint32_t id = static_cast<uint32_t>(w * 64 + b);
+                    fn(Entity{ id, generations_[id] });
+                }
+            }
+        }
     }
 
     /**
@@ -225,27 +411,29 @@ public:
      */
     ~World() {
         DEBUGLOG("World::~World() - World破棄中");
-        DEBUGLOG("アクティブエンティティ: " + std::to_string(alive_.size()));
-        DEBUGLOG("アクティブビヘイビア: " + std::to_string(behaviours_.size()));
+        DEBUGLOG("アクティブエンティティ: " + std::to_string(aliveCount_));
+        DEBUGLOG("アクティブビヘイビア: " + std::to_string(behaviourCount()));
 
         // 未処理の破棄キューを先に処理
         FlushDestroyEndOfFrame();
 
         // ⚠️ 残存エンティティを強制削除（原因をAppShutdownに明確化）
-        if (!alive_.empty()) {
-            DEBUGLOG_WARNING(std::to_string(alive_.size()) + " 個の残存エンティティを強制破棄 (原因=AppShutdown)");
+        if (aliveCount_ > 0) {
+            DEBUGLOG_WARNING(std::to_string(aliveCount_) + " 個の残存エンティティを強制破棄 (原因=AppShutdown)");
 
-            // イテレータ無効化を避けるためコピー
-            std::vector<uint32_t> aliveIds(alive_.begin(), alive_.end());
+            // 走査中にビットを変更しないようコピー
+            std::vector<uint32_t> aliveIds;
+            aliveIds.reserve(aliveCount_);
+            ForEachEntity([&aliveIds](Entity e) { aliveIds.push_back(e.id); });
             for (uint32_t id : aliveIds) {
                 DestroyEntityInternal(id, Cause::AppShutdown);
             }
 
-            DEBUGLOG("すべてのエンティティを破棄 (最終生存数: " + std::to_string(alive_.size()) + ")");
+            DEBUGLOG("すべてのエンティティを破棄 (最終生存数: " + std::to_string(aliveCount_) + ")");
         }
 
-        for (auto& pair : stores_) {
-            delete pair.second;
+        for (IStore* store : stores_) {
+            delete store;
         }
 
         DEBUGLOG("World破棄完了");
@@ -268,35 +456,188 @@ public:
      * @param cause 事象の原因
      */
     Entity CreateEntityWithCause(Cause cause) {
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中にエンティティ作成を試行 (EnqueueSpawnを使用してください)");
+            throw std::runtime_error("CreateEntity during ParallelForEach");
+        }
+        WORLD_WRITE_ACCESS("CreateEntity");
         if (enforceNoMutateDuranteUpdate_ && inUpdate_) {
             DEBUGLOG_WARNING(std::string("Update中にエンティティ作成 (原因=") + CauseToString(cause) + ")");
 
         }
 
+        // スレッドのIDキャッシュから取る（空のときだけロックしてブロック単位で補充）
+        // SetJobSystem() していない World をワーカーで組み立てる場合(SceneManager::Preload など)はキャッシュを使わない
+        const size_t slot = currentThreadSlot();
+        const uint32_t id = slot < idShards_.size() ? takeShardId(idShards_[slot]) : takeUnshardedId();
+        if (generations_.size() <= id) generations_.resize(static_cast<size_t>(id) + 1, 1);
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "エンティティ作成 (ID: {})", id);
+        setAliveBit(id, true); // 生存ビットへコミット
+
+        // メトリクス更新
+        totalCreated_++;
+        if (trackFrameAccounting_) { createdThisFrame_++; }
+        if (aliveCount_ > maxAlive_) maxAlive_ = aliveCount_;
+
+        return Entity{ id, generations_[id] };
+    }
+
+    /**
+     * @brief エンティティをまとめて作成
+     * @param[in] count 作成数
+     * @param[out] out 作成したエンティティの追加先(末尾に追加)
+     * @param[in] cause 事象の原因
+     *
+     * @details
+     * ロックとテーブルの拡張を1回にまとめます。個別のログは出力しません。
+     */
+    void CreateBatch(size_t count, std::vector<Entity>& out, Cause cause = Cause::Unknown) {
+        if (count == 0) return;
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中にエンティティ一括作成を試行 (CommandBufferを使用してください)");
+            throw std::runtime_error("CreateBatch during ParallelForEach");
+        }
+        WORLD_WRITE_ACCESS("CreateBatch");
+
         std::lock_guard<std::mutex> lock(entityMutex_);
-        uint32_t id;
-        if (!freeIdsReady_.empty()) {
-            // 再利用可能なIDがあればそれを使う
-            id = freeIdsReady_.back();
+
+        // 再利用IDを先に使い、足りない分を新規IDで確保（Entity::MAX_INDEX を超える場合は何も作らない）
+        size_t reused = (std::min)(count, freeIdsReady_.size());
+        if (count - reused > static_cast<size_t>(Entity::MAX_INDEX - nextId_)) {
+            DEBUGLOG_ERROR("エンティティIDの上限に達しました (ENTITY_INDEX_BITS=" + std::to_string(Entity::INDEX_BITS) + ")");
+            throw std::runtime_error("Entity index space exhausted");
+        }
+        out.reserve(out.size() + count);
+        for (size_t i = 0; i < reused; ++i) {
+            uint32_t id = freeIdsReady_.back();
             freeIdsReady_.pop_back();
-            DEBUGLOG("エンティティ作成 (再利用ID: " + std::to_string(id) + ")");
+            setAliveBit(id, true);
+            out.push_back(Entity{ id, generations_[id] });
         }
-        else {
-            // なければ新規ID
-            id = ++nextId_;
-            generations_.resize(std::max<size_t>(generations_.size(), id + 1), 1);
-            DEBUGLOG("エンティティ作成 (新規ID: " + std::to_string(id) + ")");
+
+        size_t fresh = count - reused;
+        if (fresh > 0) {
+            generations_.resize((std::max)(generations_.size(), static_cast<size_t>(nextId_) + fresh + 1), 1);
+            for (size_t i = 0; i < fresh; ++i) {
+                uint32_t id = ++nextId_;
+                setAliveBit(id, true);
+                out.push_back(Entity{ id, generations_[id] });
+            }
         }
-        alive_.insert(id); // live setへコミット
 
         // メトリクス更新
-        totalCreated_++;
-        if (trackFrameAccounting_) { createdThisFrame_++; }
-        if (alive_.size() > maxAlive_) maxAlive_ = alive_.size();
+        totalCreated_ += count;
+        if (trackFrameAccounting_) { createdThisFrame_ += static_cast<uint32_t>(count); }
+        if (aliveCount_ > maxAlive_) maxAlive_ = aliveCount_;
 
-        return Entity{ id, generations_[id] };
+        DEBUGLOG("エンティティ一括作成: " + std::to_string(count) + " 個 (再利用ID: " + std::to_string(reused) + ", 原因=" + CauseToString(cause) + ")");
+    }
+
+    /**
+     * @brief エンティティIDを予約(並列区間中のワーカーからも呼べる)
+     * @return Entity 予約したハンドル(CommandBuffer::CreateReserved() で反映されるまで IsAlive() は false)
+     *
+     * @details
+     * スレッドごとのIDキャッシュ(メインスレッドとワーカーごと)から取り出すため、通常はロックを取りません。
+     * キャッシュが空のときだけ entityMutex_ を取り、空きID(なければ新規ID)を ID_BLOCK_SIZE 個まとめて補充します。
+     * 並列のスポーンはブロックの補充でだけ競合するので、スレッド数に対してほぼ線形に伸びます。
+     *
+     * 予約したIDは同じフレームのうちに CommandBuffer::CreateReserved() へ渡してください。
+     * 渡さなかったIDは空きに戻らず、LoadSnapshot() で空きIDを作り直すまで使われません。
+     *
+     * @par 使用例
+     * @code
+     * world.ParallelForEach<Spawner>([&](Entity, Spawner& s) {
+     *     CommandBuffer& cmd = world.GetCommandBuffer();
+     *     Entity bullet = cmd.CreateReserved(world.ReserveEntity(), World::Cause::Spawner);
+     *     cmd.Add<Bullet>(bullet);
+     * });
+     * @endcode
+     *
+     * @throws std::runtime_error 設定されていないジョブシステムのワーカーから呼ばれた場合、IDの上限に達した場合
+     */
+    Entity ReserveEntity() {
+        const size_t slot = currentThreadSlot();
+        if (slot >= idShards_.size()) {
+            DEBUGLOG_ERROR("ReserveEntity() - ワーカー " + std::to_string(JobSystem::CurrentWorkerIndex()) + " 用のIDキャッシュがありません (SetJobSystemを確認してください)");
+            throw std::runtime_error("No entity id cache for this thread");
+        }
+        const uint32_t id = takeShardId(idShards_[slot]);
+        // 新規IDの世代表は反映時(同期点)に広げる。並列区間中は表の大きさを変えない
+        return Entity{ id, id < generations_.size() ? generations_[id] : 1u };
+    }
+
+    /**
+     * @brief プレハブからエンティティをまとめて生成
+     * @param[in] prefab 雛形
+     * @param[in] count 生成数
+     * @param[in] cause 事象の原因(Behaviourの登録にも記録されます)
+     * @return std::vector<Entity> 生成したエンティティ
+     *
+     * @details
+     * IDをまとめて確保した後、コンポーネント型ごとにスロットを事前確保して連続で構築します。
+     * クエリへの反映はエンティティごとに1回だけ行います。
+     */
+    std::vector<Entity> Instantiate(const Prefab& prefab, size_t count = 1, Cause cause = Cause::Unknown) {
+        std::vector<Entity> entities;
+        CreateBatch(count, entities, cause);
+        if (entities.empty()) return entities;
+
+        for (auto& entry : prefab.entries_) {
+            entry->Instantiate(*this, entities.data(), entities.size(), cause);
+        }
+
+        // シグネチャはまとめて立てたので、クエリへの通知はここで1回だけ
+        for (Entity e : entities) {
+            notifyQueries(e.id);
+        }
+        return entities;
+    }
+
+    /**
+     * @brief キー型 Key のエンティティプールを取得(初回は作成)
+     * @return EntityPool& プール(World が所有し、World と同じ寿命)
+     *
+     * @details
+     * プールの Spawn() で有効にしたエンティティは、DestroyEntityWithCause() で破棄されると
+     * FlushDestroyEndOfFrame() でコンポーネントを残したまま休止状態になり、次の Spawn() で再利用されます。
+     * シーンをまたいで同じキーを使うと、休止中のエンティティも引き継がれます。
+     *
+     * @see EntityPool
+     */
+    template<class Key>
+    EntityPool& Pool() {
+        const void* key = PoolTypeKey<Key>();
+        for (auto& pool : pools_) {
+            if (pool.first == key) return *pool.second;
+        }
+        pools_.emplace_back(key, std::unique_ptr<EntityPool>(new EntityPool(*this)));
+        return *pools_.back().second;
     }
 
+    /**
+     * @brief 非同期タスクのスケジューラ(World が所有し、Tick() ごとに待ちが明けたタスクを再開)
+     *
+     * @details
+     * タスクは Behaviour の OnUpdate の後・システムの前にメインスレッドで再開します。
+     * 時刻の待ちは Tick() の dt を積算したワールド時間で数えます。
+     *
+     * @see TaskScheduler
+     */
+    TaskScheduler& Tasks() { return tasks_; }
+    const TaskScheduler& Tasks() const { return tasks_; }
+
+    /**
+     * @brief 遅延コールバックのタイマーホイール(World が所有し、Tick() ごとに dt だけ進む)
+     *
+     * @details
+     * 満了したコールバックは Behaviour の OnUpdate の後・非同期タスクの前にメインスレッドで呼ばれます。
+     *
+     * @see TimerWheel
+     */
+    TimerWheel& Timers() { return timerWheel_; }
+    const TimerWheel& Timers() const { return timerWheel_; }
+
     /**
      * @brief 並列環境向け: エンティティ生成をキューし、フラッシュ時に生成（メインスレッド）
      * @param cause 起因タグ
@@ -309,7 +650,7 @@ public:
         }
         std::lock_guard<std::mutex> lock(spawnMutex_);
         pendingSpawn_.push_back({ cause, onCreated });
-        DEBUGLOG(std::string("スポーンをキューに追加 (原因=") + CauseToString(cause) + ")");
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "スポーンをキューに追加 (原因={})", CauseToString(cause));
     }
 
     /**
@@ -342,10 +683,8 @@ public:
      * @return true 生存している, false 破棄済み
      */
     bool IsAlive(Entity e) const {
-        // IDが生存かつ世代一致
-        if (alive_.count(e.id) == 0) return false;
-        if (e.id >= generations_.size()) return false;
-        return generations_[e.id] == e.gen;
+        // 世代一致かつ生存ビットが立っている（ハッシュ検索なし）
+        return isCurrentHandle(e) && testAliveBit(e.id);
     }
 
     /**
@@ -377,7 +716,152 @@ public:
             std::lock_guard<std::mutex> lock(pendingMutex_);
             pendingDestroy_.push_back({ e.id, cause });
         }
-        DEBUGLOG(std::string("破棄をキューに追加 (ID: ") + std::to_string(e.id) + ", 原因=" + CauseToString(cause) + ")");
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "破棄をキューに追加 (ID: {}, 原因={})", e.id, CauseToString(cause));
+    }
+
+    /**
+     * @brief seconds 秒後にエンティティを破棄 (原因付き)
+     * @return TimerHandle Timers().Cancel() で取り消せるハンドル
+     *
+     * @details
+     * 毎フレーム残り時間を減らす Behaviour の代わりに、タイマーホイールの満了で破棄を予約します。
+     * 待っている間のコストはなく、破棄は満了したフレームの FlushDestroyEndOfFrame() でまとめて行われます。
+     * 満了までに別の理由で破棄された場合は何もしません。
+     */
+    TimerHandle DestroyEntityAfter(Entity e, float seconds, Cause cause = Cause::LifetimeExpired) {
+        if (!IsAlive(e)) {
+            DEBUGLOG_WARNING("既に死亡/無効なエンティティの遅延破棄を試行 (ID: " + std::to_string(e.id) + ")");
+            return TimerHandle{};
+        }
+        return timerWheel_.ScheduleDestroy(e, seconds, cause);
+    }
+
+    /**
+     * @brief エンティティと子孫をすべて破棄 (原因付き)
+     *
+     * @details
+     * 親子関係を先頭の子・次の兄弟のリンクでたどるため、走査は子孫の数だけです。破棄はほかと同じく EoF で行います。
+     */
+    void DestroyRecursive(Entity root, Cause cause = Cause::Unknown) {
+        if (!IsAlive(root)) {
+            DEBUGLOG_WARNING("既に死亡/無効なエンティティの再帰破棄を試行 (ID: " + std::to_string(root.id) + ")");
+            return;
+        }
+        DestroyEntityWithCause(root, cause);
+        // 深さ優先(子へ降り、兄弟へ進み、なければ root まで戻りながら親の兄弟へ)
+        uint32_t id = hierarchyOf(root.id).firstChild;
+        while (id != 0) {
+            DestroyEntityWithCause(Entity{ id, generations_[id] }, cause);
+            const HierarchyLink* link = &hierarchy_[id];
+            if (link->firstChild != 0) {
+                id = link->firstChild;
+                continue;
+            }
+            while (id != root.id && hierarchy_[id].nextSibling == 0) {
+                id = hierarchy_[id].parent;
+            }
+            id = id == root.id ? 0 : hierarchy_[id].nextSibling;
+        }
+    }
+
+    /**
+     * @brief 親子関係を設定(既存の親からは外し、新しい親の最後の子にする)
+     * @return bool 設定できた場合 true(無効なエンティティや循環になる場合 false)
+     *
+     * @details
+     * 親子関係は EntityID で引く表に先頭の子・最後の子・前後の兄弟として持ちます(コンポーネントではない)。
+     * 親を破棄すると子はルートに戻り、子を破棄すると親の一覧から外れます。
+     * MergeFrom()・Serialize()/Deserialize() は親子関係を引き継ぎ、TransferEntities() は同じ呼び出しで移すエンティティどうしの関係だけを引き継ぎます。
+     * 変換の親子関係(Transform の継承)は TransformSystem::SetParent() で設定してください(Parent も追加します)。
+     */
+    bool SetParent(Entity child, Entity parent) {
+        if (!IsAlive(child) || !IsAlive(parent) || child == parent) return false;
+        for (uint32_t ancestor = parent.id; ancestor != 0; ancestor = hierarchyOf(ancestor).parent) {
+            if (ancestor == child.id) return false; // parent の祖先に child がいれば循環になる
+        }
+        const size_t needed = static_cast<size_t>((std::max)(child.id, parent.id)) + 1;
+        if (hierarchy_.size() < needed) hierarchy_.resize(needed);
+
+        unlinkFromParent(child.id);
+        HierarchyLink& link = hierarchy_[child.id];
+        HierarchyLink& owner = hierarchy_[parent.id];
+        link.parent = parent.id;
+        link.prevSibling = owner.lastChild;
+        link.nextSibling = 0;
+        if (owner.lastChild != 0) {
+            hierarchy_[owner.lastChild].nextSibling = child.id;
+        } else {
+            owner.firstChild = child.id;
+        }
+        owner.lastChild = child.id;
+        ++owner.childCount;
+        return true;
+    }
+
+    /**
+     * @brief 親子関係を解除(子はルートになる)
+     */
+    void ClearParent(Entity child) {
+        if (isCurrentHandle(child)) unlinkFromParent(child.id);
+    }
+
+    /**
+     * @brief 親(なければ Entity{})
+     */
+    Entity GetParent(Entity e) const {
+        if (!isCurrentHandle(e)) return Entity{};
+        const uint32_t parent = hierarchyOf(e.id).parent;
+        return parent != 0 ? Entity{ parent, generations_[parent] } : Entity{};
+    }
+
+    /**
+     * @brief 子の数
+     */
+    uint32_t ChildCount(Entity e) const {
+        return isCurrentHandle(e) ? hierarchyOf(e.id).childCount : 0;
+    }
+
+    /**
+     * @brief 子を追加した順に fn(Entity) を呼ぶ(子の数だけの走査)
+     *
+     * @details
+     * 呼び出す前に次の兄弟を読むため、fn の中で現在の子を ClearParent() してもかまいません。
+     */
+    template<class Fn>
+    void ForEachChild(Entity parent, Fn&& fn) const {
+        if (!isCurrentHandle(parent)) return;
+        uint32_t id = hierarchyOf(parent.id).firstChild;
+        while (id != 0) {
+            const uint32_t next = hierarchy_[id].nextSibling;
+            fn(Entity{ id, generations_[id] });
+            id = next;
+        }
+    }
+
+    /**
+     * @brief source の親子関係を、対応するこの World のエンティティへ写す
+     * @param[in] source 写し元
+     * @param[in] from 写し元のエンティティ
+     * @param[in] to from と同じ順の、この World のエンティティ
+     * @param[in] count 数
+     * @return size_t 設定した親子関係の数
+     *
+     * @details
+     * 親と子の両方が from に含まれる関係だけを写し、子の順は写し元と同じにします。
+     * 既に親のある子は付け替えます(SceneStream は全バッチを移した後に呼び直して、バッチをまたぐ関係を写します)。
+     */
+    size_t CopyHierarchy(const World& source, const Entity* from, const Entity* to, size_t count) {
+        std::vector<Entity> mapped(source.hierarchy_.size());
+        for (size_t i = 0; i < count; ++i) {
+            if (from[i].id < mapped.size()) mapped[from[i].id] = to[i];
+        }
+        size_t linked = 0;
+        for (size_t i = 0; i < count; ++i) {
+            source.ForEachChild(from[i], [&](Entity child) {
+                if (mapped[child.id].id != 0 && SetParent(mapped[child.id], to[i])) ++linked;
+            });
+        }
+        return linked;
     }
 
     /**
@@ -404,6 +888,11 @@ public:
      */
     template<class T, class...Args>
     T& AddWithCause(Entity e, Cause cause, Args&&...args) {
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中にコンポーネント " + std::string(typeid(T).name()) + " の追加を試行");
+            throw std::runtime_error("Add during ParallelForEach");
+        }
+        WORLD_WRITE_ACCESS("Add");
         if (!IsAlive(e)) {
             char msg[160];
             sprintf_s(msg, "死亡/無効なエンティティにコンポーネント追加を試行 (ID: %u, gen: %u)", e.id, e.gen);
@@ -415,7 +904,7 @@ public:
 
 #ifdef _DEBUG
         // デバッグモードでは重複チェック
-        if (s.map.find(e.id) != s.map.end()) {
+        if (s.data.Contains(e.id)) {
             char msg[160];
             sprintf_s(msg, "コンポーネント %s は既にエンティティに存在します (ID: %u, gen: %u)", typeid(T).name(), e.id, e.gen);
             DEBUGLOG_ERROR(std::string(msg));
@@ -423,12 +912,13 @@ public:
         }
 #endif
 
-        auto obj = std::make_unique<T>(std::forward<Args>(args)...);
-        T& ref = *obj;
-        s.map[e.id] = std::move(obj);
+        // チャンク内のスロットへ直接構築（個別のヒープ確保なし）
+        T& ref = s.data.Emplace(e.id, std::forward<Args>(args)...);
+        s.data.StampAdded(e.id, changeTick_);
+        setSignatureBit(e.id, ComponentId<T>(), true);
         registerBehaviourWithCause<T>(e, &ref, cause);
 
-        DEBUGLOG("コンポーネント " + std::string(typeid(T).name()) + " をエンティティ " + std::to_string(e.id) + " に追加");
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "コンポーネント {} をエンティティ {} に追加", typeid(T).name(), e.id);
 
         return ref;
     }
@@ -442,57 +932,165 @@ public:
      */
     template<class T>
     bool Remove(Entity e) {
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中にコンポーネント " + std::string(typeid(T).name()) + " の削除を試行");
+            return false;
+        }
+        WORLD_WRITE_ACCESS("Remove");
         if (!IsAlive(e)) {
             DEBUGLOG_WARNING("死亡/無効なエンティティからコンポーネント削除を試行 (ID: " + std::to_string(e.id) + ")");
             return false;
         }
 
-        auto itS = stores_.find(std::type_index(typeid(T)));
-        if (itS == stores_.end()) return false;
+        auto* s = findStore<T>();
+        if (!s) return false;
 
-        auto* s = static_cast<Store<T>*>(itS->second);
-        auto it = s->map.find(e.id);
-        if (it == s->map.end()) return false;
+        T* comp = s->data.Find(e.id);
+        if (!comp) return false;
 
         // Behaviourの場合は登録解除
-        unregisterBehaviour<T>(e, it->second.get());
+        unregisterBehaviour<T>(e, comp);
 
         // コンポーネントを削除
-        s->map.erase(it);
+        s->data.Erase(e.id);
+        setSignatureBit(e.id, ComponentId<T>(), false);
 
-        DEBUGLOG("コンポーネント " + std::string(typeid(T).name()) + " をエンティティ " + std::to_string(e.id) + " から削除");
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "コンポーネント {} をエンティティ {} から削除", typeid(T).name(), e.id);
 
         return true;
     }
 
     template<class T>
     bool Has(Entity e) const {
-        auto itS = stores_.find(std::type_index(typeid(T)));
-        if (itS == stores_.end()) return false;
-        auto* s = static_cast<const Store<T>*>(itS->second);
-        return s->map.find(e.id) != s->map.end();
+        if (!isCurrentHandle(e)) return false;
+        auto* s = findStore<T>();
+        return s && s->data.Contains(e.id);
+    }
+
+    /**
+     * @brief コンポーネントの有効・無効を切り替える（構造変更なし）
+     *
+     * @tparam T 対象のコンポーネント型
+     * @param[in] e 対象エンティティ
+     * @param[in] enabled 有効にする場合 true
+     * @return bool 切り替えた場合 true（既に同じ状態の場合も true）
+     *
+     * @details
+     * 無効なコンポーネントはデータもスロットも残したまま、次の対象から外れます。
+     * - ForEach / Query（必須の型として。Without<T> には存在するものとして数える）
+     * - Behaviour の OnUpdate（OnStart 済みかどうかは保持し、再度有効にしても OnStart は呼ばない）
+     *
+     * Has / TryGet / Get では引き続き取得できます。Remove<T>() + Add<T>() と違い、
+     * スロットの確保・解放や Behaviour グループの並べ替えは発生しません。
+     * 削除・破棄・プールへの返却で無効状態は解除されます。
+     *
+     * @par 使用例
+     * @code
+     * world.SetEnabled<EnemyAI>(e, false);       // AIを停止（OnUpdate が呼ばれなくなる）
+     * world.SetEnabled<MeshRenderer>(e, false);  // 描画から外す
+     * @endcode
+     */
+    template<class T>
+    bool SetEnabled(Entity e, bool enabled) {
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中にコンポーネント " + std::string(typeid(T).name()) + " の有効状態の変更を試行");
+            return false;
+        }
+        WORLD_WRITE_ACCESS("SetEnabled");
+        if (!IsAlive(e) || !Has<T>(e)) {
+            DEBUGLOG_WARNING("所持していないコンポーネントの有効状態の変更を試行 (ID: " + std::to_string(e.id) + ")");
+            return false;
+        }
+
+        const ComponentTypeId typeId = ComponentId<T>();
+        if (typeId >= MAX_COMPONENT_TYPES) {
+            // マスク上限を超えた型はシグネチャに載らないため切り替えられない
+            DEBUGLOG_WARNING("コンポーネント " + std::string(typeid(T).name()) + " はマスク上限を超えているため無効化できません");
+            return false;
+        }
+
+        if (e.id >= disabled_.size()) disabled_.resize(e.id + 1);
+        if (disabled_[e.id].test(typeId) == !enabled) return true;
+        disabled_[e.id].set(typeId, !enabled);
+
+        if (typeId < behaviourGroupByType_.size() && behaviourGroupByType_[typeId]) {
+            behaviourGroupByType_[typeId]->SetEnabled(e.id, enabled);
+        }
+        notifyQueries(e.id);
+
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "コンポーネント {} をエンティティ {} で{}", typeid(T).name(), e.id, enabled ? "有効化" : "無効化");
+        return true;
+    }
+
+    /**
+     * @brief コンポーネントを所持していて、無効化されていないか
+     */
+    template<class T>
+    bool IsEnabled(Entity e) const {
+        if (!Has<T>(e)) return false;
+        return !isDisabled(e.id, ComponentId<T>());
     }
 
+    /**
+     * @brief コンポーネントを取得（変更ティックを記録）
+     *
+     * @details
+     * 書き込み目的のアクセスとみなし、Changed<T> フィルタの対象になります。
+     * 読み取りだけの場合は Peek() または const の World から取得してください
+     * (Read の段階で複数のスレッドから読むのも Peek() です)。
+     */
     template<class T>
     T* TryGet(Entity e) {
-        if (!IsAlive(e)) return nullptr;
-        auto itS = stores_.find(std::type_index(typeid(T)));
-        if (itS == stores_.end()) return nullptr;
-        auto* s = static_cast<Store<T>*>(itS->second);
-        auto it = s->map.find(e.id);
-        if (it == s->map.end()) return nullptr;
-        return it->second.get();
+        // コンポーネントは破棄時に必ず削除されるため、世代一致の確認だけで十分
+        if (!isCurrentHandle(e)) return nullptr;
+        auto* s = findStore<T>();
+        if (!s) return nullptr;
+        T* comp = s->data.Find(e.id);
+        if (comp) s->data.StampChanged(e.id, changeTick_);
+        return comp;
+    }
+
+    /**
+     * @brief 変更ティックを記録せずに読み取り専用で取得
+     */
+    template<class T>
+    const T* Peek(Entity e) const {
+        return TryGet<T>(e);
+    }
+
+    /**
+     * @brief コンポーネントを変更済みとして記録
+     *
+     * @details
+     * ForEach/Query で受け取った参照を書き換えた場合など、TryGet を経由しない変更に使用します。
+     */
+    template<class T>
+    void MarkChanged(Entity e) {
+        if (!isCurrentHandle(e)) return;
+        auto* s = findStore<T>();
+        if (s) s->data.StampChanged(e.id, changeTick_);
     }
 
+    /**
+     * @brief 現在の変更ティック
+     */
+    uint32_t GetChangeTick() const { return changeTick_; }
+
+    /**
+     * @brief 現在の変更ティックを返し、以降の変更を次のティックで記録する
+     * @return uint32_t 進める前のティック（次回の Changed/Added フィルタの since に使う）
+     *
+     * @details
+     * 戻り値以前の変更はすべて「ティック <= 戻り値」、以降の変更は「ティック > 戻り値」になるため、
+     * 前回の戻り値を since に渡すと取りこぼしなく差分を処理できます。
+     */
+    uint32_t AdvanceChangeTick() { return changeTick_++; }
+
     template<class T>
     const T* TryGet(Entity e) const {
-        if (!IsAlive(e)) return nullptr;
-        auto itS = stores_.find(std::type_index(typeid(T)));
-        if (itS == stores_.end()) return nullptr;
-        auto* s = static_cast<const Store<T>*>(itS->second);
-        auto it = s->map.find(e.id);
-        if (it == s->map.end()) return nullptr;
-        return it->second.get();
+        if (!isCurrentHandle(e)) return nullptr;
+        auto* s = findStore<T>();
+        return s ? s->data.Find(e.id) : nullptr;
     }
 
     template<class T>
@@ -519,60 +1117,626 @@ public:
 
     template<class T, class F>
     void ForEach(F&& fn) {
-        auto itS = stores_.find(std::type_index(typeid(T)));
-        if (itS == stores_.end()) return;
-        auto* s = static_cast<Store<T>*>(itS->second);
-
-        // イテレーション中の削除に対応するため、IDのコピーを作成
-        std::vector<uint32_t> ids;
-        ids.reserve(s->map.size());
-        for (const auto& pair : s->map) {
-            ids.push_back(pair.first);
-        }
-
-        for (uint32_t id : ids) {
-            if (alive_.count(id) == 0) continue; // 処理中にエンティティが削除されたか確認
-
-            auto it = s->map.find(id);
-            if (it != s->map.end()) {
-                fn(Entity{ id, generations_[id] }, *it->second);
-            }
-        }
+        auto* s = findStore<T>();
+        if (!s) return;
+
+        // チャンクを先頭から連続走査（スロットは移動しないため、処理中の削除も安全）
+        // プールで休止中のエンティティはコンポーネントを残しているため生存ビットで除外する
+        // 無効化されたコンポーネントも除外する
+        const ComponentTypeId typeId = ComponentId<T>();
+        s->data.ForEach([this, typeId, &fn](uint32_t id, T& comp) {
+            if (!testAliveBit(id) || isDisabled(id, typeId)) return;
+            fn(Entity{ id, generations_[id] }, comp);
+        });
     }
 
     template<class T1, class T2, class F>
     void ForEach(F&& fn) {
-        auto itS1 = stores_.find(std::type_index(typeid(T1)));
-        if (itS1 == stores_.end()) return;
-        auto* s1 = static_cast<Store<T1>*>(itS1->second);
-
-        // イテレーション中の削除に対応するため、IDのコピーを作成
-        std::vector<uint32_t> ids;
-        ids.reserve(s1->map.size());
-        for (const auto& pair : s1->map) {
-            ids.push_back(pair.first);
+        auto* s1 = findStore<T1>();
+        auto* s2 = findStore<T2>();
+        if (!s1 || !s2) return;
+
+        // 要素数の少ない側のチャンクを走査し、もう一方は検索で補う
+        const ComponentTypeId typeId1 = ComponentId<T1>();
+        const ComponentTypeId typeId2 = ComponentId<T2>();
+        if (s2->data.Size() < s1->data.Size()) {
+            s2->data.ForEach([this, s1, typeId1, typeId2, &fn](uint32_t id, T2& comp2) {
+                if (!testAliveBit(id) || isDisabled(id, typeId1) || isDisabled(id, typeId2)) return;
+                T1* comp1 = s1->data.Find(id);
+                if (comp1) {
+                    fn(Entity{ id, generations_[id] }, *comp1, comp2);
+                }
+            });
+            return;
+        }
+
+        s1->data.ForEach([this, s2, typeId1, typeId2, &fn](uint32_t id, T1& comp1) {
+            if (!testAliveBit(id) || isDisabled(id, typeId1) || isDisabled(id, typeId2)) return;
+            T2* comp2 = s2->data.Find(id);
+            if (comp2) {
+                fn(Entity{ id, generations_[id] }, comp1, *comp2);
+            }
+        });
+    }
+
+    /**
+     * @brief キャッシュ付きクエリを取得
+     *
+     * @tparam Ts 必須コンポーネントの型(1つ以上)
+     * @return QueryView<Ts...>& Worldが所有するクエリ(World破棄まで有効)
+     *
+     * @details
+     * 初回呼び出し時に一致集合を構築し、以後はAdd/Remove/破棄のたびに差分更新されます。
+     * 毎フレーム同じクエリを走査する場合は、戻り値の参照を保持して使い回してください。
+     *
+     * @par 使用例
+     * @code
+     * auto& renderables = world.Query<Transform, MeshRenderer>();
+     * renderables.ForEach([](Entity e, Transform& t, MeshRenderer& mr) {
+     *     // ...
+     * });
+     *
+     * // 除外条件付き
+     * auto& enemies = world.Query<Transform, EnemyMovement>(Without<PlayerTag>());
+     *
+     * // タグで絞り込み（タグは ForEach に渡さない）
+     * auto& targets = world.Query<Transform>(With<EnemyTag>());
+     * @endcode
+     */
+    template<class... Ts>
+    QueryView<Ts...>& Query() {
+        return Query<Ts...>(With<>(), Without<>());
+    }
+
+    template<class... Ts, class... Ex>
+    QueryView<Ts...>& Query(Without<Ex...> without) {
+        return Query<Ts...>(With<>(), without);
+    }
+
+    template<class... Ts, class... In>
+    QueryView<Ts...>& Query(With<In...> with) {
+        return Query<Ts...>(with, Without<>());
+    }
+
+    template<class... Ts, class... In, class... Ex>
+    QueryView<Ts...>& Query(With<In...>, Without<Ex...>) {
+        static_assert(sizeof...(Ts) > 0, "Query requires at least one component type");
+
+        const void* key = QueryTypeKey<std::tuple<QueryView<Ts...>, With<In...>, Without<Ex...>>>();
+        for (auto& q : queries_) {
+            if (q->TypeKey() == key) {
+                return *static_cast<QueryView<Ts...>*>(q.get());
+            }
         }
 
-        for (uint32_t id : ids) {
-            if (alive_.count(id) == 0) continue; // 処理中にエンティティが削除されたか確認
+        if (parallelDepth_ > 0) {
+            // 並列区間中はクエリ一覧を変更できない（ISystem::OnCreate で事前に取得すること）
+            DEBUGLOG_ERROR("並列区間中に新しいクエリの作成を試行");
+            throw std::runtime_error("Query creation during parallel region");
+        }
+        WORLD_WRITE_ACCESS("Query");
 
-            auto it1 = s1->map.find(id);
-            if (it1 == s1->map.end()) continue;
+        ComponentMask include = MakeComponentMask<Ts..., In...>();
+        ComponentMask exclude = MakeComponentMask<Ex...>();
+        auto* query = new QueryView<Ts...>(include, exclude, key, &generations_, &getStore<Ts>().data...);
+        queries_.push_back(std::unique_ptr<QueryBase>(query));
 
-            T2* comp2 = TryGet<T2>(Entity{ id, generations_[id] });
-            if (comp2) {
-                fn(Entity{ id, generations_[id] }, *it1->second, *comp2);
+        // 既存エンティティから一致集合を構築（破棄済みIDのシグネチャは空）
+        for (uint32_t id = 0; id < signatures_.size(); ++id) {
+            query->OnSignatureChanged(id, signatures_[id], disabledMask(id));
+        }
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::ECS, "クエリを作成 (一致数: " + std::to_string(query->Size()) +
+                          ", 総クエリ数: " + std::to_string(queries_.size()) + ")");
+        return *query;
+    }
+
+    /**
+     * @brief クエリに一致するエンティティを並列に走査
+     *
+     * @tparam Ts 必須コンポーネントの型(1つ以上)
+     * @param[in] fn void(Entity, Ts&...) 形式の関数(複数スレッドから同時に呼ばれます)
+     * @param[in] grainSize 1ジョブあたりのエンティティ数
+     *
+     * @details
+     * Query<Ts...>() の一致集合を grainSize 単位に分割し、SetJobSystem() で設定した
+     * ジョブシステムのワーカーに振り分けます。ジョブシステム未設定、または一致数が
+     * grainSize 以下の場合は呼び出しスレッドで順に走査します。
+     *
+     * 走査中は構造変更(Add/Remove/CreateEntity)を禁止します。エンティティの破棄と生成は
+     * DestroyEntity() / EnqueueSpawn() で予約してください(EoFで処理されます)。
+     *
+     * @par 使用例
+     * @code
+     * world.ParallelForEach<Transform, Velocity>([dt](Entity, Transform& t, Velocity& v) {
+     *     t.position.x += v.velocity.x * dt;
+     * });
+     * @endcode
+     *
+     * @note fn 内で他エンティティのコンポーネントへ書き込まないでください(データ競合になります)
+     */
+    template<class... Ts, class F>
+    void ParallelForEach(F&& fn, size_t grainSize = 256) {
+        auto& query = Query<Ts...>();
+        if (query.Empty()) return;
+
+        // 走査全体を1つの区間とし、範囲内の位置を固定する
+        QueryBase::IterationScope scope(query);
+        const size_t count = query.DenseCount();
+
+        if (!jobSystem_ || !jobSystem_->IsRunning() || parallelDepth_ > 0 || count <= grainSize) {
+            query.ForEachInRange(0, count, fn);
+            return;
+        }
+
+        ReadPhaseScope readPhase(*this);
+        jobSystem_->ParallelFor(count, grainSize, [&query, &fn](size_t begin, size_t end) {
+            query.ForEachInRange(begin, end, fn);
+        });
+    }
+
+    /**
+     * @brief システムを登録
+     *
+     * @tparam T System<Read<...>, Write<...>> の派生クラス
+     * @param[in] args コンストラクタ引数
+     * @return T& 登録したシステム(World破棄まで有効)
+     *
+     * @details
+     * 登録直後に ISystem::OnCreate() を呼びます。登録したシステムは Tick() の
+     * Behaviour 更新の後に、宣言したアクセスが競合しないもの同士で並列実行されます。
+     */
+    template<class T, class... Args>
+    T& AddSystem(Args&&... args) {
+        static_assert(std::is_base_of<ISystem, T>::value, "T must derive from ISystem");
+        T* system = new T(std::forward<Args>(args)...);
+        scheduler_.Add(std::unique_ptr<ISystem>(system));
+        system->OnCreate(*this);
+        DEBUGLOG_CATEGORY(DebugLog::Category::ECS, std::string("システムを登録: ") + system->GetName());
+        return *system;
+    }
+
+    SystemScheduler& GetScheduler() { return scheduler_; }
+
+    /**
+     * @brief ParallelForEach() で使用するジョブシステムを設定
+     * @param[in] jobs ジョブシステム(nullptrで並列化を無効化)
+     */
+    void SetJobSystem(JobSystem* jobs) {
+        jobSystem_ = jobs;
+        // ワーカーごとのコマンドバッファを事前に用意（取得時にロックを取らないため）
+        size_t slots = 1 + (jobs ? jobs->WorkerCount() : 0);
+        while (commandBuffers_.size() < slots) {
+            commandBuffers_.push_back(std::unique_ptr<CommandBuffer>(new CommandBuffer()));
+        }
+        if (idShards_.size() < slots) idShards_.resize(slots);
+        for (auto& channel : eventChannels_) {
+            channel->SetThreadCount(slots);
+        }
+    }
+
+    JobSystem* GetJobSystem() const { return jobSystem_; }
+
+    /**
+     * @brief 現在のスレッド用のコマンドバッファを取得
+     * @return CommandBuffer& スレッド専用バッファ(ロックなしで記録可能)
+     *
+     * @details
+     * メインスレッドと、SetJobSystem() で設定したジョブシステムのワーカーから呼び出せます。
+     * 記録した操作は Tick() の開始時と終了時に PlaybackCommandBuffers() で反映されます。
+     *
+     * @throws std::runtime_error 設定されていないジョブシステムのワーカーから呼ばれた場合
+     */
+    CommandBuffer& GetCommandBuffer() {
+        size_t slot = currentThreadSlot();
+        if (slot >= commandBuffers_.size()) {
+            DEBUGLOG_ERROR("GetCommandBuffer() - ワーカー " + std::to_string(JobSystem::CurrentWorkerIndex()) + " 用のバッファがありません (SetJobSystemを確認してください)");
+            throw std::runtime_error("No command buffer for this thread");
+        }
+        return *commandBuffers_[slot];
+    }
+
+    /**
+     * @brief 型 T のイベントチャネルを取得(初回は作成)
+     * @return EventChannel<T>& チャネル(World が所有し、World と同じ寿命)
+     *
+     * @details
+     * Send() したイベントは次の Tick() の開始時に Read() で読めるようになります。
+     * 作成はメインスレッドで行ってください（ISystem::OnCreate や Behaviour::OnStart で取得しておく）。
+     * EntityDestroyedEvent のチャネルを作成すると、以降の破棄が原因付きで送信されます。
+     *
+     * @throws std::runtime_error 並列区間中に新しいチャネルを作成しようとした場合
+     */
+    template<class T>
+    EventChannel<T>& Events() {
+        const void* key = EventTypeKey<T>();
+        for (auto& channel : eventChannels_) {
+            if (channel->TypeKey() == key) {
+                return *static_cast<EventChannel<T>*>(channel.get());
+            }
+        }
+
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("並列区間中に新しいイベントチャネルの作成を試行");
+            throw std::runtime_error("Event channel creation during parallel region");
+        }
+
+        auto* channel = new EventChannel<T>(commandBuffers_.size());
+        eventChannels_.push_back(std::unique_ptr<EventChannelBase>(channel));
+        if constexpr (std::is_same_v<T, EntityDestroyedEvent>) {
+            destroyedEvents_ = channel;
+        }
+        return *channel;
+    }
+
+    /**
+     * @brief スナップショットに含めるコンポーネント型を登録（トリビアルにコピーできる型か REFLECT_COMPONENT() 済みの型）
+     * @tparam T コンポーネント型
+     * @param[in] name 型の名前（スナップショット内で型を対応付ける。保存と読み込みで同じ名前を使う）
+     *
+     * @details
+     * トリビアルにコピーできる型は、チャンクの連続した範囲をまとめて複写し、読み込み時も構築関数を通さずに書き戻します。
+     * 型の大きさが保存時と異なるセクションは読み込まずに警告します。
+     * Entity を含む型(Parent など)は、読み込み後も同じIDと世代が復元されるためそのまま有効です。
+     *
+     * IComponent の派生型など vtable を持つ型は、REFLECT_COMPONENT() で列挙したフィールドを詰めて保存し、
+     * 読み込み時は既定構築した値へ書き戻して Add と同じ経路で追加します（ComponentReflection.h）。
+     */
+    template<class T>
+    void RegisterSnapshotType(const std::string& name) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            registerSnapshotType<T>(name, std::is_empty<T>::value ? 0u : static_cast<uint32_t>(sizeof(T)), nullptr, nullptr);
+        } else {
+            static_assert(ComponentLayout<T>::FIELD_COPYABLE,
+                          "RegisterSnapshotType<T>(name) requires a trivially copyable type or REFLECT_COMPONENT() with trivially copyable fields; pass save/load functions otherwise");
+            static_assert(std::is_default_constructible<T>::value, "Reflected snapshot types must be default constructible");
+            registerSnapshotType<T>(name, SNAPSHOT_VARIABLE_SIZE,
+                [](const void* item, SnapshotWriter& out) {
+                    ComponentLayout<T>::WritePacked(*static_cast<const T*>(item), out.Append(ComponentLayout<T>::PACKED_SIZE));
+                },
+                [](SnapshotReader& in, void* item) {
+                    const uint8_t* src = in.Skip(ComponentLayout<T>::PACKED_SIZE);
+                    if (!src) return false;
+                    ComponentLayout<T>::ReadPacked(src, *static_cast<T*>(item));
+                    return true;
+                });
+        }
+    }
+
+    /**
+     * @brief スナップショットに含めるコンポーネント型を登録（要素ごとの保存・読み込み関数を使う）
+     * @param[in] save 1要素を書き込む関数
+     * @param[in] load 1要素を読み込む関数（既定構築した値に上書きする。失敗時 false）
+     *
+     * @details
+     * IComponent・Behaviour の派生型や、ポインタ・コンテナを含む型に使用します。
+     * 読み込んだ値は Add と同じ経路で追加するため、Behaviour は OnStart() から始まります。
+     *
+     * @par 使用例
+     * @code
+     * world.RegisterSnapshotType<Inventory>("Inventory",
+     *     [](const Inventory& v, SnapshotWriter& out) { out.WriteString(v.itemName); },
+     *     [](SnapshotReader& in, Inventory& v) { v.itemName = in.ReadString(); return !in.Failed(); });
+     * @endcode
+     */
+    template<class T>
+    void RegisterSnapshotType(const std::string& name,
+                              std::function<void(const T&, SnapshotWriter&)> save,
+                              std::function<bool(SnapshotReader&, T&)> load) {
+        static_assert(std::is_default_constructible<T>::value, "Snapshot types with save/load functions must be default constructible");
+        registerSnapshotType<T>(name, SNAPSHOT_VARIABLE_SIZE,
+            [save](const void* item, SnapshotWriter& out) { save(*static_cast<const T*>(item), out); },
+            [load](SnapshotReader& in, void* item) { return load(in, *static_cast<T*>(item)); });
+    }
+
+    /**
+     * @brief 生存エンティティと登録済みの型のコンポーネントをバイナリ形式で書き出す
+     * @param[out] out 書き出し先（内容は置き換えられます）
+     * @param[in] options 圧縮の有無など
+     * @return bool 成功した場合 true
+     *
+     * @details
+     * エンティティのIDと世代をそのまま保存するため、読み込み後も保存時のハンドルが有効です。
+     * 未登録の型・プールで休止中のエンティティ・無効化状態・キュー中の操作は保存しません。
+     * 並列区間中は呼び出せません（Tick の外で呼んでください）。
+     *
+     * @par 使用例
+     * @code
+     * world.RegisterSnapshotType<Transform>("Transform");
+     * world.RegisterSnapshotType<MeshRenderer>("MeshRenderer");
+     *
+     * std::vector<uint8_t> bytes;
+     * world.Serialize(bytes);
+     * WriteSnapshotFile("quicksave.hews", bytes);
+     *
+     * // 別の（空の）World へ読み込む
+     * World loaded;
+     * loaded.RegisterSnapshotType<Transform>("Transform");
+     * loaded.RegisterSnapshotType<MeshRenderer>("MeshRenderer");
+     * loaded.Deserialize(bytes);
+     * @endcode
+     */
+    bool Serialize(std::vector<uint8_t>& out, const SnapshotOptions& options = SnapshotOptions());
+
+    /**
+     * @brief Serialize() で書き出したデータを読み込む
+     * @return bool 成功した場合 true（形式が不正な場合は何も変更せず false）
+     *
+     * @details
+     * 生存エンティティのない World にだけ読み込めます（新しく作成した World、または全て破棄した後）。
+     * 保存時のIDと世代でエンティティを復元し、登録済みの型のコンポーネントを追加します。
+     * 読み込み前に取得していたハンドルは、保存時のハンドルと一致する場合があるため使用しないでください。
+     * 未登録の名前・大きさの異なる型のセクションは読み飛ばします。
+     */
+    bool Deserialize(const uint8_t* data, size_t size);
+    bool Deserialize(const std::vector<uint8_t>& bytes) { return Deserialize(bytes.data(), bytes.size()); }
+
+    /**
+     * @brief 直近の Serialize()/Deserialize() の結果
+     */
+    const SnapshotStats& GetLastSnapshotStats() const { return snapshotStats_; }
+
+    /**
+     * @brief other に登録されたスナップショットの型をこの World にも登録する
+     *
+     * @details
+     * 読み込み用の一時的な World を作る場合に使います(SceneStream)。
+     */
+    void CopySnapshotTypes(const World& other) {
+        snapshotTypes_ = other.snapshotTypes_;
+    }
+
+    /**
+     * @brief source のエンティティを、登録済みの型のコンポーネントごとこの World へ移す
+     * @param[in,out] source 移動元（コンポーネントはムーブされ、エンティティは残る）
+     * @param[in] entities 移動元のエンティティ
+     * @param[in] count 数
+     * @param[out] out 作成したエンティティの追加先（entities と同じ順）
+     * @param[in] cause 事象の原因
+     * @return size_t 移したコンポーネント数
+     *
+     * @details
+     * 呼び出しの中でエンティティごとに全てのコンポーネントを追加し終えるため、
+     * 途中まで組み立てたエンティティがシステムから見えることはありません。
+     * コンポーネント内の Entity は移動元のハンドルのままです(付け替えはしません)。
+     * 親子関係は entities に親と子の両方が含まれるものだけ引き継ぎます(CopyHierarchy())。
+     */
+    size_t TransferEntities(World& source, const Entity* entities, size_t count, std::vector<Entity>& out, Cause cause = Cause::Unknown) {
+        if (count == 0) return 0;
+        const size_t first = out.size();
+        CreateBatch(count, out, cause);
+        size_t components = 0;
+        for (const SnapshotType& type : snapshotTypes_) {
+            components += type.transfer(*this, source, entities, out.data() + first, count, cause);
+        }
+        CopyHierarchy(source, entities, out.data() + first, count);
+        return components;
+    }
+
+    /**
+     * @brief source の生存エンティティをすべてのコンポーネントごとこの World へ移す
+     * @param[in,out] source 移動元（移したエンティティは原因 Merged で破棄される）
+     * @param[out] created 作成したエンティティの追加先（nullptr 可、移動元のID順）
+     * @param[in] cause 事象の原因（Behaviour の登録にも記録されます）
+     * @return size_t 移したエンティティ数
+     *
+     * @details
+     * 移動元の型ごとのストアを密な順に走査し、移動先のストアへまとめてムーブします。
+     * シグネチャは型ごとにまとめて立て、クエリへの通知はエンティティごとに1回だけ行います。
+     * 無効化の状態は引き継ぎ、Behaviour は移動先で OnStart() から始まります。
+     * コンポーネント内の Entity は RegisterEntityRemap() で登録した型だけ付け替えます。
+     * SetParent() の親子関係は移動先のエンティティどうしで引き継ぎます。
+     * 移動元の休止中のプールのエンティティは移動しません。
+     *
+     * @par 使用例
+     * @code
+     * World staging;
+     * BuildLevel(staging);                 // ワーカースレッドなどで組み立てる
+     * std::vector<Entity> level;
+     * world.MergeFrom(std::move(staging), &level, World::Cause::SceneInit);
+     * @endcode
+     *
+     * @note どちらの World も Tick() の外で呼んでください
+     */
+    size_t MergeFrom(World&& source, std::vector<Entity>* created = nullptr, Cause cause = Cause::Unknown) {
+        if (&source == this) return 0;
+        if (parallelDepth_ > 0 || source.parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中に World::MergeFrom() を試行");
+            throw std::runtime_error("MergeFrom during ParallelForEach");
+        }
+        WORLD_WRITE_ACCESS("MergeFrom");
+        PROFILE_SCOPE("World::MergeFrom");
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        // 破棄待ちを先に反映してから、移すエンティティを確定する
+        source.FlushDestroyEndOfFrame();
+        std::vector<Entity> from;
+        from.reserve(source.aliveCount_);
+        source.ForEachEntity([&from](Entity e) { from.push_back(e); });
+        if (from.empty()) return 0;
+
+        std::vector<Entity> to;
+        CreateBatch(from.size(), to, cause);
+        if (signatures_.size() <= nextId_) signatures_.resize(static_cast<size_t>(nextId_) + 1);
+
+        std::vector<EntityRemap::Slot> slots(static_cast<size_t>(source.nextId_) + 1);
+        for (size_t i = 0; i < from.size(); ++i) {
+            slots[from[i].id] = EntityRemap::Slot{ from[i].gen, to[i] };
+        }
+        const EntityRemap remap(slots);
+
+        size_t components = 0;
+        for (IStore* store : source.stores_) {
+            if (store) components += store->MoveInto(*this, remap, cause);
+        }
+
+        // 無効化の状態を引き継ぎ、クエリへの通知はここで1回だけ
+        for (size_t i = 0; i < from.size(); ++i) {
+            const uint32_t id = to[i].id;
+            const ComponentMask disabled = source.disabledMask(from[i].id) & signatures_[id];
+            if (disabled.any()) {
+                if (id >= disabled_.size()) disabled_.resize(id + 1);
+                disabled_[id] = disabled;
+                for (size_t typeId = 0; typeId < behaviourGroupByType_.size() && typeId < MAX_COMPONENT_TYPES; ++typeId) {
+                    if (disabled.test(typeId) && behaviourGroupByType_[typeId]) {
+                        behaviourGroupByType_[typeId]->SetEnabled(id, false);
+                    }
+                }
+            }
+            notifyQueries(id);
+        }
+        CopyHierarchy(source, from.data(), to.data(), from.size());
+
+        for (Entity e : from) {
+            source.DestroyEntityInternal(e.id, Cause::Merged);
+        }
+
+        if (created) created->insert(created->end(), to.begin(), to.end());
+        DEBUGLOG_CATEGORY(DebugLog::Category::ECS, "World::MergeFrom() - エンティティ: " + std::to_string(to.size()) +
+                          ", コンポーネント: " + std::to_string(components) + ", " +
+                          std::to_string(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()) + " ms");
+        (void)start;
+        return to.size();
+    }
+
+    /**
+     * @brief MergeFrom() でコンポーネント内の Entity を付け替える関数を登録
+     * @tparam T コンポーネントの型
+     * @param[in] fn void(T&, const EntityRemap&) 形式の関数（移動先の World で呼ばれる）
+     *
+     * @par 使用例
+     * @code
+     * world.RegisterEntityRemap<Parent>([](Parent& p, const EntityRemap& remap) { p.entity = remap(p.entity); });
+     * @endcode
+     */
+    template<class T>
+    void RegisterEntityRemap(std::function<void(T&, const EntityRemap&)> fn) {
+        const ComponentTypeId typeId = ComponentId<T>();
+        if (typeId >= entityRemaps_.size()) entityRemaps_.resize(typeId + 1);
+        entityRemaps_[typeId] = [fn = std::move(fn)](void* item, const EntityRemap& remap) { fn(*static_cast<T*>(item), remap); };
+    }
+
+    /**
+     * @brief 全スレッドのコマンドバッファを記録順に反映(メインスレッドのみ)
+     *
+     * @details
+     * バッファはスレッド番号順(メインスレッド、ワーカー0、1...)に反映します。
+     * 仮ハンドルは同じバッファ内で生成したエンティティへ置き換えます。
+     * 反映時点で死亡しているエンティティへの操作はスキップします。
+     */
+    void PlaybackCommandBuffers() {
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("並列区間中にコマンドバッファの反映を試行");
+            return;
+        }
+        WORLD_WRITE_ACCESS("PlaybackCommandBuffers");
+
+        size_t applied = 0;
+        std::vector<Entity> created;
+        for (auto& buffer : commandBuffers_) {
+            if (buffer->Empty()) continue;
+            created.assign(buffer->CreatedCount(), Entity{ 0, 0 });
+
+            for (const auto& cmd : buffer->Commands()) {
+                Entity target = cmd.target;
+                if (CommandBuffer::IsDeferred(target)) {
+                    uint32_t index = target.id & ~CommandBuffer::DEFERRED_ENTITY_BIT;
+                    if (cmd.op == CommandBuffer::Op::Create) {
+                        if (systemsStopped_) {
+                            DEBUGLOG_WARNING(std::string("システム停止後の生成コマンドを破棄 (原因=") + CauseToString(cmd.cause) + ")");
+                            continue;
+                        }
+                        created[index] = CreateEntityWithCause(cmd.cause);
+                        applied++;
+                        continue;
+                    }
+                    target = index < created.size() ? created[index] : Entity{ 0, 0 };
+                }
+                else if (cmd.op == CommandBuffer::Op::Create) {
+                    // ReserveEntity() で予約済みのIDを生存させる
+                    if (systemsStopped_) {
+                        DEBUGLOG_WARNING(std::string("システム停止後の生成コマンドを破棄 (原因=") + CauseToString(cmd.cause) + ")");
+                        freeIdsPending_.push_back(target.id);
+                        continue;
+                    }
+                    if (commitReservedEntity(target, cmd.cause)) applied++;
+                    continue;
+                }
+
+                if (!IsAlive(target)) continue;
+
+                try {
+                    switch (cmd.op) {
+                    case CommandBuffer::Op::Add:
+                    case CommandBuffer::Op::Remove:
+                    case CommandBuffer::Op::Enable:
+                        cmd.apply(*this, target, cmd.cause, cmd.payload);
+                        break;
+                    case CommandBuffer::Op::Destroy:
+                        DestroyEntityWithCause(target, cmd.cause);
+                        break;
+                    default:
+                        break;
+                    }
+                    applied++;
+                } catch (const std::exception& ex) {
+                    DEBUGLOG_ERROR(std::string("コマンドの反映で例外発生: ") + ex.what());
+                }
             }
+            buffer->Clear();
+        }
+
+        if (applied > 0) {
+            DEBUGLOG("コマンドバッファを反映: " + std::to_string(applied) + " 件");
         }
     }
 
+    /**
+     * @brief ParallelForEach() の並列区間中かどうか
+     */
+    bool IsInParallelRegion() const { return parallelDepth_.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * @brief 現在のアクセスの段階(並列区間中は Read)
+     */
+    WorldPhase GetPhase() const { return IsInParallelRegion() ? WorldPhase::Read : WorldPhase::Write; }
+
+    /**
+     * @class ReadPhaseScope
+     * @brief 生存期間を読み取りフェーズにする(システムが自分でジョブを投入して World を読む場合)
+     *
+     * @details
+     * 同期点のスレッドで作成し、投入したジョブをすべて待ってから破棄してください。
+     * 入れ子にでき、SystemScheduler の並列ステージ・ParallelForEach() と同じ扱いになります。
+     *
+     * @par 使用例
+     * @code
+     * World::ReadPhaseScope read(world);
+     * JobSystem::JobCounter counter;
+     * jobs.Submit([&]() { world.ForEach<Transform>(...); }, &counter);
+     * jobs.Wait(counter);
+     * @endcode
+     */
+    class ReadPhaseScope {
+    public:
+        explicit ReadPhaseScope(World& world) : world_(world) { world_.parallelDepth_.fetch_add(1, std::memory_order_acq_rel); }
+        ~ReadPhaseScope() { world_.parallelDepth_.fetch_sub(1, std::memory_order_acq_rel); }
+        ReadPhaseScope(const ReadPhaseScope&) = delete;
+        ReadPhaseScope& operator=(const ReadPhaseScope&) = delete;
+
+    private:
+        World& world_;
+    };
+
     /**
      * @brief すべてのBehaviourコンポーネントを更新
      */
     void Tick(float dt) {
+        PROFILE_SCOPE("World::Tick");
 #ifdef _DEBUG
         // フレーム番号をログに反映
         DebugLog::GetInstance().SetFrame(frameCount_ + 1);
+        TickThreadScope tickThread(*this);
 #endif
         if (dt < 0.0f) {
             DEBUGLOG_WARNING("World::Tickで負のdeltaTimeを検出: " + std::to_string(dt));
@@ -589,8 +1753,11 @@ public:
         createdThisFrame_ = 0;
         destroyedThisFrame_ = 0;
 
+        // フレームごとに変更ティックを進める
+        ++changeTick_;
+
         // 整合性チェック用: フレーム開始時点（スポーン反映前）の生存数を記録
-        windowAliveStart_ = alive_.size();
+        windowAliveStart_ = aliveCount_;
 
         // この時点からフレーム内会計を有効化
         trackFrameAccounting_ = true;
@@ -598,97 +1765,70 @@ public:
         // まずスポーンをスタート・オブ・フレームで反映（契約：メインスレッド）
         FlushSpawnStartOfFrame();
 
+        // フレーム間に記録されたコマンドを反映
+        PlaybackCommandBuffers();
+
+        // 前のフレームに送信されたイベントを読み取り側へ移す
+        for (auto& channel : eventChannels_) {
+            channel->Swap();
+        }
+
         // メトリクス更新（最近Nフレーム）
+        lastDt_ = dt;
         recentCount_++;
         recentDtSum_ += dt;
         if (dt < recentDtMin_) recentDtMin_ = dt;
         if (dt > recentDtMax_) recentDtMax_ = dt;
 
-        inUpdate_ = true;
-
-        size_t startedCount = 0;
-        for (size_t i = 0; i < behaviours_.size(); ) {
-            if (i >= behaviours_.size()) break;
-            auto& entry = behaviours_[i];
+        {
+            UpdateScope updating(*this);
 
-            if (!entry.started && IsAlive(entry.e)) {
-                try {
-                    entry.b->OnStart(*this, entry.e);
-                    entry.started = true;
-                    startedCount++;
-                    // 原因付きログ
-                    DEBUGLOG(std::string("ビヘイビア開始: ") + typeid(*entry.b).name() +
-                             " on Entity " + std::to_string(entry.e.id) +
-                             " (gen " + std::to_string(entry.e.gen) + ")" +
-                             " 原因=" + CauseToString(entry.cause));
-                } catch (const std::exception& ex) {
-                    DEBUGLOG_ERROR("エンティティ " + std::to_string(entry.e.id) + " のBehaviour::OnStartで例外発生: " + ex.what());
-                }
+            // OnStartの実行（型ごとのグループ単位。OnStart中に追加されたものも同フレームで開始）
+            size_t startedCount = 0;
+            for (size_t g = 0; g < behaviourGroups_.size(); ++g) {
+                startedCount += behaviourGroups_[g]->StartPending(*this);
             }
 
-            if (i < behaviours_.size() && behaviours_[i].e == entry.e) {
-                i++;
+            if (startedCount > 0) {
+                DEBUGLOG(std::to_string(startedCount) + " 個の新しいビヘイビアを開始");
             }
-        }
 
-        if (startedCount > 0) {
-            DEBUGLOG(std::to_string(startedCount) + " 個の新しいビヘイビアを開始");
-        }
-
-        // OnUpdateの実行（より安全なイテレーション）
-        for (size_t i = 0; i < behaviours_.size(); ) {
-            if (i >= behaviours_.size()) break;
-
-            auto& entry = behaviours_[i];
-            Entity currentEntity = entry.e;
-            Behaviour* currentBehaviour = entry.b;
-
-            if (!IsAlive(currentEntity)) {
-                // 死んだエンティティはスキップ
-                i++;
-                continue;
+            // OnUpdateの実行（同じ型のBehaviourを連続して更新。UpdateBatchを持つ型は一括呼び出し）
+            // 更新中に追加されたBehaviourは次フレームでOnStartの後に更新される
+            for (size_t g = 0; g < behaviourGroups_.size(); ++g) {
+                IBehaviourGroup& group = *behaviourGroups_[g];
+                if (!behaviourTimingEnabled_) {
+                    group.Update(*this, dt);
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                size_t invoked = group.Update(*this, dt);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                if (invoked > 0) group.RecordTiming(elapsed.count(), invoked);
             }
 
-            try {
-                entry.b->OnUpdate(*this, currentEntity, dt);
-            } catch (const std::exception& ex) {
-                DEBUGLOG_ERROR("エンティティ " + std::to_string(currentEntity.id) + " のBehaviour::OnUpdateで例外発生: " + ex.what());
-            }
+            // 満了したタイマーの実行(遅延破棄はここで予約され、フレーム終端でまとめて破棄される)
+            timerWheel_.Advance(*this, dt);
 
-            if (i >= behaviours_.size()) {
-                break;
-            }
+            // 待ちが明けた非同期タスクの再開(待っているタスクは呼ばれない)
+            tasks_.Run(*this, dt);
 
-            if (i < behaviours_.size()) {
-                if (behaviours_[i].e == currentEntity && behaviours_[i].b == currentBehaviour) {
-                    i++;
-                }
+            // 登録システムの実行（競合しないものは並列）
+            if (!systemsStopped_) {
+                scheduler_.Run(*this, jobSystem_, dt);
             }
         }
 
-        inUpdate_ = false;
+        // 更新中に記録されたコマンドを反映（破棄は直後のFlushで処理される）
+        PlaybackCommandBuffers();
 
         // End-of-frame contract: 全System更新が終わった後に破棄を反映
         FlushDestroyEndOfFrame();
 
-        // 無効になったBehaviour（死んだエンティティに紐づくもの）をまとめて削除
-        size_t beforeCleanup = behaviours_.size();
-        behaviours_.erase(
-            std::remove_if(behaviours_.begin(), behaviours_.end(),
-                [this](const BEntry& entry) {
-                    return !IsAlive(entry.e);
-                }),
-            behaviours_.end()
-        );
-
-        if (behaviours_.size() != beforeCleanup) {
-            DEBUGLOG(std::to_string(beforeCleanup - behaviours_.size()) + " 個の死んだビヘイビアをクリーンアップ");
-        }
-
         // 整合性チェック（生存数 = 開始時 + 作成 - 破棄）
         size_t expectedAlive = windowAliveStart_ + createdThisFrame_ - destroyedThisFrame_;
-        if (alive_.size() != expectedAlive) {
-            DEBUGLOG_WARNING("メトリクス不一致: alive=" + std::to_string(alive_.size()) +
+        if (aliveCount_ != expectedAlive) {
+            DEBUGLOG_WARNING("メトリクス不一致: alive=" + std::to_string(aliveCount_) +
                              ", expected=" + std::to_string(expectedAlive) +
                              ", startAlive=" + std::to_string(windowAliveStart_) +
                              ", createdThisFrame=" + std::to_string(createdThisFrame_) +
@@ -700,6 +1840,8 @@ public:
             freeIdsReady_.insert(freeIdsReady_.end(), freeIdsPending_.begin(), freeIdsPending_.end());
             freeIdsPending_.clear();
         }
+        // 並列区間中に予約された新規IDの世代表をここで広げる
+        if (generations_.size() <= nextId_) generations_.resize(static_cast<size_t>(nextId_) + 1, 1);
 
         // Nフレームごとに集計ログを出す（スパム抑制）
         if (recentCount_ >= metricsWindow_) {
@@ -709,8 +1851,20 @@ public:
                      ", created=" + std::to_string(recentCreated_) +
                      ", destroyed=" + std::to_string(recentDestroyed_) +
                      ", maxAlive=" + std::to_string(maxAlive_) +
-                     ", aliveNow=" + std::to_string(alive_.size())
+                     ", aliveNow=" + std::to_string(aliveCount_)
             );
+            ComponentPoolStats pools = GetTotalPoolStats();
+            DEBUGLOG("コンポーネントプール: live=" + std::to_string(pools.live) +
+                     ", capacity=" + std::to_string(pools.capacity) +
+                     ", chunks=" + std::to_string(pools.chunkCount) +
+                     ", reservedKB=" + std::to_string(pools.reservedBytes / 1024) +
+                     ", occupancy=" + std::to_string(static_cast<int>(pools.Occupancy() * 100.0f)) + "%");
+            (void)pools;
+            if (behaviourTimingEnabled_) {
+                logHeaviestBehaviours(3);
+            }
+            // GetStats() 用に完了した窓を残す
+            lastWindow_ = MetricsWindow{ recentCount_, recentCreated_, recentDestroyed_, avg, recentDtMin_, recentDtMax_ };
             // リセット
             recentDtSum_ = 0.0f;
             recentDtMin_ = std::numeric_limits<float>::infinity();
@@ -735,21 +1889,29 @@ public:
      * 破棄要求キューを処理します。
      */
     void FlushDestroyEndOfFrame() {
-        std::vector<std::pair<uint32_t, Cause>> toDestroy;
+        WORLD_WRITE_ACCESS("FlushDestroyEndOfFrame");
+        // 写しはフレームアリーナに取り、キュー側は容量を残したまま空にする(定常状態でヒープ確保なし)
+        std::pmr::vector<std::pair<uint32_t, Cause>> toDestroy(&FrameArena::ForThread());
         {
             std::lock_guard<std::mutex> lock(pendingMutex_);
             if (pendingDestroy_.empty()) return;
-            toDestroy.swap(pendingDestroy_);
+            toDestroy.assign(pendingDestroy_.begin(), pendingDestroy_.end());
+            pendingDestroy_.clear();
         }
 
-        // 重複除去（最後の原因を優先)
-        std::unordered_map<uint32_t, Cause> lastCause;
-        lastCause.reserve(toDestroy.size());
-        for (auto& p : toDestroy) lastCause[p.first] = p.second;
-
+        // 後ろから処理して重複を除去（最後の原因を優先）
+        // 破棄したIDの再利用は次フレームからなので、同じIDの2件目以降は生存判定で弾ける
+        // プールから生成したエンティティは、容量に空きがあれば休止状態に戻す
         size_t destroyed = 0;
-        for (auto& kv : lastCause) {
-            DestroyEntityInternal(kv.first, kv.second);
+        for (size_t i = toDestroy.size(); i-- > 0; ) {
+            uint32_t id = toDestroy[i].first;
+            if (!testAliveBit(id)) continue;
+            EntityPool* pool = id < poolOf_.size() ? poolOf_[id] : nullptr;
+            if (pool) {
+                releaseToPool(*pool, id, toDestroy[i].second);
+            } else {
+                DestroyEntityInternal(id, toDestroy[i].second);
+            }
             destroyed++;
         }
         if (destroyed > 0) {
@@ -761,6 +1923,7 @@ public:
      * @brief メインスレッドのみで呼ぶ（契約）。フレーム開始時にスポーンキューを反映。
      */
     void FlushSpawnStartOfFrame() {
+        WORLD_WRITE_ACCESS("FlushSpawnStartOfFrame");
         if (systemsStopped_) {
             // システム停止後はスポーンキューを処理しない
             std::lock_guard<std::mutex> lock(spawnMutex_);
@@ -771,11 +1934,13 @@ public:
             return;
         }
 
-        std::vector<std::pair<Cause, std::function<void(Entity)>>> toSpawn;
+        std::pmr::vector<std::pair<Cause, std::function<void(Entity)>>> toSpawn(&FrameArena::ForThread());
         {
             std::lock_guard<std::mutex> lock(spawnMutex_);
             if (pendingSpawn_.empty()) return;
-            toSpawn.swap(pendingSpawn_);
+            toSpawn.reserve(pendingSpawn_.size());
+            for (auto& item : pendingSpawn_) toSpawn.emplace_back(item.first, std::move(item.second));
+            pendingSpawn_.clear();
         }
         size_t spawned = 0;
         for (auto& item : toSpawn) {
@@ -826,6 +1991,24 @@ public:
         generations_.reserve(count);
     }
 
+    /**
+     * @brief エンティティが所持するコンポーネントのビットマスクを取得
+     * @param[in] e 対象エンティティ
+     * @return ComponentMask ComponentId<T>() 番目のビットが所持を表すマスク
+     *
+     * @par 使用例
+     * @code
+     * ComponentMask need = MakeComponentMask<Transform, MeshRenderer>();
+     * if ((world.GetSignature(e) & need) == need) {
+     *     // 両方を所持している
+     * }
+     * @endcode
+     */
+    ComponentMask GetSignature(Entity e) const {
+        if (!isCurrentHandle(e) || e.id >= signatures_.size()) return ComponentMask();
+        return signatures_[e.id];
+    }
+
     /**
      * @brief 指定されたコンポーネントを持つエンティティの数を取得
      * @tparam T コンポーネントの型
@@ -833,48 +2016,775 @@ public:
      */
     template<class T>
     size_t GetComponentCount() const {
-        auto it = stores_.find(std::type_index(typeid(T)));
-        if (it == stores_.end()) {
-            return 0;
-        }
-        auto* store = static_cast<const Store<T>*>(it->second);
-        return store->map.size();
+        auto* store = findStore<T>();
+        return store ? store->data.Size() : 0;
     }
 
-private:
     /**
-     * @interface IStore
-     * @brief コンポーネント格納用のインターフェース
+     * @brief コンポーネントプールの使用状況を取得
+     * @tparam T コンポーネントの型
+     * @return ComponentPoolStats 格納数・最大格納数・確保容量など（未使用の型は全て0）
      */
-    struct IStore {
-        virtual ~IStore() = default;
-        virtual void Erase(Entity) = 0;
-    };
-
     template<class T>
-    struct Store : IStore {
-        std::unordered_map<uint32_t, std::unique_ptr<T>> map;  ///< EntityID -> コンポーネントインスタンス
-        void Erase(Entity e) override { map.erase(e.id); }
-    };
+    ComponentPoolStats GetComponentPoolStats() const {
+        auto* store = findStore<T>();
+        return store ? store->data.Stats() : ComponentPoolStats();
+    }
+
+    /**
+     * @brief 全コンポーネントプールの使用状況の合計を取得
+     */
+    ComponentPoolStats GetTotalPoolStats() const {
+        ComponentPoolStats total;
+        for (const IStore* store : stores_) {
+            if (store) total += store->Stats();
+        }
+        return total;
+    }
+
+    /**
+     * @brief 全エンティティプールの累計の合計(再利用率は HitRate())
+     */
+    EntityPool::Statistics GetEntityPoolStats() const {
+        EntityPool::Statistics total;
+        for (auto& pool : pools_) {
+            const EntityPool::Statistics& s = pool.second->GetStatistics();
+            total.spawned += s.spawned;
+            total.reused += s.reused;
+            total.created += s.created;
+            total.released += s.released;
+            total.discarded += s.discarded;
+        }
+        return total;
+    }
+
+    /**
+     * @brief 全エンティティプールで休止中のエンティティ数
+     */
+    size_t GetDormantEntityCount() const {
+        size_t count = 0;
+        for (auto& pool : pools_) count += pool.second->DormantCount();
+        return count;
+    }
+
+    /**
+     * @brief 作成済みの全コンポーネントストアの使用状況(型IDの順)
+     */
+    std::vector<ComponentStoreStats> GetComponentStoreStats() const {
+        std::vector<ComponentStoreStats> result;
+        for (const IStore* store : stores_) {
+            if (!store) continue;
+            ComponentStoreStats s;
+            s.name = store->Name();
+            s.pool = store->Stats();
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    /**
+     * @brief 件数とメモリの概算をまとめて取得(毎フレーム呼べるように、ストアと型の数に比例する集計のみ)
+     * @param[out] out 書き込み先(storeDetails は容量を残して書き直すため、使い回せばメモリ確保は起きない)
+     * @param[in] includeStores ストアごとの使用状況も書くか
+     */
+    void GetStats(WorldStats& out, bool includeStores = true) const {
+        out.frame = frameCount_;
+        out.lastDt = lastDt_;
+        out.alive = aliveCount_;
+        out.maxAlive = maxAlive_;
+        out.totalCreated = totalCreated_;
+        out.totalDestroyed = totalDestroyed_;
+        out.createdLastFrame = createdThisFrame_;
+        out.destroyedLastFrame = destroyedThisFrame_;
+
+        out.windowFrames = lastWindow_.frames;
+        out.windowCreated = lastWindow_.created;
+        out.windowDestroyed = lastWindow_.destroyed;
+        out.windowDtAvg = lastWindow_.dtAvg;
+        out.windowDtMin = lastWindow_.dtMin;
+        out.windowDtMax = lastWindow_.dtMax;
+
+        out.behaviours = behaviourCount();
+        out.behaviourTypes = behaviourGroups_.size();
+
+        out.stores = 0;
+        out.components = ComponentPoolStats();
+        out.storeDetails.clear();
+        for (const IStore* store : stores_) {
+            if (!store) continue;
+            ComponentStoreStats s;
+            s.name = store->Name();
+            s.pool = store->Stats();
+            ++out.stores;
+            out.components += s.pool;
+            if (includeStores) out.storeDetails.push_back(s);
+        }
+
+        out.entityBytes = generations_.capacity() * sizeof(uint32_t) +
+                          aliveBits_.capacity() * sizeof(uint64_t) +
+                          (signatures_.capacity() + disabled_.capacity()) * sizeof(ComponentMask) +
+                          hierarchy_.capacity() * sizeof(HierarchyLink) +
+                          (freeIdsReady_.capacity() + freeIdsPending_.capacity()) * sizeof(uint32_t);
+        for (const IdShard& shard : idShards_) out.entityBytes += shard.ids.capacity() * sizeof(uint32_t);
+    }
+
+    /**
+     * @brief 件数とメモリの概算(ストアごとの使用状況を含む)
+     */
+    WorldStats GetStats() const {
+        WorldStats stats;
+        GetStats(stats);
+        return stats;
+    }
+
+    /**
+     * @brief Behaviour の型ごとの更新時間の計測を切り替え(既定は無効)
+     *
+     * @details
+     * 有効な間、Tick() で型ごとのグループの更新時間と呼び出し回数を加算し、
+     * 集計ログ(metricsWindow_ フレームごと)に最も重い型を出力します。
+     * 無効にしても加算済みの値は残ります(ResetBehaviourStats() で消去)。
+     */
+    void SetBehaviourTimingEnabled(bool enabled) { behaviourTimingEnabled_ = enabled; }
+    bool IsBehaviourTimingEnabled() const { return behaviourTimingEnabled_; }
+
+    /**
+     * @brief Behaviour の例外の扱いを切り替え(既定はデバッグビルドで Catch、リリースビルドで CatchPerBatch)
+     *
+     * @details
+     * CatchPerBatch は try に入るのがグループごとに1回(と例外の後の再開ごと)のため、更新のループに
+     * 呼び出しごとの例外フレームがありません。例外を投げた要素の型とエンティティは、走査中の位置から
+     * どの方式でも特定でき、DEBUGLOG_ERROR に出力して BehaviourStats::exceptions に数えます。
+     */
+    void SetBehaviourExceptionPolicy(BehaviourExceptionPolicy policy) { behaviourExceptionPolicy_ = policy; }
+    BehaviourExceptionPolicy GetBehaviourExceptionPolicy() const { return behaviourExceptionPolicy_; }
+
+    /**
+     * @brief Behaviour の型ごとの統計(最初に追加された型の順)
+     */
+    std::vector<BehaviourStats> GetBehaviourStats() const {
+        std::vector<BehaviourStats> result;
+        result.reserve(behaviourGroups_.size());
+        for (const auto& group : behaviourGroups_) {
+            BehaviourStats s = group->timing;
+            s.name = group->Name();
+            s.live = group->Size();
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    /**
+     * @brief 登録されている Behaviour の総数(全型の合計)
+     */
+    size_t GetBehaviourCount() const {
+        size_t count = 0;
+        for (const auto& group : behaviourGroups_) {
+            count += group->Size();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Behaviour の型ごとの時間・呼び出し回数を消去
+     */
+    void ResetBehaviourStats() {
+        for (auto& group : behaviourGroups_) {
+            group->timing = BehaviourStats();
+        }
+    }
+
+private:
+    /**
+     * @interface IStore
+     * @brief コンポーネント格納用のインターフェース
+     */
+    struct IStore {
+        virtual ~IStore() = default;
+        virtual bool Erase(uint32_t id) = 0;
+        virtual ComponentPoolStats Stats() const = 0;
+        virtual const char* Name() const = 0;
+        virtual size_t MoveInto(World& dst, const EntityRemap& remap, Cause cause) = 0; ///< MergeFrom() での移動
+    };
+
+    template<class T>
+    struct Store : IStore {
+        ComponentStorageFor<T> data;  ///< スパースセット + 16KBチャンクのコンポーネント本体（タグはビット列）
+        bool Erase(uint32_t id) override { return data.Erase(id); }
+        ComponentPoolStats Stats() const override { return data.Stats(); }
+        const char* Name() const override { return typeid(T).name(); }
+        size_t MoveInto(World& dst, const EntityRemap& remap, Cause cause) override { return dst.mergeComponents<T>(*this, remap, cause); }
+    };
 
     template<class T>
     Store<T>& getStore() {
-        auto key = std::type_index(typeid(T));
-        auto it = stores_.find(key);
-        if (it == stores_.end()) {
+        ComponentTypeId id = ComponentId<T>();
+        if (id >= stores_.size()) {
+            stores_.resize(id + 1, nullptr);
+        }
+        if (!stores_[id]) {
             auto* s = new Store<T>();
-            stores_[key] = s;
-            erasers_.push_back([s](Entity e) { s->Erase(e); });
+            stores_[id] = s;
+            if (id >= MAX_COMPONENT_TYPES) {
+                DEBUGLOG_WARNING("コンポーネント型数がマスク上限を超過: " + std::string(typeid(T).name()) +
+                                 " はシグネチャに反映されません (ID: " + std::to_string(id) + ")");
+            }
             return *s;
         }
-        return *static_cast<Store<T>*>(it->second);
+        return *static_cast<Store<T>*>(stores_[id]);
+    }
+
+    // ストア検索（未作成ならnullptr）。型IDで配列を直接引く
+    template<class T>
+    Store<T>* findStore() {
+        ComponentTypeId id = ComponentId<T>();
+        return id < stores_.size() ? static_cast<Store<T>*>(stores_[id]) : nullptr;
+    }
+
+    template<class T>
+    const Store<T>* findStore() const {
+        ComponentTypeId id = ComponentId<T>();
+        return id < stores_.size() ? static_cast<const Store<T>*>(stores_[id]) : nullptr;
+    }
+
+    void setSignatureBit(uint32_t entityId, ComponentTypeId typeId, bool value) {
+        if (typeId >= MAX_COMPONENT_TYPES) return;
+        if (entityId >= signatures_.size()) {
+            signatures_.resize(entityId + 1);
+        }
+        signatures_[entityId].set(typeId, value);
+        if (!value && entityId < disabled_.size()) disabled_[entityId].reset(typeId);
+        notifyQueries(entityId);
+    }
+
+    // シグネチャ変化をキャッシュ済みクエリへ反映
+    void notifyQueries(uint32_t entityId) {
+        if (queries_.empty()) return;
+        const ComponentMask& signature = signatures_[entityId];
+        const ComponentMask disabled = disabledMask(entityId);
+        for (auto& q : queries_) {
+            q->OnSignatureChanged(entityId, signature, disabled);
+        }
+    }
+
+    ComponentMask disabledMask(uint32_t entityId) const {
+        return entityId < disabled_.size() ? disabled_[entityId] : ComponentMask();
+    }
+
+    bool isDisabled(uint32_t entityId, ComponentTypeId typeId) const {
+        return typeId < MAX_COMPONENT_TYPES && entityId < disabled_.size() && disabled_[entityId].test(typeId);
+    }
+
+    bool testAliveBit(uint32_t id) const {
+        size_t word = id / 64;
+        return word < aliveBits_.size() && (aliveBits_[word] >> (id % 64)) & 1u;
+    }
+
+    static constexpr size_t ID_BLOCK_SIZE = 64;  ///< IDキャッシュを1回に補充する数
+
+    /**
+     * @struct IdShard
+     * @brief スレッドごとのIDキャッシュ（まだ生存していない空き・新規ID、世代は generations_）
+     */
+    struct alignas(64) IdShard {
+        std::vector<uint32_t> ids;
+    };
+
+    /**
+     * @brief 現在のスレッドのスロット(0: メインスレッド, 1..: ワーカー)
+     */
+    static size_t currentThreadSlot() {
+        int worker = JobSystem::CurrentWorkerIndex();
+        return worker >= 0 ? static_cast<size_t>(worker) + 1 : 0;
+    }
+
+    /**
+     * @brief スレッドのIDキャッシュから1つ取り出す(空なら entityMutex_ の下でブロック単位に補充)
+     * @details 空きIDを優先し、足りなければ新規IDを Entity::MAX_INDEX まで確保します。世代表は広げません。
+     */
+    uint32_t takeShardId(IdShard& shard) {
+        if (shard.ids.empty()) {
+            std::lock_guard<std::mutex> lock(entityMutex_);
+            const size_t reused = (std::min)(ID_BLOCK_SIZE, freeIdsReady_.size());
+            const size_t fresh = (std::min)(ID_BLOCK_SIZE - reused, static_cast<size_t>(Entity::MAX_INDEX - nextId_));
+            if (reused + fresh == 0) {
+                DEBUGLOG_ERROR("エンティティIDの上限に達しました (ENTITY_INDEX_BITS=" + std::to_string(Entity::INDEX_BITS) + ")");
+                throw std::runtime_error("Entity index space exhausted");
+            }
+            shard.ids.reserve(ID_BLOCK_SIZE);
+            // 後ろから取り出すので、新規IDを先に積み、空きIDを従来どおり freeIdsReady_ の末尾から使う順に並べる
+            for (size_t i = fresh; i > 0; --i) shard.ids.push_back(nextId_ + static_cast<uint32_t>(i));
+            nextId_ += static_cast<uint32_t>(fresh);
+            shard.ids.insert(shard.ids.end(), freeIdsReady_.end() - reused, freeIdsReady_.end());
+            freeIdsReady_.resize(freeIdsReady_.size() - reused);
+        }
+        const uint32_t id = shard.ids.back();
+        shard.ids.pop_back();
+        return id;
+    }
+
+    /**
+     * @brief IDキャッシュを持たないスレッド用に、entityMutex_ の下で1つだけ取り出す
+     */
+    uint32_t takeUnshardedId() {
+        std::lock_guard<std::mutex> lock(entityMutex_);
+        if (!freeIdsReady_.empty()) {
+            const uint32_t id = freeIdsReady_.back();
+            freeIdsReady_.pop_back();
+            return id;
+        }
+        if (nextId_ >= Entity::MAX_INDEX) {
+            DEBUGLOG_ERROR("エンティティIDの上限に達しました (ENTITY_INDEX_BITS=" + std::to_string(Entity::INDEX_BITS) + ")");
+            throw std::runtime_error("Entity index space exhausted");
+        }
+        return ++nextId_;
+    }
+
+    /**
+     * @brief ReserveEntity() で予約したハンドルを生存させる(同期点のみ)
+     */
+    bool commitReservedEntity(Entity e, Cause cause) {
+        if (generations_.size() <= e.id) generations_.resize(static_cast<size_t>(e.id) + 1, 1);
+        if (generations_[e.id] != e.gen || testAliveBit(e.id)) {
+            DEBUGLOG_ERROR("予約されていないハンドルの生成コマンドを破棄 (ID=" + std::to_string(e.id) + ")");
+            return false;
+        }
+        setAliveBit(e.id, true);
+        totalCreated_++;
+        if (trackFrameAccounting_) { createdThisFrame_++; }
+        if (aliveCount_ > maxAlive_) maxAlive_ = aliveCount_;
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "予約済みエンティティを作成 (ID: {}, 原因={})", e.id, CauseToString(cause));
+        return true;
+    }
+
+    void setAliveBit(uint32_t id, bool alive) {
+        size_t word = id / 64;
+        if (word >= aliveBits_.size()) {
+            aliveBits_.resize(word + 1, 0);
+        }
+        uint64_t mask = uint64_t(1) << (id % 64);
+        bool was = (aliveBits_[word] & mask) != 0;
+        if (alive && !was) {
+            aliveBits_[word] |= mask;
+            ++aliveCount_;
+        } else if (!alive && was) {
+            aliveBits_[word] &= ~mask;
+            --aliveCount_;
+        }
+    }
+
+    // ハンドルの世代が現在の世代と一致するか（生存ビットを見ない軽量版）
+    bool isCurrentHandle(Entity e) const {
+        return e.id < generations_.size() && generations_[e.id] == e.gen;
+    }
+
+    /**
+     * @brief 型に依存しないBehaviourグループ
+     */
+    struct IBehaviourGroup {
+        virtual ~IBehaviourGroup() = default;
+        virtual size_t StartPending(World& w) = 0;
+        virtual size_t Update(World& w, float dt) = 0;  ///< 更新した要素数を返す
+        virtual bool Remove(uint32_t id) = 0;
+        virtual bool SetEnabled(uint32_t id, bool enabled) = 0; ///< 無効なものは更新対象から外して保管する
+        virtual size_t Size() const = 0;
+        virtual const char* Name() const = 0;
+
+        BehaviourStats timing;  ///< 計測値(name / live は GetBehaviourStats() で設定)
+
+        void RecordTiming(double ms, size_t invoked) {
+            timing.frames++;
+            timing.invocations += invoked;
+            timing.totalMs += ms;
+            timing.lastMs = ms;
+            if (ms > timing.maxMs) timing.maxMs = ms;
+        }
+    };
+
+    /**
+     * @brief 同じ具象型のBehaviourをまとめたグループ
+     *
+     * @details
+     * エンティティ・Behaviour・開始フラグ・原因を並列配列で保持し、ID -> 位置 の逆引きで
+     * O(1)で削除します(末尾の要素で埋める)。走査中の削除は nullptr で墓石化し、走査中の追加は保留して
+     * 走査終了後に反映するため、走査中に配列が再確保されることはありません。
+     * 墓石は末尾のものだけ走査終了時に切り詰め、途中の墓石が COMPACT_MIN_TOMBSTONES 個かつ
+     * 要素の 1/COMPACT_RATIO 以上になったときだけ順番を保って詰めます。破棄の少ないフレームは全体を走査しません。
+     * 無効化したものは更新用の配列から外して parked に移し、開始フラグを保ったまま戻せます。
+     */
+    template<class T>
+    struct BehaviourGroup : IBehaviourGroup {
+        static constexpr size_t COMPACT_MIN_TOMBSTONES = 32; ///< 詰める墓石の最小数
+        static constexpr size_t COMPACT_RATIO = 4;           ///< 墓石が要素の 1/COMPACT_RATIO 以上で詰める
+
+        /**
+         * @struct Entry
+         * @brief 更新用の配列の外にある要素(走査中の追加・無効化中)
+         */
+        struct Entry {
+            Entity entity;
+            T* item;
+            Cause cause;
+            uint8_t started;
+        };
+
+        std::vector<Entity> entities;       ///< 所有エンティティ
+        std::vector<T*> items;              ///< Behaviour本体（墓石は nullptr）
+        std::vector<uint8_t> started;       ///< OnStart済みか
+        std::vector<Cause> causes;          ///< 追加時の原因
+        std::vector<uint32_t> indexOf;      ///< EntityID -> 位置+1（0は非所属）
+        std::vector<Entry> pending;         ///< 走査中に追加・有効化されたもの
+        std::vector<Entry> parked;          ///< 無効化中のもの
+        std::vector<uint32_t> parkedOf;     ///< EntityID -> parked の位置+1（0は非所属）
+        std::vector<uint32_t> startQueue;   ///< OnStart待ちの EntityID（外れたもの・重複は取り出し時に読み飛ばす）
+        std::vector<uint32_t> startBatch;   ///< StartPending で処理中の startQueue
+        size_t live = 0;                    ///< 有効な要素数（保留中を含み、無効化中を含まない）
+        int iterating = 0;                  ///< 走査の入れ子深さ
+        size_t tombstones = 0;              ///< items の nullptr の数
+
+        // 走査の入れ子を1段深くし、抜けるとき(例外を含む)に endIteration() で戻す
+        struct IterationScope {
+            explicit IterationScope(BehaviourGroup& group) : group_(group) { ++group_.iterating; }
+            ~IterationScope() { group_.endIteration(); }
+            BehaviourGroup& group_;
+        };
+
+        void Reserve(size_t count) {
+            if (iterating > 0) return;
+            size_t n = items.size() + count;
+            entities.reserve(n);
+            items.reserve(n);
+            started.reserve(n);
+            causes.reserve(n);
+        }
+
+        void Add(Entity e, T* obj, Cause cause) {
+            ++live;
+            if (iterating > 0) {
+                pending.push_back(Entry{ e, obj, cause, 0 });
+                return;
+            }
+            insert(e, obj, cause, 0);
+        }
+
+        bool Remove(uint32_t id) override {
+            if (id < indexOf.size() && indexOf[id] != 0) {
+                size_t pos = indexOf[id] - 1;
+                --live;
+                detach(pos);
+                return true;
+            }
+
+            // 無効化中のもの（live には数えていない）
+            if (id < parkedOf.size() && parkedOf[id] != 0) {
+                unpark(id);
+                return true;
+            }
+
+            // 走査中に追加され、まだ反映されていないもの
+            for (size_t i = 0; i < pending.size(); ++i) {
+                if (pending[i].entity.id == id) {
+                    pending.erase(pending.begin() + i);
+                    --live;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool SetEnabled(uint32_t id, bool enabled) override {
+            if (enabled) {
+                if (id >= parkedOf.size() || parkedOf[id] == 0) return false;
+                Entry entry = parked[parkedOf[id] - 1];
+                unpark(id);
+                ++live;
+                if (iterating > 0) {
+                    pending.push_back(entry);
+                } else {
+                    insert(entry.entity, entry.item, entry.cause, entry.started);
+                }
+                return true;
+            }
+
+            if (id < indexOf.size() && indexOf[id] != 0) {
+                size_t pos = indexOf[id] - 1;
+                park(Entry{ entities[pos], items[pos], causes[pos], started[pos] });
+                --live;
+                detach(pos);
+                return true;
+            }
+            for (size_t i = 0; i < pending.size(); ++i) {
+                if (pending[i].entity.id == id) {
+                    park(pending[i]);
+                    pending.erase(pending.begin() + i);
+                    --live;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t Size() const override { return live; }
+        const char* Name() const override { return typeid(T).name(); }
+
+        /**
+         * @brief startQueue の要素の OnStart を呼ぶ（待ちがなければ要素を走査しない）
+         *
+         * @details
+         * OnStart 中に追加されたものも同じ呼び出しで開始します。例外で開始できなかったものは次フレームで再試行します。
+         */
+        size_t StartPending(World& w) override {
+            size_t startedCount = 0;
+            std::vector<uint32_t> retry;
+            while (!startQueue.empty()) {
+                startBatch.swap(startQueue);
+                IterationScope iteration(*this);
+                invokeEach(w, "OnStart", startBatch.size(), [&](size_t k) {
+                    const size_t i = unstartedPosition(startBatch[k]);
+                    if (i == SIZE_MAX) return;
+                    items[i]->OnStart(w, entities[i]);
+                    started[i] = 1;
+                    startedCount++;
+                    // 原因付きログ
+                    DEBUGLOG_FMT(DebugLog::Category::ECS, "ビヘイビア開始: {} on Entity {} (gen {}) 原因={}",
+                                 typeid(T).name(), entities[i].id, entities[i].gen, CauseToString(causes[i]));
+                }, [&](size_t k) { return startBatch[k]; });
+                for (uint32_t id : startBatch) {
+                    if (unstartedPosition(id) != SIZE_MAX) retry.push_back(id);
+                }
+                startBatch.clear();
+                // 走査中に追加されたものは iteration を抜けるときの endIteration() で startQueue に入る
+            }
+            startQueue.swap(retry);
+            return startedCount;
+        }
+
+        size_t Update(World& w, float dt) override {
+            if (items.empty()) return 0;
+            PROFILE_SCOPE(typeid(T).name());
+            IterationScope iteration(*this);
+            return dispatch(w, dt, HasUpdateBatch<T>());
+        }
+
+    private:
+        // 通常: 具象型を確定した呼び出し（仮想関数の間接呼び出しなし）
+        size_t dispatch(World& w, float dt, std::false_type) {
+            size_t invoked = 0;
+            invokeEach(w, "OnUpdate", items.size(), [&](size_t i) {
+                T* b = items[i];
+                if (!b) return;
+                ++invoked;
+                b->T::OnUpdate(w, entities[i], dt);
+            }, [&](size_t i) { return entities[i].id; });
+            return invoked;
+        }
+
+        // T::UpdateBatch が定義されている場合: グループ全体を1回で処理（Catch / CatchPerBatch は同じ）
+        size_t dispatch(World& w, float dt, std::true_type) {
+            BehaviourBatch<T> batch{ entities.data(), items.data(), items.size() };
+            if (w.behaviourExceptionPolicy_ == BehaviourExceptionPolicy::Propagate) {
+                T::UpdateBatch(w, batch, dt);
+                return items.size() - tombstones;
+            }
+            try {
+                T::UpdateBatch(w, batch, dt);
+            } catch (const std::exception& ex) {
+                ++timing.exceptions;
+                DEBUGLOG_ERROR(std::string(typeid(T).name()) + "::UpdateBatchで例外発生: " + ex.what());
+                (void)ex;
+            }
+            return items.size() - tombstones;
+        }
+
+        /**
+         * @brief fn(0) から fn(count - 1) までを呼ぶ(例外は World の BehaviourExceptionPolicy に従う)
+         *
+         * @details
+         * CatchPerBatch は内側のループ全体を try で囲み、例外を投げた位置を報告して次の位置から入り直します。
+         * 例外は idOf(位置) のエンティティのものとして報告します。
+         * 走査中の追加は pending に入るため、要素数は呼び出しの間変わりません。
+         */
+        template<class Fn, class IdOf>
+        void invokeEach(World& w, const char* what, size_t count, Fn&& fn, IdOf&& idOf) {
+            switch (w.behaviourExceptionPolicy_) {
+            case BehaviourExceptionPolicy::Propagate:
+                for (size_t i = 0; i < count; ++i) fn(i);
+                break;
+            case BehaviourExceptionPolicy::CatchPerBatch: {
+                size_t i = 0;
+                while (i < count) {
+                    try {
+                        for (; i < count; ++i) fn(i);
+                    } catch (const std::exception& ex) {
+                        reportException(what, idOf(i), ex);
+                        ++i;
+                    }
+                }
+                break;
+            }
+            default:
+                for (size_t i = 0; i < count; ++i) {
+                    try {
+                        fn(i);
+                    } catch (const std::exception& ex) {
+                        reportException(what, idOf(i), ex);
+                    }
+                }
+                break;
+            }
+        }
+
+        void reportException(const char* what, uint32_t id, const std::exception& ex) {
+            ++timing.exceptions;
+            DEBUGLOG_ERROR("エンティティ " + std::to_string(id) + " の " + typeid(T).name() + "::" + what + " で例外発生: " + ex.what());
+            (void)what;
+            (void)id;
+            (void)ex;
+        }
+
+        void insert(Entity e, T* obj, Cause cause, uint8_t isStarted) {
+            if (e.id >= indexOf.size()) {
+                indexOf.resize(e.id + 1, 0);
+            }
+            entities.push_back(e);
+            items.push_back(obj);
+            started.push_back(isStarted);
+            causes.push_back(cause);
+            indexOf[e.id] = static_cast<uint32_t>(items.size());
+            if (!isStarted) startQueue.push_back(e.id);
+        }
+
+        // 更新用の配列にあり OnStart 未完了なら位置、それ以外（外れた・開始済み）は SIZE_MAX
+        size_t unstartedPosition(uint32_t id) const {
+            if (id >= indexOf.size() || indexOf[id] == 0) return SIZE_MAX;
+            const size_t pos = indexOf[id] - 1;
+            return (items[pos] && !started[pos]) ? pos : SIZE_MAX;
+        }
+
+        // 更新用の配列から pos を外す（走査中は墓石のまま残し、それ以外は末尾の生きている要素で埋める）
+        void detach(size_t pos) {
+            indexOf[entities[pos].id] = 0;
+            items[pos] = nullptr;
+            ++tombstones;
+            if (iterating > 0) return;
+
+            trimTail();
+            if (pos >= items.size()) return;
+            // 末尾は生きている要素なので pos へ移す（墓石のエンティティは古いので逆引きを書き換えない）
+            size_t last = items.size() - 1;
+            entities[pos] = entities[last];
+            items[pos] = items[last];
+            started[pos] = started[last];
+            causes[pos] = causes[last];
+            indexOf[entities[pos].id] = static_cast<uint32_t>(pos + 1);
+            popBack();
+            --tombstones;
+        }
+
+        // 末尾の墓石を取り除く
+        void trimTail() {
+            while (!items.empty() && !items.back()) {
+                popBack();
+                --tombstones;
+            }
+        }
+
+        void popBack() {
+            entities.pop_back();
+            items.pop_back();
+            started.pop_back();
+            causes.pop_back();
+        }
+
+        void park(const Entry& entry) {
+            if (entry.entity.id >= parkedOf.size()) parkedOf.resize(entry.entity.id + 1, 0);
+            parked.push_back(entry);
+            parkedOf[entry.entity.id] = static_cast<uint32_t>(parked.size());
+        }
+
+        void unpark(uint32_t id) {
+            size_t pos = parkedOf[id] - 1;
+            parkedOf[id] = 0;
+            size_t last = parked.size() - 1;
+            if (pos != last) {
+                parked[pos] = parked[last];
+                parkedOf[parked[pos].entity.id] = static_cast<uint32_t>(pos + 1);
+            }
+            parked.pop_back();
+        }
+
+        void endIteration() {
+            if (--iterating > 0) return;
+
+            trimTail();
+            if (tombstones >= COMPACT_MIN_TOMBSTONES && tombstones * COMPACT_RATIO >= items.size()) {
+                size_t write = 0;
+                for (size_t read = 0; read < items.size(); ++read) {
+                    if (!items[read]) continue;
+                    entities[write] = entities[read];
+                    items[write] = items[read];
+                    started[write] = started[read];
+                    causes[write] = causes[read];
+                    indexOf[entities[write].id] = static_cast<uint32_t>(write + 1);
+                    ++write;
+                }
+                entities.resize(write);
+                items.resize(write);
+                started.resize(write);
+                causes.resize(write);
+                tombstones = 0;
+            }
+
+            for (const Entry& p : pending) {
+                insert(p.entity, p.item, p.cause, p.started);
+            }
+            pending.clear();
+        }
+    };
+
+    template<class T>
+    BehaviourGroup<T>& getBehaviourGroup() {
+        ComponentTypeId id = ComponentId<T>();
+        if (id >= behaviourGroupByType_.size()) {
+            behaviourGroupByType_.resize(id + 1, nullptr);
+        }
+        if (!behaviourGroupByType_[id]) {
+            auto* group = new BehaviourGroup<T>();
+            behaviourGroups_.push_back(std::unique_ptr<IBehaviourGroup>(group));
+            behaviourGroupByType_[id] = group;
+        }
+        return *static_cast<BehaviourGroup<T>*>(behaviourGroupByType_[id]);
+    }
+
+    size_t behaviourCount() const {
+        size_t count = 0;
+        for (auto& g : behaviourGroups_) count += g->Size();
+        return count;
+    }
+
+    // 1フレームあたりの平均時間が長い順に count 個の型をログに出す
+    void logHeaviestBehaviours(size_t count) const {
+        std::vector<BehaviourStats> stats = GetBehaviourStats();
+        std::sort(stats.begin(), stats.end(), [](const BehaviourStats& a, const BehaviourStats& b) {
+            return a.AverageMs() > b.AverageMs();
+        });
+        std::string line;
+        for (size_t i = 0; i < stats.size() && i < count; ++i) {
+            if (stats[i].frames == 0) break;
+            if (!line.empty()) line += ", ";
+            line += std::string(stats[i].name) + "=" + std::to_string(stats[i].AverageMs()) + "ms(" +
+                    std::to_string(stats[i].live) + ")";
+        }
+        if (!line.empty()) {
+            DEBUGLOG("Behaviour(平均/フレーム): " + line);
+        }
     }
 
     // Behaviour登録（原因付き）
     template<class TDerived>
     typename std::enable_if<std::is_base_of<Behaviour, TDerived>::value>::type
         registerBehaviourWithCause(Entity e, TDerived* obj, Cause cause) {
-        behaviours_.push_back({ e, obj, false, cause });
+        getBehaviourGroup<TDerived>().Add(e, obj, cause);
     }
     template<class TDerived>
     typename std::enable_if<!std::is_base_of<Behaviour, TDerived>::value>::type
@@ -893,72 +2803,567 @@ private:
     // Behaviourコンポーネントの登録を解除(C++14互換)
     template<class TDerived>
     typename std::enable_if<std::is_base_of<Behaviour, TDerived>::value>::type
-        unregisterBehaviour(Entity e, TDerived* obj) {
-        behaviours_.erase(
-            std::remove_if(behaviours_.begin(), behaviours_.end(),
-                [e, obj](const BEntry& entry) { return entry.e == e && entry.b == obj; }),
-            behaviours_.end());
+        unregisterBehaviour(Entity e, TDerived*) {
+        ComponentTypeId id = ComponentId<TDerived>();
+        if (id < behaviourGroupByType_.size() && behaviourGroupByType_[id]) {
+            behaviourGroupByType_[id]->Remove(e.id);
+        }
     }
     template<class TDerived>
     typename std::enable_if<!std::is_base_of<Behaviour, TDerived>::value>::type
         unregisterBehaviour(Entity, TDerived*) {}
 
-    struct BEntry {
-        Entity e;           ///< エンティティ
-        Behaviour* b;       ///< Behaviourへのポインタ
-        bool started = false; ///< OnStartが呼ばれたかどうか
-        Cause cause = Cause::Unknown; ///< 事象の原因タグ
+    // Prefab::Entry から呼ばれる: 型 T の初期値を entities に一括追加（クエリ通知は呼び出し側で行う）
+    template<class T>
+    void instantiateComponents(const Entity* entities, size_t count, Cause cause, const T& value) {
+        auto& s = getStore<T>();
+        s.data.Reserve(count);
+        reserveBehaviours<T>(count);
+
+        ComponentTypeId typeId = ComponentId<T>();
+        for (size_t i = 0; i < count; ++i) {
+            Entity e = entities[i];
+            T& ref = s.data.Emplace(e.id, value);
+            s.data.StampAdded(e.id, changeTick_);
+            if (typeId < MAX_COMPONENT_TYPES) {
+                if (e.id >= signatures_.size()) signatures_.resize(e.id + 1);
+                signatures_[e.id].set(typeId);
+            }
+            registerBehaviourWithCause<T>(e, &ref, cause);
+        }
+    }
+
+    // MergeFrom() から呼ばれる: 移動元のストアの型 T を移動先のIDへまとめてムーブ（クエリ通知は呼び出し側で行う）
+    template<class T>
+    size_t mergeComponents(Store<T>& source, const EntityRemap& remap, Cause cause) {
+        if constexpr (!std::is_move_constructible<T>::value) {
+            DEBUGLOG_WARNING("コンポーネント " + std::string(typeid(T).name()) + " はムーブできないため MergeFrom() で移しません");
+            return 0;
+        } else {
+            if (source.data.Size() == 0) return 0;
+            auto& s = getStore<T>();
+            s.data.Reserve(source.data.Size());
+            reserveBehaviours<T>(source.data.Size());
+
+            const ComponentTypeId typeId = ComponentId<T>();
+            const auto* remapFn = typeId < entityRemaps_.size() && entityRemaps_[typeId] ? &entityRemaps_[typeId] : nullptr;
+            size_t moved = 0;
+            source.data.ForEach([&](uint32_t id, T& item) {
+                const Entity e = remap.Find(id);
+                if (e.id == 0) return; // 休止中のプールのエンティティなど、移さないもの
+                T& ref = s.data.Emplace(e.id, std::move(item));
+                s.data.StampAdded(e.id, changeTick_);
+                if (typeId < MAX_COMPONENT_TYPES) signatures_[e.id].set(typeId);
+                if (remapFn) (*remapFn)(&ref, remap);
+                registerBehaviourWithCause<T>(e, &ref, cause);
+                moved++;
+            });
+            return moved;
+        }
+    }
+
+    template<class TDerived>
+    typename std::enable_if<std::is_base_of<Behaviour, TDerived>::value>::type
+        reserveBehaviours(size_t count) {
+        getBehaviourGroup<TDerived>().Reserve(count);
+    }
+    template<class TDerived>
+    typename std::enable_if<!std::is_base_of<Behaviour, TDerived>::value>::type
+        reserveBehaviours(size_t) {}
 
-        bool operator==(const BEntry& other) const {
-            return e == other.e && b == other.b;
+    // 型IDを指定してコンポーネントを削除（Behaviourなら先に登録解除）。解除したBehaviour数を返す
+    size_t eraseComponent(uint32_t id, size_t typeId) {
+        size_t removed = 0;
+        if (typeId < behaviourGroupByType_.size() && behaviourGroupByType_[typeId]) {
+            if (behaviourGroupByType_[typeId]->Remove(id)) removed = 1;
+        }
+        if (stores_[typeId]) {
+            stores_[typeId]->Erase(id);
         }
+        return removed;
+    }
+
+    /**
+     * @struct HierarchyLink
+     * @brief 親子関係のリンク(EntityID で引く。0 はなし)
+     */
+    struct HierarchyLink {
+        uint32_t parent = 0;
+        uint32_t firstChild = 0;
+        uint32_t lastChild = 0;
+        uint32_t prevSibling = 0;
+        uint32_t nextSibling = 0;
+        uint32_t childCount = 0;
     };
 
+    const HierarchyLink& hierarchyOf(uint32_t id) const {
+        static const HierarchyLink none;
+        return id < hierarchy_.size() ? hierarchy_[id] : none;
+    }
+
+    // 親の一覧から id を外す
+    void unlinkFromParent(uint32_t id) {
+        if (id >= hierarchy_.size() || hierarchy_[id].parent == 0) return;
+        HierarchyLink& link = hierarchy_[id];
+        HierarchyLink& owner = hierarchy_[link.parent];
+        if (link.prevSibling != 0) hierarchy_[link.prevSibling].nextSibling = link.nextSibling;
+        else owner.firstChild = link.nextSibling;
+        if (link.nextSibling != 0) hierarchy_[link.nextSibling].prevSibling = link.prevSibling;
+        else owner.lastChild = link.prevSibling;
+        --owner.childCount;
+        link.parent = 0;
+        link.prevSibling = 0;
+        link.nextSibling = 0;
+    }
+
+    // 破棄・休止するエンティティの親子関係を解除（子はルートに戻る）
+    void unlinkHierarchy(uint32_t id) {
+        if (id >= hierarchy_.size()) return;
+        unlinkFromParent(id);
+        HierarchyLink& link = hierarchy_[id];
+        for (uint32_t child = link.firstChild; child != 0;) {
+            HierarchyLink& childLink = hierarchy_[child];
+            const uint32_t next = childLink.nextSibling;
+            childLink.parent = 0;
+            childLink.prevSibling = 0;
+            childLink.nextSibling = 0;
+            child = next;
+        }
+        link.firstChild = 0;
+        link.lastChild = 0;
+        link.childCount = 0;
+    }
+
     // 内部破棄: 世代インクリメント + フリーIDは次フレームまで保留
     void DestroyEntityInternal(uint32_t id, Cause cause = Cause::Unknown) {
-        DEBUGLOG("エンティティ破棄中 (ID: " + std::to_string(id) + ", 原因=" + CauseToString(cause) + ")");
-
-        // Behaviourリストから該当IDを除去
-        size_t behaviourCount = behaviours_.size();
-        behaviours_.erase(
-            std::remove_if(behaviours_.begin(), behaviours_.end(),
-                [id](const BEntry& entry) { return entry.e.id == id; }),
-            behaviours_.end());
-        size_t removedBehaviours = behaviourCount - behaviours_.size();
+        WORLD_WRITE_ACCESS("DestroyEntity");
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "エンティティ破棄中 (ID: {}, 原因={})", id, CauseToString(cause));
+
+        // シグネチャに立っている型だけを削除（全ストア・全Behaviourの走査はしない）
+        size_t removedBehaviours = 0;
+        if (id < signatures_.size() && signatures_[id].any()) {
+            const ComponentMask signature = signatures_[id];
+            const size_t limit = (std::min)(stores_.size(), static_cast<size_t>(MAX_COMPONENT_TYPES));
+            for (size_t typeId = 0; typeId < limit; ++typeId) {
+                if (signature.test(typeId)) {
+                    removedBehaviours += eraseComponent(id, typeId);
+                }
+            }
+        }
+
+        // マスク上限を超えた型はシグネチャに載らないため個別に確認
+        for (size_t typeId = MAX_COMPONENT_TYPES; typeId < stores_.size(); ++typeId) {
+            removedBehaviours += eraseComponent(id, typeId);
+        }
+
         if (removedBehaviours > 0) {
-            DEBUGLOG("エンティティ " + std::to_string(id) + " から " + std::to_string(removedBehaviours) + " 個のビヘイビアを削除");
+            DEBUGLOG_FMT(DebugLog::Category::ECS, "エンティティ {} から {} 個のビヘイビアを削除", id, removedBehaviours);
+        }
+
+        if (id < disabled_.size()) disabled_[id].reset();
+        if (id < signatures_.size()) {
+            signatures_[id].reset();
+            notifyQueries(id);
         }
 
-        // 全コンポーネント削除
-        for (auto& er : erasers_) { er(Entity{ id, 0 }); }
+        // 親の一覧から外し、子はルートに戻す
+        unlinkHierarchy(id);
 
         // 生存フラグを削除
-        alive_.erase(id);
+        setAliveBit(id, false);
 
         // 世代インクリメント（古いハンドル無効化）
         if (id >= generations_.size()) generations_.resize(id + 1, 1);
-        generations_[id]++;
+        generations_[id] = Entity::NextGeneration(generations_[id]);
 
         // 再利用は次フレーム以降
         freeIdsPending_.push_back(id);
+        if (id < poolOf_.size()) poolOf_[id] = nullptr;
+
+        if (destroyedEvents_) {
+            destroyedEvents_->Send(EntityDestroyedEvent{ Entity{ id, Entity::PreviousGeneration(generations_[id]) }, cause });
+        }
 
         // メトリクス
         totalDestroyed_++;
         if (trackFrameAccounting_) { destroyedThisFrame_++; }
 
-        DEBUGLOG("エンティティ破棄成功 (ID: " + std::to_string(id) + ", 総生存数: " + std::to_string(alive_.size()) + ")");
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "エンティティ破棄成功 (ID: {}, 総生存数: {})", id, aliveCount_);
+    }
+
+    // Prefab::Entry から呼ばれる: プールから再利用する entity の型 T を初期値のコピーに戻す（クエリ通知は呼び出し側で行う）
+    template<class T>
+    void resetComponent(Entity e, Cause cause, const T& value) {
+        auto& s = getStore<T>();
+        T* ref = s.data.Find(e.id);
+        if (ref) {
+            // スロットはそのままで作り直す（代入できない型にも対応）
+            ref->~T();
+            ref = new (ref) T(value);
+        } else {
+            // 有効な間に Remove された型は追加し直す
+            ref = &s.data.Emplace(e.id, value);
+            ComponentTypeId typeId = ComponentId<T>();
+            if (typeId < MAX_COMPONENT_TYPES) {
+                if (e.id >= signatures_.size()) signatures_.resize(e.id + 1);
+                signatures_[e.id].set(typeId);
+            }
+        }
+        s.data.StampAdded(e.id, changeTick_);
+        registerBehaviourWithCause<T>(e, ref, cause);
+    }
+
+    // EntityPool::Spawn() の実装: 休止中のものを再利用し、足りない分をプレハブから生成
+    std::vector<Entity> spawnFromPool(EntityPool& pool, size_t count, Cause cause) {
+        std::vector<Entity> entities;
+        if (count == 0) return entities;
+        if (parallelDepth_ > 0) {
+            DEBUGLOG_ERROR("ParallelForEach中にプールからの生成を試行 (CommandBufferを使用してください)");
+            throw std::runtime_error("EntityPool::Spawn during ParallelForEach");
+        }
+        WORLD_WRITE_ACCESS("EntityPool::Spawn");
+        entities.reserve(count);
+
+        const size_t reused = (std::min)(count, pool.dormant_.size());
+        {
+            std::lock_guard<std::mutex> lock(entityMutex_);
+            for (size_t i = 0; i < reused; ++i) {
+                uint32_t id = pool.dormant_.back();
+                pool.dormant_.pop_back();
+                setAliveBit(id, true);
+                entities.push_back(Entity{ id, generations_[id] });
+            }
+            totalCreated_ += reused;
+            if (trackFrameAccounting_) { createdThisFrame_ += static_cast<uint32_t>(reused); }
+            if (aliveCount_ > maxAlive_) maxAlive_ = aliveCount_;
+        }
+
+        for (size_t i = 0; i < reused; ++i) {
+            for (auto& entry : pool.prefab_.entries_) {
+                entry->Reset(*this, entities[i], cause);
+            }
+            notifyQueries(entities[i].id);
+        }
+
+        const size_t fresh = count - reused;
+        if (fresh > 0) {
+            std::vector<Entity> created = Instantiate(pool.prefab_, fresh, cause);
+            for (Entity e : created) {
+                if (e.id >= poolOf_.size()) poolOf_.resize(e.id + 1, nullptr);
+                poolOf_[e.id] = &pool;
+            }
+            entities.insert(entities.end(), created.begin(), created.end());
+        }
+
+        pool.active_ += entities.size();
+        pool.stats_.spawned += entities.size();
+        pool.stats_.reused += reused;
+        pool.stats_.created += entities.size() - reused;
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "プールから生成: {} 個 (再利用: {}, 原因={})", entities.size(), reused, CauseToString(cause));
+        return entities;
+    }
+
+    // EntityPool::Prewarm() の実装: 休止中の数が count になるまで生成して休止させる
+    void prewarmPool(EntityPool& pool, size_t count) {
+        if (pool.dormant_.size() >= count) return;
+        std::vector<Entity> created = Instantiate(pool.prefab_, count - pool.dormant_.size(), Cause::Unknown);
+        for (Entity e : created) {
+            if (e.id >= poolOf_.size()) poolOf_.resize(e.id + 1, nullptr);
+            poolOf_[e.id] = &pool;
+            sleepPooledEntity(pool, e.id);
+        }
+    }
+
+    // 破棄要求されたプールのエンティティを休止させる（容量を超える場合は実際に破棄）
+    void releaseToPool(EntityPool& pool, uint32_t id, Cause cause) {
+        if (pool.active_ > 0) pool.active_--;
+        if (pool.capacity_ > 0 && pool.dormant_.size() >= pool.capacity_) {
+            pool.stats_.discarded++;
+            DestroyEntityInternal(id, cause);
+            return;
+        }
+
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "エンティティをプールへ戻す (ID: {}, 原因={})", id, CauseToString(cause));
+        sleepPooledEntity(pool, id);
+        pool.stats_.released++;
+        if (destroyedEvents_) {
+            destroyedEvents_->Send(EntityDestroyedEvent{ Entity{ id, Entity::PreviousGeneration(generations_[id]) }, cause });
+        }
+    }
+
+    // 休止: プレハブにない型を削除し、残す型は Behaviour の登録だけ解除してクエリから外す
+    void sleepPooledEntity(EntityPool& pool, uint32_t id) {
+        unlinkHierarchy(id);
+        if (id < signatures_.size()) {
+            const ComponentMask signature = signatures_[id];
+            const size_t limit = (std::min)(stores_.size(), static_cast<size_t>(MAX_COMPONENT_TYPES));
+            for (size_t typeId = 0; typeId < limit; ++typeId) {
+                if (!signature.test(typeId)) continue;
+                if (pool.prefab_.hasType(static_cast<ComponentTypeId>(typeId))) {
+                    unregisterBehaviourById(id, typeId);
+                } else {
+                    eraseComponent(id, typeId);
+                    signatures_[id].reset(typeId);
+                }
+            }
+        }
+        for (size_t typeId = MAX_COMPONENT_TYPES; typeId < stores_.size(); ++typeId) {
+            if (pool.prefab_.hasType(static_cast<ComponentTypeId>(typeId))) {
+                unregisterBehaviourById(id, typeId);
+            } else {
+                eraseComponent(id, typeId);
+            }
+        }
+
+        // シグネチャは再利用時のために残し、クエリには空として通知する（無効状態は解除）
+        if (id < disabled_.size()) disabled_[id].reset();
+        const ComponentMask none;
+        for (auto& q : queries_) {
+            q->OnSignatureChanged(id, none);
+        }
+
+        setAliveBit(id, false);
+        if (id >= generations_.size()) generations_.resize(id + 1, 1);
+        generations_[id] = Entity::NextGeneration(generations_[id]);
+        pool.dormant_.push_back(id);
+
+        // 生存数の会計上は破棄として数える（再利用時に作成として数える）
+        totalDestroyed_++;
+        if (trackFrameAccounting_) { destroyedThisFrame_++; }
+    }
+
+    // EntityPool::Clear() の実装: 休止中のエンティティを実際に破棄
+    void clearPool(EntityPool& pool) {
+        for (uint32_t id : pool.dormant_) {
+            if (id < signatures_.size() && signatures_[id].any()) {
+                const ComponentMask signature = signatures_[id];
+                const size_t limit = (std::min)(stores_.size(), static_cast<size_t>(MAX_COMPONENT_TYPES));
+                for (size_t typeId = 0; typeId < limit; ++typeId) {
+                    if (signature.test(typeId)) eraseComponent(id, typeId);
+                }
+                signatures_[id].reset();
+            }
+            for (size_t typeId = MAX_COMPONENT_TYPES; typeId < stores_.size(); ++typeId) {
+                eraseComponent(id, typeId);
+            }
+            generations_[id] = Entity::NextGeneration(generations_[id]);
+            freeIdsPending_.push_back(id);
+            if (id < poolOf_.size()) poolOf_[id] = nullptr;
+        }
+        DEBUGLOG_FMT(DebugLog::Category::ECS, "プールの休止中エンティティを破棄: {} 個", pool.dormant_.size());
+        pool.dormant_.clear();
+    }
+
+    void unregisterBehaviourById(uint32_t id, size_t typeId) {
+        if (typeId < behaviourGroupByType_.size() && behaviourGroupByType_[typeId]) {
+            behaviourGroupByType_[typeId]->Remove(id);
+        }
+    }
+
+    /**
+     * @struct SnapshotType
+     * @brief スナップショットに含める1つの型（型ごとの関数は登録時に実体化）
+     */
+    struct SnapshotType {
+        std::string name;                                                   ///< スナップショット内の名前
+        uint32_t elementSize;                                               ///< 1要素のバイト数（SNAPSHOT_VARIABLE_SIZE は要素ごとの関数）
+        std::function<void(const void*, SnapshotWriter&)> saveElement;      ///< 要素ごとの書き込み
+        std::function<bool(SnapshotReader&, void*)> loadElement;            ///< 要素ごとの読み込み
+        size_t (*save)(World&, const SnapshotType&, SnapshotWriter&);       ///< セクションの書き込み
+        std::shared_ptr<void> (*decode)(const SnapshotType&, uint32_t, const uint8_t*, uint32_t); ///< 要素ごとの読み込みの事前検証
+        size_t (*load)(World&, const SnapshotType&, uint32_t, const uint8_t*, const uint8_t*, void*); ///< セクションの反映
+        size_t (*transfer)(World&, World&, const Entity*, const Entity*, size_t, Cause); ///< 別の World からの移動
+    };
+
+    template<class T>
+    void registerSnapshotType(const std::string& name, uint32_t elementSize,
+                              std::function<void(const void*, SnapshotWriter&)> saveElement,
+                              std::function<bool(SnapshotReader&, void*)> loadElement) {
+        SnapshotType type;
+        type.name = name;
+        type.elementSize = elementSize;
+        type.saveElement = std::move(saveElement);
+        type.loadElement = std::move(loadElement);
+        type.save = &saveSnapshotSection<T>;
+        type.decode = elementSize == SNAPSHOT_VARIABLE_SIZE ? &decodeSnapshotSection<T> : nullptr;
+        type.load = &loadSnapshotSection<T>;
+        type.transfer = &transferSnapshotComponents<T>;
+
+        for (SnapshotType& existing : snapshotTypes_) {
+            if (existing.name == name) {
+                existing = std::move(type);
+                return;
+            }
+        }
+        snapshotTypes_.push_back(std::move(type));
+    }
+
+    // セクションの書き込み: エンティティIDの列、続けてデータの列
+    template<class T>
+    static size_t saveSnapshotSection(World& w, const SnapshotType& type, SnapshotWriter& out) {
+        if constexpr (std::is_trivially_copyable<T>::value && !std::is_empty<T>::value) {
+            if (type.elementSize == sizeof(T)) return saveSnapshotColumns<T>(w, out);
+        }
+
+        std::vector<uint32_t> ids;
+        std::vector<const T*> items;
+        if (auto* s = w.findStore<T>()) {
+            ids.reserve(s->data.Size());
+            items.reserve(s->data.Size());
+            s->data.ForEach([&](uint32_t id, T& item) {
+                if (!w.testAliveBit(id)) return;
+                ids.push_back(id);
+                items.push_back(&item);
+            });
+        }
+
+        out.WriteU32(type.elementSize);
+        out.WriteU32(static_cast<uint32_t>(ids.size()));
+        out.WriteBytes(ids.data(), ids.size() * sizeof(uint32_t));
+        const size_t sizeAt = out.ReserveU32();
+        const size_t begin = out.Size();
+        if (type.elementSize == SNAPSHOT_VARIABLE_SIZE) {
+            for (const T* item : items) type.saveElement(item, out);
+        } else if (type.elementSize > 0) {
+            // チャンクから密な列へそのまま複写
+            uint8_t* dst = out.Append(items.size() * type.elementSize);
+            for (const T* item : items) {
+                std::memcpy(dst, item, type.elementSize);
+                dst += type.elementSize;
+            }
+        }
+        out.PatchU32(sizeAt, static_cast<uint32_t>(out.Size() - begin));
+        return ids.size();
+    }
+
+    // トリビアルにコピーできる型のセクション: 生存しているエンティティが連続する範囲ごとに ID とデータをまとめて複写
+    template<class T>
+    static size_t saveSnapshotColumns(World& w, SnapshotWriter& out) {
+        struct Run {
+            const uint32_t* ids;
+            const T* items;
+            uint32_t count;
+        };
+        std::vector<Run> runs;
+        size_t total = 0;
+        if (auto* s = w.findStore<T>()) {
+            s->data.ForEachRun([&](const uint32_t* ids, T* items, uint32_t count) {
+                uint32_t begin = 0;
+                for (uint32_t i = 0; i <= count; ++i) {
+                    if (i < count && w.testAliveBit(ids[i])) continue;
+                    if (i > begin) {
+                        runs.push_back(Run{ ids + begin, items + begin, i - begin });
+                        total += i - begin;
+                    }
+                    begin = i + 1;
+                }
+            });
+        }
+
+        out.WriteU32(static_cast<uint32_t>(sizeof(T)));
+        out.WriteU32(static_cast<uint32_t>(total));
+        uint8_t* idDst = out.Append(total * sizeof(uint32_t));
+        for (const Run& run : runs) {
+            std::memcpy(idDst, run.ids, run.count * sizeof(uint32_t));
+            idDst += run.count * sizeof(uint32_t);
+        }
+        out.WriteU32(static_cast<uint32_t>(total * sizeof(T)));
+        uint8_t* dst = out.Append(total * sizeof(T));
+        for (const Run& run : runs) {
+            std::memcpy(dst, run.items, run.count * sizeof(T));
+            dst += run.count * sizeof(T);
+        }
+        return total;
+    }
+
+    template<class T>
+    static std::shared_ptr<void> decodeSnapshotSection(const SnapshotType& type, uint32_t count, const uint8_t* data, uint32_t bytes) {
+        auto values = std::make_shared<std::vector<T>>(count);
+        SnapshotReader in(data, bytes);
+        for (T& value : *values) {
+            if (!type.loadElement(in, &value) || in.Failed()) return nullptr;
+        }
+        if (in.Remaining() != 0) return nullptr;
+        return values;
+    }
+
+    template<class T>
+    static size_t transferSnapshotComponents(World& dst, World& src, const Entity* from, const Entity* to, size_t count, Cause cause) {
+        auto* s = src.findStore<T>();
+        if (!s || s->data.Size() == 0) return 0;
+        size_t moved = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!src.isCurrentHandle(from[i])) continue;
+            T* item = s->data.Find(from[i].id);
+            if (!item) continue;
+            dst.AddWithCause<T>(to[i], cause, std::move(*item));
+            moved++;
+        }
+        return moved;
+    }
+
+    // セクションの反映（エンティティ表の復元後に呼ぶ。クエリへの通知は呼び出し側でまとめて行う）
+    template<class T>
+    static size_t loadSnapshotSection(World& w, const SnapshotType& type, uint32_t count, const uint8_t* ids, const uint8_t* data, void* decoded) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (type.elementSize != SNAPSHOT_VARIABLE_SIZE) {
+                auto& store = w.getStore<T>();
+                const ComponentTypeId typeId = ComponentId<T>();
+                store.data.Reserve(count);
+                size_t loaded = 0;
+                for (uint32_t k = 0; k < count; ++k) {
+                    uint32_t id;
+                    std::memcpy(&id, ids + k * sizeof(uint32_t), sizeof(id));
+                    if (store.data.Contains(id)) continue;
+                    if constexpr (std::is_empty<T>::value) {
+                        store.data.Emplace(id);
+                    } else {
+                        typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer;
+                        std::memcpy(&buffer, data + static_cast<size_t>(k) * sizeof(T), sizeof(T));
+                        store.data.Emplace(id, *reinterpret_cast<const T*>(&buffer));
+                    }
+                    store.data.StampAdded(id, w.changeTick_);
+                    if (typeId < MAX_COMPONENT_TYPES) w.signatures_[id].set(typeId);
+                    loaded++;
+                }
+                return loaded;
+            }
+        }
+
+        // 要素ごとの関数で組み立てた値を Add と同じ経路で追加（Behaviour の登録を含む）
+        auto& values = *static_cast<std::vector<T>*>(decoded);
+        for (uint32_t k = 0; k < count; ++k) {
+            uint32_t id;
+            std::memcpy(&id, ids + k * sizeof(uint32_t), sizeof(id));
+            w.AddWithCause<T>(Entity{ id, w.generations_[id] }, Cause::Unknown, std::move(values[k]));
+        }
+        return count;
     }
 
     uint32_t nextId_ = 0;
     std::vector<uint32_t> freeIdsReady_;
     std::vector<uint32_t> freeIdsPending_;
-
-    std::unordered_set<uint32_t> alive_;
-    std::unordered_map<std::type_index, IStore*> stores_;
-    std::vector<std::function<void(Entity)>> erasers_;
-    std::vector<BEntry> behaviours_;
+    std::vector<IdShard> idShards_ = std::vector<IdShard>(1); ///< [0]: メインスレッド, [1..]: ワーカー（SetJobSystem() で確保）
+
+    std::vector<uint64_t> aliveBits_;        ///< EntityID -> 生存ビット（64件/ワード）
+    size_t aliveCount_ = 0;                  ///< 生存ビットの立っている数
+    std::vector<IStore*> stores_;            ///< ComponentTypeId -> ストア（未使用の型はnullptr）
+    std::vector<ComponentMask> signatures_;  ///< EntityID -> 所持コンポーネントのビットマスク
+    std::vector<ComponentMask> disabled_;    ///< EntityID -> 無効化されたコンポーネントのビットマスク（シグネチャの部分集合）
+    std::vector<std::unique_ptr<QueryBase>> queries_; ///< キャッシュ済みクエリ
+    std::vector<std::unique_ptr<IBehaviourGroup>> behaviourGroups_; ///< 型ごとのBehaviour（最初に追加された型順に更新）
+    std::vector<IBehaviourGroup*> behaviourGroupByType_;            ///< ComponentTypeId -> グループ
+    bool behaviourTimingEnabled_ = false;                           ///< Behaviour の型ごとの時間を計測するか
+#ifdef _DEBUG
+    BehaviourExceptionPolicy behaviourExceptionPolicy_ = BehaviourExceptionPolicy::Catch;         ///< Behaviour の例外の扱い
+#else
+    BehaviourExceptionPolicy behaviourExceptionPolicy_ = BehaviourExceptionPolicy::CatchPerBatch; ///< Behaviour の例外の扱い
+#endif
 
     std::vector<uint32_t> generations_{1};
+    std::vector<HierarchyLink> hierarchy_;   ///< EntityID -> 親子関係のリンク（SetParent() で拡張）
+
+    uint32_t changeTick_ = 1;                ///< 変更検出用ティック（0は「記録なし」）
 
     // メトリクス
     uint64_t frameCount_ = 0;
@@ -975,6 +3380,21 @@ private:
     uint32_t recentCreated_ = 0;
     uint32_t recentDestroyed_ = 0;
     size_t windowAliveStart_ = 0;
+    float lastDt_ = 0.0f;
+
+    /**
+     * @struct MetricsWindow
+     * @brief 完了したフレーム窓の集計(WorldStats の window*)
+     */
+    struct MetricsWindow {
+        uint32_t frames = 0;
+        uint32_t created = 0;
+        uint32_t destroyed = 0;
+        float dtAvg = 0.0f;
+        float dtMin = 0.0f;
+        float dtMax = 0.0f;
+    };
+    MetricsWindow lastWindow_;
 
     // 今フレームの作成/破棄数
     uint32_t createdThisFrame_ = 0;
@@ -1001,9 +3421,577 @@ private:
     // システム停止フラグ（新規Spawn無効化）
     bool systemsStopped_ = false;
 
+    // 並列走査（ParallelForEach）
+    JobSystem* jobSystem_ = nullptr;  // 所有しない
+    std::atomic<int> parallelDepth_{ 0 }; // 読み取りフェーズ（並列区間）の深さ（>0 の間は構造変更禁止）
+
+#ifdef _DEBUG
+    // 構造変更の競合検出（WORLD_WRITE_ACCESS）
+    std::atomic<std::thread::id> writerThread_{};  // 構造変更中のスレッド（なければ既定値）
+    int writerDepth_ = 0;                           // writerThread_ の入れ子深さ
+    std::atomic<std::thread::id> tickThread_{};    // Tick() を実行中のスレッド
+
+    /**
+     * @brief 構造変更の区間(入れ子可)。別スレッドと重なった場合と、Tick() 中に別スレッドから呼ばれた場合にエラーを出す
+     */
+    class WriteAccessCheck {
+    public:
+        WriteAccessCheck(World& world, const char* operation) : world_(world) {
+            const std::thread::id self = std::this_thread::get_id();
+            const std::thread::id ticking = world_.tickThread_.load(std::memory_order_relaxed);
+            if (ticking != std::thread::id() && ticking != self) {
+                DEBUGLOG_ERROR(std::string("Tick() 中に別スレッドから World の構造変更: ") + operation +
+                               " (CommandBuffer / EnqueueSpawn を使用してください)");
+            }
+            std::thread::id expected{};
+            if (!world_.writerThread_.compare_exchange_strong(expected, self, std::memory_order_acquire) && expected != self) {
+                DEBUGLOG_ERROR(std::string("World の構造変更が別スレッドと同時に実行されました: ") + operation);
+                assert(false && "World structural change raced with another thread");
+                return;
+            }
+            owner_ = true;
+            ++world_.writerDepth_;
+        }
+
+        ~WriteAccessCheck() {
+            if (owner_ && --world_.writerDepth_ == 0) {
+                world_.writerThread_.store(std::thread::id(), std::memory_order_release);
+            }
+        }
+
+        WriteAccessCheck(const WriteAccessCheck&) = delete;
+        WriteAccessCheck& operator=(const WriteAccessCheck&) = delete;
+
+    private:
+        World& world_;
+        bool owner_ = false;
+    };
+
+    /**
+     * @brief Tick() を実行中のスレッドを記録する(例外で抜けた場合も戻す)
+     */
+    struct TickThreadScope {
+        explicit TickThreadScope(World& world) : world_(world) {
+            world_.tickThread_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+        ~TickThreadScope() { world_.tickThread_.store(std::thread::id(), std::memory_order_relaxed); }
+        World& world_;
+    };
+#endif
+
+    /**
+     * @brief Behaviour とシステムの更新中であることを記録する(例外で抜けた場合も戻す)
+     */
+    struct UpdateScope {
+        explicit UpdateScope(World& world) : world_(world) { world_.inUpdate_ = true; }
+        ~UpdateScope() { world_.inUpdate_ = false; }
+        World& world_;
+    };
+
+    // 登録システム
+    SystemScheduler scheduler_;
+
+    // スレッドごとのコマンドバッファ（[0]: メインスレッド, [1..]: ワーカー）
+    std::vector<std::unique_ptr<CommandBuffer>> commandBuffers_ = makeCommandBuffers();
+
+    // キー型ごとのエンティティプール（EntityID -> 所属プールは poolOf_）
+    std::vector<std::pair<const void*, std::unique_ptr<EntityPool>>> pools_;
+    std::vector<EntityPool*> poolOf_;
+
+    // 非同期タスク（Tick中にBehaviourの後で再開）
+    TaskScheduler tasks_;
+
+    // 遅延コールバック・遅延破棄（Tick中にタスクの前で進める）
+    TimerWheel timerWheel_;
+
+    // 型ごとのイベントチャネル（Tick開始時に読み取り側へ切り替え）
+    std::vector<std::unique_ptr<EventChannelBase>> eventChannels_;
+    EventChannel<EntityDestroyedEvent>* destroyedEvents_ = nullptr; ///< 作成済みなら破棄時に送信
+
+    // スナップショットに含める型（名前で対応付け）
+    std::vector<SnapshotType> snapshotTypes_;
+    std::vector<std::function<void(void*, const EntityRemap&)>> entityRemaps_; ///< ComponentTypeId -> Entity の付け替え（MergeFrom()）
+    SnapshotStats snapshotStats_;
+
+    static std::vector<std::unique_ptr<CommandBuffer>> makeCommandBuffers() {
+        std::vector<std::unique_ptr<CommandBuffer>> buffers;
+        buffers.push_back(std::unique_ptr<CommandBuffer>(new CommandBuffer()));
+        return buffers;
+    }
+
     friend class EntityBuilder;
+    friend class SystemScheduler;
+    friend class Prefab;
+    friend class EntityPool;
 };
 
+/**
+ * @brief World::Serialize() の実装
+ */
+inline bool World::Serialize(std::vector<uint8_t>& out, const SnapshotOptions& options) {
+    if (parallelDepth_ > 0) {
+        DEBUGLOG_ERROR("並列区間中にスナップショットの書き出しを試行");
+        return false;
+    }
+    const auto start = std::chrono::high_resolution_clock::now();
+    snapshotStats_ = SnapshotStats();
+
+    // 本体: エンティティ表とコンポーネント型ごとのセクション
+    std::vector<uint8_t> body;
+    SnapshotWriter writer(body);
+    writer.WriteU32(nextId_);
+    // IDキャッシュへブロック単位で確保した分は世代表がまだ広がっていないため、nextId_ まで世代 1 で埋める
+    const size_t generationCount = (std::max)(generations_.size(), static_cast<size_t>(nextId_) + 1);
+    writer.WriteU32(static_cast<uint32_t>(generationCount));
+    writer.WriteBytes(generations_.data(), generations_.size() * sizeof(uint32_t));
+    for (size_t id = generations_.size(); id < generationCount; ++id) writer.WriteU32(1);
+    writer.WriteU32(static_cast<uint32_t>(aliveBits_.size()));
+    writer.WriteBytes(aliveBits_.data(), aliveBits_.size() * sizeof(uint64_t));
+
+    writer.WriteU32(static_cast<uint32_t>(snapshotTypes_.size()));
+    for (const SnapshotType& type : snapshotTypes_) {
+        writer.WriteString(type.name);
+        snapshotStats_.components += type.save(*this, type, writer);
+    }
+    snapshotStats_.sections = snapshotTypes_.size();
+
+    // 親子関係(親ごとに子の順で、子と親のID)
+    std::vector<uint32_t> links;
+    for (uint32_t id = 1; id < hierarchy_.size(); ++id) {
+        if (!testAliveBit(id)) continue;
+        for (uint32_t child = hierarchy_[id].firstChild; child != 0; child = hierarchy_[child].nextSibling) {
+            links.push_back(child);
+            links.push_back(id);
+        }
+    }
+    writer.WriteU32(static_cast<uint32_t>(links.size() / 2));
+    writer.WriteBytes(links.data(), links.size() * sizeof(uint32_t));
+
+    // ヘッダ + 本体（必要なら圧縮）
+    const bool compress = options.compress && !body.empty();
+    out.clear();
+    SnapshotWriter header(out);
+    header.WriteU32(SNAPSHOT_MAGIC);
+    header.WriteU16(SNAPSHOT_VERSION);
+    header.WriteU16(compress ? SNAPSHOT_FLAG_LZ4 : 0);
+    header.WriteU32(static_cast<uint32_t>(body.size()));
+    const size_t storedAt = header.ReserveU32();
+    const size_t bodyStart = out.size();
+    if (compress) {
+        util::Lz4::Compress(body.data(), body.size(), out);
+    } else {
+        out.insert(out.end(), body.begin(), body.end());
+    }
+    header.PatchU32(storedAt, static_cast<uint32_t>(out.size() - bodyStart));
+
+    snapshotStats_.entities = aliveCount_;
+    snapshotStats_.rawBytes = body.size();
+    snapshotStats_.storedBytes = out.size();
+    snapshotStats_.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    DEBUGLOG_CATEGORY(DebugLog::Category::ECS, "スナップショットを書き出し (エンティティ: " + std::to_string(aliveCount_) +
+                      ", コンポーネント: " + std::to_string(snapshotStats_.components) +
+                      ", " + std::to_string(body.size()) + " -> " + std::to_string(out.size()) + " バイト)");
+    return true;
+}
+
+/**
+ * @brief World::Deserialize() の実装
+ *
+ * @details
+ * 先に全体を検証してから World を変更するため、途中で失敗して一部だけ読み込まれることはありません。
+ */
+inline bool World::Deserialize(const uint8_t* data, size_t size) {
+    if (parallelDepth_ > 0) {
+        DEBUGLOG_ERROR("並列区間中にスナップショットの読み込みを試行");
+        return false;
+    }
+    WORLD_WRITE_ACCESS("Deserialize");
+    if (aliveCount_ != 0 || GetDormantEntityCount() != 0) {
+        DEBUGLOG_ERROR("スナップショットは生存エンティティのない World にだけ読み込めます (生存数: " + std::to_string(aliveCount_) + ")");
+        return false;
+    }
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // ヘッダ
+    SnapshotReader header(data, size);
+    const uint32_t magic = header.ReadU32();
+    const uint16_t version = header.ReadU16();
+    const uint16_t flags = header.ReadU16();
+    const uint32_t rawSize = header.ReadU32();
+    const uint32_t storedSize = header.ReadU32();
+    const uint8_t* stored = header.Skip(storedSize);
+    if (header.Failed() || magic != SNAPSHOT_MAGIC) {
+        DEBUGLOG_ERROR("スナップショットの形式が不正です");
+        return false;
+    }
+    if (version == 0 || version > SNAPSHOT_VERSION) {
+        DEBUGLOG_ERROR("対応していないスナップショットのバージョンです: " + std::to_string(version));
+        return false;
+    }
+
+    std::vector<uint8_t> decompressed;
+    const uint8_t* body = stored;
+    if (flags & SNAPSHOT_FLAG_LZ4) {
+        decompressed.resize(rawSize);
+        if (util::Lz4::Decompress(stored, storedSize, decompressed.data(), decompressed.size()) != rawSize) {
+            DEBUGLOG_ERROR("スナップショットの展開に失敗しました");
+            return false;
+        }
+        body = decompressed.data();
+    } else if (rawSize != storedSize) {
+        DEBUGLOG_ERROR("スナップショットのサイズが一致しません");
+        return false;
+    }
+
+    // エンティティ表
+    SnapshotReader reader(body, rawSize);
+    const uint32_t maxId = reader.ReadU32();
+    const uint32_t generationCount = reader.ReadU32();
+    const uint8_t* generations = reader.Skip(static_cast<size_t>(generationCount) * sizeof(uint32_t));
+    const uint32_t wordCount = reader.ReadU32();
+    const uint8_t* words = reader.Skip(static_cast<size_t>(wordCount) * sizeof(uint64_t));
+    if (reader.Failed() || generationCount <= maxId || static_cast<size_t>(wordCount) * 64 > static_cast<size_t>(maxId) + 64) {
+        DEBUGLOG_ERROR("スナップショットのエンティティ表が不正です");
+        return false;
+    }
+
+    std::vector<uint64_t> alive(wordCount);
+    std::memcpy(alive.data(), words, alive.size() * sizeof(uint64_t));
+    auto isAlive = [&alive, maxId](uint32_t id) {
+        return id != 0 && id <= maxId && id / 64 < alive.size() && ((alive[id / 64] >> (id % 64)) & 1u) != 0;
+    };
+
+    // セクション（先に全体を検証する）
+    struct Section {
+        const SnapshotType* type;
+        uint32_t elementSize;
+        uint32_t count;
+        const uint8_t* ids;
+        const uint8_t* data;
+        uint32_t dataBytes;
+    };
+    std::vector<Section> sections;
+    size_t skipped = 0;
+    const uint32_t sectionCount = reader.ReadU32();
+    for (uint32_t i = 0; i < sectionCount && !reader.Failed(); ++i) {
+        Section section{};
+        const std::string name = reader.ReadString();
+        section.elementSize = reader.ReadU32();
+        section.count = reader.ReadU32();
+        section.ids = reader.Skip(static_cast<size_t>(section.count) * sizeof(uint32_t));
+        section.dataBytes = reader.ReadU32();
+        section.data = reader.Skip(section.dataBytes);
+        if (reader.Failed()) break;
+
+        for (uint32_t k = 0; k < section.count; ++k) {
+            uint32_t id;
+            std::memcpy(&id, section.ids + k * sizeof(uint32_t), sizeof(id));
+            if (!isAlive(id)) {
+                DEBUGLOG_ERROR("スナップショットのセクション " + name + " に生存していないエンティティがあります (ID: " + std::to_string(id) + ")");
+                return false;
+            }
+        }
+
+        section.type = nullptr;
+        for (const SnapshotType& type : snapshotTypes_) {
+            if (type.name == name) { section.type = &type; break; }
+        }
+        if (!section.type) {
+            DEBUGLOG_WARNING("スナップショットの未登録の型を読み飛ばします: " + name);
+            skipped++;
+            continue;
+        }
+        if (section.type->elementSize != section.elementSize ||
+            (section.elementSize != SNAPSHOT_VARIABLE_SIZE &&
+             static_cast<size_t>(section.elementSize) * section.count != section.dataBytes)) {
+            DEBUGLOG_WARNING("スナップショットの型 " + name + " は大きさが一致しないため読み飛ばします (保存時: " +
+                             std::to_string(section.elementSize) + ", 現在: " + std::to_string(section.type->elementSize) + ")");
+            skipped++;
+            continue;
+        }
+        sections.push_back(section);
+    }
+    if (reader.Failed()) {
+        DEBUGLOG_ERROR("スナップショットのセクションが不正です");
+        return false;
+    }
+
+    // 親子関係(バージョン 2 から)
+    uint32_t linkCount = 0;
+    const uint8_t* links = nullptr;
+    if (version >= 2) {
+        linkCount = reader.ReadU32();
+        links = reader.Skip(static_cast<size_t>(linkCount) * 2 * sizeof(uint32_t));
+        if (reader.Failed()) {
+            DEBUGLOG_ERROR("スナップショットの親子関係が不正です");
+            return false;
+        }
+        for (uint32_t k = 0; k < linkCount * 2; ++k) {
+            uint32_t id;
+            std::memcpy(&id, links + k * sizeof(uint32_t), sizeof(id));
+            if (!isAlive(id)) {
+                DEBUGLOG_ERROR("スナップショットの親子関係に生存していないエンティティがあります (ID: " + std::to_string(id) + ")");
+                return false;
+            }
+        }
+    }
+
+    // 要素ごとの読み込み関数を使う型は、World を変更する前に値を組み立てて検証する
+    std::vector<std::shared_ptr<void>> decoded(sections.size());
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].elementSize != SNAPSHOT_VARIABLE_SIZE) continue;
+        decoded[i] = sections[i].type->decode(*sections[i].type, sections[i].count, sections[i].data, sections[i].dataBytes);
+        if (!decoded[i]) {
+            DEBUGLOG_ERROR("スナップショットの型 " + sections[i].type->name + " の読み込みに失敗しました");
+            return false;
+        }
+    }
+
+    // エンティティ表を復元（保存時のIDと世代）
+    {
+        std::lock_guard<std::mutex> lock(entityMutex_);
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex_);
+            pendingDestroy_.clear();
+        }
+        // 保存時より大きいIDの世代は残し、空きIDとして再利用する
+        if (generations_.size() < generationCount) generations_.resize(generationCount, 1);
+        std::memcpy(generations_.data(), generations, static_cast<size_t>(generationCount) * sizeof(uint32_t));
+        nextId_ = (std::max)(nextId_, maxId);
+        freeIdsReady_.clear();
+        freeIdsPending_.clear();
+        for (IdShard& shard : idShards_) shard.ids.clear();
+        std::fill(poolOf_.begin(), poolOf_.end(), nullptr);
+        for (uint32_t id = nextId_; id >= 1; --id) {
+            if (isAlive(id)) {
+                setAliveBit(id, true);
+            } else {
+                freeIdsReady_.push_back(id);
+            }
+        }
+    }
+    if (signatures_.size() < static_cast<size_t>(nextId_) + 1) signatures_.resize(static_cast<size_t>(nextId_) + 1);
+    for (ComponentMask& mask : signatures_) mask.reset();
+    for (ComponentMask& mask : disabled_) mask.reset();
+
+    totalCreated_ += aliveCount_;
+    if (trackFrameAccounting_) { createdThisFrame_ += static_cast<uint32_t>(aliveCount_); }
+    if (aliveCount_ > maxAlive_) maxAlive_ = aliveCount_;
+
+    // コンポーネント
+    size_t components = 0;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const Section& section = sections[i];
+        components += section.type->load(*this, *section.type, section.count, section.ids, section.data, decoded[i].get());
+    }
+    for (uint32_t k = 0; k < linkCount; ++k) {
+        uint32_t pair[2];
+        std::memcpy(pair, links + k * sizeof(pair), sizeof(pair));
+        SetParent(Entity{ pair[0], generations_[pair[0]] }, Entity{ pair[1], generations_[pair[1]] });
+    }
+
+    // クエリへはエンティティごとに1回だけ通知する
+    for (uint32_t id = 1; id <= maxId; ++id) {
+        if (testAliveBit(id)) notifyQueries(id);
+    }
+
+    snapshotStats_ = SnapshotStats();
+    snapshotStats_.entities = aliveCount_;
+    snapshotStats_.sections = sections.size();
+    snapshotStats_.components = components;
+    snapshotStats_.skippedSections = skipped;
+    snapshotStats_.rawBytes = rawSize;
+    snapshotStats_.storedBytes = size;
+    snapshotStats_.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    DEBUGLOG_CATEGORY(DebugLog::Category::ECS, "スナップショットを読み込み (エンティティ: " + std::to_string(aliveCount_) +
+                      ", コンポーネント: " + std::to_string(components) + ", " + std::to_string(snapshotStats_.milliseconds) + " ms)");
+    return true;
+}
+
+/**
+ * @brief SystemScheduler::Run()の実装
+ *
+ * @details
+ * ステージを順に実行し、複数のシステムを含むステージは先頭を呼び出しスレッドで、
+ * 残りをジョブシステムで実行します。並列ステージ中は World の構造変更が禁止されます。
+ */
+inline void SystemScheduler::Run(World& world, JobSystem* jobs, float dt) {
+    rebuildIfDirty();
+
+    const bool parallel = jobs && jobs->IsRunning() && !world.IsInParallelRegion();
+    for (auto& stage : stages_) {
+        if (!parallel || stage.size() == 1) {
+            for (ISystem* system : stage) {
+                runOne(system, world, dt);
+            }
+            continue;
+        }
+
+        World::ReadPhaseScope readPhase(world);
+        JobSystem::JobCounter counter;
+        for (size_t i = 1; i < stage.size(); ++i) {
+            ISystem* system = stage[i];
+            jobs->Submit([system, &world, dt]() { runOne(system, world, dt); }, &counter);
+        }
+        runOne(stage[0], world, dt);
+        jobs->Wait(counter);
+    }
+}
+
+inline void SystemScheduler::runOne(ISystem* system, World& world, float dt) {
+    if (!system->IsEnabled()) return;
+    PROFILE_SCOPE(system->GetName());
+    try {
+        system->OnUpdate(world, dt);
+    } catch (const std::exception& ex) {
+        DEBUGLOG_ERROR(std::string("システム ") + system->GetName() + " のOnUpdateで例外発生: " + ex.what());
+    }
+}
+
+/**
+ * @brief EntityPool の実装（World の内部を使うため World の定義後に置く）
+ */
+inline std::vector<Entity> EntityPool::Spawn(size_t count, EntityCause cause) {
+    return world_->spawnFromPool(*this, count, cause);
+}
+
+inline void EntityPool::Prewarm(size_t count) {
+    world_->prewarmPool(*this, count);
+}
+
+inline void EntityPool::Clear() {
+    world_->clearPool(*this);
+}
+
+/**
+ * @brief TaskScheduler の実装（World の生存判定と例外の方針を使うため World の定義後に置く）
+ */
+inline void TaskScheduler::Run(World& world, float dt) {
+    PROFILE_SCOPE("TaskScheduler::Run");
+    time_ += dt;
+    resumedLastTick_ = 0;
+
+    // 前のフレームまでに NextFrame を返したもの(この Run() 中に返したものは次の Run() で再開)
+    running_.swap(nextFrame_);
+    for (TaskHandle handle : running_) {
+        resume(world, handle);
+    }
+    running_.clear();
+
+    // 時刻になったタイマーだけを取り出す(この Run() 中に入ったものは time_ より後になる)
+    while (!timers_.empty() && timers_.top().wakeTime <= time_) {
+        const TaskHandle handle = timers_.top().handle;
+        timers_.pop();
+        resume(world, handle);
+    }
+
+    // 条件待ち: 条件だけを確認し、満たしたものを再開
+    running_.swap(polling_);
+    for (TaskHandle handle : running_) {
+        if (!IsRunning(handle)) continue;
+        bool ready = false;
+        if (world.GetBehaviourExceptionPolicy() == BehaviourExceptionPolicy::Propagate) {
+            ready = slots_[handle.index].ready();
+        } else {
+            try {
+                ready = slots_[handle.index].ready();
+            } catch (const std::exception& ex) {
+                DEBUGLOG_ERROR(std::string("タスクの待ち条件で例外発生（タスクを終了）: ") + ex.what());
+                (void)ex;
+                finish(handle.index);
+                continue;
+            }
+        }
+        if (ready) {
+            slots_[handle.index].ready = nullptr;
+            resume(world, handle);
+        } else {
+            polling_.push_back(handle);
+        }
+    }
+    running_.clear();
+}
+
+inline void TaskScheduler::resume(World& world, TaskHandle handle) {
+    if (!IsRunning(handle)) return; // Cancel() 済み
+    if (slots_[handle.index].owner.gen != 0 && !world.IsAlive(slots_[handle.index].owner)) {
+        finish(handle.index);
+        return;
+    }
+    ++resumedLastTick_;
+
+    // 実行中の Start() で slots_ が再確保されても壊れないよう、関数を取り出して呼ぶ
+    Step step = std::move(slots_[handle.index].step);
+    TaskWait wait = TaskWait::Done();
+    if (world.GetBehaviourExceptionPolicy() == BehaviourExceptionPolicy::Propagate) {
+        wait = step(world);
+    } else {
+        try {
+            wait = step(world);
+        } catch (const std::exception& ex) {
+            DEBUGLOG_ERROR(std::string("タスクで例外発生（タスクを終了）: ") + ex.what());
+            (void)ex;
+        }
+    }
+    if (!IsRunning(handle)) return; // 実行中に自身を Cancel() した
+    slots_[handle.index].step = std::move(step);
+    schedule(handle, std::move(wait));
+}
+
+/**
+ * @brief TimerWheel の実装（World の生存判定と破棄を使うため World の定義後に置く）
+ */
+inline void TimerWheel::Advance(World& world, float dt) {
+    time_ += dt;
+    firedLastTick_ = 0;
+    cascadedLastTick_ = 0;
+    const uint64_t target = static_cast<uint64_t>(time_ / tickSeconds_);
+    if (pending_ == 0) {
+        // 空のスロットを回す必要はない
+        if (target > now_) now_ = target;
+        return;
+    }
+    PROFILE_SCOPE("TimerWheel::Advance");
+    while (now_ < target) {
+        ++now_;
+        // 段の境界に達したら上の段の現在のスロットを振り分け直す
+        for (uint32_t level = 1; level < LEVELS; ++level) {
+            if ((now_ >> (SLOT_BITS * (level - 1))) & SLOT_MASK) break;
+            cascade(level);
+        }
+        expire(world);
+    }
+}
+
+inline void TimerWheel::expire(World& world) {
+    const uint32_t slot = static_cast<uint32_t>(now_ & SLOT_MASK);
+    while (heads_[0][slot] != NONE) {
+        const uint32_t index = heads_[0][slot];
+        unlink(index);
+        // コールバック中の Schedule() で nodes_ が再確保されても壊れないよう、先に取り出して解放する
+        Callback callback = std::move(nodes_[index].callback);
+        const Entity target = nodes_[index].target;
+        const EntityCause cause = nodes_[index].cause;
+        release(index);
+        ++firedLastTick_;
+
+        if (!callback) {
+            if (world.IsAlive(target)) world.DestroyEntityWithCause(target, cause);
+            continue;
+        }
+        if (world.GetBehaviourExceptionPolicy() == BehaviourExceptionPolicy::Propagate) {
+            callback(world);
+            continue;
+        }
+        try {
+            callback(world);
+        } catch (const std::exception& ex) {
+            DEBUGLOG_ERROR(std::string("タイマーのコールバックで例外発生: ") + ex.what());
+            (void)ex;
+        }
+    }
+}
+
 /**
  * @brief EntityBuilder::With()の実装
  */
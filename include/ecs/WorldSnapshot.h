@@ -0,0 +1,212 @@
+#pragma once
+#include "ecs/Entity.h"
+#include "util/Lz4.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @file WorldSnapshot.h
+ * @brief World のスナップショット(バイナリ形式)の読み書き
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * World::Serialize() / World::Deserialize() が使う形式の定義と、バイト列の読み書きです。
+ *
+ * ### 形式(リトルエンディアン、境界揃えなし)
+ * - ヘッダ: "HEWS", バージョン(u16), フラグ(u16), 本体の展開後サイズ(u32), 本体のサイズ(u32)
+ * - 本体(SNAPSHOT_FLAG_LZ4 の場合は LZ4 ブロック形式で圧縮)
+ *   - エンティティ表: 最大ID(u32), 世代数(u32) + 世代[], 生存ビットのワード数(u32) + ワード[](u64)
+ *   - セクション数(u32)
+ *   - セクション(コンポーネント型ごと): 名前長(u16) + 名前, 要素サイズ(u32), 要素数(u32),
+ *     エンティティID[](u32), データのバイト数(u32) + データ
+ *   - 親子関係の数(u32) + (子のID, 親のID)[](u32、親ごとに子の順。バージョン 2 から)
+ *
+ * セクションは列指向で、トリビアルにコピーできる型は要素をそのまま密な列へ複写し、読み込みも構築関数を通さずに書き戻します。
+ * 型は ComponentId(実行順で変わる)ではなく World::RegisterSnapshotType() で付けた名前で対応付けます。
+ */
+
+/**
+ * @brief スナップショットの先頭4バイト
+ */
+constexpr uint32_t SNAPSHOT_MAGIC = 0x53574548u; // "HEWS"
+
+/**
+ * @brief スナップショットの形式バージョン(互換性のない変更で上げる。1 は親子関係なしとして読み込める)
+ */
+constexpr uint16_t SNAPSHOT_VERSION = 2;
+
+/**
+ * @brief 本体を LZ4 ブロック形式で圧縮している
+ */
+constexpr uint16_t SNAPSHOT_FLAG_LZ4 = 1u << 0;
+
+/**
+ * @brief セクションの要素サイズ: 要素ごとの保存・読み込み関数で書いた可変長データ
+ */
+constexpr uint32_t SNAPSHOT_VARIABLE_SIZE = 0xFFFFFFFFu;
+
+/**
+ * @struct SnapshotOptions
+ * @brief World::Serialize() の設定
+ */
+struct SnapshotOptions {
+    bool compress = true;  ///< 本体を LZ4 で圧縮する
+};
+
+/**
+ * @struct SnapshotStats
+ * @brief 直近の Serialize()/Deserialize() の結果
+ */
+struct SnapshotStats {
+    size_t entities = 0;        ///< 生存エンティティ数
+    size_t sections = 0;        ///< 書き込んだ・読み込んだ型の数
+    size_t components = 0;      ///< コンポーネント数
+    size_t skippedSections = 0; ///< 未登録の型のため読み飛ばしたセクション数(読み込み時)
+    size_t rawBytes = 0;        ///< 本体の展開後サイズ
+    size_t storedBytes = 0;     ///< ヘッダを含む全体のサイズ
+    double milliseconds = 0.0;  ///< 所要時間
+};
+
+/**
+ * @class SnapshotWriter
+ * @brief スナップショット本体への追記
+ */
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& out) : out_(&out) {}
+
+    void WriteBytes(const void* data, size_t size) {
+        if (size == 0) return;
+        const size_t at = out_->size();
+        out_->resize(at + size);
+        std::memcpy(out_->data() + at, data, size);
+    }
+
+    void WriteU16(uint16_t v) { WriteBytes(&v, sizeof(v)); }
+    void WriteU32(uint32_t v) { WriteBytes(&v, sizeof(v)); }
+    void WriteU64(uint64_t v) { WriteBytes(&v, sizeof(v)); }
+    void WriteFloat(float v) { WriteBytes(&v, sizeof(v)); }
+
+    /**
+     * @brief size バイトを追加し、その先頭を返す(続けて直接書き込む)
+     */
+    uint8_t* Append(size_t size) {
+        const size_t at = out_->size();
+        out_->resize(at + size);
+        return out_->data() + at;
+    }
+
+    void WriteString(const std::string& s) {
+        WriteU16(static_cast<uint16_t>(s.size()));
+        WriteBytes(s.data(), s.size());
+    }
+
+    /**
+     * @brief 後から書き換えるための領域を確保
+     * @return size_t 位置(PatchU32 に渡す)
+     */
+    size_t ReserveU32() {
+        const size_t at = out_->size();
+        WriteU32(0);
+        return at;
+    }
+
+    void PatchU32(size_t at, uint32_t v) { std::memcpy(out_->data() + at, &v, sizeof(v)); }
+
+    size_t Size() const { return out_->size(); }
+
+private:
+    std::vector<uint8_t>* out_;
+};
+
+/**
+ * @class SnapshotReader
+ * @brief スナップショット本体の読み取り(範囲外の読み取りは失敗として記録)
+ *
+ * @details
+ * 範囲を超えた読み取りは 0 を返して Failed() を立てます。
+ * 呼び出し側は区切りごとに Failed() を確認すれば十分です。
+ */
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool ReadBytes(void* out, size_t size) {
+        if (failed_ || size > size_ - pos_) {
+            failed_ = true;
+            return false;
+        }
+        if (size > 0) std::memcpy(out, data_ + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    /**
+     * @brief 複写せずに size バイト分を参照して読み進める
+     * @return const uint8_t* 先頭(範囲外の場合 nullptr)
+     */
+    const uint8_t* Skip(size_t size) {
+        if (failed_ || size > size_ - pos_) {
+            failed_ = true;
+            return nullptr;
+        }
+        const uint8_t* p = data_ + pos_;
+        pos_ += size;
+        return p;
+    }
+
+    uint16_t ReadU16() { uint16_t v = 0; ReadBytes(&v, sizeof(v)); return v; }
+    uint32_t ReadU32() { uint32_t v = 0; ReadBytes(&v, sizeof(v)); return v; }
+    uint64_t ReadU64() { uint64_t v = 0; ReadBytes(&v, sizeof(v)); return v; }
+    float ReadFloat() { float v = 0.0f; ReadBytes(&v, sizeof(v)); return v; }
+
+    std::string ReadString() {
+        const uint16_t length = ReadU16();
+        const uint8_t* p = Skip(length);
+        return p ? std::string(reinterpret_cast<const char*>(p), length) : std::string();
+    }
+
+    size_t Remaining() const { return size_ - pos_; }
+    bool Failed() const { return failed_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+/**
+ * @brief スナップショットをファイルに書き込む
+ * @return bool 成功した場合 true
+ */
+inline bool WriteSnapshotFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    FILE* fp = nullptr;
+    if (fopen_s(&fp, path.c_str(), "wb") != 0 || !fp) return false;
+    const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), fp) == bytes.size();
+    std::fclose(fp);
+    return ok;
+}
+
+/**
+ * @brief スナップショットをファイルから読み込む
+ * @return bool 成功した場合 true
+ */
+inline bool ReadSnapshotFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    FILE* fp = nullptr;
+    if (fopen_s(&fp, path.c_str(), "rb") != 0 || !fp) return false;
+    bytes.clear();
+    uint8_t buffer[64 * 1024];
+    size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+    std::fclose(fp);
+    return true;
+}
@@ -15,6 +15,9 @@
 #include "components/Transform.h"
 #include "components/MeshRenderer.h"
 #include "components/Rotator.h"
+#include "components/SpatialBody.h"
+#include "components/Collider.h"
+#include "components/GameComponents.h"
 #include "ecs/World.h"
 #include <DirectXMath.h>
 #include "util/Random.h"
@@ -29,7 +32,10 @@
  * 
  * @author 山内陽
  */
-struct EnemyTag : IComponent {};
+struct EnemyTag : ITag {};
+
+constexpr float ENEMY_FALL_SPEED = 2.0f;  ///< スポーナーが生成する敵の落下速度(MovementSystem が Velocity で移動)
+constexpr float ENEMY_DESPAWN_Y = -10.0f; ///< スポーナーが生成する敵を破棄する高さ(DespawnBelow)
 
 /**
  * @struct EnemyMovement
@@ -37,6 +43,8 @@ struct EnemyTag : IComponent {};
  * 
  * @details
  * 敵を下方向に移動させ、画面外に出たら自動的に削除します。
+ * スポーナーは Velocity と DespawnBelow を付けて MovementSystem でまとめて動かすため、
+ * このBehaviourは個別に速度を変えたい場合などに使います。
  * 
  * @par 使用例
  * @code
@@ -105,15 +113,17 @@ struct EnemySpawner : Behaviour {
     float timer = 0.0f;          ///< 内部タイマー
     float spawnY = 10.0f;        ///< スポーン位置のY座標
     float spawnRangeX = 8.0f;    ///< スポーン範囲の幅(-spawnRangeX ~ +spawnRangeX)
-    
+    uint64_t seed = 0;           ///< 乱数のシード(0 は起動ごとに変える。固定するとエンティティIDごとに同じ出現順になる)
+    util::Rng rng;               ///< このスポーナー専用の乱数
+
     /**
      * @brief 初回起動時の処理
      * @param[in,out] w ワールド参照
      * @param[in] self 自身のエンティティ
      */
     void OnStart(World& w, Entity self) override {
-        // 高品質乱数を時刻でシード（初回のみ）
-        util::Random::SeedTime();
+        // スポーナーごとの列(スレッドや他のスポーナーの呼び出し順に影響されない)
+        rng.Seed(seed != 0 ? seed : util::Random::NextSeed(), self.id);
     }
     
     /**
@@ -133,49 +143,67 @@ struct EnemySpawner : Behaviour {
     }
     
 private:
+    /**
+     * @brief 敵のプール(初回にプレハブを組み立てる。値は取り出した後に設定する)
+     */
+    static EntityPool& EnemyPool(World& w) {
+        EntityPool& pool = w.Pool<EnemySpawner>();
+        if (pool.GetPrefab().Empty()) {
+            pool.GetPrefab()
+                .With<Transform>()
+                .With<MeshRenderer>()
+                .With<EnemyTag>()
+                .With<Collider>()
+                .With<SpatialBody>(SpatialBody{ 0.5f, SpatialBody::LAYER_ENEMY, SpatialBody::LAYER_PLAYER })
+                .With<Velocity>(DirectX::XMFLOAT3{ 0.0f, -ENEMY_FALL_SPEED, 0.0f })
+                .With<DespawnBelow>(ENEMY_DESPAWN_Y)
+                .With<Rotator>();
+        }
+        return pool;
+    }
+
     /**
      * @brief ランダムな敵を生成
      * @param[in,out] w ワールド参照
      */
     void SpawnEnemy(World& w) {
         // ランダムなX座標
-        float randomX = util::Random::Float(-spawnRangeX, spawnRangeX);
+        float randomX = rng.Float(-spawnRangeX, spawnRangeX);
         
         // ランダムな形状(0-4: Cube, Sphere, Cylinder, Cone, Capsule)
-        int shapeIndex = util::Random::Int(0, 4);
+        int shapeIndex = rng.Int(0, 4);
         if (shapeIndex >= static_cast<int>(MeshType::Plane)) {
             shapeIndex++;  // Planeをスキップ
         }
         MeshType randomShape = static_cast<MeshType>(shapeIndex);
         
         // ランダムな色(明るめの色)
-        DirectX::XMFLOAT3 randomColor = util::Random::ColorBright();
+        DirectX::XMFLOAT3 randomColor = rng.ColorBright();
         
         // ランダムな回転速度
-        float randomRotSpeed = util::Random::Float(30.0f, 130.0f) * (util::Random::Bool() ? 1.0f : -1.0f);
+        float randomRotSpeed = rng.Float(30.0f, 130.0f) * (rng.Bool() ? 1.0f : -1.0f);
         
         // ランダムなスケール(0.8～1.5倍)
-        float randomScale = util::Random::Float(0.8f, 1.5f);
+        float randomScale = rng.Float(0.8f, 1.5f);
         
-        // Transform設定
-        Transform enemyTransform;
+        // プールから取り出し(破棄された敵は休止状態で戻り、ここで再利用される)
+        Entity enemy = EnemyPool(w).Spawn(1, World::Cause::Spawner)[0];
+
+        Transform& enemyTransform = w.Get<Transform>(enemy);
         enemyTransform.position = DirectX::XMFLOAT3{randomX, spawnY, 0.0f};
-        enemyTransform.rotation = DirectX::XMFLOAT3{0.0f, 0.0f, 0.0f};
         enemyTransform.scale = DirectX::XMFLOAT3{randomScale, randomScale, randomScale};
-        
-        // MeshRenderer設定
-        MeshRenderer enemyRenderer;
+
+        MeshRenderer& enemyRenderer = w.Get<MeshRenderer>(enemy);
         enemyRenderer.meshType = randomShape;
         enemyRenderer.color = randomColor;
-        
-        // 敵エンティティを作成
-        Entity enemy = w.Create()
-            .With<Transform>(enemyTransform)
-            .With<MeshRenderer>(enemyRenderer)
-            .With<EnemyTag>()
-            .WithCause<EnemyMovement>(World::Cause::Spawner)
-            .WithCause<Rotator>(World::Cause::Spawner, randomRotSpeed)
-            .Build();
+
+        // 形状に合わせた当たり判定(プレイヤーに触れたら破棄)
+        Collider& enemyCollider = w.Get<Collider>(enemy);
+        enemyCollider = Collider::FromMesh(randomShape);
+        enemyCollider.flags |= Collider::DESTROY_ON_CONTACT;
+        w.Get<SpatialBody>(enemy).radius = enemyCollider.BoundingRadius() * randomScale;
+
+        w.Get<Rotator>(enemy).speedDegY = randomRotSpeed;
     }
 };
 
@@ -202,9 +230,11 @@ struct WaveSpawner : Behaviour {
     int enemiesPerWave = 5;      ///< 1ウェーブあたりの敵数
     float timer = 0.0f;          ///< 内部タイマー
     int currentWave = 0;         ///< 現在のウェーブ番号
-    
+    uint64_t seed = 0;           ///< 乱数のシード(0 は起動ごとに変える)
+    util::Rng rng;               ///< このスポーナー専用の乱数
+
     void OnStart(World& w, Entity self) override {
-        util::Random::SeedTime();
+        rng.Seed(seed != 0 ? seed : util::Random::NextSeed(), self.id);
     }
     
     void OnUpdate(World& w, Entity self, float dt) override {
@@ -219,48 +249,62 @@ struct WaveSpawner : Behaviour {
     
 private:
     void SpawnWave(World& w) {
-        for (int i = 0; i < enemiesPerWave; ++i) {
+        if (enemiesPerWave <= 0) return;
+
+        // ウェーブごとに色のテーマを変える
+        DirectX::XMFLOAT3 color;
+        switch (currentWave % 3) {
+            case 0: // 赤系
+                color = DirectX::XMFLOAT3{1.0f, 0.3f, 0.3f};
+                break;
+            case 1: // 緑系
+                color = DirectX::XMFLOAT3{0.3f, 1.0f, 0.3f};
+                break;
+            default: // 青系
+                color = DirectX::XMFLOAT3{0.3f, 0.3f, 1.0f};
+                break;
+        }
+
+        // ウェーブ共通の構成はプールのプレハブにまとめ、一括で取り出す(破棄された敵はここで再利用される)
+        EntityPool& pool = w.Pool<WaveSpawner>();
+        if (pool.GetPrefab().Empty()) {
+            pool.GetPrefab()
+                .With<Transform>(DirectX::XMFLOAT3{0.0f, 10.0f, 0.0f})
+                .With<MeshRenderer>()
+                .With<EnemyTag>()
+                .With<Collider>()
+                .With<SpatialBody>(SpatialBody{ 0.5f, SpatialBody::LAYER_ENEMY, SpatialBody::LAYER_PLAYER })
+                .With<Velocity>(DirectX::XMFLOAT3{ 0.0f, -ENEMY_FALL_SPEED, 0.0f })
+                .With<DespawnBelow>(ENEMY_DESPAWN_Y)
+                .With<Rotator>(60.0f);
+            pool.GetPrefab().TryGet<Transform>()->UseQuaternion(); // Rotatorの回転をクォータニオンで積算
+        }
+
+        std::vector<Entity> enemies = pool.Spawn(static_cast<size_t>(enemiesPerWave), World::Cause::WaveTimer);
+
+        for (size_t i = 0; i < enemies.size(); ++i) {
             // 横並びに配置
             float spacing = 2.5f;
             float startX = -(enemiesPerWave - 1) * spacing * 0.5f;
-            float x = startX + i * spacing;
-            
+            float x = startX + static_cast<float>(i) * spacing;
+
             // ランダムな形状
-            int shapeIndex = util::Random::Int(0, 4);
+            int shapeIndex = rng.Int(0, 4);
             if (shapeIndex >= static_cast<int>(MeshType::Plane)) {
                 shapeIndex++;
             }
-            MeshType shape = static_cast<MeshType>(shapeIndex);
-            
-            // ウェーブごとに色のテーマを変える
-            DirectX::XMFLOAT3 color;
-            switch (currentWave % 3) {
-                case 0: // 赤系
-                    color = DirectX::XMFLOAT3{1.0f, 0.3f, 0.3f};
-                    break;
-                case 1: // 緑系
-                    color = DirectX::XMFLOAT3{0.3f, 1.0f, 0.3f};
-                    break;
-                default: // 青系
-                    color = DirectX::XMFLOAT3{0.3f, 0.3f, 1.0f};
-                    break;
-            }
-            
-            Transform t;
-            t.position = DirectX::XMFLOAT3{x, 10.0f, 0.0f};
-            t.scale = DirectX::XMFLOAT3{1.0f, 1.0f, 1.0f};
-            
-            MeshRenderer mr;
-            mr.meshType = shape;
-            mr.color = color;
-            
-            Entity enemy = w.Create()
-                .With<Transform>(t)
-                .With<MeshRenderer>(mr)
-                .With<EnemyTag>()
-                .WithCause<EnemyMovement>(World::Cause::WaveTimer)
-                .WithCause<Rotator>(World::Cause::WaveTimer, 60.0f)
-                .Build();
+
+            const MeshType shape = static_cast<MeshType>(shapeIndex);
+            w.Get<Transform>(enemies[i]).position.x = x;
+            MeshRenderer& renderer = w.Get<MeshRenderer>(enemies[i]);
+            renderer.meshType = shape;
+            renderer.color = color;
+
+            // 形状に合わせた当たり判定(プレイヤーに触れたら破棄)
+            Collider& collider = w.Get<Collider>(enemies[i]);
+            collider = Collider::FromMesh(shape);
+            collider.flags |= Collider::DESTROY_ON_CONTACT;
+            w.Get<SpatialBody>(enemies[i]).radius = collider.BoundingRadius();
         }
     }
 };
@@ -0,0 +1,828 @@
+/**
+ * @file ScriptVM.h
+ * @brief ゲームプレイのスクリプトのコンパイラとバッチ実行のVM
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Bouncer・PulseScale のような小さな動きを C++ の Behaviour を書いてビルドし直さずに試すためのスクリプトです。
+ * スクリプトは読み込み時にレジスタ型のバイトコードへコンパイルされ、ScriptSystem が同じスクリプトの
+ * エンティティを BATCH_SIZE 体ずつまとめて実行します。レジスタは1つが BATCH_SIZE 個の float の列で、
+ * 1命令を全レーンに適用するため、命令の解釈のコストは体数ではなくバッチ数に比例します。
+ * if はジャンプではなくレーンごとのマスクにコンパイルし、ブロック内の代入はマスクが立ったレーンだけに書きます。
+ *
+ * @par 文法(1行に1文、# 以降はコメント)
+ * @code
+ * param speed = 2        # エンティティごとに上書きできる値(ScriptLibrary::SetParam)
+ * local phase = 0        # エンティティごとに保持される変数
+ *
+ * on start               # 最初の1回だけ
+ *   startY = pos.y
+ * on update              # 毎ステップ(on を書かない文もここ)
+ *   phase += dt * speed
+ *   if phase > 10
+ *     destroy
+ *   else
+ *     pos.y = startY + sin(phase) * 2
+ *   end
+ * @endcode
+ * - 読み書きできる値: pos.x/y/z, rot.x/y/z(度), scale.x/y/z, color.r/g/b(MeshRenderer)、param、local
+ * - 読み取りだけの値: dt(秒), time(ScriptSystem の経過秒), pi
+ * - 演算子: + - * / % < <= > >= == != and or not(比較の結果は 1 か 0)、代入は = += -= *= /=
+ * - 関数: sin cos abs floor sqrt min max mod clamp lerp rand(0以上1未満)
+ * - destroy: エンティティを破棄する(ステップの最後にまとめて)
+ */
+#pragma once
+#include "app/DebugLog.h"
+#include "util/Random.h"
+#include "components/ScriptInstance.h"
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @enum ScriptField
+ * @brief スクリプトから読み書きできるコンポーネントの値
+ */
+enum class ScriptField : uint8_t {
+    PosX, PosY, PosZ,
+    RotX, RotY, RotZ,
+    ScaleX, ScaleY, ScaleZ,
+    ColorR, ColorG, ColorB,
+    COUNT
+};
+
+/**
+ * @enum ScriptOp
+ * @brief バイトコードの命令(オペランドはすべてレジスタ)
+ */
+enum class ScriptOp : uint8_t {
+    Mov,        ///< dst = a
+    Store,      ///< dst = b != 0 ? a : dst(マスク付きの代入)
+    Add, Sub, Mul, Div, Mod, Neg,
+    Lt, Le, Gt, Ge, Eq, Ne, And, Or, Not,
+    Sin, Cos, Abs, Floor, Sqrt, Min, Max,
+    Clamp,      ///< dst = clamp(a, b, c)
+    Lerp,       ///< dst = a + (b - a) * c
+    Rand,       ///< dst = [0, 1) の乱数(レーンごと)
+};
+
+/**
+ * @struct ScriptInstruction
+ * @brief 1命令(5バイト)
+ */
+struct ScriptInstruction {
+    ScriptOp op = ScriptOp::Mov;
+    uint8_t dst = 0;
+    uint8_t a = 0;
+    uint8_t b = 0;
+    uint8_t c = 0;
+};
+
+/**
+ * @struct ScriptProgram
+ * @brief コンパイル済みのスクリプト
+ *
+ * @details
+ * レジスタの割り当ては固定で、先頭から フィールド(ScriptField) / dt・time・destroy / param・local / 定数 の順、
+ * 式の一時値は末尾から使います。
+ */
+struct ScriptProgram {
+    static constexpr uint32_t BATCH_SIZE = 128;            ///< 1回の実行で処理するエンティティ数(レジスタ1つの長さ)
+    static constexpr uint32_t MAX_REGISTERS = 96;          ///< レジスタの数(BATCH_SIZE * 4 バイトずつ)
+    static constexpr uint8_t REG_DT = static_cast<uint8_t>(ScriptField::COUNT);
+    static constexpr uint8_t REG_TIME = REG_DT + 1;
+    static constexpr uint8_t REG_DESTROY = REG_DT + 2;     ///< 0 以外のレーンを破棄する
+    static constexpr uint8_t SLOT_BASE = 16;               ///< param / local の先頭のレジスタ
+    static constexpr uint8_t CONST_BASE = SLOT_BASE + ScriptInstance::MAX_SLOTS;
+    static_assert(REG_DESTROY < SLOT_BASE, "field registers overlap the slots");
+
+    std::string name;
+    std::vector<ScriptInstruction> start;   ///< on start
+    std::vector<ScriptInstruction> update;  ///< on update
+    std::vector<float> constants;           ///< CONST_BASE からのレジスタの値
+    std::vector<std::string> slotNames;     ///< param / local の名前(宣言順)
+    std::vector<float> slotDefaults;        ///< 初期値
+    uint32_t paramCount = 0;                ///< slotNames のうち param の数(先頭から)
+    uint32_t gatherFields = 0;              ///< 読む(または書く)フィールドのビット
+    uint32_t writeFields = 0;               ///< 書くフィールドのビット
+    bool destroys = false;                  ///< destroy を含むか
+    uint16_t layout = 0;                    ///< slots の並びの番号(ScriptLibrary が設定)
+
+    static constexpr uint32_t COLOR_FIELDS = (1u << static_cast<uint32_t>(ScriptField::ColorR)) |
+                                             (1u << static_cast<uint32_t>(ScriptField::ColorG)) |
+                                             (1u << static_cast<uint32_t>(ScriptField::ColorB));
+
+    bool UsesColor() const { return (gatherFields & COLOR_FIELDS) != 0; }
+
+    /**
+     * @brief 命令列を count 個のレーンに適用する
+     * @param[in] code start または update
+     * @param[in,out] regs MAX_REGISTERS * BATCH_SIZE 個の float
+     */
+    static void Execute(const std::vector<ScriptInstruction>& code, float* regs, uint32_t count, util::Rng& rng) {
+        for (const ScriptInstruction& in : code) {
+            float* d = regs + in.dst * BATCH_SIZE;
+            const float* a = regs + in.a * BATCH_SIZE;
+            const float* b = regs + in.b * BATCH_SIZE;
+            const float* c = regs + in.c * BATCH_SIZE;
+            switch (in.op) {
+            case ScriptOp::Mov:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i]; break;
+            case ScriptOp::Store: for (uint32_t i = 0; i < count; ++i) d[i] = b[i] != 0.0f ? a[i] : d[i]; break;
+            case ScriptOp::Add:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i] + b[i]; break;
+            case ScriptOp::Sub:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i] - b[i]; break;
+            case ScriptOp::Mul:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i] * b[i]; break;
+            case ScriptOp::Div:   for (uint32_t i = 0; i < count; ++i) d[i] = b[i] != 0.0f ? a[i] / b[i] : 0.0f; break;
+            case ScriptOp::Mod:   for (uint32_t i = 0; i < count; ++i) d[i] = b[i] != 0.0f ? std::fmod(a[i], b[i]) : 0.0f; break;
+            case ScriptOp::Neg:   for (uint32_t i = 0; i < count; ++i) d[i] = -a[i]; break;
+            case ScriptOp::Lt:    for (uint32_t i = 0; i < count; ++i) d[i] = a[i] < b[i] ? 1.0f : 0.0f; break;
+            case ScriptOp::Le:    for (uint32_t i = 0; i < count; ++i) d[i] = a[i] <= b[i] ? 1.0f : 0.0f; break;
+            case ScriptOp::Gt:    for (uint32_t i = 0; i < count; ++i) d[i] = a[i] > b[i] ? 1.0f : 0.0f; break;
+            case ScriptOp::Ge:    for (uint32_t i = 0; i < count; ++i) d[i] = a[i] >= b[i] ? 1.0f : 0.0f; break;
+            case ScriptOp::Eq:    for (uint32_t i = 0; i < count; ++i) d[i] = a[i] == b[i] ? 1.0f : 0.0f; break;
+            case ScriptOp::Ne:    for (uint32_t i = 0; i < count; ++i) d[i] = a[i] != b[i] ? 1.0f : 0.0f; break;
+            case ScriptOp::And:   for (uint32_t i = 0; i < count; ++i) d[i] = (a[i] != 0.0f && b[i] != 0.0f) ? 1.0f : 0.0f; break;
+            case ScriptOp::Or:    for (uint32_t i = 0; i < count; ++i) d[i] = (a[i] != 0.0f || b[i] != 0.0f) ? 1.0f : 0.0f; break;
+            case ScriptOp::Not:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i] == 0.0f ? 1.0f : 0.0f; break;
+            case ScriptOp::Sin:   for (uint32_t i = 0; i < count; ++i) d[i] = std::sin(a[i]); break;
+            case ScriptOp::Cos:   for (uint32_t i = 0; i < count; ++i) d[i] = std::cos(a[i]); break;
+            case ScriptOp::Abs:   for (uint32_t i = 0; i < count; ++i) d[i] = std::fabs(a[i]); break;
+            case ScriptOp::Floor: for (uint32_t i = 0; i < count; ++i) d[i] = std::floor(a[i]); break;
+            case ScriptOp::Sqrt:  for (uint32_t i = 0; i < count; ++i) d[i] = a[i] > 0.0f ? std::sqrt(a[i]) : 0.0f; break;
+            case ScriptOp::Min:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i] < b[i] ? a[i] : b[i]; break;
+            case ScriptOp::Max:   for (uint32_t i = 0; i < count; ++i) d[i] = a[i] > b[i] ? a[i] : b[i]; break;
+            case ScriptOp::Clamp: for (uint32_t i = 0; i < count; ++i) d[i] = a[i] < b[i] ? b[i] : (a[i] > c[i] ? c[i] : a[i]); break;
+            case ScriptOp::Lerp:  for (uint32_t i = 0; i < count; ++i) d[i] = a[i] + (b[i] - a[i]) * c[i]; break;
+            case ScriptOp::Rand:  for (uint32_t i = 0; i < count; ++i) d[i] = rng.Float01(); break;
+            }
+        }
+    }
+};
+
+/**
+ * @class ScriptCompiler
+ * @brief スクリプトのソースを ScriptProgram にコンパイルする
+ */
+class ScriptCompiler {
+public:
+    /**
+     * @brief コンパイル
+     * @param[in] source ソース
+     * @param[out] out 結果(失敗時は不定)
+     * @param[out] error 失敗時の理由("行番号: 内容")
+     * @return bool 成功した場合 true
+     */
+    bool Compile(const std::string& source, ScriptProgram& out, std::string& error) {
+        program_ = &out;
+        out = ScriptProgram{};
+        error_.clear();
+        masks_.clear();
+        elses_.clear();
+        constantIndex_.clear();
+        tempLow_ = ScriptProgram::MAX_REGISTERS;
+        code_ = &out.update;
+
+        std::istringstream lines(source);
+        std::string line;
+        line_ = 0;
+        while (std::getline(lines, line)) {
+            ++line_;
+            if (!tokenize(line)) break;
+            if (tokens_.empty()) continue;
+            pos_ = 0;
+            tempTop_ = masks_.empty() ? ScriptProgram::MAX_REGISTERS : masks_.back();
+            if (!statement()) break;
+        }
+        if (error_.empty() && !masks_.empty()) fail("if に対応する end がありません");
+        if (!error_.empty()) {
+            error = error_;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    struct Token {
+        enum Kind : uint8_t { Number, Name, Symbol } kind;
+        std::string text;
+        float value = 0.0f;
+    };
+
+    // ---- 字句解析 ----
+
+    bool tokenize(const std::string& line) {
+        tokens_.clear();
+        size_t i = 0;
+        while (i < line.size()) {
+            const char ch = line[i];
+            if (ch == '#') break;
+            if (std::isspace(static_cast<unsigned char>(ch))) {
+                ++i;
+                continue;
+            }
+            Token token;
+            if (std::isdigit(static_cast<unsigned char>(ch)) || (ch == '.' && i + 1 < line.size() && std::isdigit(static_cast<unsigned char>(line[i + 1])))) {
+                char* end = nullptr;
+                token.kind = Token::Number;
+                token.value = std::strtof(line.c_str() + i, &end);
+                const size_t next = static_cast<size_t>(end - line.c_str());
+                token.text = line.substr(i, next - i);
+                i = next;
+            } else if (std::isalpha(static_cast<unsigned char>(ch)) || ch == '_') {
+                // pos.x のようなフィールドは1つの名前として扱う
+                const size_t begin = i;
+                while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_' || line[i] == '.')) ++i;
+                token.kind = Token::Name;
+                token.text = line.substr(begin, i - begin);
+            } else {
+                static const char* const kSymbols[] = { "<=", ">=", "==", "!=", "+=", "-=", "*=", "/=", "+", "-", "*", "/", "%", "<", ">", "=", "(", ")", "," };
+                token.kind = Token::Symbol;
+                for (const char* symbol : kSymbols) {
+                    const size_t length = std::strlen(symbol);
+                    if (line.compare(i, length, symbol) == 0) {
+                        token.text = symbol;
+                        break;
+                    }
+                }
+                if (token.text.empty()) return fail(std::string("使えない文字 '") + ch + "'");
+                i += token.text.size();
+            }
+            tokens_.push_back(std::move(token));
+        }
+        return true;
+    }
+
+    bool atEnd() const { return pos_ >= tokens_.size(); }
+    bool peekSymbol(const char* symbol) const { return !atEnd() && tokens_[pos_].kind == Token::Symbol && tokens_[pos_].text == symbol; }
+    bool peekName(const char* name) const { return !atEnd() && tokens_[pos_].kind == Token::Name && tokens_[pos_].text == name; }
+
+    bool acceptSymbol(const char* symbol) {
+        if (!peekSymbol(symbol)) return false;
+        ++pos_;
+        return true;
+    }
+
+    bool acceptName(const char* name) {
+        if (!peekName(name)) return false;
+        ++pos_;
+        return true;
+    }
+
+    bool fail(const std::string& message) {
+        if (error_.empty()) error_ = std::to_string(line_) + ": " + message;
+        return false;
+    }
+
+    // ---- 文 ----
+
+    bool statement() {
+        const Token& first = tokens_[0];
+        if (first.kind == Token::Name) {
+            if (first.text == "param" || first.text == "local") return declaration(first.text == "param");
+            if (first.text == "on") return section();
+            if (first.text == "if") {
+                ++pos_;
+                return beginIf();
+            }
+            if (first.text == "else") {
+                ++pos_;
+                return elseBlock();
+            }
+            if (first.text == "end") {
+                ++pos_;
+                if (masks_.empty()) return fail("if のない end");
+                masks_.pop_back();
+                elses_.pop_back();
+                return expectEnd();
+            }
+            if (first.text == "destroy") {
+                ++pos_;
+                program_->destroys = true;
+                assign(ScriptProgram::REG_DESTROY, constant(1.0f));
+                return expectEnd();
+            }
+        }
+        return assignment();
+    }
+
+    bool expectEnd() {
+        if (!atEnd()) return fail("余分な '" + tokens_[pos_].text + "'");
+        return error_.empty();
+    }
+
+    bool declaration(bool isParam) {
+        ++pos_;
+        if (!masks_.empty()) return fail("param / local は if の外に書いてください");
+        if (atEnd() || tokens_[pos_].kind != Token::Name) return fail("名前がありません");
+        const std::string name = tokens_[pos_++].text;
+        if (reserved(name) || findSlot(name) >= 0) return fail("'" + name + "' は既に使われています");
+        if (isParam && program_->slotNames.size() != program_->paramCount) return fail("param は local より前に宣言してください");
+        if (program_->slotNames.size() >= ScriptInstance::MAX_SLOTS) return fail("param と local は " + std::to_string(ScriptInstance::MAX_SLOTS) + " 個まで");
+
+        float value = 0.0f;
+        if (acceptSymbol("=")) {
+            const bool negative = acceptSymbol("-");
+            if (atEnd() || tokens_[pos_].kind != Token::Number) return fail("初期値は数値で指定してください");
+            value = negative ? -tokens_[pos_].value : tokens_[pos_].value;
+            ++pos_;
+        }
+        program_->slotNames.push_back(name);
+        program_->slotDefaults.push_back(value);
+        if (isParam) ++program_->paramCount;
+        return expectEnd();
+    }
+
+    bool section() {
+        ++pos_;
+        if (!masks_.empty()) return fail("on は if の外に書いてください");
+        if (acceptName("start")) {
+            code_ = &program_->start;
+        } else if (acceptName("update")) {
+            code_ = &program_->update;
+        } else {
+            return fail("on の後は start か update");
+        }
+        return expectEnd();
+    }
+
+    // マスク = 外側のマスク and 条件(マスクのレジスタは end まで一時値の領域の上に置く)
+    bool beginIf() {
+        const uint8_t cond = expression();
+        if (!error_.empty()) return false;
+        const uint8_t mask = allocTemp();
+        if (!error_.empty()) return false;
+        if (masks_.empty()) {
+            emit(ScriptOp::Mov, mask, cond);
+        } else {
+            emit(ScriptOp::And, mask, masks_.back(), cond);
+        }
+        masks_.push_back(mask);
+        elses_.push_back(false);
+        return expectEnd();
+    }
+
+    // else は外側のマスク and not 条件 = 外側のマスク and not 今のマスク
+    bool elseBlock() {
+        if (masks_.empty()) return fail("if のない else");
+        if (elses_.back()) return fail("else が2つあります");
+        elses_.back() = true;
+        const uint8_t mask = masks_.back();
+        emit(ScriptOp::Not, mask, mask);
+        if (masks_.size() > 1) emit(ScriptOp::And, mask, masks_[masks_.size() - 2], mask);
+        return expectEnd();
+    }
+
+    bool assignment() {
+        const Token& target = tokens_[pos_++];
+        if (target.kind != Token::Name) return fail("文の先頭が '" + target.text + "'");
+        int reg = writableRegister(target.text);
+        if (reg < 0) return false;
+
+        static const char* const kAssign[] = { "=", "+=", "-=", "*=", "/=" };
+        static const ScriptOp kOps[] = { ScriptOp::Mov, ScriptOp::Add, ScriptOp::Sub, ScriptOp::Mul, ScriptOp::Div };
+        int kind = -1;
+        for (int i = 0; i < 5; ++i) {
+            if (acceptSymbol(kAssign[i])) {
+                kind = i;
+                break;
+            }
+        }
+        if (kind < 0) return fail("'" + target.text + "' の後に代入がありません");
+
+        uint8_t value = expression();
+        if (!error_.empty()) return false;
+        if (kind > 0) {
+            const uint8_t combined = allocTemp();
+            emit(kOps[kind], combined, static_cast<uint8_t>(reg), value);
+            value = combined;
+        }
+        assign(static_cast<uint8_t>(reg), value);
+        return expectEnd();
+    }
+
+    void assign(uint8_t target, uint8_t value) {
+        if (masks_.empty()) {
+            emit(ScriptOp::Mov, target, value);
+        } else {
+            emit(ScriptOp::Store, target, value, masks_.back());
+        }
+    }
+
+    // ---- 式 ----
+
+    uint8_t expression() { return orExpr(); }
+
+    uint8_t orExpr() {
+        uint8_t left = andExpr();
+        while (error_.empty() && acceptName("or")) left = binary(ScriptOp::Or, left, andExpr());
+        return left;
+    }
+
+    uint8_t andExpr() {
+        uint8_t left = compare();
+        while (error_.empty() && acceptName("and")) left = binary(ScriptOp::And, left, compare());
+        return left;
+    }
+
+    uint8_t compare() {
+        const uint8_t left = additive();
+        static const char* const kSymbols[] = { "<", "<=", ">", ">=", "==", "!=" };
+        static const ScriptOp kOps[] = { ScriptOp::Lt, ScriptOp::Le, ScriptOp::Gt, ScriptOp::Ge, ScriptOp::Eq, ScriptOp::Ne };
+        for (int i = 0; i < 6 && error_.empty(); ++i) {
+            if (acceptSymbol(kSymbols[i])) return binary(kOps[i], left, additive());
+        }
+        return left;
+    }
+
+    uint8_t additive() {
+        uint8_t left = multiplicative();
+        while (error_.empty()) {
+            if (acceptSymbol("+")) {
+                left = binary(ScriptOp::Add, left, multiplicative());
+            } else if (acceptSymbol("-")) {
+                left = binary(ScriptOp::Sub, left, multiplicative());
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+
+    uint8_t multiplicative() {
+        uint8_t left = unary();
+        while (error_.empty()) {
+            if (acceptSymbol("*")) {
+                left = binary(ScriptOp::Mul, left, unary());
+            } else if (acceptSymbol("/")) {
+                left = binary(ScriptOp::Div, left, unary());
+            } else if (acceptSymbol("%")) {
+                left = binary(ScriptOp::Mod, left, unary());
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+
+    uint8_t unary() {
+        if (acceptSymbol("-")) {
+            // 数値の符号は定数に畳み込む
+            if (!atEnd() && tokens_[pos_].kind == Token::Number) return constant(-tokens_[pos_++].value);
+            const uint8_t value = unary();
+            const uint8_t dst = allocTemp();
+            emit(ScriptOp::Neg, dst, value);
+            return dst;
+        }
+        if (acceptName("not")) {
+            const uint8_t value = unary();
+            const uint8_t dst = allocTemp();
+            emit(ScriptOp::Not, dst, value);
+            return dst;
+        }
+        return primary();
+    }
+
+    uint8_t primary() {
+        if (atEnd()) {
+            fail("式がありません");
+            return 0;
+        }
+        const Token token = tokens_[pos_++];
+        if (token.kind == Token::Number) return constant(token.value);
+        if (token.kind == Token::Symbol) {
+            if (token.text != "(") {
+                fail("式に '" + token.text + "'");
+                return 0;
+            }
+            const uint8_t value = expression();
+            if (error_.empty() && !acceptSymbol(")")) fail("')' がありません");
+            return value;
+        }
+        if (peekSymbol("(")) {
+            ++pos_;
+            return call(token.text);
+        }
+        return readableRegister(token.text);
+    }
+
+    uint8_t call(const std::string& name) {
+        struct Builtin { const char* name; ScriptOp op; int args; };
+        static const Builtin kBuiltins[] = {
+            { "sin", ScriptOp::Sin, 1 }, { "cos", ScriptOp::Cos, 1 }, { "abs", ScriptOp::Abs, 1 },
+            { "floor", ScriptOp::Floor, 1 }, { "sqrt", ScriptOp::Sqrt, 1 }, { "min", ScriptOp::Min, 2 },
+            { "max", ScriptOp::Max, 2 }, { "mod", ScriptOp::Mod, 2 }, { "clamp", ScriptOp::Clamp, 3 },
+            { "lerp", ScriptOp::Lerp, 3 }, { "rand", ScriptOp::Rand, 0 },
+        };
+        const Builtin* builtin = nullptr;
+        for (const Builtin& candidate : kBuiltins) {
+            if (name == candidate.name) builtin = &candidate;
+        }
+        if (!builtin) {
+            fail("関数 '" + name + "' はありません");
+            return 0;
+        }
+        uint8_t args[3] = {};
+        int count = 0;
+        if (!acceptSymbol(")")) {
+            do {
+                if (count >= 3) break;
+                args[count++] = expression();
+                if (!error_.empty()) return 0;
+            } while (acceptSymbol(","));
+            if (!acceptSymbol(")")) {
+                fail("')' がありません");
+                return 0;
+            }
+        }
+        if (count != builtin->args) {
+            fail(name + " の引数は " + std::to_string(builtin->args) + " 個");
+            return 0;
+        }
+        const uint8_t dst = allocTemp();
+        emit(builtin->op, dst, args[0], args[1], args[2]);
+        return dst;
+    }
+
+    uint8_t binary(ScriptOp op, uint8_t left, uint8_t right) {
+        if (!error_.empty()) return 0;
+        const uint8_t dst = allocTemp();
+        emit(op, dst, left, right);
+        return dst;
+    }
+
+    // ---- レジスタ ----
+
+    static int fieldIndex(const std::string& name) {
+        static const char* const kFields[] = {
+            "pos.x", "pos.y", "pos.z", "rot.x", "rot.y", "rot.z",
+            "scale.x", "scale.y", "scale.z", "color.r", "color.g", "color.b",
+        };
+        static_assert(sizeof(kFields) / sizeof(kFields[0]) == static_cast<size_t>(ScriptField::COUNT), "field names are out of sync");
+        for (int i = 0; i < static_cast<int>(ScriptField::COUNT); ++i) {
+            if (name == kFields[i]) return i;
+        }
+        return -1;
+    }
+
+    static bool reserved(const std::string& name) {
+        static const char* const kReserved[] = { "dt", "time", "pi", "param", "local", "on", "if", "else", "end", "destroy", "and", "or", "not" };
+        for (const char* word : kReserved) {
+            if (name == word) return true;
+        }
+        return name.find('.') != std::string::npos;
+    }
+
+    int findSlot(const std::string& name) const {
+        for (size_t i = 0; i < program_->slotNames.size(); ++i) {
+            if (program_->slotNames[i] == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    uint8_t readableRegister(const std::string& name) {
+        if (name == "dt") return ScriptProgram::REG_DT;
+        if (name == "time") return ScriptProgram::REG_TIME;
+        if (name == "pi") return constant(3.14159265f);
+        const int field = fieldIndex(name);
+        if (field >= 0) {
+            program_->gatherFields |= 1u << field;
+            return static_cast<uint8_t>(field);
+        }
+        const int slot = findSlot(name);
+        if (slot >= 0) return static_cast<uint8_t>(ScriptProgram::SLOT_BASE + slot);
+        fail("'" + name + "' は宣言されていません");
+        return 0;
+    }
+
+    int writableRegister(const std::string& name) {
+        const int field = fieldIndex(name);
+        if (field >= 0) {
+            // マスク付きの代入は元の値を残すため、書くフィールドも読み込む
+            program_->gatherFields |= 1u << field;
+            program_->writeFields |= 1u << field;
+            return field;
+        }
+        const int slot = findSlot(name);
+        if (slot >= 0) return ScriptProgram::SLOT_BASE + slot;
+        if (name == "dt" || name == "time" || name == "pi") {
+            fail("'" + name + "' には代入できません");
+        } else {
+            fail("'" + name + "' は宣言されていません");
+        }
+        return -1;
+    }
+
+    uint8_t constant(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        auto it = constantIndex_.find(bits);
+        if (it != constantIndex_.end()) return it->second;
+        // 定数はスクリプト全体で1回だけ読み込むため、前の文の一時値が使ったレジスタにも置けない
+        const size_t reg = ScriptProgram::CONST_BASE + program_->constants.size();
+        if (reg >= tempLow_) {
+            fail("定数と式が多すぎます");
+            return 0;
+        }
+        program_->constants.push_back(value);
+        constantIndex_.emplace(bits, static_cast<uint8_t>(reg));
+        return static_cast<uint8_t>(reg);
+    }
+
+    // 一時値は末尾から割り当て、文ごとに(マスクの分を残して)戻す
+    uint8_t allocTemp() {
+        if (tempTop_ <= ScriptProgram::CONST_BASE + program_->constants.size()) {
+            fail("式が複雑すぎます");
+            return 0;
+        }
+        --tempTop_;
+        if (tempTop_ < tempLow_) tempLow_ = tempTop_;
+        return static_cast<uint8_t>(tempTop_);
+    }
+
+    void emit(ScriptOp op, uint8_t dst, uint8_t a = 0, uint8_t b = 0, uint8_t c = 0) {
+        if (!error_.empty()) return;
+        code_->push_back(ScriptInstruction{ op, dst, a, b, c });
+    }
+
+    ScriptProgram* program_ = nullptr;
+    std::vector<ScriptInstruction>* code_ = nullptr;
+    std::vector<Token> tokens_;
+    size_t pos_ = 0;
+    uint32_t line_ = 0;
+    uint32_t tempTop_ = ScriptProgram::MAX_REGISTERS;
+    uint32_t tempLow_ = ScriptProgram::MAX_REGISTERS;     ///< これまでの文で一時値が使った最も小さいレジスタ
+    std::vector<uint8_t> masks_;                          ///< 入れ子の if のマスクのレジスタ
+    std::vector<bool> elses_;                             ///< masks_ ごとに else を過ぎたか
+    std::unordered_map<uint32_t, uint8_t> constantIndex_; ///< 定数のビット列 -> レジスタ
+    std::string error_;
+};
+
+/**
+ * @class ScriptLibrary
+ * @brief コンパイル済みのスクリプトを番号で管理し、ファイルの変更を読み込み直す
+ *
+ * @details
+ * 同じ名前で Compile() し直すと番号はそのままで中身を差し替えます。param / local の並びが変わった場合は
+ * layout が変わり、ScriptSystem が各エンティティの値を既定値に戻して start から実行し直します。
+ * コンパイルに失敗した場合は前の内容のまま動き続けます(読み込み直しも同じ)。
+ *
+ * SetHotReloadEnabled(true) の間、LoadFile() で読み込んだファイルの更新日時を HOT_RELOAD_POLL_FRAMES ごとに確認し、
+ * 変わったものをコンパイルし直します(ScriptSystem が毎ステップ PollReload() を呼ぶ)。
+ */
+class ScriptLibrary {
+public:
+    using ScriptId = uint16_t;
+    static constexpr ScriptId INVALID_SCRIPT = ScriptInstance::NO_SCRIPT;
+    static constexpr uint32_t HOT_RELOAD_POLL_FRAMES = 30;
+    static constexpr const char* SCRIPT_DIRECTORY = "Assets/Scripts"; ///< サンプルのスクリプトの置き場所
+
+    /**
+     * @brief ソースからコンパイルして登録
+     * @return ScriptId 番号(初回のコンパイルに失敗した場合 INVALID_SCRIPT)
+     */
+    ScriptId Compile(const std::string& name, const std::string& source) {
+        auto program = std::make_unique<ScriptProgram>();
+        std::string error;
+        if (!compiler_.Compile(source, *program, error)) {
+            DEBUGLOG_WARNING("ScriptLibrary - " + name + ":" + error);
+            return Find(name);
+        }
+        program->name = name;
+
+        ScriptId id = Find(name);
+        if (id == INVALID_SCRIPT) {
+            if (programs_.size() >= INVALID_SCRIPT) return INVALID_SCRIPT;
+            id = static_cast<ScriptId>(programs_.size());
+            programs_.emplace_back();
+            names_.emplace(name, id);
+        }
+        const ScriptProgram* previous = programs_[id].get();
+        const bool sameLayout = previous && previous->slotNames == program->slotNames && previous->slotDefaults == program->slotDefaults;
+        if (!sameLayout && ++layoutCounter_ == 0) layoutCounter_ = 1; // 0 は未初期化の印
+        program->layout = sameLayout ? previous->layout : layoutCounter_;
+        DEBUGLOG_CATEGORY(DebugLog::Category::System, "ScriptLibrary - " + name + ": start " + std::to_string(program->start.size()) +
+                          " / update " + std::to_string(program->update.size()) + " 命令" + (previous ? "(読み込み直し)" : ""));
+        programs_[id] = std::move(program);
+        return id;
+    }
+
+    /**
+     * @brief ファイルを読み込んでコンパイル(名前はパス)
+     */
+    ScriptId LoadFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            DEBUGLOG_WARNING("ScriptLibrary - ファイルを開けません: " + path);
+            return Find(path);
+        }
+        std::ostringstream source;
+        source << file.rdbuf();
+        const bool known = files_.count(path) != 0;
+        FileEntry& entry = files_[path];
+        std::error_code ec;
+        entry.writeTime = std::filesystem::last_write_time(path, ec);
+        if (!known) fileOrder_.push_back(path);
+        return Compile(path, source.str());
+    }
+
+    ScriptId Find(const std::string& name) const {
+        auto it = names_.find(name);
+        return it != names_.end() ? it->second : INVALID_SCRIPT;
+    }
+
+    const ScriptProgram* Get(ScriptId id) const {
+        return id < programs_.size() ? programs_[id].get() : nullptr;
+    }
+
+    size_t Size() const { return programs_.size(); }
+
+    /**
+     * @brief param / local を既定値にした ScriptInstance
+     */
+    ScriptInstance MakeInstance(ScriptId id) const {
+        ScriptInstance instance;
+        instance.script = id;
+        Reset(instance);
+        return instance;
+    }
+
+    /**
+     * @brief param / local を既定値に戻し、start を実行し直す印を付ける
+     */
+    void Reset(ScriptInstance& instance) const {
+        const ScriptProgram* program = Get(instance.script);
+        instance.started = 0;
+        if (!program) return;
+        for (size_t i = 0; i < ScriptInstance::MAX_SLOTS; ++i) {
+            instance.slots[i] = i < program->slotDefaults.size() ? program->slotDefaults[i] : 0.0f;
+        }
+        instance.layout = program->layout;
+    }
+
+    /**
+     * @brief param の値を設定
+     * @return bool その名前の param がない場合 false
+     */
+    bool SetParam(ScriptInstance& instance, const std::string& name, float value) const {
+        const ScriptProgram* program = Get(instance.script);
+        if (!program) return false;
+        if (instance.layout != program->layout) Reset(instance);
+        for (uint32_t i = 0; i < program->paramCount; ++i) {
+            if (program->slotNames[i] == name) {
+                instance.slots[i] = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void SetHotReloadEnabled(bool enabled) {
+        hotReload_ = enabled;
+        pollCountdown_ = 0;
+    }
+
+    bool IsHotReloadEnabled() const { return hotReload_; }
+
+    /**
+     * @brief 読み込んだファイルの更新を確認し、変わったものをコンパイルし直す
+     */
+    void PollReload() {
+        if (!hotReload_ || fileOrder_.empty()) return;
+        if (pollCountdown_ > 0) {
+            --pollCountdown_;
+            return;
+        }
+        pollCountdown_ = HOT_RELOAD_POLL_FRAMES;
+        for (const std::string& path : fileOrder_) {
+            std::error_code ec;
+            const auto writeTime = std::filesystem::last_write_time(path, ec);
+            if (ec || writeTime == files_[path].writeTime) continue;
+            LoadFile(path);
+        }
+    }
+
+private:
+    struct FileEntry {
+        std::filesystem::file_time_type writeTime{};
+    };
+
+    ScriptCompiler compiler_;
+    std::vector<std::unique_ptr<ScriptProgram>> programs_;
+    std::unordered_map<std::string, ScriptId> names_;
+    std::unordered_map<std::string, FileEntry> files_;
+    std::vector<std::string> fileOrder_;       ///< 確認する順(読み込んだ順)
+    uint16_t layoutCounter_ = 0;
+    uint32_t pollCountdown_ = 0;
+    bool hotReload_ = false;
+};
@@ -0,0 +1,84 @@
+/**
+ * @file ArchiveIOSystem.h
+ * @brief AssetArchive から読む Assimp の IOSystem
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Assimp::Importer::SetIOHandler() に渡すと、モデルと参照ファイル(.mtl など)をアーカイブのメモリから読みます。
+ * アーカイブに含まれないパスは Assimp::DefaultIOSystem(個別のファイル)へ回します。
+ *
+ * @code
+ * Assimp::Importer importer;
+ * if (AssetArchive::GetInstance().IsMounted()) importer.SetIOHandler(new ArchiveIOSystem());  // importer が破棄する
+ * @endcode
+ */
+#pragma once
+#include "app/AssetArchive.h"
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+#include <cstring>
+
+/**
+ * @class ArchiveIOStream
+ * @brief AssetArchive::Blob を読む IOStream(読み込み専用)
+ */
+class ArchiveIOStream : public Assimp::IOStream {
+public:
+    explicit ArchiveIOStream(AssetArchive::Blob&& blob) : blob_(std::move(blob)) {}
+
+    size_t Read(void* buffer, size_t size, size_t count) override {
+        if (size == 0 || count == 0) return 0;
+        const size_t available = (blob_.size - position_) / size;
+        const size_t items = count < available ? count : available;
+        std::memcpy(buffer, blob_.data + position_, items * size);
+        position_ += items * size;
+        return items;
+    }
+
+    size_t Write(const void*, size_t, size_t) override { return 0; }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override {
+        size_t target = offset;
+        if (origin == aiOrigin_CUR) target = position_ + offset;
+        else if (origin == aiOrigin_END) target = blob_.size - offset;
+        if (target > blob_.size) return aiReturn_FAILURE;
+        position_ = target;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override { return position_; }
+    size_t FileSize() const override { return blob_.size; }
+    void Flush() override {}
+
+private:
+    AssetArchive::Blob blob_;  ///< 非圧縮ならマップした領域、圧縮なら展開したバッファ
+    size_t position_ = 0;
+};
+
+/**
+ * @class ArchiveIOSystem
+ * @brief アーカイブを優先し、含まれないパスは個別のファイルから読む IOSystem
+ */
+class ArchiveIOSystem : public Assimp::IOSystem {
+public:
+    bool Exists(const char* file) const override {
+        return AssetArchive::GetInstance().Contains(file) || fallback_.Exists(file);
+    }
+
+    char getOsSeparator() const override { return '/'; }
+
+    Assimp::IOStream* Open(const char* file, const char* mode = "rb") override {
+        const bool write = mode && (std::strchr(mode, 'w') || std::strchr(mode, 'a'));
+        AssetArchive::Blob blob;
+        if (!write && AssetArchive::GetInstance().Read(file, blob)) return new ArchiveIOStream(std::move(blob));
+        return fallback_.Open(file, mode);
+    }
+
+    void Close(Assimp::IOStream* stream) override { delete stream; }
+
+private:
+    Assimp::DefaultIOSystem fallback_;  ///< アーカイブにないパス
+};
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <DirectXMath.h>
+#include "graphics/FrustumCulling.h"
 
 /**
  * @file Camera.h
@@ -23,6 +24,7 @@
  * ### カメラの構成要素:
  * - **View行列**: カメラの位置と向きを表す
  * - **Projection行列**: 3D空間を2D画面に投影する方法を表す
+ * - **ViewProj行列・視錐台**: 上の2つの積と、そこから抽出した6平面(行列を変えた時に一度だけ計算し、描画とカリングで共有する)
  * 
  * ### 座標系:
  * - X軸: 右方向
@@ -57,6 +59,8 @@
 struct Camera {
     DirectX::XMMATRIX View;  ///< ビュー行列(カメラの位置・向き)
     DirectX::XMMATRIX Proj;  ///< プロジェクション行列(透視方法)
+    DirectX::XMMATRIX ViewProj;  ///< View * Proj(UpdateViewProj() で更新)
+    Frustum frustum;             ///< ViewProj の視錐台(UpdateViewProj() で更新)
     
     DirectX::XMFLOAT3 position;  ///< カメラの位置
     DirectX::XMFLOAT3 target;    ///< カメラが見ている点(注視点)
@@ -118,6 +122,7 @@ struct Camera {
             DirectX::XMLoadFloat3(&at),
             DirectX::XMLoadFloat3(&upVec));
         c.Proj = DirectX::XMMatrixPerspectiveFovLH(fovY, aspect, znear, zfar);
+        c.UpdateViewProj();
         return c;
     }
     
@@ -139,6 +144,27 @@ struct Camera {
             DirectX::XMLoadFloat3(&position),
             DirectX::XMLoadFloat3(&target),
             DirectX::XMLoadFloat3(&up));
+        UpdateViewProj();
+    }
+
+    /**
+     * @brief fovY・aspect・nearZ・farZ からプロジェクション行列を再計算
+     */
+    void UpdateProjection() {
+        Proj = DirectX::XMMatrixPerspectiveFovLH(fovY, aspect, nearZ, farZ);
+        UpdateViewProj();
+    }
+
+    /**
+     * @brief View・Proj から ViewProj と視錐台を再計算
+     *
+     * @details
+     * Update()・UpdateProjection() などの中で呼ばれます。View・Proj を直接書き換えた場合だけ呼んでください。
+     * 描画(RenderSystem)はフレームごとにここで求めた ViewProj を1回だけ定数バッファへ送ります。
+     */
+    void UpdateViewProj() {
+        ViewProj = DirectX::XMMatrixMultiply(View, Proj);
+        frustum = Frustum::FromViewProj(ViewProj);
     }
     
     /**
@@ -187,6 +213,16 @@ struct Camera {
         Update();
     }
     
+    /**
+     * @brief アスペクト比の変更(ウィンドウの大きさが変わったとき)
+     * @param[in] newAspect アスペクト比(幅/高さ)
+     */
+    void SetAspect(float newAspect) {
+        if (!(newAspect > 0.0f)) return;
+        aspect = newAspect;
+        UpdateProjection();
+    }
+
     /**
      * @brief ズーム(視野角の変更)
      * 
@@ -208,6 +244,6 @@ struct Camera {
         if (fovY < DirectX::XM_PIDIV4 * 0.5f) fovY = DirectX::XM_PIDIV4 * 0.5f;
         if (fovY > DirectX::XM_PIDIV2) fovY = DirectX::XM_PIDIV2;
         
-        Proj = DirectX::XMMatrixPerspectiveFovLH(fovY, aspect, nearZ, farZ);
+        UpdateProjection();
     }
 };
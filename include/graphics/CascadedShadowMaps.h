@@ -0,0 +1,630 @@
+/**
+ * @file CascadedShadowMaps.h
+ * @brief DirectionalLight のカスケードシャドウマップ(カスケードの当てはめ・更新の分散・深度のみのインスタンス描画)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * カメラの視錐台を奥行きで CASCADE_COUNT 個に分割し(対数と等間隔の中間)、それぞれの区間の8頂点を
+ * ライト空間の AABB でぴったり囲む正射影をカスケードとします。一辺は大きめの刻みに切り上げ、原点はテクセル単位に
+ * 揃えるため、カメラが平行移動しても影の輪郭は揺れません。
+ *
+ * 影を落とす物体(キャスター)はカスケードごとに呼び出し側が CasterFrustum() で選びます。
+ * 正射影の手前の面は判定に使わず、ラスタライザーの深度クリップを切って手前のキャスターを深度0に潰すため
+ * (パンケーキング)、カスケードの奥行きは受け側の範囲だけで済みます。
+ * キャスターは同じメッシュ(頂点・インデックスの範囲)ごとにまとめ、ワールド行列の構造化バッファを
+ * 1回の Map で書き込み、1メッシュ1回の DrawIndexedInstanced で深度だけを描画します(ピクセルシェーダーなし)。
+ *
+ * 更新はフレームごとに分散します。カスケード0は毎フレーム、1 は2フレームに1回、2 と 3 は4フレームに1回
+ * (互いにずらす)で、1フレームに描くのは常に2カスケードです。更新しなかったカスケードは前回描画したときの
+ * 行列のまま参照するため、深度と行列は常に一致します。ライトの向きが変わった場合や有効にした直後は全カスケードを描き直します。
+ *
+ * ### シェーダーリソース(RenderSystem のピクセルシェーダー):
+ * - b2: ShadowConstants(カスケードごとの行列とテクセルの大きさ)
+ * - t6: Texture2DArray<float> シャドウマップ(スライスがカスケード)
+ * - s1: 比較サンプラー(LESS_EQUAL、バイリニアの PCF)
+ */
+#pragma once
+#include "graphics/Camera.h"
+#include "graphics/FrustumCulling.h"
+#include "graphics/RenderProxy.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/GfxDevice.h"
+#include "graphics/VertexFormat.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @class CascadedShadowMaps
+ * @brief ディレクショナルライトのカスケードシャドウマップ
+ *
+ * @par 使用例
+ * @code
+ * shadows.Init(device, compileFlags);
+ *
+ * // 毎フレーム
+ * uint32_t cascades = shadows.BeginFrame(cam, light.direction);
+ * for (uint32_t c = 0; c < CascadedShadowMaps::CASCADE_COUNT; ++c) {
+ *     if (!(cascades & (1u << c))) continue;
+ *     const Frustum& frustum = shadows.CasterFrustum(c);
+ *     // 境界球が frustum に触れるものを AddCaster(c, mesh, world)
+ * }
+ * shadows.Render(device, gfx.States());   // レンダーターゲットとビューポートを変更する
+ * shadows.Bind(gfx.States());             // ピクセルシェーダーの b2 / t6 / s1
+ * @endcode
+ */
+class CascadedShadowMaps {
+public:
+    static constexpr uint32_t CASCADE_COUNT = 4;        ///< カスケード数
+    static constexpr UINT DEFAULT_RESOLUTION = 1024;     ///< 1カスケードの解像度
+    static constexpr UINT CONSTANT_SLOT = 2;             ///< ピクセルシェーダーの定数バッファ(b2)
+    static constexpr UINT TEXTURE_SLOT = 6;              ///< ピクセルシェーダーのシャドウマップ(t6)
+    static constexpr UINT SAMPLER_SLOT = 1;              ///< ピクセルシェーダーの比較サンプラー(s1)
+    static constexpr float DEFAULT_DISTANCE = 80.0f;     ///< 影を描くカメラからの距離
+    static constexpr float SPLIT_LAMBDA = 0.75f;         ///< 分割の対数の割合(残りは等間隔)
+    static constexpr size_t INITIAL_CAPACITY = 1024;     ///< ワールド行列のバッファの初期容量
+
+    /**
+     * @struct ShadowConstants
+     * @brief ピクセルシェーダーの PerShadow(b2)と同じレイアウト
+     */
+    struct ShadowConstants {
+        DirectX::XMFLOAT4X4 viewProj[CASCADE_COUNT]; ///< カスケードのライトのビュー・射影行列(転置済み)
+        float texel = 0.0f;                          ///< 1テクセルのUV(PCF のずらし幅と端の余白)
+        float bias = 0.0f;                           ///< 比較する深度から引く値
+        uint32_t cascadeCount = 0;                   ///< 有効なカスケード数(0 の場合は影なし)
+        float padding = 0.0f;
+    };
+
+    /**
+     * @struct Statistics
+     * @brief 直近の Render() の集計
+     */
+    struct Statistics {
+        size_t cascadesRendered = 0;  ///< 描き直したカスケード数
+        size_t casters = 0;           ///< 描画したキャスター数(カスケードの重複を含む)
+        size_t draws = 0;             ///< DrawIndexedInstanced の回数
+    };
+
+    CascadedShadowMaps() = default;
+    CascadedShadowMaps(const CascadedShadowMaps&) = delete;
+    CascadedShadowMaps& operator=(const CascadedShadowMaps&) = delete;
+
+    /**
+     * @brief シェーダー・シャドウマップ・ステートの作成
+     * @param[in] resolution 1カスケードの解像度
+     */
+    bool Init(ID3D11Device* device, UINT compileFlags, UINT resolution = DEFAULT_RESOLUTION) {
+        Shutdown();
+        const char* VS = R"(
+            cbuffer ShadowBatch : register(b0) {
+                float4x4 gLightViewProj;
+                uint gInstanceOffset;
+                uint3 gPadding;
+            };
+
+            // キャスターのワールド行列(転置済み)
+            StructuredBuffer<float4x4> gWorlds : register(t0);
+
+            float4 main(float3 pos : POSITION, uint instanceId : SV_InstanceID) : SV_POSITION {
+                float4x4 world = gWorlds[gInstanceOffset + instanceId];
+                return mul(mul(float4(pos, 1.0f), world), gLightViewProj);
+            }
+        )";
+
+        Microsoft::WRL::ComPtr<ID3DBlob> blob, err;
+        HRESULT hr = ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, blob, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[CascadedShadowMaps] 頂点シェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        if (FAILED(device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, vs_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] 頂点シェーダーの作成失敗");
+            Shutdown();
+            return false;
+        }
+
+        // 位置だけを読む(Compact の位置は標準と同じ float3、CompactQuantized は unorm のまま読みワールド行列で逆量子化)
+        const D3D11_INPUT_ELEMENT_DESC floatPosition = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+        const D3D11_INPUT_ELEMENT_DESC unormPosition = { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+        if (FAILED(device->CreateInputLayout(&floatPosition, 1, blob->GetBufferPointer(), blob->GetBufferSize(), layoutFloat_.GetAddressOf())) ||
+            FAILED(device->CreateInputLayout(&unormPosition, 1, blob->GetBufferPointer(), blob->GetBufferSize(), layoutUnorm_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] 入力レイアウトの作成失敗");
+            Shutdown();
+            return false;
+        }
+
+        D3D11_BUFFER_DESC cbd{};
+        cbd.Usage = D3D11_USAGE_DEFAULT;
+        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        cbd.ByteWidth = sizeof(BatchConstants);
+        if (FAILED(device->CreateBuffer(&cbd, nullptr, batchCb_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] 定数バッファの作成失敗");
+            Shutdown();
+            return false;
+        }
+        cbd.ByteWidth = sizeof(ShadowConstants);
+        D3D11_SUBRESOURCE_DATA initial{ &constants_, 0, 0 };
+        if (FAILED(device->CreateBuffer(&cbd, &initial, shadowCb_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] 定数バッファの作成失敗");
+            Shutdown();
+            return false;
+        }
+
+        if (!CreateShadowMap(device, resolution) || !CreateStates(device)) {
+            Shutdown();
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[CascadedShadowMaps] " + std::to_string(CASCADE_COUNT) + " カスケード x " +
+                          std::to_string(resolution) + "px");
+        return true;
+    }
+
+    bool IsReady() const { return vs_ != nullptr; }
+
+    /**
+     * @brief 影を描くカメラからの距離(これより遠くは影なし)
+     */
+    void SetDistance(float distance) {
+        distance_ = (std::max)(distance, 1.0f);
+        Invalidate();
+    }
+
+    float Distance() const { return distance_; }
+
+    /**
+     * @brief 次の BeginFrame() で全カスケードを描き直す
+     */
+    void Invalidate() { refreshAll_ = true; }
+
+    /**
+     * @brief このフレームに描き直すカスケードを決め、その行列を計算
+     * @param[in] lightDirection ライトの進む向き(DirectionalLight::direction)
+     * @return uint32_t 描き直すカスケードのビット
+     */
+    uint32_t BeginFrame(const Camera& cam, const DirectX::XMFLOAT3& lightDirection) {
+        using namespace DirectX;
+        for (std::vector<Caster>& casters : casters_) casters.clear();
+
+        XMVECTOR dir = XMVector3Normalize(XMLoadFloat3(&lightDirection));
+        if (XMVector3Equal(dir, XMVectorZero()) || XMVector3IsNaN(dir)) {
+            pending_ = 0;
+            return 0;
+        }
+        if (XMVectorGetX(XMVector3Dot(dir, XMLoadFloat3(&lightDirection_))) < LIGHT_CHANGE_COS) refreshAll_ = true;
+        XMStoreFloat3(&lightDirection_, dir);
+
+        pending_ = refreshAll_ ? (1u << CASCADE_COUNT) - 1 : ScheduledCascades(frame_);
+        refreshAll_ = false;
+        ++frame_;
+
+        // 区間の境界(カメラからの距離)
+        const float nearZ = cam.nearZ;
+        const float farZ = (std::min)(cam.farZ, distance_);
+        float splits[CASCADE_COUNT + 1];
+        for (uint32_t i = 0; i <= CASCADE_COUNT; ++i) {
+            const float t = static_cast<float>(i) / static_cast<float>(CASCADE_COUNT);
+            const float logSplit = nearZ * std::pow(farZ / nearZ, t);
+            const float uniformSplit = nearZ + (farZ - nearZ) * t;
+            splits[i] = SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * uniformSplit;
+        }
+
+        // ライトのビュー(上方向はライトの向きと平行にならないものを選ぶ)
+        const XMVECTOR up = std::fabs(XMVectorGetY(dir)) > 0.99f ? XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f) : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+        const XMMATRIX lightView = XMMatrixLookToLH(XMVectorZero(), dir, up);
+        const XMMATRIX invView = XMMatrixInverse(nullptr, cam.View);
+        const float tanY = std::tan(cam.fovY * 0.5f);
+        const float tanX = tanY * cam.aspect;
+
+        for (uint32_t c = 0; c < CASCADE_COUNT; ++c) {
+            if (!(pending_ & (1u << c))) continue;
+
+            // 区間の8頂点をライト空間で囲む
+            XMVECTOR lo = XMVectorReplicate(FLT_MAX);
+            XMVECTOR hi = XMVectorReplicate(-FLT_MAX);
+            for (int k = 0; k < 8; ++k) {
+                const float d = splits[c + ((k & 4) ? 1 : 0)];
+                const XMVECTOR viewCorner = XMVectorSet((k & 1 ? 1.0f : -1.0f) * tanX * d, (k & 2 ? 1.0f : -1.0f) * tanY * d, d, 1.0f);
+                const XMVECTOR lightCorner = XMVector3TransformCoord(XMVector3TransformCoord(viewCorner, invView), lightView);
+                lo = XMVectorMin(lo, lightCorner);
+                hi = XMVectorMax(hi, lightCorner);
+            }
+
+            // 一辺を刻みに切り上げて正方形にし、原点をテクセル単位に揃える(平行移動で輪郭が揺れない)
+            XMFLOAT3 minL, maxL;
+            XMStoreFloat3(&minL, lo);
+            XMStoreFloat3(&maxL, hi);
+            float size = (std::max)(maxL.x - minL.x, maxL.y - minL.y);
+            const float quantum = std::exp2(std::ceil(std::log2((std::max)(size, 1e-3f))) - SIZE_QUANTUM_SHIFT);
+            size = std::ceil(size / quantum) * quantum;
+            const float texel = size / static_cast<float>(resolution_);
+            const float left = std::floor(((minL.x + maxL.x) * 0.5f - size * 0.5f) / texel) * texel;
+            const float bottom = std::floor(((minL.y + maxL.y) * 0.5f - size * 0.5f) / texel) * texel;
+
+            const XMMATRIX proj = XMMatrixOrthographicOffCenterLH(left, left + size, bottom, bottom + size, minL.z, maxL.z);
+            const XMMATRIX viewProj = lightView * proj;
+            XMStoreFloat4x4(&viewProj_[c], viewProj);
+
+            // キャスターの判定は手前の面を使わない(ライト側の物体は深度0に潰して描く)
+            casterFrustums_[c] = Frustum::FromViewProj(viewProj);
+            casterFrustums_[c].planes[4] = XMFLOAT4{ 0.0f, 0.0f, 0.0f, 1.0f };
+        }
+        return pending_;
+    }
+
+    /**
+     * @brief カスケードのキャスターを選ぶ視錐台(手前の面なし)
+     */
+    const Frustum& CasterFrustum(uint32_t cascade) const { return casterFrustums_[cascade]; }
+
+    /**
+     * @brief キャスターを追加(BeginFrame() が返したカスケードのみ)
+     * @param[in] world ワールド行列(転置前)
+     */
+    void AddCaster(uint32_t cascade, const RenderProxyMesh& mesh, const DirectX::XMFLOAT4X4& world) {
+        if (!(pending_ & (1u << cascade)) || !mesh.vertexBuffer || mesh.indexCount == 0) return;
+        casters_[cascade].push_back(Caster{ mesh, world });
+    }
+
+    /**
+     * @brief BeginFrame() で選んだカスケードを描き直し、ピクセルシェーダーの定数を更新
+     *
+     * @details
+     * レンダーターゲット・ビューポート・頂点シェーダー・入力レイアウト・ラスタライザーを変更し、
+     * ピクセルシェーダーを外します(ステートは states を通して設定)。呼び出し側で描画用のステートに戻してください。
+     */
+    void Render(ID3D11Device* device, StateCache& states) {
+        ID3D11DeviceContext* ctx = states.Context();
+        stats_ = Statistics{};
+        if (!IsReady() || pending_ == 0) return;
+
+        // メッシュごとに並べ、全カスケード分のワールド行列を1回の Map で書き込む
+        size_t total = 0;
+        for (uint32_t c = 0; c < CASCADE_COUNT; ++c) {
+            std::vector<Caster>& casters = casters_[c];
+            std::sort(casters.begin(), casters.end(), [](const Caster& a, const Caster& b) { return MeshLess(a.mesh, b.mesh); });
+            total += casters.size();
+        }
+        if (total > 0 && !Upload(device, ctx, total)) return;
+
+        ID3D11ShaderResourceView* nullSrv = nullptr;
+        ctx->PSSetShaderResources(TEXTURE_SLOT, 1, &nullSrv); // 深度バッファとして使う間は外す
+        states.SetVSConstantBuffer(0, batchCb_.Get());
+        ctx->VSSetShaderResources(0, 1, worldSrv_.GetAddressOf());
+
+        D3D11_VIEWPORT vp{};
+        vp.Width = static_cast<FLOAT>(resolution_);
+        vp.Height = static_cast<FLOAT>(resolution_);
+        vp.MaxDepth = 1.0f;
+        ctx->RSSetViewports(1, &vp);
+
+        BatchConstants batch{};
+        UINT offset = 0;
+        for (uint32_t c = 0; c < CASCADE_COUNT; ++c) {
+            if (!(pending_ & (1u << c))) continue;
+            ctx->OMSetRenderTargets(0, nullptr, dsvs_[c].Get());
+            ctx->ClearDepthStencilView(dsvs_[c].Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+            DirectX::XMStoreFloat4x4(&constants_.viewProj[c], DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&viewProj_[c])));
+            batch.lightViewProj = constants_.viewProj[c];
+            stats_.cascadesRendered++;
+
+            const std::vector<Caster>& casters = casters_[c];
+            size_t begin = 0;
+            while (begin < casters.size()) {
+                const RenderProxyMesh& mesh = casters[begin].mesh;
+                size_t end = begin + 1;
+                while (end < casters.size() && !MeshLess(mesh, casters[end].mesh)) ++end;
+
+                batch.instanceOffset = offset + static_cast<UINT>(begin);
+                ctx->UpdateSubresource(batchCb_.Get(), 0, nullptr, &batch, 0, 0);
+                BindMesh(states, mesh);
+                ctx->DrawIndexedInstanced(mesh.indexCount, static_cast<UINT>(end - begin), mesh.startIndex, mesh.baseVertex, 0);
+                stats_.draws++;
+                begin = end;
+            }
+            offset += static_cast<UINT>(casters.size());
+            stats_.casters += casters.size();
+        }
+
+        ID3D11Buffer* nullBuffer = nullptr;
+        ctx->VSSetShaderResources(0, 1, &nullSrv);
+        ctx->IASetVertexBuffers(0, 1, &nullBuffer, &boundStride_, &boundOffset_);
+        boundVertexBuffer_ = nullptr;
+        boundIndexBuffer_ = nullptr;
+
+        constants_.texel = 1.0f / static_cast<float>(resolution_);
+        constants_.bias = DEPTH_BIAS;
+        constants_.cascadeCount = CASCADE_COUNT;
+        ctx->UpdateSubresource(shadowCb_.Get(), 0, nullptr, &constants_, 0, 0);
+        enabled_ = true;
+    }
+
+    /**
+     * @brief 影を無効にする(ピクセルシェーダーのカスケード数を0にし、次に描くときは全カスケードを描き直す)
+     */
+    void Disable(ID3D11DeviceContext* ctx) {
+        pending_ = 0;
+        refreshAll_ = true;
+        stats_ = Statistics{};
+        if (!IsReady() || !enabled_) return;
+        constants_.cascadeCount = 0;
+        ctx->UpdateSubresource(shadowCb_.Get(), 0, nullptr, &constants_, 0, 0);
+        enabled_ = false;
+    }
+
+    /**
+     * @brief ピクセルシェーダーにシャドウマップ・比較サンプラー・定数を設定(遅延コンテキストの記録開始時にも使用)
+     */
+    void Bind(StateCache& states) const {
+        if (!IsReady()) return;
+        states.SetPSConstantBuffer(CONSTANT_SLOT, shadowCb_.Get());
+        states.Context()->PSSetShaderResources(TEXTURE_SLOT, 1, srv_.GetAddressOf());
+        states.SetPSSampler(SAMPLER_SLOT, sampler_.Get());
+    }
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+    size_t GpuMemoryBytes() const {
+        if (!texture_) return 0;
+        return static_cast<size_t>(resolution_) * resolution_ * sizeof(float) * CASCADE_COUNT + GfxDevice::BufferBytes(worldBuffer_.Get());
+    }
+
+    void Shutdown() {
+        for (auto& pipeline : pipelines_) pipeline = PipelineState();
+        vs_.Reset();
+        layoutFloat_.Reset();
+        layoutUnorm_.Reset();
+        batchCb_.Reset();
+        shadowCb_.Reset();
+        texture_.Reset();
+        srv_.Reset();
+        for (auto& dsv : dsvs_) dsv.Reset();
+        sampler_.Reset();
+        rasterState_.Reset();
+        worldBuffer_.Reset();
+        worldSrv_.Reset();
+        worldCapacity_ = 0;
+        for (std::vector<Caster>& casters : casters_) casters.clear();
+        pending_ = 0;
+        refreshAll_ = true;
+        enabled_ = false;
+        constants_ = ShadowConstants{};
+    }
+
+private:
+    static constexpr float LIGHT_CHANGE_COS = 0.99999f;  ///< ライトの向きがこれより変わったら全カスケードを描き直す
+    static constexpr float SIZE_QUANTUM_SHIFT = 4.0f;    ///< 一辺の刻み(一辺以上の2の累乗の 1/16)
+    static constexpr float DEPTH_BIAS = 0.0015f;         ///< 比較する深度から引く値
+    static constexpr float SLOPE_DEPTH_BIAS = 2.0f;      ///< 描画時の傾斜に比例する深度バイアス
+
+    /**
+     * @struct BatchConstants
+     * @brief 頂点シェーダーの ShadowBatch(b0)
+     */
+    struct BatchConstants {
+        DirectX::XMFLOAT4X4 lightViewProj; ///< 転置済み
+        UINT instanceOffset = 0;
+        UINT padding[3] = {};
+    };
+
+    /**
+     * @struct Caster
+     * @brief カスケードに描くキャスター1つ
+     */
+    struct Caster {
+        RenderProxyMesh mesh;
+        DirectX::XMFLOAT4X4 world; ///< 転置前
+    };
+
+    /**
+     * @brief カスケードごとの更新の予定(0 は毎フレーム、1 は偶数フレーム、2 と 3 は奇数フレームに交互)
+     */
+    static uint32_t ScheduledCascades(uint64_t frame) {
+        uint32_t mask = 1u << 0;
+        if ((frame & 1) == 0) {
+            mask |= 1u << 1;
+        } else {
+            mask |= (frame & 2) == 0 ? (1u << 2) : (1u << 3);
+        }
+        return mask;
+    }
+
+    static bool MeshLess(const RenderProxyMesh& a, const RenderProxyMesh& b) {
+        if (a.vertexBuffer != b.vertexBuffer) return a.vertexBuffer < b.vertexBuffer;
+        if (a.indexBuffer != b.indexBuffer) return a.indexBuffer < b.indexBuffer;
+        if (a.startIndex != b.startIndex) return a.startIndex < b.startIndex;
+        if (a.baseVertex != b.baseVertex) return a.baseVertex < b.baseVertex;
+        return a.indexCount < b.indexCount;
+    }
+
+    void BindMesh(StateCache& states, const RenderProxyMesh& mesh) {
+        ID3D11DeviceContext* ctx = states.Context();
+        states.Apply(pipelines_[mesh.vertexFormat == VertexFormat::CompactQuantized ? 1 : 0]);
+        if (mesh.vertexBuffer != boundVertexBuffer_) {
+            boundStride_ = VertexStride(mesh.vertexFormat);
+            boundOffset_ = 0;
+            ctx->IASetVertexBuffers(0, 1, &mesh.vertexBuffer, &boundStride_, &boundOffset_);
+            boundVertexBuffer_ = mesh.vertexBuffer;
+        }
+        if (mesh.indexBuffer != boundIndexBuffer_ || mesh.indexFormat != boundIndexFormat_) {
+            ctx->IASetIndexBuffer(mesh.indexBuffer, mesh.indexFormat, 0);
+            boundIndexBuffer_ = mesh.indexBuffer;
+            boundIndexFormat_ = mesh.indexFormat;
+        }
+    }
+
+    /**
+     * @brief 全カスケードのワールド行列(転置)を並べた順に書き込む
+     */
+    bool Upload(ID3D11Device* device, ID3D11DeviceContext* ctx, size_t count) {
+        if (!EnsureCapacity(device, count)) return false;
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        if (FAILED(ctx->Map(worldBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return false;
+        DirectX::XMFLOAT4X4* out = static_cast<DirectX::XMFLOAT4X4*>(mapped.pData);
+        for (const std::vector<Caster>& casters : casters_) {
+            for (const Caster& caster : casters) {
+                DirectX::XMStoreFloat4x4(out++, DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&caster.world)));
+            }
+        }
+        ctx->Unmap(worldBuffer_.Get(), 0);
+        return true;
+    }
+
+    bool EnsureCapacity(ID3D11Device* device, size_t count) {
+        if (count <= worldCapacity_ && worldBuffer_) return true;
+        size_t capacity = worldCapacity_ > 0 ? worldCapacity_ * 2 : INITIAL_CAPACITY;
+        if (capacity < count) capacity = count;
+
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bd.StructureByteStride = sizeof(DirectX::XMFLOAT4X4);
+        bd.ByteWidth = static_cast<UINT>(capacity * sizeof(DirectX::XMFLOAT4X4));
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        HRESULT hr = device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[CascadedShadowMaps] ワールド行列のバッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.Format = DXGI_FORMAT_UNKNOWN;
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvd.Buffer.NumElements = static_cast<UINT>(capacity);
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        hr = device->CreateShaderResourceView(buffer.Get(), &srvd, srv.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[CascadedShadowMaps] ワールド行列のバッファのSRV作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        worldBuffer_ = buffer;
+        worldSrv_ = srv;
+        worldCapacity_ = capacity;
+        return true;
+    }
+
+    bool CreateShadowMap(ID3D11Device* device, UINT resolution) {
+        D3D11_TEXTURE2D_DESC td{};
+        td.Width = resolution;
+        td.Height = resolution;
+        td.MipLevels = 1;
+        td.ArraySize = CASCADE_COUNT;
+        td.Format = DXGI_FORMAT_R32_TYPELESS;
+        td.SampleDesc.Count = 1;
+        td.Usage = D3D11_USAGE_DEFAULT;
+        td.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+        HRESULT hr = device->CreateTexture2D(&td, nullptr, texture_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] シャドウマップの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.Format = DXGI_FORMAT_R32_FLOAT;
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvd.Texture2DArray.MipLevels = 1;
+        srvd.Texture2DArray.ArraySize = CASCADE_COUNT;
+        if (FAILED(device->CreateShaderResourceView(texture_.Get(), &srvd, srv_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] シャドウマップのSRV作成失敗");
+            return false;
+        }
+
+        for (uint32_t c = 0; c < CASCADE_COUNT; ++c) {
+            D3D11_DEPTH_STENCIL_VIEW_DESC dsvd{};
+            dsvd.Format = DXGI_FORMAT_D32_FLOAT;
+            dsvd.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+            dsvd.Texture2DArray.FirstArraySlice = c;
+            dsvd.Texture2DArray.ArraySize = 1;
+            if (FAILED(device->CreateDepthStencilView(texture_.Get(), &dsvd, dsvs_[c].GetAddressOf()))) {
+                DEBUGLOG_WARNING("[CascadedShadowMaps] シャドウマップのDSV作成失敗");
+                return false;
+            }
+        }
+        resolution_ = resolution;
+        return true;
+    }
+
+    bool CreateStates(ID3D11Device* device) {
+        D3D11_SAMPLER_DESC sd{};
+        sd.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+        sd.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+        sd.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+        sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.BorderColor[0] = sd.BorderColor[1] = sd.BorderColor[2] = sd.BorderColor[3] = 1.0f;
+        sd.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+        sd.MaxLOD = D3D11_FLOAT32_MAX;
+        if (FAILED(device->CreateSamplerState(&sd, sampler_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] 比較サンプラーの作成失敗");
+            return false;
+        }
+
+        // 両面を描き(平面も影を落とす)、深度クリップを切ってライト側のキャスターを手前の面に潰す
+        D3D11_RASTERIZER_DESC rsd{};
+        rsd.FillMode = D3D11_FILL_SOLID;
+        rsd.CullMode = D3D11_CULL_NONE;
+        rsd.DepthClipEnable = FALSE;
+        rsd.SlopeScaledDepthBias = SLOPE_DEPTH_BIAS;
+        if (FAILED(device->CreateRasterizerState(&rsd, rasterState_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[CascadedShadowMaps] ラスタライザーステートの作成失敗");
+            return false;
+        }
+
+        // 位置の形式ごと(深度だけ描くためピクセルシェーダーなし)
+        PipelineStateDesc desc;
+        desc.vertexShader = vs_.Get();
+        desc.rasterizerState = rasterState_.Get();
+        desc.inputLayout = layoutFloat_.Get();
+        pipelines_[0] = PipelineState(desc);
+        desc.inputLayout = layoutUnorm_.Get();
+        pipelines_[1] = PipelineState(desc);
+        return true;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layoutFloat_;      ///< float3 の位置(Standard / Compact)
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layoutUnorm_;      ///< 16ビット unorm の位置(CompactQuantized)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> batchCb_;               ///< BatchConstants
+    Microsoft::WRL::ComPtr<ID3D11Buffer> shadowCb_;              ///< ShadowConstants
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> texture_;            ///< シャドウマップ(スライスがカスケード)
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv_;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> dsvs_[CASCADE_COUNT];
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler_;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterState_;
+    PipelineState pipelines_[2];                                 ///< [0] layoutFloat_、[1] layoutUnorm_
+    Microsoft::WRL::ComPtr<ID3D11Buffer> worldBuffer_;           ///< キャスターのワールド行列(転置済み)
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> worldSrv_;
+    size_t worldCapacity_ = 0;
+
+    UINT resolution_ = DEFAULT_RESOLUTION;
+    float distance_ = DEFAULT_DISTANCE;
+    DirectX::XMFLOAT3 lightDirection_{ 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT4X4 viewProj_[CASCADE_COUNT] = {};           ///< 最後に描いたときの行列(転置前)
+    Frustum casterFrustums_[CASCADE_COUNT] = {};
+    std::vector<Caster> casters_[CASCADE_COUNT];
+    ShadowConstants constants_;
+    Statistics stats_;
+    uint64_t frame_ = 0;
+    uint32_t pending_ = 0;                                       ///< このフレームに描き直すカスケード
+    bool refreshAll_ = true;
+    bool enabled_ = false;                                       ///< ピクセルシェーダーの定数が有効なカスケードを持つか
+
+    // Render() 中のバインド状態
+    ID3D11Buffer* boundVertexBuffer_ = nullptr;
+    ID3D11Buffer* boundIndexBuffer_ = nullptr;
+    DXGI_FORMAT boundIndexFormat_ = DXGI_FORMAT_UNKNOWN;
+    UINT boundStride_ = 0;
+    UINT boundOffset_ = 0;
+};
@@ -0,0 +1,172 @@
+/**
+ * @file ConstantBufferRing.h
+ * @brief 動的定数バッファのリングアロケータ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 1つの大きな D3D11_USAGE_DYNAMIC 定数バッファを256バイト単位で切り出して使います。
+ * 前回の続きから MAP_WRITE_NO_OVERWRITE で書き込み、末尾に達したときだけ MAP_WRITE_DISCARD で
+ * 先頭に戻るため、オブジェクトごとの定数更新は memcpy とオフセット付きバインドだけになります。
+ * オフセット付きバインド(VSSetConstantBuffers1 など)には D3D11.1 が必要です。
+ */
+#pragma once
+#include <d3d11.h>
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <string>
+#include "app/DebugLog.h"
+
+/**
+ * @class ConstantBufferRing
+ * @brief 定数バッファのサブアロケーション
+ *
+ * @par 使用例
+ * @code
+ * ConstantBufferRing ring;
+ * ring.Init(gfx.Dev(), 4 * 1024 * 1024);
+ *
+ * ConstantBufferRing::Span span;
+ * UINT stride = ConstantBufferRing::AlignedSize(sizeof(VSConstants));
+ * if (ring.Map(gfx.Ctx(), count, stride, span)) {
+ *     for (UINT i = 0; i < span.count; ++i) {
+ *         std::memcpy(span.Element(i), &constants[i], sizeof(VSConstants));
+ *     }
+ *     ring.Unmap(gfx.Ctx());
+ *     for (UINT i = 0; i < span.count; ++i) {
+ *         UINT first = span.FirstConstant(i), num = span.NumConstants();
+ *         gfx.Ctx1()->VSSetConstantBuffers1(0, 1, ring.BufferAddress(), &first, &num);
+ *         // Draw...
+ *     }
+ * }
+ * @endcode
+ */
+class ConstantBufferRing {
+public:
+    static constexpr UINT ALIGNMENT = 256;           ///< オフセットの単位(バイト、定数16個分)
+    static constexpr UINT MAX_BIND_SIZE = 64 * 1024; ///< 1回のバインドで参照できる最大サイズ(バイト)
+
+    /**
+     * @struct Span
+     * @brief Map() で確保した連続領域
+     */
+    struct Span {
+        uint8_t* data = nullptr;  ///< 書き込み先の先頭
+        UINT firstConstant = 0;   ///< 先頭要素の位置(16バイト定数単位)
+        UINT stride = 0;          ///< 1要素のバイト数(ALIGNMENT の倍数)
+        UINT count = 0;           ///< 確保できた要素数
+
+        void* Element(UINT i) const { return data + static_cast<size_t>(i) * stride; }
+        UINT FirstConstant(UINT i) const { return firstConstant + i * (stride / 16); }
+        UINT NumConstants() const { return stride / 16; }
+    };
+
+    /**
+     * @brief バイト数を ALIGNMENT の倍数に切り上げ
+     */
+    static UINT AlignedSize(UINT bytes) {
+        return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    /**
+     * @brief バッファを作成
+     * @param[in] device デバイス
+     * @param[in] sizeBytes 容量(ALIGNMENT の倍数に切り上げ)
+     * @return bool 作成できた場合 true
+     */
+    bool Init(ID3D11Device* device, UINT sizeBytes) {
+        Shutdown();
+
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = AlignedSize(sizeBytes);
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        HRESULT hr = device->CreateBuffer(&desc, nullptr, buffer_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ConstantBufferRing] バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        capacity_ = desc.ByteWidth;
+        cursor_ = capacity_; // 最初の Map で DISCARD するため末尾扱い
+        return true;
+    }
+
+    void Shutdown() {
+        buffer_.Reset();
+        capacity_ = 0;
+        cursor_ = 0;
+        mapped_ = false;
+    }
+
+    bool IsValid() const { return buffer_ != nullptr; }
+
+    /**
+     * @brief 要素を連続で確保してMap
+     * @param[in] context デバイスコンテキスト
+     * @param[in] count 要素数
+     * @param[in] stride 1要素のバイト数(ALIGNMENT の倍数に切り上げ)
+     * @param[out] out 確保した領域(容量不足の場合 count より少ないことがある)
+     * @return bool 1要素以上確保できた場合 true(Unmap() が必要)
+     *
+     * @details
+     * 残り容量で足りる場合は MAP_WRITE_NO_OVERWRITE で続きに書き込み、
+     * 足りない場合は MAP_WRITE_DISCARD でバッファを差し替えて先頭から確保します。
+     */
+    bool Map(ID3D11DeviceContext* context, UINT count, UINT stride, Span& out) {
+        out = Span();
+        if (!buffer_ || mapped_ || count == 0) return false;
+
+        stride = AlignedSize(stride);
+        if (stride > capacity_ || stride > MAX_BIND_SIZE) return false;
+
+        D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+        if (cursor_ + stride > capacity_) {
+            mapType = D3D11_MAP_WRITE_DISCARD;
+            cursor_ = 0;
+            ++wraps_;
+        }
+
+        UINT fit = (capacity_ - cursor_) / stride;
+        if (count > fit) count = fit;
+
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        HRESULT hr = context->Map(buffer_.Get(), 0, mapType, 0, &mapped);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ConstantBufferRing] Map失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        out.data = static_cast<uint8_t*>(mapped.pData) + cursor_;
+        out.firstConstant = cursor_ / 16;
+        out.stride = stride;
+        out.count = count;
+        cursor_ += count * stride;
+        mapped_ = true;
+        return true;
+    }
+
+    void Unmap(ID3D11DeviceContext* context) {
+        if (!mapped_) return;
+        context->Unmap(buffer_.Get(), 0);
+        mapped_ = false;
+    }
+
+    ID3D11Buffer* Buffer() const { return buffer_.Get(); }
+    ID3D11Buffer* const* BufferAddress() const { return buffer_.GetAddressOf(); }
+
+    /**
+     * @brief 先頭に戻った(DISCARD した)回数
+     */
+    size_t WrapCount() const { return wraps_; }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11Buffer> buffer_; ///< 動的定数バッファ
+    UINT capacity_ = 0;                           ///< 容量(バイト)
+    UINT cursor_ = 0;                             ///< 次の確保位置(バイト)
+    size_t wraps_ = 0;                            ///< DISCARD の回数
+    bool mapped_ = false;                         ///< Map中か
+};
@@ -3,12 +3,15 @@
  * @brief デバッグ用の線描画システム
  * @author 山内陽
  * @date 2025
- * @version 6.0
+ * @version 7.0
  */
 #pragma once
 #include "graphics/GfxDevice.h"
 #include "graphics/Camera.h"
 #include "app/DebugLog.h"
+#include "app/MemoryTracker.h"
+#include "graphics/ShaderCache.h"
+#include "app/JobSystem.h"
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 #include <wrl/client.h>
@@ -17,6 +20,11 @@
 #include <cstdio>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <utility>
 
 #pragma comment(lib, "d3dcompiler.lib")
 
@@ -29,10 +37,14 @@
  * ワールド空間でのデバッグ情報の可視化に使用します。
  *
  * ### 主な機能:
- * - 高パフォーマンスな線描画
- * - 動的頂点バッファの効率的な管理
+ * - AddLine() は頂点形式のまま配列に追加し、Render() で1回の memcpy でリングバッファへ転送
+ * - 頂点バッファはリングとして使い、空きがある間は D3D11_MAP_WRITE_NO_OVERWRITE で追記
+ *   (一周したときだけ DISCARD)。容量を超えた場合は線を捨てずにバッファを拡張
+ * - ボックス・球・矢印・視錐台は単位形状のインスタンス描画(形状ごとに1ドローコール)
+ * - スレッドごとのバッファに記録するため、JobSystem のワーカーからもロックなしで追加可能
+ * - 寿命(秒・フレーム)付きの線と形状は保持用バッファに残し、増減したときだけ転送
+ * - 深度テストあり(既定)と、常に手前に描くオーバーレイの2モード
  * - 描画統計の自動収集
- * - エラーハンドリングの強化
  *
  * ### 主な用途:
  * - グリッド表示(基準となる平面)
@@ -45,7 +57,7 @@
  * DebugDraw debugDraw;
  * if (!debugDraw.Init(gfx)) {
  *     // 初期化失敗
- * return false;
+ *     return false;
  * }
  *
  * // グリッドと軸を描画
@@ -56,9 +68,13 @@
  * debugDraw.AddLine(
  *     DirectX::XMFLOAT3{0, 0, 0},
  *     DirectX::XMFLOAT3{5, 5, 5},
- *   DirectX::XMFLOAT3{1, 1, 0}  // 黄色
+ *     DirectX::XMFLOAT3{1, 1, 0}  // 黄色
  * );
  *
+ * // 形状(インスタンス描画)
+ * debugDraw.DrawSphere(DirectX::XMFLOAT3{0, 1, 0}, 0.5f, DirectX::XMFLOAT3{1, 0, 0});
+ * debugDraw.DrawArrow(DirectX::XMFLOAT3{0, 0, 0}, DirectX::XMFLOAT3{0, 2, 0}, DirectX::XMFLOAT3{0, 1, 0});
+ *
  * // 描画実行
  * debugDraw.Render(gfx, camera);
  *
@@ -66,8 +82,24 @@
  * debugDraw.Clear();
  * @endcode
  *
+ * @par スレッド
+ * AddLine() / DrawShape() などの追加は、メインスレッドと SetJobSystem() で設定したジョブシステムの
+ * ワーカーから呼び出せます(ワーカーは自分専用のバッファに書くためロックしません)。
+ * Render() / Clear() はメインスレッドから、追加するジョブが動いていない間に呼んでください。
+ * Render() はメインスレッド、ワーカー0、1... の順にバッファを連結して転送します。
+ *
+ * @par 寿命付きの描画
+ * 経路や当たり判定の履歴のように何フレームも残す線は、Lifetime を渡して一度だけ追加します。
+ * 毎フレームの Clear() では消えず、Update() で寿命が切れたものだけが取り除かれます。
+ * @code
+ * debugDraw.AddLine(from, to, color, DebugDraw::Lifetime::Seconds(2.0f));
+ * debugDraw.DrawShape(DebugDraw::SHAPE_SPHERE, world, color, DebugDraw::Lifetime::Frames(30), DebugDraw::DEPTH_OVERLAY);
+ *
+ * // 毎フレーム(Render() の前)
+ * debugDraw.Update(deltaTime);
+ * @endcode
+ *
  * @note デバッグビルド(_DEBUG定義時)のみ使用を推奨
- * @note C++14準拠
  *
  * @author 山内陽
  */
@@ -77,27 +109,82 @@ public:
      * @struct Line
      * @brief 線分の定義(開始点、終了点、色)
      */
-struct Line {
+    struct Line {
         DirectX::XMFLOAT3 start; ///< 線の開始点
         DirectX::XMFLOAT3 end;   ///< 線の終了点
         DirectX::XMFLOAT3 color; ///< 線の色(RGB: 0.0～1.0)
     };
 
+    /**
+     * @enum Shape
+     * @brief インスタンス描画する単位形状
+     */
+    enum Shape : uint32_t {
+        SHAPE_BOX = 0,  ///< 中心原点・半径1の立方体(12本)
+        SHAPE_SPHERE,   ///< 半径1の球(XY / XZ / YZ 平面の円)
+        SHAPE_ARROW,    ///< 原点から +Z の長さ1の矢印(軸と4本の矢じり)
+        SHAPE_FRUSTUM,  ///< NDC の立方体(x, y: -1～1, z: 0～1)。逆ビュー射影行列で視錐台になる
+        SHAPE_COUNT
+    };
+
+    /**
+     * @enum DepthMode
+     * @brief 深度の扱い
+     */
+    enum DepthMode : uint32_t {
+        DEPTH_TEST = 0,  ///< シーンの深度でテストする(深度は書き込まない)
+        DEPTH_OVERLAY,   ///< 深度を無視して常に手前に描く
+        DEPTH_MODE_COUNT
+    };
+
+    /**
+     * @struct Lifetime
+     * @brief 寿命付きの線・形状が残る長さ(秒かフレーム数のどちらか)
+     */
+    struct Lifetime {
+        float seconds = 0.0f; ///< 秒(frames が 0 の場合に使用)
+        uint32_t frames = 0;  ///< フレーム数(Render() される回数)
+
+        static Lifetime Seconds(float s) {
+            Lifetime lifetime;
+            lifetime.seconds = s;
+            return lifetime;
+        }
+
+        static Lifetime Frames(uint32_t f) {
+            Lifetime lifetime;
+            lifetime.frames = f;
+            return lifetime;
+        }
+    };
+
+    static constexpr int SPHERE_SEGMENTS = 24; ///< 単位球の円の分割数
+
     /**
      * @struct Statistics
      * @brief 描画統計情報
      */
     struct Statistics {
-      size_t linesDrawn = 0;        ///< 描画された線の数
-  size_t linesDropped = 0;      ///< 容量不足で破棄された線の数
-        size_t totalLinesAdded = 0;   ///< 追加された線の総数
-size_t peakLineCount = 0;     ///< ピーク時の線の数
+        size_t linesDrawn = 0;      ///< 描画された線の数(AddLine 分、寿命付きを含む)
+        size_t linesDropped = 0;    ///< 描画できなかった線の数(バッファを拡張できない・バッファのないワーカーから追加)
+        size_t totalLinesAdded = 0; ///< 追加された線の総数(Render() の時点で集計)
+        size_t peakLineCount = 0;   ///< 1フレームの線の数の最大
+        size_t shapesDrawn = 0;     ///< 描画された形状のインスタンス数
+        size_t drawCalls = 0;       ///< 直前の Render() のドローコール数
+        size_t bufferGrowths = 0;   ///< 頂点・インスタンスバッファを拡張した回数
+        size_t persistentCount = 0;   ///< 保持している寿命付きの線と形状の数
+        size_t persistentUploads = 0; ///< 保持用バッファを転送し直した回数
 
         void Reset() {
-    linesDrawn = 0;
+            linesDrawn = 0;
             linesDropped = 0;
             totalLinesAdded = 0;
-       peakLineCount = 0;
+            peakLineCount = 0;
+            shapesDrawn = 0;
+            drawCalls = 0;
+            bufferGrowths = 0;
+            persistentCount = 0;
+            persistentUploads = 0;
         }
     };
 
@@ -114,98 +201,98 @@ size_t peakLineCount = 0;     ///< ピーク時の線の数
 
     /**
      * @brief ムーブ許可
-*/
-DebugDraw(DebugDraw&& other) noexcept
-        : vs_(std::move(other.vs_))
-, ps_(std::move(other.ps_))
-    , layout_(std::move(other.layout_))
-        , cb_(std::move(other.cb_))
-        , vb_(std::move(other.vb_))
-    , lines_(std::move(other.lines_))
- , maxLines_(other.maxLines_)
-        , isShutdown_(other.isShutdown_)
-  , initialized_(other.initialized_)
-        , stats_(other.stats_)
-    {
-        other.initialized_ = false;
-        other.isShutdown_ = true;
+     */
+    DebugDraw(DebugDraw&& other) noexcept {
+        swap(other);
     }
 
     DebugDraw& operator=(DebugDraw&& other) noexcept {
-   if (this != &other) {
-      Shutdown();
-    
-            vs_ = std::move(other.vs_);
-            ps_ = std::move(other.ps_);
-    layout_ = std::move(other.layout_);
-          cb_ = std::move(other.cb_);
-            vb_ = std::move(other.vb_);
-       lines_ = std::move(other.lines_);
-          maxLines_ = other.maxLines_;
-     isShutdown_ = other.isShutdown_;
-            initialized_ = other.initialized_;
-  stats_ = other.stats_;
-            
-   other.initialized_ = false;
-     other.isShutdown_ = true;
-    }
+        if (this != &other) {
+            Shutdown();
+            swap(other);
+        }
         return *this;
     }
 
     /**
-   * @brief 初期化
+     * @brief 初期化
      * @param[in] gfx グラフィックスデバイス
-     * @param[in] maxLines 最大線数(デフォルト: 10000)
+     * @param[in] maxLines 線の頂点バッファの初期容量(デフォルト: 10000、超えた場合は拡張)
      * @return bool 初期化が成功した場合は true
      *
-* @details
-     * シェーダーのコンパイル、パイプラインステートの作成、
-     * 動的頂点バッファの作成を行います。
+     * @details
+     * シェーダーのコンパイル、単位形状の頂点バッファ、
+     * 動的な線の頂点バッファ・インスタンスバッファの作成を行います。
      */
     bool Init(GfxDevice& gfx, size_t maxLines = 10000) {
-        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Init() 開始 (最大線数: " + std::to_string(maxLines) + ")");
-        
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Init() 開始 (初期線数: " + std::to_string(maxLines) + ")");
+
         // 既に初期化済みの再初期化に対応
         if (initialized_) {
-       DEBUGLOG_WARNING("DebugDraw::Init() - 既に初期化されています。再初期化します。");
+            DEBUGLOG_WARNING("DebugDraw::Init() - 既に初期化されています。再初期化します。");
             Shutdown();
         }
 
-        maxLines_ = maxLines;
-        lines_.reserve(maxLines_);
+        SetJobSystem(nullptr); // メインスレッド用のバッファ
+        slots_[0]->lineVertices[DEPTH_TEST].reserve(maxLines * 2);
 
-  // シェーダーのコンパイル
+        // シェーダーのコンパイル
         if (!CompileShaders(gfx)) {
-      DEBUGLOG_ERROR("[DebugDraw] シェーダーのコンパイルに失敗しました");
-            return false;
-}
-
-      // パイプラインステートの作成
-        if (!CreatePipelineState(gfx)) {
-            DEBUGLOG_ERROR("[DebugDraw] パイプラインステートの作成に失敗しました");
+            DEBUGLOG_ERROR("[DebugDraw] シェーダーのコンパイルに失敗しました");
             return false;
         }
 
         // 定数バッファの作成
         if (!CreateConstantBuffer(gfx)) {
-    DEBUGLOG_ERROR("[DebugDraw] 定数バッファの作成に失敗しました");
-          return false;
+            DEBUGLOG_ERROR("[DebugDraw] 定数バッファの作成に失敗しました");
+            return false;
         }
 
-        // 動的頂点バッファの作成
-        if (!CreateVertexBuffer(gfx)) {
-            DEBUGLOG_ERROR("[DebugDraw] 頂点バッファの作成に失敗しました");
-         return false;
-      }
+        // 単位形状の頂点バッファの作成
+        if (!CreateShapeBuffer(gfx)) {
+            DEBUGLOG_ERROR("[DebugDraw] 形状の頂点バッファの作成に失敗しました");
+            return false;
+        }
+
+        // 動的バッファの作成
+        if (!lineRing_.Create(gfx, sizeof(Vertex), (std::max)(maxLines, size_t(1)) * 2) ||
+            !instanceRing_.Create(gfx, sizeof(ShapeInstance), INITIAL_INSTANCE_CAPACITY) ||
+            !retainedLineBuffer_.Create(gfx, sizeof(Vertex), INITIAL_RETAINED_CAPACITY) ||
+            !retainedInstanceBuffer_.Create(gfx, sizeof(ShapeInstance), INITIAL_RETAINED_CAPACITY)) {
+            DEBUGLOG_ERROR("[DebugDraw] 動的頂点バッファの作成に失敗しました");
+            return false;
+        }
+
+        // 深度ステートの作成
+        if (!CreateDepthStates(gfx)) {
+            DEBUGLOG_ERROR("[DebugDraw] 深度ステートの作成に失敗しました");
+            return false;
+        }
+        CreatePipelineStates();
 
         initialized_ = true;
         isShutdown_ = false;
         stats_.Reset();
-        
-   DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Init() 正常に完了");
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Init() 正常に完了");
         return true;
     }
 
+    /**
+     * @brief ワーカーごとのバッファを用意する(ジョブから追加する場合に、ジョブを投入する前に呼ぶ)
+     * @param[in] jobs ジョブシステム(nullptr の場合はメインスレッド用のみ)
+     *
+     * @details
+     * World::SetJobSystem() と同じく、追加のたびにロックを取らないよう事前に確保します。
+     * バッファは減らしません。
+     */
+    void SetJobSystem(JobSystem* jobs) {
+        const size_t count = 1 + (jobs ? jobs->WorkerCount() : 0);
+        while (slots_.size() < count) {
+            slots_.push_back(std::make_unique<ThreadSlot>());
+        }
+    }
+
     /**
      * @brief 初期化状態を確認
      * @return bool 初期化済みの場合は true
@@ -219,10 +306,11 @@ DebugDraw(DebugDraw&& other) noexcept
      * @param[in] start 線の開始点
      * @param[in] end 線の終了点
      * @param[in] color 線の色(RGB: 0.0～1.0)
+     * @param[in] mode 深度の扱い(デフォルト: 深度テストあり)
      *
      * @details
-     * 描画する線をリストに追加します。
-     * 実際の描画はRender()呼び出し時に行われます。
+     * 呼び出しスレッドの配列に頂点形式のまま追加します。実際の転送と描画はRender()呼び出し時に行われます。
+     * 上限はありません(頂点バッファに収まらない場合は Render() で拡張します)。
      *
      * @par 使用例
      * @code
@@ -234,129 +322,168 @@ DebugDraw(DebugDraw&& other) noexcept
      * );
      * @endcode
      */
-    void AddLine(const DirectX::XMFLOAT3& start, const DirectX::XMFLOAT3& end, const DirectX::XMFLOAT3& color) {
-      if (!initialized_) {
+    void AddLine(const DirectX::XMFLOAT3& start, const DirectX::XMFLOAT3& end, const DirectX::XMFLOAT3& color,
+                 DepthMode mode = DEPTH_TEST) {
+        if (!initialized_) {
             DEBUGLOG_WARNING("[DebugDraw] 初期化されていません。AddLine()を無視します。");
-       return;
+            return;
         }
 
- if (lines_.size() >= maxLines_) {
-            stats_.linesDropped++;
-     
-// 最初の警告のみログ出力
-    static bool warningShown = false;
-   if (!warningShown) {
-             DEBUGLOG_WARNING("[DebugDraw] 線の上限に到達 (" + std::to_string(maxLines_) + ")。これ以降の線は破棄されます。");
-          warningShown = true;
-            }
-   return;
+        ThreadSlot* slot = threadSlot();
+        if (!slot) return;
+        slot->lineVertices[mode].push_back(Vertex{ start, color });
+        slot->lineVertices[mode].push_back(Vertex{ end, color });
+    }
+
+    /**
+     * @brief 寿命付きの線を追加
+     * @param[in] lifetime 残す長さ(Lifetime::Seconds / Lifetime::Frames)
+     *
+     * @details
+     * Clear() では消えず、寿命が切れるまで毎フレーム描画されます。
+     * 次の Render() で保持用バッファに移り、以降は増減があったときだけ転送し直します。
+     */
+    void AddLine(const DirectX::XMFLOAT3& start, const DirectX::XMFLOAT3& end, const DirectX::XMFLOAT3& color,
+                 const Lifetime& lifetime, DepthMode mode = DEPTH_TEST) {
+        if (!initialized_) {
+            DEBUGLOG_WARNING("[DebugDraw] 初期化されていません。AddLine()を無視します。");
+            return;
+        }
+
+        ThreadSlot* slot = threadSlot();
+        if (!slot) return;
+        PendingLine pending;
+        pending.vertices[0] = Vertex{ start, color };
+        pending.vertices[1] = Vertex{ end, color };
+        pending.lifetime = lifetime;
+        pending.mode = mode;
+        slot->pendingLines.push_back(pending);
+    }
+
+    /**
+     * @brief 単位形状をワールド行列で配置して描画
+     * @param[in] shape 形状
+     * @param[in] world 単位形状に掛けるワールド行列(射影行列の逆行列も可)
+     * @param[in] color 色
+     * @param[in] mode 深度の扱い(デフォルト: 深度テストあり)
+     */
+    void DrawShape(Shape shape, const DirectX::XMMATRIX& world, const DirectX::XMFLOAT3& color,
+                   DepthMode mode = DEPTH_TEST) {
+        if (!initialized_) {
+            DEBUGLOG_WARNING("[DebugDraw] 初期化されていません。DrawShape()を無視します。");
+            return;
         }
-        
-     lines_.push_back({ start, end, color });
-      stats_.totalLinesAdded++;
-     stats_.peakLineCount = (std::max)(stats_.peakLineCount, lines_.size());
+
+        ThreadSlot* slot = threadSlot();
+        if (!slot) return;
+        ShapeInstance instance;
+        DirectX::XMStoreFloat4x4(&instance.world, world);
+        instance.color = color;
+        slot->shapes[mode][shape].push_back(instance);
+    }
+
+    /**
+     * @brief 寿命付きの単位形状を追加
+     * @param[in] lifetime 残す長さ(Lifetime::Seconds / Lifetime::Frames)
+     */
+    void DrawShape(Shape shape, const DirectX::XMMATRIX& world, const DirectX::XMFLOAT3& color,
+                   const Lifetime& lifetime, DepthMode mode = DEPTH_TEST) {
+        if (!initialized_) {
+            DEBUGLOG_WARNING("[DebugDraw] 初期化されていません。DrawShape()を無視します。");
+            return;
+        }
+
+        ThreadSlot* slot = threadSlot();
+        if (!slot) return;
+        PendingShape pending;
+        DirectX::XMStoreFloat4x4(&pending.instance.world, world);
+        pending.instance.color = color;
+        pending.lifetime = lifetime;
+        pending.mode = mode;
+        pending.shape = shape;
+        slot->pendingShapes.push_back(pending);
     }
 
     /**
      * @brief ボックスを描画
      * @param[in] center ボックスの中心
-   * @param[in] halfExtents ボックスの半分のサイズ
+     * @param[in] halfExtents ボックスの半分のサイズ
      * @param[in] color ボックスの色
      *
      * @details
-     * ワイヤーフレームのボックスを描画します。
+     * ワイヤーフレームのボックスを描画します(単位立方体のインスタンス1つ)。
      * 当たり判定の可視化に便利です。
      */
     void DrawBox(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& halfExtents, const DirectX::XMFLOAT3& color) {
-        float minX = center.x - halfExtents.x;
-    float maxX = center.x + halfExtents.x;
-        float minY = center.y - halfExtents.y;
-        float maxY = center.y + halfExtents.y;
-        float minZ = center.z - halfExtents.z;
-        float maxZ = center.z + halfExtents.z;
-
-  // Front face
-        AddLine({minX, minY, minZ}, {maxX, minY, minZ}, color);
-        AddLine({maxX, minY, minZ}, {maxX, maxY, minZ}, color);
-        AddLine({maxX, maxY, minZ}, {minX, maxY, minZ}, color);
-      AddLine({minX, maxY, minZ}, {minX, minY, minZ}, color);
-
-        // Back face
-        AddLine({minX, minY, maxZ}, {maxX, minY, maxZ}, color);
-        AddLine({maxX, minY, maxZ}, {maxX, maxY, maxZ}, color);
-  AddLine({maxX, maxY, maxZ}, {minX, maxY, maxZ}, color);
-        AddLine({minX, maxY, maxZ}, {minX, minY, maxZ}, color);
+        DrawShape(SHAPE_BOX,
+                  DirectX::XMMatrixScaling(halfExtents.x, halfExtents.y, halfExtents.z) *
+                  DirectX::XMMatrixTranslation(center.x, center.y, center.z),
+                  color);
+    }
 
-        // Connections
- AddLine({minX, minY, minZ}, {minX, minY, maxZ}, color);
-     AddLine({maxX, minY, minZ}, {maxX, minY, maxZ}, color);
-        AddLine({maxX, maxY, minZ}, {maxX, maxY, maxZ}, color);
-        AddLine({minX, maxY, minZ}, {minX, maxY, maxZ}, color);
+    /**
+     * @brief 回転したボックスを描画
+     * @param[in] world 単位立方体(-1～1)に掛けるワールド行列
+     * @param[in] color ボックスの色
+     */
+    void DrawBox(const DirectX::XMMATRIX& world, const DirectX::XMFLOAT3& color) {
+        DrawShape(SHAPE_BOX, world, color);
     }
 
     /**
      * @brief 球を描画
      * @param[in] center 球の中心
- * @param[in] radius 球の半径
-* @param[in] color 球の色
-     * @param[in] segments 分割数(デフォルト: 16)
+     * @param[in] radius 球の半径
+     * @param[in] color 球の色
+     * @param[in] segments 互換のため残している引数(分割数は SPHERE_SEGMENTS で固定)
      *
      * @details
-   * ワイヤーフレームの球を描画します。
-   */
-    void DrawSphere(const DirectX::XMFLOAT3& center, float radius, const DirectX::XMFLOAT3& color, int segments = 16) {
-   const float angleStep = DirectX::XM_2PI / segments;
-
-        // XY平面の円
-        for (int i = 0; i < segments; ++i) {
-       float angle1 = angleStep * i;
-            float angle2 = angleStep * (i + 1);
-  DirectX::XMFLOAT3 p1{
-        center.x + radius * cosf(angle1),
-center.y + radius * sinf(angle1),
-        center.z
-   };
-   DirectX::XMFLOAT3 p2{
-           center.x + radius * cosf(angle2),
-           center.y + radius * sinf(angle2),
-     center.z
-   };
-AddLine(p1, p2, color);
-        }
-
-    // XZ平面の円
-        for (int i = 0; i < segments; ++i) {
-    float angle1 = angleStep * i;
-       float angle2 = angleStep * (i + 1);
-            DirectX::XMFLOAT3 p1{
- center.x + radius * cosf(angle1),
-          center.y,
-      center.z + radius * sinf(angle1)
-            };
-          DirectX::XMFLOAT3 p2{
-    center.x + radius * cosf(angle2),
-     center.y,
-    center.z + radius * sinf(angle2)
-    };
-      AddLine(p1, p2, color);
- }
+     * ワイヤーフレームの球を描画します(単位球のインスタンス1つ)。
+     */
+    void DrawSphere(const DirectX::XMFLOAT3& center, float radius, const DirectX::XMFLOAT3& color, int segments = SPHERE_SEGMENTS) {
+        (void)segments;
+        DrawShape(SHAPE_SPHERE,
+                  DirectX::XMMatrixScaling(radius, radius, radius) * DirectX::XMMatrixTranslation(center.x, center.y, center.z),
+                  color);
+    }
 
-        // YZ平面の円
-        for (int i = 0; i < segments; ++i) {
-            float angle1 = angleStep * i;
-      float angle2 = angleStep * (i + 1);
- DirectX::XMFLOAT3 p1{
-    center.x,
- center.y + radius * cosf(angle1),
-       center.z + radius * sinf(angle1)
-   };
-            DirectX::XMFLOAT3 p2{
-        center.x,
-        center.y + radius * cosf(angle2),
-center.z + radius * sinf(angle2)
- };
-       AddLine(p1, p2, color);
-        }
+    /**
+     * @brief 矢印を描画
+     * @param[in] from 始点
+     * @param[in] to 終点(矢じりの位置)
+     * @param[in] color 色
+     *
+     * @details
+     * 矢じりの大きさは長さに比例します(長さの 20%)。
+     */
+    void DrawArrow(const DirectX::XMFLOAT3& from, const DirectX::XMFLOAT3& to, const DirectX::XMFLOAT3& color) {
+        using namespace DirectX;
+        XMVECTOR origin = XMLoadFloat3(&from);
+        XMVECTOR axis = XMVectorSubtract(XMLoadFloat3(&to), origin);
+        float length = XMVectorGetX(XMVector3Length(axis));
+        if (length <= 0.0f) return;
+
+        XMVECTOR dir = XMVectorScale(axis, 1.0f / length);
+        XMVECTOR up = std::fabs(XMVectorGetY(dir)) < 0.99f ? XMVectorSet(0, 1, 0, 0) : XMVectorSet(1, 0, 0, 0);
+        XMVECTOR side = XMVector3Normalize(XMVector3Cross(up, dir));
+        XMVECTOR up2 = XMVector3Cross(dir, side);
+
+        XMMATRIX world;
+        world.r[0] = XMVectorScale(side, length);
+        world.r[1] = XMVectorScale(up2, length);
+        world.r[2] = axis;
+        world.r[3] = XMVectorSetW(origin, 1.0f);
+        DrawShape(SHAPE_ARROW, world, color);
+    }
+
+    /**
+     * @brief 視錐台を描画
+     * @param[in] viewProj 視錐台を表すビュー射影行列(例: cam.ViewProj)
+     * @param[in] color 色
+     */
+    void DrawFrustum(const DirectX::XMMATRIX& viewProj, const DirectX::XMFLOAT3& color) {
+        DirectX::XMVECTOR det;
+        DrawShape(SHAPE_FRUSTUM, DirectX::XMMatrixInverse(&det, viewProj), color);
     }
 
     /**
@@ -370,47 +497,47 @@ center.z + radius * sinf(angle2)
      * X-Z平面にグリッドを描画します。
      * Y=yOffsetの平面に水平なグリッドが表示されます。
      *
-* @par 使用例
+     * @par 使用例
      * @code
      * // 20x20のグリッドを20本の線で描画
-  * debugDraw.DrawGrid(20.0f, 20);
+     * debugDraw.DrawGrid(20.0f, 20);
      * @endcode
      */
     void DrawGrid(float size = 10.0f, int divisions = 10, const DirectX::XMFLOAT3& color = {0.5f, 0.5f, 0.5f}, float yOffset = -0.01f) {
         if (divisions <= 0) {
             DEBUGLOG_WARNING("[DebugDraw] DrawGrid: divisionsは正の値である必要があります");
-  return;
+            return;
         }
 
         float step = size / divisions;
- float halfSize = size * 0.5f;
+        float halfSize = size * 0.5f;
 
         // X-Z平面のグリッド（yOffsetを適用）
         for (int i = 0; i <= divisions; ++i) {
- float pos = -halfSize + i * step;
+            float pos = -halfSize + i * step;
 
             // Z軸に平行な線(X方向に並ぶ)
-       AddLine(
-         DirectX::XMFLOAT3{-halfSize, yOffset, pos},
-    DirectX::XMFLOAT3{ halfSize, yOffset, pos},
-  color
-    );
+            AddLine(
+                DirectX::XMFLOAT3{-halfSize, yOffset, pos},
+                DirectX::XMFLOAT3{ halfSize, yOffset, pos},
+                color
+            );
 
-  // X軸に平行な線(Z方向に並ぶ)
+            // X軸に平行な線(Z方向に並ぶ)
             AddLine(
-            DirectX::XMFLOAT3{pos, yOffset, -halfSize},
-    DirectX::XMFLOAT3{pos, yOffset,  halfSize},
- color
-        );
+                DirectX::XMFLOAT3{pos, yOffset, -halfSize},
+                DirectX::XMFLOAT3{pos, yOffset,  halfSize},
+                color
+            );
         }
     }
 
     /**
-   * @brief 座標軸を描画
+     * @brief 座標軸を描画
      * @param[in] length 軸の長さ
-   *
+     *
      * @details
-   * X軸(赤)、Y軸(緑)、Z軸(青)を原点から描画します。
+     * X軸(赤)、Y軸(緑)、Z軸(青)を原点から描画します。
      * 3D空間の方向を確認するのに便利です。
      *
      * @par 使用例
@@ -418,124 +545,217 @@ center.z + radius * sinf(angle2)
      * // 5単位の長さの座標軸を描画
      * debugDraw.DrawAxes(5.0f);
      * @endcode
-*/
+     */
     void DrawAxes(float length = 500.0f) {
         if (length <= 0.0f) {
             DEBUGLOG_WARNING("[DebugDraw] DrawAxes: lengthは正の値である必要があります");
-    return;
+            return;
         }
 
         // X軸(明るい赤)
         AddLine(
-      DirectX::XMFLOAT3{0, 0, 0},
-         DirectX::XMFLOAT3{length, 0, 0},
+            DirectX::XMFLOAT3{0, 0, 0},
+            DirectX::XMFLOAT3{length, 0, 0},
             DirectX::XMFLOAT3{1, 0.2f, 0.2f}
-   );
+        );
 
         // Y軸(明るい緑)
         AddLine(
             DirectX::XMFLOAT3{0, 0, 0},
             DirectX::XMFLOAT3{0, length, 0},
             DirectX::XMFLOAT3{0.2f, 1, 0.2f}
-    );
+        );
 
         // Z軸(明るい青)
         AddLine(
-      DirectX::XMFLOAT3{0, 0, 0},
-     DirectX::XMFLOAT3{0, 0, length},
+            DirectX::XMFLOAT3{0, 0, 0},
+            DirectX::XMFLOAT3{0, 0, length},
             DirectX::XMFLOAT3{0.3f, 0.3f, 1}
-   );
+        );
     }
 
     /**
-     * @brief すべての線を描画
-   * @param[in] gfx グラフィックスデバイス
-   * @param[in] cam カメラ
+     * @brief 寿命付きの線と形状の時間を進める(毎フレーム、Render() の前に呼ぶ)
+     * @param[in] deltaTime 前のフレームからの経過時間(秒)
      *
-  * @details
-     * AddLine()やDrawGrid()などで追加されたすべての線を描画します。
+     * @details
+     * 寿命が切れたものを取り除き、保持用バッファを次の Render() で転送し直します。
+     * 最も早く切れるものの時刻を控えているため、切れるものがないフレームは走査しません。
+     */
+    void Update(float deltaTime) {
+        clock_ += deltaTime;
+        ++frame_;
+        if (clock_ >= nextExpiry_.time || frame_ >= nextExpiry_.frame) {
+            RemoveExpired();
+        }
+    }
+
+    /**
+     * @brief 寿命付きの線と形状をすべて消す
+     */
+    void ClearPersistent() {
+        for (auto& slot : slots_) {
+            slot->pendingLines.clear();
+            slot->pendingShapes.clear();
+        }
+        for (auto& set : retained_) set.Clear();
+        nextExpiry_ = Expiry();
+        retainedDirty_ = true;
+    }
+
+    /**
+     * @brief すべての線と形状を描画
+     * @param[in] gfx グラフィックスデバイス
+     * @param[in] cam カメラ
+     *
+     * @details
+     * 深度モードごとに、毎フレームの線を1回の Draw、寿命付きの線を1回の Draw、
+     * 形状を種類ごとに1回の DrawInstanced で描画します(空のものは省略)。
+     * 寿命付きのものは保持用バッファに残っているため、増減がないフレームは転送しません。
      * カメラのView・Projection行列を使用してワールド空間から画面空間に変換します。
      */
     void Render(GfxDevice& gfx, const Camera& cam) {
         if (!initialized_) {
             DEBUGLOG_WARNING("[DebugDraw] 初期化されていません。Render()を無視します。");
-        return;
+            return;
         }
 
-     if (lines_.empty()) {
-   return;
- }
-
-        // 頂点データを構築
-        std::vector<Vertex> vertices;
-        vertices.reserve(lines_.size() * 2);
+        stats_.drawCalls = 0;
+        stats_.linesDrawn = 0;
+        stats_.shapesDrawn = 0;
+        stats_.linesDropped += unslottedDropped_.exchange(0, std::memory_order_relaxed);
 
-        for (const auto& line : lines_) {
-      vertices.push_back({ line.start, line.color });
-            vertices.push_back({ line.end, line.color });
-   }
+        // 寿命付きの追加分を保持用の配列へ移し、増減があれば転送し直す
+        MergePending();
+        if (retainedDirty_) {
+            retainedReady_ = UploadRetained(gfx);
+            retainedDirty_ = !retainedReady_;
+        }
 
-        // 頂点バッファを更新
-  D3D11_MAPPED_SUBRESOURCE mapped;
-        HRESULT hr = gfx.Ctx()->Map(vb_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
-        if (FAILED(hr)) {
-         DEBUGLOG_ERROR("[DebugDraw] 頂点バッファのマップ失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+        size_t lineCounts[DEPTH_MODE_COUNT] = {};
+        size_t shapeCounts[DEPTH_MODE_COUNT][SHAPE_COUNT] = {};
+        size_t lineVertexTotal = 0;
+        size_t shapeTotal = 0;
+        for (const auto& slot : slots_) {
+            for (uint32_t m = 0; m < DEPTH_MODE_COUNT; ++m) {
+                lineCounts[m] += slot->lineVertices[m].size();
+                lineVertexTotal += slot->lineVertices[m].size();
+                for (uint32_t t = 0; t < SHAPE_COUNT; ++t) {
+                    shapeCounts[m][t] += slot->shapes[m][t].size();
+                    shapeTotal += slot->shapes[m][t].size();
+                }
+            }
+        }
+        stats_.totalLinesAdded += lineVertexTotal / 2;
+        stats_.peakLineCount = (std::max)(stats_.peakLineCount, lineVertexTotal / 2);
+        stats_.persistentCount = GetPersistentCount();
+        if (lineVertexTotal == 0 && shapeTotal == 0 && (!retainedReady_ || stats_.persistentCount == 0)) {
             return;
-     }
-  
-  memcpy(mapped.pData, vertices.data(), vertices.size() * sizeof(Vertex));
-        gfx.Ctx()->Unmap(vb_.Get(), 0);
-
-        // パイプライン設定
-        gfx.Ctx()->IASetInputLayout(layout_.Get());
-        gfx.Ctx()->VSSetShader(vs_.Get(), nullptr, 0);
-        gfx.Ctx()->PSSetShader(ps_.Get(), nullptr, 0);
-        gfx.Ctx()->VSSetConstantBuffers(0, 1, cb_.GetAddressOf());
+        }
 
-        UINT stride = sizeof(Vertex);
-        UINT offset = 0;
-        gfx.Ctx()->IASetVertexBuffers(0, 1, vb_.GetAddressOf(), &stride, &offset);
-      gfx.Ctx()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+        ID3D11DeviceContext* ctx = gfx.Ctx();
+        StateCache& states = gfx.States();
 
         // 定数バッファ更新(ワールド行列は単位行列)
-    DirectX::XMMATRIX VP = DirectX::XMMatrixTranspose(cam.View * cam.Proj);
-        gfx.Ctx()->UpdateSubresource(cb_.Get(), 0, nullptr, &VP, 0, 0);
+        DirectX::XMMATRIX VP = DirectX::XMMatrixTranspose(cam.ViewProj);
+        ctx->UpdateSubresource(cb_.Get(), 0, nullptr, &VP, 0, 0);
+        states.SetVSConstantBuffer(0, cb_.Get());
+
+        // 線: モードごと(その中はスレッド順)に連結してリングへ1回で転送
+        size_t lineCursor = 0;
+        if (lineVertexTotal > 0) {
+            uint8_t* dst = BeginWrite(gfx, lineRing_, lineVertexTotal, lineCursor);
+            if (dst) {
+                for (uint32_t m = 0; m < DEPTH_MODE_COUNT; ++m) {
+                    for (const auto& slot : slots_) {
+                        const size_t bytes = slot->lineVertices[m].size() * sizeof(Vertex);
+                        if (bytes == 0) continue;
+                        std::memcpy(dst, slot->lineVertices[m].data(), bytes);
+                        dst += bytes;
+                    }
+                }
+                ctx->Unmap(lineRing_.buffer.Get(), 0);
+            } else {
+                stats_.linesDropped += lineVertexTotal / 2;
+                for (auto& count : lineCounts) count = 0;
+            }
+        }
 
-        // 描画
-        gfx.Ctx()->Draw(static_cast<UINT>(vertices.size()), 0);
-        
-        stats_.linesDrawn = lines_.size();
+        // 形状: モード・種類ごと(その中はスレッド順)に連結してリングへ1回で転送
+        size_t shapeCursor = 0;
+        if (shapeTotal > 0) {
+            uint8_t* dst = BeginWrite(gfx, instanceRing_, shapeTotal, shapeCursor);
+            if (dst) {
+                for (uint32_t m = 0; m < DEPTH_MODE_COUNT; ++m) {
+                    for (uint32_t t = 0; t < SHAPE_COUNT; ++t) {
+                        for (const auto& slot : slots_) {
+                            const size_t bytes = slot->shapes[m][t].size() * sizeof(ShapeInstance);
+                            if (bytes == 0) continue;
+                            std::memcpy(dst, slot->shapes[m][t].data(), bytes);
+                            dst += bytes;
+                        }
+                    }
+                }
+                ctx->Unmap(instanceRing_.buffer.Get(), 0);
+            } else {
+                for (auto& counts : shapeCounts) {
+                    for (auto& count : counts) count = 0;
+                }
+            }
+        }
+
+        // 保持用バッファはモード・種類の順に詰めてある
+        size_t retainedLineCursor = 0;
+        size_t retainedShapeCursor = 0;
+        for (uint32_t m = 0; m < DEPTH_MODE_COUNT; ++m) {
+            DrawLines(states, m, lineRing_, lineCounts[m], lineCursor);
+            DrawShapes(states, m, instanceRing_, shapeCounts[m], shapeCursor);
+
+            if (retainedReady_) {
+                const RetainedSet& set = retained_[m];
+                size_t retainedShapeCounts[SHAPE_COUNT];
+                for (uint32_t t = 0; t < SHAPE_COUNT; ++t) retainedShapeCounts[t] = set.shapes[t].size();
+                DrawLines(states, m, retainedLineBuffer_, set.lineVertices.size(), retainedLineCursor);
+                DrawShapes(states, m, retainedInstanceBuffer_, retainedShapeCounts, retainedShapeCursor);
+            }
+        }
+
+        // スロット1にインスタンスバッファを残さない(他の描画が頂点バッファ1つで描くため)
+        ID3D11Buffer* nullBuffer = nullptr;
+        UINT zero = 0;
+        ctx->IASetVertexBuffers(1, 1, &nullBuffer, &zero, &zero);
     }
 
     /**
      * @brief フレーム終了時にクリア
      *
- * @details
-     * 蓄積された線データをクリアします。
+     * @details
+     * 蓄積された線と形状をクリアします(容量は残すため、次のフレームで再確保しません)。
+     * 寿命付きのものは消えません(ClearPersistent() を使用)。
      * 毎フレーム呼び出す必要があります。
-  *
+     *
      * @par 使用例
      * @code
      * while (running) {
      *     // 線を追加
      *     debugDraw.DrawGrid(20.0f, 20);
      *
-     *   // 描画
+     *     // 描画
      *     debugDraw.Render(gfx, camera);
      *
-     *   // フレーム終了時にクリア
+     *     // フレーム終了時にクリア
      *     debugDraw.Clear();
      * }
      * @endcode
-   */
+     */
     void Clear() {
-        lines_.clear();
+        for (auto& slot : slots_) slot->Clear();
     }
 
     /**
      * @brief 統計情報を取得
      * @return const Statistics& 統計情報への参照
-   */
+     */
     const Statistics& GetStatistics() const {
         return stats_;
     }
@@ -544,34 +764,58 @@ center.z + radius * sinf(angle2)
      * @brief 統計情報をリセット
      */
     void ResetStatistics() {
- stats_.Reset();
- }
+        stats_.Reset();
+    }
 
     /**
      * @brief 現在の線の数を取得
      * @return size_t 現在の線の数
-  */
+     */
     size_t GetLineCount() const {
-        return lines_.size();
+        size_t vertices = 0;
+        for (const auto& slot : slots_) vertices += slot->lineVertices.size();
+        return vertices / 2;
     }
 
     /**
-     * @brief 最大線数を取得
-     * @return size_t 最大線数
+     * @brief 保持している寿命付きの線と形状の数を取得(次の Render() で移るものは含まない)
+     */
+    size_t GetPersistentCount() const {
+        size_t count = 0;
+        for (const auto& set : retained_) {
+            count += set.lineVertices.size() / 2;
+            for (const auto& list : set.shapes) count += list.size();
+        }
+        return count;
+    }
+
+    /**
+     * @brief 線の頂点バッファに収まる線の数を取得(超えた場合は Render() で拡張)
+     * @return size_t 線の数
      */
     size_t GetMaxLines() const {
-        return maxLines_;
-  }
+        return lineRing_.capacity / 2;
+    }
+
+    /**
+     * @brief 頂点・インスタンス・定数バッファのサイズ(バイト、MemoryTracker への報告用)
+     */
+    size_t GpuMemoryBytes() const {
+        return GfxDevice::BufferBytes(lineRing_.buffer.Get()) + GfxDevice::BufferBytes(instanceRing_.buffer.Get()) +
+               GfxDevice::BufferBytes(retainedLineBuffer_.buffer.Get()) +
+               GfxDevice::BufferBytes(retainedInstanceBuffer_.buffer.Get()) +
+               GfxDevice::BufferBytes(shapeVb_.Get()) + GfxDevice::BufferBytes(cb_.Get());
+    }
 
     /**
      * @brief デストラクタ
      */
     ~DebugDraw() {
         if (!isShutdown_) {
-    DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::~DebugDraw() - デストラクタ呼び出し");
- DEBUGLOG_WARNING("[DebugDraw] Shutdown()が明示的に呼ばれていません。デストラクタで自動クリーンアップします。");
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::~DebugDraw() - デストラクタ呼び出し");
+            DEBUGLOG_WARNING("[DebugDraw] Shutdown()が明示的に呼ばれていません。デストラクタで自動クリーンアップします。");
         }
-      Shutdown();
+        Shutdown();
     }
 
     /**
@@ -580,207 +824,713 @@ center.z + radius * sinf(angle2)
     void Shutdown() {
         if (isShutdown_) return; // 冪等性
 
-     DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Shutdown() - リソースを解放中");
-      
-    // 統計情報をログ出力
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Shutdown() - リソースを解放中");
+
+        // 統計情報をログ出力
         if (stats_.totalLinesAdded > 0) {
-      DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, 
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics,
                 "DebugDraw統計: 総追加線数=" + std::to_string(stats_.totalLinesAdded) +
- ", ピーク線数=" + std::to_string(stats_.peakLineCount) +
-     ", 破棄線数=" + std::to_string(stats_.linesDropped));
-        }
-    
-        int releasedCount = 0;
-        
-        if (vs_) {
-       DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "頂点シェーダーを解放 (DebugDraw)");
-    vs_.Reset();
-   releasedCount++;
-        }
-    
-        if (ps_) {
-    DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "ピクセルシェーダーを解放 (DebugDraw)");
-       ps_.Reset();
-   releasedCount++;
-        }
-        
-    if (layout_) {
-  DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "入力レイアウトを解放 (DebugDraw)");
-            layout_.Reset();
-      releasedCount++;
-      }
-        
-      if (cb_) {
-     DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "定数バッファを解放 (DebugDraw)");
-    cb_.Reset();
-     releasedCount++;
-        }
-   
-        if (vb_) {
-DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "頂点バッファを解放 (DebugDraw, 最大線数: " + std::to_string(maxLines_) + ")");
-         vb_.Reset();
-      releasedCount++;
-   }
-      
-        lines_.clear();
-        lines_.shrink_to_fit();
-        
+                ", ピーク線数=" + std::to_string(stats_.peakLineCount) +
+                ", 破棄線数=" + std::to_string(stats_.linesDropped) +
+                ", バッファ拡張=" + std::to_string(stats_.bufferGrowths));
+        }
+
+        lineVs_.Reset();
+        shapeVs_.Reset();
+        ps_.Reset();
+        lineLayout_.Reset();
+        shapeLayout_.Reset();
+        cb_.Reset();
+        shapeVb_.Reset();
+        lineRing_ = DynamicRing();
+        instanceRing_ = DynamicRing();
+        retainedLineBuffer_ = DynamicRing();
+        retainedInstanceBuffer_ = DynamicRing();
+        for (auto& state : depthStates_) state.Reset();
+        for (auto& pipeline : linePipelines_) pipeline = PipelineState();
+        for (auto& pipeline : shapePipelines_) pipeline = PipelineState();
+
+        slots_.clear();
+        for (auto& set : retained_) set = RetainedSet();
+        nextExpiry_ = Expiry();
+        retainedDirty_ = false;
+        retainedReady_ = false;
+
         isShutdown_ = true;
-   initialized_ = false;
-        
-      DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Shutdown() 完了 (解放リソース数: " + std::to_string(releasedCount) + ")");
+        initialized_ = false;
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw::Shutdown() 完了");
     }
 
 private:
     /**
-   * @struct Vertex
- * @brief 頂点データ(位置と色)
+     * @struct Vertex
+     * @brief 頂点データ(位置と色)
      */
     struct Vertex {
         DirectX::XMFLOAT3 pos; ///< 位置
         DirectX::XMFLOAT3 col; ///< 色
-};
+    };
+
+    /**
+     * @struct ShapeInstance
+     * @brief 形状1つ分のインスタンスデータ
+     */
+    struct ShapeInstance {
+        DirectX::XMFLOAT4X4 world; ///< 単位形状に掛けるワールド行列(行ベクトル形式)
+        DirectX::XMFLOAT3 color;   ///< 色
+    };
+
+    /**
+     * @struct ShapeRange
+     * @brief 形状の頂点バッファ内の範囲
+     */
+    struct ShapeRange {
+        UINT first = 0; ///< 最初の頂点
+        UINT count = 0; ///< 頂点数(線分 x 2)
+    };
+
+    /**
+     * @struct DynamicRing
+     * @brief リングとして使う動的頂点バッファ
+     *
+     * @details
+     * 空きがある間は D3D11_MAP_WRITE_NO_OVERWRITE で前回の続きに書き、GPU が読み終えていない
+     * 領域を待たずに済ませます。末尾まで使い切ったときだけ DISCARD で新しい領域に切り替えます。
+     */
+    struct DynamicRing {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer; ///< 頂点バッファ
+        UINT stride = 0;                             ///< 要素のサイズ(バイト)
+        size_t capacity = 0;                         ///< 要素数
+        size_t offset = 0;                           ///< 次に書き込む要素の位置
+
+        bool Create(GfxDevice& gfx, UINT elementSize, size_t elements) {
+            D3D11_BUFFER_DESC desc{};
+            desc.ByteWidth = static_cast<UINT>(elements * elementSize);
+            desc.Usage = D3D11_USAGE_DYNAMIC;
+            desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+            desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+            Microsoft::WRL::ComPtr<ID3D11Buffer> created;
+            HRESULT hr = gfx.Dev()->CreateBuffer(&desc, nullptr, created.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[DebugDraw] 動的頂点バッファの作成失敗 (要素数: " + std::to_string(elements) +
+                               ", HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+            buffer = created;
+            stride = elementSize;
+            capacity = elements;
+            offset = elements; // 作成直後の最初の書き込みは DISCARD にする
+            return true;
+        }
+    };
+
+    /**
+     * @struct ThreadSlot
+     * @brief 1スレッド分の追加先(別スレッドと同じキャッシュラインを共有しないよう整列)
+     */
+    /**
+     * @struct PendingLine
+     * @brief 追加されたが保持用の配列へまだ移していない寿命付きの線
+     */
+    struct PendingLine {
+        Vertex vertices[2];   ///< 始点と終点
+        Lifetime lifetime;    ///< 寿命(Render() で移すときに期限へ変換)
+        DepthMode mode = DEPTH_TEST;
+    };
+
+    /**
+     * @struct PendingShape
+     * @brief 追加されたが保持用の配列へまだ移していない寿命付きの形状
+     */
+    struct PendingShape {
+        ShapeInstance instance;
+        Lifetime lifetime;
+        DepthMode mode = DEPTH_TEST;
+        Shape shape = SHAPE_BOX;
+    };
+
+    /**
+     * @struct ThreadSlot
+     * @brief 1スレッド分の追加先(別スレッドと同じキャッシュラインを共有しないよう整列)
+     */
+    struct alignas(64) ThreadSlot {
+        TrackedVector<Vertex, MemoryTag::Render> lineVertices[DEPTH_MODE_COUNT];               ///< 線の頂点(2頂点で1本)
+        TrackedVector<ShapeInstance, MemoryTag::Render> shapes[DEPTH_MODE_COUNT][SHAPE_COUNT]; ///< 形状のインスタンス
+        TrackedVector<PendingLine, MemoryTag::Render> pendingLines;   ///< 寿命付きの線(Clear() では消さない)
+        TrackedVector<PendingShape, MemoryTag::Render> pendingShapes; ///< 寿命付きの形状(Clear() では消さない)
+
+        void Clear() {
+            for (auto& list : lineVertices) list.clear();
+            for (auto& lists : shapes) {
+                for (auto& list : lists) list.clear();
+            }
+        }
+    };
+
+    /**
+     * @struct Expiry
+     * @brief 寿命付きのものが消える時刻とフレーム(どちらかに達したら消す)
+     */
+    struct Expiry {
+        double time = std::numeric_limits<double>::infinity();  ///< Update() の累積時間(秒)
+        uint64_t frame = std::numeric_limits<uint64_t>::max(); ///< Update() の回数
+    };
+
+    /**
+     * @struct RetainedSet
+     * @brief 1つの深度モードの寿命付きの線と形状(期限は要素と同じ並び)
+     */
+    struct RetainedSet {
+        TrackedVector<Vertex, MemoryTag::Render> lineVertices;               ///< 線の頂点(2頂点で1本)
+        TrackedVector<Expiry, MemoryTag::Render> lineExpiry;                 ///< 線ごとの期限
+        TrackedVector<ShapeInstance, MemoryTag::Render> shapes[SHAPE_COUNT]; ///< 形状のインスタンス(種類ごと)
+        TrackedVector<Expiry, MemoryTag::Render> shapeExpiry[SHAPE_COUNT];   ///< 形状ごとの期限
+
+        void Clear() {
+            lineVertices.clear();
+            lineExpiry.clear();
+            for (uint32_t t = 0; t < SHAPE_COUNT; ++t) {
+                shapes[t].clear();
+                shapeExpiry[t].clear();
+            }
+        }
+    };
+
+    static constexpr size_t INITIAL_INSTANCE_CAPACITY = 1024; ///< インスタンスバッファの初期容量
+    static constexpr size_t INITIAL_RETAINED_CAPACITY = 256;  ///< 保持用バッファの初期容量(要素数)
+
+    /**
+     * @brief 寿命を期限に変換(Frames(n) は n 回の Render() で描画される)
+     */
+    Expiry MakeExpiry(const Lifetime& lifetime) const {
+        Expiry expiry;
+        if (lifetime.frames > 0) {
+            expiry.frame = frame_ + lifetime.frames;
+        } else {
+            expiry.time = clock_ + (std::max)(lifetime.seconds, 0.0f);
+        }
+        return expiry;
+    }
+
+    void NoteExpiry(const Expiry& expiry) {
+        nextExpiry_.time = (std::min)(nextExpiry_.time, expiry.time);
+        nextExpiry_.frame = (std::min)(nextExpiry_.frame, expiry.frame);
+    }
+
+    /**
+     * @brief スレッドごとの寿命付きの追加分を保持用の配列へ移す
+     */
+    void MergePending() {
+        for (auto& slot : slots_) {
+            for (const PendingLine& pending : slot->pendingLines) {
+                RetainedSet& set = retained_[pending.mode];
+                const Expiry expiry = MakeExpiry(pending.lifetime);
+                set.lineVertices.push_back(pending.vertices[0]);
+                set.lineVertices.push_back(pending.vertices[1]);
+                set.lineExpiry.push_back(expiry);
+                NoteExpiry(expiry);
+            }
+            for (const PendingShape& pending : slot->pendingShapes) {
+                RetainedSet& set = retained_[pending.mode];
+                const Expiry expiry = MakeExpiry(pending.lifetime);
+                set.shapes[pending.shape].push_back(pending.instance);
+                set.shapeExpiry[pending.shape].push_back(expiry);
+                NoteExpiry(expiry);
+            }
+            if (!slot->pendingLines.empty() || !slot->pendingShapes.empty()) {
+                stats_.totalLinesAdded += slot->pendingLines.size();
+                retainedDirty_ = true;
+                slot->pendingLines.clear();
+                slot->pendingShapes.clear();
+            }
+        }
+    }
+
+    /**
+     * @brief 期限の切れたものを末尾と入れ替えて取り除き、次の期限を求め直す
+     */
+    void RemoveExpired() {
+        auto expired = [this](const Expiry& e) { return clock_ >= e.time || frame_ >= e.frame; };
+
+        nextExpiry_ = Expiry();
+        for (auto& set : retained_) {
+            for (size_t i = 0; i < set.lineExpiry.size();) {
+                if (expired(set.lineExpiry[i])) {
+                    const size_t last = set.lineExpiry.size() - 1;
+                    set.lineExpiry[i] = set.lineExpiry[last];
+                    set.lineVertices[i * 2] = set.lineVertices[last * 2];
+                    set.lineVertices[i * 2 + 1] = set.lineVertices[last * 2 + 1];
+                    set.lineExpiry.pop_back();
+                    set.lineVertices.resize(last * 2);
+                    retainedDirty_ = true;
+                } else {
+                    NoteExpiry(set.lineExpiry[i]);
+                    ++i;
+                }
+            }
+            for (uint32_t t = 0; t < SHAPE_COUNT; ++t) {
+                auto& shapes = set.shapes[t];
+                auto& expiry = set.shapeExpiry[t];
+                for (size_t i = 0; i < expiry.size();) {
+                    if (expired(expiry[i])) {
+                        expiry[i] = expiry.back();
+                        shapes[i] = shapes.back();
+                        expiry.pop_back();
+                        shapes.pop_back();
+                        retainedDirty_ = true;
+                    } else {
+                        NoteExpiry(expiry[i]);
+                        ++i;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 保持用の配列を先頭から詰めて転送し直す(DISCARD で新しい領域に書く)
+     * @return bool 転送できた場合(空の場合も含む) true
+     */
+    bool UploadRetained(GfxDevice& gfx) {
+        size_t lineVertexTotal = 0;
+        size_t shapeTotal = 0;
+        for (const auto& set : retained_) {
+            lineVertexTotal += set.lineVertices.size();
+            for (const auto& list : set.shapes) shapeTotal += list.size();
+        }
+
+        size_t first = 0;
+        if (lineVertexTotal > 0) {
+            retainedLineBuffer_.offset = retainedLineBuffer_.capacity;
+            uint8_t* dst = BeginWrite(gfx, retainedLineBuffer_, lineVertexTotal, first);
+            if (!dst) return false;
+            for (const auto& set : retained_) {
+                const size_t bytes = set.lineVertices.size() * sizeof(Vertex);
+                if (bytes == 0) continue;
+                std::memcpy(dst, set.lineVertices.data(), bytes);
+                dst += bytes;
+            }
+            gfx.Ctx()->Unmap(retainedLineBuffer_.buffer.Get(), 0);
+        }
+
+        if (shapeTotal > 0) {
+            retainedInstanceBuffer_.offset = retainedInstanceBuffer_.capacity;
+            uint8_t* dst = BeginWrite(gfx, retainedInstanceBuffer_, shapeTotal, first);
+            if (!dst) return false;
+            for (const auto& set : retained_) {
+                for (const auto& list : set.shapes) {
+                    const size_t bytes = list.size() * sizeof(ShapeInstance);
+                    if (bytes == 0) continue;
+                    std::memcpy(dst, list.data(), bytes);
+                    dst += bytes;
+                }
+            }
+            gfx.Ctx()->Unmap(retainedInstanceBuffer_.buffer.Get(), 0);
+        }
+
+        stats_.persistentUploads++;
+        return true;
+    }
+
+    /**
+     * @brief バッファの cursor から vertexCount 頂点の線を深度モード mode で描画して cursor を進める
+     */
+    void DrawLines(StateCache& states, uint32_t mode, const DynamicRing& ring, size_t vertexCount, size_t& cursor) {
+        if (vertexCount == 0) return;
+
+        ID3D11DeviceContext* ctx = states.Context();
+        UINT stride = sizeof(Vertex);
+        UINT offset = 0;
+        states.Apply(linePipelines_[mode]);
+        ctx->IASetVertexBuffers(0, 1, ring.buffer.GetAddressOf(), &stride, &offset);
+        ctx->Draw(static_cast<UINT>(vertexCount), static_cast<UINT>(cursor));
+        cursor += vertexCount;
+        stats_.linesDrawn += vertexCount / 2;
+        stats_.drawCalls++;
+    }
+
+    /**
+     * @brief バッファの cursor から種類ごとのインスタンスを深度モード mode で描画して cursor を進める
+     */
+    void DrawShapes(StateCache& states, uint32_t mode, const DynamicRing& ring, const size_t (&counts)[SHAPE_COUNT], size_t& cursor) {
+        size_t total = 0;
+        for (size_t count : counts) total += count;
+        if (total == 0) return;
+
+        ID3D11DeviceContext* ctx = states.Context();
+        ID3D11Buffer* buffers[2] = { shapeVb_.Get(), ring.buffer.Get() };
+        UINT strides[2] = { sizeof(DirectX::XMFLOAT3), sizeof(ShapeInstance) };
+        UINT offsets[2] = { 0, 0 };
+        states.Apply(shapePipelines_[mode]);
+        ctx->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+
+        for (uint32_t t = 0; t < SHAPE_COUNT; ++t) {
+            if (counts[t] == 0) continue;
+            ctx->DrawInstanced(shapeRanges_[t].count, static_cast<UINT>(counts[t]),
+                               shapeRanges_[t].first, static_cast<UINT>(cursor));
+            cursor += counts[t];
+            stats_.drawCalls++;
+        }
+        stats_.shapesDrawn += total;
+    }
+
+    /**
+     * @brief リングに count 要素分の領域を確保してマップ(容量が足りない場合は2倍以上に拡張)
+     * @param[out] first 確保した最初の要素の位置(Draw の開始位置)
+     * @return uint8_t* 書き込み先(失敗時は nullptr)。書き込み後に呼び出し側で Unmap する
+     */
+    uint8_t* BeginWrite(GfxDevice& gfx, DynamicRing& ring, size_t count, size_t& first) {
+        if (count > ring.capacity) {
+            const size_t grown = (std::max)(count, ring.capacity * 2);
+            if (!ring.Create(gfx, ring.stride, grown)) {
+                return nullptr;
+            }
+            stats_.bufferGrowths++;
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[DebugDraw] バッファを拡張 (要素数: " + std::to_string(grown) + ")");
+        }
+
+        D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+        if (ring.offset + count > ring.capacity) {
+            mapType = D3D11_MAP_WRITE_DISCARD;
+            ring.offset = 0;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        HRESULT hr = gfx.Ctx()->Map(ring.buffer.Get(), 0, mapType, 0, &mapped);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[DebugDraw] 頂点バッファのマップ失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return nullptr;
+        }
+
+        first = ring.offset;
+        ring.offset += count;
+        return static_cast<uint8_t*>(mapped.pData) + first * ring.stride;
+    }
+
+    /**
+     * @brief 呼び出しスレッドのバッファ(バッファのないワーカーの場合は nullptr)
+     */
+    ThreadSlot* threadSlot() {
+        const int worker = JobSystem::CurrentWorkerIndex();
+        const size_t index = worker >= 0 ? static_cast<size_t>(worker) + 1 : 0;
+        if (index >= slots_.size()) {
+            unslottedDropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return slots_[index].get();
+    }
+
+    void swap(DebugDraw& other) noexcept {
+        std::swap(lineVs_, other.lineVs_);
+        std::swap(shapeVs_, other.shapeVs_);
+        std::swap(ps_, other.ps_);
+        std::swap(lineLayout_, other.lineLayout_);
+        std::swap(shapeLayout_, other.shapeLayout_);
+        std::swap(cb_, other.cb_);
+        std::swap(shapeVb_, other.shapeVb_);
+        std::swap(lineRing_, other.lineRing_);
+        std::swap(instanceRing_, other.instanceRing_);
+        std::swap(shapeRanges_, other.shapeRanges_);
+        std::swap(retainedLineBuffer_, other.retainedLineBuffer_);
+        std::swap(retainedInstanceBuffer_, other.retainedInstanceBuffer_);
+        std::swap(depthStates_, other.depthStates_);
+        std::swap(linePipelines_, other.linePipelines_);
+        std::swap(shapePipelines_, other.shapePipelines_);
+        slots_.swap(other.slots_);
+        std::swap(retained_, other.retained_);
+        std::swap(nextExpiry_, other.nextExpiry_);
+        std::swap(clock_, other.clock_);
+        std::swap(frame_, other.frame_);
+        std::swap(retainedDirty_, other.retainedDirty_);
+        std::swap(retainedReady_, other.retainedReady_);
+        unslottedDropped_.store(other.unslottedDropped_.exchange(unslottedDropped_.load()));
+        std::swap(isShutdown_, other.isShutdown_);
+        std::swap(initialized_, other.initialized_);
+        std::swap(stats_, other.stats_);
+    }
 
     /**
      * @brief シェーダーのコンパイル
+     *
+     * @details
+     * 線は頂点ごとの色、形状はインスタンスごとのワールド行列と色を使います。
+     * 視錐台は射影の逆行列を掛けるため、ワールド座標を w で割ってから VP を掛けます。
      */
     bool CompileShaders(GfxDevice& gfx) {
-        const char* VS = R"(
+        const char* LINE_VS = R"(
             cbuffer CB : register(b0) { float4x4 gVP; };
-struct VSIn { float3 pos : POSITION; float3 col : COLOR; };
+            struct VSIn { float3 pos : POSITION; float3 col : COLOR; };
             struct VSOut { float4 pos : SV_POSITION; float3 col : COLOR; };
             VSOut main(VSIn i){
-  VSOut o;
-     o.pos = mul(float4(i.pos, 1), gVP);
-          o.col = i.col;
-        return o;
-        }
+                VSOut o;
+                o.pos = mul(float4(i.pos, 1), gVP);
+                o.col = i.col;
+                return o;
+            }
+        )";
+
+        const char* SHAPE_VS = R"(
+            cbuffer CB : register(b0) { float4x4 gVP; };
+            struct VSIn {
+                float3 pos : POSITION;
+                float4 w0 : WORLD0; float4 w1 : WORLD1; float4 w2 : WORLD2; float4 w3 : WORLD3;
+                float3 col : COLOR;
+            };
+            struct VSOut { float4 pos : SV_POSITION; float3 col : COLOR; };
+            VSOut main(VSIn i){
+                VSOut o;
+                float4 wp = mul(float4(i.pos, 1), float4x4(i.w0, i.w1, i.w2, i.w3));
+                o.pos = mul(float4(wp.xyz / wp.w, 1), gVP);
+                o.col = i.col;
+                return o;
+            }
         )";
 
         const char* PS = R"(
-          struct VSOut { float4 pos : SV_POSITION; float3 col : COLOR; };
-        float4 main(VSOut i) : SV_Target { return float4(i.col, 1); }
+            struct VSOut { float4 pos : SV_POSITION; float3 col : COLOR; };
+            float4 main(VSOut i) : SV_Target { return float4(i.col, 1); }
         )";
 
-        Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
-        
-      UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+        UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
 #ifdef _DEBUG
         compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
 
-        HRESULT hr = D3DCompile(VS, strlen(VS), nullptr, nullptr, nullptr, "main", "vs_5_0", compileFlags, 0, vsb.GetAddressOf(), err.GetAddressOf());
-        if (FAILED(hr)) {
-      if (err) {
-                std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
-         DEBUGLOG_ERROR("[DebugDraw] 頂点シェーダーのコンパイル失敗: " + errorMsg);
-            } else {
-                DEBUGLOG_ERROR("[DebugDraw] 頂点シェーダーのコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-            }
-     return false;
+        Microsoft::WRL::ComPtr<ID3DBlob> lineVsb, shapeVsb, psb;
+        if (!Compile(LINE_VS, "vs_5_0", compileFlags, lineVsb, "線の頂点シェーダー") ||
+            !Compile(SHAPE_VS, "vs_5_0", compileFlags, shapeVsb, "形状の頂点シェーダー") ||
+            !Compile(PS, "ps_5_0", compileFlags, psb, "ピクセルシェーダー")) {
+            return false;
         }
 
-    hr = D3DCompile(PS, strlen(PS), nullptr, nullptr, nullptr, "main", "ps_5_0", compileFlags, 0, psb.GetAddressOf(), err.ReleaseAndGetAddressOf());
-        if (FAILED(hr)) {
-     if (err) {
-           std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
-      DEBUGLOG_ERROR("[DebugDraw] ピクセルシェーダーのコンパイル失敗: " + errorMsg);
-          } else {
- DEBUGLOG_ERROR("[DebugDraw] ピクセルシェーダーのコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
- }
-      return false;
+        HRESULT hr = gfx.Dev()->CreateVertexShader(lineVsb->GetBufferPointer(), lineVsb->GetBufferSize(), nullptr, lineVs_.GetAddressOf());
+        if (SUCCEEDED(hr)) {
+            hr = gfx.Dev()->CreateVertexShader(shapeVsb->GetBufferPointer(), shapeVsb->GetBufferSize(), nullptr, shapeVs_.GetAddressOf());
         }
-
-        hr = gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs_.GetAddressOf());
-    if (FAILED(hr)) {
-       DEBUGLOG_ERROR("[DebugDraw] 頂点シェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-      return false;
+        if (SUCCEEDED(hr)) {
+            hr = gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps_.GetAddressOf());
         }
-
-        hr = gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps_.GetAddressOf());
         if (FAILED(hr)) {
-            DEBUGLOG_ERROR("[DebugDraw] ピクセルシェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-  return false;
+            DEBUGLOG_ERROR("[DebugDraw] シェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
         }
 
-      // 入力レイアウト
-        D3D11_INPUT_ELEMENT_DESC il[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,         D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        // 入力レイアウト(線)
+        D3D11_INPUT_ELEMENT_DESC lineIl[] = {
+            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,                            D3D11_INPUT_PER_VERTEX_DATA, 0 },
             { "COLOR",    0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
         };
-        
-        hr = gfx.Dev()->CreateInputLayout(il, 2, vsb->GetBufferPointer(), vsb->GetBufferSize(), layout_.GetAddressOf());
+        hr = gfx.Dev()->CreateInputLayout(lineIl, 2, lineVsb->GetBufferPointer(), lineVsb->GetBufferSize(), lineLayout_.GetAddressOf());
         if (FAILED(hr)) {
             DEBUGLOG_ERROR("[DebugDraw] 入力レイアウトの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
             return false;
-  }
+        }
+
+        // 入力レイアウト(形状: スロット0 が単位形状、スロット1 がインスタンス)
+        D3D11_INPUT_ELEMENT_DESC shapeIl[] = {
+            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 0,                            D3D11_INPUT_PER_VERTEX_DATA,   0 },
+            { "WORLD",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0,                            D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "WORLD",    1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "WORLD",    2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "WORLD",    3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "COLOR",    0, DXGI_FORMAT_R32G32B32_FLOAT,    1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+        };
+        hr = gfx.Dev()->CreateInputLayout(shapeIl, 6, shapeVsb->GetBufferPointer(), shapeVsb->GetBufferSize(), shapeLayout_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[DebugDraw] 形状の入力レイアウトの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
 
         DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw: シェーダーとレイアウトを作成");
-   return true;
+        return true;
     }
 
     /**
-     * @brief パイプラインステートの作成
+     * @brief 1つのシェーダーをコンパイル(失敗時はエラーをログ出力)
      */
-    bool CreatePipelineState(GfxDevice& gfx) {
-// 現在の実装では追加のパイプラインステートは不要
-        // 将来的にラスタライザーステートやブレンドステートを追加可能
-      return true;
+    static bool Compile(const char* source, const char* target, UINT flags, Microsoft::WRL::ComPtr<ID3DBlob>& out, const char* label) {
+        Microsoft::WRL::ComPtr<ID3DBlob> err;
+        HRESULT hr = ShaderCache::Compile(source, nullptr, "main", target, flags, out, err);
+        if (FAILED(hr)) {
+            if (err) {
+                std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
+                DEBUGLOG_ERROR(std::string("[DebugDraw] ") + label + "のコンパイル失敗: " + errorMsg);
+            } else {
+                DEBUGLOG_ERROR(std::string("[DebugDraw] ") + label + "のコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            }
+            return false;
+        }
+        return true;
     }
 
     /**
      * @brief 定数バッファの作成
-  */
+     */
     bool CreateConstantBuffer(GfxDevice& gfx) {
-     D3D11_BUFFER_DESC cbd{};
+        D3D11_BUFFER_DESC cbd{};
         cbd.ByteWidth = sizeof(DirectX::XMMATRIX);
         cbd.Usage = D3D11_USAGE_DEFAULT;
         cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
         cbd.CPUAccessFlags = 0;
         cbd.MiscFlags = 0;
         cbd.StructureByteStride = 0;
-        
+
         HRESULT hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, cb_.GetAddressOf());
         if (FAILED(hr)) {
             DEBUGLOG_ERROR("[DebugDraw] 定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
             return false;
         }
-      
-    DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw: 定数バッファを作成");
-  return true;
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw: 定数バッファを作成");
+        return true;
     }
 
     /**
-     * @brief 頂点バッファの作成
+     * @brief 深度モードごとの深度ステートの作成(どちらも深度は書き込まない)
      */
-  bool CreateVertexBuffer(GfxDevice& gfx) {
-        D3D11_BUFFER_DESC vbd{};
-        vbd.ByteWidth = static_cast<UINT>(maxLines_ * 2 * sizeof(Vertex)); // 1線分 = 2頂点
-        vbd.Usage = D3D11_USAGE_DYNAMIC;
-   vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        vbd.MiscFlags = 0;
-        vbd.StructureByteStride = 0;
-        
-        HRESULT hr = gfx.Dev()->CreateBuffer(&vbd, nullptr, vb_.GetAddressOf());
+    bool CreateDepthStates(GfxDevice& gfx) {
+        D3D11_DEPTH_STENCIL_DESC dsd{};
+        dsd.DepthEnable = TRUE;
+        dsd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+        dsd.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+        HRESULT hr = gfx.Dev()->CreateDepthStencilState(&dsd, depthStates_[DEPTH_TEST].GetAddressOf());
+        if (SUCCEEDED(hr)) {
+            dsd.DepthEnable = FALSE;
+            dsd.DepthFunc = D3D11_COMPARISON_ALWAYS;
+            hr = gfx.Dev()->CreateDepthStencilState(&dsd, depthStates_[DEPTH_OVERLAY].GetAddressOf());
+        }
         if (FAILED(hr)) {
-        DEBUGLOG_ERROR("[DebugDraw] 頂点バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            DEBUGLOG_ERROR("[DebugDraw] 深度ステートの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
             return false;
         }
-        
-      DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "DebugDraw: 頂点バッファを作成 (最大線数: " + std::to_string(maxLines_) + ")");
         return true;
     }
 
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;    ///< 頂点シェーダー
-    Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;     ///< ピクセルシェーダー
-    Microsoft::WRL::ComPtr<ID3D11InputLayout> layout_; ///< 入力レイアウト
-    Microsoft::WRL::ComPtr<ID3D11Buffer> cb_;    ///< 定数バッファ
-    Microsoft::WRL::ComPtr<ID3D11Buffer> vb_;          ///< 頂点バッファ
+    /**
+     * @brief 線・形状と深度モードの組み合わせごとのパイプラインステートを作成(どちらも線リスト、ブレンドなし)
+     */
+    void CreatePipelineStates() {
+        for (uint32_t m = 0; m < DEPTH_MODE_COUNT; ++m) {
+            PipelineStateDesc desc;
+            desc.pixelShader = ps_.Get();
+            desc.topology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+            desc.depthStencilState = depthStates_[m].Get();
+
+            desc.vertexShader = lineVs_.Get();
+            desc.inputLayout = lineLayout_.Get();
+            linePipelines_[m] = PipelineState(desc);
+
+            desc.vertexShader = shapeVs_.Get();
+            desc.inputLayout = shapeLayout_.Get();
+            shapePipelines_[m] = PipelineState(desc);
+        }
+    }
+
+    /**
+     * @brief 単位形状(線分リスト)を1つの頂点バッファにまとめて作成
+     */
+    bool CreateShapeBuffer(GfxDevice& gfx) {
+        using DirectX::XMFLOAT3;
+        std::vector<XMFLOAT3> v;
+
+        // 直方体の12辺(z の範囲を指定、視錐台は NDC の 0～1)
+        auto addBox = [&v](float zMin, float zMax) {
+            const XMFLOAT3 c[8] = {
+                { -1, -1, zMin }, { 1, -1, zMin }, { 1, 1, zMin }, { -1, 1, zMin },
+                { -1, -1, zMax }, { 1, -1, zMax }, { 1, 1, zMax }, { -1, 1, zMax },
+            };
+            static const int edges[12][2] = {
+                { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+                { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+                { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+            };
+            for (const auto& e : edges) {
+                v.push_back(c[e[0]]);
+                v.push_back(c[e[1]]);
+            }
+        };
+
+        shapeRanges_[SHAPE_BOX].first = static_cast<UINT>(v.size());
+        addBox(-1.0f, 1.0f);
+        shapeRanges_[SHAPE_BOX].count = static_cast<UINT>(v.size()) - shapeRanges_[SHAPE_BOX].first;
+
+        // XY / XZ / YZ 平面の円
+        shapeRanges_[SHAPE_SPHERE].first = static_cast<UINT>(v.size());
+        const float step = DirectX::XM_2PI / SPHERE_SEGMENTS;
+        for (int plane = 0; plane < 3; ++plane) {
+            for (int i = 0; i < SPHERE_SEGMENTS; ++i) {
+                for (int k = 0; k < 2; ++k) {
+                    const float a = step * (i + k);
+                    const float c = cosf(a);
+                    const float s = sinf(a);
+                    v.push_back(plane == 0 ? XMFLOAT3{ c, s, 0 } : plane == 1 ? XMFLOAT3{ c, 0, s } : XMFLOAT3{ 0, c, s });
+                }
+            }
+        }
+        shapeRanges_[SHAPE_SPHERE].count = static_cast<UINT>(v.size()) - shapeRanges_[SHAPE_SPHERE].first;
+
+        // 軸と4本の矢じり
+        shapeRanges_[SHAPE_ARROW].first = static_cast<UINT>(v.size());
+        const float head = 0.2f;
+        const float headWidth = 0.08f;
+        const XMFLOAT3 tip{ 0, 0, 1 };
+        v.push_back(XMFLOAT3{ 0, 0, 0 });
+        v.push_back(tip);
+        const XMFLOAT3 barbs[4] = {
+            { headWidth, 0, 1 - head }, { -headWidth, 0, 1 - head }, { 0, headWidth, 1 - head }, { 0, -headWidth, 1 - head },
+        };
+        for (const XMFLOAT3& b : barbs) {
+            v.push_back(b);
+            v.push_back(tip);
+        }
+        shapeRanges_[SHAPE_ARROW].count = static_cast<UINT>(v.size()) - shapeRanges_[SHAPE_ARROW].first;
+
+        shapeRanges_[SHAPE_FRUSTUM].first = static_cast<UINT>(v.size());
+        addBox(0.0f, 1.0f);
+        shapeRanges_[SHAPE_FRUSTUM].count = static_cast<UINT>(v.size()) - shapeRanges_[SHAPE_FRUSTUM].first;
+
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = static_cast<UINT>(v.size() * sizeof(XMFLOAT3));
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        D3D11_SUBRESOURCE_DATA init{};
+        init.pSysMem = v.data();
+
+        HRESULT hr = gfx.Dev()->CreateBuffer(&desc, &init, shapeVb_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[DebugDraw] 形状の頂点バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
+    }
 
-    std::vector<Line> lines_;  ///< 描画する線のリスト
-    size_t maxLines_ = 10000;  ///< 最大線数
-    bool isShutdown_ = false;  ///< シャットダウンフラグ
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> lineVs_;      ///< 線の頂点シェーダー
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> shapeVs_;     ///< 形状の頂点シェーダー(インスタンス描画)
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;           ///< ピクセルシェーダー
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> lineLayout_;   ///< 線の入力レイアウト
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> shapeLayout_;  ///< 形状の入力レイアウト
+    Microsoft::WRL::ComPtr<ID3D11Buffer> cb_;                ///< 定数バッファ
+    Microsoft::WRL::ComPtr<ID3D11Buffer> shapeVb_;           ///< 単位形状の頂点バッファ(変更なし)
+    DynamicRing lineRing_;                                   ///< 線の頂点のリング
+    DynamicRing instanceRing_;                               ///< 形状のインスタンスのリング
+    ShapeRange shapeRanges_[SHAPE_COUNT];                    ///< 形状ごとの頂点の範囲
+    DynamicRing retainedLineBuffer_;                         ///< 寿命付きの線の頂点(増減時のみ転送)
+    DynamicRing retainedInstanceBuffer_;                     ///< 寿命付きの形状のインスタンス(増減時のみ転送)
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthStates_[DEPTH_MODE_COUNT]; ///< 深度モードごとのステート
+    PipelineState linePipelines_[DEPTH_MODE_COUNT];          ///< 線の描画(深度モードごと)
+    PipelineState shapePipelines_[DEPTH_MODE_COUNT];         ///< 形状のインスタンス描画(深度モードごと)
+
+    std::vector<std::unique_ptr<ThreadSlot>> slots_;  ///< [0] はメインスレッド、[1 + i] はワーカー i
+    std::atomic<size_t> unslottedDropped_{ 0 };       ///< バッファのないワーカーから追加されて捨てた線・形状の数
+    RetainedSet retained_[DEPTH_MODE_COUNT];          ///< 寿命付きの線と形状(深度モードごと)
+    Expiry nextExpiry_;                               ///< 保持しているものの最も早い期限
+    double clock_ = 0.0;                              ///< Update() の累積時間(秒)
+    uint64_t frame_ = 0;                              ///< Update() の回数
+    bool retainedDirty_ = false;                      ///< 保持用バッファの転送し直しが必要
+    bool retainedReady_ = false;                      ///< 保持用バッファの内容が retained_ と一致
+    bool isShutdown_ = true;   ///< シャットダウンフラグ
     bool initialized_ = false; ///< 初期化済みフラグ
-    Statistics stats_;       ///< 統計情報
+    Statistics stats_;         ///< 統計情報
 };
@@ -0,0 +1,607 @@
+/**
+ * @file DynamicBvh.h
+ * @brief 動的AABB木(BVH)によるレイキャスト・AABB・視錐台の検索
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 葉に登録したAABBを余白(マージン)付きで保持する二分木です。移動しても余白の中に収まっている間は
+ * 木を変更せず、はみ出した場合だけ葉を外して挿入し直します。挿入先は表面積の増分が最小になる兄弟を
+ * 選び(SAH に近いコスト)、挿入・削除の後は高さの差が2以上の節を回転して木の高さを抑えます。
+ *
+ * 検索は根から子のAABBで枝を刈りながら辿ります。
+ * - Raycast(): 手前の子から辿り、コールバックが返した距離で以降の検索範囲を縮めます。
+ * - QueryAABB(): AABB と重なる葉を列挙します。
+ * - QueryFrustum(): 視錐台に触れる葉を列挙します。節が視錐台に完全に含まれる場合は
+ *   その下の葉を平面判定なしでまとめて列挙します。
+ *
+ * 節は配列で管理し、削除した節は空きリストで再利用します。プロキシ番号(CreateProxy の戻り値)は
+ * DestroyProxy まで変わりません。スレッドセーフではありません。
+ */
+#pragma once
+#include "graphics/FrustumCulling.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+
+/**
+ * @struct BvhAabb
+ * @brief 軸平行境界ボックス
+ */
+struct BvhAabb {
+    DirectX::XMFLOAT3 min{ 0.0f, 0.0f, 0.0f }; ///< 最小の角
+    DirectX::XMFLOAT3 max{ 0.0f, 0.0f, 0.0f }; ///< 最大の角
+
+    /**
+     * @brief 境界球を囲むAABB
+     */
+    static BvhAabb FromSphere(const DirectX::XMFLOAT3& center, float radius) {
+        return BvhAabb{ { center.x - radius, center.y - radius, center.z - radius },
+                        { center.x + radius, center.y + radius, center.z + radius } };
+    }
+
+    /**
+     * @brief 2つのAABBを囲むAABB
+     */
+    static BvhAabb Union(const BvhAabb& a, const BvhAabb& b) {
+        return BvhAabb{ { (std::min)(a.min.x, b.min.x), (std::min)(a.min.y, b.min.y), (std::min)(a.min.z, b.min.z) },
+                        { (std::max)(a.max.x, b.max.x), (std::max)(a.max.y, b.max.y), (std::max)(a.max.z, b.max.z) } };
+    }
+
+    /**
+     * @brief 表面積(挿入コストの評価用)
+     */
+    float SurfaceArea() const {
+        float dx = max.x - min.x, dy = max.y - min.y, dz = max.z - min.z;
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+
+    bool Contains(const BvhAabb& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+
+    bool Overlaps(const BvhAabb& other) const {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+               min.y <= other.max.y && other.min.y <= max.y &&
+               min.z <= other.max.z && other.min.z <= max.z;
+    }
+};
+
+/**
+ * @class DynamicBvh
+ * @brief 余白付きAABBの動的な二分木
+ *
+ * @par 使用例
+ * @code
+ * DynamicBvh tree;
+ * uint32_t proxy = tree.CreateProxy(BvhAabb::FromSphere(center, radius), entityIndex);
+ * tree.MoveProxy(proxy, BvhAabb::FromSphere(newCenter, radius)); // 余白の中なら木は変わらない
+ *
+ * tree.Raycast(origin, dir, 100.0f, [&](uint32_t hit) {
+ *     float t;
+ *     if (!IntersectExact(tree.UserData(hit), t)) return -1.0f; // 外れ: 検索範囲はそのまま
+ *     best = tree.UserData(hit);
+ *     return t;                                                  // 以降は t より手前だけを探す
+ * });
+ *
+ * tree.QueryFrustum(frustum, [&](uint32_t visible) { Draw(tree.UserData(visible)); return true; });
+ * @endcode
+ */
+class DynamicBvh {
+public:
+    static constexpr uint32_t NULL_NODE = 0xFFFFFFFFu; ///< 無効な節・プロキシ
+    static constexpr float DEFAULT_MARGIN = 0.1f;      ///< 葉のAABBに足す余白(ワールド単位)
+    static constexpr float DISPLACEMENT_SCALE = 2.0f;  ///< MoveProxy の移動量を余白に先取りする倍率
+
+    /**
+     * @param[in] margin 葉のAABBに足す余白。大きいほど再挿入が減り、検索の偽陽性が増えます
+     */
+    explicit DynamicBvh(float margin = DEFAULT_MARGIN) : margin_(margin) {}
+
+    /**
+     * @brief 葉を追加
+     * @param[in] aabb 登録するAABB(余白はここで足します)
+     * @param[in] userData 葉に持たせる値(UserData() で取得)
+     * @return uint32_t プロキシ番号
+     */
+    uint32_t CreateProxy(const BvhAabb& aabb, uint32_t userData) {
+        uint32_t proxy = AllocateNode();
+        Node& node = nodes_[proxy];
+        node.aabb = Fatten(aabb);
+        node.userData = userData;
+        node.height = 0;
+        InsertLeaf(proxy);
+        ++proxyCount_;
+        return proxy;
+    }
+
+    /**
+     * @brief 葉を削除
+     */
+    void DestroyProxy(uint32_t proxy) {
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        --proxyCount_;
+    }
+
+    /**
+     * @brief 葉のAABBを更新
+     * @param[in] aabb 新しいAABB
+     * @param[in] displacement 前回からの移動量(進行方向に余白を広げて再挿入を減らす。省略可)
+     * @return bool 木を組み替えた場合 true
+     *
+     * @details
+     * 新しいAABBが余白付きのAABBに収まっていれば何もしません。ただし止まった後に大きく広げた
+     * 余白が残り続けないよう、余白付きのAABBが必要な大きさを大きく超えている場合は締め直します。
+     */
+    bool MoveProxy(uint32_t proxy, const BvhAabb& aabb, const DirectX::XMFLOAT3& displacement = DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }) {
+        BvhAabb fat = Fatten(aabb);
+        const float dx = DISPLACEMENT_SCALE * displacement.x;
+        const float dy = DISPLACEMENT_SCALE * displacement.y;
+        const float dz = DISPLACEMENT_SCALE * displacement.z;
+        (dx < 0.0f ? fat.min.x : fat.max.x) += dx;
+        (dy < 0.0f ? fat.min.y : fat.max.y) += dy;
+        (dz < 0.0f ? fat.min.z : fat.max.z) += dz;
+
+        const BvhAabb& current = nodes_[proxy].aabb;
+        if (current.Contains(aabb)) {
+            // 必要な箱を余白4つ分広げた範囲に収まっていれば締め直さない
+            const float slack = 4.0f * margin_;
+            BvhAabb loose{ { fat.min.x - slack, fat.min.y - slack, fat.min.z - slack },
+                           { fat.max.x + slack, fat.max.y + slack, fat.max.z + slack } };
+            if (loose.Contains(current)) return false;
+        }
+
+        RemoveLeaf(proxy);
+        nodes_[proxy].aabb = fat;
+        InsertLeaf(proxy);
+        ++reinserts_;
+        return true;
+    }
+
+    uint32_t UserData(uint32_t proxy) const { return nodes_[proxy].userData; }
+    void SetUserData(uint32_t proxy, uint32_t userData) { nodes_[proxy].userData = userData; }
+
+    /**
+     * @brief 葉の余白付きAABB
+     */
+    const BvhAabb& FatAabb(uint32_t proxy) const { return nodes_[proxy].aabb; }
+
+    /**
+     * @brief AABB と重なる葉を列挙
+     * @param[in] fn bool(uint32_t proxy)。false を返すと検索を打ち切ります
+     */
+    template<typename Fn>
+    void QueryAABB(const BvhAabb& aabb, Fn&& fn) const {
+        NodeStack stack;
+        stack.Push(root_);
+        while (!stack.Empty()) {
+            uint32_t index = stack.Pop();
+            if (index == NULL_NODE) continue;
+            const Node& node = nodes_[index];
+            if (!node.aabb.Overlaps(aabb)) continue;
+            if (node.IsLeaf()) {
+                if (!fn(index)) return;
+            } else {
+                stack.Push(node.child1);
+                stack.Push(node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief 半直線と交わる葉を手前から列挙
+     * @param[in] origin 始点
+     * @param[in] dir 向き(正規化済み)
+     * @param[in] maxDistance 検索する距離
+     * @param[in] fn float(uint32_t proxy)。
+     *               負の値: 当たっていない(そのまま続ける)、0: 打ち切る、正の値: その距離より先は探さない
+     *
+     * @details
+     * 葉の余白付きAABBとの判定しか行わないため、正確な判定はコールバックで行ってください。
+     */
+    template<typename Fn>
+    void Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, float maxDistance, Fn&& fn) const {
+        if (root_ == NULL_NODE) return;
+        const DirectX::XMFLOAT3 inv{ SafeInverse(dir.x), SafeInverse(dir.y), SafeInverse(dir.z) };
+
+        NodeStack stack;
+        stack.Push(root_);
+        while (!stack.Empty()) {
+            const Node& node = nodes_[stack.Pop()];
+            float enter;
+            if (!RayHitsAabb(origin, inv, node.aabb, maxDistance, enter)) continue;
+
+            if (node.IsLeaf()) {
+                float value = fn(static_cast<uint32_t>(&node - nodes_.data()));
+                if (value == 0.0f) return;
+                if (value > 0.0f) maxDistance = (std::min)(maxDistance, value);
+                continue;
+            }
+
+            // 遠い子を先に積み、近い子から辿る
+            float enter1, enter2;
+            bool hit1 = RayHitsAabb(origin, inv, nodes_[node.child1].aabb, maxDistance, enter1);
+            bool hit2 = RayHitsAabb(origin, inv, nodes_[node.child2].aabb, maxDistance, enter2);
+            if (hit1 && hit2) {
+                if (enter1 <= enter2) {
+                    stack.Push(node.child2);
+                    stack.Push(node.child1);
+                } else {
+                    stack.Push(node.child1);
+                    stack.Push(node.child2);
+                }
+            } else if (hit1) {
+                stack.Push(node.child1);
+            } else if (hit2) {
+                stack.Push(node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief 視錐台に触れる葉を列挙
+     * @param[in] fn bool(uint32_t proxy)。false を返すと検索を打ち切ります
+     */
+    template<typename Fn>
+    void QueryFrustum(const Frustum& frustum, Fn&& fn) const {
+        if (root_ == NULL_NODE) return;
+        NodeStack stack;
+        stack.Push(root_);
+        while (!stack.Empty()) {
+            uint32_t index = stack.Pop();
+            const Node& node = nodes_[index];
+            bool inside = true;
+            if (!FrustumTest(frustum, node.aabb, inside)) continue;
+            if (node.IsLeaf()) {
+                if (!fn(index)) return;
+            } else if (inside) {
+                if (!ReportSubtree(index, fn)) return;
+            } else {
+                stack.Push(node.child1);
+                stack.Push(node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief すべての葉を削除(節の配列の容量は残す)
+     */
+    void Clear() {
+        nodes_.clear();
+        root_ = NULL_NODE;
+        freeList_ = NULL_NODE;
+        proxyCount_ = 0;
+    }
+
+    size_t ProxyCount() const { return proxyCount_; }
+    size_t NodeCount() const { return proxyCount_ > 0 ? proxyCount_ * 2 - 1 : 0; }
+
+    /**
+     * @brief 木の高さ(葉のみは 0、空は -1)
+     */
+    int Height() const { return root_ != NULL_NODE ? nodes_[root_].height : -1; }
+
+    /**
+     * @brief MoveProxy で組み替えた回数(累計)
+     */
+    uint64_t Reinserts() const { return reinserts_; }
+
+    float Margin() const { return margin_; }
+
+private:
+    struct Node {
+        BvhAabb aabb;                 ///< 葉は余白付き、内部節は子を囲むAABB
+        uint32_t parent = NULL_NODE;  ///< 親(空きリストでは次の空き節)
+        uint32_t child1 = NULL_NODE;  ///< 子(葉は NULL_NODE)
+        uint32_t child2 = NULL_NODE;
+        int32_t height = -1;          ///< 葉は 0、空き節は -1
+        uint32_t userData = 0;        ///< 葉に持たせた値
+
+        bool IsLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    /**
+     * @brief 検索用のスタック(浅い木はヒープを使わない)
+     */
+    class NodeStack {
+    public:
+        void Push(uint32_t index) {
+            if (count_ < INLINE_CAPACITY) {
+                inline_[count_++] = index;
+            } else {
+                overflow_.push_back(index);
+                ++count_;
+            }
+        }
+
+        uint32_t Pop() {
+            --count_;
+            if (count_ >= INLINE_CAPACITY) {
+                uint32_t index = overflow_.back();
+                overflow_.pop_back();
+                return index;
+            }
+            return inline_[count_];
+        }
+
+        bool Empty() const { return count_ == 0; }
+
+    private:
+        static constexpr size_t INLINE_CAPACITY = 128;
+        uint32_t inline_[INLINE_CAPACITY];
+        std::vector<uint32_t> overflow_;
+        size_t count_ = 0;
+    };
+
+    BvhAabb Fatten(const BvhAabb& aabb) const {
+        return BvhAabb{ { aabb.min.x - margin_, aabb.min.y - margin_, aabb.min.z - margin_ },
+                        { aabb.max.x + margin_, aabb.max.y + margin_, aabb.max.z + margin_ } };
+    }
+
+    static float SafeInverse(float v) {
+        return std::fabs(v) > 1e-12f ? 1.0f / v : (v < 0.0f ? -1e30f : 1e30f);
+    }
+
+    /**
+     * @brief スラブ法による半直線とAABBの判定
+     * @param[out] enter 入る距離(始点が内側なら 0)
+     */
+    static bool RayHitsAabb(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& inv, const BvhAabb& box, float maxDistance, float& enter) {
+        float t1 = (box.min.x - origin.x) * inv.x, t2 = (box.max.x - origin.x) * inv.x;
+        float tmin = (std::min)(t1, t2), tmax = (std::max)(t1, t2);
+        t1 = (box.min.y - origin.y) * inv.y;
+        t2 = (box.max.y - origin.y) * inv.y;
+        tmin = (std::max)(tmin, (std::min)(t1, t2));
+        tmax = (std::min)(tmax, (std::max)(t1, t2));
+        t1 = (box.min.z - origin.z) * inv.z;
+        t2 = (box.max.z - origin.z) * inv.z;
+        tmin = (std::max)(tmin, (std::min)(t1, t2));
+        tmax = (std::min)(tmax, (std::max)(t1, t2));
+        enter = (std::max)(tmin, 0.0f);
+        return tmax >= enter && enter <= maxDistance;
+    }
+
+    /**
+     * @brief AABB と視錐台の判定
+     * @param[out] inside 6平面すべての内側にある場合 true
+     * @return bool 外側と確定しなかった場合 true
+     */
+    static bool FrustumTest(const Frustum& frustum, const BvhAabb& box, bool& inside) {
+        const float cx = 0.5f * (box.min.x + box.max.x), cy = 0.5f * (box.min.y + box.max.y), cz = 0.5f * (box.min.z + box.max.z);
+        const float ex = 0.5f * (box.max.x - box.min.x), ey = 0.5f * (box.max.y - box.min.y), ez = 0.5f * (box.max.z - box.min.z);
+        inside = true;
+        for (const DirectX::XMFLOAT4& pl : frustum.planes) {
+            float distance = pl.x * cx + pl.y * cy + pl.z * cz + pl.w;
+            float reach = std::fabs(pl.x) * ex + std::fabs(pl.y) * ey + std::fabs(pl.z) * ez;
+            if (distance < -reach) return false;
+            if (distance < reach) inside = false;
+        }
+        return true;
+    }
+
+    template<typename Fn>
+    bool ReportSubtree(uint32_t index, Fn& fn) const {
+        NodeStack stack;
+        stack.Push(index);
+        while (!stack.Empty()) {
+            const Node& node = nodes_[stack.Pop()];
+            if (node.IsLeaf()) {
+                if (!fn(static_cast<uint32_t>(&node - nodes_.data()))) return false;
+            } else {
+                stack.Push(node.child1);
+                stack.Push(node.child2);
+            }
+        }
+        return true;
+    }
+
+    uint32_t AllocateNode() {
+        if (freeList_ == NULL_NODE) {
+            nodes_.emplace_back();
+            return static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        uint32_t index = freeList_;
+        freeList_ = nodes_[index].parent;
+        nodes_[index] = Node{};
+        return index;
+    }
+
+    void FreeNode(uint32_t index) {
+        nodes_[index].parent = freeList_;
+        nodes_[index].height = -1;
+        freeList_ = index;
+    }
+
+    void InsertLeaf(uint32_t leaf) {
+        if (root_ == NULL_NODE) {
+            root_ = leaf;
+            nodes_[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        // 表面積の増分が最小になる兄弟を探す(祖先が広がる分も子孫に引き継ぐ)
+        const BvhAabb leafAabb = nodes_[leaf].aabb;
+        uint32_t index = root_;
+        while (!nodes_[index].IsLeaf()) {
+            const Node& node = nodes_[index];
+            float area = node.aabb.SurfaceArea();
+            float combinedArea = BvhAabb::Union(node.aabb, leafAabb).SurfaceArea();
+            float cost = 2.0f * combinedArea;                     // ここで新しい親を作る場合
+            float inheritance = 2.0f * (combinedArea - area);     // 子へ下りる場合に祖先が広がる分
+
+            float cost1 = ChildCost(node.child1, leafAabb) + inheritance;
+            float cost2 = ChildCost(node.child2, leafAabb) + inheritance;
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        const uint32_t sibling = index;
+        const uint32_t oldParent = nodes_[sibling].parent;
+        const uint32_t newParent = AllocateNode(); // 以降は nodes_ の再確保がない
+        Node& parent = nodes_[newParent];
+        parent.parent = oldParent;
+        parent.aabb = BvhAabb::Union(leafAabb, nodes_[sibling].aabb);
+        parent.height = nodes_[sibling].height + 1;
+        parent.child1 = sibling;
+        parent.child2 = leaf;
+        nodes_[sibling].parent = newParent;
+        nodes_[leaf].parent = newParent;
+
+        if (oldParent != NULL_NODE) {
+            if (nodes_[oldParent].child1 == sibling) nodes_[oldParent].child1 = newParent;
+            else nodes_[oldParent].child2 = newParent;
+        } else {
+            root_ = newParent;
+        }
+
+        Refit(newParent);
+    }
+
+    float ChildCost(uint32_t child, const BvhAabb& leafAabb) const {
+        const Node& node = nodes_[child];
+        float combined = BvhAabb::Union(leafAabb, node.aabb).SurfaceArea();
+        return node.IsLeaf() ? combined : combined - node.aabb.SurfaceArea();
+    }
+
+    void RemoveLeaf(uint32_t leaf) {
+        if (leaf == root_) {
+            root_ = NULL_NODE;
+            return;
+        }
+
+        const uint32_t parent = nodes_[leaf].parent;
+        const uint32_t grandParent = nodes_[parent].parent;
+        const uint32_t sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+        if (grandParent != NULL_NODE) {
+            if (nodes_[grandParent].child1 == parent) nodes_[grandParent].child1 = sibling;
+            else nodes_[grandParent].child2 = sibling;
+            nodes_[sibling].parent = grandParent;
+            FreeNode(parent);
+            Refit(grandParent);
+        } else {
+            root_ = sibling;
+            nodes_[sibling].parent = NULL_NODE;
+            FreeNode(parent);
+        }
+    }
+
+    /**
+     * @brief index から根までを回転しながらAABBと高さを更新
+     */
+    void Refit(uint32_t index) {
+        while (index != NULL_NODE) {
+            index = Balance(index);
+            Node& node = nodes_[index];
+            const Node& child1 = nodes_[node.child1];
+            const Node& child2 = nodes_[node.child2];
+            node.height = 1 + (std::max)(child1.height, child2.height);
+            node.aabb = BvhAabb::Union(child1.aabb, child2.aabb);
+            index = node.parent;
+        }
+    }
+
+    void ReplaceChild(uint32_t parent, uint32_t oldChild, uint32_t newChild) {
+        if (parent == NULL_NODE) {
+            root_ = newChild;
+        } else if (nodes_[parent].child1 == oldChild) {
+            nodes_[parent].child1 = newChild;
+        } else {
+            nodes_[parent].child2 = newChild;
+        }
+    }
+
+    /**
+     * @brief 子の高さの差が2以上なら高い方の子を持ち上げる
+     * @return uint32_t 回転後に iA の位置に来た節
+     */
+    uint32_t Balance(uint32_t iA) {
+        Node& A = nodes_[iA];
+        if (A.IsLeaf() || A.height < 2) return iA;
+
+        const uint32_t iB = A.child1;
+        const uint32_t iC = A.child2;
+        Node& B = nodes_[iB];
+        Node& C = nodes_[iC];
+        const int32_t balance = C.height - B.height;
+
+        if (balance > 1) {
+            // C を持ち上げる
+            const uint32_t iF = C.child1;
+            const uint32_t iG = C.child2;
+            Node& F = nodes_[iF];
+            Node& G = nodes_[iG];
+
+            C.child1 = iA;
+            C.parent = A.parent;
+            A.parent = iC;
+            ReplaceChild(C.parent, iA, iC);
+
+            if (F.height > G.height) {
+                C.child2 = iF;
+                A.child2 = iG;
+                G.parent = iA;
+                A.aabb = BvhAabb::Union(B.aabb, G.aabb);
+                C.aabb = BvhAabb::Union(A.aabb, F.aabb);
+                A.height = 1 + (std::max)(B.height, G.height);
+                C.height = 1 + (std::max)(A.height, F.height);
+            } else {
+                C.child2 = iG;
+                A.child2 = iF;
+                F.parent = iA;
+                A.aabb = BvhAabb::Union(B.aabb, F.aabb);
+                C.aabb = BvhAabb::Union(A.aabb, G.aabb);
+                A.height = 1 + (std::max)(B.height, F.height);
+                C.height = 1 + (std::max)(A.height, G.height);
+            }
+            return iC;
+        }
+
+        if (balance < -1) {
+            // B を持ち上げる
+            const uint32_t iD = B.child1;
+            const uint32_t iE = B.child2;
+            Node& D = nodes_[iD];
+            Node& E = nodes_[iE];
+
+            B.child1 = iA;
+            B.parent = A.parent;
+            A.parent = iB;
+            ReplaceChild(B.parent, iA, iB);
+
+            if (D.height > E.height) {
+                B.child2 = iD;
+                A.child1 = iE;
+                E.parent = iA;
+                A.aabb = BvhAabb::Union(C.aabb, E.aabb);
+                B.aabb = BvhAabb::Union(A.aabb, D.aabb);
+                A.height = 1 + (std::max)(C.height, E.height);
+                B.height = 1 + (std::max)(A.height, D.height);
+            } else {
+                B.child2 = iE;
+                A.child1 = iD;
+                D.parent = iA;
+                A.aabb = BvhAabb::Union(C.aabb, D.aabb);
+                B.aabb = BvhAabb::Union(A.aabb, E.aabb);
+                A.height = 1 + (std::max)(C.height, D.height);
+                B.height = 1 + (std::max)(A.height, E.height);
+            }
+            return iB;
+        }
+
+        return iA;
+    }
+
+    std::vector<Node> nodes_;
+    uint32_t root_ = NULL_NODE;
+    uint32_t freeList_ = NULL_NODE;
+    size_t proxyCount_ = 0;
+    uint64_t reinserts_ = 0;
+    float margin_ = DEFAULT_MARGIN;
+};
@@ -0,0 +1,137 @@
+/**
+ * @file DynamicResolution.h
+ * @brief GPU時間の履歴から描画解像度の倍率を決める動的解像度の制御
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * GPU時間はおおむね描画するピクセル数(倍率の2乗)に比例するとみなし、目標時間に収まる倍率を求めます。
+ * - 下げる: 直近の1フレームが目標を超えたら、すぐに目標の HEADROOM 倍に収まる倍率まで下げる(負荷の急増に1回で追従)
+ * - 上げる: 履歴(HISTORY_SIZE フレーム)の最大値が目標の RAISE_THRESHOLD 倍を下回っている間だけ、
+ *   1回 MAX_RAISE_STEP までゆっくり上げる(上げ下げの往復を防ぐ)
+ *
+ * GpuProfiler の結果は数フレーム遅れて届くため、倍率を変えた後の SETTLE_FRAMES フレームは
+ * 変更前の解像度の計測として読み捨て、履歴も空にしてから数え直します。
+ * 倍率は SCALE_QUANTUM 単位に丸めます(わずかな変化でビューポートを揺らさない)。
+ */
+#pragma once
+#include "graphics/GpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class DynamicResolution
+ * @brief 目標のGPU時間を保つ描画解像度の倍率の制御
+ *
+ * @par 使用例
+ * @code
+ * DynamicResolution dynamicResolution;
+ * dynamicResolution.SetTargetMs(1000.0f / gfx.RefreshRate());
+ * dynamicResolution.SetEnabled(true);
+ *
+ * // フレームごと(GPU時間の計測後)
+ * gfx.SetRenderScale(dynamicResolution.Update(gfx.Profiler().FrameMs()));
+ * @endcode
+ */
+class DynamicResolution {
+public:
+    static constexpr size_t HISTORY_SIZE = 30;             ///< 倍率を上げる判定に使うフレーム数
+    static constexpr uint32_t SETTLE_FRAMES = GpuProfiler::LATENCY + 1; ///< 倍率の変更が計測に現れるまでのフレーム数
+    static constexpr float DEFAULT_MIN_SCALE = 0.5f;      ///< 倍率の下限の既定値
+    static constexpr float HEADROOM = 0.9f;               ///< 目標時間に対して狙う割合
+    static constexpr float RAISE_THRESHOLD = 0.75f;       ///< 履歴の最大値がこの割合を下回ったら上げる
+    static constexpr float MAX_RAISE_STEP = 0.05f;        ///< 1回に上げる倍率の上限
+    static constexpr float SCALE_QUANTUM = 1.0f / 64.0f;  ///< 倍率の刻み
+
+    void SetEnabled(bool enabled) {
+        enabled_ = enabled;
+        Reset();
+    }
+
+    bool IsEnabled() const { return enabled_; }
+
+    /**
+     * @brief 目標のGPU時間(ミリ秒、例: 1000 / リフレッシュレート)
+     */
+    void SetTargetMs(float ms) { targetMs_ = (std::max)(ms, 0.1f); }
+    float TargetMs() const { return targetMs_; }
+
+    /**
+     * @brief 倍率の範囲(上限は 1 まで)
+     */
+    void SetScaleRange(float minScale, float maxScale) {
+        maxScale_ = (std::min)((std::max)(maxScale, SCALE_QUANTUM), 1.0f);
+        minScale_ = (std::min)((std::max)(minScale, SCALE_QUANTUM), maxScale_);
+        scale_ = (std::min)((std::max)(scale_, minScale_), maxScale_);
+    }
+
+    /**
+     * @brief 倍率を上限に戻し、履歴を空にする
+     */
+    void Reset() {
+        scale_ = maxScale_;
+        historyCount_ = 0;
+        historyNext_ = 0;
+        settle_ = SETTLE_FRAMES;
+    }
+
+    /**
+     * @brief 1フレーム分のGPU時間を記録し、次のフレームの倍率を返す
+     * @param[in] gpuMs GPU時間(ミリ秒、0 以下は計測なしとして無視)
+     * @return float 描画解像度の倍率(無効な場合は常に上限)
+     */
+    float Update(float gpuMs) {
+        if (!enabled_ || gpuMs <= 0.0f) return scale_;
+        if (settle_ > 0) {
+            --settle_;
+            return scale_;
+        }
+
+        // 目標を超えたフレームがあれば、すぐに収まる倍率まで下げる
+        if (gpuMs > targetMs_) {
+            return Apply(scale_ * std::sqrt(targetMs_ * HEADROOM / gpuMs));
+        }
+
+        history_[historyNext_] = gpuMs;
+        historyNext_ = (historyNext_ + 1) % HISTORY_SIZE;
+        if (historyCount_ < HISTORY_SIZE) ++historyCount_;
+        if (historyCount_ < HISTORY_SIZE || scale_ >= maxScale_) return scale_;
+
+        // 履歴全体に余裕がある場合だけ、少しずつ上げる
+        const float peak = *std::max_element(history_, history_ + HISTORY_SIZE);
+        if (peak >= targetMs_ * RAISE_THRESHOLD) return scale_;
+        const float wanted = scale_ * std::sqrt(targetMs_ * HEADROOM / peak);
+        return Apply((std::min)(wanted, scale_ + MAX_RAISE_STEP));
+    }
+
+    /**
+     * @brief 現在の倍率
+     */
+    float Scale() const { return scale_; }
+
+private:
+    float Apply(float wanted) {
+        float next = std::floor(wanted / SCALE_QUANTUM) * SCALE_QUANTUM;
+        next = (std::min)((std::max)(next, minScale_), maxScale_);
+        if (next != scale_) {
+            scale_ = next;
+            historyCount_ = 0;
+            historyNext_ = 0;
+            settle_ = SETTLE_FRAMES;
+        }
+        return scale_;
+    }
+
+    float history_[HISTORY_SIZE] = {};  ///< 現在の倍率で計測したGPU時間(ミリ秒、リング)
+    size_t historyCount_ = 0;
+    size_t historyNext_ = 0;
+    uint32_t settle_ = 0;               ///< 読み捨てる残りフレーム数
+    float targetMs_ = 1000.0f / 60.0f;
+    float minScale_ = DEFAULT_MIN_SCALE;
+    float maxScale_ = 1.0f;
+    float scale_ = 1.0f;
+    bool enabled_ = false;
+};
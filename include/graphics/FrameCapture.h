@@ -0,0 +1,372 @@
+/**
+ * @file FrameCapture.h
+ * @brief 1フレーム分の描画キューの記録(バイナリ形式)と読み書き
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * RenderSystem::RequestFrameCapture() で、次のフレームにソート・カリング済みの描画キュー(不透明の DrawPacket 列)を
+ * ファイルに書き出します。パケットが参照するバッファ(頂点・インデックス・マテリアル・スキニングの影響)は
+ * 内容を読み戻して1つずつ表に入れ、テクスチャは読み込み元のファイルのパスで記録します。
+ * カメラ・ライトの定数とスキニング行列も含むため、シミュレーションや World がなくても同じ描画を再現できます。
+ *
+ * `--replay-capture` で起動すると、App は記録したパケットを RenderSystem::RenderReplay() で毎フレーム同じ送信経路
+ * (ソート・深度プリパス・定数バッファのリング・遅延コンテキストの設定に従う)から送り直し、
+ * 送信時間と GPU 時間を RenderBenchmark と同じ CSV に書き出します。
+ * 描画の設定やシェーダーを変えた時の比較を、決まった負荷で行えます。
+ *
+ * 記録するのは描画キューだけです(インスタンス描画・半透明・影・パーティクル・点光源のクラスタは含まない)。
+ * ファイルから読み込んだのではないテクスチャ(メモリから作成したものなど)はテクスチャなしで再生します。
+ *
+ * ### 形式(リトルエンディアン、境界揃えなし)
+ * - ヘッダ: "HFCP", バージョン(u16), フラグ(u16), 本体の展開後サイズ(u32), 本体のサイズ(u32)
+ * - 本体(FRAME_CAPTURE_FLAG_LZ4 の場合は LZ4 ブロック形式で圧縮)
+ *   - フレーム番号(u64), 描画解像度(u32 x 2)
+ *   - フレーム定数・ライト定数: バイト数(u32) + 内容
+ *   - バッファ数(u32) + バッファ[]: バイト数・BindFlags・MiscFlags・StructureByteStride(u32 x 4) + 内容
+ *   - テクスチャ数(u32) + パス[](u16 長 + 文字列)
+ *   - スキニング行列の数(u32) + 行列[]
+ *   - パケット数(u32) + FrameCapture::Packet[]
+ *
+ * @par 使用例
+ * @code
+ * renderer.RequestFrameCapture("frame.hfcp");  // 次の Render() で書き出す
+ *
+ * FrameCapture capture;
+ * if (capture.Load("frame.hfcp") && renderer.BeginReplay(capture)) {
+ *     renderer.RenderReplay();                 // 毎フレーム Render() の代わりに呼ぶ
+ * }
+ * @endcode
+ */
+#pragma once
+#include "ecs/WorldSnapshot.h"
+#include "util/Lz4.h"
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 記録ファイルの先頭4バイト
+ */
+constexpr uint32_t FRAME_CAPTURE_MAGIC = 0x50434648u; // "HFCP"
+
+/**
+ * @brief 記録ファイルの形式バージョン(Packet や定数の構造を変えたら上げる)
+ */
+constexpr uint16_t FRAME_CAPTURE_VERSION = 1;
+
+/**
+ * @brief 本体を LZ4 ブロック形式で圧縮している
+ */
+constexpr uint16_t FRAME_CAPTURE_FLAG_LZ4 = 1u << 0;
+
+/**
+ * @struct FrameCapture
+ * @brief 記録した1フレーム分の描画キュー
+ */
+struct FrameCapture {
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;  ///< バッファ・テクスチャの表の位置: なし
+    static constexpr uint32_t PACKET_MODEL = 1u << 0; ///< Packet::flags: ModelComponent 由来(統計用)
+
+    /**
+     * @struct Buffer
+     * @brief パケットが参照するバッファ1つ(作成時の設定と内容)
+     */
+    struct Buffer {
+        uint32_t byteWidth = 0;
+        uint32_t bindFlags = 0;
+        uint32_t miscFlags = 0;
+        uint32_t structureStride = 0;
+        std::vector<uint8_t> data;  ///< byteWidth バイト
+    };
+
+    /**
+     * @struct Packet
+     * @brief DrawPacket のポインタとハンドルを表の位置に置き換えたもの(そのままファイルに複写する)
+     */
+    struct Packet {
+        uint64_t sortKey = 0;
+        uint32_t vertexBuffer = NONE;    ///< buffers の位置
+        uint32_t indexBuffer = NONE;     ///< buffers の位置
+        uint32_t materialBuffer = NONE;  ///< buffers の位置
+        uint32_t skinBuffer = NONE;      ///< buffers の位置(NONE はスキニングしない)
+        uint32_t indexCount = 0;
+        uint32_t startIndex = 0;
+        int32_t baseVertex = 0;
+        uint32_t indexFormat = 0;        ///< DXGI_FORMAT
+        uint32_t vertexFormat = 0;       ///< VertexFormat
+        uint32_t texture = NONE;         ///< textures の位置
+        uint32_t normalTexture = NONE;   ///< textures の位置
+        uint32_t boneOffset = 0;
+        uint32_t flags = 0;              ///< PACKET_MODEL
+        DirectX::XMFLOAT4X4 world;
+        DirectX::XMFLOAT2 uvOffset{ 0.0f, 0.0f };
+        DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };
+    };
+    static_assert(std::is_trivially_copyable<Packet>::value, "FrameCapture::Packet is copied as raw bytes");
+
+    uint64_t frame = 0;                         ///< 記録した RenderSystem のフレーム番号
+    uint32_t renderWidth = 0;                   ///< 記録時の描画解像度
+    uint32_t renderHeight = 0;
+    std::vector<uint8_t> frameConstants;        ///< RenderSystem::FrameConstants の内容
+    std::vector<uint8_t> lightConstants;        ///< RenderSystem::PSLightConstants の内容
+    std::vector<Buffer> buffers;                ///< 参照されるバッファ(重複なし)
+    std::vector<std::string> textures;          ///< 参照されるテクスチャのパス(空はファイルなし)
+    std::vector<DirectX::XMFLOAT4X4> skinPalette; ///< スキニング行列(Packet::boneOffset が指す)
+    std::vector<Packet> packets;                ///< ソート済みの順
+
+    /**
+     * @brief バッファの内容の合計バイト数
+     */
+    size_t BufferBytes() const {
+        size_t bytes = 0;
+        for (const Buffer& b : buffers) bytes += b.data.size();
+        return bytes;
+    }
+
+    /**
+     * @brief ファイルに書き出す
+     * @param[in] path 書き出し先
+     * @param[in] compress 本体を LZ4 で圧縮する
+     * @return bool 成功した場合 true
+     */
+    bool Save(const std::string& path, bool compress = true) const {
+        std::vector<uint8_t> body;
+        SnapshotWriter out(body);
+        out.WriteU64(frame);
+        out.WriteU32(renderWidth);
+        out.WriteU32(renderHeight);
+        out.WriteU32(static_cast<uint32_t>(frameConstants.size()));
+        out.WriteBytes(frameConstants.data(), frameConstants.size());
+        out.WriteU32(static_cast<uint32_t>(lightConstants.size()));
+        out.WriteBytes(lightConstants.data(), lightConstants.size());
+
+        out.WriteU32(static_cast<uint32_t>(buffers.size()));
+        for (const Buffer& b : buffers) {
+            out.WriteU32(b.byteWidth);
+            out.WriteU32(b.bindFlags);
+            out.WriteU32(b.miscFlags);
+            out.WriteU32(b.structureStride);
+            out.WriteBytes(b.data.data(), b.data.size());
+        }
+        out.WriteU32(static_cast<uint32_t>(textures.size()));
+        for (const std::string& texture : textures) out.WriteString(texture);
+        out.WriteU32(static_cast<uint32_t>(skinPalette.size()));
+        out.WriteBytes(skinPalette.data(), skinPalette.size() * sizeof(DirectX::XMFLOAT4X4));
+        out.WriteU32(static_cast<uint32_t>(packets.size()));
+        out.WriteBytes(packets.data(), packets.size() * sizeof(Packet));
+
+        std::vector<uint8_t> file;
+        SnapshotWriter header(file);
+        header.WriteU32(FRAME_CAPTURE_MAGIC);
+        header.WriteU16(FRAME_CAPTURE_VERSION);
+        header.WriteU16(compress ? FRAME_CAPTURE_FLAG_LZ4 : 0);
+        header.WriteU32(static_cast<uint32_t>(body.size()));
+        const size_t storedAt = header.ReserveU32();
+        const size_t begin = file.size();
+        if (compress) {
+            util::Lz4::Compress(body.data(), body.size(), file);
+        } else {
+            header.WriteBytes(body.data(), body.size());
+        }
+        header.PatchU32(storedAt, static_cast<uint32_t>(file.size() - begin));
+        return WriteSnapshotFile(path, file);
+    }
+
+    /**
+     * @brief ファイルから読み込む(失敗時は内容を変更しない)
+     * @param[in] path 読み込むファイル
+     * @param[out] error 失敗した理由(省略可)
+     * @return bool 成功した場合 true
+     */
+    bool Load(const std::string& path, std::string* error = nullptr) {
+        auto fail = [error](const char* reason) {
+            if (error) *error = reason;
+            return false;
+        };
+
+        std::vector<uint8_t> file;
+        if (!ReadSnapshotFile(path, file)) return fail("ファイルを開けません");
+        SnapshotReader header(file.data(), file.size());
+        if (header.ReadU32() != FRAME_CAPTURE_MAGIC) return fail("記録ファイルではありません");
+        if (header.ReadU16() != FRAME_CAPTURE_VERSION) return fail("形式のバージョンが異なります");
+        const uint16_t flags = header.ReadU16();
+        const uint32_t rawSize = header.ReadU32();
+        const uint32_t storedSize = header.ReadU32();
+        const uint8_t* stored = header.Skip(storedSize);
+        if (!stored) return fail("ファイルが途中で切れています");
+
+        std::vector<uint8_t> body;
+        if (flags & FRAME_CAPTURE_FLAG_LZ4) {
+            body.resize(rawSize);
+            if (util::Lz4::Decompress(stored, storedSize, body.data(), body.size()) != rawSize) return fail("展開できません");
+        } else {
+            body.assign(stored, stored + storedSize);
+        }
+
+        FrameCapture loaded;
+        SnapshotReader in(body.data(), body.size());
+        loaded.frame = in.ReadU64();
+        loaded.renderWidth = in.ReadU32();
+        loaded.renderHeight = in.ReadU32();
+        if (!readBlob(in, loaded.frameConstants) || !readBlob(in, loaded.lightConstants)) return fail("定数を読めません");
+
+        const uint32_t bufferCount = in.ReadU32();
+        if (in.Failed() || bufferCount > in.Remaining()) return fail("バッファの表が壊れています");
+        loaded.buffers.resize(bufferCount);
+        for (Buffer& b : loaded.buffers) {
+            b.byteWidth = in.ReadU32();
+            b.bindFlags = in.ReadU32();
+            b.miscFlags = in.ReadU32();
+            b.structureStride = in.ReadU32();
+            const uint8_t* data = in.Skip(b.byteWidth);
+            if (!data) return fail("バッファの内容が途中で切れています");
+            b.data.assign(data, data + b.byteWidth);
+        }
+
+        const uint32_t textureCount = in.ReadU32();
+        if (in.Failed() || textureCount > in.Remaining()) return fail("テクスチャの表が壊れています");
+        loaded.textures.resize(textureCount);
+        for (std::string& texture : loaded.textures) texture = in.ReadString();
+
+        const uint32_t matrixCount = in.ReadU32();
+        if (in.Failed() || matrixCount > in.Remaining() / sizeof(DirectX::XMFLOAT4X4)) return fail("スキニング行列が壊れています");
+        loaded.skinPalette.resize(matrixCount);
+        in.ReadBytes(loaded.skinPalette.data(), matrixCount * sizeof(DirectX::XMFLOAT4X4));
+
+        const uint32_t packetCount = in.ReadU32();
+        if (in.Failed() || packetCount > in.Remaining() / sizeof(Packet)) return fail("パケットの列が壊れています");
+        loaded.packets.resize(packetCount);
+        in.ReadBytes(loaded.packets.data(), packetCount * sizeof(Packet));
+        if (in.Failed() || in.Remaining() != 0) return fail("本体の大きさが一致しません");
+
+        for (const Packet& p : loaded.packets) {
+            const uint32_t refs[] = { p.vertexBuffer, p.indexBuffer, p.materialBuffer, p.skinBuffer };
+            for (uint32_t ref : refs) {
+                if (ref != NONE && ref >= bufferCount) return fail("パケットが範囲外のバッファを参照しています");
+            }
+            if ((p.texture != NONE && p.texture >= textureCount) || (p.normalTexture != NONE && p.normalTexture >= textureCount)) {
+                return fail("パケットが範囲外のテクスチャを参照しています");
+            }
+            if (p.vertexBuffer == NONE || p.indexBuffer == NONE) return fail("パケットにメッシュがありません");
+        }
+
+        *this = std::move(loaded);
+        return true;
+    }
+
+    /**
+     * @brief GPU のバッファの設定と内容を読み戻す(ステージングバッファへの複写を待つため記録時だけ使う)
+     * @return bool 成功した場合 true
+     */
+    static bool ReadBuffer(ID3D11Device* device, ID3D11DeviceContext* ctx, ID3D11Buffer* buffer, Buffer& out) {
+        D3D11_BUFFER_DESC desc{};
+        buffer->GetDesc(&desc);
+
+        D3D11_BUFFER_DESC sd{};
+        sd.ByteWidth = desc.ByteWidth;
+        sd.Usage = D3D11_USAGE_STAGING;
+        sd.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        sd.MiscFlags = desc.MiscFlags & D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        sd.StructureByteStride = desc.StructureByteStride;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> staging;
+        if (FAILED(device->CreateBuffer(&sd, nullptr, staging.GetAddressOf()))) return false;
+        ctx->CopyResource(staging.Get(), buffer);
+
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        if (FAILED(ctx->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped))) return false;
+        out.byteWidth = desc.ByteWidth;
+        out.bindFlags = desc.BindFlags;
+        out.miscFlags = desc.MiscFlags;
+        out.structureStride = desc.StructureByteStride;
+        const uint8_t* src = static_cast<const uint8_t*>(mapped.pData);
+        out.data.assign(src, src + desc.ByteWidth);
+        ctx->Unmap(staging.Get(), 0);
+        return true;
+    }
+
+    /**
+     * @brief 記録した設定と内容でバッファを作り直す(再生用、変更しないため IMMUTABLE)
+     */
+    static Microsoft::WRL::ComPtr<ID3D11Buffer> CreateBuffer(ID3D11Device* device, const Buffer& b) {
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = b.byteWidth;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = b.bindFlags & (D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_INDEX_BUFFER | D3D11_BIND_CONSTANT_BUFFER | D3D11_BIND_SHADER_RESOURCE);
+        desc.MiscFlags = b.miscFlags & D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = b.structureStride;
+        D3D11_SUBRESOURCE_DATA init{};
+        init.pSysMem = b.data.data();
+
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        if (b.byteWidth == 0 || FAILED(device->CreateBuffer(&desc, &init, buffer.GetAddressOf()))) return nullptr;
+        return buffer;
+    }
+
+private:
+    static bool readBlob(SnapshotReader& in, std::vector<uint8_t>& out) {
+        const uint32_t size = in.ReadU32();
+        const uint8_t* data = in.Skip(size);
+        if (!data) return false;
+        out.assign(data, data + size);
+        return true;
+    }
+};
+
+/**
+ * @class FrameCaptureBuilder
+ * @brief 記録中のバッファ・テクスチャの重複を除いて表の位置を割り当てる
+ */
+class FrameCaptureBuilder {
+public:
+    FrameCaptureBuilder(FrameCapture& capture, ID3D11Device* device, ID3D11DeviceContext* ctx)
+        : capture_(capture), device_(device), ctx_(ctx) {}
+
+    /**
+     * @brief バッファを表に加える(同じバッファは同じ位置、nullptr や読み戻せないものは NONE)
+     */
+    uint32_t AddBuffer(ID3D11Buffer* buffer) {
+        if (!buffer) return FrameCapture::NONE;
+        auto it = buffers_.find(buffer);
+        if (it != buffers_.end()) return it->second;
+
+        uint32_t index = FrameCapture::NONE;
+        FrameCapture::Buffer contents;
+        if (FrameCapture::ReadBuffer(device_, ctx_, buffer, contents)) {
+            index = static_cast<uint32_t>(capture_.buffers.size());
+            capture_.buffers.push_back(std::move(contents));
+        }
+        buffers_.emplace(buffer, index);
+        return index;
+    }
+
+    /**
+     * @brief テクスチャを表に加える
+     * @param[in] handle TextureManager のハンドル(0 は NONE)
+     * @param[in] pathOf std::string() 形式の関数(初めてのハンドルだけ呼ぶ。読み込み元のファイル、空なら再生時はテクスチャなし)
+     */
+    template<class F>
+    uint32_t AddTexture(uint32_t handle, F&& pathOf) {
+        if (handle == 0) return FrameCapture::NONE;
+        auto it = textures_.find(handle);
+        if (it != textures_.end()) return it->second;
+        const uint32_t index = static_cast<uint32_t>(capture_.textures.size());
+        capture_.textures.push_back(pathOf());
+        textures_.emplace(handle, index);
+        return index;
+    }
+
+private:
+    FrameCapture& capture_;
+    ID3D11Device* device_;
+    ID3D11DeviceContext* ctx_;
+    std::unordered_map<ID3D11Buffer*, uint32_t> buffers_;  ///< バッファ -> 表の位置
+    std::unordered_map<uint32_t, uint32_t> textures_;      ///< テクスチャのハンドル -> 表の位置
+};
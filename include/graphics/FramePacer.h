@@ -0,0 +1,129 @@
+/**
+ * @file FramePacer.h
+ * @brief 目標フレームレートまで待つフレームリミッター
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 高精度の待機可能タイマー(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION、Windows 10 1803 以降)で
+ * 次の締め切りの直前まで眠り、残りのわずかな時間だけ yield しながら待ちます。
+ * 高精度タイマーを作成できない環境では通常の待機可能タイマーを使います(精度はタイマー分解能に依存)。
+ * GfxDevice の PresentMode::FixedRate が Present の直前に Wait() を呼びます。
+ */
+#pragma once
+#include <Windows.h>
+#include <chrono>
+#include <thread>
+#include "app/DebugLog.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+/**
+ * @class FramePacer
+ * @brief 一定間隔の締め切りまでスレッドを待たせる
+ *
+ * @par 使用例
+ * @code
+ * FramePacer pacer;
+ * pacer.Init();
+ * pacer.SetTargetHz(120.0f);
+ *
+ * // 毎フレーム(Present の直前)
+ * float waited = pacer.Wait();
+ * @endcode
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr float DEFAULT_TARGET_HZ = 60.0f;
+
+    /**
+     * @brief タイマーの作成
+     * @return bool 待機可能タイマーを作成できた場合 true(失敗時も yield だけで待機は行う)
+     */
+    bool Init() {
+        Shutdown();
+        timer_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        highResolution_ = timer_ != nullptr;
+        if (!timer_) {
+            timer_ = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+        if (!timer_) {
+            DEBUGLOG_WARNING("[FramePacer] 待機可能タイマーの作成失敗、yield で待機します");
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("[FramePacer] 待機可能タイマー: ") + (highResolution_ ? "高精度" : "通常"));
+        return true;
+    }
+
+    void Shutdown() {
+        if (timer_) CloseHandle(timer_);
+        timer_ = nullptr;
+        highResolution_ = false;
+        Reset();
+    }
+
+    /**
+     * @brief 目標のフレームレート(Hz、1以上)
+     */
+    void SetTargetHz(float hz) {
+        targetHz_ = hz >= 1.0f ? hz : 1.0f;
+        Reset();
+    }
+    float TargetHz() const { return targetHz_; }
+
+    /**
+     * @brief 次の締め切りを「次の Wait() の時点から1周期後」に戻す(モード切り替え時など)
+     */
+    void Reset() { hasDeadline_ = false; }
+
+    /**
+     * @brief 次の締め切りまで待つ
+     * @return float 待った時間(秒)
+     *
+     * @details
+     * 締め切りを1周期ずつ進めるため、フレームごとのばらつきは次のフレームで吸収されます。
+     * 1周期以上遅れた場合は遅れを取り戻そうとせず、現在時刻から数え直します。
+     */
+    float Wait() {
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetHz_));
+        const Clock::time_point start = Clock::now();
+        if (!hasDeadline_ || start - deadline_ > period) {
+            deadline_ = start + period;
+            hasDeadline_ = true;
+        }
+
+        // 締め切りの spinMargin() 前までタイマーで眠る
+        Clock::duration remaining = deadline_ - Clock::now();
+        const Clock::duration sleep = remaining - spinMargin();
+        if (timer_ && sleep > Clock::duration::zero()) {
+            LARGE_INTEGER due{};
+            due.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(sleep).count() / 100); // 相対時間(100ns単位)
+            if (SetWaitableTimerEx(timer_, &due, 0, nullptr, nullptr, nullptr, 0)) {
+                WaitForSingleObject(timer_, INFINITE);
+            }
+        }
+        while (Clock::now() < deadline_) {
+            std::this_thread::yield();
+        }
+
+        deadline_ += period;
+        return std::chrono::duration<float>(Clock::now() - start).count();
+    }
+
+private:
+    // タイマーの分解能を考慮して、締め切り直前は yield で待つ時間
+    Clock::duration spinMargin() const {
+        return highResolution_ ? std::chrono::microseconds(500) : std::chrono::milliseconds(2);
+    }
+
+    HANDLE timer_ = nullptr;
+    bool highResolution_ = false;
+    float targetHz_ = DEFAULT_TARGET_HZ;
+    bool hasDeadline_ = false;
+    Clock::time_point deadline_;
+};
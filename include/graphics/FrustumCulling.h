@@ -0,0 +1,251 @@
+/**
+ * @file FrustumCulling.h
+ * @brief 視錐台と境界球によるCPUカリング
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ビュー・プロジェクション行列から6平面を抽出し、境界球を4個ずつSIMD(DirectXMath)で判定します。
+ * 判定は範囲単位で独立しているため、JobSystem::ParallelFor で分割して並列実行できます。
+ */
+#pragma once
+#include "app/JobSystem.h"
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+/**
+ * @struct Frustum
+ * @brief 視錐台の6平面(法線は内向き、正規化済み)
+ */
+struct Frustum {
+    DirectX::XMFLOAT4 planes[6]; ///< 左・右・下・上・手前・奥 (a, b, c, d): ax + by + cz + d >= 0 が内側
+
+    /**
+     * @brief ビュー・プロジェクション行列(行ベクトル規約)から平面を抽出
+     */
+    static Frustum FromViewProj(const DirectX::XMMATRIX& viewProj) {
+        // 転置すると各行が元の列になる(clip.x = dot(v, col0) など)
+        DirectX::XMMATRIX t = DirectX::XMMatrixTranspose(viewProj);
+        DirectX::XMVECTOR p[6] = {
+            DirectX::XMVectorAdd(t.r[3], t.r[0]),      // 左
+            DirectX::XMVectorSubtract(t.r[3], t.r[0]), // 右
+            DirectX::XMVectorAdd(t.r[3], t.r[1]),      // 下
+            DirectX::XMVectorSubtract(t.r[3], t.r[1]), // 上
+            t.r[2],                                    // 手前(D3Dのクリップ空間は z >= 0)
+            DirectX::XMVectorSubtract(t.r[3], t.r[2]), // 奥
+        };
+
+        Frustum f;
+        for (int i = 0; i < 6; ++i) {
+            DirectX::XMStoreFloat4(&f.planes[i], DirectX::XMPlaneNormalize(p[i]));
+        }
+        return f;
+    }
+
+    /**
+     * @brief 境界球1個の判定
+     */
+    bool IntersectsSphere(const DirectX::XMFLOAT3& center, float radius) const {
+        for (int i = 0; i < 6; ++i) {
+            const DirectX::XMFLOAT4& pl = planes[i];
+            if (pl.x * center.x + pl.y * center.y + pl.z * center.z + pl.w < -radius) return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @class SphereCullList
+ * @brief 境界球をSoA配列に集めて一括判定するリスト
+ *
+ * @details
+ * Add() の順序がそのまま Visible() の添字になります。
+ *
+ * @par 使用例
+ * @code
+ * cull.Clear();
+ * for (auto& obj : objects) cull.Add(obj.center, obj.radius);
+ * size_t visible = cull.Run(cam.frustum, jobs);
+ * for (size_t i = 0; i < objects.size(); ++i) {
+ *     if (cull.Visible(i)) Draw(objects[i]);
+ * }
+ * @endcode
+ */
+class SphereCullList {
+public:
+    static constexpr size_t PARALLEL_THRESHOLD = 4096; ///< これ以上の件数で並列判定
+    static constexpr size_t GRAIN_SIZE = 1024;         ///< 並列判定の1ジョブあたりの件数(4の倍数)
+
+    void Clear() {
+        xs_.clear();
+        ys_.clear();
+        zs_.clear();
+        rs_.clear();
+        visible_.clear();
+    }
+
+    /**
+     * @brief 境界球を追加
+     * @param[in] center ワールド空間の中心
+     * @param[in] radius 半径(0以下は境界不明としてカリングしない)
+     */
+    void Add(const DirectX::XMFLOAT3& center, float radius) {
+        xs_.push_back(center.x);
+        ys_.push_back(center.y);
+        zs_.push_back(center.z);
+        rs_.push_back(radius > 0.0f ? radius : FLT_MAX);
+    }
+
+    size_t Size() const { return xs_.size(); }
+
+    /**
+     * @brief i 番目の境界球 (中心x, y, z, 半径。半径は Add() で補正した値)
+     */
+    DirectX::XMFLOAT4 Sphere(size_t i) const { return DirectX::XMFLOAT4{ xs_[i], ys_[i], zs_[i], rs_[i] }; }
+
+    /**
+     * @brief 全境界球を判定
+     * @param[in] frustum 視錐台
+     * @param[in] jobs ジョブシステム(nullptr可、件数が多い場合に並列化)
+     * @return size_t 可視の件数
+     */
+    size_t Run(const Frustum& frustum, JobSystem* jobs) {
+        const size_t n = xs_.size();
+        visible_.assign(n, 0);
+        if (n == 0) return 0;
+
+        if (jobs && jobs->IsRunning() && n >= PARALLEL_THRESHOLD) {
+            jobs->ParallelFor(n, GRAIN_SIZE, [this, &frustum](size_t begin, size_t end) {
+                cullRange(frustum, begin, end);
+            });
+        } else {
+            cullRange(frustum, 0, n);
+        }
+
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) count += visible_[i];
+        return count;
+    }
+
+    bool Visible(size_t i) const { return visible_[i] != 0; }
+    const uint8_t* VisibleFlags() const { return visible_.data(); }
+
+    /**
+     * @brief Run() の後で i 番目を不可視にする(遮蔽カリングなど、別の判定の結果を反映)
+     */
+    void Hide(size_t i) { visible_[i] = 0; }
+
+    size_t VisibleCount() const {
+        size_t count = 0;
+        for (uint8_t v : visible_) count += v;
+        return count;
+    }
+
+private:
+    // [begin, end) を判定(4個ずつSIMD、端数はスカラー)
+    void cullRange(const Frustum& frustum, size_t begin, size_t end) {
+        using namespace DirectX;
+
+        XMVECTOR pa[6], pb[6], pc[6], pd[6];
+        for (int p = 0; p < 6; ++p) {
+            pa[p] = XMVectorReplicate(frustum.planes[p].x);
+            pb[p] = XMVectorReplicate(frustum.planes[p].y);
+            pc[p] = XMVectorReplicate(frustum.planes[p].z);
+            pd[p] = XMVectorReplicate(frustum.planes[p].w);
+        }
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            XMVECTOR x = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&xs_[i]));
+            XMVECTOR y = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&ys_[i]));
+            XMVECTOR z = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&zs_[i]));
+            XMVECTOR negR = XMVectorNegate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&rs_[i])));
+
+            XMVECTOR inside = XMVectorTrueInt();
+            for (int p = 0; p < 6; ++p) {
+                XMVECTOR d = XMVectorMultiplyAdd(x, pa[p], XMVectorMultiplyAdd(y, pb[p], XMVectorMultiplyAdd(z, pc[p], pd[p])));
+                inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(d, negR));
+            }
+
+            uint32_t mask[4];
+            XMStoreInt4(mask, inside);
+            visible_[i + 0] = mask[0] != 0;
+            visible_[i + 1] = mask[1] != 0;
+            visible_[i + 2] = mask[2] != 0;
+            visible_[i + 3] = mask[3] != 0;
+        }
+
+        for (; i < end; ++i) {
+            visible_[i] = frustum.IntersectsSphere(XMFLOAT3{ xs_[i], ys_[i], zs_[i] }, rs_[i]) ? 1 : 0;
+        }
+    }
+
+    std::vector<float> xs_;          ///< 中心X
+    std::vector<float> ys_;          ///< 中心Y
+    std::vector<float> zs_;          ///< 中心Z
+    std::vector<float> rs_;          ///< 半径
+    std::vector<uint8_t> visible_;   ///< 判定結果(1: 可視)
+};
+
+/**
+ * @brief ローカル空間の境界球をワールド空間へ変換
+ * @param[in] world ワールド行列
+ * @param[in] localCenter ローカル空間の中心
+ * @param[in] localRadius ローカル空間の半径(0以下はそのまま返す)
+ * @param[out] center ワールド空間の中心
+ * @return float ワールド空間の半径(最大軸スケールで拡大)
+ */
+inline float TransformBoundingSphere(const DirectX::XMMATRIX& world, const DirectX::XMFLOAT3& localCenter, float localRadius, DirectX::XMFLOAT3& center) {
+    using namespace DirectX;
+    XMStoreFloat3(&center, XMVector3TransformCoord(XMLoadFloat3(&localCenter), world));
+    if (localRadius <= 0.0f) return localRadius;
+
+    float sx = XMVectorGetX(XMVector3LengthSq(world.r[0]));
+    float sy = XMVectorGetX(XMVector3LengthSq(world.r[1]));
+    float sz = XMVectorGetX(XMVector3LengthSq(world.r[2]));
+    float maxScaleSq = sx > sy ? (sx > sz ? sx : sz) : (sy > sz ? sy : sz);
+    return localRadius * std::sqrt(maxScaleSq);
+}
+
+/**
+ * @brief 頂点位置から境界球を計算(AABBの中心を中心とする)
+ * @param[in] positions 先頭頂点の位置
+ * @param[in] count 頂点数
+ * @param[in] stride 頂点間のバイト数
+ * @param[out] center ローカル空間の中心
+ * @return float 半径(頂点がなければ 0)
+ */
+inline float ComputeBoundingSphere(const DirectX::XMFLOAT3* positions, size_t count, size_t stride, DirectX::XMFLOAT3& center) {
+    center = DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f };
+    if (!positions || count == 0) return 0.0f;
+
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(positions);
+    auto at = [base, stride](size_t i) { return reinterpret_cast<const DirectX::XMFLOAT3*>(base + i * stride); };
+
+    DirectX::XMFLOAT3 minP = *at(0);
+    DirectX::XMFLOAT3 maxP = *at(0);
+    for (size_t i = 1; i < count; ++i) {
+        const DirectX::XMFLOAT3& p = *at(i);
+        if (p.x < minP.x) minP.x = p.x;
+        if (p.y < minP.y) minP.y = p.y;
+        if (p.z < minP.z) minP.z = p.z;
+        if (p.x > maxP.x) maxP.x = p.x;
+        if (p.y > maxP.y) maxP.y = p.y;
+        if (p.z > maxP.z) maxP.z = p.z;
+    }
+    center = DirectX::XMFLOAT3{ (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+
+    float maxDistSq = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        const DirectX::XMFLOAT3& p = *at(i);
+        float dx = p.x - center.x, dy = p.y - center.y, dz = p.z - center.z;
+        float d = dx * dx + dy * dy + dz * dz;
+        if (d > maxDistSq) maxDistSq = d;
+    }
+    return std::sqrt(maxDistSq);
+}
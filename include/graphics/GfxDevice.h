@@ -3,7 +3,7 @@
  * @brief DirectX11デバイス管理クラス
  * @author 山内陽
  * @date 2025
- * @version 5.0
+ * @version 5.5
  * 
  * @details 
  * DirectX11の初期化、デバイス・コンテキストの管理、描画フレームの制御を行います。
@@ -13,10 +13,23 @@
 #define NOMINMAX
 #include <Windows.h>
 #include <d3d11.h>
+#include <d3d11_1.h>
+#include <dxgi1_5.h>
 #include <wrl/client.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <mutex>
 #include "app/DebugLog.h"
+#include "app/StartupReport.h"
+#include "graphics/GpuProfiler.h"
+#include "graphics/MeshPool.h"
+#include "graphics/VertexFormat.h"
+#include "graphics/FramePacer.h"
+#include "graphics/ResolutionScaler.h"
+#include "graphics/PipelineState.h"
 
 #ifdef _DEBUG
 #include <dxgidebug.h>
@@ -35,6 +48,11 @@
  * - スワップチェインの作成
  * - レンダーターゲットビューと深度ステンシルビューの管理
  * - フレームの開始・終了処理
+ * - タイムスタンプクエリによるGPU時間の計測(Profiler())
+ * - 静的メッシュの共有頂点・インデックスバッファ(Meshes()、頂点形式ごと)
+ * - 表示モードの切り替え(SetPresentMode: VSync / 適応 / 無制限 / 固定レート / 低遅延)
+ * - シーンの描画解像度の倍率(SetRenderScale、縮小して描いたシーンを ResolveScene でバックバッファに拡大)
+ * - ウィンドウの大きさの変更(Resize、ResizeBuffers で大きさに依存するリソースだけを作り直す)
  * 
  * @par 使用例
  * @code
@@ -58,6 +76,101 @@
  */
 class GfxDevice {
 public:
+    /**
+     * @enum PresentMode
+     * @brief 表示(Present)のモード
+     */
+    enum class PresentMode : uint8_t {
+        VSync,      ///< 垂直同期(Present(1, 0))
+        Adaptive,   ///< 垂直同期、ただし前フレームがリフレッシュ間隔に間に合わなかった場合はティアリングを許可して即座に表示
+        Uncapped,   ///< 同期なし(ティアリング対応環境では DXGI_PRESENT_ALLOW_TEARING)、真のスループットの計測用
+        FixedRate,  ///< SetTargetFrameRate() の間隔まで待機可能タイマーで待ってから同期なしで表示
+        LowLatency, ///< 垂直同期 + 最大フレーム遅延1、WaitForNextFrame() でフレーム遅延待機オブジェクトを待つ
+        Count
+    };
+
+    static constexpr float MIN_RENDER_SCALE = 0.25f;            ///< SetRenderScale() の下限
+    static constexpr UINT MIN_BUFFER_COUNT = 2;                 ///< SetBufferCount() の下限(フリップモデルの最小)
+    static constexpr UINT MAX_BUFFER_COUNT = 4;                 ///< SetBufferCount() の上限
+    static constexpr UINT DEFAULT_BUFFER_COUNT = 3;             ///< スワップチェインのバッファ数の既定値
+    static constexpr const char* GPU_SCOPE_UPSCALE = "Upscale"; ///< ResolveScene() の拡大(GpuProfiler のスコープ名)
+
+    static const char* PresentModeName(PresentMode mode) {
+        switch (mode) {
+            case PresentMode::VSync: return "VSync";
+            case PresentMode::Adaptive: return "Adaptive";
+            case PresentMode::Uncapped: return "Uncapped";
+            case PresentMode::FixedRate: return "FixedRate";
+            case PresentMode::LowLatency: return "LowLatency";
+            default: return "Unknown";
+        }
+    }
+
+    /**
+     * @brief バッファのサイズ(バイト、MemoryTracker への報告用)
+     */
+    static size_t BufferBytes(ID3D11Buffer* buffer) {
+        if (!buffer) return 0;
+        D3D11_BUFFER_DESC desc{};
+        buffer->GetDesc(&desc);
+        return desc.ByteWidth;
+    }
+
+    /**
+     * @brief テクスチャのおおよそのサイズ(バイト、全ミップ・全スライス、MemoryTracker への報告用)
+     *
+     * @details
+     * BC 形式は4x4ブロック単位で数えます。それ以外はよく使う形式の1ピクセルのバイト数で、
+     * 不明な形式は4バイトとして数えます。
+     */
+    static size_t TextureBytes(ID3D11Texture2D* texture) {
+        if (!texture) return 0;
+        D3D11_TEXTURE2D_DESC desc{};
+        texture->GetDesc(&desc);
+
+        size_t blockBytes = 0;    // BC 形式の1ブロックのバイト数(0 は非圧縮)
+        size_t pixelBytes = 4;
+        switch (desc.Format) {
+            case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+            case DXGI_FORMAT_BC4_UNORM: case DXGI_FORMAT_BC4_SNORM:
+                blockBytes = 8; break;
+            case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+            case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+            case DXGI_FORMAT_BC5_UNORM: case DXGI_FORMAT_BC5_SNORM:
+            case DXGI_FORMAT_BC6H_UF16: case DXGI_FORMAT_BC6H_SF16:
+            case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+                blockBytes = 16; break;
+            case DXGI_FORMAT_R8_UNORM: pixelBytes = 1; break;
+            case DXGI_FORMAT_R8G8_UNORM: pixelBytes = 2; break;
+            case DXGI_FORMAT_R16G16B16A16_FLOAT: pixelBytes = 8; break;
+            case DXGI_FORMAT_R32G32B32A32_FLOAT: pixelBytes = 16; break;
+            default: break;
+        }
+
+        size_t bytes = 0;
+        UINT width = desc.Width, height = desc.Height;
+        for (UINT mip = 0; mip < desc.MipLevels; ++mip) {
+            if (blockBytes > 0) {
+                bytes += static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+            } else {
+                bytes += static_cast<size_t>(width) * height * pixelBytes;
+            }
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        return bytes * desc.ArraySize;
+    }
+
+    /**
+     * @brief ハードウェアの代わりにソフトウェアラスタライザ(WARP)でデバイスを作る(Init() の前に呼ぶ)
+     *
+     * @details
+     * GPU のないビルドエージェントやサーバーで、`--warp` / `--headless` の実行に使います。
+     * 描画結果は同じですが非常に遅いため、性能の比較には使えません。
+     */
+    void SetUseWarp(bool enabled) { useWarp_ = enabled; }
+    bool IsWarp() const { return useWarp_; }
+
     /**
      * @brief 初期化
      * @param[in] hwnd ウィンドウハンドル
@@ -73,32 +186,39 @@ public:
     bool Init(HWND hwnd, uint32_t w, uint32_t h) {
         width_ = w;
         height_ = h;
+        renderWidth_ = w;
+        renderHeight_ = h;
+        renderScale_ = 1.0f;
         isShutdown_ = false;
 
-        DXGI_SWAP_CHAIN_DESC sd{};
-        sd.BufferCount = 2;
-        sd.BufferDesc.Width = w;
-        sd.BufferDesc.Height = h;
-        sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-        sd.OutputWindow = hwnd;
-        sd.SampleDesc.Count = 1;
-        sd.Windowed = TRUE;
-        sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD; // FLIP_DISCARDに変更（推奨モデル）
-
         UINT flags = 0;
 #if defined(_DEBUG)
         flags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
+        // 動画のハードウェアデコード(VideoPlayer)用。ビデオ対応のないドライバでは付けずに作り直す
+        StartupReport::Scope deviceScope("GfxDevice.CreateDevice");
+        const D3D_DRIVER_TYPE driverType = useWarp_ ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE;
         D3D_FEATURE_LEVEL fl;
-        HRESULT hr = D3D11CreateDeviceAndSwapChain(
-            nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, flags,
+        HRESULT hr = D3D11CreateDevice(
+            nullptr, driverType, nullptr, flags | D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
             nullptr, 0, D3D11_SDK_VERSION,
-            &sd,
-            swap_.ReleaseAndGetAddressOf(),
             device_.ReleaseAndGetAddressOf(),
             &fl,
             context_.ReleaseAndGetAddressOf());
+        videoSupport_ = SUCCEEDED(hr);
+        if (FAILED(hr)) {
+            hr = D3D11CreateDevice(
+                nullptr, driverType, nullptr, flags,
+                nullptr, 0, D3D11_SDK_VERSION,
+                device_.ReleaseAndGetAddressOf(),
+                &fl,
+                context_.ReleaseAndGetAddressOf());
+        }
+        deviceScope.End();
+        states_.Attach(context_.Get());
+        if (useWarp_) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "ドライバ: WARP (ソフトウェアラスタライザ)");
+        }
         
         if (FAILED(hr)) {
             // エラーの詳細をログ出力
@@ -113,6 +233,40 @@ public:
             return false;
         }
 
+        DXGI_SWAP_CHAIN_DESC sd{};
+        sd.BufferCount = bufferCount_;
+        sd.BufferDesc.Width = w;
+        sd.BufferDesc.Height = h;
+        sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        sd.OutputWindow = hwnd;
+        sd.SampleDesc.Count = 1;
+        sd.Windowed = TRUE;
+        sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD; // FLIP_DISCARDに変更（推奨モデル）
+
+        StartupReport::Scope swapChainScope("GfxDevice.CreateSwapChain");
+        if (!createSwapChain(sd)) {
+            MessageBoxA(nullptr, "Failed to create swap chain", "DirectX Error", MB_OK | MB_ICONERROR);
+            return false;
+        }
+        swapChainScope.End();
+
+        queryFeatures();
+
+        // GPU計測はタイムスタンプに非対応でも描画に影響しない
+        profiler_.Init(device_.Get());
+
+        // 共有メッシュバッファ(作成できなければメッシュごとのバッファで描画)
+        // 小さな頂点形式はモデルを読み込むときだけ使うため、初期容量を小さくして必要に応じて拡張する
+        meshPools_[static_cast<size_t>(VertexFormat::Standard)].Init(device_.Get());
+        for (size_t i = 1; i < VERTEX_FORMAT_COUNT; ++i) {
+            meshPools_[i].Init(device_.Get(), VertexStride(static_cast<VertexFormat>(i)), 4 * 1024, 16 * 1024);
+        }
+
+        // 固定レートのリミッター(タイマーを作成できなくても yield で待つ)
+        pacer_.Init();
+        pacer_.SetTargetHz(refreshRate_);
+
         bool ok = createBackbufferResources();
 
         // 追加: アダプタ/機能レベル/フォーマット/SwapEffect/VSYNC情報をログ
@@ -130,35 +284,271 @@ public:
      * @details
      * レンダーターゲットと深度バッファをクリアし、ビューポートを設定します。
      * すべての描画処理の前に呼び出してください。
+     * 描画解像度の倍率が 1 未満の場合、描画先は縮小したシーンのレンダーターゲットです(ResolveScene() まで)。
      */
     void BeginFrame(float r = 0.1f, float g = 0.1f, float b = 0.12f, float a = 1.0f) {
         float c[4] = { r, g, b, a };
-        context_->OMSetRenderTargets(1, rtv_.GetAddressOf(), dsv_.Get());
-        context_->ClearRenderTargetView(rtv_.Get(), c);
+        sceneScaled_ = renderScale_ < 1.0f && scaler_.IsReady();
+        BindBackbuffer(context_.Get());
+        context_->ClearRenderTargetView(sceneScaled_ ? scaler_.Rtv() : rtv_.Get(), c);
         context_->ClearDepthStencilView(dsv_.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+        profiler_.BeginFrame(context_.Get());
+    }
+
+    /**
+     * @brief バックバッファと深度バッファ、ビューポートを設定
+     * @param[in] ctx 設定先のコンテキスト(遅延コンテキストは状態を引き継がないため記録の先頭で呼ぶ)
+     *
+     * @details
+     * シーンを縮小して描いている間(BeginFrame() から ResolveScene() まで)は、シーンのレンダーターゲットと
+     * 描画解像度のビューポートを設定します。
+     */
+    void BindBackbuffer(ID3D11DeviceContext* ctx) const {
+        ID3D11RenderTargetView* rtv = sceneScaled_ ? scaler_.Rtv() : rtv_.Get();
+        ctx->OMSetRenderTargets(1, &rtv, dsv_.Get());
 
         D3D11_VIEWPORT vp{};
-        vp.Width = static_cast<FLOAT>(width_);
-        vp.Height = static_cast<FLOAT>(height_);
+        vp.Width = static_cast<FLOAT>(sceneScaled_ ? renderWidth_ : width_);
+        vp.Height = static_cast<FLOAT>(sceneScaled_ ? renderHeight_ : height_);
         vp.MinDepth = 0.0f;
         vp.MaxDepth = 1.0f;
         vp.TopLeftX = 0;
         vp.TopLeftY = 0;
-        context_->RSSetViewports(1, &vp);
+        ctx->RSSetViewports(1, &vp);
+    }
+
+    /**
+     * @brief ウィンドウの大きさの変更(WM_SIZE を受けた後、フレームの外で呼ぶ)
+     * @param[in] w 新しい幅(ピクセル単位)
+     * @param[in] h 新しい高さ(ピクセル単位)
+     * @return bool 変更できた場合 true(大きさが0(最小化)・変わらない場合は何もせず true)
+     *
+     * @details
+     * デバイス・スワップチェイン・シェーダーなどは作り直さず、ResizeBuffers でバックバッファの大きさだけを変え、
+     * 大きさに依存するもの(レンダーターゲットビュー・深度バッファ・縮小描画用のシーンのレンダーターゲット)だけを
+     * 作り直します。描画解像度の倍率は保持します。
+     */
+    bool Resize(uint32_t w, uint32_t h) {
+        if (w == 0 || h == 0 || !swap_) return true;
+        if (w == width_ && h == height_) return true;
+        if (!resizeSwapChain(bufferCount_, w, h)) return false;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "バックバッファの大きさを変更: " + std::to_string(w) + "x" + std::to_string(h));
+        return true;
+    }
+
+    /**
+     * @brief スワップチェインのバッファ数(MIN_BUFFER_COUNT～MAX_BUFFER_COUNT、Init() の前でも後でも可)
+     * @return bool 変更できた場合 true
+     *
+     * @details
+     * 2 は表示までの遅延が最も短い一方、同期なしの表示(Uncapped など)では前の表示の完了を待つことがあります。
+     * 既定の3はCPUとGPUの重なりを保ち、遅延はフレーム遅延待機オブジェクト(LowLatency では最大1フレーム)で抑えます。
+     */
+    bool SetBufferCount(UINT count) {
+        count = (std::min)((std::max)(count, MIN_BUFFER_COUNT), MAX_BUFFER_COUNT);
+        if (count == bufferCount_) return true;
+        if (!swap_) {
+            bufferCount_ = count;
+            return true;
+        }
+        if (!resizeSwapChain(count, width_, height_)) return false;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "スワップチェインのバッファ数: " + std::to_string(count));
+        return true;
+    }
+
+    UINT BufferCount() const { return bufferCount_; }
+
+    /**
+     * @brief 縮小して描いたシーンをバックバッファに拡大し、以降の描画先をバックバッファにする
+     *
+     * @details
+     * シーン(RenderSystem・デバッグ描画)の後、UI(PerfOverlay など)の前に呼びます。UI はウィンドウの解像度で描かれます。
+     * 倍率が 1 の場合は何もしません。呼ばなかった場合は EndFrame() で行います。
+     */
+    void ResolveScene() {
+        if (!sceneScaled_) return;
+        sceneScaled_ = false;
+        {
+            GpuProfileScope scope(profiler_, context_.Get(), GPU_SCOPE_UPSCALE);
+            scaler_.Upscale(states_, rtv_.Get(), renderWidth_, renderHeight_, width_, height_);
+        }
+        BindBackbuffer(context_.Get());
+    }
+
+    /**
+     * @brief 遅延コンテキストの作成(ワーカースレッドでのコマンド記録用)
+     * @param[out] out 作成したコンテキスト
+     * @return bool 作成できた場合 true
+     *
+     * @details
+     * ドライバがコマンドリストに非対応でもランタイムのエミュレーションで動作します。
+     * 記録したコマンドリストは Ctx() の ExecuteCommandList で実行してください。
+     */
+    bool CreateDeferredContext(Microsoft::WRL::ComPtr<ID3D11DeviceContext>& out) {
+        HRESULT hr = device_->CreateDeferredContext(0, out.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("GfxDevice::CreateDeferredContext() - 遅延コンテキストの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
     }
 
+    /**
+     * @brief ドライバがコマンドリストをネイティブに実行できるか
+     */
+    bool SupportsDriverCommandLists() const { return driverCommandLists_; }
+
     /**
      * @brief フレーム終了(画面表示)
      * 
      * @details
      * バックバッファをフロントバッファに切り替え、画面に表示します。
      * すべての描画処理の後に呼び出してください。
-     * 垂直同期(VSync)が有効です。
+     * 同期の方法は SetPresentMode() で選びます(既定は VSync)。
      */
     void EndFrame() {
-        swap_->Present(1, 0);
+        ResolveScene();
+        profiler_.EndFrame(context_.Get());
+
+        float limiterWait = 0.0f;
+        UINT syncInterval = 1;
+        UINT presentFlags = 0;
+        switch (presentMode_) {
+            case PresentMode::Adaptive:
+                // 前フレームの表示間隔がリフレッシュ間隔を超えた(垂直同期を逃した)場合だけ同期しない
+                if (lastPresentInterval_ > ADAPTIVE_LATE_FACTOR / refreshRate_) {
+                    syncInterval = 0;
+                    presentFlags = tearingPresentFlag();
+                }
+                break;
+            case PresentMode::Uncapped:
+                syncInterval = 0;
+                presentFlags = tearingPresentFlag();
+                break;
+            case PresentMode::FixedRate:
+                limiterWait = pacer_.Wait();
+                syncInterval = 0;
+                presentFlags = tearingPresentFlag();
+                break;
+            default:
+                break;
+        }
+        swap_->Present(syncInterval, presentFlags);
+        pacingWait_ = frameLatencyWait_ + limiterWait;
+        frameLatencyWait_ = 0.0f;
+
+        auto now = std::chrono::steady_clock::now();
+        if (hasLastPresent_) {
+            lastPresentInterval_ = std::chrono::duration<float>(now - lastPresentTime_).count();
+        }
+        lastPresentTime_ = now;
+        hasLastPresent_ = true;
     }
 
+    /**
+     * @brief 次のフレームを始めてよくなるまで待つ(フレームの先頭、入力の取得前に呼ぶ)
+     * @return float 待った時間(秒)
+     *
+     * @details
+     * フレーム遅延待機オブジェクトに対応している場合、スワップチェインのキューに空きができるまで待ちます。
+     * LowLatency では最大フレーム遅延が1になるため、入力から表示までの遅延が最小になります。
+     * EndFrame() の後、固定レートの待ち時間と合わせて LastPacingWait() で取得できます。
+     */
+    float WaitForNextFrame() {
+        if (!frameLatencyWaitable_) return 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        WaitForSingleObjectEx(frameLatencyWaitable_, 1000, TRUE);
+        frameLatencyWait_ = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        return frameLatencyWait_;
+    }
+
+    /**
+     * @brief 表示モードの設定
+     *
+     * @details
+     * ティアリング非対応の環境では Uncapped / FixedRate / Adaptive の同期なしの表示は
+     * DXGI_PRESENT_ALLOW_TEARING なしで行います(ウィンドウモードではコンポジタの間隔に制限される場合があります)。
+     */
+    void SetPresentMode(PresentMode mode) {
+        if (mode >= PresentMode::Count) mode = PresentMode::VSync;
+        presentMode_ = mode;
+        pacer_.Reset();
+        applyFrameLatency();
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("表示モード: ") + PresentModeName(mode) +
+            (mode == PresentMode::FixedRate ? " (" + std::to_string(static_cast<int>(pacer_.TargetHz())) + "Hz)" : std::string()));
+    }
+    PresentMode GetPresentMode() const { return presentMode_; }
+
+    /**
+     * @brief FixedRate の目標フレームレート(Hz、既定はディスプレイのリフレッシュレート)
+     */
+    void SetTargetFrameRate(float hz) { pacer_.SetTargetHz(hz); }
+    float TargetFrameRate() const { return pacer_.TargetHz(); }
+
+    /**
+     * @brief 直前のフレームの表示待ちの時間(秒): WaitForNextFrame() と FixedRate のリミッターの合計
+     */
+    float LastPacingWait() const { return pacingWait_; }
+
+    /**
+     * @brief 前回と前々回の Present() の間隔(秒)
+     */
+    float LastPresentInterval() const { return lastPresentInterval_; }
+
+    /**
+     * @brief ディスプレイのリフレッシュレート(Hz、取得できない場合は60)
+     */
+    float RefreshRate() const { return refreshRate_; }
+
+    /**
+     * @brief DXGI_PRESENT_ALLOW_TEARING を使えるか
+     */
+    bool SupportsTearing() const { return tearingSupported_; }
+
+    /**
+     * @brief フレーム遅延待機オブジェクトを使えるか
+     */
+    bool SupportsFrameLatencyWaitable() const { return frameLatencyWaitable_ != nullptr; }
+
+    /**
+     * @brief GPU時間の計測(既定は無効、GpuProfiler::SetEnabled で有効化)
+     *
+     * @details
+     * BeginFrame() から EndFrame() までを1フレームとして計測します。
+     * 描画パスは GpuProfileScope で囲んでください。
+     */
+    GpuProfiler& Profiler() { return profiler_; }
+    const GpuProfiler& Profiler() const { return profiler_; }
+
+    /**
+     * @brief 静的メッシュ(基本形状・モデル)の共有頂点・インデックスバッファ
+     *
+     * @details
+     * RenderSystem の基本形状と ModelLoader::ResolveTextures() で確定したモデルのメッシュを割り当てます。
+     * 頂点形式ごとに別のバッファです。割り当ては即時コンテキストを使うため、ResourceMutex() の保護下で行ってください。
+     */
+    MeshPool& Meshes(VertexFormat format = VertexFormat::Standard) { return meshPools_[static_cast<size_t>(format)]; }
+    const MeshPool& Meshes(VertexFormat format = VertexFormat::Standard) const { return meshPools_[static_cast<size_t>(format)]; }
+
+    /**
+     * @brief すべての頂点形式の共有メッシュバッファのGPUメモリ(バイト)
+     */
+    size_t MeshGpuMemoryBytes() const {
+        size_t bytes = 0;
+        for (const MeshPool& pool : meshPools_) bytes += pool.GpuMemoryBytes();
+        return bytes;
+    }
+
+    /**
+     * @brief 描画とシミュレーションを並行して行う間、テクスチャ・モデルの管理と即時コンテキストを守るロック
+     *
+     * @details
+     * App は並列シミュレーション中の描画(RenderSystem::Render から Present まで)の間これを保持します。
+     * シミュレーション側から TextureManager / ResourceManager の読み込みを行う処理
+     * (ModelLoadingSystem)は、その間だけこのロックを取ります。保持したまま描画を呼ばないでください。
+     */
+    std::mutex& ResourceMutex() { return resourceMutex_; }
+
     /**
      * @brief デバイスアクセス
      * @return ID3D11Device* デバイスポインタ
@@ -177,6 +567,50 @@ public:
      */
     ID3D11DeviceContext* Ctx() const { return context_.Get(); }
 
+    /**
+     * @brief D3D11.1 のデバイスコンテキスト
+     * @return ID3D11DeviceContext1* 取得できない環境では nullptr
+     */
+    ID3D11DeviceContext1* Ctx1() const { return context1_.Get(); }
+
+    /**
+     * @brief 即時コンテキストのステートキャッシュ
+     *
+     * @details
+     * 即時コンテキストでシェーダー・入力レイアウト・固定機能ステート・定数バッファ・サンプラーを設定する描画は、
+     * Ctx() に直接ではなくここを通して設定します(同じ値の再設定を省略するため)。
+     * 直接設定した場合は StateCache::Invalidate() を呼んでください。
+     */
+    StateCache& States() { return states_; }
+
+    /**
+     * @brief 定数バッファのオフセット指定バインドが使えるか
+     *
+     * @details
+     * VSSetConstantBuffers1 などの範囲指定と、動的定数バッファへの MAP_WRITE_NO_OVERWRITE の両方に
+     * 対応している場合に true です。
+     */
+    bool SupportsConstantBufferOffsets() const { return constantBufferOffsets_; }
+
+    /**
+     * @brief コンピュートシェーダー(cs_5_0)と間接描画が使えるか(機能レベル 11_0 以上)
+     *
+     * @details
+     * RenderSystem は初期化時にこれを見て、GPUでのカリング(DrawIndexedInstancedIndirect)と
+     * GPUパーティクルの経路を選びます。
+     */
+    bool SupportsComputeShaders() const { return computeShaders_; }
+
+    /**
+     * @brief 動画をGPUでデコードして NV12 のテクスチャのまま描画に使えるか
+     *
+     * @details
+     * デバイスを D3D11_CREATE_DEVICE_VIDEO_SUPPORT 付きで作成でき、NV12 のテクスチャを
+     * シェーダーで読める場合に true です。VideoPlayer はこれを見て、DXVA のデコードと
+     * シェーダーでの YUV → RGB 変換を選びます(false の場合は CPU で RGB32 に変換)。
+     */
+    bool SupportsHardwareVideoDecode() const { return hardwareVideoDecode_; }
+
     /**
      * @brief 幅を取得
      * @return uint32_t 幅(ピクセル単位)
@@ -188,6 +622,45 @@ public:
      * @return uint32_t 高さ(ピクセル単位)
      */
     uint32_t Height() const { return height_; }
+
+    /**
+     * @brief シーンの描画解像度の倍率(ウィンドウの大きさに対する縦横の割合)
+     * @param[in] scale MIN_RENDER_SCALE～1(1 の場合はバックバッファに直接描く)
+     *
+     * @details
+     * 次の BeginFrame() から反映します。1 未満の場合、シーンはウィンドウと同じ大きさのレンダーターゲットの
+     * 左上 RenderWidth() x RenderHeight() に描き、ResolveScene() でバックバッファに拡大します
+     * (倍率を変えてもテクスチャは作り直しません)。レンダーターゲットは初めて 1 未満にしたときに作成し、
+     * 作成できない環境では常に 1 です。
+     */
+    void SetRenderScale(float scale) {
+        scale = (std::min)((std::max)(scale, MIN_RENDER_SCALE), 1.0f);
+        if (scale < 1.0f && !scaler_.IsReady()) {
+            if (scalerFailed_ || !scaler_.Init(device_.Get(), width_, height_)) {
+                if (!scalerFailed_) DEBUGLOG_WARNING("GfxDevice::SetRenderScale() - シーンのレンダーターゲットを作成できないため倍率は1のままです");
+                scalerFailed_ = true;
+                scale = 1.0f;
+            }
+        }
+        renderScale_ = scale;
+        renderWidth_ = (std::max)(1u, static_cast<uint32_t>(std::lround(static_cast<float>(width_) * scale)));
+        renderHeight_ = (std::max)(1u, static_cast<uint32_t>(std::lround(static_cast<float>(height_) * scale)));
+    }
+
+    /**
+     * @brief シーンの描画解像度の倍率
+     */
+    float RenderScale() const { return renderScale_; }
+
+    /**
+     * @brief シーンの描画解像度の幅(ピクセル単位、倍率が 1 の場合は Width())
+     */
+    uint32_t RenderWidth() const { return renderWidth_; }
+
+    /**
+     * @brief シーンの描画解像度の高さ(ピクセル単位、倍率が 1 の場合は Height())
+     */
+    uint32_t RenderHeight() const { return renderHeight_; }
     
     /**
      * @brief リソースの明示的解放
@@ -204,6 +677,7 @@ public:
         if (context_) {
             DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "ID3D11DeviceContext::ClearState() を呼び出し");
             context_->ClearState();
+            states_.Invalidate();
             
             DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "ID3D11DeviceContext::Flush() を呼び出し");
             context_->Flush();
@@ -237,6 +711,13 @@ public:
             releasedCount++;
         }
         
+        if (frameLatencyWaitable_) {
+            CloseHandle(frameLatencyWaitable_);
+            frameLatencyWaitable_ = nullptr;
+        }
+        swap2_.Reset();
+        pacer_.Shutdown();
+
         if (swap_) {
             ULONG refCount = swap_.Get()->AddRef() - 1;
             swap_.Get()->Release();
@@ -246,11 +727,20 @@ public:
             releasedCount++;
         }
         
+        profiler_.Shutdown();
+        scaler_.Shutdown();
+        sceneScaled_ = false;
+        for (MeshPool& pool : meshPools_) pool.Shutdown();
+        context1_.Reset();
+        constantBufferOffsets_ = false;
+        computeShaders_ = false;
+
         if (context_) {
             ULONG refCount = context_.Get()->AddRef() - 1;
             context_.Get()->Release();
             ctxRefForReport = static_cast<long>(refCount);
             DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "デバイスコンテキストを解放 (ULONG RefCount: " + std::to_string(refCount) + ")");
+            states_.Attach(nullptr);
             context_.Reset();
             releasedCount++;
         }
@@ -317,6 +807,113 @@ public:
     }
 
 private:
+    /**
+     * @brief スワップチェインの作成(ティアリングとフレーム遅延待機オブジェクトを可能なら有効化)
+     * @param[in,out] sd 設定(Flags はここで決める)
+     * @return bool 作成できた場合 true
+     *
+     * @details
+     * スワップチェインのフラグは作成時にしか指定できないため、デバイスのアダプタからファクトリを取得して
+     * ティアリング対応を確認してから作成します。フラグ付きで作成できない環境ではフラグなしで作り直します。
+     */
+    bool createSwapChain(DXGI_SWAP_CHAIN_DESC& sd) {
+        Microsoft::WRL::ComPtr<IDXGIDevice> dxgiDevice;
+        Microsoft::WRL::ComPtr<IDXGIAdapter> adapter;
+        Microsoft::WRL::ComPtr<IDXGIFactory> factory;
+        if (FAILED(device_.As(&dxgiDevice)) || FAILED(dxgiDevice->GetAdapter(adapter.GetAddressOf())) ||
+            FAILED(adapter->GetParent(__uuidof(IDXGIFactory), reinterpret_cast<void**>(factory.GetAddressOf())))) {
+            return false;
+        }
+
+        tearingSupported_ = false;
+        Microsoft::WRL::ComPtr<IDXGIFactory5> factory5;
+        if (SUCCEEDED(factory.As(&factory5))) {
+            BOOL allowTearing = FALSE;
+            if (SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing)))) {
+                tearingSupported_ = allowTearing != FALSE;
+            }
+        }
+
+        sd.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        if (tearingSupported_) sd.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+        HRESULT hr = factory->CreateSwapChain(device_.Get(), &sd, swap_.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("スワップチェインをフラグ付きで作成できません (HRESULT: 0x" + std::to_string(hr) + ")、フラグなしで作り直します");
+            sd.Flags = 0;
+            tearingSupported_ = false;
+            hr = factory->CreateSwapChain(device_.Get(), &sd, swap_.ReleaseAndGetAddressOf());
+            if (FAILED(hr)) return false;
+        }
+
+        // Alt+Enter の排他フルスクリーンはティアリングと併用できないため無効化
+        factory->MakeWindowAssociation(sd.OutputWindow, DXGI_MWA_NO_ALT_ENTER);
+
+        swapFlags_ = sd.Flags;
+        frameLatencyWaitable_ = nullptr;
+        if ((sd.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT) && SUCCEEDED(swap_.As(&swap2_))) {
+            frameLatencyWaitable_ = swap2_->GetFrameLatencyWaitableObject();
+        }
+        applyFrameLatency();
+
+        refreshRate_ = queryRefreshRate(adapter.Get(), sd);
+        return true;
+    }
+
+    // 最大フレーム遅延(LowLatency は1、それ以外は DXGI の既定と同じ3)
+    void applyFrameLatency() {
+        if (swap2_) {
+            swap2_->SetMaximumFrameLatency(presentMode_ == PresentMode::LowLatency ? 1 : 3);
+        }
+    }
+
+    // 最初の出力(モニター)のデスクトップ解像度に最も近いモードのリフレッシュレート
+    static float queryRefreshRate(IDXGIAdapter* adapter, const DXGI_SWAP_CHAIN_DESC& sd) {
+        Microsoft::WRL::ComPtr<IDXGIOutput> output;
+        if (FAILED(adapter->EnumOutputs(0, output.GetAddressOf()))) return 60.0f;
+        DXGI_OUTPUT_DESC outputDesc{};
+        output->GetDesc(&outputDesc);
+        DXGI_MODE_DESC want{};
+        want.Width = static_cast<UINT>(outputDesc.DesktopCoordinates.right - outputDesc.DesktopCoordinates.left);
+        want.Height = static_cast<UINT>(outputDesc.DesktopCoordinates.bottom - outputDesc.DesktopCoordinates.top);
+        want.Format = sd.BufferDesc.Format;
+        DXGI_MODE_DESC closest{};
+        if (FAILED(output->FindClosestMatchingMode(&want, &closest, nullptr)) || closest.RefreshRate.Denominator == 0) return 60.0f;
+        float hz = static_cast<float>(closest.RefreshRate.Numerator) / static_cast<float>(closest.RefreshRate.Denominator);
+        return hz >= 1.0f ? hz : 60.0f;
+    }
+
+    UINT tearingPresentFlag() const { return tearingSupported_ ? DXGI_PRESENT_ALLOW_TEARING : 0; }
+
+    /**
+     * @brief バックバッファの大きさ・数を変更し、大きさに依存するリソースを作り直す
+     *
+     * @details
+     * バックバッファを参照するビューが残っていると ResizeBuffers は失敗するため、先に外して解放します。
+     * フラグは作成時と同じもの(ティアリング・待機オブジェクト)を渡します。失敗した場合は元の大きさで作り直します。
+     */
+    bool resizeSwapChain(UINT count, uint32_t w, uint32_t h) {
+        context_->OMSetRenderTargets(0, nullptr, nullptr);
+        sceneScaled_ = false;
+        rtv_.Reset();
+        dsv_.Reset();
+        scaler_.Shutdown();
+        context_->Flush();
+
+        HRESULT hr = swap_->ResizeBuffers(count, w, h, DXGI_FORMAT_UNKNOWN, swapFlags_);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("GfxDevice::ResizeBuffers() 失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            createBackbufferResources();
+            SetRenderScale(renderScale_);
+            return false;
+        }
+        bufferCount_ = count;
+        width_ = w;
+        height_ = h;
+        const bool ok = createBackbufferResources();
+        SetRenderScale(renderScale_); // シーンのレンダーターゲットを新しい大きさで作り直し、描画解像度を計算し直す
+        return ok;
+    }
+
     /**
      * @brief バックバッファリソースの作成
      * @return bool 作成が成功した場合は true
@@ -371,6 +968,47 @@ private:
         return true;
     }
 
+    /**
+     * @brief マルチスレッドと D3D11.1 の機能を確認
+     *
+     * @details
+     * Windows 8 以降のランタイムでは機能レベル11.0でも ID3D11DeviceContext1 を取得できます。
+     * 取得できない場合は従来の ID3D11DeviceContext だけで動作します。
+     */
+    void queryFeatures() {
+        constantBufferOffsets_ = false;
+        driverCommandLists_ = false;
+
+        computeShaders_ = device_->GetFeatureLevel() >= D3D_FEATURE_LEVEL_11_0;
+        DEBUGLOG(std::string("コンピュートシェーダー・間接描画: ") + (computeShaders_ ? "対応" : "非対応 (機能レベル 11_0 未満)"));
+
+        hardwareVideoDecode_ = false;
+        UINT nv12Support = 0;
+        if (videoSupport_ && SUCCEEDED(device_->CheckFormatSupport(DXGI_FORMAT_NV12, &nv12Support))) {
+            const UINT required = D3D11_FORMAT_SUPPORT_TEXTURE2D | D3D11_FORMAT_SUPPORT_SHADER_SAMPLE;
+            hardwareVideoDecode_ = (nv12Support & required) == required;
+        }
+        DEBUGLOG(std::string("動画のハードウェアデコード (NV12): ") + (hardwareVideoDecode_ ? "対応" : "非対応"));
+
+        D3D11_FEATURE_DATA_THREADING threading{};
+        if (SUCCEEDED(device_->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading)))) {
+            driverCommandLists_ = threading.DriverCommandLists != FALSE;
+        }
+        DEBUGLOG(std::string("コマンドリスト: ") + (driverCommandLists_ ? "ドライバ対応" : "ランタイムでエミュレーション"));
+
+        if (FAILED(context_.As(&context1_))) {
+            context1_.Reset();
+            DEBUGLOG("D3D11.1: 非対応 (ID3D11DeviceContext1 を取得できません)");
+            return;
+        }
+
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+        if (SUCCEEDED(device_->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))) {
+            constantBufferOffsets_ = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+        }
+        DEBUGLOG(std::string("定数バッファのオフセット指定: ") + (constantBufferOffsets_ ? "対応" : "非対応"));
+    }
+
     /**
      * @brief 環境メトリクスのログ出力
      * @param fl 機能レベル
@@ -416,9 +1054,11 @@ private:
             case DXGI_SWAP_EFFECT_FLIP_DISCARD: swapEffectText = "FLIP_DISCARD (推奨)"; break;
             default: break;
         }
-        DEBUGLOG(std::string("スワップ効果: ") + swapEffectText);
+        DEBUGLOG(std::string("スワップ効果: ") + swapEffectText + " (バッファ数: " + std::to_string(sd.BufferCount) + ")");
         DEBUGLOG(std::string("バックバッファフォーマット: RGBA8_UNORM_sRGB (sRGB対応 - ガンマ補正有効)"));
-        DEBUGLOG(std::string("垂直同期: ON (Present(1)) - ディスプレイのリフレッシュレートに同期"));
+        DEBUGLOG(std::string("表示モード: ") + PresentModeName(presentMode_) + " (リフレッシュレート: " + std::to_string(static_cast<int>(refreshRate_ + 0.5f)) + "Hz)");
+        DEBUGLOG(std::string("ティアリング: ") + (tearingSupported_ ? "対応" : "非対応") +
+                 ", フレーム遅延待機オブジェクト: " + (frameLatencyWaitable_ ? "対応" : "非対応"));
     }
 
 #ifdef _DEBUG
@@ -431,10 +1071,41 @@ private:
     // メンバ変数
     uint32_t width_ = 0;  ///< 画面幅
     uint32_t height_ = 0; ///< 画面高さ
+    uint32_t renderWidth_ = 0;  ///< シーンの描画解像度の幅
+    uint32_t renderHeight_ = 0; ///< シーンの描画解像度の高さ
+    float renderScale_ = 1.0f;  ///< SetRenderScale()
+    bool sceneScaled_ = false;  ///< このフレームのシーンを縮小したレンダーターゲットに描いているか(ResolveScene() 前)
+    bool scalerFailed_ = false; ///< シーンのレンダーターゲットを作成できなかった
     Microsoft::WRL::ComPtr<ID3D11Device> device_;           ///< D3D11デバイス
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> context_;   ///< D3D11デバイスコンテキスト
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1_; ///< D3D11.1 デバイスコンテキスト(非対応時は空)
     Microsoft::WRL::ComPtr<IDXGISwapChain> swap_;           ///< スワップチェイン
+    Microsoft::WRL::ComPtr<IDXGISwapChain2> swap2_;         ///< 最大フレーム遅延の設定用(非対応時は空)
     Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv_;    ///< レンダーターゲットビュー
     Microsoft::WRL::ComPtr<ID3D11DepthStencilView> dsv_;    ///< 深度ステンシルビュー
+    GpuProfiler profiler_;  ///< GPU時間の計測
+    MeshPool meshPools_[VERTEX_FORMAT_COUNT]; ///< 静的メッシュの共有バッファ(頂点形式ごと)
+    FramePacer pacer_;      ///< FixedRate のリミッター
+    ResolutionScaler scaler_; ///< 縮小したシーンのレンダーターゲットと拡大
+    StateCache states_;       ///< 即時コンテキストのステートキャッシュ(States())
+    std::mutex resourceMutex_; ///< ResourceMutex()
+    PresentMode presentMode_ = PresentMode::VSync;
+    HANDLE frameLatencyWaitable_ = nullptr; ///< フレーム遅延待機オブジェクト(非対応時は nullptr)
+    bool tearingSupported_ = false;         ///< DXGI_PRESENT_ALLOW_TEARING を使えるか
+    UINT bufferCount_ = DEFAULT_BUFFER_COUNT; ///< スワップチェインのバッファ数
+    UINT swapFlags_ = 0;                    ///< スワップチェインの作成時のフラグ(ResizeBuffers にも同じものを渡す)
+    float refreshRate_ = 60.0f;             ///< ディスプレイのリフレッシュレート(Hz)
+    float pacingWait_ = 0.0f;               ///< 直前のフレームの表示待ちの時間(秒)
+    float frameLatencyWait_ = 0.0f;         ///< 現在のフレームの WaitForNextFrame() の待ち時間(秒)
+    float lastPresentInterval_ = 0.0f;      ///< 前回と前々回の Present() の間隔(秒)
+    bool hasLastPresent_ = false;
+    std::chrono::steady_clock::time_point lastPresentTime_;
+    static constexpr float ADAPTIVE_LATE_FACTOR = 1.2f;  ///< Adaptive: リフレッシュ間隔の何倍を超えたら同期を逃したとみなすか
+    bool constantBufferOffsets_ = false; ///< 定数バッファのオフセット指定に対応しているか
+    bool computeShaders_ = false;        ///< 機能レベル 11_0 以上(コンピュートシェーダー・間接描画)
+    bool videoSupport_ = false;          ///< D3D11_CREATE_DEVICE_VIDEO_SUPPORT 付きで作成できたか
+    bool useWarp_ = false;               ///< SetUseWarp()
+    bool hardwareVideoDecode_ = false;   ///< SupportsHardwareVideoDecode()
+    bool driverCommandLists_ = false;    ///< ドライバがコマンドリストに対応しているか
     bool isShutdown_ = false; ///< シャットダウン済みフラグ
 };
@@ -0,0 +1,374 @@
+/**
+ * @file GpuCulling.h
+ * @brief コンピュートシェーダーによるインスタンスの視錐台カリングと間接描画の引数の作成
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * インスタンス描画のバッチ(メッシュ・テクスチャの組)ごとに DrawIndexedInstancedIndirect の引数を用意し、
+ * 全インスタンスの境界球をコンピュートシェーダーで判定します。視錐台の内側にあるインスタンスは
+ * バッチの InstanceCount を InterlockedAdd で1つ進め、得た位置に自分の番号を書き込みます。
+ * 頂点シェーダーは可視リストを経由してインスタンスデータを読むため、CPUは可視判定の結果を知る必要がありません。
+ *
+ * ### シェーダーリソース(カリング CS):
+ * - b0: 視錐台の6平面とインスタンス数
+ * - t0: StructuredBuffer<CullInstance>  境界球とバッチ番号
+ * - u0: RWByteAddressBuffer            間接描画の引数(バッチごとに5 x uint)
+ * - u1: RWStructuredBuffer<uint>        可視リスト(バッチの先頭位置 + 順位 → インスタンス番号)
+ *
+ * ### 頂点シェーダー(GPU_CULLING バリアント):
+ * - t1: StructuredBuffer<uint> 可視リスト(ReadVisible() で取得)
+ *
+ * @note 機能レベル 11_0 以上(GfxDevice::SupportsComputeShaders())が必要です
+ */
+#pragma once
+#include "graphics/FrustumCulling.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/GfxDevice.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @class GpuCulling
+ * @brief インスタンスの視錐台カリングをGPUで行い、間接描画の引数を書き込む
+ *
+ * @par 使用例
+ * @code
+ * culling.Begin();
+ * uint32_t batch = culling.AddBatch(indexCount, startIndex, baseVertex, firstInstance);
+ * culling.AddInstance(sphere, batch);  // firstInstance から順にバッチの全インスタンス
+ * culling.Dispatch(device, ctx, frustum);
+ *
+ * ctx->VSSetShaderResources(GpuCulling::VISIBLE_SLOT, 1, culling.VisibleSrv());
+ * ctx->DrawIndexedInstancedIndirect(culling.ArgsBuffer(), GpuCulling::ArgsOffset(batch));
+ * @endcode
+ */
+class GpuCulling {
+public:
+    static constexpr UINT VISIBLE_SLOT = 1;      ///< 頂点シェーダーで可視リストを読むレジスタ(t1)
+    static constexpr UINT GROUP_SIZE = 64;       ///< カリング CS のスレッドグループの大きさ
+    static constexpr UINT ARGS_STRIDE = 5 * sizeof(uint32_t); ///< DrawIndexedInstancedIndirect の引数の大きさ
+
+    GpuCulling() = default;
+    GpuCulling(const GpuCulling&) = delete;
+    GpuCulling& operator=(const GpuCulling&) = delete;
+    GpuCulling(GpuCulling&&) noexcept = default;
+    GpuCulling& operator=(GpuCulling&&) noexcept = default;
+
+    /**
+     * @brief シェーダーのコンパイルと定数バッファの作成(バッファは Dispatch() で必要な分だけ作る)
+     */
+    bool Init(ID3D11Device* device, UINT compileFlags) {
+        Shutdown();
+        const char* CS = R"(
+            cbuffer CullConstants : register(b0) {
+                float4 gPlanes[6];
+                uint gInstanceCount;
+                uint3 gPadding;
+            };
+
+            struct CullInstance {
+                float4 sphere;
+                uint batch;
+                uint3 padding;
+            };
+
+            StructuredBuffer<CullInstance> gInstances : register(t0);
+            RWByteAddressBuffer gArgs : register(u0);
+            RWStructuredBuffer<uint> gVisible : register(u1);
+
+            [numthreads(64, 1, 1)]
+            void main(uint3 id : SV_DispatchThreadID) {
+                if (id.x >= gInstanceCount) return;
+                CullInstance c = gInstances[id.x];
+                [unroll]
+                for (uint p = 0; p < 6; ++p) {
+                    if (dot(gPlanes[p].xyz, c.sphere.xyz) + gPlanes[p].w < -c.sphere.w) return;
+                }
+
+                // 引数: IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation
+                uint args = c.batch * 20;
+                uint rank;
+                gArgs.InterlockedAdd(args + 4, 1, rank);
+                gVisible[gArgs.Load(args + 16) + rank] = id.x;
+            }
+        )";
+
+        Microsoft::WRL::ComPtr<ID3DBlob> blob, err;
+        HRESULT hr = ShaderCache::Compile(CS, nullptr, "main", "cs_5_0", compileFlags, blob, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[GpuCulling] コンピュートシェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        hr = device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, cs_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[GpuCulling] コンピュートシェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = sizeof(CullConstants);
+        hr = device->CreateBuffer(&bd, nullptr, constants_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[GpuCulling] 定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            cs_.Reset();
+            return false;
+        }
+        return true;
+    }
+
+    bool IsReady() const { return cs_ != nullptr; }
+
+    /**
+     * @brief このフレームのバッチとインスタンスを空にする
+     */
+    void Begin() {
+        instances_.clear();
+        args_.clear();
+    }
+
+    /**
+     * @brief バッチを追加
+     * @param[in] indexCount メッシュのインデックス数
+     * @param[in] startIndex メッシュの先頭インデックス(共有メッシュバッファ内の位置)
+     * @param[in] baseVertex メッシュの先頭頂点(共有メッシュバッファ内の位置)
+     * @param[in] firstInstance バッチの先頭のインスタンス番号(可視リスト内の書き込み開始位置にもなる)
+     * @return uint32_t バッチ番号(ArgsOffset() に渡す)
+     *
+     * @details
+     * StartInstanceLocation は SV_InstanceID に加算されない(インスタンス単位の頂点バッファにだけ効く)ため、
+     * 可視リスト内の開始位置を渡す欄として使います。
+     */
+    uint32_t AddBatch(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex, uint32_t firstInstance) {
+        const uint32_t batch = static_cast<uint32_t>(args_.size() / 5);
+        const uint32_t args[5] = { indexCount, 0, startIndex, static_cast<uint32_t>(baseVertex), firstInstance };
+        args_.insert(args_.end(), args, args + 5);
+        return batch;
+    }
+
+    /**
+     * @brief インスタンスを追加(追加順が可視リストのインスタンス番号になる)
+     * @param[in] sphere ワールド空間の境界球 (中心x, y, z, 半径)
+     * @param[in] batch AddBatch() の戻り値
+     */
+    void AddInstance(const DirectX::XMFLOAT4& sphere, uint32_t batch) {
+        instances_.push_back(CullInstance{ sphere, batch, { 0, 0, 0 } });
+    }
+
+    size_t InstanceCount() const { return instances_.size(); }
+    size_t BatchCount() const { return args_.size() / 5; }
+
+    /**
+     * @brief バッファを書き込み、カリングを実行
+     * @return bool 実行した場合 true(バッファを用意できなければ false。呼び出し側は CPU の経路で描く)
+     */
+    bool Dispatch(ID3D11Device* device, ID3D11DeviceContext* ctx, const Frustum& frustum) {
+        if (!cs_ || instances_.empty()) return false;
+        if (!ensureCapacity(device, instances_.size(), BatchCount())) return false;
+
+        // インスタンス
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        HRESULT hr = ctx->Map(instanceBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[GpuCulling] インスタンスバッファのMap失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        std::memcpy(mapped.pData, instances_.data(), instances_.size() * sizeof(CullInstance));
+        ctx->Unmap(instanceBuffer_.Get(), 0);
+
+        // 引数(InstanceCount は 0 から数え直す)
+        D3D11_BOX box{ 0, 0, 0, static_cast<UINT>(args_.size() * sizeof(uint32_t)), 1, 1 };
+        ctx->UpdateSubresource(argsBuffer_.Get(), 0, &box, args_.data(), 0, 0);
+
+        CullConstants constants{};
+        std::memcpy(constants.planes, frustum.planes, sizeof(constants.planes));
+        constants.instanceCount = static_cast<uint32_t>(instances_.size());
+        ctx->UpdateSubresource(constants_.Get(), 0, nullptr, &constants, 0, 0);
+
+        ID3D11UnorderedAccessView* uavs[2] = { argsUav_.Get(), visibleUav_.Get() };
+        ctx->CSSetShader(cs_.Get(), nullptr, 0);
+        ctx->CSSetConstantBuffers(0, 1, constants_.GetAddressOf());
+        ctx->CSSetShaderResources(0, 1, instanceSrv_.GetAddressOf());
+        ctx->CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
+        ctx->Dispatch((constants.instanceCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+        // 描画で可視リストを SRV、引数を間接引数として使うため外す
+        ID3D11UnorderedAccessView* nullUavs[2] = {};
+        ID3D11ShaderResourceView* nullSrv = nullptr;
+        ctx->CSSetUnorderedAccessViews(0, 2, nullUavs, nullptr);
+        ctx->CSSetShaderResources(0, 1, &nullSrv);
+        ctx->CSSetShader(nullptr, nullptr, 0);
+        return true;
+    }
+
+    /**
+     * @brief 頂点シェーダーの VISIBLE_SLOT に設定する可視リスト
+     */
+    ID3D11ShaderResourceView* const* VisibleSrv() const { return visibleSrv_.GetAddressOf(); }
+
+    ID3D11Buffer* ArgsBuffer() const { return argsBuffer_.Get(); }
+    static UINT ArgsOffset(uint32_t batch) { return batch * ARGS_STRIDE; }
+
+    /**
+     * @brief 確保しているGPUバッファの合計(バイト)
+     */
+    size_t GpuMemoryBytes() const {
+        return GfxDevice::BufferBytes(instanceBuffer_.Get()) + GfxDevice::BufferBytes(argsBuffer_.Get()) +
+               GfxDevice::BufferBytes(visibleBuffer_.Get());
+    }
+
+    void Shutdown() {
+        cs_.Reset();
+        constants_.Reset();
+        instanceBuffer_.Reset();
+        instanceSrv_.Reset();
+        argsBuffer_.Reset();
+        argsUav_.Reset();
+        visibleBuffer_.Reset();
+        visibleUav_.Reset();
+        visibleSrv_.Reset();
+        instanceCapacity_ = 0;
+        batchCapacity_ = 0;
+        instances_.clear();
+        args_.clear();
+    }
+
+private:
+    /**
+     * @struct CullInstance
+     * @brief カリング CS に渡すインスタンス1つ(HLSL側と同じレイアウト、32バイト)
+     */
+    struct CullInstance {
+        DirectX::XMFLOAT4 sphere;  ///< ワールド空間の境界球
+        uint32_t batch;            ///< バッチ番号
+        uint32_t padding[3];       ///< パディング
+    };
+
+    struct CullConstants {
+        DirectX::XMFLOAT4 planes[6];  ///< 視錐台の平面(Frustum と同じ)
+        uint32_t instanceCount;       ///< インスタンス数
+        uint32_t padding[3];          ///< パディング
+    };
+
+    static constexpr size_t MIN_INSTANCE_CAPACITY = 1024;
+    static constexpr size_t MIN_BATCH_CAPACITY = 64;
+
+    // 容量が足りなければ倍にして作り直す(インスタンスと可視リストは同じ容量)
+    bool ensureCapacity(ID3D11Device* device, size_t instances, size_t batches) {
+        if (instances > instanceCapacity_ || !instanceBuffer_) {
+            size_t capacity = (std::max)(instanceCapacity_ * 2, MIN_INSTANCE_CAPACITY);
+            while (capacity < instances) capacity *= 2;
+
+            D3D11_BUFFER_DESC bd{};
+            bd.Usage = D3D11_USAGE_DYNAMIC;
+            bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            bd.StructureByteStride = sizeof(CullInstance);
+            bd.ByteWidth = static_cast<UINT>(capacity * sizeof(CullInstance));
+            Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> instanceSrv;
+            if (!create(device, bd, instanceBuffer, "インスタンスバッファ")) return false;
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+            srvd.Format = DXGI_FORMAT_UNKNOWN;
+            srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvd.Buffer.NumElements = static_cast<UINT>(capacity);
+            if (FAILED(device->CreateShaderResourceView(instanceBuffer.Get(), &srvd, instanceSrv.GetAddressOf()))) {
+                DEBUGLOG_ERROR("[GpuCulling] インスタンスバッファのSRV作成失敗");
+                return false;
+            }
+
+            bd = D3D11_BUFFER_DESC{};
+            bd.Usage = D3D11_USAGE_DEFAULT;
+            bd.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+            bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            bd.StructureByteStride = sizeof(uint32_t);
+            bd.ByteWidth = static_cast<UINT>(capacity * sizeof(uint32_t));
+            Microsoft::WRL::ComPtr<ID3D11Buffer> visibleBuffer;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> visibleSrv;
+            Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> visibleUav;
+            if (!create(device, bd, visibleBuffer, "可視リスト")) return false;
+            if (FAILED(device->CreateShaderResourceView(visibleBuffer.Get(), &srvd, visibleSrv.GetAddressOf()))) {
+                DEBUGLOG_ERROR("[GpuCulling] 可視リストのSRV作成失敗");
+                return false;
+            }
+            D3D11_UNORDERED_ACCESS_VIEW_DESC uavd{};
+            uavd.Format = DXGI_FORMAT_UNKNOWN;
+            uavd.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+            uavd.Buffer.NumElements = static_cast<UINT>(capacity);
+            if (FAILED(device->CreateUnorderedAccessView(visibleBuffer.Get(), &uavd, visibleUav.GetAddressOf()))) {
+                DEBUGLOG_ERROR("[GpuCulling] 可視リストのUAV作成失敗");
+                return false;
+            }
+
+            instanceBuffer_ = instanceBuffer;
+            instanceSrv_ = instanceSrv;
+            visibleBuffer_ = visibleBuffer;
+            visibleSrv_ = visibleSrv;
+            visibleUav_ = visibleUav;
+            instanceCapacity_ = capacity;
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[GpuCulling] インスタンス容量: " + std::to_string(capacity));
+        }
+
+        if (batches > batchCapacity_ || !argsBuffer_) {
+            size_t capacity = (std::max)(batchCapacity_ * 2, MIN_BATCH_CAPACITY);
+            while (capacity < batches) capacity *= 2;
+
+            D3D11_BUFFER_DESC bd{};
+            bd.Usage = D3D11_USAGE_DEFAULT;
+            bd.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+            bd.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS | D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+            bd.ByteWidth = static_cast<UINT>(capacity * ARGS_STRIDE);
+            Microsoft::WRL::ComPtr<ID3D11Buffer> argsBuffer;
+            Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> argsUav;
+            if (!create(device, bd, argsBuffer, "間接引数バッファ")) return false;
+            D3D11_UNORDERED_ACCESS_VIEW_DESC uavd{};
+            uavd.Format = DXGI_FORMAT_R32_TYPELESS;
+            uavd.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+            uavd.Buffer.NumElements = static_cast<UINT>(capacity * 5);
+            uavd.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+            if (FAILED(device->CreateUnorderedAccessView(argsBuffer.Get(), &uavd, argsUav.GetAddressOf()))) {
+                DEBUGLOG_ERROR("[GpuCulling] 間接引数のUAV作成失敗");
+                return false;
+            }
+            argsBuffer_ = argsBuffer;
+            argsUav_ = argsUav;
+            batchCapacity_ = capacity;
+        }
+        return true;
+    }
+
+    static bool create(ID3D11Device* device, const D3D11_BUFFER_DESC& bd, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, const char* name) {
+        HRESULT hr = device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR(std::string("[GpuCulling] ") + name + "の作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> cs_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> constants_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> instanceSrv_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> argsBuffer_;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> argsUav_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> visibleBuffer_;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> visibleUav_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> visibleSrv_;
+    size_t instanceCapacity_ = 0;            ///< instanceBuffer_ と visibleBuffer_ の要素数
+    size_t batchCapacity_ = 0;               ///< argsBuffer_ のバッチ数
+    std::vector<CullInstance> instances_;    ///< このフレームのインスタンス
+    std::vector<uint32_t> args_;             ///< このフレームの引数の初期値(バッチごとに5個)
+};
@@ -0,0 +1,808 @@
+/**
+ * @file GpuMovers.h
+ * @brief GpuMover の状態を構造化バッファに置き、コンピュートシェーダーで積分してそのまま描画する
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * シミュレーション側(GpuMoverSystem)と描画側(RenderSystem)は GpuMoverChannel だけでやり取りします。
+ * - シミュレーション側: 生成(初期状態)・解放・固定ステップの経過・書き戻しの要求を積む
+ * - 描画側: フレームの始めにまとめて受け取り、生成をバッファに書き込んでから経過したステップ数だけ積分する
+ *
+ * 生成以外でCPUからGPUへ送るものはなく、1体あたりのCPUの処理はありません。
+ * 描画はメッシュの種類ごとに DrawIndexedInstanced を1回ずつ行い、頂点シェーダーが
+ * 構造化バッファからワールド変換を組み立てます(インスタンスの表はエンティティの増減があった時だけ作り直す)。
+ *
+ * 書き戻しは要求されたスロットだけを CopySubresourceRegion で読み出し用のバッファへ写し、
+ * GpuProfiler と同じく LATENCY フレームのリングで、GPU を待たずに読めたものから結果を返します。
+ *
+ * 並列シミュレーション(RenderSnapshot)の場合もチャネルはスナップショットを経由しないため、
+ * GpuMover のエンティティはコピーされません。
+ */
+#pragma once
+#include "graphics/Camera.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/GpuProfiler.h"
+#include "graphics/PipelineState.h"
+#include "graphics/RenderProxy.h"
+#include "components/MeshRenderer.h"
+#include "ecs/Entity.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @struct GpuMoverState
+ * @brief 構造化バッファ上の1体分の状態(HLSL の Mover と同じレイアウト)
+ *
+ * @details
+ * 回転は rotation(生成時の向き)の後にY軸回りに angle だけ回したもので、
+ * Transform のオイラー角 (x, y, z) は rotation = (x, 0, z)・angle = y に分けて持ちます。
+ */
+struct GpuMoverState {
+    DirectX::XMFLOAT3 position;      ///< ワールド空間の位置
+    float angle;                     ///< Y軸回りの角度(ラジアン)
+    DirectX::XMFLOAT3 velocity;      ///< 速度
+    float rotationSpeed;             ///< Y軸の回転速度(ラジアン/秒)
+    DirectX::XMFLOAT3 acceleration;  ///< 加速度
+    float drag;                      ///< 空気抵抗(1/秒)
+    DirectX::XMFLOAT4 rotation;      ///< Y軸回転の前に掛ける回転(クォータニオン)
+    DirectX::XMFLOAT3 scale;         ///< 拡大率
+    uint32_t color;                  ///< RGBA8
+    float bounceExtent;              ///< XZ をこの範囲で反射(0 で反射しない)
+    float padding[3];
+};
+static_assert(sizeof(GpuMoverState) == 96, "GpuMoverState must match the HLSL layout");
+
+/**
+ * @struct GpuMoverReadback
+ * @brief 書き戻しの要求(エンティティとスロット)
+ */
+struct GpuMoverReadback {
+    Entity entity;
+    uint32_t slot;
+};
+
+/**
+ * @struct GpuMoverResult
+ * @brief 書き戻しの結果(読み出した時点の状態)
+ */
+struct GpuMoverResult {
+    Entity entity;
+    GpuMoverState state;
+};
+
+/**
+ * @class GpuMoverChannel
+ * @brief シミュレーションと描画の間の受け渡し(どちらのスレッドから呼んでもよい)
+ */
+class GpuMoverChannel {
+public:
+    static constexpr uint32_t NO_MESH = 0xFFFFFFFFu;
+
+    /**
+     * @struct Op
+     * @brief スロットの生成(meshType が NO_MESH 以外)または解放(積んだ順に反映する)
+     */
+    struct Op {
+        uint32_t slot;
+        uint32_t meshType;
+        GpuMoverState state;
+    };
+
+    /**
+     * @struct Batch
+     * @brief 描画側が1回に受け取る分
+     */
+    struct Batch {
+        std::vector<Op> ops;
+        std::vector<GpuMoverReadback> readbacks;  ///< 最新の書き戻しの要求
+        uint32_t steps = 0;                       ///< 経過した固定ステップ数
+        float time = 0.0f;                        ///< 経過時間の合計(秒)
+        bool readbacksChanged = false;
+
+        void Clear() {
+            ops.clear();
+            steps = 0;
+            time = 0.0f;
+            readbacksChanged = false;
+        }
+    };
+
+    void Spawn(uint32_t slot, MeshType meshType, const GpuMoverState& state) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.ops.push_back(Op{ slot, static_cast<uint32_t>(meshType), state });
+    }
+
+    void Free(uint32_t slot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.ops.push_back(Op{ slot, NO_MESH, GpuMoverState{} });
+    }
+
+    /**
+     * @brief 固定ステップを1回進めたことを伝える
+     */
+    void Step(float dt) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++pending_.steps;
+        pending_.time += dt;
+    }
+
+    /**
+     * @brief 書き戻す対象を置き換える(次に変えるまで毎フレーム読み出す)
+     */
+    void SetReadbacks(const std::vector<GpuMoverReadback>& readbacks) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.readbacks = readbacks;
+        pending_.readbacksChanged = true;
+    }
+
+    /**
+     * @brief 書き戻しの結果を受け取る(シミュレーション側、前回から届いた分)
+     */
+    void TakeResults(std::vector<GpuMoverResult>& out) {
+        out.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.swap(results_);
+    }
+
+    /**
+     * @brief 積まれた分をまとめて受け取る(描画側、batch の前の内容は捨てる)
+     */
+    void Take(Batch& batch) {
+        batch.Clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(batch.ops, pending_.ops);
+        batch.steps = pending_.steps;
+        batch.time = pending_.time;
+        if (pending_.readbacksChanged) {
+            batch.readbacks = pending_.readbacks;
+            batch.readbacksChanged = true;
+        }
+        pending_.Clear();
+    }
+
+    /**
+     * @brief 描画側が受け取っていない生成・解放・ステップがあるか
+     */
+    bool HasPending() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !pending_.ops.empty() || pending_.steps > 0 || pending_.readbacksChanged;
+    }
+
+    /**
+     * @brief 書き戻しの結果を渡す(描画側。同じエンティティは新しい方で上書きされる)
+     */
+    void Publish(const std::vector<GpuMoverResult>& results) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.insert(results_.end(), results.begin(), results.end());
+    }
+
+private:
+    std::mutex mutex_;
+    Batch pending_;
+    std::vector<GpuMoverResult> results_;
+};
+
+/**
+ * @class GpuMovers
+ * @brief GpuMover の構造化バッファ・積分・インスタンス描画・書き戻し
+ *
+ * @par 使用例
+ * @code
+ * GpuMovers movers;
+ * movers.Init(device, compileFlags);
+ *
+ * // 毎フレーム(不透明な描画の後)
+ * movers.Update(device, ctx);
+ * movers.Draw(states, cam, meshes, lightCb);
+ * @endcode
+ */
+class GpuMovers {
+public:
+    static constexpr uint32_t GROUP_SIZE = 256;             ///< 積分のスレッドグループの大きさ
+    static constexpr uint32_t MIN_CAPACITY = 4096;          ///< 最初に確保するスロット数
+    static constexpr uint32_t MAX_STEPS = 8;                ///< 1フレームで積分する最大のステップ数(停止からの復帰で一度に進めない)
+    static constexpr uint32_t MAX_READBACKS = 256;          ///< 1フレームに書き戻せる数
+    static constexpr uint32_t MESH_TYPE_COUNT = static_cast<uint32_t>(MeshType::Capsule) + 1;
+
+    /**
+     * @struct Statistics
+     * @brief 直近の Update() / Draw() の結果
+     */
+    struct Statistics {
+        size_t movers = 0;       ///< GPUにある数
+        size_t spawned = 0;      ///< このフレームに書き込んだ数
+        size_t uploads = 0;      ///< 書き込みの UpdateSubresource の回数(連続したスロットはまとめる)
+        uint32_t steps = 0;      ///< 積分したステップ数
+        size_t draws = 0;        ///< ドローコール数
+        size_t readbacks = 0;    ///< 読み出しを要求した数
+    };
+
+    GpuMovers() = default;
+    GpuMovers(const GpuMovers&) = delete;
+    GpuMovers& operator=(const GpuMovers&) = delete;
+
+    /**
+     * @brief シェーダーとステートを作成(バッファは最初の生成時に作る)
+     * @return bool 失敗した場合 false(コンピュートシェーダー非対応など)
+     */
+    bool Init(ID3D11Device* device, UINT compileFlags) {
+        Shutdown();
+        if (device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+            DEBUGLOG_WARNING("[GpuMovers] 機能レベル 11_0 未満のためコンピュートシェーダーを使えません");
+            return false;
+        }
+        if (!compileShaders(device, compileFlags) || !createConstant(device, sizeof(IntegrateConstants), integrateCb_) ||
+            !createConstant(device, sizeof(DrawConstants), drawCb_) || !createConstant(device, sizeof(BatchConstants), batchCb_)) {
+            Shutdown();
+            return false;
+        }
+        PipelineStateDesc desc;
+        desc.vertexShader = vs_.Get();
+        desc.pixelShader = ps_.Get();
+        desc.inputLayout = layout_.Get();
+        pipeline_ = PipelineState(desc);
+        ready_ = true;
+        return true;
+    }
+
+    bool IsReady() const { return ready_; }
+
+    GpuMoverChannel& Channel() { return channel_; }
+
+    /**
+     * @brief チャネルに積まれた生成・解放を反映し、経過したステップ数だけ積分する
+     */
+    void Update(ID3D11Device* device, ID3D11DeviceContext* ctx) {
+        channel_.Take(batch_);
+        stats_ = Statistics{};
+        if (!ready_) return;
+
+        applyOps(device, ctx);
+        if (batch_.readbacksChanged) readbacks_.swap(batch_.readbacks);
+        stats_.movers = liveCount_;
+        if (!buffer_ || liveCount_ == 0) return;
+
+        const uint32_t steps = (std::min)(batch_.steps, MAX_STEPS);
+        if (steps > 0) {
+            IntegrateConstants constants{};
+            constants.moverCount = highWater_;
+            constants.stepCount = steps;
+            constants.deltaTime = batch_.time / static_cast<float>(batch_.steps);
+            ctx->UpdateSubresource(integrateCb_.Get(), 0, nullptr, &constants, 0, 0);
+
+            ctx->CSSetShader(integrateCs_.Get(), nullptr, 0);
+            ctx->CSSetConstantBuffers(0, 1, integrateCb_.GetAddressOf());
+            ctx->CSSetUnorderedAccessViews(0, 1, uav_.GetAddressOf(), nullptr);
+            ctx->Dispatch((highWater_ + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+            ID3D11UnorderedAccessView* nullUav = nullptr;
+            ctx->CSSetUnorderedAccessViews(0, 1, &nullUav, nullptr);
+            ctx->CSSetShader(nullptr, nullptr, 0);
+            stats_.steps = steps;
+        }
+
+        readBack(device, ctx);
+    }
+
+    /**
+     * @brief メッシュの種類ごとにインスタンス描画(不透明・深度は書く)
+     * @param[in] meshes MeshType ごとのメッシュ(標準の頂点形式。vertexBuffer が nullptr の種類は描かない)
+     * @param[in] lightCb ピクセルシェーダーの b1 に渡すディレクショナルライトの定数
+     *
+     * @details
+     * ステートは states を通して設定し、元には戻しません。
+     */
+    void Draw(StateCache& states, const Camera& cam, const RenderProxyMesh (&meshes)[MESH_TYPE_COUNT], ID3D11Buffer* lightCb) {
+        if (!ready_ || !buffer_ || liveCount_ == 0) return;
+        ID3D11DeviceContext* ctx = states.Context();
+        if (instancesDirty_ && !uploadInstances(ctx)) return;
+
+        DrawConstants constants{};
+        DirectX::XMStoreFloat4x4(&constants.viewProj, DirectX::XMMatrixTranspose(cam.ViewProj));
+        ctx->UpdateSubresource(drawCb_.Get(), 0, nullptr, &constants, 0, 0);
+
+        states.Apply(pipeline_);
+        states.SetVSConstantBuffer(0, drawCb_.Get());
+        states.SetVSConstantBuffer(1, batchCb_.Get());
+        states.SetPSConstantBuffer(1, lightCb);
+        ID3D11ShaderResourceView* srvs[2] = { srv_.Get(), instanceSrv_.Get() };
+        ctx->VSSetShaderResources(0, 2, srvs);
+
+        for (uint32_t type = 0; type < MESH_TYPE_COUNT; ++type) {
+            const RenderProxyMesh& mesh = meshes[type];
+            if (ranges_[type].count == 0 || !mesh.vertexBuffer || mesh.vertexFormat != VertexFormat::Standard) continue;
+            BatchConstants batch{};
+            batch.firstInstance = ranges_[type].first;
+            ctx->UpdateSubresource(batchCb_.Get(), 0, nullptr, &batch, 0, 0);
+
+            const UINT stride = VERTEX_STRIDE;
+            const UINT offset = 0;
+            ctx->IASetVertexBuffers(0, 1, &mesh.vertexBuffer, &stride, &offset);
+            ctx->IASetIndexBuffer(mesh.indexBuffer, mesh.indexFormat, 0);
+            ctx->DrawIndexedInstanced(mesh.indexCount, ranges_[type].count, mesh.startIndex, mesh.baseVertex, 0);
+            ++stats_.draws;
+        }
+
+        // 次のフレームで UAV としてバインドできるように外す
+        ID3D11ShaderResourceView* nullSrvs[2] = {};
+        ctx->VSSetShaderResources(0, 2, nullSrvs);
+    }
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+    size_t Count() const { return liveCount_; }
+
+    size_t GpuMemoryBytes() const {
+        return static_cast<size_t>(capacity_) * sizeof(GpuMoverState) + static_cast<size_t>(instanceCapacity_) * sizeof(uint32_t) +
+               (readbackRing_[0].buffer ? GpuProfiler::LATENCY * MAX_READBACKS * sizeof(GpuMoverState) : 0);
+    }
+
+    void Shutdown() {
+        ready_ = false;
+        integrateCs_.Reset();
+        vs_.Reset();
+        ps_.Reset();
+        layout_.Reset();
+        integrateCb_.Reset();
+        drawCb_.Reset();
+        batchCb_.Reset();
+        pipeline_ = PipelineState();
+        buffer_.Reset();
+        uav_.Reset();
+        srv_.Reset();
+        capacity_ = 0;
+        instances_.Reset();
+        instanceSrv_.Reset();
+        instanceCapacity_ = 0;
+        for (ReadbackFrame& frame : readbackRing_) frame = ReadbackFrame{};
+        readbackNext_ = 0;
+        alive_.clear();
+        meshTypes_.clear();
+        readbacks_.clear();
+        liveCount_ = 0;
+        highWater_ = 0;
+        instancesDirty_ = true;
+    }
+
+private:
+    static constexpr UINT VERTEX_STRIDE = 56;               ///< RenderSystem::Vertex(位置・UV・法線・接線・従法線)
+    static constexpr UINT NORMAL_OFFSET = 20;               ///< 頂点の法線の位置
+
+    struct IntegrateConstants {
+        uint32_t moverCount;
+        uint32_t stepCount;
+        float deltaTime;
+        float padding;
+    };
+
+    struct DrawConstants {
+        DirectX::XMFLOAT4X4 viewProj;
+    };
+
+    struct BatchConstants {
+        uint32_t firstInstance;
+        uint32_t padding[3];
+    };
+
+    struct InstanceRange {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    struct ReadbackFrame {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;   ///< STAGING(MAX_READBACKS 体分)
+        std::vector<Entity> entities;                  ///< 写したエンティティ(buffer の並び順)
+        bool pending = false;
+    };
+
+    // 積まれた生成・解放を順に反映し、生成したスロットの状態を連続した範囲ごとに書き込む
+    void applyOps(ID3D11Device* device, ID3D11DeviceContext* ctx) {
+        if (batch_.ops.empty()) return;
+        uint32_t first = UINT32_MAX;
+        uint32_t last = 0;
+        for (const GpuMoverChannel::Op& op : batch_.ops) {
+            first = (std::min)(first, op.slot);
+            last = (std::max)(last, op.slot);
+        }
+        const uint32_t needed = (std::max)(highWater_, last + 1);
+        if (needed > capacity_ && !grow(device, ctx, needed)) return;
+        if (alive_.size() < needed) {
+            alive_.resize(needed, 0);
+            meshTypes_.resize(needed, 0);
+        }
+
+        // 後から積んだ操作が優先(同じスロットの生成と解放が続いた場合)
+        uploadIndex_.assign(last + 1 - first, UINT32_MAX);
+        for (uint32_t i = 0; i < batch_.ops.size(); ++i) {
+            const GpuMoverChannel::Op& op = batch_.ops[i];
+            const bool spawn = op.meshType != GpuMoverChannel::NO_MESH;
+            if (spawn != (alive_[op.slot] != 0)) {
+                if (spawn) ++liveCount_;
+                else --liveCount_;
+            }
+            alive_[op.slot] = spawn ? 1 : 0;
+            if (spawn) meshTypes_[op.slot] = static_cast<uint8_t>((std::min)(op.meshType, MESH_TYPE_COUNT - 1));
+            uploadIndex_[op.slot - first] = spawn ? i : UINT32_MAX;
+        }
+        instancesDirty_ = true;
+        highWater_ = needed;
+        while (highWater_ > 0 && !alive_[highWater_ - 1]) --highWater_;
+
+        for (uint32_t slot = first; slot <= last;) {
+            if (uploadIndex_[slot - first] == UINT32_MAX) {
+                ++slot;
+                continue;
+            }
+            uint32_t end = slot;
+            staging_.clear();
+            while (end <= last && uploadIndex_[end - first] != UINT32_MAX) {
+                staging_.push_back(batch_.ops[uploadIndex_[end - first]].state);
+                ++end;
+            }
+            D3D11_BOX box{ slot * static_cast<UINT>(sizeof(GpuMoverState)), 0, 0, end * static_cast<UINT>(sizeof(GpuMoverState)), 1, 1 };
+            ctx->UpdateSubresource(buffer_.Get(), 0, &box, staging_.data(), 0, 0);
+            stats_.spawned += end - slot;
+            ++stats_.uploads;
+            slot = end;
+        }
+    }
+
+    // 容量を倍にして作り直し、今までの状態を写す
+    bool grow(ID3D11Device* device, ID3D11DeviceContext* ctx, uint32_t needed) {
+        uint32_t capacity = (std::max)(capacity_, MIN_CAPACITY);
+        while (capacity < needed) capacity *= 2;
+
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav;
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bd.StructureByteStride = sizeof(GpuMoverState);
+        bd.ByteWidth = capacity * static_cast<UINT>(sizeof(GpuMoverState));
+        HRESULT hr = device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[GpuMovers] バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.Format = DXGI_FORMAT_UNKNOWN;
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvd.Buffer.NumElements = capacity;
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavd{};
+        uavd.Format = DXGI_FORMAT_UNKNOWN;
+        uavd.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavd.Buffer.NumElements = capacity;
+        if (FAILED(device->CreateShaderResourceView(buffer.Get(), &srvd, srv.GetAddressOf())) ||
+            FAILED(device->CreateUnorderedAccessView(buffer.Get(), &uavd, uav.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[GpuMovers] SRV・UAVの作成失敗");
+            return false;
+        }
+        if (buffer_ && highWater_ > 0) {
+            D3D11_BOX box{ 0, 0, 0, highWater_ * static_cast<UINT>(sizeof(GpuMoverState)), 1, 1 };
+            ctx->CopySubresourceRegion(buffer.Get(), 0, 0, 0, 0, buffer_.Get(), 0, &box);
+        }
+        buffer_ = buffer;
+        srv_ = srv;
+        uav_ = uav;
+        capacity_ = capacity;
+
+        char line[128];
+        sprintf_s(line, "[GpuMovers] バッファを %u 体分に拡張", capacity);
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, line);
+        return true;
+    }
+
+    // 生存しているスロットをメッシュの種類ごとに並べた表を書き込む
+    bool uploadInstances(ID3D11DeviceContext* ctx) {
+        instanceList_.clear();
+        for (uint32_t type = 0; type < MESH_TYPE_COUNT; ++type) {
+            ranges_[type].first = static_cast<uint32_t>(instanceList_.size());
+            for (uint32_t slot = 0; slot < highWater_; ++slot) {
+                if (alive_[slot] && meshTypes_[slot] == type) instanceList_.push_back(slot);
+            }
+            ranges_[type].count = static_cast<uint32_t>(instanceList_.size()) - ranges_[type].first;
+        }
+        if (instanceList_.empty()) return false;
+
+        if (instanceList_.size() > instanceCapacity_) {
+            Microsoft::WRL::ComPtr<ID3D11Device> device;
+            ctx->GetDevice(device.GetAddressOf());
+            uint32_t capacity = (std::max)(instanceCapacity_, MIN_CAPACITY);
+            while (capacity < instanceList_.size()) capacity *= 2;
+
+            D3D11_BUFFER_DESC bd{};
+            bd.Usage = D3D11_USAGE_DEFAULT;
+            bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            bd.StructureByteStride = sizeof(uint32_t);
+            bd.ByteWidth = capacity * static_cast<UINT>(sizeof(uint32_t));
+            Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+            srvd.Format = DXGI_FORMAT_UNKNOWN;
+            srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvd.Buffer.NumElements = capacity;
+            if (FAILED(device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf())) ||
+                FAILED(device->CreateShaderResourceView(buffer.Get(), &srvd, srv.GetAddressOf()))) {
+                DEBUGLOG_ERROR("[GpuMovers] インスタンスの表の作成失敗");
+                return false;
+            }
+            instances_ = buffer;
+            instanceSrv_ = srv;
+            instanceCapacity_ = capacity;
+        }
+        D3D11_BOX box{ 0, 0, 0, static_cast<UINT>(instanceList_.size() * sizeof(uint32_t)), 1, 1 };
+        ctx->UpdateSubresource(instances_.Get(), 0, &box, instanceList_.data(), 0, 0);
+        instancesDirty_ = false;
+        return true;
+    }
+
+    // 読み出し用のリングから届いた結果を返し、今回の要求分を写す
+    void readBack(ID3D11Device* device, ID3D11DeviceContext* ctx) {
+        // 古い順(次に書き込む位置から)に返す
+        for (uint32_t i = 0; i < GpuProfiler::LATENCY; ++i) {
+            ReadbackFrame& frame = readbackRing_[(readbackNext_ + i) % GpuProfiler::LATENCY];
+            if (!frame.pending) continue;
+            D3D11_MAPPED_SUBRESOURCE mapped{};
+            if (ctx->Map(frame.buffer.Get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped) != S_OK) continue;
+            results_.resize(frame.entities.size());
+            const GpuMoverState* states = static_cast<const GpuMoverState*>(mapped.pData);
+            for (size_t i = 0; i < frame.entities.size(); ++i) {
+                results_[i].entity = frame.entities[i];
+                results_[i].state = states[i];
+            }
+            ctx->Unmap(frame.buffer.Get(), 0);
+            frame.pending = false;
+            channel_.Publish(results_);
+        }
+
+        if (readbacks_.empty()) return;
+        ReadbackFrame& frame = readbackRing_[readbackNext_];
+        if (frame.pending) return;  // GPU が LATENCY フレーム以上遅れている: このフレームは読み出さない
+        if (!frame.buffer) {
+            D3D11_BUFFER_DESC bd{};
+            bd.Usage = D3D11_USAGE_STAGING;
+            bd.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            bd.ByteWidth = MAX_READBACKS * static_cast<UINT>(sizeof(GpuMoverState));
+            HRESULT hr = device->CreateBuffer(&bd, nullptr, frame.buffer.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[GpuMovers] 読み出し用バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                readbacks_.clear();
+                return;
+            }
+        }
+
+        frame.entities.clear();
+        for (const GpuMoverReadback& request : readbacks_) {
+            if (frame.entities.size() >= MAX_READBACKS) break;
+            if (request.slot >= highWater_ || !alive_[request.slot]) continue;
+            const UINT stride = static_cast<UINT>(sizeof(GpuMoverState));
+            D3D11_BOX box{ request.slot * stride, 0, 0, (request.slot + 1) * stride, 1, 1 };
+            ctx->CopySubresourceRegion(frame.buffer.Get(), 0, static_cast<UINT>(frame.entities.size()) * stride, 0, 0, buffer_.Get(), 0, &box);
+            frame.entities.push_back(request.entity);
+        }
+        if (frame.entities.empty()) return;
+        frame.pending = true;
+        readbackNext_ = (readbackNext_ + 1) % GpuProfiler::LATENCY;
+        stats_.readbacks = frame.entities.size();
+    }
+
+    bool compileShaders(ID3D11Device* device, UINT compileFlags) {
+        const char* COMMON = R"(
+            struct Mover {
+                float3 position;
+                float angle;
+                float3 velocity;
+                float rotationSpeed;
+                float3 acceleration;
+                float drag;
+                float4 rotation;
+                float3 scale;
+                uint color;
+                float bounceExtent;
+                float3 padding;
+            };
+        )";
+
+        // 移動は MovementSystem::Integrate と同じ半陰的オイラー法
+        const char* INTEGRATE = R"(
+            cbuffer IntegrateConstants : register(b0) {
+                uint gMoverCount;
+                uint gStepCount;
+                float gDeltaTime;
+                float gPadding;
+            };
+
+            RWStructuredBuffer<Mover> gMovers : register(u0);
+
+            [numthreads(256, 1, 1)]
+            void main(uint3 id : SV_DispatchThreadID) {
+                if (id.x >= gMoverCount) return;
+                Mover m = gMovers[id.x];
+                for (uint step = 0; step < gStepCount; ++step) {
+                    m.velocity += m.acceleration * gDeltaTime;
+                    if (m.drag > 0.0) m.velocity /= 1.0 + m.drag * gDeltaTime;
+                    m.position += m.velocity * gDeltaTime;
+                    if (m.bounceExtent > 0.0) {
+                        if ((m.position.x > m.bounceExtent && m.velocity.x > 0.0) || (m.position.x < -m.bounceExtent && m.velocity.x < 0.0)) m.velocity.x = -m.velocity.x;
+                        if ((m.position.z > m.bounceExtent && m.velocity.z > 0.0) || (m.position.z < -m.bounceExtent && m.velocity.z < 0.0)) m.velocity.z = -m.velocity.z;
+                    }
+                }
+                gMovers[id.x].position = m.position;
+                gMovers[id.x].velocity = m.velocity;
+                gMovers[id.x].angle = fmod(m.angle + m.rotationSpeed * gDeltaTime * gStepCount, 6.28318531);
+            }
+        )";
+
+        const char* VS = R"(
+            cbuffer DrawConstants : register(b0) {
+                float4x4 gViewProj;
+            };
+
+            cbuffer BatchConstants : register(b1) {
+                uint gFirstInstance;
+                uint3 gBatchPadding;
+            };
+
+            StructuredBuffer<Mover> gMovers : register(t0);
+            StructuredBuffer<uint> gInstances : register(t1);
+
+            struct VSIn {
+                float3 pos : POSITION;
+                float3 nrm : NORMAL;
+            };
+
+            struct VSOut {
+                float4 pos : SV_POSITION;
+                float3 nrm : NORMAL;
+                float4 color : COLOR;
+            };
+
+            float3 Rotate(float4 q, float3 v) {
+                float3 t = 2.0 * cross(q.xyz, v);
+                return v + q.w * t + cross(q.xyz, t);
+            }
+
+            // XMMatrixRotationY と同じ向き(行ベクトル)
+            float3 RotateY(float s, float c, float3 v) {
+                return float3(v.x * c + v.z * s, v.y, v.z * c - v.x * s);
+            }
+
+            VSOut main(VSIn v, uint instanceId : SV_InstanceID) {
+                Mover m = gMovers[gInstances[gFirstInstance + instanceId]];
+                float s, c;
+                sincos(m.angle, s, c);
+                float3 worldPos = RotateY(s, c, Rotate(m.rotation, v.pos * m.scale)) + m.position;
+
+                VSOut o;
+                o.pos = mul(float4(worldPos, 1.0), gViewProj);
+                o.nrm = RotateY(s, c, Rotate(m.rotation, v.nrm / m.scale));
+                o.color = float4(m.color & 255, (m.color >> 8) & 255, (m.color >> 16) & 255, m.color >> 24) / 255.0;
+                return o;
+            }
+        )";
+
+        // ライトの定数は RenderSystem の PSLightConstants(PS の b1)をそのまま使う
+        const char* PS = R"(
+            struct DirectionalLight {
+                float3 direction;
+                float padding;
+                float4 color;
+            };
+
+            cbuffer LightConstants : register(b1) {
+                DirectionalLight gLight;
+                float3 gAmbientColor;
+                float gLightPadding;
+            };
+
+            struct VSOut {
+                float4 pos : SV_POSITION;
+                float3 nrm : NORMAL;
+                float4 color : COLOR;
+            };
+
+            float4 main(VSOut i) : SV_TARGET {
+                float lightFactor = max(0.0, dot(normalize(i.nrm), -gLight.direction));
+                return float4(i.color.rgb * (gLight.color.rgb * lightFactor + gAmbientColor), i.color.a);
+            }
+        )";
+
+        Microsoft::WRL::ComPtr<ID3DBlob> blob;
+        if (!compile(std::string(COMMON) + INTEGRATE, "cs_5_0", compileFlags, "積分", blob) ||
+            FAILED(device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, integrateCs_.GetAddressOf()))) return false;
+        if (!compile(std::string(COMMON) + VS, "vs_5_0", compileFlags, "描画", blob) ||
+            FAILED(device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, vs_.GetAddressOf()))) return false;
+
+        const D3D11_INPUT_ELEMENT_DESC il[] = {
+            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, NORMAL_OFFSET, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        };
+        HRESULT hr = device->CreateInputLayout(il, 2, blob->GetBufferPointer(), blob->GetBufferSize(), layout_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[GpuMovers] 入力レイアウトの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        if (!compile(PS, "ps_5_0", compileFlags, "描画", blob) ||
+            FAILED(device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, ps_.GetAddressOf()))) return false;
+        return true;
+    }
+
+    static bool compile(const std::string& source, const char* target, UINT compileFlags, const char* pass, Microsoft::WRL::ComPtr<ID3DBlob>& blob) {
+        Microsoft::WRL::ComPtr<ID3DBlob> err;
+        HRESULT hr = ShaderCache::Compile(source.c_str(), nullptr, "main", target, compileFlags, blob, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING(std::string("[GpuMovers] ") + pass + "シェーダー(" + target + ")のコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        return true;
+    }
+
+    static bool createConstant(ID3D11Device* device, UINT size, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer) {
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = (size + 15u) & ~15u;
+        HRESULT hr = device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[GpuMovers] 定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
+    }
+
+    // シェーダー・ステート
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> integrateCs_;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layout_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> integrateCb_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> drawCb_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> batchCb_;
+    PipelineState pipeline_;   ///< 位置と法線だけを読むインスタンス描画(既定の深度・ラスタライザー)
+
+    // 状態のバッファ(スロット番号で引く)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> buffer_;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv_;
+    uint32_t capacity_ = 0;                       ///< buffer_ のスロット数
+    std::vector<uint8_t> alive_;                  ///< スロットが使われているか
+    std::vector<uint8_t> meshTypes_;              ///< スロットの MeshType
+    size_t liveCount_ = 0;
+    uint32_t highWater_ = 0;                      ///< 使われている最後のスロット + 1(積分する範囲)
+
+    // インスタンスの表(メッシュの種類ごとに連続したスロット番号)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> instances_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> instanceSrv_;
+    uint32_t instanceCapacity_ = 0;
+    std::vector<uint32_t> instanceList_;
+    InstanceRange ranges_[MESH_TYPE_COUNT];
+    bool instancesDirty_ = true;
+
+    // 書き戻し
+    ReadbackFrame readbackRing_[GpuProfiler::LATENCY];
+    uint32_t readbackNext_ = 0;
+    std::vector<GpuMoverReadback> readbacks_;     ///< 現在の要求
+    std::vector<GpuMoverResult> results_;
+
+    GpuMoverChannel channel_;
+    GpuMoverChannel::Batch batch_;                ///< 今回受け取った分(容量を使い回す)
+    std::vector<uint32_t> uploadIndex_;           ///< スロット(今回の操作の最小からの差) -> 書き込む batch_.ops の番号
+    std::vector<GpuMoverState> staging_;          ///< 連続した範囲の書き込み
+    Statistics stats_;
+    bool ready_ = false;
+};
@@ -0,0 +1,255 @@
+/**
+ * @file GpuProfiler.h
+ * @brief タイムスタンプクエリによるGPU時間の計測
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * D3D11_QUERY_TIMESTAMP_DISJOINT でフレームを囲み、その中の名前付きスコープの前後に
+ * D3D11_QUERY_TIMESTAMP を置いて描画パスごとのGPU時間を求めます。
+ * クエリはフレーム単位で LATENCY 組を使い回し、D3D11_ASYNC_GETDATA_DONOTFLUSH で
+ * 結果が揃ったフレームだけを読み取るため、CPUがGPUを待つことはありません(結果は数フレーム遅れます)。
+ */
+#pragma once
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "app/DebugLog.h"
+
+/**
+ * @class GpuProfiler
+ * @brief 名前付きスコープのGPU時間(GfxDevice が所有し、BeginFrame/EndFrame で区切る)
+ *
+ * @par 使用例
+ * @code
+ * // GfxDevice::BeginFrame() / EndFrame() がフレームを区切る
+ * {
+ *     GpuProfileScope scope(gfx.Profiler(), gfx.Ctx(), "DebugDraw");
+ *     // 描画...
+ * }
+ * float ms = gfx.Profiler().ScopeMs("DebugDraw");
+ * @endcode
+ */
+class GpuProfiler {
+public:
+    static constexpr uint32_t LATENCY = 3;     ///< 結果待ちにできるフレーム数
+    static constexpr uint32_t MAX_SCOPES = 16; ///< 1フレームのスコープ数の上限
+
+    static constexpr uint32_t INVALID_SCOPE = 0xFFFFFFFFu; ///< BeginScope() が計測しなかった場合の戻り値
+
+    /**
+     * @struct Result
+     * @brief 1スコープの計測結果
+     */
+    struct Result {
+        const char* name = nullptr; ///< スコープ名(BeginScope() に渡した文字列)
+        float ms = 0.0f;            ///< GPU時間(ミリ秒)
+    };
+
+    /**
+     * @brief クエリの作成
+     * @return bool 作成できた場合 true(失敗時は以降の呼び出しが何もしない)
+     */
+    bool Init(ID3D11Device* dev) {
+        Shutdown();
+        D3D11_QUERY_DESC disjointDesc{};
+        disjointDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+        D3D11_QUERY_DESC timestampDesc{};
+        timestampDesc.Query = D3D11_QUERY_TIMESTAMP;
+
+        for (Frame& frame : frames_) {
+            bool ok = SUCCEEDED(dev->CreateQuery(&disjointDesc, frame.disjoint.GetAddressOf())) &&
+                      SUCCEEDED(dev->CreateQuery(&timestampDesc, frame.begin.GetAddressOf())) &&
+                      SUCCEEDED(dev->CreateQuery(&timestampDesc, frame.end.GetAddressOf()));
+            for (uint32_t i = 0; ok && i < MAX_SCOPES; ++i) {
+                ok = SUCCEEDED(dev->CreateQuery(&timestampDesc, frame.scopes[i].begin.GetAddressOf())) &&
+                     SUCCEEDED(dev->CreateQuery(&timestampDesc, frame.scopes[i].end.GetAddressOf()));
+            }
+            if (!ok) {
+                DEBUGLOG_WARNING("[GpuProfiler] タイムスタンプクエリの作成失敗、GPU計測を無効化します");
+                Shutdown();
+                return false;
+            }
+        }
+        valid_ = true;
+        return true;
+    }
+
+    void Shutdown() {
+        for (Frame& frame : frames_) {
+            frame = Frame();
+        }
+        current_ = 0;
+        frameActive_ = false;
+        valid_ = false;
+        results_.clear();
+        frameMs_ = 0.0f;
+    }
+
+    /**
+     * @brief 計測の有効・無効(既定は無効、無効の間はクエリを発行しない)
+     */
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+    bool IsEnabled() const { return enabled_ && valid_; }
+
+    /**
+     * @brief フレームの開始(完了したフレームの結果を回収してから計測を始める)
+     */
+    void BeginFrame(ID3D11DeviceContext* ctx) {
+        if (!IsEnabled()) return;
+        collect(ctx);
+
+        Frame& frame = frames_[current_];
+        if (frame.pending) return; // GPUが LATENCY フレーム以上遅れている: このフレームは計測しない
+        ctx->Begin(frame.disjoint.Get());
+        ctx->End(frame.begin.Get());
+        frame.scopeCount = 0;
+        frameActive_ = true;
+    }
+
+    /**
+     * @brief フレームの終了(Present の前に呼ぶ)
+     */
+    void EndFrame(ID3D11DeviceContext* ctx) {
+        if (!frameActive_) return;
+        Frame& frame = frames_[current_];
+        ctx->End(frame.end.Get());
+        ctx->End(frame.disjoint.Get());
+        frame.pending = true;
+        frameActive_ = false;
+        current_ = (current_ + 1) % LATENCY;
+    }
+
+    /**
+     * @brief スコープの開始
+     * @param[in] name スコープ名(結果を読むまで有効な文字列、通常は文字列リテラル)
+     * @return uint32_t EndScope() に渡す番号(計測しない場合は INVALID_SCOPE)
+     */
+    uint32_t BeginScope(ID3D11DeviceContext* ctx, const char* name) {
+        if (!frameActive_) return INVALID_SCOPE;
+        Frame& frame = frames_[current_];
+        if (frame.scopeCount >= MAX_SCOPES) return INVALID_SCOPE;
+        uint32_t index = frame.scopeCount++;
+        frame.scopes[index].name = name;
+        ctx->End(frame.scopes[index].begin.Get());
+        return index;
+    }
+
+    /**
+     * @brief スコープの終了
+     */
+    void EndScope(ID3D11DeviceContext* ctx, uint32_t index) {
+        if (!frameActive_ || index == INVALID_SCOPE) return;
+        ctx->End(frames_[current_].scopes[index].end.Get());
+    }
+
+    /**
+     * @brief 最後に回収できたフレームの全スコープ(BeginScope() の順)
+     */
+    const std::vector<Result>& Results() const { return results_; }
+
+    /**
+     * @brief 最後に回収できたフレームのスコープのGPU時間(同名は合計、なければ 0)
+     */
+    float ScopeMs(const char* name) const {
+        float ms = 0.0f;
+        for (const Result& r : results_) {
+            if (std::strcmp(r.name, name) == 0) ms += r.ms;
+        }
+        return ms;
+    }
+
+    /**
+     * @brief 最後に回収できたフレーム全体のGPU時間(BeginFrame から EndFrame まで)
+     */
+    float FrameMs() const { return frameMs_; }
+
+private:
+    struct Scope {
+        const char* name = nullptr;
+        Microsoft::WRL::ComPtr<ID3D11Query> begin;
+        Microsoft::WRL::ComPtr<ID3D11Query> end;
+    };
+
+    struct Frame {
+        Microsoft::WRL::ComPtr<ID3D11Query> disjoint;
+        Microsoft::WRL::ComPtr<ID3D11Query> begin;
+        Microsoft::WRL::ComPtr<ID3D11Query> end;
+        Scope scopes[MAX_SCOPES];
+        uint32_t scopeCount = 0;
+        bool pending = false;    ///< EndFrame() 済みで結果を未回収
+    };
+
+    // 古い順に、結果が揃ったフレームを回収する(揃っていないフレームで止める)
+    void collect(ID3D11DeviceContext* ctx) {
+        for (uint32_t n = 0; n < LATENCY; ++n) {
+            Frame& frame = frames_[(current_ + n) % LATENCY]; // current_ が最も古い
+            if (!frame.pending) continue;
+
+            D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint{};
+            if (ctx->GetData(frame.disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) return;
+            UINT64 begin = 0, end = 0;
+            if (!readTimestamp(ctx, frame.begin.Get(), begin) || !readTimestamp(ctx, frame.end.Get(), end)) return;
+
+            scratch_.clear();
+            bool ready = true;
+            for (uint32_t i = 0; ready && i < frame.scopeCount; ++i) {
+                UINT64 scopeBegin = 0, scopeEnd = 0;
+                ready = readTimestamp(ctx, frame.scopes[i].begin.Get(), scopeBegin) && readTimestamp(ctx, frame.scopes[i].end.Get(), scopeEnd);
+                Result r;
+                r.name = frame.scopes[i].name;
+                r.ms = toMs(scopeBegin, scopeEnd, disjoint.Frequency);
+                scratch_.push_back(r);
+            }
+            if (!ready) return;
+
+            frame.pending = false;
+            // クロックが変わったフレーム(省電力の切り替えなど)の値は使わない
+            if (!disjoint.Disjoint && disjoint.Frequency > 0) {
+                results_.swap(scratch_);
+                frameMs_ = toMs(begin, end, disjoint.Frequency);
+            }
+        }
+    }
+
+    static bool readTimestamp(ID3D11DeviceContext* ctx, ID3D11Query* query, UINT64& out) {
+        return ctx->GetData(query, &out, sizeof(out), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+    }
+
+    static float toMs(UINT64 begin, UINT64 end, UINT64 frequency) {
+        if (end < begin || frequency == 0) return 0.0f;
+        return static_cast<float>(static_cast<double>(end - begin) * 1000.0 / static_cast<double>(frequency));
+    }
+
+    Frame frames_[LATENCY];
+    uint32_t current_ = 0;       ///< 次に BeginFrame() するフレーム
+    bool frameActive_ = false;   ///< BeginFrame() 済みで EndFrame() 前
+    bool enabled_ = false;
+    bool valid_ = false;
+    std::vector<Result> results_; ///< 最後に回収できたフレームの結果
+    std::vector<Result> scratch_; ///< 回収中の結果(フレーム間で再利用)
+    float frameMs_ = 0.0f;
+};
+
+/**
+ * @class GpuProfileScope
+ * @brief スコープの間のGPU時間を計測する RAII ヘルパー
+ */
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler& profiler, ID3D11DeviceContext* ctx, const char* name)
+        : profiler_(profiler), ctx_(ctx), index_(profiler.BeginScope(ctx, name)) {}
+    ~GpuProfileScope() { profiler_.EndScope(ctx_, index_); }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler& profiler_;
+    ID3D11DeviceContext* ctx_;
+    uint32_t index_;
+};
@@ -0,0 +1,285 @@
+/**
+ * @file LightClusters.h
+ * @brief 点光源・スポットライトのクラスタ分割(クラスタードフォワード)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 視錐台を画面のタイル(DIM_X x DIM_Y)と指数分割した奥行き(DIM_Z)のクラスタに分け、
+ * 各ライトの影響範囲(球)が重なるクラスタにライト番号を登録します。
+ * ピクセルシェーダーは自分のクラスタのライトだけを計算するため、
+ * ピクセルあたりの負荷はシーン全体のライト数ではなく近くのライト数に比例します。
+ * 分割は毎フレームCPUで行い、結果を構造化バッファとしてピクセルシェーダーに渡します。
+ *
+ * ### シェーダーリソース(ピクセルシェーダー):
+ * - t3: StructuredBuffer<GpuLight>  ライト
+ * - t4: StructuredBuffer<uint2>     クラスタごとの (ライト番号の開始位置, 数)
+ * - t5: StructuredBuffer<uint>      ライト番号
+ */
+#pragma once
+#include "graphics/Camera.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+/**
+ * @struct GpuLight
+ * @brief シェーダーに渡すライト1つ(HLSL側と同じレイアウト、48バイト)
+ *
+ * @details
+ * 点光源は cosOuter = -2, cosInner = -1 として、スポットの減衰が常に1になるようにしています(分岐なし)。
+ */
+struct GpuLight {
+    DirectX::XMFLOAT3 position;   ///< ワールド空間の位置
+    float range;                  ///< 届く距離
+    DirectX::XMFLOAT3 color;      ///< 色 x 明るさ
+    float cosOuter;               ///< 外側の半角の cos
+    DirectX::XMFLOAT3 direction;  ///< ワールド空間の照射方向(正規化済み)
+    float cosInner;               ///< 内側の半角の cos
+};
+
+/**
+ * @class LightClusters
+ * @brief ライトのクラスタ分割とGPUバッファの管理
+ *
+ * @par 使用例
+ * @code
+ * clusters.Clear();
+ * clusters.AddPoint(position, range, color);
+ * clusters.Build(cam);
+ * clusters.Upload(device, ctx);
+ * ctx->PSSetShaderResources(LightClusters::FIRST_SLOT, LightClusters::SLOT_COUNT, clusters.ShaderResources());
+ * @endcode
+ */
+class LightClusters {
+public:
+    static constexpr uint32_t DIM_X = 16;  ///< 横のタイル数
+    static constexpr uint32_t DIM_Y = 9;   ///< 縦のタイル数
+    static constexpr uint32_t DIM_Z = 24;  ///< 奥行きの分割数
+    static constexpr uint32_t CLUSTER_COUNT = DIM_X * DIM_Y * DIM_Z;
+    static constexpr UINT FIRST_SLOT = 3;  ///< ピクセルシェーダーの最初のレジスタ(t3)
+    static constexpr UINT SLOT_COUNT = 3;  ///< 使用するレジスタ数
+
+    void Clear() { lights_.clear(); }
+
+    /**
+     * @brief 点光源を追加
+     */
+    void AddPoint(const DirectX::XMFLOAT3& position, float range, const DirectX::XMFLOAT3& color) {
+        if (range <= 0.0f) return;
+        lights_.push_back(GpuLight{ position, range, color, -2.0f, DirectX::XMFLOAT3{ 0.0f, 0.0f, 1.0f }, -1.0f });
+    }
+
+    /**
+     * @brief スポットライトを追加
+     * @param[in] direction ワールド空間の照射方向(正規化済み)
+     * @param[in] innerAngle 減衰が始まる半角(度)
+     * @param[in] outerAngle 0になる半角(度)
+     */
+    void AddSpot(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& direction, float range, const DirectX::XMFLOAT3& color,
+                 float innerAngle, float outerAngle) {
+        if (range <= 0.0f) return;
+        float cosOuter = std::cos(DirectX::XMConvertToRadians(outerAngle));
+        float cosInner = std::cos(DirectX::XMConvertToRadians((std::min)(innerAngle, outerAngle)));
+        if (cosInner <= cosOuter) cosInner = cosOuter + 1e-4f; // smoothstep の幅を0にしない
+        lights_.push_back(GpuLight{ position, range, color, cosOuter, direction, cosInner });
+    }
+
+    /**
+     * @brief ライトをクラスタに振り分ける
+     *
+     * @details
+     * ビュー空間での影響範囲の箱を投影し、重なるタイルと奥行きの範囲を求めます(保守的に広め)。
+     * 1パス目で数を数えて開始位置を決め、2パス目で番号を書き込みます。
+     */
+    void Build(const Camera& cam) {
+        counts_.assign(CLUSTER_COUNT, 0);
+        ranges_.resize(lights_.size());
+        const float nearZ = cam.nearZ;
+        const float farZ = cam.farZ;
+        const float logScale = static_cast<float>(DIM_Z) / std::log(farZ / nearZ);
+
+        for (size_t i = 0; i < lights_.size(); ++i) {
+            ClusterRange& r = ranges_[i];
+            r = ClusterRange();
+            const GpuLight& light = lights_[i];
+
+            DirectX::XMFLOAT3 v;
+            DirectX::XMStoreFloat3(&v, DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&light.position), cam.View));
+            float zMin = (std::max)(v.z - light.range, nearZ);
+            float zMax = (std::min)(v.z + light.range, farZ);
+            if (zMin > zMax) continue; // 視錐台の手前か奥
+
+            // 影響範囲の箱の角を投影してNDCの範囲を求める(z>0の箱では x/z, y/z の極値は角にある)
+            float ndcMinX = 1.0f, ndcMaxX = -1.0f, ndcMinY = 1.0f, ndcMaxY = -1.0f;
+            for (int c = 0; c < 8; ++c) {
+                DirectX::XMVECTOR corner = DirectX::XMVectorSet(
+                    v.x + ((c & 1) ? light.range : -light.range),
+                    v.y + ((c & 2) ? light.range : -light.range),
+                    (c & 4) ? zMax : zMin, 1.0f);
+                DirectX::XMFLOAT3 ndc;
+                DirectX::XMStoreFloat3(&ndc, DirectX::XMVector3TransformCoord(corner, cam.Proj));
+                ndcMinX = (std::min)(ndcMinX, ndc.x);
+                ndcMaxX = (std::max)(ndcMaxX, ndc.x);
+                ndcMinY = (std::min)(ndcMinY, ndc.y);
+                ndcMaxY = (std::max)(ndcMaxY, ndc.y);
+            }
+            if (ndcMinX > 1.0f || ndcMaxX < -1.0f || ndcMinY > 1.0f || ndcMaxY < -1.0f) continue; // 画面外
+
+            // タイルはピクセル座標と同じく左上から(NDCのYは上が正)
+            r.x0 = tile(ndcMinX * 0.5f + 0.5f, DIM_X);
+            r.x1 = tile(ndcMaxX * 0.5f + 0.5f, DIM_X);
+            r.y0 = tile(0.5f - ndcMaxY * 0.5f, DIM_Y);
+            r.y1 = tile(0.5f - ndcMinY * 0.5f, DIM_Y);
+            r.z0 = slice(zMin, nearZ, logScale);
+            r.z1 = slice(zMax, nearZ, logScale);
+            r.valid = true;
+
+            for (uint32_t z = r.z0; z <= r.z1; ++z)
+                for (uint32_t y = r.y0; y <= r.y1; ++y)
+                    for (uint32_t x = r.x0; x <= r.x1; ++x)
+                        counts_[index(x, y, z)]++;
+        }
+
+        // 開始位置(出現順を保つため counts_ は書き込み位置として使い回す)
+        clusters_.resize(CLUSTER_COUNT);
+        uint32_t offset = 0;
+        for (uint32_t c = 0; c < CLUSTER_COUNT; ++c) {
+            clusters_[c][0] = offset;
+            clusters_[c][1] = counts_[c];
+            offset += counts_[c];
+            counts_[c] = clusters_[c][0];
+        }
+
+        indices_.resize(offset);
+        for (size_t i = 0; i < lights_.size(); ++i) {
+            const ClusterRange& r = ranges_[i];
+            if (!r.valid) continue;
+            for (uint32_t z = r.z0; z <= r.z1; ++z)
+                for (uint32_t y = r.y0; y <= r.y1; ++y)
+                    for (uint32_t x = r.x0; x <= r.x1; ++x)
+                        indices_[counts_[index(x, y, z)]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    /**
+     * @brief 振り分けた結果をGPUバッファに書き込む(容量が足りなければ作り直す)
+     */
+    bool Upload(ID3D11Device* device, ID3D11DeviceContext* ctx) {
+        // ライトがないフレームが続く間は、前回書き込んだ空のクラスタをそのまま使う
+        if (lights_.empty() && uploadedEmpty_) return true;
+        uploadedEmpty_ = lights_.empty();
+        if (!upload(device, ctx, buffers_[0], lights_.data(), lights_.size(), sizeof(GpuLight))) return false;
+        if (!upload(device, ctx, buffers_[1], clusters_.data(), clusters_.size(), sizeof(uint32_t) * 2)) return false;
+        return upload(device, ctx, buffers_[2], indices_.data(), indices_.size(), sizeof(uint32_t));
+    }
+
+    /**
+     * @brief t3〜t5 に設定するビュー(SLOT_COUNT 個)
+     */
+    ID3D11ShaderResourceView* const* ShaderResources() {
+        for (UINT i = 0; i < SLOT_COUNT; ++i) srvs_[i] = buffers_[i].srv.Get();
+        return srvs_;
+    }
+
+    size_t LightCount() const { return lights_.size(); }
+    size_t IndexCount() const { return indices_.size(); }
+
+    void Shutdown() {
+        for (Buffer& b : buffers_) b = Buffer();
+        uploadedEmpty_ = false;
+        lights_.clear();
+        clusters_.clear();
+        indices_.clear();
+    }
+
+private:
+    struct ClusterRange {
+        uint32_t x0 = 0, x1 = 0, y0 = 0, y1 = 0, z0 = 0, z1 = 0;
+        bool valid = false;
+    };
+
+    struct Buffer {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        size_t capacity = 0; ///< 要素数
+    };
+
+    static constexpr size_t MIN_CAPACITY = 64;
+
+    static uint32_t index(uint32_t x, uint32_t y, uint32_t z) { return (z * DIM_Y + y) * DIM_X + x; }
+
+    static uint32_t tile(float t, uint32_t count) {
+        int i = static_cast<int>(std::floor(t * count));
+        return static_cast<uint32_t>((std::min)((std::max)(i, 0), static_cast<int>(count) - 1));
+    }
+
+    static uint32_t slice(float viewZ, float nearZ, float logScale) {
+        int i = static_cast<int>(std::floor(std::log(viewZ / nearZ) * logScale));
+        return static_cast<uint32_t>((std::min)((std::max)(i, 0), static_cast<int>(DIM_Z) - 1));
+    }
+
+    // 構造化バッファに書き込む(空でも1要素分は確保してビューを有効にしておく)
+    static bool upload(ID3D11Device* device, ID3D11DeviceContext* ctx, Buffer& b, const void* data, size_t count, size_t stride) {
+        if (count > b.capacity || !b.buffer) {
+            size_t capacity = (std::max)(b.capacity, MIN_CAPACITY);
+            while (capacity < count) capacity *= 2;
+
+            D3D11_BUFFER_DESC bd{};
+            bd.Usage = D3D11_USAGE_DYNAMIC;
+            bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            bd.StructureByteStride = static_cast<UINT>(stride);
+            bd.ByteWidth = static_cast<UINT>(capacity * stride);
+
+            Buffer created;
+            HRESULT hr = device->CreateBuffer(&bd, nullptr, created.buffer.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[LightClusters] バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+            srvd.Format = DXGI_FORMAT_UNKNOWN;
+            srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvd.Buffer.FirstElement = 0;
+            srvd.Buffer.NumElements = static_cast<UINT>(capacity);
+            hr = device->CreateShaderResourceView(created.buffer.Get(), &srvd, created.srv.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[LightClusters] SRVの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+            created.capacity = capacity;
+            b = created;
+        }
+        if (count == 0) return true;
+
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        HRESULT hr = ctx->Map(b.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[LightClusters] バッファのMap失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        std::memcpy(mapped.pData, data, count * stride);
+        ctx->Unmap(b.buffer.Get(), 0);
+        return true;
+    }
+
+    std::vector<GpuLight> lights_;                    ///< このフレームのライト
+    std::vector<ClusterRange> ranges_;                ///< ライトごとのクラスタ範囲
+    std::vector<uint32_t> counts_;                    ///< クラスタごとの数(2パス目は書き込み位置)
+    std::vector<std::array<uint32_t, 2>> clusters_;   ///< クラスタごとの (開始位置, 数)
+    std::vector<uint32_t> indices_;                   ///< ライト番号
+    Buffer buffers_[SLOT_COUNT];                      ///< ライト・クラスタ・番号
+    ID3D11ShaderResourceView* srvs_[SLOT_COUNT] = {};
+    bool uploadedEmpty_ = false;                      ///< 最後に書き込んだ内容がライトなしか
+};
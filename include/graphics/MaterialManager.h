@@ -0,0 +1,297 @@
+/**
+ * @file MaterialManager.h
+ * @brief マテリアル(色・テクスチャ・スペキュラ・不透明度)と不変の定数バッファの管理
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * マテリアルごとにピクセルシェーダーの PerObject(b0) と同じ配置の定数バッファを
+ * D3D11_USAGE_IMMUTABLE で1回だけ作成し、描画時はハンドルから引いたバッファをバインドするだけにします
+ * (描画ごとの UpdateSubresource はありません)。
+ *
+ * - Create() は明示的なマテリアルです。参照カウントを持ち、Release() で0になるまで破棄されません。
+ *   MeshRenderer::material / ModelComponent::material に設定すると、コンポーネントの色・テクスチャより優先されます。
+ * - Resolve() は material を設定していないコンポーネントの色・テクスチャから RenderSystem が引く暗黙のマテリアルです。
+ *   TRANSIENT_LIFETIME_FRAMES フレーム使われなければ EndFrame() で破棄します(色を毎フレーム変える場合も増え続けない)。
+ *
+ * opacity が 1 未満のマテリアルは半透明として扱い、RenderSystem は不透明の描画キューではなく
+ * TransparentQueue でアルファブレンドして描きます(IsTransparent())。
+ *
+ * どちらも内容が同じなら同じハンドルを返します。ハンドルは小さな連番で、描画キューのソートキーにそのまま使います。
+ * メインスレッド専用です。
+ */
+#pragma once
+#include "graphics/GfxDevice.h"
+#include "graphics/TextureManager.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct MaterialDesc
+ * @brief マテリアルの内容
+ */
+struct MaterialDesc {
+    DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f };                                   ///< 基本色(テクスチャがある場合は乗算)
+    TextureManager::TextureHandle texture = TextureManager::INVALID_TEXTURE;        ///< ディフューズテクスチャ
+    TextureManager::TextureHandle normalTexture = TextureManager::INVALID_TEXTURE;  ///< ノーマルマップ
+    float specularPower = 32.0f;                                                    ///< スペキュラ強度
+    float opacity = 1.0f;                                                           ///< 不透明度(1 未満は半透明パスで奥から手前へ描く)
+};
+
+/**
+ * @class MaterialManager
+ * @brief マテリアルのハンドルと定数バッファ
+ *
+ * @par 使用例
+ * @code
+ * auto& materials = ServiceLocator::Get<MaterialManager>();
+ * MaterialDesc desc;
+ * desc.texture = texManager.LoadFromFile("metal.png");
+ * desc.specularPower = 96.0f;
+ * MeshRenderer renderer;
+ * renderer.material = materials.Create(desc);
+ * // ...
+ * materials.Release(renderer.material);
+ * @endcode
+ */
+class MaterialManager {
+public:
+    using MaterialHandle = uint32_t;
+    static constexpr MaterialHandle INVALID_MATERIAL = 0;
+    static constexpr uint32_t TRANSIENT_LIFETIME_FRAMES = 120; ///< 参照のないマテリアルを残すフレーム数
+    static constexpr uint32_t EVICT_INTERVAL_FRAMES = 30;      ///< 破棄の判定を行う間隔
+
+    /**
+     * @struct Constants
+     * @brief 定数バッファの内容(ピクセルシェーダーの PerObject(b0) と同じ配置)
+     */
+    struct Constants {
+        DirectX::XMFLOAT4 color;  ///< マテリアルカラー
+        float useTexture;         ///< テクスチャ使用フラグ(バリアントがない場合の汎用シェーダーのみ参照)
+        float useNormalMap;       ///< ノーマルマップ使用フラグ(同上)
+        float specularPower;      ///< スペキュラ強度
+        float useTextureArray;    ///< 共有テクスチャ配列使用フラグ(インスタンス描画のみ、同上)
+    };
+
+    bool Init(GfxDevice& gfx) {
+        device_ = gfx.Dev();
+        frame_ = 0;
+        return device_ != nullptr;
+    }
+
+    void Shutdown() {
+        if (!entries_.empty()) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[MaterialManager] マテリアルを解放: " + std::to_string(count_) + " 個");
+        }
+        entries_.clear();
+        freeHandles_.clear();
+        lookup_.clear();
+        count_ = 0;
+        device_ = nullptr;
+    }
+
+    /**
+     * @brief 明示的なマテリアルを作成(同じ内容があれば参照を増やして同じハンドルを返す)
+     * @return MaterialHandle 定数バッファを作成できない場合 INVALID_MATERIAL
+     */
+    MaterialHandle Create(const MaterialDesc& desc) {
+        MaterialHandle handle = FindOrCreate(desc);
+        if (handle != INVALID_MATERIAL) entries_[handle - 1].refCount++;
+        return handle;
+    }
+
+    void AddRef(MaterialHandle handle) {
+        if (IsValid(handle)) entries_[handle - 1].refCount++;
+    }
+
+    /**
+     * @brief 明示的なマテリアルの参照を返す(0になっても使われている間は暗黙のマテリアルとして残る)
+     */
+    void Release(MaterialHandle& handle) {
+        if (IsValid(handle) && entries_[handle - 1].refCount > 0) {
+            entries_[handle - 1].refCount--;
+            entries_[handle - 1].lastUsedFrame = frame_;
+        }
+        handle = INVALID_MATERIAL;
+    }
+
+    /**
+     * @brief 暗黙のマテリアルを引く(なければ作成、今回のフレームで使ったことを記録)
+     * @return MaterialHandle 定数バッファを作成できない場合 INVALID_MATERIAL
+     */
+    MaterialHandle Resolve(const MaterialDesc& desc) {
+        return FindOrCreate(desc);
+    }
+
+    bool IsValid(MaterialHandle handle) const {
+        return handle != INVALID_MATERIAL && handle <= entries_.size() && entries_[handle - 1].buffer;
+    }
+
+    /**
+     * @brief 半透明のマテリアルか(opacity が 1 未満、無効なハンドルは false)
+     */
+    bool IsTransparent(MaterialHandle handle) const {
+        return IsValid(handle) && entries_[handle - 1].desc.opacity < 1.0f;
+    }
+
+    /**
+     * @brief マテリアルの内容(無効なハンドルは既定値)
+     */
+    const MaterialDesc& GetDesc(MaterialHandle handle) const {
+        static const MaterialDesc kDefault;
+        return IsValid(handle) ? entries_[handle - 1].desc : kDefault;
+    }
+
+    /**
+     * @brief マテリアルの定数バッファ(無効なハンドルは nullptr)
+     */
+    ID3D11Buffer* ConstantBuffer(MaterialHandle handle) const {
+        return IsValid(handle) ? entries_[handle - 1].buffer.Get() : nullptr;
+    }
+
+    /**
+     * @brief 今回のフレームで使ったことを記録して定数バッファを返す(無効なハンドルは nullptr)
+     */
+    ID3D11Buffer* Use(MaterialHandle handle) {
+        if (!IsValid(handle)) return nullptr;
+        entries_[handle - 1].lastUsedFrame = frame_;
+        return entries_[handle - 1].buffer.Get();
+    }
+
+    /**
+     * @brief フレームを進め、参照がなく一定フレーム使われていないマテリアルを破棄
+     */
+    void EndFrame() {
+        ++frame_;
+        if (frame_ % EVICT_INTERVAL_FRAMES != 0) return;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            Entry& entry = entries_[i];
+            if (!entry.buffer || entry.refCount > 0 || frame_ - entry.lastUsedFrame < TRANSIENT_LIFETIME_FRAMES) continue;
+            lookup_.erase(Key::From(entry.desc));
+            entry = Entry();
+            freeHandles_.push_back(static_cast<MaterialHandle>(i + 1));
+            count_--;
+        }
+    }
+
+    size_t Count() const { return count_; }
+
+    /**
+     * @brief GPUメモリの使用量(バイト)
+     */
+    size_t GpuMemoryBytes() const { return count_ * sizeof(Constants); }
+
+    /**
+     * @brief 定数バッファの内容
+     */
+    static Constants MakeConstants(const MaterialDesc& desc) {
+        Constants c;
+        c.color = DirectX::XMFLOAT4{ desc.color.x, desc.color.y, desc.color.z, desc.opacity };
+        c.useTexture = desc.texture != TextureManager::INVALID_TEXTURE ? 1.0f : 0.0f;
+        c.useNormalMap = desc.normalTexture != TextureManager::INVALID_TEXTURE ? 1.0f : 0.0f;
+        c.specularPower = desc.specularPower;
+        c.useTextureArray = 0.0f;
+        return c;
+    }
+
+    /**
+     * @brief 不変の定数バッファを作成
+     */
+    static bool CreateConstantBuffer(ID3D11Device* device, const Constants& constants, Microsoft::WRL::ComPtr<ID3D11Buffer>& out) {
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_IMMUTABLE;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = sizeof(Constants);
+        D3D11_SUBRESOURCE_DATA init{ &constants, 0, 0 };
+        HRESULT hr = device->CreateBuffer(&bd, &init, out.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[MaterialManager] 定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static_assert(sizeof(Constants) % 16 == 0, "Constants must be a multiple of 16 bytes");
+
+    /**
+     * @struct Key
+     * @brief 内容の比較用(浮動小数点はビット列で比較)
+     */
+    struct Key {
+        uint32_t words[7];
+
+        static Key From(const MaterialDesc& desc) {
+            Key key;
+            std::memcpy(&key.words[0], &desc.color, sizeof(desc.color));
+            key.words[3] = desc.texture;
+            key.words[4] = desc.normalTexture;
+            std::memcpy(&key.words[5], &desc.specularPower, sizeof(float));
+            std::memcpy(&key.words[6], &desc.opacity, sizeof(float));
+            return key;
+        }
+
+        bool operator==(const Key& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = 1469598103934665603ull;
+            for (uint32_t w : key.words) {
+                h ^= w;
+                h *= 1099511628211ull;
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Entry {
+        MaterialDesc desc;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;  ///< 空の場合は未使用のハンドル
+        uint32_t refCount = 0;                        ///< Create() の参照数
+        uint64_t lastUsedFrame = 0;                   ///< 最後に引かれたフレーム
+    };
+
+    MaterialHandle FindOrCreate(const MaterialDesc& desc) {
+        const Key key = Key::From(desc);
+        auto it = lookup_.find(key);
+        if (it != lookup_.end()) {
+            entries_[it->second - 1].lastUsedFrame = frame_;
+            return it->second;
+        }
+        if (!device_) return INVALID_MATERIAL;
+
+        Entry entry;
+        entry.desc = desc;
+        entry.lastUsedFrame = frame_;
+        if (!CreateConstantBuffer(device_, MakeConstants(desc), entry.buffer)) return INVALID_MATERIAL;
+
+        MaterialHandle handle;
+        if (!freeHandles_.empty()) {
+            handle = freeHandles_.back();
+            freeHandles_.pop_back();
+            entries_[handle - 1] = std::move(entry);
+        } else {
+            entries_.push_back(std::move(entry));
+            handle = static_cast<MaterialHandle>(entries_.size());
+        }
+        lookup_.emplace(key, handle);
+        count_++;
+        return handle;
+    }
+
+    ID3D11Device* device_ = nullptr;
+    std::vector<Entry> entries_;                                 ///< ハンドル - 1 で引く
+    std::vector<MaterialHandle> freeHandles_;                    ///< 破棄したハンドル(再利用)
+    std::unordered_map<Key, MaterialHandle, KeyHash> lookup_;    ///< 内容 -> ハンドル
+    size_t count_ = 0;                                           ///< 有効なマテリアル数
+    uint64_t frame_ = 0;
+};
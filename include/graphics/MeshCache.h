@@ -0,0 +1,358 @@
+/**
+ * @file MeshCache.h
+ * @brief 変換済みメッシュのバイナリキャッシュ(.meshcache)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ModelLoader が Assimp で読み込んだ結果(頂点・インデックス・LOD・マテリアル参照)を
+ * ヘッダーと生のバイト列としてモデルファイルの隣に保存します。
+ * 読み込み時はファイルをメモリマップし、頂点・インデックスはマップした領域を
+ * そのまま D3D11_USAGE_IMMUTABLE バッファの初期データに渡すため、変換処理はありません。
+ * 元ファイルのサイズと更新日時が記録と異なる場合は古いキャッシュとして扱います。
+ * AssetArchive に含まれるキャッシュはアーカイブのマップした領域(圧縮して格納した場合は展開したバッファ)を参照します。
+ *
+ * ### ファイルレイアウト:
+ * - FileHeader
+ * - メッシュごとに MeshRecord、各レベルの頂点とインデックス、テクスチャパス(それぞれ4バイト境界に揃える)
+ */
+#pragma once
+#include <Windows.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "app/AssetArchive.h"
+#include "app/DebugLog.h"
+
+/**
+ * @struct MeshCacheStamp
+ * @brief キャッシュの鮮度判定に使う元ファイルの情報
+ */
+struct MeshCacheStamp {
+    uint64_t size = 0;       ///< 元ファイルのサイズ(バイト)
+    uint64_t writeTime = 0;  ///< 元ファイルの更新日時(FILETIME)
+    uint32_t importFlags = 0;///< 変換の設定(ModelLoader の読み込みオプション。異なるキャッシュは作り直す)
+
+    /**
+     * @brief ファイルの情報を取得
+     * @return bool ファイルが存在する場合 true
+     */
+    static bool FromFile(const std::string& path, MeshCacheStamp& out) {
+        WIN32_FILE_ATTRIBUTE_DATA data{};
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) return false;
+        out.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        out.writeTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+
+    bool operator==(const MeshCacheStamp& other) const {
+        return size == other.size && writeTime == other.writeTime && importFlags == other.importFlags;
+    }
+    bool operator!=(const MeshCacheStamp& other) const { return !(*this == other); }
+};
+
+/**
+ * @struct MeshCacheGeometry
+ * @brief 1レベル分の頂点・インデックスの参照(キャッシュ読み込み時はマップした領域を指す)
+ */
+struct MeshCacheGeometry {
+    const void* vertices = nullptr;  ///< 頂点データ
+    uint32_t vertexCount = 0;        ///< 頂点数(0 の場合このレベルなし)
+    const void* indices = nullptr;   ///< インデックスデータ
+    uint32_t indexCount = 0;         ///< インデックス数
+    uint32_t indexStride = 2;        ///< インデックス1個のバイト数(2 または 4)
+};
+
+/**
+ * @struct MeshCacheEntry
+ * @brief キャッシュ内の1メッシュ
+ */
+struct MeshCacheEntry {
+    static constexpr uint32_t LEVEL_COUNT = 3;      ///< LOD0 と簡略化メッシュ2段階
+
+    MeshCacheGeometry levels[LEVEL_COUNT];          ///< LODごとのジオメトリ
+    DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f };    ///< マテリアルカラー
+    DirectX::XMFLOAT3 boundsCenter{ 0.0f, 0.0f, 0.0f }; ///< ローカル空間の境界球の中心
+    float boundsRadius = 0.0f;                      ///< ローカル空間の境界球の半径
+    std::string diffusePath;                        ///< ディフューズテクスチャのパス(空ならなし)
+    std::string normalPath;                         ///< ノーマルマップのパス(空ならなし)
+};
+
+/**
+ * @class MeshCacheFile
+ * @brief .meshcache の書き出しとメモリマップによる読み込み
+ *
+ * @par 使用例
+ * @code
+ * MeshCacheFile cache;
+ * if (cache.Open(path + MeshCacheFile::EXTENSION, &stamp, sizeof(SimpleVertex))) {
+ *     for (const MeshCacheEntry& entry : cache.Entries()) {
+ *         // entry.levels[0].vertices をそのままバッファの初期データに使う
+ *     }
+ * }
+ * @endcode
+ *
+ * @note Entries() の頂点・インデックスは Close() またはデストラクタまで有効です
+ */
+class MeshCacheFile {
+public:
+    static constexpr uint32_t MAGIC = 0x4348534D;   ///< 'MSHC'
+    static constexpr uint32_t VERSION = 3;          ///< 形式や変換処理を変えたら上げる
+    static constexpr const char* EXTENSION = ".meshcache";
+
+    MeshCacheFile() = default;
+    ~MeshCacheFile() { Close(); }
+    MeshCacheFile(const MeshCacheFile&) = delete;
+    MeshCacheFile& operator=(const MeshCacheFile&) = delete;
+
+    /**
+     * @brief キャッシュを開いてメモリマップ
+     * @param[in] path キャッシュファイルのパス
+     * @param[in] expected 元ファイルの情報(nullptr の場合は鮮度を確認しない)
+     * @param[in] vertexStride 期待する頂点1個のバイト数
+     * @return bool 有効なキャッシュを開けた場合 true
+     */
+    bool Open(const std::string& path, const MeshCacheStamp* expected, uint32_t vertexStride) {
+        Close();
+        if (!mapFile(path)) return false;
+
+        if (size_ < sizeof(FileHeader)) return fail(path, "ヘッダーが不完全");
+        FileHeader header;
+        std::memcpy(&header, data_, sizeof(header));
+        if (header.magic != MAGIC || header.version != VERSION || header.vertexStride != vertexStride) {
+            return fail(path, "形式が異なる");
+        }
+        if (expected && (header.sourceSize != expected->size || header.sourceWriteTime != expected->writeTime)) {
+            Close();
+            return false; // 元ファイルが更新されている
+        }
+        if (expected && header.importFlags != expected->importFlags) {
+            Close();
+            return false; // 読み込みオプションが変わった
+        }
+
+        size_t offset = sizeof(FileHeader);
+        // 壊れたメッシュ数で巨大な確保をしないよう、残りの大きさに収まるかを先に確かめる
+        if (header.meshCount > (size_ - offset) / sizeof(MeshRecord)) return fail(path, "メッシュ数が不正");
+        entries_.resize(header.meshCount);
+        for (uint32_t m = 0; m < header.meshCount; ++m) {
+            MeshRecord record;
+            if (!read(offset, &record, sizeof(record))) return fail(path, "メッシュ情報が不完全");
+
+            MeshCacheEntry& entry = entries_[m];
+            for (uint32_t l = 0; l < MeshCacheEntry::LEVEL_COUNT; ++l) {
+                const LevelRecord& level = record.levels[l];
+                MeshCacheGeometry& geometry = entry.levels[l];
+                if (level.indexStride != 2 && level.indexStride != 4) return fail(path, "インデックス形式が不正");
+                geometry.vertexCount = level.vertexCount;
+                geometry.indexCount = level.indexCount;
+                geometry.indexStride = level.indexStride;
+                geometry.vertices = view(offset, static_cast<size_t>(level.vertexCount) * vertexStride);
+                geometry.indices = view(offset, static_cast<size_t>(level.indexCount) * level.indexStride);
+                if (!geometry.vertices || !geometry.indices) return fail(path, "頂点データが不完全");
+            }
+
+            const char* diffuse = static_cast<const char*>(view(offset, record.diffusePathLength));
+            const char* normal = static_cast<const char*>(view(offset, record.normalPathLength));
+            if (!diffuse || !normal) return fail(path, "テクスチャパスが不完全");
+            entry.diffusePath.assign(diffuse, record.diffusePathLength);
+            entry.normalPath.assign(normal, record.normalPathLength);
+            entry.color = DirectX::XMFLOAT3{ record.color[0], record.color[1], record.color[2] };
+            entry.boundsCenter = DirectX::XMFLOAT3{ record.boundsCenter[0], record.boundsCenter[1], record.boundsCenter[2] };
+            entry.boundsRadius = record.boundsRadius;
+        }
+        return true;
+    }
+
+    void Close() {
+        entries_.clear();
+        if (data_ && !archived_.data) UnmapViewOfFile(data_);
+        archived_ = AssetArchive::Blob();
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        data_ = nullptr;
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+        size_ = 0;
+    }
+
+    const std::vector<MeshCacheEntry>& Entries() const { return entries_; }
+
+    /**
+     * @brief キャッシュを書き出し(一時ファイルに書いてから置き換える)
+     * @param[in] path キャッシュファイルのパス
+     * @param[in] stamp 元ファイルの情報
+     * @param[in] vertexStride 頂点1個のバイト数
+     * @param[in] entries 書き出すメッシュ(geometry はメモリ上のデータを指す)
+     * @return bool 書き出せた場合 true
+     */
+    static bool Write(const std::string& path, const MeshCacheStamp& stamp, uint32_t vertexStride, const std::vector<MeshCacheEntry>& entries) {
+        const std::string tempPath = path + ".tmp";
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, tempPath.c_str(), "wb") != 0 || !fp) {
+            DEBUGLOG_WARNING("[MeshCache] 書き出し先を開けません: " + tempPath);
+            return false;
+        }
+
+        FileHeader header;
+        header.vertexStride = vertexStride;
+        header.meshCount = static_cast<uint32_t>(entries.size());
+        header.sourceSize = stamp.size;
+        header.sourceWriteTime = stamp.writeTime;
+        header.importFlags = stamp.importFlags;
+
+        bool ok = writeBlock(fp, &header, sizeof(header));
+        for (const MeshCacheEntry& entry : entries) {
+            MeshRecord record;
+            for (uint32_t l = 0; l < MeshCacheEntry::LEVEL_COUNT; ++l) {
+                record.levels[l].vertexCount = entry.levels[l].vertexCount;
+                record.levels[l].indexCount = entry.levels[l].indexCount;
+                record.levels[l].indexStride = entry.levels[l].indexStride;
+            }
+            record.color[0] = entry.color.x; record.color[1] = entry.color.y; record.color[2] = entry.color.z;
+            record.boundsCenter[0] = entry.boundsCenter.x; record.boundsCenter[1] = entry.boundsCenter.y; record.boundsCenter[2] = entry.boundsCenter.z;
+            record.boundsRadius = entry.boundsRadius;
+            record.diffusePathLength = static_cast<uint32_t>(entry.diffusePath.size());
+            record.normalPathLength = static_cast<uint32_t>(entry.normalPath.size());
+
+            ok = ok && writeBlock(fp, &record, sizeof(record));
+            for (uint32_t l = 0; l < MeshCacheEntry::LEVEL_COUNT; ++l) {
+                const MeshCacheGeometry& g = entry.levels[l];
+                ok = ok && writeBlock(fp, g.vertices, static_cast<size_t>(g.vertexCount) * vertexStride);
+                ok = ok && writeBlock(fp, g.indices, static_cast<size_t>(g.indexCount) * g.indexStride);
+            }
+            ok = ok && writeBlock(fp, entry.diffusePath.data(), entry.diffusePath.size());
+            ok = ok && writeBlock(fp, entry.normalPath.data(), entry.normalPath.size());
+        }
+
+        ok = (fclose(fp) == 0) && ok;
+        if (!ok || !MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            DeleteFileA(tempPath.c_str());
+            DEBUGLOG_WARNING("[MeshCache] 書き出し失敗: " + path);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 元ファイルの情報だけを書き換える(内容が同じまま更新日時が変わった元ファイルのキャッシュを作り直さずに使うため)
+     * @param[in] path キャッシュファイルのパス
+     * @param[in] stamp 元ファイルの情報(importFlags が記録と異なる場合は書き換えない)
+     * @return bool 記録が元ファイルと一致した(書き換えた、または書き換える必要がなかった)場合 true
+     */
+    static bool Restamp(const std::string& path, const MeshCacheStamp& stamp) {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "r+b") != 0 || !fp) return false;
+        FileHeader header;
+        bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+                  header.magic == MAGIC && header.version == VERSION && header.importFlags == stamp.importFlags;
+        if (ok && (header.sourceSize != stamp.size || header.sourceWriteTime != stamp.writeTime)) {
+            header.sourceSize = stamp.size;
+            header.sourceWriteTime = stamp.writeTime;
+            ok = fseek(fp, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, fp) == 1;
+        }
+        ok = (fclose(fp) == 0) && ok;
+        return ok;
+    }
+
+private:
+    struct FileHeader {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t vertexStride = 0;
+        uint32_t meshCount = 0;
+        uint64_t sourceSize = 0;
+        uint64_t sourceWriteTime = 0;
+        uint32_t importFlags = 0;
+        uint32_t reserved = 0;
+    };
+
+    struct LevelRecord {
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint32_t indexStride = 2;
+        uint32_t reserved = 0;
+    };
+
+    struct MeshRecord {
+        LevelRecord levels[MeshCacheEntry::LEVEL_COUNT];
+        float color[3] = { 1.0f, 1.0f, 1.0f };
+        float boundsCenter[3] = { 0.0f, 0.0f, 0.0f };
+        float boundsRadius = 0.0f;
+        uint32_t diffusePathLength = 0;
+        uint32_t normalPathLength = 0;
+        uint32_t reserved = 0;
+    };
+
+    static size_t align4(size_t bytes) { return (bytes + 3) & ~static_cast<size_t>(3); }
+
+    // 4バイト境界までゼロで埋めて書き込み
+    static bool writeBlock(FILE* fp, const void* data, size_t bytes) {
+        static const uint8_t zeros[4] = {};
+        if (bytes > 0 && fwrite(data, 1, bytes, fp) != bytes) return false;
+        size_t pad = align4(bytes) - bytes;
+        return pad == 0 || fwrite(zeros, 1, pad, fp) == pad;
+    }
+
+    bool mapFile(const std::string& path) {
+        if (AssetArchive::GetInstance().Read(path, archived_)) {
+            if (archived_.size == 0) {
+                Close();
+                return false;
+            }
+            data_ = archived_.data;
+            size_ = archived_.size;
+            return true;
+        }
+
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+            Close();
+            return false;
+        }
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_) data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (!data_) {
+            DEBUGLOG_WARNING("[MeshCache] メモリマップ失敗: " + path);
+            Close();
+            return false;
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        return true;
+    }
+
+    // offset から bytes を参照して offset を次の4バイト境界へ進める(範囲外なら nullptr)
+    const void* view(size_t& offset, size_t bytes) const {
+        if (offset > size_ || bytes > size_ - offset) return nullptr;
+        const void* p = static_cast<const uint8_t*>(data_) + offset;
+        offset = align4(offset + bytes);
+        return p;
+    }
+
+    bool read(size_t& offset, void* out, size_t bytes) const {
+        const void* p = view(offset, bytes);
+        if (!p) return false;
+        std::memcpy(out, p, bytes);
+        return true;
+    }
+
+    bool fail(const std::string& path, const char* reason) {
+        DEBUGLOG_WARNING(std::string("[MeshCache] キャッシュを使用できません(") + reason + "): " + path);
+        Close();
+        return false;
+    }
+
+    HANDLE file_ = INVALID_HANDLE_VALUE;   ///< ファイルハンドル
+    HANDLE mapping_ = nullptr;             ///< ファイルマッピング
+    const void* data_ = nullptr;           ///< マップした先頭
+    AssetArchive::Blob archived_;          ///< アーカイブから読んだ場合の内容(data_ が参照)
+    size_t size_ = 0;                      ///< ファイルサイズ
+    std::vector<MeshCacheEntry> entries_;  ///< 読み込んだメッシュ(data_ を参照)
+};
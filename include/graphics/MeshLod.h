@@ -0,0 +1,95 @@
+/**
+ * @file MeshLod.h
+ * @brief 画面上の大きさによるLOD(詳細度)の選択
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 境界球の投影サイズ(画面の高さに対する割合)からLODレベルを選びます。
+ * 境界付近でレベルが毎フレーム切り替わらないよう、しきい値に幅(ヒステリシス)を持たせています。
+ */
+#pragma once
+#include "graphics/Camera.h"
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct MeshLod
+ * @brief LOD選択の定数と関数
+ *
+ * @par 使用例
+ * @code
+ * float size = MeshLod::ProjectedSize(center, radius, cam);
+ * uint8_t lod = MeshLod::Select(previousLod, size);
+ * @endcode
+ */
+struct MeshLod {
+    static constexpr uint8_t LEVEL_COUNT = 3;   ///< LODレベル数(0が最も詳細)
+    static constexpr float HYSTERESIS = 0.15f;  ///< しきい値の前後に持たせる幅(割合)
+
+    /**
+     * @brief レベル i と i+1 の境界となる投影サイズ(画面の高さに対する境界球の直径の割合)
+     */
+    static float Threshold(uint8_t i) {
+        static const float thresholds[LEVEL_COUNT - 1] = { 0.25f, 0.08f };
+        return thresholds[i];
+    }
+
+    /**
+     * @brief 境界球の投影サイズ
+     * @param[in] center ワールド空間の中心
+     * @param[in] radius ワールド空間の半径(0以下は常に最大サイズ)
+     * @param[in] cam カメラ
+     * @return float 画面の高さに対する直径の割合(カメラが球の内側なら 1 以上)
+     */
+    static float ProjectedSize(const DirectX::XMFLOAT3& center, float radius, const Camera& cam) {
+        if (radius <= 0.0f) return 1.0f;
+        float dx = center.x - cam.position.x;
+        float dy = center.y - cam.position.y;
+        float dz = center.z - cam.position.z;
+        float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (distance <= radius) return 1.0f;
+        return radius / (distance * std::tan(cam.fovY * 0.5f));
+    }
+
+    /**
+     * @brief 前回のレベルと投影サイズから今回のレベルを選択
+     * @param[in] previous 前回のレベル(初回は任意)
+     * @param[in] size ProjectedSize() の値
+     */
+    static uint8_t Select(uint8_t previous, float size) {
+        uint8_t lod = previous < LEVEL_COUNT ? previous : static_cast<uint8_t>(LEVEL_COUNT - 1);
+        while (lod > 0 && size > Threshold(lod - 1) * (1.0f + HYSTERESIS)) --lod;
+        while (lod + 1 < LEVEL_COUNT && size < Threshold(lod) * (1.0f - HYSTERESIS)) ++lod;
+        return lod;
+    }
+};
+
+/**
+ * @class LodHistory
+ * @brief エンティティごとの前回のLODレベル(ヒステリシス用)
+ *
+ * @details
+ * エンティティIDで引く平坦な配列です。IDが再利用された場合は前のエンティティの値から始まりますが、
+ * 次のフレームには正しいレベルに収束します。
+ */
+class LodHistory {
+public:
+    /**
+     * @brief 今回のレベルを選択して記録
+     */
+    uint8_t Update(uint32_t id, float size) {
+        if (id >= levels_.size()) levels_.resize(id + 1, MeshLod::LEVEL_COUNT - 1);
+        levels_[id] = MeshLod::Select(levels_[id], size);
+        return levels_[id];
+    }
+
+    void Clear() { levels_.clear(); }
+
+private:
+    std::vector<uint8_t> levels_; ///< エンティティID -> 前回のレベル
+};
@@ -0,0 +1,381 @@
+/**
+ * @file MeshPool.h
+ * @brief 静的メッシュの頂点・インデックスを1組の共有バッファに部分割り当てする
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 基本形状(RenderSystem の meshCache_)と読み込んだモデル(ModelComponent)のメッシュを、
+ * 1つの頂点バッファと1つのインデックスバッファの中の範囲として保持します。
+ * 描画は DrawIndexed の StartIndexLocation / BaseVertexLocation で範囲を指定するため、
+ * メッシュを切り替えても IASetVertexBuffers / IASetIndexBuffer を呼び直す必要がありません。
+ *
+ * - インデックスはメッシュの先頭頂点からの16ビットの番号です(BaseVertexLocation で共有バッファ内の位置に直す)。
+ *   頂点数が MAX_MESH_VERTICES を超えるメッシュは割り当てず、呼び出し側が個別のバッファで描画します。
+ * - 範囲は MeshPoolHandle の最後の参照が消えた時点で空き領域に戻り、隣接する空き領域と結合します(先頭から最初に収まる位置に割り当て)。
+ * - 容量が足りない場合は2倍以上のバッファを作り直し、使用中の内容を CopySubresourceRegion で移します。
+ *   VertexBuffer() / IndexBuffer() のポインタはこのとき変わるため、フレームをまたいで保持しないでください。
+ *
+ * 1つのプールは1つの頂点形式(VertexStride())だけを扱います。形式ごとにプールを分けて持ちます(GfxDevice::Meshes())。
+ *
+ * 割り当てと書き込みは即時コンテキストを使うため、GfxDevice::ResourceMutex() の保護下(または描画と並行しないスレッド)で行います。
+ * 範囲の返却は CPU 側の空き領域の更新だけなので、どのスレッドから行っても構いません。
+ */
+#pragma once
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @struct MeshPoolRange
+ * @brief 共有バッファ内の1メッシュ分の範囲
+ */
+struct MeshPoolRange {
+    UINT baseVertex = 0;    ///< 先頭頂点(BaseVertexLocation)
+    UINT vertexCount = 0;   ///< 頂点数
+    UINT startIndex = 0;    ///< 先頭インデックス(StartIndexLocation)
+    UINT indexCount = 0;    ///< インデックス数
+};
+
+/**
+ * @brief 割り当てた範囲の所有権(コピーは参照を共有し、最後の参照が消えると範囲を返却)
+ */
+using MeshPoolHandle = std::shared_ptr<const MeshPoolRange>;
+
+/**
+ * @class MeshPool
+ * @brief 静的メッシュ用の共有頂点・インデックスバッファ
+ *
+ * @par 使用例
+ * @code
+ * MeshPoolHandle mesh = pool.Allocate(ctx, vertices, vertexCount, indices, indexCount);
+ * if (mesh) {
+ *     ID3D11Buffer* vb = pool.VertexBuffer();
+ *     UINT stride = pool.VertexStride(), offset = 0;
+ *     ctx->IASetVertexBuffers(0, 1, &vb, &stride, &offset);  // フレームに1回
+ *     ctx->IASetIndexBuffer(pool.IndexBuffer(), MeshPool::INDEX_FORMAT, 0);
+ *     ctx->DrawIndexed(mesh->indexCount, mesh->startIndex, static_cast<INT>(mesh->baseVertex));
+ * }
+ * @endcode
+ */
+class MeshPool {
+public:
+    static constexpr UINT VERTEX_STRIDE = 56;                         ///< 標準の頂点形式(位置・UV・法線・接線・従接線)のバイト数
+    static constexpr DXGI_FORMAT INDEX_FORMAT = DXGI_FORMAT_R16_UINT; ///< インデックス形式(メッシュ内の番号)
+    static constexpr UINT MAX_MESH_VERTICES = 0x10000;                ///< 1メッシュの頂点数の上限(16ビットの番号で表せる数)
+    static constexpr UINT INITIAL_VERTICES = 64 * 1024;               ///< 頂点バッファの初期容量(頂点数)
+    static constexpr UINT INITIAL_INDICES = 256 * 1024;               ///< インデックスバッファの初期容量(インデックス数)
+
+    /**
+     * @struct Statistics
+     * @brief 使用状況
+     */
+    struct Statistics {
+        size_t meshes = 0;           ///< 割り当て中の範囲の数
+        size_t vertices = 0;         ///< 使用中の頂点数
+        size_t vertexCapacity = 0;   ///< 頂点バッファの容量(頂点数)
+        size_t indices = 0;          ///< 使用中のインデックス数
+        size_t indexCapacity = 0;    ///< インデックスバッファの容量(インデックス数)
+        size_t freeSpans = 0;        ///< 空き領域の数(頂点とインデックスの合計、断片化の目安)
+        size_t grows = 0;            ///< バッファを作り直した回数
+    };
+
+    MeshPool() = default;
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    ~MeshPool() { Shutdown(); }
+
+    /**
+     * @brief 初期容量のバッファを作成
+     * @param[in] vertexStride 1頂点のバイト数
+     * @param[in] initialVertices 頂点バッファの初期容量(頂点数)
+     * @param[in] initialIndices インデックスバッファの初期容量(インデックス数)
+     * @return bool 作成できた場合 true(false の場合 Allocate() は常に失敗し、各メッシュは個別のバッファを使う)
+     */
+    bool Init(ID3D11Device* device, UINT vertexStride = VERTEX_STRIDE, UINT initialVertices = INITIAL_VERTICES, UINT initialIndices = INITIAL_INDICES) {
+        Shutdown();
+        vertexStride_ = vertexStride;
+        auto state = std::make_shared<State>();
+        state->device = device;
+        if (!CreateBuffer(device, D3D11_BIND_VERTEX_BUFFER, initialVertices * vertexStride_, state->vertexBuffer) ||
+            !CreateBuffer(device, D3D11_BIND_INDEX_BUFFER, initialIndices * sizeof(uint16_t), state->indexBuffer)) {
+            DEBUGLOG_WARNING("[MeshPool] 共有バッファを作成できないため、メッシュごとのバッファで描画します");
+            return false;
+        }
+        state->vertices.Reset(initialVertices);
+        state->indices.Reset(initialIndices);
+        state_ = std::move(state);
+        return true;
+    }
+
+    bool IsReady() const { return state_ != nullptr; }
+
+    /**
+     * @brief 1頂点のバイト数(IASetVertexBuffers の stride)
+     */
+    UINT VertexStride() const { return vertexStride_; }
+
+    /**
+     * @brief CPU 側の頂点・インデックスを割り当てて書き込む
+     * @param[in] vertices VertexStride() バイトの頂点の配列
+     * @param[in] indices メッシュ内の頂点番号
+     * @return MeshPoolHandle 割り当てた範囲(頂点数が上限を超える・バッファを拡張できない場合は空)
+     */
+    MeshPoolHandle Allocate(ID3D11DeviceContext* ctx, const void* vertices, UINT vertexCount, const uint16_t* indices, UINT indexCount) {
+        MeshPoolRange range;
+        if (!Reserve(ctx, vertexCount, indexCount, range)) return nullptr;
+
+        const D3D11_BOX vbox{ range.baseVertex * vertexStride_, 0, 0, (range.baseVertex + vertexCount) * vertexStride_, 1, 1 };
+        ctx->UpdateSubresource(state_->vertexBuffer.Get(), 0, &vbox, vertices, 0, 0);
+        const D3D11_BOX ibox{ range.startIndex * static_cast<UINT>(sizeof(uint16_t)), 0, 0,
+                              (range.startIndex + indexCount) * static_cast<UINT>(sizeof(uint16_t)), 1, 1 };
+        ctx->UpdateSubresource(state_->indexBuffer.Get(), 0, &ibox, indices, 0, 0);
+        return MakeHandle(range);
+    }
+
+    /**
+     * @brief 作成済みの頂点・インデックスバッファ(16ビット)の内容をGPU上で複写して割り当てる
+     * @param[in] vertexBuffer 先頭から vertexCount 個の頂点を持つバッファ
+     * @param[in] indexBuffer 先頭から indexCount 個の16ビットインデックスを持つバッファ
+     * @return MeshPoolHandle 割り当てた範囲(割り当てられない場合は空。元のバッファはそのまま使える)
+     *
+     * @details
+     * ワーカースレッドで作成したバッファを、メインスレッドで共有バッファへ移すために使います。
+     */
+    MeshPoolHandle CopyFrom(ID3D11DeviceContext* ctx, ID3D11Buffer* vertexBuffer, UINT vertexCount, ID3D11Buffer* indexBuffer, UINT indexCount) {
+        if (!vertexBuffer || !indexBuffer) return nullptr;
+        MeshPoolRange range;
+        if (!Reserve(ctx, vertexCount, indexCount, range)) return nullptr;
+
+        const D3D11_BOX vbox{ 0, 0, 0, vertexCount * vertexStride_, 1, 1 };
+        ctx->CopySubresourceRegion(state_->vertexBuffer.Get(), 0, range.baseVertex * vertexStride_, 0, 0, vertexBuffer, 0, &vbox);
+        const D3D11_BOX ibox{ 0, 0, 0, indexCount * static_cast<UINT>(sizeof(uint16_t)), 1, 1 };
+        ctx->CopySubresourceRegion(state_->indexBuffer.Get(), 0, range.startIndex * static_cast<UINT>(sizeof(uint16_t)), 0, 0, indexBuffer, 0, &ibox);
+        return MakeHandle(range);
+    }
+
+    /**
+     * @brief 共有頂点バッファ(拡張すると変わる)
+     */
+    ID3D11Buffer* VertexBuffer() const { return state_ ? state_->vertexBuffer.Get() : nullptr; }
+
+    /**
+     * @brief 共有インデックスバッファ(拡張すると変わる)
+     */
+    ID3D11Buffer* IndexBuffer() const { return state_ ? state_->indexBuffer.Get() : nullptr; }
+
+    Statistics GetStatistics() const {
+        Statistics stats;
+        if (!state_) return stats;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        stats.meshes = state_->meshes;
+        stats.vertices = state_->vertices.Used();
+        stats.vertexCapacity = state_->vertices.capacity;
+        stats.indices = state_->indices.Used();
+        stats.indexCapacity = state_->indices.capacity;
+        stats.freeSpans = state_->vertices.spans.size() + state_->indices.spans.size();
+        stats.grows = state_->grows;
+        return stats;
+    }
+
+    /**
+     * @brief GPUメモリの使用量(バイト、容量で数える)
+     */
+    size_t GpuMemoryBytes() const {
+        if (!state_) return 0;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return static_cast<size_t>(state_->vertices.capacity) * vertexStride_ + static_cast<size_t>(state_->indices.capacity) * sizeof(uint16_t);
+    }
+
+    /**
+     * @brief バッファを解放(残っているハンドルは以降も安全に破棄できる)
+     */
+    void Shutdown() {
+        if (!state_) return;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->vertexBuffer.Reset();
+        state_->indexBuffer.Reset();
+        state_->device = nullptr;
+        state_.reset();
+    }
+
+private:
+    /**
+     * @struct Span
+     * @brief 空き領域 [first, first + count)
+     */
+    struct Span {
+        UINT first;
+        UINT count;
+    };
+
+    /**
+     * @struct FreeList
+     * @brief 位置順に並べた空き領域(先頭から最初に収まる位置に割り当て)
+     */
+    struct FreeList {
+        std::vector<Span> spans;
+        UINT capacity = 0;
+        UINT free = 0;
+
+        void Reset(UINT newCapacity) {
+            spans.assign(1, Span{ 0, newCapacity });
+            capacity = newCapacity;
+            free = newCapacity;
+        }
+
+        size_t Used() const { return capacity - free; }
+
+        bool Allocate(UINT count, UINT& first) {
+            for (size_t i = 0; i < spans.size(); ++i) {
+                Span& span = spans[i];
+                if (span.count < count) continue;
+                first = span.first;
+                span.first += count;
+                span.count -= count;
+                if (span.count == 0) spans.erase(spans.begin() + static_cast<ptrdiff_t>(i));
+                free -= count;
+                return true;
+            }
+            return false;
+        }
+
+        void Free(UINT first, UINT count) {
+            if (count == 0) return;
+            auto it = std::lower_bound(spans.begin(), spans.end(), first, [](const Span& s, UINT v) { return s.first < v; });
+            it = spans.insert(it, Span{ first, count });
+            free += count;
+            // 後ろと結合してから前と結合
+            auto next = it + 1;
+            if (next != spans.end() && it->first + it->count == next->first) {
+                it->count += next->count;
+                spans.erase(next);
+            }
+            if (it != spans.begin()) {
+                auto prev = it - 1;
+                if (prev->first + prev->count == it->first) {
+                    prev->count += it->count;
+                    spans.erase(it);
+                }
+            }
+        }
+
+        /**
+         * @brief 容量を広げ、増えた分を空き領域に加える
+         */
+        void Grow(UINT newCapacity) {
+            Free(capacity, newCapacity - capacity);
+            capacity = newCapacity;
+        }
+
+        /**
+         * @brief count 個を割り当てるのに必要な容量(末尾の空き領域も使う)
+         */
+        UINT RequiredCapacity(UINT count) const {
+            UINT tail = 0;
+            if (!spans.empty() && spans.back().first + spans.back().count == capacity) tail = spans.back().count;
+            return capacity + (count - tail);
+        }
+    };
+
+    /**
+     * @struct State
+     * @brief ハンドルと共有する状態(プールの破棄後に返却されても安全なように分けて持つ)
+     */
+    struct State {
+        std::mutex mutex;
+        ID3D11Device* device = nullptr;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+        FreeList vertices;
+        FreeList indices;
+        size_t meshes = 0;
+        size_t grows = 0;
+    };
+
+    static bool CreateBuffer(ID3D11Device* device, UINT bindFlags, UINT byteWidth, Microsoft::WRL::ComPtr<ID3D11Buffer>& out) {
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = bindFlags;
+        bd.ByteWidth = byteWidth;
+        HRESULT hr = device->CreateBuffer(&bd, nullptr, out.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[MeshPool] バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ", " + std::to_string(byteWidth) + " バイト)");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief バッファを newCapacity 要素に作り直し、使用中の内容を複写
+     */
+    static bool GrowBuffer(State& state, ID3D11DeviceContext* ctx, FreeList& list, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer,
+                           UINT bindFlags, UINT stride, UINT required) {
+        UINT newCapacity = (std::max)(list.capacity * 2, required);
+        Microsoft::WRL::ComPtr<ID3D11Buffer> grown;
+        if (!CreateBuffer(state.device, bindFlags, newCapacity * stride, grown)) return false;
+        ctx->CopySubresourceRegion(grown.Get(), 0, 0, 0, 0, buffer.Get(), 0, nullptr);
+        buffer = grown;
+        list.Grow(newCapacity);
+        state.grows++;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[MeshPool] " + std::string(bindFlags == D3D11_BIND_VERTEX_BUFFER ? "頂点" : "インデックス") +
+                          "バッファを拡張: " + std::to_string(newCapacity) + " 要素");
+        return true;
+    }
+
+    /**
+     * @brief 範囲を確保(必要ならバッファを拡張)
+     */
+    bool Reserve(ID3D11DeviceContext* ctx, UINT vertexCount, UINT indexCount, MeshPoolRange& range) {
+        if (!state_ || vertexCount == 0 || indexCount == 0 || vertexCount > MAX_MESH_VERTICES) return false;
+        State& state = *state_;
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        UINT baseVertex = 0;
+        if (!state.vertices.Allocate(vertexCount, baseVertex)) {
+            if (!GrowBuffer(state, ctx, state.vertices, state.vertexBuffer, D3D11_BIND_VERTEX_BUFFER, vertexStride_, state.vertices.RequiredCapacity(vertexCount)) ||
+                !state.vertices.Allocate(vertexCount, baseVertex)) {
+                return false;
+            }
+        }
+        UINT startIndex = 0;
+        if (!state.indices.Allocate(indexCount, startIndex)) {
+            if (!GrowBuffer(state, ctx, state.indices, state.indexBuffer, D3D11_BIND_INDEX_BUFFER, sizeof(uint16_t), state.indices.RequiredCapacity(indexCount)) ||
+                !state.indices.Allocate(indexCount, startIndex)) {
+                state.vertices.Free(baseVertex, vertexCount);
+                return false;
+            }
+        }
+
+        range.baseVertex = baseVertex;
+        range.vertexCount = vertexCount;
+        range.startIndex = startIndex;
+        range.indexCount = indexCount;
+        state.meshes++;
+        return true;
+    }
+
+    MeshPoolHandle MakeHandle(const MeshPoolRange& range) {
+        std::shared_ptr<State> state = state_;
+        return MeshPoolHandle(new MeshPoolRange(range), [state](const MeshPoolRange* r) {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->vertices.Free(r->baseVertex, r->vertexCount);
+                state->indices.Free(r->startIndex, r->indexCount);
+                state->meshes--;
+            }
+            delete r;
+        });
+    }
+
+    std::shared_ptr<State> state_;
+    UINT vertexStride_ = VERTEX_STRIDE;
+};
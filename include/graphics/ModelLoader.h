@@ -7,24 +7,93 @@
 #include "components/ModelComponent.h"
 #include "graphics/GfxDevice.h"
 #include "graphics/TextureManager.h"
+#include "graphics/VertexFormat.h"
 #include "app/DebugLog.h"
 
+struct Skeleton;
+struct SkinnedModelData;
+class JobSystem;
+
 class ModelLoader {
 public:
+    /**
+     * @struct LoadedModel
+     * @brief テクスチャ未解決の読み込み結果(メッシュごとのテクスチャパスを持つ)
+     */
+    struct LoadedModel {
+        std::vector<ModelComponent> meshes;     ///< テクスチャ以外を設定済みのメッシュ
+        std::vector<std::string> diffusePaths;  ///< meshes と同順のディフューズテクスチャのパス
+        std::vector<std::string> normalPaths;   ///< meshes と同順のノーマルマップのパス
+    };
+
+    /**
+     * @struct LoadTimings
+     * @brief LoadGeometry の段階ごとの所要時間(ミリ秒、読み込み時間の計測用)
+     */
+    struct LoadTimings {
+        bool fromCache = false;      ///< 変換済みキャッシュ(.meshcache)から読み込んだか
+        double cacheReadMs = 0.0;    ///< キャッシュの検証とマップ(キャッシュがない場合は存在確認のみ)
+        double parseMs = 0.0;        ///< Assimp でのファイルの読み込みと解析
+        double postProcessMs = 0.0;  ///< Assimp のポストプロセス(三角形化・法線・接線・頂点の結合など)
+        double convertMs = 0.0;      ///< 頂点形式への変換と LOD の生成
+        double cacheWriteMs = 0.0;   ///< キャッシュへの書き出し
+        double uploadMs = 0.0;       ///< 頂点・インデックスバッファの作成
+        size_t vertexCount = 0;      ///< LOD0 の頂点数の合計
+        size_t indexCount = 0;       ///< LOD0 のインデックス数の合計
+    };
+
+    // 読み込んでテクスチャまで解決する(メインスレッド専用)
+    // ボーンを持つメッシュはスキニングの影響(ModelComponent::skinBuffer)とスケルトン・クリップ(ModelComponent::skinData)も読み込む
     static std::vector<ModelComponent> LoadModel(const std::string& filePath);
 
+    // ジオメトリとGPUバッファだけを読み込む(TextureManager を使わないためワーカースレッドから呼び出し可)
+    // timings を渡すと段階ごとの所要時間を記録する
+    static bool LoadGeometry(const std::string& filePath, LoadedModel& out, LoadTimings* timings = nullptr);
+
+    /**
+     * @enum CookResult
+     * @brief CookCache の結果
+     */
+    enum class CookResult {
+        Written,  ///< .meshcache を書き出した
+        Skinned,  ///< スキニングされたモデル(キャッシュを持たないため実行時も Assimp で読み込む)
+        Failed    ///< 読み込み・書き出しの失敗
+    };
+
+    // Assimp で読み込んで .meshcache だけを書き出す(GPU バッファを作らないため D3D11 デバイスは不要。アセットの事前変換用)
+    // 現在の SetMergeByMaterial の設定で変換し、SetJobSystem があればメッシュの変換をワーカーに分ける
+    static CookResult CookCache(const std::string& filePath);
+
+    // 既存の .meshcache の元ファイルの記録(サイズ・更新日時)を現在の元ファイルに合わせる
+    // 内容が変わっていないと分かっている場合だけ呼ぶ(変換し直さずに実行時の鮮度判定を通すため)
+    static bool RestampCache(const std::string& filePath);
+
+    // LoadGeometry の結果のテクスチャを TextureManager で読み込み、メッシュを共有メッシュバッファ(GfxDevice::Meshes())へ移す(メインスレッド専用)
+    static void ResolveTextures(LoadedModel& model);
+
+    // 以降に読み込むモデルの頂点形式(既定は Standard。キャッシュは標準形式のまま、バッファ作成時に変換する)
+    // 読み込み済みのモデルには影響しない。ワーカースレッドでの読み込み中に変更してもよい(次のモデルから反映)
+    static void SetVertexFormat(VertexFormat format);
+    static VertexFormat GetVertexFormat();
+
+    // 同じマテリアルの静的なメッシュを1つのメッシュ(頂点・インデックスの範囲)に結合するか(既定 true)
+    // false の場合はノードのメッシュごとに ModelComponent を作る(変換の焼き込みは同じ)。キャッシュは設定ごとに作り直す
+    static void SetMergeByMaterial(bool merge);
+    static bool IsMergeByMaterial();
+
+    // 1モデル内のメッシュの変換とバッファ作成を分けるジョブシステム(nullptr なら呼び出したスレッドで順に処理、所有しない)
+    // ワーカーで実行中の LoadGeometry からも使える(完了を待つ間は呼び出したスレッドもジョブを実行する)
+    static void SetJobSystem(JobSystem* jobs);
+
 private:
-    static void ProcessMesh(
-        std::vector<ModelComponent>& modelComponents,
-        aiMesh* mesh,
-        const aiScene* scene,
-        const std::string& directory,
-        GfxDevice& gfx
-    );
+    struct CookedMesh;
+
+    static bool ImportAndCook(const std::string& filePath, bool mergeByMaterial, std::vector<CookedMesh>& cooked,
+                              std::shared_ptr<SkinnedModelData>& skinData, size_t& sourceMeshCount, LoadTimings& t);
 
-    static TextureManager::TextureHandle LoadMaterialTextures(
+    static std::string FindMaterialTexture(
         aiMaterial* mat,
         aiTextureType type,
         const std::string& directory
     );
-};
\ No newline at end of file
+};
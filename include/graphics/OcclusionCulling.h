@@ -0,0 +1,289 @@
+/**
+ * @file OcclusionCulling.h
+ * @brief 遮蔽物のソフトウェアラスタライズと階層Zバッファ(HZB)による遮蔽カリング
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 画面に大きく映る遮蔽物(オクルーダー)の三角形を低解像度の深度バッファにCPUでラスタライズし、
+ * 2x2 の最大値で縮小したミップ(HZB)を作ります。描画対象の境界球は、画面上の矩形が2x2テクセルに収まるレベルで
+ * 矩形の最大深度と球の最も手前の深度を比べ、遮蔽物より奥なら除外します。
+ *
+ * 遮蔽物の側を小さく見積もるため、判定は保守的です(見えているものを除外しない)。
+ * - 三角形の深度は3頂点の最も奥の値で書き込む
+ * - ニアクリップ面をまたぐ三角形と裏面は書き込まない
+ * - 境界球はそれを囲むAABBの8頂点で投影し、ニアクリップ面をまたぐものは常に可視とする
+ *
+ * 被覆はピクセル中心で判定するため、遮蔽物の輪郭では1ピクセル(画面の 1/256)未満の誤差があります。
+ *
+ * 遮蔽物は同じフレームのものをラスタライズするため、GPUの読み戻しやフレームの遅れはありません。
+ * ラスタライズは1行4ピクセルずつSIMD(DirectXMath)で辺関数を評価します。
+ */
+#pragma once
+#include "graphics/FrustumCulling.h"
+#include "app/JobSystem.h"
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @class OcclusionBuffer
+ * @brief 遮蔽物の深度バッファと階層Zバッファ
+ *
+ * @par 使用例
+ * @code
+ * occlusion.Begin(cam.ViewProj);
+ * occlusion.AddOccluder(&vertices[0].pos, sizeof(Vertex), indices.data(), indices.size(), world);
+ * occlusion.BuildHierarchy();
+ * size_t occluded = occlusion.Cull(cull, jobs); // cull.Run() で可視になったものを判定し直す
+ * @endcode
+ */
+class OcclusionBuffer {
+public:
+    static constexpr uint32_t WIDTH = 256;   ///< 深度バッファの幅(4の倍数、2の累乗)
+    static constexpr uint32_t HEIGHT = 128;  ///< 深度バッファの高さ(2の累乗)
+
+    OcclusionBuffer() {
+        uint32_t w = WIDTH, h = HEIGHT;
+        size_t offset = 0;
+        while (true) {
+            levels_.push_back(Level{ w, h, offset });
+            offset += static_cast<size_t>(w) * h;
+            if (w == 1 && h == 1) break;
+            w = (std::max)(w / 2, 1u);
+            h = (std::max)(h / 2, 1u);
+        }
+        depth_.assign(offset, 1.0f);
+    }
+
+    /**
+     * @brief 深度バッファを奥(1.0)で埋め、このフレームのビュー・プロジェクション行列を設定
+     */
+    void Begin(const DirectX::XMMATRIX& viewProj) {
+        DirectX::XMStoreFloat4x4(&viewProj_, viewProj);
+        std::fill(depth_.begin(), depth_.begin() + static_cast<size_t>(WIDTH) * HEIGHT, 1.0f);
+        occluders_ = 0;
+        triangles_ = 0;
+        built_ = false;
+    }
+
+    /**
+     * @brief 遮蔽物のメッシュをラスタライズ
+     * @param[in] positions 先頭頂点の位置
+     * @param[in] stride 頂点間のバイト数
+     * @param[in] indices 三角形リストのインデックス
+     * @param[in] indexCount インデックス数
+     * @param[in] world ワールド行列
+     *
+     * @details
+     * 遮蔽物は閉じた不透明なメッシュを想定しています(表面だけを書き込むため、平面は表からのみ遮蔽します)。
+     * 詳細なメッシュほど正確ですが、LODの粗いメッシュでも頂点が元の表面上にあれば内側に収まるため保守的です。
+     */
+    void AddOccluder(const DirectX::XMFLOAT3* positions, size_t stride, const uint16_t* indices, size_t indexCount,
+                     const DirectX::XMMATRIX& world) {
+        using namespace DirectX;
+        if (!positions || !indices || indexCount < 3) return;
+
+        const XMMATRIX worldViewProj = world * XMLoadFloat4x4(&viewProj_);
+        const unsigned char* base = reinterpret_cast<const unsigned char*>(positions);
+        for (size_t t = 0; t + 2 < indexCount; t += 3) {
+            XMFLOAT4 v[3];
+            bool clipped = false;
+            for (int k = 0; k < 3; ++k) {
+                const XMFLOAT3& p = *reinterpret_cast<const XMFLOAT3*>(base + static_cast<size_t>(indices[t + k]) * stride);
+                XMFLOAT4 clip;
+                XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&p), worldViewProj));
+                if (clip.w <= NEAR_W || clip.z < 0.0f) {
+                    clipped = true;
+                    break;
+                }
+                const float invW = 1.0f / clip.w;
+                v[k] = XMFLOAT4{ (clip.x * invW * 0.5f + 0.5f) * WIDTH, (0.5f - clip.y * invW * 0.5f) * HEIGHT, clip.z * invW, 0.0f };
+            }
+            if (!clipped) rasterizeTriangle(v[0], v[1], v[2]);
+        }
+        occluders_++;
+    }
+
+    /**
+     * @brief 深度バッファから2x2の最大値でミップを作成(Cull() の前に1回呼ぶ)
+     */
+    void BuildHierarchy() {
+        for (size_t l = 1; l < levels_.size(); ++l) {
+            const Level& src = levels_[l - 1];
+            const Level& dst = levels_[l];
+            for (uint32_t y = 0; y < dst.height; ++y) {
+                const uint32_t y0 = (std::min)(y * 2, src.height - 1);
+                const uint32_t y1 = (std::min)(y * 2 + 1, src.height - 1);
+                for (uint32_t x = 0; x < dst.width; ++x) {
+                    const uint32_t x0 = (std::min)(x * 2, src.width - 1);
+                    const uint32_t x1 = (std::min)(x * 2 + 1, src.width - 1);
+                    const float d = (std::max)((std::max)(at(src, x0, y0), at(src, x1, y0)), (std::max)(at(src, x0, y1), at(src, x1, y1)));
+                    depth_[dst.offset + static_cast<size_t>(y) * dst.width + x] = d;
+                }
+            }
+        }
+        built_ = true;
+    }
+
+    /**
+     * @brief 境界球が遮蔽物に完全に隠れているか(BuildHierarchy() の後に使用)
+     * @param[in] sphere ワールド空間の境界球 (中心x, y, z, 半径。半径0以下・FLT_MAX は境界不明として可視)
+     */
+    bool IsOccluded(const DirectX::XMFLOAT4& sphere) const {
+        using namespace DirectX;
+        if (!built_ || occluders_ == 0 || sphere.w <= 0.0f || sphere.w >= FLT_MAX) return false;
+
+        const XMMATRIX viewProj = XMLoadFloat4x4(&viewProj_);
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+        for (int c = 0; c < 8; ++c) {
+            const XMVECTOR corner = XMVectorSet(sphere.x + ((c & 1) ? sphere.w : -sphere.w),
+                                                sphere.y + ((c & 2) ? sphere.w : -sphere.w),
+                                                sphere.z + ((c & 4) ? sphere.w : -sphere.w), 1.0f);
+            XMFLOAT4 clip;
+            XMStoreFloat4(&clip, XMVector4Transform(corner, viewProj));
+            if (clip.w <= NEAR_W || clip.z < 0.0f) return false; // ニアクリップ面をまたぐ
+            const float invW = 1.0f / clip.w;
+            const float x = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+            const float y = (0.5f - clip.y * invW * 0.5f) * HEIGHT;
+            minX = (std::min)(minX, x);
+            maxX = (std::max)(maxX, x);
+            minY = (std::min)(minY, y);
+            maxY = (std::max)(maxY, y);
+            minZ = (std::min)(minZ, clip.z * invW);
+        }
+
+        // 画面外にはみ出す部分は遮蔽物がないものとして扱う
+        if (minX < 0.0f || minY < 0.0f || maxX >= static_cast<float>(WIDTH) || maxY >= static_cast<float>(HEIGHT)) return false;
+
+        uint32_t x0 = static_cast<uint32_t>(minX), x1 = static_cast<uint32_t>(maxX);
+        uint32_t y0 = static_cast<uint32_t>(minY), y1 = static_cast<uint32_t>(maxY);
+        size_t level = 0;
+        while (level + 1 < levels_.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+            ++level;
+        }
+        const Level& l = levels_[level];
+        float maxDepth = 0.0f;
+        for (uint32_t y = y0 >> level; y <= (y1 >> level); ++y) {
+            for (uint32_t x = x0 >> level; x <= (x1 >> level); ++x) {
+                maxDepth = (std::max)(maxDepth, at(l, (std::min)(x, l.width - 1), (std::min)(y, l.height - 1)));
+            }
+        }
+        return minZ > maxDepth;
+    }
+
+    /**
+     * @brief 可視と判定済みの境界球を判定し直し、隠れているものを不可視にする
+     * @param[in,out] list SphereCullList::Run() 済みのリスト
+     * @param[in] jobs ジョブシステム(nullptr可、件数が多い場合に並列化)
+     * @return size_t 隠れていた件数
+     */
+    size_t Cull(SphereCullList& list, JobSystem* jobs) const {
+        const size_t n = list.Size();
+        if (!built_ || occluders_ == 0 || n == 0) return 0;
+
+        auto cullRange = [this, &list](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (list.Visible(i) && IsOccluded(list.Sphere(i))) list.Hide(i);
+            }
+        };
+
+        const size_t before = list.VisibleCount();
+        if (jobs && jobs->IsRunning() && n >= SphereCullList::PARALLEL_THRESHOLD) {
+            jobs->ParallelFor(n, SphereCullList::GRAIN_SIZE, cullRange);
+        } else {
+            cullRange(0, n);
+        }
+        return before - list.VisibleCount();
+    }
+
+    size_t OccluderCount() const { return occluders_; }
+    size_t TriangleCount() const { return triangles_; }
+
+    /**
+     * @brief CPUメモリの使用量(バイト)
+     */
+    size_t MemoryBytes() const { return depth_.capacity() * sizeof(float); }
+
+private:
+    static constexpr float NEAR_W = 1e-4f; ///< これ以下の w はニアクリップ面の手前として扱う
+
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        size_t offset;   ///< depth_ 内の先頭
+    };
+
+    float at(const Level& l, uint32_t x, uint32_t y) const {
+        return depth_[l.offset + static_cast<size_t>(y) * l.width + x];
+    }
+
+    // 画面座標(y は下向き)の三角形をピクセル中心で判定し、3頂点の最も奥の深度で書き込む
+    void rasterizeTriangle(const DirectX::XMFLOAT4& v0, const DirectX::XMFLOAT4& v1, const DirectX::XMFLOAT4& v2) {
+        using namespace DirectX;
+
+        // 時計回り(CULL_BACK, FrontCounterClockwise = FALSE の表面)は y が下向きの画面座標で面積が正
+        const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (area <= 0.0f) return;
+
+        const float fminX = (std::min)(v0.x, (std::min)(v1.x, v2.x));
+        const float fmaxX = (std::max)(v0.x, (std::max)(v1.x, v2.x));
+        const float fminY = (std::min)(v0.y, (std::min)(v1.y, v2.y));
+        const float fmaxY = (std::max)(v0.y, (std::max)(v1.y, v2.y));
+        if (fmaxX < 0.0f || fmaxY < 0.0f || fminX >= static_cast<float>(WIDTH) || fminY >= static_cast<float>(HEIGHT)) return;
+
+        const int minX = (std::max)(static_cast<int>(fminX), 0) & ~3;
+        const int maxX = (std::min)(static_cast<int>(fmaxX), static_cast<int>(WIDTH) - 1);
+        const int minY = (std::max)(static_cast<int>(fminY), 0);
+        const int maxY = (std::min)(static_cast<int>(fmaxY), static_cast<int>(HEIGHT) - 1);
+        const float z = (std::min)((std::max)(v0.z, (std::max)(v1.z, v2.z)), 1.0f);
+        triangles_++;
+
+        // 辺 a->b: E(p) = (b.x - a.x)(p.y - a.y) - (b.y - a.y)(p.x - a.x) = A * p.x + B * p.y + C
+        const XMFLOAT4* vs[3] = { &v0, &v1, &v2 };
+        XMVECTOR edgeA[3], edgeRow[3];
+        float edgeB[3];
+        const XMVECTOR offsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+        for (int e = 0; e < 3; ++e) {
+            const XMFLOAT4& a = *vs[e];
+            const XMFLOAT4& b = *vs[(e + 1) % 3];
+            const float A = -(b.y - a.y);
+            const float B = b.x - a.x;
+            const float C = -(A * a.x + B * a.y);
+            edgeA[e] = XMVectorReplicate(A * 4.0f);
+            // 行の先頭4ピクセル(minX + 0.5 ... + 3.5, minY + 0.5)の値
+            edgeRow[e] = XMVectorAdd(XMVectorScale(XMVectorAdd(XMVectorReplicate(static_cast<float>(minX)), offsets), A),
+                                     XMVectorReplicate(B * (static_cast<float>(minY) + 0.5f) + C));
+            edgeB[e] = B;
+        }
+
+        const XMVECTOR zero = XMVectorZero();
+        const XMVECTOR depth = XMVectorReplicate(z);
+        for (int y = minY; y <= maxY; ++y) {
+            XMVECTOR e0 = edgeRow[0], e1 = edgeRow[1], e2 = edgeRow[2];
+            float* row = &depth_[static_cast<size_t>(y) * WIDTH];
+            for (int x = minX; x <= maxX; x += 4) {
+                const XMVECTOR inside = XMVectorAndInt(XMVectorGreaterOrEqual(e0, zero),
+                                                       XMVectorAndInt(XMVectorGreaterOrEqual(e1, zero), XMVectorGreaterOrEqual(e2, zero)));
+                const XMVECTOR current = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x));
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + x), XMVectorSelect(current, XMVectorMin(current, depth), inside));
+                e0 = XMVectorAdd(e0, edgeA[0]);
+                e1 = XMVectorAdd(e1, edgeA[1]);
+                e2 = XMVectorAdd(e2, edgeA[2]);
+            }
+            for (int e = 0; e < 3; ++e) edgeRow[e] = XMVectorAdd(edgeRow[e], XMVectorReplicate(edgeB[e]));
+        }
+    }
+
+    DirectX::XMFLOAT4X4 viewProj_{};
+    std::vector<Level> levels_;      ///< 0 が深度バッファ、以降は2x2の最大値で縮小したミップ
+    std::vector<float> depth_;       ///< 全レベルの深度(levels_[i].offset から)
+    size_t occluders_ = 0;           ///< このフレームの遮蔽物の数
+    size_t triangles_ = 0;           ///< このフレームに書き込んだ三角形の数
+    bool built_ = false;             ///< BuildHierarchy() 済みか
+};
@@ -0,0 +1,864 @@
+/**
+ * @file ParticleSystem.h
+ * @brief コンピュートシェーダーによるGPUパーティクル
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 粒子の状態はGPUのバッファだけに置き、放出・移動・寿命の判定・描画をすべてGPUで行います。
+ * CPUは放出元ごとの「このフレームに何個出すか」だけを計算するため、粒子数が増えてもCPUの負荷は変わりません。
+ *
+ * ### 1フレームの流れ:
+ * 1. 放出(Emit CS): 放出元の表を読み、空きリスト(Consume)から番号を取り出して粒子を初期化し、生存リストに追加
+ * 2. 引数(Args CS): 生存リストの数から移動パスの DispatchIndirect の引数を作る
+ * 3. 移動(Simulate CS): 生存リストを読み、寿命が残る粒子はもう一方の生存リストへ、尽きた粒子は空きリストへ戻す(詰め直し)
+ * 4. 描画: 詰め直した生存リストの数を DrawInstancedIndirect の引数に写し、粒子1つを1インスタンスのビルボードで描く
+ *
+ * 生存数はCPUに読み戻しません(リストの数は CopyStructureCount で定数バッファと間接引数に写します)。
+ * 描画は加算合成のため並べ替えは不要で、深度は読むだけです。
+ *
+ * ### シェーダーリソース:
+ * - Emit CS: t0 放出元, u0 粒子, u1 空きリスト(Consume), u2 生存リスト(Append)
+ * - Simulate CS: t0 生存リスト(入力), u0 粒子, u1 生存リスト(出力、Append), u2 空きリスト(Append)
+ * - 描画 VS: t0 粒子, t1 生存リスト
+ *
+ * @note コンピュートシェーダー(cs_5_0)を使うため、機能レベル 11_0 未満のデバイスでは Init() が失敗します
+ */
+#pragma once
+#include "graphics/Camera.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/GfxDevice.h"
+#include "components/ParticleEmitter.h"
+#include "ecs/Entity.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+/**
+ * @struct GpuParticleEmitter
+ * @brief 放出パスに渡す放出元1つ(HLSL側と同じレイアウト、112バイト)
+ */
+struct GpuParticleEmitter {
+    DirectX::XMFLOAT3 position;      ///< ワールド空間の位置
+    uint32_t firstThread;            ///< この放出元が担当する最初のスレッド(放出数の累積)
+    DirectX::XMFLOAT3 direction;     ///< ワールド空間の放出方向(正規化済み)
+    float cosSpread;                 ///< 放出方向からの最大の角度の cos
+    DirectX::XMFLOAT3 acceleration;  ///< ワールド空間の加速度
+    float drag;                      ///< 速度の減衰(毎秒の割合)
+    DirectX::XMFLOAT4 startColor;    ///< 放出時の色
+    DirectX::XMFLOAT4 endColor;      ///< 寿命の終わりの色
+    float lifetimeMin;               ///< 寿命の最小
+    float lifetimeMax;               ///< 寿命の最大
+    float speedMin;                  ///< 初速の最小
+    float speedMax;                  ///< 初速の最大
+    float startSize;                 ///< 放出時の大きさ
+    float endSize;                   ///< 寿命の終わりの大きさ
+    float spawnRadius;               ///< 放出位置のばらつき
+    uint32_t count;                  ///< このフレームの放出数
+};
+static_assert(sizeof(GpuParticleEmitter) == 112, "GpuParticleEmitter must match the HLSL layout");
+
+/**
+ * @class ParticleSystem
+ * @brief GPUパーティクルのバッファとパスの管理
+ *
+ * @par 使用例
+ * @code
+ * particles.Init(device, compileFlags);
+ *
+ * // 毎フレーム
+ * particles.BeginFrame();
+ * particles.AddEmitter(entity, emitter, worldMatrix);
+ * particles.Simulate(device, ctx);
+ * particles.Draw(ctx, cam);
+ * @endcode
+ */
+class ParticleSystem {
+public:
+    static constexpr uint32_t MAX_PARTICLES = 1u << 17;     ///< 同時に存在できる粒子数
+    static constexpr uint32_t EMIT_GROUP_SIZE = 64;         ///< 放出パスのスレッドグループの大きさ
+    static constexpr uint32_t SIMULATE_GROUP_SIZE = 256;    ///< 移動パスのスレッドグループの大きさ
+    static constexpr float MAX_DELTA_TIME = 0.1f;           ///< 1フレームで進める最大の時間(秒、停止からの復帰で一度に進めない)
+
+    ParticleSystem() = default;
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+    ParticleSystem(ParticleSystem&&) noexcept = default;
+    ParticleSystem& operator=(ParticleSystem&&) noexcept = default;
+
+    /**
+     * @brief シェーダーのコンパイルとバッファ・ステートの作成
+     * @return bool 成功した場合 true(失敗した場合は何も描画しない)
+     */
+    bool Init(ID3D11Device* device, UINT compileFlags) {
+        Shutdown();
+        if (device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+            DEBUGLOG_WARNING("[ParticleSystem] 機能レベル 11_0 未満のためコンピュートシェーダーを使えません");
+            return false;
+        }
+        if (!compileShaders(device, compileFlags) || !createBuffers(device) || !createStates(device)) {
+            Shutdown();
+            return false;
+        }
+        resetPending_ = true;
+        ready_ = true;
+        lastFrame_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool IsReady() const { return ready_; }
+
+    /**
+     * @brief 放出数の倍率(連続放出の割合とバーストの数に掛ける。品質を下げる時に使う、既定 1)
+     */
+    void SetEmissionScale(float scale) { emissionScale_ = (std::min)((std::max)(scale, 0.0f), 1.0f); }
+    float EmissionScale() const { return emissionScale_; }
+
+    /**
+     * @brief フレームの開始(経過時間を測り、放出元の表を空にする)
+     * @return float このフレームで進める時間(秒、MAX_DELTA_TIME で頭打ち)
+     */
+    float BeginFrame() {
+        const auto now = std::chrono::steady_clock::now();
+        deltaTime_ = (std::min)(std::chrono::duration<float>(now - lastFrame_).count(), MAX_DELTA_TIME);
+        lastFrame_ = now;
+        emitters_.clear();
+        emitTotal_ = 0;
+        ++frame_;
+
+        // このフレームまでに一度も見つからなかった放出元の記録を捨てる
+        for (auto it = states_.begin(); it != states_.end();) {
+            if (it->second.frame + 1 < frame_) it = states_.erase(it);
+            else ++it;
+        }
+        return deltaTime_;
+    }
+
+    /**
+     * @brief 放出元を追加(このフレームの放出数を計算し、0 なら何もしない)
+     * @param[in] e 放出元のエンティティ(端数とバーストの記録に使う)
+     * @param[in] emitter 設定
+     * @param[in] world 放出元のワールド行列
+     */
+    void AddEmitter(Entity e, const ParticleEmitter& emitter, const DirectX::XMMATRIX& world) {
+        if (!ready_) return;
+        EmitterState& state = states_[e.Packed()];
+        state.frame = frame_;
+
+        uint32_t count = 0;
+        if (emitter.enabled && emitter.rate > 0.0f) {
+            state.carry += emitter.rate * emissionScale_ * deltaTime_;
+            const float whole = std::floor(state.carry);
+            state.carry -= whole;
+            count = static_cast<uint32_t>((std::min)(whole, static_cast<float>(MAX_PARTICLES)));
+        }
+        if (emitter.burstId != state.burstId) {
+            state.burstId = emitter.burstId;
+            const uint32_t burst = static_cast<uint32_t>(std::ceil(static_cast<float>(emitter.burstCount) * emissionScale_));
+            count += (std::min)(burst, MAX_PARTICLES);
+        }
+
+        // 1フレームの放出は空きの最大数まで(GPU側でも実際の空きの数で打ち切る)
+        count = (std::min)(count, MAX_PARTICLES - emitTotal_);
+        if (count == 0) return;
+
+        GpuParticleEmitter g{};
+        DirectX::XMStoreFloat3(&g.position, world.r[3]);
+        DirectX::XMVECTOR direction = DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&emitter.direction), world);
+        if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(direction)) < 1e-12f) direction = DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+        DirectX::XMStoreFloat3(&g.direction, DirectX::XMVector3Normalize(direction));
+        g.firstThread = emitTotal_;
+        g.cosSpread = std::cos(DirectX::XMConvertToRadians((std::min)((std::max)(emitter.spreadAngle, 0.0f), 180.0f)));
+        g.acceleration = emitter.acceleration;
+        g.drag = (std::max)(emitter.drag, 0.0f);
+        g.startColor = emitter.startColor;
+        g.endColor = emitter.endColor;
+        g.lifetimeMin = (std::max)(emitter.lifetimeMin, 0.0f);
+        g.lifetimeMax = (std::max)(emitter.lifetimeMax, g.lifetimeMin);
+        g.speedMin = emitter.speedMin;
+        g.speedMax = emitter.speedMax;
+        g.startSize = emitter.startSize;
+        g.endSize = emitter.endSize;
+        g.spawnRadius = (std::max)(emitter.spawnRadius, 0.0f);
+        g.count = count;
+        emitters_.push_back(g);
+        emitTotal_ += count;
+    }
+
+    /**
+     * @brief 放出・移動・詰め直しのパスを実行(描画の前に1回)
+     */
+    void Simulate(ID3D11Device* device, ID3D11DeviceContext* ctx) {
+        if (!ready_) return;
+
+        // 空きの数(初期化直後はカウンタがまだないため、バインド時に設定する値をそのまま書く)
+        if (resetPending_) {
+            const uint32_t counts[4] = { MAX_PARTICLES, 0, 0, 0 };
+            ctx->UpdateSubresource(deadCountCb_.Get(), 0, nullptr, counts, 0, 0);
+        } else {
+            ctx->CopyStructureCount(deadCountCb_.Get(), 0, deadUav_.Get());
+        }
+
+        if (emitTotal_ > 0 && !uploadEmitters(device, ctx)) emitTotal_ = 0;
+
+        FrameConstants frame{};
+        frame.emitCount = emitTotal_;
+        frame.emitterCount = static_cast<uint32_t>(emitters_.size());
+        frame.frameSeed = frame_ * 0x9E3779B9u;
+        frame.deltaTime = deltaTime_;
+        ctx->UpdateSubresource(frameCb_.Get(), 0, nullptr, &frame, 0, 0);
+
+        // 放出(初期化直後はここでのバインドがカウンタを設定するため、放出数が 0 でもバインドする)
+        ID3D11Buffer* emitCbs[2] = { frameCb_.Get(), deadCountCb_.Get() };
+        ctx->CSSetConstantBuffers(0, 2, emitCbs);
+        ID3D11UnorderedAccessView* emitUavs[3] = { particleUav_.Get(), deadUav_.Get(), aliveUavs_[current_].Get() };
+        const UINT keep = static_cast<UINT>(-1);
+        const UINT emitCounts[3] = { keep, resetPending_ ? MAX_PARTICLES : keep, resetPending_ ? 0u : keep };
+        ctx->CSSetUnorderedAccessViews(0, 3, emitUavs, emitCounts);
+        resetPending_ = false;
+        if (emitTotal_ > 0) {
+            ctx->CSSetShader(emitCs_.Get(), nullptr, 0);
+            ctx->CSSetShaderResources(0, 1, emitterSrv_.GetAddressOf());
+            ctx->Dispatch((emitTotal_ + EMIT_GROUP_SIZE - 1) / EMIT_GROUP_SIZE, 1, 1);
+        }
+        stats_.emitters = emitters_.size();
+        stats_.emitted = emitTotal_;
+
+        // 移動パスの引数(生存数から必要なグループ数)
+        ctx->CopyStructureCount(aliveCountCb_.Get(), 0, aliveUavs_[current_].Get());
+        ID3D11Buffer* simulateCbs[2] = { frameCb_.Get(), aliveCountCb_.Get() };
+        ctx->CSSetConstantBuffers(0, 2, simulateCbs);
+        ID3D11UnorderedAccessView* argsUavs[3] = { argsUav_.Get(), nullptr, nullptr };
+        ctx->CSSetUnorderedAccessViews(0, 3, argsUavs, nullptr);
+        ctx->CSSetShader(argsCs_.Get(), nullptr, 0);
+        ctx->Dispatch(1, 1, 1);
+
+        // 移動と詰め直し(UAV を差し替えてから、直前まで UAV だった生存リストを SRV として読む)
+        const uint32_t next = current_ ^ 1u;
+        ID3D11UnorderedAccessView* simulateUavs[3] = { particleUav_.Get(), aliveUavs_[next].Get(), deadUav_.Get() };
+        const UINT simulateCounts[3] = { keep, 0u, keep };
+        ctx->CSSetUnorderedAccessViews(0, 3, simulateUavs, simulateCounts);
+        ctx->CSSetShaderResources(0, 1, aliveSrvs_[current_].GetAddressOf());
+        ctx->CSSetShader(simulateCs_.Get(), nullptr, 0);
+        ctx->DispatchIndirect(args_.Get(), DISPATCH_ARGS_OFFSET);
+
+        ID3D11UnorderedAccessView* nullUavs[3] = {};
+        ID3D11ShaderResourceView* nullSrv = nullptr;
+        ctx->CSSetUnorderedAccessViews(0, 3, nullUavs, nullptr);
+        ctx->CSSetShaderResources(0, 1, &nullSrv);
+        ctx->CSSetShader(nullptr, nullptr, 0);
+
+        // 描画のインスタンス数 = 詰め直した生存リストの数
+        ctx->CopyStructureCount(args_.Get(), static_cast<UINT>(DRAW_ARGS_OFFSET + sizeof(uint32_t)), aliveUavs_[next].Get());
+        current_ = next;
+    }
+
+    /**
+     * @brief 生存している粒子をビルボードで描画(加算合成・深度は読むだけ)
+     *
+     * @details
+     * ステートは states を通して設定し、元には戻しません(後の描画は必要な分だけ states で設定し直す)。
+     */
+    void Draw(StateCache& states, const Camera& cam) {
+        if (!ready_) return;
+        ID3D11DeviceContext* ctx = states.Context();
+
+        DrawConstants constants{};
+        DirectX::XMStoreFloat4x4(&constants.viewProj, DirectX::XMMatrixTranspose(cam.ViewProj));
+        DirectX::XMFLOAT4X4 view;
+        DirectX::XMStoreFloat4x4(&view, cam.View);
+        constants.cameraRight = DirectX::XMFLOAT4{ view._11, view._21, view._31, 0.0f };
+        constants.cameraUp = DirectX::XMFLOAT4{ view._12, view._22, view._32, 0.0f };
+        ctx->UpdateSubresource(drawCb_.Get(), 0, nullptr, &constants, 0, 0);
+
+        states.Apply(pipeline_);
+        states.SetVSConstantBuffer(0, drawCb_.Get());
+        ID3D11ShaderResourceView* srvs[2] = { particleSrv_.Get(), aliveSrvs_[current_].Get() };
+        ctx->VSSetShaderResources(0, 2, srvs);
+
+        ctx->DrawInstancedIndirect(args_.Get(), DRAW_ARGS_OFFSET);
+
+        // 次のフレームで UAV としてバインドできるように外す
+        ID3D11ShaderResourceView* nullSrvs[2] = {};
+        ctx->VSSetShaderResources(0, 2, nullSrvs);
+    }
+
+    /**
+     * @brief すべての粒子を消す(次の Simulate() で空きリストを満たし直す)
+     */
+    void Clear() {
+        resetPending_ = true;
+        states_.clear();
+    }
+
+    /**
+     * @brief 放出元ごとの端数とバーストの記録を捨てる(エンティティの対応が変わった場合)
+     */
+    void ResetEmitters() { states_.clear(); }
+
+    /**
+     * @struct Statistics
+     * @brief 直近の Simulate() の結果(生存数はGPUにしかないため含まない)
+     */
+    struct Statistics {
+        size_t emitters = 0;  ///< 放出した放出元の数
+        size_t emitted = 0;   ///< 放出を要求した粒子数(空きが足りない分はGPUで打ち切る)
+    };
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+    /**
+     * @brief 確保しているGPUバッファの合計(バイト)
+     */
+    size_t GpuMemoryBytes() const {
+        size_t bytes = GfxDevice::BufferBytes(particles_.Get()) + GfxDevice::BufferBytes(deadList_.Get()) +
+                       GfxDevice::BufferBytes(emitterBuffer_.Get()) + GfxDevice::BufferBytes(args_.Get());
+        for (const auto& list : aliveLists_) bytes += GfxDevice::BufferBytes(list.Get());
+        return bytes;
+    }
+
+    void Shutdown() {
+        ready_ = false;
+        emitCs_.Reset();
+        argsCs_.Reset();
+        simulateCs_.Reset();
+        pipeline_ = PipelineState();
+        vs_.Reset();
+        ps_.Reset();
+        particles_.Reset();
+        particleUav_.Reset();
+        particleSrv_.Reset();
+        deadList_.Reset();
+        deadUav_.Reset();
+        for (uint32_t i = 0; i < 2; ++i) {
+            aliveLists_[i].Reset();
+            aliveUavs_[i].Reset();
+            aliveSrvs_[i].Reset();
+        }
+        emitterBuffer_.Reset();
+        emitterSrv_.Reset();
+        emitterCapacity_ = 0;
+        args_.Reset();
+        argsUav_.Reset();
+        frameCb_.Reset();
+        deadCountCb_.Reset();
+        aliveCountCb_.Reset();
+        drawCb_.Reset();
+        blend_.Reset();
+        depth_.Reset();
+        raster_.Reset();
+        emitters_.clear();
+        states_.clear();
+        emitTotal_ = 0;
+        current_ = 0;
+        stats_ = Statistics();
+    }
+
+private:
+    /**
+     * @struct EmitterState
+     * @brief 放出元ごとにフレームをまたいで持つ値
+     */
+    struct EmitterState {
+        float carry = 0.0f;    ///< 連続放出の端数
+        uint32_t burstId = 0;  ///< 最後に放出した burstId
+        uint32_t frame = 0;    ///< 最後に見つかったフレーム
+    };
+
+    struct FrameConstants {
+        uint32_t emitCount;     ///< このフレームの放出数の合計
+        uint32_t emitterCount;  ///< 放出元の数
+        uint32_t frameSeed;     ///< 乱数の種
+        float deltaTime;        ///< 進める時間(秒)
+    };
+
+    struct DrawConstants {
+        DirectX::XMFLOAT4X4 viewProj;   ///< ビュー・プロジェクション行列(転置済み)
+        DirectX::XMFLOAT4 cameraRight;  ///< ワールド空間のカメラの右
+        DirectX::XMFLOAT4 cameraUp;     ///< ワールド空間のカメラの上
+    };
+
+    static constexpr UINT PARTICLE_STRIDE = 64;          ///< HLSL の Particle の大きさ
+    static constexpr UINT DISPATCH_ARGS_OFFSET = 0;      ///< args_ 内の DispatchIndirect の引数(3 x uint)
+    static constexpr UINT DRAW_ARGS_OFFSET = 16;         ///< args_ 内の DrawInstancedIndirect の引数(4 x uint)
+    static constexpr UINT ARGS_COUNT = 8;                ///< args_ の uint の数
+    static constexpr size_t MIN_EMITTER_CAPACITY = 64;
+
+    bool compileShaders(ID3D11Device* device, UINT compileFlags) {
+        const char* COMMON = R"(
+            struct Particle {
+                float3 position;
+                float age;
+                float3 velocity;
+                float lifetime;
+                float3 acceleration;
+                float drag;
+                uint startColor;
+                uint endColor;
+                float startSize;
+                float endSize;
+            };
+
+            uint PackColor(float4 c) {
+                uint4 b = (uint4)(saturate(c) * 255.0 + 0.5);
+                return b.r | (b.g << 8) | (b.b << 16) | (b.a << 24);
+            }
+
+            float4 UnpackColor(uint c) {
+                return float4(c & 255, (c >> 8) & 255, (c >> 16) & 255, c >> 24) / 255.0;
+            }
+        )";
+
+        const char* COMPUTE = R"(
+            cbuffer FrameConstants : register(b0) {
+                uint gEmitCount;
+                uint gEmitterCount;
+                uint gFrameSeed;
+                float gDeltaTime;
+            };
+
+            // 空きの数(放出)または生存数(引数・移動)。CopyStructureCount で書き込む
+            cbuffer ListCount : register(b1) {
+                uint gListCount;
+                uint3 gListCountPadding;
+            };
+
+            uint Hash(uint x) {
+                x ^= x >> 16;
+                x *= 0x7feb352du;
+                x ^= x >> 15;
+                x *= 0x846ca68bu;
+                x ^= x >> 16;
+                return x;
+            }
+
+            float Random(inout uint state) {
+                state = Hash(state);
+                return (state >> 8) * (1.0 / 16777216.0);
+            }
+        )";
+
+        const char* EMIT = R"(
+            struct Emitter {
+                float3 position;
+                uint firstThread;
+                float3 direction;
+                float cosSpread;
+                float3 acceleration;
+                float drag;
+                float4 startColor;
+                float4 endColor;
+                float lifetimeMin;
+                float lifetimeMax;
+                float speedMin;
+                float speedMax;
+                float startSize;
+                float endSize;
+                float spawnRadius;
+                uint count;
+            };
+
+            StructuredBuffer<Emitter> gEmitters : register(t0);
+            RWStructuredBuffer<Particle> gParticles : register(u0);
+            ConsumeStructuredBuffer<uint> gDeadList : register(u1);
+            AppendStructuredBuffer<uint> gAliveList : register(u2);
+
+            // 方向 axis から最大 cosSpread の円錐内の一様な方向
+            float3 ConeDirection(float3 axis, float cosSpread, inout uint state) {
+                float cosTheta = lerp(1.0, cosSpread, Random(state));
+                float sinTheta = sqrt(saturate(1.0 - cosTheta * cosTheta));
+                float phi = 6.28318530718 * Random(state);
+                float3 up = abs(axis.y) < 0.999 ? float3(0, 1, 0) : float3(1, 0, 0);
+                float3 tangent = normalize(cross(up, axis));
+                float3 bitangent = cross(axis, tangent);
+                return tangent * (cos(phi) * sinTheta) + bitangent * (sin(phi) * sinTheta) + axis * cosTheta;
+            }
+
+            [numthreads(64, 1, 1)]
+            void main(uint3 id : SV_DispatchThreadID) {
+                uint t = id.x;
+                // 空きの数を超えた分は出さない(Consume は空のリストで呼べない)
+                if (t >= gEmitCount || t >= gListCount) return;
+
+                // firstThread <= t となる最後の放出元
+                uint lo = 0;
+                uint hi = gEmitterCount - 1;
+                while (lo < hi) {
+                    uint mid = (lo + hi + 1) >> 1;
+                    if (gEmitters[mid].firstThread <= t) lo = mid;
+                    else hi = mid - 1;
+                }
+                Emitter e = gEmitters[lo];
+
+                uint state = Hash(t ^ gFrameSeed);
+                float3 direction = ConeDirection(e.direction, e.cosSpread, state);
+                float3 offset = ConeDirection(float3(0, 1, 0), -1.0, state) * (e.spawnRadius * pow(Random(state), 1.0 / 3.0));
+
+                Particle p;
+                p.position = e.position + offset;
+                p.age = 0.0;
+                p.velocity = direction * lerp(e.speedMin, e.speedMax, Random(state));
+                p.lifetime = max(lerp(e.lifetimeMin, e.lifetimeMax, Random(state)), 1e-3);
+                p.acceleration = e.acceleration;
+                p.drag = e.drag;
+                p.startColor = PackColor(e.startColor);
+                p.endColor = PackColor(e.endColor);
+                p.startSize = e.startSize;
+                p.endSize = e.endSize;
+
+                uint index = gDeadList.Consume();
+                gParticles[index] = p;
+                gAliveList.Append(index);
+            }
+        )";
+
+        const char* ARGS = R"(
+            RWBuffer<uint> gArgs : register(u0);
+
+            [numthreads(1, 1, 1)]
+            void main() {
+                gArgs[0] = (gListCount + 255) / 256;
+                gArgs[1] = 1;
+                gArgs[2] = 1;
+            }
+        )";
+
+        const char* SIMULATE = R"(
+            StructuredBuffer<uint> gAliveIn : register(t0);
+            RWStructuredBuffer<Particle> gParticles : register(u0);
+            AppendStructuredBuffer<uint> gAliveOut : register(u1);
+            AppendStructuredBuffer<uint> gDeadList : register(u2);
+
+            [numthreads(256, 1, 1)]
+            void main(uint3 id : SV_DispatchThreadID) {
+                if (id.x >= gListCount) return;
+                uint index = gAliveIn[id.x];
+                Particle p = gParticles[index];
+
+                p.age += gDeltaTime;
+                if (p.age >= p.lifetime) {
+                    gDeadList.Append(index);
+                    return;
+                }
+                p.velocity += p.acceleration * gDeltaTime;
+                p.velocity *= saturate(1.0 - p.drag * gDeltaTime);
+                p.position += p.velocity * gDeltaTime;
+                gParticles[index] = p;
+                gAliveOut.Append(index);
+            }
+        )";
+
+        const char* VS = R"(
+            cbuffer DrawConstants : register(b0) {
+                float4x4 gViewProj;
+                float4 gCameraRight;
+                float4 gCameraUp;
+            };
+
+            StructuredBuffer<Particle> gParticles : register(t0);
+            StructuredBuffer<uint> gAliveList : register(t1);
+
+            struct VSOut {
+                float4 pos : SV_POSITION;
+                float4 color : COLOR;
+                float2 uv : TEXCOORD;
+            };
+
+            static const float2 CORNERS[6] = {
+                float2(-1, -1), float2(-1, 1), float2(1, 1),
+                float2(-1, -1), float2(1, 1), float2(1, -1)
+            };
+
+            VSOut main(uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID) {
+                Particle p = gParticles[gAliveList[instanceId]];
+                float t = saturate(p.age / p.lifetime);
+                float2 corner = CORNERS[vertexId];
+                float size = lerp(p.startSize, p.endSize, t);
+                float3 worldPos = p.position + (gCameraRight.xyz * corner.x + gCameraUp.xyz * corner.y) * size;
+
+                VSOut o;
+                o.pos = mul(float4(worldPos, 1.0), gViewProj);
+                o.color = lerp(UnpackColor(p.startColor), UnpackColor(p.endColor), t);
+                o.uv = corner;
+                return o;
+            }
+        )";
+
+        const char* PS = R"(
+            struct VSOut {
+                float4 pos : SV_POSITION;
+                float4 color : COLOR;
+                float2 uv : TEXCOORD;
+            };
+
+            float4 main(VSOut i) : SV_TARGET {
+                float falloff = saturate(1.0 - dot(i.uv, i.uv));
+                return float4(i.color.rgb * (i.color.a * falloff * falloff), 1.0);
+            }
+        )";
+
+        Microsoft::WRL::ComPtr<ID3DBlob> blob;
+        if (!compile(std::string(COMMON) + COMPUTE + EMIT, "cs_5_0", compileFlags, "放出", blob) ||
+            FAILED(device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, emitCs_.GetAddressOf()))) return false;
+        if (!compile(std::string(COMMON) + COMPUTE + ARGS, "cs_5_0", compileFlags, "引数", blob) ||
+            FAILED(device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, argsCs_.GetAddressOf()))) return false;
+        if (!compile(std::string(COMMON) + COMPUTE + SIMULATE, "cs_5_0", compileFlags, "移動", blob) ||
+            FAILED(device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, simulateCs_.GetAddressOf()))) return false;
+        if (!compile(std::string(COMMON) + VS, "vs_5_0", compileFlags, "描画", blob) ||
+            FAILED(device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, vs_.GetAddressOf()))) return false;
+        if (!compile(PS, "ps_5_0", compileFlags, "描画", blob) ||
+            FAILED(device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, ps_.GetAddressOf()))) return false;
+        return true;
+    }
+
+    static bool compile(const std::string& source, const char* target, UINT compileFlags, const char* pass, Microsoft::WRL::ComPtr<ID3DBlob>& blob) {
+        Microsoft::WRL::ComPtr<ID3DBlob> err;
+        HRESULT hr = ShaderCache::Compile(source.c_str(), nullptr, "main", target, compileFlags, blob, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING(std::string("[ParticleSystem] ") + pass + "シェーダー(" + target + ")のコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        return true;
+    }
+
+    bool createBuffers(ID3D11Device* device) {
+        // 粒子
+        if (!createStructured(device, PARTICLE_STRIDE, MAX_PARTICLES, nullptr, particles_, particleSrv_.GetAddressOf(), particleUav_, 0)) return false;
+
+        // 空きリスト(最初はすべての番号が空き)
+        std::vector<uint32_t> indices(MAX_PARTICLES);
+        for (uint32_t i = 0; i < MAX_PARTICLES; ++i) indices[i] = i;
+        if (!createStructured(device, sizeof(uint32_t), MAX_PARTICLES, indices.data(), deadList_, nullptr, deadUav_, D3D11_BUFFER_UAV_FLAG_APPEND)) return false;
+
+        // 生存リスト(移動パスで入れ替える)
+        for (uint32_t i = 0; i < 2; ++i) {
+            if (!createStructured(device, sizeof(uint32_t), MAX_PARTICLES, nullptr, aliveLists_[i], aliveSrvs_[i].GetAddressOf(), aliveUavs_[i],
+                                  D3D11_BUFFER_UAV_FLAG_APPEND)) return false;
+        }
+
+        // 間接引数(Dispatch: x, y, z / Draw: 頂点数 6, インスタンス数, 開始頂点, 開始インスタンス)
+        const uint32_t args[ARGS_COUNT] = { 0, 1, 1, 0, 6, 0, 0, 0 };
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        bd.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+        bd.ByteWidth = sizeof(args);
+        D3D11_SUBRESOURCE_DATA init{ args, 0, 0 };
+        HRESULT hr = device->CreateBuffer(&bd, &init, args_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ParticleSystem] 間接引数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavd{};
+        uavd.Format = DXGI_FORMAT_R32_UINT;
+        uavd.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavd.Buffer.NumElements = ARGS_COUNT;
+        hr = device->CreateUnorderedAccessView(args_.Get(), &uavd, argsUav_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ParticleSystem] 間接引数のUAVの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        // 定数バッファ(数の2つは CopyStructureCount の書き込み先)
+        return createConstant(device, sizeof(FrameConstants), frameCb_) && createConstant(device, 16, deadCountCb_) &&
+               createConstant(device, 16, aliveCountCb_) && createConstant(device, sizeof(DrawConstants), drawCb_);
+    }
+
+    static bool createStructured(ID3D11Device* device, UINT stride, UINT count, const void* data, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer,
+                                 ID3D11ShaderResourceView** srv, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView>& uav, UINT uavFlags) {
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_UNORDERED_ACCESS | (srv ? D3D11_BIND_SHADER_RESOURCE : 0);
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bd.StructureByteStride = stride;
+        bd.ByteWidth = stride * count;
+        D3D11_SUBRESOURCE_DATA init{ data, 0, 0 };
+        HRESULT hr = device->CreateBuffer(&bd, data ? &init : nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ParticleSystem] バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        if (srv) {
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+            srvd.Format = DXGI_FORMAT_UNKNOWN;
+            srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvd.Buffer.NumElements = count;
+            hr = device->CreateShaderResourceView(buffer.Get(), &srvd, srv);
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[ParticleSystem] SRVの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+        }
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavd{};
+        uavd.Format = DXGI_FORMAT_UNKNOWN;
+        uavd.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavd.Buffer.NumElements = count;
+        uavd.Buffer.Flags = uavFlags;
+        hr = device->CreateUnorderedAccessView(buffer.Get(), &uavd, uav.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ParticleSystem] UAVの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
+    }
+
+    static bool createConstant(ID3D11Device* device, UINT size, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer) {
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = (size + 15u) & ~15u;
+        HRESULT hr = device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ParticleSystem] 定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        return true;
+    }
+
+    bool createStates(ID3D11Device* device) {
+        // 加算合成(出力は a を掛け済み)。描画先のアルファは変えない
+        D3D11_BLEND_DESC bd{};
+        bd.RenderTarget[0].BlendEnable = TRUE;
+        bd.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+        bd.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+        bd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+        bd.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ZERO;
+        bd.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+        bd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+        bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+        if (FAILED(device->CreateBlendState(&bd, blend_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[ParticleSystem] ブレンドステートの作成失敗");
+            return false;
+        }
+
+        D3D11_DEPTH_STENCIL_DESC dd{};
+        dd.DepthEnable = TRUE;
+        dd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+        dd.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+        if (FAILED(device->CreateDepthStencilState(&dd, depth_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[ParticleSystem] 深度ステンシルステートの作成失敗");
+            return false;
+        }
+
+        D3D11_RASTERIZER_DESC rd{};
+        rd.FillMode = D3D11_FILL_SOLID;
+        rd.CullMode = D3D11_CULL_NONE;
+        rd.DepthClipEnable = TRUE;
+        if (FAILED(device->CreateRasterizerState(&rd, raster_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[ParticleSystem] ラスタライザーステートの作成失敗");
+            return false;
+        }
+
+        PipelineStateDesc desc;
+        desc.vertexShader = vs_.Get();
+        desc.pixelShader = ps_.Get();
+        desc.blendState = blend_.Get();
+        desc.rasterizerState = raster_.Get();
+        desc.depthStencilState = depth_.Get();
+        pipeline_ = PipelineState(desc);
+        return true;
+    }
+
+    // 放出元の表を書き込む(容量が足りなければ作り直す)
+    bool uploadEmitters(ID3D11Device* device, ID3D11DeviceContext* ctx) {
+        if (emitters_.size() > emitterCapacity_ || !emitterBuffer_) {
+            size_t capacity = (std::max)(emitterCapacity_, MIN_EMITTER_CAPACITY);
+            while (capacity < emitters_.size()) capacity *= 2;
+
+            D3D11_BUFFER_DESC bd{};
+            bd.Usage = D3D11_USAGE_DYNAMIC;
+            bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+            bd.StructureByteStride = sizeof(GpuParticleEmitter);
+            bd.ByteWidth = static_cast<UINT>(capacity * sizeof(GpuParticleEmitter));
+
+            Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+            HRESULT hr = device->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[ParticleSystem] 放出元バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+            srvd.Format = DXGI_FORMAT_UNKNOWN;
+            srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvd.Buffer.NumElements = static_cast<UINT>(capacity);
+            hr = device->CreateShaderResourceView(buffer.Get(), &srvd, srv.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[ParticleSystem] 放出元のSRVの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+            emitterBuffer_ = buffer;
+            emitterSrv_ = srv;
+            emitterCapacity_ = capacity;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        HRESULT hr = ctx->Map(emitterBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[ParticleSystem] 放出元バッファのMap失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        std::memcpy(mapped.pData, emitters_.data(), emitters_.size() * sizeof(GpuParticleEmitter));
+        ctx->Unmap(emitterBuffer_.Get(), 0);
+        return true;
+    }
+
+    // シェーダー
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> emitCs_;
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> argsCs_;
+    Microsoft::WRL::ComPtr<ID3D11ComputeShader> simulateCs_;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;
+
+    // 粒子とリスト
+    Microsoft::WRL::ComPtr<ID3D11Buffer> particles_;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> particleUav_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> particleSrv_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> deadList_;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> deadUav_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> aliveLists_[2];
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> aliveUavs_[2];
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> aliveSrvs_[2];
+    uint32_t current_ = 0;                        ///< 描画・次の放出に使う生存リスト
+
+    // 放出元
+    Microsoft::WRL::ComPtr<ID3D11Buffer> emitterBuffer_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> emitterSrv_;
+    size_t emitterCapacity_ = 0;                  ///< emitterBuffer_ の要素数
+    std::vector<GpuParticleEmitter> emitters_;    ///< このフレームの放出元
+    uint32_t emitTotal_ = 0;                      ///< このフレームの放出数の合計
+    std::unordered_map<uint64_t, EmitterState> states_; ///< Entity::Packed() で引く
+
+    // 間接引数・定数・ステート
+    Microsoft::WRL::ComPtr<ID3D11Buffer> args_;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> argsUav_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> frameCb_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> deadCountCb_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> aliveCountCb_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> drawCb_;
+    Microsoft::WRL::ComPtr<ID3D11BlendState> blend_;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depth_;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> raster_;
+    PipelineState pipeline_;   ///< ビルボード描画(入力レイアウトなし・加算合成・深度は読むだけ)
+
+    std::chrono::steady_clock::time_point lastFrame_{};
+    float deltaTime_ = 0.0f;
+    float emissionScale_ = 1.0f;                  ///< 放出数の倍率(SetEmissionScale)
+    uint32_t frame_ = 0;
+    bool resetPending_ = false;                   ///< 次の Simulate() でリストのカウンタを設定し直す
+    bool ready_ = false;
+    Statistics stats_;
+};
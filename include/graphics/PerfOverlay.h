@@ -0,0 +1,368 @@
+/**
+ * @file PerfOverlay.h
+ * @brief 画面左上に重ねる性能のオーバーレイ(フレーム時間のグラフ・統計・メモリ予算)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * グラフの棒・背景・文字をすべて画面座標の単色の四角形として SpriteBatch に積みます。
+ * GPU のリソースは持たず、HUD のスプライトと同じ End() でまとめて描かれます
+ * (内容は SpriteBatch::LAYER_OVERLAY、背景はその1つ下の layer で、ほかのスプライトより手前)。
+ * 文字は 3x5 ドットの組み込みフォントで、横に連続したドットを1つの四角形にまとめます。テクスチャやフォントファイルは使いません。
+ *
+ * 1フレームに積む四角形は MAX_QUADS までで、超えた四角形は積まずに DroppedQuads() に数えます。
+ *
+ * @par 使用例
+ * @code
+ * PerfOverlay overlay;
+ * overlay.Init();
+ *
+ * // フレームの計測後(グラフは毎フレーム、文字と棒は表示を更新するときだけ積み直す)
+ * const float ms[PerfOverlay::SERIES_COUNT] = { updateMs, renderMs, presentMs, gpuMs };
+ * overlay.PushFrame(ms);
+ * if (refresh) {
+ *     overlay.ClearText();
+ *     overlay.AddText("ENTITIES 1234");
+ *     overlay.AddBar("ECS", usedBytes, budgetBytes);
+ * }
+ *
+ * // 次のフレームの描画の最後(SpriteBatch::Begin() と End() の間)
+ * overlay.Render(sprites);
+ * @endcode
+ */
+#pragma once
+#include "graphics/SpriteBatch.h"
+#include "app/DebugLog.h"
+#include "app/MemoryTracker.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @class PerfOverlay
+ * @brief フレーム時間のグラフと統計を SpriteBatch の四角形として描くオーバーレイ
+ */
+class PerfOverlay {
+public:
+    /**
+     * @enum Series
+     * @brief グラフに描くフレーム時間の系列
+     */
+    enum Series : uint32_t {
+        SERIES_UPDATE = 0, ///< Update 時間
+        SERIES_RENDER,     ///< Render 時間
+        SERIES_PRESENT,    ///< Present 時間
+        SERIES_GPU,        ///< GPU 時間(GpuProfiler が無効な間は 0)
+        SERIES_COUNT
+    };
+
+    static constexpr size_t HISTORY = 240;      ///< グラフに残すフレーム数(1フレーム1ピクセル)
+    static constexpr size_t MAX_QUADS = 8192;   ///< 1フレームに積む四角形の最大数
+    static constexpr float GRAPH_MAX_MS = 33.3f; ///< グラフの上端(ミリ秒)
+    static constexpr float TARGET_MS = 16.7f;    ///< グラフに引く目標時間の線(ミリ秒)
+
+    // 色(0xAABBGGRR、DXGI_FORMAT_R8G8B8A8_UNORM の並び)
+    static constexpr uint32_t COLOR_TEXT = 0xFFFFFFFFu;   ///< 文字の既定の色
+    static constexpr uint32_t COLOR_WARN = 0xFF4040FFu;   ///< 目標・予算の超過
+    static constexpr uint32_t COLOR_DIM = 0xFFA0A0A0u;    ///< 補足の文字
+
+    PerfOverlay() = default;
+    PerfOverlay(const PerfOverlay&) = delete;
+    PerfOverlay& operator=(const PerfOverlay&) = delete;
+
+    /**
+     * @brief フォントを展開
+     */
+    void Init() {
+        BuildFont();
+        texts_.reserve(32);
+        bars_.reserve(MemoryTracker::TAG_COUNT);
+        initialized_ = true;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "PerfOverlay::Init() 完了 (最大四角形数: " + std::to_string(MAX_QUADS) + ")");
+    }
+
+    /**
+     * @brief 文字と棒を捨てて未初期化に戻す(冪等)
+     */
+    void Shutdown() {
+        ClearText();
+        initialized_ = false;
+    }
+
+    bool IsInitialized() const { return initialized_; }
+
+    void SetVisible(bool visible) { visible_ = visible; }
+    bool IsVisible() const { return visible_; }
+
+    /**
+     * @brief 1フレーム分のフレーム時間を追加(表示していない間も履歴は進める)
+     * @param[in] ms Series の順のミリ秒
+     */
+    void PushFrame(const float ms[SERIES_COUNT]) {
+        for (size_t s = 0; s < SERIES_COUNT; ++s) {
+            history_[s][head_] = ms[s];
+        }
+        head_ = (head_ + 1) % HISTORY;
+        if (filled_ < HISTORY) ++filled_;
+    }
+
+    /**
+     * @brief グラフの下に1行の文字を追加(ClearText() まで毎フレーム描画)
+     * @note 英大文字・数字・一部の記号のみ(小文字は大文字で描き、ほかの文字は空白)
+     */
+    void AddText(const std::string& text, uint32_t color = COLOR_TEXT) {
+        texts_.push_back(TextLine{ text, color });
+    }
+
+    /**
+     * @brief 使用量と予算の棒を追加(budget が 0 の場合は棒を描かない、ClearText() まで毎フレーム描画)
+     */
+    void AddBar(const std::string& label, size_t used, size_t budget) {
+        bars_.push_back(Bar{ label, used, budget });
+    }
+
+    /**
+     * @brief 文字と棒を消去(表示を更新するときに積み直す前に呼ぶ)
+     *
+     * @details
+     * 文字は毎フレーム作り直さず、呼び出し側が決めた間隔で積み直します
+     * (揺れの大きい1フレームの値を読める速さで表示し、書式化の負荷も間隔ごとにする)。
+     */
+    void ClearText() {
+        texts_.clear();
+        bars_.clear();
+    }
+
+    bool HasText() const { return !texts_.empty() || !bars_.empty(); }
+
+    /**
+     * @brief グラフと積んである文字・棒を SpriteBatch に積む
+     *
+     * @details
+     * 描画は SpriteBatch::End() で、HUD のスプライトと同じドローコールにまとまります。
+     * 非表示の間は何もしません。
+     */
+    void Render(SpriteBatch& sprites) {
+        quadCount_ = 0;
+        droppedQuads_ = 0;
+        if (!initialized_ || !visible_) return;
+
+        batch_ = &sprites;
+        float y = PADDING;
+        float right = PADDING;
+        for (size_t s = 0; s < SERIES_COUNT; ++s) {
+            right = (std::max)(right, DrawGraph(static_cast<Series>(s), PADDING, y));
+            y += GRAPH_HEIGHT + GRAPH_SPACING;
+        }
+        y += GRAPH_SPACING;
+
+        for (const TextLine& line : texts_) {
+            right = (std::max)(right, DrawText(line.text.c_str(), PADDING, y, line.color));
+            y += LINE_HEIGHT;
+        }
+
+        for (const Bar& bar : bars_) {
+            right = (std::max)(right, DrawBar(bar, PADDING, y));
+            y += LINE_HEIGHT;
+        }
+
+        // 背景は大きさが決まってから積む(layer が1つ下なので先に描かれる)
+        batch_->DrawRect(0.0f, 0.0f, right + PADDING, y + PADDING - (LINE_HEIGHT - GLYPH_SCALE * 5.0f), COLOR_PANEL,
+                         SpriteBatch::LAYER_OVERLAY - 1);
+        ++quadCount_;
+        batch_ = nullptr;
+    }
+
+    /**
+     * @brief 直前の Render() で積んだ四角形の数
+     */
+    size_t LastQuadCount() const { return quadCount_; }
+
+    /**
+     * @brief 直前の Render() で MAX_QUADS を超えて積めなかった四角形の数
+     */
+    size_t DroppedQuads() const { return droppedQuads_; }
+
+    /**
+     * @brief 系列の表示名
+     */
+    static const char* SeriesName(Series s) {
+        static const char* const names[SERIES_COUNT] = { "UPDATE", "RENDER", "PRESENT", "GPU" };
+        return names[s];
+    }
+
+private:
+    struct TextLine {
+        std::string text;
+        uint32_t color;
+    };
+
+    struct Bar {
+        std::string label;
+        size_t used;
+        size_t budget;
+    };
+
+    static constexpr float PADDING = 8.0f;        ///< パネルの余白(ピクセル)
+    static constexpr float GRAPH_HEIGHT = 32.0f;  ///< 1系列のグラフの高さ
+    static constexpr float GRAPH_SPACING = 4.0f;  ///< グラフの間隔
+    static constexpr float GLYPH_SCALE = 2.0f;    ///< フォントの1ドットの大きさ
+    static constexpr float GLYPH_ADVANCE = 8.0f;  ///< 1文字の幅(3ドット + 間隔)
+    static constexpr float LINE_HEIGHT = 14.0f;   ///< 文字の行の高さ
+    static constexpr float BAR_WIDTH = 160.0f;    ///< 予算の棒の幅
+    static constexpr size_t BAR_LABEL_CHARS = 10; ///< 予算の棒の前に置くラベルの幅(文字数)
+
+    static constexpr uint32_t COLOR_PANEL = 0xB0000000u;      ///< パネルの背景
+    static constexpr uint32_t COLOR_GRAPH_BG = 0x60303030u;   ///< グラフの背景
+    static constexpr uint32_t COLOR_TARGET = 0xC000C0C0u;     ///< 目標時間の線
+    static constexpr uint32_t COLOR_BAR_OK = 0xFF40C040u;     ///< 予算内の棒
+
+    /**
+     * @brief 系列の色
+     */
+    static uint32_t SeriesColor(Series s) {
+        static const uint32_t colors[SERIES_COUNT] = {
+            0xFF60D060u, // UPDATE: 緑
+            0xFFF0A040u, // RENDER: 青
+            0xFF40D0F0u, // PRESENT: 黄
+            0xFFF060D0u, // GPU: 紫
+        };
+        return colors[s];
+    }
+
+    /**
+     * @brief 1系列のグラフと、その右に直近値と履歴中の最大値を描く
+     * @return float 描いた内容の右端(ピクセル)
+     */
+    float DrawGraph(Series s, float x, float y) {
+        PushQuad(x, y, static_cast<float>(HISTORY), GRAPH_HEIGHT, COLOR_GRAPH_BG);
+
+        const float pxPerMs = GRAPH_HEIGHT / GRAPH_MAX_MS;
+        const uint32_t color = SeriesColor(s);
+        float latest = 0.0f;
+        float peak = 0.0f;
+        // 古い順に左から並べる(右端が最新)
+        const size_t start = (head_ + HISTORY - filled_) % HISTORY;
+        const float left = x + static_cast<float>(HISTORY - filled_);
+        for (size_t i = 0; i < filled_; ++i) {
+            const float ms = history_[s][(start + i) % HISTORY];
+            latest = ms;
+            peak = (std::max)(peak, ms);
+            const float h = (std::min)(ms * pxPerMs, GRAPH_HEIGHT);
+            if (h < 0.5f) continue;
+            PushQuad(left + static_cast<float>(i), y + GRAPH_HEIGHT - h, 1.0f, h, ms > TARGET_MS ? COLOR_WARN : color);
+        }
+        PushQuad(x, y + GRAPH_HEIGHT - TARGET_MS * pxPerMs, static_cast<float>(HISTORY), 1.0f, COLOR_TARGET);
+
+        char label[64];
+        sprintf_s(label, "%-7s %5.2f MAX %5.2f", SeriesName(s), latest, peak);
+        const float textY = y + (GRAPH_HEIGHT - GLYPH_SCALE * 5.0f) * 0.5f;
+        return DrawText(label, x + static_cast<float>(HISTORY) + PADDING, textY, color);
+    }
+
+    /**
+     * @brief 「ラベル 使用量/予算 MB」と使用率の棒を描く
+     * @return float 描いた内容の右端(ピクセル)
+     */
+    float DrawBar(const Bar& bar, float x, float y) {
+        const float toMb = 1.0f / (1024.0f * 1024.0f);
+        const float ratio = bar.budget > 0 ? static_cast<float>(bar.used) / static_cast<float>(bar.budget) : 0.0f;
+        const uint32_t color = ratio > 1.0f ? COLOR_WARN : COLOR_TEXT;
+
+        DrawText(bar.label.c_str(), x, y, color);
+        float cursor = x + GLYPH_ADVANCE * static_cast<float>(BAR_LABEL_CHARS);
+        if (bar.budget > 0) {
+            const float h = GLYPH_SCALE * 5.0f;
+            PushQuad(cursor, y, BAR_WIDTH, h, COLOR_GRAPH_BG);
+            PushQuad(cursor, y, BAR_WIDTH * (std::min)(ratio, 1.0f), h, ratio > 1.0f ? COLOR_WARN : COLOR_BAR_OK);
+            cursor += BAR_WIDTH + PADDING;
+        }
+
+        char text[64];
+        if (bar.budget > 0) {
+            sprintf_s(text, "%.1f/%.0f MB", static_cast<float>(bar.used) * toMb, static_cast<float>(bar.budget) * toMb);
+        } else {
+            sprintf_s(text, "%.1f MB", static_cast<float>(bar.used) * toMb);
+        }
+        return DrawText(text, cursor, y, color);
+    }
+
+    /**
+     * @brief 文字列を描く(横に連続したドットを1つの四角形にまとめる)
+     * @return float 描いた文字列の右端(ピクセル)
+     */
+    float DrawText(const char* text, float x, float y, uint32_t color) {
+        float cursor = x;
+        for (const char* p = text; *p; ++p, cursor += GLYPH_ADVANCE) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c >= 'a' && c <= 'z') c = static_cast<unsigned char>(c - 'a' + 'A');
+            const uint16_t glyph = c < 128 ? font_[c] : 0;
+            if (glyph == 0) continue;
+            for (int row = 0; row < 5; ++row) {
+                const uint32_t bits = (glyph >> ((4 - row) * 3)) & 0x7u;
+                int col = 0;
+                while (col < 3) {
+                    if (!(bits & (4u >> col))) { ++col; continue; }
+                    const int begin = col;
+                    while (col < 3 && (bits & (4u >> col))) ++col;
+                    PushQuad(cursor + begin * GLYPH_SCALE, y + row * GLYPH_SCALE,
+                             (col - begin) * GLYPH_SCALE, GLYPH_SCALE, color);
+                }
+            }
+        }
+        return cursor;
+    }
+
+    /**
+     * @brief 画面座標(ピクセル、左上原点)の四角形を積む(背景の分を残して MAX_QUADS まで)
+     */
+    void PushQuad(float x, float y, float w, float h, uint32_t color) {
+        if (quadCount_ + 1 >= MAX_QUADS) {
+            ++droppedQuads_;
+            return;
+        }
+        batch_->DrawRect(x, y, w, h, color, SpriteBatch::LAYER_OVERLAY);
+        ++quadCount_;
+    }
+
+    /**
+     * @brief 3x5 ドットのフォントを ASCII の表に展開
+     *
+     * @details
+     * 各文字は上の行から3ビットずつ、左のドットを上位ビットとした15ビットです。
+     */
+    void BuildFont() {
+        struct Glyph { char c; uint16_t bits; };
+        static const Glyph glyphs[] = {
+            { '0', 0x7B6F }, { '1', 0x2C97 }, { '2', 0x73E7 }, { '3', 0x73CF }, { '4', 0x5BC9 }, { '5', 0x79CF },
+            { '6', 0x79EF }, { '7', 0x7252 }, { '8', 0x7BEF }, { '9', 0x7BCF }, { 'A', 0x2BED }, { 'B', 0x6BAE },
+            { 'C', 0x3923 }, { 'D', 0x6B6E }, { 'E', 0x79A7 }, { 'F', 0x79A4 }, { 'G', 0x396B }, { 'H', 0x5BED },
+            { 'I', 0x7497 }, { 'J', 0x126A }, { 'K', 0x5BAD }, { 'L', 0x4927 }, { 'M', 0x5FED }, { 'N', 0x6B6D },
+            { 'O', 0x2B6A }, { 'P', 0x6BA4 }, { 'Q', 0x2B73 }, { 'R', 0x6BAD }, { 'S', 0x388E }, { 'T', 0x7492 },
+            { 'U', 0x5B6F }, { 'V', 0x5B6A }, { 'W', 0x5BFD }, { 'X', 0x5AAD }, { 'Y', 0x5A92 }, { 'Z', 0x72A7 },
+            { '.', 0x0002 }, { ':', 0x0410 }, { '/', 0x12A4 }, { '%', 0x52A5 }, { '-', 0x01C0 }, { '+', 0x05D0 },
+            { '(', 0x1491 }, { ')', 0x4494 }, { '=', 0x0E38 }, { ',', 0x0014 }, { '_', 0x0007 }, { '?', 0x7282 },
+        };
+        std::fill(std::begin(font_), std::end(font_), static_cast<uint16_t>(0));
+        for (const Glyph& g : glyphs) {
+            font_[static_cast<unsigned char>(g.c)] = g.bits;
+        }
+    }
+
+    float history_[SERIES_COUNT][HISTORY] = {}; ///< 系列ごとのフレーム時間のリング(ミリ秒)
+    size_t head_ = 0;                           ///< 次に書き込む位置
+    size_t filled_ = 0;                         ///< 記録済みのフレーム数(最大 HISTORY)
+
+    std::vector<TextLine> texts_;                       ///< 描く文字の行(ClearText() まで残す)
+    std::vector<Bar> bars_;                             ///< 描く予算の棒(ClearText() まで残す)
+    uint16_t font_[128] = {};                           ///< ASCII -> 3x5 のドット
+    SpriteBatch* batch_ = nullptr;                      ///< Render() の間だけ積み先を指す
+    size_t quadCount_ = 0;                              ///< 直前の Render() で積んだ四角形の数
+    size_t droppedQuads_ = 0;                           ///< 直前の Render() で積めなかった四角形の数
+    bool visible_ = false;                              ///< 表示するか
+    bool initialized_ = false;                          ///< Init() 済みか
+};
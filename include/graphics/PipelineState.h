@@ -0,0 +1,257 @@
+/**
+ * @file PipelineState.h
+ * @brief 描画パイプラインのステートをまとめた不変のハンドルと、コンテキストごとのステートキャッシュ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * PipelineState は頂点シェーダー・ピクセルシェーダー・入力レイアウト・トポロジ・ブレンド・ラスタライザー・深度ステートを
+ * 1つにまとめた作成後に変更できないハンドルです。描画側は初期化時に使う組み合わせの分だけ作っておき、描画時は
+ * StateCache::Apply() に渡すだけにします。
+ *
+ * StateCache はコンテキストに最後に設定した値を覚えておき、同じ値の `*Set*` 呼び出しを省略します。
+ * 即時コンテキストのものは GfxDevice::States() が持ち、RenderSystem・DebugDraw・SpriteBatch・ParticleSystem・
+ * ResolutionScaler が共有するため、デバッグ描画の後に RenderSystem が次のフレームで同じステートを設定し直しても、
+ * 実際に変わった項目だけがドライバへ送られます。遅延コンテキストは記録ごとに状態が空から始まるため、
+ * 記録の開始時に Attach() し直した別の StateCache を使います。
+ *
+ * キャッシュを通さずに同じ項目を設定するコード(シャドウマップの描画など)の後は Invalidate() を呼んでください。
+ * 覚えているのはポインタだけですが、設定中のオブジェクトはコンテキストが参照を持つため、
+ * 解放されて同じアドレスに別のオブジェクトが作られることはありません(ClearState() の後は Invalidate() が必要)。
+ */
+#pragma once
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+
+/**
+ * @struct PipelineStateDesc
+ * @brief PipelineState の作成に使う設定(nullptr は既定のステート)
+ */
+struct PipelineStateDesc {
+    ID3D11VertexShader* vertexShader = nullptr;
+    ID3D11PixelShader* pixelShader = nullptr;            ///< nullptr なら深度だけ描く
+    ID3D11InputLayout* inputLayout = nullptr;            ///< nullptr なら頂点バッファを使わない(SV_VertexID で描く)
+    D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    ID3D11BlendState* blendState = nullptr;
+    ID3D11RasterizerState* rasterizerState = nullptr;
+    ID3D11DepthStencilState* depthStencilState = nullptr;
+    UINT stencilRef = 0;
+};
+
+/**
+ * @class PipelineState
+ * @brief シェーダー・入力レイアウト・固定機能ステートの組み合わせ(作成後は不変)
+ *
+ * @par 使用例
+ * @code
+ * PipelineStateDesc desc;
+ * desc.vertexShader = vs_.Get();
+ * desc.pixelShader = ps_.Get();
+ * desc.inputLayout = layout_.Get();
+ * desc.topology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+ * desc.depthStencilState = depth_.Get();
+ * linePipeline_ = PipelineState(desc);
+ *
+ * gfx.States().Apply(linePipeline_);   // 前回と同じ項目は設定しない
+ * @endcode
+ */
+class PipelineState {
+public:
+    PipelineState() = default;
+
+    explicit PipelineState(const PipelineStateDesc& desc)
+        : vertexShader_(desc.vertexShader), pixelShader_(desc.pixelShader), inputLayout_(desc.inputLayout),
+          blendState_(desc.blendState), rasterizerState_(desc.rasterizerState), depthStencilState_(desc.depthStencilState),
+          topology_(desc.topology), stencilRef_(desc.stencilRef) {}
+
+    /**
+     * @brief 作成済みか(頂点シェーダーのないステートは描画に使えない)
+     */
+    bool IsValid() const { return vertexShader_ != nullptr; }
+
+    ID3D11VertexShader* VertexShader() const { return vertexShader_.Get(); }
+    ID3D11PixelShader* PixelShader() const { return pixelShader_.Get(); }
+    ID3D11InputLayout* InputLayout() const { return inputLayout_.Get(); }
+    ID3D11BlendState* BlendState() const { return blendState_.Get(); }
+    ID3D11RasterizerState* RasterizerState() const { return rasterizerState_.Get(); }
+    ID3D11DepthStencilState* DepthStencilState() const { return depthStencilState_.Get(); }
+    D3D11_PRIMITIVE_TOPOLOGY Topology() const { return topology_; }
+    UINT StencilRef() const { return stencilRef_; }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader_;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout_;
+    Microsoft::WRL::ComPtr<ID3D11BlendState> blendState_;
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterizerState_;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthStencilState_;
+    D3D11_PRIMITIVE_TOPOLOGY topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    UINT stencilRef_ = 0;
+};
+
+/**
+ * @struct StateCacheStats
+ * @brief StateCache が送った・省略した設定の数(ResetStats() からの累計)
+ */
+struct StateCacheStats {
+    uint64_t issued = 0;    ///< コンテキストへ送った設定
+    uint64_t skipped = 0;   ///< 前回と同じため省略した設定
+    uint64_t applies = 0;   ///< Apply() の回数
+};
+
+/**
+ * @class StateCache
+ * @brief 1つのデバイスコンテキストに設定したステートを覚え、重複する設定を省略する
+ *
+ * @details
+ * 定数バッファは VS・PS とも CONSTANT_SLOTS 個、サンプラーは PS の SAMPLER_SLOTS 個までを覚えます
+ * (それより後のスロットは毎回そのまま設定)。シェーダーリソースと頂点バッファは描画ごとに変わるため扱いません。
+ * ブレンド係数は 0、サンプルマスクは 0xFFFFFFFF 固定です。
+ */
+class StateCache {
+public:
+    static constexpr UINT CONSTANT_SLOTS = 8;
+    static constexpr UINT SAMPLER_SLOTS = 4;
+
+    StateCache() = default;
+    explicit StateCache(ID3D11DeviceContext* ctx) : ctx_(ctx) {}
+
+    StateCache(const StateCache&) = delete;
+    StateCache& operator=(const StateCache&) = delete;
+
+    /**
+     * @brief 対象のコンテキストを設定し、覚えている値を捨てる
+     */
+    void Attach(ID3D11DeviceContext* ctx) {
+        ctx_ = ctx;
+        Invalidate();
+    }
+
+    ID3D11DeviceContext* Context() const { return ctx_; }
+
+    /**
+     * @brief 覚えている値をすべて不明にする(キャッシュを通さずにステートを変えた後に呼ぶ)
+     */
+    void Invalidate() {
+        vertexShader_.known = false;
+        pixelShader_.known = false;
+        inputLayout_.known = false;
+        topology_.known = false;
+        blendState_.known = false;
+        rasterizerState_.known = false;
+        depthStencilState_.known = false;
+        for (auto& slot : vsConstantBuffers_) slot.known = false;
+        for (auto& slot : psConstantBuffers_) slot.known = false;
+        for (auto& slot : psSamplers_) slot.known = false;
+    }
+
+    /**
+     * @brief パイプラインステートを設定(前回と同じ項目は省略)
+     */
+    void Apply(const PipelineState& state) {
+        ++stats_.applies;
+        SetInputLayout(state.InputLayout());
+        SetTopology(state.Topology());
+        SetVertexShader(state.VertexShader());
+        SetPixelShader(state.PixelShader());
+        SetBlendState(state.BlendState());
+        SetRasterizerState(state.RasterizerState());
+        SetDepthStencilState(state.DepthStencilState(), state.StencilRef());
+    }
+
+    void SetVertexShader(ID3D11VertexShader* shader) {
+        if (filter(vertexShader_, shader)) ctx_->VSSetShader(shader, nullptr, 0);
+    }
+
+    void SetPixelShader(ID3D11PixelShader* shader) {
+        if (filter(pixelShader_, shader)) ctx_->PSSetShader(shader, nullptr, 0);
+    }
+
+    void SetInputLayout(ID3D11InputLayout* layout) {
+        if (filter(inputLayout_, layout)) ctx_->IASetInputLayout(layout);
+    }
+
+    void SetTopology(D3D11_PRIMITIVE_TOPOLOGY topology) {
+        if (filter(topology_, topology)) ctx_->IASetPrimitiveTopology(topology);
+    }
+
+    void SetBlendState(ID3D11BlendState* state) {
+        if (!filter(blendState_, state)) return;
+        const FLOAT blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        ctx_->OMSetBlendState(state, blendFactor, 0xFFFFFFFFu);
+    }
+
+    void SetRasterizerState(ID3D11RasterizerState* state) {
+        if (filter(rasterizerState_, state)) ctx_->RSSetState(state);
+    }
+
+    void SetDepthStencilState(ID3D11DepthStencilState* state, UINT stencilRef = 0) {
+        if (filter(depthStencilState_, DepthKey{ state, stencilRef })) ctx_->OMSetDepthStencilState(state, stencilRef);
+    }
+
+    void SetVSConstantBuffer(UINT slot, ID3D11Buffer* buffer) {
+        if (slot >= CONSTANT_SLOTS || filter(vsConstantBuffers_[slot], buffer)) ctx_->VSSetConstantBuffers(slot, 1, &buffer);
+    }
+
+    void SetPSConstantBuffer(UINT slot, ID3D11Buffer* buffer) {
+        if (slot >= CONSTANT_SLOTS || filter(psConstantBuffers_[slot], buffer)) ctx_->PSSetConstantBuffers(slot, 1, &buffer);
+    }
+
+    void SetPSSampler(UINT slot, ID3D11SamplerState* sampler) {
+        if (slot >= SAMPLER_SLOTS || filter(psSamplers_[slot], sampler)) ctx_->PSSetSamplers(slot, 1, &sampler);
+    }
+
+    /**
+     * @brief VS の定数バッファのスロットを不明にする(VSSetConstantBuffers1 でオフセット付きに設定した後など)
+     */
+    void ForgetVSConstantBuffer(UINT slot) {
+        if (slot < CONSTANT_SLOTS) vsConstantBuffers_[slot].known = false;
+    }
+
+    const StateCacheStats& GetStats() const { return stats_; }
+    void ResetStats() { stats_ = StateCacheStats{}; }
+
+private:
+    struct DepthKey {
+        ID3D11DepthStencilState* state = nullptr;
+        UINT stencilRef = 0;
+
+        bool operator==(const DepthKey& other) const { return state == other.state && stencilRef == other.stencilRef; }
+    };
+
+    template<class T>
+    struct Slot {
+        T value{};
+        bool known = false;  ///< false ならコンテキストの値は不明(必ず設定する)
+    };
+
+    /**
+     * @return bool 設定が必要な場合 true(値を覚え直す)
+     */
+    template<class T>
+    bool filter(Slot<T>& slot, const T& value) {
+        if (slot.known && slot.value == value) {
+            ++stats_.skipped;
+            return false;
+        }
+        slot.value = value;
+        slot.known = true;
+        ++stats_.issued;
+        return true;
+    }
+
+    ID3D11DeviceContext* ctx_ = nullptr;
+    Slot<ID3D11VertexShader*> vertexShader_;
+    Slot<ID3D11PixelShader*> pixelShader_;
+    Slot<ID3D11InputLayout*> inputLayout_;
+    Slot<D3D11_PRIMITIVE_TOPOLOGY> topology_;
+    Slot<ID3D11BlendState*> blendState_;
+    Slot<ID3D11RasterizerState*> rasterizerState_;
+    Slot<DepthKey> depthStencilState_;
+    Slot<ID3D11Buffer*> vsConstantBuffers_[CONSTANT_SLOTS];
+    Slot<ID3D11Buffer*> psConstantBuffers_[CONSTANT_SLOTS];
+    Slot<ID3D11SamplerState*> psSamplers_[SAMPLER_SLOTS];
+    StateCacheStats stats_;
+};
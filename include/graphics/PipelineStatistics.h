@@ -0,0 +1,140 @@
+/**
+ * @file PipelineStatistics.h
+ * @brief D3D11_QUERY_PIPELINE_STATISTICS による描画パスごとのGPUカウンタ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * ピクセルシェーダーの起動回数などをパス単位で計測し、オーバードローの確認に使います。
+ * クエリは LATENCY 個を順に使い回し、結果は D3D11_ASYNC_GETDATA_DONOTFLUSH で準備ができたものだけ
+ * 読み取ります。CPUがGPUを待つことはなく、結果は数フレーム遅れて届きます。
+ */
+#pragma once
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <string>
+#include "app/DebugLog.h"
+
+/**
+ * @class PipelineStatisticsQuery
+ * @brief 1つの描画パスのパイプライン統計(フレームごとに Begin/End を1回)
+ *
+ * @par 使用例
+ * @code
+ * PipelineStatisticsQuery query;
+ * query.Init(gfx.Dev());
+ *
+ * // 毎フレーム
+ * query.Poll(gfx.Ctx());
+ * query.Begin(gfx.Ctx());
+ * // 描画...
+ * query.End(gfx.Ctx());
+ * if (query.HasResult()) {
+ *     UINT64 ps = query.Latest().PSInvocations;
+ * }
+ * @endcode
+ */
+class PipelineStatisticsQuery {
+public:
+    static constexpr uint32_t LATENCY = 3; ///< 同時に待機できるクエリの数(フレーム)
+
+    /**
+     * @brief クエリの作成
+     * @return bool 作成できた場合 true(失敗時は以降の呼び出しが何もしない)
+     */
+    bool Init(ID3D11Device* dev) {
+        Shutdown();
+        D3D11_QUERY_DESC desc{};
+        desc.Query = D3D11_QUERY_PIPELINE_STATISTICS;
+        for (uint32_t i = 0; i < LATENCY; ++i) {
+            HRESULT hr = dev->CreateQuery(&desc, slots_[i].query.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_WARNING("[PipelineStatistics] クエリの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                Shutdown();
+                return false;
+            }
+        }
+        valid_ = true;
+        return true;
+    }
+
+    void Shutdown() {
+        for (uint32_t i = 0; i < LATENCY; ++i) {
+            slots_[i] = Slot();
+        }
+        next_ = 0;
+        active_ = false;
+        valid_ = false;
+        hasResult_ = false;
+        latest_ = D3D11_QUERY_DATA_PIPELINE_STATISTICS{};
+    }
+
+    bool IsValid() const { return valid_; }
+
+    /**
+     * @brief 完了したクエリの結果を回収(発行した順に、準備ができていないところで止める)
+     */
+    void Poll(ID3D11DeviceContext* ctx) {
+        if (!valid_) return;
+        for (uint32_t n = 0; n < LATENCY; ++n) {
+            Slot& slot = slots_[(next_ + n) % LATENCY]; // next_ が最も古い
+            if (!slot.pending) continue;
+            D3D11_QUERY_DATA_PIPELINE_STATISTICS data{};
+            HRESULT hr = ctx->GetData(slot.query.Get(), &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+            if (hr == S_FALSE) break;
+            slot.pending = false;
+            if (hr == S_OK) {
+                latest_ = data;
+                hasResult_ = true;
+            }
+        }
+    }
+
+    /**
+     * @brief 計測開始(次のクエリがまだ結果待ちの場合、このフレームは計測しない)
+     */
+    void Begin(ID3D11DeviceContext* ctx) {
+        if (!valid_ || active_) return;
+        Slot& slot = slots_[next_];
+        if (slot.pending) return;
+        ctx->Begin(slot.query.Get());
+        active_ = true;
+    }
+
+    /**
+     * @brief 計測終了
+     */
+    void End(ID3D11DeviceContext* ctx) {
+        if (!active_) return;
+        Slot& slot = slots_[next_];
+        ctx->End(slot.query.Get());
+        slot.pending = true;
+        active_ = false;
+        next_ = (next_ + 1) % LATENCY;
+    }
+
+    /**
+     * @brief 最後に回収できた結果があるか
+     */
+    bool HasResult() const { return hasResult_; }
+
+    /**
+     * @brief 最後に回収できた結果(数フレーム前の値)
+     */
+    const D3D11_QUERY_DATA_PIPELINE_STATISTICS& Latest() const { return latest_; }
+
+private:
+    struct Slot {
+        Microsoft::WRL::ComPtr<ID3D11Query> query;
+        bool pending = false;  ///< End() 済みで結果を未回収
+    };
+
+    Slot slots_[LATENCY];
+    uint32_t next_ = 0;        ///< 次に Begin() するスロット
+    bool active_ = false;      ///< Begin() 済みで End() 前
+    bool valid_ = false;
+    bool hasResult_ = false;
+    D3D11_QUERY_DATA_PIPELINE_STATISTICS latest_{};
+};
@@ -0,0 +1,188 @@
+/**
+ * @file RenderProxy.h
+ * @brief 描画に必要なデータだけを詰めた描画プロキシ(SoA、ダブルバッファ)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * RenderSystem はフレームの最初に World から描画対象を抽出し、ワールド行列・メッシュ・
+ * マテリアル・ワールド空間の境界球を RenderProxyBuffer の平坦な配列に書き込みます。
+ * 以降の LOD 選択・カリング・描画キューの作成はこの配列だけを読み、ECS のストレージには触れません。
+ *
+ * RenderProxies は2面のバッファを持ち、抽出は裏面に書いてから Swap() します。
+ * 前のフレームのプロキシは裏面に残るため、描画とは別のスレッドで次のフレームを抽出する構成にも使えます。
+ *
+ * @note ModelComponent のバッファはポインタだけを保持します(参照カウントは増やしません)。
+ *       抽出元のエンティティを破棄する場合は、そのフレームの描画を終えてから行ってください。
+ */
+#pragma once
+#include "ecs/Entity.h"
+#include "components/MeshRenderer.h"
+#include "graphics/MeshLod.h"
+#include "graphics/TextureManager.h"
+#include "graphics/MaterialManager.h"
+#include "graphics/VertexFormat.h"
+#include "app/MemoryTracker.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct RenderProxyMesh
+ * @brief ModelComponent の1レベル分の頂点・インデックスバッファ
+ *
+ * @details
+ * 共有メッシュバッファ(MeshPool)に入っているメッシュは、共有バッファと範囲の先頭を指します。
+ */
+struct RenderProxyMesh {
+    ID3D11Buffer* vertexBuffer = nullptr;           ///< 頂点バッファ
+    ID3D11Buffer* indexBuffer = nullptr;            ///< インデックスバッファ
+    UINT indexCount = 0;                            ///< インデックス数(0 の場合はこのレベルなし)
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT; ///< インデックス形式
+    UINT startIndex = 0;                            ///< 先頭インデックス(StartIndexLocation)
+    INT baseVertex = 0;                             ///< 先頭頂点(BaseVertexLocation)
+    VertexFormat vertexFormat = VertexFormat::Standard; ///< 頂点形式
+};
+
+/**
+ * @struct RenderProxyModelMesh
+ * @brief ModelComponent の全LODのバッファ(levels[0] が元のメッシュ)
+ */
+struct RenderProxyModelMesh {
+    RenderProxyMesh levels[MeshLod::LEVEL_COUNT];
+    DirectX::XMFLOAT4 positionDequant{ 0.0f, 0.0f, 0.0f, 1.0f }; ///< VertexFormat::CompactQuantized の逆量子化(全LOD共通)
+    ID3D11Buffer* skinBuffer = nullptr;                           ///< スキニングの影響(nullptr の場合はスキニングしない)
+    uint32_t boneOffset = 0;                                      ///< RenderProxyBuffer::skinPalettes 内の先頭の行列
+};
+
+/**
+ * @class RenderProxyList
+ * @brief 同じ種類の描画プロキシを列ごとに並べた配列
+ *
+ * @details
+ * 添字 i の各列が1つのプロキシです。Clear() は容量を残すため、
+ * 対象数が変わらなければフレーム間でメモリ確保は発生しません。
+ */
+class RenderProxyList {
+public:
+    template<class T>
+    using Column = TrackedVector<T, MemoryTag::Render>;
+
+    Column<Entity> entities;                  ///< 抽出元のエンティティ(LOD の履歴用)
+    Column<DirectX::XMFLOAT4X4> worlds;       ///< ワールド行列(転置前、補間済み)
+    Column<uint32_t> meshes;                  ///< MeshRenderer は MeshType、ModelComponent は modelMeshes の添字
+    Column<MaterialManager::MaterialHandle> materials; ///< 明示的なマテリアル(INVALID_MATERIAL の場合は色・テクスチャから引く)
+    Column<DirectX::XMFLOAT3> colors;         ///< マテリアルカラー
+    Column<DirectX::XMFLOAT4> uvTransforms;   ///< UVオフセット(xy)とスケール(zw)
+    Column<TextureManager::TextureHandle> textures;       ///< テクスチャ
+    Column<TextureManager::TextureHandle> normalTextures; ///< ノーマルマップ
+    Column<DirectX::XMFLOAT4> bounds;         ///< ワールド空間の境界球(xyz: 中心, w: 半径、0以下はカリングしない)
+    Column<RenderProxyModelMesh> modelMeshes; ///< ModelComponent のバッファ(ModelComponent のリストのみ)
+
+    void Clear() {
+        entities.clear();
+        worlds.clear();
+        meshes.clear();
+        materials.clear();
+        colors.clear();
+        uvTransforms.clear();
+        textures.clear();
+        normalTextures.clear();
+        bounds.clear();
+        modelMeshes.clear();
+    }
+
+    /**
+     * @brief プロキシを1つ追加
+     * @return size_t 追加したプロキシの添字
+     */
+    size_t Add(Entity e, const DirectX::XMMATRIX& world, uint32_t mesh, const DirectX::XMFLOAT3& color,
+               const DirectX::XMFLOAT2& uvOffset, const DirectX::XMFLOAT2& uvScale,
+               TextureManager::TextureHandle texture, TextureManager::TextureHandle normalTexture,
+               const DirectX::XMFLOAT3& boundsCenter, float boundsRadius,
+               MaterialManager::MaterialHandle material = MaterialManager::INVALID_MATERIAL) {
+        entities.push_back(e);
+        worlds.emplace_back();
+        DirectX::XMStoreFloat4x4(&worlds.back(), world);
+        meshes.push_back(mesh);
+        materials.push_back(material);
+        colors.push_back(color);
+        uvTransforms.push_back(DirectX::XMFLOAT4{ uvOffset.x, uvOffset.y, uvScale.x, uvScale.y });
+        textures.push_back(texture);
+        normalTextures.push_back(normalTexture);
+        bounds.push_back(DirectX::XMFLOAT4{ boundsCenter.x, boundsCenter.y, boundsCenter.z, boundsRadius });
+        return entities.size() - 1;
+    }
+
+    size_t Size() const { return entities.size(); }
+    bool Empty() const { return entities.empty(); }
+
+    DirectX::XMFLOAT3 BoundsCenter(size_t i) const { return DirectX::XMFLOAT3{ bounds[i].x, bounds[i].y, bounds[i].z }; }
+    float BoundsRadius(size_t i) const { return bounds[i].w; }
+    DirectX::XMFLOAT2 UvOffset(size_t i) const { return DirectX::XMFLOAT2{ uvTransforms[i].x, uvTransforms[i].y }; }
+    DirectX::XMFLOAT2 UvScale(size_t i) const { return DirectX::XMFLOAT2{ uvTransforms[i].z, uvTransforms[i].w }; }
+};
+
+/**
+ * @struct RenderProxyBuffer
+ * @brief 1フレーム分の描画プロキシ
+ */
+struct RenderProxyBuffer {
+    RenderProxyList meshes; ///< MeshRenderer(StaticBatch を除く)
+    RenderProxyList models; ///< ModelComponent
+    RenderProxyList::Column<DirectX::XMFLOAT4X4> skinPalettes; ///< スキニングされたモデルの行列(SkinPose のパレットを連結、転置済み)
+
+    void Clear() {
+        meshes.Clear();
+        models.Clear();
+        skinPalettes.clear();
+    }
+
+    size_t Size() const { return meshes.Size() + models.Size(); }
+};
+
+/**
+ * @class RenderProxies
+ * @brief 描画プロキシのダブルバッファ
+ *
+ * @par 使用例
+ * @code
+ * RenderProxyBuffer& back = proxies.Back();
+ * back.Clear();
+ * // back.meshes.Add(...) で抽出
+ * proxies.Swap();
+ * const RenderProxyBuffer& frame = proxies.Front(); // 今回描画するプロキシ
+ * @endcode
+ */
+class RenderProxies {
+public:
+    /**
+     * @brief 抽出の書き込み先
+     */
+    RenderProxyBuffer& Back() { return buffers_[front_ ^ 1u]; }
+
+    /**
+     * @brief 最後に Swap() したプロキシ(描画側が読む)
+     */
+    const RenderProxyBuffer& Front() const { return buffers_[front_]; }
+
+    /**
+     * @brief 裏面を表に切り替える
+     */
+    void Swap() { front_ ^= 1u; }
+
+    /**
+     * @brief 両面を空にする(World を切り替えた場合など)
+     */
+    void Clear() {
+        buffers_[0].Clear();
+        buffers_[1].Clear();
+    }
+
+private:
+    RenderProxyBuffer buffers_[2];
+    uint32_t front_ = 0;
+};
@@ -0,0 +1,206 @@
+/**
+ * @file RenderQueue.h
+ * @brief ソートキー付きの描画パケット列
+ * @author 山内陽
+ * @date 2025
+ * @version 1.3
+ *
+ * @details
+ * 描画対象を一度平坦な配列に集めてから64ビットのソートキーで並べ替え、
+ * 同じステート(シェーダー・マテリアル・メッシュ)の描画を連続させます。
+ * 送信側は直前と同じステートの設定を省略できます。
+ */
+#pragma once
+#include "graphics/VertexFormat.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct DrawPacket
+ * @brief 1回の DrawIndexed に必要な情報
+ */
+struct DrawPacket {
+    uint64_t sortKey = 0;                              ///< RenderQueue::MakeKey() で作成したキー
+    ID3D11Buffer* vertexBuffer = nullptr;              ///< 頂点バッファ
+    ID3D11Buffer* indexBuffer = nullptr;               ///< インデックスバッファ
+    UINT indexCount = 0;                               ///< インデックス数
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;    ///< インデックス形式
+    UINT startIndex = 0;                               ///< 先頭インデックス(共有メッシュバッファ内の位置)
+    INT baseVertex = 0;                                ///< 先頭頂点(共有メッシュバッファ内の位置)
+    VertexFormat vertexFormat = VertexFormat::Standard; ///< 頂点形式(CompactQuantized の world は逆量子化を含む)
+    DirectX::XMFLOAT4X4 world;                         ///< ワールド行列(転置前)
+    DirectX::XMFLOAT2 uvOffset{ 0.0f, 0.0f };          ///< UVオフセット
+    DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };           ///< UVスケール
+    uint32_t material = 0;                             ///< マテリアルハンドル(MaterialManager)
+    ID3D11Buffer* materialBuffer = nullptr;            ///< マテリアルの不変の定数バッファ(PS の b0)
+    uint32_t texture = 0;                              ///< テクスチャハンドル(マテリアルの内容、シェーダーの選択とバインド用)
+    uint32_t normalTexture = 0;                        ///< ノーマルマップハンドル(同上)
+    bool isModel = false;                              ///< ModelComponent 由来か(統計用)
+    ID3D11Buffer* skinBuffer = nullptr;                ///< スキニングの影響(2本目の頂点ストリーム、nullptr の場合はスキニングしない)
+    uint32_t boneOffset = 0;                           ///< スキニング行列のバッファ内の先頭
+};
+
+/**
+ * @class RenderQueue
+ * @brief 描画パケットの収集と基数ソート
+ *
+ * @details
+ * ### ソートキーのレイアウト(上位ビットから):
+ * - pass    (4ビット): 描画パス(不透明・半透明など)
+ * - shader  (4ビット): シェーダーの組み合わせ
+ * - material(20ビット): マテリアル(色・テクスチャ・スペキュラ)
+ * - mesh    (20ビット): メッシュ(頂点バッファ)
+ * - depth   (16ビット): カメラからの距離(近い順)
+ *
+ * MakeDepthFirstKey() は depth を pass の直後に置き、パス内を手前から奥の順に並べます
+ * (ステートの切り替えは増えますが、深度テストで隠れたピクセルのシェーディングが減ります)。
+ *
+ * @par 使用例
+ * @code
+ * queue.Clear();
+ * DrawPacket& p = queue.Push();
+ * p.sortKey = RenderQueue::MakeKey(0, 0, material, meshId, RenderQueue::QuantizeDepth(z, nearZ, farZ));
+ * queue.Sort();
+ * for (size_t i = 0; i < queue.Size(); ++i) {
+ *     const DrawPacket& packet = queue.Sorted(i);
+ * }
+ * @endcode
+ */
+class RenderQueue {
+public:
+    static constexpr uint32_t PASS_BITS = 4;     ///< pass のビット数
+    static constexpr uint32_t SHADER_BITS = 4;   ///< shader のビット数
+    static constexpr uint32_t MATERIAL_BITS = 20; ///< material のビット数
+    static constexpr uint32_t MESH_BITS = 20;    ///< mesh のビット数
+    static constexpr uint32_t DEPTH_BITS = 16;   ///< depth のビット数
+
+    /**
+     * @brief ソートキーを作成(各フィールドはビット数でマスク)
+     */
+    static uint64_t MakeKey(uint32_t pass, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t depth) {
+        uint64_t key = pass & ((1u << PASS_BITS) - 1);
+        key = (key << SHADER_BITS) | (shader & ((1u << SHADER_BITS) - 1));
+        key = (key << MATERIAL_BITS) | (material & ((1u << MATERIAL_BITS) - 1));
+        key = (key << MESH_BITS) | (mesh & ((1u << MESH_BITS) - 1));
+        key = (key << DEPTH_BITS) | (depth & ((1u << DEPTH_BITS) - 1));
+        return key;
+    }
+
+    /**
+     * @brief 手前から奥を優先するソートキーを作成(pass, depth, shader, material, mesh の順)
+     */
+    static uint64_t MakeDepthFirstKey(uint32_t pass, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t depth) {
+        uint64_t key = pass & ((1u << PASS_BITS) - 1);
+        key = (key << DEPTH_BITS) | (depth & ((1u << DEPTH_BITS) - 1));
+        key = (key << SHADER_BITS) | (shader & ((1u << SHADER_BITS) - 1));
+        key = (key << MATERIAL_BITS) | (material & ((1u << MATERIAL_BITS) - 1));
+        key = (key << MESH_BITS) | (mesh & ((1u << MESH_BITS) - 1));
+        return key;
+    }
+
+    /**
+     * @brief ビュー空間の奥行きを depth フィールドに量子化
+     * @param[in] viewZ ビュー空間のZ
+     * @param[in] nearZ ニアクリップ
+     * @param[in] farZ ファークリップ
+     */
+    static uint32_t QuantizeDepth(float viewZ, float nearZ, float farZ) {
+        float range = farZ - nearZ;
+        float t = range > 0.0f ? (viewZ - nearZ) / range : 0.0f;
+        if (t < 0.0f) t = 0.0f;
+        if (t > 1.0f) t = 1.0f;
+        return static_cast<uint32_t>(t * static_cast<float>((1u << DEPTH_BITS) - 1));
+    }
+
+    void Clear() {
+        packets_.clear();
+        order_.clear();
+    }
+
+    /**
+     * @brief パケットを追加(返した参照は次の Push() まで有効)
+     */
+    DrawPacket& Push() {
+        packets_.emplace_back();
+        return packets_.back();
+    }
+
+    size_t Size() const { return packets_.size(); }
+    bool Empty() const { return packets_.empty(); }
+
+    /**
+     * @brief keep[i] が 0 のパケットを取り除く(Sort() の前に使用、追加順は保つ)
+     * @param[in] keep Size() 個のフラグ
+     */
+    void Retain(const uint8_t* keep) {
+        size_t write = 0;
+        for (size_t read = 0; read < packets_.size(); ++read) {
+            if (!keep[read]) continue;
+            if (write != read) packets_[write] = packets_[read];
+            ++write;
+        }
+        packets_.resize(write);
+    }
+
+    /**
+     * @brief ソートキーで並べ替え(LSD基数ソート、8ビット x 8パス)
+     *
+     * @details
+     * パケット本体は動かさず、キーと位置の組だけを並べ替えます。
+     * 全要素が同じバイトを持つパスは省略します。同じキーは追加順を保ちます。
+     */
+    void Sort() {
+        const size_t n = packets_.size();
+        order_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            order_[i] = SortEntry{ packets_[i].sortKey, static_cast<uint32_t>(i) };
+        }
+        if (n < 2) return;
+
+        size_t histogram[8][256] = {};
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t key = order_[i].key;
+            for (int pass = 0; pass < 8; ++pass) {
+                ++histogram[pass][(key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        scratch_.resize(n);
+        for (int pass = 0; pass < 8; ++pass) {
+            size_t* counts = histogram[pass];
+            if (counts[(order_[0].key >> (pass * 8)) & 0xFF] == n) continue; // 全要素が同じバイト
+
+            size_t offset = 0;
+            for (int b = 0; b < 256; ++b) {
+                size_t c = counts[b];
+                counts[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                const SortEntry& e = order_[i];
+                scratch_[counts[(e.key >> (pass * 8)) & 0xFF]++] = e;
+            }
+            order_.swap(scratch_);
+        }
+    }
+
+    /**
+     * @brief ソート後 i 番目のパケット(Sort() の後に使用)
+     */
+    const DrawPacket& Sorted(size_t i) const {
+        return packets_[order_[i].index];
+    }
+
+private:
+    struct SortEntry {
+        uint64_t key;    ///< ソートキー
+        uint32_t index;  ///< packets_ 内の位置
+    };
+
+    std::vector<DrawPacket> packets_;  ///< 追加順のパケット
+    std::vector<SortEntry> order_;     ///< ソート済みの順序
+    std::vector<SortEntry> scratch_;   ///< 基数ソートの作業領域
+};
@@ -0,0 +1,195 @@
+/**
+ * @file RenderSnapshot.h
+ * @brief 描画に使うコンポーネントだけを写し取った World(並列シミュレーション用)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * シミュレーションと描画を並行して行う場合、描画スレッドはシミュレーション中の World を読めません。
+ * Capture() は両者が止まっている同期点で、描画が参照するコンポーネント
+ * (Transform / LocalToWorld / MeshRenderer / PackedMeshRenderer / StaticBatch / ModelComponent / SkinPose / ライト / ParticleEmitter / Sprite / VideoSurface)を
+ * 専用の World にコピーします。RenderSystem::Render() はこの World をそのまま描画できます。
+ *
+ * 元のエンティティと写し先のエンティティの対応は保持するため、LOD の履歴や静的バッチの
+ * 変更検出は描画側で通常どおり働きます。値が変わらなかったコンポーネントは書き換えないので、
+ * 静的バッチは元の World で変わったときだけ再構築されます。
+ */
+#pragma once
+#include "ecs/World.h"
+#include "components/Transform.h"
+#include "components/TransformHierarchy.h"
+#include "components/MeshRenderer.h"
+#include "components/PackedMeshRenderer.h"
+#include "components/ModelComponent.h"
+#include "components/Animator.h"
+#include "components/Light.h"
+#include "components/ParticleEmitter.h"
+#include "components/Sprite.h"
+#include "components/VideoSurface.h"
+#include "app/Profiler.h"
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+/**
+ * @class RenderSnapshot
+ * @brief 描画用コンポーネントの差分コピー
+ *
+ * @par 使用例
+ * @code
+ * RenderSnapshot snapshot;
+ *
+ * // 同期点(シミュレーションが止まっている間)
+ * snapshot.Capture(world);
+ *
+ * // 次のシミュレーションと並行して
+ * renderer.Render(snapshot.GetWorld(), camera);
+ * @endcode
+ */
+class RenderSnapshot {
+public:
+    /**
+     * @brief source の描画用コンポーネントを写し取る
+     *
+     * @details
+     * 追加・変更されたコンポーネントを反映し、なくなったコンポーネントとエンティティを取り除きます。
+     * コストは描画対象のエンティティ数に比例します。
+     */
+    void Capture(World& source) {
+        PROFILE_SCOPE("RenderSnapshot::Capture");
+        ++captureIndex_;
+
+        captureType<Transform>(source, TRANSFORM_BIT);
+        captureType<LocalToWorld>(source, LOCAL_TO_WORLD_BIT);
+        captureType<MeshRenderer>(source, MESH_RENDERER_BIT);
+        captureType<PackedMeshRenderer>(source, PACKED_MESH_RENDERER_BIT);
+        captureType<StaticBatch>(source, STATIC_BATCH_BIT);
+        captureType<ModelComponent>(source, MODEL_BIT);
+        captureType<SkinPose>(source, SKIN_POSE_BIT);
+        captureType<DirectionalLight>(source, DIRECTIONAL_LIGHT_BIT);
+        captureType<PointLight>(source, POINT_LIGHT_BIT);
+        captureType<SpotLight>(source, SPOT_LIGHT_BIT);
+        captureType<ParticleEmitter>(source, PARTICLE_EMITTER_BIT);
+        captureType<Sprite>(source, SPRITE_BIT);
+        captureType<VideoSurface>(source, VIDEO_SURFACE_BIT);
+
+        for (auto it = slots_.begin(); it != slots_.end();) {
+            Slot& slot = it->second;
+            if (slot.capture != captureIndex_) {
+                world_.DestroyEntity(slot.entity);
+                it = slots_.erase(it);
+                continue;
+            }
+            uint32_t removed = slot.previousMask & ~slot.mask;
+            if (removed) removeTypes(slot.entity, removed);
+            ++it;
+        }
+        world_.FlushDestroyEndOfFrame();
+    }
+
+    /**
+     * @brief 描画に渡す World
+     */
+    World& GetWorld() { return world_; }
+
+    /**
+     * @brief 写し取ったエンティティ数
+     */
+    size_t EntityCount() const { return slots_.size(); }
+
+private:
+    static constexpr uint32_t TRANSFORM_BIT = 1u << 0;
+    static constexpr uint32_t LOCAL_TO_WORLD_BIT = 1u << 1;
+    static constexpr uint32_t MESH_RENDERER_BIT = 1u << 2;
+    static constexpr uint32_t STATIC_BATCH_BIT = 1u << 3;
+    static constexpr uint32_t MODEL_BIT = 1u << 4;
+    static constexpr uint32_t DIRECTIONAL_LIGHT_BIT = 1u << 5;
+    static constexpr uint32_t POINT_LIGHT_BIT = 1u << 6;
+    static constexpr uint32_t SPOT_LIGHT_BIT = 1u << 7;
+    static constexpr uint32_t PARTICLE_EMITTER_BIT = 1u << 8;
+    static constexpr uint32_t SKIN_POSE_BIT = 1u << 9;
+    static constexpr uint32_t SPRITE_BIT = 1u << 10;
+    static constexpr uint32_t VIDEO_SURFACE_BIT = 1u << 11;
+    static constexpr uint32_t PACKED_MESH_RENDERER_BIT = 1u << 12;
+
+    /**
+     * @struct Slot
+     * @brief 元のエンティティ1つ分の写し
+     */
+    struct Slot {
+        Entity entity{};           ///< 写し先のエンティティ
+        uint32_t capture = 0;      ///< 最後に見つかった Capture() の番号
+        uint32_t mask = 0;         ///< 今回コピーしたコンポーネント
+        uint32_t previousMask = 0; ///< 前回コピーしたコンポーネント
+    };
+
+    template<class T>
+    void captureType(World& source, uint32_t bit) {
+        source.ForEach<T>([this, bit](Entity e, T& value) {
+            Slot& slot = slotFor(e);
+            slot.mask |= bit;
+            copyComponent(slot.entity, value);
+        });
+    }
+
+    // 元のエンティティの写しを取得(初めてなら作成、今回の Capture() で最初なら mask をやり直す)
+    Slot& slotFor(Entity e) {
+        auto it = slots_.find(e);
+        if (it == slots_.end()) {
+            it = slots_.emplace(e, Slot{ world_.CreateEntity(), 0, 0, 0 }).first;
+        }
+        Slot& slot = it->second;
+        if (slot.capture != captureIndex_) {
+            slot.capture = captureIndex_;
+            slot.previousMask = slot.mask;
+            slot.mask = 0;
+        }
+        return slot;
+    }
+
+    // 値が同じなら書き換えない(TryGet は変更ティックを記録するため)
+    template<class T>
+    void copyComponent(Entity target, const T& value) {
+        const T* existing = world_.Peek<T>(target);
+        if (!existing) {
+            world_.Add<T>(target, value);
+            return;
+        }
+        if (sameValue(*existing, value)) return;
+        *world_.TryGet<T>(target) = value;
+    }
+
+    // ComPtr や配列を持つ型(ModelComponent / SkinPose)は比較せず毎回コピーする
+    template<class T>
+    static bool sameValue(const T& a, const T& b) {
+        if constexpr (std::is_empty<T>::value) {
+            return true;
+        } else if constexpr (std::is_trivially_copyable<T>::value) {
+            return std::memcmp(&a, &b, sizeof(T)) == 0;
+        } else {
+            return false;
+        }
+    }
+
+    void removeTypes(Entity target, uint32_t removed) {
+        if (removed & TRANSFORM_BIT) world_.Remove<Transform>(target);
+        if (removed & LOCAL_TO_WORLD_BIT) world_.Remove<LocalToWorld>(target);
+        if (removed & MESH_RENDERER_BIT) world_.Remove<MeshRenderer>(target);
+        if (removed & PACKED_MESH_RENDERER_BIT) world_.Remove<PackedMeshRenderer>(target);
+        if (removed & STATIC_BATCH_BIT) world_.Remove<StaticBatch>(target);
+        if (removed & MODEL_BIT) world_.Remove<ModelComponent>(target);
+        if (removed & SKIN_POSE_BIT) world_.Remove<SkinPose>(target);
+        if (removed & DIRECTIONAL_LIGHT_BIT) world_.Remove<DirectionalLight>(target);
+        if (removed & POINT_LIGHT_BIT) world_.Remove<PointLight>(target);
+        if (removed & SPOT_LIGHT_BIT) world_.Remove<SpotLight>(target);
+        if (removed & PARTICLE_EMITTER_BIT) world_.Remove<ParticleEmitter>(target);
+        if (removed & SPRITE_BIT) world_.Remove<Sprite>(target);
+        if (removed & VIDEO_SURFACE_BIT) world_.Remove<VideoSurface>(target);
+    }
+
+    World world_;                               ///< 描画用の写し
+    std::unordered_map<Entity, Slot> slots_;    ///< 元のエンティティ → 写し
+    uint32_t captureIndex_ = 0;                 ///< Capture() の呼び出し回数
+};
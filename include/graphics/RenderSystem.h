@@ -3,7 +3,7 @@
  * @brief 3Dレンダリングシステム
  * @author 山内陽
  * @date 2025
- * @version 7.0
+ * @version 7.21
  *
  * @details
  * DirectX11を使用した3Dレンダリングシステムです。
@@ -14,21 +14,59 @@
 #include "graphics/Camera.h"
 #include "ecs/World.h"
 #include "components/Transform.h"
+#include "components/TransformHierarchy.h"
 #include "components/MeshRenderer.h"
 #include "components/ModelComponent.h"
+#include "components/PackedMeshRenderer.h"
+#include "components/Animator.h"
 #include "components/Light.h"
 #include "graphics/TextureManager.h"
+#include "graphics/MaterialManager.h"
+#include "graphics/RenderQueue.h"
+#include "graphics/TransparentQueue.h"
+#include "graphics/RenderProxy.h"
+#include "graphics/FrustumCulling.h"
+#include "graphics/OcclusionCulling.h"
+#include "graphics/DynamicBvh.h"
+#include "graphics/ConstantBufferRing.h"
+#include "graphics/MeshLod.h"
+#include "graphics/VertexFormat.h"
+#include "graphics/LightClusters.h"
+#include "graphics/ParticleSystem.h"
+#include "graphics/GpuMovers.h"
+#include "graphics/SharedModelTable.h"
+#include "graphics/VideoSurfaceRenderer.h"
+#include "graphics/GpuCulling.h"
+#include "graphics/CascadedShadowMaps.h"
+#include "graphics/PipelineStatistics.h"
+#include "graphics/WorldMatrixBatch.h"
+#include "app/JobSystem.h"
+#include "app/ParallelAlgorithms.h"
 #include "app/DebugLog.h"
+#include "app/Profiler.h"
+#include "app/MemoryTracker.h"
 #include "app/ServiceLocator.h"
+#include "app/StartupReport.h"
+#include "app/FileWatcher.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/FrameCapture.h"
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 #include <wrl/client.h>
 #include <cstring>
 #include <cstdio>
+#include <climits>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <atomic>
+#include <fstream>
+#include <sstream>
 
 #pragma comment(lib, "d3dcompiler.lib")
 
@@ -41,9 +79,26 @@
  *
  * ### 主な機能:
  * - Blinn-Phongライティングモデル
+ * - 点光源・スポットライトのクラスタードフォワードシェーディング(LightClusters)
  * - ノーマルマッピング対応
  * - テクスチャサポート
  * - 基本形状(Cube, Sphere, Cylinder, Plane)の描画
+ * - MeshRenderer のインスタンス描画(メッシュ種別・テクスチャごとに1ドロー)
+ * - 同じモデルのメッシュを使う ModelComponent のインスタンス描画(メッシュのバッファと範囲・テクスチャごとに1ドロー)
+ * - インスタンスの視錐台カリングをコンピュートシェーダーで行い、DrawIndexedInstancedIndirect で描く経路(機能レベル 11_0 以上、GpuCulling)
+ * - ソートキー付き描画キューによる冗長なステート設定の省略
+ * - テクスチャ・ノーマルマップの有無ごとのピクセルシェーダーのバリアント(ピクセル単位の分岐なし)
+ * - 画面上の大きさによるLOD選択(球体・円柱は3段階の分割数、モデルは簡略化メッシュ)
+ * - 描画キューの深度プリパスと手前から奥へのソート(オーバードローの削減、既定は無効)
+ * - 半透明のマテリアル(MaterialDesc::opacity < 1)を不透明の後に奥から手前へアルファブレンドで描く半透明パス(TransparentQueue)
+ * - パスごとのGPU時間の計測(GfxDevice::Profiler() が有効な場合、GPU_SCOPE_* の名前で記録)
+ * - 描画プロキシの抽出(フレームの最初に MeshRenderer・ModelComponent を RenderProxyBuffer に詰め、以降は World を読まない)
+ * - 基本形状とモデルのメッシュを共有頂点・インデックスバッファ(GfxDevice::Meshes())に置き、メッシュを切り替えても IA の設定を省略
+ * - ParticleEmitter からのGPUパーティクル(放出・移動・詰め直しはコンピュートシェーダー、描画は間接描画。ParticleSystem)
+ * - VideoSurface の動画(VideoPlayer のフレームを変換・コピーせずに直接サンプリング。VideoSurfaceRenderer)
+ * - モデルの小さな頂点形式(VertexFormat、half の UV・八面体の法線・接線・量子化した位置)を頂点シェーダーのバリアントで描画
+ * - メッシュのシェーダーのホットリロード(SetShaderHotReloadEnabled()、書き出したHLSLの変更をワーカーで検証してから差し替え)
+ * - 描画キューの1フレーム分の記録と再生(RequestFrameCapture() / BeginReplay()、FrameCapture.h)
  *
  * @par 使用例
  * @code
@@ -62,52 +117,261 @@
 struct RenderSystem {
     /**
      * @struct VSConstants
-     * @brief 頂点シェーダー用定数バッファ
+     * @brief 頂点シェーダー用定数バッファ(描画ごと。ビュー・プロジェクションは FrameConstants)
      */
     struct VSConstants {
         DirectX::XMMATRIX World;      ///< ワールド行列
-        DirectX::XMMATRIX WVP;        ///< ワールド・ビュー・プロジェクション行列
         DirectX::XMFLOAT4 uvTransform; ///< UVオフセットとスケール
     };
 
-  /**
-     * @struct PSConstants
-     * @brief ピクセルシェーダー用オブジェクト定数バッファ
-     */
-    struct PSConstants {
-        DirectX::XMFLOAT4 color;///< マテリアルカラー
-        float useTexture;     ///< テクスチャ使用フラグ
-        float useNormalMap;     ///< ノーマルマップ使用フラグ
-        float specularPower;     ///< スペキュラ強度
-        float padding;       ///< パディング
+    /**
+     * @struct FrameConstants
+     * @brief カメラと画面で決まるフレームごとの定数バッファ(VS の b2 と PS の b3、全バリアント共通)
+     *
+     * @details
+     * 内容が前のフレームと同じ(カメラも画面の大きさも変わらない)場合は送りません。
+     */
+    struct FrameConstants {
+        DirectX::XMMATRIX viewProj;                 ///< ビュー・プロジェクション行列(転置済み、Camera::ViewProj)
+        DirectX::XMFLOAT3 eyePos{ 0.0f, 0.0f, 0.0f }; ///< カメラ位置
+        float padding0 = 0.0f;                      ///< パディング
+        DirectX::XMFLOAT2 screenSize{ 1.0f, 1.0f };  ///< 画面サイズ(ピクセル、タイルの計算用)
+        float clusterNear = 0.1f;                   ///< 奥行き分割の基準(ニアクリップ)
+        float clusterLogScale = 0.0f;               ///< DIM_Z / log(far / near)
+        uint32_t clusterDims[3] = { LightClusters::DIM_X, LightClusters::DIM_Y, LightClusters::DIM_Z }; ///< クラスタの分割数
+        float padding1 = 0.0f;                      ///< パディング
     };
 
+  /**
+     * @brief ピクセルシェーダー用オブジェクト定数バッファ(マテリアルごとの不変のバッファ、MaterialManager)
+     */
+    using PSConstants = MaterialManager::Constants;
+
     /**
      * @struct PSLightConstants
-     * @brief ピクセルシェーダー用ライト定数バッファ
+     * @brief ピクセルシェーダー用ライト定数バッファ(PS の b1、ディレクショナルライトが変わった時だけ送る)
      */
     struct PSLightConstants {
         DirectionalLight light; ///< ディレクショナルライト
         DirectX::XMFLOAT3 ambientColor{ 0.2f, 0.2f, 0.2f };  ///< アンビエントカラー
-float padding2;         ///< パディング
-        DirectX::XMFLOAT3 eyePos;                 ///< カメラ位置
-   float padding3;      ///< パディング
- };
+        float padding = 0.0f;   ///< パディング
+    };
+
+    /**
+     * @struct CachedConstants
+     * @brief 前回送った内容を覚えておき、変わった時だけ UpdateSubresource する定数バッファ
+     */
+    template<class T>
+    struct CachedConstants {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        T uploaded{};          ///< 前回送った内容
+        bool valid = false;    ///< uploaded が buffer の内容と一致しているか(作成直後は false)
+
+        /**
+         * @return bool 送った場合 true(同じ内容なら何もせず false)
+         */
+        bool Upload(ID3D11DeviceContext* ctx, const T& value) {
+            if (valid && std::memcmp(&uploaded, &value, sizeof(T)) == 0) return false;
+            ctx->UpdateSubresource(buffer.Get(), 0, nullptr, &value, 0, 0);
+            uploaded = value;
+            valid = true;
+            return true;
+        }
+
+        void Reset() {
+            buffer.Reset();
+            valid = false;
+        }
+    };
+
+    // GpuProfiler のスコープ名(GfxDevice::Profiler().ScopeMs() で参照)
+    static constexpr const char* GPU_SCOPE_RENDER = "Render";                ///< Render() 全体
+    static constexpr const char* GPU_SCOPE_INSTANCED = "Render.Instanced";   ///< MeshRenderer のインスタンス描画
+    static constexpr const char* GPU_SCOPE_DEPTH_PREPASS = "Render.DepthPrepass"; ///< 描画キューの深度プリパス
+    static constexpr const char* GPU_SCOPE_QUEUE = "Render.Queue";           ///< 描画キュー(ModelComponent・静的バッチなど)
+    static constexpr const char* GPU_SCOPE_TRANSPARENT = "Render.Transparent"; ///< 半透明パス
+    static constexpr const char* GPU_SCOPE_SHADOWS = "Render.Shadows";       ///< カスケードシャドウマップの深度描画
+    static constexpr const char* GPU_SCOPE_PARTICLES = "Render.Particles";   ///< GPUパーティクルの更新と描画
+    static constexpr const char* GPU_SCOPE_GPU_MOVERS = "Render.GpuMovers";  ///< GpuMover の積分とインスタンス描画
+    static constexpr const char* GPU_SCOPE_VIDEO = "Render.Video";           ///< VideoSurface の描画(ゲーム内の面と全画面)
+
+    static constexpr size_t STATISTICS_HISTORY_FRAMES = 240; ///< GetStatisticsHistory() で遡れるフレーム数
 
     /**
      * @struct Statistics
      * @brief レンダリング統計情報
      */
     struct Statistics {
+        /**
+         * @brief ステート設定の種類(stateChangesByKind の添字)
+         */
+        enum StateKind : uint32_t {
+            STATE_SHADER,          ///< ピクセルシェーダー
+            STATE_MATERIAL,        ///< マテリアルの定数バッファ
+            STATE_TEXTURE,         ///< テクスチャの組
+            STATE_MESH,            ///< 頂点・インデックスバッファ
+            STATE_VERTEX_FORMAT,   ///< 頂点シェーダーと入力レイアウト
+            STATE_SKIN,            ///< スキニングの影響のバッファ
+            STATE_KIND_COUNT
+        };
+
+        /**
+         * @brief CPU時間を計る描画の段階(passMs の添字、Render() の実行順)
+         */
+        enum Pass : uint32_t {
+            PASS_LIGHTS,           ///< ライトの定数とクラスタ
+            PASS_EXTRACT,          ///< 描画プロキシの抽出
+            PASS_CULLING,          ///< カリング用BVHと遮蔽物のラスタライズ
+            PASS_MODELS,           ///< スキニング行列の書き込みと ModelComponent の描画キューへの追加
+            PASS_STATIC_BATCHES,   ///< 静的バッチ
+            PASS_SHADOWS,          ///< シャドウマップ
+            PASS_INSTANCED,        ///< MeshRenderer のインスタンス描画
+            PASS_QUEUE,            ///< 描画キュー(不透明・半透明)のカリング・ソート・送信
+            PASS_PARTICLES,        ///< GPUパーティクル
+            PASS_GPU_MOVERS,       ///< GpuMover の積分と描画
+            PASS_COUNT
+        };
+
+        static const char* StateKindName(uint32_t kind) {
+            static const char* const NAMES[STATE_KIND_COUNT] = { "shader", "material", "texture", "mesh", "vertex_format", "skin" };
+            return kind < STATE_KIND_COUNT ? NAMES[kind] : "?";
+        }
+
+        static const char* PassName(uint32_t pass) {
+            static const char* const NAMES[PASS_COUNT] = {
+                "lights", "extract", "culling", "models", "static_batches", "shadows", "instanced", "queue", "particles", "gpu_movers"
+            };
+            return pass < PASS_COUNT ? NAMES[pass] : "?";
+        }
+
+        uint64_t frame = 0;            ///< Render() の通し番号
         size_t modelsRendered = 0;     ///< 描画されたModelComponentの数
       size_t meshesRendered = 0;  ///< 描画されたMeshRendererの数
         size_t totalDrawCalls = 0;     ///< 総描画コール数
+        size_t instancedDraws = 0;     ///< インスタンス描画のドローコール数
+        size_t instancesRendered = 0;  ///< インスタンス描画で描いたインスタンス数
+        size_t stateChanges = 0;       ///< 実際に行ったステート設定(メッシュ・テクスチャ・PS定数)
+        size_t stateChangesSkipped = 0; ///< 直前と同じため省略したステート設定
+        size_t culled = 0;             ///< 視錐台カリングで除外した描画対象
+        size_t treeCulled = 0;         ///< culled のうちカリング用BVHの検索で除外した数
+        size_t occluded = 0;           ///< 視錐台の内側で、遮蔽カリングで除外した描画対象
+        size_t occluders = 0;          ///< 遮蔽カリングでラスタライズした遮蔽物の数
+        size_t commandLists = 0;       ///< 遅延コンテキストで記録して実行したコマンドリスト数
+        size_t staticBatches = 0;      ///< 描画キューに追加した静的バッチ数
+        size_t staticBatchedMeshes = 0; ///< 静的バッチにまとめたMeshRendererの数
+        size_t lodReduced = 0;         ///< LOD1以上を選択した描画対象(カリング前)
+        size_t lights = 0;             ///< 点光源・スポットライトの数
+        size_t lightClusterEntries = 0; ///< クラスタに登録したライトの延べ数
+        size_t depthPrepassDraws = 0;  ///< 深度プリパスのドローコール数
+        size_t transparentDraws = 0;   ///< 半透明パスのドローコール数
+        size_t transparentBatches = 0; ///< 半透明パスでステートをまとめた描画のまとまり数
+        size_t videoSurfaces = 0;      ///< 描いた VideoSurface の数
+        float submitMs = 0.0f;         ///< 描画キューの送信にかかったCPU時間(ミリ秒)
+        size_t proxies = 0;            ///< 抽出した描画プロキシ数
+        float extractMs = 0.0f;        ///< 描画プロキシの抽出にかかったCPU時間(ミリ秒)
+        uint64_t psInvocations = 0;    ///< ピクセルシェーダーの起動回数(GPU計測、数フレーム前の値)
+        uint64_t depthPrepassPrimitives = 0; ///< 深度プリパスでラスタライズしたプリミティブ数(同上)
+        float overdraw = 0.0f;         ///< psInvocations / 画面のピクセル数(同上)
+        size_t gpuCullInstances = 0;   ///< GPUで視錐台カリングしたインスタンス数(このとき meshesRendered・instancesRendered は判定前の数)
+        size_t indirectDraws = 0;      ///< DrawIndexedInstancedIndirect のドローコール数
+        size_t particleEmitters = 0;   ///< 粒子を放出した ParticleEmitter の数
+        size_t particlesEmitted = 0;   ///< 放出を要求した粒子数(生存数はGPUにしかないため含まない)
+        size_t gpuMovers = 0;          ///< GPUで積分・描画した GpuMover の数
+        size_t gpuMoversSpawned = 0;   ///< このフレームにGPUへ書き込んだ GpuMover の数
+        size_t skinnedModels = 0;      ///< スキニング行列を渡した ModelComponent の数(カリング前)
+        size_t skinningMatrices = 0;   ///< スキニング行列のバッファに書き込んだ行列数
+        size_t shadowCascades = 0;     ///< 描き直したシャドウマップのカスケード数
+        size_t shadowCasters = 0;      ///< シャドウマップに描いたキャスター数(カスケードの重複を含む)
+        size_t shadowDraws = 0;        ///< シャドウマップのドローコール数
+        size_t trianglesRendered = 0;  ///< 描画した三角形数(インスタンス分を含む。シャドウマップ・パーティクルを除く)
+        size_t textureBinds = 0;       ///< バインドしたテクスチャのSRV数
+        size_t constantBufferBytes = 0; ///< CPUから書き込んだ定数バッファのバイト数
+        size_t constantBuffersSkipped = 0; ///< 内容が前回と同じため送らなかったフレーム・ライトの定数バッファ数
+        size_t pipelineStateCalls = 0;  ///< StateCache がコンテキストへ送ったシェーダー・固定機能ステート・定数バッファ・サンプラーの設定
+        size_t pipelineStateCallsSkipped = 0; ///< StateCache が前回と同じため省略した設定
+        size_t stateChangesByKind[STATE_KIND_COUNT] = {}; ///< stateChanges の種類ごとの内訳
+        float passMs[PASS_COUNT] = {}; ///< 段階ごとのCPU時間(ミリ秒)
 
     void Reset() {
  modelsRendered = 0;
        meshesRendered = 0;
  totalDrawCalls = 0;
+        instancedDraws = 0;
+        instancesRendered = 0;
+        stateChanges = 0;
+        stateChangesSkipped = 0;
+        culled = 0;
+        treeCulled = 0;
+        occluded = 0;
+        occluders = 0;
+        commandLists = 0;
+        staticBatches = 0;
+        staticBatchedMeshes = 0;
+        lodReduced = 0;
+        lights = 0;
+        lightClusterEntries = 0;
+        depthPrepassDraws = 0;
+        transparentDraws = 0;
+        transparentBatches = 0;
+        videoSurfaces = 0;
+        submitMs = 0.0f;
+        proxies = 0;
+        extractMs = 0.0f;
+        psInvocations = 0;
+        depthPrepassPrimitives = 0;
+        overdraw = 0.0f;
+        gpuCullInstances = 0;
+        indirectDraws = 0;
+        particleEmitters = 0;
+        particlesEmitted = 0;
+        gpuMovers = 0;
+        gpuMoversSpawned = 0;
+        skinnedModels = 0;
+        skinningMatrices = 0;
+        shadowCascades = 0;
+        shadowCasters = 0;
+        shadowDraws = 0;
+        trianglesRendered = 0;
+        textureBinds = 0;
+        constantBufferBytes = 0;
+        constantBuffersSkipped = 0;
+        pipelineStateCalls = 0;
+        pipelineStateCallsSkipped = 0;
+        std::fill(std::begin(stateChangesByKind), std::end(stateChangesByKind), size_t(0));
+        std::fill(std::begin(passMs), std::end(passMs), 0.0f);
      }
+
+        /**
+         * @brief ステートを実際に設定したことを種類ごとに数える
+         */
+        void CountStateChange(StateKind kind) {
+            stateChanges++;
+            stateChangesByKind[kind]++;
+        }
+
+        /**
+         * @brief 描画キューの並列記録で別に数えた分を加算
+         */
+        void AddRecorded(const Statistics& recorded) {
+            modelsRendered += recorded.modelsRendered;
+            meshesRendered += recorded.meshesRendered;
+            totalDrawCalls += recorded.totalDrawCalls;
+            stateChanges += recorded.stateChanges;
+            stateChangesSkipped += recorded.stateChangesSkipped;
+            trianglesRendered += recorded.trianglesRendered;
+            textureBinds += recorded.textureBinds;
+            constantBufferBytes += recorded.constantBufferBytes;
+            pipelineStateCalls += recorded.pipelineStateCalls;
+            pipelineStateCallsSkipped += recorded.pipelineStateCallsSkipped;
+            for (uint32_t k = 0; k < STATE_KIND_COUNT; ++k) stateChangesByKind[k] += recorded.stateChangesByKind[k];
+        }
+
+        /**
+         * @brief インスタンス描画1回あたりの平均インスタンス数
+         */
+        float InstancesPerDraw() const {
+            return instancedDraws > 0 ? static_cast<float>(instancesRendered) / static_cast<float>(instancedDraws) : 0.0f;
+        }
     };
 
     /**
@@ -151,11 +415,14 @@ float padding2;         ///< パディング
         DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 初期化開始");
 
       auto& gfx = ServiceLocator::Get<GfxDevice>();
+        materials_ = &ServiceLocator::Get<MaterialManager>();
 
+        StartupReport::Scope compileScope("RenderSystem.CompileShaders");
         if (!CompileShaders(gfx)) {
         DEBUGLOG_ERROR("[RenderSystem] シェーダーのコンパイルに失敗");
         return false;
         }
+        compileScope.End();
 
         if (!CreateInputLayout(gfx)) {
        DEBUGLOG_ERROR("[RenderSystem] 入力レイアウトの作成に失敗");
@@ -167,15 +434,32 @@ float padding2;         ///< パディング
      return false;
         }
 
+        // 定数バッファのリング(D3D11.1 のオフセット指定バインドが使える場合のみ)
+        if (gfx.Ctx1() && gfx.SupportsConstantBufferOffsets()) {
+            if (!cbRing_.Init(gfx.Dev(), CB_RING_SIZE)) {
+                DEBUGLOG_WARNING("[RenderSystem] 定数バッファのリングを無効化します(UpdateSubresourceで更新)");
+            }
+        }
+
+        if (instancingSupported_ && !CreateInstancingResources(gfx)) {
+            DEBUGLOG_WARNING("[RenderSystem] インスタンス描画を無効化します(1エンティティ1ドローで描画)");
+            instancingSupported_ = false;
+        }
+
  if (!CreateStates(gfx)) {
     DEBUGLOG_ERROR("[RenderSystem] ステートの作成に失敗");
             return false;
         }
 
+        for (size_t i = 0; i < VERTEX_FORMAT_COUNT; ++i) {
+            meshPools_[i] = &gfx.Meshes(static_cast<VertexFormat>(i));
+        }
+        StartupReport::Scope meshScope("RenderSystem.CreatePrimitiveMeshes");
  if (!CreatePrimitiveMeshes(gfx)) {
    DEBUGLOG_ERROR("[RenderSystem] 基本形状メッシュの作成に失敗");
     return false;
         }
+        meshScope.End();
 
         initialized_ = true;
         stats_.Reset();
@@ -191,6 +475,8 @@ float padding2;         ///< パディング
      *
      * @details
      * すべてのModelComponentとMeshRendererを描画します。
+     * 前回と異なる World(App の並列シミュレーションの切り替えで RenderSnapshot の World に
+     * 替わった場合など)を渡すと、エンティティに紐づくキャッシュを作り直します。
      */
     void Render(World& w, const Camera& cam) {
         if (!initialized_) {
@@ -198,22 +484,100 @@ float padding2;         ///< パディング
          return;
  }
 
+        PROFILE_SCOPE("RenderSystem::Render");
+        if (&w != lastWorld_) {
+            ResetWorldCaches();
+            lastWorld_ = &w;
+        }
         auto& gfx = ServiceLocator::Get<GfxDevice>();
      auto& texMgr = ServiceLocator::Get<TextureManager>();
+        GpuProfileScope gpuScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_RENDER);
 
  stats_.Reset();
+        stats_.frame = frameCount_++;
 
   // パイプラインステートの設定
       SetupPipeline(gfx);
 
         // ライト情報の更新
-        UpdateLightConstants(w, cam, gfx);
+        TimePass(Statistics::PASS_LIGHTS, [&] { UpdateLightConstants(w, cam, gfx); });
+
+        // 描画プロキシの抽出(以降の MeshRenderer・ModelComponent の処理は World を読まない)
+        TimePass(Statistics::PASS_EXTRACT, [&] { ExtractRenderProxies(w); });
+        const RenderProxyBuffer& proxies = proxies_.Front();
+
+        queue_.Clear();
+        queueCull_.Clear();
+        transparent_.Clear();
+        frustum_ = cam.frustum;
+        UpdateFrameConstants(gfx, cam);
+        cullTreeActive_ = cullingEnabled_ && cullTreeEnabled_;
+        TimePass(Statistics::PASS_CULLING, [&] {
+            UpdateCullTree(proxies);
+            RasterizeOccluders(proxies, cam);
+        });
+        textureStreaming_ = texMgr.StreamingCount() > 0;
+        screenHeight_ = static_cast<float>(gfx.RenderHeight());
+
+        TimePass(Statistics::PASS_MODELS, [&] {
+            // スキニング行列の書き込み(ModelComponent の描画キューへの追加より前)
+            UploadSkinPalettes(gfx, proxies);
+
+            // ModelComponentの描画
+            RenderModelComponents(proxies, cam, texMgr);
+        });
 
-    // ModelComponentの描画
-        RenderModelComponents(w, gfx, cam, texMgr);
+        // 静的バッチ(StaticBatch タグ付きの MeshRenderer)
+        TimePass(Statistics::PASS_STATIC_BATCHES, [&] { RenderStaticBatches(w, gfx, cam); });
+
+        // ディレクショナルライトのシャドウマップ(描画キューの送信・インスタンス描画より前)
+        TimePass(Statistics::PASS_SHADOWS, [&] { RenderShadows(gfx, cam, proxies); });
 
         // MeshRendererの描画
-        RenderMeshRenderers(w, gfx, cam, texMgr);
+        CollectPipelineStatistics(gfx);
+        pipelineQueries_[PIPELINE_PASS_INSTANCED].Begin(gfx.Ctx());
+        TimePass(Statistics::PASS_INSTANCED, [&] {
+            GpuProfileScope instancedScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_INSTANCED);
+            RenderMeshRenderers(proxies, gfx, cam, texMgr);
+        });
+        pipelineQueries_[PIPELINE_PASS_INSTANCED].End(gfx.Ctx());
+
+        // 描画キューをソートして送信
+        if (benchmark_.framesLeft > 0) {
+            deferredEnabled_ = (benchmark_.framesLeft % 2) == 0;
+        }
+        TimePass(Statistics::PASS_QUEUE, [&] { SubmitQueue(gfx, texMgr); });
+        if (benchmark_.framesLeft > 0) {
+            UpdateSubmitBenchmark();
+        }
+        if (!capturePath_.empty()) {
+            WriteFrameCapture(gfx, texMgr, proxies);
+            capturePath_.clear();
+        }
+
+        // GPUで積分する GpuMover(不透明、半透明より前)
+        TimePass(Statistics::PASS_GPU_MOVERS, [&] { RenderGpuMovers(gfx, cam); });
+
+        // ゲーム内の動画の面(不透明、半透明より前)
+        TimePass(Statistics::PASS_QUEUE, [&] { RenderVideoSurfaces(w, gfx, cam); });
+
+        // 半透明(不透明の描画の後、奥から手前へアルファブレンド)
+        TimePass(Statistics::PASS_QUEUE, [&] { SubmitTransparent(gfx, texMgr, cam); });
+
+        // GPUパーティクル(不透明な描画の後、加算合成)
+        TimePass(Statistics::PASS_PARTICLES, [&] { RenderParticles(w, gfx, cam); });
+
+        // 全画面の動画(カットシーン、3D の描画の最後)
+        if (videoSurfaces_.HasFullscreenSurfaces()) {
+            GpuProfileScope videoScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_VIDEO);
+            videoSurfaces_.DrawFullscreen(gfx.States(), cam.aspect);
+            stats_.videoSurfaces = videoSurfaces_.GetStatistics().surfaces;
+        }
+
+        // 使われなくなった暗黙のマテリアルを破棄
+        materials_->EndFrame();
+
+        RecordFrameStatistics(gfx);
     }
 
     /**
@@ -232,20 +596,102 @@ float padding2;         ///< パディング
             DEBUGLOG_CATEGORY(DebugLog::Category::Graphics,
      "RenderSystem統計: Models=" + std::to_string(stats_.modelsRendered) +
          ", Meshes=" + std::to_string(stats_.meshesRendered) +
-           ", DrawCalls=" + std::to_string(stats_.totalDrawCalls));
+           ", DrawCalls=" + std::to_string(stats_.totalDrawCalls) +
+           ", Triangles=" + std::to_string(stats_.trianglesRendered) +
+           ", InstancedDraws=" + std::to_string(stats_.instancedDraws) +
+           ", InstancesPerDraw=" + std::to_string(stats_.InstancesPerDraw()) +
+           ", StateChangesSkipped=" + std::to_string(stats_.stateChangesSkipped) +
+           ", ConstantBuffersSkipped=" + std::to_string(stats_.constantBuffersSkipped) +
+           ", PipelineStateCallsSkipped=" + std::to_string(stats_.pipelineStateCallsSkipped) +
+           ", Culled=" + std::to_string(stats_.culled) +
+           ", Occluded=" + std::to_string(stats_.occluded) +
+           ", DepthPrepassDraws=" + std::to_string(stats_.depthPrepassDraws) +
+           ", TransparentDraws=" + std::to_string(stats_.transparentDraws) +
+           ", Overdraw=" + std::to_string(stats_.overdraw));
         }
 
+        EndReplay();
+
+        // シェーダーのホットリロードのコンパイルを待ってから解放
+        shaderWatcher_.Stop();
+        if (jobs_ && !shaderReloadJobs_.IsDone()) jobs_->Wait(shaderReloadJobs_);
+        shaderReload_.reset();
+
         // リソース解放
     vs_.Reset();
         ps_.Reset();
         layout_.Reset();
+        vsCompact_.Reset();
+        layoutCompact_.Reset();
+        layoutQuantized_.Reset();
+        compactVerticesSupported_ = false;
+        vsSkinned_.Reset();
+        layoutSkinned_.Reset();
+        skinCb_.Reset();
+        skinBuffer_.Reset();
+        skinSrv_.Reset();
+        skinCapacity_ = 0;
+        skinningSupported_ = false;
+        skinningActive_ = false;
     vsCb_.Reset();
-        psCb_.Reset();
+        frameCb_.Reset();
+        textureArrayMaterialCb_.Reset();
+        materials_ = nullptr;
         psLightCb_.Reset();
+        cbRing_.Shutdown();
+        lightClusters_.Shutdown();
+        particles_.Shutdown();
+        particlesSupported_ = false;
+        movers_.Shutdown();
+        moversSupported_ = false;
+        sharedModels_.Clear();
+        sharedEntries_.clear();
+        sharedMeshes_.clear();
+        sharedVersion_ = 0;
+        videoSurfaces_.Shutdown();
+        videoSurfacesSupported_ = false;
+        shadows_.Shutdown();
+        shadowsSupported_ = false;
+        deferred_.clear();
+        staticBatches_.clear();
+        staticBatchMembers_ = 0;
+        staticBatchesBuilt_ = false;
+        vsInstanced_.Reset();
+        psInstanced_.Reset();
+        vsInstancedCulled_.Reset();
+        gpuCulling_.Shutdown();
+        gpuCullingSupported_ = false;
+        for (uint32_t i = 0; i < SHADER_VARIANT_COUNT; ++i) {
+            psVariants_[i].Reset();
+            psInstancedVariants_[i].Reset();
+        }
+        batchCb_.Reset();
+        instanceSrv_.Reset();
+        instanceBuffer_.Reset();
+        instanceCapacity_ = 0;
         rasterState_.Reset();
  samplerState_.Reset();
+        depthPrepassState_.Reset();
+        depthEqualState_.Reset();
+        pipeline_ = PipelineState();
+        pipelineDepthEqual_ = PipelineState();
+        transparentBlend_.Reset();
+        pipelineTransparent_ = PipelineState();
+        transparent_.Reset();
+        depthPrepassActive_ = false;
+        for (PipelineStatisticsQuery& query : pipelineQueries_) {
+            query.Shutdown();
+        }
 
         meshCache_.clear();
+        for (const MeshPool*& pool : meshPools_) pool = nullptr;
+        meshLods_.Clear();
+        modelLods_.Clear();
+        meshSortIds_.clear();
+        queue_.Clear();
+        queueCull_.Clear();
+        instanceCull_.Clear();
+        ClearCullTree();
 
       initialized_ = false;
 
@@ -260,6 +706,41 @@ float padding2;         ///< パディング
         return stats_;
     }
 
+    /**
+     * @brief 直近のフレームの統計(0 が最新。GetStatisticsHistorySize() 以上は最も古いもの)
+     *
+     * @details
+     * Render() の最後に、そのフレームの Statistics を STATISTICS_HISTORY_FRAMES フレーム分のリングに記録します。
+     * パフォーマンスオーバーレイ・負荷計測・テレメトリはここから読みます。
+     */
+    const Statistics& GetStatisticsHistory(size_t framesAgo) const {
+        if (historyCount_ == 0) return stats_;
+        framesAgo = (std::min)(framesAgo, historyCount_ - 1);
+        return history_[(historyHead_ + STATISTICS_HISTORY_FRAMES - 1 - framesAgo) % STATISTICS_HISTORY_FRAMES];
+    }
+
+    size_t GetStatisticsHistorySize() const { return historyCount_; }
+
+    /**
+     * @brief 直近 frames フレームの統計を古い順に out へ書き出す(記録されている分だけ)
+     */
+    void CaptureStatistics(size_t frames, std::vector<Statistics>& out) const {
+        frames = (std::min)(frames, historyCount_);
+        out.resize(frames);
+        for (size_t i = 0; i < frames; ++i) out[i] = GetStatisticsHistory(frames - 1 - i);
+    }
+
+    /**
+     * @brief 直近 frames フレームの段階ごとのCPU時間の平均(ミリ秒)
+     */
+    float AveragePassMs(Statistics::Pass pass, size_t frames = STATISTICS_HISTORY_FRAMES) const {
+        frames = (std::min)(frames, historyCount_);
+        if (frames == 0) return 0.0f;
+        float total = 0.0f;
+        for (size_t i = 0; i < frames; ++i) total += GetStatisticsHistory(i).passMs[pass];
+        return total / static_cast<float>(frames);
+    }
+
     /**
   * @brief 初期化状態の確認
      * @return bool 初期化済みの場合は true
@@ -268,725 +749,4379 @@ float padding2;         ///< パディング
         return initialized_;
     }
 
-private:
     /**
-     * @struct MeshData
-   * @brief メッシュデータ
+     * @brief MeshRenderer のインスタンス描画を切り替え(比較・デバッグ用)
+     * @param[in] enabled false の場合は1エンティティ1ドローで描画
      */
-    struct MeshData {
-        Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
-        Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
-        UINT indexCount = 0;
-    };
+    void SetInstancingEnabled(bool enabled) {
+        instancingEnabled_ = enabled;
+    }
 
     /**
-     * @struct Vertex
-     * @brief 頂点データ
+     * @brief インスタンス描画が有効か(シェーダー非対応時は常に false)
      */
-    struct Vertex {
-        DirectX::XMFLOAT3 pos;
-        DirectX::XMFLOAT2 tex;
-        DirectX::XMFLOAT3 nrm;
-     DirectX::XMFLOAT3 tan;
-        DirectX::XMFLOAT3 bitan;
-    };
+    bool IsInstancingEnabled() const {
+        return instancingEnabled_ && instancingSupported_;
+    }
 
-    // DirectX11リソース
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;
-  Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;
-    Microsoft::WRL::ComPtr<ID3D11InputLayout> layout_;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> vsCb_;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> psCb_;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> psLightCb_;
-    Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterState_;
-    Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState_;
+    /**
+     * @brief ModelComponent のインスタンス描画を切り替え(比較・デバッグ用)
+     * @param[in] enabled false の場合は1メッシュ1ドローで描画キューに追加
+     *
+     * @details
+     * インスタンス描画が有効な場合、同じメッシュ(頂点バッファと範囲、LOD)とテクスチャを使う ModelComponent を
+     * MeshRenderer と同じインスタンスバッファで1回の DrawIndexedInstanced にまとめます。
+     * 同じモデルファイルから作ったエンティティは ResourceManager のキャッシュのバッファを共有するため、
+     * 同じモデルを何百体置いてもドローはメッシュとテクスチャの組み合わせの数だけです。
+     * スキニングされたもの・明示的なマテリアルやノーマルマップを持つもの・標準以外の頂点形式のものは従来どおり描画キューで描きます。
+     */
+    void SetModelInstancingEnabled(bool enabled) {
+        modelInstancingEnabled_ = enabled;
+    }
 
-    // メッシュキャッシュ
-    std::unordered_map<int, std::unique_ptr<MeshData>> meshCache_;
+    bool IsModelInstancingEnabled() const {
+        return modelInstancingEnabled_ && IsInstancingEnabled();
+    }
 
-    // 状態管理
-    bool initialized_ = false;
-    Statistics stats_;
+    /**
+     * @brief インスタンス描画の視錐台カリングをGPUで行うか(比較・デバッグ用、対応環境では既定で有効)
+     * @param[in] enabled false の場合はCPUで判定して DrawIndexedInstanced で描画
+     *
+     * @details
+     * 有効な間は、全インスタンスの境界球をコンピュートシェーダーで判定し、可視の数を
+     * DrawIndexedInstancedIndirect の引数に直接書き込みます。CPUはバッチごとに1回の間接描画を発行するだけで、
+     * 可視判定の結果を待ちません(Statistics::culled には数えません)。SetCullingEnabled(false) の場合は行いません。
+     */
+    void SetGpuCullingEnabled(bool enabled) {
+        gpuCullingEnabled_ = enabled;
+    }
 
     /**
-     * @brief シェーダーのコンパイル
+     * @brief GPUカリングが有効か(機能レベル 11_0 未満・シェーダー非対応時は常に false)
      */
-    bool CompileShaders(GfxDevice& gfx) {
-        const char* VS = R"(
-            cbuffer PerObject : register(b0) {
-          float4x4 gWorld;
-         float4x4 gWVP;
-       float4 gUVTransform;
-     };
+    bool IsGpuCullingEnabled() const {
+        return gpuCullingEnabled_ && gpuCullingSupported_;
+    }
 
-     struct VSIn {
-      float3 pos : POSITION;
-                float2 tex : TEXCOORD;
-      float3 nrm : NORMAL;
-      float3 tan : TANGENT;
-       float3 bitan : BITANGENT;
-         };
+    /**
+     * @brief 描画キューの定数更新に定数バッファのリングを使うか(比較・デバッグ用)
+     * @param[in] enabled false の場合は毎ドロー UpdateSubresource で更新
+     */
+    void SetConstantBufferRingEnabled(bool enabled) {
+        cbRingEnabled_ = enabled;
+    }
 
-            struct VSOut {
-         float4 pos : SV_POSITION;
-        float2 tex : TEXCOORD;
-       float3 nrm : NORMAL;
-       float3 tan : TANGENT;
-     float3 bitan : BITANGENT;
-        float3 worldPos : WORLDPOS;
-            };
+    /**
+     * @brief 定数バッファのリングが有効か(D3D11.1 非対応時は常に false)
+     */
+    bool IsConstantBufferRingEnabled() const {
+        return cbRingEnabled_ && cbRing_.IsValid();
+    }
 
-    VSOut main(VSIn i) {
-         VSOut o;
-           o.pos = mul(float4(i.pos, 1.0f), gWVP);
-        o.worldPos = mul(float4(i.pos, 1.0f), gWorld).xyz;
-         o.nrm = mul(i.nrm, (float3x3)gWorld);
-        o.tan = mul(i.tan, (float3x3)gWorld);
-           o.bitan = mul(i.bitan, (float3x3)gWorld);
-         o.tex = i.tex * gUVTransform.zw + gUVTransform.xy;
-    return o;
-       }
-        )";
+    /**
+     * @brief 描画キューを遅延コンテキストで並列記録するか(既定は無効)
+     *
+     * @details
+     * 有効にすると、ソート済みの描画キューをワーカー数に分割し、各ワーカーが自分の遅延コンテキストに
+     * 記録したコマンドリストを即時コンテキストで順に実行します。SetJobSystem() でジョブシステムが
+     * 設定されていない場合や、パケット数が少ない場合は単一スレッドで送信します。
+     */
+    void SetDeferredRecordingEnabled(bool enabled) {
+        deferredEnabled_ = enabled;
+    }
 
-        const char* PS = R"(
-            struct DirectionalLight {
-     float3 direction;
-          float padding;
-  float4 color;
-     };
+    bool IsDeferredRecordingEnabled() const {
+        return deferredEnabled_;
+    }
 
-         cbuffer PerObject : register(b0) {
-    float4 gColor;
-    float gUseTexture;
-       float gUseNormalMap;
-   float gSpecularPower;
-    float padding_obj;
-            };
+    /**
+     * @brief 単一スレッド送信と並列記録を交互に計測し、平均の送信時間をログに出力
+     * @param[in] frames 計測フレーム数(2方式の合計)
+     */
+    void StartSubmitBenchmark(uint32_t frames) {
+        if (benchmark_.framesLeft > 0) return;
+        benchmark_ = SubmitBenchmark();
+        benchmark_.framesLeft = frames;
+        benchmark_.restoreDeferred = deferredEnabled_;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 送信方式の比較計測を開始 (" + std::to_string(frames) + "フレーム)");
+    }
 
-       cbuffer PerFrame : register(b1) {
-       DirectionalLight gLight;
-    float3 gAmbientColor;
-    float padding_frame;
-      float3 gEyePos;
-          float padding_frame2;
-   };
+    /**
+     * @brief 視錐台カリングを切り替え(比較・デバッグ用)
+     */
+    void SetCullingEnabled(bool enabled) {
+        cullingEnabled_ = enabled;
+    }
 
-   Texture2D gTexture : register(t0);
-      Texture2D gNormalMap : register(t1);
- SamplerState gSampler : register(s0);
+    bool IsCullingEnabled() const {
+        return cullingEnabled_;
+    }
 
-            struct VSOut {
-       float4 pos : SV_POSITION;
-       float2 tex : TEXCOORD;
- float3 nrm : NORMAL;
-     float3 tan : TANGENT;
-      float3 bitan : BITANGENT;
-      float3 worldPos : WORLDPOS;
-    };
+    /**
+     * @brief カリング用BVHによる事前の除外を切り替え(比較・デバッグ用)
+     *
+     * @details
+     * 無効にしても木の更新は続けるため、Raycast() などの検索はそのまま使えます。
+     * 有効な場合も、木が残した描画対象は SphereCullList で境界球ごとに判定し直します。
+     */
+    void SetCullTreeEnabled(bool enabled) {
+        cullTreeEnabled_ = enabled;
+    }
 
-    float4 main(VSOut i) : SV_Target {
-      float3 normal = normalize(i.nrm);
-     if (gUseNormalMap > 0.5) {
-        float3x3 TBN = float3x3(normalize(i.tan), normalize(i.bitan), normalize(i.nrm));
-            float3 tangentNormal = gNormalMap.Sample(gSampler, i.tex).xyz * 2.0 - 1.0;
-               normal = normalize(mul(tangentNormal, TBN));
-   }
+    bool IsCullTreeEnabled() const {
+        return cullTreeEnabled_;
+    }
 
-     float light_factor = max(0.0f, dot(normal, -gLight.direction));
+    /**
+     * @brief 遮蔽カリングを切り替え(比較・デバッグ用)
+     *
+     * @details
+     * 画面に大きく映る MeshRenderer を遮蔽物として OcclusionBuffer にラスタライズし、
+     * 視錐台カリングで残った描画キューのパケットと(CPUカリング時の)インスタンスを判定し直します。
+     * 視錐台カリングが無効な場合は行いません。
+     */
+    void SetOcclusionCullingEnabled(bool enabled) {
+        occlusionEnabled_ = enabled;
+    }
 
- float4 final_color = gColor;
-         if (gUseTexture > 0.5) {
-     final_color *= gTexture.Sample(gSampler, i.tex);
-   }
+    bool IsOcclusionCullingEnabled() const {
+        return occlusionEnabled_;
+    }
 
-         float3 toEye = normalize(gEyePos - i.worldPos);
-     float3 reflection = reflect(gLight.direction, normal);
-     float spec_factor = pow(max(0.0f, dot(toEye, reflection)), gSpecularPower);
+    /**
+     * @brief 描画プロキシのBVH(前回の Render() の時点)
+     */
+    const DynamicBvh& CullTree() const {
+        return cullTree_;
+    }
 
-    float3 diffuse = final_color.rgb * gLight.color.rgb * light_factor;
-     float3 ambient = final_color.rgb * gAmbientColor;
-           float3 specular = gLight.color.rgb * spec_factor;
+    /**
+     * @brief 前回描画した MeshRenderer・ModelComponent の境界球に対するレイキャスト
+     * @param[in] origin 始点
+     * @param[in] dir 向き(正規化済み)
+     * @param[in] maxDistance 検索する距離
+     * @param[out] hit 最も手前で当たったエンティティ
+     * @param[out] distance hit までの距離
+     * @return bool 当たった場合 true
+     *
+     * @details
+     * 描画と同じメインスレッドから呼んでください。結果は前回の Render() に渡した World
+     * (並列シミュレーション中は RenderSnapshot の World)のエンティティです。
+     * シミュレーション側の近傍検索・当たり判定には SpatialHashGrid を使ってください。
+     * 境界球を持たない(半径0以下の)描画対象は対象外です。
+     */
+    bool Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, float maxDistance, Entity& hit, float& distance) const {
+        const RenderProxyBuffer& proxies = proxies_.Front();
+        bool found = false;
+        distance = maxDistance;
+        cullTree_.Raycast(origin, dir, maxDistance, [&](uint32_t proxy) {
+            const RenderProxyList& list = CullTreeList(proxies, cullTree_.UserData(proxy));
+            const size_t index = CullTreeIndex(cullTree_.UserData(proxy));
+            float t;
+            if (!RaySphere(origin, dir, list.BoundsCenter(index), list.BoundsRadius(index), t) || t > distance) return -1.0f;
+            hit = list.entities[index];
+            distance = t;
+            found = true;
+            return (std::max)(t, FLT_MIN); // 0 は打ち切りの意味になるため、始点が球の内側でも続ける
+        });
+        return found;
+    }
 
-          return float4(diffuse + ambient + specular, final_color.a);
+    /**
+     * @brief 前回描画した対象のうち、境界球を囲むAABBが指定のAABBと重なるものを列挙
+     * @param[out] out 見つかったエンティティ(追記)
+     */
+    void QueryAABB(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max, std::vector<Entity>& out) const {
+        const RenderProxyBuffer& proxies = proxies_.Front();
+        const BvhAabb box{ min, max };
+        cullTree_.QueryAABB(box, [&](uint32_t proxy) {
+            const RenderProxyList& list = CullTreeList(proxies, cullTree_.UserData(proxy));
+            const size_t index = CullTreeIndex(cullTree_.UserData(proxy));
+            if (BvhAabb::FromSphere(list.BoundsCenter(index), list.BoundsRadius(index)).Overlaps(box)) {
+                out.push_back(list.entities[index]);
             }
-  )";
-
-Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
-        UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
-#ifdef _DEBUG
-        compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
+            return true;
+        });
+    }
 
-        // 頂点シェーダーのコンパイル
-        HRESULT hr = D3DCompile(VS, strlen(VS), nullptr, nullptr, nullptr, "main", "vs_5_0", compileFlags, 0, vsb.GetAddressOf(), err.GetAddressOf());
-  if (FAILED(hr)) {
-   if (err) {
-        std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
-     DEBUGLOG_ERROR("[RenderSystem] 頂点シェーダーのコンパイル失敗: " + errorMsg);
-            } else {
-        DEBUGLOG_ERROR("[RenderSystem] 頂点シェーダーのコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+    /**
+     * @brief 前回描画した対象のうち、境界球が視錐台に触れるものを列挙
+     * @param[out] out 見つかったエンティティ(追記)
+     */
+    void QueryFrustum(const Frustum& frustum, std::vector<Entity>& out) const {
+        const RenderProxyBuffer& proxies = proxies_.Front();
+        cullTree_.QueryFrustum(frustum, [&](uint32_t proxy) {
+            const RenderProxyList& list = CullTreeList(proxies, cullTree_.UserData(proxy));
+            const size_t index = CullTreeIndex(cullTree_.UserData(proxy));
+            if (frustum.IntersectsSphere(list.BoundsCenter(index), list.BoundsRadius(index))) {
+                out.push_back(list.entities[index]);
             }
-            return false;
-        }
+            return true;
+        });
+    }
 
-// ピクセルシェーダーのコンパイル
-  err.Reset();
-        hr = D3DCompile(PS, strlen(PS), nullptr, nullptr, nullptr, "main", "ps_5_0", compileFlags, 0, psb.GetAddressOf(), err.GetAddressOf());
-        if (FAILED(hr)) {
-            if (err) {
-         std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
-     DEBUGLOG_ERROR("[RenderSystem] ピクセルシェーダーのコンパイル失敗: " + errorMsg);
-  } else {
-      DEBUGLOG_ERROR("[RenderSystem] ピクセルシェーダーのコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-            }
-return false;
-        }
+    /**
+     * @brief 画面上の点にある描画対象を選択(マウスでのピッキング)
+     * @param[in] cam 前回の Render() に渡したカメラ
+     * @param[in] x, y クライアント領域のピクセル座標(左上が原点)
+     * @param[in] width, height クライアント領域の大きさ
+     * @param[out] hit 選択したエンティティ
+     * @return bool 見つかった場合 true
+     */
+    bool Pick(const Camera& cam, float x, float y, float width, float height, Entity& hit) const {
+        if (width <= 0.0f || height <= 0.0f) return false;
+        const float ndcX = 2.0f * x / width - 1.0f;
+        const float ndcY = 1.0f - 2.0f * y / height;
+        DirectX::XMMATRIX invViewProj = DirectX::XMMatrixInverse(nullptr, cam.ViewProj);
+        DirectX::XMVECTOR nearPoint = DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), invViewProj);
+        DirectX::XMVECTOR farPoint = DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), invViewProj);
+        DirectX::XMVECTOR ray = DirectX::XMVectorSubtract(farPoint, nearPoint);
+
+        DirectX::XMFLOAT3 origin, dir;
+        DirectX::XMStoreFloat3(&origin, nearPoint);
+        DirectX::XMStoreFloat3(&dir, DirectX::XMVector3Normalize(ray));
+        float distance;
+        return Raycast(origin, dir, DirectX::XMVectorGetX(DirectX::XMVector3Length(ray)), hit, distance);
+    }
 
-// 頂点シェーダーの作成
-        hr = gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs_.GetAddressOf());
-if (FAILED(hr)) {
-       DEBUGLOG_ERROR("[RenderSystem] 頂点シェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+    /**
+     * @brief 前回描画したエンティティのワールド空間の境界球(ピッキング結果の強調表示など)
+     * @return bool 前回の描画対象で境界球を持つ場合 true
+     */
+    bool FindProxyBounds(Entity e, DirectX::XMFLOAT3& center, float& radius) const {
+        const RenderProxyBuffer& proxies = proxies_.Front();
+        for (const std::vector<CullTreeSlot>& slots : cullTreeSlots_) {
+            if (e.id >= slots.size()) continue;
+            const CullTreeSlot& slot = slots[e.id];
+            if (slot.proxy == DynamicBvh::NULL_NODE || slot.entity != e) continue;
+            const uint32_t data = cullTree_.UserData(slot.proxy);
+            const RenderProxyList& list = CullTreeList(proxies, data);
+            center = list.BoundsCenter(CullTreeIndex(data));
+            radius = list.BoundsRadius(CullTreeIndex(data));
+            return true;
+        }
         return false;
-     }
-
-     // ピクセルシェーダーの作成
-        hr = gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps_.GetAddressOf());
-      if (FAILED(hr)) {
-            DEBUGLOG_ERROR("[RenderSystem] ピクセルシェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-          return false;
-  }
+    }
 
-        // 入力レイアウトの作成のためにvsb_を保存
+    /**
+     * @brief LOD選択を切り替え(無効の場合は常にLOD0)
+     */
+    void SetLodEnabled(bool enabled) {
+        lodEnabled_ = enabled;
+    }
+
+    bool IsLodEnabled() const {
+        return lodEnabled_;
+    }
+
+    /**
+     * @brief LOD選択に使う投影サイズの倍率(1 未満で近くから粗いLODに切り替える。品質を下げる時に使う、既定 1)
+     */
+    void SetLodScale(float scale) {
+        lodScale_ = (std::min)((std::max)(scale, 0.05f), 1.0f);
+    }
+
+    float GetLodScale() const {
+        return lodScale_;
+    }
+
+    /**
+     * @brief ストリーミング中のテクスチャに要求する解像度の倍率(1 未満で上位のミップを読み込まない。既定 1)
+     */
+    void SetTextureDetailScale(float scale) {
+        textureDetailScale_ = (std::min)((std::max)(scale, 0.05f), 1.0f);
+    }
+
+    float GetTextureDetailScale() const {
+        return textureDetailScale_;
+    }
+
+    /**
+     * @brief 描画キューの深度プリパスを切り替え(既定は無効)
+     *
+     * @details
+     * 有効にすると、ソート済みの描画キューをまず深度だけ描き(ピクセルシェーダーなし)、
+     * 続くシェーディングは深度を書かずに LESS_EQUAL で描きます。隠れたピクセルのライティングが
+     * 省かれる代わりに、頂点処理とドローコールが2倍になります。インスタンス描画はプリパスより
+     * 前に通常どおり深度を書いて描かれ、プリパスの深度テストにも使われます。
+     */
+    void SetDepthPrepassEnabled(bool enabled) {
+        depthPrepassEnabled_ = enabled;
+    }
+
+    bool IsDepthPrepassEnabled() const {
+        return depthPrepassEnabled_;
+    }
+
+    /**
+     * @brief 固定ステップ間の補間を設定(App が描画の前に毎フレーム呼ぶ)
+     * @param[in] alpha 最後の更新から次の更新までの割合(0〜1。1 で補間なし)
+     * @param[in] step TransformSystem::StepCount()(この更新で動いたノードだけ補間する)
+     *
+     * @details
+     * LocalToWorld::movedStep が step と等しいエンティティは previous と matrix の間を
+     * 移動・拡大を線形、回転を球面線形で補間した行列で描画します(カリングも同じ行列を使います)。
+     */
+    void SetInterpolation(float alpha, uint32_t step) {
+        interpolationAlpha_ = alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+        interpolationStep_ = step;
+    }
+
+    float InterpolationAlpha() const {
+        return interpolationAlpha_;
+    }
+
+    /**
+     * @brief 描画キューを手前から奥の順に並べるか(既定は無効、ステート順)
+     *
+     * @details
+     * RenderQueue::MakeDepthFirstKey() でソートします。ステートの切り替えは増えますが、
+     * 深度テストで早期に棄却されるピクセルが増えます。深度プリパスを使う場合は
+     * プリパス自体の順序にも効きます。
+     */
+    void SetFrontToBackSortingEnabled(bool enabled) {
+        frontToBackEnabled_ = enabled;
+    }
+
+    bool IsFrontToBackSortingEnabled() const {
+        return frontToBackEnabled_;
+    }
+
+    /**
+     * @brief パイプライン統計クエリによる計測を切り替え(既定は無効)
+     *
+     * @details
+     * 有効な間、Statistics の psInvocations / depthPrepassPrimitives / overdraw を
+     * D3D11_QUERY_PIPELINE_STATISTICS で計測します。結果は GPU を待たずに回収するため
+     * 数フレーム遅れます。
+     */
+    void SetPipelineStatisticsEnabled(bool enabled) {
+        pipelineStatsEnabled_ = enabled;
+        if (!enabled) {
+            for (PipelineStatisticsQuery& query : pipelineQueries_) {
+                query.Shutdown();
+            }
+        }
+    }
+
+    bool IsPipelineStatisticsEnabled() const {
+        return pipelineStatsEnabled_;
+    }
+
+    /**
+     * @brief GPUパーティクルの更新と描画を切り替え(比較・デバッグ用)
+     * @param[in] enabled false の間は放出も移動も止まる(粒子は消さない)
+     */
+    void SetParticlesEnabled(bool enabled) {
+        particlesEnabled_ = enabled;
+    }
+
+    /**
+     * @brief GPUパーティクルが有効か(コンピュートシェーダー非対応時は常に false)
+     */
+    bool IsParticlesEnabled() const {
+        return particlesEnabled_ && particlesSupported_;
+    }
+
+    /**
+     * @brief GpuMoverSystem が生成・解放・ステップの経過を積むチャネル
+     *
+     * @details
+     * GpuMover のエンティティは World ではなくこのチャネルを通して描画されるため、
+     * RenderSnapshot を使う並列シミュレーションでもそのまま渡せます。
+     */
+    GpuMoverChannel& GpuMoverQueue() {
+        return movers_.Channel();
+    }
+
+    /**
+     * @brief PackedMeshRenderer から番号で参照する共有モデルの表
+     */
+    SharedModelTable& SharedModels() {
+        return sharedModels_;
+    }
+
+    /**
+     * @brief ディレクショナルライトの影を切り替え(比較・デバッグ用)
+     */
+    void SetShadowsEnabled(bool enabled) {
+        shadowsEnabled_ = enabled;
+    }
+
+    /**
+     * @brief ディレクショナルライトの影が有効か(シャドウマップの作成に失敗した場合は常に false)
+     */
+    bool IsShadowsEnabled() const {
+        return shadowsEnabled_ && shadowsSupported_;
+    }
+
+    /**
+     * @brief 影を描くカメラからの距離(CascadedShadowMaps::SetDistance、短くすると各カスケードのキャスターが減る)
+     */
+    void SetShadowDistance(float distance) {
+        shadows_.SetDistance(distance);
+    }
+
+    float GetShadowDistance() const {
+        return shadows_.Distance();
+    }
+
+    /**
+     * @brief GPUパーティクルの放出数の倍率(ParticleSystem::SetEmissionScale、既定 1)
+     */
+    void SetParticleDensity(float scale) {
+        particles_.SetEmissionScale(scale);
+    }
+
+    float GetParticleDensity() const {
+        return particles_.EmissionScale();
+    }
+
+    /**
+     * @brief 生存しているGPUパーティクルをすべて消す(シーンの切り替えなど)
+     */
+    void ClearParticles() {
+        particles_.Clear();
+    }
+
+    /**
+     * @brief カリングの並列化に使うジョブシステムを設定(nullptrで逐次実行)
+     */
+    /**
+     * @brief 確保しているGPUバッファの合計(バイト、MemoryTracker への報告用)
+     *
+     * @details
+     * 基本形状のメッシュ(共有メッシュバッファに入らなかったもの)・インスタンスバッファ・静的バッチ・定数バッファのリング・GPUカリング・GPUパーティクルを数えます。
+     */
+    size_t GpuMemoryBytes() const {
+        size_t bytes = 0;
+        for (const auto& pair : meshCache_) {
+            if (!pair.second) continue;
+            bytes += GfxDevice::BufferBytes(pair.second->vertexBuffer.Get()) + GfxDevice::BufferBytes(pair.second->indexBuffer.Get());
+        }
+        for (const StaticBatchData& batch : staticBatches_) {
+            bytes += GfxDevice::BufferBytes(batch.vertexBuffer.Get()) + GfxDevice::BufferBytes(batch.indexBuffer.Get());
+        }
+        bytes += GfxDevice::BufferBytes(instanceBuffer_.Get());
+        bytes += GfxDevice::BufferBytes(cbRing_.Buffer());
+        bytes += gpuCulling_.GpuMemoryBytes();
+        bytes += particles_.GpuMemoryBytes();
+        bytes += movers_.GpuMemoryBytes();
+        bytes += videoSurfaces_.GpuMemoryBytes();
+        bytes += shadows_.GpuMemoryBytes();
+        return bytes;
+    }
+
+    void SetJobSystem(JobSystem* jobs) {
+        jobs_ = jobs;
+    }
+
+    /**
+     * @brief メッシュのシェーダーのホットリロードを切り替え(既定は無効)
+     *
+     * @details
+     * 有効にした後の最初の UpdateShaderHotReload() で、組み込みの頂点・ピクセルシェーダーのソースを
+     * SHADER_SOURCE_DIRECTORY の mesh_vs.hlsl / mesh_ps.hlsl に書き出して監視を始めます
+     * (内容の異なるファイルが既にあれば .bak に退避)。ファイルを保存すると、すべてのバリアントを
+     * ワーカーで ShaderCache にコンパイルし、1つでも失敗した場合はエラーを記録して元のシェーダーのまま描画を続けます。
+     * すべて成功した場合だけ、次の UpdateShaderHotReload() でキャッシュから作り直して差し替えます。
+     * 頂点の入力の構造(入力レイアウト)を変える変更は反映されないため、組み込みのソースに戻して再起動してください。
+     */
+    void SetShaderHotReloadEnabled(bool enabled) {
+        shaderHotReload_ = enabled;
+        if (!enabled) shaderWatcher_.Stop();
+    }
+    bool IsShaderHotReloadEnabled() const { return shaderHotReload_; }
+
+    /**
+     * @brief シェーダーのホットリロードの確認と差し替え(毎フレーム、描画の前にメインスレッドから呼び出す)
+     */
+    void UpdateShaderHotReload() {
+        if (!shaderHotReload_ || !initialized_) return;
+        if (!shaderWatcher_.IsRunning() && !StartShaderWatch()) {
+            shaderHotReload_ = false;
+            return;
+        }
+
+        if (shaderReload_ && shaderReload_->done.load(std::memory_order_acquire)) {
+            std::shared_ptr<ShaderReload> reload = std::move(shaderReload_);
+            ApplyShaderReload(*reload);
+        }
+
+        std::vector<std::string> changed;
+        bool overflowed = false;
+        shaderWatcher_.Poll(changed, overflowed);
+        bool touched = overflowed;
+        for (const std::string& path : changed) {
+            if (path == ShaderSourcePath(false) || path == ShaderSourcePath(true)) touched = true;
+        }
+        if (touched) StartShaderReload();
+    }
+
+    static constexpr const char* SHADER_SOURCE_DIRECTORY = "ShaderSource"; ///< ホットリロードで編集するHLSLの置き場所
+
+    /**
+     * @brief 次の Render() で送信する描画キューをファイルに書き出す(FrameCapture.h を参照)
+     * @param[in] path 書き出し先
+     *
+     * @details
+     * カリングとソートの後、送信したパケットをその順で記録します。参照するバッファの内容を GPU から読み戻すため、
+     * 記録するフレームだけ CPU が GPU を待ちます。
+     */
+    void RequestFrameCapture(const std::string& path) {
+        capturePath_ = path;
+    }
+
+    /**
+     * @brief 記録したフレームの再生を始める(バッファの作成とテクスチャの読み込み)
+     * @param[in] capture FrameCapture::Load() で読み込んだ記録
+     * @return bool 再生できる場合 true(定数の構造が記録時と異なる場合は false)
+     *
+     * @details
+     * 以降は Render() の代わりに RenderReplay() を呼びます。現在の RenderSystem で描けないパケット
+     * (小さな頂点形式・スキニングのシェーダーがない場合など)は取り除きます。
+     */
+    bool BeginReplay(const FrameCapture& capture) {
+        if (!initialized_) return false;
+        EndReplay();
+        if (capture.frameConstants.size() != sizeof(FrameConstants) || capture.lightConstants.size() != sizeof(PSLightConstants)) {
+            DEBUGLOG_ERROR("[RenderSystem] 記録の定数の大きさが現在の RenderSystem と異なるため再生できません");
+            return false;
+        }
+
+        auto& gfx = ServiceLocator::Get<GfxDevice>();
+        auto& texMgr = ServiceLocator::Get<TextureManager>();
+        std::memcpy(&replay_.frame, capture.frameConstants.data(), sizeof(FrameConstants));
+        std::memcpy(&replay_.light, capture.lightConstants.data(), sizeof(PSLightConstants));
+
+        replay_.buffers.reserve(capture.buffers.size());
+        for (const FrameCapture::Buffer& b : capture.buffers) {
+            replay_.buffers.push_back(FrameCapture::CreateBuffer(gfx.Dev(), b));
+        }
+        replay_.textures.reserve(capture.textures.size());
+        for (const std::string& path : capture.textures) {
+            replay_.textures.push_back(path.empty() ? TextureManager::INVALID_TEXTURE : texMgr.LoadFromFile(path.c_str()));
+        }
+
+        // スキニング行列は再生中に変わらないため最初に1回だけ書き込む
+        bool skinning = false;
+        if (skinningSupported_ && !capture.skinPalette.empty() && EnsureSkinCapacity(gfx, capture.skinPalette.size())) {
+            D3D11_MAPPED_SUBRESOURCE mapped{};
+            if (SUCCEEDED(gfx.Ctx()->Map(skinBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+                std::memcpy(mapped.pData, capture.skinPalette.data(), capture.skinPalette.size() * sizeof(DirectX::XMFLOAT4X4));
+                gfx.Ctx()->Unmap(skinBuffer_.Get(), 0);
+                skinning = true;
+            }
+        }
+
+        auto bufferAt = [&](uint32_t index) -> ID3D11Buffer* {
+            return index != FrameCapture::NONE ? replay_.buffers[index].Get() : nullptr;
+        };
+        auto textureAt = [&](uint32_t index) {
+            return index != FrameCapture::NONE ? replay_.textures[index] : TextureManager::INVALID_TEXTURE;
+        };
+        size_t dropped = 0;
+        replay_.packets.reserve(capture.packets.size());
+        for (const FrameCapture::Packet& p : capture.packets) {
+            DrawPacket packet;
+            packet.sortKey = p.sortKey;
+            packet.vertexBuffer = bufferAt(p.vertexBuffer);
+            packet.indexBuffer = bufferAt(p.indexBuffer);
+            packet.indexCount = p.indexCount;
+            packet.indexFormat = static_cast<DXGI_FORMAT>(p.indexFormat);
+            packet.startIndex = p.startIndex;
+            packet.baseVertex = p.baseVertex;
+            packet.vertexFormat = static_cast<VertexFormat>(p.vertexFormat);
+            packet.world = p.world;
+            packet.uvOffset = p.uvOffset;
+            packet.uvScale = p.uvScale;
+            packet.materialBuffer = bufferAt(p.materialBuffer);
+            packet.texture = textureAt(p.texture);
+            packet.normalTexture = textureAt(p.normalTexture);
+            packet.isModel = (p.flags & FrameCapture::PACKET_MODEL) != 0;
+            packet.skinBuffer = bufferAt(p.skinBuffer);
+            packet.boneOffset = p.boneOffset;
+
+            const bool drawable = packet.vertexBuffer && packet.indexBuffer &&
+                                  (packet.vertexFormat == VertexFormat::Standard || compactVerticesSupported_) &&
+                                  (p.skinBuffer == FrameCapture::NONE || (packet.skinBuffer && skinning));
+            if (!drawable) {
+                dropped++;
+                continue;
+            }
+            replay_.packets.push_back(packet);
+        }
+        replay_.active = true;
+
+        char line[256];
+        sprintf_s(line, "[RenderSystem] フレーム %llu の記録を再生: パケット %zu (描けないもの %zu), バッファ %zu (%.1f MB), テクスチャ %zu",
+                  static_cast<unsigned long long>(capture.frame), replay_.packets.size(), dropped, capture.buffers.size(),
+                  static_cast<double>(capture.BufferBytes()) / (1024.0 * 1024.0), capture.textures.size());
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, line);
+        return true;
+    }
+
+    /**
+     * @brief 記録したパケットを描画キューと同じ経路で送信(BeginReplay() の後、毎フレーム Render() の代わりに呼ぶ)
+     *
+     * @details
+     * World・カメラ・ライトの抽出は行わず、記録時のフレーム定数・ライト定数で描きます。
+     * 深度プリパス・定数バッファのリング・遅延コンテキストは現在の設定に従うため、設定ごとの送信時間と GPU 時間を比べられます。
+     * 統計は Render() と同じく GetStatistics() に記録します。
+     */
+    void RenderReplay() {
+        if (!replay_.active) return;
+        PROFILE_SCOPE("RenderSystem::RenderReplay");
+        auto& gfx = ServiceLocator::Get<GfxDevice>();
+        auto& texMgr = ServiceLocator::Get<TextureManager>();
+        GpuProfileScope gpuScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_RENDER);
+
+        stats_.Reset();
+        stats_.frame = frameCount_++;
+        SetupPipeline(gfx);
+        if (frameCb_.Upload(gfx.Ctx(), replay_.frame)) {
+            stats_.constantBufferBytes += sizeof(FrameConstants);
+        } else {
+            stats_.constantBuffersSkipped++;
+        }
+        if (psLightCb_.Upload(gfx.Ctx(), replay_.light)) {
+            stats_.constantBufferBytes += sizeof(PSLightConstants);
+        } else {
+            stats_.constantBuffersSkipped++;
+        }
+
+        queue_.Clear();
+        for (const DrawPacket& packet : replay_.packets) {
+            queue_.Push() = packet;
+        }
+        TimePass(Statistics::PASS_QUEUE, [&] { SubmitSortedQueue(gfx, texMgr); });
+        RecordFrameStatistics(gfx);
+    }
+
+    /**
+     * @brief 再生を終えて、作成したバッファと読み込んだテクスチャを解放
+     */
+    void EndReplay() {
+        if (!replay_.active && replay_.buffers.empty()) return;
+        if (TextureManager* texMgr = ServiceLocator::TryGet<TextureManager>()) {
+            for (TextureManager::TextureHandle texture : replay_.textures) {
+                if (texture != TextureManager::INVALID_TEXTURE) texMgr->Release(texture);
+            }
+        }
+        queue_.Clear();
+        replay_ = ReplayState();
+    }
+
+    bool IsReplaying() const { return replay_.active; }
+
+private:
+    /**
+     * @struct Vertex
+     * @brief 頂点データ
+     */
+    struct Vertex {
+        DirectX::XMFLOAT3 pos;
+        DirectX::XMFLOAT2 tex;
+        DirectX::XMFLOAT3 nrm;
+     DirectX::XMFLOAT3 tan;
+        DirectX::XMFLOAT3 bitan;
+    };
+    static_assert(sizeof(Vertex) == MeshPool::VERTEX_STRIDE, "Vertex must match the shared mesh buffer layout");
+
+    /**
+     * @struct MeshData
+   * @brief メッシュデータ
+     */
+    struct MeshData {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+        Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+        UINT indexCount = 0;
+        DirectX::XMFLOAT3 boundsCenter{ 0.0f, 0.0f, 0.0f }; ///< ローカル空間の境界球の中心
+        float boundsRadius = 0.0f;                           ///< ローカル空間の境界球の半径
+        std::vector<Vertex> vertices;                        ///< 頂点のCPU側コピー(静的バッチの構築用)
+        std::vector<uint16_t> indices;                       ///< インデックスのCPU側コピー(静的バッチの構築用)
+        MeshPoolHandle pooled;                               ///< 共有メッシュバッファ内の範囲(設定時は vertexBuffer/indexBuffer は空)
+        uint8_t lodCount = 1;                                ///< このメッシュ種別のLOD数(LOD0のエントリのみ有効)
+    };
+
+    /**
+     * @struct StaticBatchData
+     * @brief 同じマテリアルの静的メッシュをまとめたバッファ
+     */
+    struct StaticBatchData {
+        Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;   ///< ワールド座標へ変換済みの頂点
+        Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;    ///< 32ビットインデックス
+        UINT indexCount = 0;                                 ///< インデックス数
+        DirectX::XMFLOAT3 color{ 1.0f, 1.0f, 1.0f };         ///< マテリアルカラー
+        DirectX::XMFLOAT2 uvOffset{ 0.0f, 0.0f };            ///< UVオフセット
+        DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };             ///< UVスケール
+        TextureManager::TextureHandle texture = TextureManager::INVALID_TEXTURE; ///< テクスチャ
+        TextureManager::TextureHandle normalTexture = TextureManager::INVALID_TEXTURE; ///< ノーマルマップ(明示的なマテリアルのみ)
+        MaterialManager::MaterialHandle material = MaterialManager::INVALID_MATERIAL; ///< 明示的なマテリアル(設定時は上の色・テクスチャはその内容)
+        DirectX::XMFLOAT3 boundsCenter{ 0.0f, 0.0f, 0.0f };  ///< ワールド空間の境界球の中心
+        float boundsRadius = 0.0f;                           ///< ワールド空間の境界球の半径
+        size_t members = 0;                                  ///< まとめたエンティティ数
+    };
+
+    /**
+     * @struct InstanceData
+     * @brief インスタンスバッファの1要素(HLSL の InstanceData と同じレイアウト)
+     */
+    struct InstanceData {
+        DirectX::XMFLOAT4X4 world;     ///< ワールド行列(転置済み)
+        DirectX::XMFLOAT4 color;       ///< マテリアルカラー
+        DirectX::XMFLOAT4 uvTransform; ///< UVオフセットとスケール
+        UINT textureSlice;             ///< 共有テクスチャ配列のスライス
+        UINT padding[3];               ///< パディング
+    };
+
+    /**
+     * @struct VSBatchConstants
+     * @brief インスタンス描画のバッチ単位の定数バッファ
+     */
+    struct VSBatchConstants {
+        UINT instanceOffset;           ///< インスタンスバッファ内の先頭位置
+        UINT padding[3];               ///< パディング
+    };
+
+    /**
+     * @struct VSSkinConstants
+     * @brief スキニングされたメッシュの描画ごとの定数バッファ(VS の b1)
+     */
+    struct VSSkinConstants {
+        UINT boneOffset;               ///< スキニング行列のバッファ内の先頭
+        UINT padding[3];               ///< パディング
+    };
+
+    /**
+     * @struct InstanceKey
+     * @brief インスタンスのバッチ分けキー(メッシュ種別とテクスチャ)と元の位置
+     */
+    // ピクセルシェーダーのバリアントの機能(ソートキーの shader フィールドにも使う)
+    static constexpr uint32_t FEATURE_TEXTURE = 1;        ///< ディフューズテクスチャ
+    static constexpr uint32_t FEATURE_NORMAL_MAP = 2;     ///< ノーマルマップ(通常の描画のみ)
+    static constexpr uint32_t FEATURE_TEXTURE_ARRAY = 4;  ///< 共有テクスチャ配列(インスタンス描画のみ)
+    static constexpr uint32_t SHADER_VARIANT_COUNT = 8;   ///< 機能の組み合わせの数
+    static constexpr uint32_t SORT_COMPACT_VERTEX = 8;    ///< ソートキーの shader フィールドで小さな頂点形式を表すビット(頂点シェーダーの切り替えをまとめる)
+
+    static constexpr uint32_t POOLED_TEXTURE_BIT = 0x80000000u; ///< InstanceKey のテクスチャ部が共有配列のプール番号であることを示す
+
+    struct InstanceKey {
+        uint64_t key;                  ///< (MeshKey(meshType, lod) << 32) | texture(共有配列なら POOLED_TEXTURE_BIT | プール番号)
+        uint32_t index;                ///< instanceScratch_ 内の位置
+
+        bool operator<(const InstanceKey& other) const {
+            return key < other.key || (key == other.key && index < other.index);
+        }
+    };
+
+    static constexpr size_t INITIAL_INSTANCE_CAPACITY = 1024; ///< インスタンスバッファの初期容量
+    static constexpr size_t INITIAL_SKIN_CAPACITY = 1024;     ///< スキニング行列のバッファの初期容量(行列数)
+    static constexpr UINT CB_RING_SIZE = 4 * 1024 * 1024;     ///< 定数バッファのリングの容量(バイト)
+    static constexpr size_t MIN_PACKETS_PER_CONTEXT = 256;    ///< 遅延コンテキスト1つあたりの最小パケット数
+
+    // DirectX11リソース
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;
+  Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;  ///< 定数で分岐する汎用版(バリアントの作成失敗時に使用)
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> psVariants_[SHADER_VARIANT_COUNT];          ///< 機能ごとのバリアント
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> psInstancedVariants_[SHADER_VARIANT_COUNT]; ///< インスタンス描画用のバリアント
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layout_;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vsCompact_;     ///< 小さな頂点形式(VertexFormat::Compact / CompactQuantized)の頂点シェーダー
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layoutCompact_;   ///< VertexFormat::Compact の入力レイアウト
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layoutQuantized_; ///< VertexFormat::CompactQuantized の入力レイアウト
+    bool compactVerticesSupported_ = false;                     ///< 小さな頂点形式のシェーダーと入力レイアウトの準備ができたか
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vsSkinned_;      ///< スキニングする頂点シェーダー(標準の頂点形式 + SkinInfluence)
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layoutSkinned_;   ///< 標準の頂点形式(スロット0)と SkinInfluence(スロット1)の入力レイアウト
+    Microsoft::WRL::ComPtr<ID3D11Buffer> skinCb_;               ///< VSSkinConstants
+    Microsoft::WRL::ComPtr<ID3D11Buffer> skinBuffer_;           ///< スキニング行列(フレームごとに全モデル分を書き込む構造化バッファ)
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> skinSrv_;
+    size_t skinCapacity_ = 0;                                   ///< skinBuffer_ の行列数
+    bool skinningSupported_ = false;                            ///< スキニングのシェーダーと入力レイアウトの準備ができたか
+    bool skinningActive_ = false;                               ///< このフレームのスキニング行列を書き込めたか(false の場合はバインドポーズで描画)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> vsCb_;
+    CachedConstants<FrameConstants> frameCb_;      ///< カメラ・画面(内容が変わったフレームだけ更新)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> textureArrayMaterialCb_; ///< 共有テクスチャ配列のインスタンス描画用のPS定数(不変)
+    MaterialManager* materials_ = nullptr;         ///< マテリアルの定数バッファ(ServiceLocator)
+    CachedConstants<PSLightConstants> psLightCb_;  ///< ディレクショナルライト(変わった時だけ更新)
+    ConstantBufferRing cbRing_;                    ///< オブジェクト定数のリング(D3D11.1)
+    LightClusters lightClusters_;                  ///< 点光源・スポットライトのクラスタ分割
+    ParticleSystem particles_;                     ///< ParticleEmitter のGPUパーティクル
+    bool particlesSupported_ = false;              ///< コンピュートシェーダーとバッファの準備ができたか
+    bool particlesEnabled_ = true;                 ///< GPUパーティクルを更新・描画するか
+    GpuMovers movers_;                             ///< GpuMover の構造化バッファ・積分・描画
+    SharedModelTable sharedModels_;                ///< PackedMeshRenderer の共有モデル
+    std::vector<SharedModelTable::Entry> sharedEntries_;   ///< 抽出で使う共有モデルの写し
+    std::vector<RenderProxyModelMesh> sharedMeshes_;       ///< 共有モデルごとに解決したバッファ(抽出ごと)
+    std::vector<uint32_t> sharedResolved_;                 ///< sharedMeshes_ を解決した抽出の番号
+    uint32_t sharedVersion_ = 0;                           ///< sharedEntries_ を写し取った時点の版
+    uint32_t extractIndex_ = 0;                            ///< ExtractRenderProxies の呼び出し回数
+    bool moversSupported_ = false;                 ///< コンピュートシェーダーとシェーダーの準備ができたか
+    VideoSurfaceRenderer videoSurfaces_;           ///< VideoSurface の描画
+    bool videoSurfacesSupported_ = false;          ///< 動画のシェーダーの準備ができたか
+    CascadedShadowMaps shadows_;                   ///< ディレクショナルライトのカスケードシャドウマップ
+    bool shadowsSupported_ = false;                ///< シェーダーとシャドウマップの準備ができたか
+    bool shadowsEnabled_ = true;                   ///< ディレクショナルライトの影を描くか
+    DirectionalLight shadowLight_{};               ///< 影を落とすディレクショナルライト(UpdateLightConstants で取得)
+    bool hasDirectionalLight_ = false;             ///< このフレームにディレクショナルライトがあるか
+    bool cbRingEnabled_ = true;                    ///< 描画キューでリングを使うか
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterState_;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState_;
+
+    // インスタンス描画
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vsInstanced_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> psInstanced_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> batchCb_;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> instanceSrv_;
+    size_t instanceCapacity_ = 0;                 ///< instanceBuffer_ の要素数
+    TrackedVector<InstanceData, MemoryTag::Render> instanceScratch_; ///< 収集したインスタンス(フレーム間で再利用)
+    TrackedVector<InstanceKey, MemoryTag::Render> instanceKeys_;     ///< ソート用キー(フレーム間で再利用)
+    TrackedVector<InstanceKey, MemoryTag::Render> instanceKeysVisible_; ///< カリングで詰めたキー(instanceKeys_ と入れ替えて再利用)
+    bool instancingSupported_ = false;            ///< シェーダーとバッファの準備ができたか
+    bool instancingEnabled_ = true;               ///< インスタンス描画を使うか
+    bool modelInstancingEnabled_ = true;          ///< ModelComponent もインスタンス描画でまとめるか
+
+    // インスタンス描画に回した ModelComponent(RenderModelComponents() で集め、RenderMeshRenderers() で描く)
+    struct ModelInstanceProxy {
+        uint32_t proxy;                           ///< proxies.models の添字
+        RenderProxyMesh mesh;                     ///< 選択したLODのメッシュ
+    };
+    static constexpr uint32_t MODEL_INSTANCE_BIT = 0x80000000u; ///< InstanceKey のメッシュ部が modelInstanceMeshes_ の添字であることを示す
+    TrackedVector<ModelInstanceProxy, MemoryTag::Render> modelInstanceProxies_;
+    TrackedVector<RenderProxyMesh, MemoryTag::Render> modelInstanceMeshes_;   ///< このフレームのモデルのメッシュ(重複なし)
+    std::unordered_map<uint64_t, uint32_t> modelInstanceSlots_;               ///< (MeshSortId(頂点バッファ), 先頭インデックス) -> modelInstanceMeshes_ の添字
+
+    // GPUカリング(インスタンス描画の視錐台カリングと間接描画)
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vsInstancedCulled_; ///< 可視リストを経由して読むインスタンス描画の頂点シェーダー
+    GpuCulling gpuCulling_;
+    bool gpuCullingSupported_ = false;            ///< 機能レベルとシェーダーの準備ができたか
+    bool gpuCullingEnabled_ = true;               ///< 対応環境でGPUカリングを使うか
+
+    // 視錐台カリング
+    Frustum frustum_{};                           ///< 現在のフレームの視錐台
+    SphereCullList queueCull_;                    ///< 描画キューのパケットと同順の境界球
+    SphereCullList instanceCull_;                 ///< instanceScratch_ と同順の境界球
+
+    // LocalToWorld のない MeshRenderer のワールド行列(抽出の最後に WorldMatrixBatch でまとめて計算)
+    struct PendingWorld {
+        size_t proxy;                             ///< proxies.meshes の添字
+        const MeshData* boundsMesh;               ///< 境界球の元(nullptr ならカリングしない)
+    };
+    TrackedVector<PendingWorld, MemoryTag::Render> pendingWorlds_;
+    TrackedVector<DirectX::XMFLOAT3, MemoryTag::Render> pendingPositions_;
+    TrackedVector<DirectX::XMFLOAT3, MemoryTag::Render> pendingRotations_;
+    TrackedVector<DirectX::XMFLOAT3, MemoryTag::Render> pendingScales_;
+    TrackedVector<DirectX::XMFLOAT4X4, MemoryTag::Render> pendingMatrices_;
+    JobSystem* jobs_ = nullptr;                   ///< カリングの並列化用(nullptr可)
+    bool cullingEnabled_ = true;                  ///< 視錐台カリングを行うか
+
+    /**
+     * @struct ShaderReload
+     * @brief ワーカーで検証中のホットリロードのソース
+     */
+    struct ShaderReload {
+        std::string vs;                    ///< 頂点シェーダーのソース
+        std::string ps;                    ///< ピクセルシェーダーのソース
+        bool succeeded = false;            ///< すべてのバリアントのコンパイルに成功したか
+        std::string error;                 ///< 失敗したバリアントとコンパイラのメッセージ
+        std::atomic<bool> done{ false };   ///< ワーカーの処理が終わったか
+    };
+
+    // シェーダーのホットリロード
+    bool shaderHotReload_ = false;                ///< SetShaderHotReloadEnabled()
+    const char* builtinVS_ = nullptr;             ///< CompileShaders() の組み込みのソース(書き出しの元)
+    const char* builtinPS_ = nullptr;
+    std::string vsSource_;                        ///< 現在のシェーダーのソース(監視を始めるまでは空)
+    std::string psSource_;
+    FileWatcher shaderWatcher_;                   ///< SHADER_SOURCE_DIRECTORY の変更の通知
+    std::shared_ptr<ShaderReload> shaderReload_;  ///< 検証中のソース(なければ nullptr)
+    JobSystem::JobCounter shaderReloadJobs_;      ///< 検証のジョブ
+
+    // フレームの記録と再生
+    /**
+     * @struct ReplayState
+     * @brief BeginReplay() で作り直した記録のリソース
+     */
+    struct ReplayState {
+        bool active = false;
+        std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> buffers; ///< FrameCapture::buffers と同じ順
+        std::vector<TextureManager::TextureHandle> textures;       ///< FrameCapture::textures と同じ順(ファイルなしは INVALID_TEXTURE)
+        std::vector<DrawPacket> packets;                           ///< 記録したソート済みの順
+        FrameConstants frame;
+        PSLightConstants light;
+    };
+    std::string capturePath_;                     ///< 次の Render() で書き出す先(空なら記録しない)
+    ReplayState replay_;
+
+    // カリング用BVH(プロキシの境界球をエンティティごとに保持)
+    static constexpr uint32_t CULL_TREE_MESHES = 0;     ///< proxies.meshes
+    static constexpr uint32_t CULL_TREE_MODELS = 1;     ///< proxies.models
+    static constexpr uint32_t CULL_TREE_LIST_SHIFT = 31; ///< 葉の値: (リスト << 31) | プロキシの添字
+    static constexpr float CULL_TREE_MARGIN = 0.25f;    ///< 葉の余白(小さな揺れで木を組み替えない)
+
+    struct CullTreeSlot {
+        Entity entity{ 0, 0 };                    ///< 葉の持ち主
+        uint32_t proxy = DynamicBvh::NULL_NODE;   ///< 葉(なければ NULL_NODE)
+        uint32_t stamp = 0;                       ///< 最後に抽出された UpdateCullTree の回
+    };
+
+    DynamicBvh cullTree_{ CULL_TREE_MARGIN };
+    std::vector<CullTreeSlot> cullTreeSlots_[2];  ///< リストごとにエンティティ番号で引く
+    TrackedVector<uint8_t, MemoryTag::Render> cullTreeVisible_[2]; ///< プロキシと同順の事前判定の結果
+    uint32_t cullTreeStamp_ = 0;
+    bool cullTreeEnabled_ = true;                 ///< BVHで事前に除外するか
+    bool cullTreeActive_ = false;                 ///< このフレームで事前の除外を行うか
+
+    // 遮蔽カリング(ソフトウェアラスタライズした遮蔽物の階層Zバッファ)
+    static constexpr float OCCLUDER_MIN_SIZE = 0.1f; ///< 遮蔽物にする投影サイズ(MeshLod::ProjectedSize())の下限
+    static constexpr size_t MAX_OCCLUDERS = 32;      ///< 1フレームにラスタライズする遮蔽物の上限(大きい順)
+
+    struct OccluderCandidate {
+        float size;      ///< 投影サイズ
+        uint32_t proxy;  ///< proxies.meshes の添字
+    };
+
+    OcclusionBuffer occlusion_;
+    std::vector<OccluderCandidate> occluderCandidates_; ///< 遮蔽物の候補(フレーム間で再利用)
+    bool occlusionEnabled_ = true;                ///< 遮蔽カリングを行うか
+    bool occlusionActive_ = false;                ///< このフレームに遮蔽物をラスタライズしたか
+
+    // メッシュキャッシュ(キーは MeshKey())
+    std::unordered_map<int, std::unique_ptr<MeshData>> meshCache_;
+    const MeshPool* meshPools_[VERTEX_FORMAT_COUNT] = {}; ///< 頂点形式ごとの共有メッシュバッファ(GfxDevice::Meshes())
+
+    // LOD
+    LodHistory meshLods_;                         ///< MeshRenderer の前回のLOD
+    LodHistory modelLods_;                        ///< ModelComponent の前回のLOD
+    bool lodEnabled_ = true;                      ///< LOD選択を行うか
+    float lodScale_ = 1.0f;                       ///< LOD選択の投影サイズの倍率(SetLodScale)
+    float textureDetailScale_ = 1.0f;             ///< テクスチャに要求する解像度の倍率(SetTextureDetailScale)
+    bool textureStreaming_ = false;               ///< このフレームにストリーミング中のテクスチャがあるか
+    float screenHeight_ = 0.0f;                   ///< 投影サイズをピクセルに換算する画面の高さ
+
+    // 深度プリパス
+    static constexpr uint32_t PIPELINE_PASS_INSTANCED = 0;     ///< インスタンス描画(とキューへの収集)
+    static constexpr uint32_t PIPELINE_PASS_DEPTH_PREPASS = 1; ///< 描画キューの深度プリパス
+    static constexpr uint32_t PIPELINE_PASS_QUEUE = 2;         ///< 描画キューのシェーディング
+    static constexpr uint32_t PIPELINE_PASS_COUNT = 3;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthPrepassState_; ///< LESS、深度書き込みあり
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthEqualState_;   ///< LESS_EQUAL、深度書き込みなし(プリパス後と半透明パス)
+    Microsoft::WRL::ComPtr<ID3D11BlendState> transparentBlend_;         ///< 半透明パスのアルファブレンド
+    PipelineState pipeline_;                      ///< 標準の頂点形式・既定の深度ステート(BindPipelineState)
+    PipelineState pipelineDepthEqual_;            ///< pipeline_ の深度ステートを depthEqualState_ にしたもの(プリパス後)
+    PipelineState pipelineTransparent_;           ///< pipelineDepthEqual_ にアルファブレンドを加えたもの(半透明パス)
+    bool depthPrepassEnabled_ = false;            ///< 描画キューの深度プリパスを行うか
+    bool depthPrepassActive_ = false;             ///< プリパス後のシェーディング中か(BindPipelineState が参照)
+    bool frontToBackEnabled_ = false;             ///< 描画キューを手前から奥の順に並べるか
+    bool pipelineStatsEnabled_ = false;           ///< パイプライン統計を計測するか
+    float interpolationAlpha_ = 1.0f;             ///< 固定ステップ間の補間の割合(1 で補間なし)
+    uint32_t interpolationStep_ = 0;              ///< 補間する LocalToWorld::movedStep
+    PipelineStatisticsQuery pipelineQueries_[PIPELINE_PASS_COUNT]; ///< パスごとの統計クエリ
+
+    /**
+     * @struct BoundState
+     * @brief 直前に設定したステート(冗長な設定の省略用)
+     */
+    struct BoundState {
+        ID3D11Buffer* vertexBuffer = nullptr;                                   ///< 頂点バッファ
+        ID3D11Buffer* indexBuffer = nullptr;                                    ///< インデックスバッファ
+        DXGI_FORMAT indexFormat = DXGI_FORMAT_UNKNOWN;                          ///< インデックス形式
+        TextureManager::TextureHandle texture = TextureManager::INVALID_TEXTURE; ///< テクスチャ
+        TextureManager::TextureHandle normalTexture = TextureManager::INVALID_TEXTURE; ///< ノーマルマップ
+        ID3D11Buffer* material = nullptr;                                       ///< PS定数(マテリアルの定数バッファ)
+        ID3D11PixelShader* pixelShader = nullptr;                               ///< ピクセルシェーダー
+        VertexFormat vertexFormat = VertexFormat::Standard;                     ///< 頂点シェーダーと入力レイアウトの頂点形式(BindPipelineState() は Standard)
+        bool skinned = false;                                                   ///< スキニングの頂点シェーダーと入力レイアウトか
+        ID3D11Buffer* skinBuffer = nullptr;                                     ///< スロット1の頂点バッファ
+        UINT boneOffset = UINT_MAX;                                             ///< skinCb_ に書き込んだ先頭
+        bool texturesValid = false;                                             ///< texture/normalTexture が有効か
+    };
+
+    /**
+     * @struct DrawContext
+     * @brief 描画コマンドの送信先とその記録状態(コンテキストごとに1つ)
+     */
+    struct DrawContext {
+        ID3D11DeviceContext* ctx = nullptr; ///< 送信先(即時または遅延コンテキスト)
+        StateCache* states = nullptr;       ///< ctx のステートキャッシュ(シェーダー・入力レイアウト・定数バッファの設定先)
+        BoundState bound;                   ///< 直前に設定したステート
+        Statistics* stats = nullptr;        ///< 統計の加算先
+    };
+
+    /**
+     * @struct DeferredSlot
+     * @brief 並列記録用の遅延コンテキストと記録結果
+     */
+    struct DeferredSlot {
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext> ctx;       ///< 遅延コンテキスト
+        Microsoft::WRL::ComPtr<ID3D11CommandList> commands;    ///< 記録したコマンドリスト
+        StateCache states;                                     ///< ctx のステートキャッシュ(記録のたびに空から始める)
+        Statistics stats;                                      ///< この記録分の統計
+    };
+
+    /**
+     * @struct SubmitBenchmark
+     * @brief 単一スレッド送信と並列記録の比較計測
+     */
+    struct SubmitBenchmark {
+        uint32_t framesLeft = 0;        ///< 残りフレーム数(0で停止中)
+        double totalMs[2] = { 0, 0 };   ///< 方式ごとの送信時間の合計(0: 単一スレッド, 1: 並列記録)
+        uint32_t frames[2] = { 0, 0 };  ///< 方式ごとの計測フレーム数
+        bool restoreDeferred = false;   ///< 計測前の deferredEnabled_
+    };
+
+    // 描画キュー
+    static constexpr uint32_t TRANSPARENT_ID_MESH = 0;         ///< TransparentId() の種類: MeshRenderer
+    static constexpr uint32_t TRANSPARENT_ID_MODEL = 1;        ///< TransparentId() の種類: ModelComponent
+    static constexpr uint32_t TRANSPARENT_ID_STATIC_BATCH = 2; ///< TransparentId() の種類: 静的バッチ(添字)
+    RenderQueue queue_;                                       ///< フレームごとの描画パケット
+    TransparentQueue transparent_;                            ///< 半透明のマテリアルの描画パケット(奥から手前)
+    std::unordered_map<ID3D11Buffer*, uint32_t> meshSortIds_; ///< 頂点バッファ -> ソート用ID
+    DrawContext immediate_;                                   ///< 即時コンテキストへの送信状態
+
+    // 遅延コンテキストによる並列記録
+    std::vector<std::unique_ptr<DeferredSlot>> deferred_;     ///< ワーカーごとの遅延コンテキスト
+    bool deferredEnabled_ = false;                            ///< 描画キューを並列記録するか
+    SubmitBenchmark benchmark_;                               ///< 送信方式の比較計測
+
+    // 静的バッチ
+    std::vector<StaticBatchData> staticBatches_;              ///< マテリアルごとのバッチ
+    size_t staticBatchMembers_ = 0;                           ///< 構築時のメンバー数
+    uint32_t staticBatchTick_ = 0;                            ///< 構築時の変更ティック
+    bool staticBatchesBuilt_ = false;                         ///< 一度でも構築したか
+    const World* lastWorld_ = nullptr;                        ///< 前回描画した World(キャッシュの持ち主)
+
+    // 描画プロキシ
+    RenderProxies proxies_;                                   ///< World から抽出した描画データ(ダブルバッファ)
+
+    // 状態管理
+    bool initialized_ = false;
+    Statistics stats_;
+    StateCacheStats stateCacheStart_;                         ///< SetupPipeline() 時点の GfxDevice::States() の統計
+
+    // 統計の履歴
+    std::unique_ptr<Statistics[]> history_ = std::make_unique<Statistics[]>(STATISTICS_HISTORY_FRAMES); ///< Render() ごとの統計のリング
+    size_t historyHead_ = 0;                                  ///< 次に書き込む位置
+    size_t historyCount_ = 0;                                 ///< 記録したフレーム数(最大 STATISTICS_HISTORY_FRAMES)
+    uint64_t frameCount_ = 0;                                 ///< Render() の呼び出し回数
+
+    /**
+     * @brief fn を実行し、かかったCPU時間を段階 pass に加算
+     */
+    template<class F>
+    void TimePass(Statistics::Pass pass, F&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        stats_.passMs[pass] += elapsed.count();
+    }
+
+    /**
+     * @brief シェーダーのコンパイル
+     */
+    bool CompileShaders(GfxDevice& gfx) {
+        // INSTANCED を定義すると、ワールド行列・色・UV変換をインスタンスバッファから読むバリアントになる
+        // SKINNED を定義すると、2本目の頂点ストリームの関節番号と重みで行列パレットを混ぜて頂点を変形するバリアントになる
+        const char* VS = R"(
+            cbuffer PerObject : register(b0) {
+                float4x4 gWorld;
+                float4 gUVTransform;
+            };
+
+            // カメラが動いたフレームだけ更新(ワールド行列との積は頂点ごとに計算する。PS の b3 と同じバッファ)
+            cbuffer PerView : register(b2) {
+                float4x4 gViewProj;
+                float3 gEyePos;
+                float padding_view;
+                float2 gScreenSize;
+                float gClusterNear;
+                float gClusterLogScale;
+                uint3 gClusterDims;
+                float padding_view2;
+            };
+
+#ifdef INSTANCED
+            struct InstanceData {
+                float4x4 world;
+                float4 color;
+                float4 uvTransform;
+                uint textureSlice;
+                uint3 instancePadding;
+            };
+            StructuredBuffer<InstanceData> gInstances : register(t0);
+
+            cbuffer PerBatch : register(b1) {
+                uint gInstanceOffset;
+                uint3 gBatchPadding;
+            };
+
+#ifdef GPU_CULLING
+            // GpuCulling が書き込んだ可視リスト(バッチの先頭位置 + SV_InstanceID → インスタンス番号)
+            StructuredBuffer<uint> gVisibleInstances : register(t1);
+#endif
+#endif
+
+#ifdef SKINNED
+            // AnimationSystem が計算したスキニング行列(全モデル分を連結、転置済み)
+            StructuredBuffer<float4x4> gBones : register(t0);
+
+            cbuffer PerSkin : register(b1) {
+                uint gBoneOffset;
+                uint3 gSkinPadding;
+            };
+#endif
+
+#ifdef COMPACT_VERTEX
+            // VertexFormat::Compact / CompactQuantized(量子化した位置は R16G16B16A16_UNORM のまま読み、ワールド行列で逆量子化する)
+            struct VSIn {
+                float3 pos : POSITION;
+                float2 tex : TEXCOORD;
+                float4 frame : NORMAL;  // 法線(xy)と接線(zw)の八面体写像、w の符号が従接線の向き
+            };
+
+            float3 DecodeOctahedral(float2 e) {
+                float3 v = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+                if (v.z < 0.0f) {
+                    float2 s = float2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+                    v.xy = (1.0f - abs(v.yx)) * s;
+                }
+                return normalize(v);
+            }
+#else
+            struct VSIn {
+                float3 pos : POSITION;
+                float2 tex : TEXCOORD;
+                float3 nrm : NORMAL;
+                float3 tan : TANGENT;
+                float3 bitan : BITANGENT;
+#ifdef SKINNED
+                uint4 bones : BLENDINDICES;     // SkinInfluence(スロット1)
+                float4 weights : BLENDWEIGHT;
+#endif
+            };
+#endif
+
+            struct VSOut {
+                float4 pos : SV_POSITION;
+                float2 tex : TEXCOORD;
+                float3 nrm : NORMAL;
+                float3 tan : TANGENT;
+                float3 bitan : BITANGENT;
+                float3 worldPos : WORLDPOS;
+#ifdef INSTANCED
+                float4 color : COLOR;
+                nointerpolation uint textureSlice : TEXSLICE;
+#endif
+            };
+
+            VSOut main(VSIn i, uint instanceId : SV_InstanceID) {
+                VSOut o;
+#ifdef INSTANCED
+#ifdef GPU_CULLING
+                InstanceData inst = gInstances[gVisibleInstances[gInstanceOffset + instanceId]];
+#else
+                InstanceData inst = gInstances[gInstanceOffset + instanceId];
+#endif
+                float4x4 world = inst.world;
+                float4 uvTransform = inst.uvTransform;
+                o.color = inst.color;
+                o.textureSlice = inst.textureSlice;
+#else
+                float4x4 world = gWorld;
+                float4 uvTransform = gUVTransform;
+#endif
+                float3 pos = i.pos;
+#ifdef COMPACT_VERTEX
+                float3 nrm = DecodeOctahedral(i.frame.xy);
+                float3 tan = DecodeOctahedral(float2(i.frame.z, abs(i.frame.w) * 2.0f - 1.0f));
+                float3 bitan = cross(nrm, tan) * (i.frame.w < 0.0f ? -1.0f : 1.0f);
+#else
+                float3 nrm = i.nrm;
+                float3 tan = i.tan;
+                float3 bitan = i.bitan;
+#endif
+#ifdef SKINNED
+                float4x4 skin = gBones[gBoneOffset + i.bones.x] * i.weights.x
+                              + gBones[gBoneOffset + i.bones.y] * i.weights.y
+                              + gBones[gBoneOffset + i.bones.z] * i.weights.z
+                              + gBones[gBoneOffset + i.bones.w] * i.weights.w;
+                pos = mul(float4(pos, 1.0f), skin).xyz;
+                nrm = mul(nrm, (float3x3)skin);
+                tan = mul(tan, (float3x3)skin);
+                bitan = mul(bitan, (float3x3)skin);
+#endif
+                float4 worldPos = mul(float4(pos, 1.0f), world);
+                o.pos = mul(worldPos, gViewProj);
+                o.worldPos = worldPos.xyz;
+                o.nrm = mul(nrm, (float3x3)world);
+                o.tan = mul(tan, (float3x3)world);
+                o.bitan = mul(bitan, (float3x3)world);
+                o.tex = i.tex * uvTransform.zw + uvTransform.xy;
+                return o;
+            }
+        )";
+
+        const char* PS = R"(
+            struct DirectionalLight {
+     float3 direction;
+          float padding;
+  float4 color;
+     };
+
+         cbuffer PerObject : register(b0) {
+    float4 gColor;
+    float gUseTexture;
+       float gUseNormalMap;
+   float gSpecularPower;
+    float gUseTextureArray;
+            };
+
+            // ディレクショナルライトが変わった時だけ更新
+            cbuffer PerLight : register(b1) {
+                DirectionalLight gLight;
+                float3 gAmbientColor;
+                float padding_light;
+            };
+
+            // カメラと画面で決まる値(VS の b2 と同じバッファ)
+            cbuffer PerView : register(b3) {
+                float4x4 gViewProj;
+                float3 gEyePos;
+                float padding_view;
+                float2 gScreenSize;
+                float gClusterNear;
+                float gClusterLogScale;
+                uint3 gClusterDims;
+                float padding_view2;
+            };
+
+            // 点光源・スポットライト(LightClusters.h の GpuLight と同じレイアウト)
+            struct LocalLight {
+                float3 position;
+                float range;
+                float3 color;
+                float cosOuter;
+                float3 direction;
+                float cosInner;
+            };
+            StructuredBuffer<LocalLight> gLights : register(t3);
+            StructuredBuffer<uint2> gClusters : register(t4);
+            StructuredBuffer<uint> gLightIndices : register(t5);
+
+            // カスケードシャドウマップ(CascadedShadowMaps.h の ShadowConstants と同じレイアウト)
+            cbuffer PerShadow : register(b2) {
+                float4x4 gShadowViewProj[4];
+                float gShadowTexel;
+                float gShadowBias;
+                uint gShadowCascades;
+                float padding_shadow;
+            };
+            Texture2DArray<float> gShadowMap : register(t6);
+            SamplerComparisonState gShadowSampler : register(s1);
+
+            // 最初に収まるカスケードで 2x2 の PCF(どのカスケードにも入らなければ影なし)
+            float ShadowFactor(float3 worldPos) {
+                for (uint c = 0; c < gShadowCascades; ++c) {
+                    float4 p = mul(float4(worldPos, 1.0f), gShadowViewProj[c]);
+                    float2 uv = float2(p.x * 0.5f + 0.5f, 0.5f - p.y * 0.5f);
+                    float margin = gShadowTexel * 2.0f;
+                    if (any(uv < margin) || any(uv > 1.0f - margin) || p.z > 1.0f) continue;
+                    float depth = p.z - gShadowBias;
+                    float sum = 0.0f;
+                    [unroll] for (int k = 0; k < 4; ++k) {
+                        float2 offset = (float2(k & 1, k >> 1) - 0.5f) * gShadowTexel;
+                        sum += gShadowMap.SampleCmpLevelZero(gShadowSampler, float3(uv + offset, c), depth);
+                    }
+                    return sum * 0.25f;
+                }
+                return 1.0f;
+            }
+
+   Texture2D gTexture : register(t0);
+      Texture2D gNormalMap : register(t1);
+#ifdef INSTANCED
+      Texture2DArray gTextureArray : register(t2);
+#endif
+ SamplerState gSampler : register(s0);
+
+            // バリアントでは HAS_* を 0/1 で定義し、分岐をコンパイル時に取り除く(未定義なら定数で分岐する汎用版)
+#ifdef HAS_TEXTURE
+#define USE_TEXTURE HAS_TEXTURE
+#else
+#define USE_TEXTURE (gUseTexture > 0.5)
+#endif
+#ifdef HAS_NORMAL_MAP
+#define USE_NORMAL_MAP HAS_NORMAL_MAP
+#else
+#define USE_NORMAL_MAP (gUseNormalMap > 0.5)
+#endif
+#ifdef HAS_TEXTURE_ARRAY
+#define USE_TEXTURE_ARRAY HAS_TEXTURE_ARRAY
+#else
+#define USE_TEXTURE_ARRAY (gUseTextureArray > 0.5)
+#endif
+
+            struct VSOut {
+       float4 pos : SV_POSITION;
+       float2 tex : TEXCOORD;
+ float3 nrm : NORMAL;
+     float3 tan : TANGENT;
+      float3 bitan : BITANGENT;
+      float3 worldPos : WORLDPOS;
+#ifdef INSTANCED
+      float4 color : COLOR;
+      nointerpolation uint textureSlice : TEXSLICE;
+#endif
+    };
+
+    float4 main(VSOut i) : SV_Target {
+      float3 normal = normalize(i.nrm);
+     if (USE_NORMAL_MAP) {
+        float3x3 TBN = float3x3(normalize(i.tan), normalize(i.bitan), normalize(i.nrm));
+            // XYからZを復元(2チャンネルのBC5ノーマルマップにも対応)
+            float2 nxy = gNormalMap.Sample(gSampler, i.tex).xy * 2.0 - 1.0;
+            float3 tangentNormal = float3(nxy, sqrt(saturate(1.0 - dot(nxy, nxy))));
+               normal = normalize(mul(tangentNormal, TBN));
+   }
+
+     float light_factor = max(0.0f, dot(normal, -gLight.direction));
+
+#ifdef INSTANCED
+ float4 final_color = i.color;
+#else
+ float4 final_color = gColor;
+#endif
+         if (USE_TEXTURE) {
+     final_color *= gTexture.Sample(gSampler, i.tex);
+   }
+#ifdef INSTANCED
+         if (USE_TEXTURE_ARRAY) {
+            final_color *= gTextureArray.Sample(gSampler, float3(i.tex, i.textureSlice));
+         }
+#endif
+
+         float3 toEye = normalize(gEyePos - i.worldPos);
+     float3 reflection = reflect(gLight.direction, normal);
+     float spec_factor = pow(max(0.0f, dot(toEye, reflection)), gSpecularPower);
+
+    float shadow = ShadowFactor(i.worldPos);
+    float3 diffuse = final_color.rgb * gLight.color.rgb * light_factor * shadow;
+     float3 ambient = final_color.rgb * gAmbientColor;
+           float3 specular = gLight.color.rgb * spec_factor * shadow;
+
+         // このピクセルのクラスタに登録されたライトだけを加算(SV_Position.w はビュー空間の奥行き)
+         uint3 cluster;
+         cluster.xy = min(uint2(i.pos.xy / gScreenSize * float2(gClusterDims.xy)), gClusterDims.xy - 1);
+         cluster.z = min(uint(max(log(i.pos.w / gClusterNear) * gClusterLogScale, 0.0)), gClusterDims.z - 1);
+         uint2 lightRange = gClusters[(cluster.z * gClusterDims.y + cluster.y) * gClusterDims.x + cluster.x];
+         float3 local = float3(0.0, 0.0, 0.0);
+         for (uint k = 0; k < lightRange.y; ++k) {
+            LocalLight L = gLights[gLightIndices[lightRange.x + k]];
+            float3 toLight = L.position - i.worldPos;
+            float dist = length(toLight);
+            float3 l = toLight / max(dist, 1e-4);
+            float window = saturate(1.0 - pow(dist / L.range, 4.0));
+            float attenuation = window * window / (dist * dist + 1.0);
+            float spot = smoothstep(L.cosOuter, L.cosInner, dot(-l, L.direction));
+            float ndotl = max(0.0, dot(normal, l));
+            float spec = pow(max(0.0, dot(toEye, reflect(-l, normal))), gSpecularPower);
+            local += L.color * (attenuation * spot) * (final_color.rgb * ndotl + spec);
+         }
+
+          return float4(diffuse + ambient + specular + local, final_color.a);
+            }
+  )";
+
+        // ホットリロードで書き出す元として組み込みのソースを覚えておく
+        builtinVS_ = VS;
+        builtinPS_ = PS;
+
+Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
+        const UINT compileFlags = ShaderCompileFlags();
+
+        // 頂点シェーダーのコンパイル
+        HRESULT hr = ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err);
+  if (FAILED(hr)) {
+   if (err) {
+        std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
+     DEBUGLOG_ERROR("[RenderSystem] 頂点シェーダーのコンパイル失敗: " + errorMsg);
+            } else {
+        DEBUGLOG_ERROR("[RenderSystem] 頂点シェーダーのコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            }
+            return false;
+        }
+
+// ピクセルシェーダーのコンパイル
+  err.Reset();
+        hr = ShaderCache::Compile(PS, nullptr, "main", "ps_5_0", compileFlags, psb, err);
+        if (FAILED(hr)) {
+            if (err) {
+         std::string errorMsg(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize());
+     DEBUGLOG_ERROR("[RenderSystem] ピクセルシェーダーのコンパイル失敗: " + errorMsg);
+  } else {
+      DEBUGLOG_ERROR("[RenderSystem] ピクセルシェーダーのコンパイル失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            }
+return false;
+        }
+
+// 頂点シェーダーの作成
+        hr = gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs_.GetAddressOf());
+if (FAILED(hr)) {
+       DEBUGLOG_ERROR("[RenderSystem] 頂点シェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+        return false;
+     }
+
+     // ピクセルシェーダーの作成
+        hr = gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps_.GetAddressOf());
+      if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] ピクセルシェーダーの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+          return false;
+  }
+
+        // 入力レイアウトの作成のためにvsb_を保存
+        vsBlob_ = vsb;
+
+        // 以降のバリアントは互いに独立しているため、ジョブシステムがあればワーカーで並列にコンパイルする
+        // (ShaderCache はキーごとに別のファイル、ID3D11Device の作成系の呼び出しはスレッドセーフ)
+        JobSystem::JobCounter counter;
+        auto submit = [this, &counter](std::function<void()> job) {
+            if (jobs_) {
+                jobs_->Submit(std::move(job), &counter);
+            } else {
+                job();
+            }
+        };
+        const bool computeShaders = gfx.SupportsComputeShaders();
+
+        // 小さな頂点形式用の頂点シェーダー(失敗した場合はモデルを読み込んでも描画しない)
+        submit([&]() { compactVerticesSupported_ = CompileCompactVertexShader(gfx, VS, compileFlags); });
+
+        // スキニング用の頂点シェーダー(失敗した場合はスキニングされたモデルをバインドポーズで描画)
+        submit([&]() { skinningSupported_ = CompileSkinnedVertexShader(gfx, VS, compileFlags); });
+
+        // インスタンス描画用バリアント(失敗しても1エンティティ1ドローで継続)
+        // GPUでのカリングと間接描画はその後に続ける(機能レベル 11_0 以上の場合のみ、失敗してもCPUのカリングで継続)
+        submit([&]() {
+            instancingSupported_ = CompileInstancedShaders(gfx, VS, PS, compileFlags);
+            gpuCullingSupported_ = instancingSupported_ && computeShaders && CompileGpuCullingShaders(gfx, VS, compileFlags);
+            if (gpuCullingSupported_ && !gpuCulling_.Init(gfx.Dev(), compileFlags)) {
+                vsInstancedCulled_.Reset();
+                gpuCullingSupported_ = false;
+            }
+        });
+
+        // 機能ごとのピクセルシェーダー(失敗したものは汎用版で描画)
+        CompilePixelShaderVariants(gfx, PS, compileFlags, submit);
+
+        // GPUパーティクル(失敗しても ParticleEmitter を描かないだけで継続)
+        submit([&]() { particlesSupported_ = computeShaders && particles_.Init(gfx.Dev(), compileFlags); });
+
+        // GpuMover の積分と描画(失敗しても GpuMover を描かないだけで継続)
+        submit([&]() { moversSupported_ = computeShaders && movers_.Init(gfx.Dev(), compileFlags); });
+
+        // VideoSurface の描画(失敗しても動画を描かないだけで継続)
+        submit([&]() { videoSurfacesSupported_ = videoSurfaces_.Init(gfx.Dev(), compileFlags); });
+
+        // カスケードシャドウマップ(失敗しても影なしで継続)
+        submit([&]() { shadowsSupported_ = shadows_.Init(gfx.Dev(), compileFlags); });
+
+        // 待つ間も呼び出しスレッドがコンパイルを引き受ける
+        if (jobs_) jobs_->Wait(counter);
+
+        // インスタンス描画が使えない場合、先にコンパイルしたインスタンス描画用のピクセルシェーダーは使わない
+        if (!instancingSupported_) {
+            for (uint32_t i = 0; i < SHADER_VARIANT_COUNT; ++i) {
+                psInstancedVariants_[i].Reset();
+            }
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("[RenderSystem] インスタンスのカリング: ") + (gpuCullingSupported_ ? "GPU (間接描画)" : "CPU"));
+        if (!particlesSupported_) {
+            DEBUGLOG_WARNING("[RenderSystem] GPUパーティクルを無効化します");
+        }
+        if (!shadowsSupported_) {
+            DEBUGLOG_WARNING("[RenderSystem] ディレクショナルライトの影を無効化します");
+        }
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] シェーダーのコンパイル完了");
+        return true;
+    }
+
+    // 頂点シェーダーのバリアントのマクロ(ホットリロードの検証と同じキーで ShaderCache を引くため共有)
+    static constexpr D3D_SHADER_MACRO COMPACT_VERTEX_DEFINES[] = { { "COMPACT_VERTEX", "1" }, { nullptr, nullptr } };
+    static constexpr D3D_SHADER_MACRO SKINNED_DEFINES[] = { { "SKINNED", "1" }, { nullptr, nullptr } };
+    static constexpr D3D_SHADER_MACRO INSTANCED_DEFINES[] = { { "INSTANCED", "1" }, { nullptr, nullptr } };
+    static constexpr D3D_SHADER_MACRO GPU_CULLING_DEFINES[] = { { "INSTANCED", "1" }, { "GPU_CULLING", "1" }, { nullptr, nullptr } };
+
+    // メッシュのシェーダーのコンパイルフラグ
+    static UINT ShaderCompileFlags() {
+        UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+        flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+        return flags;
+    }
+
+    Microsoft::WRL::ComPtr<ID3DBlob> vsBlob_; // 入力レイアウト作成用に保持
+    Microsoft::WRL::ComPtr<ID3DBlob> vsCompactBlob_; // 小さな頂点形式の入力レイアウト作成用に保持
+    Microsoft::WRL::ComPtr<ID3DBlob> vsSkinnedBlob_; // スキニングの入力レイアウト作成用に保持
+
+    /**
+     * @brief COMPACT_VERTEX を定義した頂点シェーダーのコンパイル(VertexFormat::Compact / CompactQuantized で共用)
+     */
+    bool CompileCompactVertexShader(GfxDevice& gfx, const char* vsSource, UINT compileFlags) {
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, err;
+
+        HRESULT hr = ShaderCache::Compile(vsSource, COMPACT_VERTEX_DEFINES, "main", "vs_5_0", compileFlags, vsb, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[RenderSystem] 小さな頂点形式用頂点シェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        if (FAILED(gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vsCompact_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[RenderSystem] 小さな頂点形式用頂点シェーダーの作成失敗");
+            return false;
+        }
+        vsCompactBlob_ = vsb;
+        return true;
+    }
+
+    /**
+     * @brief SKINNED を定義した頂点シェーダーのコンパイル(標準の頂点形式のみ)
+     */
+    bool CompileSkinnedVertexShader(GfxDevice& gfx, const char* vsSource, UINT compileFlags) {
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, err;
+
+        HRESULT hr = ShaderCache::Compile(vsSource, SKINNED_DEFINES, "main", "vs_5_0", compileFlags, vsb, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[RenderSystem] スキニング用頂点シェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        if (FAILED(gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vsSkinned_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[RenderSystem] スキニング用頂点シェーダーの作成失敗");
+            return false;
+        }
+        vsSkinnedBlob_ = vsb;
+        return true;
+    }
+
+    /**
+     * @brief INSTANCED を定義したシェーダーバリアントのコンパイル
+     */
+    bool CompileInstancedShaders(GfxDevice& gfx, const char* vsSource, const char* psSource, UINT compileFlags) {
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
+
+        HRESULT hr = ShaderCache::Compile(vsSource, INSTANCED_DEFINES, "main", "vs_5_0", compileFlags, vsb, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[RenderSystem] インスタンス描画用頂点シェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+
+        err.Reset();
+        hr = ShaderCache::Compile(psSource, INSTANCED_DEFINES, "main", "ps_5_0", compileFlags, psb, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[RenderSystem] インスタンス描画用ピクセルシェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+
+        if (FAILED(gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vsInstanced_.ReleaseAndGetAddressOf())) ||
+            FAILED(gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, psInstanced_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[RenderSystem] インスタンス描画用シェーダーの作成失敗");
+            vsInstanced_.Reset();
+            psInstanced_.Reset();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief INSTANCED と GPU_CULLING を定義した頂点シェーダーのコンパイル(GpuCulling の初期化は呼び出し側)
+     */
+    bool CompileGpuCullingShaders(GfxDevice& gfx, const char* vsSource, UINT compileFlags) {
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, err;
+
+        HRESULT hr = ShaderCache::Compile(vsSource, GPU_CULLING_DEFINES, "main", "vs_5_0", compileFlags, vsb, err);
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[RenderSystem] GPUカリング用頂点シェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        if (FAILED(gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vsInstancedCulled_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[RenderSystem] GPUカリング用頂点シェーダーの作成失敗");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 機能の組み合わせごとのピクセルシェーダーのコンパイル
+     *
+     * @details
+     * 通常の描画はテクスチャ・ノーマルマップの4通り、インスタンス描画はテクスチャなし・テクスチャ・
+     * 共有テクスチャ配列の3通りです。ノーマルマップとテクスチャ配列はそれぞれ片方の経路でしか使わないため作りません。
+     * 1つのバリアントを1回の submit で渡します(インスタンス描画用は、インスタンス描画が使えるかの判定を待たずにコンパイル)。
+     */
+    template<class Submit>
+    void CompilePixelShaderVariants(GfxDevice& gfx, const char* psSource, UINT compileFlags, Submit& submit) {
+        for (uint32_t features = 0; features < SHADER_VARIANT_COUNT; ++features) {
+            if (HasPixelShaderVariant(features, false)) {
+                submit([this, &gfx, psSource, compileFlags, features]() {
+                    psVariants_[features] = CompilePixelShaderVariant(gfx, psSource, compileFlags, features, false);
+                });
+            }
+            if (HasPixelShaderVariant(features, true)) {
+                submit([this, &gfx, psSource, compileFlags, features]() {
+                    psInstancedVariants_[features] = CompilePixelShaderVariant(gfx, psSource, compileFlags, features, true);
+                });
+            }
+        }
+    }
+
+    // ピクセルシェーダーのバリアントを作るか(通常の描画はテクスチャ配列なし、インスタンス描画はノーマルマップなし)
+    static bool HasPixelShaderVariant(uint32_t features, bool instanced) {
+        const bool texture = (features & FEATURE_TEXTURE) != 0;
+        const bool normalMap = (features & FEATURE_NORMAL_MAP) != 0;
+        const bool textureArray = (features & FEATURE_TEXTURE_ARRAY) != 0;
+        return instanced ? !normalMap && !(texture && textureArray) : !textureArray;
+    }
+
+    // ピクセルシェーダーのバリアントのマクロ(out は5要素)
+    static void PixelShaderVariantDefines(uint32_t features, bool instanced, D3D_SHADER_MACRO* out) {
+        out[0] = { "HAS_TEXTURE", (features & FEATURE_TEXTURE) ? "1" : "0" };
+        out[1] = { "HAS_NORMAL_MAP", (features & FEATURE_NORMAL_MAP) ? "1" : "0" };
+        out[2] = { "HAS_TEXTURE_ARRAY", (features & FEATURE_TEXTURE_ARRAY) ? "1" : "0" };
+        out[3] = { instanced ? "INSTANCED" : nullptr, "1" };
+        out[4] = { nullptr, nullptr };
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> CompilePixelShaderVariant(GfxDevice& gfx, const char* psSource, UINT compileFlags, uint32_t features, bool instanced) {
+        D3D_SHADER_MACRO defines[5];
+        PixelShaderVariantDefines(features, instanced, defines);
+        Microsoft::WRL::ComPtr<ID3DBlob> psb, err;
+        Microsoft::WRL::ComPtr<ID3D11PixelShader> shader;
+        HRESULT hr = ShaderCache::Compile(psSource, defines, "main", "ps_5_0", compileFlags, psb, err);
+        if (FAILED(hr) || FAILED(gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, shader.GetAddressOf()))) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[RenderSystem] ピクセルシェーダーのバリアント " + std::to_string(features) + " の作成失敗: " + errorMsg);
+            shader.Reset();
+        }
+        return shader;
+    }
+
+    // ホットリロードで編集するソースのパス('/' 区切り、FileWatcher の通知と同じ形)
+    static std::string ShaderSourcePath(bool pixel) {
+        return std::string(SHADER_SOURCE_DIRECTORY) + (pixel ? "/mesh_ps.hlsl" : "/mesh_vs.hlsl");
+    }
+
+    static bool ReadTextFile(const std::string& path, std::string& out) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        std::ostringstream text;
+        text << file.rdbuf();
+        out = text.str();
+        return true;
+    }
+
+    /**
+     * @brief 現在のソース(最初は組み込みのソース)を書き出して SHADER_SOURCE_DIRECTORY の監視を始める
+     */
+    bool StartShaderWatch() {
+        if (!builtinVS_ || !builtinPS_) return false;
+        if (vsSource_.empty()) {
+            vsSource_ = builtinVS_;
+            psSource_ = builtinPS_;
+        }
+        CreateDirectoryA(SHADER_SOURCE_DIRECTORY, nullptr); // 既にある場合は失敗するが問題ない
+        for (bool pixel : { false, true }) {
+            const std::string path = ShaderSourcePath(pixel);
+            const std::string& current = pixel ? psSource_ : vsSource_;
+            std::string existing;
+            if (ReadTextFile(path, existing)) {
+                if (existing == current) continue;
+                // 前回の編集は残しておく(組み込みのソースへ反映したら消してよい)
+                MoveFileExA(path.c_str(), (path + ".bak").c_str(), MOVEFILE_REPLACE_EXISTING);
+                DEBUGLOG_WARNING("[RenderSystem] 組み込みと異なるシェーダーのソースを退避: " + path + ".bak");
+            }
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << current;
+            if (!file) {
+                DEBUGLOG_WARNING("[RenderSystem] シェーダーのソースを書き出せないため、ホットリロードを無効化します: " + path);
+                return false;
+            }
+        }
+        if (!shaderWatcher_.Start({ SHADER_SOURCE_DIRECTORY })) {
+            DEBUGLOG_WARNING("[RenderSystem] シェーダーのソースを監視できないため、ホットリロードを無効化します");
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, std::string("[RenderSystem] シェーダーのホットリロード: ") + SHADER_SOURCE_DIRECTORY);
+        return true;
+    }
+
+    /**
+     * @brief 編集されたソースのすべてのバリアントのコンパイルをワーカーで始める(検証中なら前の結果は捨てる)
+     */
+    void StartShaderReload() {
+        auto reload = std::make_shared<ShaderReload>();
+        if (!ReadTextFile(ShaderSourcePath(false), reload->vs) || !ReadTextFile(ShaderSourcePath(true), reload->ps)) return;
+        if (reload->vs == vsSource_ && reload->ps == psSource_) return; // 保存し直しただけ
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] シェーダーを再コンパイル中");
+
+        shaderReload_ = reload;
+        auto compile = [reload]() {
+            reload->succeeded = ValidateMeshShaders(reload->vs.c_str(), reload->ps.c_str(), reload->error);
+            reload->done.store(true, std::memory_order_release);
+        };
+        if (jobs_ && jobs_->IsRunning()) {
+            jobs_->Submit(compile, &shaderReloadJobs_);
+        } else {
+            compile();
+        }
+    }
+
+    /**
+     * @brief CompileShaders() が作るすべてのメッシュのシェーダーを ShaderCache へコンパイル(ワーカーから呼ぶ)
+     * @param[out] error 最初に失敗したバリアントのメッセージ
+     * @return bool すべて成功した場合 true(以降の RebuildMeshShaders() はすべてキャッシュから読む)
+     */
+    static bool ValidateMeshShaders(const char* vsSource, const char* psSource, std::string& error) {
+        const UINT flags = ShaderCompileFlags();
+        auto compile = [&](const char* source, const D3D_SHADER_MACRO* defines, const char* target, const char* name) {
+            Microsoft::WRL::ComPtr<ID3DBlob> blob, err;
+            if (SUCCEEDED(ShaderCache::Compile(source, defines, "main", target, flags, blob, err))) return true;
+            error = std::string(name) + ": " + (err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::string("unknown error"));
+            return false;
+        };
+        if (!compile(vsSource, nullptr, "vs_5_0", "vs") || !compile(psSource, nullptr, "ps_5_0", "ps") ||
+            !compile(vsSource, COMPACT_VERTEX_DEFINES, "vs_5_0", "vs COMPACT_VERTEX") ||
+            !compile(vsSource, SKINNED_DEFINES, "vs_5_0", "vs SKINNED") ||
+            !compile(vsSource, INSTANCED_DEFINES, "vs_5_0", "vs INSTANCED") ||
+            !compile(psSource, INSTANCED_DEFINES, "ps_5_0", "ps INSTANCED") ||
+            !compile(vsSource, GPU_CULLING_DEFINES, "vs_5_0", "vs GPU_CULLING")) {
+            return false;
+        }
+        for (uint32_t features = 0; features < SHADER_VARIANT_COUNT; ++features) {
+            for (bool instanced : { false, true }) {
+                if (!HasPixelShaderVariant(features, instanced)) continue;
+                D3D_SHADER_MACRO defines[5];
+                PixelShaderVariantDefines(features, instanced, defines);
+                const std::string name = "ps variant " + std::to_string(features) + (instanced ? " INSTANCED" : "");
+                if (!compile(psSource, defines, "ps_5_0", name.c_str())) return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 検証が終わったソースでメッシュのシェーダーを作り直す(失敗していれば元のまま)
+     */
+    void ApplyShaderReload(ShaderReload& reload) {
+        if (!reload.succeeded) {
+            DEBUGLOG_ERROR("[RenderSystem] シェーダーのホットリロード失敗(元のシェーダーで描画を継続): " + reload.error);
+            return;
+        }
+        vsSource_ = std::move(reload.vs);
+        psSource_ = std::move(reload.ps);
+        if (RebuildMeshShaders(ServiceLocator::Get<GfxDevice>())) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] シェーダーをホットリロードしました");
+        }
+    }
+
+    /**
+     * @brief vsSource_ / psSource_ からメッシュの頂点・ピクセルシェーダーとバリアントを作り直す
+     *
+     * @details
+     * ValidateMeshShaders() の後に呼ぶため、コンパイルはすべてキャッシュから読むだけです。入力レイアウト・
+     * パーティクル・影・動画など、メッシュのソースに依存しないものは作り直しません。
+     */
+    bool RebuildMeshShaders(GfxDevice& gfx) {
+        const UINT compileFlags = ShaderCompileFlags();
+        const char* VS = vsSource_.c_str();
+        const char* PS = psSource_.c_str();
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
+        Microsoft::WRL::ComPtr<ID3D11VertexShader> vs;
+        Microsoft::WRL::ComPtr<ID3D11PixelShader> ps;
+        if (FAILED(ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err)) ||
+            FAILED(ShaderCache::Compile(PS, nullptr, "main", "ps_5_0", compileFlags, psb, err)) ||
+            FAILED(gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs.GetAddressOf())) ||
+            FAILED(gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[RenderSystem] シェーダーの作り直しに失敗(元のシェーダーで描画を継続)");
+            return false;
+        }
+        vs_ = vs;
+        ps_ = ps;
         vsBlob_ = vsb;
 
-        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] シェーダーのコンパイル完了");
+        JobSystem::JobCounter counter;
+        auto submit = [this, &counter](std::function<void()> job) {
+            if (jobs_) {
+                jobs_->Submit(std::move(job), &counter);
+            } else {
+                job();
+            }
+        };
+        submit([&]() { compactVerticesSupported_ = CompileCompactVertexShader(gfx, VS, compileFlags); });
+        submit([&]() { skinningSupported_ = CompileSkinnedVertexShader(gfx, VS, compileFlags); });
+        submit([&]() {
+            instancingSupported_ = CompileInstancedShaders(gfx, VS, PS, compileFlags);
+            if (gpuCullingSupported_ && !CompileGpuCullingShaders(gfx, VS, compileFlags)) gpuCullingSupported_ = false;
+        });
+        CompilePixelShaderVariants(gfx, PS, compileFlags, submit);
+        if (jobs_) jobs_->Wait(counter);
+
+        if (!instancingSupported_) {
+            for (uint32_t i = 0; i < SHADER_VARIANT_COUNT; ++i) {
+                psInstancedVariants_[i].Reset();
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 描画するテクスチャの組み合わせからシェーダーの機能を決める
+     */
+    static uint32_t ShaderFeatures(TextureManager::TextureHandle texture, TextureManager::TextureHandle normalTexture) {
+        uint32_t features = 0;
+        if (texture != TextureManager::INVALID_TEXTURE) features |= FEATURE_TEXTURE;
+        if (normalTexture != TextureManager::INVALID_TEXTURE) features |= FEATURE_NORMAL_MAP;
+        return features;
+    }
+
+    /**
+     * @brief 機能に対応するピクセルシェーダー(バリアントがなければ汎用版)
+     */
+    ID3D11PixelShader* PixelShaderFor(uint32_t features, bool instanced) const {
+        ID3D11PixelShader* shader = instanced ? psInstancedVariants_[features].Get() : psVariants_[features].Get();
+        if (shader) return shader;
+        return instanced ? psInstanced_.Get() : ps_.Get();
+    }
+
+    /**
+     * @brief ピクセルシェーダーの設定(直前と同じなら省略)
+     */
+    void BindPixelShader(DrawContext& dc, ID3D11PixelShader* shader) {
+        if (dc.bound.pixelShader == shader) {
+            dc.stats->stateChangesSkipped++;
+            return;
+        }
+        dc.states->SetPixelShader(shader);
+        dc.bound.pixelShader = shader;
+        dc.stats->CountStateChange(Statistics::STATE_SHADER);
+    }
+
+    /**
+     * @brief 入力レイアウトの作成
+     */
+    bool CreateInputLayout(GfxDevice& gfx) {
+  D3D11_INPUT_ELEMENT_DESC il[] = {
+       { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+  { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+ { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+     { "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+        };
+
+        HRESULT hr = gfx.Dev()->CreateInputLayout(il, 5, vsBlob_->GetBufferPointer(), vsBlob_->GetBufferSize(), layout_.GetAddressOf());
+      if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] 入力レイアウトの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+return false;
+        }
+
+        // 小さな頂点形式(作成できなければその形式のメッシュは描画しない)
+        if (compactVerticesSupported_) {
+            const D3D11_INPUT_ELEMENT_DESC compact[] = {
+                { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "NORMAL", 0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+            };
+            const D3D11_INPUT_ELEMENT_DESC quantized[] = {
+                { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "NORMAL", 0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+            };
+            const void* code = vsCompactBlob_->GetBufferPointer();
+            const SIZE_T codeSize = vsCompactBlob_->GetBufferSize();
+            if (FAILED(gfx.Dev()->CreateInputLayout(compact, 3, code, codeSize, layoutCompact_.GetAddressOf())) ||
+                FAILED(gfx.Dev()->CreateInputLayout(quantized, 3, code, codeSize, layoutQuantized_.GetAddressOf()))) {
+                DEBUGLOG_WARNING("[RenderSystem] 小さな頂点形式の入力レイアウトの作成失敗");
+                compactVerticesSupported_ = false;
+            }
+        }
+        vsCompactBlob_.Reset();
+
+        // スキニング(標準の頂点形式 + スロット1の SkinInfluence。作成できなければバインドポーズで描画)
+        if (skinningSupported_) {
+            const D3D11_INPUT_ELEMENT_DESC skinned[] = {
+                { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "BLENDINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "BLENDWEIGHT", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+            };
+            if (FAILED(gfx.Dev()->CreateInputLayout(skinned, 7, vsSkinnedBlob_->GetBufferPointer(), vsSkinnedBlob_->GetBufferSize(),
+                                                    layoutSkinned_.GetAddressOf()))) {
+                DEBUGLOG_WARNING("[RenderSystem] スキニングの入力レイアウトの作成失敗");
+                skinningSupported_ = false;
+            }
+        }
+        vsSkinnedBlob_.Reset();
+
+     DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 入力レイアウトの作成完了");
+    return true;
+    }
+
+    /**
+     * @brief 定数バッファの作成
+     */
+    bool CreateConstantBuffers(GfxDevice& gfx) {
+        D3D11_BUFFER_DESC cbd{};
+        cbd.Usage = D3D11_USAGE_DEFAULT;
+   cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        cbd.CPUAccessFlags = 0;
+cbd.MiscFlags = 0;
+        cbd.StructureByteStride = 0;
+
+        // VS定数バッファ
+   cbd.ByteWidth = sizeof(VSConstants);
+        HRESULT hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, vsCb_.GetAddressOf());
+        if (FAILED(hr)) {
+  DEBUGLOG_ERROR("[RenderSystem] VS定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        // フレームの定数バッファ(カメラ・画面。VS と PS で共有)
+        cbd.ByteWidth = sizeof(FrameConstants);
+        hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, frameCb_.buffer.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] フレームの定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        frameCb_.valid = false;
+
+        // スキニングの定数バッファ(作成できなければバインドポーズで描画)
+        cbd.ByteWidth = sizeof(VSSkinConstants);
+        if (skinningSupported_ && FAILED(gfx.Dev()->CreateBuffer(&cbd, nullptr, skinCb_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[RenderSystem] スキニングの定数バッファの作成失敗");
+            skinningSupported_ = false;
+        }
+
+        // PS定数はマテリアルごとの不変のバッファ(MaterialManager)。共有テクスチャ配列用だけここで作る
+        PSConstants arrayConstants = MaterialManager::MakeConstants(MaterialDesc{});
+        arrayConstants.useTextureArray = 1.0f;
+        if (!MaterialManager::CreateConstantBuffer(gfx.Dev(), arrayConstants, textureArrayMaterialCb_)) {
+            return false;
+        }
+
+        // PSライト定数バッファ
+        cbd.ByteWidth = sizeof(PSLightConstants);
+        hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, psLightCb_.buffer.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+     DEBUGLOG_ERROR("[RenderSystem] PSライト定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        psLightCb_.valid = false;
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 定数バッファの作成完了");
+        return true;
+    }
+
+    /**
+     * @brief インスタンス描画用のバッチ定数バッファとインスタンスバッファの作成
+     */
+    bool CreateInstancingResources(GfxDevice& gfx) {
+        D3D11_BUFFER_DESC cbd{};
+        cbd.Usage = D3D11_USAGE_DEFAULT;
+        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        cbd.ByteWidth = sizeof(VSBatchConstants);
+
+        HRESULT hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, batchCb_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] バッチ定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        return EnsureInstanceCapacity(gfx, INITIAL_INSTANCE_CAPACITY);
+    }
+
+    /**
+     * @brief インスタンスバッファの容量を確保(不足時は2倍以上に拡張して作り直す)
+     */
+    bool EnsureInstanceCapacity(GfxDevice& gfx, size_t count) {
+        if (count <= instanceCapacity_ && instanceBuffer_) return true;
+
+        size_t capacity = instanceCapacity_ > 0 ? instanceCapacity_ * 2 : static_cast<size_t>(INITIAL_INSTANCE_CAPACITY);
+        if (capacity < count) capacity = count;
+
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bd.StructureByteStride = sizeof(InstanceData);
+        bd.ByteWidth = static_cast<UINT>(capacity * sizeof(InstanceData));
+
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        HRESULT hr = gfx.Dev()->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] インスタンスバッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.Format = DXGI_FORMAT_UNKNOWN;
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvd.Buffer.FirstElement = 0;
+        srvd.Buffer.NumElements = static_cast<UINT>(capacity);
+
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        hr = gfx.Dev()->CreateShaderResourceView(buffer.Get(), &srvd, srv.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] インスタンスバッファのSRV作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        instanceBuffer_ = buffer;
+        instanceSrv_ = srv;
+        instanceCapacity_ = capacity;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] インスタンスバッファ容量: " + std::to_string(capacity));
+        return true;
+    }
+
+    /**
+     * @brief ステートの作成
+     */
+    bool CreateStates(GfxDevice& gfx) {
+     // サンプラーステート
+        D3D11_SAMPLER_DESC sampDesc{};
+        sampDesc.Filter = D3D11_FILTER_ANISOTROPIC;
+        sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+        sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+        sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+        sampDesc.MaxAnisotropy = 16;
+   sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        sampDesc.MipLODBias = 0.0f;
+        sampDesc.MinLOD = 0;
+        sampDesc.MaxLOD = D3D11_FLOAT32_MAX; // TextureManager が作成したミップチェーン全体を使う
+
+        HRESULT hr = gfx.Dev()->CreateSamplerState(&sampDesc, &samplerState_);
+        if (FAILED(hr)) {
+     DEBUGLOG_ERROR("[RenderSystem] サンプラーステートの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+     return false;
+        }
+
+        // ラスタライザーステート
+ D3D11_RASTERIZER_DESC rsd{};
+        rsd.FillMode = D3D11_FILL_SOLID;
+   rsd.CullMode = D3D11_CULL_BACK;
+        rsd.FrontCounterClockwise = FALSE;
+        rsd.DepthClipEnable = TRUE;
+        rsd.ScissorEnable = FALSE;
+        rsd.MultisampleEnable = FALSE;
+        rsd.AntialiasedLineEnable = FALSE;
+
+        hr = gfx.Dev()->CreateRasterizerState(&rsd, rasterState_.GetAddressOf());
+   if (FAILED(hr)) {
+      DEBUGLOG_ERROR("[RenderSystem] ラスタライザーステートの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+  return false;
+        }
+
+        // 深度プリパス用の深度ステート(作成できなければプリパスを使わない)
+        D3D11_DEPTH_STENCIL_DESC dsd{};
+        dsd.DepthEnable = TRUE;
+        dsd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+        dsd.DepthFunc = D3D11_COMPARISON_LESS;
+        hr = gfx.Dev()->CreateDepthStencilState(&dsd, depthPrepassState_.GetAddressOf());
+        if (SUCCEEDED(hr)) {
+            dsd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+            dsd.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+            hr = gfx.Dev()->CreateDepthStencilState(&dsd, depthEqualState_.GetAddressOf());
+        }
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[RenderSystem] 深度ステートの作成失敗、深度プリパスを無効化します (HRESULT: 0x" + std::to_string(hr) + ")");
+            depthPrepassState_.Reset();
+            depthEqualState_.Reset();
+        }
+
+        // 半透明パスのアルファブレンド
+        D3D11_BLEND_DESC bd{};
+        bd.RenderTarget[0].BlendEnable = TRUE;
+        bd.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+        bd.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+        bd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+        bd.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+        bd.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+        bd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+        bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+        hr = gfx.Dev()->CreateBlendState(&bd, transparentBlend_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] ブレンドステートの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        // 共通のパイプラインステート(頂点形式・ピクセルシェーダーは描画ごとに StateCache で差し替える)
+        PipelineStateDesc pipelineDesc;
+        pipelineDesc.vertexShader = vs_.Get();
+        pipelineDesc.pixelShader = ps_.Get();
+        pipelineDesc.inputLayout = layout_.Get();
+        pipelineDesc.rasterizerState = rasterState_.Get();
+        pipeline_ = PipelineState(pipelineDesc);
+        pipelineDesc.depthStencilState = depthEqualState_.Get();
+        pipelineDepthEqual_ = PipelineState(pipelineDesc);
+        pipelineDesc.blendState = transparentBlend_.Get();
+        pipelineTransparent_ = PipelineState(pipelineDesc);
+
+ DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] ステートの作成完了");
+        return true;
+    }
+
+    /**
+     * @brief 基本形状メッシュの作成
+     */
+    bool CreatePrimitiveMeshes(GfxDevice& gfx) {
+        // Cube
+        if (!CreateCubeMesh(gfx)) {
+  DEBUGLOG_ERROR("[RenderSystem] キューブメッシュの作成失敗");
+            return false;
+        }
+
+        // Sphere(LODごとに分割数を半分にする)
+        static const int SPHERE_SEGMENTS[MeshLod::LEVEL_COUNT] = { 32, 16, 8 };
+        for (uint8_t lod = 0; lod < MeshLod::LEVEL_COUNT; ++lod) {
+            if (!CreateSphereMesh(gfx, SPHERE_SEGMENTS[lod], SPHERE_SEGMENTS[lod] / 2, MeshKey(MeshType::Sphere, lod))) {
+                DEBUGLOG_ERROR("[RenderSystem] 球体メッシュの作成失敗 (LOD" + std::to_string(lod) + ")");
+                return false;
+            }
+        }
+        meshCache_[MeshKey(MeshType::Sphere, 0)]->lodCount = MeshLod::LEVEL_COUNT;
+
+        // Cylinder
+        static const int CYLINDER_SEGMENTS[MeshLod::LEVEL_COUNT] = { 32, 16, 8 };
+        for (uint8_t lod = 0; lod < MeshLod::LEVEL_COUNT; ++lod) {
+            if (!CreateCylinderMesh(gfx, CYLINDER_SEGMENTS[lod], MeshKey(MeshType::Cylinder, lod))) {
+                DEBUGLOG_ERROR("[RenderSystem] 円柱メッシュの作成失敗 (LOD" + std::to_string(lod) + ")");
+                return false;
+            }
+        }
+        meshCache_[MeshKey(MeshType::Cylinder, 0)]->lodCount = MeshLod::LEVEL_COUNT;
+
+      // Plane
+        if (!CreatePlaneMesh(gfx)) {
+            DEBUGLOG_ERROR("[RenderSystem] 平面メッシュの作成失敗");
+  return false;
+        }
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 基本形状メッシュの作成完了");
+        return true;
+    }
+
+    /**
+     * @brief キューブメッシュの作成
+     */
+    bool CreateCubeMesh(GfxDevice& gfx) {
+        const float size = 0.5f;
+
+        // 頂点データ（各面に4頂点）
+        Vertex vertices[] = {
+            // Front face (Z+)
+    {{-size, -size, size}, {0, 1}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+  {{size, -size, size}, {1, 1}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+            {{size, size, size}, {1, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+     {{-size, size, size}, {0, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+
+     // Back face (Z-)
+         {{size, -size, -size}, {0, 1}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+       {{-size, -size, -size}, {1, 1}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+          {{-size, size, -size}, {1, 0}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+            {{size, size, -size}, {0, 0}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+
+        // Left face (X-)
+      {{-size, -size, -size}, {0, 1}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+      {{-size, -size, size}, {1, 1}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+       {{-size, size, size}, {1, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        {{-size, size, -size}, {0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+
+        // Right face (X+)
+            {{size, -size, size}, {0, 1}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+  {{size, -size, -size}, {1, 1}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+      {{size, size, -size}, {1, 0}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+            {{size, size, size}, {0, 0}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+
+   // Top face (Y+)
+            {{-size, size, size}, {0, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+          {{size, size, size}, {1, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+   {{size, size, -size}, {1, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+    {{-size, size, -size}, {0, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+
+        // Bottom face (Y-)
+            {{-size, -size, -size}, {0, 1}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+   {{size, -size, -size}, {1, 1}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+ {{size, -size, size}, {1, 0}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+    {{-size, -size, size}, {0, 0}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+        };
+
+        // インデックスデータ（各面に2三角形 = 6インデックス）
+ uint16_t indices[] = {
+     0, 1, 2, 0, 2, 3,       // Front
+            4, 5, 6, 4, 6, 7,     // Back
+      8, 9, 10, 8, 10, 11,    // Left
+            12, 13, 14, 12, 14, 15, // Right
+       16, 17, 18, 16, 18, 19, // Top
+     20, 21, 22, 20, 22, 23  // Bottom
+        };
+
+     return CreateMeshBuffers(gfx, vertices, sizeof(vertices) / sizeof(Vertex), indices, sizeof(indices) / sizeof(uint16_t), static_cast<int>(MeshType::Cube));
+    }
+
+    /**
+   * @brief 球体メッシュの作成
+     * @param[in] segments 経度方向の分割数
+     * @param[in] rings 緯度方向の分割数
+     * @param[in] meshKey メッシュキャッシュのキー
+     */
+    bool CreateSphereMesh(GfxDevice& gfx, int segments, int rings, int meshKey) {
+        const float radius = 0.5f;
+
+     std::vector<Vertex> vertices;
+        std::vector<uint16_t> indices;
+
+        // 頂点生成
+        for (int ring = 0; ring <= rings; ++ring) {
+   float phi = DirectX::XM_PI * ring / rings;
+    float sinPhi = sinf(phi);
+            float cosPhi = cosf(phi);
+
+            for (int seg = 0; seg <= segments; ++seg) {
+        float theta = 2.0f * DirectX::XM_PI * seg / segments;
+        float sinTheta = sinf(theta);
+  float cosTheta = cosf(theta);
+
+        Vertex v;
+       v.pos.x = radius * sinPhi * cosTheta;
+          v.pos.y = radius * cosPhi;
+       v.pos.z = radius * sinPhi * sinTheta;
+
+           v.nrm.x = sinPhi * cosTheta;
+      v.nrm.y = cosPhi;
+         v.nrm.z = sinPhi * sinTheta;
+
+v.tex.x = static_cast<float>(seg) / segments;
+  v.tex.y = static_cast<float>(ring) / rings;
+
+    v.tan.x = -sinTheta;
+     v.tan.y = 0;
+                v.tan.z = cosTheta;
+
+     v.bitan.x = cosPhi * cosTheta;
+      v.bitan.y = -sinPhi;
+   v.bitan.z = cosPhi * sinTheta;
+
+          vertices.push_back(v);
+        }
+        }
+
+        // インデックス生成
+        for (int ring = 0; ring < rings; ++ring) {
+            for (int seg = 0; seg < segments; ++seg) {
+            int a = ring * (segments + 1) + seg;
+ int b = a + 1;
+                int c = a + segments + 1;
+  int d = c + 1;
+
+   indices.push_back(a);
+     indices.push_back(c);
+          indices.push_back(b);
+
+      indices.push_back(b);
+       indices.push_back(c);
+           indices.push_back(d);
+   }
+        }
+
+        return CreateMeshBuffers(gfx, vertices.data(), vertices.size(), indices.data(), indices.size(), meshKey);
+    }
+
+    /**
+     * @brief 円柱メッシュの作成
+     * @param[in] segments 円周方向の分割数
+     * @param[in] meshKey メッシュキャッシュのキー
+     */
+    bool CreateCylinderMesh(GfxDevice& gfx, int segments, int meshKey) {
+     const float radius = 0.5f;
+        const float height = 1.0f;
+
+        std::vector<Vertex> vertices;
+        std::vector<uint16_t> indices;
+
+        // 側面の頂点
+        for (int i = 0; i <= segments; ++i) {
+            float theta = 2.0f * DirectX::XM_PI * i / segments;
+        float cosTheta = cosf(theta);
+         float sinTheta = sinf(theta);
+
+            // トップの頂点
+            Vertex vTop;
+    vTop.pos = {radius * cosTheta, height / 2, radius * sinTheta};
+     vTop.tex = {static_cast<float>(i) / segments, 0.0f};
+        vTop.nrm = {cosTheta, 0, sinTheta};
+    vTop.tan = {-sinTheta, 0, cosTheta};
+   vTop.bitan = {0, 1, 0};
+            vertices.push_back(vTop);
+
+         // ボトムの頂点
+    Vertex vBottom;
+      vBottom.pos = {radius * cosTheta, -height / 2, radius * sinTheta};
+       vBottom.tex = {static_cast<float>(i) / segments, 1.0f};
+      vBottom.nrm = {cosTheta, 0, sinTheta};
+            vBottom.tan = {-sinTheta, 0, cosTheta};
+            vBottom.bitan = {0, 1, 0};
+            vertices.push_back(vBottom);
+    }
+
+     // 側面のインデックス
+    for (int i = 0; i < segments; ++i) {
+            int top1 = i * 2;
+  int bot1 = i * 2 + 1;
+  int top2 = (i + 1) * 2;
+            int bot2 = (i + 1) * 2 + 1;
+
+            indices.push_back(top1);
+            indices.push_back(bot1);
+            indices.push_back(top2);
+
+            indices.push_back(top2);
+    indices.push_back(bot1);
+   indices.push_back(bot2);
+     }
+
+        // キャップの追加は省略（実装を簡略化）
+
+        return CreateMeshBuffers(gfx, vertices.data(), vertices.size(), indices.data(), indices.size(), meshKey);
+    }
+
+    /**
+     * @brief 平面メッシュの作成
+     */
+ bool CreatePlaneMesh(GfxDevice& gfx) {
+        const float size = 0.5f;
+
+        Vertex vertices[] = {
+  {{-size, 0, -size}, {0, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
+            {{size, 0, -size}, {1, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
+            {{size, 0, size}, {1, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
+  {{-size, 0, size}, {0, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
+        };
+
+      uint16_t indices[] = {0, 1, 2, 0, 2, 3};
+
+  return CreateMeshBuffers(gfx, vertices, 4, indices, 6, static_cast<int>(MeshType::Plane));
+    }
+
+    /**
+     * @brief メッシュキャッシュのキー(下位8ビットがメッシュ種別、その上がLOD)
+     */
+    static int MeshKey(MeshType type, uint8_t lod) {
+        return static_cast<int>(type) | (static_cast<int>(lod) << 8);
+    }
+
+    /**
+     * @brief LOD0 のメッシュから指定LODのメッシュを取得(そのLODがなければLOD0)
+     */
+    const MeshData* FindLodMesh(const MeshData* lod0, MeshType type, uint8_t lod) const {
+        if (!lod0 || lod == 0 || lod >= lod0->lodCount) return lod0;
+        auto it = meshCache_.find(MeshKey(type, lod));
+        return it != meshCache_.end() && it->second ? it->second.get() : lod0;
+    }
+
+    /**
+     * @brief ワールド空間の境界球の投影サイズ(MeshLod::ProjectedSize())からLODを選択
+     */
+    uint8_t SelectLod(LodHistory& history, Entity e, float size) {
+        if (!lodEnabled_) return 0;
+        uint8_t lod = history.Update(e.id, size * lodScale_);
+        if (lod > 0) stats_.lodReduced++;
+        return lod;
+    }
+
+    /**
+     * @brief 投影サイズからストリーミング中のテクスチャに必要な解像度を通知
+     */
+    void RequestTextureDetail(TextureManager& texMgr, TextureManager::TextureHandle texture, float size) {
+        if (!textureStreaming_ || texture == TextureManager::INVALID_TEXTURE) return;
+        float pixels = (std::min)(size * screenHeight_ * textureDetailScale_, 16384.0f);
+        texMgr.RequestResolution(texture, static_cast<uint32_t>(pixels) + 1);
+    }
+
+    /**
+     * @brief メッシュバッファの作成
+     *
+     * @details
+     * 共有メッシュバッファ(GfxDevice::Meshes())に割り当てられた場合は個別のバッファを作りません。
+     */
+    bool CreateMeshBuffers(GfxDevice& gfx, const Vertex* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount, int meshTypeKey) {
+        auto meshData = std::make_unique<MeshData>();
+        meshData->pooled = gfx.Meshes().Allocate(gfx.Ctx(), vertices, static_cast<UINT>(vertexCount), indices, static_cast<UINT>(indexCount));
+
+        if (!meshData->pooled) {
+            // 頂点バッファの作成
+            D3D11_BUFFER_DESC vbd{};
+            vbd.Usage = D3D11_USAGE_IMMUTABLE;
+            vbd.ByteWidth = static_cast<UINT>(vertexCount * sizeof(Vertex));
+            vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+            vbd.CPUAccessFlags = 0;
+            vbd.MiscFlags = 0;
+            vbd.StructureByteStride = 0;
+
+            D3D11_SUBRESOURCE_DATA vData{};
+            vData.pSysMem = vertices;
+
+            HRESULT hr = gfx.Dev()->CreateBuffer(&vbd, &vData, meshData->vertexBuffer.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[RenderSystem] 頂点バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+
+            // インデックスバッファの作成
+            D3D11_BUFFER_DESC ibd{};
+            ibd.Usage = D3D11_USAGE_IMMUTABLE;
+            ibd.ByteWidth = static_cast<UINT>(indexCount * sizeof(uint16_t));
+            ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+            ibd.CPUAccessFlags = 0;
+            ibd.MiscFlags = 0;
+            ibd.StructureByteStride = 0;
+
+            D3D11_SUBRESOURCE_DATA iData{};
+            iData.pSysMem = indices;
+
+            hr = gfx.Dev()->CreateBuffer(&ibd, &iData, meshData->indexBuffer.GetAddressOf());
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[RenderSystem] インデックスバッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+        }
+
+        meshData->indexCount = static_cast<UINT>(indexCount);
+        meshData->vertices.assign(vertices, vertices + vertexCount);
+        meshData->indices.assign(indices, indices + indexCount);
+        meshData->boundsRadius = ComputeBoundingSphere(&vertices[0].pos, vertexCount, sizeof(Vertex), meshData->boundsCenter);
+        meshCache_[meshTypeKey] = std::move(meshData);
+
         return true;
     }
 
-    Microsoft::WRL::ComPtr<ID3DBlob> vsBlob_; // 入力レイアウト作成用に保持
+    /**
+     * @brief メッシュの描画に使うバッファと範囲(共有メッシュバッファの場合は共有バッファ内の範囲)
+     * @return RenderProxyMesh バッファがない(または頂点形式のシェーダーがない)場合 vertexBuffer が nullptr
+     */
+    RenderProxyMesh ResolveMesh(ID3D11Buffer* vertexBuffer, ID3D11Buffer* indexBuffer, UINT indexCount, DXGI_FORMAT indexFormat,
+                                const MeshPoolHandle& pooled, VertexFormat vertexFormat = VertexFormat::Standard) const {
+        if (vertexFormat != VertexFormat::Standard && !compactVerticesSupported_) return RenderProxyMesh{};
+        if (!pooled) {
+            if (!vertexBuffer || !indexBuffer) return RenderProxyMesh{};
+            return RenderProxyMesh{ vertexBuffer, indexBuffer, indexCount, indexFormat, 0, 0, vertexFormat };
+        }
+        const MeshPool* pool = meshPools_[static_cast<size_t>(vertexFormat)];
+        if (!pool || !pool->IsReady()) return RenderProxyMesh{};
+        return RenderProxyMesh{ pool->VertexBuffer(), pool->IndexBuffer(), indexCount, MeshPool::INDEX_FORMAT,
+                                pooled->startIndex, static_cast<INT>(pooled->baseVertex), vertexFormat };
+    }
+
+    RenderProxyMesh ResolveMesh(const MeshData& mesh) const {
+        return ResolveMesh(mesh.vertexBuffer.Get(), mesh.indexBuffer.Get(), mesh.indexCount, DXGI_FORMAT_R16_UINT, mesh.pooled);
+    }
+
+    /**
+     * @brief ModelComponent の全LODのバッファを解決(LOD0 がない場合 levels[0].vertexBuffer は nullptr)
+     */
+    RenderProxyModelMesh ResolveModelMesh(const ModelComponent& mc) const {
+        RenderProxyModelMesh mesh;
+        mesh.levels[0] = ResolveMesh(mc.vertexBuffer.Get(), mc.indexBuffer.Get(), mc.indexCount, mc.indexFormat, mc.pooled, mc.vertexFormat);
+        if (!mesh.levels[0].vertexBuffer) return mesh;
+        for (int level = 1; level < MeshLod::LEVEL_COUNT; ++level) {
+            const ModelLod& simplified = mc.lods[level - 1];
+            mesh.levels[level] = ResolveMesh(simplified.vertexBuffer.Get(), simplified.indexBuffer.Get(), simplified.indexCount,
+                                             simplified.indexFormat, simplified.pooled, mc.vertexFormat);
+        }
+        mesh.positionDequant = mc.positionDequant;
+        return mesh;
+    }
+
+    /**
+   * @brief パイプラインの設定
+     */
+    void SetupPipeline(GfxDevice& gfx) {
+        stateCacheStart_ = gfx.States().GetStats();
+        BindPipelineState(gfx.States());
+
+        // フレーム開始時点ではバインド状態を不明として扱う
+        immediate_.ctx = gfx.Ctx();
+        immediate_.states = &gfx.States();
+        immediate_.bound = BoundState();
+        immediate_.stats = &stats_;
+    }
+
+    /**
+     * @brief 共通のパイプラインステートを設定(遅延コンテキストの記録開始時にも使用)
+     *
+     * @details
+     * states を通すため、前のフレームやデバッグ描画から変わっていない項目はコンテキストに送りません。
+     */
+    void BindPipelineState(StateCache& states) {
+        states.Apply(depthPrepassActive_ ? pipelineDepthEqual_ : pipeline_);
+        states.SetVSConstantBuffer(0, vsCb_.Get());
+        states.SetVSConstantBuffer(2, frameCb_.buffer.Get());
+        states.SetPSConstantBuffer(0, nullptr); // 最初のパケットの BindMaterial() で設定
+        states.SetPSConstantBuffer(1, psLightCb_.buffer.Get());
+        states.SetPSConstantBuffer(3, frameCb_.buffer.Get());
+        states.Context()->PSSetShaderResources(LightClusters::FIRST_SLOT, LightClusters::SLOT_COUNT, lightClusters_.ShaderResources());
+        states.SetPSSampler(0, samplerState_.Get());
+        shadows_.Bind(states);
+    }
+
+    /**
+* @brief ライト定数の更新
+     */
+    void UpdateLightConstants(World& w, const Camera& cam, GfxDevice& gfx) {
+      PSLightConstants lightCbuf;
+
+        hasDirectionalLight_ = false;
+        w.ForEach<DirectionalLight>([&](Entity e, DirectionalLight& l) {
+            lightCbuf.light = l;
+            shadowLight_ = l;
+            hasDirectionalLight_ = true;
+        });
+        lightCbuf.light.padding = 0.0f; // 比較のため未使用の値もそろえる
+
+        if (psLightCb_.Upload(gfx.Ctx(), lightCbuf)) {
+            stats_.constantBufferBytes += sizeof(PSLightConstants);
+        } else {
+            stats_.constantBuffersSkipped++;
+        }
+
+        UpdateLightClusters(w, cam, gfx);
+    }
+
+    /**
+     * @brief 点光源・スポットライトを集めてクラスタに振り分け、t3〜t5 に設定
+     */
+    void UpdateLightClusters(World& w, const Camera& cam, GfxDevice& gfx) {
+        PROFILE_SCOPE("RenderSystem::UpdateLightClusters");
+        lightClusters_.Clear();
+        w.ForEach<PointLight>([&](Entity e, PointLight& l) {
+            auto* t = w.Peek<Transform>(e);
+            if (!t) return;
+            DirectX::XMFLOAT3 position;
+            DirectX::XMStoreFloat3(&position, ResolveWorldMatrix(w, e, *t).r[3]);
+            lightClusters_.AddPoint(position, l.range, DirectX::XMFLOAT3{ l.color.x * l.intensity, l.color.y * l.intensity, l.color.z * l.intensity });
+        });
+        w.ForEach<SpotLight>([&](Entity e, SpotLight& l) {
+            auto* t = w.Peek<Transform>(e);
+            if (!t) return;
+            DirectX::XMMATRIX world = ResolveWorldMatrix(w, e, *t);
+            DirectX::XMFLOAT3 position, direction;
+            DirectX::XMStoreFloat3(&position, world.r[3]);
+            DirectX::XMStoreFloat3(&direction, DirectX::XMVector3Normalize(DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&l.direction), world)));
+            lightClusters_.AddSpot(position, direction, l.range, DirectX::XMFLOAT3{ l.color.x * l.intensity, l.color.y * l.intensity, l.color.z * l.intensity },
+                                   l.innerAngle, l.outerAngle);
+        });
+
+        lightClusters_.Build(cam);
+        if (!lightClusters_.Upload(gfx.Dev(), gfx.Ctx())) return;
+        gfx.Ctx()->PSSetShaderResources(LightClusters::FIRST_SLOT, LightClusters::SLOT_COUNT, lightClusters_.ShaderResources());
+        stats_.lights = lightClusters_.LightCount();
+        stats_.lightClusterEntries = lightClusters_.IndexCount();
+    }
+
+    /**
+     * @brief VideoSurface を集め、ゲーム内の面を描く(全画面の面は Render() の最後に描く)
+     *
+     * @details
+     * VideoPlayer が表示中のフレームのテクスチャを直接読むため、フレームが更新されない間も CPU のコピーはありません。
+     * 描いた後は描画キューのステート(共通のパイプラインとバインド状態)を設定し直し、半透明パスに備えます。
+     */
+    void RenderVideoSurfaces(World& w, GfxDevice& gfx, const Camera& cam) {
+        videoSurfaces_.BeginFrame();
+        if (!videoSurfacesSupported_) return;
+        w.ForEach<VideoSurface>([&](Entity e, VideoSurface& surface) {
+            if (surface.fullscreen) {
+                videoSurfaces_.Add(surface, DirectX::XMMatrixIdentity());
+                return;
+            }
+            auto* t = w.Peek<Transform>(e);
+            if (!t) return;
+            videoSurfaces_.Add(surface, ResolveWorldMatrix(w, e, *t));
+        });
+        if (!videoSurfaces_.HasWorldSurfaces()) return;
+
+        PROFILE_SCOPE("RenderSystem::RenderVideoSurfaces");
+        {
+            GpuProfileScope videoScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_VIDEO);
+            videoSurfaces_.DrawWorld(gfx.States(), cam);
+        }
+        stats_.videoSurfaces = videoSurfaces_.GetStatistics().surfaces;
+        BindPipelineState(gfx.States());
+        immediate_.bound = BoundState();
+    }
+
+    /**
+     * @brief ParticleEmitter を集めてGPUパーティクルを放出・更新し、描画
+     *
+     * @details
+     * CPU側は放出元ごとの放出数と位置・向きを表にするだけで、粒子1つあたりの処理はGPUで行います。
+     */
+    void RenderParticles(World& w, GfxDevice& gfx, const Camera& cam) {
+        if (!particlesSupported_ || !particlesEnabled_) return;
+        PROFILE_SCOPE("RenderSystem::RenderParticles");
+        GpuProfileScope particleScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_PARTICLES);
+
+        particles_.BeginFrame();
+        w.ForEach<ParticleEmitter>([&](Entity e, ParticleEmitter& emitter) {
+            auto* t = w.Peek<Transform>(e);
+            if (!t) return;
+            particles_.AddEmitter(e, emitter, ResolveWorldMatrix(w, e, *t));
+        });
+        particles_.Simulate(gfx.Dev(), gfx.Ctx());
+        particles_.Draw(gfx.States(), cam);
+
+        stats_.particleEmitters = particles_.GetStatistics().emitters;
+        stats_.particlesEmitted = particles_.GetStatistics().emitted;
+    }
+
+    /**
+     * @brief GpuMover の生成・解放を反映し、コンピュートシェーダーで積分してメッシュの種類ごとにインスタンス描画
+     *
+     * @details
+     * CPU側の処理はチャネルの受け取りと、メッシュの種類ごとの定数の書き込み・ドローコールだけです。
+     * 影・視錐台カリング・LOD の対象にはなりません。
+     */
+    void RenderGpuMovers(GfxDevice& gfx, const Camera& cam) {
+        if (!moversSupported_ || (movers_.Count() == 0 && !movers_.Channel().HasPending())) {
+            movers_.Update(gfx.Dev(), gfx.Ctx());  // 使えない場合も積まれた分は捨てる
+            return;
+        }
+        PROFILE_SCOPE("RenderSystem::RenderGpuMovers");
+        GpuProfileScope moverScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_GPU_MOVERS);
+
+        movers_.Update(gfx.Dev(), gfx.Ctx());
+        RenderProxyMesh meshes[GpuMovers::MESH_TYPE_COUNT];
+        for (uint32_t type = 0; type < GpuMovers::MESH_TYPE_COUNT; ++type) {
+            auto it = meshCache_.find(MeshKey(static_cast<MeshType>(type), 0));
+            if (it != meshCache_.end() && it->second) meshes[type] = ResolveMesh(*it->second);
+        }
+        movers_.Draw(gfx.States(), cam, meshes, psLightCb_.buffer.Get());
+
+        const GpuMovers::Statistics& moverStats = movers_.GetStatistics();
+        stats_.gpuMovers = moverStats.movers;
+        stats_.gpuMoversSpawned = moverStats.spawned;
+        stats_.totalDrawCalls += moverStats.draws;
+        BindPipelineState(gfx.States());
+        immediate_.bound = BoundState();
+    }
+
+    /**
+     * @brief World から描画プロキシを抽出して表に切り替える
+     *
+     * @details
+     * ワールド行列(補間済み)とワールド空間の境界球はここで一度だけ計算します。
+     * StaticBatch 付きの MeshRenderer は静的バッチが扱うため抽出しません。
+     * LocalToWorld のない(生成直後など)オイラー角の MeshRenderer は、走査の後に
+     * WorldMatrixBatch でまとめて行列を計算し、境界球もそこで求めます。
+     */
+    void ExtractRenderProxies(World& w) {
+        PROFILE_SCOPE("RenderSystem::ExtractRenderProxies");
+        auto extractStart = std::chrono::high_resolution_clock::now();
+        RenderProxyBuffer& out = proxies_.Back();
+        out.Clear();
+
+        ++extractIndex_;
+        // モデルのプロキシを追加(mesh は LOD を解決済み。色・UV・マテリアルはエンティティのもの)
+        const auto addModel = [&](Entity e, const Transform& t, const ModelComponent& mc, RenderProxyModelMesh mesh, const DirectX::XMFLOAT3& color,
+                                  const DirectX::XMFLOAT2& uvOffset, const DirectX::XMFLOAT2& uvScale, MaterialManager::MaterialHandle materialHandle) {
+            DirectX::XMMATRIX worldMatrix = ResolveWorldMatrix(w, e, t);
+            DirectX::XMFLOAT3 center;
+            float radius = TransformBoundingSphere(worldMatrix, mc.boundsCenter, mc.boundsRadius, center);
+            if (mc.skinBuffer) {
+                // スキニング行列は SkinPose がある場合のみ(ない・空の場合はバインドポーズで描画)
+                const SkinPose* pose = w.Peek<SkinPose>(e);
+                if (pose && !pose->palette.empty()) {
+                    mesh.skinBuffer = mc.skinBuffer.Get();
+                    mesh.boneOffset = static_cast<uint32_t>(out.skinPalettes.size());
+                    out.skinPalettes.insert(out.skinPalettes.end(), pose->palette.begin(), pose->palette.end());
+                }
+            }
+            if (materials_->IsValid(materialHandle)) {
+                const MaterialDesc& material = materials_->GetDesc(materialHandle);
+                out.models.Add(e, worldMatrix, static_cast<uint32_t>(out.models.modelMeshes.size()), material.color, uvOffset, uvScale,
+                               material.texture, material.normalTexture, center, radius, materialHandle);
+            } else {
+                out.models.Add(e, worldMatrix, static_cast<uint32_t>(out.models.modelMeshes.size()), color, uvOffset, uvScale,
+                               mc.texture, mc.normalTexture, center, radius);
+            }
+            out.models.modelMeshes.push_back(mesh);
+        };
+
+        w.ForEach<ModelComponent>([&](Entity e, ModelComponent& mc) {
+            auto* t = w.Peek<Transform>(e);
+            if (!t) return;
+            RenderProxyModelMesh mesh = ResolveModelMesh(mc);
+            if (!mesh.levels[0].vertexBuffer) return;
+            addModel(e, *t, mc, mesh, mc.color, mc.uvOffset, mc.uvScale, mc.material);
+        });
+
+        // 境界球は LOD0 のものを使用(同じメッシュ種別が続くことが多いので直前の検索結果を再利用)
+        int boundsMeshType = -1;
+        const MeshData* boundsMesh = nullptr;
+        pendingWorlds_.clear();
+        pendingPositions_.clear();
+        pendingRotations_.clear();
+        pendingScales_.clear();
+        const auto addMesh = [&](Entity e, const Transform& t, MeshType meshType, const DirectX::XMFLOAT3& color, const DirectX::XMFLOAT2& uvOffset,
+                                 const DirectX::XMFLOAT2& uvScale, TextureManager::TextureHandle texture, MaterialManager::MaterialHandle materialHandle) {
+            if (static_cast<int>(meshType) != boundsMeshType) {
+                boundsMeshType = static_cast<int>(meshType);
+                auto it = meshCache_.find(MeshKey(meshType, 0));
+                boundsMesh = it != meshCache_.end() ? it->second.get() : nullptr;
+            }
+
+            // キャッシュのない行列は後でまとめて計算する(ここでは単位行列で追加)
+            const LocalToWorld* cache = w.Peek<LocalToWorld>(e);
+            const bool deferred = (!cache || !cache->valid) && !t.useQuaternion;
+            DirectX::XMMATRIX worldMatrix = deferred ? DirectX::XMMatrixIdentity() : ResolveWorldMatrix(w, e, t);
+            DirectX::XMFLOAT3 center{ 0.0f, 0.0f, 0.0f };
+            float radius = boundsMesh && !deferred ? TransformBoundingSphere(worldMatrix, boundsMesh->boundsCenter, boundsMesh->boundsRadius, center) : 0.0f;
+            size_t proxy;
+            if (materials_->IsValid(materialHandle)) {
+                const MaterialDesc& material = materials_->GetDesc(materialHandle);
+                proxy = out.meshes.Add(e, worldMatrix, static_cast<uint32_t>(meshType), material.color, uvOffset, uvScale,
+                                       material.texture, material.normalTexture, center, radius, materialHandle);
+            } else {
+                proxy = out.meshes.Add(e, worldMatrix, static_cast<uint32_t>(meshType), color, uvOffset, uvScale,
+                                       texture, TextureManager::INVALID_TEXTURE, center, radius);
+            }
+            if (deferred) {
+                pendingWorlds_.push_back(PendingWorld{ proxy, boundsMesh });
+                pendingPositions_.push_back(t.position);
+                pendingRotations_.push_back(t.rotation);
+                pendingScales_.push_back(t.scale);
+            }
+        };
+        w.Query<Transform, MeshRenderer>(Without<StaticBatch>()).ForEach([&](Entity e, Transform& t, MeshRenderer& mr) {
+            addMesh(e, t, mr.meshType, mr.color, mr.uvOffset, mr.uvScale, mr.texture, mr.material);
+        });
+
+        // 詰めた描画コンポーネント(モデルは共有の表から、LOD の解決はモデルごとに1回)
+        auto& packed = w.Query<Transform, PackedMeshRenderer>();
+        if (!packed.Empty()) {
+            if (sharedModels_.Acquire(sharedEntries_, sharedVersion_)) {
+                sharedMeshes_.assign(sharedEntries_.size(), RenderProxyModelMesh{});
+                sharedResolved_.assign(sharedEntries_.size(), 0);
+            }
+            packed.ForEach([&](Entity e, Transform& t, PackedMeshRenderer& pm) {
+                if (!pm.IsModel()) {
+                    addMesh(e, t, pm.GetMeshType(), pm.GetColor(), pm.UvOffset(), pm.UvScale(), TextureManager::INVALID_TEXTURE, pm.GetMaterial());
+                    return;
+                }
+                const uint16_t id = pm.ModelId();
+                if (id >= sharedEntries_.size()) return;
+                const ModelComponent& mc = *sharedEntries_[id];
+                if (sharedResolved_[id] != extractIndex_) {
+                    sharedMeshes_[id] = ResolveModelMesh(mc);
+                    sharedResolved_[id] = extractIndex_;
+                }
+                if (!sharedMeshes_[id].levels[0].vertexBuffer) return;
+                addModel(e, t, mc, sharedMeshes_[id], pm.GetColor(), pm.UvOffset(), pm.UvScale(), pm.GetMaterial());
+            });
+        }
+        ResolvePendingWorlds(out.meshes);
+
+        proxies_.Swap();
+        std::chrono::duration<float, std::milli> extractTime = std::chrono::high_resolution_clock::now() - extractStart;
+        stats_.extractMs = extractTime.count();
+        stats_.proxies = out.Size();
+    }
+
+    /**
+     * @brief このフレームのスキニング行列をまとめて構造化バッファに書き込む
+     *
+     * @details
+     * ExtractRenderProxies で連結したパレットを1回の Map で書き込み、各メッシュは先頭(boneOffset)だけを持ちます。
+     * 書き込めなかった場合(シェーダー未対応・バッファ作成失敗)はスキニングせずバインドポーズで描画します。
+     */
+    void UploadSkinPalettes(GfxDevice& gfx, const RenderProxyBuffer& proxies) {
+        skinningActive_ = false;
+        const auto& palettes = proxies.skinPalettes;
+        if (!skinningSupported_ || palettes.empty()) return;
+        if (!EnsureSkinCapacity(gfx, palettes.size())) return;
+
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        if (FAILED(gfx.Ctx()->Map(skinBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return;
+        std::memcpy(mapped.pData, palettes.data(), palettes.size() * sizeof(DirectX::XMFLOAT4X4));
+        gfx.Ctx()->Unmap(skinBuffer_.Get(), 0);
+
+        skinningActive_ = true;
+        stats_.skinningMatrices = palettes.size();
+        for (const RenderProxyModelMesh& mesh : proxies.models.modelMeshes) {
+            if (mesh.skinBuffer) stats_.skinnedModels++;
+        }
+    }
+
+    /**
+     * @brief スキニング行列のバッファの容量を確保(不足時は2倍以上に拡張して作り直す)
+     */
+    bool EnsureSkinCapacity(GfxDevice& gfx, size_t count) {
+        if (count <= skinCapacity_ && skinBuffer_) return true;
+
+        size_t capacity = skinCapacity_ > 0 ? skinCapacity_ * 2 : static_cast<size_t>(INITIAL_SKIN_CAPACITY);
+        if (capacity < count) capacity = count;
+
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bd.StructureByteStride = sizeof(DirectX::XMFLOAT4X4);
+        bd.ByteWidth = static_cast<UINT>(capacity * sizeof(DirectX::XMFLOAT4X4));
+
+        Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+        HRESULT hr = gfx.Dev()->CreateBuffer(&bd, nullptr, buffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] スキニング行列のバッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.Format = DXGI_FORMAT_UNKNOWN;
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvd.Buffer.FirstElement = 0;
+        srvd.Buffer.NumElements = static_cast<UINT>(capacity);
+
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        hr = gfx.Dev()->CreateShaderResourceView(buffer.Get(), &srvd, srv.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] スキニング行列のバッファのSRV作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+
+        skinBuffer_ = buffer;
+        skinSrv_ = srv;
+        skinCapacity_ = capacity;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] スキニング行列のバッファ容量: " + std::to_string(capacity));
+        return true;
+    }
+
+    /**
+     * @brief ModelComponent のプロキシを描画キューに追加(インスタンス描画でまとめられるものは後で描くために集める)
+     */
+    void RenderModelComponents(const RenderProxyBuffer& proxies, const Camera& cam, TextureManager& texMgr) {
+        PROFILE_SCOPE("RenderSystem::RenderModelComponents");
+        const RenderProxyList& models = proxies.models;
+        const bool instancing = IsModelInstancingEnabled();
+        modelInstanceProxies_.clear();
+        for (size_t i = 0; i < models.Size(); ++i) {
+            if (CullTreeRejects(CULL_TREE_MODELS, i)) continue;
+
+            // LOD選択(生成されていないレベルはより詳細なレベルで代用)
+            DirectX::XMFLOAT3 center = models.BoundsCenter(i);
+            float radius = models.BoundsRadius(i);
+            float size = MeshLod::ProjectedSize(center, radius, cam);
+            const RenderProxyModelMesh& meshes = models.modelMeshes[models.meshes[i]];
+            const bool skinned = meshes.skinBuffer && skinningActive_;
+            // スキニングされたメッシュは LOD を生成しない(SelectLod の履歴も更新しない)
+            uint8_t lod = skinned ? 0 : SelectLod(modelLods_, models.entities[i], size);
+            RequestTextureDetail(texMgr, models.textures[i], size);
+            RequestTextureDetail(texMgr, models.normalTextures[i], size);
+            const RenderProxyMesh* mesh = &meshes.levels[0];
+            for (int level = lod; level > 0; --level) {
+                if (meshes.levels[level].indexCount == 0 || !meshes.levels[level].vertexBuffer) continue;
+                mesh = &meshes.levels[level];
+                break;
+            }
+
+            // 色・テクスチャだけのモデルはインスタンス描画でまとめる(インスタンスのシェーダーは標準の頂点形式のみ)
+            if (instancing && !skinned && mesh->vertexFormat == VertexFormat::Standard &&
+                !materials_->IsValid(models.materials[i]) && models.normalTextures[i] == TextureManager::INVALID_TEXTURE) {
+                modelInstanceProxies_.push_back(ModelInstanceProxy{ static_cast<uint32_t>(i), *mesh });
+                continue;
+            }
+            QueueModelPacket(models, i, *mesh, cam);
+        }
+    }
 
     /**
-     * @brief 入力レイアウトの作成
+     * @brief ModelComponent の1メッシュを描画キューに追加
      */
-    bool CreateInputLayout(GfxDevice& gfx) {
-  D3D11_INPUT_ELEMENT_DESC il[] = {
-       { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-  { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
- { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-     { "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
-        };
+    void QueueModelPacket(const RenderProxyList& models, size_t i, const RenderProxyMesh& mesh, const Camera& cam) {
+        MaterialManager::MaterialHandle material = ResolveMaterial(models.materials[i], models.colors[i], models.textures[i], models.normalTextures[i]);
+        if (material == MaterialManager::INVALID_MATERIAL) return;
+        DirectX::XMMATRIX worldMatrix = DirectX::XMLoadFloat4x4(&models.worlds[i]);
+        const RenderProxyModelMesh& meshes = models.modelMeshes[models.meshes[i]];
+        const bool skinned = meshes.skinBuffer && skinningActive_;
+
+        DrawPacket& packet = PushPacket(material, models.BoundsCenter(i), models.BoundsRadius(i),
+                                        TransparentId(TRANSPARENT_ID_MODEL, models.entities[i].Packed()));
+        packet.vertexBuffer = mesh.vertexBuffer;
+        packet.indexBuffer = mesh.indexBuffer;
+        packet.indexCount = mesh.indexCount;
+        packet.indexFormat = mesh.indexFormat;
+        packet.startIndex = mesh.startIndex;
+        packet.baseVertex = mesh.baseVertex;
+        packet.vertexFormat = mesh.vertexFormat;
+        packet.world = models.worlds[i];
+        if (mesh.vertexFormat == VertexFormat::CompactQuantized) {
+            // 量子化した位置の逆量子化をワールド行列に畳み込む(ソートキーと境界球は元のワールド行列のまま)
+            DirectX::XMStoreFloat4x4(&packet.world, VertexCompression::PositionDequantMatrix(meshes.positionDequant) * worldMatrix);
+        }
+        packet.material = material;
+        packet.materialBuffer = materials_->Use(material);
+        packet.uvOffset = models.UvOffset(i);
+        packet.uvScale = models.UvScale(i);
+        packet.texture = models.textures[i];
+        packet.normalTexture = models.normalTextures[i];
+        packet.isModel = true;
+        if (skinned) {
+            packet.skinBuffer = meshes.skinBuffer;
+            packet.boneOffset = meshes.boneOffset;
+        }
+        packet.sortKey = MakeSortKey(packet, worldMatrix, cam);
+    }
 
-        HRESULT hr = gfx.Dev()->CreateInputLayout(il, 5, vsBlob_->GetBufferPointer(), vsBlob_->GetBufferSize(), layout_.GetAddressOf());
-      if (FAILED(hr)) {
-            DEBUGLOG_ERROR("[RenderSystem] 入力レイアウトの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-return false;
+    /**
+     * @brief 静的バッチを描画キューに追加(メンバーが変わった場合は先に再構築)
+     */
+    void RenderStaticBatches(World& w, GfxDevice& gfx, const Camera& cam) {
+        PROFILE_SCOPE("RenderSystem::RenderStaticBatches");
+        if (StaticBatchesDirty(w)) {
+            RebuildStaticBatches(w, gfx);
         }
 
-     DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 入力レイアウトの作成完了");
-    return true;
+        const DirectX::XMMATRIX identity = DirectX::XMMatrixIdentity();
+        for (size_t b = 0; b < staticBatches_.size(); ++b) {
+            const StaticBatchData& batch = staticBatches_[b];
+            MaterialManager::MaterialHandle material = ResolveMaterial(batch.material, batch.color, batch.texture, TextureManager::INVALID_TEXTURE);
+            if (material == MaterialManager::INVALID_MATERIAL) continue;
+
+            DrawPacket& packet = PushPacket(material, batch.boundsCenter, batch.boundsRadius, TransparentId(TRANSPARENT_ID_STATIC_BATCH, b));
+            packet.vertexBuffer = batch.vertexBuffer.Get();
+            packet.indexBuffer = batch.indexBuffer.Get();
+            packet.indexCount = batch.indexCount;
+            packet.indexFormat = DXGI_FORMAT_R32_UINT;
+            DirectX::XMStoreFloat4x4(&packet.world, identity);
+            packet.material = material;
+            packet.materialBuffer = materials_->Use(material);
+            packet.uvOffset = batch.uvOffset;
+            packet.uvScale = batch.uvScale;
+            packet.texture = batch.texture;
+            packet.normalTexture = batch.normalTexture;
+            packet.sortKey = MakeSortKey(packet, identity, cam);
+
+            stats_.staticBatches++;
+            stats_.staticBatchedMeshes += batch.members;
+        }
     }
 
     /**
-     * @brief 定数バッファの作成
+     * @brief ディレクショナルライトのシャドウマップのうち、このフレームに更新するカスケードを描き直す
+     *
+     * @details
+     * カスケードごとにその視錐台(手前の面なし)でカリング用BVHを検索してキャスターを選びます。
+     * 遠いカスケードほど粗いLOD(カスケードの番号、なければより詳細なレベル)で描きます。
+     * スキニングされたメッシュ(頂点シェーダーでしか変形しない)と境界球のないものは影を落としません。
+     * 描画後はバックバッファと共通のパイプラインステートに戻します。
      */
-    bool CreateConstantBuffers(GfxDevice& gfx) {
-        D3D11_BUFFER_DESC cbd{};
-        cbd.Usage = D3D11_USAGE_DEFAULT;
-   cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        cbd.CPUAccessFlags = 0;
-cbd.MiscFlags = 0;
-        cbd.StructureByteStride = 0;
+    void RenderShadows(GfxDevice& gfx, const Camera& cam, const RenderProxyBuffer& proxies) {
+        PROFILE_SCOPE("RenderSystem::RenderShadows");
+        if (!shadowsSupported_) return;
+        const uint32_t cascades = shadowsEnabled_ && hasDirectionalLight_ ? shadows_.BeginFrame(cam, shadowLight_.direction) : 0;
+        if (cascades == 0) {
+            shadows_.Disable(gfx.Ctx());
+            return;
+        }
 
-        // VS定数バッファ
-   cbd.ByteWidth = sizeof(VSConstants);
-        HRESULT hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, vsCb_.GetAddressOf());
-        if (FAILED(hr)) {
-  DEBUGLOG_ERROR("[RenderSystem] VS定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-            return false;
+        const DirectX::XMFLOAT4X4 identity(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+        for (uint32_t c = 0; c < CascadedShadowMaps::CASCADE_COUNT; ++c) {
+            if (!(cascades & (1u << c))) continue;
+            const uint8_t lod = static_cast<uint8_t>((std::min)(c, static_cast<uint32_t>(MeshLod::LEVEL_COUNT - 1)));
+            const Frustum& frustum = shadows_.CasterFrustum(c);
+            cullTree_.QueryFrustum(frustum, [&](uint32_t proxy) {
+                const uint32_t data = cullTree_.UserData(proxy);
+                const size_t index = CullTreeIndex(data);
+                if ((data >> CULL_TREE_LIST_SHIFT) == CULL_TREE_MODELS) {
+                    AddModelShadowCaster(c, lod, proxies.models, index);
+                } else {
+                    AddMeshShadowCaster(c, lod, proxies.meshes, index);
+                }
+                return true;
+            });
+            for (const StaticBatchData& batch : staticBatches_) {
+                if (!frustum.IntersectsSphere(batch.boundsCenter, batch.boundsRadius)) continue;
+                RenderProxyMesh mesh;
+                mesh.vertexBuffer = batch.vertexBuffer.Get();
+                mesh.indexBuffer = batch.indexBuffer.Get();
+                mesh.indexCount = batch.indexCount;
+                mesh.indexFormat = DXGI_FORMAT_R32_UINT;
+                shadows_.AddCaster(c, mesh, identity);
+            }
         }
 
-        // PS定数バッファ
-        cbd.ByteWidth = sizeof(PSConstants);
-  hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, psCb_.GetAddressOf());
-    if (FAILED(hr)) {
-            DEBUGLOG_ERROR("[RenderSystem] PS定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-  return false;
+        {
+            GpuProfileScope shadowScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_SHADOWS);
+            shadows_.Render(gfx.Dev(), gfx.States());
         }
+        const CascadedShadowMaps::Statistics& shadowStats = shadows_.GetStatistics();
+        stats_.shadowCascades = shadowStats.cascadesRendered;
+        stats_.shadowCasters = shadowStats.casters;
+        stats_.shadowDraws = shadowStats.draws;
+        stats_.totalDrawCalls += shadowStats.draws;
+
+        // シャドウマップの描画で変えたステートを戻す
+        gfx.BindBackbuffer(gfx.Ctx());
+        BindPipelineState(gfx.States());
+        immediate_.bound = BoundState();
+    }
 
-        // PSライト定数バッファ
-        cbd.ByteWidth = sizeof(PSLightConstants);
-        hr = gfx.Dev()->CreateBuffer(&cbd, nullptr, psLightCb_.GetAddressOf());
-        if (FAILED(hr)) {
-     DEBUGLOG_ERROR("[RenderSystem] PSライト定数バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-            return false;
+    void AddMeshShadowCaster(uint32_t cascade, uint8_t lod, const RenderProxyList& meshes, size_t index) {
+        const MeshType meshType = static_cast<MeshType>(meshes.meshes[index]);
+        auto it = meshCache_.find(MeshKey(meshType, 0));
+        if (it == meshCache_.end() || !it->second) return;
+        const MeshData* mesh = FindLodMesh(it->second.get(), meshType, lod);
+        shadows_.AddCaster(cascade, ResolveMesh(*mesh), meshes.worlds[index]);
+    }
+
+    void AddModelShadowCaster(uint32_t cascade, uint8_t lod, const RenderProxyList& models, size_t index) {
+        const RenderProxyModelMesh& meshes = models.modelMeshes[models.meshes[index]];
+        if (meshes.skinBuffer) return;
+        const RenderProxyMesh* mesh = &meshes.levels[0];
+        for (int level = lod; level > 0; --level) {
+            if (meshes.levels[level].indexCount == 0 || !meshes.levels[level].vertexBuffer) continue;
+            mesh = &meshes.levels[level];
+            break;
+        }
+        if (mesh->vertexFormat != VertexFormat::CompactQuantized) {
+            shadows_.AddCaster(cascade, *mesh, models.worlds[index]);
+            return;
         }
+        DirectX::XMFLOAT4X4 world;
+        DirectX::XMStoreFloat4x4(&world, VertexCompression::PositionDequantMatrix(meshes.positionDequant) * DirectX::XMLoadFloat4x4(&models.worlds[index]));
+        shadows_.AddCaster(cascade, *mesh, world);
+    }
 
-        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 定数バッファの作成完了");
-        return true;
+    /**
+     * @brief 画面に大きく映る MeshRenderer を遮蔽物として深度バッファにラスタライズし、階層Zバッファを作成
+     *
+     * @details
+     * 投影サイズが OCCLUDER_MIN_SIZE 以上のものから大きい順に MAX_OCCLUDERS 個まで、最も粗いLODのメッシュで書き込みます
+     * (球・円柱の粗いLODは元の表面の内側に収まるため、遮蔽物を大きく見積もりません)。
+     * ModelComponent と静的バッチはCPU側の頂点を持たないため遮蔽物にはせず、判定される側だけです。
+     */
+    void RasterizeOccluders(const RenderProxyBuffer& proxies, const Camera& cam) {
+        PROFILE_SCOPE("RenderSystem::RasterizeOccluders");
+        occlusionActive_ = false;
+        if (!cullingEnabled_ || !occlusionEnabled_) return;
+
+        const RenderProxyList& meshes = proxies.meshes;
+        occluderCandidates_.clear();
+        for (size_t i = 0; i < meshes.Size(); ++i) {
+            if (CullTreeRejects(CULL_TREE_MESHES, i)) continue;
+            const DirectX::XMFLOAT3 center = meshes.BoundsCenter(i);
+            const float radius = meshes.BoundsRadius(i);
+            if (radius <= 0.0f || !frustum_.IntersectsSphere(center, radius)) continue;
+            const float size = MeshLod::ProjectedSize(center, radius, cam);
+            if (size >= OCCLUDER_MIN_SIZE) occluderCandidates_.push_back(OccluderCandidate{ size, static_cast<uint32_t>(i) });
+        }
+        if (occluderCandidates_.empty()) return;
+
+        auto larger = [](const OccluderCandidate& a, const OccluderCandidate& b) { return a.size > b.size; };
+        if (occluderCandidates_.size() > MAX_OCCLUDERS) {
+            std::nth_element(occluderCandidates_.begin(), occluderCandidates_.begin() + MAX_OCCLUDERS, occluderCandidates_.end(), larger);
+            occluderCandidates_.resize(MAX_OCCLUDERS);
+        }
+
+        occlusion_.Begin(cam.ViewProj);
+        for (const OccluderCandidate& candidate : occluderCandidates_) {
+            const MeshType meshType = static_cast<MeshType>(meshes.meshes[candidate.proxy]);
+            auto it = meshCache_.find(MeshKey(meshType, 0));
+            if (it == meshCache_.end() || !it->second) continue;
+            const MeshData* mesh = FindLodMesh(it->second.get(), meshType, MeshLod::LEVEL_COUNT - 1);
+            if (mesh->vertices.empty()) continue;
+            occlusion_.AddOccluder(&mesh->vertices[0].pos, sizeof(Vertex), mesh->indices.data(), mesh->indices.size(),
+                                   DirectX::XMLoadFloat4x4(&meshes.worlds[candidate.proxy]));
+        }
+        occlusion_.BuildHierarchy();
+        occlusionActive_ = occlusion_.OccluderCount() > 0;
+        stats_.occluders = occlusion_.OccluderCount();
     }
 
     /**
-     * @brief ステートの作成
+     * @brief カリング用BVHを今回のプロキシに合わせて更新し、視錐台に触れる葉に印を付ける
+     *
+     * @details
+     * 葉はエンティティごとに保持し、移動したものだけ MoveProxy() で更新します
+     * (余白の中の移動では木は変わりません)。今回抽出されなかったエンティティの葉は削除します。
      */
-    bool CreateStates(GfxDevice& gfx) {
-     // サンプラーステート
-        D3D11_SAMPLER_DESC sampDesc{};
-        sampDesc.Filter = D3D11_FILTER_ANISOTROPIC;
-        sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-        sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-        sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-        sampDesc.MaxAnisotropy = 16;
-   sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-        sampDesc.MinLOD = 0;
-        sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    void UpdateCullTree(const RenderProxyBuffer& proxies) {
+        PROFILE_SCOPE("RenderSystem::UpdateCullTree");
+        ++cullTreeStamp_;
+        SyncCullTree(proxies.meshes, CULL_TREE_MESHES);
+        SyncCullTree(proxies.models, CULL_TREE_MODELS);
+        for (std::vector<CullTreeSlot>& slots : cullTreeSlots_) {
+            for (CullTreeSlot& slot : slots) {
+                if (slot.proxy == DynamicBvh::NULL_NODE || slot.stamp == cullTreeStamp_) continue;
+                cullTree_.DestroyProxy(slot.proxy);
+                slot.proxy = DynamicBvh::NULL_NODE;
+            }
+        }
+        if (!cullTreeActive_) return;
 
-        HRESULT hr = gfx.Dev()->CreateSamplerState(&sampDesc, &samplerState_);
-        if (FAILED(hr)) {
-     DEBUGLOG_ERROR("[RenderSystem] サンプラーステートの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-     return false;
+        cullTree_.QueryFrustum(frustum_, [this](uint32_t proxy) {
+            const uint32_t data = cullTree_.UserData(proxy);
+            cullTreeVisible_[data >> CULL_TREE_LIST_SHIFT][CullTreeIndex(data)] = 1;
+            return true;
+        });
+        for (const TrackedVector<uint8_t, MemoryTag::Render>& visible : cullTreeVisible_) {
+            for (uint8_t v : visible) {
+                if (!v) stats_.treeCulled++;
+            }
         }
+        stats_.culled += stats_.treeCulled;
+    }
 
-        // ラスタライザーステート
- D3D11_RASTERIZER_DESC rsd{};
-        rsd.FillMode = D3D11_FILL_SOLID;
-   rsd.CullMode = D3D11_CULL_BACK;
-        rsd.FrontCounterClockwise = FALSE;
-        rsd.DepthClipEnable = TRUE;
-        rsd.ScissorEnable = FALSE;
-        rsd.MultisampleEnable = FALSE;
-        rsd.AntialiasedLineEnable = FALSE;
+    void SyncCullTree(const RenderProxyList& list, uint32_t listIndex) {
+        std::vector<CullTreeSlot>& slots = cullTreeSlots_[listIndex];
+        TrackedVector<uint8_t, MemoryTag::Render>& visible = cullTreeVisible_[listIndex];
+        visible.assign(list.Size(), 0);
+        for (size_t i = 0; i < list.Size(); ++i) {
+            const float radius = list.BoundsRadius(i);
+            if (radius <= 0.0f) {
+                visible[i] = 1; // 境界球がないものはカリングしない
+                continue;
+            }
 
-        hr = gfx.Dev()->CreateRasterizerState(&rsd, rasterState_.GetAddressOf());
-   if (FAILED(hr)) {
-      DEBUGLOG_ERROR("[RenderSystem] ラスタライザーステートの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-  return false;
+            const Entity e = list.entities[i];
+            if (e.id >= slots.size()) slots.resize(e.id + 1);
+            CullTreeSlot& slot = slots[e.id];
+            const uint32_t data = (listIndex << CULL_TREE_LIST_SHIFT) | static_cast<uint32_t>(i);
+            const BvhAabb box = BvhAabb::FromSphere(list.BoundsCenter(i), radius);
+            if (slot.proxy != DynamicBvh::NULL_NODE && slot.entity != e) {
+                cullTree_.DestroyProxy(slot.proxy);
+                slot.proxy = DynamicBvh::NULL_NODE;
+            }
+            if (slot.proxy == DynamicBvh::NULL_NODE) {
+                slot.proxy = cullTree_.CreateProxy(box, data);
+                slot.entity = e;
+            } else {
+                cullTree_.MoveProxy(slot.proxy, box);
+                cullTree_.SetUserData(slot.proxy, data);
+            }
+            slot.stamp = cullTreeStamp_;
         }
+    }
 
- DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] ステートの作成完了");
+    /**
+     * @brief カリング用BVHの事前判定で視錐台の外と分かっているか
+     */
+    bool CullTreeRejects(uint32_t listIndex, size_t index) const {
+        return cullTreeActive_ && !cullTreeVisible_[listIndex][index];
+    }
+
+    void ClearCullTree() {
+        cullTree_.Clear();
+        for (std::vector<CullTreeSlot>& slots : cullTreeSlots_) slots.clear();
+        for (TrackedVector<uint8_t, MemoryTag::Render>& visible : cullTreeVisible_) visible.clear();
+    }
+
+    static const RenderProxyList& CullTreeList(const RenderProxyBuffer& proxies, uint32_t data) {
+        return (data >> CULL_TREE_LIST_SHIFT) == CULL_TREE_MODELS ? proxies.models : proxies.meshes;
+    }
+
+    static size_t CullTreeIndex(uint32_t data) {
+        return data & ((1u << CULL_TREE_LIST_SHIFT) - 1u);
+    }
+
+    /**
+     * @brief 半直線と球の判定
+     * @param[out] t 当たった距離(始点が球の内側なら 0)
+     */
+    static bool RaySphere(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, const DirectX::XMFLOAT3& center, float radius, float& t) {
+        const float mx = origin.x - center.x, my = origin.y - center.y, mz = origin.z - center.z;
+        const float b = mx * dir.x + my * dir.y + mz * dir.z;
+        const float c = mx * mx + my * my + mz * mz - radius * radius;
+        if (c > 0.0f && b > 0.0f) return false;
+        const float discriminant = b * b - c;
+        if (discriminant < 0.0f) return false;
+        t = (std::max)(0.0f, -b - std::sqrt(discriminant));
         return true;
     }
 
     /**
-     * @brief 基本形状メッシュの作成
+     * @brief エンティティと変更ティックに依存するキャッシュ(静的バッチ・LODの履歴)を破棄
      */
-    bool CreatePrimitiveMeshes(GfxDevice& gfx) {
-        // Cube
-        if (!CreateCubeMesh(gfx)) {
-  DEBUGLOG_ERROR("[RenderSystem] キューブメッシュの作成失敗");
-            return false;
+    void ResetWorldCaches() {
+        for (const StaticBatchData& batch : staticBatches_) {
+            meshSortIds_.erase(batch.vertexBuffer.Get());
         }
+        staticBatches_.clear();
+        staticBatchMembers_ = 0;
+        staticBatchesBuilt_ = false;
+        staticBatchTick_ = 0;
+        meshLods_.Clear();
+        modelLods_.Clear();
+        proxies_.Clear();
+        ClearCullTree();
+        particles_.ResetEmitters();
+        transparent_.Reset();
+    }
 
-        // Sphere
-  if (!CreateSphereMesh(gfx)) {
-    DEBUGLOG_ERROR("[RenderSystem] 球体メッシュの作成失敗");
-            return false;
+    /**
+     * @brief 前回の構築以降にメンバーが変わったか
+     */
+    bool StaticBatchesDirty(World& w) {
+        auto& members = w.Query<Transform, MeshRenderer, StaticBatch>();
+        if (!staticBatchesBuilt_) return !members.Empty();
+        if (members.Size() != staticBatchMembers_) return true;
+        if (members.Empty()) return false;
+
+        const uint32_t since = staticBatchTick_;
+        bool dirty = false;
+        members.ForEach(Changed<Transform>(since), [&](Entity, Transform&, MeshRenderer&, StaticBatch&) { dirty = true; });
+        if (dirty) return true;
+        members.ForEach(Changed<MeshRenderer>(since), [&](Entity, Transform&, MeshRenderer&, StaticBatch&) { dirty = true; });
+        if (dirty) return true;
+        members.ForEach(Added<StaticBatch>(since), [&](Entity, Transform&, MeshRenderer&, StaticBatch&) { dirty = true; });
+        if (dirty) return true;
+        w.Query<LocalToWorld, StaticBatch>().ForEach(Changed<LocalToWorld>(since), [&](Entity, LocalToWorld&, StaticBatch&) { dirty = true; });
+        return dirty;
+    }
+
+    /**
+     * @brief 静的バッチの再構築
+     *
+     * @details
+     * メンバーをマテリアルごとに並べ、各メッシュの頂点をワールド行列で変換して連結します。
+     * 法線は逆転置行列で変換し、裏返る行列(行列式が負)の場合は三角形の巻き順を反転します。
+     */
+    void RebuildStaticBatches(World& w, GfxDevice& gfx) {
+        for (const StaticBatchData& batch : staticBatches_) {
+            meshSortIds_.erase(batch.vertexBuffer.Get());
         }
+        staticBatches_.clear();
+
+        struct Member {
+            const MeshRenderer* renderer;
+            const MeshData* mesh;
+            DirectX::XMFLOAT4X4 world;
+        };
+        std::vector<Member> members;
+
+        auto& query = w.Query<Transform, MeshRenderer, StaticBatch>();
+        query.ForEach([&](Entity e, Transform& t, MeshRenderer& mr, StaticBatch&) {
+            auto it = meshCache_.find(static_cast<int>(mr.meshType));
+            if (it == meshCache_.end() || !it->second || it->second->vertices.empty()) return;
+            Member m{ &mr, it->second.get(), {} };
+            DirectX::XMStoreFloat4x4(&m.world, ResolveWorldMatrix(w, e, t, false)); // 焼き込むため補間しない
+            members.push_back(m);
+        });
 
-     // Cylinder
-    if (!CreateCylinderMesh(gfx)) {
-            DEBUGLOG_ERROR("[RenderSystem] 円柱メッシュの作成失敗");
+        auto materialLess = [](const MeshRenderer& a, const MeshRenderer& b) {
+            if (a.material != b.material) return a.material < b.material;
+            if (a.texture != b.texture) return a.texture < b.texture;
+            const float ka[7] = { a.color.x, a.color.y, a.color.z, a.uvOffset.x, a.uvOffset.y, a.uvScale.x, a.uvScale.y };
+            const float kb[7] = { b.color.x, b.color.y, b.color.z, b.uvOffset.x, b.uvOffset.y, b.uvScale.x, b.uvScale.y };
+            for (int i = 0; i < 7; ++i) {
+                if (ka[i] != kb[i]) return ka[i] < kb[i];
+            }
             return false;
-    }
+        };
+        std::stable_sort(members.begin(), members.end(), [&](const Member& a, const Member& b) {
+            return materialLess(*a.renderer, *b.renderer);
+        });
 
-      // Plane
-        if (!CreatePlaneMesh(gfx)) {
-            DEBUGLOG_ERROR("[RenderSystem] 平面メッシュの作成失敗");
-  return false;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        size_t begin = 0;
+        while (begin < members.size()) {
+            size_t end = begin + 1;
+            while (end < members.size() &&
+                   !materialLess(*members[begin].renderer, *members[end].renderer) &&
+                   !materialLess(*members[end].renderer, *members[begin].renderer)) {
+                ++end;
+            }
+
+            vertices.clear();
+            indices.clear();
+            for (size_t i = begin; i < end; ++i) {
+                AppendTransformedMesh(*members[i].mesh, DirectX::XMLoadFloat4x4(&members[i].world), vertices, indices);
+            }
+
+            StaticBatchData batch;
+            const MeshRenderer& material = *members[begin].renderer;
+            batch.color = material.color;
+            batch.uvOffset = material.uvOffset;
+            batch.uvScale = material.uvScale;
+            batch.texture = material.texture;
+            if (materials_->IsValid(material.material)) {
+                const MaterialDesc& desc = materials_->GetDesc(material.material);
+                batch.material = material.material;
+                batch.color = desc.color;
+                batch.texture = desc.texture;
+                batch.normalTexture = desc.normalTexture;
+            }
+            batch.members = end - begin;
+            if (CreateStaticBatchBuffers(gfx, vertices, indices, batch)) {
+                staticBatches_.push_back(std::move(batch));
+            }
+            begin = end;
         }
 
-        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 基本形状メッシュの作成完了");
-        return true;
+        staticBatchMembers_ = query.Size();
+        staticBatchTick_ = w.AdvanceChangeTick();
+        staticBatchesBuilt_ = true;
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[RenderSystem] 静的バッチを構築: " + std::to_string(members.size()) +
+                          "メッシュ -> " + std::to_string(staticBatches_.size()) + "バッチ");
     }
 
     /**
-     * @brief キューブメッシュの作成
+     * @brief メッシュをワールド行列で変換して連結
      */
-    bool CreateCubeMesh(GfxDevice& gfx) {
-        const float size = 0.5f;
+    static void AppendTransformedMesh(const MeshData& mesh, const DirectX::XMMATRIX& world, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+        DirectX::XMVECTOR det;
+        DirectX::XMMATRIX normalMatrix = DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(&det, world));
+        const bool flip = DirectX::XMVectorGetX(DirectX::XMMatrixDeterminant(world)) < 0.0f;
+
+        const uint32_t base = static_cast<uint32_t>(vertices.size());
+        for (const Vertex& src : mesh.vertices) {
+            Vertex v = src;
+            DirectX::XMStoreFloat3(&v.pos, DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&src.pos), world));
+            DirectX::XMStoreFloat3(&v.nrm, DirectX::XMVector3Normalize(DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&src.nrm), normalMatrix)));
+            DirectX::XMStoreFloat3(&v.tan, DirectX::XMVector3Normalize(DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&src.tan), world)));
+            DirectX::XMStoreFloat3(&v.bitan, DirectX::XMVector3Normalize(DirectX::XMVector3TransformNormal(DirectX::XMLoadFloat3(&src.bitan), world)));
+            vertices.push_back(v);
+        }
 
-        // 頂点データ（各面に4頂点）
-        Vertex vertices[] = {
-            // Front face (Z+)
-    {{-size, -size, size}, {0, 1}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
-  {{size, -size, size}, {1, 1}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
-            {{size, size, size}, {1, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
-     {{-size, size, size}, {0, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            uint32_t a = base + mesh.indices[i];
+            uint32_t b = base + mesh.indices[i + 1];
+            uint32_t c = base + mesh.indices[i + 2];
+            indices.push_back(a);
+            indices.push_back(flip ? c : b);
+            indices.push_back(flip ? b : c);
+        }
+    }
 
-     // Back face (Z-)
-         {{size, -size, -size}, {0, 1}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
-       {{-size, -size, -size}, {1, 1}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
-          {{-size, size, -size}, {1, 0}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
-            {{size, size, -size}, {0, 0}, {0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+    /**
+     * @brief 静的バッチの頂点・インデックスバッファ作成
+     */
+    bool CreateStaticBatchBuffers(GfxDevice& gfx, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, StaticBatchData& batch) {
+        if (vertices.empty() || indices.empty()) return false;
 
-        // Left face (X-)
-      {{-size, -size, -size}, {0, 1}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
-      {{-size, -size, size}, {1, 1}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
-       {{-size, size, size}, {1, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
-        {{-size, size, -size}, {0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        D3D11_BUFFER_DESC vbd{};
+        vbd.Usage = D3D11_USAGE_IMMUTABLE;
+        vbd.ByteWidth = static_cast<UINT>(vertices.size() * sizeof(Vertex));
+        vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        D3D11_SUBRESOURCE_DATA vData{};
+        vData.pSysMem = vertices.data();
+        HRESULT hr = gfx.Dev()->CreateBuffer(&vbd, &vData, batch.vertexBuffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] 静的バッチの頂点バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
 
-        // Right face (X+)
-            {{size, -size, size}, {0, 1}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
-  {{size, -size, -size}, {1, 1}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
-      {{size, size, -size}, {1, 0}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
-            {{size, size, size}, {0, 0}, {1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+        D3D11_BUFFER_DESC ibd{};
+        ibd.Usage = D3D11_USAGE_IMMUTABLE;
+        ibd.ByteWidth = static_cast<UINT>(indices.size() * sizeof(uint32_t));
+        ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+        D3D11_SUBRESOURCE_DATA iData{};
+        iData.pSysMem = indices.data();
+        hr = gfx.Dev()->CreateBuffer(&ibd, &iData, batch.indexBuffer.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] 静的バッチのインデックスバッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
 
-   // Top face (Y+)
-            {{-size, size, size}, {0, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
-          {{size, size, size}, {1, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
-   {{size, size, -size}, {1, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
-    {{-size, size, -size}, {0, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+        batch.indexCount = static_cast<UINT>(indices.size());
+        batch.boundsRadius = ComputeBoundingSphere(&vertices[0].pos, vertices.size(), sizeof(Vertex), batch.boundsCenter);
+        return true;
+    }
 
-        // Bottom face (Y-)
-            {{-size, -size, -size}, {0, 1}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
-   {{size, -size, -size}, {1, 1}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
- {{size, -size, size}, {1, 0}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
-    {{-size, -size, size}, {0, 0}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
-        };
+    /**
+     * @brief MeshRendererの描画(インスタンス描画が使えない場合は描画キューに追加)
+     */
+    void RenderMeshRenderers(const RenderProxyBuffer& proxies, GfxDevice& gfx, const Camera& cam, TextureManager& texMgr) {
+        PROFILE_SCOPE("RenderSystem::RenderMeshRenderers");
+        if (IsInstancingEnabled() && RenderMeshRenderersInstanced(proxies.meshes, proxies.models, gfx, cam, texMgr)) {
+            modelInstanceProxies_.clear();
+            return;
+        }
 
-        // インデックスデータ（各面に2三角形 = 6インデックス）
- uint16_t indices[] = {
-     0, 1, 2, 0, 2, 3,       // Front
-            4, 5, 6, 4, 6, 7,     // Back
-      8, 9, 10, 8, 10, 11,    // Left
-            12, 13, 14, 12, 14, 15, // Right
-       16, 17, 18, 16, 18, 19, // Top
-     20, 21, 22, 20, 22, 23  // Bottom
-        };
+        // インスタンス描画に回した ModelComponent は描画キューに戻す
+        for (const ModelInstanceProxy& proxy : modelInstanceProxies_) {
+            QueueModelPacket(proxies.models, proxy.proxy, proxy.mesh, cam);
+        }
+        modelInstanceProxies_.clear();
 
-     return CreateMeshBuffers(gfx, vertices, sizeof(vertices) / sizeof(Vertex), indices, sizeof(indices) / sizeof(uint16_t), static_cast<int>(MeshType::Cube));
+        const RenderProxyList& meshes = proxies.meshes;
+        for (size_t i = 0; i < meshes.Size(); ++i) {
+            if (CullTreeRejects(CULL_TREE_MESHES, i)) continue;
+            QueueMeshPacket(meshes, i, cam, texMgr);
+        }
     }
 
     /**
-   * @brief 球体メッシュの作成
+     * @brief MeshRenderer の1つを描画キュー(半透明のマテリアルは TransparentQueue)に追加
      */
-    bool CreateSphereMesh(GfxDevice& gfx) {
-        const int segments = 32;
-     const int rings = 16;
-        const float radius = 0.5f;
-
-     std::vector<Vertex> vertices;
-        std::vector<uint16_t> indices;
-
-        // 頂点生成
-        for (int ring = 0; ring <= rings; ++ring) {
-   float phi = DirectX::XM_PI * ring / rings;
-    float sinPhi = sinf(phi);
-            float cosPhi = cosf(phi);
+    void QueueMeshPacket(const RenderProxyList& meshes, size_t i, const Camera& cam, TextureManager& texMgr) {
+        // メッシュデータの取得
+        const MeshType meshType = static_cast<MeshType>(meshes.meshes[i]);
+        auto it = meshCache_.find(static_cast<int>(meshType));
+        if (it == meshCache_.end() || !it->second) {
+            DEBUGLOG_WARNING("[RenderSystem] MeshType not found: " + std::to_string(static_cast<int>(meshType)));
+            return;
+        }
 
-            for (int seg = 0; seg <= segments; ++seg) {
-        float theta = 2.0f * DirectX::XM_PI * seg / segments;
-        float sinTheta = sinf(theta);
-  float cosTheta = cosf(theta);
+        const MeshData* meshData = it->second.get();
+
+        DirectX::XMMATRIX worldMatrix = DirectX::XMLoadFloat4x4(&meshes.worlds[i]);
+
+        // 境界球はLOD0のもの(抽出時に変換済み)
+        DirectX::XMFLOAT3 center = meshes.BoundsCenter(i);
+        float radius = meshes.BoundsRadius(i);
+        float size = MeshLod::ProjectedSize(center, radius, cam);
+        meshData = FindLodMesh(meshData, meshType, SelectLod(meshLods_, meshes.entities[i], size));
+        RequestTextureDetail(texMgr, meshes.textures[i], size);
+        const RenderProxyMesh mesh = ResolveMesh(*meshData);
+        if (!mesh.vertexBuffer) return;
+        MaterialManager::MaterialHandle material = ResolveMaterial(meshes.materials[i], meshes.colors[i], meshes.textures[i], meshes.normalTextures[i]);
+        if (material == MaterialManager::INVALID_MATERIAL) return;
+
+        DrawPacket& packet = PushPacket(material, center, radius, TransparentId(TRANSPARENT_ID_MESH, meshes.entities[i].Packed()));
+        packet.vertexBuffer = mesh.vertexBuffer;
+        packet.indexBuffer = mesh.indexBuffer;
+        packet.indexCount = mesh.indexCount;
+        packet.startIndex = mesh.startIndex;
+        packet.baseVertex = mesh.baseVertex;
+        packet.world = meshes.worlds[i];
+        packet.material = material;
+        packet.materialBuffer = materials_->Use(material);
+        packet.uvOffset = meshes.UvOffset(i);
+        packet.uvScale = meshes.UvScale(i);
+        packet.texture = meshes.textures[i];
+        packet.normalTexture = meshes.normalTextures[i];
+        packet.sortKey = MakeSortKey(packet, worldMatrix, cam);
+    }
 
-        Vertex v;
-       v.pos.x = radius * sinPhi * cosTheta;
-          v.pos.y = radius * cosPhi;
-       v.pos.z = radius * sinPhi * sinTheta;
+    /**
+     * @brief 描画パケットを追加(半透明のマテリアルは TransparentQueue、それ以外はカリング用の境界球と一緒に描画キュー)
+     * @param[in] id フレームをまたいで同じ描画を指す値(TransparentId()、半透明の前回の順番を引き継ぐ)
+     */
+    DrawPacket& PushPacket(MaterialManager::MaterialHandle material, const DirectX::XMFLOAT3& center, float radius, uint64_t id) {
+        if (materials_->IsTransparent(material)) return transparent_.Push(id, center, radius);
+        queueCull_.Add(center, radius);
+        return queue_.Push();
+    }
 
-           v.nrm.x = sinPhi * cosTheta;
-      v.nrm.y = cosPhi;
-         v.nrm.z = sinPhi * sinTheta;
+    /**
+     * @brief TransparentQueue に渡す id(下位2ビットが描画の種類。世代番号の上位2ビットは捨てるが、重複しても描画順は正しい)
+     */
+    static uint64_t TransparentId(uint32_t kind, uint64_t value) {
+        return (value << 2) | kind;
+    }
 
-v.tex.x = static_cast<float>(seg) / segments;
-  v.tex.y = static_cast<float>(ring) / rings;
+    /**
+     * @brief パケットのマテリアル(明示的なマテリアルがなければ色・テクスチャから暗黙のマテリアルを引く)
+     * @return MaterialManager::MaterialHandle 定数バッファを作成できない場合 INVALID_MATERIAL
+     */
+    MaterialManager::MaterialHandle ResolveMaterial(MaterialManager::MaterialHandle material, const DirectX::XMFLOAT3& color,
+                                                    TextureManager::TextureHandle texture, TextureManager::TextureHandle normalTexture) {
+        if (materials_->IsValid(material)) return material;
+        MaterialDesc desc;
+        desc.color = color;
+        desc.texture = texture;
+        desc.normalTexture = normalTexture;
+        return materials_->Resolve(desc);
+    }
 
-    v.tan.x = -sinTheta;
-     v.tan.y = 0;
-                v.tan.z = cosTheta;
+    /**
+     * @brief 描画パケットのソートキーを作成(不透明パス・シェーダーの機能・マテリアル・メッシュ・手前から奥)
+     *
+     * @details
+     * SetFrontToBackSortingEnabled(true) の場合は奥行きをステートより優先します。
+     */
+    uint64_t MakeSortKey(const DrawPacket& packet, const DirectX::XMMATRIX& worldMatrix, const Camera& cam) {
+        DirectX::XMVECTOR viewPos = DirectX::XMVector3TransformCoord(worldMatrix.r[3], cam.View);
+        uint32_t depth = RenderQueue::QuantizeDepth(DirectX::XMVectorGetZ(viewPos), cam.nearZ, cam.farZ);
+        uint32_t shader = ShaderFeatures(packet.texture, packet.normalTexture);
+        if (packet.vertexFormat != VertexFormat::Standard) shader |= SORT_COMPACT_VERTEX;
+        if (frontToBackEnabled_) {
+            return RenderQueue::MakeDepthFirstKey(0, shader, packet.material, MeshSortId(packet.vertexBuffer), depth);
+        }
+        return RenderQueue::MakeKey(0, shader, packet.material, MeshSortId(packet.vertexBuffer), depth);
+    }
 
-     v.bitan.x = cosPhi * cosTheta;
-      v.bitan.y = -sinPhi;
-   v.bitan.z = cosPhi * sinTheta;
+    /**
+     * @brief 頂点バッファごとの連番(ソートキーの mesh フィールド用)
+     */
+    uint32_t MeshSortId(ID3D11Buffer* vertexBuffer) {
+        auto it = meshSortIds_.find(vertexBuffer);
+        if (it != meshSortIds_.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(meshSortIds_.size() + 1);
+        meshSortIds_.emplace(vertexBuffer, id);
+        return id;
+    }
 
-          vertices.push_back(v);
+    /**
+     * @brief 描画キューをカリング(視錐台・遮蔽)してから SubmitSortedQueue() で送信
+     */
+    void SubmitQueue(GfxDevice& gfx, TextureManager& texMgr) {
+        PROFILE_SCOPE("RenderSystem::SubmitQueue");
+        if (cullingEnabled_ && !queue_.Empty()) {
+            size_t visible = queueCull_.Run(frustum_, jobs_);
+            stats_.culled += queue_.Size() - visible;
+            if (occlusionActive_) {
+                stats_.occluded += occlusion_.Cull(queueCull_, jobs_);
+            }
+            queue_.Retain(queueCull_.VisibleFlags());
         }
+        SubmitSortedQueue(gfx, texMgr);
+    }
+
+    /**
+     * @brief 描画キューをソートして送信(直前と同じステートの設定は省略。RenderReplay() は記録したパケットをそのまま渡す)
+     */
+    void SubmitSortedQueue(GfxDevice& gfx, TextureManager& texMgr) {
+        queue_.Sort();
+
+        auto submitStart = std::chrono::high_resolution_clock::now();
+        pipelineQueries_[PIPELINE_PASS_DEPTH_PREPASS].Begin(gfx.Ctx());
+        if (depthPrepassEnabled_ && depthPrepassState_ && !queue_.Empty()) {
+            GpuProfileScope prepassScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_DEPTH_PREPASS);
+            SubmitDepthPrepass(gfx);
         }
+        pipelineQueries_[PIPELINE_PASS_DEPTH_PREPASS].End(gfx.Ctx());
 
-        // インデックス生成
-        for (int ring = 0; ring < rings; ++ring) {
-            for (int seg = 0; seg < segments; ++seg) {
-            int a = ring * (segments + 1) + seg;
- int b = a + 1;
-                int c = a + segments + 1;
-  int d = c + 1;
+        pipelineQueries_[PIPELINE_PASS_QUEUE].Begin(gfx.Ctx());
+        {
+            GpuProfileScope queueScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_QUEUE);
+            if (!(deferredEnabled_ && SubmitQueueDeferred(gfx, texMgr))) {
+                SubmitQueueImmediate(gfx, texMgr);
+            }
+        }
+        pipelineQueries_[PIPELINE_PASS_QUEUE].End(gfx.Ctx());
+        std::chrono::duration<float, std::milli> submitTime = std::chrono::high_resolution_clock::now() - submitStart;
+        stats_.submitMs = submitTime.count();
+
+        // 以降の描画(デバッグ描画など)は標準の頂点形式と既定の深度ステートに戻す
+        BindVertexFormat(immediate_, VertexFormat::Standard);
+        if (depthPrepassActive_) {
+            gfx.States().SetDepthStencilState(nullptr);
+            depthPrepassActive_ = false;
+        }
+    }
 
-   indices.push_back(a);
-     indices.push_back(c);
-          indices.push_back(b);
+    /**
+     * @brief 送信した描画キューとフレームの定数を capturePath_ に書き出す
+     */
+    void WriteFrameCapture(GfxDevice& gfx, TextureManager& texMgr, const RenderProxyBuffer& proxies) {
+        PROFILE_SCOPE("RenderSystem::WriteFrameCapture");
+        FrameCapture capture;
+        capture.frame = stats_.frame;
+        capture.renderWidth = gfx.RenderWidth();
+        capture.renderHeight = gfx.RenderHeight();
+        const uint8_t* frame = reinterpret_cast<const uint8_t*>(&frameCb_.uploaded);
+        const uint8_t* light = reinterpret_cast<const uint8_t*>(&psLightCb_.uploaded);
+        capture.frameConstants.assign(frame, frame + sizeof(FrameConstants));
+        capture.lightConstants.assign(light, light + sizeof(PSLightConstants));
+        if (skinningActive_) {
+            capture.skinPalette.assign(proxies.skinPalettes.begin(), proxies.skinPalettes.end());
+        }
 
-      indices.push_back(b);
-       indices.push_back(c);
-           indices.push_back(d);
-   }
+        FrameCaptureBuilder builder(capture, gfx.Dev(), gfx.Ctx());
+        capture.packets.reserve(queue_.Size());
+        for (size_t i = 0; i < queue_.Size(); ++i) {
+            const DrawPacket& packet = queue_.Sorted(i);
+            FrameCapture::Packet out;
+            out.sortKey = packet.sortKey;
+            out.vertexBuffer = builder.AddBuffer(packet.vertexBuffer);
+            out.indexBuffer = builder.AddBuffer(packet.indexBuffer);
+            out.materialBuffer = builder.AddBuffer(packet.materialBuffer);
+            out.skinBuffer = builder.AddBuffer(packet.skinBuffer);
+            out.indexCount = packet.indexCount;
+            out.startIndex = packet.startIndex;
+            out.baseVertex = packet.baseVertex;
+            out.indexFormat = static_cast<uint32_t>(packet.indexFormat);
+            out.vertexFormat = static_cast<uint32_t>(packet.vertexFormat);
+            out.texture = builder.AddTexture(packet.texture, [&] { return texMgr.GetSourcePath(packet.texture); });
+            out.normalTexture = builder.AddTexture(packet.normalTexture, [&] { return texMgr.GetSourcePath(packet.normalTexture); });
+            out.boneOffset = packet.boneOffset;
+            out.flags = packet.isModel ? FrameCapture::PACKET_MODEL : 0;
+            out.world = packet.world;
+            out.uvOffset = packet.uvOffset;
+            out.uvScale = packet.uvScale;
+            capture.packets.push_back(out);
         }
 
-        return CreateMeshBuffers(gfx, vertices.data(), vertices.size(), indices.data(), indices.size(), static_cast<int>(MeshType::Sphere));
+        if (!capture.Save(capturePath_)) {
+            DEBUGLOG_ERROR("[RenderSystem] フレームの記録を書き出せません: " + capturePath_);
+            return;
+        }
+        char line[256];
+        sprintf_s(line, "[RenderSystem] フレーム %llu を記録: パケット %zu, バッファ %zu (%.1f MB), テクスチャ %zu -> ",
+                  static_cast<unsigned long long>(capture.frame), capture.packets.size(), capture.buffers.size(),
+                  static_cast<double>(capture.BufferBytes()) / (1024.0 * 1024.0), capture.textures.size());
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, line + capturePath_);
     }
 
     /**
-     * @brief 円柱メッシュの作成
+     * @brief フレームの最後にステートキャッシュの統計を加え、統計の履歴(GetStatisticsHistory)に記録
      */
-    bool CreateCylinderMesh(GfxDevice& gfx) {
-      const int segments = 32;
-     const float radius = 0.5f;
-        const float height = 1.0f;
+    void RecordFrameStatistics(GfxDevice& gfx) {
+        const StateCacheStats& cacheStats = gfx.States().GetStats();
+        stats_.pipelineStateCalls += static_cast<size_t>(cacheStats.issued - stateCacheStart_.issued);
+        stats_.pipelineStateCallsSkipped += static_cast<size_t>(cacheStats.skipped - stateCacheStart_.skipped);
+
+        history_[historyHead_] = stats_;
+        historyHead_ = (historyHead_ + 1) % STATISTICS_HISTORY_FRAMES;
+        historyCount_ = (std::min)(historyCount_ + 1, STATISTICS_HISTORY_FRAMES);
+    }
 
-        std::vector<Vertex> vertices;
-        std::vector<uint16_t> indices;
+    /**
+     * @brief 半透明のパケットを奥から手前へ送信(不透明の描画の後。深度は読むだけで書かない)
+     *
+     * @details
+     * TransparentQueue が前のフレームの順番から差分ソートし、同じステートで画面上の重ならないパケットを続けて並べるため、
+     * マテリアル・テクスチャ・メッシュの設定は BoundState でまとまりごとに1回になります。
+     */
+    void SubmitTransparent(GfxDevice& gfx, TextureManager& texMgr, const Camera& cam) {
+        if (transparent_.Empty()) return;
+        PROFILE_SCOPE("RenderSystem::SubmitTransparent");
+        transparent_.Prepare(cam.View, cam.Proj, cam.nearZ, cullingEnabled_ ? &frustum_ : nullptr);
+        const TransparentQueue::Stats& sorted = transparent_.GetStats();
+        stats_.culled += sorted.culled;
+        stats_.transparentBatches += sorted.batches;
+        if (transparent_.Size() == 0) return;
+
+        GpuProfileScope transparentScope(gfx.Profiler(), gfx.Ctx(), GPU_SCOPE_TRANSPARENT);
+        gfx.States().Apply(pipelineTransparent_);
+        immediate_.bound.pixelShader = nullptr; // Apply() が標準のピクセルシェーダーに戻したため、最初のパケットで設定し直す
+        for (size_t i = 0; i < transparent_.Size(); ++i) {
+            const DrawPacket& packet = transparent_.Sorted(i);
+            UpdateVSConstants(immediate_, DirectX::XMLoadFloat4x4(&packet.world), packet.uvOffset, packet.uvScale);
+            DrawPacketGeometry(immediate_, texMgr, packet);
+        }
+        stats_.transparentDraws += transparent_.Size();
 
-        // 側面の頂点
-        for (int i = 0; i <= segments; ++i) {
-            float theta = 2.0f * DirectX::XM_PI * i / segments;
-        float cosTheta = cosf(theta);
-         float sinTheta = sinf(theta);
+        // 以降の描画は標準の頂点形式と既定のブレンド・深度ステートに戻す
+        BindVertexFormat(immediate_, VertexFormat::Standard);
+        gfx.States().SetBlendState(nullptr);
+        gfx.States().SetDepthStencilState(nullptr);
+    }
 
-            // トップの頂点
-            Vertex vTop;
-    vTop.pos = {radius * cosTheta, height / 2, radius * sinTheta};
-     vTop.tex = {static_cast<float>(i) / segments, 0.0f};
-        vTop.nrm = {cosTheta, 0, sinTheta};
-    vTop.tan = {-sinTheta, 0, cosTheta};
-   vTop.bitan = {0, 1, 0};
-            vertices.push_back(vTop);
+    /**
+     * @brief ソート済みの描画キューを深度だけ描画し、シェーディング用の深度ステートに切り替える
+     *
+     * @details
+     * 頂点シェーダーと VS 定数はシェーディングと同じものを使うため、同じ深度が出力され
+     * LESS_EQUAL のテストを通ります。ピクセルシェーダーは外し、テクスチャも設定しません。
+     */
+    void SubmitDepthPrepass(GfxDevice& gfx) {
+        ID3D11DeviceContext* ctx = gfx.Ctx();
+        gfx.States().SetDepthStencilState(depthPrepassState_.Get());
+        gfx.States().SetPixelShader(nullptr);
+        immediate_.bound.pixelShader = nullptr; // シェーディングの最初のパケットで必ず設定し直す
+
+        for (size_t i = 0; i < queue_.Size(); ++i) {
+            const DrawPacket& packet = queue_.Sorted(i);
+            VSConstants vsCbuf = MakeVSConstants(DirectX::XMLoadFloat4x4(&packet.world), packet.uvOffset, packet.uvScale);
+            ctx->UpdateSubresource(vsCb_.Get(), 0, nullptr, &vsCbuf, 0, 0);
+            BindMesh(immediate_, packet.vertexBuffer, packet.indexBuffer, packet.indexFormat, packet.vertexFormat, packet.skinBuffer);
+            BindBoneOffset(immediate_, packet);
+            ctx->DrawIndexed(packet.indexCount, packet.startIndex, packet.baseVertex);
+            stats_.depthPrepassDraws++;
+            stats_.totalDrawCalls++;
+            stats_.trianglesRendered += packet.indexCount / 3;
+            stats_.constantBufferBytes += sizeof(VSConstants);
+        }
 
-         // ボトムの頂点
-    Vertex vBottom;
-      vBottom.pos = {radius * cosTheta, -height / 2, radius * sinTheta};
-       vBottom.tex = {static_cast<float>(i) / segments, 1.0f};
-      vBottom.nrm = {cosTheta, 0, sinTheta};
-            vBottom.tan = {-sinTheta, 0, cosTheta};
-            vBottom.bitan = {0, 1, 0};
-            vertices.push_back(vBottom);
+        depthPrepassActive_ = true;
+        gfx.States().SetDepthStencilState(depthEqualState_.Get());
     }
 
-     // 側面のインデックス
-    for (int i = 0; i < segments; ++i) {
-            int top1 = i * 2;
-  int bot1 = i * 2 + 1;
-  int top2 = (i + 1) * 2;
-            int bot2 = (i + 1) * 2 + 1;
-
-            indices.push_back(top1);
-            indices.push_back(bot1);
-            indices.push_back(top2);
+    /**
+     * @brief パイプライン統計の回収(有効化された直後はクエリを作成)
+     *
+     * @details
+     * Statistics は毎フレーム Reset() されるため、回収済みの最新値をここで書き戻します。
+     */
+    void CollectPipelineStatistics(GfxDevice& gfx) {
+        if (!pipelineStatsEnabled_) return;
+
+        uint64_t psInvocations = 0;
+        for (PipelineStatisticsQuery& query : pipelineQueries_) {
+            if (!query.IsValid() && !query.Init(gfx.Dev())) {
+                DEBUGLOG_WARNING("[RenderSystem] パイプライン統計を無効化します");
+                SetPipelineStatisticsEnabled(false);
+                return;
+            }
+            query.Poll(gfx.Ctx());
+            if (query.HasResult()) psInvocations += query.Latest().PSInvocations;
+        }
 
-            indices.push_back(top2);
-    indices.push_back(bot1);
-   indices.push_back(bot2);
-     }
+        const PipelineStatisticsQuery& prepass = pipelineQueries_[PIPELINE_PASS_DEPTH_PREPASS];
+        stats_.psInvocations = psInvocations;
+        stats_.depthPrepassPrimitives = prepass.HasResult() ? prepass.Latest().CPrimitives : 0;
+        const uint64_t pixels = static_cast<uint64_t>(gfx.RenderWidth()) * gfx.RenderHeight();
+        stats_.overdraw = pixels > 0 ? static_cast<float>(static_cast<double>(psInvocations) / static_cast<double>(pixels)) : 0.0f;
+    }
 
-        // キャップの追加は省略（実装を簡略化）
+    /**
+     * @brief 描画キューを即時コンテキストに送信
+     */
+    void SubmitQueueImmediate(GfxDevice& gfx, TextureManager& texMgr) {
+        size_t begin = 0;
+        if (IsConstantBufferRingEnabled() && gfx.Ctx1()) {
+            begin = SubmitQueueWithRing(gfx, texMgr);
+        }
+        for (size_t i = begin; i < queue_.Size(); ++i) {
+            const DrawPacket& packet = queue_.Sorted(i);
 
-        return CreateMeshBuffers(gfx, vertices.data(), vertices.size(), indices.data(), indices.size(), static_cast<int>(MeshType::Cylinder));
+            UpdateVSConstants(immediate_, DirectX::XMLoadFloat4x4(&packet.world), packet.uvOffset, packet.uvScale);
+            DrawPacketGeometry(immediate_, texMgr, packet);
+        }
     }
 
     /**
-     * @brief 平面メッシュの作成
+     * @brief 描画キューを分割して遅延コンテキストで並列に記録し、順に実行
+     * @return bool 並列記録した場合 true(条件を満たさない場合は何もせず false)
+     *
+     * @details
+     * 各パーティションはソート順で連続した範囲なので、コマンドリストを順に実行すれば
+     * 単一スレッド送信と同じ描画順になります。定数は各コンテキストで UpdateSubresource します。
      */
- bool CreatePlaneMesh(GfxDevice& gfx) {
-        const float size = 0.5f;
-
-        Vertex vertices[] = {
-  {{-size, 0, -size}, {0, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
-            {{size, 0, -size}, {1, 1}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
-            {{size, 0, size}, {1, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
-  {{-size, 0, size}, {0, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
-        };
+    bool SubmitQueueDeferred(GfxDevice& gfx, TextureManager& texMgr) {
+        if (!jobs_ || !jobs_->IsRunning()) return false;
+
+        const size_t n = queue_.Size();
+        size_t partitions = std::min<size_t>(jobs_->WorkerCount() + 1, n / MIN_PACKETS_PER_CONTEXT);
+        if (partitions < 2) return false;
+        if (!EnsureDeferredContexts(gfx, partitions)) return false;
+
+        const size_t perPartition = (n + partitions - 1) / partitions;
+        jobs_->ParallelFor(partitions, 1, [&](size_t first, size_t last) {
+            for (size_t p = first; p < last; ++p) {
+                size_t begin = p * perPartition;
+                size_t end = std::min(n, begin + perPartition);
+                RecordDeferred(gfx, texMgr, *deferred_[p], begin, end);
+            }
+        });
 
-      uint16_t indices[] = {0, 1, 2, 0, 2, 3};
+        for (size_t p = 0; p < partitions; ++p) {
+            DeferredSlot& slot = *deferred_[p];
+            if (!slot.commands) continue;
+            gfx.Ctx()->ExecuteCommandList(slot.commands.Get(), TRUE);
+            slot.commands.Reset();
 
-  return CreateMeshBuffers(gfx, vertices, 4, indices, 6, static_cast<int>(MeshType::Plane));
+            stats_.AddRecorded(slot.stats);
+            stats_.commandLists++;
+        }
+        return true;
     }
 
     /**
-     * @brief メッシュバッファの作成
+     * @brief 遅延コンテキストを count 個まで用意
      */
-    bool CreateMeshBuffers(GfxDevice& gfx, const Vertex* vertices, size_t vertexCount, const uint16_t* indices, size_t indexCount, int meshTypeKey) {
-        auto meshData = std::make_unique<MeshData>();
+    bool EnsureDeferredContexts(GfxDevice& gfx, size_t count) {
+        while (deferred_.size() < count) {
+            auto slot = std::make_unique<DeferredSlot>();
+            if (!gfx.CreateDeferredContext(slot->ctx)) {
+                DEBUGLOG_WARNING("[RenderSystem] 遅延コンテキストを作成できないため並列記録を無効化します");
+                deferredEnabled_ = false;
+                return false;
+            }
+            deferred_.push_back(std::move(slot));
+        }
+        return true;
+    }
 
-        // 頂点バッファの作成
-        D3D11_BUFFER_DESC vbd{};
-        vbd.Usage = D3D11_USAGE_IMMUTABLE;
-        vbd.ByteWidth = static_cast<UINT>(vertexCount * sizeof(Vertex));
-        vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        vbd.CPUAccessFlags = 0;
-vbd.MiscFlags = 0;
-        vbd.StructureByteStride = 0;
+    /**
+     * @brief ソート済みキューの [begin, end) を遅延コンテキストに記録(ワーカースレッドから呼ばれる)
+     */
+    void RecordDeferred(GfxDevice& gfx, TextureManager& texMgr, DeferredSlot& slot, size_t begin, size_t end) {
+        slot.stats.Reset();
+
+        DrawContext dc;
+        dc.ctx = slot.ctx.Get();
+        dc.states = &slot.states;
+        dc.stats = &slot.stats;
+
+        // 遅延コンテキストは即時コンテキストの状態を引き継がない
+        slot.states.Attach(dc.ctx);
+        slot.states.ResetStats();
+        gfx.BindBackbuffer(dc.ctx);
+        BindPipelineState(slot.states);
+
+        for (size_t i = begin; i < end; ++i) {
+            const DrawPacket& packet = queue_.Sorted(i);
+            UpdateVSConstants(dc, DirectX::XMLoadFloat4x4(&packet.world), packet.uvOffset, packet.uvScale);
+            DrawPacketGeometry(dc, texMgr, packet);
+        }
 
-        D3D11_SUBRESOURCE_DATA vData{};
-        vData.pSysMem = vertices;
+        slot.stats.pipelineStateCalls = static_cast<size_t>(slot.states.GetStats().issued);
+        slot.stats.pipelineStateCallsSkipped = static_cast<size_t>(slot.states.GetStats().skipped);
 
-        HRESULT hr = gfx.Dev()->CreateBuffer(&vbd, &vData, meshData->vertexBuffer.GetAddressOf());
+        HRESULT hr = dc.ctx->FinishCommandList(FALSE, slot.commands.ReleaseAndGetAddressOf());
         if (FAILED(hr)) {
-            DEBUGLOG_ERROR("[RenderSystem] 頂点バッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-            return false;
+            DEBUGLOG_ERROR("[RenderSystem] コマンドリストの記録失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            slot.commands.Reset();
         }
+    }
 
-        // インデックスバッファの作成
-        D3D11_BUFFER_DESC ibd{};
-ibd.Usage = D3D11_USAGE_IMMUTABLE;
-        ibd.ByteWidth = static_cast<UINT>(indexCount * sizeof(uint16_t));
-        ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        ibd.CPUAccessFlags = 0;
-        ibd.MiscFlags = 0;
-        ibd.StructureByteStride = 0;
+    /**
+     * @brief 比較計測の集計(両方式の平均をログに出力して終了)
+     */
+    void UpdateSubmitBenchmark() {
+        int mode = deferredEnabled_ && stats_.commandLists > 0 ? 1 : 0;
+        benchmark_.totalMs[mode] += stats_.submitMs;
+        benchmark_.frames[mode]++;
 
-        D3D11_SUBRESOURCE_DATA iData{};
-    iData.pSysMem = indices;
+        if (--benchmark_.framesLeft > 0) return;
 
-     hr = gfx.Dev()->CreateBuffer(&ibd, &iData, meshData->indexBuffer.GetAddressOf());
-     if (FAILED(hr)) {
-            DEBUGLOG_ERROR("[RenderSystem] インデックスバッファの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
-   return false;
+        deferredEnabled_ = benchmark_.restoreDeferred;
+        auto average = [this](int m) {
+            return benchmark_.frames[m] > 0 ? benchmark_.totalMs[m] / benchmark_.frames[m] : 0.0;
+        };
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics,
+            "[RenderSystem] 送信時間の比較: 単一スレッド=" + std::to_string(average(0)) + "ms (" + std::to_string(benchmark_.frames[0]) +
+            "フレーム), 並列記録=" + std::to_string(average(1)) + "ms (" + std::to_string(benchmark_.frames[1]) + "フレーム)");
+        if (benchmark_.frames[1] == 0) {
+            DEBUGLOG_WARNING("[RenderSystem] 並列記録が一度も行われませんでした(ジョブシステム未設定、またはパケット数が少ない)");
         }
+    }
 
-        meshData->indexCount = static_cast<UINT>(indexCount);
-        meshCache_[meshTypeKey] = std::move(meshData);
+    /**
+     * @brief 定数バッファのリングを使って描画キューを送信
+     * @return size_t 送信したパケット数(Map に失敗した場合は残りを呼び出し側が通常の経路で送信)
+     *
+     * @details
+     * パケットごとに VS定数の領域を確保し、まとめて書き込んでから VSSetConstantBuffers1 のオフセット指定でバインドします。
+     * PS定数はマテリアルの不変のバッファをバインドするだけなので(DrawPacketGeometry)、リングには入れません。
+     */
+    size_t SubmitQueueWithRing(GfxDevice& gfx, TextureManager& texMgr) {
+        const UINT vsSize = ConstantBufferRing::AlignedSize(sizeof(VSConstants));
+        const UINT vsNum = vsSize / 16;
+        ID3D11DeviceContext1* ctx1 = gfx.Ctx1();
+
+        size_t submitted = 0;
+        const size_t n = queue_.Size();
+        while (submitted < n) {
+            ConstantBufferRing::Span span;
+            UINT want = static_cast<UINT>(n - submitted);
+            if (!cbRing_.Map(gfx.Ctx(), want, vsSize, span)) break;
+
+            for (UINT k = 0; k < span.count; ++k) {
+                const DrawPacket& packet = queue_.Sorted(submitted + k);
+                VSConstants vsCbuf = MakeVSConstants(DirectX::XMLoadFloat4x4(&packet.world), packet.uvOffset, packet.uvScale);
+                std::memcpy(span.Element(k), &vsCbuf, sizeof(VSConstants));
+            }
+            cbRing_.Unmap(gfx.Ctx());
+            stats_.constantBufferBytes += static_cast<size_t>(span.count) * sizeof(VSConstants);
+
+            for (UINT k = 0; k < span.count; ++k) {
+                const DrawPacket& packet = queue_.Sorted(submitted + k);
+                UINT vsFirst = span.FirstConstant(k);
+                ctx1->VSSetConstantBuffers1(0, 1, cbRing_.BufferAddress(), &vsFirst, &vsNum);
+                DrawPacketGeometry(immediate_, texMgr, packet);
+            }
+            submitted += span.count;
+        }
 
- return true;
+        // 以降の描画用に通常の定数バッファへ戻す(オフセット付きで設定したスロットはキャッシュと一致しない)
+        gfx.States().ForgetVSConstantBuffer(0);
+        gfx.States().SetVSConstantBuffer(0, vsCb_.Get());
+        return submitted;
     }
 
     /**
-   * @brief パイプラインの設定
+     * @brief VS定数設定済みのパケットのマテリアル・テクスチャ・メッシュを設定して描画
      */
-    void SetupPipeline(GfxDevice& gfx) {
-        gfx.Ctx()->IASetInputLayout(layout_.Get());
-        gfx.Ctx()->VSSetShader(vs_.Get(), nullptr, 0);
-        gfx.Ctx()->PSSetShader(ps_.Get(), nullptr, 0);
-        gfx.Ctx()->VSSetConstantBuffers(0, 1, vsCb_.GetAddressOf());
-        gfx.Ctx()->PSSetConstantBuffers(0, 1, psCb_.GetAddressOf());
-        gfx.Ctx()->PSSetConstantBuffers(1, 1, psLightCb_.GetAddressOf());
-        gfx.Ctx()->PSSetSamplers(0, 1, samplerState_.GetAddressOf());
-  gfx.Ctx()->RSSetState(rasterState_.Get());
-        gfx.Ctx()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    void DrawPacketGeometry(DrawContext& dc, TextureManager& texMgr, const DrawPacket& packet) {
+        BindPixelShader(dc, PixelShaderFor(ShaderFeatures(packet.texture, packet.normalTexture), false));
+        BindMaterial(dc, packet.materialBuffer);
+        SetTextures(dc, texMgr, packet.texture, packet.normalTexture);
+        BindMesh(dc, packet.vertexBuffer, packet.indexBuffer, packet.indexFormat, packet.vertexFormat, packet.skinBuffer);
+        BindBoneOffset(dc, packet);
+        dc.ctx->DrawIndexed(packet.indexCount, packet.startIndex, packet.baseVertex);
+
+        if (packet.isModel) {
+            dc.stats->modelsRendered++;
+        } else {
+            dc.stats->meshesRendered++;
+        }
+        dc.stats->totalDrawCalls++;
+        dc.stats->trianglesRendered += packet.indexCount / 3;
     }
 
     /**
-* @brief ライト定数の更新
+     * @brief 頂点・インデックスバッファの設定(直前と同じなら省略)
+     *
+     * @details
+     * 共有メッシュバッファのメッシュは同じバッファを指すため、メッシュが替わっても設定し直しません。
+     * 頂点形式が替わった場合は頂点シェーダーと入力レイアウトも切り替えます(BindVertexFormat)。
+     * skinBuffer を指定した場合はスキニングの影響をスロット1に設定します(標準の頂点形式のみ)。
      */
-    void UpdateLightConstants(World& w, const Camera& cam, GfxDevice& gfx) {
-      PSLightConstants lightCbuf;
-        lightCbuf.eyePos = cam.position;
+    void BindMesh(DrawContext& dc, ID3D11Buffer* vertexBuffer, ID3D11Buffer* indexBuffer, DXGI_FORMAT indexFormat,
+                  VertexFormat vertexFormat = VertexFormat::Standard, ID3D11Buffer* skinBuffer = nullptr) {
+        BindVertexFormat(dc, vertexFormat, skinBuffer != nullptr);
+        if (skinBuffer && dc.bound.skinBuffer != skinBuffer) {
+            UINT skinStride = sizeof(SkinInfluence);
+            UINT skinOffset = 0;
+            dc.ctx->IASetVertexBuffers(1, 1, &skinBuffer, &skinStride, &skinOffset);
+            dc.bound.skinBuffer = skinBuffer;
+            dc.stats->CountStateChange(Statistics::STATE_SKIN);
+        }
+        if (dc.bound.vertexBuffer == vertexBuffer && dc.bound.indexBuffer == indexBuffer && dc.bound.indexFormat == indexFormat) {
+            dc.stats->stateChangesSkipped++;
+            return;
+        }
+        UINT stride = VertexStride(vertexFormat);
+        UINT offset = 0;
+        dc.ctx->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+        dc.ctx->IASetIndexBuffer(indexBuffer, indexFormat, 0);
+        dc.bound.vertexBuffer = vertexBuffer;
+        dc.bound.indexBuffer = indexBuffer;
+        dc.bound.indexFormat = indexFormat;
+        dc.stats->CountStateChange(Statistics::STATE_MESH);
+    }
 
-        w.ForEach<DirectionalLight>([&](Entity e, DirectionalLight& l) {
-            lightCbuf.light = l;
-        });
+    /**
+     * @brief スキニングされたパケットのスキニング行列の先頭を VS の b1 に設定(直前と同じなら省略)
+     */
+    void BindBoneOffset(DrawContext& dc, const DrawPacket& packet) {
+        if (!packet.skinBuffer || dc.bound.boneOffset == packet.boneOffset) return;
+        VSSkinConstants skinCbuf{};
+        skinCbuf.boneOffset = packet.boneOffset;
+        dc.ctx->UpdateSubresource(skinCb_.Get(), 0, nullptr, &skinCbuf, 0, 0);
+        dc.bound.boneOffset = packet.boneOffset;
+        dc.stats->constantBufferBytes += sizeof(VSSkinConstants);
+    }
 
-        gfx.Ctx()->UpdateSubresource(psLightCb_.Get(), 0, nullptr, &lightCbuf, 0, 0);
+    /**
+     * @brief 頂点形式に合う頂点シェーダーと入力レイアウトの設定(直前と同じなら何もしない)
+     *
+     * @details
+     * 頂点形式ごとに頂点バッファは別なので(MeshPool も形式ごと)、形式が替わると BindMesh() は必ずバッファも設定し直します。
+     * スキニングに切り替える場合はスキニング行列(VS の t0)と VSSkinConstants(VS の b1)も設定します
+     * (インスタンス描画が同じスロットを使うため、切り替えるたびに設定し直す)。
+     */
+    void BindVertexFormat(DrawContext& dc, VertexFormat vertexFormat, bool skinned = false) {
+        if (dc.bound.vertexFormat == vertexFormat && dc.bound.skinned == skinned) return;
+        if (skinned) {
+            dc.states->SetVertexShader(vsSkinned_.Get());
+            dc.states->SetInputLayout(layoutSkinned_.Get());
+            dc.ctx->VSSetShaderResources(0, 1, skinSrv_.GetAddressOf());
+            dc.states->SetVSConstantBuffer(1, skinCb_.Get());
+            dc.bound.boneOffset = UINT_MAX;
+        } else {
+            const bool compact = vertexFormat != VertexFormat::Standard;
+            dc.states->SetVertexShader(compact ? vsCompact_.Get() : vs_.Get());
+            dc.states->SetInputLayout(vertexFormat == VertexFormat::Compact ? layoutCompact_.Get()
+                                      : vertexFormat == VertexFormat::CompactQuantized ? layoutQuantized_.Get() : layout_.Get());
+        }
+        dc.bound.vertexFormat = vertexFormat;
+        dc.bound.skinned = skinned;
+        dc.stats->CountStateChange(Statistics::STATE_VERTEX_FORMAT);
     }
 
     /**
-     * @brief ModelComponentの描画
+     * @brief MeshRendererのインスタンス描画
+     * @return bool 描画した場合 true(インスタンスバッファを用意できなければ false)
+     *
+     * @details
+     * (メッシュ種別, テクスチャ) ごとにまとめ、1グループ1回の DrawIndexedInstanced で描画します。
+     * 共有テクスチャ配列(TextureManager::SetArrayPoolingEnabled)に入っているテクスチャは
+     * (メッシュ種別, 配列) でまとめ、スライスをインスタンスデータで渡します。
+     * 全インスタンスのワールド行列・色・UV変換は1つの構造化バッファに1回の Map で書き込みます。
+     * 視錐台の外にあるインスタンスはソート前に取り除きます。
+     * GPUカリングが有効な場合は取り除かずに GpuCulling で判定し、バッチごとに DrawIndexedInstancedIndirect で描画します。
+     * RenderModelComponents() が集めた ModelComponent も (メッシュのバッファと範囲, テクスチャ) ごとに同じバッファでまとめます。
      */
-    void RenderModelComponents(World& w, GfxDevice& gfx, const Camera& cam, TextureManager& texMgr) {
-        w.ForEach<ModelComponent>([&](Entity e, ModelComponent& mc) {
-    auto* t = w.TryGet<Transform>(e);
-       if (!t) return;
-    if (!mc.vertexBuffer || !mc.indexBuffer) return;
+    bool RenderMeshRenderersInstanced(const RenderProxyList& meshes, const RenderProxyList& models, GfxDevice& gfx, const Camera& cam, TextureManager& texMgr) {
+        instanceScratch_.clear();
+        instanceKeys_.clear();
+        instanceCull_.Clear();
+
+        int lodMeshType = -1;
+        uint8_t lodCount = 0;
+        TextureManager::TextureHandle slotTexture = TextureManager::INVALID_TEXTURE;
+        uint32_t slotKey = 0, slotSlice = 0;
+        // テクスチャ(共有配列にあれば配列単位でまとめる。直前の検索結果を再利用)
+        auto resolveTextureSlot = [&](TextureManager::TextureHandle texture) {
+            if (texture != slotTexture || slotKey == 0) {
+                slotTexture = texture;
+                TextureManager::TextureArraySlot slot;
+                if (texMgr.GetArraySlot(texture, slot)) {
+                    slotKey = POOLED_TEXTURE_BIT | slot.pool;
+                    slotSlice = slot.slice;
+                } else {
+                    slotKey = texture;
+                    slotSlice = 0;
+                }
+            }
+        };
+        for (size_t i = 0; i < meshes.Size(); ++i) {
+            if (CullTreeRejects(CULL_TREE_MESHES, i)) continue;
+            if (materials_->IsTransparent(meshes.materials[i])) {
+                // 半透明は奥から手前の順が必要なのでインスタンス描画にはまとめない
+                QueueMeshPacket(meshes, i, cam, texMgr);
+                continue;
+            }
+            const MeshType meshType = static_cast<MeshType>(meshes.meshes[i]);
+            const TextureManager::TextureHandle texture = meshes.textures[i];
+            InstanceData data;
+            DirectX::XMStoreFloat4x4(&data.world, DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&meshes.worlds[i])));
+            data.color = DirectX::XMFLOAT4{ meshes.colors[i].x, meshes.colors[i].y, meshes.colors[i].z, 1.0f };
+            data.uvTransform = meshes.uvTransforms[i];
+
+            resolveTextureSlot(texture);
+            data.textureSlice = slotSlice;
+            data.padding[0] = data.padding[1] = data.padding[2] = 0;
+
+            // LOD(境界球は抽出時に変換済み。同じメッシュ種別が続くことが多いので直前の検索結果を再利用)
+            if (static_cast<int>(meshType) != lodMeshType) {
+                lodMeshType = static_cast<int>(meshType);
+                auto it = meshCache_.find(MeshKey(meshType, 0));
+                lodCount = it != meshCache_.end() && it->second ? it->second->lodCount : 0;
+            }
+            uint8_t lod = 0;
+            DirectX::XMFLOAT3 center = meshes.BoundsCenter(i);
+            float radius = meshes.BoundsRadius(i);
+            instanceCull_.Add(center, radius);
+            if (lodCount > 0) {
+                float size = MeshLod::ProjectedSize(center, radius, cam);
+                lod = SelectLod(meshLods_, meshes.entities[i], size);
+                RequestTextureDetail(texMgr, texture, size);
+                if (lod >= lodCount) lod = static_cast<uint8_t>(lodCount - 1);
+            }
 
-     // ワールド行列の計算
-          DirectX::XMMATRIX worldMatrix = CalculateWorldMatrix(*t);
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(MeshKey(meshType, lod))) << 32) | static_cast<uint64_t>(slotKey);
+            instanceKeys_.push_back(InstanceKey{ key, static_cast<uint32_t>(instanceScratch_.size()) });
+            instanceScratch_.push_back(data);
+        }
+
+        // ModelComponent: 同じ頂点バッファと範囲のメッシュを1つのバッチにする(LOD は RenderModelComponents() で選択済み)
+        modelInstanceMeshes_.clear();
+        modelInstanceSlots_.clear();
+        ID3D11Buffer* lastBuffer = nullptr;
+        UINT lastStart = 0;
+        uint32_t lastMesh = 0;
+        for (const ModelInstanceProxy& proxy : modelInstanceProxies_) {
+            const size_t i = proxy.proxy;
+            if (proxy.mesh.vertexBuffer != lastBuffer || proxy.mesh.startIndex != lastStart || modelInstanceMeshes_.empty()) {
+                const uint64_t meshId = (static_cast<uint64_t>(MeshSortId(proxy.mesh.vertexBuffer)) << 32) | proxy.mesh.startIndex;
+                auto inserted = modelInstanceSlots_.emplace(meshId, static_cast<uint32_t>(modelInstanceMeshes_.size()));
+                if (inserted.second) modelInstanceMeshes_.push_back(proxy.mesh);
+                lastBuffer = proxy.mesh.vertexBuffer;
+                lastStart = proxy.mesh.startIndex;
+                lastMesh = inserted.first->second;
+            }
+
+            InstanceData data;
+            DirectX::XMStoreFloat4x4(&data.world, DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&models.worlds[i])));
+            data.color = DirectX::XMFLOAT4{ models.colors[i].x, models.colors[i].y, models.colors[i].z, 1.0f };
+            data.uvTransform = models.uvTransforms[i];
+            resolveTextureSlot(models.textures[i]);
+            data.textureSlice = slotSlice;
+            data.padding[0] = data.padding[1] = data.padding[2] = 0;
+            instanceCull_.Add(models.BoundsCenter(i), models.BoundsRadius(i));
+
+            uint64_t key = (static_cast<uint64_t>(MODEL_INSTANCE_BIT | lastMesh) << 32) | static_cast<uint64_t>(slotKey);
+            instanceKeys_.push_back(InstanceKey{ key, static_cast<uint32_t>(instanceScratch_.size()) });
+            instanceScratch_.push_back(data);
+        }
 
-            // 定数バッファの更新
-   UpdateVSConstants(gfx, worldMatrix, cam, mc.uvOffset, mc.uvScale);
-            UpdatePSConstants(gfx, mc.color, mc.texture, mc.normalTexture, 32.0f);
+        size_t culled = 0;
+        bool gpuCulling = cullingEnabled_ && IsGpuCullingEnabled() && !instanceKeys_.empty();
+        if (cullingEnabled_ && !gpuCulling && !instanceKeys_.empty()) {
+            size_t visible = instanceCull_.Run(frustum_, jobs_);
+            size_t occluded = occlusionActive_ ? occlusion_.Cull(instanceCull_, jobs_) : 0;
+            // 可視のキーを順番を保って詰める(件数が多ければ並列)
+            instanceKeysVisible_.resize(instanceKeys_.size());
+            size_t write = parallel::Compact(jobs_, instanceKeys_.size(), 0,
+                [this](size_t i) { return instanceCull_.Visible(instanceKeys_[i].index); },
+                [this](size_t i, size_t dst) { instanceKeysVisible_[dst] = instanceKeys_[i]; });
+            culled = instanceKeys_.size() - visible;
+            stats_.occluded += occluded;
+            instanceKeysVisible_.resize(write);
+            instanceKeys_.swap(instanceKeysVisible_);
+        }
 
-  // テクスチャの設定
-         SetTextures(gfx, texMgr, mc.texture, mc.normalTexture);
+        if (instanceKeys_.empty()) {
+            stats_.culled += culled;
+            return true;
+        }
+        if (!EnsureInstanceCapacity(gfx, instanceKeys_.size())) return false;
 
-// 描画
-   UINT stride = sizeof(Vertex);
-     UINT offset = 0;
-            gfx.Ctx()->IASetVertexBuffers(0, 1, mc.vertexBuffer.GetAddressOf(), &stride, &offset);
-            gfx.Ctx()->IASetIndexBuffer(mc.indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-          gfx.Ctx()->DrawIndexed(mc.indexCount, 0, 0);
+        parallel::Sort(jobs_, instanceKeys_.data(), instanceKeys_.size());
 
-stats_.modelsRendered++;
-      stats_.totalDrawCalls++;
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        HRESULT hr = gfx.Ctx()->Map(instanceBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[RenderSystem] インスタンスバッファのMap失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            return false;
+        }
+        InstanceData* dst = static_cast<InstanceData*>(mapped.pData);
+        parallel::For(jobs_, instanceKeys_.size(), 0, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                dst[i] = instanceScratch_[instanceKeys_[i].index];
+            }
         });
+        gfx.Ctx()->Unmap(instanceBuffer_.Get(), 0);
+
+        // GPUカリング: ソート後の順にバッチとインスタンスを登録して判定(失敗した場合はカリングせずに描画)
+        if (gpuCulling) {
+            gpuCulling_.Begin();
+            size_t begin = 0;
+            while (begin < instanceKeys_.size()) {
+                const uint64_t key = instanceKeys_[begin].key;
+                const RenderProxyMesh mesh = InstanceBatchMesh(static_cast<uint32_t>(key >> 32));
+                const UINT indexCount = mesh.vertexBuffer ? mesh.indexCount : 0;
+                const uint32_t batch = gpuCulling_.AddBatch(indexCount, mesh.startIndex, mesh.baseVertex, static_cast<uint32_t>(begin));
+                for (; begin < instanceKeys_.size() && instanceKeys_[begin].key == key; ++begin) {
+                    gpuCulling_.AddInstance(instanceCull_.Sphere(instanceKeys_[begin].index), batch);
+                }
+            }
+            gpuCulling = gpuCulling_.Dispatch(gfx.Dev(), gfx.Ctx(), frustum_);
+            if (gpuCulling) stats_.gpuCullInstances += instanceKeys_.size();
+        }
+
+        gfx.States().SetVertexShader(gpuCulling ? vsInstancedCulled_.Get() : vsInstanced_.Get());
+        gfx.Ctx()->VSSetShaderResources(0, 1, instanceSrv_.GetAddressOf());
+        if (gpuCulling) gfx.Ctx()->VSSetShaderResources(GpuCulling::VISIBLE_SLOT, 1, gpuCulling_.VisibleSrv());
+        gfx.States().SetVSConstantBuffer(1, batchCb_.Get());
+
+        VSBatchConstants batch{};
+
+        size_t begin = 0;
+        uint32_t batchIndex = 0;
+        while (begin < instanceKeys_.size()) {
+            const uint64_t key = instanceKeys_[begin].key;
+            size_t end = begin + 1;
+            while (end < instanceKeys_.size() && instanceKeys_[end].key == key) ++end;
+            const uint32_t batchArgs = batchIndex++; // GpuCulling の登録と同じ順
+
+            const uint32_t meshKey = static_cast<uint32_t>(key >> 32);
+            const TextureManager::TextureHandle texture = static_cast<TextureManager::TextureHandle>(key & 0xFFFFFFFFull);
+
+            const RenderProxyMesh mesh = InstanceBatchMesh(meshKey);
+            if (!mesh.vertexBuffer) {
+                DEBUGLOG_WARNING("[RenderSystem] MeshType not found: " + std::to_string(meshKey & 0xFF));
+                begin = end;
+                continue;
+            }
+
+            batch.instanceOffset = static_cast<UINT>(begin);
+            gfx.Ctx()->UpdateSubresource(batchCb_.Get(), 0, nullptr, &batch, 0, 0);
+            stats_.constantBufferBytes += sizeof(VSBatchConstants);
+            if (texture & POOLED_TEXTURE_BIT) {
+                BindPixelShader(immediate_, PixelShaderFor(FEATURE_TEXTURE_ARRAY, true));
+                BindMaterial(immediate_, textureArrayMaterialCb_.Get());
+                SetTextures(immediate_, texMgr, TextureManager::INVALID_TEXTURE, TextureManager::INVALID_TEXTURE);
+                ID3D11ShaderResourceView* arraySrv = texMgr.GetArraySRV(texture & ~POOLED_TEXTURE_BIT);
+                gfx.Ctx()->PSSetShaderResources(2, 1, &arraySrv);
+                stats_.textureBinds++;
+            } else {
+                BindPixelShader(immediate_, PixelShaderFor(ShaderFeatures(texture, TextureManager::INVALID_TEXTURE), true));
+                // 色はインスタンスごとなので、マテリアルは白とテクスチャだけ
+                MaterialDesc material;
+                material.texture = texture;
+                BindMaterial(immediate_, materials_->ConstantBuffer(materials_->Resolve(material)));
+                SetTextures(immediate_, texMgr, texture, TextureManager::INVALID_TEXTURE);
+            }
+
+            BindMesh(immediate_, mesh.vertexBuffer, mesh.indexBuffer, mesh.indexFormat);
+            if (gpuCulling) {
+                gfx.Ctx()->DrawIndexedInstancedIndirect(gpuCulling_.ArgsBuffer(), GpuCulling::ArgsOffset(batchArgs));
+                stats_.indirectDraws++;
+            } else {
+                gfx.Ctx()->DrawIndexedInstanced(mesh.indexCount, static_cast<UINT>(end - begin), mesh.startIndex, mesh.baseVertex, 0);
+            }
+
+            if (meshKey & MODEL_INSTANCE_BIT) {
+                stats_.modelsRendered += end - begin;
+            } else {
+                stats_.meshesRendered += end - begin;
+            }
+            stats_.instancesRendered += end - begin;
+            stats_.instancedDraws++;
+            stats_.totalDrawCalls++;
+            stats_.trianglesRendered += static_cast<size_t>(mesh.indexCount / 3) * (end - begin);
+            begin = end;
+        }
+
+        // 通常パイプラインに戻す
+        ID3D11ShaderResourceView* nullSrv = nullptr;
+        gfx.Ctx()->VSSetShaderResources(0, 1, &nullSrv);
+        if (gpuCulling) gfx.Ctx()->VSSetShaderResources(GpuCulling::VISIBLE_SLOT, 1, &nullSrv);
+        gfx.Ctx()->PSSetShaderResources(2, 1, &nullSrv);
+        gfx.States().SetVertexShader(vs_.Get());
+        gfx.States().SetPixelShader(ps_.Get());
+        immediate_.bound.pixelShader = ps_.Get();
+        stats_.culled += culled;
+        return true;
     }
 
     /**
-     * @brief MeshRendererの描画
-   */
-    void RenderMeshRenderers(World& w, GfxDevice& gfx, const Camera& cam, TextureManager& texMgr) {
-        w.ForEach<Transform, MeshRenderer>([&](Entity e, Transform& t, MeshRenderer& mr) {
-          // メッシュデータの取得
-  auto it = meshCache_.find(static_cast<int>(mr.meshType));
-            if (it == meshCache_.end() || !it->second) {
-  DEBUGLOG_WARNING("[RenderSystem] MeshType not found: " + std::to_string(static_cast<int>(mr.meshType)));
-    return;
+     * @brief インスタンスのバッチのメッシュ(InstanceKey の上位32ビットから)
+     */
+    RenderProxyMesh InstanceBatchMesh(uint32_t meshKey) const {
+        if (meshKey & MODEL_INSTANCE_BIT) {
+            const uint32_t slot = meshKey & ~MODEL_INSTANCE_BIT;
+            return slot < modelInstanceMeshes_.size() ? modelInstanceMeshes_[slot] : RenderProxyMesh{};
+        }
+        auto it = meshCache_.find(static_cast<int>(meshKey));
+        return it != meshCache_.end() && it->second ? ResolveMesh(*it->second) : RenderProxyMesh{};
     }
 
-   auto* meshData = it->second.get();
-        if (!meshData->vertexBuffer || !meshData->indexBuffer) return;
-
-      // ワールド行列の計算
-     DirectX::XMMATRIX worldMatrix = CalculateWorldMatrix(t);
-
-  // 定数バッファの更新
-     UpdateVSConstants(gfx, worldMatrix, cam, mr.uvOffset, mr.uvScale);
-UpdatePSConstants(gfx, mr.color, mr.texture, TextureManager::INVALID_TEXTURE, 32.0f);
+    /**
+     * @brief ローカル境界球をワールド空間に変換してカリングリストに追加
+     * @param[out] center ワールド空間の中心(LOD選択用)
+     * @return float ワールド空間の半径
+     */
+    static float AddBounds(SphereCullList& list, const DirectX::XMMATRIX& worldMatrix, const DirectX::XMFLOAT3& localCenter, float localRadius, DirectX::XMFLOAT3& center) {
+        float radius = TransformBoundingSphere(worldMatrix, localCenter, localRadius, center);
+        list.Add(center, radius);
+        return radius;
+    }
 
-            // テクスチャの設定
-   SetTextures(gfx, texMgr, mr.texture, TextureManager::INVALID_TEXTURE);
+    /**
+     * @brief 描画に使用するワールド行列を取得
+     *
+     * @details
+     * LocalToWorld がある場合はキャッシュ済みの行列(親子階層を反映済み)を使用し、
+     * ない場合(TransformSystem 未登録、または生成直後)は Transform から計算します。
+     * interpolate が true の場合、最後の更新で動いたエンティティは SetInterpolation() の割合で
+     * 直前の行列と補間します。
+     */
+    DirectX::XMMATRIX ResolveWorldMatrix(const World& w, Entity e, const Transform& t, bool interpolate = true) const {
+        const LocalToWorld* cache = w.Peek<LocalToWorld>(e);
+        if (cache && cache->valid) {
+            if (interpolate && interpolationAlpha_ < 1.0f && cache->movedStep == interpolationStep_) {
+                return InterpolateWorldMatrix(*cache, interpolationAlpha_);
+            }
+            return DirectX::XMLoadFloat4x4(&cache->matrix);
+        }
+        return CalculateWorldMatrix(t);
+    }
 
- // 描画
-            UINT stride = sizeof(Vertex);
-            UINT offset = 0;
-            gfx.Ctx()->IASetVertexBuffers(0, 1, meshData->vertexBuffer.GetAddressOf(), &stride, &offset);
-        gfx.Ctx()->IASetIndexBuffer(meshData->indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-            gfx.Ctx()->DrawIndexed(meshData->indexCount, 0, 0);
+    /**
+     * @brief 抽出で後回しにした MeshRenderer のワールド行列と境界球をまとめて計算
+     */
+    void ResolvePendingWorlds(RenderProxyList& meshes) {
+        if (pendingWorlds_.empty()) return;
+        pendingMatrices_.resize(pendingWorlds_.size());
+        WorldMatrixBatch::Output batchOut;
+        batchOut.world = pendingMatrices_.data();
+        batchOut.transpose = false; // プロキシは転置前の行列を持つ
+        WorldMatrixBatch::Build(pendingPositions_.data(), pendingRotations_.data(), pendingScales_.data(), pendingWorlds_.size(), batchOut);
+
+        for (size_t i = 0; i < pendingWorlds_.size(); ++i) {
+            const PendingWorld& pending = pendingWorlds_[i];
+            meshes.worlds[pending.proxy] = pendingMatrices_[i];
+            if (!pending.boundsMesh) continue;
+            DirectX::XMFLOAT3 center;
+            const float radius = TransformBoundingSphere(DirectX::XMLoadFloat4x4(&pendingMatrices_[i]),
+                                                         pending.boundsMesh->boundsCenter, pending.boundsMesh->boundsRadius, center);
+            meshes.bounds[pending.proxy] = DirectX::XMFLOAT4{ center.x, center.y, center.z, radius };
+        }
+    }
 
-            stats_.meshesRendered++;
-            stats_.totalDrawCalls++;
-        });
+    /**
+     * @brief 直前の行列と現在の行列の補間(分解できない行列は要素ごとの線形補間)
+     */
+    static DirectX::XMMATRIX InterpolateWorldMatrix(const LocalToWorld& cache, float alpha) {
+        using namespace DirectX;
+        XMMATRIX from = XMLoadFloat4x4(&cache.previous);
+        XMMATRIX to = XMLoadFloat4x4(&cache.matrix);
+        XMVECTOR s0, r0, t0, s1, r1, t1;
+        if (!XMMatrixDecompose(&s0, &r0, &t0, from) || !XMMatrixDecompose(&s1, &r1, &t1, to)) {
+            XMMATRIX blended = from;
+            for (int i = 0; i < 4; ++i) blended.r[i] = XMVectorLerp(from.r[i], to.r[i], alpha);
+            return blended;
+        }
+        return XMMatrixAffineTransformation(
+            XMVectorLerp(s0, s1, alpha), XMVectorZero(),
+            XMQuaternionSlerp(r0, r1, alpha), XMVectorLerp(t0, t1, alpha));
     }
 
     /**
-     * @brief ワールド行列の計算
+     * @brief ワールド行列の計算(1つずつ。多数の MeshRenderer は ResolvePendingWorlds で WorldMatrixBatch を使う)
      */
     DirectX::XMMATRIX CalculateWorldMatrix(const Transform& t) const {
-        DirectX::XMMATRIX S = DirectX::XMMatrixScaling(t.scale.x, t.scale.y, t.scale.z);
-        DirectX::XMMATRIX R = DirectX::XMMatrixRotationRollPitchYaw(
-            DirectX::XMConvertToRadians(t.rotation.x),
-            DirectX::XMConvertToRadians(t.rotation.y),
- DirectX::XMConvertToRadians(t.rotation.z));
-  DirectX::XMMATRIX T = DirectX::XMMatrixTranslation(t.position.x, t.position.y, t.position.z);
+        return t.ToMatrix();
+    }
 
-        return S * R * T;
+    /**
+     * @brief フレームの定数(カメラ・画面)を、前のフレームから変わった場合だけ送る(全パス・遅延コンテキストが共有)
+     */
+    void UpdateFrameConstants(GfxDevice& gfx, const Camera& cam) {
+        FrameConstants frame;
+        frame.viewProj = DirectX::XMMatrixTranspose(cam.ViewProj);
+        frame.eyePos = cam.position;
+        frame.screenSize = DirectX::XMFLOAT2{ static_cast<float>(gfx.RenderWidth()), static_cast<float>(gfx.RenderHeight()) };
+        frame.clusterNear = cam.nearZ;
+        frame.clusterLogScale = static_cast<float>(LightClusters::DIM_Z) / std::log(cam.farZ / cam.nearZ);
+        if (frameCb_.Upload(gfx.Ctx(), frame)) {
+            stats_.constantBufferBytes += sizeof(FrameConstants);
+        } else {
+            stats_.constantBuffersSkipped++;
+        }
     }
 
     /**
      * @brief VS定数バッファの更新
      */
-    void UpdateVSConstants(GfxDevice& gfx, const DirectX::XMMATRIX& worldMatrix, const Camera& cam, const DirectX::XMFLOAT2& uvOffset, const DirectX::XMFLOAT2& uvScale) {
+    void UpdateVSConstants(DrawContext& dc, const DirectX::XMMATRIX& worldMatrix, const DirectX::XMFLOAT2& uvOffset, const DirectX::XMFLOAT2& uvScale) {
+        VSConstants vsCbuf = MakeVSConstants(worldMatrix, uvOffset, uvScale);
+        dc.ctx->UpdateSubresource(vsCb_.Get(), 0, nullptr, &vsCbuf, 0, 0);
+        dc.stats->constantBufferBytes += sizeof(VSConstants);
+    }
+
+    /**
+     * @brief VS定数の作成(ワールド行列とUV変換だけ。ビュー・プロジェクションとの積はシェーダーで計算)
+     */
+    static VSConstants MakeVSConstants(const DirectX::XMMATRIX& worldMatrix, const DirectX::XMFLOAT2& uvOffset, const DirectX::XMFLOAT2& uvScale) {
       VSConstants vsCbuf;
         vsCbuf.World = DirectX::XMMatrixTranspose(worldMatrix);
-    vsCbuf.WVP = DirectX::XMMatrixTranspose(worldMatrix * cam.View * cam.Proj);
      vsCbuf.uvTransform = DirectX::XMFLOAT4{uvOffset.x, uvOffset.y, uvScale.x, uvScale.y};
-
-        gfx.Ctx()->UpdateSubresource(vsCb_.Get(), 0, nullptr, &vsCbuf, 0, 0);
+        return vsCbuf;
     }
 
     /**
-     * @brief PS定数バッファの更新
+     * @brief マテリアルの定数バッファを PS の b0 に設定(直前と同じなら省略)
      */
-    void UpdatePSConstants(GfxDevice& gfx, const DirectX::XMFLOAT3& color, TextureManager::TextureHandle texture, TextureManager::TextureHandle normalTexture, float specularPower) {
-        PSConstants psCbuf;
-   psCbuf.color = DirectX::XMFLOAT4{color.x, color.y, color.z, 1.0f};
-      psCbuf.useTexture = (texture != TextureManager::INVALID_TEXTURE) ? 1.0f : 0.0f;
-    psCbuf.useNormalMap = (normalTexture != TextureManager::INVALID_TEXTURE) ? 1.0f : 0.0f;
-        psCbuf.specularPower = specularPower;
-
-        gfx.Ctx()->UpdateSubresource(psCb_.Get(), 0, nullptr, &psCbuf, 0, 0);
+    void BindMaterial(DrawContext& dc, ID3D11Buffer* material) {
+        if (dc.bound.material == material) {
+            dc.stats->stateChangesSkipped++;
+            return;
+        }
+        dc.states->SetPSConstantBuffer(0, material);
+        dc.bound.material = material;
+        dc.stats->CountStateChange(Statistics::STATE_MATERIAL);
     }
 
     /**
      * @brief テクスチャの設定
      */
-    void SetTextures(GfxDevice& gfx, TextureManager& texMgr, TextureManager::TextureHandle texture, TextureManager::TextureHandle normalTexture) {
+    void SetTextures(DrawContext& dc, TextureManager& texMgr, TextureManager::TextureHandle texture, TextureManager::TextureHandle normalTexture) {
+        if (dc.bound.texturesValid && dc.bound.texture == texture && dc.bound.normalTexture == normalTexture) {
+            dc.stats->stateChangesSkipped++;
+            return;
+        }
+        dc.bound.texture = texture;
+        dc.bound.normalTexture = normalTexture;
+        dc.bound.texturesValid = true;
+        dc.stats->CountStateChange(Statistics::STATE_TEXTURE);
+
    ID3D11ShaderResourceView* srvs[2] = {nullptr, nullptr};
 
         if (texture != TextureManager::INVALID_TEXTURE) {
@@ -997,6 +5132,7 @@ UpdatePSConstants(gfx, mr.color, mr.texture, TextureManager::INVALID_TEXTURE, 32
     srvs[1] = texMgr.GetSRV(normalTexture);
         }
 
-        gfx.Ctx()->PSSetShaderResources(0, 2, srvs);
+        dc.ctx->PSSetShaderResources(0, 2, srvs);
+        dc.stats->textureBinds += (srvs[0] ? 1 : 0) + (srvs[1] ? 1 : 0);
     }
 };
@@ -0,0 +1,239 @@
+/**
+ * @file ResolutionScaler.h
+ * @brief 縮小した解像度でシーンを描くレンダーターゲットと、バックバッファへの拡大
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * シーンのレンダーターゲットはウィンドウと同じ大きさで1回だけ作成し、縮小する場合は
+ * 左上の一部(描画解像度のビューポート)にだけ描きます。解像度を毎フレーム変えても
+ * テクスチャの作り直しはなく、深度バッファもバックバッファ用のものをそのまま使えます。
+ *
+ * 拡大は全画面の三角形1枚をバイリニアで描くだけです(頂点バッファなし、SV_VertexID から位置とUVを作る)。
+ * UV は描画した範囲の内側半テクセルまでに制限し、範囲外の古い内容がにじまないようにします。
+ * テクスチャは sRGB として読み書きするため、補間は線形空間で行われます。
+ */
+#pragma once
+#include "graphics/PipelineState.h"
+#include "graphics/ShaderCache.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class ResolutionScaler
+ * @brief シーンの縮小レンダーターゲットと拡大のシェーダー
+ *
+ * @par 使用例
+ * @code
+ * scaler.Init(device, width, height);
+ *
+ * // シーンは scaler.Rtv() の左上 renderWidth x renderHeight に描く
+ * scaler.Upscale(gfx.States(), backbufferRtv, renderWidth, renderHeight, width, height);
+ * @endcode
+ */
+class ResolutionScaler {
+public:
+    ResolutionScaler() = default;
+    ResolutionScaler(const ResolutionScaler&) = delete;
+    ResolutionScaler& operator=(const ResolutionScaler&) = delete;
+
+    /**
+     * @brief シェーダー・ステート・シーンのレンダーターゲット(width x height)の作成
+     */
+    bool Init(ID3D11Device* device, uint32_t width, uint32_t height) {
+        Shutdown();
+        const char* VS = R"(
+            struct VSOut {
+                float4 pos : SV_POSITION;
+                float2 uv : TEXCOORD;
+            };
+
+            // 画面を覆う三角形1枚(頂点0が左上、時計回り)
+            VSOut main(uint id : SV_VertexID) {
+                VSOut o;
+                float2 t = float2((id << 1) & 2, id & 2);
+                o.pos = float4(t * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+                o.uv = t;
+                return o;
+            }
+        )";
+        const char* PS = R"(
+            cbuffer Upscale : register(b0) {
+                float2 gUvScale;   // 描画解像度 / テクスチャの大きさ
+                float2 gUvMax;     // 描画した範囲の内側半テクセル
+            };
+            Texture2D gScene : register(t0);
+            SamplerState gSampler : register(s0);
+
+            float4 main(float4 pos : SV_POSITION, float2 uv : TEXCOORD) : SV_Target {
+                return gScene.SampleLevel(gSampler, min(uv * gUvScale, gUvMax), 0);
+            }
+        )";
+
+        UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+        compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
+        HRESULT hr = ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err);
+        if (SUCCEEDED(hr)) {
+            err.Reset();
+            hr = ShaderCache::Compile(PS, nullptr, "main", "ps_5_0", compileFlags, psb, err);
+        }
+        if (FAILED(hr)) {
+            std::string errorMsg = err ? std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::to_string(hr);
+            DEBUGLOG_WARNING("[ResolutionScaler] シェーダーのコンパイル失敗: " + errorMsg);
+            return false;
+        }
+        if (FAILED(device->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs_.GetAddressOf())) ||
+            FAILED(device->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[ResolutionScaler] シェーダーの作成失敗");
+            Shutdown();
+            return false;
+        }
+        PipelineStateDesc pipelineDesc;
+        pipelineDesc.vertexShader = vs_.Get();
+        pipelineDesc.pixelShader = ps_.Get();
+        pipeline_ = PipelineState(pipelineDesc);
+
+        D3D11_BUFFER_DESC cbd{};
+        cbd.Usage = D3D11_USAGE_DEFAULT;
+        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        cbd.ByteWidth = sizeof(UpscaleConstants);
+        D3D11_SAMPLER_DESC sd{};
+        sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        sd.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.MaxLOD = D3D11_FLOAT32_MAX;
+        if (FAILED(device->CreateBuffer(&cbd, nullptr, cb_.GetAddressOf())) ||
+            FAILED(device->CreateSamplerState(&sd, sampler_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[ResolutionScaler] 定数バッファ・サンプラーの作成失敗");
+            Shutdown();
+            return false;
+        }
+
+        // sRGB のバックバッファと同じく、書き込みで sRGB に変換し、読み込みで線形に戻す
+        D3D11_TEXTURE2D_DESC td{};
+        td.Width = width;
+        td.Height = height;
+        td.MipLevels = 1;
+        td.ArraySize = 1;
+        td.Format = DXGI_FORMAT_R8G8B8A8_TYPELESS;
+        td.SampleDesc.Count = 1;
+        td.Usage = D3D11_USAGE_DEFAULT;
+        td.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        hr = device->CreateTexture2D(&td, nullptr, texture_.GetAddressOf());
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[ResolutionScaler] シーンのレンダーターゲットの作成失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+            Shutdown();
+            return false;
+        }
+        D3D11_RENDER_TARGET_VIEW_DESC rtvd{};
+        rtvd.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        rtvd.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvd.Texture2D.MipLevels = 1;
+        if (FAILED(device->CreateRenderTargetView(texture_.Get(), &rtvd, rtv_.GetAddressOf())) ||
+            FAILED(device->CreateShaderResourceView(texture_.Get(), &srvd, srv_.GetAddressOf()))) {
+            DEBUGLOG_WARNING("[ResolutionScaler] シーンのレンダーターゲットのビューの作成失敗");
+            Shutdown();
+            return false;
+        }
+        width_ = width;
+        height_ = height;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "[ResolutionScaler] シーンのレンダーターゲット: " + std::to_string(width) + "x" + std::to_string(height));
+        return true;
+    }
+
+    bool IsReady() const { return rtv_ != nullptr; }
+
+    /**
+     * @brief シーンを描くレンダーターゲット(左上の描画解像度の範囲だけを使う)
+     */
+    ID3D11RenderTargetView* Rtv() const { return rtv_.Get(); }
+
+    /**
+     * @brief シーンの左上 renderWidth x renderHeight を target 全体(targetWidth x targetHeight)に拡大して描く
+     *
+     * @details
+     * レンダーターゲット(深度なし)・ビューポート・シェーダー・入力レイアウト・ブレンド・深度・ラスタライザーを変更します
+     * (ステートは states を通して設定)。
+     * 描画後はシーンのテクスチャをシェーダーから外します(次のフレームでレンダーターゲットに使うため)。
+     */
+    void Upscale(StateCache& states, ID3D11RenderTargetView* target, uint32_t renderWidth, uint32_t renderHeight,
+                 uint32_t targetWidth, uint32_t targetHeight) {
+        if (!IsReady()) return;
+        ID3D11DeviceContext* ctx = states.Context();
+        UpscaleConstants constants;
+        constants.uvScale[0] = static_cast<float>(renderWidth) / static_cast<float>(width_);
+        constants.uvScale[1] = static_cast<float>(renderHeight) / static_cast<float>(height_);
+        constants.uvMax[0] = (static_cast<float>(renderWidth) - 0.5f) / static_cast<float>(width_);
+        constants.uvMax[1] = (static_cast<float>(renderHeight) - 0.5f) / static_cast<float>(height_);
+        ctx->UpdateSubresource(cb_.Get(), 0, nullptr, &constants, 0, 0);
+
+        ctx->OMSetRenderTargets(1, &target, nullptr);
+        D3D11_VIEWPORT vp{};
+        vp.Width = static_cast<FLOAT>(targetWidth);
+        vp.Height = static_cast<FLOAT>(targetHeight);
+        vp.MaxDepth = 1.0f;
+        ctx->RSSetViewports(1, &vp);
+
+        states.Apply(pipeline_);
+        states.SetPSConstantBuffer(0, cb_.Get());
+        ctx->PSSetShaderResources(0, 1, srv_.GetAddressOf());
+        states.SetPSSampler(0, sampler_.Get());
+        ctx->Draw(3, 0);
+
+        ID3D11ShaderResourceView* nullSrv = nullptr;
+        ctx->PSSetShaderResources(0, 1, &nullSrv);
+    }
+
+    /**
+     * @brief シーンのレンダーターゲットのGPUメモリ(バイト)
+     */
+    size_t GpuMemoryBytes() const {
+        return texture_ ? static_cast<size_t>(width_) * height_ * 4 : 0;
+    }
+
+    void Shutdown() {
+        pipeline_ = PipelineState();
+        vs_.Reset();
+        ps_.Reset();
+        cb_.Reset();
+        sampler_.Reset();
+        texture_.Reset();
+        rtv_.Reset();
+        srv_.Reset();
+        width_ = 0;
+        height_ = 0;
+    }
+
+private:
+    /**
+     * @struct UpscaleConstants
+     * @brief ピクセルシェーダーの Upscale(b0)
+     */
+    struct UpscaleConstants {
+        float uvScale[2] = { 1.0f, 1.0f };
+        float uvMax[2] = { 1.0f, 1.0f };
+    };
+
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;
+    PipelineState pipeline_;                                   ///< 全画面三角形(入力レイアウトなし、既定の固定機能ステート)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> cb_;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler_;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> texture_;          ///< シーン(R8G8B8A8、sRGB のビュー)
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv_;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv_;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+};
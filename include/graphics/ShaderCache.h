@@ -0,0 +1,165 @@
+/**
+ * @file ShaderCache.h
+ * @brief コンパイル済みシェーダーのディスクキャッシュ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 埋め込みのHLSLを D3DCompile した結果を ShaderCache/<キー>.cso に保存し、次回以降の起動では
+ * ファイルを読むだけでシェーダーを作成できるようにします。
+ * キーはソース・マクロ・エントリポイント・ターゲット・コンパイルフラグ・D3DCompiler のバージョンの
+ * 64ビットハッシュです。どれかが変わればファイル名が変わるため、古いキャッシュを読むことはありません
+ * (ヘッダーにもキーを記録し、壊れたファイルや途中まで書かれたファイルは無視します)。
+ */
+#pragma once
+#include <Windows.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include "app/DebugLog.h"
+
+/**
+ * @class ShaderCache
+ * @brief D3DCompile をキャッシュ経由で行う
+ *
+ * @par 使用例
+ * @code
+ * Microsoft::WRL::ComPtr<ID3DBlob> vsb, err;
+ * HRESULT hr = ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err);
+ * @endcode
+ */
+class ShaderCache {
+public:
+    static constexpr uint32_t MAGIC = 0x43444853;   ///< 'SHDC'
+    static constexpr uint32_t VERSION = 1;          ///< 形式を変えたら上げる
+
+    /**
+     * @brief キャッシュを置くディレクトリ(作業ディレクトリからの相対パス)
+     */
+    static const char* Directory() { return "ShaderCache"; }
+
+    /**
+     * @brief シェーダーをコンパイル(キャッシュがあればそれを返す)
+     * @param[in] source HLSLソース(終端ヌル)
+     * @param[in] defines マクロ({ nullptr, nullptr } で終わる配列、なしなら nullptr)
+     * @param[in] entry エントリポイント
+     * @param[in] target シェーダーモデル("vs_5_0" など)
+     * @param[in] flags D3DCOMPILE_* フラグ
+     * @param[out] out バイトコード
+     * @param[out] errors コンパイルエラー(キャッシュから読んだ場合と成功時は空)
+     * @return HRESULT D3DCompile の結果(キャッシュから読んだ場合は S_OK)
+     *
+     * @details
+     * キャッシュがない・読めない場合だけ D3DCompile を呼び、成功したら書き出します。
+     * 書き出しの失敗は警告だけで、コンパイル結果はそのまま返します。
+     * 異なるシェーダーであれば複数のスレッドから同時に呼べます(キーごとに別の一時ファイルに書いてから置き換えるため)。
+     */
+    static HRESULT Compile(const char* source, const D3D_SHADER_MACRO* defines, const char* entry, const char* target, UINT flags,
+                           Microsoft::WRL::ComPtr<ID3DBlob>& out, Microsoft::WRL::ComPtr<ID3DBlob>& errors) {
+        out.Reset();
+        errors.Reset();
+        const uint64_t key = Key(source, defines, entry, target, flags);
+        const std::string path = PathFor(key);
+        if (load(path, key, out)) {
+            return S_OK;
+        }
+
+        HRESULT hr = D3DCompile(source, strlen(source), nullptr, defines, nullptr, entry, target, flags, 0, out.GetAddressOf(), errors.GetAddressOf());
+        if (SUCCEEDED(hr)) {
+            store(path, key, out.Get());
+        }
+        return hr;
+    }
+
+    /**
+     * @brief キャッシュのキー(FNV-1a)
+     */
+    static uint64_t Key(const char* source, const D3D_SHADER_MACRO* defines, const char* entry, const char* target, UINT flags) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        hashString(h, source);
+        for (const D3D_SHADER_MACRO* d = defines; d && d->Name; ++d) {
+            hashString(h, d->Name);
+            hashString(h, d->Definition ? d->Definition : "");
+        }
+        hashString(h, entry);
+        hashString(h, target);
+        hashValue(h, flags);
+        hashValue(h, static_cast<uint32_t>(D3D_COMPILER_VERSION));
+        hashValue(h, VERSION);
+        return h;
+    }
+
+    /**
+     * @brief キーに対応するファイルのパス
+     */
+    static std::string PathFor(uint64_t key) {
+        char name[32];
+        sprintf_s(name, "%016llx.cso", static_cast<unsigned long long>(key));
+        return std::string(Directory()) + "/" + name;
+    }
+
+private:
+    struct FileHeader {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint64_t key = 0;
+        uint32_t size = 0;       ///< バイトコードのサイズ
+        uint32_t reserved = 0;
+    };
+
+    static void hashString(uint64_t& h, const char* s) {
+        for (; *s; ++s) h = (h ^ static_cast<uint8_t>(*s)) * 0x100000001b3ull;
+        h = (h ^ 0xff) * 0x100000001b3ull; // 区切り(連結で同じ並びにならないように)
+    }
+
+    static void hashValue(uint64_t& h, uint32_t value) {
+        for (int i = 0; i < 4; ++i) h = (h ^ ((value >> (i * 8)) & 0xff)) * 0x100000001b3ull;
+    }
+
+    // キャッシュを読み込む(ヘッダーが一致しなければ false)
+    static bool load(const std::string& path, uint64_t key, Microsoft::WRL::ComPtr<ID3DBlob>& out) {
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, path.c_str(), "rb") != 0 || !fp) return false;
+
+        FileHeader header;
+        bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+                  header.magic == MAGIC && header.version == VERSION && header.key == key && header.size > 0;
+        if (ok) {
+            ok = SUCCEEDED(D3DCreateBlob(header.size, out.ReleaseAndGetAddressOf())) &&
+                 fread(out->GetBufferPointer(), 1, header.size, fp) == header.size;
+        }
+        fclose(fp);
+        if (!ok) {
+            out.Reset();
+            DEBUGLOG_WARNING("[ShaderCache] キャッシュを読めないため再コンパイルします: " + path);
+        }
+        return ok;
+    }
+
+    // 一時ファイルに書いてから置き換える(途中で終了しても壊れたキャッシュを残さない)
+    static void store(const std::string& path, uint64_t key, ID3DBlob* blob) {
+        CreateDirectoryA(Directory(), nullptr); // 既にある場合は失敗するが問題ない
+
+        const std::string tempPath = path + ".tmp";
+        FILE* fp = nullptr;
+        if (fopen_s(&fp, tempPath.c_str(), "wb") != 0 || !fp) {
+            DEBUGLOG_WARNING("[ShaderCache] 書き出し先を開けません: " + tempPath);
+            return;
+        }
+
+        FileHeader header;
+        header.key = key;
+        header.size = static_cast<uint32_t>(blob->GetBufferSize());
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                  fwrite(blob->GetBufferPointer(), 1, header.size, fp) == header.size;
+        ok = (fclose(fp) == 0) && ok;
+        if (!ok || !MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            DeleteFileA(tempPath.c_str());
+            DEBUGLOG_WARNING("[ShaderCache] 書き出し失敗: " + path);
+        }
+    }
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include "components/ModelComponent.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file SharedModelTable.h
+ * @brief 複数のエンティティで共有するモデルのバッファの表(PackedMeshRenderer から番号で参照)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Register() で ModelComponent を1つ登録すると番号が返り、PackedMeshRenderer::SetModel() でその番号を
+ * 持たせたエンティティは同じ頂点・インデックスバッファ(LOD・スキニングの影響を含む)で描画されます。
+ * エンティティごとに ComPtr を複製しないため、コンポーネントは16バイトのままです。
+ *
+ * 登録は追加だけで、Clear() まで取り消せません(番号は登録順に 0 から)。
+ * 並列シミュレーションでは描画スレッドが読み、メインスレッドが登録するため、
+ * 描画側は Acquire() で登録が増えた時だけ表を写し取ります。
+ */
+
+/**
+ * @class SharedModelTable
+ * @brief 番号で引ける共有の ModelComponent
+ */
+class SharedModelTable {
+public:
+    static constexpr uint16_t MAX_MODELS = 0x7FFF;      ///< PackedMeshRenderer::MODEL_BIT を除いた番号の数
+    static constexpr uint16_t INVALID_ID = 0xFFFF;
+
+    using Entry = std::shared_ptr<const ModelComponent>;
+
+    /**
+     * @brief モデルを登録
+     * @return uint16_t 番号(バッファがない・上限に達した場合 INVALID_ID)
+     */
+    uint16_t Register(const ModelComponent& model) {
+        if (!model.vertexBuffer && !model.pooled) return INVALID_ID;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.size() >= MAX_MODELS) return INVALID_ID;
+        entries_.push_back(std::make_shared<const ModelComponent>(model));
+        ++version_;
+        return static_cast<uint16_t>(entries_.size() - 1);
+    }
+
+    /**
+     * @brief 登録が変わっていれば表を写し取る
+     * @param[in,out] out 写し先
+     * @param[in,out] version 写し取った時点の版(最初は 0)
+     * @return bool 写し取った場合 true
+     */
+    bool Acquire(std::vector<Entry>& out, uint32_t& version) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (version == version_) return false;
+        out = entries_;
+        version = version_;
+        return true;
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    /**
+     * @brief すべての登録を破棄(番号は無効になる)
+     */
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        ++version_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    uint32_t version_ = 1;          ///< 登録のたびに増える(写し先の 0 と区別するため 1 から)
+};
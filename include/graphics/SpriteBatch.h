@@ -0,0 +1,522 @@
+/**
+ * @file SpriteBatch.h
+ * @brief 2Dスプライト・HUDの四角形をまとめて描くスプライトバッチ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Begin() と End() の間に追加した四角形を、layer とテクスチャで並べ替えてから1つの動的インスタンスバッファ(リング)に書き込み、
+ * テクスチャが続く範囲ごとに1回の DrawInstanced で描きます。四角形は頂点バッファを使わず SV_VertexID から作ります。
+ *
+ * - **リング**: インスタンスバッファは RING_CAPACITY 個分で、前回の続きに D3D11_MAP_WRITE_NO_OVERWRITE で追記し、
+ *   末尾に収まらないときだけ D3D11_MAP_WRITE_DISCARD で先頭に戻ります(フレームごとの再確保はありません)。
+ * - **アトラス**: SpriteSheetAnimation のアトラスは uvOffset / uvScale の違いだけなので同じ描画にまとまります。
+ *   TextureManager の共有 Texture2DArray に入ったテクスチャは配列ごとに1つのテクスチャとして扱い、スライスはインスタンスに持たせます。
+ * - **並び順**: layer の小さい順、同じ layer の中はテクスチャごと、同じテクスチャの中は追加順です。
+ *   テクスチャのないスプライトは白テクスチャとして扱うため、単色の四角形(PerfOverlay など)もまとめて描けます。
+ *
+ * 深度テストなし・アルファブレンド・カリングなしで描きます(ステートは GfxDevice::States() を通して設定し、既定には戻しません)。
+ *
+ * @par 使用例
+ * @code
+ * SpriteBatch sprites;
+ * sprites.Init(gfx);
+ *
+ * // フレームの最後(シーンの拡大の後、Present の前)
+ * sprites.Begin(static_cast<float>(gfx.Width()), static_cast<float>(gfx.Height()));
+ * sprites.DrawWorld(world);                              // Sprite コンポーネント
+ * sprites.DrawRect(8, 8, 100, 20, 0x80000000u, 100);     // 単色の四角形(0xAABBGGRR)
+ * sprites.End(gfx, texManager);
+ * @endcode
+ */
+#pragma once
+#include "graphics/GfxDevice.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/TextureManager.h"
+#include "components/Sprite.h"
+#include "ecs/World.h"
+#include "app/DebugLog.h"
+#include "app/MemoryTracker.h"
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+/**
+ * @class SpriteBatch
+ * @brief 画面座標の四角形をテクスチャごとのインスタンス描画にまとめる
+ */
+class SpriteBatch {
+public:
+    static constexpr size_t RING_CAPACITY = 16384;   ///< インスタンスバッファのスプライト数(超える分は先頭に戻って続けて描く)
+    static constexpr int16_t LAYER_OVERLAY = 32767;  ///< 最前面(PerfOverlay の文字とグラフ)
+
+    /**
+     * @struct Statistics
+     * @brief 直前の End() の結果
+     */
+    struct Statistics {
+        size_t sprites = 0;       ///< 描いた四角形
+        size_t draws = 0;         ///< DrawInstanced の回数
+        size_t textureBinds = 0;  ///< テクスチャを設定し直した回数
+        size_t ringWraps = 0;     ///< リングの先頭に戻った回数(D3D11_MAP_WRITE_DISCARD)
+    };
+
+    SpriteBatch() = default;
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    ~SpriteBatch() {
+        Shutdown();
+    }
+
+    /**
+     * @brief シェーダー・ステート・インスタンスバッファを作成
+     * @return bool 成功した場合 true
+     */
+    bool Init(GfxDevice& gfx) {
+        Shutdown();
+        if (!CompileShaders(gfx) || !CreateStates(gfx) || !CreateBuffers(gfx)) {
+            DEBUGLOG_ERROR("[SpriteBatch] 初期化に失敗しました");
+            Shutdown();
+            return false;
+        }
+        entries_.reserve(1024);
+        keys_.reserve(1024);
+        initialized_ = true;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "SpriteBatch::Init() 完了 (リング: " + std::to_string(RING_CAPACITY) + " スプライト)");
+        return true;
+    }
+
+    /**
+     * @brief リソースを解放(冪等)
+     */
+    void Shutdown() {
+        pipeline_ = PipelineState();
+        pipelineArray_ = PipelineState();
+        vs_.Reset();
+        ps_.Reset();
+        psArray_.Reset();
+        layout_.Reset();
+        ring_.Reset();
+        screenCb_.Reset();
+        blend_.Reset();
+        depth_.Reset();
+        raster_.Reset();
+        sampler_.Reset();
+        entries_.clear();
+        ringHead_ = RING_CAPACITY;
+        initialized_ = false;
+    }
+
+    bool IsInitialized() const { return initialized_; }
+
+    /**
+     * @brief 追加を始める(前回の四角形を捨てる)
+     * @param[in] width 描画先の幅(ピクセル)
+     * @param[in] height 描画先の高さ(ピクセル)
+     */
+    void Begin(float width, float height) {
+        entries_.clear();
+        width_ = width > 0.0f ? width : 1.0f;
+        height_ = height > 0.0f ? height : 1.0f;
+    }
+
+    /**
+     * @brief スプライトを1つ追加
+     */
+    void Draw(const Sprite& sprite) {
+        Entry entry;
+        entry.instance.center = sprite.position;
+        entry.instance.halfSize = DirectX::XMFLOAT2{ sprite.size.x * 0.5f, sprite.size.y * 0.5f };
+        if (sprite.rotation != 0.0f) {
+            float s, c;
+            DirectX::XMScalarSinCos(&s, &c, DirectX::XMConvertToRadians(sprite.rotation));
+            entry.instance.rotation = DirectX::XMFLOAT2{ c, s };
+        }
+        entry.instance.uvRect = DirectX::XMFLOAT4{ sprite.uvOffset.x, sprite.uvOffset.y, sprite.uvScale.x, sprite.uvScale.y };
+        entry.instance.color = PackColor(sprite.color);
+        entry.texture = sprite.texture;
+        entry.layer = sprite.layer;
+        entries_.push_back(entry);
+    }
+
+    /**
+     * @brief 単色の四角形を追加(回転なし)
+     * @param[in] x,y 左上(ピクセル)
+     * @param[in] w,h 幅・高さ(ピクセル)
+     * @param[in] color 0xAABBGGRR(DXGI_FORMAT_R8G8B8A8_UNORM の並び)
+     * @param[in] layer 描画の前後(大きいほど手前)
+     */
+    void DrawRect(float x, float y, float w, float h, uint32_t color, int16_t layer) {
+        Entry entry;
+        entry.instance.center = DirectX::XMFLOAT2{ x + w * 0.5f, y + h * 0.5f };
+        entry.instance.halfSize = DirectX::XMFLOAT2{ w * 0.5f, h * 0.5f };
+        entry.instance.color = color;
+        entry.layer = layer;
+        entries_.push_back(entry);
+    }
+
+    /**
+     * @brief World の有効な Sprite をすべて追加
+     */
+    void DrawWorld(World& world) {
+        world.ForEach<Sprite>([this](Entity, Sprite& sprite) { Draw(sprite); });
+    }
+
+    /**
+     * @brief 追加した四角形を並べ替えて描く
+     */
+    void End(GfxDevice& gfx, TextureManager& texMgr) {
+        stats_ = Statistics{};
+        if (!initialized_ || entries_.empty()) return;
+
+        SortEntries(texMgr);
+
+        ID3D11DeviceContext* ctx = gfx.Ctx();
+        StateCache& states = gfx.States();
+        if (screenSize_.x != width_ || screenSize_.y != height_) {
+            screenSize_ = DirectX::XMFLOAT2{ width_, height_ };
+            ScreenConstants constants{ 2.0f / width_, 2.0f / height_, 0.0f, 0.0f };
+            ctx->UpdateSubresource(screenCb_.Get(), 0, nullptr, &constants, 0, 0);
+        }
+        states.Apply(pipeline_);
+        states.SetVSConstantBuffer(0, screenCb_.Get());
+        states.SetPSSampler(0, sampler_.Get());
+        const UINT stride = sizeof(Instance);
+        const UINT offset = 0;
+        ctx->IASetVertexBuffers(0, 1, ring_.GetAddressOf(), &stride, &offset);
+
+        uint32_t boundKey = UINT32_MAX;
+        const size_t n = keys_.size();
+        size_t written = 0;
+        while (written < n) {
+            const size_t chunk = (std::min)(n - written, RING_CAPACITY);
+            D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+            if (ringHead_ + chunk > RING_CAPACITY) {
+                mapType = D3D11_MAP_WRITE_DISCARD;
+                ringHead_ = 0;
+                stats_.ringWraps++;
+            }
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            HRESULT hr = ctx->Map(ring_.Get(), 0, mapType, 0, &mapped);
+            if (FAILED(hr)) {
+                DEBUGLOG_ERROR("[SpriteBatch] インスタンスバッファのマップ失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                ringHead_ = RING_CAPACITY;  // 次は DISCARD から
+                return;
+            }
+            Instance* dst = static_cast<Instance*>(mapped.pData) + ringHead_;
+            for (size_t k = 0; k < chunk; ++k) {
+                dst[k] = entries_[keys_[written + k].index].instance;
+            }
+            ctx->Unmap(ring_.Get(), 0);
+
+            // テクスチャが続く範囲ごとに1回で描く(layer をまたいでも順番はそのまま)
+            size_t run = 0;
+            while (run < chunk) {
+                const uint32_t textureKey = keys_[written + run].textureKey;
+                size_t end = run + 1;
+                while (end < chunk && keys_[written + end].textureKey == textureKey) ++end;
+                if (textureKey != boundKey) {
+                    BindTexture(ctx, states, texMgr, textureKey);
+                    boundKey = textureKey;
+                }
+                ctx->DrawInstanced(4, static_cast<UINT>(end - run), 0, static_cast<UINT>(ringHead_ + run));
+                stats_.draws++;
+                run = end;
+            }
+            ringHead_ += chunk;
+            written += chunk;
+        }
+        stats_.sprites = n;
+    }
+
+    /**
+     * @brief Begin() から追加した四角形の数
+     */
+    size_t PendingCount() const { return entries_.size(); }
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+    /**
+     * @brief インスタンスバッファと定数バッファのサイズ(バイト、MemoryTracker への報告用)
+     */
+    size_t GpuMemoryBytes() const {
+        return GfxDevice::BufferBytes(ring_.Get()) + GfxDevice::BufferBytes(screenCb_.Get());
+    }
+
+private:
+    static constexpr uint32_t POOLED_TEXTURE_BIT = 0x80000000u; ///< textureKey が共有配列のプール番号であることを示す
+
+    /**
+     * @struct Instance
+     * @brief インスタンスバッファの1スプライト(48バイト)
+     */
+    struct Instance {
+        DirectX::XMFLOAT2 center{ 0.0f, 0.0f };              ///< 中心(ピクセル)
+        DirectX::XMFLOAT2 halfSize{ 0.0f, 0.0f };            ///< 幅・高さの半分(ピクセル)
+        DirectX::XMFLOAT2 rotation{ 1.0f, 0.0f };            ///< (cos, sin)
+        DirectX::XMFLOAT4 uvRect{ 0.0f, 0.0f, 1.0f, 1.0f };  ///< UVの左上と幅・高さ
+        uint32_t color = 0xFFFFFFFFu;                        ///< RGBA8
+        uint32_t slice = 0;                                  ///< 共有配列のスライス
+    };
+    static_assert(sizeof(Instance) == 48, "Instance layout must match the input layout");
+
+    struct Entry {
+        Instance instance;
+        TextureManager::TextureHandle texture = TextureManager::INVALID_TEXTURE;
+        int16_t layer = 0;
+    };
+
+    /**
+     * @struct SortKey
+     * @brief 並べ替えのキー(layer・テクスチャ・追加順)
+     */
+    struct SortKey {
+        int16_t layer;
+        uint32_t textureKey;   ///< テクスチャハンドル、または POOLED_TEXTURE_BIT | プール番号
+        uint32_t index;        ///< entries_ の位置
+
+        bool operator<(const SortKey& other) const {
+            if (layer != other.layer) return layer < other.layer;
+            if (textureKey != other.textureKey) return textureKey < other.textureKey;
+            return index < other.index;
+        }
+    };
+
+    struct ScreenConstants {
+        float invHalfWidth;   ///< 2 / 幅
+        float invHalfHeight;  ///< 2 / 高さ
+        float padding[2];
+    };
+
+    static uint32_t PackColor(const DirectX::XMFLOAT4& color) {
+        auto channel = [](float v) {
+            v = (std::min)((std::max)(v, 0.0f), 1.0f);
+            return static_cast<uint32_t>(v * 255.0f + 0.5f);
+        };
+        return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+    }
+
+    /**
+     * @brief テクスチャを解決して keys_ を並べ替える(共有配列のテクスチャはスライスをインスタンスに書く)
+     */
+    void SortEntries(TextureManager& texMgr) {
+        keys_.clear();
+        const TextureManager::TextureHandle white = texMgr.GetDefaultWhite();
+        TextureManager::TextureHandle lastTexture = TextureManager::INVALID_TEXTURE;
+        uint32_t lastKey = white;
+        uint32_t lastSlice = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entries_.size()); ++i) {
+            Entry& entry = entries_[i];
+            const TextureManager::TextureHandle texture = entry.texture != TextureManager::INVALID_TEXTURE ? entry.texture : white;
+            // 同じテクスチャが続くことが多いので直前の検索結果を再利用
+            if (texture != lastTexture) {
+                lastTexture = texture;
+                TextureManager::TextureArraySlot slot;
+                if (texMgr.GetArraySlot(texture, slot)) {
+                    lastKey = POOLED_TEXTURE_BIT | slot.pool;
+                    lastSlice = slot.slice;
+                } else {
+                    lastKey = texture;
+                    lastSlice = 0;
+                }
+            }
+            entry.instance.slice = lastSlice;
+            keys_.push_back(SortKey{ entry.layer, lastKey, i });
+        }
+        std::sort(keys_.begin(), keys_.end());
+    }
+
+    void BindTexture(ID3D11DeviceContext* ctx, StateCache& states, TextureManager& texMgr, uint32_t textureKey) {
+        ID3D11ShaderResourceView* srv = nullptr;
+        if (textureKey & POOLED_TEXTURE_BIT) {
+            states.Apply(pipelineArray_);
+            srv = texMgr.GetArraySRV(textureKey & ~POOLED_TEXTURE_BIT);
+        } else {
+            states.Apply(pipeline_);
+            srv = texMgr.GetSRV(textureKey);
+        }
+        ctx->PSSetShaderResources(0, 1, &srv);
+        stats_.textureBinds++;
+    }
+
+    bool CompileShaders(GfxDevice& gfx) {
+        const char* VS = R"(
+            cbuffer Screen : register(b0) { float2 gInvHalfScreen; float2 gPadding; };
+            struct VSIn {
+                float2 center : CENTER; float2 halfSize : HALFSIZE; float2 rotation : ROTATION;
+                float4 uvRect : UVRECT; float4 col : COLOR; uint slice : SLICE; uint id : SV_VertexID;
+            };
+            struct VSOut { float4 pos : SV_POSITION; float2 uv : TEXCOORD0; float4 col : COLOR; nointerpolation uint slice : SLICE; };
+            VSOut main(VSIn i) {
+                // 三角形ストリップの 0:左上 1:右上 2:左下 3:右下
+                float2 corner = float2(i.id & 1, i.id >> 1);
+                float2 local = (corner * 2.0 - 1.0) * i.halfSize;
+                float2 p = i.center + float2(local.x * i.rotation.x - local.y * i.rotation.y,
+                                             local.x * i.rotation.y + local.y * i.rotation.x);
+                VSOut o;
+                o.pos = float4(p.x * gInvHalfScreen.x - 1.0, 1.0 - p.y * gInvHalfScreen.y, 0, 1);
+                o.uv = i.uvRect.xy + corner * i.uvRect.zw;
+                o.col = i.col;
+                o.slice = i.slice;
+                return o;
+            }
+        )";
+
+        const char* PS = R"(
+            struct VSOut { float4 pos : SV_POSITION; float2 uv : TEXCOORD0; float4 col : COLOR; nointerpolation uint slice : SLICE; };
+            SamplerState gSampler : register(s0);
+        #ifdef TEXTURE_ARRAY
+            Texture2DArray gTexture : register(t0);
+            float4 main(VSOut i) : SV_Target { return gTexture.Sample(gSampler, float3(i.uv, i.slice)) * i.col; }
+        #else
+            Texture2D gTexture : register(t0);
+            float4 main(VSOut i) : SV_Target { return gTexture.Sample(gSampler, i.uv) * i.col; }
+        #endif
+        )";
+
+        UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+        compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+
+        auto errorText = [](const Microsoft::WRL::ComPtr<ID3DBlob>& err) {
+            return err ? ": " + std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::string();
+        };
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, psArrayb, err;
+        HRESULT hr = ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[SpriteBatch] 頂点シェーダーのコンパイル失敗" + errorText(err));
+            return false;
+        }
+        hr = ShaderCache::Compile(PS, nullptr, "main", "ps_5_0", compileFlags, psb, err);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[SpriteBatch] ピクセルシェーダーのコンパイル失敗" + errorText(err));
+            return false;
+        }
+        const D3D_SHADER_MACRO defines[] = { { "TEXTURE_ARRAY", "1" }, { nullptr, nullptr } };
+        hr = ShaderCache::Compile(PS, defines, "main", "ps_5_0", compileFlags, psArrayb, err);
+        if (FAILED(hr)) {
+            DEBUGLOG_ERROR("[SpriteBatch] ピクセルシェーダー(テクスチャ配列)のコンパイル失敗" + errorText(err));
+            return false;
+        }
+
+        if (FAILED(gfx.Dev()->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs_.GetAddressOf())) ||
+            FAILED(gfx.Dev()->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, ps_.GetAddressOf())) ||
+            FAILED(gfx.Dev()->CreatePixelShader(psArrayb->GetBufferPointer(), psArrayb->GetBufferSize(), nullptr, psArray_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[SpriteBatch] シェーダーの作成失敗");
+            return false;
+        }
+
+        D3D11_INPUT_ELEMENT_DESC il[] = {
+            { "CENTER",   0, DXGI_FORMAT_R32G32_FLOAT,       0, 0,                            D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "HALFSIZE", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "ROTATION", 0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "UVRECT",   0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM,     0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "SLICE",    0, DXGI_FORMAT_R32_UINT,           0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        };
+        if (FAILED(gfx.Dev()->CreateInputLayout(il, static_cast<UINT>(std::size(il)), vsb->GetBufferPointer(), vsb->GetBufferSize(),
+                                                layout_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[SpriteBatch] 入力レイアウトの作成失敗");
+            return false;
+        }
+        return true;
+    }
+
+    bool CreateStates(GfxDevice& gfx) {
+        D3D11_BLEND_DESC bd{};
+        bd.RenderTarget[0].BlendEnable = TRUE;
+        bd.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+        bd.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+        bd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+        bd.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+        bd.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+        bd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+        bd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+        if (FAILED(gfx.Dev()->CreateBlendState(&bd, blend_.GetAddressOf()))) return false;
+
+        D3D11_DEPTH_STENCIL_DESC dsd{};
+        dsd.DepthEnable = FALSE;
+        dsd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+        dsd.DepthFunc = D3D11_COMPARISON_ALWAYS;
+        if (FAILED(gfx.Dev()->CreateDepthStencilState(&dsd, depth_.GetAddressOf()))) return false;
+
+        D3D11_RASTERIZER_DESC rsd{};
+        rsd.FillMode = D3D11_FILL_SOLID;
+        rsd.CullMode = D3D11_CULL_NONE;
+        rsd.DepthClipEnable = TRUE;
+        if (FAILED(gfx.Dev()->CreateRasterizerState(&rsd, raster_.GetAddressOf()))) return false;
+
+        D3D11_SAMPLER_DESC sd{};
+        sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        sd.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        sd.MaxLOD = D3D11_FLOAT32_MAX;
+        if (FAILED(gfx.Dev()->CreateSamplerState(&sd, sampler_.GetAddressOf()))) return false;
+
+        PipelineStateDesc desc;
+        desc.vertexShader = vs_.Get();
+        desc.pixelShader = ps_.Get();
+        desc.inputLayout = layout_.Get();
+        desc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+        desc.blendState = blend_.Get();
+        desc.rasterizerState = raster_.Get();
+        desc.depthStencilState = depth_.Get();
+        pipeline_ = PipelineState(desc);
+        desc.pixelShader = psArray_.Get();
+        pipelineArray_ = PipelineState(desc);
+        return true;
+    }
+
+    bool CreateBuffers(GfxDevice& gfx) {
+        D3D11_BUFFER_DESC vbd{};
+        vbd.ByteWidth = static_cast<UINT>(RING_CAPACITY * sizeof(Instance));
+        vbd.Usage = D3D11_USAGE_DYNAMIC;
+        vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        if (FAILED(gfx.Dev()->CreateBuffer(&vbd, nullptr, ring_.GetAddressOf()))) return false;
+
+        D3D11_BUFFER_DESC cbd{};
+        cbd.ByteWidth = sizeof(ScreenConstants);
+        cbd.Usage = D3D11_USAGE_DEFAULT;
+        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        if (FAILED(gfx.Dev()->CreateBuffer(&cbd, nullptr, screenCb_.GetAddressOf()))) return false;
+        screenSize_ = DirectX::XMFLOAT2{ 0.0f, 0.0f };
+        ringHead_ = RING_CAPACITY;  // 最初の書き込みは DISCARD
+        return true;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;          ///< 頂点シェーダー(SV_VertexID とインスタンスから四角形を作る)
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> ps_;           ///< ピクセルシェーダー(Texture2D)
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> psArray_;      ///< ピクセルシェーダー(共有 Texture2DArray)
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> layout_;       ///< インスタンスだけの入力レイアウト
+    Microsoft::WRL::ComPtr<ID3D11Buffer> ring_;              ///< 動的インスタンスバッファ(RING_CAPACITY 個)
+    Microsoft::WRL::ComPtr<ID3D11Buffer> screenCb_;          ///< 画面サイズの定数(VS の b0)
+    Microsoft::WRL::ComPtr<ID3D11BlendState> blend_;         ///< アルファブレンド
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depth_;  ///< 深度テストなし
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> raster_;   ///< カリングなし
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler_;     ///< バイリニア・クランプ
+    PipelineState pipeline_;                                 ///< 上の組み合わせ(三角形ストリップ、Texture2D)
+    PipelineState pipelineArray_;                            ///< pipeline_ のピクセルシェーダーを psArray_ にしたもの
+
+    TrackedVector<Entry, MemoryTag::Render> entries_;        ///< Begin() から追加した四角形
+    std::vector<SortKey> keys_;                              ///< 描く順
+    size_t ringHead_ = RING_CAPACITY;                        ///< リングの次に書き込む位置
+    DirectX::XMFLOAT2 screenSize_{ 0.0f, 0.0f };             ///< screenCb_ に書き込んだ画面サイズ
+    float width_ = 1.0f;                                     ///< 描画先の幅(ピクセル)
+    float height_ = 1.0f;                                    ///< 描画先の高さ(ピクセル)
+    Statistics stats_;
+    bool initialized_ = false;                               ///< Init() 済みか
+};
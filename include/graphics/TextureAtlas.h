@@ -0,0 +1,169 @@
+/**
+ * @file TextureAtlas.h
+ * @brief 複数の画像を1枚のテクスチャにまとめるアトラスパッカー
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * スプライトアニメーションのフレームを1枚のテクスチャに詰め、各フレームをUV矩形で表します。
+ * フレームの切り替えがテクスチャの差し替えではなく MeshRenderer::uvOffset / uvScale の変更になるため、
+ * 表示中のフレームが違うスプライト同士でも同じインスタンス描画にまとまります。
+ */
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @struct AtlasRect
+ * @brief アトラス内の1フレームのUV矩形(MeshRenderer の uvOffset / uvScale にそのまま設定できる)
+ */
+struct AtlasRect {
+    DirectX::XMFLOAT2 uvOffset{ 0.0f, 0.0f }; ///< 左上のUV
+    DirectX::XMFLOAT2 uvScale{ 1.0f, 1.0f };  ///< 幅・高さ(UV)
+};
+
+/**
+ * @struct AtlasImage
+ * @brief パックした結果の画像(RGBA8)
+ */
+struct AtlasImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @class TextureAtlasPacker
+ * @brief シェルフ(棚)方式のアトラスパッカー
+ *
+ * @details
+ * 高さの高い順に左から並べ、幅が足りなくなったら次の段に移ります。
+ * 各フレームの周囲には端のピクセルを複製した余白を付け、バイリニアフィルタやミップで
+ * 隣のフレームが滲まないようにします。アトラスの一辺は2の累乗です。
+ *
+ * @par 使用例
+ * @code
+ * std::vector<TextureAtlasPacker::Source> sources = { { pixels0, 32, 32 }, { pixels1, 32, 32 } };
+ * AtlasImage image;
+ * std::vector<AtlasRect> rects;
+ * if (TextureAtlasPacker::Pack(sources, TextureAtlasPacker::DEFAULT_PADDING, image, rects)) {
+ *     auto atlas = texManager.CreateTextureFromMemory(image.pixels.data(), image.width, image.height, 4);
+ * }
+ * @endcode
+ */
+class TextureAtlasPacker {
+public:
+    static constexpr uint32_t MAX_SIZE = 8192;      ///< アトラスの一辺の上限(ピクセル)
+    static constexpr uint32_t DEFAULT_PADDING = 2;  ///< フレーム周囲の余白(ピクセル)
+
+    /**
+     * @struct Source
+     * @brief パックする画像1枚(RGBA8、行間の詰め物なし)
+     */
+    struct Source {
+        const uint8_t* pixels = nullptr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    /**
+     * @brief 画像をアトラスにまとめる
+     * @param[in] sources 画像(この順序で rects を返す)
+     * @param[in] padding フレーム周囲の余白(ピクセル)
+     * @param[out] out アトラス画像
+     * @param[out] rects 各画像のUV矩形
+     * @return bool MAX_SIZE 以内に収まった場合 true
+     */
+    static bool Pack(const std::vector<Source>& sources, uint32_t padding, AtlasImage& out, std::vector<AtlasRect>& rects) {
+        out = AtlasImage();
+        rects.assign(sources.size(), AtlasRect());
+        if (sources.empty()) return false;
+
+        // 高さの高い順に並べる(同じ高さは元の順序)
+        std::vector<uint32_t> order(sources.size());
+        uint64_t area = 0;
+        uint32_t maxWidth = 0;
+        for (uint32_t i = 0; i < sources.size(); ++i) {
+            order[i] = i;
+            if (!sources[i].pixels || sources[i].width == 0 || sources[i].height == 0) return false;
+            uint64_t w = sources[i].width + padding * 2, h = sources[i].height + padding * 2;
+            area += w * h;
+            maxWidth = (std::max)(maxWidth, static_cast<uint32_t>(w));
+        }
+        std::stable_sort(order.begin(), order.end(), [&sources](uint32_t a, uint32_t b) {
+            return sources[a].height > sources[b].height;
+        });
+
+        // 面積から始めて、入らなければ幅・高さを交互に倍にする
+        uint32_t width = 1, height = 1;
+        while (static_cast<uint64_t>(width) * width < area || width < maxWidth) width *= 2;
+        height = width;
+        std::vector<uint32_t> xs(sources.size()), ys(sources.size());
+        while (!place(sources, order, padding, width, height, xs, ys)) {
+            if (width <= height) width *= 2; else height *= 2;
+            if (width > MAX_SIZE || height > MAX_SIZE) return false;
+        }
+        // 使っていない下側を切り詰める
+        uint32_t usedHeight = 0;
+        for (uint32_t i = 0; i < sources.size(); ++i) {
+            usedHeight = (std::max)(usedHeight, ys[i] + sources[i].height + padding * 2);
+        }
+        while (height / 2 >= usedHeight) height /= 2;
+
+        out.width = width;
+        out.height = height;
+        out.pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+        for (uint32_t i = 0; i < sources.size(); ++i) {
+            const Source& src = sources[i];
+            blit(out, src, xs[i], ys[i], padding);
+            rects[i].uvOffset = DirectX::XMFLOAT2{
+                static_cast<float>(xs[i] + padding) / width,
+                static_cast<float>(ys[i] + padding) / height };
+            rects[i].uvScale = DirectX::XMFLOAT2{
+                static_cast<float>(src.width) / width,
+                static_cast<float>(src.height) / height };
+        }
+        return true;
+    }
+
+private:
+    // シェルフ方式で配置(入りきらなければ false)
+    static bool place(const std::vector<Source>& sources, const std::vector<uint32_t>& order, uint32_t padding,
+        uint32_t width, uint32_t height, std::vector<uint32_t>& xs, std::vector<uint32_t>& ys) {
+        uint32_t x = 0, y = 0, shelfHeight = 0;
+        for (uint32_t i : order) {
+            uint32_t w = sources[i].width + padding * 2;
+            uint32_t h = sources[i].height + padding * 2;
+            if (x + w > width) {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (w > width || y + h > height) return false;
+            xs[i] = x;
+            ys[i] = y;
+            x += w;
+            shelfHeight = (std::max)(shelfHeight, h);
+        }
+        return true;
+    }
+
+    // 余白に端のピクセルを複製しながらコピー
+    static void blit(AtlasImage& out, const Source& src, uint32_t x0, uint32_t y0, uint32_t padding) {
+        const uint32_t w = src.width + padding * 2;
+        const uint32_t h = src.height + padding * 2;
+        for (uint32_t y = 0; y < h; ++y) {
+            uint32_t sy = y < padding ? 0 : (std::min)(y - padding, src.height - 1);
+            uint8_t* dstRow = &out.pixels[(static_cast<size_t>(y0 + y) * out.width + x0) * 4];
+            const uint8_t* srcRow = src.pixels + static_cast<size_t>(sy) * src.width * 4;
+            for (uint32_t x = 0; x < w; ++x) {
+                uint32_t sx = x < padding ? 0 : (std::min)(x - padding, src.width - 1);
+                std::memcpy(dstRow + x * 4, srcRow + sx * 4, 4);
+            }
+        }
+    }
+};
@@ -3,15 +3,32 @@
  * @brief テクスチャ管理システム
  * @author 山内陽
  * @date 2025
- * @version 5.0
+ * @version 5.8
  * 
  * @details
  * 画像ファイルの読み込み、テクスチャの作成・管理を行うシステムです。
  * WIC (Windows Imaging Component) を使用して様々な画像フォーマットに対応しています。
+ * LoadFromFileAsync() はデコードとミップチェーンの生成をワーカースレッドで行い、
+ * 小さいミップから順に、画面上の大きさに応じて必要な解像度までストリーミングします。
+ * デコードは SetImageDecoder() で別のデコーダー(stb_image など)に差し替えられ、失敗した形式は WIC で読み込みます。
+ * LoadFromFiles() は独立した複数の画像のデコードをワーカーで並列に行います。
+ * DDSファイル(BC1/BC3/BC5/BC7 など)は展開せずにそのままGPUへ渡します。画像ファイルと同じ名前の
+ * .dds があればそちらを優先するため、tools/Convert-Textures.ps1 で事前に圧縮しておくだけで切り替わります。
+ * 同じパス・同じ内容のテクスチャは同じハンドルを返して参照カウントで共有し、最後の Release() で解放します。
+ * SetArrayPoolingEnabled(true) にすると、同じサイズ・形式のテクスチャを共有の Texture2DArray にもコピーし、
+ * インスタンス描画がテクスチャの違うエンティティを1回の描画にまとめられるようにします。
+ * SetResidencyBudget() を設定すると、GetSRV() で描画に使ったフレームを記録し、VRAMが予算を超えた場合に
+ * 長く使われていないテクスチャのミップを落とすか退避し、次に描画で参照された時に読み込み直します。
  */
 #pragma once
 #include "graphics/GfxDevice.h"
 #include "app/DebugLog.h"
+#include "app/JobSystem.h"
+#include "app/Telemetry.h"
+#include "app/StartupReport.h"
+#include "app/AssetArchive.h"
+#include "graphics/DdsLoader.h"
+#include "graphics/TextureAtlas.h"
 #include <d3d11.h>
 #include <wrl/client.h>
 #include <wincodec.h>
@@ -23,6 +40,15 @@
 #include <vector>
 #include <fstream>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <memory>
+#include <iterator>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
 
 #pragma comment(lib, "windowscodecs.lib")
 
@@ -76,6 +102,13 @@ public:
      */
     static constexpr TextureHandle INVALID_TEXTURE = 0;
 
+    /**
+     * @typedef ImageDecoder
+     * @brief 画像を RGBA8 (sRGB) にデコードする関数(ワーカーから並列に呼ばれるためスレッド安全にする)
+     * @return bool デコードできた場合 true(false なら WIC で読み込む)
+     */
+    using ImageDecoder = bool (*)(const char* filepath, std::vector<uint8_t>& rgba, uint32_t& width, uint32_t& height);
+
     /**
      * @brief 初期化
      * @param[in] gfx グラフィックスデバイス
@@ -89,6 +122,7 @@ public:
         isShutdown_ = false;
 
         if (!wicFactory_) {
+            StartupReport::Scope scope("TextureManager.CreateWicFactory");
             HRESULT hr = CoCreateInstance(
                 CLSID_WICImagingFactory,
                 nullptr,
@@ -115,13 +149,28 @@ public:
     }
 
     /**
-     * @brief ファイルからテクスチャを読み込み(BMP, PNG, JPGなど)
+     * @struct LoadTimings
+     * @brief LoadFromFile() の段階ごとの所要時間(ミリ秒、読み込み時間の計測用)
+     */
+    struct LoadTimings {
+        bool compressed = false;  ///< DDS を読み込んだか
+        double decodeMs = 0.0;    ///< WIC のデコード(DDS はファイルの読み込みと検証)
+        double uploadMs = 0.0;    ///< ミップの生成とテクスチャ・SRV の作成
+        uint32_t width = 0;       ///< 幅(ピクセル)
+        uint32_t height = 0;      ///< 高さ(ピクセル)
+    };
+
+    /**
+     * @brief ファイルからテクスチャを読み込み(BMP, PNG, JPG, DDSなど)
      * @param[in] filepath 画像ファイルのパス
+     * @param[out] timings 段階ごとの所要時間(nullptr可、読み込み済みのパスの場合はすべて0)
      * @return TextureHandle テクスチャハンドル(失敗時は INVALID_TEXTURE)
      * 
      * @details
      * Windows Imaging Component (WIC) を使用して画像を読み込み、
      * DirectX11 テクスチャに変換します。
+     * DDSファイル、または同じ名前の .dds がある場合は CreateTextureFromDds() で圧縮形式のまま読み込みます。
+     * 読み込み済みのパス(大文字小文字と区切り文字は区別しない)は参照カウントを増やして同じハンドルを返します。
      * 
      * @par 使用例
      * @code
@@ -131,71 +180,333 @@ public:
      * }
      * @endcode
      */
-    TextureHandle LoadFromFile(const char* filepath) {
+    TextureHandle LoadFromFile(const char* filepath, LoadTimings* timings = nullptr) {
         // WICを使用して画像を読み込む
         if (!wicFactory_) {
             DEBUGLOG_ERROR("TextureManager::LoadFromFile() - WIC factory not initialised");
             return INVALID_TEXTURE;
         }
 
-        HRESULT hr = S_OK;
-        // ワイド文字列に変換
-        wchar_t wpath[MAX_PATH];
-        MultiByteToWideChar(CP_ACP, 0, filepath, -1, wpath, MAX_PATH);
+        LoadTimings local;
+        LoadTimings& t = timings ? *timings : local;
+        t = LoadTimings();
 
-        // デコーダーを作成
-        Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
-        hr = wicFactory_->CreateDecoderFromFilename(
-            wpath,
-            nullptr,
-            GENERIC_READ,
-            WICDecodeMetadataCacheOnDemand,
-            &decoder
-        );
+        std::string key = PathKey(filepath);
+        TextureHandle cached = acquireCached(key);
+        if (cached != INVALID_TEXTURE) return cached;
+
+        auto lap = std::chrono::steady_clock::now();
+        auto lapMs = [&lap]() {
+            auto now = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(now - lap).count();
+            lap = now;
+            return ms;
+        };
+
+        std::string compressed = ResolveCompressedPath(filepath);
+        if (!compressed.empty()) {
+            DdsImage image;
+            std::string error;
+            if (!DdsLoader::Load(compressed.c_str(), image, error)) {
+                char msg[512];
+                sprintf_s(msg, "Failed to load DDS file: %s (%s)", compressed.c_str(), error.c_str());
+                MessageBoxA(nullptr, msg, "Texture Load Error", MB_OK | MB_ICONERROR);
+                return INVALID_TEXTURE;
+            }
+            t.compressed = true;
+            t.decodeMs = lapMs();
+            t.width = image.width;
+            t.height = image.height;
+            TextureHandle handle = CreateTextureFromDds(image);
+            t.uploadMs = lapMs();
+            return cachePath(key, handle);
+        }
 
+        std::vector<uint8_t> pixels;
+        UINT width = 0, height = 0;
+        HRESULT hr = DecodeRGBA(wicFactory_.Get(), filepath, pixels, width, height);
         if (FAILED(hr)) {
             char msg[512];
             sprintf_s(msg, "Failed to load image file: %s", filepath);
             MessageBoxA(nullptr, msg, "Texture Load Error", MB_OK | MB_ICONERROR);
             return INVALID_TEXTURE;
         }
+        t.decodeMs = lapMs();
+        t.width = width;
+        t.height = height;
 
-        // フレームを取得
-        Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
-        hr = decoder->GetFrame(0, &frame);
-        if (FAILED(hr)) return INVALID_TEXTURE;
+        TextureHandle handle = CreateTextureFromPixels(std::move(pixels), width, height);
+        t.uploadMs = lapMs();
+        return cachePath(key, handle, filepath);
+    }
 
-        // RGBA32に変換
-        Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
-        hr = wicFactory_->CreateFormatConverter(&converter);
-        if (FAILED(hr)) return INVALID_TEXTURE;
+    /**
+     * @brief ファイルからテクスチャを非同期で読み込み(ストリーミング)
+     * @param[in] filepath 画像ファイルのパス
+     * @return TextureHandle テクスチャハンドル(すぐに有効。データが届くまで GetSRV() は白テクスチャを返す)
+     *
+     * @details
+     * WICのデコードとミップチェーンの生成をジョブシステムのワーカーで行います。
+     * GPUへは Update() で最も小さいミップから1段ずつ転送し、RequestResolution() で
+     * 通知された画面上の大きさに必要な段まで詳細にします。通知がないテクスチャは最大解像度まで読み込みます。
+     * 読み込み失敗時はメッセージボックスを出さずにログに記録し、白テクスチャのままにします。
+     * パスのキャッシュは LoadFromFile() と共有します(デコード前にハンドルを返すため内容による共有は行いません)。
+     */
+    TextureHandle LoadFromFileAsync(const char* filepath) {
+        if (!wicFactory_ || !gfx_) {
+            DEBUGLOG_ERROR("TextureManager::LoadFromFileAsync() - not initialised");
+            return INVALID_TEXTURE;
+        }
 
-        hr = converter->Initialize(
-            frame.Get(),
-            GUID_WICPixelFormat32bppRGBA,
-            WICBitmapDitherTypeNone,
-            nullptr,
-            0.0,
-            WICBitmapPaletteTypeCustom
-        );
-        if (FAILED(hr)) return INVALID_TEXTURE;
+        // DDSはデコードが不要でミップも含むため、そのまま同期で読み込む
+        if (!ResolveCompressedPath(filepath).empty()) {
+            return LoadFromFile(filepath);
+        }
 
-        // サイズを取得
-        UINT width, height;
-        hr = converter->GetSize(&width, &height);
-        if (FAILED(hr)) return INVALID_TEXTURE;
+        std::string key = PathKey(filepath);
+        TextureHandle cached = acquireCached(key);
+        if (cached != INVALID_TEXTURE) return cached;
 
-        // ピクセルデータを取得
-        std::vector<uint8_t> pixels(width * height * 4);
-        hr = converter->CopyPixels(
-            nullptr,
-            width * 4,
-            static_cast<UINT>(pixels.size()),
-            pixels.data()
-        );
-        if (FAILED(hr)) return INVALID_TEXTURE;
+        TextureHandle handle = nextHandle_++;
+        pathCache_[key] = handle;
+        TextureData& t = textures_[handle];
+        t.sourcePath = filepath;
+        t.lastUsedFrame.store(frame_, std::memory_order_relaxed);
+        startStream(handle, t);
+        return handle;
+    }
+
+    /**
+     * @brief 複数の画像ファイルをまとめて読み込み(デコードとミップの生成をワーカーで並列に行う)
+     * @param[in] filepaths 画像ファイルのパス
+     * @return std::vector<TextureHandle> filepaths と同じ順のハンドル(失敗したものは INVALID_TEXTURE)
+     *
+     * @details
+     * 読み込み済みのパスと DDS は LoadFromFile() と同じ扱いで、テクスチャの作成は呼び出しスレッドで行います。
+     * デコードした画素はそのままミップの最上段になり、CreateTexture2D の初期データになります(複写しません)。
+     * 読み込み失敗時はメッセージボックスを出さずにログに記録します。
+     */
+    std::vector<TextureHandle> LoadFromFiles(const std::vector<std::string>& filepaths) {
+        std::vector<TextureHandle> handles(filepaths.size(), INVALID_TEXTURE);
+        if (!wicFactory_ || !gfx_) {
+            DEBUGLOG_ERROR("TextureManager::LoadFromFiles() - not initialised");
+            return handles;
+        }
+
+        struct Decoded {
+            size_t index = 0;                  ///< filepaths の位置
+            std::string key;                   ///< PathKey
+            std::vector<MipLevel> mips;        ///< ミップチェーン
+            uint64_t contentHash = 0;
+        };
+        std::vector<Decoded> decodes;
+        std::vector<std::pair<size_t, size_t>> duplicates; // 同じ呼び出しで重複したパス(filepaths の位置, decodes の位置)
+        std::unordered_map<std::string, size_t> pending;
+        for (size_t i = 0; i < filepaths.size(); ++i) {
+            std::string key = PathKey(filepaths[i].c_str());
+            auto p = pending.find(key);
+            if (p != pending.end()) {
+                duplicates.emplace_back(i, p->second);
+                continue;
+            }
+            TextureHandle cached = acquireCached(key);
+            if (cached != INVALID_TEXTURE) {
+                handles[i] = cached;
+                continue;
+            }
+            if (!ResolveCompressedPath(filepaths[i].c_str()).empty()) {
+                handles[i] = LoadFromFile(filepaths[i].c_str());
+                continue;
+            }
+            pending.emplace(key, decodes.size());
+            Decoded d;
+            d.index = i;
+            d.key = std::move(key);
+            decodes.push_back(std::move(d));
+        }
 
-        return CreateTextureFromMemory(pixels.data(), width, height, 4);
+        IWICImagingFactory* factory = wicFactory_.Get();
+        auto decodeRange = [&](size_t begin, size_t end) {
+            // ワーカースレッドでもWICを使えるようにCOMを初期化(既に初期化済みなら参照カウントのみ)
+            HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            for (size_t k = begin; k < end; ++k) {
+                Decoded& d = decodes[k];
+                std::vector<uint8_t> pixels;
+                UINT width = 0, height = 0;
+                if (FAILED(DecodeRGBA(factory, filepaths[d.index].c_str(), pixels, width, height))) continue;
+                d.contentHash = HashPixels(pixels.data(), pixels.size(), width, height, 4, true);
+                BuildMipChain(std::move(pixels), width, height, d.mips);
+            }
+            if (SUCCEEDED(co)) CoUninitialize();
+        };
+        if (jobs_ && jobs_->IsRunning()) {
+            jobs_->ParallelFor(decodes.size(), 1, decodeRange);
+        } else {
+            decodeRange(0, decodes.size());
+        }
+
+        for (Decoded& d : decodes) {
+            if (d.mips.empty()) {
+                DEBUGLOG_WARNING("TextureManager::LoadFromFiles() - 読み込み失敗: " + filepaths[d.index]);
+                continue;
+            }
+            const uint32_t width = d.mips[0].width, height = d.mips[0].height;
+            TextureHandle handle = acquireContent(d.contentHash, width, height);
+            if (handle == INVALID_TEXTURE) handle = createTexture(d.mips[0].pixels.data(), width, height, 4, d.mips, d.contentHash);
+            handles[d.index] = cachePath(d.key, handle, filepaths[d.index].c_str());
+        }
+        for (const auto& duplicate : duplicates) {
+            handles[duplicate.first] = acquireCached(decodes[duplicate.second].key);
+        }
+        return handles;
+    }
+
+    /**
+     * @brief 画像のデコーダーを差し替え(nullptr で WIC のみ)
+     *
+     * @details
+     * 高速なデコーダー(stb_image / libspng / wuffs など)をプロジェクトに組み込む場合に、初期化時に1回設定します。
+     * デコーダーが false を返した画像は WIC で読み込みます。DDS はデコーダーを通しません。
+     */
+    static void SetImageDecoder(ImageDecoder decoder) {
+        ImageDecoderSetting().store(decoder, std::memory_order_release);
+    }
+
+    /**
+     * @brief 描画対象の画面上の大きさを通知(ストリーミング中のテクスチャのみ有効)
+     * @param[in] handle テクスチャハンドル
+     * @param[in] pixels テクスチャを貼った対象の画面上の大きさ(ピクセル)
+     *
+     * @details
+     * 同じフレームで複数回通知された場合は最大値を使用します。
+     */
+    void RequestResolution(TextureHandle handle, uint32_t pixels) {
+        auto it = textures_.find(handle);
+        if (it == textures_.end() || !it->second.stream) return;
+        TextureData& t = it->second;
+        if (t.requestFrame != frame_) {
+            t.requestFrame = frame_;
+            t.requestedPixels = 0;
+        }
+        t.requestedPixels = (std::max)(t.requestedPixels, pixels);
+    }
+
+    /**
+     * @brief ストリーミングの更新(毎フレーム、描画前にメインスレッドから呼び出す)
+     *
+     * @details
+     * ReloadAsync() のデコードが終わったテクスチャを差し替えた後、
+     * デコード済みのテクスチャを1フレームあたり STREAM_UPLOAD_BYTES_PER_FRAME まで転送し、
+     * 常駐量が予算を超えた場合は長く使われていないテクスチャの最上位ミップから破棄します。
+     * その後、退避したテクスチャの読み込み直しと、SetResidencyBudget() の予算の確認を行います。
+     */
+    void Update() {
+        if (!pendingReloads_.empty()) {
+            finishReloads();
+        }
+        if (!streaming_.empty()) {
+            updateStreaming();
+        }
+        updateResidency();
+        ++frame_;
+    }
+
+    /**
+     * @struct ResidencyStats
+     * @brief VRAMの常駐管理の状況(GetResidencyStats())
+     */
+    struct ResidencyStats {
+        size_t gpuBytes = 0;            ///< テクスチャと共有配列のGPUメモリ(直近の Update() 時点)
+        size_t budget = 0;              ///< SetResidencyBudget() の予算(0は無制限)
+        size_t evictedTextures = 0;     ///< 退避中(次に描画で参照された時に読み込み直す)のテクスチャ数
+        size_t evictionsLastUpdate = 0; ///< 直近の Update() でミップを落とした・退避した回数
+        size_t reloadsLastUpdate = 0;   ///< 直近の Update() で読み込み直しを始めた数
+    };
+
+    /**
+     * @brief テクスチャが使うVRAMの上限(バイト、0で無制限。既定 0)
+     *
+     * @details
+     * Update() のたびにテクスチャと共有配列のVRAMを数え、予算を超えていれば GetSRV() で最後に参照されたのが
+     * 古い順に、RESIDENCY_IDLE_FRAMES フレーム以上使われていないテクスチャを次のように減らします。
+     * - ストリーミング中のテクスチャ: 最上位ミップから1段ずつ落とす(最小ミップは残す)
+     * - 画像ファイルから読み込んだテクスチャ: GPUから退避する(ハンドルとパスのキャッシュは残す)
+     *
+     * 退避したテクスチャは GetSRV() が白テクスチャを返し、次の Update() で LoadFromFileAsync() と同じく
+     * 最小ミップからストリーミングで読み込み直します。DDS・メモリから作成したテクスチャ・共有配列に
+     * 配置したテクスチャは読み込み直せないため、数えるだけで減らしません。
+     */
+    void SetResidencyBudget(size_t bytes) { residencyBudget_ = bytes; }
+    size_t GetResidencyBudget() const { return residencyBudget_; }
+
+    ResidencyStats GetResidencyStats() const {
+        ResidencyStats stats = residency_;
+        stats.budget = residencyBudget_;
+        stats.evictedTextures = evictedCount_;
+        return stats;
+    }
+
+private:
+    // デコード済みのミップを転送し、ストリーミングの予算を守る
+    void updateStreaming() {
+        size_t uploaded = 0;
+        size_t write = 0;
+        for (size_t read = 0; read < streaming_.size(); ++read) {
+            TextureHandle handle = streaming_[read];
+            auto it = textures_.find(handle);
+            if (it == textures_.end() || !it->second.stream) continue; // 解放済み
+            streaming_[write++] = handle;
+
+            TextureData& t = it->second;
+            StreamState& state = *t.stream;
+            if (!state.decoded.load(std::memory_order_acquire)) continue;
+            if (!state.succeeded) {
+                DEBUGLOG_WARNING("TextureManager - テクスチャのストリーミング読み込み失敗: " + state.path);
+                t.stream.reset();
+                --write;
+                continue;
+            }
+
+            const uint32_t mipCount = static_cast<uint32_t>(state.mips.size());
+            const uint32_t wanted = wantedMip(t);
+            if (isIdle(t) && t.residentMip < mipCount) continue; // 常駐管理で落としたミップは使われるまで戻さない
+            if (t.residentMip > wanted && uploaded < STREAM_UPLOAD_BYTES_PER_FRAME) {
+                // 未転送なら最小ミップから、それ以外は1段ずつ詳細にする(予算を超える段は読み込まない)
+                uint32_t next = t.residentMip >= mipCount ? mipCount - 1 : t.residentMip - 1;
+                bool first = t.residentMip >= mipCount;
+                if (first || residentBytes_ + state.mips[next].pixels.size() <= streamingBudget_) {
+                    uploaded += makeResident(t, next);
+                }
+            }
+        }
+        streaming_.resize(write);
+
+        enforceBudget();
+    }
+
+public:
+    /**
+     * @brief ストリーミングで常駐させるテクスチャの合計サイズの上限
+     */
+    void SetStreamingBudget(size_t bytes) { streamingBudget_ = bytes; }
+    size_t GetStreamingBudget() const { return streamingBudget_; }
+
+    /**
+     * @brief ストリーミングで常駐しているテクスチャの合計サイズ(バイト)
+     */
+    size_t GetStreamingResidentBytes() const { return residentBytes_; }
+
+    /**
+     * @brief ストリーミング管理下のテクスチャ数(0なら RequestResolution() は不要)
+     */
+    size_t StreamingCount() const { return streaming_.size(); }
+
+    /**
+     * @brief デコードに使うジョブシステムを設定(nullptrで呼び出しスレッドでデコード、切り替え前にデコード中のものを待つ)
+     */
+    void SetJobSystem(JobSystem* jobs) {
+        waitDecodes();
+        jobs_ = jobs;
     }
 
     /**
@@ -204,11 +515,15 @@ public:
      * @param[in] width 幅(ピクセル)
      * @param[in] height 高さ(ピクセル)
      * @param[in] channels チャンネル数(通常4: RGBA)
+     * @param[in] generateMips 1x1までのミップチェーンを作成するか(4チャンネルのみ)
      * @return TextureHandle テクスチャハンドル(失敗時は INVALID_TEXTURE)
      * 
      * @details
      * メモリ上のピクセルデータから DirectX11 テクスチャを作成します。
      * プロシージャルテクスチャの生成などに使用できます。
+     * ミップは BuildMipChain() でCPU側で作成して初期データとして渡します
+     * (GenerateMips と違いレンダーターゲット用のバインドが不要で、IMMUTABLE のまま作成できます)。
+     * 同じサイズ・同じ内容(64ビットハッシュ)のテクスチャが既にあれば参照カウントを増やしてそれを返します。
      * 
      * @par 使用例
      * @code
@@ -220,23 +535,75 @@ public:
      * auto texture = texManager.CreateTextureFromMemory(pixels, 2, 2, 4);
      * @endcode
      */
-    TextureHandle CreateTextureFromMemory(const uint8_t* data, uint32_t width, uint32_t height, uint32_t channels) {
+    TextureHandle CreateTextureFromMemory(const uint8_t* data, uint32_t width, uint32_t height, uint32_t channels, bool generateMips = true) {
+        uint64_t contentHash = HashPixels(data, static_cast<size_t>(width) * height * channels, width, height, channels, generateMips);
+        TextureHandle cached = acquireContent(contentHash, width, height);
+        if (cached != INVALID_TEXTURE) return cached;
+
+        std::vector<MipLevel> mips;
+        if (generateMips && channels == 4 && (width > 1 || height > 1)) {
+            BuildMipChain(std::vector<uint8_t>(data, data + static_cast<size_t>(width) * height * 4), width, height, mips);
+        }
+        return createTexture(data, width, height, channels, mips, contentHash);
+    }
+
+    /**
+     * @brief デコード済みの RGBA8 の画素からミップ付きのテクスチャを作成(画素は複写せずにミップの最上段にする)
+     * @param[in] rgba 画素(width * height * 4 バイト、呼び出し後は空になる)
+     */
+    TextureHandle CreateTextureFromPixels(std::vector<uint8_t>&& rgba, uint32_t width, uint32_t height) {
+        uint64_t contentHash = HashPixels(rgba.data(), rgba.size(), width, height, 4, true);
+        TextureHandle cached = acquireContent(contentHash, width, height);
+        if (cached != INVALID_TEXTURE) return cached;
+
+        std::vector<MipLevel> mips;
+        BuildMipChain(std::move(rgba), width, height, mips);
+        if (mips.empty()) return INVALID_TEXTURE;
+        return createTexture(mips[0].pixels.data(), width, height, 4, mips, contentHash);
+    }
+
+private:
+    struct MipLevel;
+
+    // 同じ内容のテクスチャがあれば参照カウントを増やして返す
+    TextureHandle acquireContent(uint64_t contentHash, uint32_t width, uint32_t height) {
+        auto cachedContent = contentCache_.find(contentHash);
+        if (cachedContent != contentCache_.end()) {
+            auto cached = textures_.find(cachedContent->second);
+            if (cached != textures_.end() && cached->second.width == width && cached->second.height == height) {
+                cached->second.refCount++;
+                return cachedContent->second;
+            }
+        }
+        return INVALID_TEXTURE;
+    }
+
+    // テクスチャとSRVを作成して登録(mips が空なら data を1段だけ使う)
+    TextureHandle createTexture(const uint8_t* data, uint32_t width, uint32_t height, uint32_t channels,
+                                const std::vector<MipLevel>& mips, uint64_t contentHash) {
         D3D11_TEXTURE2D_DESC texDesc{};
         texDesc.Width = width;
         texDesc.Height = height;
-        texDesc.MipLevels = 1;
+        texDesc.MipLevels = mips.empty() ? 1 : static_cast<UINT>(mips.size());
         texDesc.ArraySize = 1;
         texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;  // sRGB対応に変更
         texDesc.SampleDesc.Count = 1;
         texDesc.Usage = D3D11_USAGE_DEFAULT;
         texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
-        D3D11_SUBRESOURCE_DATA initData{};
-        initData.pSysMem = data;
-        initData.SysMemPitch = width * channels;
+        std::vector<D3D11_SUBRESOURCE_DATA> initData(texDesc.MipLevels);
+        if (mips.empty()) {
+            initData[0].pSysMem = data;
+            initData[0].SysMemPitch = width * channels;
+        } else {
+            for (size_t i = 0; i < mips.size(); ++i) {
+                initData[i].pSysMem = mips[i].pixels.data();
+                initData[i].SysMemPitch = mips[i].width * 4;
+            }
+        }
 
         Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
-        HRESULT hr = gfx_->Dev()->CreateTexture2D(&texDesc, &initData, &texture);
+        HRESULT hr = gfx_->Dev()->CreateTexture2D(&texDesc, initData.data(), &texture);
         if (FAILED(hr)) {
             MessageBoxA(nullptr, "Failed to create texture2D", "Texture Error", MB_OK | MB_ICONERROR);
             return INVALID_TEXTURE;
@@ -246,7 +613,7 @@ public:
         D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
         srvDesc.Format = texDesc.Format;
         srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MipLevels = 1;
+        srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
 
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
         hr = gfx_->Dev()->CreateShaderResourceView(texture.Get(), &srvDesc, &srv);
@@ -257,16 +624,136 @@ public:
 
         // テクスチャを登録
         TextureHandle handle = nextHandle_++;
-        TextureData texData;
+        TextureData& texData = textures_[handle];
         texData.texture = texture;
         texData.srv = srv;
         texData.width = width;
         texData.height = height;
-        textures_[handle] = texData;
+        texData.contentHash = contentHash;
+        texData.lastUsedFrame.store(frame_, std::memory_order_relaxed);
+        contentCache_[contentHash] = handle;
+        addToArrayPool(texData, texDesc);
+
+        return handle;
+    }
+
+public:
+    /**
+     * @brief DDSの内容からテクスチャを作成
+     * @param[in] image DdsLoader::Load() で読み込んだ内容
+     * @return TextureHandle テクスチャハンドル(失敗時は INVALID_TEXTURE)
+     *
+     * @details
+     * ブロック圧縮形式もファイルのミップもそのまま CreateTexture2D に渡します(展開・再生成はしません)。
+     */
+    TextureHandle CreateTextureFromDds(const DdsImage& image) {
+        D3D11_TEXTURE2D_DESC texDesc{};
+        texDesc.Width = image.width;
+        texDesc.Height = image.height;
+        texDesc.MipLevels = static_cast<UINT>(image.mips.size());
+        texDesc.ArraySize = 1;
+        texDesc.Format = image.format;
+        texDesc.SampleDesc.Count = 1;
+        texDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        std::vector<D3D11_SUBRESOURCE_DATA> initData = image.Subresources();
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        HRESULT hr = gfx_->Dev()->CreateTexture2D(&texDesc, initData.data(), &texture);
+        if (FAILED(hr)) {
+            MessageBoxA(nullptr, "Failed to create compressed texture2D", "Texture Error", MB_OK | MB_ICONERROR);
+            return INVALID_TEXTURE;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+        srvDesc.Format = texDesc.Format;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
+
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        hr = gfx_->Dev()->CreateShaderResourceView(texture.Get(), &srvDesc, &srv);
+        if (FAILED(hr)) {
+            MessageBoxA(nullptr, "Failed to create SRV", "Texture Error", MB_OK | MB_ICONERROR);
+            return INVALID_TEXTURE;
+        }
 
+        TextureHandle handle = nextHandle_++;
+        TextureData& texData = textures_[handle];
+        texData.texture = texture;
+        texData.srv = srv;
+        texData.width = image.width;
+        texData.height = image.height;
+        texData.lastUsedFrame.store(frame_, std::memory_order_relaxed);
+        addToArrayPool(texData, texDesc);
         return handle;
     }
 
+    /**
+     * @brief 複数の画像ファイルを1枚のアトラステクスチャにまとめて作成
+     * @param[in] filepaths 画像ファイルのパス(この順序で rects を返す)
+     * @param[out] rects 各画像のUV矩形
+     * @return TextureHandle アトラスのテクスチャハンドル(失敗時は INVALID_TEXTURE)
+     *
+     * @details
+     * スプライトアニメーションのフレームをまとめる用途を想定しています(SpriteSheetAnimation を参照)。
+     * 各画像は TextureAtlasPacker で余白付きで配置され、アトラスにはミップが作成されます。
+     *
+     * @par 使用例
+     * @code
+     * std::vector<AtlasRect> rects;
+     * auto atlas = texManager.CreateAtlasFromFiles({ "walk1.png", "walk2.png", "walk3.png" }, rects);
+     * @endcode
+     */
+    TextureHandle CreateAtlasFromFiles(const std::vector<std::string>& filepaths, std::vector<AtlasRect>& rects) {
+        rects.clear();
+        if (!wicFactory_) {
+            DEBUGLOG_ERROR("TextureManager::CreateAtlasFromFiles() - WIC factory not initialised");
+            return INVALID_TEXTURE;
+        }
+
+        // デコードは画像ごとに独立しているのでワーカーで並列に行う
+        std::vector<std::vector<uint8_t>> images(filepaths.size());
+        std::vector<TextureAtlasPacker::Source> sources(filepaths.size());
+        std::vector<HRESULT> results(filepaths.size(), E_FAIL);
+        IWICImagingFactory* factory = wicFactory_.Get();
+        auto decodeRange = [&](size_t begin, size_t end) {
+            HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            for (size_t i = begin; i < end; ++i) {
+                UINT width = 0, height = 0;
+                results[i] = DecodeRGBA(factory, filepaths[i].c_str(), images[i], width, height);
+                sources[i].width = width;
+                sources[i].height = height;
+            }
+            if (SUCCEEDED(co)) CoUninitialize();
+        };
+        if (jobs_ && jobs_->IsRunning()) {
+            jobs_->ParallelFor(filepaths.size(), 1, decodeRange);
+        } else {
+            decodeRange(0, filepaths.size());
+        }
+
+        for (size_t i = 0; i < filepaths.size(); ++i) {
+            if (FAILED(results[i])) {
+                char msg[512];
+                sprintf_s(msg, "Failed to load image file: %s", filepaths[i].c_str());
+                MessageBoxA(nullptr, msg, "Texture Load Error", MB_OK | MB_ICONERROR);
+                return INVALID_TEXTURE;
+            }
+            sources[i].pixels = images[i].data();
+        }
+
+        AtlasImage atlas;
+        if (!TextureAtlasPacker::Pack(sources, TextureAtlasPacker::DEFAULT_PADDING, atlas, rects)) {
+            DEBUGLOG_ERROR("TextureManager::CreateAtlasFromFiles() - アトラスに収まりません (" + std::to_string(filepaths.size()) + " 枚)");
+            return INVALID_TEXTURE;
+        }
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "TextureManager - アトラス作成: " + std::to_string(filepaths.size()) + " 枚 -> " +
+            std::to_string(atlas.width) + "x" + std::to_string(atlas.height));
+        return CreateTextureFromMemory(atlas.pixels.data(), atlas.width, atlas.height, 4);
+    }
+
     /**
      * @brief テクスチャの取得
      * @param[in] handle テクスチャハンドル
@@ -288,9 +775,76 @@ public:
         if (handle == INVALID_TEXTURE) return nullptr;
         auto it = textures_.find(handle);
         if (it == textures_.end()) return nullptr;
+        // 描画キューの並列記録(遅延コンテキスト)ではワーカースレッドから呼ばれる
+        const TextureData& t = it->second;
+        t.lastUsedFrame.store(frame_, std::memory_order_relaxed);
+        if (t.evicted && !t.reloadRequested.exchange(true, std::memory_order_relaxed)) {
+            // 退避したテクスチャは次の Update() で読み込み直す
+            std::lock_guard<std::mutex> lock(reloadMutex_);
+            reloadRequests_.push_back(handle);
+        }
+        if (!t.srv) {
+            // ストリーミングのデータが届くまで(退避中・読み込み失敗時も)は白テクスチャで代用
+            auto white = textures_.find(defaultWhiteTexture_);
+            return white != textures_.end() ? white->second.srv.Get() : nullptr;
+        }
         return it->second.srv.Get();
     }
 
+    /**
+     * @brief テクスチャの読み込み元のファイル(FrameCapture の記録用)
+     * @return std::string パス(メモリから作成したテクスチャなど、ファイルがない場合は空)
+     */
+    std::string GetSourcePath(TextureHandle handle) const {
+        auto it = textures_.find(handle);
+        if (it == textures_.end()) return std::string();
+        if (!it->second.sourcePath.empty()) return it->second.sourcePath;
+        for (const auto& entry : pathCache_) {
+            if (entry.second == handle) return entry.first; // 共有配列に置いたテクスチャは sourcePath を持たない
+        }
+        return std::string();
+    }
+
+    /**
+     * @struct TextureArraySlot
+     * @brief 共有 Texture2DArray 内の位置
+     */
+    struct TextureArraySlot {
+        uint32_t pool = 0;  ///< プール番号(1以上、GetArraySRV() に渡す)
+        uint32_t slice = 0; ///< 配列のスライス
+    };
+
+    /**
+     * @brief 共有 Texture2DArray への配置を有効化(以降に作成したテクスチャが対象)
+     *
+     * @details
+     * 同じサイズ・ミップ数・形式のテクスチャを1つの配列にまとめます。元のテクスチャも残すため、
+     * 対象テクスチャのVRAMは2倍になります。小さなスプライトやマテリアルのテクスチャが多いシーン向けです。
+     * ストリーミング中のテクスチャは解像度が変わるため対象外です。
+     */
+    void SetArrayPoolingEnabled(bool enabled) { arrayPooling_ = enabled; }
+    bool IsArrayPoolingEnabled() const { return arrayPooling_; }
+
+    /**
+     * @brief テクスチャの共有配列内の位置を取得
+     * @return bool 配列に配置されている場合 true
+     */
+    bool GetArraySlot(TextureHandle handle, TextureArraySlot& slot) const {
+        auto it = textures_.find(handle);
+        if (it == textures_.end() || it->second.pool == 0) return false;
+        slot.pool = it->second.pool;
+        slot.slice = it->second.slice;
+        return true;
+    }
+
+    /**
+     * @brief 共有配列のSRV(Texture2DArray、無効なプールは nullptr)
+     */
+    ID3D11ShaderResourceView* GetArraySRV(uint32_t pool) const {
+        if (pool == 0 || pool > pools_.size()) return nullptr;
+        return pools_[pool - 1].srv.Get();
+    }
+
     /**
      * @brief デフォルトテクスチャ(白色)を取得
      * @return TextureHandle 白色テクスチャのハンドル
@@ -306,8 +860,8 @@ public:
      * @param[in] handle テクスチャハンドル
      * 
      * @details
-     * 指定されたテクスチャをメモリから解放します。
-     * 解放後、そのハンドルは無効になります。
+     * 参照カウントを1つ減らし、0になったらテクスチャをメモリから解放します。
+     * 解放後、そのハンドルは無効になります。LoadFromFile() などで取得した回数だけ呼び出してください。
      * 
      * @par 使用例
      * @code
@@ -318,7 +872,135 @@ public:
         if (handle == INVALID_TEXTURE || handle == defaultWhiteTexture_) {
             return;
         }
-        textures_.erase(handle);
+        auto it = textures_.find(handle);
+        if (it == textures_.end()) return;
+        if (--it->second.refCount > 0) return;
+
+        // このハンドルを指すキャッシュを削除(複数のパスが同じ内容を共有している場合がある)
+        for (auto p = pathCache_.begin(); p != pathCache_.end();) {
+            p = p->second == handle ? pathCache_.erase(p) : std::next(p);
+        }
+        auto c = contentCache_.find(it->second.contentHash);
+        if (c != contentCache_.end() && c->second == handle) contentCache_.erase(c);
+        if (it->second.pool != 0) pools_[it->second.pool - 1].freeSlices.push_back(it->second.slice);
+
+        residentBytes_ -= it->second.residentBytes;
+        if (it->second.evicted) --evictedCount_;
+        textures_.erase(it);
+    }
+
+    /**
+     * @brief ファイルを読み込み直して既存のハンドルの内容を差し替え(ホットリロード用)
+     * @param[in] handle 差し替えるテクスチャハンドル
+     * @param[in] filepath 画像ファイルのパス(同名の .dds があればそちらを読み込む)
+     * @return bool 差し替えた場合 true(失敗時は元の内容のまま)
+     *
+     * @details
+     * ハンドルを保持している側はそのまま新しい内容で描画されます。保存途中のファイルを読んだ場合に
+     * 備えてメッセージボックスは出さず、ログに記録するだけにします。
+     * ストリーミング中だったテクスチャは最大解像度で同期的に読み込み、ストリーミングの管理から外れます。
+     */
+    bool Reload(TextureHandle handle, const char* filepath) {
+        if (handle == INVALID_TEXTURE || handle == defaultWhiteTexture_ || !textures_.count(handle) || !wicFactory_) {
+            return false;
+        }
+
+        const TextureHandle firstNew = nextHandle_;
+        TextureHandle created = INVALID_TEXTURE;
+        std::string compressed = ResolveCompressedPath(filepath);
+        if (!compressed.empty()) {
+            DdsImage image;
+            std::string error;
+            if (DdsLoader::Load(compressed.c_str(), image, error)) created = CreateTextureFromDds(image);
+        } else {
+            std::vector<uint8_t> pixels;
+            UINT width = 0, height = 0;
+            if (SUCCEEDED(DecodeRGBA(wicFactory_.Get(), filepath, pixels, width, height))) {
+                created = CreateTextureFromPixels(std::move(pixels), width, height);
+            }
+        }
+        if (created == INVALID_TEXTURE) {
+            DEBUGLOG_WARNING("TextureManager::Reload() - 読み込み失敗: " + std::string(filepath));
+            return false;
+        }
+        replaceContents(handle, created, firstNew);
+        return true;
+    }
+
+    /**
+     * @brief Reload() のデコードをワーカーで行い、完了後の Update() で差し替え(ホットリロード用)
+     * @param[in] handle 差し替えるテクスチャハンドル
+     * @param[in] filepath 画像ファイルのパス(同名の .dds があればその場で Reload() する)
+     * @return bool 読み込みを始めた(DDS は差し替えた)場合 true
+     *
+     * @details
+     * WICのデコードとミップの生成に時間がかかる大きな画像でも、メインスレッドは止まりません。
+     * 差し替えまでは元の内容で描画され、失敗時は元の内容のままログに記録します。
+     * 同じハンドルの読み込み直しが完了前に再び要求された場合は、前の結果を捨てて新しい方を使います。
+     */
+    bool ReloadAsync(TextureHandle handle, const char* filepath) {
+        if (handle == INVALID_TEXTURE || handle == defaultWhiteTexture_ || !textures_.count(handle) || !wicFactory_) {
+            return false;
+        }
+        if (!ResolveCompressedPath(filepath).empty()) {
+            return Reload(handle, filepath);
+        }
+
+        for (const std::shared_ptr<PendingReload>& pending : pendingReloads_) {
+            if (pending->handle == handle) pending->superseded = true;
+        }
+        auto pending = std::make_shared<PendingReload>();
+        pending->handle = handle;
+        pending->path = filepath;
+        pendingReloads_.push_back(pending);
+
+        Microsoft::WRL::ComPtr<IWICImagingFactory> factory = wicFactory_;
+        auto decode = [pending, factory]() {
+            HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            UINT width = 0, height = 0;
+            if (SUCCEEDED(DecodeRGBA(factory.Get(), pending->path.c_str(), pending->pixels, width, height))) {
+                pending->width = width;
+                pending->height = height;
+                pending->succeeded = true;
+            }
+            if (SUCCEEDED(co)) CoUninitialize();
+            pending->decoded.store(true, std::memory_order_release);
+        };
+
+        if (jobs_ && jobs_->IsRunning()) {
+            jobs_->Submit(decode, &decodes_);
+        } else {
+            decode();
+        }
+        return true;
+    }
+
+    /**
+     * @brief 管理しているテクスチャ数(共有されているものは1つと数える)
+     */
+    size_t GetTextureCount() const { return textures_.size(); }
+
+    /**
+     * @brief テクスチャと共有配列が確保しているGPUメモリ(バイト、MemoryTracker への報告用)
+     */
+    size_t GpuMemoryBytes() const {
+        size_t bytes = 0;
+        for (const auto& pair : textures_) bytes += GfxDevice::TextureBytes(pair.second.texture.Get());
+        for (const ArrayPool& pool : pools_) bytes += GfxDevice::TextureBytes(pool.texture.Get());
+        return bytes;
+    }
+
+    /**
+     * @brief ストリーミング用にCPU側に保持しているミップの合計(バイト、MemoryTracker への報告用)
+     */
+    size_t CpuMemoryBytes() const {
+        size_t bytes = 0;
+        for (const auto& pair : textures_) {
+            const StreamState* stream = pair.second.stream.get();
+            if (!stream || !stream->decoded.load(std::memory_order_acquire)) continue;
+            for (const MipLevel& mip : stream->mips) bytes += mip.pixels.capacity();
+        }
+        return bytes;
     }
 
     /**
@@ -351,6 +1033,16 @@ public:
         DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "テクスチャ2D: " + std::to_string(textureCount) + " 個");
         DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "シェーダーリソースビュー: " + std::to_string(srvCount) + " 個");
         
+        waitDecodes();
+        streaming_.clear();
+        pendingReloads_.clear();
+        residentBytes_ = 0;
+        reloadRequests_.clear();
+        evictedCount_ = 0;
+        residency_ = ResidencyStats{};
+        pathCache_.clear();
+        contentCache_.clear();
+        pools_.clear();
         textures_.clear();
         wicFactory_.Reset();
         defaultWhiteTexture_ = INVALID_TEXTURE;
@@ -364,18 +1056,702 @@ private:
      * @struct TextureData
      * @brief テクスチャの内部データ
      */
+    /**
+     * @struct MipLevel
+     * @brief CPU側のミップ1段(RGBA8)
+     */
+    struct MipLevel {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    /**
+     * @struct StreamState
+     * @brief ワーカーとメインスレッドで共有するストリーミングの状態
+     */
+    struct StreamState {
+        std::string path;                  ///< 画像ファイルのパス
+        std::vector<MipLevel> mips;        ///< ミップチェーン(decoded が true になってから参照)
+        bool succeeded = false;            ///< デコードに成功したか
+        std::atomic<bool> decoded{ false }; ///< ワーカーの処理が終わったか
+    };
+
+    /**
+     * @struct PendingReload
+     * @brief ReloadAsync() でワーカーがデコード中の画像
+     */
+    struct PendingReload {
+        TextureHandle handle = INVALID_TEXTURE; ///< 差し替えるテクスチャ
+        std::string path;                       ///< 画像ファイルのパス
+        std::vector<uint8_t> pixels;            ///< RGBA(decoded が true になってから参照)
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool succeeded = false;                 ///< デコードに成功したか
+        bool superseded = false;                ///< 同じハンドルに新しい要求が来た(メインスレッドのみ)
+        std::atomic<bool> decoded{ false };     ///< ワーカーの処理が終わったか
+    };
+
     struct TextureData {
         Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
-        uint32_t width;
-        uint32_t height;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t refCount = 1;                   ///< 参照カウント(0で解放)
+        uint64_t contentHash = 0;                ///< CreateTextureFromMemory() の内容のハッシュ(0はなし)
+        uint32_t pool = 0;                       ///< 共有配列のプール番号(0は配置なし)
+        uint32_t slice = 0;                      ///< 共有配列のスライス
+
+        // ストリーミング(LoadFromFileAsync のみ)
+        std::shared_ptr<StreamState> stream;     ///< CPU側のミップ(ストリーミングしない場合 nullptr)
+        uint32_t residentMip = UINT32_MAX;       ///< GPUにある最も詳細なミップ(UINT32_MAX は未転送)
+        size_t residentBytes = 0;                ///< GPUに常駐しているバイト数
+        uint32_t requestedPixels = 0;            ///< 最後に通知された画面上の大きさ
+        uint64_t requestFrame = UINT64_MAX;      ///< 最後に通知されたフレーム(UINT64_MAX は通知なし)
+
+        // 常駐管理(SetResidencyBudget)
+        std::string sourcePath;                  ///< 読み込み直しに使う画像ファイル(空なら退避しない)
+        mutable std::atomic<uint64_t> lastUsedFrame{ 0 }; ///< 最後に GetSRV() で参照されたフレーム
+        mutable std::atomic<bool> reloadRequested{ false }; ///< 退避中に参照され、読み込み直しを待っている
+        bool evicted = false;                    ///< GPUから退避している
+        const ID3D11Texture2D* measured = nullptr; ///< gpuBytes を数えたテクスチャ(作り直したら数え直す)
+        size_t gpuBytes = 0;                     ///< texture のGPUメモリ(バイト)
+    };
+
+    /**
+     * @struct ArrayPool
+     * @brief 同じサイズ・形式のテクスチャをまとめる Texture2DArray
+     */
+    struct ArrayPool {
+        UINT width = 0;
+        UINT height = 0;
+        UINT mipLevels = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        UINT capacity = 0;                                     ///< 確保済みのスライス数
+        UINT used = 0;                                         ///< 使用したスライス数(解放済みを含む)
+        std::vector<uint32_t> freeSlices;                      ///< 解放されて再利用できるスライス
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
     };
 
+    static constexpr UINT ARRAY_POOL_INITIAL_SLICES = 4;  ///< プール作成時のスライス数
+    static constexpr UINT ARRAY_POOL_MAX_SLICES = 256;    ///< 1プールのスライス数の上限(超えたら別のプール)
+
+    static constexpr size_t STREAM_UPLOAD_BYTES_PER_FRAME = 4 * 1024 * 1024; ///< 1フレームの転送量の上限
+    static constexpr size_t DEFAULT_STREAMING_BUDGET = 256 * 1024 * 1024;    ///< 常駐量の上限の既定値
+    static constexpr uint64_t RESIDENCY_IDLE_FRAMES = 120;                    ///< これだけ使われていなければ減らす対象
+
+    static std::atomic<ImageDecoder>& ImageDecoderSetting() {
+        static std::atomic<ImageDecoder> decoder{ nullptr };
+        return decoder;
+    }
+
+    /**
+     * @brief 画像をRGBA8にデコード(ファクトリ以外の状態を持たないためワーカーから呼び出し可)
+     * @details SetImageDecoder() のデコーダーを先に試し、失敗した場合は WIC を使います。
+     * デコード時間はテレメトリの texture_decode_ms に記録します。
+     */
+    static HRESULT DecodeRGBA(IWICImagingFactory* factory, const char* filepath, std::vector<uint8_t>& pixels, UINT& width, UINT& height) {
+        static const Telemetry::MetricId decodeMs = Telemetry::GetInstance().RegisterHistogram("texture_decode_ms");
+        auto start = std::chrono::steady_clock::now();
+        HRESULT hr = E_FAIL;
+        ImageDecoder decoder = ImageDecoderSetting().load(std::memory_order_acquire);
+        uint32_t w = 0, h = 0;
+        if (decoder && decoder(filepath, pixels, w, h) && w > 0 && h > 0 && pixels.size() >= static_cast<size_t>(w) * h * 4) {
+            width = w;
+            height = h;
+            hr = S_OK;
+        } else {
+            hr = decodeRGBA(factory, filepath, pixels, width, height);
+        }
+        Telemetry::GetInstance().Record(decodeMs, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return hr;
+    }
+
+    static HRESULT decodeRGBA(IWICImagingFactory* factory, const char* filepath, std::vector<uint8_t>& pixels, UINT& width, UINT& height) {
+        // デコーダーを作成(アーカイブに含まれていればメモリ上のストリームから、なければファイルから)
+        Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+        AssetArchive::Blob blob;  // デコードが終わるまで保持
+        HRESULT hr = E_FAIL;
+        if (AssetArchive::GetInstance().Read(filepath, blob)) {
+            Microsoft::WRL::ComPtr<IWICStream> stream;
+            hr = factory->CreateStream(&stream);
+            if (SUCCEEDED(hr)) hr = stream->InitializeFromMemory(const_cast<BYTE*>(blob.data), static_cast<DWORD>(blob.size));
+            if (SUCCEEDED(hr)) hr = factory->CreateDecoderFromStream(stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+        } else {
+            // ワイド文字列に変換
+            wchar_t wpath[MAX_PATH];
+            MultiByteToWideChar(CP_ACP, 0, filepath, -1, wpath, MAX_PATH);
+            hr = factory->CreateDecoderFromFilename(
+                wpath,
+                nullptr,
+                GENERIC_READ,
+                WICDecodeMetadataCacheOnDemand,
+                &decoder
+            );
+        }
+        if (FAILED(hr)) return hr;
+
+        // フレームを取得
+        Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+        hr = decoder->GetFrame(0, &frame);
+        if (FAILED(hr)) return hr;
+
+        // 元が RGBA32 ならフレームから直接複写する(変換器を通さない)
+        WICPixelFormatGUID format{};
+        if (SUCCEEDED(frame->GetPixelFormat(&format)) && IsEqualGUID(format, GUID_WICPixelFormat32bppRGBA)) {
+            hr = frame->GetSize(&width, &height);
+            if (FAILED(hr)) return hr;
+            pixels.resize(static_cast<size_t>(width) * height * 4);
+            return frame->CopyPixels(nullptr, width * 4, static_cast<UINT>(pixels.size()), pixels.data());
+        }
+
+        // RGBA32に変換
+        Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
+        hr = factory->CreateFormatConverter(&converter);
+        if (FAILED(hr)) return hr;
+
+        hr = converter->Initialize(
+            frame.Get(),
+            GUID_WICPixelFormat32bppRGBA,
+            WICBitmapDitherTypeNone,
+            nullptr,
+            0.0,
+            WICBitmapPaletteTypeCustom
+        );
+        if (FAILED(hr)) return hr;
+
+        // サイズを取得
+        hr = converter->GetSize(&width, &height);
+        if (FAILED(hr)) return hr;
+
+        // ピクセルデータを取得
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        return converter->CopyPixels(
+            nullptr,
+            width * 4,
+            static_cast<UINT>(pixels.size()),
+            pixels.data()
+        );
+    }
+
+    /**
+     * @brief 2x2の平均で1x1までのミップチェーンを作成(RGBA8 sRGB)
+     *
+     * @details
+     * RGBはsRGBから線形に戻してから平均します(ガンマ空間のまま平均すると縮小時に暗くなるため)。
+     * アルファはそのまま平均します。
+     */
+    static void BuildMipChain(std::vector<uint8_t>&& base, uint32_t width, uint32_t height, std::vector<MipLevel>& out) {
+        out.clear();
+        if (width == 0 || height == 0) return;
+        MipLevel level0;
+        level0.width = width;
+        level0.height = height;
+        level0.pixels = std::move(base);
+        out.push_back(std::move(level0));
+
+        const float* toLinear = SrgbToLinearTable();
+        while (out.back().width > 1 || out.back().height > 1) {
+            const MipLevel& src = out.back();
+            MipLevel dst;
+            dst.width = (std::max)(1u, src.width / 2);
+            dst.height = (std::max)(1u, src.height / 2);
+            dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+            for (uint32_t y = 0; y < dst.height; ++y) {
+                uint32_t y0 = (std::min)(y * 2, src.height - 1), y1 = (std::min)(y * 2 + 1, src.height - 1);
+                for (uint32_t x = 0; x < dst.width; ++x) {
+                    uint32_t x0 = (std::min)(x * 2, src.width - 1), x1 = (std::min)(x * 2 + 1, src.width - 1);
+                    const uint8_t* p00 = &src.pixels[(static_cast<size_t>(y0) * src.width + x0) * 4];
+                    const uint8_t* p01 = &src.pixels[(static_cast<size_t>(y0) * src.width + x1) * 4];
+                    const uint8_t* p10 = &src.pixels[(static_cast<size_t>(y1) * src.width + x0) * 4];
+                    const uint8_t* p11 = &src.pixels[(static_cast<size_t>(y1) * src.width + x1) * 4];
+                    uint8_t* d = &dst.pixels[(static_cast<size_t>(y) * dst.width + x) * 4];
+                    for (int c = 0; c < 3; ++c) {
+                        float linear = (toLinear[p00[c]] + toLinear[p01[c]] + toLinear[p10[c]] + toLinear[p11[c]]) * 0.25f;
+                        d[c] = LinearToSrgb(linear);
+                    }
+                    d[3] = static_cast<uint8_t>((p00[3] + p01[3] + p10[3] + p11[3] + 2) / 4);
+                }
+            }
+            out.push_back(std::move(dst));
+        }
+    }
+
+    /**
+     * @brief 共有配列にテクスチャをコピー(無効時・失敗時は何もしない)
+     */
+    void addToArrayPool(TextureData& t, const D3D11_TEXTURE2D_DESC& desc) {
+        if (!arrayPooling_ || !t.texture) return;
+
+        ArrayPool* pool = nullptr;
+        uint32_t poolIndex = 0;
+        for (uint32_t i = 0; i < pools_.size(); ++i) {
+            ArrayPool& p = pools_[i];
+            if (p.width != desc.Width || p.height != desc.Height || p.mipLevels != desc.MipLevels || p.format != desc.Format) continue;
+            if (!p.freeSlices.empty() || p.used < ARRAY_POOL_MAX_SLICES) {
+                pool = &p;
+                poolIndex = i;
+                break;
+            }
+        }
+        if (!pool) {
+            ArrayPool created;
+            created.width = desc.Width;
+            created.height = desc.Height;
+            created.mipLevels = desc.MipLevels;
+            created.format = desc.Format;
+            pools_.push_back(std::move(created));
+            poolIndex = static_cast<uint32_t>(pools_.size() - 1);
+            pool = &pools_.back();
+        }
+
+        uint32_t slice;
+        if (!pool->freeSlices.empty()) {
+            slice = pool->freeSlices.back();
+            pool->freeSlices.pop_back();
+        } else {
+            if (pool->used == pool->capacity && !growArrayPool(*pool)) return;
+            slice = pool->used++;
+        }
+
+        ID3D11DeviceContext* ctx = gfx_->Ctx();
+        for (UINT mip = 0; mip < desc.MipLevels; ++mip) {
+            ctx->CopySubresourceRegion(pool->texture.Get(), mip + slice * pool->mipLevels, 0, 0, 0, t.texture.Get(), mip, nullptr);
+        }
+        t.pool = poolIndex + 1;
+        t.slice = slice;
+    }
+
+    /**
+     * @brief プールの容量を倍にして作り直す(使用中のスライスはGPU上でコピー)
+     */
+    bool growArrayPool(ArrayPool& pool) {
+        UINT capacity = pool.capacity == 0 ? ARRAY_POOL_INITIAL_SLICES : (std::min)(pool.capacity * 2, ARRAY_POOL_MAX_SLICES);
+
+        D3D11_TEXTURE2D_DESC desc{};
+        desc.Width = pool.width;
+        desc.Height = pool.height;
+        desc.MipLevels = pool.mipLevels;
+        desc.ArraySize = capacity;
+        desc.Format = pool.format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        if (FAILED(gfx_->Dev()->CreateTexture2D(&desc, nullptr, &texture))) {
+            DEBUGLOG_WARNING("TextureManager - 共有テクスチャ配列の作成失敗 (" + std::to_string(pool.width) + "x" + std::to_string(pool.height) + ")");
+            return false;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+        srvDesc.Format = desc.Format;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+        srvDesc.Texture2DArray.ArraySize = capacity;
+
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        if (FAILED(gfx_->Dev()->CreateShaderResourceView(texture.Get(), &srvDesc, &srv))) {
+            DEBUGLOG_WARNING("TextureManager - 共有テクスチャ配列のSRV作成失敗");
+            return false;
+        }
+
+        ID3D11DeviceContext* ctx = gfx_->Ctx();
+        for (UINT slice = 0; slice < pool.used; ++slice) {
+            for (UINT mip = 0; mip < pool.mipLevels; ++mip) {
+                UINT sub = mip + slice * pool.mipLevels;
+                ctx->CopySubresourceRegion(texture.Get(), sub, 0, 0, 0, pool.texture.Get(), sub, nullptr);
+            }
+        }
+
+        pool.texture = texture;
+        pool.srv = srv;
+        pool.capacity = capacity;
+        return true;
+    }
+
+    /**
+     * @brief パスのキャッシュのキー(小文字、区切りは '/')
+     */
+    static std::string PathKey(const char* filepath) {
+        std::string key = filepath;
+        for (char& c : key) {
+            if (c == '\\') c = '/';
+            else if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return key;
+    }
+
+    // キャッシュにあれば参照カウントを増やして返す
+    TextureHandle acquireCached(const std::string& key) {
+        auto p = pathCache_.find(key);
+        if (p == pathCache_.end()) return INVALID_TEXTURE;
+        auto it = textures_.find(p->second);
+        if (it == textures_.end()) {
+            pathCache_.erase(p);
+            return INVALID_TEXTURE;
+        }
+        it->second.refCount++;
+        return p->second;
+    }
+
+    // 読み込んだハンドルをパスのキャッシュに登録(sourcePath は退避後の読み込み直しに使う)
+    TextureHandle cachePath(const std::string& key, TextureHandle handle, const char* sourcePath = nullptr) {
+        if (handle == INVALID_TEXTURE) return handle;
+        pathCache_[key] = handle;
+        TextureData& t = textures_[handle];
+        if (sourcePath && t.sourcePath.empty() && t.pool == 0) t.sourcePath = sourcePath;
+        return handle;
+    }
+
+    /**
+     * @brief ピクセルデータのハッシュ(8バイト単位のFNV-1a、サイズと設定も含む)
+     */
+    static uint64_t HashPixels(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint32_t channels, bool mips) {
+        const uint64_t PRIME = 0x100000001b3ull;
+        uint64_t h = 0xcbf29ce484222325ull;
+        h = (h ^ ((static_cast<uint64_t>(width) << 32) | height)) * PRIME;
+        h = (h ^ ((static_cast<uint64_t>(channels) << 1) | (mips ? 1u : 0u))) * PRIME;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            h = (h ^ word) * PRIME;
+        }
+        for (; i < size; ++i) {
+            h = (h ^ data[i]) * PRIME;
+        }
+        return h != 0 ? h : 1;
+    }
+
+    /**
+     * @brief 読み込むDDSのパス(DDSでも同名の .dds もなければ空)
+     */
+    static std::string ResolveCompressedPath(const char* filepath) {
+        if (DdsLoader::IsDdsPath(filepath)) return filepath;
+        std::string path = filepath;
+        size_t dot = path.find_last_of('.');
+        size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return std::string();
+        path.replace(dot, std::string::npos, ".dds");
+        return AssetArchive::Exists(path) ? path : std::string();
+    }
+
+    /**
+     * @brief sRGB(0〜255) -> 線形(0〜1) の変換表
+     */
+    static const float* SrgbToLinearTable() {
+        static const struct Table {
+            float values[256];
+            Table() {
+                for (int i = 0; i < 256; ++i) {
+                    float c = i / 255.0f;
+                    values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+            }
+        } table;
+        return table.values;
+    }
+
+    static uint8_t LinearToSrgb(float linear) {
+        float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        c = (std::min)(1.0f, (std::max)(0.0f, c));
+        return static_cast<uint8_t>(c * 255.0f + 0.5f);
+    }
+
+    // 画面上の大きさから必要なミップを決める(通知がなければ最大解像度)
+    uint32_t wantedMip(const TextureData& t) const {
+        const std::vector<MipLevel>& mips = t.stream->mips;
+        if (t.requestFrame == UINT64_MAX || t.requestedPixels == 0) return 0;
+        uint32_t mip = 0;
+        while (mip + 1 < mips.size() && (std::max)(mips[mip + 1].width, mips[mip + 1].height) >= t.requestedPixels) ++mip;
+        return mip;
+    }
+
+    /**
+     * @brief mips[top] 以下を常駐させたテクスチャに作り直す
+     * @return size_t CPUから転送したバイト数(既存のミップはGPU上でコピー)
+     */
+    size_t makeResident(TextureData& t, uint32_t top) {
+        const std::vector<MipLevel>& mips = t.stream->mips;
+        const uint32_t mipCount = static_cast<uint32_t>(mips.size());
+
+        D3D11_TEXTURE2D_DESC texDesc{};
+        texDesc.Width = mips[top].width;
+        texDesc.Height = mips[top].height;
+        texDesc.MipLevels = mipCount - top;
+        texDesc.ArraySize = 1;
+        texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        texDesc.SampleDesc.Count = 1;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        if (FAILED(gfx_->Dev()->CreateTexture2D(&texDesc, nullptr, &texture))) {
+            DEBUGLOG_ERROR("TextureManager - ストリーミング用テクスチャの作成失敗: " + t.stream->path);
+            return 0;
+        }
+
+        size_t uploaded = 0;
+        size_t resident = 0;
+        ID3D11DeviceContext* ctx = gfx_->Ctx();
+        for (uint32_t level = top; level < mipCount; ++level) {
+            UINT dst = level - top;
+            const MipLevel& mip = mips[level];
+            if (t.texture && level >= t.residentMip) {
+                ctx->CopySubresourceRegion(texture.Get(), dst, 0, 0, 0, t.texture.Get(), level - t.residentMip, nullptr);
+            } else {
+                ctx->UpdateSubresource(texture.Get(), dst, nullptr, mip.pixels.data(), mip.width * 4, 0);
+                uploaded += mip.pixels.size();
+            }
+            resident += mip.pixels.size();
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+        srvDesc.Format = texDesc.Format;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
+
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+        if (FAILED(gfx_->Dev()->CreateShaderResourceView(texture.Get(), &srvDesc, &srv))) {
+            DEBUGLOG_ERROR("TextureManager - ストリーミング用SRVの作成失敗: " + t.stream->path);
+            return uploaded;
+        }
+
+        residentBytes_ = residentBytes_ - t.residentBytes + resident;
+        t.texture = texture;
+        t.srv = srv;
+        t.width = texDesc.Width;
+        t.height = texDesc.Height;
+        t.residentMip = top;
+        t.residentBytes = resident;
+        return uploaded;
+    }
+
+    // 予算を超えている間、最後の通知が古いテクスチャの最上位ミップを破棄
+    void enforceBudget() {
+        while (residentBytes_ > streamingBudget_) {
+            TextureData* victim = nullptr;
+            for (TextureHandle handle : streaming_) {
+                auto it = textures_.find(handle);
+                if (it == textures_.end() || !it->second.stream || !it->second.texture) continue;
+                TextureData& t = it->second;
+                if (t.residentMip + 1 >= t.stream->mips.size()) continue; // 最小ミップは残す
+                // 通知のないテクスチャ(UINT64_MAX)は最後に回す
+                if (!victim || t.requestFrame < victim->requestFrame) victim = &t;
+            }
+            if (!victim) break;
+            makeResident(*victim, victim->residentMip + 1);
+        }
+    }
+
+    // created の内容を handle へ移す(handle の元の内容はキャッシュ・配列の配置・ストリーミングごと外す)
+    // created が firstNew 以降なら新しく作ったもので、仮のハンドルは消える。それ以前なら既存の共有を1つ返却する
+    void replaceContents(TextureHandle handle, TextureHandle created, TextureHandle firstNew) {
+        // 元の内容のキャッシュ・配列の配置・ストリーミングを外す
+        TextureData& t = textures_[handle];
+        auto c = contentCache_.find(t.contentHash);
+        if (c != contentCache_.end() && c->second == handle) contentCache_.erase(c);
+        if (t.pool != 0) pools_[t.pool - 1].freeSlices.push_back(t.slice);
+        residentBytes_ -= t.residentBytes;
+        if (t.evicted) --evictedCount_;
+        t.evicted = false;
+        t.stream.reset();
+        t.residentBytes = 0;
+        t.residentMip = UINT32_MAX;
+        t.requestFrame = UINT64_MAX;
+
+        TextureData& src = textures_[created];
+        t.texture = src.texture;
+        t.srv = src.srv;
+        t.width = src.width;
+        t.height = src.height;
+        if (created >= firstNew) {
+            // 新しく作ったものは配置とキャッシュごと引き継いで仮のハンドルを消す
+            t.contentHash = src.contentHash;
+            t.pool = src.pool;
+            t.slice = src.slice;
+            if (t.contentHash != 0) contentCache_[t.contentHash] = handle;
+            textures_.erase(created);
+        } else {
+            // 同じ内容の既存テクスチャを共有した場合は、配置とキャッシュはそちらに残す
+            t.contentHash = 0;
+            t.pool = 0;
+            t.slice = 0;
+            Release(created);
+        }
+    }
+
+    // ReloadAsync() のデコードが終わったものを差し替える
+    void finishReloads() {
+        size_t write = 0;
+        for (size_t read = 0; read < pendingReloads_.size(); ++read) {
+            std::shared_ptr<PendingReload>& pending = pendingReloads_[read];
+            if (!pending->decoded.load(std::memory_order_acquire)) {
+                pendingReloads_[write++] = std::move(pending);
+                continue;
+            }
+            if (pending->superseded || !textures_.count(pending->handle)) continue; // 新しい要求がある・解放済み
+            if (!pending->succeeded) {
+                DEBUGLOG_WARNING("TextureManager::ReloadAsync() - 読み込み失敗: " + pending->path);
+                continue;
+            }
+            const TextureHandle firstNew = nextHandle_;
+            TextureHandle created = CreateTextureFromPixels(std::move(pending->pixels), pending->width, pending->height);
+            if (created != INVALID_TEXTURE) {
+                replaceContents(pending->handle, created, firstNew);
+                DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Texture reloaded: " + pending->path);
+            }
+        }
+        pendingReloads_.resize(write);
+    }
+
+    // t.sourcePath のデコードをワーカーで始め、ストリーミングの管理に加える
+    void startStream(TextureHandle handle, TextureData& t) {
+        auto state = std::make_shared<StreamState>();
+        state->path = t.sourcePath;
+        t.stream = state;
+        t.residentMip = UINT32_MAX;
+        t.residentBytes = 0;
+        t.requestFrame = UINT64_MAX;
+        streaming_.push_back(handle);
+
+        Microsoft::WRL::ComPtr<IWICImagingFactory> factory = wicFactory_;
+        auto decode = [state, factory]() {
+            // ワーカースレッドでもWICを使えるようにCOMを初期化(既に初期化済みなら参照カウントのみ)
+            HRESULT co = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            std::vector<uint8_t> pixels;
+            UINT width = 0, height = 0;
+            if (SUCCEEDED(DecodeRGBA(factory.Get(), state->path.c_str(), pixels, width, height))) {
+                BuildMipChain(std::move(pixels), width, height, state->mips);
+                state->succeeded = true;
+            }
+            if (SUCCEEDED(co)) CoUninitialize();
+            state->decoded.store(true, std::memory_order_release);
+        };
+
+        if (jobs_ && jobs_->IsRunning()) {
+            jobs_->Submit(decode, &decodes_);
+        } else {
+            decode();
+        }
+    }
+
+    // 使われていないフレームが RESIDENCY_IDLE_FRAMES 以上か(予算がなければ常に false)
+    bool isIdle(const TextureData& t) const {
+        return residencyBudget_ != 0 && frame_ >= t.lastUsedFrame.load(std::memory_order_relaxed) + RESIDENCY_IDLE_FRAMES;
+    }
+
+    // 退避したテクスチャの読み込み直しを始め、VRAMが予算を超えていれば使われていないものから減らす
+    void updateResidency() {
+        residency_.evictionsLastUpdate = 0;
+        residency_.reloadsLastUpdate = 0;
+        for (TextureHandle handle : reloadRequests_) {
+            auto it = textures_.find(handle);
+            if (it == textures_.end() || !it->second.evicted) continue; // 解放済み・差し替え済み
+            TextureData& t = it->second;
+            t.evicted = false;
+            t.reloadRequested.store(false, std::memory_order_relaxed);
+            --evictedCount_;
+            startStream(handle, t);
+            ++residency_.reloadsLastUpdate;
+        }
+        reloadRequests_.clear();
+
+        size_t total = 0;
+        for (const ArrayPool& pool : pools_) total += GfxDevice::TextureBytes(pool.texture.Get());
+        evictionCandidates_.clear();
+        for (auto& pair : textures_) {
+            TextureData& t = pair.second;
+            measure(t);
+            total += t.gpuBytes;
+            if (!t.texture || pair.first == defaultWhiteTexture_ || t.pool != 0 || !isIdle(t)) continue;
+            if (t.stream ? t.residentMip + 1 < t.stream->mips.size() : !t.sourcePath.empty()) {
+                evictionCandidates_.push_back(pair.first);
+            }
+        }
+        residency_.gpuBytes = total;
+        if (residencyBudget_ == 0 || total <= residencyBudget_) return;
+
+        // 最後に参照されたのが古い順(同じなら先に作ったもの)
+        std::sort(evictionCandidates_.begin(), evictionCandidates_.end(), [this](TextureHandle a, TextureHandle b) {
+            const uint64_t fa = textures_.at(a).lastUsedFrame.load(std::memory_order_relaxed);
+            const uint64_t fb = textures_.at(b).lastUsedFrame.load(std::memory_order_relaxed);
+            return fa != fb ? fa < fb : a < b;
+        });
+        for (TextureHandle handle : evictionCandidates_) {
+            if (total <= residencyBudget_) break;
+            TextureData& t = textures_.at(handle);
+            if (t.stream) {
+                // 最小ミップを残して最上位から落とす
+                while (total > residencyBudget_ && t.residentMip + 1 < t.stream->mips.size()) {
+                    const uint32_t top = t.residentMip;
+                    const size_t before = t.gpuBytes;
+                    makeResident(t, top + 1);
+                    if (t.residentMip == top) break; // 作り直しに失敗
+                    ++residency_.evictionsLastUpdate;
+                    measure(t);
+                    total -= (std::min)(total, before - (std::min)(before, t.gpuBytes));
+                }
+            } else {
+                const size_t before = t.gpuBytes;
+                t.texture.Reset();
+                t.srv.Reset();
+                t.evicted = true;
+                t.reloadRequested.store(false, std::memory_order_relaxed);
+                ++evictedCount_;
+                ++residency_.evictionsLastUpdate;
+                measure(t);
+                total -= (std::min)(total, before);
+            }
+        }
+        residency_.gpuBytes = total;
+    }
+
+    // テクスチャが作り直されていればGPUメモリを数え直す
+    static void measure(TextureData& t) {
+        if (t.measured == t.texture.Get()) return;
+        t.measured = t.texture.Get();
+        t.gpuBytes = GfxDevice::TextureBytes(t.texture.Get());
+    }
+
+    void waitDecodes() {
+        if (jobs_ && !decodes_.IsDone()) {
+            jobs_->Wait(decodes_);
+        }
+    }
+
     GfxDevice* gfx_ = nullptr;                          ///< グラフィックスデバイスへのポインタ
     Microsoft::WRL::ComPtr<IWICImagingFactory> wicFactory_; ///< Shared WIC factory instance
     TextureHandle nextHandle_ = 1;                      ///< 次に割り当てるハンドル
     TextureHandle defaultWhiteTexture_ = INVALID_TEXTURE; ///< デフォルト白テクスチャ
     std::unordered_map<TextureHandle, TextureData> textures_; ///< テクスチャマップ
     bool isShutdown_ = false;                           ///< シャットダウン済みフラグ
+
+    // ストリーミング
+    JobSystem* jobs_ = nullptr;                         ///< デコード用(nullptrで呼び出しスレッド)
+    JobSystem::JobCounter decodes_;                     ///< デコード中のジョブ
+    std::vector<TextureHandle> streaming_;              ///< ストリーミング中のハンドル
+    std::vector<std::shared_ptr<PendingReload>> pendingReloads_; ///< ReloadAsync() のデコード中のもの
+    size_t streamingBudget_ = DEFAULT_STREAMING_BUDGET; ///< 常駐量の上限
+    size_t residentBytes_ = 0;                          ///< 現在の常駐量
+
+    // 常駐管理
+    size_t residencyBudget_ = 0;                        ///< テクスチャのVRAMの上限(0は無制限)
+    size_t evictedCount_ = 0;                           ///< 退避中のテクスチャ数
+    ResidencyStats residency_;                          ///< 直近の Update() の集計
+    mutable std::vector<TextureHandle> reloadRequests_; ///< 退避中に GetSRV() で参照されたハンドル
+    mutable std::mutex reloadMutex_;                    ///< reloadRequests_ の追加(GetSRV() はワーカーからも呼ばれる)
+    std::vector<TextureHandle> evictionCandidates_;     ///< 減らす候補(容量を使い回す)
+
+    // キャッシュ
+    std::unordered_map<std::string, TextureHandle> pathCache_; ///< パス(PathKey) -> ハンドル
+    std::unordered_map<uint64_t, TextureHandle> contentCache_;  ///< 内容のハッシュ -> ハンドル
+
+    // 共有テクスチャ配列
+    bool arrayPooling_ = false;                         ///< 作成時に共有配列へ配置するか
+    std::vector<ArrayPool> pools_;                      ///< プール番号 - 1 で引く
+    uint64_t frame_ = 0;                                ///< Update() の呼び出し回数
 };
 
@@ -0,0 +1,295 @@
+/**
+ * @file TransparentQueue.h
+ * @brief 半透明の描画パケットを奥から手前へ並べ、重ならないものをまとめる描画キュー
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 半透明はブレンドの結果が描く順番で変わるため、不透明の RenderQueue のようにステート順には並べられません。
+ * TransparentQueue はパケットをビュー空間の奥行き(境界球の中心)で奥から手前へ並べます。
+ *
+ * - **差分ソート**: 前のフレームの順番(呼び出し側が渡す安定した id ごと)を初期の並びにして挿入ソートします。
+ *   カメラや物体の動きが小さければほぼ整列済みなので、ほぼ線形の時間で終わります。
+ *   入れ替えが多すぎる場合(カメラの急な旋回など)は途中で std::stable_sort に切り替えます。
+ * - **まとめ描き**: 同じステート(マテリアル・メッシュ・頂点形式)のパケットは、間に挟まる描画と画面上で重ならなければ
+ *   前のまとまりへ移して続けて描きます。重ならないもの同士は順番を入れ替えても結果が変わらないためです。
+ *   画面上の範囲は境界球を投影した矩形(NDC)で、ニアクリップをまたぐ球は画面全体として扱います。
+ *
+ * id が重複しても描画順は正しく、前のフレームの順番を初期値として使えないだけです。
+ * メインスレッド専用です。
+ *
+ * @par 使用例
+ * @code
+ * transparent.Clear();
+ * DrawPacket& p = transparent.Push(entity.Packed(), center, radius);
+ * // ... p の内容を設定 ...
+ * transparent.Prepare(cam.View, cam.Proj, cam.nearZ, &cam.frustum);
+ * for (size_t i = 0; i < transparent.Size(); ++i) {
+ *     const DrawPacket& packet = transparent.Sorted(i);
+ * }
+ * @endcode
+ */
+#pragma once
+#include "graphics/FrustumCulling.h"
+#include "graphics/RenderQueue.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TransparentQueue
+ * @brief 半透明の描画パケットの差分ソートとまとめ描き
+ */
+class TransparentQueue {
+public:
+    static constexpr size_t BATCH_LOOKBACK = 8;         ///< まとめ先を探す直前のまとまりの数
+    static constexpr size_t SHIFTS_PER_ITEM = 8;        ///< 挿入ソートの移動回数の上限(1パケットあたり、超えたら全体をソート)
+
+    /**
+     * @struct Stats
+     * @brief 直前の Prepare() の結果
+     */
+    struct Stats {
+        size_t culled = 0;      ///< 視錐台の外で除いたパケット
+        size_t batches = 0;     ///< ステートをまとめた描画のまとまり
+        size_t merged = 0;      ///< 前のまとまりへ移したパケット
+        size_t shifts = 0;      ///< 挿入ソートの移動回数
+        bool fullSort = false;  ///< 差分ソートをやめて全体をソートしたか
+    };
+
+    /**
+     * @brief パケットを空にする(前のフレームの順番は残す)
+     */
+    void Clear() {
+        items_.clear();
+        packets_.clear();
+        draw_.clear();
+    }
+
+    /**
+     * @brief 前のフレームの順番も捨てる(ワールドの切り替え時など)
+     */
+    void Reset() {
+        Clear();
+        ranks_.clear();
+    }
+
+    /**
+     * @brief パケットを追加(返した参照は次の Push() まで有効)
+     * @param[in] id フレームをまたいで同じ描画を指す値(エンティティなど)
+     * @param[in] center ワールド空間の境界球の中心
+     * @param[in] radius 境界球の半径
+     */
+    DrawPacket& Push(uint64_t id, const DirectX::XMFLOAT3& center, float radius) {
+        Item item;
+        item.id = id;
+        item.center = center;
+        item.radius = radius;
+        items_.push_back(item);
+        packets_.emplace_back();
+        return packets_.back();
+    }
+
+    bool Empty() const { return packets_.empty(); }
+
+    /**
+     * @brief カリング・奥から手前へのソート・まとめ描きの順番を決める
+     * @param[in] view ビュー行列
+     * @param[in] proj プロジェクション行列
+     * @param[in] nearZ ニアクリップ
+     * @param[in] frustum 視錐台(nullptr ならカリングしない)
+     */
+    void Prepare(const DirectX::XMMATRIX& view, const DirectX::XMMATRIX& proj, float nearZ, const Frustum* frustum) {
+        stats_ = Stats{};
+        draw_.clear();
+
+        // カリングと奥行き・画面上の範囲
+        visible_.clear();
+        const float scaleX = DirectX::XMVectorGetX(proj.r[0]);
+        const float scaleY = DirectX::XMVectorGetY(proj.r[1]);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(items_.size()); ++i) {
+            Item& item = items_[i];
+            if (frustum && !frustum->IntersectsSphere(item.center, item.radius)) {
+                stats_.culled++;
+                continue;
+            }
+            DirectX::XMFLOAT3 v;
+            DirectX::XMStoreFloat3(&v, DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&item.center), view));
+            item.depth = v.z;
+            ProjectBounds(v, item.radius, nearZ, scaleX, scaleY, item.rect);
+            visible_.push_back(i);
+        }
+
+        SortBackToFront();
+        BuildBatches();
+
+        // 次のフレームの初期の並び
+        ranks_.clear();
+        for (uint32_t k = 0; k < static_cast<uint32_t>(order_.size()); ++k) {
+            ranks_.emplace(items_[order_[k]].id, k);
+        }
+    }
+
+    /**
+     * @brief 描画するパケット数(Prepare() 後)
+     */
+    size_t Size() const { return draw_.size(); }
+
+    /**
+     * @brief 描画順の i 番目のパケット(Prepare() 後)
+     */
+    const DrawPacket& Sorted(size_t i) const { return packets_[draw_[i]]; }
+
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Rect {
+        float minX, minY, maxX, maxY;  ///< NDC
+    };
+
+    struct Item {
+        uint64_t id = 0;
+        DirectX::XMFLOAT3 center{ 0.0f, 0.0f, 0.0f };
+        float radius = 0.0f;
+        float depth = 0.0f;   ///< ビュー空間のZ
+        Rect rect{};
+        uint32_t next = NONE; ///< 同じまとまりの次のパケット
+    };
+
+    struct Batch {
+        uint32_t first;
+        uint32_t last;
+        Rect rect;            ///< まとまりのパケットの範囲の和
+    };
+
+    /**
+     * @brief ビュー空間の境界球を NDC の矩形に投影(球を囲む箱の角の投影を含む保守的な範囲)
+     */
+    static void ProjectBounds(const DirectX::XMFLOAT3& v, float r, float nearZ, float scaleX, float scaleY, Rect& out) {
+        const float zNear = v.z - r;
+        if (zNear <= nearZ) {
+            out = Rect{ -1.0f, -1.0f, 1.0f, 1.0f };
+            return;
+        }
+        const float zFar = v.z + r;
+        auto project = [&](float c, float scale, float& lo, float& hi) {
+            lo = (c - r) / ((c - r) < 0.0f ? zNear : zFar) * scale;
+            hi = (c + r) / ((c + r) > 0.0f ? zNear : zFar) * scale;
+        };
+        project(v.x, scaleX, out.minX, out.maxX);
+        project(v.y, scaleY, out.minY, out.maxY);
+    }
+
+    static bool Overlaps(const Rect& a, const Rect& b) {
+        return a.minX < b.maxX && b.minX < a.maxX && a.minY < b.maxY && b.minY < a.maxY;
+    }
+
+    static void Merge(Rect& a, const Rect& b) {
+        a.minX = (std::min)(a.minX, b.minX);
+        a.minY = (std::min)(a.minY, b.minY);
+        a.maxX = (std::max)(a.maxX, b.maxX);
+        a.maxY = (std::max)(a.maxY, b.maxY);
+    }
+
+    /**
+     * @brief 続けて描くときにステートの設定がいらないか(VS定数以外が同じ)
+     */
+    static bool SameState(const DrawPacket& a, const DrawPacket& b) {
+        return a.materialBuffer == b.materialBuffer && a.texture == b.texture && a.normalTexture == b.normalTexture &&
+               a.vertexBuffer == b.vertexBuffer && a.indexBuffer == b.indexBuffer && a.vertexFormat == b.vertexFormat &&
+               a.skinBuffer == b.skinBuffer;
+    }
+
+    /**
+     * @brief 前のフレームの順番を初期値にして奥から手前へ並べる(order_)
+     */
+    void SortBackToFront() {
+        // 前のフレームにあった id はその順番、新しい id は後ろに追加
+        slots_.assign(ranks_.size(), NONE);
+        fresh_.clear();
+        for (uint32_t i : visible_) {
+            auto it = ranks_.find(items_[i].id);
+            if (it != ranks_.end() && slots_[it->second] == NONE) {
+                slots_[it->second] = i;
+            } else {
+                fresh_.push_back(i);
+            }
+        }
+        order_.clear();
+        for (uint32_t i : slots_) {
+            if (i != NONE) order_.push_back(i);
+        }
+        order_.insert(order_.end(), fresh_.begin(), fresh_.end());
+
+        auto farther = [this](uint32_t a, uint32_t b) { return items_[a].depth > items_[b].depth; };
+        const size_t budget = order_.size() * SHIFTS_PER_ITEM;
+        for (size_t k = 1; k < order_.size(); ++k) {
+            const uint32_t value = order_[k];
+            size_t j = k;
+            while (j > 0 && farther(value, order_[j - 1])) {
+                order_[j] = order_[j - 1];
+                --j;
+            }
+            order_[j] = value;
+            stats_.shifts += k - j;
+            if (stats_.shifts > budget) {
+                std::stable_sort(order_.begin(), order_.end(), farther);
+                stats_.fullSort = true;
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief 同じステートで重ならないパケットを前のまとまりへ移し、描画順(draw_)を作る
+     */
+    void BuildBatches() {
+        batches_.clear();
+        for (uint32_t i : order_) {
+            Item& item = items_[i];
+            item.next = NONE;
+            size_t target = batches_.size();
+            const size_t limit = batches_.size() > BATCH_LOOKBACK ? batches_.size() - BATCH_LOOKBACK : 0;
+            for (size_t b = batches_.size(); b-- > limit;) {
+                if (SameState(packets_[batches_[b].first], packets_[i])) {
+                    target = b;
+                    break;
+                }
+                if (Overlaps(batches_[b].rect, item.rect)) break;  // 重なる描画は追い越せない
+            }
+            if (target == batches_.size()) {
+                batches_.push_back(Batch{ i, i, item.rect });
+                continue;
+            }
+            Batch& batch = batches_[target];
+            items_[batch.last].next = i;
+            batch.last = i;
+            Merge(batch.rect, item.rect);
+            if (target + 1 != batches_.size()) stats_.merged++;
+        }
+
+        for (const Batch& batch : batches_) {
+            for (uint32_t i = batch.first; i != NONE; i = items_[i].next) {
+                draw_.push_back(i);
+            }
+        }
+        stats_.batches = batches_.size();
+    }
+
+    std::vector<Item> items_;                      ///< Push() の順
+    std::vector<DrawPacket> packets_;              ///< items_ と同じ順
+    std::vector<uint32_t> visible_;                ///< カリング後のパケット
+    std::vector<uint32_t> slots_;                  ///< 前のフレームの順番ごとのパケット
+    std::vector<uint32_t> fresh_;                  ///< 前のフレームになかったパケット
+    std::vector<uint32_t> order_;                  ///< 奥から手前の順
+    std::vector<Batch> batches_;
+    std::vector<uint32_t> draw_;                   ///< 描画順
+    std::unordered_map<uint64_t, uint32_t> ranks_; ///< 前のフレームの id ごとの順番
+    Stats stats_;
+};
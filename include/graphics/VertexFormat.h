@@ -0,0 +1,191 @@
+/**
+ * @file VertexFormat.h
+ * @brief メッシュの頂点形式と、属性を量子化した小さな頂点への変換
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 標準の頂点(56バイト)は位置・UV・法線・接線・従接線をすべて float で持ちます。
+ * モデルは読み込み時に(ModelLoader::SetVertexFormat)、次の小さな形式に変換できます。
+ *
+ * | 形式             | 位置                                   | UV             | 法線・接線                     | 大きさ   |
+ * |------------------|----------------------------------------|----------------|--------------------------------|----------|
+ * | Standard         | R32G32B32_FLOAT                        | R32G32_FLOAT   | R32G32B32_FLOAT x 3            | 56バイト |
+ * | Compact          | R32G32B32_FLOAT                        | R16G16_FLOAT   | R16G16B16A16_SNORM(八面体 x 2) | 24バイト |
+ * | CompactQuantized | R16G16B16A16_UNORM(メッシュごとに逆量子化) | R16G16_FLOAT   | R16G16B16A16_SNORM(八面体 x 2) | 20バイト |
+ *
+ * 法線と接線は八面体写像で2成分ずつにし、従接線は cross(法線, 接線) と符号から頂点シェーダーで復元します。
+ * 符号は接線の2成分目に畳み込みます(w = 符号 x (y x 0.5 + 0.5))。
+ *
+ * 量子化した位置はメッシュの AABB の最小点を原点、最も長い辺を1とした [0, 1] の値です。
+ * 逆量子化は一様な拡大と平行移動なので(PositionDequantMatrix())、ワールド行列に掛けて頂点シェーダーに渡せば
+ * 法線の向きも変わりません(長さはピクセルシェーダーで正規化する)。
+ */
+#pragma once
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @enum VertexFormat
+ * @brief メッシュの頂点形式
+ */
+enum class VertexFormat : uint8_t {
+    Standard,           ///< すべて float(56バイト)
+    Compact,            ///< half の UV と八面体の法線・接線(24バイト)
+    CompactQuantized    ///< Compact の位置を16ビットに量子化(20バイト)
+};
+
+constexpr size_t VERTEX_FORMAT_COUNT = 3;
+
+/**
+ * @struct CompactVertex
+ * @brief VertexFormat::Compact の頂点
+ */
+struct CompactVertex {
+    DirectX::XMFLOAT3 position;  ///< 位置
+    uint16_t uv[2];              ///< UV(half)
+    int16_t frame[4];            ///< 法線(xy)と接線(zw、w に従接線の符号)の八面体写像(snorm)
+};
+
+/**
+ * @struct QuantizedVertex
+ * @brief VertexFormat::CompactQuantized の頂点
+ */
+struct QuantizedVertex {
+    uint16_t position[4];        ///< 逆量子化前の位置(unorm、w は未使用)
+    uint16_t uv[2];              ///< UV(half)
+    int16_t frame[4];            ///< CompactVertex::frame と同じ
+};
+
+static_assert(sizeof(CompactVertex) == 24, "CompactVertex must be 24 bytes");
+static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex must be 20 bytes");
+
+/**
+ * @brief 頂点形式ごとの1頂点のバイト数
+ */
+constexpr UINT VertexStride(VertexFormat format) {
+    return format == VertexFormat::Compact ? static_cast<UINT>(sizeof(CompactVertex))
+         : format == VertexFormat::CompactQuantized ? static_cast<UINT>(sizeof(QuantizedVertex))
+         : 56u;
+}
+
+/**
+ * @struct VertexCompression
+ * @brief 頂点属性の量子化
+ *
+ * @par 使用例
+ * @code
+ * DirectX::XMFLOAT4 dequant = VertexCompression::ComputePositionDequant(positions, count, sizeof(Vertex));
+ * QuantizedVertex q;
+ * VertexCompression::QuantizePosition(v.pos, dequant, q.position);
+ * VertexCompression::PackUv(v.tex, q.uv);
+ * VertexCompression::PackTangentFrame(v.nrm, v.tan, v.bitan, q.frame);
+ * @endcode
+ */
+struct VertexCompression {
+    /**
+     * @brief 位置の逆量子化の係数(AABB の最小点と最も長い辺)
+     * @param[in] positions 先頭の頂点の位置
+     * @param[in] stride 頂点の間隔(バイト)
+     * @return DirectX::XMFLOAT4 xyz: 原点(AABB の最小点), w: 拡大率(0 の場合は 1)
+     */
+    static DirectX::XMFLOAT4 ComputePositionDequant(const DirectX::XMFLOAT3* positions, size_t count, size_t stride) {
+        if (count == 0) return DirectX::XMFLOAT4{ 0.0f, 0.0f, 0.0f, 1.0f };
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(positions);
+        DirectX::XMFLOAT3 minP = *positions;
+        DirectX::XMFLOAT3 maxP = *positions;
+        for (size_t i = 1; i < count; ++i) {
+            const DirectX::XMFLOAT3& v = *reinterpret_cast<const DirectX::XMFLOAT3*>(p + i * stride);
+            minP.x = (std::min)(minP.x, v.x); maxP.x = (std::max)(maxP.x, v.x);
+            minP.y = (std::min)(minP.y, v.y); maxP.y = (std::max)(maxP.y, v.y);
+            minP.z = (std::min)(minP.z, v.z); maxP.z = (std::max)(maxP.z, v.z);
+        }
+        float extent = (std::max)(maxP.x - minP.x, (std::max)(maxP.y - minP.y, maxP.z - minP.z));
+        return DirectX::XMFLOAT4{ minP.x, minP.y, minP.z, extent > 0.0f ? extent : 1.0f };
+    }
+
+    /**
+     * @brief 逆量子化の行列(量子化した位置 → メッシュのローカル空間)
+     *
+     * @details
+     * ワールド行列の前に掛けます(dequant * world)。
+     */
+    static DirectX::XMMATRIX PositionDequantMatrix(const DirectX::XMFLOAT4& dequant) {
+        return DirectX::XMMatrixScaling(dequant.w, dequant.w, dequant.w) * DirectX::XMMatrixTranslation(dequant.x, dequant.y, dequant.z);
+    }
+
+    static void QuantizePosition(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT4& dequant, uint16_t out[4]) {
+        const float inv = 1.0f / dequant.w;
+        out[0] = ToUnorm16((position.x - dequant.x) * inv);
+        out[1] = ToUnorm16((position.y - dequant.y) * inv);
+        out[2] = ToUnorm16((position.z - dequant.z) * inv);
+        out[3] = 0;
+    }
+
+    static void PackUv(const DirectX::XMFLOAT2& uv, uint16_t out[2]) {
+        out[0] = DirectX::PackedVector::XMConvertFloatToHalf(uv.x);
+        out[1] = DirectX::PackedVector::XMConvertFloatToHalf(uv.y);
+    }
+
+    /**
+     * @brief 法線・接線を八面体写像に、従接線を符号にして詰める
+     *
+     * @details
+     * 符号は dot(cross(法線, 接線), 従接線) の正負です。接線の2成分目 y は
+     * w = 符号 x (y x 0.5 + 0.5) として書き込み、0 にならないよう最小の大きさで切り上げます。
+     */
+    static void PackTangentFrame(const DirectX::XMFLOAT3& normal, const DirectX::XMFLOAT3& tangent, const DirectX::XMFLOAT3& bitangent, int16_t out[4]) {
+        float nx, ny, tx, ty;
+        EncodeOctahedral(normal, nx, ny);
+        EncodeOctahedral(tangent, tx, ty);
+
+        DirectX::XMVECTOR n = DirectX::XMLoadFloat3(&normal);
+        DirectX::XMVECTOR t = DirectX::XMLoadFloat3(&tangent);
+        DirectX::XMVECTOR b = DirectX::XMLoadFloat3(&bitangent);
+        const float sign = DirectX::XMVectorGetX(DirectX::XMVector3Dot(DirectX::XMVector3Cross(n, t), b)) < 0.0f ? -1.0f : 1.0f;
+
+        constexpr float MIN_MAGNITUDE = 1.0f / 32767.0f;
+        const float w = (std::max)(ty * 0.5f + 0.5f, MIN_MAGNITUDE) * sign;
+
+        out[0] = ToSnorm16(nx);
+        out[1] = ToSnorm16(ny);
+        out[2] = ToSnorm16(tx);
+        out[3] = ToSnorm16(w);
+        if (out[3] == 0) out[3] = sign < 0.0f ? -1 : 1;
+    }
+
+    /**
+     * @brief 単位ベクトルの八面体写像([-1, 1] の2成分。長さ0のベクトルは +Z として扱う)
+     */
+    static void EncodeOctahedral(const DirectX::XMFLOAT3& v, float& x, float& y) {
+        const float l1 = std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z);
+        if (l1 <= 0.0f) {
+            x = 0.0f;
+            y = 0.0f;
+            return;
+        }
+        x = v.x / l1;
+        y = v.y / l1;
+        if (v.z < 0.0f) {
+            const float ox = x;
+            x = (1.0f - std::fabs(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+            y = (1.0f - std::fabs(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+        }
+    }
+
+    static int16_t ToSnorm16(float v) {
+        v = (std::min)((std::max)(v, -1.0f), 1.0f);
+        return static_cast<int16_t>(std::lround(v * 32767.0f));
+    }
+
+    static uint16_t ToUnorm16(float v) {
+        v = (std::min)((std::max)(v, 0.0f), 1.0f);
+        return static_cast<uint16_t>(std::lround(v * 65535.0f));
+    }
+};
@@ -1,9 +1,13 @@
 ﻿﻿#pragma once
 #include "graphics/GfxDevice.h"
+#include "graphics/ShaderCache.h"
+#include "app/DebugLog.h"
 #include "components/Component.h"
 #include "ecs/Entity.h"
 #include "ecs/World.h"
 #include <d3d11.h>
+#include <d3d10.h>
+#include <d3dcompiler.h>
 #include <mfapi.h>
 #include <mfidl.h>
 #include <mfreadwrite.h>
@@ -12,6 +16,9 @@
 #include <string>
 #include <cstdio>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <deque>
 
 #pragma comment(lib, "mf.lib")
 #pragma comment(lib, "mfplat.lib")
@@ -32,6 +39,23 @@
  * @details
  * Windows Media Foundationを使用して動画ファイルを再生します。
  * 動画フレームをテクスチャとして取得し、DirectX11で描画できます。
+ *
+ * ### デコード:
+ * - ソースリーダーは非同期(MF_SOURCE_READER_ASYNC_CALLBACK)で、ReadSample() は要求を出すだけで戻ります。
+ *   デコード済みのフレームは Media Foundation のスレッドから VideoReaderCallback に届き、
+ *   要求中と受け取り済みを合わせて PREFETCH_FRAMES 枚先まで先読みします(フレームを待ちません)。
+ * - 表示するフレームはタイムスタンプと再生時間で選びます。再生時間に達したフレームのうち最新の1枚だけを
+ *   テクスチャに反映し(遅れている場合はそれより前を捨てる)、達していなければ前のフレームを使い続けます。
+ *   テクスチャへのコピーは表示が変わるフレームで1回だけで、高リフレッシュレートでも動画のフレームレート以上はデコードしません。
+ * - GfxDevice::SupportsHardwareVideoDecode() の環境では MF_SOURCE_READER_D3D_MANAGER で DXVA のデコーダーに
+ *   同じデバイスを渡し、NV12 のテクスチャで受け取ります。GPU上でシェーダーから読めるテクスチャへコピーするだけで、CPUは画素に触れません。
+ *   VideoSurface(RenderSystem)は GetFrame() の輝度・色差を直接サンプリングして描きます。
+ *   GetSRV() を使う場合だけ、呼び出したときにピクセルシェーダーで YUV → RGB(BT.601 / BT.709、リミテッドレンジ)に変換します
+ *   (フレームが変わったときの1回だけ)。
+ * - 非対応環境では RGB32 に変換したフレームをステージングテクスチャのリングへ書き込み、
+ *   CopyResource で表示用テクスチャ(2枚を交互に使用)へ転送します。CPU の書き込み・GPU のコピー・サンプリングが
+ *   別のフレームのテクスチャを使うため互いを待ちません。書き込むステージングテクスチャのコピーがまだ終わっていない場合は
+ *   (Map の D3D11_MAP_FLAG_DO_NOT_WAIT をフェンスとして使う)待たずに前のフレームを表示し続け、次の Update() で書き込み直します。
  * 
  * ### サポート形式:
  * - MP4
@@ -50,12 +74,102 @@
  * while (running) {
  *     player.Update(deltaTime);
  *     ID3D11ShaderResourceView* texture = player.GetSRV();
- *     // テクスチャを描画
+ *     // テクスチャを描画(エンティティに VideoSurface を付ければ RenderSystem が変換せずに描く)
  * }
  * @endcode
  */
+/**
+ * @class VideoReaderCallback
+ * @brief 非同期のソースリーダーからデコード済みのフレームを受け取る
+ *
+ * @details
+ * OnReadSample() は Media Foundation のワーカースレッドから呼ばれます。結果は届いた順に溜め、
+ * メインスレッドが Drain() でまとめて受け取ります(VideoPlayer は先読みのため要求を複数出します)。
+ * ソースリーダーが参照を持つため、VideoPlayer の破棄後に届いた結果もこのオブジェクトが受け取って捨てます。
+ */
+class VideoReaderCallback : public IMFSourceReaderCallback {
+public:
+    /**
+     * @struct Result
+     * @brief ReadSample() 1回分の結果
+     */
+    struct Result {
+        HRESULT status = S_OK;                         ///< 読み込みの結果
+        DWORD flags = 0;                               ///< MF_SOURCE_READER_FLAG
+        LONGLONG timestamp = 0;                        ///< 表示時刻(100ナノ秒単位)
+        Microsoft::WRL::ComPtr<IMFSample> sample;      ///< フレーム(ストリームの終端などでは空)
+    };
+
+    STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override {
+        if (!ppv) return E_POINTER;
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFSourceReaderCallback)) {
+            *ppv = static_cast<IMFSourceReaderCallback*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) AddRef() override { return ++refCount_; }
+
+    STDMETHODIMP_(ULONG) Release() override {
+        ULONG count = --refCount_;
+        if (count == 0) delete this;
+        return count;
+    }
+
+    STDMETHODIMP OnReadSample(HRESULT status, DWORD, DWORD flags, LONGLONG timestamp, IMFSample* sample) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Result result;
+        result.status = status;
+        result.flags = flags;
+        result.timestamp = timestamp;
+        result.sample = sample;
+        results_.push_back(std::move(result));
+        return S_OK;
+    }
+
+    STDMETHODIMP OnFlush(DWORD) override { return S_OK; }
+    STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) override { return S_OK; }
+
+    /**
+     * @brief 届いた結果を届いた順に out の末尾へ移す
+     * @return size_t 移した件数
+     */
+    size_t Drain(std::deque<Result>& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t count = results_.size();
+        for (Result& result : results_) out.push_back(std::move(result));
+        results_.clear();
+        return count;
+    }
+
+private:
+    ~VideoReaderCallback() = default;
+
+    std::atomic<ULONG> refCount_{ 1 };
+    std::mutex mutex_;
+    std::deque<Result> results_;
+};
+
 class VideoPlayer {
 public:
+    static constexpr size_t PREFETCH_FRAMES = 3; ///< 先読みするフレーム数(ハードウェアデコードではデコーダーの面をこの数まで保持)
+    static constexpr uint32_t UPLOAD_RING_SIZE = 3; ///< CPU 変換時のステージングテクスチャ数
+
+    /**
+     * @struct Frame
+     * @brief 表示中のフレームのテクスチャ(描画側が直接サンプリングする)
+     */
+    struct Frame {
+        ID3D11ShaderResourceView* luma = nullptr;    ///< NV12 の輝度(R8、ハードウェアデコード時のみ)
+        ID3D11ShaderResourceView* chroma = nullptr;  ///< NV12 の色差(R8G8、半分の解像度)
+        ID3D11Buffer* convert = nullptr;             ///< YUV → RGB の係数と UV の倍率(HLSL の ConvertConstants)
+        ID3D11ShaderResourceView* rgb = nullptr;     ///< RGB のテクスチャ(CPU 変換時のみ)
+        uint64_t serial = 0;                         ///< 表示したフレームの通し番号(1から、変わらなければ同じフレーム)
+    };
+
     /**
      * @brief 初期化
      * @return bool 初期化に成功した場合true
@@ -89,7 +203,7 @@ public:
      * リソースを解放し、Media Foundationをシャットダウンします。
      */
     ~VideoPlayer() {
-        if (reader_) reader_.Reset();
+        close();
         if (mfInitialized_) {
             MFShutdown();
             mfInitialized_ = false;
@@ -105,39 +219,286 @@ public:
      * @details
      * 指定されたパスの動画ファイルを開き、再生準備を行います。
      * ファイルが見つからない場合やフォーマットが不正な場合はfalseを返します。
+     * ハードウェアデコードの準備に失敗した場合は CPU での変換で開き直します。
     */
     bool Open(GfxDevice& gfx, const char* filepath) {
         if (!mfInitialized_ && !Init()) {
             return false;
         }
 
+        close();
         gfx_ = &gfx;
         
         // ワイド文字列に変換
         wchar_t wpath[MAX_PATH];
         MultiByteToWideChar(CP_ACP, 0, filepath, -1, wpath, MAX_PATH);
 
-        // ソースリーダーを作成
+        if (gfx.SupportsHardwareVideoDecode()) {
+            if (openReader(wpath, true) && createHardwareResources()) {
+                hardwareDecode_ = true;
+            } else {
+                DEBUGLOG_WARNING(std::string("[VideoPlayer] ハードウェアデコードを使えないため CPU で変換します: ") + filepath);
+                close();
+                gfx_ = &gfx;
+            }
+        }
+
+        if (!hardwareDecode_) {
+            if (!openReader(wpath, false)) {
+                char msg[512];
+                sprintf_s(msg, "Failed to open video file: %s", filepath);
+                MessageBoxA(nullptr, msg, "Video Error", MB_OK | MB_ICONERROR);
+                return false;
+            }
+            // 動画テクスチャを作成
+            if (!createVideoTexture()) return false;
+        }
+
+        isOpen_ = true;
+        currentTime_ = 0.0f;
+
+        // Play() の前から最初のフレームをデコードさせておく
+        return fillPrefetch();
+    }
+
+    /**
+     * @brief フレームを更新
+     * @param[in] dt デルタタイム(秒単位)
+     * @return bool 更新に成功した場合true
+     * 
+     * @details
+     * 届いているフレームのうち、表示時刻に達した最新の1枚をテクスチャに反映し、先読みを補充します。
+     * デコードを待つことはなく、表示時刻に達したフレームがなければ前のフレームのまま true を返します。
+     * 再生中でない場合や動画の終端に達した場合はfalseを返します。
+     * ループが有効な場合、終端に達すると自動的に先頭に戻ります。
+     */
+    bool Update(float dt) {
+        if (!isOpen_ || !isPlaying_) return false;
+
+        currentTime_ += dt;
+        inFlight_ -= callback_->Drain(queue_);
+
+        // 再生時間に達したフレームのうち最新の1枚を選ぶ(それより前は表示せずに捨てる)
+        const LONGLONG clock = static_cast<LONGLONG>(static_cast<double>(currentTime_) * 1.0e7); // 100ナノ秒単位
+        Microsoft::WRL::ComPtr<IMFSample> due;
+        while (!queue_.empty()) {
+            VideoReaderCallback::Result& front = queue_.front();
+            if (FAILED(front.status)) {
+                DEBUGLOG_WARNING("[VideoPlayer] フレームの読み込み失敗 (HRESULT: 0x" + std::to_string(front.status) + ")");
+                queue_.clear();
+                isPlaying_ = false;
+                return false;
+            }
+            if (front.flags & MF_SOURCE_READERF_ENDOFSTREAM) {
+                // 終端より後の結果はすべて終端なので捨てる
+                endOfStream_ = true;
+                queue_.clear();
+                break;
+            }
+            if (front.sample && front.timestamp > clock) break; // 先読み分(まだ表示しない)
+            if (front.sample) {
+                if (due) droppedFrames_++;
+                due = std::move(front.sample);
+            }
+            queue_.pop_front();
+        }
+
+        // コピー待ちで書き込めなかったフレームは、新しいフレームがなければ書き込み直す
+        if (pendingUpload_) {
+            if (due) droppedFrames_++;
+            else due = std::move(pendingUpload_);
+            pendingUpload_.Reset();
+        }
+
+        bool ok = true;
+        if (due) {
+            ok = hardwareDecode_ ? presentHardwareFrame(due.Get()) : presentSoftwareFrame(due.Get());
+        }
+
+        // 終端: 残りの要求がすべて返ってから位置を戻す(要求中は SetCurrentPosition できない)
+        if (endOfStream_) {
+            if (inFlight_ > 0) return ok;
+            endOfStream_ = false;
+            if (!loop_) {
+                isPlaying_ = false;
+                return false;
+            }
+            // ループ再生
+            PROPVARIANT var{};
+            var.vt = VT_I8;
+            var.hVal.QuadPart = 0;
+            reader_->SetCurrentPosition(GUID_NULL, var);
+            PropVariantClear(&var);
+            currentTime_ = 0.0f;
+        }
+
+        // 表示している間に先のフレームをデコードさせる
+        return fillPrefetch() && ok;
+    }
+
+
+
+    /**
+     * @brief 再生開始
+     * 
+     * @details
+     * 動画の再生を開始します。
+     */
+    void Play() { isPlaying_ = true; }
+    
+    /**
+     * @brief 再生停止
+     * 
+     * @details
+     * 動画の再生を停止します。
+     */
+    void Stop() { isPlaying_ = false; }
+    
+    /**
+     * @brief ループ再生を設定
+     * @param[in] loop trueでループ再生、falseで1回のみ再生
+     * 
+     * @details
+     * 動画の終端に達したときの動作を設定します。
+     */
+    void SetLoop(bool loop) { loop_ = loop; }
+
+    /**
+     * @brief 動画テクスチャのシェーダーリソースビューを取得
+     * @return ID3D11ShaderResourceView* シェーダーリソースビュー
+     * 
+     * @details
+     * 現在のフレームの RGB のテクスチャを取得します。
+     * これを使用して動画を描画できます。
+     * CPU 変換時はフレームごとに表示用テクスチャが切り替わるため、保持せずに毎フレーム取得してください。
+     * ハードウェアデコード時は、フレームが変わってから最初の呼び出しで RGB へ変換します(即時コンテキストを使用)。
+     * VideoSurface で描く場合は変換しない GetFrame() が使われます。
+     */
+    ID3D11ShaderResourceView* GetSRV() {
+        if (rgbStale_) {
+            convert(gfx_->Ctx());
+            rgbStale_ = false;
+        }
+        return videoSRV_.Get();
+    }
+
+    /**
+     * @brief 表示中のフレームのテクスチャを取得(変換やコピーはしない)
+     * @return bool 表示したフレームがある場合 true
+     *
+     * @details
+     * ハードウェアデコード時は NV12 の輝度・色差と変換の定数、CPU 変換時は RGB のテクスチャを返します。
+     * 新しいフレームが届かない間は同じテクスチャ(同じ serial)のままです。
+     */
+    bool GetFrame(Frame& out) const {
+        out = Frame{};
+        if (frameSerial_ == 0) return false;
+        out.serial = frameSerial_;
+        if (hardwareDecode_) {
+            out.luma = lumaSrv_.Get();
+            out.chroma = chromaSrv_.Get();
+            out.convert = convertCb_.Get();
+        } else {
+            out.rgb = videoSRV_.Get();
+        }
+        return true;
+    }
+
+    /**
+     * @brief 再生中かどうかを取得
+     * @return bool 再生中の場合true
+     */
+    bool IsPlaying() const { return isPlaying_; }
+
+    /**
+     * @brief GPUでデコードしているか
+     * @return bool DXVA のデコードとシェーダーでの変換を使っている場合true
+     */
+    bool IsHardwareDecoding() const { return hardwareDecode_; }
+    
+    /**
+     * @brief 表示した動画フレーム数(テクスチャへのコピー回数)
+     */
+    uint64_t GetPresentedFrames() const { return presentedFrames_; }
+
+    /**
+     * @brief 再生が遅れて表示せずに捨てたフレーム数
+     */
+    uint64_t GetDroppedFrames() const { return droppedFrames_; }
+
+    /**
+     * @brief CPU 変換時、書き込むステージングテクスチャが GPU のコピー待ちで前のフレームを表示し続けた回数
+     */
+    uint64_t GetUploadStalls() const { return uploadStalls_; }
+
+    /**
+     * @brief 動画の幅を取得
+     * @return UINT 幅(ピクセル単位)
+     */
+    UINT GetWidth() const { return width_; }
+    
+    /**
+     * @brief 動画の高さを取得
+     * @return UINT 高さ(ピクセル単位)
+     */
+    UINT GetHeight() const { return height_; }
+
+private:
+    /**
+     * @struct ConvertConstants
+     * @brief YUV → RGB 変換の定数(HLSL の ConvertConstants と同じレイアウト)
+     */
+    struct ConvertConstants {
+        DirectX::XMFLOAT4 rows[3];    ///< RGB の各行(xyz: Y, Cb, Cr の係数, w: オフセット)
+        DirectX::XMFLOAT2 uvScale;    ///< 表示領域 / デコード面の大きさ
+        DirectX::XMFLOAT2 padding;    ///< パディング
+    };
+
+    /**
+     * @brief 非同期のソースリーダーを作成し、出力形式を設定
+     * @param[in] path 動画ファイルのパス
+     * @param[in] hardware true: DXVA でデコードして NV12、false: CPU で RGB32 に変換
+     */
+    bool openReader(const wchar_t* path, bool hardware) {
+        callback_.Attach(new VideoReaderCallback());
+
         Microsoft::WRL::ComPtr<IMFAttributes> attributes;
-        HRESULT hr = MFCreateAttributes(&attributes, 1);
+        HRESULT hr = MFCreateAttributes(&attributes, 3);
         if (FAILED(hr)) return false;
 
-        hr = attributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE);
+        hr = attributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, callback_.Get());
         if (FAILED(hr)) return false;
 
-        hr = MFCreateSourceReaderFromURL(wpath, attributes.Get(), &reader_);
-        if (FAILED(hr)) {
-            char msg[512];
-            sprintf_s(msg, "Failed to open video file: %s", filepath);
-            MessageBoxA(nullptr, msg, "Video Error", MB_OK | MB_ICONERROR);
-            return false;
+        if (hardware) {
+            // デコーダーはワーカースレッドから同じデバイスを使うため、デバイスをスレッドセーフにする
+            Microsoft::WRL::ComPtr<ID3D10Multithread> multithread;
+            if (SUCCEEDED(gfx_->Dev()->QueryInterface(IID_PPV_ARGS(&multithread)))) {
+                multithread->SetMultithreadProtected(TRUE);
+            }
+
+            hr = MFCreateDXGIDeviceManager(&resetToken_, &deviceManager_);
+            if (FAILED(hr)) return false;
+            hr = deviceManager_->ResetDevice(gfx_->Dev(), resetToken_);
+            if (FAILED(hr)) return false;
+            hr = attributes->SetUnknown(MF_SOURCE_READER_D3D_MANAGER, deviceManager_.Get());
+            if (FAILED(hr)) return false;
+            hr = attributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE);
+            if (FAILED(hr)) return false;
+        } else {
+            hr = attributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE);
+            if (FAILED(hr)) return false;
         }
 
+        hr = MFCreateSourceReaderFromURL(path, attributes.Get(), &reader_);
+        if (FAILED(hr)) return false;
+
         // ビデオストリームを選択
+        hr = reader_->SetStreamSelection((DWORD)MF_SOURCE_READER_ALL_STREAMS, FALSE);
+        if (FAILED(hr)) return false;
         hr = reader_->SetStreamSelection((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, TRUE);
         if (FAILED(hr)) return false;
 
-        // 出力メディアタイプを設定(RGB32)
+        // 出力メディアタイプを設定(NV12 / RGB32)
         Microsoft::WRL::ComPtr<IMFMediaType> mediaType;
         hr = MFCreateMediaType(&mediaType);
         if (FAILED(hr)) return false;
@@ -145,13 +506,13 @@ public:
         hr = mediaType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
         if (FAILED(hr)) return false;
 
-        hr = mediaType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_RGB32);
+        hr = mediaType->SetGUID(MF_MT_SUBTYPE, hardware ? MFVideoFormat_NV12 : MFVideoFormat_RGB32);
         if (FAILED(hr)) return false;
 
         hr = reader_->SetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, nullptr, mediaType.Get());
         if (FAILED(hr)) return false;
 
-        // 動画サイズを取得して保存
+        // 動画サイズを取得して保存(デコード面はマクロブロック単位で大きいことがあるため、表示領域を優先)
         Microsoft::WRL::ComPtr<IMFMediaType> currentType;
         hr = reader_->GetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, &currentType);
         if (FAILED(hr)) return false;
@@ -159,76 +520,105 @@ public:
         UINT32 w, h;
         hr = MFGetAttributeSize(currentType.Get(), MF_MT_FRAME_SIZE, &w, &h);
         if (FAILED(hr)) return false;
-
+        frameWidth_ = w;
+        frameHeight_ = h;
         width_ = w;
         height_ = h;
 
-        // 動画テクスチャを作成
-        if (!createVideoTexture()) return false;
+        MFVideoArea aperture{};
+        if (SUCCEEDED(currentType->GetBlob(MF_MT_MINIMUM_DISPLAY_APERTURE, reinterpret_cast<UINT8*>(&aperture), sizeof(aperture), nullptr)) &&
+            aperture.Area.cx > 0 && aperture.Area.cy > 0) {
+            width_ = (std::min)(static_cast<UINT>(aperture.Area.cx), frameWidth_);
+            height_ = (std::min)(static_cast<UINT>(aperture.Area.cy), frameHeight_);
+        }
 
-        isOpen_ = true;
+        // 色変換の行列(指定がなければ HD は BT.709、SD は BT.601)
+        UINT32 matrix = MFGetAttributeUINT32(currentType.Get(), MF_MT_YUV_MATRIX, MFVideoTransferMatrix_Unknown);
+        bt709_ = matrix == MFVideoTransferMatrix_BT709 || (matrix != MFVideoTransferMatrix_BT601 && height_ >= 720);
         return true;
     }
 
     /**
-     * @brief フレームを更新
-     * @param[in] dt デルタタイム(秒単位)
-     * @return bool 更新に成功した場合true
-     * 
-     * @details
-     * 次のフレームを読み込み、テクスチャを更新します。
-     * 再生中でない場合や動画の終端に達した場合はfalseを返します。
-     * ループが有効な場合、終端に達すると自動的に先頭に戻ります。
+     * @brief 要求中と受け取り済みが PREFETCH_FRAMES 枚になるまで次のフレームを要求(結果は VideoReaderCallback に届く)
      */
-    bool Update(float dt) {
-        if (!isOpen_ || !isPlaying_) return false;
-
-        currentTime_ += dt;
-
-        // フレームを読み込み
-        DWORD streamFlags = 0;
-        LONGLONG timestamp = 0;
-        Microsoft::WRL::ComPtr<IMFSample> sample;
-
-        HRESULT hr = reader_->ReadSample(
-            (DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM,
-            0,
-            nullptr,
-            &streamFlags,
-            &timestamp,
-            &sample
-        );
+    bool fillPrefetch() {
+        while (inFlight_ + queue_.size() < PREFETCH_FRAMES) {
+            HRESULT hr = reader_->ReadSample((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, 0, nullptr, nullptr, nullptr, nullptr);
+            if (FAILED(hr)) {
+                DEBUGLOG_WARNING("[VideoPlayer] ReadSample の要求失敗 (HRESULT: 0x" + std::to_string(hr) + ")");
+                return false;
+            }
+            inFlight_++;
+        }
+        return true;
+    }
 
+    /**
+     * @brief デコーダーの NV12 テクスチャをシェーダーから読めるテクスチャへコピー(RGB への変換は GetSRV() まで遅らせる)
+     */
+    bool presentHardwareFrame(IMFSample* sample) {
+        Microsoft::WRL::ComPtr<IMFMediaBuffer> buffer;
+        HRESULT hr = sample->GetBufferByIndex(0, &buffer);
         if (FAILED(hr)) return false;
 
-        // ストリームの終端
-        if (streamFlags & MF_SOURCE_READERF_ENDOFSTREAM) {
-            if (loop_) {
-                // ループ再生
-                PROPVARIANT var{};
-                var.vt = VT_I8;
-                var.hVal.QuadPart = 0;
-                reader_->SetCurrentPosition(GUID_NULL, var);
-                PropVariantClear(&var);
-                return true;
-            }
-            isPlaying_ = false;
+        Microsoft::WRL::ComPtr<IMFDXGIBuffer> dxgiBuffer;
+        if (FAILED(buffer.As(&dxgiBuffer))) return false;
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> decoded;
+        UINT subresource = 0;
+        if (FAILED(dxgiBuffer->GetResource(IID_PPV_ARGS(&decoded))) || FAILED(dxgiBuffer->GetSubresourceIndex(&subresource))) {
             return false;
         }
 
-        if (!sample) return true;
+        // デコーダーの出力はテクスチャ配列の1枚でシェーダーから読めないため、SRV を作れる NV12 テクスチャへ GPU 上でコピー
+        ID3D11DeviceContext* ctx = gfx_->Ctx();
+        D3D11_BOX box{ 0, 0, 0, frameWidth_, frameHeight_, 1 };
+        ctx->CopySubresourceRegion(nv12Texture_.Get(), 0, 0, 0, 0, decoded.Get(), subresource, &box);
 
-        // サンプルからバッファを取得
+        rgbStale_ = true;
+        presentedFrames_++;
+        frameSerial_++;
+        return true;
+    }
+
+    /**
+     * @brief CPU で RGB32 に変換済みのフレームをステージングのリングへ書き込み、表示用テクスチャへ GPU でコピー
+     *
+     * @details
+     * 書き込むステージングテクスチャは UPLOAD_RING_SIZE 枚を順に使うため、GPU が前のフレームをコピーしている間に
+     * 次のフレームを書き込めます。表示用テクスチャも2枚を交互に使い、サンプリング中のテクスチャには書き込みません。
+     * それでもステージングのコピーが終わっていない場合は待たず、サンプルを pendingUpload_ に残して前のフレームを表示し続けます。
+     * サンプルのバッファが1つの場合は ConvertToContiguousBuffer() を使わずデコーダーのバッファから直接コピーします。
+     */
+    bool presentSoftwareFrame(IMFSample* sample) {
+        // サンプルからバッファを取得(複数に分かれている場合だけ連続したバッファにまとめる)
         Microsoft::WRL::ComPtr<IMFMediaBuffer> buffer;
-        hr = sample->ConvertToContiguousBuffer(&buffer);
+        DWORD bufferCount = 0;
+        HRESULT hr = sample->GetBufferCount(&bufferCount);
+        if (SUCCEEDED(hr) && bufferCount == 1) {
+            hr = sample->GetBufferByIndex(0, &buffer);
+        } else {
+            hr = sample->ConvertToContiguousBuffer(&buffer);
+        }
         if (FAILED(hr)) return false;
 
+        Microsoft::WRL::ComPtr<IMF2DBuffer2> buffer2D2;
         Microsoft::WRL::ComPtr<IMF2DBuffer> buffer2D;
         BYTE* data = nullptr;
         LONG srcPitch = 0;
         bool locked2D = false;
 
-        if (SUCCEEDED(buffer.As(&buffer2D))) {
+        if (SUCCEEDED(buffer.As(&buffer2D2))) {
+            // 読み取り専用でロック(書き戻しのコピーがない)
+            BYTE* bufferStart = nullptr;
+            DWORD bufferLength = 0;
+            hr = buffer2D2->Lock2DSize(MF2DBuffer_LockFlags_Read, &data, &srcPitch, &bufferStart, &bufferLength);
+            if (FAILED(hr)) {
+                return false;
+            }
+            buffer2D = buffer2D2;
+            locked2D = true;
+        } else if (SUCCEEDED(buffer.As(&buffer2D))) {
             hr = buffer2D->Lock2D(&data, &srcPitch);
             if (FAILED(hr)) {
                 return false;
@@ -248,98 +638,268 @@ public:
             data += srcPitch * (height_ - 1);
         }
 
-        // テクスチャを更新
+        // ステージングテクスチャへ書き込む(UPLOAD_RING_SIZE フレーム前のコピーは通常終わっている)
+        ID3D11DeviceContext* ctx = gfx_->Ctx();
+        ID3D11Texture2D* staging = uploadRing_[uploadIndex_].Get();
         D3D11_MAPPED_SUBRESOURCE mapped{};
-        hr = gfx_->Ctx()->Map(videoTexture_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+        hr = ctx->Map(staging, 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
         if (FAILED(hr)) {
             if (locked2D) {
                 buffer2D->Unlock2D();
             } else {
                 buffer->Unlock();
             }
-            return false;
+            if (hr != DXGI_ERROR_WAS_STILL_DRAWING) return false;
+            // コピー待ち: 前のフレームのまま次の Update() で書き込み直す
+            uploadStalls_++;
+            pendingUpload_ = sample;
+            return true;
         }
 
-        const UINT copyBytes = std::min<UINT>(mapped.RowPitch, static_cast<UINT>(srcPitch));
+        const UINT rowBytes = width_ * 4;
         uint8_t* dest = static_cast<uint8_t*>(mapped.pData);
         const uint8_t* src = data;
-        for (UINT y = 0; y < height_; ++y) {
-            memcpy(dest, src, copyBytes);
-            dest += mapped.RowPitch;
-            src += srcPitch;
+        if (mapped.RowPitch == static_cast<UINT>(srcPitch)) {
+            memcpy(dest, src, static_cast<size_t>(mapped.RowPitch) * (height_ - 1) + rowBytes);
+        } else {
+            const UINT copyBytes = (std::min)(rowBytes, static_cast<UINT>(srcPitch));
+            for (UINT y = 0; y < height_; ++y) {
+                memcpy(dest, src, copyBytes);
+                dest += mapped.RowPitch;
+                src += srcPitch;
+            }
         }
-        gfx_->Ctx()->Unmap(videoTexture_.Get(), 0);
+        ctx->Unmap(staging, 0);
 
         if (locked2D) {
             buffer2D->Unlock2D();
         } else {
             buffer->Unlock();
         }
+
+        // サンプリングしていない方の表示用テクスチャへ GPU でコピーして切り替える
+        displayIndex_ ^= 1u;
+        ctx->CopyResource(displayRing_[displayIndex_].Get(), staging);
+        videoTexture_ = displayRing_[displayIndex_];
+        videoSRV_ = displaySrvs_[displayIndex_];
+        uploadIndex_ = (uploadIndex_ + 1) % UPLOAD_RING_SIZE;
+        presentedFrames_++;
+        frameSerial_++;
         return true;
     }
 
-
-
-    /**
-     * @brief 再生開始
-     * 
-     * @details
-     * 動画の再生を開始します。
-     */
-    void Play() { isPlaying_ = true; }
-    
     /**
-     * @brief 再生停止
-     * 
-     * @details
-     * 動画の再生を停止します。
+     * @brief NV12 テクスチャを全画面三角形で RGB のテクスチャへ描く(変更したステートは元に戻す)
      */
-    void Stop() { isPlaying_ = false; }
-    
-    /**
-     * @brief ループ再生を設定
-     * @param[in] loop trueでループ再生、falseで1回のみ再生
-     * 
-     * @details
-     * 動画の終端に達したときの動作を設定します。
-     */
-    void SetLoop(bool loop) { loop_ = loop; }
+    void convert(ID3D11DeviceContext* ctx) {
+        // 保存
+        Microsoft::WRL::ComPtr<ID3D11RenderTargetView> oldRtv;
+        Microsoft::WRL::ComPtr<ID3D11DepthStencilView> oldDsv;
+        ctx->OMGetRenderTargets(1, oldRtv.GetAddressOf(), oldDsv.GetAddressOf());
+        UINT viewportCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+        D3D11_VIEWPORT oldViewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+        ctx->RSGetViewports(&viewportCount, oldViewports);
+        Microsoft::WRL::ComPtr<ID3D11InputLayout> oldLayout;
+        ctx->IAGetInputLayout(oldLayout.GetAddressOf());
+        D3D11_PRIMITIVE_TOPOLOGY oldTopology;
+        ctx->IAGetPrimitiveTopology(&oldTopology);
+        Microsoft::WRL::ComPtr<ID3D11VertexShader> oldVs;
+        ctx->VSGetShader(oldVs.GetAddressOf(), nullptr, nullptr);
+        Microsoft::WRL::ComPtr<ID3D11PixelShader> oldPs;
+        ctx->PSGetShader(oldPs.GetAddressOf(), nullptr, nullptr);
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> oldSrvs[2];
+        ctx->PSGetShaderResources(0, 2, reinterpret_cast<ID3D11ShaderResourceView**>(oldSrvs));
+        Microsoft::WRL::ComPtr<ID3D11SamplerState> oldSampler;
+        ctx->PSGetSamplers(0, 1, oldSampler.GetAddressOf());
+        Microsoft::WRL::ComPtr<ID3D11Buffer> oldCb;
+        ctx->PSGetConstantBuffers(0, 1, oldCb.GetAddressOf());
+        Microsoft::WRL::ComPtr<ID3D11RasterizerState> oldRaster;
+        ctx->RSGetState(oldRaster.GetAddressOf());
+        Microsoft::WRL::ComPtr<ID3D11BlendState> oldBlend;
+        FLOAT oldBlendFactor[4];
+        UINT oldSampleMask = 0;
+        ctx->OMGetBlendState(oldBlend.GetAddressOf(), oldBlendFactor, &oldSampleMask);
+        Microsoft::WRL::ComPtr<ID3D11DepthStencilState> oldDepth;
+        UINT oldStencilRef = 0;
+        ctx->OMGetDepthStencilState(oldDepth.GetAddressOf(), &oldStencilRef);
 
-    /**
-     * @brief 動画テクスチャのシェーダーリソースビューを取得
-     * @return ID3D11ShaderResourceView* シェーダーリソースビュー
-     * 
-     * @details
-     * 現在のフレームのテクスチャを取得します。
-     * これを使用して動画を描画できます。
-     */
-    ID3D11ShaderResourceView* GetSRV() const { return videoSRV_.Get(); }
+        // 変換
+        ID3D11RenderTargetView* rtv = videoRtv_.Get();
+        ctx->OMSetRenderTargets(1, &rtv, nullptr);
+        D3D11_VIEWPORT vp{ 0.0f, 0.0f, static_cast<float>(width_), static_cast<float>(height_), 0.0f, 1.0f };
+        ctx->RSSetViewports(1, &vp);
+        ctx->IASetInputLayout(nullptr);
+        ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        ctx->VSSetShader(convertVs_.Get(), nullptr, 0);
+        ctx->PSSetShader(convertPs_.Get(), nullptr, 0);
+        ID3D11ShaderResourceView* planes[2] = { lumaSrv_.Get(), chromaSrv_.Get() };
+        ctx->PSSetShaderResources(0, 2, planes);
+        ctx->PSSetSamplers(0, 1, sampler_.GetAddressOf());
+        ctx->PSSetConstantBuffers(0, 1, convertCb_.GetAddressOf());
+        ctx->RSSetState(nullptr);
+        ctx->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+        ctx->OMSetDepthStencilState(nullptr, 0);
+        ctx->Draw(3, 0);
+
+        // 復元(NV12 の SRV を外してから次のコピーに備える)
+        ID3D11RenderTargetView* restoreRtv = oldRtv.Get();
+        ctx->OMSetRenderTargets(1, &restoreRtv, oldDsv.Get());
+        ctx->RSSetViewports(viewportCount, oldViewports);
+        ctx->IASetInputLayout(oldLayout.Get());
+        ctx->IASetPrimitiveTopology(oldTopology);
+        ctx->VSSetShader(oldVs.Get(), nullptr, 0);
+        ctx->PSSetShader(oldPs.Get(), nullptr, 0);
+        ID3D11ShaderResourceView* restoreSrvs[2] = { oldSrvs[0].Get(), oldSrvs[1].Get() };
+        ctx->PSSetShaderResources(0, 2, restoreSrvs);
+        ctx->PSSetSamplers(0, 1, oldSampler.GetAddressOf());
+        ctx->PSSetConstantBuffers(0, 1, oldCb.GetAddressOf());
+        ctx->RSSetState(oldRaster.Get());
+        ctx->OMSetBlendState(oldBlend.Get(), oldBlendFactor, oldSampleMask);
+        ctx->OMSetDepthStencilState(oldDepth.Get(), oldStencilRef);
+    }
 
     /**
-     * @brief 再生中かどうかを取得
-     * @return bool 再生中の場合true
-     */
-    bool IsPlaying() const { return isPlaying_; }
-    
-    /**
-     * @brief 動画の幅を取得
-     * @return UINT 幅(ピクセル単位)
-     */
-    UINT GetWidth() const { return width_; }
-    
-    /**
-     * @brief 動画の高さを取得
-     * @return UINT 高さ(ピクセル単位)
+     * @brief ハードウェアデコード用の NV12 テクスチャ、変換シェーダー、RGB のレンダーターゲットを作成
      */
-    UINT GetHeight() const { return height_; }
+    bool createHardwareResources() {
+        ID3D11Device* dev = gfx_->Dev();
+
+        // NV12 は幅・高さが偶数
+        D3D11_TEXTURE2D_DESC td{};
+        td.Width = (frameWidth_ + 1) & ~1u;
+        td.Height = (frameHeight_ + 1) & ~1u;
+        td.MipLevels = 1;
+        td.ArraySize = 1;
+        td.Format = DXGI_FORMAT_NV12;
+        td.SampleDesc.Count = 1;
+        td.Usage = D3D11_USAGE_DEFAULT;
+        td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        if (FAILED(dev->CreateTexture2D(&td, nullptr, nv12Texture_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] NV12 テクスチャの作成失敗");
+            return false;
+        }
+        frameWidth_ = td.Width;
+        frameHeight_ = td.Height;
+
+        // 輝度(R8)と色差(R8G8、半分の解像度)を別の SRV で読む
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvd{};
+        srvd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvd.Texture2D.MipLevels = 1;
+        srvd.Format = DXGI_FORMAT_R8_UNORM;
+        if (FAILED(dev->CreateShaderResourceView(nv12Texture_.Get(), &srvd, lumaSrv_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] 輝度の SRV 作成失敗");
+            return false;
+        }
+        srvd.Format = DXGI_FORMAT_R8G8_UNORM;
+        if (FAILED(dev->CreateShaderResourceView(nv12Texture_.Get(), &srvd, chromaSrv_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] 色差の SRV 作成失敗");
+            return false;
+        }
+
+        // 変換結果(GetSRV() で返すテクスチャ)
+        td.Width = width_;
+        td.Height = height_;
+        td.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        td.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+        if (FAILED(dev->CreateTexture2D(&td, nullptr, videoTexture_.ReleaseAndGetAddressOf())) ||
+            FAILED(dev->CreateShaderResourceView(videoTexture_.Get(), nullptr, videoSRV_.ReleaseAndGetAddressOf())) ||
+            FAILED(dev->CreateRenderTargetView(videoTexture_.Get(), nullptr, videoRtv_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] 変換先テクスチャの作成失敗");
+            return false;
+        }
+
+        const char* VS = R"(
+            struct VSOut { float4 pos : SV_POSITION; float2 uv : TEXCOORD0; };
+            VSOut main(uint id : SV_VertexID) {
+                VSOut o;
+                o.uv = float2((id << 1) & 2, id & 2);
+                o.pos = float4(o.uv * float2(2, -2) + float2(-1, 1), 0, 1);
+                return o;
+            }
+        )";
+
+        const char* PS = R"(
+            cbuffer ConvertConstants : register(b0) {
+                float4 gRows[3];
+                float2 gUvScale;
+                float2 gPadding;
+            };
+            Texture2D<float> gLuma : register(t0);
+            Texture2D<float2> gChroma : register(t1);
+            SamplerState gSampler : register(s0);
+
+            struct VSOut { float4 pos : SV_POSITION; float2 uv : TEXCOORD0; };
+            float4 main(VSOut i) : SV_Target {
+                float2 uv = i.uv * gUvScale;
+                float4 ycc = float4(gLuma.Sample(gSampler, uv), gChroma.Sample(gSampler, uv), 1.0);
+                return float4(saturate(float3(dot(gRows[0], ycc), dot(gRows[1], ycc), dot(gRows[2], ycc))), 1.0);
+            }
+        )";
+
+        UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+        compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, psb, err;
+        HRESULT hr = ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err);
+        if (SUCCEEDED(hr)) hr = ShaderCache::Compile(PS, nullptr, "main", "ps_5_0", compileFlags, psb, err);
+        if (FAILED(hr)) {
+            DEBUGLOG_WARNING("[VideoPlayer] 変換シェーダーのコンパイル失敗" +
+                             (err ? ": " + std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::string()));
+            return false;
+        }
+        if (FAILED(dev->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, convertVs_.ReleaseAndGetAddressOf())) ||
+            FAILED(dev->CreatePixelShader(psb->GetBufferPointer(), psb->GetBufferSize(), nullptr, convertPs_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] 変換シェーダーの作成失敗");
+            return false;
+        }
+
+        // リミテッドレンジ(Y: 16-235, CbCr: 16-240)の YCbCr → RGB
+        const float kr = bt709_ ? 0.2126f : 0.299f;
+        const float kb = bt709_ ? 0.0722f : 0.114f;
+        const float kg = 1.0f - kr - kb;
+        const float ys = 255.0f / 219.0f;
+        const float cs = 255.0f / 224.0f;
+        const float yo = -16.0f / 255.0f * ys;
+        const float crR = 2.0f * (1.0f - kr) * cs;
+        const float cbB = 2.0f * (1.0f - kb) * cs;
+        const float cbG = -2.0f * (1.0f - kb) * kb / kg * cs;
+        const float crG = -2.0f * (1.0f - kr) * kr / kg * cs;
+        const float c0 = 128.0f / 255.0f;
+        ConvertConstants constants{};
+        constants.rows[0] = DirectX::XMFLOAT4{ ys, 0.0f, crR, yo - crR * c0 };
+        constants.rows[1] = DirectX::XMFLOAT4{ ys, cbG, crG, yo - (cbG + crG) * c0 };
+        constants.rows[2] = DirectX::XMFLOAT4{ ys, cbB, 0.0f, yo - cbB * c0 };
+        constants.uvScale = DirectX::XMFLOAT2{ static_cast<float>(width_) / frameWidth_, static_cast<float>(height_) / frameHeight_ };
+
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_IMMUTABLE;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = sizeof(ConvertConstants);
+        D3D11_SUBRESOURCE_DATA init{ &constants, 0, 0 };
+        if (FAILED(dev->CreateBuffer(&bd, &init, convertCb_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] 変換定数バッファの作成失敗");
+            return false;
+        }
+
+        D3D11_SAMPLER_DESC sd{};
+        sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.MaxLOD = D3D11_FLOAT32_MAX;
+        if (FAILED(dev->CreateSamplerState(&sd, sampler_.ReleaseAndGetAddressOf()))) {
+            DEBUGLOG_WARNING("[VideoPlayer] サンプラーの作成失敗");
+            return false;
+        }
+        return true;
+    }
 
-private:
     /**
      * @brief 動画用テクスチャを作成
      * @return bool 成功した場合true
      * 
      * @details
-     * 動画フレームを格納するためのダイナミックテクスチャを作成します。
+     * CPU で変換したフレームの書き込み先(ステージング x UPLOAD_RING_SIZE)と表示用テクスチャ(x 2)を作成します。
      */
     bool createVideoTexture() {
         D3D11_TEXTURE2D_DESC texDesc{};
@@ -349,40 +909,122 @@ private:
         texDesc.ArraySize = 1;
         texDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
         texDesc.SampleDesc.Count = 1;
-        texDesc.Usage = D3D11_USAGE_DYNAMIC;
-        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.Usage = D3D11_USAGE_STAGING;
         texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-        HRESULT hr = gfx_->Dev()->CreateTexture2D(&texDesc, nullptr, &videoTexture_);
-        if (FAILED(hr)) {
-            MessageBoxA(nullptr, "Failed to create video texture", "Video Error", MB_OK | MB_ICONERROR);
-            return false;
+        for (auto& staging : uploadRing_) {
+            HRESULT hr = gfx_->Dev()->CreateTexture2D(&texDesc, nullptr, staging.ReleaseAndGetAddressOf());
+            if (FAILED(hr)) {
+                MessageBoxA(nullptr, "Failed to create video staging texture", "Video Error", MB_OK | MB_ICONERROR);
+                return false;
+            }
         }
 
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.CPUAccessFlags = 0;
+
         D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
         srvDesc.Format = texDesc.Format;
         srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
         srvDesc.Texture2D.MipLevels = 1;
 
-        hr = gfx_->Dev()->CreateShaderResourceView(videoTexture_.Get(), &srvDesc, &videoSRV_);
-        if (FAILED(hr)) {
-            MessageBoxA(nullptr, "Failed to create video SRV", "Video Error", MB_OK | MB_ICONERROR);
-            return false;
+        for (int i = 0; i < 2; ++i) {
+            HRESULT hr = gfx_->Dev()->CreateTexture2D(&texDesc, nullptr, displayRing_[i].ReleaseAndGetAddressOf());
+            if (FAILED(hr)) {
+                MessageBoxA(nullptr, "Failed to create video texture", "Video Error", MB_OK | MB_ICONERROR);
+                return false;
+            }
+
+            hr = gfx_->Dev()->CreateShaderResourceView(displayRing_[i].Get(), &srvDesc, displaySrvs_[i].ReleaseAndGetAddressOf());
+            if (FAILED(hr)) {
+                MessageBoxA(nullptr, "Failed to create video SRV", "Video Error", MB_OK | MB_ICONERROR);
+                return false;
+            }
         }
 
+        displayIndex_ = 0;
+        uploadIndex_ = 0;
+        videoTexture_ = displayRing_[0];
+        videoSRV_ = displaySrvs_[0];
         return true;
     }
 
+    /**
+     * @brief ソースリーダーと作成したリソースを解放
+     */
+    void close() {
+        queue_.clear();
+        pendingUpload_.Reset();
+        reader_.Reset();         // 残っている要求の結果は callback_ が受け取って捨てる
+        callback_.Reset();
+        deviceManager_.Reset();
+        resetToken_ = 0;
+        videoTexture_.Reset();
+        videoSRV_.Reset();
+        videoRtv_.Reset();
+        for (auto& staging : uploadRing_) staging.Reset();
+        for (int i = 0; i < 2; ++i) {
+            displayRing_[i].Reset();
+            displaySrvs_[i].Reset();
+        }
+        nv12Texture_.Reset();
+        lumaSrv_.Reset();
+        chromaSrv_.Reset();
+        convertVs_.Reset();
+        convertPs_.Reset();
+        convertCb_.Reset();
+        sampler_.Reset();
+        isOpen_ = false;
+        hardwareDecode_ = false;
+        inFlight_ = 0;
+        endOfStream_ = false;
+        presentedFrames_ = 0;
+        droppedFrames_ = 0;
+        uploadStalls_ = 0;
+        frameSerial_ = 0;
+        rgbStale_ = false;
+    }
+
     GfxDevice* gfx_ = nullptr;                                      ///< グラフィックスデバイスへのポインタ
-    Microsoft::WRL::ComPtr<IMFSourceReader> reader_;                ///< Media Foundationソースリーダー
-    Microsoft::WRL::ComPtr<ID3D11Texture2D> videoTexture_;          ///< 動画フレーム用テクスチャ
+    Microsoft::WRL::ComPtr<IMFSourceReader> reader_;                ///< Media Foundationソースリーダー(非同期)
+    Microsoft::WRL::ComPtr<VideoReaderCallback> callback_;          ///< デコード済みのフレームの受け取り口
+    Microsoft::WRL::ComPtr<IMFDXGIDeviceManager> deviceManager_;    ///< デコーダーに渡すデバイス(ハードウェアデコード時)
+    UINT resetToken_ = 0;                                           ///< deviceManager_ のトークン
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> videoTexture_;          ///< 動画フレーム用テクスチャ(RGB、CPU 変換時は displayRing_ の現在の面)
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> videoSRV_;    ///< シェーダーリソースビュー
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> uploadRing_[UPLOAD_RING_SIZE];         ///< CPU 変換時の書き込み先(ステージング、UPLOAD_RING_SIZE 枚)
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> displayRing_[2];        ///< CPU 変換時の表示用テクスチャ(交互に使用)
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> displaySrvs_[2]; ///< displayRing_ の SRV
+    uint32_t uploadIndex_ = 0;                                      ///< 次に書き込む uploadRing_ の位置
+    uint32_t displayIndex_ = 0;                                     ///< 表示中の displayRing_ の位置
+    uint64_t uploadStalls_ = 0;                                     ///< ステージングが GPU のコピー待ちだった回数
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> videoRtv_;       ///< 変換先(ハードウェアデコード時)
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> nv12Texture_;           ///< デコード結果のコピー先
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> lumaSrv_;      ///< NV12 の輝度(R8)
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> chromaSrv_;    ///< NV12 の色差(R8G8)
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> convertVs_;          ///< 全画面三角形
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> convertPs_;           ///< YUV → RGB
+    Microsoft::WRL::ComPtr<ID3D11Buffer> convertCb_;                ///< 変換の係数(不変)
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler_;            ///< 色差の補間用
+    std::deque<VideoReaderCallback::Result> queue_;                 ///< 受け取って表示を待っているフレーム(タイムスタンプ順)
+    Microsoft::WRL::ComPtr<IMFSample> pendingUpload_;               ///< ステージングのコピー待ちで書き込めなかったフレーム(CPU 変換時)
+    size_t inFlight_ = 0;                                           ///< 結果を待っている ReadSample の数
+    uint64_t presentedFrames_ = 0;                                  ///< 表示したフレーム数
+    uint64_t droppedFrames_ = 0;                                    ///< 捨てたフレーム数
+    uint64_t frameSerial_ = 0;                                      ///< 表示したフレームの通し番号(GetFrame())
+    bool rgbStale_ = false;                                         ///< NV12 が RGB のテクスチャより新しいか(GetSRV() で変換)
 
     UINT width_ = 0;            ///< 動画の幅
     UINT height_ = 0;           ///< 動画の高さ
+    UINT frameWidth_ = 0;       ///< デコード面の幅
+    UINT frameHeight_ = 0;      ///< デコード面の高さ
     bool isOpen_ = false;       ///< ファイルが開かれているか
     bool isPlaying_ = false;    ///< 再生中か
     bool loop_ = false;         ///< ループ再生するか
+    bool hardwareDecode_ = false; ///< DXVA でデコードしているか
+    bool bt709_ = true;         ///< BT.709 の色変換を使うか(false: BT.601)
+    bool endOfStream_ = false;  ///< 終端の結果を受け取り、残りの要求を待っているか
     float currentTime_ = 0.0f;  ///< 現在の再生時間
     bool mfInitialized_ = false; ///< Media Foundationを初期化済みかどうか
 };
@@ -0,0 +1,334 @@
+/**
+ * @file VideoSurfaceRenderer.h
+ * @brief VideoSurface の描画(NV12 / RGB のフレームを直接サンプリング)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * VideoPlayer::GetFrame() のテクスチャを、変換やコピーをせずにそのまま描きます。
+ * ハードウェアデコードのフレームは NV12 の輝度(t0)・色差(t1)と VideoPlayer の変換の定数(PS の b1)で、
+ * ピクセルシェーダーの中で YUV → RGB に変換します。CPU 変換のフレームは RGB のテクスチャ(t0)を読みます。
+ * 四角形は SV_VertexID から作るため頂点バッファはありません。
+ *
+ * - ゲーム内の面: 不透明・深度テストと書き込みあり(RenderSystem は描画キューの後、半透明の前に描く)
+ * - 全画面: 深度なしで画面全体に描く(RenderSystem の最後)。縦横比を保つ場合、動画の外は黒
+ *
+ * ステートは StateCache を通して設定し、元には戻しません。
+ */
+#pragma once
+#include "graphics/Camera.h"
+#include "graphics/GfxDevice.h"
+#include "graphics/ShaderCache.h"
+#include "graphics/VideoPlayer.h"
+#include "components/VideoSurface.h"
+#include "app/DebugLog.h"
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class VideoSurfaceRenderer
+ * @brief VideoSurface を集めて描く
+ *
+ * @par 使用例
+ * @code
+ * videoSurfaces.Init(device, compileFlags);
+ *
+ * // 毎フレーム
+ * videoSurfaces.BeginFrame();
+ * videoSurfaces.Add(surface, worldMatrix);
+ * videoSurfaces.DrawWorld(states, cam);        // 不透明の描画の後
+ * videoSurfaces.DrawFullscreen(states, aspect); // 3D の描画の最後
+ * @endcode
+ */
+class VideoSurfaceRenderer {
+public:
+    /**
+     * @struct Statistics
+     * @brief 直近のフレームの結果
+     */
+    struct Statistics {
+        size_t surfaces = 0;   ///< 描いた面
+        size_t nv12Draws = 0;  ///< NV12 のフレームを直接変換して描いた面
+    };
+
+    VideoSurfaceRenderer() = default;
+    VideoSurfaceRenderer(const VideoSurfaceRenderer&) = delete;
+    VideoSurfaceRenderer& operator=(const VideoSurfaceRenderer&) = delete;
+
+    /**
+     * @brief シェーダーのコンパイルと定数バッファ・ステートの作成
+     * @return bool 成功した場合 true(失敗した場合は VideoSurface を描かない)
+     */
+    bool Init(ID3D11Device* device, UINT compileFlags) {
+        Shutdown();
+        if (!compileShaders(device, compileFlags) || !createStates(device)) {
+            Shutdown();
+            return false;
+        }
+        ready_ = true;
+        return true;
+    }
+
+    bool IsReady() const { return ready_; }
+
+    void Shutdown() {
+        ready_ = false;
+        vs_.Reset();
+        psNv12_.Reset();
+        psRgb_.Reset();
+        drawCb_.Reset();
+        depthWorld_.Reset();
+        depthFullscreen_.Reset();
+        raster_.Reset();
+        sampler_.Reset();
+        for (PipelineState& pipeline : pipelines_) pipeline = PipelineState();
+        world_.clear();
+        fullscreen_.clear();
+    }
+
+    /**
+     * @brief フレームの開始(面の一覧を空にする)
+     */
+    void BeginFrame() {
+        world_.clear();
+        fullscreen_.clear();
+        stats_ = Statistics{};
+    }
+
+    /**
+     * @brief 面を追加(表示したフレームのない VideoPlayer は描かない)
+     * @param[in] world ワールド行列(fullscreen では無視)
+     */
+    void Add(const VideoSurface& surface, const DirectX::XMMATRIX& world) {
+        if (!surface.player) return;
+        Item item;
+        if (!surface.player->GetFrame(item.frame)) return;
+        item.surface = surface;
+        DirectX::XMStoreFloat4x4(&item.world, world);
+        (surface.fullscreen ? fullscreen_ : world_).push_back(item);
+    }
+
+    bool HasWorldSurfaces() const { return !world_.empty(); }
+    bool HasFullscreenSurfaces() const { return !fullscreen_.empty(); }
+
+    /**
+     * @brief ゲーム内の面を描く(不透明・深度テストあり)
+     */
+    void DrawWorld(StateCache& states, const Camera& cam) {
+        if (!ready_) return;
+        for (const Item& item : world_) {
+            const DirectX::XMMATRIX wvp = DirectX::XMLoadFloat4x4(&item.world) * cam.ViewProj;
+            draw(states, item, wvp, item.surface.size, DirectX::XMFLOAT4{ 0.0f, 0.0f, 1.0f, 1.0f }, false);
+        }
+    }
+
+    /**
+     * @brief 全画面の面を描く(深度なし)
+     * @param[in] screenAspect 描画先の縦横比(幅 / 高さ)
+     */
+    void DrawFullscreen(StateCache& states, float screenAspect) {
+        if (!ready_) return;
+        for (const Item& item : fullscreen_) {
+            // 画面全体の四角形で、縦横比を保つ場合は UV を広げて動画の外を黒にする
+            DirectX::XMFLOAT4 uvRect{ 0.0f, 0.0f, 1.0f, 1.0f };
+            const VideoPlayer& player = *item.surface.player;
+            if (item.surface.preserveAspect && player.GetWidth() > 0 && player.GetHeight() > 0 && screenAspect > 0.0f) {
+                const float ratio = screenAspect * static_cast<float>(player.GetHeight()) / static_cast<float>(player.GetWidth());
+                if (ratio > 1.0f) {
+                    uvRect = DirectX::XMFLOAT4{ 0.5f - 0.5f * ratio, 0.0f, ratio, 1.0f };                 // 左右に余白
+                } else {
+                    uvRect = DirectX::XMFLOAT4{ 0.0f, 0.5f - 0.5f / ratio, 1.0f, 1.0f / ratio };         // 上下に余白
+                }
+            }
+            draw(states, item, DirectX::XMMatrixIdentity(), DirectX::XMFLOAT2{ 2.0f, 2.0f }, uvRect, true);
+        }
+    }
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+    size_t GpuMemoryBytes() const { return GfxDevice::BufferBytes(drawCb_.Get()); }
+
+private:
+    enum PipelineIndex : uint32_t {
+        PIPELINE_WORLD_RGB = 0,
+        PIPELINE_WORLD_NV12,
+        PIPELINE_FULLSCREEN_RGB,
+        PIPELINE_FULLSCREEN_NV12,
+        PIPELINE_COUNT
+    };
+
+    /**
+     * @struct DrawConstants
+     * @brief 面ごとの定数(VS・PS の b0、HLSL の DrawConstants と同じレイアウト)
+     */
+    struct DrawConstants {
+        DirectX::XMFLOAT4X4 worldViewProj;  ///< 転置済み
+        DirectX::XMFLOAT4 tint;             ///< 乗算する色
+        DirectX::XMFLOAT4 uvRect;           ///< xy: UV の左上, zw: UV の幅・高さ([0, 1] の外は黒)
+        DirectX::XMFLOAT2 size;             ///< 四角形の幅・高さ
+        DirectX::XMFLOAT2 padding;
+    };
+
+    struct Item {
+        VideoSurface surface;
+        VideoPlayer::Frame frame;
+        DirectX::XMFLOAT4X4 world;
+    };
+
+    void draw(StateCache& states, const Item& item, const DirectX::XMMATRIX& wvp, const DirectX::XMFLOAT2& size,
+              const DirectX::XMFLOAT4& uvRect, bool fullscreen) {
+        ID3D11DeviceContext* ctx = states.Context();
+        DrawConstants constants{};
+        DirectX::XMStoreFloat4x4(&constants.worldViewProj, DirectX::XMMatrixTranspose(wvp));
+        constants.tint = item.surface.tint;
+        constants.uvRect = uvRect;
+        constants.size = size;
+        ctx->UpdateSubresource(drawCb_.Get(), 0, nullptr, &constants, 0, 0);
+
+        const bool nv12 = item.frame.luma != nullptr;
+        const uint32_t index = (fullscreen ? PIPELINE_FULLSCREEN_RGB : PIPELINE_WORLD_RGB) + (nv12 ? 1u : 0u);
+        states.Apply(pipelines_[index]);
+        states.SetVSConstantBuffer(0, drawCb_.Get());
+        states.SetPSConstantBuffer(0, drawCb_.Get());
+        states.SetPSSampler(0, sampler_.Get());
+        if (nv12) {
+            states.SetPSConstantBuffer(1, item.frame.convert);
+            ID3D11ShaderResourceView* planes[2] = { item.frame.luma, item.frame.chroma };
+            ctx->PSSetShaderResources(0, 2, planes);
+            stats_.nv12Draws++;
+        } else {
+            ctx->PSSetShaderResources(0, 1, &item.frame.rgb);
+        }
+        ctx->Draw(4, 0);
+        stats_.surfaces++;
+    }
+
+    bool compileShaders(ID3D11Device* device, UINT compileFlags) {
+        const char* VS = R"(
+            cbuffer DrawConstants : register(b0) { float4x4 gWorldViewProj; float4 gTint; float4 gUvRect; float2 gSize; float2 gPadding; };
+            struct VSOut { float4 pos : SV_POSITION; float2 uv : TEXCOORD0; };
+            VSOut main(uint id : SV_VertexID) {
+                // 三角形ストリップの 0:左上 1:右上 2:左下 3:右下
+                float2 corner = float2(id & 1, id >> 1);
+                float3 local = float3((corner.x - 0.5) * gSize.x, (0.5 - corner.y) * gSize.y, 0.0);
+                VSOut o;
+                o.pos = mul(float4(local, 1.0), gWorldViewProj);
+                o.uv = gUvRect.xy + corner * gUvRect.zw;
+                return o;
+            }
+        )";
+
+        const char* PS = R"(
+            cbuffer DrawConstants : register(b0) { float4x4 gWorldViewProj; float4 gTint; float4 gUvRect; float2 gSize; float2 gPadding; };
+            SamplerState gSampler : register(s0);
+            struct VSOut { float4 pos : SV_POSITION; float2 uv : TEXCOORD0; };
+        #ifdef VIDEO_NV12
+            cbuffer ConvertConstants : register(b1) { float4 gRows[3]; float2 gUvScale; float2 gConvertPadding; };
+            Texture2D<float> gLuma : register(t0);
+            Texture2D<float2> gChroma : register(t1);
+            float3 SampleVideo(float2 uv) {
+                uv *= gUvScale;
+                float4 ycc = float4(gLuma.Sample(gSampler, uv), gChroma.Sample(gSampler, uv), 1.0);
+                return saturate(float3(dot(gRows[0], ycc), dot(gRows[1], ycc), dot(gRows[2], ycc)));
+            }
+        #else
+            Texture2D gVideo : register(t0);
+            float3 SampleVideo(float2 uv) { return gVideo.Sample(gSampler, uv).rgb; }
+        #endif
+            float4 main(VSOut i) : SV_Target {
+                if (any(i.uv < 0.0) || any(i.uv > 1.0)) return float4(0, 0, 0, 1);
+                return float4(SampleVideo(i.uv) * gTint.rgb, 1.0);
+            }
+        )";
+
+        auto errorText = [](const Microsoft::WRL::ComPtr<ID3DBlob>& err) {
+            return err ? ": " + std::string(static_cast<const char*>(err->GetBufferPointer()), err->GetBufferSize()) : std::string();
+        };
+        Microsoft::WRL::ComPtr<ID3DBlob> vsb, rgbb, nv12b, err;
+        if (FAILED(ShaderCache::Compile(VS, nullptr, "main", "vs_5_0", compileFlags, vsb, err))) {
+            DEBUGLOG_ERROR("[VideoSurfaceRenderer] 頂点シェーダーのコンパイル失敗" + errorText(err));
+            return false;
+        }
+        if (FAILED(ShaderCache::Compile(PS, nullptr, "main", "ps_5_0", compileFlags, rgbb, err))) {
+            DEBUGLOG_ERROR("[VideoSurfaceRenderer] ピクセルシェーダー(RGB)のコンパイル失敗" + errorText(err));
+            return false;
+        }
+        const D3D_SHADER_MACRO defines[] = { { "VIDEO_NV12", "1" }, { nullptr, nullptr } };
+        if (FAILED(ShaderCache::Compile(PS, defines, "main", "ps_5_0", compileFlags, nv12b, err))) {
+            DEBUGLOG_ERROR("[VideoSurfaceRenderer] ピクセルシェーダー(NV12)のコンパイル失敗" + errorText(err));
+            return false;
+        }
+        if (FAILED(device->CreateVertexShader(vsb->GetBufferPointer(), vsb->GetBufferSize(), nullptr, vs_.GetAddressOf())) ||
+            FAILED(device->CreatePixelShader(rgbb->GetBufferPointer(), rgbb->GetBufferSize(), nullptr, psRgb_.GetAddressOf())) ||
+            FAILED(device->CreatePixelShader(nv12b->GetBufferPointer(), nv12b->GetBufferSize(), nullptr, psNv12_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[VideoSurfaceRenderer] シェーダーの作成失敗");
+            return false;
+        }
+        return true;
+    }
+
+    bool createStates(ID3D11Device* device) {
+        D3D11_BUFFER_DESC bd{};
+        bd.ByteWidth = sizeof(DrawConstants);
+        bd.Usage = D3D11_USAGE_DEFAULT;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        if (FAILED(device->CreateBuffer(&bd, nullptr, drawCb_.GetAddressOf()))) {
+            DEBUGLOG_ERROR("[VideoSurfaceRenderer] 定数バッファの作成失敗");
+            return false;
+        }
+
+        D3D11_DEPTH_STENCIL_DESC dd{};
+        dd.DepthEnable = TRUE;
+        dd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+        dd.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+        if (FAILED(device->CreateDepthStencilState(&dd, depthWorld_.GetAddressOf()))) return false;
+        dd.DepthEnable = FALSE;
+        dd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+        dd.DepthFunc = D3D11_COMPARISON_ALWAYS;
+        if (FAILED(device->CreateDepthStencilState(&dd, depthFullscreen_.GetAddressOf()))) return false;
+
+        // ゲーム内の画面は裏からも見える
+        D3D11_RASTERIZER_DESC rd{};
+        rd.FillMode = D3D11_FILL_SOLID;
+        rd.CullMode = D3D11_CULL_NONE;
+        rd.DepthClipEnable = TRUE;
+        if (FAILED(device->CreateRasterizerState(&rd, raster_.GetAddressOf()))) return false;
+
+        D3D11_SAMPLER_DESC sd{};
+        sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        sd.AddressU = sd.AddressV = sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        sd.MaxLOD = D3D11_FLOAT32_MAX;
+        if (FAILED(device->CreateSamplerState(&sd, sampler_.GetAddressOf()))) return false;
+
+        PipelineStateDesc desc;
+        desc.vertexShader = vs_.Get();
+        desc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+        desc.rasterizerState = raster_.Get();
+        for (uint32_t i = 0; i < PIPELINE_COUNT; ++i) {
+            const bool fullscreen = i >= PIPELINE_FULLSCREEN_RGB;
+            desc.pixelShader = (i % 2) ? psNv12_.Get() : psRgb_.Get();
+            desc.depthStencilState = fullscreen ? depthFullscreen_.Get() : depthWorld_.Get();
+            pipelines_[i] = PipelineState(desc);
+        }
+        return true;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> vs_;                ///< SV_VertexID の四角形
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> psRgb_;              ///< RGB のテクスチャ
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> psNv12_;             ///< NV12 の輝度・色差を変換
+    Microsoft::WRL::ComPtr<ID3D11Buffer> drawCb_;                  ///< DrawConstants
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthWorld_;   ///< 深度テストと書き込み
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthFullscreen_; ///< 深度なし
+    Microsoft::WRL::ComPtr<ID3D11RasterizerState> raster_;         ///< カリングなし
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler_;           ///< バイリニア・クランプ
+    PipelineState pipelines_[PIPELINE_COUNT];                      ///< PipelineIndex の組み合わせ
+    std::vector<Item> world_;                                      ///< このフレームのゲーム内の面
+    std::vector<Item> fullscreen_;                                 ///< このフレームの全画面の面
+    Statistics stats_;
+    bool ready_ = false;
+};
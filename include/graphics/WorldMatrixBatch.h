@@ -0,0 +1,338 @@
+/**
+ * @file WorldMatrixBatch.h
+ * @brief 位置・回転(オイラー角)・スケールの配列からワールド行列と WVP 行列をまとめて計算するカーネル
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform::ToMatrix() は1エンティティごとにクォータニオンを作り、スケール・回転・平行移動を合成します。
+ * このカーネルは配列をまとめて受け取り、オイラー角から回転行列の要素を直接求め、
+ * (必要なら転置して)ワールド行列と WVP 行列を書き込み先へ直接格納します。
+ * 書き込み先は要素間のバイト数(stride)を指定できるため、インスタンスバッファの構造体の
+ * 行列メンバーへそのまま書き込めます。
+ *
+ * 実装は2種類で、起動後の最初の呼び出しで CPUID を調べて選びます。
+ * - Avx2: 8 エンティティを1組として、x/y/z を 8 レーンの列に集めて計算する(AVX2 と FMA が必要)
+ * - Sse : 1エンティティずつ DirectXMath(SSE)で計算する(8 の倍数に満たない残りもこちら)
+ * AVX2 の命令は該当する関数の中だけで使うため、/arch:AVX なしのビルドでも AVX2 のない CPU で動作します。
+ *
+ * 三角関数の近似は XMVectorSinCos と同じ多項式なので、どちらの実装でも結果はほぼ一致します
+ * (Transform::ToMatrix() との差も浮動小数点の丸め程度)。
+ *
+ * @note クォータニオンで向きを保持する Transform(useQuaternion)は対象外です
+ */
+#pragma once
+#include <DirectXMath.h>
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#if defined(_MSC_VER)
+#define WORLD_MATRIX_BATCH_AVX2
+#else
+#define WORLD_MATRIX_BATCH_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+/**
+ * @class WorldMatrixBatch
+ * @brief オイラー角の Transform の配列からワールド行列・WVP 行列を計算する
+ *
+ * @par 使用例
+ * @code
+ * // インスタンスバッファの world メンバーへ転置済みの行列を直接書き込む
+ * WorldMatrixBatch::Output out;
+ * out.world = &instances[0].world;
+ * out.worldStride = sizeof(InstanceData);
+ * WorldMatrixBatch::Build(positions, rotations, scales, count, out);
+ *
+ * // 定数バッファ用に WVP も求める
+ * const DirectX::XMMATRIX viewProj = cam.ViewProj;
+ * out.wvp = wvpMatrices;
+ * out.viewProj = &viewProj;
+ * WorldMatrixBatch::Build(positions, rotations, scales, count, out);
+ * @endcode
+ */
+class WorldMatrixBatch {
+public:
+    static constexpr size_t LANES = 8;  ///< Avx2 で1度に計算するエンティティ数
+
+    /**
+     * @enum Kernel
+     * @brief 計算に使う実装
+     */
+    enum class Kernel : uint8_t {
+        Auto,   ///< CPU に合わせて選ぶ(Avx2 が使えれば Avx2)
+        Sse,    ///< DirectXMath で1つずつ
+        Avx2,   ///< 8 レーンずつ(使えない CPU では Sse になる)
+    };
+
+    /**
+     * @struct Output
+     * @brief 書き込み先(stride はバイト単位、nullptr の出力は書かない)
+     */
+    struct Output {
+        DirectX::XMFLOAT4X4* world = nullptr;           ///< ワールド行列
+        size_t worldStride = sizeof(DirectX::XMFLOAT4X4);
+        DirectX::XMFLOAT4X4* wvp = nullptr;             ///< ワールド行列 * viewProj
+        size_t wvpStride = sizeof(DirectX::XMFLOAT4X4);
+        const DirectX::XMMATRIX* viewProj = nullptr;    ///< wvp を書く場合に必要
+        bool transpose = true;                          ///< シェーダー用に転置して書くか
+    };
+
+    /**
+     * @brief count 個のワールド行列(スケール → 回転 → 平行移動)を計算して書き込む
+     * @param[in] position 位置の配列
+     * @param[in] rotation 回転(度数法のオイラー角、Transform::rotation と同じ軸順)の配列
+     * @param[in] scale スケールの配列
+     * @param[in] count 要素数
+     * @param[in] out 書き込み先
+     * @param[in] kernel 使う実装(Auto 以外は計測・比較用)
+     */
+    static void Build(const DirectX::XMFLOAT3* position, const DirectX::XMFLOAT3* rotation, const DirectX::XMFLOAT3* scale,
+                      size_t count, const Output& out, Kernel kernel = Kernel::Auto) {
+        if (count == 0 || (!out.world && !out.wvp)) return;
+        if (out.wvp && !out.viewProj) return;
+
+        size_t done = 0;
+        if (Resolve(kernel) == Kernel::Avx2) {
+            done = count - count % LANES;
+            if (done > 0) buildAvx2(position, rotation, scale, done, out);
+        }
+        buildSse(position, rotation, scale, done, count, out);
+    }
+
+    /**
+     * @brief 実際に使われる実装(Auto と使えない Avx2 を解決したもの)
+     */
+    static Kernel Resolve(Kernel kernel) {
+        if (kernel == Kernel::Sse) return Kernel::Sse;
+        return IsAvx2Supported() ? Kernel::Avx2 : Kernel::Sse;
+    }
+
+    /**
+     * @brief AVX2 と FMA が使えるか(CPU と OS の両方、初回に1度だけ調べる)
+     */
+    static bool IsAvx2Supported() {
+        static const bool supported = detectAvx2();
+        return supported;
+    }
+
+    static const char* KernelName(Kernel kernel) {
+        switch (kernel) {
+        case Kernel::Auto: return "Auto";
+        case Kernel::Sse:  return "SSE";
+        case Kernel::Avx2: return "AVX2";
+        }
+        return "Unknown";
+    }
+
+private:
+    static constexpr float DEG_TO_RAD = DirectX::XM_PI / 180.0f;
+
+    static bool detectAvx2() {
+#if defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0);
+        if (regs[0] < 7) return false;
+        __cpuid(regs, 1);
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        const bool fma = (regs[2] & (1 << 12)) != 0;
+        if (!osxsave || !avx || !fma) return false;
+        // OS が YMM レジスタを保存するか(XCR0 の SSE と AVX の状態)
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+    static DirectX::XMFLOAT4X4* at(DirectX::XMFLOAT4X4* base, size_t stride, size_t i) {
+        return reinterpret_cast<DirectX::XMFLOAT4X4*>(reinterpret_cast<uint8_t*>(base) + stride * i);
+    }
+
+    // [begin, end) を DirectXMath で1つずつ計算
+    static void buildSse(const DirectX::XMFLOAT3* position, const DirectX::XMFLOAT3* rotation, const DirectX::XMFLOAT3* scale,
+                         size_t begin, size_t end, const Output& out) {
+        using namespace DirectX;
+        const XMVECTOR degToRad = XMVectorReplicate(DEG_TO_RAD);
+        for (size_t i = begin; i < end; ++i) {
+            // x: ピッチ, y: ヨー, z: ロール の sin / cos を1回で求める
+            XMVECTOR sinAngles, cosAngles;
+            XMVectorSinCos(&sinAngles, &cosAngles, XMVectorMultiply(XMLoadFloat3(&rotation[i]), degToRad));
+            XMFLOAT4A s, c;
+            XMStoreFloat4A(&s, sinAngles);
+            XMStoreFloat4A(&c, cosAngles);
+            const float sp = s.x, sy = s.y, sr = s.z;
+            const float cp = c.x, cy = c.y, cr = c.z;
+
+            // XMMatrixRotationRollPitchYaw と同じ(ロール → ピッチ → ヨー)の回転にスケールを掛けた行
+            XMMATRIX world;
+            world.r[0] = XMVectorScale(XMVectorSet(cr * cy + sr * sp * sy, sr * cp, sr * sp * cy - cr * sy, 0.0f), scale[i].x);
+            world.r[1] = XMVectorScale(XMVectorSet(cr * sp * sy - sr * cy, cr * cp, sr * sy + cr * sp * cy, 0.0f), scale[i].y);
+            world.r[2] = XMVectorScale(XMVectorSet(cp * sy, -sp, cp * cy, 0.0f), scale[i].z);
+            world.r[3] = XMVectorSet(position[i].x, position[i].y, position[i].z, 1.0f);
+
+            if (out.world) {
+                XMStoreFloat4x4(at(out.world, out.worldStride, i), out.transpose ? XMMatrixTranspose(world) : world);
+            }
+            if (out.wvp) {
+                const XMMATRIX wvp = XMMatrixMultiply(world, *out.viewProj);
+                XMStoreFloat4x4(at(out.wvp, out.wvpStride, i), out.transpose ? XMMatrixTranspose(wvp) : wvp);
+            }
+        }
+    }
+
+    // XMVectorSinCos と同じ範囲の縮小と多項式(8 レーン)
+    WORLD_MATRIX_BATCH_AVX2 static void sinCos8(__m256 x, __m256& sinOut, __m256& cosOut) {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        // [-π, π] へ
+        const __m256 turns = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(DirectX::XM_1DIV2PI)),
+                                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        x = _mm256_fnmadd_ps(turns, _mm256_set1_ps(DirectX::XM_2PI), x);
+
+        // [-π/2, π/2] へ折り返す(cos の符号を反転)
+        const __m256 sign = _mm256_and_ps(x, signMask);
+        const __m256 c = _mm256_or_ps(_mm256_set1_ps(DirectX::XM_PI), sign);
+        const __m256 absX = _mm256_andnot_ps(signMask, x);
+        const __m256 reflected = _mm256_sub_ps(c, x);
+        const __m256 fold = _mm256_cmp_ps(absX, _mm256_set1_ps(DirectX::XM_PIDIV2), _CMP_GT_OQ);
+        x = _mm256_blendv_ps(x, reflected, fold);
+        const __m256 cosSign = _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_set1_ps(-1.0f), fold);
+
+        const __m256 x2 = _mm256_mul_ps(x, x);
+
+        __m256 s = _mm256_set1_ps(-2.3889859e-08f);
+        s = _mm256_fmadd_ps(s, x2, _mm256_set1_ps(+2.7525562e-06f));
+        s = _mm256_fmadd_ps(s, x2, _mm256_set1_ps(-0.00019840874f));
+        s = _mm256_fmadd_ps(s, x2, _mm256_set1_ps(+0.0083333310f));
+        s = _mm256_fmadd_ps(s, x2, _mm256_set1_ps(-0.16666667f));
+        s = _mm256_fmadd_ps(s, x2, _mm256_set1_ps(1.0f));
+        sinOut = _mm256_mul_ps(s, x);
+
+        __m256 k = _mm256_set1_ps(-2.6051615e-07f);
+        k = _mm256_fmadd_ps(k, x2, _mm256_set1_ps(+2.4760495e-05f));
+        k = _mm256_fmadd_ps(k, x2, _mm256_set1_ps(-0.0013888378f));
+        k = _mm256_fmadd_ps(k, x2, _mm256_set1_ps(+0.041666638f));
+        k = _mm256_fmadd_ps(k, x2, _mm256_set1_ps(-0.5f));
+        k = _mm256_fmadd_ps(k, x2, _mm256_set1_ps(1.0f));
+        cosOut = _mm256_mul_ps(k, cosSign);
+    }
+
+    // 8x8 の転置(r[i] のレーン j → r[j] のレーン i)
+    WORLD_MATRIX_BATCH_AVX2 static void transpose8(__m256* r) {
+        const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+        const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+        const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+        const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+        const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+        const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+        const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+        const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+        const __m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+        const __m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+        const __m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+        const __m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+        const __m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+        const __m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+        const __m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+        const __m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+        r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+        r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+        r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+        r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+        r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+        r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+        r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+        r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+    }
+
+    // 行列の 16 要素の列 m[row * 4 + col](各 8 レーン)を 8 個の行列として書き込む
+    WORLD_MATRIX_BATCH_AVX2 static void store8(const __m256* m, bool transpose, DirectX::XMFLOAT4X4* base, size_t stride) {
+        __m256 lo[8], hi[8];
+        for (int k = 0; k < 8; ++k) {
+            // 書き込む順の k 番目の要素(転置なら列優先で読む)
+            const int src = transpose ? (k % 4) * 4 + k / 4 : k;
+            const int srcHi = transpose ? (k % 4) * 4 + k / 4 + 2 : k + 8;
+            lo[k] = m[src];
+            hi[k] = m[srcHi];
+        }
+        transpose8(lo);
+        transpose8(hi);
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            float* dst = reinterpret_cast<float*>(at(base, stride, lane));
+            _mm256_storeu_ps(dst, lo[lane]);
+            _mm256_storeu_ps(dst + 8, hi[lane]);
+        }
+    }
+
+    WORLD_MATRIX_BATCH_AVX2 static void buildAvx2(const DirectX::XMFLOAT3* position, const DirectX::XMFLOAT3* rotation,
+                                                  const DirectX::XMFLOAT3* scale, size_t count, const Output& out) {
+        // XMFLOAT3 の配列から x / y / z をそれぞれ 8 レーンに集める添字(float 単位)
+        const __m256i gather = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        const __m256 degToRad = _mm256_set1_ps(DEG_TO_RAD);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        DirectX::XMFLOAT4X4 viewProj;
+        if (out.wvp) DirectX::XMStoreFloat4x4(&viewProj, *out.viewProj);
+
+        for (size_t base = 0; base < count; base += LANES) {
+            const float* rot = &rotation[base].x;
+            const float* scl = &scale[base].x;
+            const float* pos = &position[base].x;
+
+            __m256 sp, cp, sy, cy, sr, cr;
+            sinCos8(_mm256_mul_ps(_mm256_i32gather_ps(rot + 0, gather, 4), degToRad), sp, cp);
+            sinCos8(_mm256_mul_ps(_mm256_i32gather_ps(rot + 1, gather, 4), degToRad), sy, cy);
+            sinCos8(_mm256_mul_ps(_mm256_i32gather_ps(rot + 2, gather, 4), degToRad), sr, cr);
+            const __m256 sx = _mm256_i32gather_ps(scl + 0, gather, 4);
+            const __m256 syScale = _mm256_i32gather_ps(scl + 1, gather, 4);
+            const __m256 sz = _mm256_i32gather_ps(scl + 2, gather, 4);
+
+            // buildSse と同じ式(m[row * 4 + col])
+            const __m256 srsp = _mm256_mul_ps(sr, sp);
+            const __m256 crsp = _mm256_mul_ps(cr, sp);
+            __m256 w[16];
+            w[0] = _mm256_mul_ps(_mm256_fmadd_ps(srsp, sy, _mm256_mul_ps(cr, cy)), sx);
+            w[1] = _mm256_mul_ps(_mm256_mul_ps(sr, cp), sx);
+            w[2] = _mm256_mul_ps(_mm256_fmsub_ps(srsp, cy, _mm256_mul_ps(cr, sy)), sx);
+            w[3] = zero;
+            w[4] = _mm256_mul_ps(_mm256_fmsub_ps(crsp, sy, _mm256_mul_ps(sr, cy)), syScale);
+            w[5] = _mm256_mul_ps(_mm256_mul_ps(cr, cp), syScale);
+            w[6] = _mm256_mul_ps(_mm256_fmadd_ps(crsp, cy, _mm256_mul_ps(sr, sy)), syScale);
+            w[7] = zero;
+            w[8] = _mm256_mul_ps(_mm256_mul_ps(cp, sy), sz);
+            w[9] = _mm256_mul_ps(_mm256_xor_ps(sp, _mm256_set1_ps(-0.0f)), sz);
+            w[10] = _mm256_mul_ps(_mm256_mul_ps(cp, cy), sz);
+            w[11] = zero;
+            w[12] = _mm256_i32gather_ps(pos + 0, gather, 4);
+            w[13] = _mm256_i32gather_ps(pos + 1, gather, 4);
+            w[14] = _mm256_i32gather_ps(pos + 2, gather, 4);
+            w[15] = one;
+
+            if (out.world) store8(w, out.transpose, at(out.world, out.worldStride, base), out.worldStride);
+            if (out.wvp) {
+                // wvp[row][col] = Σ world[row][k] * viewProj[k][col](world の 4 列目は 0, 0, 0, 1)
+                __m256 m[16];
+                for (int row = 0; row < 4; ++row) {
+                    for (int col = 0; col < 4; ++col) {
+                        __m256 acc = row == 3 ? _mm256_set1_ps(viewProj.m[3][col]) : zero;
+                        acc = _mm256_fmadd_ps(w[row * 4 + 0], _mm256_set1_ps(viewProj.m[0][col]), acc);
+                        acc = _mm256_fmadd_ps(w[row * 4 + 1], _mm256_set1_ps(viewProj.m[1][col]), acc);
+                        acc = _mm256_fmadd_ps(w[row * 4 + 2], _mm256_set1_ps(viewProj.m[2][col]), acc);
+                        m[row * 4 + col] = acc;
+                    }
+                }
+                store8(m, out.transpose, at(out.wvp, out.wvpStride, base), out.wvpStride);
+            }
+        }
+    }
+};
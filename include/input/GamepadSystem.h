@@ -9,6 +9,10 @@
  * @details
  * XInput と DirectInput を統合し、最大4つのゲームパッドの入力を管理します。
  * XInputデバイスを優先的に使用し、XInputで認識されないデバイスはDirectInputで処理します。
+ *
+ * 接続の検出(未接続の XInput スロットの確認と DirectInput デバイスの列挙)はバックグラウンドのスレッドで行います。
+ * 未接続のスロットの XInputGetState() や列挙中の WMI の問い合わせはミリ秒～数百ミリ秒かかるため、
+ * Update() は接続済みのデバイスだけを読み、列挙の結果はロックを待たずに受け取ります。
  */
 
 #define WIN32_LEAN_AND_MEAN
@@ -16,7 +20,13 @@
 #include <Windows.h>
 #include <Xinput.h>
 #include <dinput.h>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <cstring>
 #include <cmath>
 
@@ -82,6 +92,29 @@ public:
         Button_Count = 14 ///< ボタン総数
     };
 
+    /**
+     * @struct ReplayPad
+     * @brief 1台分の処理済みの状態(InputReplay の記録・再生用)
+     */
+    struct ReplayPad {
+        bool connected;                  ///< 接続状態
+        uint8_t buttons[Button_Count];   ///< ボタン状態(ButtonState)
+        float leftStickX;                ///< 左スティックX(デッドゾーン適用後)
+        float leftStickY;                ///< 左スティックY
+        float rightStickX;               ///< 右スティックX
+        float rightStickY;               ///< 右スティックY
+        float leftTrigger;               ///< 左トリガー(閾値適用後)
+        float rightTrigger;              ///< 右トリガー
+    };
+
+    /**
+     * @struct ReplayFrame
+     * @brief 1ステップ分の全スロットの状態
+     */
+    struct ReplayFrame {
+        ReplayPad pads[MAX_GAMEPADS];
+    };
+
     /**
      * @brief デフォルトコンストラクタ
      */
@@ -111,12 +144,62 @@ public:
 
     /**
      * @brief 入力状態の更新(毎フレーム呼ぶ)
+     * @param[in] untilTime InputSampler のサンプルをこの時刻(QueryPerformanceCounter の値)まで反映(既定はすべて)
      * 
      * @details
      * XInputとDirectInputの状態を取得し、内部状態を更新します。
    * ボタンの押下・離された瞬間の判定はこの更新処理によって行われます。
+     * InputSampler が XInput をサンプリングしている間は、前回からのサンプルのうち最新の状態を使い、
+     * 途中のサンプルで押されていたボタンも押下として扱います(短い押下を取りこぼさない)。
+     */
+    void Update(int64_t untilTime = INT64_MAX);
+
+    /**
+     * @brief XInput のサンプルを追加(InputSampler のスレッドから呼ぶ)
+     * @param[in] slot XInput のユーザーインデックス
+     * @param[in] pad XInputGetState() の結果
+     * @param[in] time サンプリングした時刻(QueryPerformanceCounter の値)
+     *
+     * @details
+     * 書き込みは1スレッドのみです。キューが一杯の場合は捨てます。
+     */
+    void PushXInputSample(DWORD slot, const XINPUT_GAMEPAD& pad, int64_t time);
+
+    /**
+     * @brief XInput を InputSampler のサンプルから読むかを設定
+     */
+    void SetSampled(bool sampled) { sampled_.store(sampled, std::memory_order_release); }
+
+    /**
+     * @brief チャージ時間の計測に使うデルタタイムを固定(0 で Update() の間隔を計測)
+     *
+     * @details
+     * 入力を記録・再生する場合は、チャージ時間が実行ごとに変わらないようステップの長さを指定します。
+     */
+    void SetFixedDeltaTime(float dt) { fixedDeltaTime_ = dt; }
+
+    /**
+     * @brief 直前の Update() の結果を取り出す(入力の記録用)
+     */
+    void CaptureReplayFrame(ReplayFrame& out) const;
+
+    /**
+     * @brief 記録した状態を Update() の代わりに反映(入力の再生用)
+     * @param[in] frame 記録した状態
+     *
+     * @details
+     * デバイスは読まず、チャージ時間は SetFixedDeltaTime() の値で進めます。
+     */
+    void ApplyReplayFrame(const ReplayFrame& frame);
+
+    /**
+     * @brief デバイスの接続・切断を通知(WM_DEVICECHANGE で呼ぶ)
+     *
+     * @details
+     * バックグラウンドのスレッドに DirectInput デバイスの列挙と XInput スロットの確認を依頼します。
+     * 結果は次回以降の Update() で反映されます(呼び出し元は待ちません)。
      */
-    void Update();
+    void OnDeviceChange();
 
     // ========================================================
     // 統合入力取得（全コントローラー対応）
@@ -326,6 +409,7 @@ private:
         float rightTrigger;          ///< 右トリガー
         LPDIRECTINPUTDEVICE8 dinputDevice;      ///< DirectInputデバイス
         DWORD xinputIndex; ///< XInputインデックス
+        GUID dinputInstance;  ///< DirectInputデバイスのインスタンスGUID(再接続の判定用)
 
         // チャージ&リリースシステム用
         bool leftStickWasCharging;   ///< 前フレームで左スティックがチャージ中だったか
@@ -349,6 +433,7 @@ private:
             leftTrigger = rightTrigger = 0.0f;
             dinputDevice = nullptr;
             xinputIndex = 0;
+            dinputInstance = GUID{};
             
           // チャージシステム初期化
             leftStickWasCharging = false;
@@ -415,10 +500,93 @@ private:
      */
     static bool IsXInputDevice(const GUID* pGuidProductFromDirectInput);
 
+    /**
+     * @struct PendingDevice
+     * @brief 列挙スレッドが作成し、Update() が受け取る前の DirectInput デバイス
+     */
+    struct PendingDevice {
+        LPDIRECTINPUTDEVICE8 device;  ///< データフォーマットと軸の範囲を設定済みのデバイス
+        GUID instance;                ///< インスタンスGUID
+    };
+
+    /**
+     * @struct EnumContext
+     * @brief EnumDevicesCallback() に渡す列挙の状態
+     */
+    struct EnumContext {
+        GamepadSystem* self;
+        std::vector<PendingDevice>* found;
+    };
+
+    /**
+     * @brief 接続の検出スレッドを起動(起動時に1回列挙する)
+     */
+    void StartDeviceThread();
+
+    /**
+     * @brief 接続の検出スレッドを終了
+     */
+    void StopDeviceThread();
+
+    /**
+     * @brief 接続の検出スレッドの処理
+     *
+     * @details
+     * XINPUT_PROBE_INTERVAL_MS ごとに未接続の XInput スロットを確認し、
+     * OnDeviceChange() で依頼された場合は DirectInput デバイスを列挙します。
+     */
+    void DeviceThreadLoop();
+
+    /**
+     * @brief 列挙スレッドが作成したデバイスをスロットに割り当てる(ロックを取れない場合は次のフレーム)
+     */
+    void AdoptPendingDevices();
+
+    /**
+     * @struct XInputSample
+     * @brief InputSampler が取得した XInput の状態1回分
+     */
+    struct XInputSample {
+        int64_t time;        ///< サンプリングした時刻
+        DWORD slot;          ///< XInput のユーザーインデックス
+        XINPUT_GAMEPAD pad;  ///< 状態
+    };
+
+    /**
+     * @brief 前回からのサンプルを untilTime まで読み、スロットごとの最新の状態と押されたボタンにまとめる
+     */
+    void DrainXInputSamples(int64_t untilTime);
+
+    static constexpr uint32_t SAMPLE_RING_SIZE = 256; ///< サンプルのキューの容量(2の累乗)
+
     GamepadState gamepads_[MAX_GAMEPADS];  ///< ゲームパッド状態
     LPDIRECTINPUT8 dinput_;        ///< DirectInput8インターフェース
     int nextDInputSlot_;       ///< 次に使用するDirectInputスロット
     float deltaTime_;    ///< 前フレームのデルタタイム
+    float fixedDeltaTime_ = 0.0f; ///< 0 以外の場合 deltaTime_ の代わりに使う
+
+    // InputSampler からのサンプル(単一生産者・単一消費者のキュー)
+    XInputSample samples_[SAMPLE_RING_SIZE];      ///< サンプルのリングバッファ
+    std::atomic<uint32_t> sampleWrite_{ 0 };      ///< 書き込み位置(InputSampler のスレッド)
+    std::atomic<uint32_t> sampleRead_{ 0 };       ///< 読み込み位置(Update())
+    std::atomic<bool> sampled_{ false };          ///< XInput をサンプルから読むか
+    XINPUT_GAMEPAD sampledPad_[MAX_GAMEPADS] = {}; ///< スロットごとの最新のサンプル
+    bool hasSampledPad_[MAX_GAMEPADS] = {};        ///< sampledPad_ を受け取ったことがあるか
+    WORD sampledPressed_[MAX_GAMEPADS] = {};       ///< 前回の Update() から押されていたボタン
+
+    // 接続の検出スレッド
+    static constexpr uint32_t XINPUT_PROBE_INTERVAL_MS = 1000; ///< 未接続の XInput スロットを確認する間隔
+    std::thread deviceThread_;                     ///< 接続の検出スレッド
+    std::mutex deviceMutex_;                       ///< deviceStop_ / enumRequested_ の保護
+    std::condition_variable deviceCv_;             ///< 終了・列挙の依頼の通知
+    bool deviceStop_ = false;                      ///< スレッドを終了するか
+    bool enumRequested_ = false;                   ///< DirectInput デバイスの列挙を依頼されたか
+    std::atomic<bool> xinputPresent_[MAX_GAMEPADS] = {}; ///< XInput スロットに接続されているか(false の間 Update() は読まない)
+    std::mutex pendingMutex_;                      ///< pendingDevices_ の保護
+    std::vector<PendingDevice> pendingDevices_;    ///< 受け取り待ちのデバイス
+    std::atomic<bool> pendingReady_{ false };      ///< pendingDevices_ が空でないか
+    std::vector<std::pair<GUID, bool>> xinputProducts_; ///< 製品GUIDごとの IsXInputDevice() の結果(列挙スレッドのみ)
+    HWND window_ = nullptr;                        ///< 協調レベルを設定するウィンドウ
 
     // デッドゾーン定数
     static constexpr float XINPUT_LEFT_DEADZONE = 7849.0f / 32767.0f;   ///< 左スティックデッドゾーン
@@ -0,0 +1,304 @@
+/**
+ * @file InputActions.h
+ * @brief 入力のアクション・軸への割り当て(バインディングを平坦な表にまとめて1ステップに1回評価)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * "MoveX" や "Fire" のようなアクションにキー・マウスボタン・ゲームパッドのボタン/軸を割り当て、
+ * Update() でステップごとに1回だけ評価して、アクションごとの値と押下状態の配列に書き込みます。
+ * ゲームのコードは ActionId で引いた評価済みの値を読むだけで、エンティティごとに
+ * InputSystem / GamepadSystem へ問い合わせることはありません。
+ *
+ * バインディングは入力の種類ごとの平坦な表(キー、ボタン、軸)にまとめてから評価します。
+ * Bind*() / Rebind*() / ClearBindings() で変更した場合は、次の Update() で表を作り直します。
+ *
+ * 値はバインディングの値(キー・ボタンは scale、軸は軸の値 × scale)の合計を -1 ～ +1 に制限したものです。
+ * 値の絶対値が PRESS_THRESHOLD 以上の場合を押されている状態とします(トリガーやスティックもボタンとして使える)。
+ * Update() を呼ぶスレッド(シミュレーションのステップ)からのみ使用してください。
+ */
+#pragma once
+#include "input/InputSystem.h"
+#include "input/GamepadSystem.h"
+#include "app/DebugLog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class InputActions
+ * @brief アクション・軸のバインディングと評価済みの状態
+ *
+ * @par 使用例
+ * @code
+ * auto& actions = ServiceLocator::Get<InputActions>();
+ * const InputActions::ActionId fire = actions.Register("Fire");
+ * actions.BindKey(fire, VK_SPACE);
+ * actions.BindButton(fire, GamepadSystem::Button_A);
+ * // ステップごと(InputSystem / GamepadSystem の Update() の後)
+ * actions.Update(input, &gamepad);
+ * if (actions.WasPressed(fire)) Shoot();
+ * @endcode
+ */
+class InputActions {
+public:
+    using ActionId = uint16_t;
+    static constexpr ActionId INVALID_ACTION = 0xFFFF;
+    static constexpr float PRESS_THRESHOLD = 0.5f; ///< 押されている状態とする値の絶対値
+
+    /**
+     * @enum GamepadAxis
+     * @brief ゲームパッドの軸(すべての接続されているゲームパッドの統合値)
+     */
+    enum class GamepadAxis : uint8_t {
+        LeftX,
+        LeftY,
+        RightX,
+        RightY,
+        LeftTrigger,
+        RightTrigger,
+        Count
+    };
+
+    /**
+     * @brief アクションを登録(同じ名前があればそのIDを返す)
+     */
+    ActionId Register(const std::string& name) {
+        auto it = ids_.find(name);
+        if (it != ids_.end()) return it->second;
+        if (names_.size() >= INVALID_ACTION) {
+            DEBUGLOG_ERROR("[InputActions] アクション数の上限に達しました: " + name);
+            return INVALID_ACTION;
+        }
+        const ActionId id = static_cast<ActionId>(names_.size());
+        names_.push_back(name);
+        ids_.emplace(name, id);
+        values_.push_back(0.0f);
+        flags_.push_back(0);
+        return id;
+    }
+
+    /**
+     * @brief 名前からアクションを引く(ない場合 INVALID_ACTION)
+     */
+    ActionId Find(const std::string& name) const {
+        auto it = ids_.find(name);
+        return it != ids_.end() ? it->second : INVALID_ACTION;
+    }
+
+    const std::string& Name(ActionId id) const {
+        static const std::string kEmpty;
+        return IsValid(id) ? names_[id] : kEmpty;
+    }
+
+    bool IsValid(ActionId id) const { return id < names_.size(); }
+    size_t Count() const { return names_.size(); }
+
+    /**
+     * @brief キー(マウスボタンは VK_LBUTTON など)を割り当てる
+     * @param[in] scale 押されている間の値(軸の負の方向は -1.0f)
+     */
+    void BindKey(ActionId id, int vkCode, float scale = 1.0f) {
+        if (vkCode < 0 || vkCode >= 256) return;
+        AddBinding(id, Source::Key, static_cast<uint16_t>(vkCode), scale);
+    }
+
+    /**
+     * @brief ゲームパッドのボタンを割り当てる
+     */
+    void BindButton(ActionId id, GamepadSystem::GamepadButton button, float scale = 1.0f) {
+        AddBinding(id, Source::Button, static_cast<uint16_t>(button), scale);
+    }
+
+    /**
+     * @brief ゲームパッドの軸を割り当てる
+     */
+    void BindAxis(ActionId id, GamepadAxis axis, float scale = 1.0f) {
+        if (axis >= GamepadAxis::Count) return;
+        AddBinding(id, Source::Axis, static_cast<uint16_t>(axis), scale);
+    }
+
+    /**
+     * @brief アクションに割り当てたキーを別のキーに替える
+     * @return bool oldVk が割り当てられていた場合 true
+     */
+    bool RebindKey(ActionId id, int oldVk, int newVk) {
+        if (newVk < 0 || newVk >= 256) return false;
+        bool found = false;
+        for (Binding& binding : bindings_) {
+            if (binding.action == id && binding.source == Source::Key && binding.code == oldVk) {
+                binding.code = static_cast<uint16_t>(newVk);
+                found = true;
+            }
+        }
+        dirty_ |= found;
+        return found;
+    }
+
+    /**
+     * @brief アクションのバインディングをすべて外す
+     */
+    void ClearBindings(ActionId id) {
+        const size_t before = bindings_.size();
+        bindings_.erase(std::remove_if(bindings_.begin(), bindings_.end(),
+                                       [id](const Binding& binding) { return binding.action == id; }),
+                        bindings_.end());
+        dirty_ |= bindings_.size() != before;
+    }
+
+    /**
+     * @brief 既定のアクション(MoveX / MoveY / Fire)を登録して割り当てる
+     */
+    void RegisterDefaults() {
+        const ActionId moveX = Register("MoveX");
+        BindKey(moveX, 'D');
+        BindKey(moveX, VK_RIGHT);
+        BindKey(moveX, 'A', -1.0f);
+        BindKey(moveX, VK_LEFT, -1.0f);
+        BindAxis(moveX, GamepadAxis::LeftX);
+
+        const ActionId moveY = Register("MoveY");
+        BindKey(moveY, 'W');
+        BindKey(moveY, VK_UP);
+        BindKey(moveY, 'S', -1.0f);
+        BindKey(moveY, VK_DOWN, -1.0f);
+        BindAxis(moveY, GamepadAxis::LeftY);
+
+        const ActionId fire = Register("Fire");
+        BindKey(fire, VK_SPACE);
+        BindButton(fire, GamepadSystem::Button_A);
+    }
+
+    /**
+     * @brief すべてのアクションを評価(ステップごとに1回、入力の Update() の後)
+     * @param[in] input キーボード・マウス
+     * @param[in] gamepad ゲームパッド(nullptr の場合はキーボード・マウスのみ)
+     */
+    void Update(const InputSystem& input, const GamepadSystem* gamepad) {
+        if (dirty_) Compile();
+
+        std::fill(values_.begin(), values_.end(), 0.0f);
+
+        for (const Entry& entry : keyTable_) {
+            if (input.GetKey(entry.code)) values_[entry.action] += entry.scale;
+        }
+        if (gamepad) {
+            for (const Entry& entry : buttonTable_) {
+                if (gamepad->GetButton(static_cast<GamepadSystem::GamepadButton>(entry.code))) values_[entry.action] += entry.scale;
+            }
+            if (!axisTable_.empty()) {
+                float axes[static_cast<size_t>(GamepadAxis::Count)];
+                axes[static_cast<size_t>(GamepadAxis::LeftX)] = gamepad->GetLeftStickX();
+                axes[static_cast<size_t>(GamepadAxis::LeftY)] = gamepad->GetLeftStickY();
+                axes[static_cast<size_t>(GamepadAxis::RightX)] = gamepad->GetRightStickX();
+                axes[static_cast<size_t>(GamepadAxis::RightY)] = gamepad->GetRightStickY();
+                axes[static_cast<size_t>(GamepadAxis::LeftTrigger)] = gamepad->GetLeftTrigger();
+                axes[static_cast<size_t>(GamepadAxis::RightTrigger)] = gamepad->GetRightTrigger();
+                for (const Entry& entry : axisTable_) {
+                    values_[entry.action] += axes[entry.code] * entry.scale;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < values_.size(); ++i) {
+            float& value = values_[i];
+            value = std::max(-1.0f, std::min(1.0f, value));
+            const uint8_t wasHeld = flags_[i] & FLAG_HELD;
+            const uint8_t held = std::fabs(value) >= PRESS_THRESHOLD ? FLAG_HELD : 0;
+            uint8_t flags = held;
+            if (held && !wasHeld) flags |= FLAG_PRESSED;
+            if (!held && wasHeld) flags |= FLAG_RELEASED;
+            flags_[i] = flags;
+        }
+    }
+
+    /**
+     * @brief 評価済みの値(-1.0 ～ +1.0、無効なIDは 0)
+     */
+    float Value(ActionId id) const { return IsValid(id) ? values_[id] : 0.0f; }
+
+    /**
+     * @brief 押されているか
+     */
+    bool IsHeld(ActionId id) const { return IsValid(id) && (flags_[id] & FLAG_HELD) != 0; }
+
+    /**
+     * @brief このステップで押されたか
+     */
+    bool WasPressed(ActionId id) const { return IsValid(id) && (flags_[id] & FLAG_PRESSED) != 0; }
+
+    /**
+     * @brief このステップで離されたか
+     */
+    bool WasReleased(ActionId id) const { return IsValid(id) && (flags_[id] & FLAG_RELEASED) != 0; }
+
+private:
+    enum class Source : uint8_t { Key, Button, Axis };
+
+    static constexpr uint8_t FLAG_HELD = 1u << 0;
+    static constexpr uint8_t FLAG_PRESSED = 1u << 1;
+    static constexpr uint8_t FLAG_RELEASED = 1u << 2;
+
+    /**
+     * @struct Binding
+     * @brief 登録されたバインディング(編集用)
+     */
+    struct Binding {
+        ActionId action;
+        Source source;
+        uint16_t code;  ///< 仮想キーコード / GamepadButton / GamepadAxis
+        float scale;
+    };
+
+    /**
+     * @struct Entry
+     * @brief 評価用の表の1行
+     */
+    struct Entry {
+        uint16_t code;
+        ActionId action;
+        float scale;
+    };
+
+    void AddBinding(ActionId id, Source source, uint16_t code, float scale) {
+        if (!IsValid(id)) return;
+        bindings_.push_back(Binding{ id, source, code, scale });
+        dirty_ = true;
+    }
+
+    /**
+     * @brief バインディングを入力の種類ごとの表にまとめる(入力の順に並べる)
+     */
+    void Compile() {
+        keyTable_.clear();
+        buttonTable_.clear();
+        axisTable_.clear();
+        for (const Binding& binding : bindings_) {
+            const Entry entry{ binding.code, binding.action, binding.scale };
+            switch (binding.source) {
+                case Source::Key:    keyTable_.push_back(entry); break;
+                case Source::Button: buttonTable_.push_back(entry); break;
+                case Source::Axis:   axisTable_.push_back(entry); break;
+            }
+        }
+        auto byCode = [](const Entry& a, const Entry& b) { return a.code < b.code; };
+        std::stable_sort(keyTable_.begin(), keyTable_.end(), byCode);
+        std::stable_sort(buttonTable_.begin(), buttonTable_.end(), byCode);
+        std::stable_sort(axisTable_.begin(), axisTable_.end(), byCode);
+        dirty_ = false;
+    }
+
+    std::vector<std::string> names_;                    ///< ID -> 名前
+    std::unordered_map<std::string, ActionId> ids_;     ///< 名前 -> ID
+    std::vector<Binding> bindings_;                     ///< 登録されたバインディング
+    std::vector<Entry> keyTable_;                       ///< キー・マウスボタンの表
+    std::vector<Entry> buttonTable_;                    ///< ゲームパッドのボタンの表
+    std::vector<Entry> axisTable_;                      ///< ゲームパッドの軸の表
+    std::vector<float> values_;                         ///< アクションごとの評価済みの値
+    std::vector<uint8_t> flags_;                        ///< アクションごとの FLAG_*
+    bool dirty_ = false;                                ///< 表を作り直す必要があるか
+};
@@ -0,0 +1,352 @@
+/**
+ * @file InputReplay.h
+ * @brief 入力の記録と再生(ビルド間の性能比較で同じシミュレーションを実行する)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 記録時はステップごとに InputSystem / GamepadSystem の処理済みの状態を前のステップとの差分だけ書き出し、
+ * ファイルの先頭に乱数のシードと固定ステップの長さを記録します。
+ * 再生時は Update() の代わりにファイルの状態を反映し、同じシードで util::Random を初期化するため、
+ * フレームレートや実際の操作に関係なく毎回同じ入力列でシミュレーションが進みます
+ * (再生が終わるとアプリケーションを終了します)。
+ *
+ * ファイル形式(リトルエンディアン):
+ * - ヘッダー: magic "HIRP", version(u32), seed(u64), fixedTimestep(f32), stepCount(u32)
+ * - ステップごと: flags(u8) に続いて、変わったものだけ
+ *   - FLAG_KEYS: 変わったキーの数(u16)と (仮想キーコード(u8), KeyState(u8)) の列
+ *   - FLAG_MOUSE: x(i32), y(i32), wheel(i32)
+ *   - FLAG_PADS: スロットごとに connected(u8)、接続中ならボタン状態(2ビット×14、u32)と軸6本(f32)
+ *
+ * @note util::Random はスレッドごとのエンジンのため、シードはメインスレッドとシミュレーションのステップを
+ *       実行するスレッドに設定します。ワーカースレッド(World::ParallelForEach)から util::Random を呼ぶ処理は
+ *       再現されません(util::Rng をシードとエンティティIDで初期化してください)。
+ */
+#pragma once
+#include "input/InputSystem.h"
+#include "input/GamepadSystem.h"
+#include "app/DebugLog.h"
+#include "app/CommandLine.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @struct InputReplayConfig
+ * @brief 入力の記録・再生の設定(コマンドライン)
+ *
+ * @details
+ * - `--record-input <path>`: 入力を記録する
+ * - `--replay-input <path>`: 記録した入力を再生する(記録より優先)
+ * - `--replay-seed <n>`: 記録時の乱数のシード(省略時は起動ごとに変える)
+ */
+struct InputReplayConfig {
+    std::string recordPath;  ///< 記録先(空の場合は記録しない)
+    std::string replayPath;  ///< 再生するファイル(空の場合は再生しない)
+    uint64_t seed = 0;       ///< 記録時のシード(0 は起動ごとに変える)
+
+    /**
+     * @brief コマンドラインから設定を読む
+     * @return bool `--record-input` か `--replay-input` が指定されていた場合 true
+     */
+    static bool Parse(const char* cmdLine, InputReplayConfig& out) {
+        if (!cmdLine) return false;
+        const std::vector<std::string> args = CommandLine::Split(cmdLine);
+
+        InputReplayConfig config;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            const std::string& key = args[i];
+            if (key == "--record-input") config.recordPath = args[i + 1];
+            else if (key == "--replay-input") config.replayPath = args[i + 1];
+            else if (key == "--replay-seed") config.seed = std::strtoull(args[i + 1].c_str(), nullptr, 10);
+        }
+        if (config.recordPath.empty() && config.replayPath.empty()) return false;
+        out = config;
+        return true;
+    }
+};
+
+/**
+ * @class InputReplay
+ * @brief ステップごとの入力状態の記録・再生
+ *
+ * @par 使用例
+ * @code
+ * // 記録
+ * replay.StartRecording("run.inputs", seed, FIXED_TIMESTEP);
+ * input.Update(); gamepad.Update();
+ * replay.RecordStep(input, gamepad);
+ * replay.Stop();
+ *
+ * // 再生
+ * replay.StartReplay("run.inputs");
+ * if (!replay.ReplayStep(input, gamepad)) Quit(); // 最後のステップまで再生した
+ * @endcode
+ */
+class InputReplay {
+public:
+    static constexpr uint32_t MAGIC = 0x50524948u;  ///< "HIRP"
+    static constexpr uint32_t VERSION = 1;
+
+    enum class Mode { None, Recording, Replaying };
+
+    ~InputReplay() { Stop(); }
+
+    /**
+     * @brief 記録を開始
+     * @return bool ファイルを作成できた場合 true
+     */
+    bool StartRecording(const std::string& path, uint64_t seed, float fixedTimestep) {
+        Stop();
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_) {
+            DEBUGLOG_ERROR("[InputReplay] 記録ファイルを作成できません: " + path);
+            return false;
+        }
+        seed_ = seed;
+        fixedTimestep_ = fixedTimestep;
+        stepCount_ = 0;
+        buffer_.clear();
+        WriteHeader();
+        file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+        ResetPrevious();
+        mode_ = Mode::Recording;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Input, "[InputReplay] 記録開始: " + path + " (seed=" + std::to_string(seed) + ")");
+        return true;
+    }
+
+    /**
+     * @brief 再生を開始(ファイル全体を読み込む)
+     * @return bool ヘッダーが正しい場合 true(seed / fixedTimestep はヘッダーの値)
+     */
+    bool StartReplay(const std::string& path) {
+        Stop();
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            DEBUGLOG_ERROR("[InputReplay] 再生ファイルを開けません: " + path);
+            return false;
+        }
+        data_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        cursor_ = 0;
+        uint32_t magic = 0, version = 0;
+        if (!Read(magic) || !Read(version) || !Read(seed_) || !Read(fixedTimestep_) || !Read(stepCount_) ||
+            magic != MAGIC || version != VERSION) {
+            DEBUGLOG_ERROR("[InputReplay] 再生ファイルの形式が正しくありません: " + path);
+            data_.clear();
+            return false;
+        }
+        ResetPrevious();
+        stepsReplayed_ = 0;
+        mode_ = Mode::Replaying;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Input, "[InputReplay] 再生開始: " + path + " (" + std::to_string(stepCount_) +
+                          " ステップ, seed=" + std::to_string(seed_) + ")");
+        return true;
+    }
+
+    /**
+     * @brief 記録・再生を終了(記録中はステップ数をヘッダーに書き込んで閉じる)
+     */
+    void Stop() {
+        if (mode_ == Mode::Recording) {
+            Flush();
+            file_.seekp(static_cast<std::streamoff>(sizeof(uint32_t) * 2 + sizeof(uint64_t) + sizeof(float)));
+            file_.write(reinterpret_cast<const char*>(&stepCount_), sizeof(stepCount_));
+            file_.close();
+            DEBUGLOG_CATEGORY(DebugLog::Category::Input, "[InputReplay] 記録終了: " + std::to_string(stepCount_) + " ステップ");
+        }
+        data_.clear();
+        data_.shrink_to_fit();
+        mode_ = Mode::None;
+    }
+
+    /**
+     * @brief 今回のステップの入力を記録(InputSystem / GamepadSystem の Update() の後)
+     */
+    void RecordStep(const InputSystem& input, const GamepadSystem& gamepad) {
+        if (mode_ != Mode::Recording) return;
+        InputSystem::ReplayFrame keys;
+        GamepadSystem::ReplayFrame pads;
+        input.CaptureReplayFrame(keys);
+        gamepad.CaptureReplayFrame(pads);
+
+        uint8_t flags = 0;
+        uint16_t changedKeys = 0;
+        for (int i = 0; i < 256; ++i) {
+            if (keys.keyStates[i] != prevKeys_.keyStates[i]) ++changedKeys;
+        }
+        if (changedKeys > 0) flags |= FLAG_KEYS;
+        if (keys.mouseX != prevKeys_.mouseX || keys.mouseY != prevKeys_.mouseY || keys.mouseWheel != prevKeys_.mouseWheel) flags |= FLAG_MOUSE;
+        for (int i = 0; i < GamepadSystem::MAX_GAMEPADS; ++i) {
+            if (!SamePad(pads.pads[i], prevPads_.pads[i])) flags |= FLAG_PADS;
+        }
+
+        Write(flags);
+        if (flags & FLAG_KEYS) {
+            Write(changedKeys);
+            for (int i = 0; i < 256; ++i) {
+                if (keys.keyStates[i] == prevKeys_.keyStates[i]) continue;
+                Write(static_cast<uint8_t>(i));
+                Write(keys.keyStates[i]);
+            }
+        }
+        if (flags & FLAG_MOUSE) {
+            Write(static_cast<int32_t>(keys.mouseX));
+            Write(static_cast<int32_t>(keys.mouseY));
+            Write(static_cast<int32_t>(keys.mouseWheel));
+        }
+        if (flags & FLAG_PADS) {
+            for (const GamepadSystem::ReplayPad& pad : pads.pads) {
+                Write(static_cast<uint8_t>(pad.connected ? 1 : 0));
+                if (!pad.connected) continue;
+                uint32_t buttons = 0;
+                for (int b = 0; b < GamepadSystem::Button_Count; ++b) buttons |= static_cast<uint32_t>(pad.buttons[b] & 3u) << (b * 2);
+                Write(buttons);
+                Write(pad.leftStickX);
+                Write(pad.leftStickY);
+                Write(pad.rightStickX);
+                Write(pad.rightStickY);
+                Write(pad.leftTrigger);
+                Write(pad.rightTrigger);
+            }
+        }
+
+        prevKeys_ = keys;
+        prevPads_ = pads;
+        ++stepCount_;
+        if (buffer_.size() >= FLUSH_BYTES) Flush();
+    }
+
+    /**
+     * @brief 次のステップの入力を Update() の代わりに反映
+     * @return bool 反映できた場合 true(最後まで再生した・ファイルが壊れている場合 false)
+     */
+    bool ReplayStep(InputSystem& input, GamepadSystem& gamepad) {
+        if (mode_ != Mode::Replaying) return false;
+        if (stepsReplayed_ >= stepCount_ || !ReadStep()) {
+            if (stepsReplayed_ < stepCount_) {
+                DEBUGLOG_ERROR("[InputReplay] 再生ファイルが途中で終わっています (ステップ " + std::to_string(stepsReplayed_) + ")");
+            }
+            mode_ = Mode::None;
+            return false;
+        }
+        input.ApplyReplayFrame(prevKeys_);
+        gamepad.ApplyReplayFrame(prevPads_);
+        ++stepsReplayed_;
+        return true;
+    }
+
+    Mode GetMode() const { return mode_; }
+    bool IsRecording() const { return mode_ == Mode::Recording; }
+    bool IsReplaying() const { return mode_ == Mode::Replaying; }
+    uint64_t Seed() const { return seed_; }
+    float FixedTimestep() const { return fixedTimestep_; }
+    uint32_t StepCount() const { return stepCount_; }
+
+private:
+    static constexpr uint8_t FLAG_KEYS = 1u << 0;
+    static constexpr uint8_t FLAG_MOUSE = 1u << 1;
+    static constexpr uint8_t FLAG_PADS = 1u << 2;
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;  ///< 記録をファイルへ書き出すバッファの大きさ
+
+    static bool SamePad(const GamepadSystem::ReplayPad& a, const GamepadSystem::ReplayPad& b) {
+        if (a.connected != b.connected) return false;
+        if (!a.connected) return true;
+        return std::memcmp(a.buttons, b.buttons, sizeof(a.buttons)) == 0 &&
+               a.leftStickX == b.leftStickX && a.leftStickY == b.leftStickY &&
+               a.rightStickX == b.rightStickX && a.rightStickY == b.rightStickY &&
+               a.leftTrigger == b.leftTrigger && a.rightTrigger == b.rightTrigger;
+    }
+
+    void ResetPrevious() {
+        std::memset(&prevKeys_, 0, sizeof(prevKeys_));
+        std::memset(&prevPads_, 0, sizeof(prevPads_));
+    }
+
+    void WriteHeader() {
+        Write(MAGIC);
+        Write(VERSION);
+        Write(seed_);
+        Write(fixedTimestep_);
+        Write(stepCount_);
+    }
+
+    template<class T>
+    void Write(const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Flush() {
+        if (buffer_.empty()) return;
+        file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    template<class T>
+    bool Read(T& value) {
+        if (cursor_ + sizeof(T) > data_.size()) return false;
+        std::memcpy(&value, data_.data() + cursor_, sizeof(T));
+        cursor_ += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief 1ステップ分を読み、prevKeys_ / prevPads_ に反映
+     */
+    bool ReadStep() {
+        uint8_t flags = 0;
+        if (!Read(flags)) return false;
+        if (flags & FLAG_KEYS) {
+            uint16_t count = 0;
+            if (!Read(count)) return false;
+            for (uint16_t i = 0; i < count; ++i) {
+                uint8_t vk = 0, state = 0;
+                if (!Read(vk) || !Read(state)) return false;
+                prevKeys_.keyStates[vk] = state;
+            }
+        }
+        if (flags & FLAG_MOUSE) {
+            int32_t x = 0, y = 0, wheel = 0;
+            if (!Read(x) || !Read(y) || !Read(wheel)) return false;
+            prevKeys_.mouseX = x;
+            prevKeys_.mouseY = y;
+            prevKeys_.mouseWheel = wheel;
+        }
+        if (flags & FLAG_PADS) {
+            for (GamepadSystem::ReplayPad& pad : prevPads_.pads) {
+                uint8_t connected = 0;
+                if (!Read(connected)) return false;
+                pad = GamepadSystem::ReplayPad{};
+                pad.connected = connected != 0;
+                if (!pad.connected) continue;
+                uint32_t buttons = 0;
+                if (!Read(buttons) || !Read(pad.leftStickX) || !Read(pad.leftStickY) || !Read(pad.rightStickX) ||
+                    !Read(pad.rightStickY) || !Read(pad.leftTrigger) || !Read(pad.rightTrigger)) {
+                    return false;
+                }
+                for (int b = 0; b < GamepadSystem::Button_Count; ++b) pad.buttons[b] = static_cast<uint8_t>((buttons >> (b * 2)) & 3u);
+            }
+        }
+        return true;
+    }
+
+    Mode mode_ = Mode::None;
+    uint64_t seed_ = 0;
+    float fixedTimestep_ = 0.0f;
+    uint32_t stepCount_ = 0;                  ///< 記録したステップ数(再生時はファイルのステップ数)
+    uint32_t stepsReplayed_ = 0;              ///< 再生したステップ数
+
+    InputSystem::ReplayFrame prevKeys_{};     ///< 直前のステップの状態(差分の基準)
+    GamepadSystem::ReplayFrame prevPads_{};   ///< 同上
+
+    std::ofstream file_;                      ///< 記録先
+    std::vector<uint8_t> buffer_;             ///< 書き出し前の記録
+    std::vector<uint8_t> data_;               ///< 再生するファイルの内容
+    size_t cursor_ = 0;                       ///< data_ の読み込み位置
+};
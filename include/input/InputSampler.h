@@ -0,0 +1,250 @@
+/**
+ * @file InputSampler.h
+ * @brief キーボード・マウス・XInput を高頻度で受け取る専用スレッド(任意)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 通常、Raw Input はメインスレッドのメッセージ処理(フレームの先頭)でしか届かず、XInput はステップごとに1回読むだけです。
+ * InputSampler を起動すると、専用スレッドがメッセージ専用ウィンドウで Raw Input を受け取り、XInput を
+ * 既定 1000Hz でポーリングして、QueryPerformanceCounter の時刻付きで InputSystem / GamepadSystem の
+ * ロックフリーのキューに書き込みます。
+ *
+ * App は各ステップのシミュレーション時刻を InputSystem::Update(untilTime) / GamepadSystem::Update(untilTime) に渡すため、
+ * 1フレームで複数のステップを進める場合も入力は実際に起きた時刻のステップに入り、最後のステップは
+ * フレームの直前(スワップチェインの待機後)までの入力を使います(カメラやプレイヤーの移動の遅延が減る)。
+ *
+ * Raw Input は RIDEV_INPUTSINK で登録するため、メインウィンドウがフォアグラウンドでない間のイベントは捨て、
+ * フォアグラウンドでなくなったときに押されているキーを解放します。
+ */
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Xinput.h>
+#include "input/InputSystem.h"
+#include "input/GamepadSystem.h"
+#include "app/DebugLog.h"
+#include "app/ThreadPlacement.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#pragma comment(lib, "winmm.lib")
+
+/**
+ * @class InputSampler
+ * @brief 入力を高頻度で受け取りキューに書き込むスレッド
+ *
+ * @par 使用例
+ * @code
+ * InputSampler sampler;
+ * sampler.Start(input, gamepad, hwnd, 1000); // 失敗した場合はメインスレッドでの受け取りのまま
+ * // ...
+ * input.Update(InputSystem::Now());          // ステップの時刻までのイベントを反映
+ * // ...
+ * sampler.Stop();                            // Raw Input をメインウィンドウに登録し直す
+ * @endcode
+ */
+class InputSampler {
+public:
+    static constexpr uint32_t DEFAULT_RATE_HZ = 1000;  ///< 既定のサンプリング周波数
+    static constexpr uint32_t DISCONNECTED_RECHECK_MS = 500; ///< 未接続の XInput スロットを確認する間隔(XInputGetState が重いため)
+
+    InputSampler() = default;
+    InputSampler(const InputSampler&) = delete;
+    InputSampler& operator=(const InputSampler&) = delete;
+
+    ~InputSampler() { Stop(); }
+
+    /**
+     * @brief スレッドを起動し、Raw Input の受け取りを専用スレッドへ移す
+     * @param[in] input イベントの書き込み先
+     * @param[in] gamepad XInput のサンプルの書き込み先
+     * @param[in] mainWindow ゲームのウィンドウ(フォアグラウンドの判定と、停止後の登録先)
+     * @param[in] rateHz XInput のポーリング周波数(Raw Input は届いたらすぐ処理)
+     * @return bool 起動できた場合 true
+     */
+    bool Start(InputSystem& input, GamepadSystem& gamepad, HWND mainWindow, uint32_t rateHz = DEFAULT_RATE_HZ) {
+        if (thread_.joinable()) return true;
+        input_ = &input;
+        gamepad_ = &gamepad;
+        mainWindow_ = mainWindow;
+        periodMs_ = rateHz >= 1000 ? 1 : (rateHz == 0 ? 1 : 1000 / rateHz);
+        stopping_.store(false, std::memory_order_relaxed);
+        started_ = false;
+        startOk_ = false;
+
+        try {
+            thread_ = std::thread([this]() { threadLoop(); });
+        } catch (const std::exception& e) {
+            DEBUGLOG_ERROR(std::string("[InputSampler] スレッドの起動失敗: ") + e.what());
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return started_; });
+        if (!startOk_) {
+            lock.unlock();
+            thread_.join();
+            input_->SetWindowHandle(mainWindow_);
+            return false;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Input, "[InputSampler] 入力スレッドを起動 (" + std::to_string(1000 / periodMs_) + "Hz)");
+        return true;
+    }
+
+    /**
+     * @brief スレッドを終了し、Raw Input をメインウィンドウに登録し直す
+     */
+    void Stop() {
+        if (!thread_.joinable()) return;
+        stopping_.store(true, std::memory_order_release);
+        PostThreadMessageW(threadId_.load(std::memory_order_acquire), WM_QUIT, 0, 0);
+        thread_.join();
+        input_->SetWindowHandle(mainWindow_);
+        DEBUGLOG_CATEGORY(DebugLog::Category::Input, "[InputSampler] 入力スレッドを停止 (XInput サンプル: " + std::to_string(sampleCount_.load()) + ")");
+    }
+
+    bool IsRunning() const { return thread_.joinable(); }
+
+    /**
+     * @brief キューに書き込んだ XInput のサンプル数(状態が変わったときのみ書き込む)
+     */
+    uint64_t SampleCount() const { return sampleCount_.load(std::memory_order_relaxed); }
+
+private:
+    static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp) {
+        if (msg == WM_INPUT) {
+            auto* self = reinterpret_cast<InputSampler*>(GetWindowLongPtrW(hWnd, GWLP_USERDATA));
+            if (self && self->foreground_) {
+                self->input_->OnRawInput(reinterpret_cast<HRAWINPUT>(lp));
+            }
+        }
+        return DefWindowProcW(hWnd, msg, wp, lp);
+    }
+
+    /**
+     * @brief Raw Input を window へ登録(nullptr で登録解除)
+     */
+    static bool registerRawInput(HWND window) {
+        RAWINPUTDEVICE devices[2]{};
+        devices[0].usUsagePage = 0x01;
+        devices[0].usUsage = 0x06;
+        devices[1].usUsagePage = 0x01;
+        devices[1].usUsage = 0x02;
+        for (auto& device : devices) {
+            device.dwFlags = window ? RIDEV_INPUTSINK : RIDEV_REMOVE; // メッセージ専用ウィンドウはフォアグラウンドにならない
+            device.hwndTarget = window;
+        }
+        return RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE)) != FALSE;
+    }
+
+    void signalStarted(bool ok) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            started_ = true;
+            startOk_ = ok;
+        }
+        cv_.notify_all();
+    }
+
+    void threadLoop() {
+        threadId_.store(GetCurrentThreadId(), std::memory_order_release);
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+        ThreadPlacement::GetInstance().ApplyCurrent(ThreadRole::Input);  // 予約したコアがあれば固定
+
+        HINSTANCE instance = GetModuleHandleW(nullptr);
+        WNDCLASSEXW wc{ sizeof(WNDCLASSEXW) };
+        wc.lpfnWndProc = WndProc;
+        wc.hInstance = instance;
+        wc.lpszClassName = L"InputSamplerWindow";
+        if (!RegisterClassExW(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
+            DEBUGLOG_ERROR("[InputSampler] ウィンドウクラスの登録失敗 (エラー: " + std::to_string(GetLastError()) + ")");
+            signalStarted(false);
+            return;
+        }
+        HWND window = CreateWindowExW(0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, instance, nullptr);
+        if (!window) {
+            DEBUGLOG_ERROR("[InputSampler] メッセージ専用ウィンドウの作成失敗 (エラー: " + std::to_string(GetLastError()) + ")");
+            signalStarted(false);
+            return;
+        }
+        SetWindowLongPtrW(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+
+        // 書き込み側をこのスレッドにしてから登録を移す(メインウィンドウへの WM_INPUT は届かなくなる)
+        input_->SetProducerThread(GetCurrentThreadId());
+        if (!registerRawInput(window)) {
+            DEBUGLOG_ERROR("[InputSampler] Raw Input の登録失敗 (エラー: " + std::to_string(GetLastError()) + ")");
+            input_->SetProducerThread(0);
+            DestroyWindow(window);
+            signalStarted(false);
+            return;
+        }
+        gamepad_->SetSampled(true);
+        timeBeginPeriod(1);
+        signalStarted(true);
+
+        XINPUT_STATE last[XUSER_MAX_COUNT] = {};
+        bool connected[XUSER_MAX_COUNT] = {};
+        DWORD lastRecheck = 0;
+        foreground_ = GetForegroundWindow() == mainWindow_;
+
+        while (!stopping_.load(std::memory_order_acquire)) {
+            MsgWaitForMultipleObjectsEx(0, nullptr, periodMs_, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+            // フォアグラウンドでなくなったら押されているキーを解放
+            const bool foreground = GetForegroundWindow() == mainWindow_;
+            if (foreground_ && !foreground) input_->OnFocusLost();
+            foreground_ = foreground;
+
+            MSG msg;
+            while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                if (msg.message == WM_QUIT) {
+                    stopping_.store(true, std::memory_order_release);
+                    break;
+                }
+                DispatchMessageW(&msg);
+            }
+
+            // XInput(状態が変わったときだけ書き込む。未接続のスロットはたまに確認)
+            const DWORD nowMs = GetTickCount();
+            const bool recheck = nowMs - lastRecheck >= DISCONNECTED_RECHECK_MS;
+            if (recheck) lastRecheck = nowMs;
+            const int64_t now = InputSystem::Now();
+            for (DWORD slot = 0; slot < XUSER_MAX_COUNT; ++slot) {
+                if (!connected[slot] && !recheck) continue;
+                XINPUT_STATE state{};
+                connected[slot] = XInputGetState(slot, &state) == ERROR_SUCCESS;
+                if (!connected[slot] || state.dwPacketNumber == last[slot].dwPacketNumber) continue;
+                last[slot] = state;
+                gamepad_->PushXInputSample(slot, state.Gamepad, now);
+                sampleCount_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        timeEndPeriod(1);
+        gamepad_->SetSampled(false);
+        registerRawInput(nullptr);
+        input_->SetProducerThread(0);
+        DestroyWindow(window);
+    }
+
+    InputSystem* input_ = nullptr;
+    GamepadSystem* gamepad_ = nullptr;
+    HWND mainWindow_ = nullptr;
+    DWORD periodMs_ = 1;                        ///< ポーリング間隔(ミリ秒)
+    std::thread thread_;
+    std::atomic<DWORD> threadId_{ 0 };
+    std::atomic<bool> stopping_{ false };
+    std::atomic<uint64_t> sampleCount_{ 0 };
+    bool foreground_ = false;                   ///< メインウィンドウがフォアグラウンドか(スレッド内のみ)
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool started_ = false;                      ///< スレッドの初期化が終わったか
+    bool startOk_ = false;                      ///< 初期化に成功したか
+};
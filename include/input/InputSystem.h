@@ -3,15 +3,17 @@
 #define NOMINMAX
 #include <Windows.h>
 #include "app/DebugLog.h"
+#include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 /**
  * @file InputSystem.h
  * @brief キーボード・マウス入力管理システム
  * @author 山内陽
  * @date 2025
- * @version 5.0
+ * @version 5.2
  * 
  * @details
  * このファイルはキーボードとマウスの入力を管理するシステムを提供します。
@@ -24,6 +26,19 @@
  * @details
  * Windows APIを使用してキーボードとマウスの入力状態を管理します。
  * ゲームループ内で毎フレームUpdate()を呼び出すことで、入力状態が更新されます。
+ *
+ * ### Raw Input:
+ * SetWindowHandle() でキーボードとマウスを Raw Input に登録し、ウィンドウプロシージャが WM_INPUT を
+ * OnRawInput() に渡すと、キー・マウスボタンの押下/解放を時刻付きでイベントのリングバッファに記録します。
+ * Update() はリングを読んだ順にキー状態へ反映するため、256キー分の GetAsyncKeyState は呼びません。
+ * 2回の Update() の間に押して離したキーも、押した瞬間(Down)と離した瞬間(Up)を1回ずつ検出します。
+ * カーソル位置は WM_MOUSEMOVE(OnMouseMove())から受け取ります。
+ * 登録に失敗した場合は従来どおり毎回すべてのキーをポーリングします。
+ *
+ * リングはウィンドウプロシージャ(メインスレッド)が書き、Update()(シミュレーションスレッドの場合もある)が読む
+ * 単一生産者・単一消費者のキューです。InputSampler を使う場合は書き込み側がその専用スレッドに替わります
+ * (SetProducerThread())。イベントの時刻は QueryPerformanceCounter の値で、Update(untilTime) はその時刻までの
+ * イベントだけを反映します(後のイベントは次の Update() に残す)。
  * 
  * @par 使用例
  * @code
@@ -64,6 +79,29 @@ public:
         Middle = 2     ///< 中ボタン
     };
 
+    /**
+     * @struct InputEvent
+     * @brief キー・マウスボタンの押下/解放1回分
+     */
+    struct InputEvent {
+        int64_t time;    ///< 受け取った時刻(QueryPerformanceCounter の値)
+        uint8_t vkCode;  ///< 仮想キーコード(マウスボタンは VK_LBUTTON など)
+        bool down;       ///< true: 押下, false: 解放
+    };
+
+    static constexpr uint32_t EVENT_RING_SIZE = 256; ///< イベントのリングバッファの容量(2の累乗)
+
+    /**
+     * @struct ReplayFrame
+     * @brief 1ステップ分の入力状態(InputReplay の記録・再生用)
+     */
+    struct ReplayFrame {
+        uint8_t keyStates[256];  ///< KeyState
+        int mouseX;              ///< カーソルX
+        int mouseY;              ///< カーソルY
+        int mouseWheel;          ///< ホイールの回転量
+    };
+
     /**
      * @brief 初期化
      * 
@@ -79,8 +117,17 @@ public:
         mouseX_ = mouseY_ = 0;
         mouseDeltaX_ = mouseDeltaY_ = 0;
         mouseWheel_ = 0;
-        mouseWheelAccum_ = 0;
-        hwnd_ = nullptr;
+        mouseWheelAccum_.store(0, std::memory_order_relaxed);
+        memset(held_, 0, sizeof(held_));
+        memset(sentDown_, 0, sizeof(sentDown_));
+        eventWrite_.store(0, std::memory_order_relaxed);
+        eventRead_.store(0, std::memory_order_relaxed);
+        eventsDropped_.store(0, std::memory_order_relaxed);
+        stepEvents_.clear();
+        stepEvents_.reserve(EVENT_RING_SIZE);
+        if (!hwnd_) {
+            rawInput_ = false;
+        }
 #ifdef _DEBUG
         DEBUGLOG_CATEGORY(DebugLog::Category::Input, "InputSystem::Init() - 初期化完了");
 #endif
@@ -99,6 +146,23 @@ public:
             mouseX_ = 0;
             mouseY_ = 0;
         }
+        cursorPos_.store(PackCursor(mouseX_, mouseY_), std::memory_order_relaxed);
+
+        // キーボード(Generic Desktop / Keyboard)とマウス(Generic Desktop / Mouse)を登録
+        // RIDEV_NOLEGACY は付けない(WM_CHAR・WM_MOUSEMOVE・WM_MOUSEWHEEL も従来どおり届く)
+        RAWINPUTDEVICE devices[2]{};
+        devices[0].usUsagePage = 0x01;
+        devices[0].usUsage = 0x06;
+        devices[0].hwndTarget = hwnd_;
+        devices[1].usUsagePage = 0x01;
+        devices[1].usUsage = 0x02;
+        devices[1].hwndTarget = hwnd_;
+        rawInput_ = RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE)) != FALSE;
+        if (!rawInput_) {
+            DEBUGLOG_WARNING("[InputSystem] Raw Input の登録に失敗 (エラー: " + std::to_string(GetLastError()) + ") - キーをポーリングします");
+        } else {
+            DEBUGLOG_CATEGORY(DebugLog::Category::Input, "[InputSystem] Raw Input を登録");
+        }
     }
 
 
@@ -109,6 +173,17 @@ public:
      * 入力システムをシャットダウンします。
      */
     void Shutdown() {
+        if (rawInput_) {
+            RAWINPUTDEVICE devices[2]{};
+            devices[0].usUsagePage = 0x01;
+            devices[0].usUsage = 0x06;
+            devices[0].dwFlags = RIDEV_REMOVE;
+            devices[1].usUsagePage = 0x01;
+            devices[1].usUsage = 0x02;
+            devices[1].dwFlags = RIDEV_REMOVE;
+            RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE));
+            rawInput_ = false;
+        }
         hwnd_ = nullptr;
 #ifdef _DEBUG
         DEBUGLOG_CATEGORY(DebugLog::Category::Input, "InputSystem::Shutdown() - シャットダウン中");
@@ -120,45 +195,234 @@ public:
 
     /**
      * @brief 入力状態の更新(毎フレーム呼ぶ)
+     * @param[in] untilTime この時刻(QueryPerformanceCounter の値)までのイベントを反映(既定はすべて)
      * 
      * @details
      * 前フレームの状態を保存し、現在の入力状態を取得します。
      * キーの押下・離された瞬間の判定はこの更新処理によって行われます。
+     * Raw Input が有効な場合は前回からのイベントを順に反映し、GetEvents() で参照できるようにします。
+     * 固定ステップを複数回進めるフレームでは、各ステップのシミュレーション時刻を渡すと
+     * 入力がその時刻に起きたステップへ振り分けられます。
      */
-    void Update() {
+    void Update(int64_t untilTime = INT64_MAX) {
         memcpy(prevKeyStates_, keyStates_, sizeof(keyStates_));
-        
+
+        if (!rawInput_) {
+            pollKeys();
+            pollCursor();
+            mouseWheel_ = mouseWheelAccum_.exchange(0, std::memory_order_relaxed);
+            return;
+        }
+
+        // 前回からのイベントを届いた順に反映(押して離したキーも押下として数える)
+        uint8_t pressed[256] = {};
+        stepEvents_.clear();
+        const uint32_t write = eventWrite_.load(std::memory_order_acquire);
+        uint32_t read = eventRead_.load(std::memory_order_relaxed);
+        for (; read != write; ++read) {
+            const InputEvent& e = events_[read & (EVENT_RING_SIZE - 1)];
+            if (e.time > untilTime) break; // 次のステップの分
+            stepEvents_.push_back(e);
+            if (e.down) {
+                if (!held_[e.vkCode]) pressed[e.vkCode] = 1;
+                held_[e.vkCode] = 1;
+            } else {
+                held_[e.vkCode] = 0;
+            }
+        }
+        eventRead_.store(read, std::memory_order_release);
+
+        // 左右を区別しない修飾キー(GetAsyncKeyState と同じく、どちらかが押されていれば押下)
+        static constexpr int kGeneric[3][3] = {
+            { VK_SHIFT, VK_LSHIFT, VK_RSHIFT },
+            { VK_CONTROL, VK_LCONTROL, VK_RCONTROL },
+            { VK_MENU, VK_LMENU, VK_RMENU },
+        };
+        for (const auto& keys : kGeneric) {
+            const bool wasHeld = held_[keys[0]] != 0;
+            held_[keys[0]] = held_[keys[1]] | held_[keys[2]];
+            if (!wasHeld && (pressed[keys[1]] || pressed[keys[2]])) pressed[keys[0]] = 1;
+        }
+
         for (int i = 0; i < 256; ++i) {
-            bool isDown = (GetAsyncKeyState(i) & 0x8000) != 0;
+            bool isDown = held_[i] || pressed[i];
             KeyState prevState = static_cast<KeyState>(prevKeyStates_[i]);
             bool wasDown = (prevState == KeyState::Down || prevState == KeyState::Pressed);
 
             if (isDown) {
-                keyStates_[i] = static_cast<uint8_t>(wasDown ? KeyState::Pressed : KeyState::Down);
+                keyStates_[i] = static_cast<uint8_t>(wasDown && !pressed[i] ? KeyState::Pressed : KeyState::Down);
             } else {
                 keyStates_[i] = static_cast<uint8_t>(wasDown ? KeyState::Up : KeyState::None);
             }
         }
-        
-        POINT pt;
-        if (GetCursorPos(&pt)) {
-            POINT clientPt = pt;
-            if (hwnd_ && ScreenToClient(hwnd_, &clientPt)) {
-                pt = clientPt;
+
+        const uint64_t cursor = cursorPos_.load(std::memory_order_relaxed);
+        const int newX = static_cast<int32_t>(static_cast<uint32_t>(cursor));
+        const int newY = static_cast<int32_t>(static_cast<uint32_t>(cursor >> 32));
+        mouseDeltaX_ = newX - mouseX_;
+        mouseDeltaY_ = newY - mouseY_;
+        mouseX_ = newX;
+        mouseY_ = newY;
+
+        mouseWheel_ = mouseWheelAccum_.exchange(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief WM_INPUT を処理(ウィンドウプロシージャから呼ぶ)
+     * @param[in] input WM_INPUT の lParam
+     *
+     * @details
+     * キーボードの押下/解放とマウスボタンの押下/解放をイベントとして記録します。
+     * 左右の Shift / Ctrl / Alt は VK_LSHIFT などに分けて記録し、VK_SHIFT などは Update() で合成します。
+     * 呼び出し後は DefWindowProc に渡してください。
+     * SetProducerThread() で別のスレッドを指定している間、他のスレッドからの呼び出しは無視します。
+     */
+    void OnRawInput(HRAWINPUT input) {
+        if (!isProducerThread()) return;
+        RAWINPUT raw;
+        UINT size = sizeof(raw);
+        if (GetRawInputData(input, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1)) {
+            return;
+        }
+        const int64_t time = Now();
+
+        if (raw.header.dwType == RIM_TYPEKEYBOARD) {
+            const RAWKEYBOARD& kb = raw.data.keyboard;
+            UINT vk = kb.VKey;
+            if (vk == 0 || vk >= 255) return; // 0xFF は拡張キーの前置き(E0/E1)だけのイベント
+            const bool e0 = (kb.Flags & RI_KEY_E0) != 0;
+            switch (vk) {
+                case VK_SHIFT:   vk = MapVirtualKeyW(kb.MakeCode, MAPVK_VSC_TO_VK_EX); break;
+                case VK_CONTROL: vk = e0 ? VK_RCONTROL : VK_LCONTROL; break;
+                case VK_MENU:    vk = e0 ? VK_RMENU : VK_LMENU; break;
             }
+            pushEvent(time, vk, (kb.Flags & RI_KEY_BREAK) == 0);
+        } else if (raw.header.dwType == RIM_TYPEMOUSE) {
+            const USHORT flags = raw.data.mouse.usButtonFlags;
+            if (flags & RI_MOUSE_LEFT_BUTTON_DOWN)   pushEvent(time, VK_LBUTTON, true);
+            if (flags & RI_MOUSE_LEFT_BUTTON_UP)     pushEvent(time, VK_LBUTTON, false);
+            if (flags & RI_MOUSE_RIGHT_BUTTON_DOWN)  pushEvent(time, VK_RBUTTON, true);
+            if (flags & RI_MOUSE_RIGHT_BUTTON_UP)    pushEvent(time, VK_RBUTTON, false);
+            if (flags & RI_MOUSE_MIDDLE_BUTTON_DOWN) pushEvent(time, VK_MBUTTON, true);
+            if (flags & RI_MOUSE_MIDDLE_BUTTON_UP)   pushEvent(time, VK_MBUTTON, false);
+            if (flags & RI_MOUSE_BUTTON_4_DOWN)      pushEvent(time, VK_XBUTTON1, true);
+            if (flags & RI_MOUSE_BUTTON_4_UP)        pushEvent(time, VK_XBUTTON1, false);
+            if (flags & RI_MOUSE_BUTTON_5_DOWN)      pushEvent(time, VK_XBUTTON2, true);
+            if (flags & RI_MOUSE_BUTTON_5_UP)        pushEvent(time, VK_XBUTTON2, false);
+        }
+    }
 
-            int newX = pt.x;
-            int newY = pt.y;
-            mouseDeltaX_ = newX - mouseX_;
-            mouseDeltaY_ = newY - mouseY_;
-            mouseX_ = newX;
-            mouseY_ = newY;
+    /**
+     * @brief カーソル位置の更新(WM_MOUSEMOVE から呼ぶ)
+     * @param[in] x クライアント座標のX
+     * @param[in] y クライアント座標のY
+     */
+    void OnMouseMove(int x, int y) {
+        cursorPos_.store(PackCursor(x, y), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief フォーカスを失った(WM_KILLFOCUS から呼ぶ)
+     *
+     * @details
+     * フォーカスがない間の解放は WM_INPUT で届かないため、押されているキーをすべて解放として記録します。
+     */
+    void OnFocusLost() {
+        if (!rawInput_ || !isProducerThread()) return;
+        const int64_t time = Now();
+        for (int i = 1; i < 256; ++i) {
+            if (sentDown_[i]) pushEvent(time, static_cast<UINT>(i), false);
         }
-        
-        mouseWheel_ = mouseWheelAccum_;
-        mouseWheelAccum_ = 0;
     }
 
+    /**
+     * @brief 直前の Update() で反映したイベント(届いた順)
+     * @param[out] count イベント数
+     * @return const InputEvent* 先頭(Raw Input が無効な場合は常に0件)
+     *
+     * @details
+     * 同じ Update() の間に複数のキーを押した場合の順序や時刻が必要な処理(コマンド入力など)に使います。
+     */
+    const InputEvent* GetEvents(size_t& count) const {
+        count = stepEvents_.size();
+        return stepEvents_.data();
+    }
+
+    /**
+     * @brief 直前の Update() の結果を取り出す(入力の記録用)
+     */
+    void CaptureReplayFrame(ReplayFrame& out) const {
+        memcpy(out.keyStates, keyStates_, sizeof(keyStates_));
+        out.mouseX = mouseX_;
+        out.mouseY = mouseY_;
+        out.mouseWheel = mouseWheel_;
+    }
+
+    /**
+     * @brief 記録した状態を Update() の代わりに反映(入力の再生用)
+     *
+     * @details
+     * 実際のキー・マウスのイベントは読み捨てます(再生中の操作はシミュレーションに入らない)。
+     * GetEvents() は0件になります。
+     */
+    void ApplyReplayFrame(const ReplayFrame& frame) {
+        memcpy(prevKeyStates_, keyStates_, sizeof(keyStates_));
+        memcpy(keyStates_, frame.keyStates, sizeof(keyStates_));
+        mouseDeltaX_ = frame.mouseX - mouseX_;
+        mouseDeltaY_ = frame.mouseY - mouseY_;
+        mouseX_ = frame.mouseX;
+        mouseY_ = frame.mouseY;
+        mouseWheel_ = frame.mouseWheel;
+        stepEvents_.clear();
+        eventRead_.store(eventWrite_.load(std::memory_order_acquire), std::memory_order_release);
+        mouseWheelAccum_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Raw Input でイベントを受け取っているか(false の場合はポーリング)
+     */
+    bool IsRawInputActive() const { return rawInput_; }
+
+    /**
+     * @brief イベントを書き込むスレッドを指定(InputSampler 用)
+     * @param[in] threadId OnRawInput() / OnFocusLost() を受け付けるスレッド(0 でウィンドウのスレッドに戻す)
+     *
+     * @details
+     * 指定したスレッドは Raw Input を自分のウィンドウで受け取り、OnRawInput() を呼びます。
+     * リングの書き込み側は常に1スレッドになるよう、他のスレッドからの呼び出しは無視されます。
+     * 0 に戻した後は SetWindowHandle() で Raw Input をウィンドウに登録し直してください。
+     */
+    void SetProducerThread(DWORD threadId) {
+        producerThread_.store(threadId, std::memory_order_release);
+        if (threadId != 0) rawInput_ = true;
+    }
+
+    /**
+     * @brief イベントの時刻の基準(QueryPerformanceCounter の値)
+     */
+    static int64_t Now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    /**
+     * @brief Now() の1秒あたりのカウント
+     */
+    static int64_t Frequency() {
+        static const int64_t frequency = []() {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            return f.QuadPart;
+        }();
+        return frequency;
+    }
+
+    /**
+     * @brief リングバッファが一杯で捨てたイベント数
+     */
+    uint32_t GetDroppedEventCount() const { return eventsDropped_.load(std::memory_order_relaxed); }
+
     /**
      * @brief キーが押されているか
      * @param[in] vkCode 仮想キーコード
@@ -325,12 +589,75 @@ public:
      * 
      * @details
      * ウィンドウプロシージャからホイールイベントを受け取るために使用します。
+     * Update() をシミュレーションスレッドで呼ぶ場合もあるため、累積値はアトミックに扱います。
      */
     void OnMouseWheel(int delta) {
-        mouseWheelAccum_ += delta / WHEEL_DELTA;
+        mouseWheelAccum_.fetch_add(delta / WHEEL_DELTA, std::memory_order_relaxed);
     }
 
 private:
+    static uint64_t PackCursor(int x, int y) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(x)) | (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32);
+    }
+
+    /**
+     * @brief イベントをリングに追加(メインスレッドのみ、一杯の場合は捨てる)
+     */
+    bool isProducerThread() const {
+        const DWORD producer = producerThread_.load(std::memory_order_acquire);
+        return producer == 0 || producer == GetCurrentThreadId();
+    }
+
+    void pushEvent(int64_t time, UINT vk, bool down) {
+        if (vk == 0 || vk > 255) return;
+        if (sentDown_[vk] == static_cast<uint8_t>(down)) return; // キーリピート・重複した解放
+        const uint32_t write = eventWrite_.load(std::memory_order_relaxed);
+        if (write - eventRead_.load(std::memory_order_acquire) >= EVENT_RING_SIZE) {
+            eventsDropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        sentDown_[vk] = static_cast<uint8_t>(down);
+        events_[write & (EVENT_RING_SIZE - 1)] = InputEvent{ time, static_cast<uint8_t>(vk), down };
+        eventWrite_.store(write + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief すべての仮想キーを GetAsyncKeyState で取得(Raw Input を使えない場合)
+     */
+    void pollKeys() {
+        for (int i = 0; i < 256; ++i) {
+            bool isDown = (GetAsyncKeyState(i) & 0x8000) != 0;
+            KeyState prevState = static_cast<KeyState>(prevKeyStates_[i]);
+            bool wasDown = (prevState == KeyState::Down || prevState == KeyState::Pressed);
+
+            if (isDown) {
+                keyStates_[i] = static_cast<uint8_t>(wasDown ? KeyState::Pressed : KeyState::Down);
+            } else {
+                keyStates_[i] = static_cast<uint8_t>(wasDown ? KeyState::Up : KeyState::None);
+            }
+        }
+    }
+
+    /**
+     * @brief カーソル位置を GetCursorPos で取得(Raw Input を使えない場合)
+     */
+    void pollCursor() {
+        POINT pt;
+        if (GetCursorPos(&pt)) {
+            POINT clientPt = pt;
+            if (hwnd_ && ScreenToClient(hwnd_, &clientPt)) {
+                pt = clientPt;
+            }
+
+            int newX = pt.x;
+            int newY = pt.y;
+            mouseDeltaX_ = newX - mouseX_;
+            mouseDeltaY_ = newY - mouseY_;
+            mouseX_ = newX;
+            mouseY_ = newY;
+        }
+    }
+
     HWND hwnd_ = nullptr;            ///< Tracking window handle for client-space coordinates
     uint8_t keyStates_[256];        ///< 現在のキー状態
     uint8_t prevKeyStates_[256];    ///< 前フレームのキー状態
@@ -340,7 +667,18 @@ private:
     int mouseDeltaX_;   ///< マウスX移動量
     int mouseDeltaY_;   ///< マウスY移動量
     int mouseWheel_;    ///< マウスホイール回転量
-    int mouseWheelAccum_;  ///< マウスホイール累積値
+    std::atomic<int> mouseWheelAccum_{ 0 };  ///< マウスホイール累積値(ウィンドウプロシージャから加算)
+
+    bool rawInput_ = false;                          ///< Raw Input を登録済みか
+    InputEvent events_[EVENT_RING_SIZE];             ///< イベントのリングバッファ
+    std::atomic<uint32_t> eventWrite_{ 0 };          ///< 書き込み位置(ウィンドウプロシージャ)
+    std::atomic<uint32_t> eventRead_{ 0 };           ///< 読み込み位置(Update())
+    std::atomic<uint32_t> eventsDropped_{ 0 };       ///< 捨てたイベント数
+    std::atomic<uint64_t> cursorPos_{ 0 };           ///< WM_MOUSEMOVE のカーソル位置(下位32ビット: X, 上位: Y)
+    std::atomic<DWORD> producerThread_{ 0 };         ///< イベントを書き込むスレッド(0: ウィンドウのスレッド)
+    uint8_t sentDown_[256] = {};                     ///< 最後に記録した押下状態(ウィンドウプロシージャ側)
+    uint8_t held_[256] = {};                         ///< イベントを反映した押下状態(Update() 側)
+    std::vector<InputEvent> stepEvents_;             ///< 直前の Update() で反映したイベント
 };
 
 /**
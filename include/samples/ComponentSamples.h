@@ -160,9 +160,9 @@ DEFINE_DATA_COMPONENT(Name,
  * @details エンティティの種類を識別するためのマーカーです。
  * データは持たず、エンティティが特定の種類であることを示すために使用します。
  */
-struct PlayerTag : IComponent {};  ///< プレイヤータグ
-struct EnemyTag : IComponent {};   ///< 敵タグ
-struct BulletTag : IComponent {};  ///< 弾丸タグ
+struct PlayerTag : ITag {};  ///< プレイヤータグ
+struct EnemyTag : ITag {};   ///< 敵タグ
+struct BulletTag : ITag {};  ///< 弾丸タグ
 
 // ========================================================
 // サンプル集2: シンプルなBehaviour
@@ -461,25 +461,22 @@ private:
  * @details
  * 指定した時間が経過したらエンティティを自動削除します。
  * 一時的なエフェクトや弾丸などに使用します。
+ * 残り時間を毎フレーム減らす代わりに、OnStart で World::DestroyEntityAfter() に破棄を予約します
+ * (満了まで何もせず、破棄はフレーム終端でまとめて行われます)。
  *
  * @author 山内陽
  */
 struct LifeTime : Behaviour {
-    float remainingTime = 5.0f; ///< 残り寿命(秒)
+    float remainingTime = 5.0f; ///< 寿命(秒、OnStart の時点の値で予約する)
+    TimerHandle timer;          ///< 予約した破棄(Timers().Remaining() で残り時間を取得できる)
 
     /**
-     * @brief 毎フレーム更新処理
+     * @brief 開始時に破棄を予約
      * @param[in,out] w ワールド参照
      * @param[in] self このコンポーネントが付いているエンティティ
-     * @param[in] dt デルタタイム(前フレームからの経過時間)
      */
-    void OnUpdate(World& w, Entity self, float dt) override {
-        remainingTime -= dt;
-
-        // 寿命が尽きたら削除（原因付き）
-        if (remainingTime <= 0.0f) {
-            w.DestroyEntityWithCause(self, World::Cause::LifetimeExpired);
-        }
+    void OnStart(World& w, Entity self) override {
+        timer = w.DestroyEntityAfter(self, remainingTime, World::Cause::LifetimeExpired);
     }
 };
 
@@ -0,0 +1,433 @@
+#pragma once
+#include "ecs/World.h"
+#include "components/Transform.h"
+#include "scenes/SceneStream.h"
+#include "app/JobSystem.h"
+#include "app/DebugLog.h"
+#include "app/Profiler.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @file CellStreamer.h
+ * @brief グリッドのセルに分けたレベルの、注視点の周りだけを読み込むストリーミング
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * レベルを XZ 平面の正方形のセルに分け、セルごとに World::Serialize() と同じ形式のファイルにしておきます
+ * (Bake() で1つの World から書き出せます)。ディレクトリには次のファイルが並びます。
+ * - `cells.txt`: セルの大きさと、セルの座標ごとのエンティティ数(マニフェスト)
+ * - `cell_<x>_<z>.hews`: セルのスナップショット
+ *
+ * Update() はプレイヤーやカメラの位置(注視点)からの距離で、次のように読み込みと破棄を決めます。
+ * - loadRadius 以内に入ったセルを SceneStream で読み込む(展開はワーカー、生成はメインスレッドで時間の予算内)
+ * - unloadRadius より遠くなったセルのエンティティを破棄する(1フレームの破棄数に上限)
+ *
+ * 読み込む距離と破棄する距離を分けてあるため、境界の近くを行き来してもセルの読み込みと破棄を繰り返しません。
+ * 同時に読み込むセル数と、常駐するエンティティ数の上限(マニフェストの数で見積もる)があるため、
+ * レベル全体の大きさに関わらず、メモリとフレームあたりの生成・破棄の量は一定の範囲に収まります。
+ */
+
+/**
+ * @struct CellStreamerConfig
+ * @brief セルの読み込みと破棄の距離・予算
+ */
+struct CellStreamerConfig {
+    float loadRadius = 96.0f;                           ///< 注視点からこの距離以内のセルを読み込む
+    float unloadRadius = 128.0f;                        ///< この距離より遠いセルを破棄する(loadRadius 以上)
+    int maxConcurrentLoads = 2;                         ///< 同時に読み込むセル数
+    size_t maxEntities = 0;                             ///< 常駐するエンティティ数の上限(0 なら無制限)
+    double budgetMs = SceneStream::DEFAULT_BUDGET_MS;   ///< 1フレームでエンティティの生成に使う時間の目安
+    size_t destroyPerFrame = 512;                       ///< 1フレームで破棄するエンティティ数の上限
+};
+
+/**
+ * @struct CellStreamerStats
+ * @brief セルの状態の集計(CellStreamer::GetStats())
+ */
+struct CellStreamerStats {
+    size_t cells = 0;               ///< マニフェストのセル数
+    size_t loaded = 0;              ///< 読み込み済みのセル数
+    size_t loading = 0;             ///< 読み込み中のセル数
+    size_t unloading = 0;           ///< 破棄中のセル数
+    size_t residentEntities = 0;    ///< 読み込み済み・読み込み中・破棄中のセルのエンティティ数(マニフェストの値)
+    size_t loadsStarted = 0;        ///< 開始した読み込みの累計
+    size_t unloadsStarted = 0;      ///< 開始した破棄の累計
+    size_t deferredLoads = 0;       ///< エンティティ数の上限で見送った読み込みの累計
+};
+
+/**
+ * @class CellStreamer
+ * @brief セルに分けたレベルの読み込みと破棄
+ *
+ * @details
+ * 型は本来の World に RegisterSnapshotType() で登録したものだけが読み込まれます(SceneStream と同じ)。
+ * エンティティはセルのものとして記録され、読み込み後にセルの外へ動いても、破棄はセルの単位で行います。
+ * ゲーム側で破棄したエンティティは破棄の時に読み飛ばします。
+ *
+ * @par 使用例
+ * @code
+ * // レベルを 64m のセルに分けて書き出す(エディタ・ツール側。level のエンティティはセルへ移る)
+ * CellStreamer::Bake(level, "assets/levels/forest", 64.0f);
+ *
+ * // ゲーム側(Tick の外で毎フレーム)
+ * CellStreamer cells;
+ * cells.Open("assets/levels/forest");
+ * cells.Update(world, playerPosition, &jobs);
+ * @endcode
+ */
+class CellStreamer {
+public:
+    static constexpr const char* MANIFEST = "cells.txt";
+
+    CellStreamer() = default;
+    CellStreamer(const CellStreamer&) = delete;
+    CellStreamer& operator=(const CellStreamer&) = delete;
+
+    /**
+     * @brief セルのファイルのパス
+     */
+    static std::string CellPath(const std::string& directory, int x, int z) {
+        return directory + "/cell_" + std::to_string(x) + "_" + std::to_string(z) + ".hews";
+    }
+
+    /**
+     * @brief source のエンティティを Transform の位置でセルに分け、セルのファイルとマニフェストを書き出す
+     * @param[in,out] source 分割するレベル(セルへ移したコンポーネントはムーブされる)
+     * @param[in] directory 出力先(なければ作成)
+     * @param[in] cellSize セルの一辺
+     * @param[in] options 圧縮の有無など
+     * @return size_t 書き出したセル数(失敗した場合 0)
+     *
+     * @details
+     * Transform を持たないエンティティは書き出しません。位置はワールド座標として扱うため、
+     * 親子関係のあるエンティティは分割の前にワールド座標へ直してください。
+     * World::SetParent() の親子関係は同じセルに入ったエンティティどうしのものだけ書き出します。
+     */
+    static size_t Bake(World& source, const std::string& directory, float cellSize,
+                       const SnapshotOptions& options = SnapshotOptions()) {
+        if (cellSize <= 0.0f) return 0;
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        // セルの座標順に並べる(マニフェストとファイル名を毎回同じにする)
+        std::map<std::pair<int, int>, std::vector<Entity>> cells;
+        source.ForEach<Transform>([&cells, cellSize](Entity e, Transform& t) {
+            cells[{ CellCoord(t.position.x, cellSize), CellCoord(t.position.z, cellSize) }].push_back(e);
+        });
+
+        std::ofstream manifest(directory + "/" + MANIFEST);
+        if (!manifest) {
+            DEBUGLOG_ERROR("CellStreamer::Bake() - " + directory + "/" + MANIFEST + " を開けません");
+            return 0;
+        }
+        manifest << "cellSize " << cellSize << "\n";
+
+        size_t written = 0;
+        std::vector<uint8_t> bytes;
+        for (auto& cell : cells) {
+            World staging;
+            staging.CopySnapshotTypes(source);
+            std::vector<Entity> created;
+            created.reserve(cell.second.size());
+            staging.TransferEntities(source, cell.second.data(), cell.second.size(), created, World::Cause::SceneInit);
+
+            const std::string path = CellPath(directory, cell.first.first, cell.first.second);
+            if (!staging.Serialize(bytes, options) || !WriteSnapshotFile(path, bytes)) {
+                DEBUGLOG_ERROR("CellStreamer::Bake() - セルを書き出せません: " + path);
+                continue;
+            }
+            manifest << cell.first.first << " " << cell.first.second << " " << cell.second.size() << "\n";
+            written++;
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "セルを書き出しました: " + directory + " (" + std::to_string(written) + " セル)");
+        return written;
+    }
+
+    /**
+     * @brief セルのディレクトリのマニフェストを読む(読み込み済みのセルは破棄しないため、先に Close() する)
+     * @return bool 読めた場合 true
+     */
+    bool Open(const std::string& directory) {
+        cells_.clear();
+        index_.clear();
+        active_.clear();
+        directory_.clear();
+        cellSize_ = 0.0f;
+
+        std::ifstream in(directory + "/" + MANIFEST);
+        std::string key;
+        float cellSize = 0.0f;
+        if (!in || !(in >> key >> cellSize) || key != "cellSize" || cellSize <= 0.0f) {
+            DEBUGLOG_ERROR("CellStreamer::Open() - マニフェストを読めません: " + directory);
+            return false;
+        }
+        Cell cell;
+        while (in >> cell.x >> cell.z >> cell.entityCount) {
+            index_[Key(cell.x, cell.z)] = cells_.size();
+            cells_.push_back(Cell{ cell.x, cell.z, cell.entityCount });
+        }
+        directory_ = directory;
+        cellSize_ = cellSize;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "セルのストリーミングを開始: " + directory + " (" + std::to_string(cells_.size()) + " セル)");
+        return true;
+    }
+
+    /**
+     * @brief 読み込みを中止し、すべてのセルのエンティティを破棄する(予算に関係なくこの呼び出しで予約する)
+     */
+    void Close(World& world) {
+        for (size_t i : active_) {
+            Cell& cell = cells_[i];
+            if (cell.stream) {
+                cell.stream->Cancel();
+                cell.entities = cell.stream->GetEntities();
+                cell.stream.reset();
+            }
+            for (size_t k = cell.destroyCursor; k < cell.entities.size(); ++k) {
+                if (world.IsAlive(cell.entities[k])) {
+                    world.DestroyEntityWithCause(cell.entities[k], World::Cause::SceneUnload);
+                }
+            }
+            cell.entities.clear();
+            cell.entities.shrink_to_fit();
+            cell.destroyCursor = 0;
+            cell.state = CellState::Unloaded;
+        }
+        active_.clear();
+        cells_.clear();
+        index_.clear();
+        directory_.clear();
+        cellSize_ = 0.0f;
+    }
+
+    void SetConfig(const CellStreamerConfig& config) {
+        config_ = config;
+        config_.unloadRadius = (std::max)(config_.unloadRadius, config_.loadRadius);
+        config_.maxConcurrentLoads = (std::max)(config_.maxConcurrentLoads, 1);
+        config_.destroyPerFrame = (std::max)(config_.destroyPerFrame, static_cast<size_t>(1));
+    }
+    const CellStreamerConfig& GetConfig() const { return config_; }
+
+    /**
+     * @brief 注視点に合わせてセルの読み込み・生成・破棄を進める(メインスレッド、Tick の外で呼ぶ)
+     * @param[in] world 生成先
+     * @param[in] focus 注視点(プレイヤー・カメラの位置。Y は使わない)
+     * @param[in] jobs セルのファイルを展開するワーカー(nullptr の場合はこの呼び出しの中で読み込む)
+     */
+    void Update(World& world, const DirectX::XMFLOAT3& focus, JobSystem* jobs) {
+        if (cells_.empty()) return;
+        PROFILE_SCOPE("CellStreamer::Update");
+
+        // 遠くなったセルを破棄に回す
+        for (size_t i : active_) {
+            Cell& cell = cells_[i];
+            if (cell.state == CellState::Unloading || Distance(cell, focus) <= config_.unloadRadius) continue;
+            if (cell.stream) {
+                cell.stream->Cancel();
+                cell.entities = cell.stream->GetEntities();
+                cell.stream.reset();
+            }
+            cell.destroyCursor = 0;
+            cell.state = CellState::Unloading;
+            stats_.unloadsStarted++;
+        }
+
+        Instantiate(world, focus);
+        Destroy(world);
+        BeginLoads(world, focus, jobs);
+    }
+
+    bool IsOpen() const { return !directory_.empty(); }
+
+    /**
+     * @brief 読み込み中・破棄中のセルがあるか
+     */
+    bool IsBusy() const {
+        for (size_t i : active_) {
+            if (cells_[i].state != CellState::Loaded) return true;
+        }
+        return false;
+    }
+
+    float CellSize() const { return cellSize_; }
+    const std::string& GetDirectory() const { return directory_; }
+
+    CellStreamerStats GetStats() const {
+        CellStreamerStats stats = stats_;
+        stats.cells = cells_.size();
+        for (size_t i : active_) {
+            const Cell& cell = cells_[i];
+            stats.residentEntities += cell.entityCount;
+            switch (cell.state) {
+            case CellState::Loaded: stats.loaded++; break;
+            case CellState::Loading: stats.loading++; break;
+            case CellState::Unloading: stats.unloading++; break;
+            default: break;
+            }
+        }
+        return stats;
+    }
+
+private:
+    enum class CellState : uint8_t {
+        Unloaded,   ///< エンティティなし
+        Loading,    ///< SceneStream で読み込み・生成中
+        Loaded,     ///< 生成済み(読み込みに失敗したセルもエンティティなしでここに置き、離れるまで読み直さない)
+        Unloading,  ///< 破棄中
+    };
+
+    struct Cell {
+        int x = 0;
+        int z = 0;
+        size_t entityCount = 0;                 ///< マニフェストのエンティティ数
+        CellState state = CellState::Unloaded;
+        std::unique_ptr<SceneStream> stream;    ///< 読み込み中のみ
+        std::vector<Entity> entities;           ///< 生成したエンティティ(読み込み済み・破棄中)
+        size_t destroyCursor = 0;               ///< 次に破棄する entities の位置
+    };
+
+    static int CellCoord(float position, float cellSize) {
+        return static_cast<int>(std::floor(position / cellSize));
+    }
+
+    static uint64_t Key(int x, int z) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+    }
+
+    /**
+     * @brief 注視点からセルの矩形までの XZ 平面の距離(中にいれば 0)
+     */
+    float Distance(const Cell& cell, const DirectX::XMFLOAT3& focus) const {
+        const float minX = static_cast<float>(cell.x) * cellSize_;
+        const float minZ = static_cast<float>(cell.z) * cellSize_;
+        const float dx = (std::max)({ minX - focus.x, 0.0f, focus.x - (minX + cellSize_) });
+        const float dz = (std::max)({ minZ - focus.z, 0.0f, focus.z - (minZ + cellSize_) });
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    /**
+     * @brief 読み込み中のセルを近い順に、予算の範囲で生成を進める
+     */
+    void Instantiate(World& world, const DirectX::XMFLOAT3& focus) {
+        loadingOrder_.clear();
+        for (size_t i : active_) {
+            if (cells_[i].state == CellState::Loading) loadingOrder_.push_back({ Distance(cells_[i], focus), i });
+        }
+        std::sort(loadingOrder_.begin(), loadingOrder_.end());
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        double remaining = config_.budgetMs;
+        for (const auto& entry : loadingOrder_) {
+            if (remaining <= 0.0) break;
+            Cell& cell = cells_[entry.second];
+            if (!cell.stream->Step(world, remaining)) {
+                remaining = config_.budgetMs - std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+                continue;
+            }
+            if (cell.stream->GetState() == SceneStream::State::Done) {
+                cell.entities = cell.stream->GetEntities();
+            }
+            cell.stream.reset();
+            cell.state = CellState::Loaded;
+            remaining = config_.budgetMs - std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+    }
+
+    /**
+     * @brief 破棄中のセルのエンティティを上限まで破棄(実際の破棄はフレームの終わり)
+     */
+    void Destroy(World& world) {
+        size_t quota = config_.destroyPerFrame;
+        for (size_t i : active_) {
+            Cell& cell = cells_[i];
+            if (cell.state != CellState::Unloading) continue;
+            while (quota > 0 && cell.destroyCursor < cell.entities.size()) {
+                const Entity e = cell.entities[cell.destroyCursor++];
+                if (world.IsAlive(e)) {
+                    world.DestroyEntityWithCause(e, World::Cause::SceneUnload);
+                    quota--;
+                }
+            }
+            if (cell.destroyCursor < cell.entities.size()) break;
+            cell.entities.clear();
+            cell.entities.shrink_to_fit();
+            cell.destroyCursor = 0;
+            cell.state = CellState::Unloaded;
+        }
+        active_.erase(std::remove_if(active_.begin(), active_.end(),
+                                     [this](size_t i) { return cells_[i].state == CellState::Unloaded; }),
+                      active_.end());
+    }
+
+    /**
+     * @brief 読み込む距離に入ったセルを近い順に、同時数とエンティティ数の上限まで読み込み始める
+     */
+    void BeginLoads(const World& world, const DirectX::XMFLOAT3& focus, JobSystem* jobs) {
+        size_t loading = 0;
+        size_t resident = 0;
+        for (size_t i : active_) {
+            if (cells_[i].state == CellState::Loading) loading++;
+            resident += cells_[i].entityCount;
+        }
+        if (loading >= static_cast<size_t>(config_.maxConcurrentLoads)) return;
+
+        // 注視点の周りの範囲のセルだけを調べる(レベル全体は走査しない)
+        const int minX = CellCoord(focus.x - config_.loadRadius, cellSize_);
+        const int maxX = CellCoord(focus.x + config_.loadRadius, cellSize_);
+        const int minZ = CellCoord(focus.z - config_.loadRadius, cellSize_);
+        const int maxZ = CellCoord(focus.z + config_.loadRadius, cellSize_);
+        candidates_.clear();
+        for (int z = minZ; z <= maxZ; ++z) {
+            for (int x = minX; x <= maxX; ++x) {
+                auto it = index_.find(Key(x, z));
+                if (it == index_.end() || cells_[it->second].state != CellState::Unloaded) continue;
+                const float distance = Distance(cells_[it->second], focus);
+                if (distance <= config_.loadRadius) candidates_.push_back({ distance, it->second });
+            }
+        }
+        std::sort(candidates_.begin(), candidates_.end());
+
+        for (const auto& entry : candidates_) {
+            if (loading >= static_cast<size_t>(config_.maxConcurrentLoads)) break;
+            Cell& cell = cells_[entry.second];
+            if (config_.maxEntities > 0 && resident + cell.entityCount > config_.maxEntities) {
+                // 近いセルを優先するため、遠いセルで枠を埋めずに破棄が進むのを待つ
+                stats_.deferredLoads++;
+                break;
+            }
+            cell.stream = std::make_unique<SceneStream>();
+            cell.stream->Begin(CellPath(directory_, cell.x, cell.z), world, jobs);
+            cell.state = CellState::Loading;
+            active_.push_back(entry.second);
+            resident += cell.entityCount;
+            loading++;
+            stats_.loadsStarted++;
+        }
+    }
+
+    CellStreamerConfig config_;
+    std::string directory_;
+    float cellSize_ = 0.0f;
+    std::vector<Cell> cells_;                           ///< マニフェストのセル
+    std::unordered_map<uint64_t, size_t> index_;        ///< セルの座標から cells_ の位置
+    std::vector<size_t> active_;                        ///< Unloaded 以外のセル
+    std::vector<std::pair<float, size_t>> loadingOrder_;///< Instantiate() の作業用(容量を使い回す)
+    std::vector<std::pair<float, size_t>> candidates_;  ///< BeginLoads() の作業用
+    CellStreamerStats stats_;
+};
@@ -0,0 +1,109 @@
+/**
+ * @file CrowdBenchmarkScene.h
+ * @brief シミュレーションの負荷計測用シーン(`--bench crowd` で起動)
+ * @author 山内陽
+ * @date 2025
+ *
+ * @details
+ * ScenarioBenchmarkConfig::entities 個の MeshRenderer を箱の中にばらまき、Velocity で動かします。
+ * 位置・速度・形状は util::Random から決めるため、同じシードなら毎回同じ配置と動きになります。
+ * 4個に1個は Rotator(Behaviour)を持たせ、MovementSystem の積分・Behaviour の更新・
+ * 並列の壁の反射(ParallelForEach)・TransformSystem の行列の更新がどれも毎ステップ実行されるようにします。
+ * `--bench crowd-gpu` では同じ配置と速度を GpuMover で作り、積分・壁の反射・回転・描画をGPUで行います(CPU版との比較用)。
+ */
+#pragma once
+
+#include "pch.h"
+#include "app/ScenarioBenchmark.h"
+#include "components/GameComponents.h"
+#include "components/GpuMover.h"
+#include "components/Light.h"
+#include "components/MeshRenderer.h"
+#include "components/Rotator.h"
+#include "util/Random.h"
+
+// ========================================================
+// シミュレーションの負荷計測シーン
+// ========================================================
+
+class CrowdBenchmarkScene : public IScene {
+  public:
+    explicit CrowdBenchmarkScene(const ScenarioBenchmarkConfig &config) : config_(config) {}
+
+    void OnEnter(World &world) override {
+        DEBUGLOG("CrowdBenchmarkScene::OnEnter() - entities=" + std::to_string(config_.entities) +
+                 ", seed=" + std::to_string(config_.seed));
+
+        ownedEntities_.push_back(world.Create().With<DirectionalLight>().Build());
+        CreateCrowd(world);
+
+        DEBUGLOG("CrowdBenchmarkScene::OnEnter() - 初期化完了");
+    }
+
+    void OnUpdate(World &world, InputSystem &input, float deltaTime) override {
+        world.Tick(deltaTime);
+
+        // 箱の壁で速度を反射(自分のコンポーネントだけを書き換えるのでワーカーに分割できる)
+        const float extent = config_.CrowdExtent();
+        world.ParallelForEach<Transform, Velocity>([extent](Entity, Transform &t, Velocity &v) {
+            if ((t.position.x > extent && v.velocity.x > 0.0f) || (t.position.x < -extent && v.velocity.x < 0.0f)) {
+                v.velocity.x = -v.velocity.x;
+            }
+            if ((t.position.z > extent && v.velocity.z > 0.0f) || (t.position.z < -extent && v.velocity.z < 0.0f)) {
+                v.velocity.z = -v.velocity.z;
+            }
+        }, 1024);
+    }
+
+    void OnExit(World &world) override {
+        for (const auto &entity : ownedEntities_) {
+            if (world.IsAlive(entity)) {
+                world.DestroyEntityWithCause(entity, World::Cause::SceneUnload);
+            }
+        }
+        ownedEntities_.clear();
+    }
+
+  private:
+    /**
+     * @brief エンティティを箱の中にばらまく(乱数はすべてメインスレッドの util::Random から取る)
+     */
+    void CreateCrowd(World &world) {
+        static const MeshType shapes[] = { MeshType::Cube, MeshType::Sphere, MeshType::Cylinder, MeshType::Capsule };
+        const size_t shapeCount = sizeof(shapes) / sizeof(shapes[0]);
+        const float extent = config_.CrowdExtent();
+        const bool gpu = config_.scenario == "crowd-gpu";
+
+        ownedEntities_.reserve(ownedEntities_.size() + config_.entities);
+        for (size_t i = 0; i < config_.entities; ++i) {
+            MeshRenderer renderer;
+            renderer.meshType = shapes[i % shapeCount];
+            renderer.color = util::Random::ColorBright();
+
+            const DirectX::XMFLOAT3 position{ util::Random::Float(-extent, extent), 0.5f, util::Random::Float(-extent, extent) };
+            const float angle = util::Random::Float(0.0f, DirectX::XM_2PI);
+            const float speed = util::Random::Float(0.5f, ScenarioBenchmarkConfig::CROWD_SPEED);
+            const Velocity velocity(DirectX::XMFLOAT3{ std::cos(angle) * speed, 0.0f, std::sin(angle) * speed });
+
+            // GPU版: 壁の反射も GpuMover の bounceExtent で GPU 側が行う(乱数の取り方は CPU 版と同じ)
+            if (gpu) {
+                GpuMover mover(velocity.velocity);
+                mover.meshType = renderer.meshType;
+                mover.color = renderer.color;
+                mover.bounceExtent = extent;
+                if (i % 4 == 0) mover.rotationSpeedDegY = util::Random::Float(-180.0f, 180.0f);
+                ownedEntities_.push_back(world.Create().With<Transform>(Transform{ position }).With<GpuMover>(mover).Build());
+                continue;
+            }
+
+            EntityBuilder builder = world.Create().With<Transform>(Transform{ position }).With<Velocity>(velocity).With<MeshRenderer>(renderer);
+            if (i % 4 == 0) {
+                builder.With<Rotator>(util::Random::Float(-180.0f, 180.0f));
+            }
+            ownedEntities_.push_back(builder.Build());
+        }
+    }
+
+    ScenarioBenchmarkConfig config_;     ///< シーンの規模とシード
+    std::vector<Entity> ownedEntities_;  ///< シーンが管理するエンティティ
+};
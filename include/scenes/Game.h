@@ -12,9 +12,12 @@
 #include "components/MeshRenderer.h"
 #include "input/InputSystem.h"
 #include "input/GamepadSystem.h"
+#include "input/InputActions.h"
 #include "components/Model.h"
 #include "components/ModelComponent.h"
 #include "components/Rotator.h"
+#include "components/SpatialBody.h"
+#include "components/Collider.h"
 #include "components/Light.h"
 #include "systems/ModelLoadingSystem.h"
 #include "app/ServiceLocator.h"
@@ -29,6 +32,9 @@ class GameScene : public IScene {
     void OnEnter(World &world) override {
         DEBUGLOG("GameScene::OnEnter() - ゲーム開始");
 
+        // シーンが管理するエンティティの親（OnExit で子孫ごと破棄）
+        sceneRoot_ = world.CreateEntityWithCause(World::Cause::SceneInit);
+
         // システムエンティティを作成
         world.Create().With<ModelLoadingSystem>();
 
@@ -42,13 +48,10 @@ class GameScene : public IScene {
     }
 
     void OnUpdate(World &world, InputSystem &input, float deltaTime) override {
-        // PlayerMovementコンポーネントにInputSystemとGamepadSystemの参照を設定
+        // PlayerMovementコンポーネントに評価済みのアクションの参照を設定
         world.ForEach<PlayerMovement>([&](Entity e, PlayerMovement &pm) {
-            if (!pm.input_) {
-                pm.input_ = &input;
-            }
-            if (!pm.gamepad_) {
-                pm.gamepad_ = &ServiceLocator::Get<GamepadSystem>();
+            if (!pm.actions_) {
+                pm.actions_ = &ServiceLocator::Get<InputActions>();
             }
         });
 
@@ -62,13 +65,11 @@ class GameScene : public IScene {
     void OnExit(World &world) override {
         DEBUGLOG("GameScene::OnExit() - ゲーム終了");
 
-        // シーンが管理するエンティティを削除
-        for (const auto &entity : ownedEntities_) {
-            if (world.IsAlive(entity)) {
-                world.DestroyEntityWithCause(entity, World::Cause::SceneUnload);
-            }
+        // シーンが管理するエンティティを削除（子の数だけの走査）
+        if (world.IsAlive(sceneRoot_)) {
+            world.DestroyRecursive(sceneRoot_, World::Cause::SceneUnload);
         }
-        ownedEntities_.clear();
+        sceneRoot_ = Entity{};
 
         DEBUGLOG("GameScene::OnExit() - クリーンアップ完了");
     }
@@ -93,11 +94,16 @@ class GameScene : public IScene {
         renderer.meshType = MeshType::Cube;
         renderer.color = DirectX::XMFLOAT3{0.0f, 1.0f, 0.0f}; // 緑色
 
+        // キューブに合わせた当たり判定
+        Collider collider = Collider::FromMesh(MeshType::Cube);
+
         // プレイヤーエンティティを作成
         Entity player = world.Create()
                             .With<Transform>(transform)
                             .With<MeshRenderer>(renderer)
                             .With<PlayerTag>()
+                            .With<Collider>(collider)
+                            .With<SpatialBody>(SpatialBody{ collider.BoundingRadius(), SpatialBody::LAYER_PLAYER, SpatialBody::LAYER_ENEMY })
                             .With<PlayerMovement>() // プレイヤー移動コンポーネントを追加
                             .With<Rotator>(45.0f)   // 回転速度を45度/秒に修正
                             .Build();
@@ -110,9 +116,9 @@ class GameScene : public IScene {
         DEBUGLOG("CreatePlayer: Has PlayerTag: " + std::string(world.Has<PlayerTag>(player) ? "YES" : "NO"));
         DEBUGLOG("CreatePlayer: Has MeshRenderer: " + std::string(world.Has<MeshRenderer>(player) ? "YES" : "NO"));
 
-        ownedEntities_.push_back(player);
+        world.SetParent(player, sceneRoot_); // 所有のみ（Transform は継承しない）
         playerEntity_ = player;
     }
     Entity playerEntity_;               ///< プレイヤーエンティティ
-    std::vector<Entity> ownedEntities_; ///< シーンが管理するエンティティ
+    Entity sceneRoot_{};                ///< シーンが管理するエンティティの親
 };
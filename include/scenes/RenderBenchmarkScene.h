@@ -0,0 +1,106 @@
+/**
+ * @file RenderBenchmarkScene.h
+ * @brief 描画の負荷計測用シーン(`--render-benchmark` で起動)
+ * @author 山内陽
+ * @date 2025
+ *
+ * @details
+ * RenderBenchmarkConfig の数だけ MeshRenderer のプリミティブと Model を格子状に並べます。
+ * 配置・色・形状・テクスチャの有無はすべて添字から決まるため、実行のたびに同じシーンになります。
+ * エンティティは動かさず、視点の移動とフレームごとの記録は App が RenderBenchmark で行います。
+ */
+#pragma once
+
+#include "pch.h"
+#include "app/RenderBenchmark.h"
+#include "app/ServiceLocator.h"
+#include "components/Light.h"
+#include "components/MeshRenderer.h"
+#include "components/Model.h"
+#include "systems/ModelLoadingSystem.h"
+
+// ========================================================
+// 描画の負荷計測シーン
+// ========================================================
+
+class RenderBenchmarkScene : public IScene {
+  public:
+    explicit RenderBenchmarkScene(const RenderBenchmarkConfig &config) : config_(config) {}
+
+    void OnEnter(World &world) override {
+        DEBUGLOG("RenderBenchmarkScene::OnEnter() - meshes=" + std::to_string(config_.meshCount) +
+                 ", models=" + std::to_string(config_.modelCount) +
+                 ", lines=" + std::to_string(config_.lineCount));
+
+        ownedEntities_.push_back(world.Create().With<ModelLoadingSystem>().Build());
+        ownedEntities_.push_back(world.Create().With<DirectionalLight>().Build());
+
+        CreateMeshes(world);
+        CreateModels(world);
+
+        DEBUGLOG("RenderBenchmarkScene::OnEnter() - 初期化完了");
+    }
+
+    void OnUpdate(World &world, InputSystem &input, float deltaTime) override {
+        world.Tick(deltaTime);
+    }
+
+    void OnExit(World &world) override {
+        for (const auto &entity : ownedEntities_) {
+            if (world.IsAlive(entity)) {
+                world.DestroyEntityWithCause(entity, World::Cause::SceneUnload);
+            }
+        }
+        ownedEntities_.clear();
+    }
+
+  private:
+    /**
+     * @brief プリミティブを格子に並べる
+     *
+     * @details
+     * 形状は6種類を順に、4個に1個はテクスチャ付きにして、インスタンス描画のまとまりと
+     * ステート変更がどちらも発生するようにします。
+     */
+    void CreateMeshes(World &world) {
+        static const MeshType shapes[] = {
+            MeshType::Cube, MeshType::Sphere, MeshType::Cylinder, MeshType::Cone, MeshType::Capsule, MeshType::Plane
+        };
+        const size_t shapeCount = sizeof(shapes) / sizeof(shapes[0]);
+
+        TextureManager::TextureHandle texture = ServiceLocator::Get<TextureManager>().LoadFromFile("Assets/Textures/test.png");
+
+        ownedEntities_.reserve(ownedEntities_.size() + config_.meshCount + config_.modelCount);
+        for (size_t i = 0; i < config_.meshCount; ++i) {
+            MeshRenderer renderer;
+            renderer.meshType = shapes[i % shapeCount];
+            renderer.color = DirectX::XMFLOAT3{
+                0.3f + 0.7f * static_cast<float>(i % 5) / 4.0f,
+                0.3f + 0.7f * static_cast<float>(i % 3) / 2.0f,
+                0.3f + 0.7f * static_cast<float>(i % 7) / 6.0f
+            };
+            if (i % 4 == 0) {
+                renderer.texture = texture;
+            }
+
+            Transform transform{ RenderBenchmarkConfig::GridPosition(i, config_.meshCount, RenderBenchmarkConfig::MESH_SPACING, 0.5f) };
+            ownedEntities_.push_back(world.Create().With<Transform>(transform).With<MeshRenderer>(renderer).Build());
+        }
+    }
+
+    /**
+     * @brief モデルをプリミティブの上に格子で並べる(読み込みは ModelLoadingSystem が非同期に行う)
+     */
+    void CreateModels(World &world) {
+        for (size_t i = 0; i < config_.modelCount; ++i) {
+            Transform transform{ RenderBenchmarkConfig::GridPosition(i, config_.modelCount, RenderBenchmarkConfig::MODEL_SPACING,
+                                                                     RenderBenchmarkConfig::MODEL_HEIGHT) };
+            Entity e = world.Create().With<Transform>(transform).Build();
+            world.Add<Model>(e, Model{ config_.modelPath });
+            ownedEntities_.push_back(e);
+        }
+    }
+
+    RenderBenchmarkConfig config_;       ///< シーンの規模
+    std::vector<Entity> ownedEntities_;  ///< シーンが管理するエンティティ
+};
@@ -5,11 +5,17 @@
 #pragma once
 
 #include "app/DebugLog.h"
+#include "app/Profiler.h"
+#include "app/StartupReport.h"
 #include "ecs/World.h"
 #include "input/InputSystem.h"
+#include "scenes/SceneStream.h"
+#include "scenes/CellStreamer.h"
+#include "app/JobSystem.h"
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @class IScene
@@ -25,6 +31,66 @@ public:
 
     virtual bool ShouldChangeScene() const { return false; }
     virtual const char* GetNextScene() const { return nullptr; }
+
+    /**
+     * @brief Scene file streamed in after OnEnter() (nullptr for none).
+     * @details Entities are created a few at a time over the following frames
+     * and destroyed by the manager when the scene exits.
+     */
+    virtual const char* GetStreamingScenePath() const { return nullptr; }
+
+    /**
+     * @brief Called once all streamed entities exist in the world.
+     */
+    virtual void OnSceneStreamed(World& world, const std::vector<Entity>& entities) {
+        (void)world;
+        (void)entities;
+    }
+
+    /**
+     * @brief Directory of a cell-partitioned level (see CellStreamer::Bake()), or nullptr for none.
+     * @details Cells around the streaming focus are loaded and unloaded by the manager
+     * while the scene is active, and all of them are destroyed when it exits.
+     */
+    virtual const char* GetStreamingCellDirectory() const { return nullptr; }
+
+    /**
+     * @brief Load/unload radii and budgets used for the cell directory.
+     */
+    virtual CellStreamerConfig GetCellStreamingConfig() const { return CellStreamerConfig(); }
+
+    /**
+     * @brief Point the cells are streamed around (usually the player).
+     * @return false to keep the point given to SceneManager::SetStreamingFocus() (the camera).
+     */
+    virtual bool GetStreamingFocus(const World& world, DirectX::XMFLOAT3& focus) const {
+        (void)world;
+        (void)focus;
+        return false;
+    }
+
+    /**
+     * @brief Called on the main thread by SceneManager::Preload(), and by Init() for the start scene.
+     * @details Start asynchronous asset loads here (e.g. ResourceManager::PreloadModels())
+     * and keep the handles until OnExit().
+     */
+    virtual void OnPreloadAssets() {}
+
+    /**
+     * @brief Called on a worker thread by SceneManager::Preload().
+     * @param staging Private world whose entities are moved into the real world on entry.
+     * @details Only touch the staging world and data owned by this scene. All components are
+     * carried over; Entity fields are remapped for types registered with World::RegisterEntityRemap().
+     */
+    virtual void OnPreload(World& staging) { (void)staging; }
+
+    /**
+     * @brief Called after OnEnter() once the preloaded entities exist in the world.
+     */
+    virtual void OnPreloadMerged(World& world, const std::vector<Entity>& entities) {
+        (void)world;
+        (void)entities;
+    }
 };
 
 /**
@@ -45,7 +111,12 @@ public:
             DEBUGLOG_WARNING("SceneManager::Init() - start scene not found");
             return;
         }
+        // Start the scene's asset loads on the workers before building it.
+        StartupReport::Scope scope("Scene.OnEnter");
+        currentScene_->OnPreloadAssets();
         currentScene_->OnEnter(world);
+        scope.End();
+        BeginStreaming(world);
     }
 
     /**
@@ -68,6 +139,18 @@ public:
         if (!currentScene_) {
             return;
         }
+        PROFILE_SCOPE("SceneManager::Update");
+
+        if (stream_.IsActive() && stream_.Step(world, streamingBudgetMs_)) {
+            if (stream_.GetState() == SceneStream::State::Done) {
+                currentScene_->OnSceneStreamed(world, stream_.GetEntities());
+            }
+        }
+        if (cells_.IsOpen()) {
+            DirectX::XMFLOAT3 focus = streamingFocus_;
+            currentScene_->GetStreamingFocus(world, focus);
+            cells_.Update(world, focus, jobs_);
+        }
 
         currentScene_->OnUpdate(world, input, deltaTime);
 
@@ -93,12 +176,73 @@ public:
         if (currentScene_) {
             DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "Scene change: OnExit()");
             currentScene_->OnExit(world);
+            EndStreaming(world);
             world.FlushDestroyEndOfFrame();
         }
 
         currentScene_ = nextScene;
         DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "Scene change: OnEnter()");
         currentScene_->OnEnter(world);
+        MergePreload(world);
+        BeginStreaming(world);
+    }
+
+    /**
+     * @brief Prepare a scene in the background before switching to it.
+     * @param sceneName Scene to prepare. Must not be the current scene.
+     * @param world Real world (its snapshot type registrations are copied to the staging world,
+     * so OnPreload() can Deserialize() scene data).
+     * @return true if preloading started.
+     *
+     * @details Calls OnPreloadAssets() now and OnPreload() on a worker. A later ChangeScene()
+     * to the same scene waits for the worker if needed, then moves the staged entities into
+     * the world right after OnEnter(). Only one scene is preloaded at a time.
+     */
+    bool Preload(const char* sceneName, World& world) {
+        IScene* scene = FindScene(sceneName);
+        if (!scene || scene == currentScene_) {
+            return false;
+        }
+        if (preload_) {
+            if (preload_->scene == scene) {
+                return true;
+            }
+            CancelPreload();
+        }
+
+        auto pending = std::make_shared<PendingPreload>();
+        pending->scene = scene;
+        pending->staging.CopySnapshotTypes(world);
+        preload_ = pending;
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Scene, std::string("Scene preload: ") + sceneName);
+        scene->OnPreloadAssets();
+        auto job = [pending]() { pending->scene->OnPreload(pending->staging); };
+        if (jobs_ && jobs_->IsRunning()) {
+            jobs_->Submit(job, &pending->counter);
+        } else {
+            job();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Whether the scene has finished preloading (ChangeScene() will not wait).
+     */
+    bool IsPreloaded(const char* sceneName) {
+        IScene* scene = FindScene(sceneName);
+        return scene && preload_ && preload_->scene == scene && preload_->counter.IsDone();
+    }
+
+    /**
+     * @brief Discard the pending preload (waits for the worker to finish first).
+     */
+    void CancelPreload() {
+        if (!preload_) {
+            return;
+        }
+        waitPreload();
+        preload_.reset();
     }
 
     /**
@@ -106,6 +250,37 @@ public:
      */
     IScene* GetCurrentScene() const { return currentScene_; }
 
+    /**
+     * @brief Worker pool used to parse streamed scene files (nullptr parses inline).
+     */
+    void SetJobSystem(JobSystem* jobs) {
+        if (preload_) {
+            waitPreload();
+        }
+        jobs_ = jobs;
+    }
+
+    /**
+     * @brief Per-frame time budget for instantiating streamed entities.
+     */
+    void SetStreamingBudget(double milliseconds) { streamingBudgetMs_ = milliseconds; }
+
+    /**
+     * @brief Stream of the current scene (progress reporting).
+     */
+    const SceneStream& GetStreaming() const { return stream_; }
+
+    /**
+     * @brief Fallback focus for cell streaming when the scene does not provide one.
+     * @details Call between simulation steps (e.g. with the camera position at the frame's sync point).
+     */
+    void SetStreamingFocus(const DirectX::XMFLOAT3& focus) { streamingFocus_ = focus; }
+
+    /**
+     * @brief Cell streaming of the current scene (statistics).
+     */
+    const CellStreamer& GetCellStreaming() const { return cells_; }
+
     /**
      * @brief Destructor performs sanity logging.
      */
@@ -126,8 +301,12 @@ public:
 
         DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "SceneManager::Shutdown()");
 
+        // The preload worker calls into a scene owned by scenes_
+        CancelPreload();
+
         if (currentScene_) {
             currentScene_->OnExit(world);
+            EndStreaming(world);
             currentScene_ = nullptr;
         }
 
@@ -136,6 +315,66 @@ public:
     }
 
 private:
+    void BeginStreaming(World& world) {
+        const char* path = currentScene_->GetStreamingScenePath();
+        if (path) {
+            stream_.Begin(path, world, jobs_);
+        }
+        const char* cellDirectory = currentScene_->GetStreamingCellDirectory();
+        if (cellDirectory) {
+            cells_.SetConfig(currentScene_->GetCellStreamingConfig());
+            cells_.Open(cellDirectory);
+        }
+    }
+
+    /**
+     * @brief Stop the stream and destroy the entities it created.
+     */
+    void EndStreaming(World& world) {
+        stream_.Cancel();
+        for (Entity e : stream_.GetEntities()) {
+            if (world.IsAlive(e)) {
+                world.DestroyEntityWithCause(e, World::Cause::SceneUnload);
+            }
+        }
+        stream_.Reset();
+        cells_.Close(world);
+
+        for (Entity e : preloaded_) {
+            if (world.IsAlive(e)) {
+                world.DestroyEntityWithCause(e, World::Cause::SceneUnload);
+            }
+        }
+        preloaded_.clear();
+    }
+
+    /**
+     * @brief Move the entities preloaded for the current scene into the world.
+     */
+    void MergePreload(World& world) {
+        if (!preload_ || preload_->scene != currentScene_) {
+            return;
+        }
+        PROFILE_SCOPE("SceneManager::MergePreload");
+        waitPreload();
+
+        world.MergeFrom(std::move(preload_->staging), &preloaded_, World::Cause::SceneInit);
+        preload_.reset();
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "Scene preload merged: " + std::to_string(preloaded_.size()) + " entities");
+        currentScene_->OnPreloadMerged(world, preloaded_);
+    }
+
+    void waitPreload() {
+        if (preload_->counter.IsDone()) {
+            return;
+        }
+        PROFILE_SCOPE("SceneManager::WaitPreload");
+        if (jobs_) {
+            jobs_->Wait(preload_->counter);
+        }
+    }
+
     IScene* FindScene(const char* name) {
         if (!name) {
             return nullptr;
@@ -151,6 +390,22 @@ private:
     IScene* currentScene_ = nullptr;
     std::unordered_map<std::string, std::unique_ptr<IScene>> scenes_;
     bool isShutdown_ = false;
+    SceneStream stream_;
+    CellStreamer cells_;
+    DirectX::XMFLOAT3 streamingFocus_{ 0.0f, 0.0f, 0.0f };
+    JobSystem* jobs_ = nullptr;
+
+    /**
+     * @brief Scene being prepared by Preload() (staging is read only after counter is done).
+     */
+    struct PendingPreload {
+        IScene* scene = nullptr;
+        World staging;
+        JobSystem::JobCounter counter;
+    };
+    std::shared_ptr<PendingPreload> preload_;
+    std::vector<Entity> preloaded_; ///< Entities merged from the preload of the current scene
+    double streamingBudgetMs_ = SceneStream::DEFAULT_BUDGET_MS;
 };
 
 
@@ -0,0 +1,242 @@
+#pragma once
+#include "ecs/World.h"
+#include "app/JobSystem.h"
+#include "app/DebugLog.h"
+#include "app/Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file SceneStream.h
+ * @brief シーンファイルの非同期読み込みと、複数フレームに分けたエンティティの生成
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * シーンファイルは World::Serialize() で書き出したスナップショットと同じ形式です。
+ * 読み込みは2段階で行います。
+ * 1. ワーカースレッドでファイルを読み、一時的な World へ Deserialize()(展開・検証・構築)
+ * 2. メインスレッドで Step() を呼ぶたびに、時間の予算内で BATCH_SIZE 件ずつ本来の World へ移す
+ *
+ * 2 の間もゲームは毎フレーム更新され、移し終えたエンティティから順に動き始めます。
+ */
+
+/**
+ * @class SceneStream
+ * @brief 1つのシーンファイルの段階的な読み込み
+ *
+ * @details
+ * 型は本来の World に RegisterSnapshotType() で登録したものだけが読み込まれます。
+ * コンポーネント内の Entity(Parent など)はファイル内のハンドルのままなので、
+ * エンティティ間の参照を含む状態の保存には World::Deserialize() を直接使ってください。
+ *
+ * @par 使用例
+ * @code
+ * SceneStream stream;
+ * stream.Begin("assets/scenes/level1.hews", world, &jobs);
+ *
+ * // 毎フレーム(Tick の外)
+ * if (!stream.Step(world, 2.0)) {
+ *     DrawLoadingBar(stream.Progress());
+ * }
+ * @endcode
+ */
+class SceneStream {
+public:
+    /**
+     * @enum State
+     * @brief 読み込みの状態
+     */
+    enum class State {
+        Idle,           ///< 未開始
+        Parsing,        ///< ワーカーで読み込み・展開中
+        Instantiating,  ///< メインスレッドで生成中
+        Done,           ///< 完了
+        Failed          ///< ファイルがない・形式が不正
+    };
+
+    static constexpr size_t BATCH_SIZE = 64;            ///< 予算を確認する間隔(エンティティ数)
+    static constexpr double DEFAULT_BUDGET_MS = 2.0;    ///< 1フレームあたりの生成時間の目安
+
+    SceneStream() = default;
+    SceneStream(const SceneStream&) = delete;
+    SceneStream& operator=(const SceneStream&) = delete;
+
+    ~SceneStream() { Cancel(); }
+
+    /**
+     * @brief 読み込みを開始
+     * @param[in] path シーンファイル
+     * @param[in] world 生成先(登録済みのスナップショットの型を使う)
+     * @param[in] jobs ワーカー(nullptr または停止中の場合はこの呼び出しの中で読み込む)
+     * @return bool 開始できた場合 true(読み込み中・生成中の場合は false)
+     */
+    bool Begin(const std::string& path, const World& world, JobSystem* jobs) {
+        if (state_ == State::Parsing || state_ == State::Instantiating) {
+            DEBUGLOG_WARNING("SceneStream::Begin() - 読み込み中のため開始できません: " + path_);
+            return false;
+        }
+
+        path_ = path;
+        entities_.clear();
+        sources_.clear();
+        cursor_ = 0;
+        frames_ = 0;
+        instantiateMs_ = 0.0;
+        components_ = 0;
+        state_ = State::Parsing;
+
+        auto pending = std::make_shared<Pending>();
+        pending->staging.CopySnapshotTypes(world);
+        pending_ = pending;
+
+        auto parse = [pending, path]() {
+            const auto start = std::chrono::high_resolution_clock::now();
+            std::vector<uint8_t> bytes;
+            pending->succeeded = ReadSnapshotFile(path, bytes) && pending->staging.Deserialize(bytes);
+            pending->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            pending->done.store(true, std::memory_order_release);
+        };
+
+        if (jobs && jobs->IsRunning()) {
+            jobs->Submit(parse);
+        } else {
+            parse();
+        }
+        DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "シーンの読み込みを開始: " + path);
+        return true;
+    }
+
+    /**
+     * @brief 予算の範囲で生成を進める(メインスレッド、Tick の外で呼ぶ)
+     * @param[in] world 生成先
+     * @param[in] budgetMs このフレームで使う時間の目安(最低1バッチは進める)
+     * @return bool 完了または失敗して、進める作業が残っていない場合 true
+     */
+    bool Step(World& world, double budgetMs = DEFAULT_BUDGET_MS) {
+        if (state_ == State::Parsing) {
+            if (!pending_->done.load(std::memory_order_acquire)) return false;
+            if (!pending_->succeeded) {
+                DEBUGLOG_ERROR("シーンの読み込みに失敗: " + path_);
+                pending_.reset();
+                state_ = State::Failed;
+                return true;
+            }
+            parseMs_ = pending_->milliseconds;
+            pending_->staging.ForEachEntity([this](Entity e) { sources_.push_back(e); });
+            entities_.reserve(sources_.size());
+            state_ = State::Instantiating;
+        }
+        if (state_ != State::Instantiating) return true;
+
+        PROFILE_SCOPE("SceneStream::Step");
+        const auto start = std::chrono::high_resolution_clock::now();
+        double elapsed = 0.0;
+        do {
+            const size_t count = (std::min)(BATCH_SIZE, sources_.size() - cursor_);
+            components_ += world.TransferEntities(pending_->staging, sources_.data() + cursor_, count, entities_, World::Cause::SceneInit);
+            cursor_ += count;
+            elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        } while (cursor_ < sources_.size() && elapsed < budgetMs);
+        instantiateMs_ += elapsed;
+        frames_++;
+
+        if (cursor_ < sources_.size()) return false;
+
+        // バッチをまたぐ親子関係は全て移した後で写す
+        world.CopyHierarchy(pending_->staging, sources_.data(), entities_.data(), sources_.size());
+
+        DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "シーンの読み込みが完了: " + path_ + " (エンティティ: " + std::to_string(entities_.size()) +
+                          ", コンポーネント: " + std::to_string(components_) + ", 読み込み " + std::to_string(parseMs_) +
+                          " ms, 生成 " + std::to_string(instantiateMs_) + " ms / " + std::to_string(frames_) + " フレーム)");
+        pending_.reset();
+        sources_.clear();
+        sources_.shrink_to_fit();
+        state_ = State::Done;
+        return true;
+    }
+
+    /**
+     * @brief 読み込みを中止(ワーカーの処理は完了後に結果を捨てる。生成済みのエンティティは残る)
+     */
+    void Cancel() {
+        if (state_ == State::Parsing || state_ == State::Instantiating) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::Scene, "シーンの読み込みを中止: " + path_);
+            state_ = State::Idle;
+        }
+        pending_.reset();
+        sources_.clear();
+        cursor_ = 0;
+    }
+
+    /**
+     * @brief 中止して生成済みエンティティの記録も消し、未開始の状態に戻す(エンティティ自体は破棄しない)
+     */
+    void Reset() {
+        Cancel();
+        entities_.clear();
+        components_ = 0;
+        parseMs_ = 0.0;
+        instantiateMs_ = 0.0;
+        frames_ = 0;
+        state_ = State::Idle;
+    }
+
+    State GetState() const { return state_; }
+    bool IsActive() const { return state_ == State::Parsing || state_ == State::Instantiating; }
+
+    /**
+     * @brief 進み具合(0.0～1.0。読み込み中は 0、生成中は生成済みの割合)
+     */
+    float Progress() const {
+        switch (state_) {
+        case State::Instantiating:
+            return sources_.empty() ? 1.0f : static_cast<float>(cursor_) / static_cast<float>(sources_.size());
+        case State::Done:
+            return 1.0f;
+        default:
+            return 0.0f;
+        }
+    }
+
+    const std::string& GetPath() const { return path_; }
+
+    /**
+     * @brief 生成したエンティティ(シーン終了時の破棄に使う)
+     */
+    const std::vector<Entity>& GetEntities() const { return entities_; }
+
+    size_t TotalCount() const { return sources_.empty() ? entities_.size() : sources_.size(); }
+    size_t InstantiatedCount() const { return entities_.size(); }
+    double ParseMilliseconds() const { return parseMs_; }
+    double InstantiateMilliseconds() const { return instantiateMs_; }
+    uint32_t FramesUsed() const { return frames_; }
+
+private:
+    /**
+     * @struct Pending
+     * @brief ワーカーで読み込む一時的な World(done が true になってからメインスレッドで参照)
+     */
+    struct Pending {
+        World staging;
+        bool succeeded = false;
+        double milliseconds = 0.0;
+        std::atomic<bool> done{ false };
+    };
+
+    std::shared_ptr<Pending> pending_;
+    std::string path_;
+    State state_ = State::Idle;
+    std::vector<Entity> sources_;   ///< 一時的な World のエンティティ(ID順)
+    size_t cursor_ = 0;             ///< 次に移す sources_ の位置
+    std::vector<Entity> entities_;  ///< 生成したエンティティ
+    size_t components_ = 0;
+    double parseMs_ = 0.0;
+    double instantiateMs_ = 0.0;
+    uint32_t frames_ = 0;
+};
@@ -7,11 +7,11 @@
  * @brief プレイヤータグ
  * @details プレイヤーエンティティを識別するためのマーカー
  */
-struct Player : IComponent {};
+struct Player : ITag {};
 
 /**
  * @struct Enemy
  * @brief 敵タグ
  * @details 敵エンティティを識別するためのマーカー
  */
-struct Enemy : IComponent {};
\ No newline at end of file
+struct Enemy : ITag {};
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Animator.h"
+#include "components/Model.h"
+#include "animation/Skeleton.h"
+#include <DirectXMath.h>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file AnimationSystem.h
+ * @brief Animator のクリップを評価して SkinPose のスキニング行列を書くシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 1ステップの処理は2段です。どちらも World::ParallelForEach でワーカーに分割します。
+ * 1. Animator と SkinPose を持つエンティティ(Model のルート)ごとに、再生位置を進めてクリップを
+ *    サンプリング・ブレンドし、スキニング行列のパレットを自身の SkinPose に書き込みます。
+ * 2. ModelPart と SkinPose を持つ子メッシュは、ルートの SkinPose をコピーします(読むのは1段目で書き終えたルートのみ)。
+ *
+ * ポーズと関節の行列の作業領域はスレッドごとに保持するため、エンティティごとのメモリ確保はありません。
+ */
+
+/**
+ * @class AnimationSystem
+ * @brief スケルタルアニメーションの評価(CPU ではパレットまで、頂点のスキニングは GPU)
+ *
+ * @par 使用例
+ * @code
+ * world.AddSystem<AnimationSystem>();
+ *
+ * // ModelLoadingSystem がスキニングされたモデルに Animator / SkinPose を追加する
+ * world.Create().With<Transform>().With<Model>("Assets/Models/Character.fbx").Build();
+ * @endcode
+ */
+class AnimationSystem : public System<Write<Animator>, Write<SkinPose>, Read<ModelPart>> {
+public:
+    static constexpr size_t GRAIN_SIZE = 16;       ///< 並列化する場合の1ジョブあたりの Animator 数(1体あたりの処理が重いため小さい)
+    static constexpr size_t COPY_GRAIN_SIZE = 256; ///< 子メッシュへのコピーの1ジョブあたりの数
+
+    void OnCreate(World& world) override {
+        animators_ = &world.Query<Animator, SkinPose>();
+        parts_ = &world.Query<ModelPart, SkinPose>();
+    }
+
+    void OnUpdate(World& world, float dt) override {
+        animatedCount_ = 0;
+        if (animators_->Empty()) return;
+
+        world.ParallelForEach<Animator, SkinPose>([dt](Entity, Animator& animator, SkinPose& pose) {
+            Evaluate(animator, dt, pose);
+        }, GRAIN_SIZE);
+        animatedCount_ = animators_->Size();
+
+        if (!parts_->Empty()) {
+            world.ParallelForEach<ModelPart, SkinPose>([&world](Entity, ModelPart& part, SkinPose& pose) {
+                const SkinPose* root = world.Peek<SkinPose>(part.root);
+                if (root) pose.palette = root->palette;
+            }, COPY_GRAIN_SIZE);
+        }
+    }
+
+    const char* GetName() const override { return "AnimationSystem"; }
+
+    /**
+     * @brief 直近の更新で評価した Animator の数
+     */
+    size_t AnimatedCount() const { return animatedCount_; }
+
+    /**
+     * @brief 1体分の再生位置の更新・サンプリング・ブレンド・パレットの計算
+     */
+    static void Evaluate(Animator& animator, float dt, SkinPose& out) {
+        if (!animator.data) {
+            out.palette.clear();
+            return;
+        }
+        const SkinnedModelData& data = *animator.data;
+        const Skeleton& skeleton = data.skeleton;
+        const size_t joints = skeleton.JointCount();
+
+        Scratch& scratch = ThreadScratch();
+        const AnimationClip* clip = FindClip(data, animator.clip);
+        if (clip) {
+            if (animator.playing) animator.time += dt * animator.speed;
+            animator.time = clip->WrapTime(animator.time, animator.loop);
+            clip->Sample(animator.time, animator.loop, scratch.pose);
+        } else {
+            scratch.pose.SetBindPose(skeleton);
+        }
+
+        const AnimationClip* blend = FindClip(data, animator.blendClip);
+        if (blend && animator.blendWeight > 0.0f) {
+            if (animator.playing) animator.blendTime += dt * animator.speed;
+            animator.blendTime = blend->WrapTime(animator.blendTime, animator.loop);
+            blend->Sample(animator.blendTime, animator.loop, scratch.blendPose);
+            SkeletalAnimation::BlendPoses(scratch.pose, scratch.blendPose, animator.blendWeight);
+        }
+
+        if (scratch.model.size() < joints) scratch.model.resize(joints);
+        out.palette.resize(joints);
+        SkeletalAnimation::ComputeSkinningPalette(skeleton, scratch.pose, scratch.model.data(), out.palette.data());
+    }
+
+private:
+    /**
+     * @struct Scratch
+     * @brief スレッドごとの作業領域
+     */
+    struct Scratch {
+        Pose pose;
+        Pose blendPose;
+        std::vector<DirectX::XMFLOAT4X4A> model;
+    };
+
+    static Scratch& ThreadScratch() {
+        thread_local Scratch scratch;
+        return scratch;
+    }
+
+    // 関節数がスケルトンと一致する有効なクリップ(それ以外は nullptr)
+    static const AnimationClip* FindClip(const SkinnedModelData& data, int index) {
+        if (index < 0 || static_cast<size_t>(index) >= data.clips.size()) return nullptr;
+        const AnimationClip& clip = data.clips[index];
+        return clip.IsValid() && clip.JointCount() == data.skeleton.JointCount() ? &clip : nullptr;
+    }
+
+    QueryView<Animator, SkinPose>* animators_ = nullptr;
+    QueryView<ModelPart, SkinPose>* parts_ = nullptr;
+    size_t animatedCount_ = 0;
+};
@@ -0,0 +1,514 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Collider.h"
+#include "components/SpatialBody.h"
+#include "components/TransformHierarchy.h"
+#include "systems/SpatialHashGrid.h"
+#include "app/JobSystem.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file CollisionSystem.h
+ * @brief SpatialHashGrid の組に対する詳細判定と衝突イベント
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 1回の更新は次の段階で処理します。
+ * 1. Collider を持つエンティティの形状を LocalToWorld でワールド空間に変換し、平坦な配列に詰める
+ *    (Collider のない SpatialBody は SpatialBody::radius の球として扱う)
+ * 2. SpatialHashGrid::FindPairs() で境界球が重なる組を集める(ブロードフェーズ)
+ * 3. 組ごとに形状の詳細判定を行う(ナローフェーズ)。各組は独立しているため JobSystem::ParallelFor で分割し、
+ *    結果は組と同じ添字の配列に書き込むだけなのでロックは不要
+ * 4. 接触した組を CollisionEvent の配列に詰め、DESTROY_ON_CONTACT の Collider を持つ側の破棄を予約する
+ */
+
+/**
+ * @class CollisionSystem
+ * @brief 球・カプセル・箱の衝突判定(排他システム)
+ *
+ * @details
+ * 同じステップで更新された SpatialHashGrid と LocalToWorld を読むため、
+ * アクセス宣言なし(排他)で SpatialHashGrid・TransformSystem の後に登録します。
+ * ナローフェーズは自身の配列だけを読むため、排他で実行している間にワーカーへ分割できます。
+ *
+ * Events() は次の OnUpdate() まで有効です。Behaviour は World::Tick の中でシステムより先に
+ * 更新されるため、Behaviour から読むと1ステップ前の接触になります。
+ * 同じ接触は World::Events<CollisionSystem::CollisionEvent>() にも送信され、
+ * システムへの参照を持たない側は次の Tick の間そちらから読めます。
+ *
+ * @par 使用例
+ * @code
+ * SpatialHashGrid& grid = world.AddSystem<SpatialHashGrid>();
+ * CollisionSystem& collisions = world.AddSystem<CollisionSystem>(grid);
+ *
+ * for (const CollisionSystem::CollisionEvent& hit : collisions.Events()) {
+ *     // hit.normal は a から b への向き、hit.depth はめり込み量
+ * }
+ * @endcode
+ *
+ * @note 対象の組は SpatialBody の layer / mask で絞り込まれます
+ */
+class CollisionSystem : public System<> {
+public:
+    static constexpr size_t GRAIN_SIZE = 256; ///< ナローフェーズの1ジョブあたりの組の数
+
+    /**
+     * @struct CollisionEvent
+     * @brief 1組の接触
+     */
+    struct CollisionEvent {
+        Entity a;                   ///< 組の一方
+        Entity b;                   ///< 組のもう一方
+        DirectX::XMFLOAT3 normal;   ///< 接触の法線(a から b への向き、正規化済み)
+        float depth;                ///< めり込み量(0 以上)
+    };
+
+    /**
+     * @struct Statistics
+     * @brief 直近の更新の統計
+     */
+    struct Statistics {
+        size_t shapes = 0;     ///< ワールド空間に変換した形状の数
+        size_t pairs = 0;      ///< ブロードフェーズの組の数
+        size_t contacts = 0;   ///< 詳細判定で接触した組の数
+        size_t destroyed = 0;  ///< DESTROY_ON_CONTACT で破棄を予約した数
+    };
+
+    /**
+     * @param[in] grid 組を列挙する空間ハッシュグリッド(このシステムより先に登録されていること)
+     */
+    explicit CollisionSystem(SpatialHashGrid& grid) : grid_(&grid) {}
+
+    void OnCreate(World& world) override {
+        colliders_ = &world.Query<LocalToWorld, Collider>();
+        bodies_ = &world.Query<LocalToWorld, SpatialBody>(Without<Collider>());
+        channel_ = &world.Events<CollisionEvent>();
+    }
+
+    void OnUpdate(World& world, float) override {
+        stats_ = Statistics();
+        events_.clear();
+
+        gatherShapes();
+
+        pairs_.clear();
+        grid_->FindPairs(pairs_);
+        stats_.pairs = pairs_.size();
+
+        results_.resize(pairs_.size());
+        auto narrowPhase = [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                results_[i] = testPair(pairs_[i].first, pairs_[i].second);
+            }
+        };
+        JobSystem* jobs = world.GetJobSystem();
+        if (jobs && !world.IsInParallelRegion()) {
+            jobs->ParallelFor(pairs_.size(), GRAIN_SIZE, narrowPhase);
+        } else {
+            narrowPhase(0, pairs_.size());
+        }
+
+        ++destroyStamp_;
+        for (size_t i = 0; i < pairs_.size(); ++i) {
+            const Contact& contact = results_[i];
+            if (!contact.hit) continue;
+            events_.push_back(CollisionEvent{ pairs_[i].first, pairs_[i].second, contact.normal, contact.depth });
+            channel_->Send(events_.back());
+            destroyOnContact(world, pairs_[i].first);
+            destroyOnContact(world, pairs_[i].second);
+        }
+        stats_.contacts = events_.size();
+    }
+
+    const char* GetName() const override { return "CollisionSystem"; }
+
+    /**
+     * @brief 直近の更新で接触した組
+     */
+    const std::vector<CollisionEvent>& Events() const { return events_; }
+
+    const Statistics& GetStatistics() const { return stats_; }
+
+private:
+    /**
+     * @struct WorldShape
+     * @brief ワールド空間に変換した形状
+     */
+    struct WorldShape {
+        Entity entity{ 0, 0 };
+        uint32_t shape = Collider::SHAPE_SPHERE;
+        uint32_t flags = 0;
+        DirectX::XMFLOAT3 center{ 0.0f, 0.0f, 0.0f };  ///< 中心
+        float radius = 0.0f;                           ///< 球・カプセルの半径
+        DirectX::XMFLOAT3 axes[3];                     ///< 箱の軸(正規化済み)
+        DirectX::XMFLOAT3 extent{ 0.0f, 0.0f, 0.0f };  ///< 箱は軸ごとの半分の大きさ、カプセルは線分の半分のベクトル
+    };
+
+    /**
+     * @struct Contact
+     * @brief 組ごとの詳細判定の結果
+     */
+    struct Contact {
+        bool hit = false;
+        DirectX::XMFLOAT3 normal{ 0.0f, 1.0f, 0.0f };
+        float depth = 0.0f;
+    };
+
+    static constexpr uint32_t NO_SHAPE = 0xFFFFFFFFu;
+    static constexpr float EPSILON = 1e-6f;
+    static constexpr int CAPSULE_BOX_ITERATIONS = 4;
+
+    void gatherShapes() {
+        shapes_.clear();
+        colliders_->ForEach([this](Entity e, LocalToWorld& ltw, Collider& collider) {
+            addShape(e, toWorld(ltw.matrix, collider));
+        });
+        bodies_->ForEach([this](Entity e, LocalToWorld& ltw, SpatialBody& body) {
+            WorldShape s;
+            s.shape = Collider::SHAPE_SPHERE;
+            s.center = DirectX::XMFLOAT3{ ltw.matrix._41, ltw.matrix._42, ltw.matrix._43 };
+            s.radius = body.radius;
+            addShape(e, s);
+        });
+        stats_.shapes = shapes_.size();
+    }
+
+    void addShape(Entity e, WorldShape shape) {
+        shape.entity = e;
+        if (e.id >= shapeIndex_.size()) shapeIndex_.resize(e.id + 1, NO_SHAPE);
+        shapeIndex_[e.id] = static_cast<uint32_t>(shapes_.size());
+        shapes_.push_back(shape);
+    }
+
+    const WorldShape* findShape(Entity e) const {
+        if (e.id >= shapeIndex_.size()) return nullptr;
+        const uint32_t index = shapeIndex_[e.id];
+        if (index >= shapes_.size() || shapes_[index].entity != e) return nullptr;
+        return &shapes_[index];
+    }
+
+    /**
+     * @brief ローカルの形状をワールド行列(行優先、行ベクトル規約)で変換
+     */
+    static WorldShape toWorld(const DirectX::XMFLOAT4X4& m, const Collider& collider) {
+        const DirectX::XMFLOAT3 rows[3] = { { m._11, m._12, m._13 }, { m._21, m._22, m._23 }, { m._31, m._32, m._33 } };
+        float scales[3];
+        for (int i = 0; i < 3; ++i) scales[i] = std::sqrt(dot(rows[i], rows[i]));
+
+        WorldShape s;
+        s.shape = collider.shape;
+        s.flags = collider.flags;
+        s.center = add(add(add(scale(rows[0], collider.center.x), scale(rows[1], collider.center.y)),
+                           scale(rows[2], collider.center.z)), DirectX::XMFLOAT3{ m._41, m._42, m._43 });
+        for (int i = 0; i < 3; ++i) {
+            s.axes[i] = scales[i] > EPSILON ? scale(rows[i], 1.0f / scales[i]) : DirectX::XMFLOAT3{ i == 0 ? 1.0f : 0.0f, i == 1 ? 1.0f : 0.0f, i == 2 ? 1.0f : 0.0f };
+        }
+
+        switch (collider.shape) {
+        case Collider::SHAPE_CAPSULE:
+            s.radius = collider.radius * (std::max)(scales[0], scales[2]);
+            s.extent = scale(rows[1], collider.halfHeight);
+            break;
+        case Collider::SHAPE_BOX:
+            s.extent = DirectX::XMFLOAT3{ collider.halfExtents.x * scales[0], collider.halfExtents.y * scales[1], collider.halfExtents.z * scales[2] };
+            break;
+        default:
+            s.radius = collider.radius * (std::max)((std::max)(scales[0], scales[1]), scales[2]);
+            break;
+        }
+        return s;
+    }
+
+    void destroyOnContact(World& world, Entity e) {
+        const WorldShape* shape = findShape(e);
+        if (!shape || !(shape->flags & Collider::DESTROY_ON_CONTACT)) return;
+        if (e.id >= destroyedAt_.size()) destroyedAt_.resize(e.id + 1, 0);
+        if (destroyedAt_[e.id] == destroyStamp_) return; // 同じ更新で複数の相手に触れた場合は1回だけ
+        destroyedAt_[e.id] = destroyStamp_;
+        world.DestroyEntityWithCause(e, World::Cause::Collision);
+        stats_.destroyed++;
+    }
+
+    /**
+     * @brief 1組の詳細判定(球 < カプセル < 箱 の順に並べ替えて判定し、法線の向きを戻す)
+     */
+    Contact testPair(Entity ea, Entity eb) const {
+        const WorldShape* a = findShape(ea);
+        const WorldShape* b = findShape(eb);
+        if (!a || !b) return Contact();
+
+        const bool swapped = a->shape > b->shape;
+        if (swapped) std::swap(a, b);
+
+        Contact c;
+        switch (a->shape * Collider::SHAPE_COUNT + b->shape) {
+        case Collider::SHAPE_SPHERE * Collider::SHAPE_COUNT + Collider::SHAPE_SPHERE:
+            c = sphereSphere(a->center, a->radius, b->center, b->radius);
+            break;
+        case Collider::SHAPE_SPHERE * Collider::SHAPE_COUNT + Collider::SHAPE_CAPSULE:
+            c = sphereSphere(a->center, a->radius, closestOnSegment(a->center, sub(b->center, b->extent), add(b->center, b->extent)), b->radius);
+            break;
+        case Collider::SHAPE_SPHERE * Collider::SHAPE_COUNT + Collider::SHAPE_BOX:
+            c = sphereBox(a->center, a->radius, *b);
+            break;
+        case Collider::SHAPE_CAPSULE * Collider::SHAPE_COUNT + Collider::SHAPE_CAPSULE: {
+            DirectX::XMFLOAT3 pa, pb;
+            closestSegmentSegment(sub(a->center, a->extent), add(a->center, a->extent),
+                                  sub(b->center, b->extent), add(b->center, b->extent), pa, pb);
+            c = sphereSphere(pa, a->radius, pb, b->radius);
+            break;
+        }
+        case Collider::SHAPE_CAPSULE * Collider::SHAPE_COUNT + Collider::SHAPE_BOX:
+            c = capsuleBox(*a, *b);
+            break;
+        case Collider::SHAPE_BOX * Collider::SHAPE_COUNT + Collider::SHAPE_BOX:
+            c = boxBox(*a, *b);
+            break;
+        default:
+            break;
+        }
+
+        if (swapped) c.normal = scale(c.normal, -1.0f);
+        return c;
+    }
+
+    static Contact sphereSphere(const DirectX::XMFLOAT3& ca, float ra, const DirectX::XMFLOAT3& cb, float rb) {
+        Contact c;
+        const DirectX::XMFLOAT3 d = sub(cb, ca);
+        const float distSq = dot(d, d);
+        const float r = ra + rb;
+        if (distSq > r * r) return c;
+        const float dist = std::sqrt(distSq);
+        c.hit = true;
+        c.normal = dist > EPSILON ? scale(d, 1.0f / dist) : DirectX::XMFLOAT3{ 0.0f, 1.0f, 0.0f };
+        c.depth = r - dist;
+        return c;
+    }
+
+    /**
+     * @brief 点に最も近い箱の上の点
+     * @param[out] inside 点が箱の内側にある場合 true
+     */
+    static DirectX::XMFLOAT3 closestOnBox(const DirectX::XMFLOAT3& p, const WorldShape& box, bool& inside) {
+        const DirectX::XMFLOAT3 local = sub(p, box.center);
+        const float half[3] = { box.extent.x, box.extent.y, box.extent.z };
+        DirectX::XMFLOAT3 q = box.center;
+        inside = true;
+        for (int i = 0; i < 3; ++i) {
+            float d = dot(local, box.axes[i]);
+            if (d > half[i]) { d = half[i]; inside = false; }
+            else if (d < -half[i]) { d = -half[i]; inside = false; }
+            q = add(q, scale(box.axes[i], d));
+        }
+        return q;
+    }
+
+    static Contact sphereBox(const DirectX::XMFLOAT3& center, float radius, const WorldShape& box) {
+        Contact c;
+        bool inside;
+        const DirectX::XMFLOAT3 q = closestOnBox(center, box, inside);
+        if (!inside) {
+            const DirectX::XMFLOAT3 d = sub(q, center);
+            const float distSq = dot(d, d);
+            if (distSq > radius * radius) return c;
+            const float dist = std::sqrt(distSq);
+            c.hit = true;
+            c.normal = dist > EPSILON ? scale(d, 1.0f / dist) : DirectX::XMFLOAT3{ 0.0f, 1.0f, 0.0f };
+            c.depth = radius - dist;
+            return c;
+        }
+
+        // 中心が箱の内側: 最も近い面から押し出す向き
+        const DirectX::XMFLOAT3 local = sub(center, box.center);
+        const float half[3] = { box.extent.x, box.extent.y, box.extent.z };
+        int axis = 0;
+        float best = 3.4e38f, side = 1.0f;
+        for (int i = 0; i < 3; ++i) {
+            const float d = dot(local, box.axes[i]);
+            const float gap = half[i] - std::fabs(d);
+            if (gap < best) {
+                best = gap;
+                axis = i;
+                side = d >= 0.0f ? -1.0f : 1.0f;
+            }
+        }
+        c.hit = true;
+        c.normal = scale(box.axes[axis], side);
+        c.depth = radius + best;
+        return c;
+    }
+
+    /**
+     * @brief カプセルと箱
+     *
+     * @details
+     * 線分上の最近点と箱の最近点を交互に求め、その向きを候補の軸に加えた分離軸判定を行います
+     * (カプセルの射影は線分の射影 + radius)。反復が収束していない場合、角の付近の接触は近似になります。
+     */
+    static Contact capsuleBox(const WorldShape& capsule, const WorldShape& box) {
+        const DirectX::XMFLOAT3 p0 = sub(capsule.center, capsule.extent);
+        const DirectX::XMFLOAT3 p1 = add(capsule.center, capsule.extent);
+        DirectX::XMFLOAT3 p = closestOnSegment(box.center, p0, p1);
+        DirectX::XMFLOAT3 q = p;
+        bool inside = false;
+        for (int i = 0; i < CAPSULE_BOX_ITERATIONS; ++i) {
+            q = closestOnBox(p, box, inside);
+            if (inside) break;
+            p = closestOnSegment(q, p0, p1);
+        }
+
+        // 最近点の向き、箱の3軸、線分の向きと箱の軸の外積
+        Contact c;
+        const DirectX::XMFLOAT3 d = sub(box.center, capsule.center);
+        const float hb[3] = { box.extent.x, box.extent.y, box.extent.z };
+        float best = 3.4e38f;
+        DirectX::XMFLOAT3 bestAxis{ 0.0f, 1.0f, 0.0f };
+        auto testAxis = [&](DirectX::XMFLOAT3 axis) {
+            const float lengthSq = dot(axis, axis);
+            if (lengthSq < EPSILON) return true;
+            axis = scale(axis, 1.0f / std::sqrt(lengthSq));
+            const float ra = std::fabs(dot(capsule.extent, axis)) + capsule.radius;
+            float rb = 0.0f;
+            for (int i = 0; i < 3; ++i) rb += hb[i] * std::fabs(dot(axis, box.axes[i]));
+            const float distance = dot(d, axis);
+            const float overlap = ra + rb - std::fabs(distance);
+            if (overlap < 0.0f) return false;
+            if (overlap < best) {
+                best = overlap;
+                bestAxis = distance >= 0.0f ? axis : scale(axis, -1.0f);
+            }
+            return true;
+        };
+        if (!inside && !testAxis(sub(q, p))) return c;
+        for (int i = 0; i < 3; ++i) {
+            if (!testAxis(box.axes[i]) || !testAxis(cross(capsule.extent, box.axes[i]))) return c;
+        }
+        c.hit = true;
+        c.normal = bestAxis;
+        c.depth = best;
+        return c;
+    }
+
+    /**
+     * @brief 分離軸判定(各箱の3軸と、その外積の9軸)。法線はめり込みが最小の軸
+     */
+    static Contact boxBox(const WorldShape& a, const WorldShape& b) {
+        Contact c;
+        const DirectX::XMFLOAT3 d = sub(b.center, a.center);
+        const float ha[3] = { a.extent.x, a.extent.y, a.extent.z };
+        const float hb[3] = { b.extent.x, b.extent.y, b.extent.z };
+
+        float best = 3.4e38f;
+        DirectX::XMFLOAT3 bestAxis{ 0.0f, 1.0f, 0.0f };
+        auto testAxis = [&](DirectX::XMFLOAT3 axis) {
+            const float lengthSq = dot(axis, axis);
+            if (lengthSq < EPSILON) return true; // 平行な辺の外積は判定しない
+            axis = scale(axis, 1.0f / std::sqrt(lengthSq));
+            float ra = 0.0f, rb = 0.0f;
+            for (int i = 0; i < 3; ++i) {
+                ra += ha[i] * std::fabs(dot(axis, a.axes[i]));
+                rb += hb[i] * std::fabs(dot(axis, b.axes[i]));
+            }
+            const float distance = dot(d, axis);
+            const float overlap = ra + rb - std::fabs(distance);
+            if (overlap < 0.0f) return false;
+            if (overlap < best) {
+                best = overlap;
+                bestAxis = distance >= 0.0f ? axis : scale(axis, -1.0f);
+            }
+            return true;
+        };
+
+        for (int i = 0; i < 3; ++i) {
+            if (!testAxis(a.axes[i]) || !testAxis(b.axes[i])) return c;
+        }
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                if (!testAxis(cross(a.axes[i], b.axes[j]))) return c;
+            }
+        }
+        c.hit = true;
+        c.normal = bestAxis;
+        c.depth = best;
+        return c;
+    }
+
+    static DirectX::XMFLOAT3 closestOnSegment(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) {
+        const DirectX::XMFLOAT3 ab = sub(b, a);
+        const float lengthSq = dot(ab, ab);
+        if (lengthSq < EPSILON) return a;
+        const float t = clamp01(dot(sub(p, a), ab) / lengthSq);
+        return add(a, scale(ab, t));
+    }
+
+    /**
+     * @brief 2本の線分の最近点の組
+     */
+    static void closestSegmentSegment(const DirectX::XMFLOAT3& p1, const DirectX::XMFLOAT3& q1,
+                                      const DirectX::XMFLOAT3& p2, const DirectX::XMFLOAT3& q2,
+                                      DirectX::XMFLOAT3& c1, DirectX::XMFLOAT3& c2) {
+        const DirectX::XMFLOAT3 d1 = sub(q1, p1);
+        const DirectX::XMFLOAT3 d2 = sub(q2, p2);
+        const DirectX::XMFLOAT3 r = sub(p1, p2);
+        const float a = dot(d1, d1);
+        const float e = dot(d2, d2);
+        const float f = dot(d2, r);
+        float s = 0.0f, t = 0.0f;
+
+        if (a <= EPSILON && e <= EPSILON) {
+            s = t = 0.0f;
+        } else if (a <= EPSILON) {
+            t = clamp01(f / e);
+        } else {
+            const float cv = dot(d1, r);
+            if (e <= EPSILON) {
+                s = clamp01(-cv / a);
+            } else {
+                const float b = dot(d1, d2);
+                const float denom = a * e - b * b;
+                s = denom > EPSILON ? clamp01((b * f - cv * e) / denom) : 0.0f;
+                t = (b * s + f) / e;
+                if (t < 0.0f) {
+                    t = 0.0f;
+                    s = clamp01(-cv / a);
+                } else if (t > 1.0f) {
+                    t = 1.0f;
+                    s = clamp01((b - cv) / a);
+                }
+            }
+        }
+        c1 = add(p1, scale(d1, s));
+        c2 = add(p2, scale(d2, t));
+    }
+
+    static float clamp01(float v) { return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v); }
+    static float dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    static DirectX::XMFLOAT3 add(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) { return DirectX::XMFLOAT3{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+    static DirectX::XMFLOAT3 sub(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) { return DirectX::XMFLOAT3{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+    static DirectX::XMFLOAT3 scale(const DirectX::XMFLOAT3& a, float s) { return DirectX::XMFLOAT3{ a.x * s, a.y * s, a.z * s }; }
+    static DirectX::XMFLOAT3 cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) {
+        return DirectX::XMFLOAT3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    SpatialHashGrid* grid_ = nullptr;
+    QueryView<LocalToWorld, Collider>* colliders_ = nullptr;
+    QueryView<LocalToWorld, SpatialBody>* bodies_ = nullptr;
+    EventChannel<CollisionEvent>* channel_ = nullptr;  ///< 接触の送信先
+    std::vector<WorldShape> shapes_;                   ///< 今回の形状(ワールド空間)
+    std::vector<uint32_t> shapeIndex_;                 ///< エンティティID -> shapes_ の位置
+    std::vector<std::pair<Entity, Entity>> pairs_;     ///< ブロードフェーズの組
+    std::vector<Contact> results_;                     ///< pairs_ と同順の詳細判定の結果
+    std::vector<CollisionEvent> events_;               ///< 今回の接触
+    std::vector<uint32_t> destroyedAt_;                ///< エンティティIDごとに破棄を予約した更新番号
+    uint32_t destroyStamp_ = 0;
+    Statistics stats_;
+};
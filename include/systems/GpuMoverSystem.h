@@ -0,0 +1,204 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Transform.h"
+#include "components/GpuMover.h"
+#include "graphics/GpuMovers.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file GpuMoverSystem.h
+ * @brief GpuMover のエンティティにGPUのバッファ上の位置(スロット)を割り当て、RenderSystem へ送るシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 毎ステップ行うのは次の3つだけで、GPUに置いたエンティティを1体ずつ積分することはありません。
+ * - 固定ステップの経過を GpuMoverChannel に積む(積分は RenderSystem がまとめて行う)
+ * - 追加された GpuMover(Added フィルタ)にスロットを割り当てて初期状態を積む
+ * - GpuMover の数が割り当て済みのスロット数と合わない場合だけ全体を走査し、
+ *   破棄・Remove されたエンティティのスロットを解放する
+ * - GpuReadback を持つエンティティの書き戻しの要求を更新し、届いた結果を Transform に反映する
+ *
+ * スロットの持ち主はエンティティのハンドルで確認するため、プール(スリープ)からの再利用や
+ * スナップショットの読み込みでスロット番号ごと複写された GpuMover も新しく割り当て直します。
+ */
+
+/**
+ * @class GpuMoverSystem
+ * @brief GpuMover のスロットの管理と書き戻し
+ *
+ * @par 使用例
+ * @code
+ * world.AddSystem<GpuMoverSystem>(renderer.GpuMoverQueue());
+ * @endcode
+ */
+class GpuMoverSystem : public System<Write<Transform>, Write<GpuMover>, Read<GpuReadback>> {
+public:
+    explicit GpuMoverSystem(GpuMoverChannel& channel) : channel_(channel) {}
+
+    void OnCreate(World& world) override {
+        movers_ = &world.Query<Transform, GpuMover>();
+        readbacks_ = &world.Query<Transform, GpuMover>(With<GpuReadback>());
+    }
+
+    void OnUpdate(World& world, float dt) override {
+        spawnedCount_ = 0;
+        freedCount_ = 0;
+
+        // 前回の実行と同じティックのうちに追加された分も含めるため、1つ前のティックから
+        const uint32_t since = addedSince_;
+        addedSince_ = world.GetChangeTick() - 1;
+        movers_->ForEach(Added<GpuMover>(since), [&](Entity e, Transform& t, GpuMover& m) {
+            if (!owns(e, m)) spawn(e, t, m);
+        });
+        if (movers_->Size() != liveCount_) sweep();
+        if (dt > 0.0f && liveCount_ > 0) channel_.Step(dt);
+
+        // 書き戻し(届いた結果を反映してから、今の対象で要求を更新する)
+        channel_.TakeResults(results_);
+        for (const GpuMoverResult& result : results_) {
+            // 読み出しの後に破棄・Remove されたエンティティには書かない
+            const GpuMover* m = world.Peek<GpuMover>(result.entity);
+            if (!m || !owns(result.entity, *m)) continue;
+            Transform* t = world.TryGet<Transform>(result.entity);
+            if (!t) continue;
+            ApplyState(result.state, *t);
+        }
+
+        requests_.clear();
+        readbacks_->ForEach([&](Entity e, Transform&, GpuMover& m) {
+            if (owns(e, m)) requests_.push_back(GpuMoverReadback{ e, m.slot });
+        });
+        if (requests_.size() != sentRequests_ || !std::equal(requests_.begin(), requests_.end(), lastRequests_.begin(), sameRequest)) {
+            channel_.SetReadbacks(requests_);
+            lastRequests_ = requests_;
+            sentRequests_ = requests_.size();
+        }
+    }
+
+    const char* GetName() const override { return "GpuMoverSystem"; }
+
+    size_t GetLiveCount() const { return liveCount_; }
+    size_t GetSpawnedCount() const { return spawnedCount_; }
+    size_t GetFreedCount() const { return freedCount_; }
+
+    /**
+     * @brief Transform と GpuMover からGPUに置く初期状態を作る
+     */
+    static GpuMoverState MakeState(const Transform& t, const GpuMover& m) {
+        GpuMoverState s{};
+        s.position = t.position;
+        s.velocity = m.velocity;
+        s.acceleration = m.acceleration;
+        s.drag = m.drag > 0.0f ? m.drag : 0.0f;
+        s.rotationSpeed = DirectX::XMConvertToRadians(m.rotationSpeedDegY);
+        s.scale = t.scale;
+        s.bounceExtent = m.bounceExtent > 0.0f ? m.bounceExtent : 0.0f;
+        if (t.useQuaternion) {
+            s.rotation = t.orientation;
+            s.angle = 0.0f;
+        } else {
+            // RollPitchYaw(x, y, z) = RollPitchYaw(x, 0, z) の後に Y 軸回りに y
+            DirectX::XMStoreFloat4(&s.rotation, DirectX::XMQuaternionRotationRollPitchYaw(
+                DirectX::XMConvertToRadians(t.rotation.x), 0.0f, DirectX::XMConvertToRadians(t.rotation.z)));
+            s.angle = DirectX::XMConvertToRadians(t.rotation.y);
+        }
+        const auto toByte = [](float c) { return static_cast<uint32_t>((c < 0.0f ? 0.0f : c > 1.0f ? 1.0f : c) * 255.0f + 0.5f); };
+        s.color = toByte(m.color.x) | (toByte(m.color.y) << 8) | (toByte(m.color.z) << 16) | (255u << 24);
+        return s;
+    }
+
+    /**
+     * @brief 読み出した状態を Transform に書き戻す(位置と向き)
+     */
+    static void ApplyState(const GpuMoverState& s, Transform& t) {
+        t.position = s.position;
+        if (t.useQuaternion) {
+            const DirectX::XMVECTOR yaw = DirectX::XMQuaternionRotationRollPitchYaw(0.0f, s.angle, 0.0f);
+            DirectX::XMStoreFloat4(&t.orientation, DirectX::XMQuaternionMultiply(DirectX::XMLoadFloat4(&s.rotation), yaw));
+        } else {
+            float degrees = std::fmod(DirectX::XMConvertToDegrees(s.angle), 360.0f);
+            if (degrees < 0.0f) degrees += 360.0f;
+            t.rotation.y = degrees;
+        }
+    }
+
+private:
+    static bool sameRequest(const GpuMoverReadback& a, const GpuMoverReadback& b) {
+        return a.entity == b.entity && a.slot == b.slot;
+    }
+
+    bool owns(Entity e, const GpuMover& m) const {
+        return m.slot < slotOwners_.size() && slotOwners_[m.slot] == e;
+    }
+
+    void spawn(Entity e, const Transform& t, GpuMover& m) {
+        m.slot = allocate(e);
+        channel_.Spawn(m.slot, m.meshType, MakeState(t, m));
+        ++spawnedCount_;
+    }
+
+    // 割り当て済みのスロットに印を付け、持ち主のいないものを新しく割り当て、印のないスロットを解放する
+    // (破棄・Remove、追加と同時の増減など、数が合わなくなった場合だけ)
+    void sweep() {
+        ++sweepIndex_;
+        movers_->ForEach([&](Entity e, Transform& t, GpuMover& m) {
+            if (owns(e, m)) {
+                slotSweeps_[m.slot] = sweepIndex_;
+                return;
+            }
+            spawn(e, t, m);
+        });
+        for (uint32_t slot = 0; slot < slotOwners_.size(); ++slot) {
+            if (!(slotOwners_[slot] == Entity{}) && slotSweeps_[slot] != sweepIndex_) {
+                slotOwners_[slot] = Entity{};
+                freeSlots_.push_back(slot);
+                channel_.Free(slot);
+                --liveCount_;
+                ++freedCount_;
+            }
+        }
+    }
+
+    uint32_t allocate(Entity e) {
+        uint32_t slot;
+        if (!freeSlots_.empty()) {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slotOwners_.size());
+            slotOwners_.push_back(Entity{});
+            slotSweeps_.push_back(0);
+        }
+        slotOwners_[slot] = e;
+        slotSweeps_[slot] = sweepIndex_;
+        ++liveCount_;
+        return slot;
+    }
+
+    GpuMoverChannel& channel_;
+    QueryView<Transform, GpuMover>* movers_ = nullptr;
+    QueryView<Transform, GpuMover>* readbacks_ = nullptr;
+
+    std::vector<Entity> slotOwners_;       ///< スロット -> 持ち主(Entity{} は空き)
+    std::vector<uint32_t> slotSweeps_;     ///< スロットに最後に印を付けた走査の番号
+    std::vector<uint32_t> freeSlots_;
+    size_t liveCount_ = 0;
+    uint32_t sweepIndex_ = 0;
+    uint32_t addedSince_ = 0;              ///< 次の Added<GpuMover> の since
+
+    std::vector<GpuMoverResult> results_;
+    std::vector<GpuMoverReadback> requests_;
+    std::vector<GpuMoverReadback> lastRequests_;
+    size_t sentRequests_ = 0;
+
+    size_t spawnedCount_ = 0;
+    size_t freedCount_ = 0;
+};
@@ -1,43 +1,130 @@
 /**
  * @file ModelLoadingSystem.h
  * @brief Loads Model components into renderable data.
+ *
+ * @details
+ * Models are requested through ResourceManager::GetModelAsync, so the import runs on
+ * worker threads and ModelComponent is attached on the frame the load completes.
+ * When ResourceManager hot-reloads a model file, entities built from the old generation
+ * drop their ModelComponent and ModelPart children and are rebuilt from the new load.
+ *
+ * When the simulation runs concurrently with rendering, GetModelAsync is called under
+ * GfxDevice::ResourceMutex() because it touches TextureManager; the lock is only taken
+ * on frames where some Model still has to be resolved.
+ *
+ * Skinned models get an Animator (playing the first clip) on the Model entity and a
+ * SkinPose on every skinned mesh entity; AnimationSystem fills the poses each step.
  */
 #pragma once
 
 #include "ecs/World.h"
 #include "components/Model.h"
+#include "components/Animator.h"
 #include "components/Component.h"
 #include "components/ModelComponent.h"
+#include "components/MeshRenderer.h"
 #include "components/Transform.h"
+#include "systems/TransformSystem.h"
 #include "app/ServiceLocator.h"
 #include "app/ResourceManager.h"
+#include "graphics/GfxDevice.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 struct ModelLoadingSystem : public Behaviour {
     void OnUpdate(World& world, Entity self, float dt) override {
         auto& resMgr = ServiceLocator::Get<ResourceManager>();
 
+        // Generations are only compared on frames after some model was reloaded.
+        const bool reloaded = resMgr.GetReloadCount() != lastReloadCount_;
+        lastReloadCount_ = resMgr.GetReloadCount();
+        std::vector<Entity> stale;
+        std::unique_lock<std::mutex> resourceLock(ServiceLocator::Get<GfxDevice>().ResourceMutex(), std::defer_lock);
+
         world.ForEach<Model>([&](Entity entity, Model& model) {
             if (world.Has<ModelComponent>(entity)) {
+                if (reloaded && resMgr.GetModelGeneration(model.filePath) != model.generation) {
+                    stale.push_back(entity);
+                }
+                return;
+            }
+
+            if (!resourceLock.owns_lock()) resourceLock.lock();
+            const std::vector<ModelComponent>* loaded = nullptr;
+            ResourceManager::LoadState state = resMgr.GetModelAsync(model.filePath, loaded);
+            if (state == ResourceManager::LoadState::Loading) {
+                if (model.showPlaceholder && !world.Has<MeshRenderer>(entity)) {
+                    MeshRenderer placeholder;
+                    placeholder.color = DirectX::XMFLOAT3{ 0.5f, 0.5f, 0.5f };
+                    world.Add<MeshRenderer>(entity, placeholder);
+                    world.Add<ModelPlaceholder>(entity);
+                }
                 return;
             }
 
-            const auto& components = resMgr.GetModel(model.filePath);
-            if (components.empty()) {
+            if (world.Has<ModelPlaceholder>(entity)) {
+                world.Remove<MeshRenderer>(entity);
+                world.Remove<ModelPlaceholder>(entity);
+            }
+
+            if (state == ResourceManager::LoadState::Failed || !loaded || loaded->empty()) {
                 world.Remove<Model>(entity);
                 return;
             }
 
+            const auto& components = *loaded;
+            model.generation = resMgr.GetModelGeneration(model.filePath);
             world.Add<ModelComponent>(entity, components[0]);
 
             for (size_t i = 1; i < components.size(); ++i) {
+                // Child meshes share the parent's placement (identity local transform).
                 Entity child = world.Create()
-                    .With<Transform>()
+                    .With<Transform>(DirectX::XMFLOAT3{0, 0, 0})
                     .With<ModelComponent>(components[i])
+                    .With<ModelPart>(ModelPart{ entity })
                     .Build();
-                // TODO: Relate child transform to parent.
-                static_cast<void>(child);
+                TransformSystem::SetParent(world, child, entity);
+                if (components[i].skinData) world.Add<SkinPose>(child);
             }
+            attachAnimator(world, entity, components);
         });
+
+        if (!stale.empty()) {
+            rebuild(world, stale);
+        }
     }
+
+private:
+    // Adds the Animator to the root when any mesh of the model is skinned.
+    static void attachAnimator(World& world, Entity root, const std::vector<ModelComponent>& components) {
+        for (const ModelComponent& mesh : components) {
+            if (!mesh.skinData) continue;
+            Animator animator;
+            animator.data = mesh.skinData;
+            animator.clip = mesh.skinData->clips.empty() ? Animator::NO_CLIP : 0;
+            world.Add<Animator>(root, animator);
+            world.Add<SkinPose>(root);
+            return;
+        }
+    }
+
+    // Removes the old meshes; the next update attaches the reloaded ones.
+    // Parts are children of their root, so only the stale roots' children are visited.
+    static void rebuild(World& world, const std::vector<Entity>& roots) {
+        for (Entity root : roots) {
+            world.ForEachChild(root, [&](Entity child) {
+                const ModelPart* part = world.Peek<ModelPart>(child);
+                if (part && part->root == root) world.DestroyEntity(child);
+            });
+            world.Remove<ModelComponent>(root);
+            if (world.Has<Animator>(root)) {
+                world.Remove<Animator>(root);
+                world.Remove<SkinPose>(root);
+            }
+        }
+    }
+
+    uint32_t lastReloadCount_ = 0;
 };
 
@@ -0,0 +1,162 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Transform.h"
+#include "components/GameComponents.h"
+#include "components/TransformColumns.h"
+#include <DirectXMath.h>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file MovementSystem.h
+ * @brief Velocity を Transform に積分するシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform と Velocity を持つエンティティを、クエリの密配列の順に1回の走査で進めます。
+ * Behaviour の OnUpdate と違い、エンティティごとの仮想呼び出しや TryGet による検索はありません。
+ * 1エンティティの計算は DirectXMath のベクトル演算(加速度・抵抗・位置の更新)で行い、
+ * 対象が多い場合は World::ParallelForEach でワーカーに分割します。
+ * SetColumnLayout(true) の間は、位置・速度・加速度を TransformColumns の列(8 要素ブロック)に集めて
+ * ブロック単位で積分し、書き戻します(結果は要素ごとの計算と同じです)。
+ */
+
+/**
+ * @class MovementSystem
+ * @brief 速度・加速度・抵抗による移動(半陰的オイラー法)
+ *
+ * @details
+ * 1ステップの更新は次のとおりです(dt は固定ステップ)。
+ * - velocity += acceleration * dt
+ * - velocity /= 1 + drag * dt(drag が正の場合)
+ * - position += velocity * dt
+ *
+ * 移動の後、DespawnBelow を持つエンティティは高さを判定して破棄を予約します。
+ * TransformSystem より先に登録すると、同じステップの行列に移動が反映されます。
+ *
+ * @par 使用例
+ * @code
+ * world.AddSystem<MovementSystem>();
+ * world.AddSystem<TransformSystem>();
+ *
+ * world.Create()
+ *     .With<Transform>(DirectX::XMFLOAT3{0, 5, 0})
+ *     .With<Velocity>(DirectX::XMFLOAT3{0, -2, 0})
+ *     .With<DespawnBelow>(-10.0f)
+ *     .Build();
+ * @endcode
+ */
+class MovementSystem : public System<Write<Transform>, Write<Velocity>, Read<DespawnBelow>> {
+public:
+    static constexpr size_t GRAIN_SIZE = 1024; ///< 並列化する場合の1ジョブあたりのエンティティ数
+
+    void OnCreate(World& world) override {
+        movers_ = &world.Query<Transform, Velocity>();
+        despawners_ = &world.Query<Transform, DespawnBelow>();
+    }
+
+    void OnUpdate(World& world, float dt) override {
+        movedCount_ = 0;
+        despawnedCount_ = 0;
+        if (dt <= 0.0f) return;
+
+        if (!movers_->Empty()) {
+            if (columnLayout_) {
+                integrateColumns(dt);
+            } else {
+                world.ParallelForEach<Transform, Velocity>([dt](Entity, Transform& t, Velocity& v) {
+                    Integrate(t, v, dt);
+                }, GRAIN_SIZE);
+            }
+            movedCount_ = movers_->Size();
+        }
+
+        despawners_->ForEach([&](Entity e, Transform& t, DespawnBelow& limit) {
+            if (t.position.y >= limit.y) return;
+            world.DestroyEntityWithCause(e, World::Cause::LifetimeExpired);
+            ++despawnedCount_;
+        });
+    }
+
+    const char* GetName() const override { return "MovementSystem"; }
+
+    /**
+     * @brief 積分を列(SoA)に並べ替えて行うか(既定 false)
+     *
+     * @details
+     * 並べ替えと書き戻しはメインスレッドで行うため、計算が積分だけの間は要素ごとの並列実行と大差ありません。
+     * 列に集めた後の処理(ブロック単位の計算)を増やす場合の土台です。
+     */
+    void SetColumnLayout(bool enabled) { columnLayout_ = enabled; }
+    bool IsColumnLayout() const { return columnLayout_; }
+
+    /**
+     * @brief 直近の更新で移動したエンティティ数
+     */
+    size_t MovedCount() const { return movedCount_; }
+
+    /**
+     * @brief 直近の更新で DespawnBelow により破棄を予約した数
+     */
+    size_t DespawnedCount() const { return despawnedCount_; }
+
+    /**
+     * @brief 1エンティティ分の積分
+     */
+    static void Integrate(Transform& t, Velocity& v, float dt) {
+        using namespace DirectX;
+        const XMVECTOR step = XMVectorReplicate(dt);
+        XMVECTOR velocity = XMVectorMultiplyAdd(XMLoadFloat3(&v.acceleration), step, XMLoadFloat3(&v.velocity));
+        if (v.drag > 0.0f) {
+            velocity = XMVectorScale(velocity, 1.0f / (1.0f + v.drag * dt));
+        }
+        XMStoreFloat3(&v.velocity, velocity);
+        XMStoreFloat3(&t.position, XMVectorMultiplyAdd(velocity, step, XMLoadFloat3(&t.position)));
+    }
+
+private:
+    // Integrate() と同じ計算を 8 要素ブロック単位で行う
+    void integrateColumns(float dt) {
+        columns_.Begin();
+        velocitySources_.clear();
+        movers_->ForEach([this](Entity, Transform& t, Velocity& v) {
+            columns_.Add(t);
+            velocitySources_.push_back(&v);
+        });
+        columns_.Gather(TransformColumns::POSITION);
+
+        const size_t count = velocitySources_.size();
+        velocity_.Resize(count);
+        acceleration_.Resize(count);
+        dragFactor_.assign(velocity_.BlockCount() * Float3Columns::LANES, 1.0f);
+        for (size_t i = 0; i < count; ++i) {
+            const Velocity& v = *velocitySources_[i];
+            velocity_[i] = v.velocity;
+            acceleration_[i] = v.acceleration;
+            if (v.drag > 0.0f) dragFactor_[i] = 1.0f / (1.0f + v.drag * dt);
+        }
+
+        velocity_.MultiplyAdd(acceleration_, dt);
+        velocity_.MultiplyPerElement(dragFactor_.data());
+        columns_.position.MultiplyAdd(velocity_, dt);
+
+        columns_.Scatter(TransformColumns::POSITION);
+        for (size_t i = 0; i < count; ++i) {
+            velocitySources_[i]->velocity = velocity_.Get(i);
+        }
+    }
+
+    QueryView<Transform, Velocity>* movers_ = nullptr;
+    QueryView<Transform, DespawnBelow>* despawners_ = nullptr;
+    size_t movedCount_ = 0;
+    size_t despawnedCount_ = 0;
+    bool columnLayout_ = false;
+    TransformColumns columns_;                 ///< 位置の列(SetColumnLayout(true) の間)
+    Float3Columns velocity_;                   ///< 速度の列
+    Float3Columns acceleration_;               ///< 加速度の列
+    std::vector<float> dragFactor_;            ///< 1 / (1 + drag * dt)(抵抗なしは 1)
+    std::vector<Velocity*> velocitySources_;   ///< 速度の書き戻し先
+};
@@ -0,0 +1,202 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Transform.h"
+#include "components/MeshRenderer.h"
+#include "components/ScriptInstance.h"
+#include "gameplay/ScriptVM.h"
+#include "util/Random.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file ScriptSystem.h
+ * @brief ScriptInstance を持つエンティティを、スクリプトごとにまとめてバッチで実行するシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 毎ステップ、Transform と ScriptInstance を持つエンティティをスクリプトの番号ごとに並べ、
+ * ScriptProgram::BATCH_SIZE 体ずつ次の順で処理します。
+ * 1. スクリプトが使うフィールドと param / local だけをレジスタの列に集める
+ * 2. 命令列を全レーンに適用する(ScriptProgram::Execute)
+ * 3. スクリプトが書いたフィールドと param / local を書き戻す
+ *
+ * エンティティごとの仮想関数の呼び出しやコンポーネントの検索はなく、命令の解釈はバッチごとに1回です。
+ * color を使うスクリプトだけ MeshRenderer を引き(ない場合は読み 1・書き込みなし)、書いた場合は変更を記録します。
+ * destroy されたエンティティはすべてのスクリプトを実行した後にまとめて破棄します。
+ */
+
+/**
+ * @class ScriptSystem
+ * @brief スクリプトのバッチ実行
+ *
+ * @par 使用例
+ * @code
+ * world.AddSystem<ScriptSystem>(scripts);  // MovementSystem の後、TransformSystem の前
+ * @endcode
+ */
+class ScriptSystem : public System<Write<Transform>, Write<MeshRenderer>, Write<ScriptInstance>> {
+public:
+    explicit ScriptSystem(ScriptLibrary& library) : library_(library) {}
+
+    void OnCreate(World& world) override {
+        scripted_ = &world.Query<Transform, ScriptInstance>();
+        registers_.assign(static_cast<size_t>(ScriptProgram::MAX_REGISTERS) * ScriptProgram::BATCH_SIZE, 0.0f);
+    }
+
+    void OnUpdate(World& world, float dt) override {
+        executedCount_ = 0;
+        batchCount_ = 0;
+        library_.PollReload();
+        if (scripted_->Empty()) return;
+        time_ += dt;
+
+        // スクリプトごとに並べる(並びが変わった・未初期化のものは既定値に戻す)
+        for (Group& group : groups_) {
+            group.lanes.clear();
+            group.starting.clear();
+        }
+        if (groups_.size() < library_.Size()) groups_.resize(library_.Size());
+        scripted_->ForEach([&](Entity e, Transform& t, ScriptInstance& s) {
+            const ScriptProgram* program = library_.Get(s.script);
+            if (!program) return;
+            if (s.layout != program->layout) library_.Reset(s);
+            MeshRenderer* mr = program->UsesColor() ? world.TryGet<MeshRenderer>(e) : nullptr;
+            Group& group = groups_[s.script];
+            group.lanes.push_back(Lane{ e, &t, &s, mr });
+            if (!s.started) group.starting.push_back(Lane{ e, &t, &s, mr });
+        });
+
+        destroyed_.clear();
+        for (size_t id = 0; id < groups_.size(); ++id) {
+            Group& group = groups_[id];
+            if (group.lanes.empty()) continue;
+            const ScriptProgram& program = *library_.Get(static_cast<ScriptLibrary::ScriptId>(id));
+            loadConstants(program, dt);
+            if (!group.starting.empty()) {
+                run(program, program.start, group.starting);
+                for (Lane& lane : group.starting) lane.instance->started = 1;
+            }
+            run(program, program.update, group.lanes);
+            executedCount_ += group.lanes.size();
+        }
+
+        for (Entity e : destroyed_) {
+            world.DestroyEntity(e);
+        }
+    }
+
+    const char* GetName() const override { return "ScriptSystem"; }
+
+    size_t ExecutedCount() const { return executedCount_; }
+    size_t BatchCount() const { return batchCount_; }
+
+private:
+    struct Lane {
+        Entity entity;
+        Transform* transform;
+        ScriptInstance* instance;
+        MeshRenderer* renderer;   ///< color を使うスクリプトのみ(なければ nullptr)
+    };
+
+    struct Group {
+        std::vector<Lane> lanes;      ///< このスクリプトのエンティティ
+        std::vector<Lane> starting;   ///< このステップで start を実行するもの
+    };
+
+    float* reg(uint32_t index) { return registers_.data() + static_cast<size_t>(index) * ScriptProgram::BATCH_SIZE; }
+
+    // 定数・dt・time はスクリプトの間で書き換わらないので、スクリプトごとに1回だけ埋める
+    void loadConstants(const ScriptProgram& program, float dt) {
+        std::fill_n(reg(ScriptProgram::REG_DT), ScriptProgram::BATCH_SIZE, dt);
+        std::fill_n(reg(ScriptProgram::REG_TIME), ScriptProgram::BATCH_SIZE, time_);
+        for (size_t k = 0; k < program.constants.size(); ++k) {
+            std::fill_n(reg(static_cast<uint32_t>(ScriptProgram::CONST_BASE + k)), ScriptProgram::BATCH_SIZE, program.constants[k]);
+        }
+    }
+
+    void run(const ScriptProgram& program, const std::vector<ScriptInstruction>& code, const std::vector<Lane>& lanes) {
+        if (code.empty()) return;
+        const size_t slotCount = program.slotNames.size();
+        for (size_t begin = 0; begin < lanes.size(); begin += ScriptProgram::BATCH_SIZE) {
+            const uint32_t count = static_cast<uint32_t>((std::min)(lanes.size() - begin, static_cast<size_t>(ScriptProgram::BATCH_SIZE)));
+            const Lane* batch = lanes.data() + begin;
+
+            for (uint32_t field = 0; field < static_cast<uint32_t>(ScriptField::COUNT); ++field) {
+                if (program.gatherFields & (1u << field)) gather(field, batch, count);
+            }
+            for (size_t s = 0; s < slotCount; ++s) {
+                float* column = reg(static_cast<uint32_t>(ScriptProgram::SLOT_BASE + s));
+                for (uint32_t i = 0; i < count; ++i) column[i] = batch[i].instance->slots[s];
+            }
+            if (program.destroys) std::fill_n(reg(ScriptProgram::REG_DESTROY), count, 0.0f);
+
+            ScriptProgram::Execute(code, registers_.data(), count, rng_);
+            ++batchCount_;
+
+            for (uint32_t field = 0; field < static_cast<uint32_t>(ScriptField::COUNT); ++field) {
+                if (program.writeFields & (1u << field)) scatter(field, batch, count);
+            }
+            for (size_t s = 0; s < slotCount; ++s) {
+                const float* column = reg(static_cast<uint32_t>(ScriptProgram::SLOT_BASE + s));
+                for (uint32_t i = 0; i < count; ++i) batch[i].instance->slots[s] = column[i];
+            }
+            if (program.destroys) {
+                const float* flags = reg(ScriptProgram::REG_DESTROY);
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (flags[i] != 0.0f) destroyed_.push_back(batch[i].entity);
+                }
+            }
+        }
+    }
+
+    // フィールドの値のアドレス(color は MeshRenderer がない場合 nullptr)
+    static float* fieldPointer(uint32_t field, const Lane& lane) {
+        switch (static_cast<ScriptField>(field)) {
+        case ScriptField::PosX: return &lane.transform->position.x;
+        case ScriptField::PosY: return &lane.transform->position.y;
+        case ScriptField::PosZ: return &lane.transform->position.z;
+        case ScriptField::RotX: return &lane.transform->rotation.x;
+        case ScriptField::RotY: return &lane.transform->rotation.y;
+        case ScriptField::RotZ: return &lane.transform->rotation.z;
+        case ScriptField::ScaleX: return &lane.transform->scale.x;
+        case ScriptField::ScaleY: return &lane.transform->scale.y;
+        case ScriptField::ScaleZ: return &lane.transform->scale.z;
+        case ScriptField::ColorR: return lane.renderer ? &lane.renderer->color.x : nullptr;
+        case ScriptField::ColorG: return lane.renderer ? &lane.renderer->color.y : nullptr;
+        case ScriptField::ColorB: return lane.renderer ? &lane.renderer->color.z : nullptr;
+        default: return nullptr;
+        }
+    }
+
+    void gather(uint32_t field, const Lane* batch, uint32_t count) {
+        float* column = reg(field);
+        for (uint32_t i = 0; i < count; ++i) {
+            const float* value = fieldPointer(field, batch[i]);
+            column[i] = value ? *value : 1.0f;
+        }
+    }
+
+    void scatter(uint32_t field, const Lane* batch, uint32_t count) {
+        const float* column = reg(field);
+        for (uint32_t i = 0; i < count; ++i) {
+            float* value = fieldPointer(field, batch[i]);
+            if (value) *value = column[i];
+        }
+    }
+
+    ScriptLibrary& library_;
+    QueryView<Transform, ScriptInstance>* scripted_ = nullptr;
+    std::vector<Group> groups_;          ///< スクリプトの番号ごと
+    std::vector<float> registers_;       ///< MAX_REGISTERS 本の列(BATCH_SIZE 個ずつ)
+    std::vector<Entity> destroyed_;
+    util::Rng rng_{ 0x5C41u };
+    float time_ = 0.0f;
+
+    size_t executedCount_ = 0;
+    size_t batchCount_ = 0;
+};
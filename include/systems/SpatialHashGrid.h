@@ -0,0 +1,409 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Transform.h"
+#include "components/SpatialBody.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @file SpatialHashGrid.h
+ * @brief 一様グリッドによる近傍検索とブロードフェーズ
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * Transform と SpatialBody を持つエンティティを、Transform::position を含むセルに登録します。
+ * セルは座標をキーとするハッシュで管理するため、ワールドの広さに関係なく使ったセルの分だけメモリを使います。
+ * 更新ではセルが変わったエンティティだけを付け替え、セル内の位置・半径は上書きするだけです。
+ */
+
+/**
+ * @class SpatialHashGrid
+ * @brief 空間ハッシュグリッド(Transform と SpatialBody を読むシステム)
+ *
+ * @details
+ * 検索は登録時にコピーした位置と半径だけを見るため、World のコンポーネントには触れません。
+ * 半径がセルより大きい球は中心のセルにだけ登録し、検索範囲を最大半径の分だけ広げて拾います。
+ *
+ * - QueryRadius / QueryAABB: 範囲に重なる球の列挙(範囲が覆うセルだけを調べる)
+ * - ForEachPair: 重なっている組の列挙。セルごとに自分と「前方」の隣接セル(3x3x3 なら13個)だけを
+ *   調べるため、各組は一度だけ、全体で O(N) になります
+ *
+ * @par 使用例
+ * @code
+ * SpatialHashGrid& grid = world.AddSystem<SpatialHashGrid>(4.0f);
+ *
+ * // Behaviour から(前の World::Tick の時点の位置で検索)
+ * std::vector<Entity> nearby;
+ * grid.QueryRadius(t->position, 3.0f, nearby);
+ *
+ * grid.ForEachPair([&](Entity a, Entity b) {
+ *     // 敵と弾など、layer / mask が合う重なった組
+ * });
+ * @endcode
+ *
+ * @note 内容は直近の OnUpdate() の時点のものです。破棄されたエンティティは次の更新まで残るため、
+ *       必要に応じて World::IsAlive() で確認してください
+ * @note OnUpdate() と同時に検索しないでください(同じステージで並列に動くシステムからの検索など)
+ */
+class SpatialHashGrid : public System<Read<Transform>, Read<SpatialBody>> {
+public:
+    static constexpr float DEFAULT_CELL_SIZE = 4.0f; ///< 既定のセルの一辺
+
+    /**
+     * @struct Item
+     * @brief セルに登録された球(登録時の値のコピー)
+     */
+    struct Item {
+        Entity entity;              ///< エンティティ
+        DirectX::XMFLOAT3 position; ///< 球の中心(Transform::position)
+        float radius;               ///< 球の半径
+        uint32_t layer;             ///< SpatialBody::layer
+        uint32_t mask;              ///< SpatialBody::mask
+    };
+
+    /**
+     * @struct Statistics
+     * @brief 直近の更新の統計
+     */
+    struct Statistics {
+        size_t bodies = 0;       ///< 登録されている球の数
+        size_t cells = 0;        ///< 使用中のセルの数
+        size_t inserted = 0;     ///< 新しく登録した数
+        size_t removed = 0;      ///< 登録を外した数(破棄・SpatialBody の削除)
+        size_t cellChanges = 0;  ///< セルを付け替えた数
+    };
+
+    /**
+     * @brief コンストラクタ
+     * @param[in] cellSize セルの一辺(典型的な球の直径の2倍程度が目安)
+     */
+    explicit SpatialHashGrid(float cellSize = DEFAULT_CELL_SIZE)
+        : cellSize_((std::max)(cellSize, 0.001f)), invCellSize_(1.0f / cellSize_) {}
+
+    void OnCreate(World& world) override {
+        bodies_ = &world.Query<Transform, SpatialBody>();
+    }
+
+    void OnUpdate(World&, float) override {
+        ++stamp_;
+        stats_.inserted = 0;
+        stats_.removed = 0;
+        stats_.cellChanges = 0;
+
+        float maxRadius = 0.0f;
+        bodies_->ForEach([this, &maxRadius](Entity e, Transform& t, SpatialBody& body) {
+            sync(e, t.position, body);
+            maxRadius = (std::max)(maxRadius, body.radius);
+        });
+        removeUnseen();
+
+        maxRadius_ = maxRadius;
+        setReach(static_cast<int>(std::ceil(2.0f * maxRadius_ * invCellSize_)));
+        stats_.cells = lookup_.size();
+    }
+
+    const char* GetName() const override { return "SpatialHashGrid"; }
+
+    /**
+     * @brief 中心 center、半径 radius の球に重なる球を列挙
+     * @param[out] out 見つかったエンティティを追加する(クリアしない)
+     */
+    void QueryRadius(const DirectX::XMFLOAT3& center, float radius, std::vector<Entity>& out) const {
+        ForEachInRadius(center, radius, [&out](const Item& item) { out.push_back(item.entity); });
+    }
+
+    /**
+     * @brief 球に重なる球ごとに fn(const Item&) を呼ぶ
+     */
+    template<class F>
+    void ForEachInRadius(const DirectX::XMFLOAT3& center, float radius, F&& fn) const {
+        const float reach = radius + maxRadius_;
+        const DirectX::XMFLOAT3 lo{ center.x - reach, center.y - reach, center.z - reach };
+        const DirectX::XMFLOAT3 hi{ center.x + reach, center.y + reach, center.z + reach };
+        forEachCellInRange(lo, hi, [&](const Cell& cell) {
+            for (const Item& item : cell.items) {
+                const float dx = item.position.x - center.x;
+                const float dy = item.position.y - center.y;
+                const float dz = item.position.z - center.z;
+                const float r = radius + item.radius;
+                if (dx * dx + dy * dy + dz * dz <= r * r) fn(item);
+            }
+        });
+    }
+
+    /**
+     * @brief 軸平行ボックス [minPoint, maxPoint] に重なる球を列挙
+     * @param[out] out 見つかったエンティティを追加する(クリアしない)
+     */
+    void QueryAABB(const DirectX::XMFLOAT3& minPoint, const DirectX::XMFLOAT3& maxPoint, std::vector<Entity>& out) const {
+        ForEachInAABB(minPoint, maxPoint, [&out](const Item& item) { out.push_back(item.entity); });
+    }
+
+    /**
+     * @brief ボックスに重なる球ごとに fn(const Item&) を呼ぶ
+     */
+    template<class F>
+    void ForEachInAABB(const DirectX::XMFLOAT3& minPoint, const DirectX::XMFLOAT3& maxPoint, F&& fn) const {
+        const DirectX::XMFLOAT3 lo{ minPoint.x - maxRadius_, minPoint.y - maxRadius_, minPoint.z - maxRadius_ };
+        const DirectX::XMFLOAT3 hi{ maxPoint.x + maxRadius_, maxPoint.y + maxRadius_, maxPoint.z + maxRadius_ };
+        forEachCellInRange(lo, hi, [&](const Cell& cell) {
+            for (const Item& item : cell.items) {
+                // ボックス内で球の中心に最も近い点までの距離
+                const float dx = item.position.x - (std::min)((std::max)(item.position.x, minPoint.x), maxPoint.x);
+                const float dy = item.position.y - (std::min)((std::max)(item.position.y, minPoint.y), maxPoint.y);
+                const float dz = item.position.z - (std::min)((std::max)(item.position.z, minPoint.z), maxPoint.z);
+                if (dx * dx + dy * dy + dz * dz <= item.radius * item.radius) fn(item);
+            }
+        });
+    }
+
+    /**
+     * @brief 重なっている組ごとに fn(Entity a, Entity b) を呼ぶ(各組は一度だけ)
+     *
+     * @details
+     * 互いの layer が相手の mask に含まれる組だけを返します。
+     * 同じセルの中の組と、前方の隣接セルとの組だけを調べます。
+     */
+    template<class F>
+    void ForEachPair(F&& fn) const {
+        for (const auto& entry : lookup_) {
+            const Cell& cell = cells_[entry.second];
+            const auto& items = cell.items;
+
+            for (size_t i = 0; i < items.size(); ++i) {
+                for (size_t j = i + 1; j < items.size(); ++j) {
+                    if (overlaps(items[i], items[j])) fn(items[i].entity, items[j].entity);
+                }
+            }
+
+            for (const CellCoord& offset : forwardOffsets_) {
+                auto it = lookup_.find(keyOf(CellCoord{ cell.coord.x + offset.x, cell.coord.y + offset.y, cell.coord.z + offset.z }));
+                if (it == lookup_.end()) continue;
+                const auto& others = cells_[it->second].items;
+                for (const Item& a : items) {
+                    for (const Item& b : others) {
+                        if (overlaps(a, b)) fn(a.entity, b.entity);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 重なっている組をすべて集める
+     * @param[out] out 組を追加する(クリアしない)
+     */
+    void FindPairs(std::vector<std::pair<Entity, Entity>>& out) const {
+        ForEachPair([&out](Entity a, Entity b) { out.emplace_back(a, b); });
+    }
+
+    float CellSize() const { return cellSize_; }
+    size_t BodyCount() const { return stats_.bodies; }
+    const Statistics& GetStatistics() const { return stats_; }
+
+private:
+    static constexpr uint32_t NO_CELL = 0xFFFFFFFFu;
+
+    /**
+     * @struct CellCoord
+     * @brief セルの整数座標
+     */
+    struct CellCoord {
+        int32_t x, y, z;
+    };
+
+    /**
+     * @struct Cell
+     * @brief 1セル分の球(空になったセルは配列を残したまま再利用)
+     */
+    struct Cell {
+        uint64_t key = 0;
+        CellCoord coord{ 0, 0, 0 };
+        std::vector<Item> items;
+    };
+
+    /**
+     * @struct Slot
+     * @brief エンティティIDごとの登録先
+     */
+    struct Slot {
+        Entity entity{};          ///< 登録しているエンティティ(ID の再利用を見分ける)
+        uint32_t cell = NO_CELL;  ///< cells_ の位置
+        uint32_t index = 0;       ///< Cell::items の位置
+        uint32_t seen = 0;        ///< 最後に見つかった更新番号
+    };
+
+    CellCoord cellOf(const DirectX::XMFLOAT3& p) const {
+        return CellCoord{ static_cast<int32_t>(std::floor(p.x * invCellSize_)),
+                          static_cast<int32_t>(std::floor(p.y * invCellSize_)),
+                          static_cast<int32_t>(std::floor(p.z * invCellSize_)) };
+    }
+
+    // 各軸 21 ビットに詰める(±100万セルの範囲で一意)
+    static uint64_t keyOf(const CellCoord& c) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(c.x) & 0x1FFFFFu) << 42) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(c.y) & 0x1FFFFFu) << 21) |
+               static_cast<uint64_t>(static_cast<uint32_t>(c.z) & 0x1FFFFFu);
+    }
+
+    static bool overlaps(const Item& a, const Item& b) {
+        if (!(a.layer & b.mask) || !(b.layer & a.mask)) return false;
+        const float dx = a.position.x - b.position.x;
+        const float dy = a.position.y - b.position.y;
+        const float dz = a.position.z - b.position.z;
+        const float r = a.radius + b.radius;
+        return dx * dx + dy * dy + dz * dz <= r * r;
+    }
+
+    // 範囲が覆うセルを列挙(使用中のセルより多い場合は使用中のセルを直接調べる)
+    template<class F>
+    void forEachCellInRange(const DirectX::XMFLOAT3& lo, const DirectX::XMFLOAT3& hi, F&& fn) const {
+        const CellCoord a = cellOf(lo);
+        const CellCoord b = cellOf(hi);
+        const double span = static_cast<double>(b.x - a.x + 1) * (b.y - a.y + 1) * (b.z - a.z + 1);
+        if (span > static_cast<double>(lookup_.size())) {
+            for (const auto& entry : lookup_) {
+                const Cell& cell = cells_[entry.second];
+                if (cell.coord.x >= a.x && cell.coord.x <= b.x && cell.coord.y >= a.y && cell.coord.y <= b.y &&
+                    cell.coord.z >= a.z && cell.coord.z <= b.z) {
+                    fn(cell);
+                }
+            }
+            return;
+        }
+
+        for (int32_t x = a.x; x <= b.x; ++x) {
+            for (int32_t y = a.y; y <= b.y; ++y) {
+                for (int32_t z = a.z; z <= b.z; ++z) {
+                    auto it = lookup_.find(keyOf(CellCoord{ x, y, z }));
+                    if (it != lookup_.end()) fn(cells_[it->second]);
+                }
+            }
+        }
+    }
+
+    // 1エンティティ分を反映(同じセルなら値の上書きだけ)
+    void sync(Entity e, const DirectX::XMFLOAT3& position, const SpatialBody& body) {
+        if (e.id >= slots_.size()) slots_.resize(static_cast<size_t>(e.id) + 1);
+        Slot& slot = slots_[e.id];
+        const CellCoord coord = cellOf(position);
+        const uint64_t key = keyOf(coord);
+        const Item item{ e, position, body.radius, body.layer, body.mask };
+
+        if (slot.cell != NO_CELL) {
+            if (slot.entity == e && cells_[slot.cell].key == key) {
+                cells_[slot.cell].items[slot.index] = item;
+                slot.seen = stamp_;
+                return;
+            }
+            if (slot.entity == e) {
+                ++stats_.cellChanges;
+            } else {
+                ++stats_.removed; // 同じ ID の破棄済みエンティティ
+            }
+            detach(slot);
+        } else {
+            ++stats_.inserted;
+        }
+
+        const uint32_t cellIndex = acquireCell(key, coord);
+        Cell& cell = cells_[cellIndex];
+        slot.entity = e;
+        slot.cell = cellIndex;
+        slot.index = static_cast<uint32_t>(cell.items.size());
+        slot.seen = stamp_;
+        cell.items.push_back(item);
+    }
+
+    // 今回の更新で見つからなかった球を外す
+    void removeUnseen() {
+        size_t bodies = 0;
+        for (size_t c = 0; c < cells_.size(); ++c) {
+            auto& items = cells_[c].items;
+            for (size_t i = 0; i < items.size();) {
+                Slot& slot = slots_[items[i].entity.id];
+                if (slot.seen == stamp_ && slot.entity == items[i].entity) {
+                    ++i;
+                    continue;
+                }
+                ++stats_.removed;
+                detach(slot); // 末尾が i に移るので i は進めない
+            }
+            bodies += items.size();
+        }
+        stats_.bodies = bodies;
+    }
+
+    // セルから外す(末尾と入れ替え、空になったセルは解放)
+    void detach(Slot& slot) {
+        const uint32_t cellIndex = slot.cell;
+        auto& items = cells_[cellIndex].items;
+        const Item last = items.back();
+        items[slot.index] = last;
+        slots_[last.entity.id].index = slot.index;
+        items.pop_back();
+        slot.cell = NO_CELL;
+        if (items.empty()) {
+            lookup_.erase(cells_[cellIndex].key);
+            freeCells_.push_back(cellIndex);
+        }
+    }
+
+    uint32_t acquireCell(uint64_t key, const CellCoord& coord) {
+        auto it = lookup_.find(key);
+        if (it != lookup_.end()) return it->second;
+
+        uint32_t index;
+        if (!freeCells_.empty()) {
+            index = freeCells_.back();
+            freeCells_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(cells_.size());
+            cells_.emplace_back();
+        }
+        cells_[index].key = key;
+        cells_[index].coord = coord;
+        lookup_.emplace(key, index);
+        return index;
+    }
+
+    // 組の検索で調べる前方の隣接セル(半径がセルの半分を超える場合は範囲を広げる)
+    void setReach(int reach) {
+        reach = (std::max)(reach, 1);
+        if (reach == reach_) return;
+        reach_ = reach;
+        forwardOffsets_.clear();
+        for (int32_t x = -reach; x <= reach; ++x) {
+            for (int32_t y = -reach; y <= reach; ++y) {
+                for (int32_t z = -reach; z <= reach; ++z) {
+                    // (0,0,0) より辞書順で後ろのものだけ(逆向きの組は相手のセルから見つかる)
+                    if (x > 0 || (x == 0 && (y > 0 || (y == 0 && z > 0)))) {
+                        forwardOffsets_.push_back(CellCoord{ x, y, z });
+                    }
+                }
+            }
+        }
+    }
+
+    QueryView<Transform, SpatialBody>* bodies_ = nullptr; ///< 登録対象
+    float cellSize_;                                       ///< セルの一辺
+    float invCellSize_;                                    ///< 1 / cellSize_
+    float maxRadius_ = 0.0f;                               ///< 登録中の球の最大半径(検索範囲の拡張量)
+    int reach_ = 0;                                        ///< 組の検索で調べる隣接セルの距離
+    uint32_t stamp_ = 0;                                   ///< 更新番号
+    std::vector<Cell> cells_;                              ///< セル(解放済みを含む)
+    std::vector<uint32_t> freeCells_;                      ///< 解放済みのセルの位置
+    std::unordered_map<uint64_t, uint32_t> lookup_;        ///< セル座標のキー → cells_ の位置
+    std::vector<Slot> slots_;                              ///< エンティティIDごとの登録先
+    std::vector<CellCoord> forwardOffsets_;                ///< 前方の隣接セルのずれ
+    Statistics stats_;                                     ///< 直近の更新の統計
+};
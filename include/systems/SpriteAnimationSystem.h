@@ -0,0 +1,209 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "ecs/CommandBuffer.h"
+#include "components/MeshRenderer.h"
+#include "components/Sprite.h"
+#include "animation/Animation.h"
+#include <DirectXMath.h>
+#include <cstddef>
+
+/**
+ * @file SpriteAnimationSystem.h
+ * @brief SpriteAnimation / SpriteSheetAnimation / UVAnimation をまとめて進めるシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * アニメーションの種類ごとに、MeshRenderer(3D)または Sprite(SpriteBatch の2D)と一緒に持つエンティティを
+ * クエリの密配列の順に1回の走査で進め、結果を同じエンティティの描画コンポーネントに直接書き込みます。
+ * 1つのエンティティは MeshRenderer と Sprite のどちらか一方だけを持ってください(両方あると2回進みます)。
+ * Behaviour の OnUpdate と違い、エンティティごとの仮想呼び出しや TryGet による検索はありません。
+ * 対象が多い場合は World::ParallelForEach でワーカーに分割します。
+ *
+ * - SpriteAnimation: フレームが変わったときだけ texture を書き換える
+ * - SpriteSheetAnimation: フレームが変わったときだけ texture / uvOffset / uvScale を書き換える
+ * - UVAnimation: currentOffset を進めて [0, 1) に折り返し(fmodf ではなく floor の差)、uvOffset に書き込む(MeshRenderer のみ)
+ *
+ * 停止中(playing が false)・再生の終わったスプライトアニメーションは、表示中のフレームを反映した後に
+ * コンポーネントを無効化し(コマンドバッファ経由で World::SetEnabled)、次のステップから走査しません。
+ * 再開は Play() で行います(再生状態を戻してコンポーネントを有効化)。
+ */
+
+/**
+ * @class SpriteAnimationSystem
+ * @brief スプライト・UVスクロールアニメーションの一括更新
+ *
+ * @par 使用例
+ * @code
+ * world.AddSystem<SpriteAnimationSystem>();
+ *
+ * SpriteAnimation anim;
+ * anim.frames = { tex1, tex2, tex3, tex4 };
+ * anim.frameTime = 0.1f;
+ * world.Create().With<Transform>().With<MeshRenderer>().With<SpriteAnimation>(anim).Build();
+ *
+ * world.Create().With<Sprite>().With<SpriteAnimation>(anim).Build();   // HUD のアイコン
+ *
+ * SpriteAnimationSystem::Stop<SpriteAnimation>(world, entity);  // 一時停止(走査の対象外になる)
+ * SpriteAnimationSystem::Play<SpriteAnimation>(world, entity);  // 再開
+ * @endcode
+ */
+class SpriteAnimationSystem
+    : public System<Write<SpriteAnimation>, Write<SpriteSheetAnimation>, Write<UVAnimation>, Write<MeshRenderer>, Write<Sprite>> {
+public:
+    static constexpr size_t GRAIN_SIZE = 2048; ///< 並列化する場合の1ジョブあたりのエンティティ数(1体あたりの処理が軽いため大きい)
+
+    void OnCreate(World& world) override {
+        sprites_ = &world.Query<SpriteAnimation, MeshRenderer>();
+        sheets_ = &world.Query<SpriteSheetAnimation, MeshRenderer>();
+        scrolls_ = &world.Query<UVAnimation, MeshRenderer>();
+        spriteFrames_ = &world.Query<SpriteAnimation, Sprite>();
+        spriteSheets_ = &world.Query<SpriteSheetAnimation, Sprite>();
+    }
+
+    void OnUpdate(World& world, float dt) override {
+        animatedCount_ = 0;
+
+        animatedCount_ += Animate<SpriteAnimation, MeshRenderer>(world, *sprites_, dt);
+        animatedCount_ += Animate<SpriteSheetAnimation, MeshRenderer>(world, *sheets_, dt);
+        animatedCount_ += Animate<SpriteAnimation, Sprite>(world, *spriteFrames_, dt);
+        animatedCount_ += Animate<SpriteSheetAnimation, Sprite>(world, *spriteSheets_, dt);
+
+        if (!scrolls_->Empty()) {
+            world.ParallelForEach<UVAnimation, MeshRenderer>([dt](Entity, UVAnimation& uv, MeshRenderer& renderer) {
+                Scroll(uv, dt);
+                renderer.uvOffset = uv.currentOffset;
+            }, GRAIN_SIZE);
+            animatedCount_ += scrolls_->Size();
+        }
+    }
+
+    const char* GetName() const override { return "SpriteAnimationSystem"; }
+
+    /**
+     * @brief 直近の更新で走査したアニメーションの数(無効化されたものは含まない)
+     */
+    size_t AnimatedCount() const { return animatedCount_; }
+
+    /**
+     * @brief 再生を再開(再生状態を戻し、無効化されていればコンポーネントを有効化)
+     * @tparam T SpriteAnimation / SpriteSheetAnimation
+     * @note 再生の終わったアニメーションを最初から再生する場合は先に T::Reset() を呼んでください
+     */
+    template<class T>
+    static void Play(World& world, Entity e) {
+        T* anim = world.TryGet<T>(e);
+        if (!anim) return;
+        anim->Play();
+        world.SetEnabled<T>(e, true);
+    }
+
+    /**
+     * @brief 再生を一時停止(現在のフレームを保持し、コンポーネントを無効化)
+     * @tparam T SpriteAnimation / SpriteSheetAnimation
+     */
+    template<class T>
+    static void Stop(World& world, Entity e) {
+        T* anim = world.TryGet<T>(e);
+        if (!anim) return;
+        anim->Stop();
+        world.SetEnabled<T>(e, false);
+    }
+
+    /**
+     * @brief 再生位置を進める
+     * @return bool 引き続き再生する場合 true(停止中・再生が終わった場合 false)
+     *
+     * @details
+     * dt が複数フレーム分の場合は除算1回でまとめて進めます。
+     * ループしない場合は最後のフレームで止め、finished を立てます。
+     */
+    template<class T>
+    static bool Advance(T& anim, float dt) {
+        const size_t count = anim.frames.size();
+        if (!anim.playing || count == 0) return false;
+
+        anim.currentTime += dt;
+        if (anim.currentTime < anim.frameTime) return true;
+
+        size_t steps = 1;
+        if (anim.frameTime > 0.0f) {
+            steps = static_cast<size_t>(anim.currentTime / anim.frameTime);
+            anim.currentTime -= static_cast<float>(steps) * anim.frameTime;
+        } else {
+            anim.currentTime = 0.0f;
+        }
+
+        size_t next = anim.currentFrame + steps;
+        if (next >= count) {
+            if (anim.loop) {
+                next %= count;
+            } else {
+                next = count - 1;
+                anim.playing = false;
+                anim.finished = true;
+            }
+        }
+        anim.currentFrame = next;
+        return anim.playing;
+    }
+
+    /**
+     * @brief 表示するフレームのテクスチャを描画コンポーネントに書き込む
+     * @tparam R MeshRenderer / Sprite(texture を持つ型)
+     */
+    template<class R>
+    static void ApplyFrame(const SpriteAnimation& anim, R& renderer) {
+        renderer.texture = anim.frames[anim.currentFrame];
+    }
+
+    /**
+     * @brief 表示するフレームのアトラスと矩形を描画コンポーネントに書き込む
+     * @tparam R MeshRenderer / Sprite(texture / uvOffset / uvScale を持つ型)
+     */
+    template<class R>
+    static void ApplyFrame(const SpriteSheetAnimation& anim, R& renderer) {
+        const AtlasRect& rect = anim.frames[anim.currentFrame];
+        renderer.texture = anim.atlas;
+        renderer.uvOffset = rect.uvOffset;
+        renderer.uvScale = rect.uvScale;
+    }
+
+    /**
+     * @brief UVスクロールを進めて [0, 1) に折り返す
+     */
+    static void Scroll(UVAnimation& uv, float dt) {
+        using namespace DirectX;
+        XMVECTOR offset = XMVectorMultiplyAdd(XMLoadFloat2(&uv.scrollSpeed), XMVectorReplicate(dt), XMLoadFloat2(&uv.currentOffset));
+        offset = XMVectorSubtract(offset, XMVectorFloor(offset));
+        XMStoreFloat2(&uv.currentOffset, offset);
+    }
+
+private:
+    /**
+     * @brief アニメーションを進め、フレームが変わったものだけ描画コンポーネントに反映
+     * @return size_t 走査したエンティティ数
+     */
+    template<class A, class R>
+    static size_t Animate(World& world, QueryView<A, R>& view, float dt) {
+        if (view.Empty()) return 0;
+        world.ParallelForEach<A, R>([&world, dt](Entity e, A& anim, R& renderer) {
+            const bool active = Advance(anim, dt);
+            if (anim.currentFrame != anim.appliedFrame && !anim.frames.empty()) {
+                ApplyFrame(anim, renderer);
+                anim.appliedFrame = anim.currentFrame;
+            }
+            if (!active) world.GetCommandBuffer().SetEnabled<A>(e, false);
+        }, GRAIN_SIZE);
+        return view.Size();
+    }
+
+    QueryView<SpriteAnimation, MeshRenderer>* sprites_ = nullptr;
+    QueryView<SpriteSheetAnimation, MeshRenderer>* sheets_ = nullptr;
+    QueryView<UVAnimation, MeshRenderer>* scrolls_ = nullptr;
+    QueryView<SpriteAnimation, Sprite>* spriteFrames_ = nullptr;
+    QueryView<SpriteSheetAnimation, Sprite>* spriteSheets_ = nullptr;
+    size_t animatedCount_ = 0;
+};
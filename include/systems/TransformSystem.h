@@ -0,0 +1,258 @@
+#pragma once
+#include "ecs/World.h"
+#include "ecs/System.h"
+#include "components/Transform.h"
+#include "components/TransformHierarchy.h"
+#include "app/DebugLog.h"
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file TransformSystem.h
+ * @brief ワールド行列の計算と親子階層の伝播を行うシステム
+ * @author 山内陽
+ * @date 2025
+ * @version 1.1
+ *
+ * @details
+ * Transform を持つエンティティに LocalToWorld を追加し、Transform が変わったノードと
+ * その子孫だけ行列を再計算します。階層は親から子へ幅優先(深さごとの平坦な配列)で処理するため、
+ * 行列演算は変更のあったノードごとに1回になり、描画ごとの再計算は不要になります。
+ * 子は World の親子関係(先頭の子・次の兄弟のリンク)でたどるため、ノードごとの走査は子の数だけです。
+ *
+ * 再計算したノードには直前の行列(LocalToWorld::previous)と更新番号(movedStep)を残します。
+ * 固定ステップで更新する場合、描画は最後の更新で動いたノードだけ previous と matrix の間を補間します。
+ */
+
+/**
+ * @class TransformSystem
+ * @brief LocalToWorld を更新する排他システム
+ *
+ * @details
+ * LocalToWorld / Parent の追加・削除を伴うため、アクセス宣言なし(排他)で実行します。
+ * 変更検出は LocalToWorld::source との比較で行うので、ForEach の参照経由で
+ * Transform を書き換えた場合も検出されます。
+ *
+ * @par 使用例
+ * @code
+ * world.AddSystem<TransformSystem>();
+ *
+ * Entity body = world.Create().With<Transform>().Build();
+ * Entity arm = world.Create().With<Transform>(DirectX::XMFLOAT3{1, 0, 0}).Build();
+ * TransformSystem::SetParent(world, arm, body); // arm の Transform は body からの相対値になる
+ * @endcode
+ *
+ * @note 親を破棄しても子は破棄されません。子は次の更新でルートに戻ります(子孫ごと破棄するには World::DestroyRecursive())
+ * @note World::SetParent() だけで設定した子(Parent なし)は所有関係のみで、Transform は継承しません
+ */
+class TransformSystem : public System<> {
+public:
+    static constexpr size_t MAX_DEPTH = 64; ///< 階層の最大深さ(循環検出用)
+
+    void OnCreate(World& world) override {
+        uncached_ = &world.Query<Transform>(Without<LocalToWorld>());
+        roots_ = &world.Query<Transform, LocalToWorld>(Without<Parent>());
+        links_ = &world.Query<Parent>();
+    }
+
+    void OnUpdate(World& world, float) override {
+        ++stepCount_;
+        updatedCount_ = 0;
+        attachCaches(world);
+        syncLinks(world);
+        updateRoots(world);
+        propagate(world);
+    }
+
+    const char* GetName() const override { return "TransformSystem"; }
+
+    /**
+     * @brief 直近の更新で行列を再計算したノード数
+     */
+    size_t UpdatedCount() const { return updatedCount_; }
+
+    /**
+     * @brief これまでの更新回数(最後の更新で動いたノードは LocalToWorld::movedStep がこの値になる)
+     */
+    uint32_t StepCount() const { return stepCount_; }
+
+    /**
+     * @brief 次の更新で補間を行わずに新しい位置へ移す(ワープ・リスポーンなど)
+     */
+    static void ResetInterpolation(World& world, Entity e) {
+        invalidate(world, e);
+    }
+
+    /**
+     * @brief ローカル行列(S * R * T)を計算
+     */
+    static DirectX::XMMATRIX ComputeLocalMatrix(const Transform& t) {
+        return t.ToMatrix();
+    }
+
+    /**
+     * @brief 親子関係を設定(既存の親からは外す)
+     * @param[in,out] world ゲームワールド
+     * @param[in] child 子エンティティ
+     * @param[in] parent 親エンティティ
+     * @return bool 設定できた場合 true(無効なエンティティや循環になる場合 false)
+     */
+    static bool SetParent(World& world, Entity child, Entity parent) {
+        if (!world.SetParent(child, parent)) {
+            DEBUGLOG_WARNING("TransformSystem::SetParent() - 無効な親子指定または循環 (子ID: " + std::to_string(child.id) +
+                             ", 親ID: " + std::to_string(parent.id) + ")");
+            return false;
+        }
+
+        if (Parent* link = world.TryGet<Parent>(child)) {
+            link->entity = parent;
+        } else {
+            world.Add<Parent>(child, Parent{ parent });
+        }
+        invalidate(world, child);
+        return true;
+    }
+
+    /**
+     * @brief 親子関係を解除(子はルートになる)
+     */
+    static void ClearParent(World& world, Entity child) {
+        if (!world.Has<Parent>(child)) return;
+        world.ClearParent(child);
+        world.Remove<Parent>(child);
+        invalidate(world, child);
+    }
+
+private:
+    /**
+     * @struct Node
+     * @brief 幅優先走査の1要素
+     */
+    struct Node {
+        Entity entity;                    ///< 処理するエンティティ
+        const LocalToWorld* parentMatrix; ///< 親の計算済み行列(コンポーネントのアドレスは安定)
+        bool parentDirty;                 ///< 親の行列がこの更新で変わったか
+    };
+
+    static bool sameFloat3(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    static bool sameTransform(const Transform& a, const Transform& b) {
+        if (a.useQuaternion != b.useQuaternion) return false;
+        bool sameRotation = a.useQuaternion
+            ? (a.orientation.x == b.orientation.x && a.orientation.y == b.orientation.y &&
+               a.orientation.z == b.orientation.z && a.orientation.w == b.orientation.w)
+            : sameFloat3(a.rotation, b.rotation);
+        return sameRotation && sameFloat3(a.position, b.position) && sameFloat3(a.scale, b.scale);
+    }
+
+    static void invalidate(World& world, Entity e) {
+        LocalToWorld* cache = world.TryGet<LocalToWorld>(e);
+        if (cache) cache->valid = false;
+    }
+
+    // 直前の行列を previous に残して更新(初回と ResetInterpolation 後は補間しない)
+    void storeMatrix(LocalToWorld& cache, const DirectX::XMMATRIX& matrix) {
+        if (cache.valid) {
+            cache.previous = cache.matrix;
+            DirectX::XMStoreFloat4x4(&cache.matrix, matrix);
+        } else {
+            DirectX::XMStoreFloat4x4(&cache.matrix, matrix);
+            cache.previous = cache.matrix;
+        }
+        cache.movedStep = stepCount_;
+        cache.valid = true;
+    }
+
+    // Transform だけを持つエンティティに LocalToWorld を追加
+    void attachCaches(World& world) {
+        pending_.clear();
+        uncached_->ForEach([this](Entity e, Transform&) { pending_.push_back(e); });
+        for (Entity e : pending_) {
+            world.Add<LocalToWorld>(e);
+        }
+    }
+
+    // Parent と World の親子関係を合わせる(親が破棄された子はルートに戻し、移動・復元で失われたリンクは張り直す)
+    void syncLinks(World& world) {
+        pending_.clear();
+        links_->ForEach([this, &world](Entity e, Parent& p) {
+            if (world.GetParent(e) != p.entity) pending_.push_back(e);
+        });
+        for (Entity e : pending_) {
+            const Entity parent = world.Peek<Parent>(e)->entity;
+            if (!world.IsAlive(parent) || !world.SetParent(e, parent)) {
+                world.ClearParent(e);
+                world.Remove<Parent>(e);
+            }
+            invalidate(world, e);
+        }
+    }
+
+    void updateRoots(World& world) {
+        frontier_.clear();
+        roots_->ForEach([this, &world](Entity e, Transform& t, LocalToWorld& cache) {
+            bool dirty = !cache.valid || !sameTransform(t, cache.source);
+            if (dirty) {
+                storeMatrix(cache, ComputeLocalMatrix(t));
+                cache.source = t;
+                world.MarkChanged<LocalToWorld>(e);
+                ++updatedCount_;
+            }
+            enqueueChildren(world, e, &cache, dirty, frontier_);
+        });
+    }
+
+    // 深さごとに親の行列を子へ伝播
+    void propagate(World& world) {
+        size_t depth = 0;
+        while (!frontier_.empty()) {
+            if (++depth > MAX_DEPTH) {
+                if (!depthWarned_) {
+                    DEBUGLOG_WARNING("TransformSystem - 階層が最大深さ(" + std::to_string(MAX_DEPTH) + ")を超えたため伝播を打ち切りました");
+                    depthWarned_ = true;
+                }
+                break;
+            }
+
+            next_.clear();
+            for (const Node& node : frontier_) {
+                const Transform* t = world.Peek<Transform>(node.entity);
+                const LocalToWorld* cached = world.Peek<LocalToWorld>(node.entity);
+                if (!t || !cached) continue;
+
+                bool dirty = node.parentDirty || !cached->valid || !sameTransform(*t, cached->source);
+                if (dirty) {
+                    LocalToWorld* cache = world.TryGet<LocalToWorld>(node.entity); // 変更ティックを記録
+                    DirectX::XMMATRIX parentWorld = DirectX::XMLoadFloat4x4(&node.parentMatrix->matrix);
+                    storeMatrix(*cache, DirectX::XMMatrixMultiply(ComputeLocalMatrix(*t), parentWorld));
+                    cache->source = *t;
+                    ++updatedCount_;
+                }
+                enqueueChildren(world, node.entity, cached, dirty, next_);
+            }
+            frontier_.swap(next_);
+        }
+    }
+
+    // Transform を継承する子(Parent を持つもの)を out に追加
+    void enqueueChildren(World& world, Entity parent, const LocalToWorld* parentMatrix, bool parentDirty, std::vector<Node>& out) {
+        world.ForEachChild(parent, [&](Entity child) {
+            if (world.Has<Parent>(child)) out.push_back(Node{ child, parentMatrix, parentDirty });
+        });
+    }
+
+    QueryView<Transform>* uncached_ = nullptr;                 ///< LocalToWorld 未追加のエンティティ
+    QueryView<Transform, LocalToWorld>* roots_ = nullptr;      ///< 親を持たないエンティティ
+    QueryView<Parent>* links_ = nullptr;                       ///< 親を持つエンティティ
+    std::vector<Entity> pending_;                              ///< 走査後に構造変更するエンティティ
+    std::vector<Node> frontier_;                               ///< 現在の深さのノード
+    std::vector<Node> next_;                                   ///< 次の深さのノード
+    size_t updatedCount_ = 0;                                  ///< 直近の再計算数
+    uint32_t stepCount_ = 0;                                   ///< 更新回数(LocalToWorld::movedStep と比較)
+    bool depthWarned_ = false;                                 ///< 深さ超過の警告済みか
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @file Lz4.h
+ * @brief LZ4 ブロック形式の圧縮・展開(外部ライブラリなし)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * LZ4 のブロック形式(フレームヘッダなし)と互換のデータを読み書きします。
+ * 圧縮は 4バイトのハッシュ表による貪欲法で、参照ライブラリの高速モードより圧縮率はやや劣りますが、
+ * 出力は公式の LZ4_decompress_safe で展開できます。
+ * 展開は入力・出力の範囲をすべて検査するため、壊れたデータでも範囲外を読み書きしません。
+ */
+
+namespace util {
+
+class Lz4 {
+public:
+    /**
+     * @brief 圧縮後の最大サイズ(圧縮できないデータでもこのサイズに収まる)
+     */
+    static size_t CompressBound(size_t size) { return size + size / 255 + 16; }
+
+    /**
+     * @brief src を圧縮して out の末尾に追加
+     * @return size_t 追加したバイト数
+     */
+    static size_t Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+        const size_t start = out.size();
+        out.resize(start + CompressBound(size));
+        uint8_t* dst = out.data() + start;
+        uint8_t* op = dst;
+
+        const uint8_t* ip = src;
+        const uint8_t* anchor = src;
+        const uint8_t* const end = src + size;
+
+        // 最後の5バイトは必ずリテラル、最後の一致は終端の12バイトより前で始める(ブロック形式の規則)
+        if (size >= MF_LIMIT) {
+            const uint8_t* const matchLimit = end - LAST_LITERALS;
+            const uint8_t* const searchLimit = end - MF_LIMIT;
+            std::vector<uint32_t> table(HASH_SIZE, 0);
+
+            ++ip;
+            while (ip <= searchLimit) {
+                const uint32_t sequence = read32(ip);
+                uint32_t& slot = table[hash(sequence)];
+                const uint8_t* ref = src + slot;
+                slot = static_cast<uint32_t>(ip - src);
+
+                if (ref >= ip || ip - ref > MAX_DISTANCE || read32(ref) != sequence) {
+                    ++ip;
+                    continue;
+                }
+
+                // 一致を前後に伸ばす
+                while (ip > anchor && ref > src && ip[-1] == ref[-1]) { --ip; --ref; }
+                const uint8_t* matchEnd = ip + MIN_MATCH;
+                const uint8_t* refEnd = ref + MIN_MATCH;
+                while (matchEnd < matchLimit && *matchEnd == *refEnd) { ++matchEnd; ++refEnd; }
+
+                op = writeSequence(op, anchor, static_cast<size_t>(ip - anchor),
+                                   static_cast<uint16_t>(ip - ref), static_cast<size_t>(matchEnd - ip));
+                ip = matchEnd;
+                anchor = ip;
+                if (ip - 2 > src && ip - 2 <= searchLimit) {
+                    table[hash(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+                }
+            }
+        }
+
+        op = writeLiterals(op, anchor, static_cast<size_t>(end - anchor));
+        const size_t written = static_cast<size_t>(op - dst);
+        out.resize(start + written);
+        return written;
+    }
+
+    /**
+     * @brief 圧縮データを展開
+     * @param[in] src 圧縮データ
+     * @param[in] size 圧縮データのサイズ
+     * @param[out] dst 展開先
+     * @param[in] capacity 展開先のサイズ
+     * @return size_t 展開したバイト数(データが壊れている場合 0)
+     */
+    static size_t Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+        const uint8_t* ip = src;
+        const uint8_t* const end = src + size;
+        uint8_t* op = dst;
+        uint8_t* const opEnd = dst + capacity;
+
+        while (ip < end) {
+            const uint8_t token = *ip++;
+
+            size_t literals = token >> 4;
+            if (literals == 15 && !readLength(ip, end, literals)) return 0;
+            if (literals > static_cast<size_t>(end - ip) || literals > static_cast<size_t>(opEnd - op)) return 0;
+            std::memcpy(op, ip, literals);
+            ip += literals;
+            op += literals;
+
+            // 最後のシーケンスはリテラルだけ
+            if (ip == end) break;
+
+            if (end - ip < 2) return 0;
+            const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst)) return 0;
+
+            size_t match = token & 15;
+            if (match == 15 && !readLength(ip, end, match)) return 0;
+            match += MIN_MATCH;
+            if (match > static_cast<size_t>(opEnd - op)) return 0;
+
+            // 重なりのある一致(offset < match)があるため1バイトずつ複写する
+            const uint8_t* ref = op - offset;
+            for (size_t i = 0; i < match; ++i) op[i] = ref[i];
+            op += match;
+        }
+        return static_cast<size_t>(op - dst);
+    }
+
+private:
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr size_t LAST_LITERALS = 5;
+    static constexpr size_t MF_LIMIT = 12;
+    static constexpr ptrdiff_t MAX_DISTANCE = 65535;
+    static constexpr uint32_t HASH_BITS = 12;
+    static constexpr size_t HASH_SIZE = size_t(1) << HASH_BITS;
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t hash(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    static uint8_t* writeLength(uint8_t* op, size_t length) {
+        while (length >= 255) {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = static_cast<uint8_t>(length);
+        return op;
+    }
+
+    static bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+        uint8_t b;
+        do {
+            if (ip >= end) return false;
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+        return true;
+    }
+
+    static uint8_t* writeSequence(uint8_t* op, const uint8_t* literals, size_t literalCount, uint16_t offset, size_t matchLength) {
+        const size_t match = matchLength - MIN_MATCH;
+        uint8_t* token = op++;
+        *token = static_cast<uint8_t>(((literalCount >= 15 ? 15 : literalCount) << 4) | (match >= 15 ? 15 : match));
+        if (literalCount >= 15) op = writeLength(op, literalCount - 15);
+        std::memcpy(op, literals, literalCount);
+        op += literalCount;
+        *op++ = static_cast<uint8_t>(offset & 0xFF);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        if (match >= 15) op = writeLength(op, match - 15);
+        return op;
+    }
+
+    static uint8_t* writeLiterals(uint8_t* op, const uint8_t* literals, size_t literalCount) {
+        *op++ = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+        if (literalCount >= 15) op = writeLength(op, literalCount - 15);
+        std::memcpy(op, literals, literalCount);
+        return op + literalCount;
+    }
+};
+
+} // namespace util
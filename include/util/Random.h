@@ -9,9 +9,13 @@
  * 使い方はシンプルで、`Random::Float(min, max)` や `Random::Int(min, max)` を呼ぶだけです。
  * 必要に応じて `Random::Seed(seed)` でシード固定も可能です（リプレイ再現などに便利）。
  *
- * - スレッドローカルな `std::mt19937` を内部で使用
+ * - スレッドローカルな `util::Rng`（xoshiro128**）を内部で使用
  * - 追加コストなしで安全に複数箇所から利用可能
  * - C++14対応（ヘッダオンリー）
+ *
+ * 結果を再現したい場合（リプレイ、並列の生成、パーティクルなど）は、`util::Rng` を
+ * シードとストリーム番号（エンティティIDやジョブの番号など）で初期化して各自で持ちます。
+ * スレッドや実行順に関係なく、同じシードとストリーム番号からは同じ列が得られます。
  */
 #pragma once
 
@@ -27,11 +31,180 @@
 
 namespace util {
 
+/**
+ * @class Rng
+ * @brief 値として持てる高速な擬似乱数生成器（xoshiro128**、状態16バイト）
+ *
+ * @details
+ * 分布オブジェクトを作らず、ビット演算と乗算だけで値を作ります。
+ * FillFloat() などのまとめて生成する関数は、4本の独立した列を構造体配列の形で同時に進め、
+ * コンパイラのベクトル化が効くようにしています。
+ *
+ * @par 使用例
+ * @code
+ * util::Rng rng(levelSeed, self.id); // 同じシード・同じエンティティなら毎回同じ列
+ * float x = rng.Float(-8.0f, 8.0f);
+ *
+ * std::vector<DirectX::XMFLOAT3> velocities(count);
+ * rng.FillVec3(velocities.data(), count, -1.0f, 1.0f);
+ * @endcode
+ */
+class Rng {
+public:
+    Rng() { Seed(0); }
+    explicit Rng(uint64_t seed, uint64_t stream = 0) { Seed(seed, stream); }
+
+    /**
+     * @brief シードとストリーム番号で初期化（異なるストリームは互いに独立した列になる）
+     */
+    void Seed(uint64_t seed, uint64_t stream = 0) {
+        uint64_t x = mix64(seed) ^ mix64(stream ^ 0x6A09E667F3BCC909ULL);
+        const uint64_t a = splitMix64(x);
+        const uint64_t b = splitMix64(x);
+        s_[0] = static_cast<uint32_t>(a);
+        s_[1] = static_cast<uint32_t>(a >> 32);
+        s_[2] = static_cast<uint32_t>(b);
+        s_[3] = static_cast<uint32_t>(b >> 32);
+        if ((s_[0] | s_[1] | s_[2] | s_[3]) == 0) s_[0] = 1; // 全て0の状態からは抜け出せない
+    }
+
+    uint32_t NextU32() {
+        const uint32_t result = rotl(s_[1] * 5u, 7) * 9u;
+        const uint32_t t = s_[1] << 9;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 11);
+        return result;
+    }
+
+    uint64_t NextU64() {
+        const uint64_t hi = NextU32();
+        return (hi << 32) | NextU32();
+    }
+
+    // [0, 1) の実数（上位24ビットを使用）
+    float Float01() { return toUnitFloat(NextU32()); }
+
+    // [min, max] の実数一様乱数
+    float Float(float minInclusive, float maxInclusive) {
+        return minInclusive + (maxInclusive - minInclusive) * Float01();
+    }
+
+    // [min, max] の整数一様乱数（乗算による範囲の縮小。偏りは範囲/2^32 以下）
+    int Int(int minInclusive, int maxInclusive) {
+        if (minInclusive > maxInclusive) std::swap(minInclusive, maxInclusive);
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(maxInclusive) - minInclusive) + 1;
+        const uint64_t offset = (static_cast<uint64_t>(NextU32()) * range) >> 32;
+        return static_cast<int>(static_cast<int64_t>(minInclusive) + static_cast<int64_t>(offset));
+    }
+
+    // true を返す確率 p（0..1）
+    bool Bool(float p = 0.5f) { return Float01() < p; }
+
+    // 正規分布 N(mean, stddev)（Box-Muller）
+    float Normal(float mean = 0.0f, float stddev = 1.0f) {
+        if (stddev <= 0.0f) return mean;
+        const float u1 = 1.0f - Float01(); // (0, 1]
+        const float u2 = Float01();
+        return mean + stddev * std::sqrt(-2.0f * std::log(u1)) * std::cos(6.28318530718f * u2);
+    }
+
+    // [0,1] の明るめカラー（0.33～1.0）
+    DirectX::XMFLOAT3 ColorBright() { return Color(0.33f, 1.0f); }
+
+    // [min,max] のカラー
+    DirectX::XMFLOAT3 Color(float minInclusive = 0.0f, float maxInclusive = 1.0f) {
+        const float r = Float(minInclusive, maxInclusive);
+        const float g = Float(minInclusive, maxInclusive);
+        const float b = Float(minInclusive, maxInclusive);
+        return DirectX::XMFLOAT3{ r, g, b };
+    }
+
+    // 一様な単位ベクトル
+    DirectX::XMFLOAT3 UnitVec3() {
+        const float z = Float(-1.0f, 1.0f);
+        const float t = Float(0.0f, 6.28318530718f); // 2π
+        const float r = std::sqrt((std::max)(0.0f, 1.0f - z * z));
+        return DirectX::XMFLOAT3{ r * std::cos(t), r * std::sin(t), z };
+    }
+
+    /**
+     * @brief [min, max] の実数を count 個まとめて生成
+     *
+     * @details
+     * この生成器から4本の列を派生させて同時に進めます（生成器自体は派生の4回分と、4で割り切れない端数の分だけ進む）。
+     * 結果は同じ状態・同じ count なら常に同じですが、Float() を count 回呼んだ結果とは異なります。
+     */
+    void FillFloat(float* out, size_t count, float minInclusive, float maxInclusive) {
+        const float scale = maxInclusive - minInclusive;
+        if (count < LANES * 4) {
+            for (size_t i = 0; i < count; ++i) out[i] = minInclusive + scale * Float01();
+            return;
+        }
+
+        // 4本の列（構造体配列）。内側のループは依存のない同じ演算なのでベクトル化される
+        uint32_t s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            Rng lane(NextU32(), l);
+            s0[l] = lane.s_[0]; s1[l] = lane.s_[1]; s2[l] = lane.s_[2]; s3[l] = lane.s_[3];
+        }
+
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES) {
+            for (size_t l = 0; l < LANES; ++l) {
+                const uint32_t result = rotl(s1[l] * 5u, 7) * 9u;
+                const uint32_t t = s1[l] << 9;
+                s2[l] ^= s0[l];
+                s3[l] ^= s1[l];
+                s1[l] ^= s2[l];
+                s0[l] ^= s3[l];
+                s2[l] ^= t;
+                s3[l] = rotl(s3[l], 11);
+                out[i + l] = minInclusive + scale * toUnitFloat(result);
+            }
+        }
+        for (; i < count; ++i) out[i] = minInclusive + scale * Float01();
+    }
+
+    // [min, max] の各成分を持つベクトルを count 個まとめて生成
+    void FillVec3(DirectX::XMFLOAT3* out, size_t count, float minInclusive, float maxInclusive) {
+        static_assert(sizeof(DirectX::XMFLOAT3) == sizeof(float) * 3, "XMFLOAT3 must be 3 packed floats");
+        FillFloat(reinterpret_cast<float*>(out), count * 3, minInclusive, maxInclusive);
+    }
+
+    // ColorBright() を count 個まとめて生成
+    void FillColorBright(DirectX::XMFLOAT3* out, size_t count) { FillVec3(out, count, 0.33f, 1.0f); }
+
+private:
+    static constexpr size_t LANES = 4;
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    // 上位24ビットを [0, 1) の float へ（float の仮数部にちょうど収まる）
+    static float toUnitFloat(uint32_t x) { return static_cast<float>(x >> 8) * (1.0f / 16777216.0f); }
+
+    static uint64_t splitMix64(uint64_t& x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        return mix64(x);
+    }
+
+    static uint64_t mix64(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t s_[4];
+};
+
 class Random {
 public:
     // 任意の固定シードで初期化（現在のスレッドのエンジンを再シード）
     static void Seed(uint32_t seed) {
-        Engine() .seed(seed);
+        Engine().Seed(seed);
 		DEBUGLOG_CATEGORY(DebugLog::Category::System, "Randomのシード設定： " + std::to_string(seed));
     }
 
@@ -43,77 +216,46 @@ public:
     }
 
     // [min, max] の実数一様乱数（閉区間）
-    static float Float(float minInclusive, float maxInclusive) {
-        if (minInclusive > maxInclusive) std::swap(minInclusive, maxInclusive);
-        std::uniform_real_distribution<float> dist(minInclusive, nextUp(maxInclusive));
-        return dist(Engine());
-    }
+    static float Float(float minInclusive, float maxInclusive) { return Engine().Float(minInclusive, maxInclusive); }
 
     // [min, max] の整数一様乱数（閉区間）
-    static int Int(int minInclusive, int maxInclusive) {
-        if (minInclusive > maxInclusive) std::swap(minInclusive, maxInclusive);
-        std::uniform_int_distribution<int> dist(minInclusive, maxInclusive);
-        return dist(Engine());
-    }
+    static int Int(int minInclusive, int maxInclusive) { return Engine().Int(minInclusive, maxInclusive); }
 
     // true を返す確率 p（0..1）
-    static bool Bool(float p = 0.5f) {
-        if (p <= 0.0f) return false;
-        if (p >= 1.0f) return true;
-        std::bernoulli_distribution dist(p);
-        return dist(Engine());
-    }
+    static bool Bool(float p = 0.5f) { return Engine().Bool(p); }
 
     // 正規分布 N(mean, stddev)
-    static float Normal(float mean = 0.0f, float stddev = 1.0f) {
-        if (stddev <= 0.0f) return mean;
-        std::normal_distribution<float> dist(mean, stddev);
-        return dist(Engine());
-    }
+    static float Normal(float mean = 0.0f, float stddev = 1.0f) { return Engine().Normal(mean, stddev); }
 
     // [0,1] の明るめカラー（0.33～1.0）
-    static DirectX::XMFLOAT3 ColorBright() {
-        return DirectX::XMFLOAT3{ Float(0.33f, 1.0f), Float(0.33f, 1.0f), Float(0.33f, 1.0f) };
-    }
+    static DirectX::XMFLOAT3 ColorBright() { return Engine().ColorBright(); }
 
     // [min,max] のカラー
     static DirectX::XMFLOAT3 Color(float minInclusive = 0.0f, float maxInclusive = 1.0f) {
-        return DirectX::XMFLOAT3{ Float(minInclusive, maxInclusive),
-                                   Float(minInclusive, maxInclusive),
-                                   Float(minInclusive, maxInclusive) };
+        return Engine().Color(minInclusive, maxInclusive);
     }
 
-    // 一様な単位ベクトル（近似）
-    static DirectX::XMFLOAT3 UnitVec3() {
-        // 球面一様分布（角度から生成）
-        const float z = Float(-1.0f, 1.0f);
-        const float t = Float(0.0f, 6.28318530718f); // 2π
-        const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
-        return DirectX::XMFLOAT3{ r * std::cos(t), r * std::sin(t), z };
-    }
+    // 一様な単位ベクトル
+    static DirectX::XMFLOAT3 UnitVec3() { return Engine().UnitVec3(); }
 
-private:
-    // スレッドローカルなエンジン（最初の使用時にランダムデバイスで初期化）
-    static std::mt19937& Engine() {
-        thread_local std::mt19937 rng(seedFromDevice());
+    // util::Rng の初期化用のシード（現在のスレッドのエンジンから取り出す）
+    static uint64_t NextSeed() { return Engine().NextU64(); }
+
+    // 現在のスレッドのエンジン（まとめて生成する関数を使う場合など）
+    static Rng& Engine() {
+        thread_local Rng rng(seedFromDevice());
         return rng;
     }
 
-    static uint32_t seedFromDevice() {
+private:
+
+    static uint64_t seedFromDevice() {
         std::random_device rd;
-        // 一部環境で rd() が低品質な場合もあるらしいため、複数回混合
-        uint32_t s = rd();
-        s ^= (rd() << 1);
-        s ^= (rd() << 2);
+        // 一部環境で rd() が低品質な場合もあるらしいため、時刻も混合
+        uint64_t s = (static_cast<uint64_t>(rd()) << 32) | rd();
+        s ^= static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
         return s;
     }
-
-    // 上方向の隣接浮動小数（閉区間を実現するための微小オフセット）
-    static float nextUp(float x) {
-        if (std::isinf(x) && x > 0) return x;
-        if (std::isnan(x)) return x;
-        return std::nextafter(x, std::numeric_limits<float>::infinity());
-    }
 };
 
 } // namespace util
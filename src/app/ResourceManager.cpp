@@ -1,5 +1,35 @@
 #include "app/ResourceManager.h"
+#include "app/AssetArchive.h"
 #include "app/DebugLog.h"
+#include "app/ServiceLocator.h"
+#include "app/Telemetry.h"
+#include <chrono>
+
+namespace {
+// ジオメトリの読み込み時間をテレメトリ(model_load_ms)に記録する
+bool loadGeometryTimed(const std::string& filePath, ModelLoader::LoadedModel& model) {
+    static const Telemetry::MetricId loadMs = Telemetry::GetInstance().RegisterHistogram("model_load_ms");
+    auto start = std::chrono::steady_clock::now();
+    bool ok = ModelLoader::LoadGeometry(filePath, model);
+    Telemetry::GetInstance().Record(loadMs, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return ok;
+}
+
+// ホットリロードで変更の通知とアセットを対応付けるキー(小文字・'/' 区切り・先頭の "./" と拡張子なし)
+// "Textures/a.png" と "Textures/a.dds"、"Models/b.obj" と "Models/b.mtl" は同じキーになる
+std::string reloadKey(const std::string& path) {
+    std::string key = path;
+    for (char& c : key) {
+        if (c == '\\') c = '/';
+        else if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    if (key.compare(0, 2, "./") == 0) key.erase(0, 2);
+    size_t dot = key.find_last_of('.');
+    size_t slash = key.find_last_of('/');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) key.erase(dot);
+    return key;
+}
+} // namespace
 
 const std::vector<ModelComponent>& ResourceManager::GetModel(const std::string& filePath) {
     static const std::vector<ModelComponent> kEmpty;
@@ -10,19 +40,402 @@ const std::vector<ModelComponent>& ResourceManager::GetModel(const std::string&
         return it->second;
     }
 
-    DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model cache miss, loading: " + filePath);
-    std::vector<ModelComponent> loadedModel = ModelLoader::LoadModel(filePath);
+    // 非同期読み込み中の場合は完了を待って結果を使う
+    auto pendingIt = pending_.find(filePath);
+    if (pendingIt != pending_.end()) {
+        waitPending();
+        const std::vector<ModelComponent>* model = nullptr;
+        finishPending(filePath, *pendingIt->second, model);
+        return model ? *model : kEmpty;
+    }
 
-    if (loadedModel.empty()) {
+    DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model cache miss, loading: " + filePath);
+    ModelLoader::LoadedModel loadedModel;
+    if (!loadGeometryTimed(filePath, loadedModel) || loadedModel.meshes.empty()) {
         return kEmpty;
     }
 
-    auto result = modelCache_.emplace(filePath, std::move(loadedModel));
+    ModelLoader::ResolveTextures(loadedModel);
+    return storeModel(filePath, loadedModel);
+}
+
+ResourceManager::LoadState ResourceManager::GetModelAsync(const std::string& filePath, const std::vector<ModelComponent>*& out) {
+    out = nullptr;
+
+    auto it = modelCache_.find(filePath);
+    if (it != modelCache_.end()) {
+        out = &it->second;
+        return LoadState::Ready;
+    }
+    if (failed_.count(filePath)) {
+        return LoadState::Failed;
+    }
+
+    auto pendingIt = pending_.find(filePath);
+    if (pendingIt != pending_.end()) {
+        if (!pendingIt->second->done.load(std::memory_order_acquire)) {
+            return LoadState::Loading;
+        }
+        return finishPending(filePath, *pendingIt->second, out);
+    }
+
+    if (!jobs_ || !jobs_->IsRunning()) {
+        const std::vector<ModelComponent>& model = GetModel(filePath);
+        if (model.empty()) {
+            failed_.insert(filePath);
+            return LoadState::Failed;
+        }
+        out = &model;
+        return LoadState::Ready;
+    }
+
+    // ジオメトリの変換とバッファ作成をワーカーで行う(ID3D11Device の生成系はスレッドセーフ)
+    DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model async load started: " + filePath);
+    auto pending = std::make_shared<PendingModel>();
+    pending_.emplace(filePath, pending);
+    jobs_->Submit([pending, filePath]() {
+        pending->succeeded = loadGeometryTimed(filePath, pending->model);
+        pending->done.store(true, std::memory_order_release);
+    }, &loads_);
+    return LoadState::Loading;
+}
+
+ResourceManager::LoadState ResourceManager::finishPending(const std::string& filePath, PendingModel& pending, const std::vector<ModelComponent>*& out) {
+    out = nullptr;
+    LoadState state = LoadState::Failed;
+    if (pending.succeeded && !pending.model.meshes.empty()) {
+        ModelLoader::ResolveTextures(pending.model);
+        out = &storeModel(filePath, pending.model);
+        state = LoadState::Ready;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model async load finished: " + filePath);
+    } else {
+        failed_.insert(filePath);
+        releaseRetired(filePath);
+        DEBUGLOG_WARNING("Model async load failed: " + filePath);
+    }
+    pending_.erase(filePath); // pending はここで破棄される可能性があるため最後に消す
+    return state;
+}
+
+const std::vector<ModelComponent>& ResourceManager::storeModel(const std::string& filePath, ModelLoader::LoadedModel& model) {
+    std::vector<TextureManager::TextureHandle>& textures = modelTextures_[filePath];
+    for (size_t i = 0; i < model.meshes.size(); ++i) {
+        const ModelComponent& mesh = model.meshes[i];
+        if (mesh.texture != TextureManager::INVALID_TEXTURE) {
+            textures.push_back(mesh.texture);
+            watchTexture(mesh.texture, model.diffusePaths[i]);
+        }
+        if (mesh.normalTexture != TextureManager::INVALID_TEXTURE) {
+            textures.push_back(mesh.normalTexture);
+            watchTexture(mesh.normalTexture, model.normalPaths[i]);
+        }
+    }
+
+    MeshCacheStamp stamp;
+    if (MeshCacheStamp::FromFile(filePath, stamp)) {
+        modelStamps_[filePath] = stamp;
+    }
+
+    // 再読み込み前のテクスチャは、同じパスを新しいモデルが参照し直してから解放する
+    releaseRetired(filePath);
+
+    auto result = modelCache_.emplace(filePath, std::move(model.meshes));
     return result.first->second;
 }
 
+void ResourceManager::unloadModel(const std::string& filePath, bool keepTextures) {
+    // ワーカーは PendingModel を共有して持つため、結果を捨てても安全
+    pending_.erase(filePath);
+    reloading_.erase(filePath);
+    failed_.erase(filePath);
+    modelCache_.erase(filePath);
+    modelStamps_.erase(filePath);
+
+    auto deps = modelTextures_.find(filePath);
+    if (deps != modelTextures_.end()) {
+        std::vector<TextureManager::TextureHandle>& retired = retiredTextures_[filePath];
+        retired.insert(retired.end(), deps->second.begin(), deps->second.end());
+        modelTextures_.erase(deps);
+    }
+    if (!keepTextures) releaseRetired(filePath);
+}
+
+void ResourceManager::releaseRetired(const std::string& filePath) {
+    auto retired = retiredTextures_.find(filePath);
+    if (retired == retiredTextures_.end()) return;
+    auto& texMgr = ServiceLocator::Get<TextureManager>();
+    for (TextureManager::TextureHandle texture : retired->second) {
+        unwatchTexture(texture);
+        texMgr.Release(texture);
+    }
+    retiredTextures_.erase(retired);
+}
+
+void ResourceManager::watchTexture(TextureManager::TextureHandle handle, const std::string& filePath) {
+    TextureWatch& watch = textureWatches_[handle];
+    if (watch.refCount++ == 0) {
+        watch.path = filePath;
+        MeshCacheStamp::FromFile(filePath, watch.stamp);
+    }
+}
+
+void ResourceManager::unwatchTexture(TextureManager::TextureHandle handle) {
+    auto it = textureWatches_.find(handle);
+    if (it != textureWatches_.end() && --it->second.refCount == 0) {
+        textureWatches_.erase(it);
+    }
+}
+
+ModelAssetHandle ResourceManager::AcquireModel(const std::string& filePath) {
+    ModelAssetHandle handle;
+    auto it = modelIds_.find(filePath);
+    if (it != modelIds_.end()) {
+        handle.id = it->second;
+        modelRecords_[handle.id - 1].refCount++;
+        return handle;
+    }
+
+    if (!freeModelIds_.empty()) {
+        handle.id = freeModelIds_.back();
+        freeModelIds_.pop_back();
+    } else {
+        modelRecords_.emplace_back();
+        handle.id = static_cast<uint32_t>(modelRecords_.size());
+    }
+    ModelRecord& record = modelRecords_[handle.id - 1];
+    record.path = filePath;
+    record.refCount = 1;
+    modelIds_.emplace(filePath, handle.id);
+
+    const std::vector<ModelComponent>* model = nullptr;
+    GetModelAsync(filePath, model);
+    return handle;
+}
+
+ResourceManager::LoadState ResourceManager::GetModelAsync(ModelAssetHandle handle, const std::vector<ModelComponent>*& out) {
+    out = nullptr;
+    if (!handle.IsValid() || handle.id > modelRecords_.size() || modelRecords_[handle.id - 1].refCount == 0) {
+        return LoadState::Failed;
+    }
+    return GetModelAsync(modelRecords_[handle.id - 1].path, out);
+}
+
+const std::string& ResourceManager::GetPath(ModelAssetHandle handle) const {
+    static const std::string kEmpty;
+    if (!handle.IsValid() || handle.id > modelRecords_.size()) return kEmpty;
+    return modelRecords_[handle.id - 1].path;
+}
+
+void ResourceManager::Release(ModelAssetHandle& handle) {
+    if (!handle.IsValid() || handle.id > modelRecords_.size()) return;
+    ModelRecord& record = modelRecords_[handle.id - 1];
+    if (record.refCount > 0 && --record.refCount == 0) {
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model released: " + record.path);
+        unloadModel(record.path);
+        modelIds_.erase(record.path);
+        record.path.clear();
+        freeModelIds_.push_back(handle.id);
+    }
+    handle = ModelAssetHandle();
+}
+
+TextureAssetHandle ResourceManager::AcquireTexture(const std::string& filePath) {
+    TextureAssetHandle handle;
+    TextureManager::TextureHandle texture = ServiceLocator::Get<TextureManager>().LoadFromFileAsync(filePath.c_str());
+    if (texture == TextureManager::INVALID_TEXTURE) return handle;
+
+    textureRefs_[texture]++;
+    watchTexture(texture, filePath);
+    handle.id = texture;
+    return handle;
+}
+
+TextureManager::TextureHandle ResourceManager::GetTexture(TextureAssetHandle handle) const {
+    return textureRefs_.count(handle.id) ? handle.id : TextureManager::INVALID_TEXTURE;
+}
+
+void ResourceManager::Release(TextureAssetHandle& handle) {
+    auto it = textureRefs_.find(handle.id);
+    if (it != textureRefs_.end()) {
+        if (--it->second == 0) textureRefs_.erase(it);
+        unwatchTexture(handle.id);
+        ServiceLocator::Get<TextureManager>().Release(handle.id);
+    }
+    handle = TextureAssetHandle();
+}
+
+std::vector<ModelAssetHandle> ResourceManager::PreloadModels(const std::vector<std::string>& filePaths) {
+    std::vector<ModelAssetHandle> handles;
+    handles.reserve(filePaths.size());
+    for (const std::string& path : filePaths) {
+        handles.push_back(AcquireModel(path));
+    }
+    return handles;
+}
+
+bool ResourceManager::AreModelsLoaded(const std::vector<ModelAssetHandle>& handles) {
+    bool loaded = true;
+    for (ModelAssetHandle handle : handles) {
+        // 完了したものはここでキャッシュへ移す(すべての完了を確認するため途中で抜けない)
+        const std::vector<ModelComponent>* model = nullptr;
+        if (GetModelAsync(handle, model) == LoadState::Loading) loaded = false;
+    }
+    return loaded;
+}
+
+void ResourceManager::ReleaseModels(std::vector<ModelAssetHandle>& handles) {
+    for (ModelAssetHandle& handle : handles) {
+        Release(handle);
+    }
+    handles.clear();
+}
+
+void ResourceManager::SetHotReloadEnabled(bool enabled) {
+    hotReload_ = enabled;
+    pollFrame_ = 0;
+    if (!enabled) {
+        watcher_.Stop();
+        return;
+    }
+    if (AssetArchive::GetInstance().IsMounted()) {
+        DEBUGLOG_WARNING("Hot reload: assets inside the mounted archive are read from it; start with --no-pak to pick up edits");
+    }
+    if (!watcher_.IsRunning() && !watcher_.Start({ HOT_RELOAD_DIRECTORY })) {
+        DEBUGLOG_WARNING("Hot reload: could not watch " + std::string(HOT_RELOAD_DIRECTORY) + ", falling back to polling");
+    }
+}
+
+void ResourceManager::Update() {
+    if (!hotReload_) return;
+    if (!reloading_.empty()) finishReloads();
+
+    // 監視中は通知のあったファイルだけ、監視できない・通知があふれた場合はすべての更新日時を確認する
+    bool checkAll = false;
+    std::unordered_set<std::string> notified;
+    if (watcher_.IsRunning()) {
+        std::vector<std::string> changed;
+        watcher_.Poll(changed, checkAll);
+        for (const std::string& path : changed) {
+            notified.insert(reloadKey(path));
+        }
+        if (notified.empty() && !checkAll) return;
+    } else {
+        if (++pollFrame_ < HOT_RELOAD_POLL_FRAMES) return;
+        pollFrame_ = 0;
+        checkAll = true;
+    }
+
+    // テクスチャはハンドルを保ったまま、ワーカーでデコードしてから差し替える
+    auto& texMgr = ServiceLocator::Get<TextureManager>();
+    for (auto& pair : textureWatches_) {
+        TextureWatch& watch = pair.second;
+        MeshCacheStamp stamp;
+        if (!MeshCacheStamp::FromFile(watch.path, stamp)) continue;
+        if (!notified.count(reloadKey(watch.path)) && (!checkAll || stamp == watch.stamp)) continue;
+        if (texMgr.ReloadAsync(pair.first, watch.path.c_str())) {
+            watch.stamp = stamp;
+            DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Texture hot reload: " + watch.path);
+        }
+    }
+
+    // モデルはワーカーで読み込み直し、完了したら finishReloads() で入れ替える
+    // (元の情報をここで更新し、読み込み直し中に同じ変更で再び始めないようにする)
+    std::vector<std::string> changed;
+    for (auto& pair : modelStamps_) {
+        MeshCacheStamp stamp;
+        if (!MeshCacheStamp::FromFile(pair.first, stamp)) continue;
+        if (!notified.count(reloadKey(pair.first)) && (!checkAll || stamp == pair.second)) continue;
+        pair.second = stamp;
+        changed.push_back(pair.first);
+    }
+    for (const std::string& path : changed) {
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model hot reload: " + path);
+        startReload(path);
+    }
+}
+
+void ResourceManager::startReload(const std::string& filePath) {
+    auto pending = std::make_shared<PendingModel>();
+    reloading_[filePath] = pending; // ワーカーは PendingModel を共有して持つため、前の結果を捨てても安全
+    if (!jobs_ || !jobs_->IsRunning()) {
+        pending->succeeded = loadGeometryTimed(filePath, pending->model);
+        pending->done.store(true, std::memory_order_release);
+        return;
+    }
+    jobs_->Submit([pending, filePath]() {
+        pending->succeeded = loadGeometryTimed(filePath, pending->model);
+        pending->done.store(true, std::memory_order_release);
+    }, &loads_);
+}
+
+void ResourceManager::finishReloads() {
+    std::vector<std::string> finished;
+    for (const auto& pair : reloading_) {
+        if (pair.second->done.load(std::memory_order_acquire)) finished.push_back(pair.first);
+    }
+    for (const std::string& path : finished) {
+        std::shared_ptr<PendingModel> pending = std::move(reloading_[path]);
+        reloading_.erase(path);
+        if (!pending->succeeded || pending->model.meshes.empty()) {
+            DEBUGLOG_WARNING("Model hot reload failed, keeping the previous model: " + path);
+            continue;
+        }
+
+        // テクスチャを解決してから入れ替える(同じテクスチャは共有され、使われなくなったものだけ解放される)
+        ModelLoader::ResolveTextures(pending->model);
+        unloadModel(path, true);
+        storeModel(path, pending->model);
+        modelGenerations_[path]++;
+        reloadCount_++;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Model hot reloaded: " + path);
+    }
+}
+
+uint32_t ResourceManager::GetModelGeneration(const std::string& filePath) const {
+    auto it = modelGenerations_.find(filePath);
+    return it != modelGenerations_.end() ? it->second : 0;
+}
+
+size_t ResourceManager::GpuMemoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : modelCache_) {
+        for (const ModelComponent& mesh : entry.second) {
+            bytes += GfxDevice::BufferBytes(mesh.vertexBuffer.Get()) + GfxDevice::BufferBytes(mesh.indexBuffer.Get());
+            bytes += GfxDevice::BufferBytes(mesh.skinBuffer.Get());
+            for (const ModelLod& lod : mesh.lods) {
+                bytes += GfxDevice::BufferBytes(lod.vertexBuffer.Get()) + GfxDevice::BufferBytes(lod.indexBuffer.Get());
+            }
+        }
+    }
+    return bytes;
+}
+
+void ResourceManager::waitPending() {
+    if (jobs_ && !loads_.IsDone()) {
+        jobs_->Wait(loads_);
+    }
+}
+
+void ResourceManager::SetJobSystem(JobSystem* jobs) {
+    waitPending();
+    jobs_ = jobs;
+}
+
 void ResourceManager::Clear() {
     DEBUGLOG_CATEGORY(DebugLog::Category::Graphics, "Clearing all cached resources.");
+    waitPending();
+    pending_.clear();
+    reloading_.clear();
+    failed_.clear();
     modelCache_.clear();
+    // テクスチャは TextureManager::Shutdown() で解放されるため記録だけ消す
+    modelTextures_.clear();
+    retiredTextures_.clear();
+    modelStamps_.clear();
+    modelGenerations_.clear();
+    modelRecords_.clear();
+    modelIds_.clear();
+    freeModelIds_.clear();
+    textureRefs_.clear();
+    textureWatches_.clear();
 }
-
@@ -1,9 +1,22 @@
 #include "graphics/ModelLoader.h"
 #include "app/ServiceLocator.h"
+#include "graphics/FrustumCulling.h"
+#include "graphics/MeshCache.h"
+#include "graphics/ArchiveIOSystem.h"
+#include "animation/Skeleton.h"
+#include "app/JobSystem.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <DirectXMath.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 // 頂点構造体 (PositionとTexCoordのみ)
 struct SimpleVertex {
@@ -13,64 +26,215 @@ struct SimpleVertex {
     DirectX::XMFLOAT3 Tangent;
     DirectX::XMFLOAT3 Bitangent;
 };
+static_assert(sizeof(SimpleVertex) == MeshPool::VERTEX_STRIDE, "SimpleVertex must match the shared mesh buffer layout");
+static_assert(sizeof(SimpleVertex) == VertexStride(VertexFormat::Standard), "SimpleVertex must match VertexFormat::Standard");
 
-std::vector<ModelComponent> ModelLoader::LoadModel(const std::string& filePath)
+namespace {
+
+using LoadClock = std::chrono::steady_clock;
+
+// 前回の区切りからの経過時間(ミリ秒)を返し、区切りを現在に進める
+double LapMs(LoadClock::time_point& lap)
 {
-    auto& gfx = ServiceLocator::Get<GfxDevice>();
-    auto& texMgr = ServiceLocator::Get<TextureManager>();
-    std::vector<ModelComponent> modelComponents;
-    Assimp::Importer importer;
+    LoadClock::time_point now = LoadClock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - lap).count();
+    lap = now;
+    return ms;
+}
 
-    // モデルをロード
-    // aiProcess_Triangulate: 全てのプリミティブを三角形に変換
-    // aiProcess_FlipUVs: UV座標を反転 (DirectXの慣例に合わせる)
-    // aiProcess_GenNormals: 法線がなければ生成
-    const aiScene* scene = importer.ReadFile(filePath,
-        aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals | aiProcess_CalcTangentSpace);
+// インデックスを詰める(頂点数が16ビットに収まる場合は16ビット、それ以外は32ビット)
+uint32_t PackIndices(const std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint8_t>& out)
+{
+    if (vertexCount <= 0xFFFF) {
+        out.resize(indices.size() * sizeof(uint16_t));
+        uint16_t* dst = reinterpret_cast<uint16_t*>(out.data());
+        for (size_t i = 0; i < indices.size(); ++i) dst[i] = static_cast<uint16_t>(indices[i]);
+        return sizeof(uint16_t);
+    }
+    out.resize(indices.size() * sizeof(uint32_t));
+    if (!indices.empty()) std::memcpy(out.data(), indices.data(), out.size());
+    return sizeof(uint32_t);
+}
 
-    // エラーチェック
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        DEBUGLOG_ERROR("Assimp Error: " + std::string(importer.GetErrorString()));
-        return modelComponents;
+std::atomic<VertexFormat>& VertexFormatSetting()
+{
+    static std::atomic<VertexFormat> format{ VertexFormat::Standard };
+    return format;
+}
+
+std::atomic<bool>& MergeByMaterialSetting()
+{
+    static std::atomic<bool> merge{ true };
+    return merge;
+}
+
+std::atomic<JobSystem*>& JobSystemSetting()
+{
+    static std::atomic<JobSystem*> jobs{ nullptr };
+    return jobs;
+}
+
+// count 個のメッシュを fn(i) で処理(ジョブシステムがあればメッシュごとにワーカーへ分ける)
+// ワーカーで実行中の読み込みから呼ばれた場合も、待つ間は呼び出したスレッドがジョブを実行する
+template<class F>
+void ForEachMesh(size_t count, F&& fn)
+{
+    JobSystem* jobs = JobSystemSetting().load(std::memory_order_acquire);
+    if (!jobs || !jobs->IsRunning() || count < 2) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
     }
+    jobs->ParallelFor(count, 1, [&fn](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) fn(i);
+    });
+}
 
-    // ファイルパスからディレクトリを抽出
-    std::string directory = filePath.substr(0, filePath.find_last_of('/'));
-    if (directory.empty()) {
-        directory = filePath.substr(0, filePath.find_last_of('\\'));
+// バッファを作成する1メッシュ分(skin はスキニングされたメッシュのみ)
+struct MeshUpload {
+    const MeshCacheEntry* entry = nullptr;
+    const std::vector<SkinInfluence>* skin = nullptr;
+};
+
+// MeshCacheStamp::importFlags のビット(キャッシュの内容を変える読み込みオプション)
+constexpr uint32_t IMPORT_FLAG_MERGE_BY_MATERIAL = 1u << 0;
+
+// 標準形式の頂点を小さな形式に変換(Standard は変換しない)
+void ConvertVertices(const SimpleVertex* src, size_t count, VertexFormat format, const DirectX::XMFLOAT4& dequant, std::vector<uint8_t>& out)
+{
+    out.resize(count * VertexStride(format));
+    if (format == VertexFormat::Compact) {
+        CompactVertex* dst = reinterpret_cast<CompactVertex*>(out.data());
+        for (size_t i = 0; i < count; ++i) {
+            dst[i].position = src[i].Position;
+            VertexCompression::PackUv(src[i].TexCoord, dst[i].uv);
+            VertexCompression::PackTangentFrame(src[i].Normal, src[i].Tangent, src[i].Bitangent, dst[i].frame);
+        }
+    } else if (format == VertexFormat::CompactQuantized) {
+        QuantizedVertex* dst = reinterpret_cast<QuantizedVertex*>(out.data());
+        for (size_t i = 0; i < count; ++i) {
+            VertexCompression::QuantizePosition(src[i].Position, dequant, dst[i].position);
+            VertexCompression::PackUv(src[i].TexCoord, dst[i].uv);
+            VertexCompression::PackTangentFrame(src[i].Normal, src[i].Tangent, src[i].Bitangent, dst[i].frame);
+        }
+    }
+}
+
+// 頂点・インデックスバッファの作成(キャッシュ読み込み時はマップした領域をそのまま初期データに使う)
+// 小さな頂点形式の場合は変換した頂点を初期データにする
+bool CreateMeshBuffers(GfxDevice& gfx, const MeshCacheGeometry& geometry, VertexFormat format, const DirectX::XMFLOAT4& dequant,
+                       Microsoft::WRL::ComPtr<ID3D11Buffer>& vertexBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& indexBuffer,
+                       DXGI_FORMAT& indexFormat)
+{
+    std::vector<uint8_t> converted;
+    const void* vertices = geometry.vertices;
+    if (format != VertexFormat::Standard) {
+        ConvertVertices(static_cast<const SimpleVertex*>(geometry.vertices), geometry.vertexCount, format, dequant, converted);
+        vertices = converted.data();
     }
 
-    // シーンのルートノードから再帰的に処理を開始
-    // 現状はルートノード直下のメッシュのみを処理する簡易実装
-    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
-        aiMesh* mesh = scene->mMeshes[i];
-        ProcessMesh(modelComponents, mesh, scene, directory, gfx);
+    D3D11_BUFFER_DESC vbd{};
+    vbd.ByteWidth = static_cast<UINT>(geometry.vertexCount * VertexStride(format));
+    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    vbd.Usage = D3D11_USAGE_IMMUTABLE;
+    D3D11_SUBRESOURCE_DATA vinit{ vertices, 0, 0 };
+    if (FAILED(gfx.Dev()->CreateBuffer(&vbd, &vinit, vertexBuffer.GetAddressOf()))) {
+        DEBUGLOG_ERROR("Failed to create vertex buffer for model.");
+        return false;
     }
 
-    DEBUGLOG_CATEGORY(DebugLog::Category::Render, "Model loaded: " + filePath + ", Meshes: " + std::to_string(modelComponents.size()));
-    return modelComponents;
+    D3D11_BUFFER_DESC ibd{};
+    ibd.ByteWidth = static_cast<UINT>(geometry.indexCount * geometry.indexStride);
+    ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    ibd.Usage = D3D11_USAGE_IMMUTABLE;
+    D3D11_SUBRESOURCE_DATA iinit{ geometry.indices, 0, 0 };
+    if (FAILED(gfx.Dev()->CreateBuffer(&ibd, &iinit, indexBuffer.GetAddressOf()))) {
+        DEBUGLOG_ERROR("Failed to create index buffer for model.");
+        return false;
+    }
+    indexFormat = geometry.indexStride == sizeof(uint32_t) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+    return true;
 }
 
-void ModelLoader::ProcessMesh(
-    std::vector<ModelComponent>& modelComponents,
-    aiMesh* mesh,
-    const aiScene* scene,
-    const std::string& directory,
-    GfxDevice& gfx
-) {
-    std::vector<SimpleVertex> vertices;
-    std::vector<unsigned short> indices;
+// キャッシュ形式のメッシュから ModelComponent を作成(テクスチャは ResolveTextures で設定)
+bool CreateModelComponent(GfxDevice& gfx, const MeshCacheEntry& entry, VertexFormat format, ModelComponent& mc)
+{
+    const MeshCacheGeometry& base = entry.levels[0];
+    if (base.vertexCount == 0 || base.indexCount == 0) return false;
+
+    // 量子化の範囲は LOD0 の AABB(簡略化した頂点も同じ範囲に収まり、LOD間で共有できる)
+    mc.vertexFormat = format;
+    if (mc.vertexFormat == VertexFormat::CompactQuantized) {
+        mc.positionDequant = VertexCompression::ComputePositionDequant(
+            &static_cast<const SimpleVertex*>(base.vertices)->Position, base.vertexCount, sizeof(SimpleVertex));
+    }
+    if (!CreateMeshBuffers(gfx, base, mc.vertexFormat, mc.positionDequant, mc.vertexBuffer, mc.indexBuffer, mc.indexFormat)) return false;
+    mc.indexCount = base.indexCount;
+
+    for (uint32_t lod = 1; lod < MeshCacheEntry::LEVEL_COUNT; ++lod) {
+        const MeshCacheGeometry& geometry = entry.levels[lod];
+        if (geometry.vertexCount == 0 || geometry.indexCount == 0) continue;
+        ModelLod& level = mc.lods[lod - 1];
+        if (!CreateMeshBuffers(gfx, geometry, mc.vertexFormat, mc.positionDequant, level.vertexBuffer, level.indexBuffer, level.indexFormat)) break;
+        level.indexCount = geometry.indexCount;
+    }
+
+    mc.color = entry.color;
+    mc.boundsCenter = entry.boundsCenter;
+    mc.boundsRadius = entry.boundsRadius;
+    return true;
+}
+
+// スキニングの影響の頂点バッファ(2本目のストリーム)を作成
+bool CreateSkinBuffer(GfxDevice& gfx, const std::vector<SkinInfluence>& skin, Microsoft::WRL::ComPtr<ID3D11Buffer>& skinBuffer)
+{
+    D3D11_BUFFER_DESC desc{};
+    desc.ByteWidth = static_cast<UINT>(skin.size() * sizeof(SkinInfluence));
+    desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    D3D11_SUBRESOURCE_DATA init{ skin.data(), 0, 0 };
+    if (FAILED(gfx.Dev()->CreateBuffer(&desc, &init, skinBuffer.GetAddressOf()))) {
+        DEBUGLOG_ERROR("Failed to create skin buffer for model.");
+        return false;
+    }
+    return true;
+}
+
+// Assimp の行列(列ベクトルの規約)を DirectXMath の行ベクトルの規約に転置して読む
+DirectX::XMMATRIX ToXMMatrix(const aiMatrix4x4& m)
+{
+    return DirectX::XMMatrixSet(
+        m.a1, m.b1, m.c1, m.d1,
+        m.a2, m.b2, m.c2, m.d2,
+        m.a3, m.b3, m.c3, m.d3,
+        m.a4, m.b4, m.c4, m.d4);
+}
+
+// aiMesh の頂点と三角形を追加(インデックスは追加前の頂点数だけずらす)
+// transform を指定した場合はノードの変換を焼き込む(法線は逆転置行列、接線は変換後に正規化し、裏返る変換では三角形の向きを戻す)
+void AppendMeshGeometry(const aiMesh* mesh, const DirectX::XMMATRIX* transform, std::vector<SimpleVertex>& vertices, std::vector<uint32_t>& indices)
+{
+    using namespace DirectX;
+    const uint32_t base = static_cast<uint32_t>(vertices.size());
+    vertices.reserve(vertices.size() + mesh->mNumVertices);
+    indices.reserve(indices.size() + static_cast<size_t>(mesh->mNumFaces) * 3);
+
+    XMMATRIX normalMatrix = XMMatrixIdentity();
+    bool flipWinding = false;
+    if (transform) {
+        XMVECTOR det;
+        const XMMATRIX inverse = XMMatrixInverse(&det, *transform);
+        const float d = XMVectorGetX(det);
+        normalMatrix = d != 0.0f ? XMMatrixTranspose(inverse) : *transform;
+        flipWinding = d < 0.0f;
+    }
 
-    // 頂点データを処理
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        SimpleVertex vertex;
+        SimpleVertex vertex{};
         vertex.Position = { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z };
-        
+
         // テクスチャ座標が存在する場合
         if (mesh->mTextureCoords[0]) {
             vertex.TexCoord = { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y };
-        } else {
-            vertex.TexCoord = { 0.0f, 0.0f };
         }
 
         if (mesh->mNormals) {
@@ -86,83 +250,663 @@ void ModelLoader::ProcessMesh(
         if (mesh->mBitangents) {
             vertex.Bitangent = { mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z };
         }
+
+        if (transform) {
+            XMStoreFloat3(&vertex.Position, XMVector3TransformCoord(XMLoadFloat3(&vertex.Position), *transform));
+            XMStoreFloat3(&vertex.Normal, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertex.Normal), normalMatrix)));
+            XMStoreFloat3(&vertex.Tangent, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertex.Tangent), *transform)));
+            XMStoreFloat3(&vertex.Bitangent, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertex.Bitangent), *transform)));
+        }
         vertices.push_back(vertex);
     }
 
-    // インデックスデータを処理
+    // 三角形のみ(Triangulate の後に残る点・線は描画しない)
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        aiFace face = mesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++) {
-            indices.push_back(static_cast<unsigned short>(face.mIndices[j]));
+        const aiFace& face = mesh->mFaces[i];
+        if (face.mNumIndices != 3) continue;
+        indices.push_back(base + face.mIndices[0]);
+        indices.push_back(base + face.mIndices[flipWinding ? 2 : 1]);
+        indices.push_back(base + face.mIndices[flipWinding ? 1 : 2]);
+    }
+}
+
+// スケルトンの構築(ボーンとその祖先のノードを、親が先に来る深さ優先の順に並べる)
+// ボーンがない場合、または関節が Skeleton::MAX_JOINTS を超える場合は false
+bool BuildSkeleton(const aiScene* scene, Skeleton& out)
+{
+    std::unordered_map<std::string, const aiBone*> bones;
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+            bones.emplace(mesh->mBones[b]->mName.C_Str(), mesh->mBones[b]);
         }
     }
+    if (bones.empty()) return false;
 
-    // ModelComponentを作成
-    ModelComponent mc;
-    mc.indexCount = static_cast<UINT>(indices.size());
+    std::unordered_set<const aiNode*> used;
+    for (const auto& bone : bones) {
+        const aiNode* node = scene->mRootNode->FindNode(bone.first.c_str());
+        if (!node) {
+            DEBUGLOG_WARNING("Bone node not found: " + bone.first);
+            continue;
+        }
+        for (; node && used.insert(node).second; node = node->mParent) {}
+    }
 
-    // 頂点バッファの作成
-    D3D11_BUFFER_DESC vbd{};
-    vbd.ByteWidth = static_cast<UINT>(vertices.size() * sizeof(SimpleVertex));
-    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vbd.Usage = D3D11_USAGE_IMMUTABLE;
-    D3D11_SUBRESOURCE_DATA vinit{ vertices.data(), 0, 0 };
-    if (FAILED(gfx.Dev()->CreateBuffer(&vbd, &vinit, mc.vertexBuffer.GetAddressOf()))) {
-        DEBUGLOG_ERROR("Failed to create vertex buffer for model.");
-        return;
+    std::vector<std::pair<const aiNode*, int>> stack{ { scene->mRootNode, -1 } };
+    while (!stack.empty()) {
+        const aiNode* node = stack.back().first;
+        const int parent = stack.back().second;
+        stack.pop_back();
+        if (!used.count(node)) continue;
+        if (out.JointCount() >= Skeleton::MAX_JOINTS) {
+            DEBUGLOG_WARNING("Too many joints for skinning (max " + std::to_string(Skeleton::MAX_JOINTS) + "), loading as a static mesh.");
+            out = Skeleton();
+            return false;
+        }
+
+        DirectX::XMFLOAT4X4 inverseBind;
+        auto bone = bones.find(node->mName.C_Str());
+        DirectX::XMStoreFloat4x4(&inverseBind, bone != bones.end() ? ToXMMatrix(bone->second->mOffsetMatrix) : DirectX::XMMatrixIdentity());
+        const int index = out.AddJoint(node->mName.C_Str(), parent, ToXMMatrix(node->mTransformation), inverseBind);
+        for (unsigned int c = node->mNumChildren; c-- > 0;) {
+            stack.emplace_back(node->mChildren[c], index);
+        }
     }
+    DirectX::XMStoreFloat4x4(&out.rootInverse, DirectX::XMMatrixInverse(nullptr, ToXMMatrix(scene->mRootNode->mTransformation)));
+    return out.JointCount() > 0;
+}
 
-    // インデックスバッファの作成
-    D3D11_BUFFER_DESC ibd{};
-    ibd.ByteWidth = static_cast<UINT>(indices.size() * sizeof(unsigned short));
-    ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    ibd.Usage = D3D11_USAGE_IMMUTABLE;
-    D3D11_SUBRESOURCE_DATA iinit{ indices.data(), 0, 0 };
-    if (FAILED(gfx.Dev()->CreateBuffer(&ibd, &iinit, mc.indexBuffer.GetAddressOf()))) {
-        DEBUGLOG_ERROR("Failed to create index buffer for model.");
-        return;
+// tick 以前の最後のキー(キーは時刻順、最初のキーより前は 0)
+template<class Key>
+size_t FindKey(const Key* keys, unsigned int count, double tick)
+{
+    const Key* it = std::upper_bound(keys, keys + count, tick, [](double t, const Key& key) { return t < key.mTime; });
+    return it == keys ? 0 : static_cast<size_t>(it - keys) - 1;
+}
+
+DirectX::XMFLOAT3 SampleVectorKeys(const aiVectorKey* keys, unsigned int count, double tick, const DirectX::XMFLOAT3& fallback)
+{
+    if (count == 0) return fallback;
+    const size_t i = FindKey(keys, count, tick);
+    aiVector3D value = keys[i].mValue;
+    if (i + 1 < count && tick > keys[i].mTime) {
+        const float t = static_cast<float>((tick - keys[i].mTime) / (keys[i + 1].mTime - keys[i].mTime));
+        value = value + (keys[i + 1].mValue - value) * t;
+    }
+    return DirectX::XMFLOAT3{ value.x, value.y, value.z };
+}
+
+DirectX::XMFLOAT4 SampleQuatKeys(const aiQuatKey* keys, unsigned int count, double tick, const DirectX::XMFLOAT4& fallback)
+{
+    if (count == 0) return fallback;
+    const size_t i = FindKey(keys, count, tick);
+    aiQuaternion value = keys[i].mValue;
+    if (i + 1 < count && tick > keys[i].mTime) {
+        const float t = static_cast<float>((tick - keys[i].mTime) / (keys[i + 1].mTime - keys[i].mTime));
+        aiQuaternion::Interpolate(value, keys[i].mValue, keys[i + 1].mValue, t);
+        value.Normalize();
+    }
+    return DirectX::XMFLOAT4{ value.x, value.y, value.z, value.w };
+}
+
+// アニメーションを一定周期(AnimationClip::DEFAULT_SAMPLE_RATE)で再標本化して量子化
+// チャンネルのない関節はバインドポーズのまま
+void ImportClips(const aiScene* scene, const Skeleton& skeleton, std::vector<AnimationClip>& out)
+{
+    const uint32_t joints = static_cast<uint32_t>(skeleton.JointCount());
+    const float rate = AnimationClip::DEFAULT_SAMPLE_RATE;
+    for (unsigned int a = 0; a < scene->mNumAnimations; ++a) {
+        const aiAnimation* animation = scene->mAnimations[a];
+        const double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+        const uint32_t frames = static_cast<uint32_t>(std::ceil(animation->mDuration / ticksPerSecond * rate)) + 1;
+
+        std::vector<const aiNodeAnim*> channels(joints, nullptr);
+        for (unsigned int c = 0; c < animation->mNumChannels; ++c) {
+            const int joint = skeleton.Find(animation->mChannels[c]->mNodeName.C_Str());
+            if (joint >= 0) channels[joint] = animation->mChannels[c];
+        }
+
+        const size_t keys = static_cast<size_t>(frames) * joints;
+        std::vector<DirectX::XMFLOAT4> rotations(keys);
+        std::vector<DirectX::XMFLOAT3> translations(keys);
+        std::vector<DirectX::XMFLOAT3> scales(keys);
+        for (uint32_t f = 0; f < frames; ++f) {
+            const double tick = std::min(static_cast<double>(f) / rate * ticksPerSecond, animation->mDuration);
+            for (uint32_t j = 0; j < joints; ++j) {
+                const size_t k = static_cast<size_t>(f) * joints + j;
+                const aiNodeAnim* channel = channels[j];
+                if (!channel) {
+                    rotations[k] = skeleton.bindRotations[j];
+                    translations[k] = skeleton.bindTranslations[j];
+                    scales[k] = skeleton.bindScales[j];
+                    continue;
+                }
+                rotations[k] = SampleQuatKeys(channel->mRotationKeys, channel->mNumRotationKeys, tick, skeleton.bindRotations[j]);
+                translations[k] = SampleVectorKeys(channel->mPositionKeys, channel->mNumPositionKeys, tick, skeleton.bindTranslations[j]);
+                scales[k] = SampleVectorKeys(channel->mScalingKeys, channel->mNumScalingKeys, tick, skeleton.bindScales[j]);
+            }
+        }
+
+        const std::string name = animation->mName.length > 0 ? animation->mName.C_Str() : "Clip" + std::to_string(a);
+        AnimationClip clip = AnimationClip::Compress(name, rate, frames, joints, rotations, translations, scales);
+        if (clip.IsValid()) out.push_back(std::move(clip));
     }
+}
 
-    // マテリアルを処理
-    if (mesh->mMaterialIndex >= 0) {
-        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+// ワーカーで作成したバッファの内容を共有メッシュバッファへ複写し、個別のバッファを解放する
+// (32ビットインデックスのメッシュ、または共有バッファに入らない場合は個別のバッファのまま)
+void MoveToMeshPool(GfxDevice& gfx, VertexFormat format, Microsoft::WRL::ComPtr<ID3D11Buffer>& vertexBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& indexBuffer,
+                    UINT indexCount, DXGI_FORMAT indexFormat, MeshPoolHandle& pooled)
+{
+    if (!vertexBuffer || !indexBuffer || indexCount == 0 || indexFormat != MeshPool::INDEX_FORMAT) return;
+    const UINT vertexCount = static_cast<UINT>(GfxDevice::BufferBytes(vertexBuffer.Get()) / VertexStride(format));
+    pooled = gfx.Meshes(format).CopyFrom(gfx.Ctx(), vertexBuffer.Get(), vertexCount, indexBuffer.Get(), indexCount);
+    if (!pooled) return;
+    vertexBuffer.Reset();
+    indexBuffer.Reset();
+}
+
+// 頂点クラスタリングによる簡略化
+// AABBを cellsPerAxis 分割した格子で頂点をまとめ、つぶれた三角形を取り除く
+bool SimplifyByClustering(const std::vector<SimpleVertex>& vertices, const std::vector<uint32_t>& indices, int cellsPerAxis,
+                          std::vector<SimpleVertex>& outVertices, std::vector<uint32_t>& outIndices)
+{
+    outVertices.clear();
+    outIndices.clear();
+    if (vertices.empty() || indices.size() < 3 || cellsPerAxis < 1) return false;
+
+    DirectX::XMFLOAT3 minP = vertices[0].Position;
+    DirectX::XMFLOAT3 maxP = vertices[0].Position;
+    for (const SimpleVertex& v : vertices) {
+        minP.x = (std::min)(minP.x, v.Position.x); maxP.x = (std::max)(maxP.x, v.Position.x);
+        minP.y = (std::min)(minP.y, v.Position.y); maxP.y = (std::max)(maxP.y, v.Position.y);
+        minP.z = (std::min)(minP.z, v.Position.z); maxP.z = (std::max)(maxP.z, v.Position.z);
+    }
+    float extent = (std::max)(maxP.x - minP.x, (std::max)(maxP.y - minP.y, maxP.z - minP.z));
+    if (extent <= 0.0f) return false;
+    const float invCell = static_cast<float>(cellsPerAxis) / extent;
+
+    auto cellOf = [&](float v, float base) {
+        int c = static_cast<int>((v - base) * invCell);
+        return static_cast<uint64_t>(c < 0 ? 0 : (c > cellsPerAxis ? cellsPerAxis : c));
+    };
+
+    std::unordered_map<uint64_t, uint32_t> cells;
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<DirectX::XMFLOAT3> positionSums;
+    std::vector<DirectX::XMFLOAT3> normalSums;
+    std::vector<uint32_t> counts;
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const SimpleVertex& v = vertices[i];
+        uint64_t key = (cellOf(v.Position.x, minP.x) << 42) | (cellOf(v.Position.y, minP.y) << 21) | cellOf(v.Position.z, minP.z);
+        auto it = cells.find(key);
+        if (it == cells.end()) {
+            uint32_t index = static_cast<uint32_t>(outVertices.size());
+            it = cells.emplace(key, index).first;
+            outVertices.push_back(v);
+            positionSums.push_back(v.Position);
+            normalSums.push_back(v.Normal);
+            counts.push_back(1);
+        } else {
+            uint32_t index = it->second;
+            positionSums[index].x += v.Position.x; positionSums[index].y += v.Position.y; positionSums[index].z += v.Position.z;
+            normalSums[index].x += v.Normal.x; normalSums[index].y += v.Normal.y; normalSums[index].z += v.Normal.z;
+            counts[index]++;
+        }
+        remap[i] = it->second;
+    }
+
+    for (size_t i = 0; i < outVertices.size(); ++i) {
+        float inv = 1.0f / static_cast<float>(counts[i]);
+        outVertices[i].Position = { positionSums[i].x * inv, positionSums[i].y * inv, positionSums[i].z * inv };
+        DirectX::XMStoreFloat3(&outVertices[i].Normal, DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&normalSums[i])));
+    }
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t a = remap[indices[i]];
+        uint32_t b = remap[indices[i + 1]];
+        uint32_t c = remap[indices[i + 2]];
+        if (a == b || b == c || a == c) continue;
+        outIndices.push_back(a);
+        outIndices.push_back(b);
+        outIndices.push_back(c);
+    }
+    return !outIndices.empty();
+}
+
+// 変換する1メッシュ分の入力(結合する aiMesh と、それぞれのノードのワールド変換)
+struct MeshSource {
+    struct Part {
+        const aiMesh* mesh = nullptr;
+        DirectX::XMFLOAT4X4 transform;
+    };
+
+    std::vector<Part> parts;
+    unsigned int materialIndex = 0;
+    size_t vertexCount = 0;     ///< parts の頂点数の合計(変換先の確保に使う)
+    size_t indexCount = 0;      ///< parts のインデックス数の合計
+    bool skinned = false;       ///< スキニングされたメッシュ(parts は1つで、変換を焼き込まない)
+};
+
+// 変換するメッシュの一覧を作る
+// 静的なメッシュはノードの階層をルートからたどってワールド変換(行ベクトルの規約で local * parent)を記録し、
+// mergeByMaterial なら同じマテリアルどうしを頂点数が16ビットのインデックスに収まる範囲で1つにまとめる。
+// skeleton のボーンを持つメッシュは関節の階層を Skeleton が持つため、1つずつメッシュ空間のまま変換する
+void CollectMeshSources(const aiScene* scene, const Skeleton* skeleton, bool mergeByMaterial, std::vector<MeshSource>& out)
+{
+    auto addPart = [](MeshSource& source, const aiMesh* mesh, const DirectX::XMFLOAT4X4& transform) {
+        source.parts.push_back(MeshSource::Part{ mesh, transform });
+        source.vertexCount += mesh->mNumVertices;
+        source.indexCount += static_cast<size_t>(mesh->mNumFaces) * 3;
+    };
+
+    std::vector<int> open(scene->mNumMaterials + 1, -1); // マテリアルごとの追加中の結合先(末尾はマテリアルなし)
+    DirectX::XMFLOAT4X4 identity;
+    DirectX::XMStoreFloat4x4(&identity, DirectX::XMMatrixIdentity());
+    std::vector<std::pair<const aiNode*, DirectX::XMFLOAT4X4>> stack{ { scene->mRootNode, identity } };
+    while (!stack.empty()) {
+        const aiNode* node = stack.back().first;
+        DirectX::XMFLOAT4X4 global;
+        DirectX::XMStoreFloat4x4(&global, ToXMMatrix(node->mTransformation) * DirectX::XMLoadFloat4x4(&stack.back().second));
+        stack.pop_back();
+
+        for (unsigned int m = 0; m < node->mNumMeshes; ++m) {
+            const aiMesh* mesh = scene->mMeshes[node->mMeshes[m]];
+            if (skeleton && mesh->HasBones()) continue;
+            if (mesh->mNumVertices == 0 || mesh->mNumFaces == 0) continue;
+
+            const unsigned int material = (std::min)(mesh->mMaterialIndex, scene->mNumMaterials);
+            int& target = open[material];
+            if (!mergeByMaterial || target < 0 || out[target].vertexCount + mesh->mNumVertices > 0xFFFF) {
+                target = static_cast<int>(out.size());
+                out.emplace_back();
+                out.back().materialIndex = material;
+            }
+            addPart(out[target], mesh, global);
+        }
+
+        for (unsigned int c = node->mNumChildren; c-- > 0;) {
+            stack.emplace_back(node->mChildren[c], global);
+        }
+    }
+
+    for (unsigned int i = 0; skeleton && i < scene->mNumMeshes; ++i) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        if (!mesh->HasBones()) continue;
+        MeshSource source;
+        source.materialIndex = mesh->mMaterialIndex;
+        source.skinned = true;
+        addPart(source, mesh, identity);
+        out.push_back(std::move(source));
+    }
+}
+
+} // namespace
+
+// Assimp から変換したメッシュ(キャッシュへの書き出しとバッファ作成に使う)
+struct ModelLoader::CookedMesh {
+    std::vector<SimpleVertex> vertices[MeshCacheEntry::LEVEL_COUNT]; ///< LODごとの頂点
+    std::vector<uint8_t> indices[MeshCacheEntry::LEVEL_COUNT];       ///< LODごとの詰めたインデックス
+    MeshCacheEntry entry;                                            ///< vertices / indices を参照する記述
+    std::vector<SkinInfluence> skin;                                 ///< LOD0 の頂点ごとのスキニングの影響(スキニングされたメッシュのみ)
+
+    // LOD level のデータを設定して entry から参照させる
+    void SetLevel(uint32_t level, std::vector<SimpleVertex>&& levelVertices, const std::vector<uint32_t>& levelIndices) {
+        vertices[level] = std::move(levelVertices);
+        MeshCacheGeometry& geometry = entry.levels[level];
+        geometry.indexStride = PackIndices(levelIndices, vertices[level].size(), indices[level]);
+        geometry.vertices = vertices[level].data();
+        geometry.vertexCount = static_cast<uint32_t>(vertices[level].size());
+        geometry.indices = indices[level].data();
+        geometry.indexCount = static_cast<uint32_t>(levelIndices.size());
+    }
+
+    // source を変換して設定(ワーカーから並列に呼ばれる。scene と skeleton は読み取りのみ)
+    void Cook(const MeshSource& source, const aiScene* scene, const std::string& directory, const Skeleton* skeleton) {
+        std::vector<SimpleVertex> baseVertices;
+        std::vector<uint32_t> baseIndices;
+        baseVertices.reserve(source.vertexCount);
+        baseIndices.reserve(source.indexCount);
+        for (const MeshSource::Part& part : source.parts) {
+            if (source.skinned) {
+                AppendMeshGeometry(part.mesh, nullptr, baseVertices, baseIndices);
+                continue;
+            }
+            const DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&part.transform);
+            AppendMeshGeometry(part.mesh, &transform, baseVertices, baseIndices);
+        }
+        if (baseVertices.empty() || baseIndices.empty()) return;
+
+        // スキニングの影響(頂点ごとに重みの大きい4つまで)
+        if (source.skinned && skeleton) {
+            const aiMesh* mesh = source.parts[0].mesh;
+            std::vector<SkinInfluence::Accumulator> influences(mesh->mNumVertices);
+            for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+                const aiBone* bone = mesh->mBones[b];
+                const int joint = skeleton->Find(bone->mName.C_Str());
+                if (joint < 0) continue;
+                for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+                    const aiVertexWeight& weight = bone->mWeights[w];
+                    if (weight.mVertexId < influences.size()) influences[weight.mVertexId].Add(static_cast<uint8_t>(joint), weight.mWeight);
+                }
+            }
+            skin.reserve(influences.size());
+            for (const SkinInfluence::Accumulator& influence : influences) skin.push_back(influence.Pack());
+        }
+
+        Build(std::move(baseVertices), baseIndices);
+        SetMaterial(scene, source.materialIndex, directory);
+    }
+
+    // LOD0 の頂点からバウンディング球と LOD1, LOD2 を作成して設定(skin は先に設定しておく)
+    void Build(std::vector<SimpleVertex>&& baseVertices, const std::vector<uint32_t>& baseIndices) {
+        entry.boundsRadius = ComputeBoundingSphere(&baseVertices[0].Position, baseVertices.size(), sizeof(SimpleVertex), entry.boundsCenter);
+
+        // LOD1, LOD2 の生成(三角形数が十分に減った場合のみ。スキニングされたメッシュは頂点をまとめると影響が合わなくなるため生成しない)
+        static const int LOD_CELLS[2] = { 24, 10 };
+        std::vector<SimpleVertex> lodVertices;
+        std::vector<uint32_t> lodIndices;
+        size_t previousIndexCount = baseIndices.size();
+        for (uint32_t lod = 0; lod < 2 && skin.empty(); ++lod) {
+            if (!SimplifyByClustering(baseVertices, baseIndices, LOD_CELLS[lod], lodVertices, lodIndices)) break;
+            if (lodIndices.size() * 4 > previousIndexCount * 3) continue; // 25%以上減らなければ使わない
+            previousIndexCount = lodIndices.size();
+            SetLevel(lod + 1, std::move(lodVertices), lodIndices);
+        }
+        SetLevel(0, std::move(baseVertices), baseIndices);
+    }
+
+    // マテリアルのテクスチャと色を設定
+    void SetMaterial(const aiScene* scene, unsigned int materialIndex, const std::string& directory) {
+        if (materialIndex >= scene->mNumMaterials) return;
+        aiMaterial* material = scene->mMaterials[materialIndex];
         // 現時点ではDiffuseテクスチャのみをロード
-        mc.texture = LoadMaterialTextures(material, aiTextureType_DIFFUSE, directory);
-        mc.normalTexture = LoadMaterialTextures(material, aiTextureType_NORMALS, directory);
+        entry.diffusePath = FindMaterialTexture(material, aiTextureType_DIFFUSE, directory);
+        entry.normalPath = FindMaterialTexture(material, aiTextureType_NORMALS, directory);
 
         // マテリアルから色情報を取得 (Ambient/Diffuse/Specularなど、ここではDiffuseを代表として使用)
         aiColor3D color (0.f,0.f,0.f);
         if(AI_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, color)) {
-            mc.color = {color.r, color.g, color.b};
+            entry.color = {color.r, color.g, color.b};
+        }
+    }
+};
+
+std::vector<ModelComponent> ModelLoader::LoadModel(const std::string& filePath)
+{
+    LoadedModel model;
+    if (!LoadGeometry(filePath, model)) {
+        return {};
+    }
+    ResolveTextures(model);
+    return std::move(model.meshes);
+}
+
+void ModelLoader::ResolveTextures(LoadedModel& model)
+{
+    auto& texMgr = ServiceLocator::Get<TextureManager>();
+    auto& gfx = ServiceLocator::Get<GfxDevice>();
+
+    // ノーマルマップは代用できないため同期読み込み(メッシュ間で独立したデコードはまとめて並列に行う)
+    std::vector<std::string> normalPaths;
+    std::vector<size_t> normalMeshes;
+    for (size_t i = 0; i < model.meshes.size(); ++i) {
+        if (model.normalPaths[i].empty()) continue;
+        normalPaths.push_back(model.normalPaths[i]);
+        normalMeshes.push_back(i);
+    }
+    const std::vector<TextureManager::TextureHandle> normals = texMgr.LoadFromFiles(normalPaths);
+    for (size_t n = 0; n < normals.size(); ++n) model.meshes[normalMeshes[n]].normalTexture = normals[n];
+
+    for (size_t i = 0; i < model.meshes.size(); ++i) {
+        const std::string& diffuse = model.diffusePaths[i];
+        // ディフューズは白テクスチャで代用できるためストリーミング
+        model.meshes[i].texture = diffuse.empty() ? TextureManager::INVALID_TEXTURE : texMgr.LoadFromFileAsync(diffuse.c_str());
+        if (model.normalPaths[i].empty()) model.meshes[i].normalTexture = TextureManager::INVALID_TEXTURE;
+
+        // 即時コンテキストを使うため、共有メッシュバッファへの移動もここ(メインスレッド)で行う
+        // (スキニングされたメッシュは影響のストリームと頂点の位置を揃えるため個別のバッファのまま)
+        ModelComponent& mc = model.meshes[i];
+        if (mc.skinBuffer) continue;
+        MoveToMeshPool(gfx, mc.vertexFormat, mc.vertexBuffer, mc.indexBuffer, mc.indexCount, mc.indexFormat, mc.pooled);
+        for (ModelLod& level : mc.lods) {
+            MoveToMeshPool(gfx, mc.vertexFormat, level.vertexBuffer, level.indexBuffer, level.indexCount, level.indexFormat, level.pooled);
+        }
+    }
+}
+
+void ModelLoader::SetVertexFormat(VertexFormat format)
+{
+    VertexFormatSetting().store(format, std::memory_order_relaxed);
+}
+
+VertexFormat ModelLoader::GetVertexFormat()
+{
+    return VertexFormatSetting().load(std::memory_order_relaxed);
+}
+
+void ModelLoader::SetJobSystem(JobSystem* jobs)
+{
+    JobSystemSetting().store(jobs, std::memory_order_release);
+}
+
+void ModelLoader::SetMergeByMaterial(bool merge)
+{
+    MergeByMaterialSetting().store(merge, std::memory_order_relaxed);
+}
+
+bool ModelLoader::IsMergeByMaterial()
+{
+    return MergeByMaterialSetting().load(std::memory_order_relaxed);
+}
+
+bool ModelLoader::LoadGeometry(const std::string& filePath, LoadedModel& out, LoadTimings* timings)
+{
+    auto& gfx = ServiceLocator::Get<GfxDevice>();
+    out = LoadedModel();
+
+    LoadTimings local;
+    LoadTimings& t = timings ? *timings : local;
+    t = LoadTimings();
+    LoadClock::time_point lap = LoadClock::now();
+
+    // メッシュを作成し、作成できたものとテクスチャパスを元の順に追加
+    // (ID3D11Device の生成系はスレッドセーフなので、バッファの作成はメッシュごとにワーカーへ分ける)
+    auto append = [&out, &gfx, &t](const std::vector<MeshUpload>& uploads, const std::shared_ptr<SkinnedModelData>& skinData) {
+        const VertexFormat format = GetVertexFormat();
+        std::vector<ModelComponent> meshes(uploads.size());
+        std::vector<uint8_t> created(uploads.size(), 0);
+        ForEachMesh(uploads.size(), [&](size_t i) {
+            // スキニングされたメッシュは標準の頂点形式(SKINNED の頂点シェーダーが読む形式)で作成する
+            const MeshUpload& upload = uploads[i];
+            ModelComponent& mc = meshes[i];
+            if (!CreateModelComponent(gfx, *upload.entry, upload.skin ? VertexFormat::Standard : format, mc)) return;
+            created[i] = 1;
+            if (upload.skin && CreateSkinBuffer(gfx, *upload.skin, mc.skinBuffer)) mc.skinData = skinData;
+        });
+
+        out.meshes.reserve(out.meshes.size() + uploads.size());
+        out.diffusePaths.reserve(out.diffusePaths.size() + uploads.size());
+        out.normalPaths.reserve(out.normalPaths.size() + uploads.size());
+        for (size_t i = 0; i < uploads.size(); ++i) {
+            if (!created[i]) continue;
+            const MeshCacheEntry& entry = *uploads[i].entry;
+            out.meshes.push_back(std::move(meshes[i]));
+            out.diffusePaths.push_back(entry.diffusePath);
+            out.normalPaths.push_back(entry.normalPath);
+            t.vertexCount += entry.levels[0].vertexCount;
+            t.indexCount += entry.levels[0].indexCount;
+        }
+    };
+
+    // 変換済みキャッシュがあれば Assimp を通さずに読み込む
+    // (元ファイルがない場合はキャッシュをそのまま使う)
+    const std::string cachePath = filePath + MeshCacheFile::EXTENSION;
+    MeshCacheStamp stamp;
+    const bool hasSource = MeshCacheStamp::FromFile(filePath, stamp);
+    const bool mergeByMaterial = IsMergeByMaterial();
+    stamp.importFlags = mergeByMaterial ? IMPORT_FLAG_MERGE_BY_MATERIAL : 0;
+    {
+        MeshCacheFile cache;
+        const bool opened = cache.Open(cachePath, hasSource ? &stamp : nullptr, sizeof(SimpleVertex));
+        t.cacheReadMs = LapMs(lap);
+        if (opened) {
+            std::vector<MeshUpload> uploads;
+            uploads.reserve(cache.Entries().size());
+            for (const MeshCacheEntry& entry : cache.Entries()) uploads.push_back(MeshUpload{ &entry, nullptr });
+            append(uploads, nullptr);
+            t.uploadMs = LapMs(lap);
+            if (!out.meshes.empty()) {
+                t.fromCache = true;
+                DEBUGLOG_CATEGORY(DebugLog::Category::Render, "Model loaded from cache: " + cachePath + ", Meshes: " + std::to_string(out.meshes.size()));
+                return true;
+            }
+        }
+    }
+
+    std::vector<CookedMesh> cooked;
+    std::shared_ptr<SkinnedModelData> skinData;
+    size_t sourceMeshCount = 0;
+    if (!ImportAndCook(filePath, mergeByMaterial, cooked, skinData, sourceMeshCount, t)) {
+        return false;
+    }
+    lap = LoadClock::now();
+
+    // 次回以降のためにキャッシュへ書き出す
+    // (キャッシュはスキニングの影響とスケルトンを持たないため、スキニングされたモデルは毎回 Assimp で読み込む)
+    if (hasSource && !cooked.empty() && !skinData) {
+        std::vector<MeshCacheEntry> entries;
+        entries.reserve(cooked.size());
+        for (const CookedMesh& mesh : cooked) entries.push_back(mesh.entry);
+        if (MeshCacheFile::Write(cachePath, stamp, sizeof(SimpleVertex), entries)) {
+            DEBUGLOG_CATEGORY(DebugLog::Category::Render, "Model cache written: " + cachePath);
         }
     }
+    t.cacheWriteMs = LapMs(lap);
 
-    modelComponents.push_back(mc);
+    std::vector<MeshUpload> uploads;
+    uploads.reserve(cooked.size());
+    for (const CookedMesh& mesh : cooked) uploads.push_back(MeshUpload{ &mesh.entry, mesh.skin.empty() ? nullptr : &mesh.skin });
+    append(uploads, skinData);
+    t.uploadMs = LapMs(lap);
+
+    DEBUGLOG_CATEGORY(DebugLog::Category::Render, "Model loaded: " + filePath + ", Meshes: " + std::to_string(out.meshes.size()) +
+                      " (source meshes: " + std::to_string(sourceMeshCount) + ")");
+    return !out.meshes.empty();
 }
 
-TextureManager::TextureHandle ModelLoader::LoadMaterialTextures(
+ModelLoader::CookResult ModelLoader::CookCache(const std::string& filePath)
+{
+    MeshCacheStamp stamp;
+    if (!MeshCacheStamp::FromFile(filePath, stamp)) return CookResult::Failed;
+    const bool mergeByMaterial = IsMergeByMaterial();
+    stamp.importFlags = mergeByMaterial ? IMPORT_FLAG_MERGE_BY_MATERIAL : 0;
+
+    std::vector<CookedMesh> cooked;
+    std::shared_ptr<SkinnedModelData> skinData;
+    size_t sourceMeshCount = 0;
+    LoadTimings t;
+    if (!ImportAndCook(filePath, mergeByMaterial, cooked, skinData, sourceMeshCount, t) || cooked.empty()) {
+        return CookResult::Failed;
+    }
+    if (skinData) return CookResult::Skinned;
+
+    std::vector<MeshCacheEntry> entries;
+    entries.reserve(cooked.size());
+    for (const CookedMesh& mesh : cooked) entries.push_back(mesh.entry);
+    return MeshCacheFile::Write(filePath + MeshCacheFile::EXTENSION, stamp, sizeof(SimpleVertex), entries) ? CookResult::Written : CookResult::Failed;
+}
+
+bool ModelLoader::RestampCache(const std::string& filePath)
+{
+    MeshCacheStamp stamp;
+    if (!MeshCacheStamp::FromFile(filePath, stamp)) return false;
+    stamp.importFlags = IsMergeByMaterial() ? IMPORT_FLAG_MERGE_BY_MATERIAL : 0;
+    return MeshCacheFile::Restamp(filePath + MeshCacheFile::EXTENSION, stamp);
+}
+
+// Assimp で読み込んでメッシュごとに変換する(バッファは作らない。scene は importer とともにここで破棄する)
+bool ModelLoader::ImportAndCook(const std::string& filePath, bool mergeByMaterial, std::vector<CookedMesh>& cooked,
+                                std::shared_ptr<SkinnedModelData>& skinData, size_t& sourceMeshCount, LoadTimings& t)
+{
+    Assimp::Importer importer;
+    if (AssetArchive::GetInstance().IsMounted()) {
+        importer.SetIOHandler(new ArchiveIOSystem());  // importer が破棄する
+    }
+
+    // モデルをロード(解析とポストプロセスの時間を分けて計測するため、ポストプロセスは後から適用する)
+    // aiProcess_Triangulate: 全てのプリミティブを三角形に変換
+    // aiProcess_FlipUVs: UV座標を反転 (DirectXの慣例に合わせる)
+    // aiProcess_GenNormals: 法線がなければ生成
+    // aiProcess_JoinIdenticalVertices: 同一の頂点を共有してインデックス化
+    // aiProcess_ImproveCacheLocality: 頂点キャッシュのヒット率が上がるよう三角形を並べ替え
+    LoadClock::time_point lap = LoadClock::now();
+    const aiScene* scene = importer.ReadFile(filePath, 0);
+    t.parseMs = LapMs(lap);
+    if (scene) {
+        scene = importer.ApplyPostProcessing(
+            aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals | aiProcess_CalcTangentSpace |
+            aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality);
+        t.postProcessMs = LapMs(lap);
+    }
+
+    // エラーチェック
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        DEBUGLOG_ERROR("Assimp Error: " + std::string(importer.GetErrorString()));
+        return false;
+    }
+
+    // ファイルパスからディレクトリを抽出
+    std::string directory = filePath.substr(0, filePath.find_last_of('/'));
+    if (directory.empty()) {
+        directory = filePath.substr(0, filePath.find_last_of('\\'));
+    }
+
+    // ボーンを持つメッシュがあればスケルトンとアニメーションクリップを読み込む
+    skinData = std::make_shared<SkinnedModelData>();
+    if (BuildSkeleton(scene, skinData->skeleton)) {
+        ImportClips(scene, skinData->skeleton, skinData->clips);
+        DEBUGLOG_CATEGORY(DebugLog::Category::Render, "Skeleton loaded: " + filePath + ", Joints: " + std::to_string(skinData->skeleton.JointCount()) +
+                          ", Clips: " + std::to_string(skinData->clips.size()));
+    } else {
+        skinData.reset();
+    }
+
+    // 静的なメッシュはノードの階層をたどって変換を焼き込み、マテリアルごとに結合する
+    // スキニングされたメッシュは関節の階層を Skeleton が持つため、メッシュ空間のまま1メッシュずつ処理する
+    // 変換(頂点の読み取り・LODの生成)はメッシュごとに独立しているので、変換先を先に確保してワーカーに分ける
+    const Skeleton* skeleton = skinData ? &skinData->skeleton : nullptr;
+    std::vector<MeshSource> sources;
+    CollectMeshSources(scene, skeleton, mergeByMaterial, sources);
+    cooked.clear();
+    cooked.resize(sources.size());
+    ForEachMesh(sources.size(), [&](size_t i) { cooked[i].Cook(sources[i], scene, directory, skeleton); });
+    cooked.erase(std::remove_if(cooked.begin(), cooked.end(), [](const CookedMesh& mesh) { return mesh.entry.levels[0].vertexCount == 0; }), cooked.end());
+    sourceMeshCount = scene->mNumMeshes;
+    t.convertMs = LapMs(lap);
+    return true;
+}
+
+std::string ModelLoader::FindMaterialTexture(
     aiMaterial* mat,
     aiTextureType type,
     const std::string& directory
 ) {
-    auto& texMgr = ServiceLocator::Get<TextureManager>();
-    TextureManager::TextureHandle textureHandle = TextureManager::INVALID_TEXTURE;
     for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
         aiString str;
         mat->GetTexture(type, i, &str);
         std::string filename = str.C_Str();
-        
+
         // テクスチャパスを構築 (モデルファイルと同じディレクトリを基準)
         std::string fullPath = directory + "/" + filename;
-        
-        // テクスチャマネージャーでロード
-        textureHandle = texMgr.LoadFromFile(fullPath.c_str());
-        if (textureHandle != TextureManager::INVALID_TEXTURE) {
-            DEBUGLOG_CATEGORY(DebugLog::Category::Render, "Loaded texture: " + fullPath);
-            break; // 最初のテクスチャのみを使用
-        } else {
-            DEBUGLOG_WARNING("Failed to load texture: " + fullPath);
+
+        // 存在する最初のテクスチャのみを使用(読み込みは ResolveTextures でメインスレッドから行う)
+        if (AssetArchive::Exists(fullPath)) {
+            return fullPath;
         }
+        DEBUGLOG_WARNING("Texture not found: " + fullPath);
     }
-    return textureHandle;
-}
\ No newline at end of file
+    return std::string();
+}
@@ -58,6 +58,7 @@ bool GamepadSystem::Init() {
         XINPUT_STATE state;
         ZeroMemory(&state, sizeof(state));
         DWORD result = XInputGetState(i, &state);
+        xinputPresent_[i].store(result == ERROR_SUCCESS, std::memory_order_relaxed);
         if (result == ERROR_SUCCESS) {
             gamepads_[i].type = Type_XInput;
             gamepads_[i].connected = true; // 初期状態として接続済みを予約
@@ -82,20 +83,13 @@ bool GamepadSystem::Init() {
         std::ostringstream oss;
         oss << "GamepadSystem::Init() - DirectInput8の作成に失敗: HRESULT=0x" << std::hex << hr;
         DEBUGLOG_ERROR(oss.str());
-        return false;
+        dinput_ = nullptr;
     }
 
-    // DirectInputデバイスを列挙
-    hr = dinput_->EnumDevices(
-        DI8DEVCLASS_GAMECTRL,
-        EnumDevicesCallback,
-        this,
-        DIEDFL_ATTACHEDONLY);
-
-    if (FAILED(hr)) {
-        std::ostringstream oss;
-        oss << "GamepadSystem::Init() - デバイス列挙に失敗: HRESULT=0x" << std::hex << hr;
-        DEBUGLOG_ERROR(oss.str());
+    // 接続の検出とDirectInputデバイスの列挙(WMIで数百ms)はバックグラウンドのスレッドで行う
+    window_ = GetActiveWindow();
+    StartDeviceThread();
+    if (!dinput_) {
         return false;
     }
 
@@ -111,7 +105,14 @@ void GamepadSystem::Shutdown() {
     DEBUGLOG_CATEGORY(DebugLog::Category::Input, "GamepadSystem::Shutdown() - シャットダウン開始");
 #endif
 
-    //すべてのDirectInputデバイスを解放
+    // 列挙スレッドを止めてから、受け取っていないデバイスとすべてのDirectInputデバイスを解放
+    StopDeviceThread();
+    for (PendingDevice &pending : pendingDevices_) {
+        SAFE_RELEASE(pending.device);
+    }
+    pendingDevices_.clear();
+    pendingReady_.store(false, std::memory_order_relaxed);
+
     for (int i = 0; i < MAX_GAMEPADS; ++i) {
         if (gamepads_[i].dinputDevice) {
             gamepads_[i].dinputDevice->Unacquire();
@@ -133,7 +134,7 @@ void GamepadSystem::Shutdown() {
 // 更新処理
 // ========================================================
 
-void GamepadSystem::Update() {
+void GamepadSystem::Update(int64_t untilTime) {
 #ifdef _DEBUG
     static int frameCounter = 0;
     static int logInterval = 300; //5秒ごと(60FPS想定)
@@ -149,15 +150,27 @@ void GamepadSystem::Update() {
     static auto lastTime = std::chrono::high_resolution_clock::now();
     auto currentTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float> elapsed = currentTime - lastTime;
-    deltaTime_ = elapsed.count();
+    deltaTime_ = fixedDeltaTime_ > 0.0f ? fixedDeltaTime_ : elapsed.count();
     lastTime = currentTime;
 
+    const bool sampled = sampled_.load(std::memory_order_acquire);
+    if (sampled) {
+        DrainXInputSamples(untilTime);
+    }
+
+    // 列挙スレッドが作成したDirectInputデバイスを受け取る(待たない)
+    AdoptPendingDevices();
+
     // XInputデバイスを最初にチェック(0-3のスロット)
+    // 未接続のスロットの XInputGetState は遅いため、接続はバックグラウンドのスレッドが確認する
     for (DWORD i = 0; i < XUSER_MAX_COUNT; ++i) {
         XINPUT_STATE state;
         ZeroMemory(&state, sizeof(XINPUT_STATE));
 
-        DWORD result = XInputGetState(i, &state);
+        DWORD result = ERROR_DEVICE_NOT_CONNECTED;
+        if (xinputPresent_[i].load(std::memory_order_acquire)) {
+            result = XInputGetState(i, &state);
+        }
 
 #ifdef _DEBUG
         if (shouldLog) {
@@ -218,8 +231,9 @@ void GamepadSystem::Update() {
             }
             UpdateXInput(static_cast<int>(i));
         } else {
-            // XInputデバイスが切断された
-            if (gamepads_[i].type == Type_XInput) {
+            // XInputデバイスが切断された(以降はバックグラウンドのスレッドが再接続を確認)
+            xinputPresent_[i].store(false, std::memory_order_release);
+            if (gamepads_[i].type == Type_XInput && gamepads_[i].connected) {
                 gamepads_[i].connected = false;
 #ifdef _DEBUG
                 std::ostringstream oss;
@@ -262,10 +276,18 @@ void GamepadSystem::UpdateXInput(int index) {
     XINPUT_STATE state;
     ZeroMemory(&state, sizeof(XINPUT_STATE));
 
-    DWORD result = XInputGetState(pad.xinputIndex, &state);
-    if (result != ERROR_SUCCESS) {
-        pad.connected = false;
-        return;
+    const DWORD slot = pad.xinputIndex;
+    if (sampled_.load(std::memory_order_acquire) && slot < MAX_GAMEPADS && hasSampledPad_[slot]) {
+        // InputSampler の最新のサンプル(途中で押されていたボタンも押下として扱う)
+        state.Gamepad = sampledPad_[slot];
+        state.Gamepad.wButtons |= sampledPressed_[slot];
+        sampledPressed_[slot] = 0;
+    } else {
+        DWORD result = XInputGetState(slot, &state);
+        if (result != ERROR_SUCCESS) {
+            pad.connected = false;
+            return;
+        }
     }
 
     pad.connected = true;
@@ -345,6 +367,63 @@ void GamepadSystem::UpdateXInput(int index) {
         pad.rightTrigger = 0.0f;
 }
 
+void GamepadSystem::CaptureReplayFrame(ReplayFrame &out) const {
+    for (int i = 0; i < MAX_GAMEPADS; ++i) {
+        const GamepadState &pad = gamepads_[i];
+        ReplayPad &dst = out.pads[i];
+        dst.connected = pad.connected;
+        memcpy(dst.buttons, pad.buttons, sizeof(dst.buttons));
+        dst.leftStickX = pad.leftStickX;
+        dst.leftStickY = pad.leftStickY;
+        dst.rightStickX = pad.rightStickX;
+        dst.rightStickY = pad.rightStickY;
+        dst.leftTrigger = pad.leftTrigger;
+        dst.rightTrigger = pad.rightTrigger;
+    }
+}
+
+void GamepadSystem::ApplyReplayFrame(const ReplayFrame &frame) {
+    deltaTime_ = fixedDeltaTime_;
+    for (int i = 0; i < MAX_GAMEPADS; ++i) {
+        GamepadState &pad = gamepads_[i];
+        const ReplayPad &src = frame.pads[i];
+        memcpy(pad.prevButtons, pad.buttons, sizeof(pad.buttons));
+        pad.connected = src.connected;
+        memcpy(pad.buttons, src.buttons, sizeof(pad.buttons));
+        pad.leftStickX = src.leftStickX;
+        pad.leftStickY = src.leftStickY;
+        pad.rightStickX = src.rightStickX;
+        pad.rightStickY = src.rightStickY;
+        pad.leftTrigger = src.leftTrigger;
+        pad.rightTrigger = src.rightTrigger;
+        UpdateChargeSystem(i, deltaTime_);
+    }
+}
+
+void GamepadSystem::PushXInputSample(DWORD slot, const XINPUT_GAMEPAD &pad, int64_t time) {
+    if (slot >= MAX_GAMEPADS)
+        return;
+    const uint32_t write = sampleWrite_.load(std::memory_order_relaxed);
+    if (write - sampleRead_.load(std::memory_order_acquire) >= SAMPLE_RING_SIZE)
+        return;
+    samples_[write & (SAMPLE_RING_SIZE - 1)] = XInputSample{time, slot, pad};
+    sampleWrite_.store(write + 1, std::memory_order_release);
+}
+
+void GamepadSystem::DrainXInputSamples(int64_t untilTime) {
+    const uint32_t write = sampleWrite_.load(std::memory_order_acquire);
+    uint32_t read = sampleRead_.load(std::memory_order_relaxed);
+    for (; read != write; ++read) {
+        const XInputSample &sample = samples_[read & (SAMPLE_RING_SIZE - 1)];
+        if (sample.time > untilTime)
+            break; // 次のステップの分
+        sampledPad_[sample.slot] = sample.pad;
+        sampledPressed_[sample.slot] |= sample.pad.wButtons;
+        hasSampledPad_[sample.slot] = true;
+    }
+    sampleRead_.store(read, std::memory_order_release);
+}
+
 void GamepadSystem::UpdateDInput(int index) {
     if (index < 0 || index >= MAX_GAMEPADS)
         return;
@@ -910,29 +989,186 @@ void GamepadSystem::ApplyDeadzone(float x, float y, float &outX, float &outY, fl
 // DirectInput デバイス列挙
 // ========================================================
 
-BOOL CALLBACK GamepadSystem::EnumDevicesCallback(LPCDIDEVICEINSTANCE lpddi, LPVOID pvRef) {
-    GamepadSystem *pThis = static_cast<GamepadSystem *>(pvRef);
-    if (!pThis)
-        return DIENUM_STOP;
+void GamepadSystem::OnDeviceChange() {
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex_);
+        enumRequested_ = true;
+    }
+    deviceCv_.notify_one();
+}
 
-    // XInputデバイスはスキップ
-    if (IsXInputDevice(&lpddi->guidProduct)) {
-        return DIENUM_CONTINUE;
+void GamepadSystem::StartDeviceThread() {
+    if (deviceThread_.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex_);
+        deviceStop_ = false;
+        enumRequested_ = dinput_ != nullptr;
     }
+    try {
+        deviceThread_ = std::thread([this]() { DeviceThreadLoop(); });
+    } catch (const std::exception &e) {
+        DEBUGLOG_ERROR(std::string("GamepadSystem - 列挙スレッドの起動失敗: ") + e.what());
+    }
+}
 
-    // 空きスロットを探す（XInput予約スロットは使用しない）
-    int slot = -1;
-    for (int i = 0; i < MAX_GAMEPADS; ++i) {
-        // Type_None のスロットのみ使用（XInputと競合しない）
-        if (pThis->gamepads_[i].type == Type_None) {
-            slot = i;
-            break;
+void GamepadSystem::StopDeviceThread() {
+    if (!deviceThread_.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex_);
+        deviceStop_ = true;
+    }
+    deviceCv_.notify_one();
+    deviceThread_.join();
+}
+
+void GamepadSystem::DeviceThreadLoop() {
+    HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+    std::unique_lock<std::mutex> lock(deviceMutex_);
+    while (!deviceStop_) {
+        const bool enumerate = enumRequested_;
+        enumRequested_ = false;
+        lock.unlock();
+
+        // 未接続のXInputスロットを確認
+        for (DWORD i = 0; i < XUSER_MAX_COUNT && i < MAX_GAMEPADS; ++i) {
+            if (xinputPresent_[i].load(std::memory_order_acquire))
+                continue;
+            XINPUT_STATE state;
+            ZeroMemory(&state, sizeof(state));
+            if (XInputGetState(i, &state) == ERROR_SUCCESS) {
+                xinputPresent_[i].store(true, std::memory_order_release);
+            }
+        }
+
+        // DirectInputデバイスを列挙し、作成したデバイスをメインスレッドに渡す
+        if (enumerate && dinput_) {
+            std::vector<PendingDevice> found;
+            EnumContext context{ this, &found };
+            HRESULT hr = dinput_->EnumDevices(DI8DEVCLASS_GAMECTRL, EnumDevicesCallback, &context, DIEDFL_ATTACHEDONLY);
+            if (FAILED(hr)) {
+                std::ostringstream oss;
+                oss << "GamepadSystem - デバイス列挙に失敗: HRESULT=0x" << std::hex << hr;
+                DEBUGLOG_ERROR(oss.str());
+            }
+            std::lock_guard<std::mutex> pendingLock(pendingMutex_);
+            for (PendingDevice &device : found) {
+                pendingDevices_.push_back(device);
+            }
+            if (!found.empty()) {
+                pendingReady_.store(true, std::memory_order_release);
+            }
+        }
+
+        lock.lock();
+        deviceCv_.wait_for(lock, std::chrono::milliseconds(XINPUT_PROBE_INTERVAL_MS), [this]() { return deviceStop_ || enumRequested_; });
+    }
+    lock.unlock();
+
+    if (SUCCEEDED(hrCom))
+        CoUninitialize();
+}
+
+void GamepadSystem::AdoptPendingDevices() {
+    if (!pendingReady_.load(std::memory_order_acquire))
+        return;
+
+    std::vector<PendingDevice> devices;
+    {
+        std::unique_lock<std::mutex> lock(pendingMutex_, std::try_to_lock);
+        if (!lock.owns_lock())
+            return; // 次のフレームで受け取る
+        devices.swap(pendingDevices_);
+        pendingReady_.store(false, std::memory_order_relaxed);
+    }
+
+    for (PendingDevice &pending : devices) {
+        // 同じデバイスがすでにスロットにある場合、接続中なら新しい方を捨て、切断中なら入れ替える
+        int slot = -1;
+        for (int i = 0; i < MAX_GAMEPADS; ++i) {
+            if (gamepads_[i].type == Type_DInput && IsEqualGUID(gamepads_[i].dinputInstance, pending.instance)) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot >= 0) {
+            if (gamepads_[slot].connected) {
+                SAFE_RELEASE(pending.device);
+                continue;
+            }
+            gamepads_[slot].dinputDevice->Unacquire();
+            SAFE_RELEASE(gamepads_[slot].dinputDevice);
+        } else {
+            // 空きスロットを探す（XInput予約スロットは使用しない）
+            for (int i = 0; i < MAX_GAMEPADS; ++i) {
+                if (gamepads_[i].type == Type_None) {
+                    slot = i;
+                    break;
+                }
+            }
+            if (slot == -1) {
+                DEBUGLOG_WARNING("DirectInputデバイスの空きスロットがありません");
+                SAFE_RELEASE(pending.device);
+                continue;
+            }
+        }
+
+        // 協調レベルを設定(バックグラウンドでも動作、排他的でない)
+        HRESULT hr = pending.device->SetCooperativeLevel(window_, DISCL_BACKGROUND | DISCL_NONEXCLUSIVE);
+        if (FAILED(hr)) {
+            std::ostringstream oss;
+            oss << "GamepadSystem - 協調レベル設定失敗: HRESULT=0x" << std::hex << hr;
+            DEBUGLOG_ERROR(oss.str());
+            SAFE_RELEASE(pending.device);
+            continue;
+        }
+
+        // デバイスを取得
+        hr = pending.device->Acquire();
+        if (FAILED(hr)) {
+            //取得失敗は致命的ではない(後で再取得可能)
+#ifdef _DEBUG
+            DEBUGLOG_WARNING("DirectInputデバイスの初回Acquireに失敗（後で再取得を試みます）");
+#endif
         }
+
+        // ゲームパッド状態に設定
+        gamepads_[slot].type = Type_DInput;
+        gamepads_[slot].connected = true;
+        gamepads_[slot].dinputDevice = pending.device;
+        gamepads_[slot].dinputInstance = pending.instance;
+
+#ifdef _DEBUG
+        std::ostringstream oss;
+        oss << "GamepadSystem - DirectInputデバイス登録: Slot=" << slot;
+        DEBUGLOG_CATEGORY(DebugLog::Category::Input, oss.str());
+#endif
     }
+}
 
-    if (slot == -1) {
-        // 空きスロットなし
-        DEBUGLOG_WARNING("DirectInputデバイスの空きスロットがありません");
+BOOL CALLBACK GamepadSystem::EnumDevicesCallback(LPCDIDEVICEINSTANCE lpddi, LPVOID pvRef) {
+    EnumContext *context = static_cast<EnumContext *>(pvRef);
+    if (!context || !context->self)
+        return DIENUM_STOP;
+    GamepadSystem *pThis = context->self;
+
+    // XInputデバイスはスキップ(WMIの問い合わせは製品ごとに1回だけ)
+    bool isXInput = false;
+    bool cached = false;
+    for (const auto &entry : pThis->xinputProducts_) {
+        if (IsEqualGUID(entry.first, lpddi->guidProduct)) {
+            isXInput = entry.second;
+            cached = true;
+            break;
+        }
+    }
+    if (!cached) {
+        isXInput = IsXInputDevice(&lpddi->guidProduct);
+        pThis->xinputProducts_.emplace_back(lpddi->guidProduct, isXInput);
+    }
+    if (isXInput) {
         return DIENUM_CONTINUE;
     }
 
@@ -956,16 +1192,6 @@ BOOL CALLBACK GamepadSystem::EnumDevicesCallback(LPCDIDEVICEINSTANCE lpddi, LPVO
         return DIENUM_CONTINUE;
     }
 
-    // 協調レベルを設定(バックグラウンドでも動作、排他的でない)
-    hr = device->SetCooperativeLevel(GetActiveWindow(), DISCL_BACKGROUND | DISCL_NONEXCLUSIVE);
-    if (FAILED(hr)) {
-        std::ostringstream oss;
-        oss << "GamepadSystem::EnumDevicesCallback() - 協調レベル設定失敗: HRESULT=0x" << std::hex << hr;
-        DEBUGLOG_ERROR(oss.str());
-        SAFE_RELEASE(device);
-        return DIENUM_CONTINUE;
-    }
-
     // 軸の範囲を設定（-32767 ～ +32767ではなく、0 ～65535）
     DIPROPRANGE diprg;
     diprg.diph.dwSize = sizeof(DIPROPRANGE);
@@ -985,24 +1211,12 @@ BOOL CALLBACK GamepadSystem::EnumDevicesCallback(LPCDIDEVICEINSTANCE lpddi, LPVO
 #endif
     }
 
-    // デバイスを取得
-    hr = device->Acquire();
-    if (FAILED(hr)) {
-        //取得失敗は致命的ではない(後で再取得可能)
-#ifdef _DEBUG
-        DEBUGLOG_WARNING("DirectInputデバイスの初回Acquireに失敗（後で再取得を試みます）");
-#endif
-    }
-
-    // ゲームパッド状態に設定
-    pThis->gamepads_[slot].type = Type_DInput;
-    pThis->gamepads_[slot].connected = true;
-    pThis->gamepads_[slot].dinputDevice = device;
+    // 協調レベルの設定と Acquire はメインスレッドが受け取るときに行う
+    context->found->push_back(PendingDevice{ device, lpddi->guidInstance });
 
 #ifdef _DEBUG
     std::ostringstream oss;
-    oss << "GamepadSystem::EnumDevicesCallback() - DirectInputデバイス登録: Slot=" << slot
-        << ", Name=" << lpddi->tszProductName;
+    oss << "GamepadSystem::EnumDevicesCallback() - DirectInputデバイス検出: Name=" << lpddi->tszProductName;
     DEBUGLOG_CATEGORY(DebugLog::Category::Input, oss.str());
 #endif
 
@@ -17,7 +17,12 @@
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <Windows.h>
+#include <cstring>
+#include <cstdlib>
 #include "app/App.h"
+#include "app/AssetArchive.h"
+#include "app/StartupReport.h"
+#include "graphics/ModelLoader.h"
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -31,7 +36,23 @@
  * 
  * @param[in] hInst アプリケーションのインスタンスハンドル
  * @param[in] HINSTANCE 前のインスタンス(常にNULL、互換性のため残されている)
- * @param[in] LPSTR コマンドライン引数(未使用)
+ * @param[in] cmdLine コマンドライン引数(`--render-benchmark` で描画の負荷計測シーンを起動、
+ *                    `--asset-benchmark` で読み込み時間を計測して終了、
+ *                    `--replay-capture <path>` で F11 で記録した描画キューを再生して計測して終了、
+ *                    `--bench <scenario>` でシナリオを決まったフレーム数だけ実行して結果を CSV に追記して終了、
+ *                    `--headless` でウィンドウを表示せずにシミュレーションだけを全速で進めて終了、
+ *                    `--warp` でハードウェアの代わりにソフトウェアラスタライザ(WARP)で描画、
+ *                    `--compact-vertices` / `--quantized-vertices` でモデルを小さな頂点形式で読み込む、
+ *                    `--no-mesh-merge` でモデルのメッシュをマテリアルごとに結合せずに読み込む、
+ *                    `--texture-vram-mb=N` でテクスチャのVRAMを N MB までに抑える、
+ *                    `--frame-budget[=ms]` でフレーム時間の予算(既定はリフレッシュ間隔)に合わせて品質を自動で上げ下げする、
+ *                    `--input-thread[=Hz]` で入力を専用スレッドで受け取る、
+ *                    `--workers=N` / `--pin-threads` / `--reserve-cores=main,input,sim,video` / `--worker-priority=N` で
+ *                    ワーカー数とスレッドのコアの割り当てを指定する、
+ *                    `--stats-hz=N` でタイトルとオーバーレイの数値を毎秒 N 回更新する、
+ *                    `--record-input <path>` / `--replay-input <path>` で入力を記録・再生する、
+ *                    `--pak <path>` / `--no-pak` で読み込むアーカイブを指定する、
+ *                    `--build-pak` で Assets をアーカイブにまとめて終了)
  * @param[in] int ウィンドウの表示状態(未使用)
  * @return int 終了コード(0=成功、-1=失敗)
  * 
@@ -39,23 +60,130 @@
  * アプリケーションの初期化と実行を行います。
  * 
  * ### 処理の流れ:
- * 1. Appクラスのインスタンスを作成
+ * 1. Appクラスのインスタンスを作成(`--render-benchmark` / `--bench` の場合は計測シーンを指定)
  * 2. Init()で初期化(DirectX11、ECS、シーンなど)
  * 3. 初期化に失敗した場合、エラーメッセージを表示して終了
- * 4. Run()でメインループを実行
+ * 4. Run()でメインループを実行(`--asset-benchmark` の場合は代わりに RunAssetBenchmark())
  * 5. アプリケーション終了
  * 
  * @note DirectX11がサポートされていない環境では初期化に失敗します
  * @see App アプリケーションクラス
  */
-int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int) {
+int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR cmdLine, int) {
+    // 起動時間の計測の起点(最初の Present の後に startup_report.csv へ追記)
+    StartupReport::GetInstance().Begin();
+
     // アプリケーションインスタンスを作成
     App app;
 
+    // 描画の負荷計測(RenderBenchmark.h のコマンドラインを参照)
+    RenderBenchmarkConfig benchmarkConfig;
+    if (RenderBenchmarkConfig::Parse(cmdLine, benchmarkConfig)) {
+        app.EnableRenderBenchmark(benchmarkConfig);
+    }
+
+    // 記録したフレームの再生(RenderBenchmark.h のコマンドラインを参照)
+    FrameReplayConfig frameReplayConfig;
+    if (FrameReplayConfig::Parse(cmdLine, frameReplayConfig)) {
+        app.EnableFrameReplay(frameReplayConfig);
+    }
+
+    // シナリオの計測(ScenarioBenchmark.h のコマンドラインを参照)
+    ScenarioBenchmarkConfig scenarioConfig;
+    if (ScenarioBenchmarkConfig::Parse(cmdLine, scenarioConfig)) {
+        if (!ScenarioBenchmarkConfig::IsKnownScenario(scenarioConfig.scenario)) {
+            // 夜間の計測で止まらないようメッセージボックスは出さない
+            DEBUGLOG_ERROR("不明なシナリオです: " + scenarioConfig.scenario + " (crowd / render / game)");
+            return -1;
+        }
+        app.EnableScenarioBenchmark(scenarioConfig);
+    }
+
+    // ヘッドレス実行(HeadlessRun.h のコマンドラインを参照)と WARP での描画
+    HeadlessConfig headlessConfig;
+    if (HeadlessConfig::Parse(cmdLine, headlessConfig)) {
+        app.EnableHeadless(headlessConfig);
+    }
+    if (cmdLine && std::strstr(cmdLine, "--warp")) {
+        app.EnableWarp();
+    }
+
+    // 読み込むモデルの頂点形式(VertexFormat.h を参照)
+    if (cmdLine && std::strstr(cmdLine, "--quantized-vertices")) {
+        ModelLoader::SetVertexFormat(VertexFormat::CompactQuantized);
+    } else if (cmdLine && std::strstr(cmdLine, "--compact-vertices")) {
+        ModelLoader::SetVertexFormat(VertexFormat::Compact);
+    }
+
+    // 同じマテリアルのメッシュの結合(ModelLoader::SetMergeByMaterial を参照、既定は結合する)
+    if (cmdLine && std::strstr(cmdLine, "--no-mesh-merge")) {
+        ModelLoader::SetMergeByMaterial(false);
+    }
+
+    // テクスチャのVRAMの予算(TextureManager::SetResidencyBudget を参照、既定は無制限)
+    if (const char* option = cmdLine ? std::strstr(cmdLine, "--texture-vram-mb=") : nullptr) {
+        int megabytes = std::atoi(option + 18);
+        if (megabytes > 0) app.SetTextureVramBudget(static_cast<size_t>(megabytes) * 1024 * 1024);
+    }
+
+    // フレーム時間の予算に合わせた品質の自動調整(QualityGovernor.h を参照、既定は無効)
+    if (const char* option = cmdLine ? std::strstr(cmdLine, "--frame-budget") : nullptr) {
+        app.EnableQualityGovernor(option[14] == '=' ? static_cast<float>(std::atof(option + 15)) : 0.0f);
+    }
+
+    // タイトルとオーバーレイの数値の更新頻度(App::SetStatsDisplayRate を参照、既定 4Hz)
+    if (const char* option = cmdLine ? std::strstr(cmdLine, "--stats-hz=") : nullptr) {
+        const float hz = static_cast<float>(std::atof(option + 11));
+        if (hz > 0.0f) app.SetStatsDisplayRate(hz);
+    }
+
+    // 入力の専用スレッド(InputSampler.h を参照、既定 1000Hz)
+    if (const char* option = cmdLine ? std::strstr(cmdLine, "--input-thread") : nullptr) {
+        int rate = option[14] == '=' ? std::atoi(option + 15) : 0;
+        app.EnableInputSampling(rate > 0 ? static_cast<uint32_t>(rate) : InputSampler::DEFAULT_RATE_HZ);
+    }
+
+    // ワーカー数とスレッドの配置(ThreadPlacement.h を参照、既定は OS の配置)
+    ThreadPlacementConfig placementConfig;
+    if (ThreadPlacementConfig::Parse(cmdLine, placementConfig)) {
+        app.SetThreadPlacement(placementConfig);
+    }
+
+    // 入力の記録・再生(InputReplay.h を参照)
+    InputReplayConfig replayConfig;
+    if (InputReplayConfig::Parse(cmdLine, replayConfig)) {
+        app.EnableInputReplay(replayConfig);
+    }
+
+    // アセットのアーカイブ(AssetArchive.h を参照、Assets.pak があれば個別のファイルより優先)
+    AssetArchiveConfig archiveConfig;
+    AssetArchiveConfig::Parse(cmdLine, archiveConfig);
+    if (archiveConfig.build) {
+        std::string error;
+        if (!AssetArchive::Build(archiveConfig.sourceDirectory, archiveConfig.path, archiveConfig.compress, error)) {
+            DEBUGLOG_ERROR("アーカイブの作成に失敗しました: " + error);
+            return -1;
+        }
+        return 0;
+    }
+    if (archiveConfig.mount && GetFileAttributesA(archiveConfig.path.c_str()) != INVALID_FILE_ATTRIBUTES) {
+        StartupReport::Scope scope("AssetArchive.Mount");
+        AssetArchive::GetInstance().Mount(archiveConfig.path);
+    }
+
     // 初期化
-    if (!app.Init(hInst)) {
-        MessageBoxA(nullptr, "Initialization failed!\nCheck DirectX 11 support.", "Error", MB_ICONERROR | MB_OK);
-        return -1;
+    {
+        StartupReport::Scope scope("App.Init");
+        if (!app.Init(hInst)) {
+            MessageBoxA(nullptr, "Initialization failed!\nCheck DirectX 11 support.", "Error", MB_ICONERROR | MB_OK);
+            return -1;
+        }
+    }
+
+    // 読み込み時間の計測(AssetBenchmark.h のコマンドラインを参照)
+    AssetBenchmarkConfig assetConfig;
+    if (AssetBenchmarkConfig::Parse(cmdLine, assetConfig)) {
+        return app.RunAssetBenchmark(assetConfig) ? 0 : -1;
     }
 
     // メインループを実行
@@ -0,0 +1,541 @@
+/**
+ * @file AssetCooker.cpp
+ * @brief Assets を実行時の形式へ事前に変換するツール(HEW_COOK)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 実行時の読み込みが「そのまま GPU に渡せるデータを読むだけ」になるよう、次の順に変換します。
+ * - models   : モデル(.fbx / .obj / .gltf / .glb / .dae)を ModelLoader::CookCache() で Assimp に通し、隣に .meshcache を書き出す
+ *              (スキニングされたモデルはキャッシュを持たないため元ファイルのまま)
+ * - textures : 画像(.png / .jpg / .jpeg / .bmp / .tga)を texconv で同じ名前の .dds(ミップ付き)に変換する
+ *              (名前が _n / _normal / _nrm で終わる画像は BC5、それ以外は BC7 sRGB。tools/Convert-Textures.ps1 と同じ規則)
+ * - shaders  : HEW_GAME.exe を `--headless --headless-frames 1` で起動し、起動時にコンパイルするシェーダーを ShaderCache に書き出させる
+ *              (シェーダーはソースに埋め込まれているため、同じ構成のゲーム本体にコンパイルさせる)
+ * - pak      : 変換結果と、変換の対象でないファイルを AssetArchive にまとめる(変換済みの元ファイルは含めない)
+ *              作った後にマウントし、含めた全ファイルが実行時のパス("./" なし)で引けるかを確かめる
+ *
+ * 変換は入力の内容のハッシュ(FNV-1a)で判定し、前回と同じ内容で出力が残っていれば飛ばします。
+ * 判定の記録は `--manifest`(既定 Assets.cook)に書き、変換処理の版(COOK_VERSION、MeshCacheFile::VERSION)を変えると全体を作り直します。
+ * 更新日時だけが変わったモデルは変換し直さず、.meshcache の元ファイルの記録だけを合わせます(ModelLoader::RestampCache)。
+ * モデルと画像の変換は JobSystem のワーカーで並列に行います。
+ *
+ * @par 使用例
+ * @code
+ * HEW_COOK.exe                                  // Assets を変換して Assets.pak を作る
+ * HEW_COOK.exe --force --texconv tools\texconv.exe
+ * HEW_COOK.exe --no-shaders --no-pak            // モデルと画像だけ
+ * @endcode
+ *
+ * @note 作業ディレクトリはゲームと同じ(Assets と ShaderCache の親)で実行してください。
+ */
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include "app/AssetArchive.h"
+#include "app/JobSystem.h"
+#include "graphics/MeshCache.h"
+#include "graphics/ModelLoader.h"
+#include "graphics/ShaderCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+
+namespace {
+
+constexpr uint32_t COOK_VERSION = 1;  ///< 変換の規則を変えたら上げる(全体を作り直す)
+
+/**
+ * @struct CookOptions
+ * @brief コマンドライン引数
+ */
+struct CookOptions {
+    std::string assets = "Assets";          ///< 変換するディレクトリ
+    std::string pak = "Assets.pak";         ///< 出力するアーカイブ
+    std::string manifest = "Assets.cook";   ///< 変換の記録
+    std::string game = "";                  ///< シェーダーをコンパイルさせるゲーム本体(空ならツールと同じディレクトリの HEW_GAME.exe)
+    std::string texconv = "";               ///< texconv.exe(空なら PATH と tools)
+    bool force = false;                     ///< 記録を無視してすべて変換する
+    bool models = true;
+    bool textures = true;
+    bool shaders = true;
+    bool buildPak = true;
+    bool compress = true;                   ///< アーカイブで縮むファイルを圧縮する
+    bool mergeByMaterial = true;            ///< ModelLoader::SetMergeByMaterial(ゲームの `--no-mesh-merge` と合わせる)
+};
+
+/**
+ * @enum CookStatus
+ * @brief 1つの入力の変換結果
+ */
+enum class CookStatus {
+    Cooked,    ///< 変換した
+    UpToDate,  ///< 前回の出力をそのまま使う
+    Failed     ///< 失敗した
+};
+
+/**
+ * @struct ManifestEntry
+ * @brief 1つの変換の記録
+ */
+struct ManifestEntry {
+    uint64_t hash = 0;      ///< 入力の内容と変換の設定のハッシュ
+    std::string output;     ///< 出力ファイル(出力を持たない場合は "-")
+};
+
+using Manifest = std::unordered_map<std::string, ManifestEntry>;
+
+/**
+ * @struct CookStats
+ * @brief 段階ごとの件数
+ */
+struct CookStats {
+    std::atomic<int> cooked{ 0 };
+    std::atomic<int> upToDate{ 0 };
+    std::atomic<int> failed{ 0 };
+};
+
+std::mutex g_printMutex;
+
+void Report(const char* stage, const char* result, const std::string& path) {
+    std::lock_guard<std::mutex> lock(g_printMutex);
+    std::printf("[%s] %-10s %s\n", stage, result, path.c_str());
+}
+
+// ========================================================
+// ハッシュと記録
+// ========================================================
+
+void HashBytes(uint64_t& h, const void* data, size_t bytes) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; ++i) h = (h ^ p[i]) * 0x100000001b3ull;
+}
+
+void HashValue(uint64_t& h, uint64_t value) { HashBytes(h, &value, sizeof(value)); }
+
+/**
+ * @brief ファイルの内容を h に混ぜる(読めなければ false)
+ */
+bool HashFile(uint64_t& h, const std::string& path) {
+    FILE* fp = nullptr;
+    if (fopen_s(&fp, path.c_str(), "rb") != 0 || !fp) return false;
+    std::vector<uint8_t> buffer(1 << 20);
+    size_t read = 0;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), fp)) > 0) HashBytes(h, buffer.data(), read);
+    const bool ok = std::ferror(fp) == 0;
+    std::fclose(fp);
+    return ok;
+}
+
+uint64_t StepKey(const char* stage, uint64_t settings) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    HashBytes(h, stage, std::strlen(stage));
+    HashValue(h, COOK_VERSION);
+    HashValue(h, settings);
+    return h;
+}
+
+bool FileExists(const std::string& path) {
+    return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+// 1行に「ハッシュ(16進) 出力 入力」(区切りはタブ)
+Manifest LoadManifest(const std::string& path) {
+    Manifest manifest;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t a = line.find('\t');
+        const size_t b = a == std::string::npos ? a : line.find('\t', a + 1);
+        if (b == std::string::npos) continue;
+        ManifestEntry entry;
+        entry.hash = std::strtoull(line.substr(0, a).c_str(), nullptr, 16);
+        entry.output = line.substr(a + 1, b - a - 1);
+        manifest[line.substr(b + 1)] = entry;
+    }
+    return manifest;
+}
+
+bool SaveManifest(const std::string& path, const Manifest& manifest) {
+    std::vector<std::string> keys;
+    keys.reserve(manifest.size());
+    for (const auto& item : manifest) keys.push_back(item.first);
+    std::sort(keys.begin(), keys.end());
+
+    const std::string tempPath = path + ".tmp";
+    FILE* fp = nullptr;
+    if (fopen_s(&fp, tempPath.c_str(), "w") != 0 || !fp) return false;
+    bool ok = true;
+    for (const std::string& key : keys) {
+        const ManifestEntry& entry = manifest.at(key);
+        ok = ok && std::fprintf(fp, "%016llx\t%s\t%s\n", static_cast<unsigned long long>(entry.hash), entry.output.c_str(), key.c_str()) > 0;
+    }
+    ok = (std::fclose(fp) == 0) && ok;
+    return ok && MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+}
+
+/**
+ * @brief 前回と同じ内容で、出力が残っているか
+ */
+bool IsUpToDate(const Manifest& manifest, const std::string& input, uint64_t hash) {
+    auto it = manifest.find(input);
+    return it != manifest.end() && it->second.hash == hash && (it->second.output == "-" || FileExists(it->second.output));
+}
+
+// ========================================================
+// 外部プロセス
+// ========================================================
+
+/**
+ * @brief コマンドを実行して終了を待つ(標準出力は捨てる)
+ * @return bool 起動でき、終了コードが 0 の場合 true
+ */
+bool RunProcess(const std::string& commandLine) {
+    STARTUPINFOA startup{};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION process{};
+    std::vector<char> buffer(commandLine.begin(), commandLine.end());
+    buffer.push_back('\0');
+    if (!CreateProcessA(nullptr, buffer.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startup, &process)) {
+        return false;
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    return exitCode == 0;
+}
+
+std::string Quote(const std::string& s) { return "\"" + s + "\""; }
+
+std::string ModuleDirectory() {
+    char path[MAX_PATH] = {};
+    GetModuleFileNameA(nullptr, path, MAX_PATH);
+    return std::filesystem::path(path).parent_path().string();
+}
+
+// PATH、ツールと同じディレクトリ、tools の順に探す
+std::string FindTexConv(const std::string& specified) {
+    if (!specified.empty()) return FileExists(specified) ? specified : std::string();
+    char found[MAX_PATH] = {};
+    if (SearchPathA(nullptr, "texconv.exe", nullptr, MAX_PATH, found, nullptr) > 0) return found;
+    const std::string local = ModuleDirectory() + "\\texconv.exe";
+    if (FileExists(local)) return local;
+    return FileExists("tools\\texconv.exe") ? "tools\\texconv.exe" : std::string();
+}
+
+// ========================================================
+// 分類
+// ========================================================
+
+std::string Extension(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c); });
+    return ext;
+}
+
+bool IsModel(const std::string& path) {
+    const std::string ext = Extension(path);
+    return ext == ".fbx" || ext == ".obj" || ext == ".gltf" || ext == ".glb" || ext == ".dae";
+}
+
+bool IsImage(const std::string& path) {
+    const std::string ext = Extension(path);
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga";
+}
+
+bool IsNormalMap(const std::string& path) {
+    std::string stem = std::filesystem::path(path).stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), [](char c) { return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c); });
+    auto endsWith = [&stem](const char* suffix) {
+        const size_t n = std::strlen(suffix);
+        return stem.size() >= n && stem.compare(stem.size() - n, n, suffix) == 0;
+    };
+    return endsWith("_n") || endsWith("_normal") || endsWith("_nrm");
+}
+
+std::string DdsPathFor(const std::string& path) {
+    return std::filesystem::path(path).replace_extension(".dds").generic_string();
+}
+
+// ========================================================
+// 各段階
+// ========================================================
+
+/**
+ * @brief 入力ごとの変換をワーカーで並列に行い、結果を記録に反映する
+ * @param[in] cook (入力, 前回と同じ内容で出力が残っているか, 出力) -> CookStatus。出力を持たない場合は出力に "-" を設定する
+ */
+template<class CookFn>
+void CookFiles(const char* stage, JobSystem& jobs, const std::vector<std::string>& inputs, uint64_t settings,
+               const CookOptions& options, Manifest& manifest, CookStats& stats, CookFn&& cook) {
+    std::vector<uint64_t> hashes(inputs.size(), 0);
+    std::vector<ManifestEntry> results(inputs.size());
+    std::vector<uint8_t> done(inputs.size(), 0);
+    jobs.ParallelFor(inputs.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const std::string& input = inputs[i];
+            uint64_t h = StepKey(stage, settings);
+            if (!HashFile(h, input)) {
+                Report(stage, "unreadable", input);
+                ++stats.failed;
+                continue;
+            }
+            hashes[i] = h;
+            std::string output;
+            const CookStatus status = cook(input, !options.force && IsUpToDate(manifest, input, h), output);
+            if (status == CookStatus::UpToDate) {
+                ++stats.upToDate;
+                continue;
+            }
+            if (status == CookStatus::Failed) {
+                Report(stage, "failed", input);
+                ++stats.failed;
+                continue;
+            }
+            results[i] = ManifestEntry{ h, output };
+            done[i] = 1;
+            Report(stage, "cooked", input);
+            ++stats.cooked;
+        }
+    });
+    // 記録の更新はワーカーの完了後にまとめて行う(走査中の manifest は読み取りのみ)
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (done[i]) manifest[inputs[i]] = results[i];
+        else if (hashes[i] == 0) manifest.erase(inputs[i]);
+    }
+}
+
+/**
+ * @brief ゲーム本体に起動時のシェーダーをコンパイルさせる(本体が変わった場合だけ)
+ */
+bool CookShaders(const CookOptions& options, Manifest& manifest, CookStats& stats) {
+    const std::string game = options.game.empty() ? ModuleDirectory() + "\\HEW_GAME.exe" : options.game;
+    uint64_t h = StepKey("shaders", ShaderCache::VERSION);
+    if (!HashFile(h, game)) {
+        Report("shaders", "missing", game);
+        ++stats.failed;
+        return false;
+    }
+    if (!options.force && IsUpToDate(manifest, game, h)) {
+        ++stats.upToDate;
+        return true;
+    }
+    const std::string csv = "cook_shaders.csv";
+    const bool ok = RunProcess(Quote(game) + " --headless --headless-frames 1 --headless-out " + csv + " --no-pak");
+    DeleteFileA(csv.c_str());
+    if (!ok) {
+        Report("shaders", "failed", game);
+        ++stats.failed;
+        return false;
+    }
+    manifest[game] = ManifestEntry{ h, ShaderCache::Directory() };
+    Report("shaders", "cooked", game);
+    ++stats.cooked;
+    return true;
+}
+
+/**
+ * @brief 作ったアーカイブをマウントし、含めた全ファイルが実行時のパスで引けるか確かめる
+ *
+ * @details
+ * `--assets ./Assets` のように "./" 付きで列挙したファイルも、ゲームは "Assets/..." で開くため両方の形で引きます。
+ */
+bool VerifyPak(const std::string& pak, const std::vector<std::string>& packed, std::string& error) {
+    AssetArchive& archive = AssetArchive::GetInstance();
+    if (!archive.Mount(pak)) {
+        error = "マウントできません: " + pak;
+        return false;
+    }
+    bool ok = archive.FileCount() == packed.size();
+    if (!ok) error = "ファイル数が一致しません: " + std::to_string(archive.FileCount()) + " / " + std::to_string(packed.size());
+    for (size_t i = 0; ok && i < packed.size(); ++i) {
+        const std::string& file = packed[i];
+        const bool dotted = file.size() >= 2 && file[0] == '.' && (file[1] == '/' || file[1] == '\\');
+        const std::string runtime = dotted ? file.substr(2) : file;
+        if (!archive.Contains(file) || !archive.Contains(runtime)) {
+            error = "アーカイブから引けません: " + runtime;
+            ok = false;
+        }
+    }
+    archive.Unmount();
+    return ok;
+}
+
+/**
+ * @brief アーカイブを作る(含めるファイルの一覧と内容が前回と同じなら飛ばす)
+ */
+bool BuildPak(const CookOptions& options, Manifest& manifest, CookStats& stats) {
+    std::vector<std::string> files;
+    std::string error;
+    if (!AssetArchive::ListFiles(options.assets, files, error)) {
+        Report("pak", "failed", error);
+        ++stats.failed;
+        return false;
+    }
+
+    // 変換済みの元ファイル(隣に .meshcache / .dds があるもの)と作業中の一時ファイルは含めない
+    std::vector<std::string> packed;
+    uint64_t h = StepKey("pak", options.compress ? 1 : 0);
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files) {
+        const std::string ext = Extension(file);
+        if (ext == ".tmp") continue;
+        if (IsModel(file) && FileExists(file + MeshCacheFile::EXTENSION)) continue;
+        if (IsImage(file) && FileExists(DdsPathFor(file))) continue;
+        HashBytes(h, file.data(), file.size());
+        if (!HashFile(h, file)) {
+            Report("pak", "unreadable", file);
+            ++stats.failed;
+            return false;
+        }
+        packed.push_back(file);
+    }
+    if (!options.force && IsUpToDate(manifest, options.pak, h)) {
+        ++stats.upToDate;
+        return true;
+    }
+    if (!AssetArchive::Build(packed, options.pak, options.compress, error) || !VerifyPak(options.pak, packed, error)) {
+        Report("pak", "failed", error);
+        ++stats.failed;
+        return false;
+    }
+    manifest[options.pak] = ManifestEntry{ h, options.pak };
+    Report("pak", "cooked", options.pak + " (" + std::to_string(packed.size()) + " files)");
+    ++stats.cooked;
+    return true;
+}
+
+bool ParseOptions(int argc, char** argv, CookOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--assets") == 0 && hasValue) {
+            options.assets = argv[++i];
+        } else if (std::strcmp(arg, "--pak") == 0 && hasValue) {
+            options.pak = argv[++i];
+        } else if (std::strcmp(arg, "--manifest") == 0 && hasValue) {
+            options.manifest = argv[++i];
+        } else if (std::strcmp(arg, "--game") == 0 && hasValue) {
+            options.game = argv[++i];
+        } else if (std::strcmp(arg, "--texconv") == 0 && hasValue) {
+            options.texconv = argv[++i];
+        } else if (std::strcmp(arg, "--force") == 0) {
+            options.force = true;
+        } else if (std::strcmp(arg, "--no-models") == 0) {
+            options.models = false;
+        } else if (std::strcmp(arg, "--no-textures") == 0) {
+            options.textures = false;
+        } else if (std::strcmp(arg, "--no-shaders") == 0) {
+            options.shaders = false;
+        } else if (std::strcmp(arg, "--no-pak") == 0) {
+            options.buildPak = false;
+        } else if (std::strcmp(arg, "--pak-store") == 0) {
+            options.compress = false;
+        } else if (std::strcmp(arg, "--no-mesh-merge") == 0) {
+            options.mergeByMaterial = false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintUsage() {
+    std::printf("usage: HEW_COOK [--assets Assets] [--pak Assets.pak] [--manifest Assets.cook] [--game HEW_GAME.exe]\n"
+                "                [--texconv texconv.exe] [--force] [--no-models] [--no-textures] [--no-shaders] [--no-pak]\n"
+                "                [--pak-store] [--no-mesh-merge]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CookOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    std::string error;
+    if (!AssetArchive::ListFiles(options.assets, files, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::vector<std::string> models;
+    std::vector<std::string> images;
+    for (const std::string& file : files) {
+        if (IsModel(file)) models.push_back(file);
+        else if (IsImage(file)) images.push_back(file);
+    }
+
+    Manifest manifest = LoadManifest(options.manifest);
+    CookStats stats;
+    JobSystem jobs;
+    jobs.Init();
+    ModelLoader::SetJobSystem(&jobs);
+    ModelLoader::SetMergeByMaterial(options.mergeByMaterial);
+
+    if (options.models) {
+        const uint64_t settings = (static_cast<uint64_t>(MeshCacheFile::VERSION) << 32) | (ModelLoader::IsMergeByMaterial() ? 1u : 0u);
+        CookFiles("models", jobs, models, settings, options, manifest, stats,
+                  [](const std::string& input, bool upToDate, std::string& output) {
+            if (upToDate) {
+                // 内容が同じでも更新日時が変わっていれば実行時の鮮度判定に合わせて記録だけを書き換える(スキニングされたモデルは何もしない)
+                ModelLoader::RestampCache(input);
+                return CookStatus::UpToDate;
+            }
+            output = input + MeshCacheFile::EXTENSION;
+            switch (ModelLoader::CookCache(input)) {
+            case ModelLoader::CookResult::Written: return CookStatus::Cooked;
+            case ModelLoader::CookResult::Skinned: output = "-"; return CookStatus::Cooked;
+            default: return CookStatus::Failed;
+            }
+        });
+    }
+
+    if (options.textures && !images.empty()) {
+        const std::string texconv = FindTexConv(options.texconv);
+        if (texconv.empty()) {
+            std::fprintf(stderr, "texconv.exe が見つかりません(PATH へ追加するか、tools に置くか、--texconv で指定してください)\n");
+            ++stats.failed;
+        } else {
+            CookFiles("textures", jobs, images, 0, options, manifest, stats,
+                      [&texconv](const std::string& input, bool upToDate, std::string& output) {
+                if (upToDate) return CookStatus::UpToDate;
+                output = DdsPathFor(input);
+                const std::string format = IsNormalMap(input) ? "-f BC5_UNORM" : "-f BC7_UNORM_SRGB -srgb";
+                const std::string directory = std::filesystem::path(input).parent_path().string();
+                // -m 0: 1x1 までのミップを生成 / -y: 上書き
+                const bool ok = RunProcess(Quote(texconv) + " " + format + " -m 0 -y -nologo -o " + Quote(directory) + " " + Quote(input));
+                return ok && FileExists(output) ? CookStatus::Cooked : CookStatus::Failed;
+            });
+        }
+    }
+
+    if (options.shaders) CookShaders(options, manifest, stats);
+    if (options.buildPak) BuildPak(options, manifest, stats);
+
+    ModelLoader::SetJobSystem(nullptr);
+    jobs.Shutdown();
+
+    if (!SaveManifest(options.manifest, manifest)) {
+        std::fprintf(stderr, "failed to write %s\n", options.manifest.c_str());
+        return 1;
+    }
+    std::printf("cooked %d, up to date %d, failed %d\n", stats.cooked.load(), stats.upToDate.load(), stats.failed.load());
+    return stats.failed.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file BenchCompare.cpp
+ * @brief ベンチマークの履歴(bench_history.csv)から2つのコミットの計測値を比較し、回帰を検出するツール(HEW_BENCH_COMPARE)
+ * @author 山内陽
+ * @date 2025
+ * @version 1.0
+ *
+ * @details
+ * 各ベンチマークが BenchmarkHistory に追記した計測値を、同じマシン・同じ suite・同じ metric ごとに
+ * 基準(baseline)と候補(candidate)のコミットで比べ、中央値・MAD・変化率とその信頼区間・判定を表にします。
+ * 同じコミットで複数回実行した分はまとめて1つの標本として扱います。
+ *
+ * - コミットは前方一致で指定できます。省略すると候補は履歴の最後の行のコミット、基準はそのマシンで候補の前に記録したコミットです。
+ * - マシンは `--machine`(識別子の前方一致)で指定できます。省略すると候補の最後の行のマシンです。
+ * - World::Tick・RenderSystem::Render・ModelLoader の指標(BenchmarkHistory::IsGated()、表の * 印)に
+ *   Regression があれば終了コード 1 を返します。`--gate all` ではすべての指標が対象です。
+ *   引数やファイルの誤りは終了コード 2 です。
+ *
+ * @par 使用例
+ * @code
+ * HEW_BENCH_COMPARE.exe                                        // 最新のコミットをその前のコミットと比較
+ * HEW_BENCH_COMPARE.exe --baseline 8fca8c3 --threshold 3       // 基準を指定し、3% 以上の変化を差として扱う
+ * HEW_BENCH_COMPARE.exe --filter World::Tick --gate all
+ * HEW_BENCH_COMPARE.exe --list                                 // 記録されているマシンとコミットを表示
+ * @endcode
+ */
+#include "app/BenchmarkHistory.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/**
+ * @struct CompareOptions
+ * @brief コマンドライン引数
+ */
+struct CompareOptions {
+    std::string history = BenchmarkHistory::DEFAULT_PATH;  ///< 履歴のファイル
+    std::string baseline;                                   ///< 基準のコミット(前方一致、空なら候補の前のコミット)
+    std::string candidate;                                  ///< 候補のコミット(前方一致、空なら最後に記録したコミット)
+    std::string machine;                                    ///< マシンの識別子(前方一致、空なら候補の最後の行のマシン)
+    std::string filter;                                     ///< suite か metric にこの文字列を含むものだけ比較する
+    double threshold = BenchmarkHistory::DEFAULT_THRESHOLD; ///< 差として扱う最小の変化率
+    double confidence = BenchmarkHistory::DEFAULT_CONFIDENCE;
+    bool gateAll = false;                                   ///< すべての指標の回帰で終了コードを変える
+    bool list = false;                                      ///< マシンとコミットの一覧を表示して終了
+};
+
+using MetricKey = std::pair<std::string, std::string>;   ///< suite, metric
+using MetricSamples = std::map<MetricKey, std::vector<double>>;
+
+bool StartsWith(const std::string& text, const std::string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool ParseOptions(int argc, char** argv, CompareOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--history") == 0 && hasValue) {
+            options.history = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0 && hasValue) {
+            options.baseline = argv[++i];
+        } else if (std::strcmp(arg, "--candidate") == 0 && hasValue) {
+            options.candidate = argv[++i];
+        } else if (std::strcmp(arg, "--machine") == 0 && hasValue) {
+            options.machine = argv[++i];
+        } else if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(arg, "--threshold") == 0 && hasValue) {
+            options.threshold = std::atof(argv[++i]) / 100.0;
+            if (options.threshold < 0.0) return false;
+        } else if (std::strcmp(arg, "--confidence") == 0 && hasValue) {
+            options.confidence = std::atof(argv[++i]);
+            if (options.confidence <= 0.0 || options.confidence >= 1.0) return false;
+        } else if (std::strcmp(arg, "--gate") == 0 && hasValue) {
+            const char* value = argv[++i];
+            if (std::strcmp(value, "all") == 0) options.gateAll = true;
+            else if (std::strcmp(value, "key") == 0) options.gateAll = false;
+            else return false;
+        } else if (std::strcmp(arg, "--list") == 0) {
+            options.list = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintUsage() {
+    std::printf("usage: HEW_BENCH_COMPARE [--history bench_history.csv] [--baseline commit] [--candidate commit] [--machine id]\n"
+                "                         [--filter text] [--threshold percent] [--confidence 0.95] [--gate key|all] [--list]\n");
+}
+
+/**
+ * @brief machine のコミットを初めて記録された順に並べる
+ */
+std::vector<std::string> CommitsInOrder(const std::vector<BenchmarkRecord>& records, const std::string& machine) {
+    std::vector<std::string> commits;
+    for (const BenchmarkRecord& r : records) {
+        if (r.machine != machine) continue;
+        if (std::find(commits.begin(), commits.end(), r.commit) == commits.end()) commits.push_back(r.commit);
+    }
+    return commits;
+}
+
+/**
+ * @brief 前方一致でコミットを1つに決める(見つからない・複数ある場合は空)
+ */
+std::string ResolveCommit(const std::vector<std::string>& commits, const std::string& prefix) {
+    std::string found;
+    for (const std::string& commit : commits) {
+        if (!StartsWith(commit, prefix)) continue;
+        if (!found.empty()) {
+            std::fprintf(stderr, "commit '%s' is ambiguous (%s, %s, ...)\n", prefix.c_str(), found.c_str(), commit.c_str());
+            return std::string();
+        }
+        found = commit;
+    }
+    if (found.empty()) std::fprintf(stderr, "commit '%s' is not in the history for this machine\n", prefix.c_str());
+    return found;
+}
+
+MetricSamples Collect(const std::vector<BenchmarkRecord>& records, const std::string& machine, const std::string& commit,
+                      const std::string& filter) {
+    MetricSamples samples;
+    for (const BenchmarkRecord& r : records) {
+        if (r.machine != machine || r.commit != commit) continue;
+        if (!filter.empty() && r.suite.find(filter) == std::string::npos && r.metric.find(filter) == std::string::npos) continue;
+        std::vector<double>& out = samples[MetricKey(r.suite, r.metric)];
+        out.insert(out.end(), r.samples.begin(), r.samples.end());
+    }
+    return samples;
+}
+
+void PrintList(const std::vector<BenchmarkRecord>& records) {
+    std::vector<std::string> machines;
+    for (const BenchmarkRecord& r : records) {
+        if (std::find(machines.begin(), machines.end(), r.machine) == machines.end()) machines.push_back(r.machine);
+    }
+    for (const std::string& machine : machines) {
+        const auto info = std::find_if(records.begin(), records.end(), [&](const BenchmarkRecord& r) { return r.machine == machine; });
+        std::printf("machine %s (%s)\n", machine.c_str(), info->machineInfo.c_str());
+        for (const std::string& commit : CommitsInOrder(records, machine)) {
+            size_t rows = 0;
+            std::string last;
+            for (const BenchmarkRecord& r : records) {
+                if (r.machine != machine || r.commit != commit) continue;
+                ++rows;
+                last = r.date;
+            }
+            std::printf("  %s  %4zu rows, last %s\n", commit.c_str(), rows, last.c_str());
+        }
+    }
+}
+
+std::string Short(const std::string& commit) {
+    return commit.substr(0, 10);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CompareOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<BenchmarkRecord> records;
+    if (!BenchmarkHistory::Load(options.history, records)) {
+        std::fprintf(stderr, "failed to read %s\n", options.history.c_str());
+        return 2;
+    }
+    if (records.empty()) {
+        std::fprintf(stderr, "%s has no samples\n", options.history.c_str());
+        return 2;
+    }
+    if (options.list) {
+        PrintList(records);
+        return 0;
+    }
+
+    // マシン: 指定がなければ候補(指定がなければ履歴の最後の行)のマシン
+    std::string machine;
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+        if (!options.machine.empty() && !StartsWith(it->machine, options.machine)) continue;
+        if (options.machine.empty() && !options.candidate.empty() && !StartsWith(it->commit, options.candidate)) continue;
+        machine = it->machine;
+        break;
+    }
+    if (machine.empty()) {
+        std::fprintf(stderr, "no samples for the given machine / candidate\n");
+        return 2;
+    }
+
+    const std::vector<std::string> commits = CommitsInOrder(records, machine);
+    const std::string candidate = options.candidate.empty() ? commits.back() : ResolveCommit(commits, options.candidate);
+    if (candidate.empty()) return 2;
+    std::string baseline;
+    if (options.baseline.empty()) {
+        const auto it = std::find(commits.begin(), commits.end(), candidate);
+        if (it == commits.begin()) {
+            std::fprintf(stderr, "no commit was recorded before %s on machine %s (use --baseline)\n", Short(candidate).c_str(), machine.c_str());
+            return 2;
+        }
+        baseline = *(it - 1);
+    } else {
+        baseline = ResolveCommit(commits, options.baseline);
+        if (baseline.empty()) return 2;
+    }
+
+    const auto info = std::find_if(records.begin(), records.end(), [&](const BenchmarkRecord& r) { return r.machine == machine; });
+    std::printf("machine   %s (%s)\n", machine.c_str(), info->machineInfo.c_str());
+    std::printf("baseline  %s\ncandidate %s\n", baseline.c_str(), candidate.c_str());
+    std::printf("threshold %.1f%%, confidence %.0f%%, * = gated (World::Tick / RenderSystem::Render / ModelLoader)\n\n",
+                options.threshold * 100.0, options.confidence * 100.0);
+
+    const MetricSamples base = Collect(records, machine, baseline, options.filter);
+    const MetricSamples cand = Collect(records, machine, candidate, options.filter);
+
+    std::printf("  %-28s %-44s %21s %21s %8s %19s  %s\n", "suite", "metric", "baseline med/mad (n)", "candidate med/mad (n)",
+                "change", "ci", "verdict");
+    int counts[4] = {};
+    int gatedRegressions = 0;
+    size_t missing = 0;
+    for (const auto& entry : cand) {
+        const auto found = base.find(entry.first);
+        if (found == base.end()) {
+            ++missing;
+            continue;
+        }
+        const std::string& metric = entry.first.second;
+        const bool gated = options.gateAll || BenchmarkHistory::IsGated(metric);
+        const BenchmarkComparison c = BenchmarkHistory::Compare(found->second, entry.second, options.threshold, options.confidence);
+        ++counts[static_cast<int>(c.verdict)];
+        if (gated && c.verdict == BenchmarkComparison::Verdict::Regression) ++gatedRegressions;
+
+        char baseText[32], candText[32], ci[32];
+        std::snprintf(baseText, sizeof(baseText), "%.3f/%.3f (%zu)", c.baseline.median, c.baseline.mad, c.baseline.count);
+        std::snprintf(candText, sizeof(candText), "%.3f/%.3f (%zu)", c.candidate.median, c.candidate.mad, c.candidate.count);
+        std::snprintf(ci, sizeof(ci), "[%+.1f%%, %+.1f%%]", c.ciLow * 100.0, c.ciHigh * 100.0);
+        std::printf("%c %-28s %-44s %21s %21s %+7.1f%% %19s  %s\n", gated ? '*' : ' ', entry.first.first.c_str(), metric.c_str(),
+                    baseText, candText, c.change * 100.0, ci, BenchmarkComparison::VerdictName(c.verdict));
+    }
+
+    using Verdict = BenchmarkComparison::Verdict;
+    std::printf("\n%d regression(s) (%d gated), %d improvement(s), %d unchanged, %d with too few samples",
+                counts[static_cast<int>(Verdict::Regression)], gatedRegressions, counts[static_cast<int>(Verdict::Improvement)],
+                counts[static_cast<int>(Verdict::Unchanged)], counts[static_cast<int>(Verdict::Insufficient)]);
+    if (missing > 0) std::printf(", %zu only in candidate", missing);
+    std::printf("\n");
+    return gatedRegressions > 0 ? 1 : 0;
+}
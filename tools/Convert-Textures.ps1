@@ -0,0 +1,77 @@
+[CmdletBinding()]
+param(
+    [string]$Root = 'Assets',
+    [switch]$Force,
+    [string]$TexConv
+)
+
+# 画像(PNG/JPG/BMP/TGA)を同じ名前の .dds (BC圧縮・ミップ付き)に変換する。
+# TextureManager は同名の .dds があればそちらを読み込む。
+#   *_n / *_normal / *_nrm : BC5 (RG、Zはシェーダーで復元)
+#   それ以外               : BC7 sRGB
+# DirectXTex の texconv.exe を使用する(https://github.com/microsoft/DirectXTex/releases)。
+
+$ErrorActionPreference = 'Stop'
+
+function Find-TexConv {
+    param([string]$Path)
+
+    if ($Path) {
+        if (Test-Path $Path) {
+            return $Path
+        }
+        throw "texconv.exe が見つかりませんでした: $Path"
+    }
+
+    $cmd = Get-Command texconv -ErrorAction SilentlyContinue
+    if ($cmd) {
+        return $cmd.Path
+    }
+
+    $local = Join-Path $PSScriptRoot 'texconv.exe'
+    if (Test-Path $local) {
+        return $local
+    }
+
+    throw "texconv.exe が見つかりませんでした。PATH へ追加するか、tools フォルダに置くか、-TexConv で指定してください。"
+}
+
+function IsNormalMap {
+    param([string]$Name)
+
+    return $Name -match '(_n|_normal|_nrm)$'
+}
+
+$texconv = Find-TexConv -Path $TexConv
+
+$sources = Get-ChildItem -Path $Root -Recurse -File |
+    Where-Object { $_.Extension -match '^\.(png|jpg|jpeg|bmp|tga)$' }
+
+if (-not $sources -or $sources.Count -eq 0) {
+    Write-Host "texconv: 対象ファイルがありません。"
+    return
+}
+
+$converted = 0
+foreach ($source in $sources) {
+    $target = [IO.Path]::ChangeExtension($source.FullName, '.dds')
+    if (-not $Force -and (Test-Path $target) -and (Get-Item $target).LastWriteTime -ge $source.LastWriteTime) {
+        continue
+    }
+
+    if (IsNormalMap -Name $source.BaseName) {
+        $formatArgs = @('-f', 'BC5_UNORM')
+    } else {
+        $formatArgs = @('-f', 'BC7_UNORM_SRGB', '-srgb')
+    }
+
+    # -m 0: 1x1 までのミップを生成 / -y: 上書き
+    & $texconv @formatArgs -m 0 -y -nologo -o $source.DirectoryName $source.FullName | Out-Null
+
+    if ($LASTEXITCODE -ne 0) {
+        throw "texconv の実行に失敗しました: $($source.FullName)"
+    }
+    $converted++
+}
+
+Write-Host "texconv: $converted 件のテクスチャを変換しました。"